@@ -369,6 +369,7 @@ let package = Package(
         "compiled_proto/connections/cpp",
         "presence",
         "embedded",
+        "connections/benchmarks",
         "connections/c",
         "connections/dart",
         "connections/clients/ios",
@@ -398,6 +399,7 @@ let package = Package(
         "internal/crypto/BUILD.gn",
         "internal/interop/BUILD",
         "internal/weave/BUILD",
+        "internal/weave/fuzzers",
         "internal/platform/flags/BUILD",
         "internal/platform/implementation/shared/BUILD",
         "internal/platform/implementation/apple/Mediums/BUILD",
@@ -414,6 +416,8 @@ let package = Package(
         // tests
         "connections/listeners_test.cc",
         "connections/strategy_test.cc",
+        "connections/implementation/adaptive_chunk_sizer_test.cc",
+        "connections/implementation/aead_frame_cipher_test.cc",
         "connections/implementation/offline_frames_test.cc",
         "connections/implementation/offline_service_controller_test.cc",
         "connections/implementation/encryption_runner_test.cc",
@@ -422,12 +426,20 @@ let package = Package(
         "connections/implementation/base_pcp_handler_test.cc",
         "connections/implementation/injected_bluetooth_device_store_test.cc",
         "connections/implementation/internal_payload_factory_test.cc",
+        "connections/implementation/memory_accountant_test.cc",
         "connections/implementation/client_proxy_test.cc",
         "connections/implementation/payload_manager_test.cc",
+        "connections/implementation/payload_chunk_prefetcher_test.cc",
+        "connections/implementation/payload_chunk_compression_test.cc",
+        "connections/implementation/payload_progress_throttle_test.cc",
+        "connections/implementation/payload_relay_test.cc",
+        "connections/implementation/payload_send_scheduler_test.cc",
         "connections/implementation/offline_frames_validator_test.cc",
         "connections/implementation/service_controller_router_test.cc",
+        "connections/implementation/session_ticket_store_test.cc",
         "connections/implementation/wifi_direct_bwu_test.cc",
         "connections/implementation/wifi_hotspot_test.cc",
+        "connections/implementation/transport_config_test.cc",
         "connections/implementation/analytics/analytics_recorder_test.cc",
         "connections/implementation/analytics/throughput_recorder_test.cc",
         "connections/implementation/mediums/ble_v2_test.cc",
@@ -435,15 +447,18 @@ let package = Package(
         "connections/implementation/mediums/ble_v2/ble_packet_test.cc",
         "connections/implementation/mediums/ble_v2/ble_advertisement_test.cc",
         "connections/implementation/mediums/ble_v2/advertisement_read_result_test.cc",
+        "connections/implementation/mediums/ble_v2/advertisement_cache_test.cc",
         "connections/implementation/mediums/ble_v2/ble_advertisement_header_test.cc",
         "connections/implementation/mediums/ble_v2/ble_utils_test.cc",
         "connections/implementation/mediums/ble_v2/discovered_peripheral_tracker_test.cc",
+        "connections/implementation/mediums/ble_v2/gatt_client_pool_test.cc",
         "connections/implementation/mediums/webrtc_peer_id_test.cc",
         "connections/implementation/mediums/wifi_lan_test.cc",
         "connections/implementation/mediums/bluetooth_classic_test.cc",
         "connections/implementation/mediums/ble_test.cc",
         "connections/implementation/mediums/webrtc_test.cc",
         "connections/implementation/mediums/lost_entity_tracker_test.cc",
+        "connections/implementation/mediums/expiry_wheel_test.cc",
         "connections/implementation/mediums/bluetooth_radio_test.cc",
         "connections/implementation/mediums/wifi_direct_test.cc",
         "connections/implementation/mediums/wifi_hotspot_test.cc",
@@ -452,9 +467,14 @@ let package = Package(
         "connections/implementation/bwu_manager_test.cc",
         "connections/implementation/base_bwu_handler_test.cc",
         "connections/implementation/endpoint_manager_test.cc",
+        "connections/implementation/endpoint_stats_test.cc",
+        "connections/implementation/file_chunk_store_test.cc",
+        "connections/implementation/frame_trace_test.cc",
+        "connections/implementation/medium_performance_history_test.cc",
         "connections/implementation/bluetooth_device_name_test.cc",
         "connections/implementation/wifi_lan_service_info_test.cc",
         "connections/implementation/pcp_manager_test.cc",
+        "connections/implementation/round_robin_executor_test.cc",
         "connections/implementation/ble_advertisement_test.cc",
         "connections/implementation/base_endpoint_channel_test.cc",
         "connections/v3/connections_device_test.cc",
@@ -465,6 +485,7 @@ let package = Package(
         "connections/payload_test.cc",
         "internal/base/bluetooth_address_test.cc",
         "internal/crypto/aead_unittest.cc",
+        "internal/crypto/crypto_benchmark.cc",
         "internal/crypto/ec_private_key_unittest.cc",
         "internal/crypto/ec_signature_creator_unittest.cc",
         "internal/crypto/ed25519_unittest.cc",
@@ -481,7 +502,11 @@ let package = Package(
         "internal/platform/feature_flags_test.cc",
         "internal/platform/cancelable_alarm_test.cc",
         "internal/platform/crypto_test.cc",
+        "internal/platform/device_info_impl_test.cc",
+        "internal/platform/async_stream_test.cc",
         "internal/platform/byte_array_test.cc",
+        "internal/platform/byte_slice_test.cc",
+        "internal/platform/base64_utils_test.cc",
         "internal/platform/bluetooth_utils_test.cc",
         "internal/platform/credential_storage_impl_test.cc",
         "internal/platform/input_stream_test.cc",
@@ -504,12 +529,16 @@ let package = Package(
         "internal/platform/bluetooth_classic_test.cc",
         "internal/platform/bluetooth_connection_info_test.cc",
         "internal/platform/mutex_test.cc",
+        "internal/platform/mutex_profiler_test.cc",
+        "internal/platform/tracing_test.cc",
         "internal/platform/atomic_reference_test.cc",
         "internal/platform/logging_test.cc",
         "internal/platform/multi_thread_executor_test.cc",
+        "internal/platform/pending_job_registry_test.cc",
         "internal/platform/ble_connection_info_test.cc",
         "internal/platform/ble_test.cc",
         "internal/platform/ble_v2_test.cc",
+        "internal/platform/ble_scan_arbiter_test.cc",
         "internal/platform/prng_test.cc",
         "internal/platform/implementation/apple/count_down_latch_test.cc",
         "internal/platform/implementation/apple/condition_variable_test.cc",
@@ -517,12 +546,19 @@ let package = Package(
         "internal/platform/implementation/apple/atomic_boolean_test.cc",
         "internal/platform/implementation/apple/atomic_uint32_test.cc",
         "internal/platform/implementation/shared/file_test.cc",
+        "internal/platform/implementation/shared/binary_preferences_manager_test.cc",
+        "internal/platform/implementation/shared/mapped_file_test.cc",
+        "internal/platform/implementation/shared/strand_test.cc",
+        "internal/platform/implementation/shared/timer_wheel_test.cc",
+        "internal/platform/implementation/shared/work_stealing_executor_test.cc",
+        "internal/platform/implementation/shared/write_behind_credential_storage_test.cc",
         "internal/platform/atomic_boolean_test.cc",
         "internal/platform/exception_test.cc",
         "internal/platform/error_code_recorder_test.cc",
         "internal/platform/future_test.cc",
         "internal/platform/cancellation_flag_test.cc",
         "internal/platform/bluetooth_adapter_test.cc",
+        "internal/platform/bluetooth_radio_state_test.cc",
         "internal/platform/byte_utils_test.cc",
         "internal/platform/direct_executor_test.cc",
         "internal/platform/borrowable_test.cc",
@@ -546,6 +582,7 @@ let package = Package(
         "internal/weave/packet_sequence_number_generator_test.cc",
         "internal/weave/packetizer_test.cc",
         // simulation
+        "connections/implementation/frame_trace_replayer.cc",
         "connections/implementation/offline_simulation_user.cc",
         "connections/implementation/simulation_user.cc",
         // proto
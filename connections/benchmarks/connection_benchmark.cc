@@ -0,0 +1,258 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Connection establishment benchmarks over simulated mediums.
+//
+// Every iteration starts from two fresh devices, one of them advertising, and
+// measures the time from StartDiscovery() until the first payload sent over
+// the new connection has arrived, i.e. the time to first byte.
+//
+// The time is broken down into phases using the durations AnalyticsRecorder
+// records in the ConnectionsLog of each device:
+//  - discovery_ms: StartDiscovery() until the endpoint was found.
+//  - connect_ms:   medium connect, i.e. the discoverer's outgoing connection
+//                  attempt minus the advertiser's incoming one.
+//  - ukey2_ms:     the advertiser's incoming connection attempt, which spans
+//                  reading the ConnectionRequest and the UKEY2 handshake.
+//  - response_ms:  ConnectionResponse exchange, from initiated_cb until both
+//                  sides have accepted.
+//  - bwu_ms:       bandwidth upgrade, for cases that allow one. The upgrade
+//                  starts once both sides have accepted and isn't waited for
+//                  as part of the wall time.
+// first_payload_ms is measured by the benchmark itself.
+//
+// Arguments are {medium}, see kMediums for the medium indices.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "connections/implementation/offline_simulation_user.h"
+#include "connections/medium_selector.h"
+#include "connections/payload.h"
+#include "internal/analytics/event_logger.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/count_down_latch.h"
+#include "internal/platform/medium_environment.h"
+#include "internal/proto/analytics/connections_log.pb.h"
+#include "proto/connections_enums.pb.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+using ::location::nearby::analytics::proto::ConnectionsLog;
+using ::location::nearby::proto::connections::CLIENT_SESSION;
+using ::location::nearby::proto::connections::ConnectionAttemptDirection;
+using ::location::nearby::proto::connections::INCOMING;
+using ::location::nearby::proto::connections::INITIAL;
+using ::location::nearby::proto::connections::OUTGOING;
+using ::location::nearby::proto::connections::RESULT_SUCCESS;
+using ::location::nearby::proto::connections::UPGRADE_RESULT_SUCCESS;
+
+constexpr absl::string_view kServiceId = "benchmark-service-id";
+constexpr absl::Duration kSetupTimeout = absl::Seconds(5);
+constexpr absl::Duration kUpgradeTimeout = absl::Seconds(10);
+
+struct MediumCase {
+  const char* name;
+  BooleanMediumSelector allowed;
+  // Whether the devices are expected to upgrade after connecting.
+  bool upgrade;
+};
+
+const MediumCase kMediums[] = {
+    {"bluetooth", BooleanMediumSelector{.bluetooth = true}, false},
+    {"ble", BooleanMediumSelector{.ble = true}, false},
+    {"wifi_lan", BooleanMediumSelector{.wifi_lan = true}, false},
+    {"bluetooth_to_wifi_lan",
+     BooleanMediumSelector{.bluetooth = true, .wifi_lan = true}, true},
+};
+
+// Keeps the first ClientSession logged by a device.
+class SessionLogger : public analytics::EventLogger {
+ public:
+  void Log(const ::google::protobuf::MessageLite& message) override {
+    auto connections_log = dynamic_cast<const ConnectionsLog*>(&message);
+    if (connections_log == nullptr || logged_ ||
+        connections_log->event_type() != CLIENT_SESSION) {
+      return;
+    }
+    session_ = connections_log->client_session();
+    logged_ = true;
+    latch_.CountDown();
+  }
+
+  // Returns the logged session, or nullptr if it wasn't logged in time.
+  const ConnectionsLog::ClientSession* Await() {
+    if (!latch_.Await(kSetupTimeout).result()) return nullptr;
+    return &session_;
+  }
+
+ private:
+  // Only touched from the analytics executor until latch_ is released.
+  bool logged_ = false;
+  ConnectionsLog::ClientSession session_;
+  CountDownLatch latch_{1};
+};
+
+const ConnectionsLog::ConnectionAttempt* FindInitialAttempt(
+    const ConnectionsLog::ClientSession& session,
+    ConnectionAttemptDirection direction) {
+  for (const auto& strategy : session.strategy_session()) {
+    for (const auto& attempt : strategy.connection_attempt()) {
+      if (attempt.type() == INITIAL && attempt.direction() == direction &&
+          attempt.attempt_result() == RESULT_SUCCESS) {
+        return &attempt;
+      }
+    }
+  }
+  return nullptr;
+}
+
+// Accumulated phase durations, in milliseconds.
+struct Phases {
+  double discovery = 0;
+  double connect = 0;
+  double ukey2 = 0;
+  double response = 0;
+  double first_payload = 0;
+  double bwu = 0;
+
+  // Adds the phases recorded by AnalyticsRecorder. Returns false if the logs
+  // are missing any of them.
+  bool Add(const ConnectionsLog::ClientSession& advertiser,
+           const ConnectionsLog::ClientSession& discoverer) {
+    if (discoverer.strategy_session_size() == 0) return false;
+    const auto& strategy = discoverer.strategy_session(0);
+    if (strategy.discovery_phase_size() == 0) return false;
+    const auto& phase = strategy.discovery_phase(0);
+    if (phase.discovered_endpoint_size() == 0 ||
+        phase.sent_connection_request_size() == 0) {
+      return false;
+    }
+    const auto* outgoing = FindInitialAttempt(discoverer, OUTGOING);
+    const auto* incoming = FindInitialAttempt(advertiser, INCOMING);
+    if (outgoing == nullptr || incoming == nullptr) return false;
+
+    discovery += phase.discovered_endpoint(0).latency_millis();
+    connect += outgoing->duration_millis() - incoming->duration_millis();
+    ukey2 += incoming->duration_millis();
+    response += phase.sent_connection_request(0).duration_millis();
+    for (const auto& advertiser_strategy : advertiser.strategy_session()) {
+      for (const auto& upgrade : advertiser_strategy.upgrade_attempt()) {
+        if (upgrade.upgrade_result() == UPGRADE_RESULT_SUCCESS) {
+          bwu += upgrade.duration_millis();
+          return true;
+        }
+      }
+    }
+    return true;
+  }
+
+  void Report(benchmark::State& state) const {
+    auto avg = [](double value) {
+      return benchmark::Counter(value, benchmark::Counter::kAvgIterations);
+    };
+    state.counters["discovery_ms"] = avg(discovery);
+    state.counters["connect_ms"] = avg(connect);
+    state.counters["ukey2_ms"] = avg(ukey2);
+    state.counters["response_ms"] = avg(response);
+    state.counters["first_payload_ms"] = avg(first_payload);
+    state.counters["bwu_ms"] = avg(bwu);
+  }
+};
+
+// Connects a fresh pair of devices and sends one payload.
+void BM_ConnectToFirstPayload(benchmark::State& state) {
+  const MediumCase& medium = kMediums[state.range(0)];
+  MediumEnvironment& env = MediumEnvironment::Instance();
+  const ByteArray first_payload(std::string(1, 'p'));
+  Phases phases;
+  state.SetLabel(medium.name);
+  for (auto _ : state) {
+    state.PauseTiming();
+    env.Start();
+    SessionLogger advertiser_log;
+    SessionLogger discoverer_log;
+    auto advertiser = std::make_unique<OfflineSimulationUser>(
+        "advertiser", medium.allowed, &advertiser_log);
+    auto discoverer = std::make_unique<OfflineSimulationUser>(
+        "discoverer", medium.allowed, &discoverer_log);
+    CountDownLatch found(1);
+    CountDownLatch initiated(2);
+    CountDownLatch accepted(2);
+    CountDownLatch received(1);
+    CountDownLatch upgraded(1);
+    discoverer->ExpectBandwidthChanged(upgraded);
+    bool ok =
+        advertiser->StartAdvertising(std::string(kServiceId), &initiated).Ok();
+    state.ResumeTiming();
+
+    ok = ok &&
+         discoverer->StartDiscovery(std::string(kServiceId), &found).Ok() &&
+         found.Await(kSetupTimeout).result();
+    if (ok) {
+      discoverer->StopDiscovery();
+      ok = discoverer->RequestConnection(&initiated).Ok() &&
+           initiated.Await(kSetupTimeout).result();
+    }
+    if (ok) {
+      advertiser->AcceptConnection(&accepted);
+      discoverer->AcceptConnection(&accepted);
+      ok = accepted.Await(kSetupTimeout).result();
+    }
+    absl::Time accepted_time = absl::Now();
+    if (ok) {
+      advertiser->ExpectPayload(received);
+      discoverer->SendPayload(Payload(first_payload));
+      ok = received.Await(kSetupTimeout).result();
+    }
+    phases.first_payload += absl::ToDoubleMilliseconds(absl::Now() -
+                                                       accepted_time);
+
+    state.PauseTiming();
+    if (ok && medium.upgrade) ok = upgraded.Await(kUpgradeTimeout).result();
+    discoverer->Stop();
+    advertiser->Stop();
+    const auto* advertiser_session = advertiser_log.Await();
+    const auto* discoverer_session = discoverer_log.Await();
+    ok = ok && advertiser_session != nullptr &&
+         discoverer_session != nullptr &&
+         phases.Add(*advertiser_session, *discoverer_session);
+    discoverer.reset();
+    advertiser.reset();
+    env.Stop();
+    state.ResumeTiming();
+    if (!ok) {
+      state.SkipWithError("Failed to connect and deliver the first payload.");
+      break;
+    }
+  }
+  phases.Report(state);
+}
+
+BENCHMARK(BM_ConnectToFirstPayload)
+    ->ArgNames({"medium"})
+    ->DenseRange(0, 3)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
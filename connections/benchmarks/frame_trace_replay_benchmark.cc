@@ -0,0 +1,228 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Replays frame traces through MediumEnvironment with the simulated clock,
+// see FrameTraceReplayer.
+//
+// BM_ReplayCapturedTrace replays the trace in the file named by the
+// NEARBY_FRAME_TRACE environment variable, as written by
+// FrameTrace::ToString() from a capture with kEnableFrameTraceCapture. The
+// BM_Replay*Pattern benchmarks replay synthetic traces of traffic patterns
+// that have caused trouble before.
+//
+// The link argument is 0 for an ideal link, or 1 for a typical link of the
+// medium most frames of the trace were captured on.
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "connections/implementation/frame_trace.h"
+#include "connections/implementation/frame_trace_replayer.h"
+#include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "internal/platform/medium_environment.h"
+#include "proto/connections_enums.pb.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+using ::location::nearby::connections::V1Frame;
+using ::location::nearby::proto::connections::Medium;
+
+constexpr char kTraceEnvironmentVariable[] = "NEARBY_FRAME_TRACE";
+
+LinkModel GetTypicalLink(Medium medium) {
+  switch (medium) {
+    case Medium::BLUETOOTH:
+      return {.bandwidth_bytes_per_second = 200 * 1024,
+              .round_trip_time = absl::Milliseconds(40),
+              .jitter = absl::Milliseconds(10)};
+    case Medium::BLE:
+    case Medium::BLE_L2CAP:
+      return {.bandwidth_bytes_per_second = 30 * 1024,
+              .round_trip_time = absl::Milliseconds(60),
+              .jitter = absl::Milliseconds(15)};
+    default:
+      return {.bandwidth_bytes_per_second = 10 * 1024 * 1024,
+              .round_trip_time = absl::Milliseconds(5),
+              .jitter = absl::Milliseconds(2),
+              .loss_probability = 0.001};
+  }
+}
+
+Medium GetMostUsedMedium(const FrameTrace& trace) {
+  absl::flat_hash_map<Medium, int> frames;
+  Medium most_used = Medium::WIFI_LAN;
+  int most_frames = 0;
+  for (const FrameTrace::Frame& frame : trace.frames) {
+    if (++frames[frame.medium] > most_frames) {
+      most_used = frame.medium;
+      most_frames = frames[frame.medium];
+    }
+  }
+  return most_used;
+}
+
+void AddFrame(FrameTrace& trace, absl::Duration time,
+              FrameTrace::Direction direction, V1Frame::FrameType frame_type,
+              std::int64_t size) {
+  trace.frames.push_back({.time = time,
+                          .direction = direction,
+                          .endpoint_id = "ABCD",
+                          .medium = Medium::WIFI_LAN,
+                          .frame_type = frame_type,
+                          .size = size});
+}
+
+// Bursts of 32 KB file chunks with an ack coming back for every chunk, as a
+// file transfer that keeps stalling on a congested link.
+FrameTrace MakeBurstyFilePattern() {
+  FrameTrace trace;
+  for (int burst = 0; burst < 20; ++burst) {
+    absl::Duration burst_start = burst * absl::Milliseconds(100);
+    for (int chunk = 0; chunk < 25; ++chunk) {
+      absl::Duration time = burst_start + chunk * absl::Microseconds(200);
+      AddFrame(trace, time, FrameTrace::Direction::kOutgoing,
+               V1Frame::PAYLOAD_TRANSFER, 32 * 1024);
+      AddFrame(trace, time + absl::Microseconds(100),
+               FrameTrace::Direction::kIncoming, V1Frame::PAYLOAD_TRANSFER,
+               40);
+    }
+  }
+  return trace;
+}
+
+// Small frames in both directions every millisecond, as a chatty client
+// sending tiny BYTES payloads back and forth.
+FrameTrace MakeSmallFramesPattern() {
+  FrameTrace trace;
+  for (int i = 0; i < 2000; ++i) {
+    AddFrame(trace, i * absl::Milliseconds(1),
+             i % 2 == 0 ? FrameTrace::Direction::kOutgoing
+                        : FrameTrace::Direction::kIncoming,
+             V1Frame::PAYLOAD_TRANSFER, 64 + i % 64);
+  }
+  return trace;
+}
+
+// Keep-alives stuck behind 1 MB chunks, as a large transfer over a slow
+// medium that risks timing out the connection.
+FrameTrace MakeLargeChunksPattern() {
+  FrameTrace trace;
+  for (int i = 0; i < 16; ++i) {
+    absl::Duration time = i * absl::Milliseconds(50);
+    AddFrame(trace, time, FrameTrace::Direction::kOutgoing,
+             V1Frame::PAYLOAD_TRANSFER, 1000 * 1000);
+    AddFrame(trace, time + absl::Milliseconds(1),
+             FrameTrace::Direction::kOutgoing, V1Frame::KEEP_ALIVE, 4);
+    AddFrame(trace, time + absl::Milliseconds(2),
+             FrameTrace::Direction::kIncoming, V1Frame::KEEP_ALIVE, 4);
+  }
+  return trace;
+}
+
+void ReplayTrace(benchmark::State& state, const FrameTrace& trace) {
+  EnvironmentConfig config;
+  config.use_simulated_clock = true;
+  if (state.range(0) != 0) {
+    config.link_models[Medium::WIFI_LAN] =
+        GetTypicalLink(GetMostUsedMedium(trace));
+  }
+  MediumEnvironment& env = MediumEnvironment::Instance();
+  env.Start(std::move(config));
+  std::int64_t bytes = 0;
+  FrameTraceReplayer::Result result;
+  for (auto _ : state) {
+    std::optional<FrameTraceReplayer::Result> replayed =
+        FrameTraceReplayer::Replay(trace);
+    if (!replayed.has_value()) {
+      state.SkipWithError("Replay did not complete.");
+      break;
+    }
+    result = *replayed;
+    bytes += result.bytes;
+    state.SetIterationTime(absl::ToDoubleSeconds(result.wall_time));
+  }
+  env.Stop();
+  state.SetBytesProcessed(bytes);
+  state.counters["frames"] = result.frames;
+  state.counters["write_p50_us"] =
+      absl::ToDoubleMicroseconds(result.local.write_latency_p50);
+  state.counters["write_p99_us"] =
+      absl::ToDoubleMicroseconds(result.local.write_latency_p99);
+}
+
+void BM_ReplayCapturedTrace(benchmark::State& state) {
+  const char* path = std::getenv(kTraceEnvironmentVariable);
+  if (path == nullptr) {
+    state.SkipWithError(
+        absl::StrCat("Set ", kTraceEnvironmentVariable, " to a trace file.")
+            .c_str());
+    return;
+  }
+  std::ifstream file(path);
+  std::stringstream text;
+  text << file.rdbuf();
+  std::optional<FrameTrace> trace = FrameTrace::FromString(text.str());
+  if (!file || !trace.has_value()) {
+    state.SkipWithError(absl::StrCat("Failed to read trace ", path).c_str());
+    return;
+  }
+  ReplayTrace(state, *trace);
+}
+
+void BM_ReplayBurstyFilePattern(benchmark::State& state) {
+  ReplayTrace(state, MakeBurstyFilePattern());
+}
+
+void BM_ReplaySmallFramesPattern(benchmark::State& state) {
+  ReplayTrace(state, MakeSmallFramesPattern());
+}
+
+void BM_ReplayLargeChunksPattern(benchmark::State& state) {
+  ReplayTrace(state, MakeLargeChunksPattern());
+}
+
+BENCHMARK(BM_ReplayCapturedTrace)
+    ->ArgName("link")
+    ->Arg(0)
+    ->Arg(1)
+    ->UseManualTime();
+BENCHMARK(BM_ReplayBurstyFilePattern)
+    ->ArgName("link")
+    ->Arg(0)
+    ->Arg(1)
+    ->UseManualTime();
+BENCHMARK(BM_ReplaySmallFramesPattern)
+    ->ArgName("link")
+    ->Arg(0)
+    ->Arg(1)
+    ->UseManualTime();
+BENCHMARK(BM_ReplayLargeChunksPattern)
+    ->ArgName("link")
+    ->Arg(0)
+    ->Arg(1)
+    ->UseManualTime();
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,280 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Micro-benchmarks for the per-frame work of the offline frames parser.
+//
+// The BM_*Frame benchmarks run over every frame type the parser can build,
+// see kFrames for the frame indices. The BM_DataPayload* benchmarks cover
+// PAYLOAD_TRANSFER data frames with chunk bodies of 1 byte up to 1 MB, which
+// is where serialization and parsing scale with the payload.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "google/protobuf/arena.h"
+#include "connections/connection_options.h"
+#include "connections/implementation/offline_frames.h"
+#include "connections/implementation/offline_frames_validator.h"
+#include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "proto/connections_enums.pb.h"
+
+namespace nearby {
+namespace connections {
+namespace parser {
+namespace {
+
+using ::location::nearby::connections::LocationHint;
+using ::location::nearby::connections::OfflineFrame;
+using ::location::nearby::connections::OsInfo;
+using ::location::nearby::connections::PayloadTransferFrame;
+
+constexpr std::int64_t kMaxPayloadChunkSize = 1 << 20;
+
+PayloadTransferFrame::PayloadHeader MakeHeader(std::int64_t total_size) {
+  PayloadTransferFrame::PayloadHeader header;
+  header.set_id(1234567890);
+  header.set_type(PayloadTransferFrame::PayloadHeader::BYTES);
+  header.set_total_size(total_size);
+  return header;
+}
+
+ByteArray MakeDataFrame(std::int64_t body_size) {
+  PayloadTransferFrame::PayloadChunk chunk;
+  chunk.set_offset(0);
+  chunk.set_flags(0);
+  chunk.set_body(std::string(body_size, 'd'));
+  return ForDataPayloadTransfer(MakeHeader(body_size), chunk);
+}
+
+ByteArray MakeConnectionRequest() {
+  return ForConnectionRequest(ConnectionInfo{
+      .local_endpoint_id = "ABCD",
+      .local_endpoint_info = ByteArray(std::string("endpoint info")),
+      .nonce = 1234,
+      .supports_5_ghz = true,
+      .bssid = "FF:FF:FF:FF:FF:FF",
+      .ap_frequency = 2412,
+      .ip_address = "8xqT",
+      .supported_mediums = {location::nearby::proto::connections::BLUETOOTH,
+                            location::nearby::proto::connections::WIFI_LAN},
+      .keep_alive_interval_millis = 5000,
+      .keep_alive_timeout_millis = 30000,
+  });
+}
+
+ByteArray MakeConnectionResponse() {
+  OsInfo os_info;
+  os_info.set_type(OsInfo::LINUX);
+  return ForConnectionResponse(0, os_info);
+}
+
+ByteArray MakeControlFrame() {
+  PayloadTransferFrame::ControlMessage control;
+  control.set_event(PayloadTransferFrame::ControlMessage::PAYLOAD_CANCELED);
+  control.set_offset(4096);
+  return ForControlPayloadTransfer(MakeHeader(8192), control);
+}
+
+ByteArray MakeBytesPayloadBatch() {
+  std::vector<PayloadTransferFrame::BytesPayload> payloads(8);
+  for (auto& payload : payloads) {
+    *payload.mutable_payload_header() = MakeHeader(64);
+    payload.set_body(std::string(64, 'b'));
+  }
+  return ForBytesPayloadBatch(std::move(payloads));
+}
+
+ByteArray MakeWebrtcPathAvailable() {
+  LocationHint location_hint;
+  location_hint.set_location("US");
+  location_hint.set_format(
+      location::nearby::connections::LocationStandard::ISO_3166_1_ALPHA_2);
+  return ForBwuWebrtcPathAvailable("peer-id", location_hint);
+}
+
+ByteArray MakeBwuFailure() {
+  UpgradePathInfo info;
+  info.set_medium(UpgradePathInfo::WIFI_LAN);
+  return ForBwuFailure(info);
+}
+
+struct FrameCase {
+  const char* name;
+  ByteArray (*make)();
+};
+
+const FrameCase kFrames[] = {
+    {"connection_request", MakeConnectionRequest},
+    {"connection_response", MakeConnectionResponse},
+    {"session_resumption",
+     []() { return ForSessionResumption(ByteArray(std::string(32, 'n'))); }},
+    {"data_payload", []() { return MakeDataFrame(1024); }},
+    {"control_payload", MakeControlFrame},
+    {"bytes_payload_batch", MakeBytesPayloadBatch},
+    {"bwu_introduction", []() { return ForBwuIntroduction("ABCD", false); }},
+    {"bwu_introduction_ack", ForBwuIntroductionAck},
+    {"bwu_wifi_hotspot",
+     []() {
+       return ForBwuWifiHotspotPathAvailable("ssid", "password", 1234,
+                                             "0.0.0.0", false);
+     }},
+    {"bwu_wifi_lan",
+     []() {
+       return ForBwuWifiLanPathAvailable(std::string("\x0a\x00\x00\x01", 4),
+                                         1234);
+     }},
+    {"bwu_wifi_aware",
+     []() {
+       return ForBwuWifiAwarePathAvailable("service-id", "service-info",
+                                           "password", false);
+     }},
+    {"bwu_wifi_direct",
+     []() {
+       return ForBwuWifiDirectPathAvailable("DIRECT-ssid", "password", 1234,
+                                            2412, false, "0.0.0.0");
+     }},
+    {"bwu_bluetooth",
+     []() {
+       return ForBwuBluetoothPathAvailable("service-id", "11:22:33:44:55:66");
+     }},
+    {"bwu_webrtc", MakeWebrtcPathAvailable},
+    {"bwu_failure", MakeBwuFailure},
+    {"bwu_last_write", ForBwuLastWrite},
+    {"bwu_safe_to_close", ForBwuSafeToClose},
+    {"keep_alive", ForKeepAlive},
+    {"disconnection", ForDisconnection},
+};
+
+constexpr int kFrameCount = sizeof(kFrames) / sizeof(kFrames[0]);
+
+void BM_SerializeFrame(benchmark::State& state) {
+  const FrameCase& frame = kFrames[state.range(0)];
+  state.SetLabel(frame.name);
+  for (auto _ : state) {
+    ByteArray bytes = frame.make();
+    benchmark::DoNotOptimize(bytes.data());
+  }
+}
+
+void BM_ParseFrame(benchmark::State& state) {
+  const FrameCase& frame = kFrames[state.range(0)];
+  const ByteArray bytes = frame.make();
+  state.SetLabel(frame.name);
+  for (auto _ : state) {
+    ExceptionOr<OfflineFrame> parsed = FromBytes(bytes);
+    benchmark::DoNotOptimize(parsed.ok());
+  }
+  state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+void BM_ParseFrameOnArena(benchmark::State& state) {
+  const FrameCase& frame = kFrames[state.range(0)];
+  const ByteArray bytes = frame.make();
+  google::protobuf::Arena arena;
+  state.SetLabel(frame.name);
+  for (auto _ : state) {
+    ExceptionOr<OfflineFrame*> parsed = FromBytes(bytes, &arena);
+    benchmark::DoNotOptimize(parsed.ok());
+    arena.Reset();
+  }
+  state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+void BM_PeekFrameType(benchmark::State& state) {
+  const FrameCase& frame = kFrames[state.range(0)];
+  const ByteArray bytes = frame.make();
+  state.SetLabel(frame.name);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(PeekFrameType(bytes));
+  }
+}
+
+void BM_ValidateFrame(benchmark::State& state) {
+  const FrameCase& frame = kFrames[state.range(0)];
+  ExceptionOr<OfflineFrame> parsed = FromBytes(frame.make());
+  if (!parsed.ok()) {
+    state.SkipWithError("Failed to parse frame.");
+    return;
+  }
+  const OfflineFrame offline_frame = parsed.result();
+  state.SetLabel(frame.name);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(EnsureValidOfflineFrame(offline_frame).value);
+  }
+}
+
+void BM_DataPayloadSerialize(benchmark::State& state) {
+  const std::int64_t size = state.range(0);
+  const PayloadTransferFrame::PayloadHeader header = MakeHeader(size);
+  PayloadTransferFrame::PayloadChunk chunk;
+  chunk.set_body(std::string(size, 'd'));
+  for (auto _ : state) {
+    ByteArray bytes = ForDataPayloadTransfer(header, chunk);
+    benchmark::DoNotOptimize(bytes.data());
+  }
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+// Parses on the heap (arena = 0) or on a reused arena (arena = 1), then
+// validates, i.e. the full per-frame work on the receiving side.
+void BM_DataPayloadParseAndValidate(benchmark::State& state) {
+  const std::int64_t size = state.range(0);
+  const bool use_arena = state.range(1) != 0;
+  const ByteArray bytes = MakeDataFrame(size);
+  google::protobuf::Arena arena;
+  for (auto _ : state) {
+    if (use_arena) {
+      ExceptionOr<OfflineFrame*> parsed = FromBytes(bytes, &arena);
+      if (!parsed.ok() || !EnsureValidOfflineFrame(*parsed.result()).Ok()) {
+        state.SkipWithError("Invalid frame.");
+        break;
+      }
+      arena.Reset();
+    } else {
+      ExceptionOr<OfflineFrame> parsed = FromBytes(bytes);
+      if (!parsed.ok() || !EnsureValidOfflineFrame(parsed.result()).Ok()) {
+        state.SkipWithError("Invalid frame.");
+        break;
+      }
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+BENCHMARK(BM_SerializeFrame)->ArgName("frame")->DenseRange(0, kFrameCount - 1);
+BENCHMARK(BM_ParseFrame)->ArgName("frame")->DenseRange(0, kFrameCount - 1);
+BENCHMARK(BM_ParseFrameOnArena)
+    ->ArgName("frame")
+    ->DenseRange(0, kFrameCount - 1);
+BENCHMARK(BM_PeekFrameType)->ArgName("frame")->DenseRange(0, kFrameCount - 1);
+BENCHMARK(BM_ValidateFrame)->ArgName("frame")->DenseRange(0, kFrameCount - 1);
+
+BENCHMARK(BM_DataPayloadSerialize)
+    ->ArgName("size")
+    ->RangeMultiplier(8)
+    ->Range(1, kMaxPayloadChunkSize);
+BENCHMARK(BM_DataPayloadParseAndValidate)
+    ->ArgNames({"size", "arena"})
+    ->ArgsProduct({benchmark::CreateRange(1, kMaxPayloadChunkSize,
+                                          /*multi=*/8),
+                   {0, 1}});
+
+}  // namespace
+}  // namespace parser
+}  // namespace connections
+}  // namespace nearby
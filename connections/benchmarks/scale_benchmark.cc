@@ -0,0 +1,436 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Scale benchmark with many simulated devices in one process.
+//
+// Every iteration creates a hub and N - 1 spokes in MediumEnvironment. All
+// spokes discover and connect to the hub at once (a connect storm), then each
+// spoke sends a payload to the hub while the hub sends one to every spoke.
+// Wall time per iteration spans both phases.
+//
+// Reported counters:
+//  - threads_per_endpoint, rss_kb_per_endpoint: growth of the process over
+//    its baseline once everything is connected, divided by N.
+//  - cpu_ms_per_endpoint: process CPU time of both phases, divided by N.
+//  - <callback>_p50_ms, _p90_ms, _p99_ms, _max_ms: latency from the call that
+//    triggers each callback until it runs, for endpoint_found_cb,
+//    initiated_cb, accepted_cb and the final payload_progress_cb.
+//
+// Arguments are {devices, strategy, clock}: strategy 0 is P2P_STAR and 1 is
+// P2P_CLUSTER; clock 1 installs the simulated clock. Devices connect over
+// WiFi LAN.
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/strip.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "connections/advertising_options.h"
+#include "connections/connection_options.h"
+#include "connections/discovery_options.h"
+#include "connections/implementation/client_proxy.h"
+#include "connections/implementation/offline_service_controller.h"
+#include "connections/listeners.h"
+#include "connections/medium_selector.h"
+#include "connections/payload.h"
+#include "connections/strategy.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/count_down_latch.h"
+#include "internal/platform/feature_flags.h"
+#include "internal/platform/medium_environment.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+constexpr absl::string_view kServiceId = "scale-benchmark-service-id";
+constexpr absl::Duration kStormTimeout = absl::Seconds(60);
+constexpr std::int64_t kPayloadSize = 4 * 1024;
+const BooleanMediumSelector kAllowed{.wifi_lan = true};
+
+// Latency samples of one callback, in milliseconds.
+class LatencyStats {
+ public:
+  void Record(absl::Duration latency) {
+    absl::MutexLock lock(&mutex_);
+    samples_.push_back(absl::ToDoubleMilliseconds(latency));
+  }
+
+  void Report(benchmark::State& state, absl::string_view name) {
+    absl::MutexLock lock(&mutex_);
+    if (samples_.empty()) return;
+    std::vector<double>& sorted = samples_;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](double p) {
+      return sorted[static_cast<size_t>(p * (sorted.size() - 1))];
+    };
+    state.counters[absl::StrCat(name, "_p50_ms")] = percentile(0.5);
+    state.counters[absl::StrCat(name, "_p90_ms")] = percentile(0.9);
+    state.counters[absl::StrCat(name, "_p99_ms")] = percentile(0.99);
+    state.counters[absl::StrCat(name, "_max_ms")] = sorted.back();
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<double> samples_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Callback latencies shared by all devices of a run. Times are real time, so
+// they stay meaningful with the simulated clock installed.
+struct Stats {
+  LatencyStats found;
+  LatencyStats initiated;
+  LatencyStats accepted;
+  LatencyStats payload;
+
+  void PayloadSent(Payload::Id id) {
+    absl::MutexLock lock(&mutex);
+    sent[id] = absl::Now();
+  }
+
+  void PayloadReceived(Payload::Id id) {
+    absl::Time now = absl::Now();
+    absl::MutexLock lock(&mutex);
+    auto it = sent.find(id);
+    if (it != sent.end()) payload.Record(now - it->second);
+  }
+
+  absl::Mutex mutex;
+  absl::flat_hash_map<Payload::Id, absl::Time> sent ABSL_GUARDED_BY(mutex);
+};
+
+struct ProcessSample {
+  std::int64_t threads = 0;
+  std::int64_t rss_kb = 0;
+  absl::Duration cpu;
+};
+
+ProcessSample SampleProcess() {
+  ProcessSample sample;
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    absl::string_view value = line;
+    if (absl::ConsumePrefix(&value, "Threads:")) {
+      (void)absl::SimpleAtoi(value, &sample.threads);
+    } else if (absl::ConsumePrefix(&value, "VmRSS:")) {
+      absl::ConsumeSuffix(&value, "kB");
+      (void)absl::SimpleAtoi(value, &sample.rss_kb);
+    }
+  }
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    sample.cpu = absl::DurationFromTimeval(usage.ru_utime) +
+                 absl::DurationFromTimeval(usage.ru_stime);
+  }
+  return sample;
+}
+
+// A simulated device with its own ClientProxy and service controller, able
+// to handle any number of connections. Spokes connect to the hub with
+// ConnectToHub(); the hub accepts them with AcceptAll().
+class Device {
+ public:
+  Device(absl::string_view name, const Strategy& strategy, Stats& stats)
+      : info_(std::string(name)),
+        stats_(stats),
+        advertising_options_{{strategy, kAllowed}},
+        discovery_options_{{strategy, kAllowed}},
+        connection_options_{
+            .keep_alive_interval_millis = FeatureFlags::GetInstance()
+                                              .GetFlags()
+                                              .keep_alive_interval_millis,
+            .keep_alive_timeout_millis = FeatureFlags::GetInstance()
+                                             .GetFlags()
+                                             .keep_alive_timeout_millis,
+        } {}
+
+  ~Device() {
+    ctrl_.StopAdvertising(&client_);
+    ctrl_.StopDiscovery(&client_);
+    ctrl_.Stop();
+  }
+
+  bool StartAdvertising() {
+    return ctrl_
+        .StartAdvertising(&client_, std::string(kServiceId),
+                          advertising_options_,
+                          {.endpoint_info = info_, .listener = Listener()})
+        .Ok();
+  }
+
+  // Discovers the hub, connects to it and accepts the connection.
+  bool ConnectToHub() {
+    CountDownLatch found(1);
+    CountDownLatch initiated(1);
+    CountDownLatch accepted(1);
+    found_latch_ = &found;
+    initiated_latch_ = &initiated;
+    accepted_latch_ = &accepted;
+    DiscoveryListener listener = {
+        .endpoint_found_cb =
+            [this](const std::string& endpoint_id, const ByteArray&,
+                   const std::string&) {
+              if (!hub_id_.empty()) return;
+              stats_.found.Record(absl::Now() - discovery_start_);
+              hub_id_ = endpoint_id;
+              found_latch_->CountDown();
+            },
+    };
+    discovery_start_ = absl::Now();
+    if (!ctrl_.StartDiscovery(&client_, std::string(kServiceId),
+                              discovery_options_, std::move(listener))
+             .Ok() ||
+        !found.Await(kStormTimeout).result()) {
+      return false;
+    }
+    ctrl_.StopDiscovery(&client_);
+
+    client_.AddCancellationFlag(hub_id_);
+    request_start_ = absl::Now();
+    if (!ctrl_.RequestConnection(&client_, hub_id_,
+                                 {.endpoint_info = info_,
+                                  .listener = Listener()},
+                                 connection_options_)
+             .Ok() ||
+        !initiated.Await(kStormTimeout).result()) {
+      return false;
+    }
+    return Accept(hub_id_).Ok() && accepted.Await(kStormTimeout).result();
+  }
+
+  // Accepts incoming connections as they are initiated, until |count| of
+  // them have been accepted by both sides.
+  bool AcceptAll(int count) {
+    const absl::Time deadline = absl::Now() + kStormTimeout;
+    for (int i = 0; i < count; ++i) {
+      std::string endpoint_id;
+      {
+        absl::MutexLock lock(&mutex_);
+        if (!mutex_.AwaitWithDeadline(
+                absl::Condition(this, &Device::HasPendingLocked), deadline)) {
+          return false;
+        }
+        endpoint_id = std::move(pending_.front());
+        pending_.pop_front();
+      }
+      if (!Accept(endpoint_id).Ok()) return false;
+    }
+    absl::MutexLock lock(&mutex_);
+    accepted_target_ = count;
+    return mutex_.AwaitWithDeadline(
+        absl::Condition(this, &Device::AcceptedAllLocked), deadline);
+  }
+
+  // Sends one BYTES payload to all connected peers. Counts down |latch| for
+  // each payload this device receives in full.
+  void ExchangePayload(CountDownLatch* latch) {
+    std::vector<std::string> peers;
+    {
+      absl::MutexLock lock(&mutex_);
+      received_latch_ = latch;
+      peers = peers_;
+    }
+    Payload payload(ByteArray(std::string(kPayloadSize, 'p')));
+    stats_.PayloadSent(payload.GetId());
+    ctrl_.SendPayload(&client_, peers, std::move(payload));
+  }
+
+ private:
+  ConnectionListener Listener() {
+    return {
+        .initiated_cb =
+            [this](const std::string& endpoint_id,
+                   const ConnectionResponseInfo& info) {
+              if (!info.is_incoming_connection) {
+                stats_.initiated.Record(absl::Now() - request_start_);
+                initiated_latch_->CountDown();
+                return;
+              }
+              absl::MutexLock lock(&mutex_);
+              pending_.push_back(endpoint_id);
+            },
+        .accepted_cb =
+            [this](const std::string& endpoint_id) {
+              absl::Time now = absl::Now();
+              absl::MutexLock lock(&mutex_);
+              auto it = accept_start_.find(endpoint_id);
+              if (it != accept_start_.end()) {
+                stats_.accepted.Record(now - it->second);
+              }
+              peers_.push_back(endpoint_id);
+              if (accepted_latch_ != nullptr) accepted_latch_->CountDown();
+            },
+    };
+  }
+
+  Status Accept(const std::string& endpoint_id) {
+    {
+      absl::MutexLock lock(&mutex_);
+      accept_start_[endpoint_id] = absl::Now();
+    }
+    PayloadListener listener = {
+        .payload_cb =
+            [this](absl::string_view, Payload payload) {
+              absl::MutexLock lock(&mutex_);
+              incoming_.push_back(payload.GetId());
+            },
+        .payload_progress_cb =
+            [this](absl::string_view, const PayloadProgressInfo& info) {
+              if (info.status != PayloadProgressInfo::Status::kSuccess) return;
+              absl::MutexLock lock(&mutex_);
+              if (std::find(incoming_.begin(), incoming_.end(),
+                            info.payload_id) == incoming_.end()) {
+                return;
+              }
+              stats_.PayloadReceived(info.payload_id);
+              if (received_latch_ != nullptr) received_latch_->CountDown();
+            },
+    };
+    return ctrl_.AcceptConnection(&client_, endpoint_id, std::move(listener));
+  }
+
+  bool HasPendingLocked() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return !pending_.empty();
+  }
+  bool AcceptedAllLocked() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return static_cast<int>(peers_.size()) >= accepted_target_;
+  }
+
+  const ByteArray info_;
+  Stats& stats_;
+  const AdvertisingOptions advertising_options_;
+  const DiscoveryOptions discovery_options_;
+  const ConnectionOptions connection_options_;
+
+  // Spoke state, only used by ConnectToHub() and the callbacks it awaits.
+  std::string hub_id_;
+  absl::Time discovery_start_;
+  absl::Time request_start_;
+  CountDownLatch* found_latch_ = nullptr;
+  CountDownLatch* initiated_latch_ = nullptr;
+  CountDownLatch* accepted_latch_ = nullptr;
+
+  absl::Mutex mutex_;
+  std::deque<std::string> pending_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, absl::Time> accept_start_
+      ABSL_GUARDED_BY(mutex_);
+  std::vector<std::string> peers_ ABSL_GUARDED_BY(mutex_);
+  int accepted_target_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::vector<Payload::Id> incoming_ ABSL_GUARDED_BY(mutex_);
+  CountDownLatch* received_latch_ ABSL_GUARDED_BY(mutex_) = nullptr;
+
+  ClientProxy client_;
+  OfflineServiceController ctrl_;
+};
+
+void BM_ConnectStormAndPayloads(benchmark::State& state) {
+  const int devices = static_cast<int>(state.range(0));
+  const int spokes = devices - 1;
+  const Strategy& strategy =
+      state.range(1) == 0 ? Strategy::kP2pStar : Strategy::kP2pCluster;
+  MediumEnvironment& env = MediumEnvironment::Instance();
+  Stats stats;
+  double threads = 0;
+  double rss_kb = 0;
+  double cpu_ms = 0;
+  state.SetLabel(state.range(1) == 0 ? "p2p_star" : "p2p_cluster");
+  for (auto _ : state) {
+    state.PauseTiming();
+    const ProcessSample baseline = SampleProcess();
+    env.Start({.use_simulated_clock = state.range(2) != 0});
+    auto hub = std::make_unique<Device>("hub", strategy, stats);
+    std::vector<std::unique_ptr<Device>> spoke_devices;
+    for (int i = 0; i < spokes; ++i) {
+      spoke_devices.push_back(std::make_unique<Device>(
+          absl::StrCat("spoke-", i), strategy, stats));
+    }
+    bool ok = hub->StartAdvertising();
+    const ProcessSample start = SampleProcess();
+    state.ResumeTiming();
+
+    std::atomic<int> connected{0};
+    std::vector<std::thread> workers;
+    workers.reserve(spokes);
+    for (auto& spoke : spoke_devices) {
+      workers.emplace_back([&spoke, &connected]() {
+        if (spoke->ConnectToHub()) connected++;
+      });
+    }
+    ok = hub->AcceptAll(spokes) && ok;
+    for (auto& worker : workers) worker.join();
+    ok = ok && connected == spokes;
+    const ProcessSample after_connect = SampleProcess();
+
+    if (ok) {
+      CountDownLatch received(2 * spokes);
+      for (auto& spoke : spoke_devices) spoke->ExchangePayload(&received);
+      hub->ExchangePayload(&received);
+      ok = received.Await(kStormTimeout).result();
+    }
+
+    state.PauseTiming();
+    const ProcessSample done = SampleProcess();
+    threads += static_cast<double>(after_connect.threads - baseline.threads) /
+               devices;
+    rss_kb += static_cast<double>(after_connect.rss_kb - baseline.rss_kb) /
+              devices;
+    cpu_ms += absl::ToDoubleMilliseconds(done.cpu - start.cpu) / devices;
+    spoke_devices.clear();
+    hub.reset();
+    env.Stop();
+    state.ResumeTiming();
+    if (!ok) {
+      state.SkipWithError("Connect storm or payload exchange timed out.");
+      break;
+    }
+  }
+  auto avg = [](double value) {
+    return benchmark::Counter(value, benchmark::Counter::kAvgIterations);
+  };
+  state.counters["threads_per_endpoint"] = avg(threads);
+  state.counters["rss_kb_per_endpoint"] = avg(rss_kb);
+  state.counters["cpu_ms_per_endpoint"] = avg(cpu_ms);
+  stats.found.Report(state, "found");
+  stats.initiated.Report(state, "initiated");
+  stats.accepted.Report(state, "accepted");
+  stats.payload.Report(state, "payload");
+}
+
+BENCHMARK(BM_ConnectStormAndPayloads)
+    ->ArgNames({"devices", "strategy", "clock"})
+    ->ArgsProduct({{16, 64, 128}, {0, 1}, {0, 1}})
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
@@ -14,6 +14,10 @@
 
 #include "connections/c/core_adapter.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
 #include "absl/strings/str_format.h"
 #include "connections/core.h"
 #include "internal/platform/bluetooth_utils.h"
@@ -246,6 +250,23 @@ void CancelPayload(connections::Core *pCore, std::int64_t payload_id,
   pCore->CancelPayload(payload_id, *callback.GetImpl());
 }
 
+size_t ReadPayloadProgressEvents(PayloadProgressRingW *ring,
+                                 PayloadProgressEventW *events,
+                                 size_t max_events) {
+  if (ring == nullptr || ring->capacity == 0 || events == nullptr) {
+    return 0;
+  }
+  uint64_t read_index = ring->read_index.load(std::memory_order_relaxed);
+  uint64_t write_index = ring->write_index.load(std::memory_order_acquire);
+  size_t count = std::min<uint64_t>(write_index - read_index, max_events);
+  for (size_t i = 0; i < count; ++i) {
+    events[i] = ring->events[(read_index + i) % ring->capacity];
+  }
+  // Hands the slots back to the writer.
+  ring->read_index.store(read_index + count, std::memory_order_release);
+  return count;
+}
+
 void DisconnectFromEndpoint(connections::Core *pCore, const char *endpoint_id,
                             ResultCallbackW callback) {
   if (pCore == nullptr) {
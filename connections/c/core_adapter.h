@@ -213,6 +213,17 @@ DLL_API void __stdcall SendPayload(Core*, const char**, size_t, PayloadW,
 //     Status::STATUS_OK if none of the above errors occurred.
 DLL_API void __stdcall CancelPayload(Core*, int64_t, ResultCallbackW);
 
+// Copies up to |max_events| of the payload progress events not read yet from
+// a ring given to a PayloadListenerW, oldest first, and frees their slots.
+//
+// ring       - The ring to read from.
+// events     - Where to copy the events to.
+// max_events - How many events fit into |events|.
+// Returns the number of events copied.
+DLL_API size_t __stdcall ReadPayloadProgressEvents(PayloadProgressRingW*,
+                                                   PayloadProgressEventW*,
+                                                   size_t);
+
 // Disconnects from a remote endpoint. {@link Payload}s can no longer be sent
 // to or received from the endpoint after this method is called.
 //
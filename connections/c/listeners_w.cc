@@ -14,7 +14,16 @@
 
 #include "connections/c/listeners_w.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "absl/strings/string_view.h"
 #include "connections/listeners.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/mutex_lock.h"
 
 namespace nearby {
 // Must implement Deleters, since the connections classes weren't
@@ -38,6 +47,33 @@ namespace windows {
 
 static ResultCallbackW *ResultCallbackImpl;
 
+namespace {
+
+// Returns false if |ring| is full.
+bool WritePayloadProgressEvent(PayloadProgressRingW &ring,
+                               absl::string_view endpoint_id,
+                               const PayloadProgressInfoW &info) {
+  if (ring.events == nullptr || ring.capacity == 0) {
+    return false;
+  }
+  uint64_t write_index = ring.write_index.load(std::memory_order_relaxed);
+  if (write_index - ring.read_index.load(std::memory_order_acquire) >=
+      ring.capacity) {
+    return false;
+  }
+  PayloadProgressEventW &event = ring.events[write_index % ring.capacity];
+  size_t endpoint_id_size =
+      std::min(endpoint_id.size(), sizeof(event.endpoint_id) - 1);
+  std::memcpy(event.endpoint_id, endpoint_id.data(), endpoint_id_size);
+  event.endpoint_id[endpoint_id_size] = '\0';
+  event.info = info;
+  // Publishes the event to the reader.
+  ring.write_index.store(write_index + 1, std::memory_order_release);
+  return true;
+}
+
+}  // namespace
+
 void ResultCB(Status status) { ResultCallbackImpl->result_cb(status); }
 
 ResultCallbackW::ResultCallbackW()
@@ -186,6 +222,12 @@ DiscoveryListenerW::DiscoveryListenerW(DiscoveryListenerW &&other) noexcept {
 
 PayloadListenerW::PayloadListenerW(PayloadCB payloadCB,
                                    PayloadProgressCB payloadProgressCB)
+    : PayloadListenerW(payloadCB, payloadProgressCB,
+                       /*progress_ring=*/nullptr) {}
+
+PayloadListenerW::PayloadListenerW(PayloadCB payloadCB,
+                                   PayloadProgressCB payloadProgressCB,
+                                   PayloadProgressRingW *progress_ring)
     : payload_cb(payloadCB),
       payload_progress_cb(payloadProgressCB),
       impl_(std::unique_ptr<connections::PayloadListener,
@@ -199,8 +241,8 @@ PayloadListenerW::PayloadListenerW(PayloadCB payloadCB,
 
     switch (payload.GetType()) {
       case connections::PayloadType::kBytes: {
-        payloadW = PayloadW(payload.GetId(), payload.AsBytes().data(),
-                            payload.AsBytes().size());
+        payloadW = PayloadW(payload.GetId(), payload.AsBytesView().data(),
+                            payload.AsBytesView().size());
         break;
       }
       case connections::PayloadType::kFile: {
@@ -216,6 +258,8 @@ PayloadListenerW::PayloadListenerW(PayloadCB payloadCB,
         InputFileW file(std::move(payload.AsFile()));
         payloadW = PayloadW(payload.GetId(), std::move(file));
       } break;
+      // Batch payloads aren't exposed through the C API yet.
+      case connections::PayloadType::kFileBatch:
       case connections::PayloadType::kUnknown: {
         // Throw exception here?
         break;
@@ -226,9 +270,12 @@ PayloadListenerW::PayloadListenerW(PayloadCB payloadCB,
 
   CHECK(payload_progress_cb != nullptr);
   auto ppcb = payload_progress_cb;
+  // Serializes the writers of |progress_ring|.
+  auto ring_mutex = std::make_shared<Mutex>();
   impl_->payload_progress_cb =
-      [ppcb](absl::string_view endpoint_id,
-             connections::PayloadProgressInfo payload_progress_info) {
+      [ppcb, progress_ring, ring_mutex](
+          absl::string_view endpoint_id,
+          connections::PayloadProgressInfo payload_progress_info) {
         PayloadProgressInfoW payload_progress_info_w;
         payload_progress_info_w.payload_id = payload_progress_info.payload_id;
         payload_progress_info_w.total_bytes = payload_progress_info.total_bytes;
@@ -254,6 +301,13 @@ PayloadListenerW::PayloadListenerW(PayloadCB payloadCB,
             break;
         }
 
+        if (progress_ring != nullptr) {
+          MutexLock lock(ring_mutex.get());
+          if (WritePayloadProgressEvent(*progress_ring, endpoint_id,
+                                        payload_progress_info_w)) {
+            return;
+          }
+        }
         ppcb(std::string(endpoint_id).c_str(), payload_progress_info_w);
       };
 }
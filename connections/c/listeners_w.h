@@ -15,6 +15,7 @@
 #ifndef THIRD_PARTY_NEARBY_CONNECTIONS_C_LISTENERS_W_H_
 #define THIRD_PARTY_NEARBY_CONNECTIONS_C_LISTENERS_W_H_
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -126,6 +127,30 @@ struct DLL_API PayloadProgressInfoW {
   size_t bytes_transferred = 0;
 };
 
+struct DLL_API PayloadProgressEventW {
+  // Null-terminated.
+  char endpoint_id[16];
+  PayloadProgressInfoW info;
+};
+
+// A ring buffer of payload progress events, in memory owned by the host, which
+// it drains in batches with ReadPayloadProgressEvents() instead of getting a
+// callback per event. There's no locking between Nearby Connections writing
+// the events and the host reading them.
+//
+// The ring, and its events, must stay valid for as long as the payload
+// listener it was given to may be called, i.e. until the endpoint is
+// disconnected.
+struct DLL_API PayloadProgressRingW {
+  // Slots for |capacity| events.
+  PayloadProgressEventW* events = nullptr;
+  uint32_t capacity = 0;
+  // Counts of events written and read so far. Only advanced by Nearby
+  // Connections, and by ReadPayloadProgressEvents(), respectively.
+  std::atomic<uint64_t> write_index = 0;
+  std::atomic<uint64_t> read_index = 0;
+};
+
 enum class DLL_API DistanceInfoW {
   kUnknown = 1,
   kVeryClose = 2,
@@ -259,6 +284,12 @@ struct DLL_API PayloadListenerW {
                                     const PayloadProgressInfoW& info);
 
   PayloadListenerW(PayloadCB, PayloadProgressCB);
+  // Writes progress into |progress_ring| instead of calling |progress_cb|.
+  // Progress that doesn't fit, since the host doesn't drain the ring fast
+  // enough, still goes to |progress_cb|, so that no event is lost. It may then
+  // overtake the events in the ring.
+  PayloadListenerW(PayloadCB, PayloadProgressCB progress_cb,
+                   PayloadProgressRingW* progress_ring);
   PayloadListenerW(PayloadListenerW& other);
   PayloadListenerW(PayloadListenerW&& other) noexcept;
 
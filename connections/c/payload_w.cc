@@ -13,6 +13,7 @@
 // limitations under the License.
 #include "connections/c/payload_w.h"
 
+#include "absl/strings/string_view.h"
 #include "connections/c/file_w.h"
 #include "connections/payload.h"
 #include "internal/platform/byte_array.h"
@@ -45,6 +46,13 @@ PayloadW::PayloadW(const char *bytes, const size_t bytes_size)
     : impl_(std::unique_ptr<connections::Payload, connections::PayloadDeleter>(
           new connections::Payload(ByteArray(bytes, bytes_size)))) {}
 
+PayloadW::PayloadW(const char *bytes, const size_t bytes_size,
+                   void (*release)(void *context), void *context)
+    : impl_(std::unique_ptr<connections::Payload, connections::PayloadDeleter>(
+          new connections::Payload(bytes, bytes_size, [release, context]() {
+            if (release != nullptr) release(context);
+          }))) {}
+
 PayloadW::PayloadW(InputFileW &file)
     : impl_(std::unique_ptr<connections::Payload, connections::PayloadDeleter>(
           new connections::Payload(InputFile(std::move(*file.GetImpl()))))) {}
@@ -75,27 +83,27 @@ PayloadW::PayloadW(PayloadId id, std::function<InputStream &()> stream)
 
 // Returns ByteArray payload, if it has been defined, or empty ByteArray.
 bool PayloadW::AsBytes(const char *&bytes, size_t &bytes_size) const & {
-  auto byteArray = impl_->AsBytes();
-  if (bytes_size < byteArray.size()) {
-    bytes_size = byteArray.size();
+  absl::string_view byte_view = impl_->AsBytesView();
+  if (bytes_size < byte_view.size()) {
+    bytes_size = byte_view.size();
     bytes = nullptr;
     return false;
   }
 
-  bytes_size = byteArray.size();
-  bytes = byteArray.data();
+  bytes_size = byte_view.size();
+  bytes = byte_view.data();
   return true;
 }
 bool PayloadW::AsBytes(const char *&bytes, size_t &bytes_size) && {
-  auto byteArray = impl_->AsBytes();
-  if (bytes_size < byteArray.size()) {
-    bytes_size = byteArray.size();
+  absl::string_view byte_view = impl_->AsBytesView();
+  if (bytes_size < byte_view.size()) {
+    bytes_size = byte_view.size();
     bytes = nullptr;
     return false;
   }
 
-  bytes_size = byteArray.size();
-  bytes = byteArray.data();
+  bytes_size = byte_view.size();
+  bytes = byte_view.data();
   return true;
 }
 // Returns InputStream* payload, if it has been defined, or nullptr.
@@ -61,6 +61,11 @@ class DLL_API PayloadW {
 
   // Constructors for outgoing payloads.
   explicit PayloadW(const char* bytes, const size_t size);
+  // Sends |size| bytes from a buffer the caller keeps owning, without copying
+  // it across the DLL boundary. The buffer must stay valid and unchanged until
+  // |release| is called with |context|, once the payload is done with it.
+  PayloadW(const char* bytes, const size_t size, void (*release)(void* context),
+           void* context);
 
   explicit PayloadW(InputFileW& file);
   explicit PayloadW(std::function<InputStream&()> stream);
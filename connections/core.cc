@@ -20,7 +20,9 @@
 
 #include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
+#include "absl/types/span.h"
 #include "connections/implementation/service_id_constants.h"
+#include "connections/implementation/transport_config.h"
 #include "connections/listeners.h"
 #include "connections/v3/bandwidth_info.h"
 #include "connections/v3/connection_result.h"
@@ -29,7 +31,6 @@
 #include "connections/v3/params.h"
 #include "internal/interop/device.h"
 #include "internal/platform/count_down_latch.h"
-#include "internal/platform/feature_flags.h"
 #include "internal/platform/logging.h"
 
 namespace nearby {
@@ -121,10 +122,11 @@ void Core::RequestConnection(absl::string_view endpoint_id,
         "timeout=%d, which is un-expected. Change to default.",
         connection_options.keep_alive_interval_millis,
         connection_options.keep_alive_timeout_millis);
+    TransportConfig transport_config = TransportConfig::Get();
     connection_options.keep_alive_interval_millis =
-        FeatureFlags::GetInstance().GetFlags().keep_alive_interval_millis;
+        transport_config.keep_alive_interval_millis;
     connection_options.keep_alive_timeout_millis =
-        FeatureFlags::GetInstance().GetFlags().keep_alive_timeout_millis;
+        transport_config.keep_alive_timeout_millis;
   }
 
   router_->RequestConnection(&client_, endpoint_id, info, connection_options,
@@ -139,6 +141,14 @@ void Core::AcceptConnection(absl::string_view endpoint_id,
                             callback);
 }
 
+void Core::AcceptConnections(
+    std::vector<std::pair<std::string, PayloadListener>> connections,
+    ResultCallback callback) {
+  CHECK(!connections.empty());
+
+  router_->AcceptConnections(&client_, std::move(connections), callback);
+}
+
 void Core::RejectConnection(absl::string_view endpoint_id,
                             ResultCallback callback) {
   CHECK(!endpoint_id.empty());
@@ -172,6 +182,13 @@ void Core::DisconnectFromEndpoint(absl::string_view endpoint_id,
   router_->DisconnectFromEndpoint(&client_, endpoint_id, callback);
 }
 
+void Core::DisconnectFromEndpoints(absl::Span<const std::string> endpoint_ids,
+                                   ResultCallback callback) {
+  CHECK(!endpoint_ids.empty());
+
+  router_->DisconnectFromEndpoints(&client_, endpoint_ids, callback);
+}
+
 void Core::StopAllEndpoints(ResultCallback callback) {
   router_->StopAllEndpoints(&client_, callback);
 }
@@ -180,7 +197,9 @@ void Core::SetCustomSavePath(absl::string_view path, ResultCallback callback) {
   router_->SetCustomSavePath(&client_, path, callback);
 }
 
-std::string Core::Dump() { return client_.Dump(); }
+std::string Core::Dump(const ClientProxy::DumpOptions& options) {
+  return client_.Dump(options);
+}
 
 // V3
 void Core::StartAdvertisingV3(absl::string_view service_id,
@@ -375,10 +394,11 @@ void Core::RequestConnectionV3(const NearbyDevice& local_device,
         "timeout=%d, which is un-expected. Change to default.",
         connection_options.keep_alive_interval_millis,
         connection_options.keep_alive_timeout_millis);
+    TransportConfig transport_config = TransportConfig::Get();
     connection_options.keep_alive_interval_millis =
-        FeatureFlags::GetInstance().GetFlags().keep_alive_interval_millis;
+        transport_config.keep_alive_interval_millis;
     connection_options.keep_alive_timeout_millis =
-        FeatureFlags::GetInstance().GetFlags().keep_alive_timeout_millis;
+        transport_config.keep_alive_timeout_millis;
   }
   router_->RequestConnectionV3(&client_, remote_device, std::move(info),
                                connection_options, result_cb);
@@ -406,10 +426,11 @@ void Core::RequestConnectionV3(const NearbyDevice& remote_device,
         "timeout=%d, which is un-expected. Change to default.",
         connection_options.keep_alive_interval_millis,
         connection_options.keep_alive_timeout_millis);
+    TransportConfig transport_config = TransportConfig::Get();
     connection_options.keep_alive_interval_millis =
-        FeatureFlags::GetInstance().GetFlags().keep_alive_interval_millis;
+        transport_config.keep_alive_interval_millis;
     connection_options.keep_alive_timeout_millis =
-        FeatureFlags::GetInstance().GetFlags().keep_alive_timeout_millis;
+        transport_config.keep_alive_timeout_millis;
   }
   router_->RequestConnectionV3(&client_, remote_device, std::move(info),
                                connection_options, result_cb);
@@ -15,14 +15,19 @@
 #ifndef CORE_CORE_H_
 #define CORE_CORE_H_
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "connections/connection_options.h"
 #include "connections/implementation/client_proxy.h"
+#include "connections/implementation/endpoint_stats.h"
+#include "connections/implementation/memory_accountant.h"
 #include "connections/implementation/service_controller.h"
 #include "connections/implementation/service_controller_router.h"
 #include "connections/listeners.h"
@@ -167,6 +172,14 @@ class Core {
   void AcceptConnection(absl::string_view endpoint_id, PayloadListener listener,
                         ResultCallback callback);
 
+  // Accepts connections to several remote endpoints at once, each with its own
+  // listener. Same as calling AcceptConnection() for each of them, except that
+  // |callback| is called once: with Status::STATUS_OK if every connection was
+  // accepted, or with the status of the first one that wasn't.
+  void AcceptConnections(
+      std::vector<std::pair<std::string, PayloadListener>> connections,
+      ResultCallback callback);
+
   // Rejects a connection to a remote endpoint.
   //
   // endpoint_id - The identifier for the remote endpoint. Should match the
@@ -219,6 +232,12 @@ class Core {
   void DisconnectFromEndpoint(absl::string_view endpoint_id,
                               ResultCallback callback);
 
+  // Disconnects from several remote endpoints at once. |callback| is called
+  // once: with Status::STATUS_OK if every endpoint was disconnected, or with
+  // the status of the first one that wasn't.
+  void DisconnectFromEndpoints(absl::Span<const std::string> endpoint_ids,
+                               ResultCallback callback);
+
   // Disconnects from, and removes all traces of, all connected and/or
   // discovered endpoints. This call is expected to be preceded by a call to
   // StopAdvertising or StartDiscovery as needed. After calling
@@ -250,7 +269,30 @@ class Core {
   // Gets the local endpoint generated by Nearby Connections.
   std::string GetLocalEndpointId() { return client_.GetLocalEndpointId(); }
 
-  std::string Dump();
+  // Gets the memory buffered for incoming data from a connected endpoint:
+  // frames being processed, STREAM payload chunks not read yet and FILE
+  // payload chunks not written yet. Once this reaches the cap set by
+  // kMaxBufferedBytesPerEndpoint, no further frames are read from the endpoint
+  // until it drops below it again.
+  MemoryAccountant::Usage GetMemoryUsage(absl::string_view endpoint_id) {
+    return client_.GetMemoryAccountant().GetEndpointUsage(
+        std::string(endpoint_id));
+  }
+
+  // Gets the memory buffered for an incoming payload, see GetMemoryUsage().
+  MemoryAccountant::Usage GetPayloadMemoryUsage(std::int64_t payload_id) {
+    return client_.GetMemoryAccountant().GetPayloadUsage(payload_id);
+  }
+
+  // Gets live transport statistics of a connected endpoint: its current
+  // medium, traffic and throughput, write latency and queue depth, and time
+  // spent on encryption. Statistics carry over bandwidth upgrades. Returns
+  // nullopt if the endpoint has no channel.
+  std::optional<EndpointStats> GetEndpointStats(absl::string_view endpoint_id) {
+    return client_.GetEndpointStats(std::string(endpoint_id));
+  }
+
+  std::string Dump(const ClientProxy::DumpOptions& options = {});
 
   //******************************* V3 *******************************
   // NOTE: Do NOT mix with the V1 APIs above, this might result in undefined
@@ -496,6 +538,13 @@ class Core {
   void InitiateBandwidthUpgradeV3(const NearbyDevice& remote_device,
                                   ResultCallback result_cb);
 
+  // Gets live transport statistics of a connected device, see
+  // GetEndpointStats().
+  std::optional<EndpointStats> GetEndpointStatsV3(
+      const NearbyDevice& remote_device) {
+    return client_.GetEndpointStats(remote_device.GetEndpointId());
+  }
+
   // Updates AdvertisingOptions. It compares the old AdvertisingOptions and the
   // new AdvertisingOptions to start/stop each advertising medium.
   //
@@ -16,8 +16,12 @@
 
 #include <cstdint>
 #include <string>
+#include <utility>
 
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
 #include "connections/core.h"
+#include "connections/dart/dart_callback_batcher.h"
 #include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/payload.h"
 #include "internal/flags/nearby_flags.h"
@@ -49,6 +53,11 @@ static DiscoveryListenerDart current_discovery_listener_dart;
 static ConnectionListenerDart current_connection_listener_dart;
 static PayloadListenerDart current_payload_listener_dart;
 
+static DartCallbackBatcher &GetCallbackBatcher() {
+  static DartCallbackBatcher *callback_batcher = new DartCallbackBatcher();
+  return *callback_batcher;
+}
+
 void ResultCB(Status status) {
   (void)status;  // Avoid unused parameter warning
   Dart_CObject dart_object_result_callback;
@@ -153,30 +162,14 @@ void ListenerEndpointFoundCB(const char *endpoint_id, const char *endpoint_info,
   NEARBY_LOG(INFO, "Device discovered: service_id=%s", str_service_id);
   NEARBY_LOG(INFO, "Device discovered: info=%s", endpoint_info);
 
-  Dart_CObject dart_object_endpoint_id;
-  dart_object_endpoint_id.type = Dart_CObject_kString;
-  dart_object_endpoint_id.value.as_string = const_cast<char *>(endpoint_id);
-
-  Dart_CObject dart_object_endpoint_info;
-  dart_object_endpoint_info.type = Dart_CObject_kString;
-  dart_object_endpoint_info.value.as_string = const_cast<char *>(endpoint_info);
-
-  Dart_CObject *elements[2];
-  elements[0] = &dart_object_endpoint_id;
-  elements[1] = &dart_object_endpoint_info;
-
-  Dart_CObject dart_object_found;
-  dart_object_found.type = Dart_CObject_kArray;
-  dart_object_found.value.as_array.length = 2;
-  dart_object_found.value.as_array.values = elements;
-  const bool result = Dart_PostCObject_DL(
-      current_discovery_listener_dart.found_dart_port, &dart_object_found);
-  if (!result) {
-    NEARBY_LOG(INFO, "Posting message to port failed.");
-  }
+  GetCallbackBatcher().Post(
+      current_discovery_listener_dart.found_dart_port,
+      {std::string(endpoint_id), std::string(endpoint_info)});
 }
 void ListenerEndpointLostCB(const char *endpoint_id) {
   NEARBY_LOG(INFO, "Device lost: id=%s", endpoint_id);
+  // Mustn't overtake the endpoint being found.
+  GetCallbackBatcher().Flush(current_discovery_listener_dart.found_dart_port);
   Dart_CObject dart_object_lost;
   dart_object_lost.type = Dart_CObject_kString;
   dart_object_lost.value.as_string = const_cast<char *>(endpoint_id);
@@ -191,6 +184,7 @@ void ListenerEndpointDistanceChangedCB(const char *endpoint_id,
                                        DistanceInfoW distance_info) {
   (void)distance_info;  // Avoid unused parameter warning
   NEARBY_LOG(INFO, "Device distance changed: id=%s", endpoint_id);
+  GetCallbackBatcher().Flush(current_discovery_listener_dart.found_dart_port);
   Dart_CObject dart_object_distance_changed;
   dart_object_distance_changed.type = Dart_CObject_kString;
   dart_object_distance_changed.value.as_string =
@@ -220,20 +214,30 @@ void ListenerPayloadCB(const char *endpoint_id, PayloadW &payload) {
 
   switch (payload.GetType()) {
     case nearby::connections::PayloadType::kBytes: {
+      // The bytes are handed to Dart as external typed data, backed by the
+      // payload itself, instead of being copied into the Dart heap. Dart frees
+      // the payload once the typed data is garbage collected.
+      auto *held_payload = new PayloadW(std::move(payload));
       const char *bytes = nullptr;
       size_t bytes_size;
 
-      if (!payload.AsBytes(bytes, bytes_size)) {
+      if (!held_payload->AsBytes(bytes, bytes_size)) {
         NEARBY_LOG(INFO, "Failed to get the payload as bytes.");
+        delete held_payload;
         return;
       }
 
       Dart_CObject dart_object_bytes;
-      dart_object_bytes.type = Dart_CObject_kTypedData;
-      dart_object_bytes.value.as_typed_data = {
+      dart_object_bytes.type = Dart_CObject_kExternalTypedData;
+      dart_object_bytes.value.as_external_typed_data = {
           .type = Dart_TypedData_kUint8,
           .length = static_cast<intptr_t>(bytes_size),
-          .values = reinterpret_cast<const uint8_t *>(bytes),
+          .data = reinterpret_cast<uint8_t *>(const_cast<char *>(bytes)),
+          .peer = held_payload,
+          .callback =
+              [](void *isolate_callback_data, void *peer) {
+                delete static_cast<PayloadW *>(peer);
+              },
       };
 
       Dart_CObject *elements[] = {
@@ -250,6 +254,8 @@ void ListenerPayloadCB(const char *endpoint_id, PayloadW &payload) {
               current_payload_listener_dart.initial_byte_info_port,
               &dart_object_payload)) {
         NEARBY_LOG(INFO, "Posting message to port failed.");
+        // Dart only takes over the external data if the message was posted.
+        delete held_payload;
       }
       return;
     }
@@ -313,44 +319,21 @@ void ListenerPayloadProgressCB(
              endpoint_id, payload_progress_info.payload_id,
              payload_progress_info.bytes_transferred,
              payload_progress_info.total_bytes, payload_progress_info.status);
-  Dart_CObject dart_object_endpoint_id;
-  dart_object_endpoint_id.type = Dart_CObject_kString;
-  dart_object_endpoint_id.value.as_string = const_cast<char *>(endpoint_id);
-
-  Dart_CObject dart_object_payload_id;
-  dart_object_payload_id.type = Dart_CObject_kInt64;
-  dart_object_payload_id.value.as_int64 = payload_progress_info.payload_id;
-
-  Dart_CObject dart_object_bytes_transferred;
-  dart_object_bytes_transferred.type = Dart_CObject_kInt64;
-  dart_object_bytes_transferred.value.as_int64 =
-      payload_progress_info.bytes_transferred;
-
-  Dart_CObject dart_object_total_bytes;
-  dart_object_total_bytes.type = Dart_CObject_kInt64;
-  dart_object_total_bytes.value.as_int64 = payload_progress_info.total_bytes;
-
-  Dart_CObject dart_object_status;
-  dart_object_status.type = Dart_CObject_kInt64;
-  dart_object_status.value.as_int64 = (int64_t)payload_progress_info.status;
-
-  Dart_CObject *elements[5];
-  elements[0] = &dart_object_endpoint_id;
-  elements[1] = &dart_object_payload_id;
-  elements[2] = &dart_object_bytes_transferred;
-  elements[3] = &dart_object_total_bytes;
-  elements[4] = &dart_object_status;
-
-  Dart_CObject dart_object_payload_progress;
-  dart_object_payload_progress.type = Dart_CObject_kArray;
-  dart_object_payload_progress.value.as_array.length = 5;
-  dart_object_payload_progress.value.as_array.values = elements;
-
-  if (!Dart_PostCObject_DL(
-          current_payload_listener_dart.payload_progress_dart_port,
-          &dart_object_payload_progress)) {
-    NEARBY_LOG(INFO, "Posting message to port failed.");
+  // Only the latest progress of a payload that's still being transferred is
+  // worth posting.
+  std::string coalesce_key;
+  if (payload_progress_info.status ==
+      PayloadProgressInfoW::Status::kInProgress) {
+    coalesce_key =
+        absl::StrCat(endpoint_id, "/", payload_progress_info.payload_id);
   }
+  GetCallbackBatcher().Post(
+      current_payload_listener_dart.payload_progress_dart_port,
+      {std::string(endpoint_id), payload_progress_info.payload_id,
+       static_cast<std::int64_t>(payload_progress_info.bytes_transferred),
+       static_cast<std::int64_t>(payload_progress_info.total_bytes),
+       static_cast<std::int64_t>(payload_progress_info.status)},
+      std::move(coalesce_key));
 }
 
 void SetResultCallback(ResultCallbackW &result_callback, Dart_Port &dart_port) {
@@ -370,6 +353,18 @@ void PostResult(Dart_Port &result_cb, Status::Value value) {
   }
 }
 
+void SetCallbackBatchingDart(Core *pCore, int64_t interval_millis,
+                             Dart_Port result_cb) {
+  if (!pCore) {
+    PostResult(result_cb, Status::Value::kError);
+    return;
+  }
+  port = result_cb;
+
+  GetCallbackBatcher().SetInterval(absl::Milliseconds(interval_millis));
+  PostResult(result_cb, Status::kSuccess);
+}
+
 void EnableBleV2Dart(Core *pCore, int64_t enable, Dart_Port result_cb) {
   if (!pCore) {
     PostResult(result_cb, Status::Value::kError);
@@ -169,6 +169,17 @@ static void ListenerPayloadProgressCB(const char *endpoint_id,
 DLL_API void __stdcall EnableBleV2Dart(Core *pCore, int64_t enable,
                                        Dart_Port result_cb);
 
+// Posts discovered endpoints and payload progress to their ports in batches,
+// each port getting at most one message every |interval_millis|. The message
+// is then an array of the messages the port gets otherwise, one per event.
+// Only the latest progress of a payload still in progress is kept. 0 posts
+// every event on its own again.
+//
+// result_cb - to access the status of the operation when available.
+DLL_API void __stdcall SetCallbackBatchingDart(Core *pCore,
+                                               int64_t interval_millis,
+                                               Dart_Port result_cb);
+
 // Starts advertising an endpoint for a local app.
 //
 // service_id - An identifier to advertise your app to other endpoints.
@@ -0,0 +1,138 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/dart/dart_callback_batcher.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "absl/types/variant.h"
+#include "internal/platform/logging.h"
+#include "internal/platform/mutex_lock.h"
+#include "internal/platform/system_clock.h"
+
+namespace nearby::windows {
+
+void DartCallbackBatcher::SetInterval(absl::Duration interval) {
+  MutexLock lock(&mutex_);
+  for (auto& [port, batch] : batches_) {
+    FlushLocked(port, batch);
+  }
+  interval_ = std::max(interval, absl::ZeroDuration());
+}
+
+void DartCallbackBatcher::Post(Dart_Port port, Event event,
+                               std::string coalesce_key) {
+  MutexLock lock(&mutex_);
+  if (interval_ == absl::ZeroDuration()) {
+    if (!PostEvents(port, {{std::move(coalesce_key), std::move(event)}},
+                    /*as_batch=*/false)) {
+      NEARBY_LOG(INFO, "Posting message to port failed.");
+    }
+    return;
+  }
+
+  Batch& batch = batches_[port];
+  auto it = coalesce_key.empty()
+                ? batch.events.end()
+                : std::find_if(batch.events.begin(), batch.events.end(),
+                               [&coalesce_key](const auto& pending) {
+                                 return pending.first == coalesce_key;
+                               });
+  if (it != batch.events.end()) {
+    it->second = std::move(event);
+  } else {
+    batch.events.emplace_back(std::move(coalesce_key), std::move(event));
+  }
+  if (batch.events.size() >= kMaxBatchSize) {
+    FlushLocked(port, batch);
+    return;
+  }
+  if (batch.flush_scheduled) return;
+
+  batch.flush_scheduled = true;
+  absl::Duration delay =
+      std::max(batch.last_post_time + interval_ - SystemClock::ElapsedRealtime(),
+               absl::ZeroDuration());
+  flush_executor_.Schedule([this, port]() { Flush(port); }, delay);
+}
+
+void DartCallbackBatcher::Flush(Dart_Port port) {
+  MutexLock lock(&mutex_);
+  auto it = batches_.find(port);
+  if (it != batches_.end()) FlushLocked(port, it->second);
+}
+
+void DartCallbackBatcher::FlushLocked(Dart_Port port, Batch& batch) {
+  batch.flush_scheduled = false;
+  if (batch.events.empty()) return;
+  if (!PostEvents(port, batch.events, /*as_batch=*/true)) {
+    NEARBY_LOG(INFO, "Posting batch of %d messages to port failed.",
+               static_cast<int>(batch.events.size()));
+  }
+  batch.events.clear();
+  batch.last_post_time = SystemClock::ElapsedRealtime();
+}
+
+bool DartCallbackBatcher::PostEvents(
+    Dart_Port port, const std::vector<std::pair<std::string, Event>>& events,
+    bool as_batch) {
+  // Dart copies the message while posting it, so it only needs to outlive
+  // Dart_PostCObject_DL().
+  std::vector<std::vector<Dart_CObject>> values(events.size());
+  std::vector<std::vector<Dart_CObject*>> elements(events.size());
+  std::vector<Dart_CObject> event_objects(events.size());
+  std::vector<Dart_CObject*> batch_elements(events.size());
+  for (int i = 0; i < events.size(); ++i) {
+    const Event& event = events[i].second;
+    values[i].resize(event.size());
+    for (int j = 0; j < event.size(); ++j) {
+      if (const auto* number = absl::get_if<std::int64_t>(&event[j])) {
+        values[i][j].type = Dart_CObject_kInt64;
+        values[i][j].value.as_int64 = *number;
+      } else {
+        values[i][j].type = Dart_CObject_kString;
+        values[i][j].value.as_string =
+            const_cast<char*>(absl::get<std::string>(event[j]).c_str());
+      }
+      elements[i].push_back(&values[i][j]);
+    }
+    if (event.size() == 1) {
+      event_objects[i] = values[i][0];
+    } else {
+      event_objects[i].type = Dart_CObject_kArray;
+      event_objects[i].value.as_array.length = event.size();
+      event_objects[i].value.as_array.values = elements[i].data();
+    }
+    batch_elements[i] = &event_objects[i];
+  }
+
+  if (!as_batch) {
+    return std::all_of(event_objects.begin(), event_objects.end(),
+                       [port](Dart_CObject& event_object) {
+                         return Dart_PostCObject_DL(port, &event_object);
+                       });
+  }
+  Dart_CObject batch_object;
+  batch_object.type = Dart_CObject_kArray;
+  batch_object.value.as_array.length = batch_elements.size();
+  batch_object.value.as_array.values = batch_elements.data();
+  return Dart_PostCObject_DL(port, &batch_object);
+}
+
+}  // namespace nearby::windows
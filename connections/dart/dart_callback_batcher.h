@@ -0,0 +1,87 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONNECTIONS_DART_DART_CALLBACK_BATCHER_H_
+#define CONNECTIONS_DART_DART_CALLBACK_BATCHER_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/time/time.h"
+#include "absl/types/variant.h"
+#include "third_party/dart_lang/v2/runtime/include/dart_api_dl.h"
+#include "third_party/dart_lang/v2/runtime/include/dart_native_api.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/scheduled_executor.h"
+
+namespace nearby::windows {
+
+// Posts callback events to Dart ports, either one message per event, or, once
+// an interval is set, as batches that each port gets at most once per
+// interval. A batch is an array of the messages the port would otherwise get
+// one by one, so that a discovery storm or a large transfer doesn't flood the
+// Dart isolate with messages.
+//
+// Thread-safe.
+class DartCallbackBatcher {
+ public:
+  // A batch is posted right away once it holds this many events.
+  static constexpr int kMaxBatchSize = 256;
+
+  // An event is posted as an array of these, or as the value itself if it is
+  // the only one.
+  using Value = absl::variant<std::int64_t, std::string>;
+  using Event = std::vector<Value>;
+
+  // Sets how often each port gets a batch. Zero posts every event on its own.
+  // Pending batches are posted first.
+  void SetInterval(absl::Duration interval);
+
+  // Posts |event| to |port|, or adds it to the port's pending batch. A pending
+  // event with the same non-empty |coalesce_key| is replaced in place, e.g. to
+  // only keep the latest progress of a payload.
+  void Post(Dart_Port port, Event event, std::string coalesce_key = "");
+
+  // Posts the pending batch of |port|, if any. Called before posting an event
+  // to another port that must not overtake the batched ones.
+  void Flush(Dart_Port port);
+
+ private:
+  struct Batch {
+    std::vector<std::pair<std::string, Event>> events;
+    absl::Time last_post_time = absl::InfinitePast();
+    bool flush_scheduled = false;
+  };
+
+  void FlushLocked(Dart_Port port, Batch& batch)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Returns whether Dart accepted the message.
+  static bool PostEvents(Dart_Port port,
+                         const std::vector<std::pair<std::string, Event>>&
+                             events,
+                         bool as_batch);
+
+  Mutex mutex_;
+  absl::Duration interval_ ABSL_GUARDED_BY(mutex_) = absl::ZeroDuration();
+  absl::flat_hash_map<Dart_Port, Batch> batches_ ABSL_GUARDED_BY(mutex_);
+  ScheduledExecutor flush_executor_;
+};
+
+}  // namespace nearby::windows
+
+#endif  // CONNECTIONS_DART_DART_CALLBACK_BATCHER_H_
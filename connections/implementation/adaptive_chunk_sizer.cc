@@ -0,0 +1,64 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/adaptive_chunk_sizer.h"
+
+#include <algorithm>
+
+#include "absl/time/time.h"
+
+namespace nearby {
+namespace connections {
+
+constexpr absl::Duration AdaptiveChunkSizer::kTargetChunkWriteTime;
+constexpr int AdaptiveChunkSizer::kMinChunkSize;
+constexpr int AdaptiveChunkSizer::kMaxChunkSize;
+constexpr double AdaptiveChunkSizer::kThroughputSmoothing;
+
+AdaptiveChunkSizer::AdaptiveChunkSizer(int initial_chunk_size)
+    : adaptive_(initial_chunk_size >= kMinChunkSize),
+      chunk_size_(adaptive_ ? std::min(initial_chunk_size, kMaxChunkSize)
+                            : initial_chunk_size) {}
+
+void AdaptiveChunkSizer::OnChunkWritten(int chunk_size,
+                                        absl::Duration write_time) {
+  if (!adaptive_) return;
+  // Short chunks (the tail of a payload, small BYTES payloads) are dominated
+  // by per-frame overhead and would understate the throughput.
+  if (chunk_size <= 0 || chunk_size < chunk_size_ / 2) return;
+
+  int desired_chunk_size;
+  if (write_time <= absl::ZeroDuration()) {
+    // Too fast to measure.
+    desired_chunk_size = kMaxChunkSize;
+  } else {
+    double bytes_per_second =
+        chunk_size / absl::ToDoubleSeconds(write_time);
+    bytes_per_second_ =
+        bytes_per_second_ == 0
+            ? bytes_per_second
+            : kThroughputSmoothing * bytes_per_second +
+                  (1 - kThroughputSmoothing) * bytes_per_second_;
+    desired_chunk_size = static_cast<int>(std::min<double>(
+        bytes_per_second_ * absl::ToDoubleSeconds(kTargetChunkWriteTime),
+        kMaxChunkSize));
+  }
+
+  desired_chunk_size =
+      std::clamp(desired_chunk_size, chunk_size_ / 2, chunk_size_ * 2);
+  chunk_size_ = std::clamp(desired_chunk_size, kMinChunkSize, kMaxChunkSize);
+}
+
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,65 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_ADAPTIVE_CHUNK_SIZER_H_
+#define CORE_INTERNAL_ADAPTIVE_CHUNK_SIZER_H_
+
+#include "absl/time/time.h"
+
+namespace nearby {
+namespace connections {
+
+// Picks the payload chunk size for one endpoint from the measured write
+// throughput of the chunks sent to it so far.
+//
+// The goal is for each chunk write to take about kTargetChunkWriteTime: long
+// enough that per-frame overhead is amortized on fast links, and short enough
+// that other frames written to the same channel don't queue behind a chunk
+// for long on slow ones. The chunk size changes by at most a factor of two
+// per written chunk.
+//
+// Not thread-safe.
+class AdaptiveChunkSizer {
+ public:
+  static constexpr absl::Duration kTargetChunkWriteTime =
+      absl::Milliseconds(50);
+  // Endpoints whose channel starts out below this size (e.g. BLE GATT) keep
+  // their fixed chunk size.
+  static constexpr int kMinChunkSize = 8 * 1024;  // 8 KB
+  // Stays below TransportConfig::kDefaultMaxFrameSize, leaving room for
+  // the frame header and the encryption overhead.
+  static constexpr int kMaxChunkSize = 1024 * 1024 - 16 * 1024;  // 1008 KB
+
+  explicit AdaptiveChunkSizer(int initial_chunk_size);
+
+  int GetChunkSize() const { return chunk_size_; }
+
+  // Records that a chunk of |chunk_size| bytes took |write_time| to write, and
+  // updates the chunk size accordingly.
+  void OnChunkWritten(int chunk_size, absl::Duration write_time);
+
+ private:
+  // Weight of the newest throughput sample in the running average.
+  static constexpr double kThroughputSmoothing = 0.25;
+
+  const bool adaptive_;
+  int chunk_size_;
+  // Exponentially weighted average, 0 until the first sample.
+  double bytes_per_second_ = 0;
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_ADAPTIVE_CHUNK_SIZER_H_
@@ -0,0 +1,97 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/adaptive_chunk_sizer.h"
+
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+constexpr int kInitialChunkSize = 64 * 1024;
+
+TEST(AdaptiveChunkSizerTest, StartsWithInitialChunkSize) {
+  AdaptiveChunkSizer sizer(kInitialChunkSize);
+
+  EXPECT_EQ(sizer.GetChunkSize(), kInitialChunkSize);
+}
+
+TEST(AdaptiveChunkSizerTest, GrowsOnFastLink) {
+  AdaptiveChunkSizer sizer(kInitialChunkSize);
+
+  sizer.OnChunkWritten(kInitialChunkSize, absl::Milliseconds(1));
+
+  EXPECT_EQ(sizer.GetChunkSize(), 2 * kInitialChunkSize);
+}
+
+TEST(AdaptiveChunkSizerTest, ShrinksOnSlowLink) {
+  AdaptiveChunkSizer sizer(kInitialChunkSize);
+
+  sizer.OnChunkWritten(kInitialChunkSize, absl::Seconds(1));
+
+  EXPECT_EQ(sizer.GetChunkSize(), kInitialChunkSize / 2);
+}
+
+TEST(AdaptiveChunkSizerTest, SettlesOnTargetWriteTime) {
+  AdaptiveChunkSizer sizer(kInitialChunkSize);
+  // 4 MB/s, so a 50ms write is 200 KB.
+  constexpr double kBytesPerSecond = 4 * 1024 * 1024;
+
+  for (int i = 0; i < 50; ++i) {
+    int chunk_size = sizer.GetChunkSize();
+    sizer.OnChunkWritten(chunk_size,
+                         absl::Seconds(chunk_size / kBytesPerSecond));
+  }
+
+  EXPECT_NEAR(sizer.GetChunkSize(),
+              kBytesPerSecond * absl::ToDoubleSeconds(
+                                    AdaptiveChunkSizer::kTargetChunkWriteTime),
+              1024);
+}
+
+TEST(AdaptiveChunkSizerTest, StaysWithinBounds) {
+  AdaptiveChunkSizer sizer(kInitialChunkSize);
+
+  for (int i = 0; i < 20; ++i) {
+    sizer.OnChunkWritten(sizer.GetChunkSize(), absl::ZeroDuration());
+  }
+  EXPECT_EQ(sizer.GetChunkSize(), AdaptiveChunkSizer::kMaxChunkSize);
+
+  for (int i = 0; i < 20; ++i) {
+    sizer.OnChunkWritten(sizer.GetChunkSize(), absl::Seconds(10));
+  }
+  EXPECT_EQ(sizer.GetChunkSize(), AdaptiveChunkSizer::kMinChunkSize);
+}
+
+TEST(AdaptiveChunkSizerTest, IgnoresShortChunks) {
+  AdaptiveChunkSizer sizer(kInitialChunkSize);
+
+  sizer.OnChunkWritten(100, absl::Milliseconds(100));
+
+  EXPECT_EQ(sizer.GetChunkSize(), kInitialChunkSize);
+}
+
+TEST(AdaptiveChunkSizerTest, KeepsSmallPacketSizeFixed) {
+  AdaptiveChunkSizer sizer(512);
+
+  sizer.OnChunkWritten(512, absl::Microseconds(1));
+
+  EXPECT_EQ(sizer.GetChunkSize(), 512);
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,91 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/aead_frame_cipher.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "internal/crypto/aead.h"
+#include "internal/crypto/hkdf.h"
+#include "internal/platform/mutex_lock.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+constexpr absl::string_view kKeySalt = "NearbyConnectionsAeadFrames";
+constexpr absl::string_view kClientKeyInfo = "ClientToServer";
+constexpr absl::string_view kServerKeyInfo = "ServerToClient";
+constexpr int kKeyLength = 32;
+
+std::string DeriveKey(absl::string_view session_unique,
+                      absl::string_view info) {
+  return crypto::HkdfSha256(session_unique, kKeySalt, info, kKeyLength);
+}
+
+}  // namespace
+
+AeadFrameCipher::AeadFrameCipher(absl::string_view session_unique,
+                                 bool is_server)
+    : seal_key_(DeriveKey(session_unique,
+                          is_server ? kServerKeyInfo : kClientKeyInfo)),
+      seal_aead_(crypto::Aead::AES_256_GCM),
+      open_key_(DeriveKey(session_unique,
+                          is_server ? kClientKeyInfo : kServerKeyInfo)),
+      open_aead_(crypto::Aead::AES_256_GCM) {
+  // Aead keeps pointers to the keys, which live as long as this cipher.
+  MutexLock seal_lock(&seal_mutex_);
+  MutexLock open_lock(&open_mutex_);
+  seal_aead_.Init(&seal_key_);
+  open_aead_.Init(&open_key_);
+}
+
+std::unique_ptr<std::string> AeadFrameCipher::Seal(absl::string_view frame) {
+  MutexLock lock(&seal_mutex_);
+  auto sealed_frame = std::make_unique<std::string>();
+  if (!seal_aead_.Seal(frame, ToNonce(seal_sequence_number_),
+                       /*additional_data=*/"", sealed_frame.get())) {
+    return nullptr;
+  }
+  ++seal_sequence_number_;
+  return sealed_frame;
+}
+
+std::unique_ptr<std::string> AeadFrameCipher::Open(
+    absl::string_view sealed_frame) {
+  MutexLock lock(&open_mutex_);
+  auto frame = std::make_unique<std::string>();
+  if (!open_aead_.Open(sealed_frame, ToNonce(open_sequence_number_),
+                       /*additional_data=*/"", frame.get())) {
+    return nullptr;
+  }
+  ++open_sequence_number_;
+  return frame;
+}
+
+std::string AeadFrameCipher::ToNonce(std::uint64_t sequence_number) {
+  // A 12 byte nonce, with the sequence number big-endian in its last 8 bytes.
+  std::string nonce(12, '\0');
+  for (int i = 11; i >= 4; --i) {
+    nonce[i] = static_cast<char>(sequence_number & 0xff);
+    sequence_number >>= 8;
+  }
+  return nonce;
+}
+
+}  // namespace connections
+}  // namespace nearby
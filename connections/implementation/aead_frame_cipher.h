@@ -0,0 +1,67 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_AEAD_FRAME_CIPHER_H_
+#define CORE_INTERNAL_AEAD_FRAME_CIPHER_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "internal/crypto/aead.h"
+#include "internal/platform/mutex.h"
+
+namespace nearby {
+namespace connections {
+
+// Encrypts endpoint channel frames with AES-256-GCM, as a lighter alternative
+// to D2DConnectionContextV1's SecureMessage envelopes. A sealed frame is just
+// the ciphertext followed by the GCM tag; the nonce is the number of frames
+// sealed before it, so frames must be opened in the order they were sealed.
+//
+// Thread-safe. Like a D2DConnectionContextV1, a cipher is shared by all the
+// channels of an endpoint, which number their frames together.
+class AeadFrameCipher {
+ public:
+  // Derives the keys from the session unique of the connection's
+  // D2DConnectionContextV1. Both sides derive the same keys, and
+  // |is_server| picks which of them seals and which opens.
+  AeadFrameCipher(absl::string_view session_unique, bool is_server);
+
+  // Returns the sealed |frame|, or null on failure.
+  std::unique_ptr<std::string> Seal(absl::string_view frame);
+  // Returns the frame sealed in |sealed_frame|, or null if it wasn't the next
+  // frame sealed by the remote endpoint's cipher.
+  std::unique_ptr<std::string> Open(absl::string_view sealed_frame);
+
+ private:
+  static std::string ToNonce(std::uint64_t sequence_number);
+
+  Mutex seal_mutex_;
+  const std::string seal_key_;
+  crypto::Aead seal_aead_ ABSL_GUARDED_BY(seal_mutex_);
+  std::uint64_t seal_sequence_number_ ABSL_GUARDED_BY(seal_mutex_) = 0;
+
+  Mutex open_mutex_;
+  const std::string open_key_;
+  crypto::Aead open_aead_ ABSL_GUARDED_BY(open_mutex_);
+  std::uint64_t open_sequence_number_ ABSL_GUARDED_BY(open_mutex_) = 0;
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_AEAD_FRAME_CIPHER_H_
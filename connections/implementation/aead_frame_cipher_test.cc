@@ -0,0 +1,97 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/aead_frame_cipher.h"
+
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+constexpr char kSessionUnique[] = "session unique";
+
+TEST(AeadFrameCipherTest, ServerOpensWhatClientSeals) {
+  AeadFrameCipher client(kSessionUnique, /*is_server=*/false);
+  AeadFrameCipher server(kSessionUnique, /*is_server=*/true);
+
+  for (const std::string frame : {"first", "second", ""}) {
+    std::unique_ptr<std::string> sealed = client.Seal(frame);
+    ASSERT_NE(sealed, nullptr);
+    EXPECT_NE(*sealed, frame);
+    std::unique_ptr<std::string> opened = server.Open(*sealed);
+    ASSERT_NE(opened, nullptr);
+    EXPECT_EQ(*opened, frame);
+  }
+}
+
+TEST(AeadFrameCipherTest, ClientOpensWhatServerSeals) {
+  AeadFrameCipher client(kSessionUnique, /*is_server=*/false);
+  AeadFrameCipher server(kSessionUnique, /*is_server=*/true);
+
+  std::unique_ptr<std::string> sealed = server.Seal("frame");
+  ASSERT_NE(sealed, nullptr);
+  std::unique_ptr<std::string> opened = client.Open(*sealed);
+  ASSERT_NE(opened, nullptr);
+  EXPECT_EQ(*opened, "frame");
+}
+
+TEST(AeadFrameCipherTest, CannotOpenOwnFrames) {
+  AeadFrameCipher client(kSessionUnique, /*is_server=*/false);
+
+  std::unique_ptr<std::string> sealed = client.Seal("frame");
+  ASSERT_NE(sealed, nullptr);
+  EXPECT_EQ(client.Open(*sealed), nullptr);
+}
+
+TEST(AeadFrameCipherTest, RejectsReorderedAndReplayedFrames) {
+  AeadFrameCipher client(kSessionUnique, /*is_server=*/false);
+  AeadFrameCipher server(kSessionUnique, /*is_server=*/true);
+  std::unique_ptr<std::string> first = client.Seal("first");
+  std::unique_ptr<std::string> second = client.Seal("second");
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+
+  EXPECT_EQ(server.Open(*second), nullptr);
+  ASSERT_NE(server.Open(*first), nullptr);
+  EXPECT_EQ(server.Open(*first), nullptr);
+  ASSERT_NE(server.Open(*second), nullptr);
+}
+
+TEST(AeadFrameCipherTest, RejectsTamperedFrame) {
+  AeadFrameCipher client(kSessionUnique, /*is_server=*/false);
+  AeadFrameCipher server(kSessionUnique, /*is_server=*/true);
+  std::unique_ptr<std::string> sealed = client.Seal("frame");
+  ASSERT_NE(sealed, nullptr);
+
+  (*sealed)[0] ^= 1;
+
+  EXPECT_EQ(server.Open(*sealed), nullptr);
+}
+
+TEST(AeadFrameCipherTest, RejectsFrameFromOtherSession) {
+  AeadFrameCipher client("other session", /*is_server=*/false);
+  AeadFrameCipher server(kSessionUnique, /*is_server=*/true);
+  std::unique_ptr<std::string> sealed = client.Seal("frame");
+  ASSERT_NE(sealed, nullptr);
+
+  EXPECT_EQ(server.Open(*sealed), nullptr);
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
@@ -25,6 +25,7 @@
 
 #include "absl/algorithm/container.h"
 #include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "internal/analytics/event_logger.h"
@@ -468,6 +469,7 @@ void AnalyticsRecorder::OnConnectionClosed(const std::string &endpoint_id,
                     << endpoint_id << ", medium:" << Medium_Name(medium)
                     << ", reason:" << DisconnectionReason_Name(reason);
 
+  FoldChunkTalliesLocked();
   if (!CanRecordAnalyticsLocked("OnConnectionClosed")) {
     return;
   }
@@ -518,22 +520,21 @@ void AnalyticsRecorder::OnIncomingPayloadStarted(
 void AnalyticsRecorder::OnPayloadChunkReceived(const std::string &endpoint_id,
                                                std::int64_t payload_id,
                                                std::int64_t chunk_size_bytes) {
-  MutexLock lock(&mutex_);
-  if (!CanRecordAnalyticsLocked("OnPayloadChunkReceived")) {
-    return;
-  }
-  auto it = active_connections_.find(endpoint_id);
-  if (it == active_connections_.end()) {
+  if (event_logger_ == nullptr) {
     return;
   }
-  const std::unique_ptr<LogicalConnection> &logical_connection = it->second;
-  logical_connection->ChunkReceived(payload_id, chunk_size_bytes);
+  ChunkTallyShard &shard = GetChunkTallyShard(payload_id);
+  MutexLock lock(&shard.mutex);
+  ChunkTally &tally = shard.received[{endpoint_id, payload_id}];
+  tally.num_chunks++;
+  tally.num_bytes += chunk_size_bytes;
 }
 
 void AnalyticsRecorder::OnIncomingPayloadDone(const std::string &endpoint_id,
                                               std::int64_t payload_id,
                                               PayloadStatus status) {
   MutexLock lock(&mutex_);
+  FoldChunkTalliesLocked();
   if (!CanRecordAnalyticsLocked("OnIncomingPayloadDone")) {
     return;
   }
@@ -566,22 +567,21 @@ void AnalyticsRecorder::OnOutgoingPayloadStarted(
 void AnalyticsRecorder::OnPayloadChunkSent(const std::string &endpoint_id,
                                            std::int64_t payload_id,
                                            std::int64_t chunk_size_bytes) {
-  MutexLock lock(&mutex_);
-  if (!CanRecordAnalyticsLocked("OnPayloadChunkSent")) {
-    return;
-  }
-  auto it = active_connections_.find(endpoint_id);
-  if (it == active_connections_.end()) {
+  if (event_logger_ == nullptr) {
     return;
   }
-  const std::unique_ptr<LogicalConnection> &logical_connection = it->second;
-  logical_connection->ChunkSent(payload_id, chunk_size_bytes);
+  ChunkTallyShard &shard = GetChunkTallyShard(payload_id);
+  MutexLock lock(&shard.mutex);
+  ChunkTally &tally = shard.sent[{endpoint_id, payload_id}];
+  tally.num_chunks++;
+  tally.num_bytes += chunk_size_bytes;
 }
 
 void AnalyticsRecorder::OnOutgoingPayloadDone(const std::string &endpoint_id,
                                               std::int64_t payload_id,
                                               PayloadStatus status) {
   MutexLock lock(&mutex_);
+  FoldChunkTalliesLocked();
   if (!CanRecordAnalyticsLocked("OnOutgoingPayloadDone")) {
     return;
   }
@@ -1008,6 +1008,7 @@ void AnalyticsRecorder::FinishUpgradeAttemptLocked(
 }
 
 void AnalyticsRecorder::FinishStrategySessionLocked() {
+  FoldChunkTalliesLocked();
   if (current_strategy_session_ != nullptr) {
     FinishAdvertisingPhaseLocked();
     FinishDiscoveryPhaseLocked();
@@ -1060,6 +1061,7 @@ PayloadType AnalyticsRecorder::PayloadTypeToProtoPayloadType(
     case connections::PayloadType::kBytes:
       return BYTES;
     case connections::PayloadType::kFile:
+    case connections::PayloadType::kFileBatch:
       return FILE;
     case connections::PayloadType::kStream:
       return STREAM;
@@ -1068,10 +1070,41 @@ PayloadType AnalyticsRecorder::PayloadTypeToProtoPayloadType(
   }
 }
 
-void AnalyticsRecorder::PendingPayload::AddChunk(
-    std::int64_t chunk_size_bytes) {
-  num_bytes_transferred_ += chunk_size_bytes;
-  num_chunks_++;
+AnalyticsRecorder::ChunkTallyShard &AnalyticsRecorder::GetChunkTallyShard(
+    std::int64_t payload_id) {
+  return chunk_tally_shards_[static_cast<std::uint64_t>(payload_id) %
+                             kNumChunkTallyShards];
+}
+
+void AnalyticsRecorder::FoldChunkTalliesLocked() {
+  for (ChunkTallyShard &shard : chunk_tally_shards_) {
+    absl::flat_hash_map<ChunkTallyKey, ChunkTally> received;
+    absl::flat_hash_map<ChunkTallyKey, ChunkTally> sent;
+    {
+      MutexLock lock(&shard.mutex);
+      received.swap(shard.received);
+      sent.swap(shard.sent);
+    }
+    for (const auto &[key, tally] : received) {
+      auto it = active_connections_.find(key.first);
+      if (it != active_connections_.end()) {
+        it->second->ChunksReceived(key.second, tally.num_chunks,
+                                   tally.num_bytes);
+      }
+    }
+    for (const auto &[key, tally] : sent) {
+      auto it = active_connections_.find(key.first);
+      if (it != active_connections_.end()) {
+        it->second->ChunksSent(key.second, tally.num_chunks, tally.num_bytes);
+      }
+    }
+  }
+}
+
+void AnalyticsRecorder::PendingPayload::AddChunks(int num_chunks,
+                                                  std::int64_t size_bytes) {
+  num_bytes_transferred_ += size_bytes;
+  num_chunks_ += num_chunks;
 }
 
 ConnectionsLog::Payload AnalyticsRecorder::PendingPayload::GetProtoPayload(
@@ -1181,14 +1214,14 @@ void AnalyticsRecorder::LogicalConnection::IncomingPayloadStarted(
       {payload_id, std::make_unique<PendingPayload>(type, total_size_bytes)});
 }
 
-void AnalyticsRecorder::LogicalConnection::ChunkReceived(
-    std::int64_t payload_id, std::int64_t size_bytes) {
+void AnalyticsRecorder::LogicalConnection::ChunksReceived(
+    std::int64_t payload_id, int num_chunks, std::int64_t size_bytes) {
   auto it = incoming_payloads_.find(payload_id);
   if (it == incoming_payloads_.end()) {
     return;
   }
   PendingPayload *pending_payload = it->second.get();
-  pending_payload->AddChunk(size_bytes);
+  pending_payload->AddChunks(num_chunks, size_bytes);
 }
 
 void AnalyticsRecorder::LogicalConnection::IncomingPayloadDone(
@@ -1217,14 +1250,14 @@ void AnalyticsRecorder::LogicalConnection::OutgoingPayloadStarted(
       {payload_id, std::make_unique<PendingPayload>(type, total_size_bytes)});
 }
 
-void AnalyticsRecorder::LogicalConnection::ChunkSent(std::int64_t payload_id,
-                                                     std::int64_t size_bytes) {
+void AnalyticsRecorder::LogicalConnection::ChunksSent(
+    std::int64_t payload_id, int num_chunks, std::int64_t size_bytes) {
   auto it = outgoing_payloads_.find(payload_id);
   if (it == outgoing_payloads_.end()) {
     return;
   }
   PendingPayload *payload = it->second.get();
-  payload->AddChunk(size_bytes);
+  payload->AddChunks(num_chunks, size_bytes);
 }
 
 void AnalyticsRecorder::LogicalConnection::OutgoingPayloadDone(
@@ -15,6 +15,7 @@
 #ifndef ANALYTICS_ANALYTICS_RECORDER_H_
 #define ANALYTICS_ANALYTICS_RECORDER_H_
 
+#include <array>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -23,6 +24,7 @@
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "connections/implementation/analytics/connection_attempt_metadata_params.h"
@@ -197,7 +199,7 @@ class AnalyticsRecorder {
           num_chunks_(0) {}
     ~PendingPayload() = default;
 
-    void AddChunk(std::int64_t chunk_size_bytes);
+    void AddChunks(int num_chunks, std::int64_t size_bytes);
 
     location::nearby::analytics::proto::ConnectionsLog::Payload GetProtoPayload(
         location::nearby::proto::connections::PayloadStatus status);
@@ -245,7 +247,8 @@ class AnalyticsRecorder {
         std::int64_t payload_id,
         location::nearby::proto::connections::PayloadType type,
         std::int64_t total_size_bytes);
-    void ChunkReceived(std::int64_t payload_id, std::int64_t size_bytes);
+    void ChunksReceived(std::int64_t payload_id, int num_chunks,
+                        std::int64_t size_bytes);
     void IncomingPayloadDone(
         std::int64_t payload_id,
         location::nearby::proto::connections::PayloadStatus status);
@@ -253,7 +256,8 @@ class AnalyticsRecorder {
         std::int64_t payload_id,
         location::nearby::proto::connections::PayloadType type,
         std::int64_t total_size_bytes);
-    void ChunkSent(std::int64_t payload_id, std::int64_t size_bytes);
+    void ChunksSent(std::int64_t payload_id, int num_chunks,
+                    std::int64_t size_bytes);
     void OutgoingPayloadDone(
         std::int64_t payload_id,
         location::nearby::proto::connections::PayloadStatus status);
@@ -332,6 +336,10 @@ class AnalyticsRecorder {
       bool erase_item = true) ABSL_SHARED_LOCKS_REQUIRED(mutex_);
   void FinishStrategySessionLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Adds the chunks tallied since the last call to the pending payloads of
+  // active_connections_, and forgets the tallies.
+  void FoldChunkTalliesLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   // Reset the client cession's logging resources (e.g. current_strategy_,
   // current_advertising_phase_, current_discovery_phase_, etc)
   void ResetClientSessionLoggingResouces();
@@ -345,7 +353,7 @@ class AnalyticsRecorder {
   // that outlives the one constructed.
   ::nearby::analytics::EventLogger *event_logger_;
 
-  SingleThreadExecutor serial_executor_;
+  SingleThreadExecutor serial_executor_{api::ExecutorQos::kBackground};
   // Protects all sub-protos reading and writing in ConnectionLog.
   Mutex mutex_;
 
@@ -391,6 +399,26 @@ class AnalyticsRecorder {
                   std::unique_ptr<location::nearby::analytics::proto::
                                       ConnectionsLog::BandwidthUpgradeAttempt>>
       bandwidth_upgrade_attempts_ ABSL_GUARDED_BY(mutex_);
+
+  // Chunks are reported for every few KB of a payload, so rather than taking
+  // |mutex_| for each of them, they are only tallied here, per endpoint and
+  // payload, and folded into active_connections_ before anything reads them.
+  // The tallies are spread over shards by payload, so that payloads moving
+  // on different threads don't wait for each other.
+  struct ChunkTally {
+    int num_chunks = 0;
+    std::int64_t num_bytes = 0;
+  };
+  using ChunkTallyKey = std::pair<std::string, std::int64_t>;
+  struct ChunkTallyShard {
+    Mutex mutex;
+    absl::flat_hash_map<ChunkTallyKey, ChunkTally> received
+        ABSL_GUARDED_BY(mutex);
+    absl::flat_hash_map<ChunkTallyKey, ChunkTally> sent ABSL_GUARDED_BY(mutex);
+  };
+  static constexpr int kNumChunkTallyShards = 8;
+  ChunkTallyShard &GetChunkTallyShard(std::int64_t payload_id);
+  std::array<ChunkTallyShard, kNumChunkTallyShards> chunk_tally_shards_;
 };
 
 }  // namespace analytics
@@ -68,8 +68,8 @@ void ThroughputRecorder::Start(PayloadType payload_type,
 
   MutexLock lock(&mutex_);
   start_timestamp_ = SystemClock::ElapsedRealtime();
-  payload_type_ = payload_type;
   payload_direction_ = payload_direction;
+  payload_type_ = payload_type;
   // Add packetLostAlarm later
 }
 
@@ -84,37 +84,46 @@ bool ThroughputRecorder::Stop() {
     // Add packetLostAlarm stop process later
     absl::Time stop_timestamp = SystemClock::ElapsedRealtime();
     int64_t total_byte_size = 0;
-    int medium_size = throughputs_.size();
-
-    // The worse case is the socket/connect blocking the write request, never
-    // got return when writing a frame out, it would get a very good data rate
-    // for this case. e.g. use 60 seconds to send a file and failed, the counter
-    // only get the duration as 30 seconds because the last write request
-    // blocked.
-    if (!success_) {
-      if (!throughputs_.empty()) {
-        for (auto& tp : throughputs_) {
-          tp.second.SetLastTimestamp(stop_timestamp);
-        }
-      }
-    }
+    int medium_size = 0;
 
     // calculate throughput by medium
-    for (auto& tp : throughputs_) {
-      tp.second.dump();
-      total_byte_size += tp.second.GetTotalByteSize();
+    for (int medium = 0; medium < static_cast<int>(mediums_.size());
+         ++medium) {
+      MediumCounters& counters = mediums_[medium];
+      if (counters.frame_count.load(std::memory_order_acquire) == 0) continue;
+      ++medium_size;
+      Throughput throughput = MakeThroughput(static_cast<Medium>(medium),
+                                             counters, stop_timestamp);
+      // The worse case is the socket/connect blocking the write request,
+      // never got return when writing a frame out, it would get a very good
+      // data rate for this case. e.g. use 60 seconds to send a file and
+      // failed, the counter only get the duration as 30 seconds because the
+      // last write request blocked.
+      if (!success_) {
+        throughput.SetLastTimestamp(stop_timestamp);
+      }
+      throughput.dump();
+      total_byte_size += throughput.GetTotalByteSize();
+
+      counters.frame_count = 0;
+      counters.total_byte_size = 0;
+      counters.file_io_time = 0;
+      counters.encryption_time = 0;
+      counters.socket_io_time = 0;
+      counters.start_nanos = 0;
+      counters.last_nanos = 0;
     }
 
-    throughputs_.clear();
-
     int64_t total_millis =
         absl::ToInt64Milliseconds(stop_timestamp - start_timestamp_);
-    throughput_kbps_ = CalculateThroughputKBps(total_byte_size, total_millis);
-    int throughput_mbps = CalculateThroughputMBps(throughput_kbps_);
+    int throughput_kbps =
+        CalculateThroughputKBps(total_byte_size, total_millis);
+    throughput_kbps_ = throughput_kbps;
+    int throughput_mbps = CalculateThroughputMBps(throughput_kbps);
 
     // calculate overall throughput if there are multiple mediums
     if (medium_size > 1) {
-      if (throughput_kbps_ != kDefaultThroughoutKbps) {
+      if (throughput_kbps != kDefaultThroughoutKbps) {
         std::string dump_content = absl::StrFormat(
             "%s %s data(%d bytes) %s, overall used %d milliseconds, "
             "throughput "
@@ -126,11 +135,11 @@ bool ThroughputRecorder::Stop() {
                 : "Sent",
             ToString(payload_type_), total_byte_size,
             success_ ? "SUCCEEDED" : "FAILED", total_millis, throughput_mbps,
-            throughput_kbps_, file_io_time_,
+            throughput_kbps, file_io_time_.load(),
             (payload_direction_ == PayloadDirection::INCOMING_PAYLOAD)
                 ? "Decryption"
                 : "Encryption",
-            encryption_time_, socket_io_time_);
+            encryption_time_.load(), socket_io_time_.load());
         NEARBY_LOGS(INFO) << dump_content;
       }
     }
@@ -150,7 +159,8 @@ int ThroughputRecorder::CalculateThroughputMBps(int throughputKBps) {
   return throughputKBps / kKbInBytes;
 }
 
-void ThroughputRecorder::Throughput::Add(int frame_size, int64_t file_io_time,
+void ThroughputRecorder::Throughput::Add(int64_t frame_size,
+                                         int64_t file_io_time,
                                          int64_t encryption_time,
                                          int64_t socket_io_time) {
   total_byte_size_ += frame_size;
@@ -188,24 +198,51 @@ bool ThroughputRecorder::Throughput::dump() {
   return true;
 }
 
-ThroughputRecorder::Throughput& ThroughputRecorder::GetThroughput(
+ThroughputRecorder::MediumCounters* ThroughputRecorder::GetMediumCounters(
+    Medium medium) {
+  if (medium < 0 || medium >= static_cast<int>(mediums_.size())) {
+    return nullptr;
+  }
+  return &mediums_[medium];
+}
+
+ThroughputRecorder::Throughput ThroughputRecorder::MakeThroughput(
+    Medium medium, const MediumCounters& counters,
+    absl::Time default_start_timestamp) {
+  int64_t start_nanos = counters.start_nanos.load(std::memory_order_acquire);
+  Throughput throughput(medium,
+                        start_nanos == 0 ? default_start_timestamp
+                                         : absl::FromUnixNanos(start_nanos),
+                        payload_type_, payload_direction_);
+  if (start_nanos != 0) {
+    throughput.Add(counters.total_byte_size.load(std::memory_order_relaxed),
+                   counters.file_io_time.load(std::memory_order_relaxed),
+                   counters.encryption_time.load(std::memory_order_relaxed),
+                   counters.socket_io_time.load(std::memory_order_relaxed));
+    throughput.SetLastTimestamp(absl::FromUnixNanos(
+        counters.last_nanos.load(std::memory_order_relaxed)));
+  }
+  return throughput;
+}
+
+ThroughputRecorder::Throughput ThroughputRecorder::GetThroughput(
     Medium medium, int64_t duration_millis) {
-  auto it = throughputs_.find(medium);
-  if (it == throughputs_.end()) {
-    auto throughput = new Throughput(
-        medium,
-        SystemClock::ElapsedRealtime() - absl::Milliseconds(duration_millis),
-        payload_type_, payload_direction_);
-    throughputs_.emplace(medium, std::move(*throughput));
-    delete throughput;
-    return throughputs_.find(medium)->second;
+  absl::Time default_start_timestamp =
+      SystemClock::ElapsedRealtime() - absl::Milliseconds(duration_millis);
+  MediumCounters* counters = GetMediumCounters(medium);
+  if (counters == nullptr) {
+    return Throughput(medium, default_start_timestamp, payload_type_,
+                      payload_direction_);
   }
-  return it->second;
+  return MakeThroughput(medium, *counters, default_start_timestamp);
 }
 
 int ThroughputRecorder::GetThroughputsSize() {
-  MutexLock lock(&mutex_);
-  return throughputs_.size();
+  int size = 0;
+  for (const MediumCounters& counters : mediums_) {
+    if (counters.frame_count.load(std::memory_order_relaxed) > 0) ++size;
+  }
+  return size;
 }
 
 int ThroughputRecorder::GetThroughputKbps() { return throughput_kbps_; }
@@ -214,45 +251,56 @@ int64_t ThroughputRecorder::GetDurationMillis() { return duration_millis_; }
 
 void ThroughputRecorder::OnFrameSent(Medium medium,
                                      PacketMetaData& packetMetaData) {
-  MutexLock lock(&mutex_);
-  if (payload_type_ == PayloadType::kUnknown) {
-    NEARBY_LOGS(INFO) << "PayloadType is invalid, return";
-    return;
-  }
-
-  duration_millis_ = packetMetaData.GetEncryptionTimeInMillis() +
-                     packetMetaData.GetFileIoTimeInMillis() +
-                     packetMetaData.GetSocketIoTimeInMillis();
-  GetThroughput(medium, duration_millis_)
-      .Add(packetMetaData.packet_size, packetMetaData.GetFileIoTimeInMillis(),
-           packetMetaData.GetEncryptionTimeInMillis(),
-           packetMetaData.GetSocketIoTimeInMillis());
-  CalculateDurationTimes(packetMetaData);
+  OnFrame(medium, packetMetaData);
 }
 
 void ThroughputRecorder::OnFrameReceived(Medium medium,
                                          PacketMetaData& packetMetaData) {
-  MutexLock lock(&mutex_);
+  // Add packetLostAlarm process later
+  OnFrame(medium, packetMetaData);
+}
+
+void ThroughputRecorder::OnFrame(Medium medium,
+                                 PacketMetaData& packetMetaData) {
   if (payload_type_ == PayloadType::kUnknown) {
     NEARBY_LOGS(INFO) << "PayloadType is invalid, return";
     return;
   }
+  MediumCounters* counters = GetMediumCounters(medium);
+  if (counters == nullptr) {
+    return;
+  }
 
-  // Add packetLostAlarm process later
-  duration_millis_ = packetMetaData.GetEncryptionTimeInMillis() +
-                     packetMetaData.GetFileIoTimeInMillis() +
-                     packetMetaData.GetSocketIoTimeInMillis();
-  GetThroughput(medium, duration_millis_)
-      .Add(packetMetaData.packet_size, packetMetaData.GetFileIoTimeInMillis(),
-           packetMetaData.GetEncryptionTimeInMillis(),
-           packetMetaData.GetSocketIoTimeInMillis());
+  int64_t duration_millis = packetMetaData.GetEncryptionTimeInMillis() +
+                            packetMetaData.GetFileIoTimeInMillis() +
+                            packetMetaData.GetSocketIoTimeInMillis();
+  duration_millis_.store(duration_millis, std::memory_order_relaxed);
+
+  int64_t now = absl::ToUnixNanos(SystemClock::ElapsedRealtime());
+  int64_t no_start = 0;
+  counters->start_nanos.compare_exchange_strong(
+      no_start, now - duration_millis * 1000 * 1000, std::memory_order_relaxed);
+  counters->total_byte_size.fetch_add(packetMetaData.packet_size,
+                                      std::memory_order_relaxed);
+  counters->file_io_time.fetch_add(packetMetaData.GetFileIoTimeInMillis(),
+                                   std::memory_order_relaxed);
+  counters->encryption_time.fetch_add(
+      packetMetaData.GetEncryptionTimeInMillis(), std::memory_order_relaxed);
+  counters->socket_io_time.fetch_add(packetMetaData.GetSocketIoTimeInMillis(),
+                                     std::memory_order_relaxed);
+  counters->last_nanos.store(now, std::memory_order_relaxed);
+  // Publishes the updates above to Stop().
+  counters->frame_count.fetch_add(1, std::memory_order_release);
   CalculateDurationTimes(packetMetaData);
 }
 
 void ThroughputRecorder::CalculateDurationTimes(PacketMetaData packetMetaData) {
-  encryption_time_ += packetMetaData.GetEncryptionTimeInMillis();
-  socket_io_time_ += packetMetaData.GetSocketIoTimeInMillis();
-  file_io_time_ += packetMetaData.GetFileIoTimeInMillis();
+  encryption_time_.fetch_add(packetMetaData.GetEncryptionTimeInMillis(),
+                             std::memory_order_relaxed);
+  socket_io_time_.fetch_add(packetMetaData.GetSocketIoTimeInMillis(),
+                            std::memory_order_relaxed);
+  file_io_time_.fetch_add(packetMetaData.GetFileIoTimeInMillis(),
+                          std::memory_order_relaxed);
 }
 
 std::string ThroughputRecorder::ToString(PayloadType type) {
@@ -263,6 +311,8 @@ std::string ThroughputRecorder::ToString(PayloadType type) {
       return std::string("Stream");
     case PayloadType::kFile:
       return std::string("File");
+    case PayloadType::kFileBatch:
+      return std::string("FileBatch");
     case PayloadType::kUnknown:
       return std::string("Unknown");
   }
@@ -272,6 +322,7 @@ std::string ThroughputRecorder::ToString(PayloadType type) {
 
 void ThroughputRecorderContainer::Shutdown() {
   MutexLock lock(&mutex_);
+  generation_.fetch_add(1, std::memory_order_release);
   NEARBY_LOGS(INFO) << __func__
                     << ".  Num of Instance:" << throughput_recorders_.size();
   for (auto& throughput_recorder : throughput_recorders_) {
@@ -284,7 +335,37 @@ void ThroughputRecorderContainer::Shutdown() {
 
 ThroughputRecorder* ThroughputRecorderContainer::GetTPRecorder(
     const int64_t payload_id, PayloadDirection payload_direction) {
+  // Frames of a payload are usually recorded from the same thread, so the
+  // last recorder looked up by each thread is cached to keep the container's
+  // lock off the per-frame path.
+  struct CachedRecorder {
+    int64_t generation = -1;
+    int64_t payload_id = 0;
+    PayloadDirection payload_direction = PayloadDirection::INCOMING_PAYLOAD;
+    ThroughputRecorder* recorder = nullptr;
+  };
+  thread_local CachedRecorder cached_recorder;
+  if (cached_recorder.generation ==
+          generation_.load(std::memory_order_acquire) &&
+      cached_recorder.payload_id == payload_id &&
+      cached_recorder.payload_direction == payload_direction) {
+    return cached_recorder.recorder;
+  }
+
   MutexLock lock(&mutex_);
+  ThroughputRecorder* recorder = GetTPRecorderLocked(payload_id,
+                                                     payload_direction);
+  cached_recorder = {
+      .generation = generation_.load(std::memory_order_relaxed),
+      .payload_id = payload_id,
+      .payload_direction = payload_direction,
+      .recorder = recorder,
+  };
+  return recorder;
+}
+
+ThroughputRecorder* ThroughputRecorderContainer::GetTPRecorderLocked(
+    const int64_t payload_id, PayloadDirection payload_direction) {
   auto it = throughput_recorders_.find(
       std::pair<int64_t, PayloadDirection>(payload_id, payload_direction));
   if (it == throughput_recorders_.end()) {
@@ -315,6 +396,7 @@ void ThroughputRecorderContainer::StopTPRecorder(
     NEARBY_LOGS(INFO) << "Found and stop/delete ThroughputRecorder instance : "
                       << &(it->second) << " for payload_id:" << payload_id
                       << direction;
+    generation_.fetch_add(1, std::memory_order_release);
     it->second->Stop();
     delete it->second;
     throughput_recorders_.erase(
@@ -15,6 +15,8 @@
 #ifndef NEARBY_CONNECTIONS_IMPLEMENTATION_ANALYTICS_THROUGHPUT_RECORDER_H_
 #define NEARBY_CONNECTIONS_IMPLEMENTATION_ANALYTICS_THROUGHPUT_RECORDER_H_
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <string>
 #include <utility>
@@ -36,6 +38,11 @@ using ::nearby::connections::PayloadType;
 // Enum to represent if a payload is incoming or outgoing.
 using ::nearby::connections::PayloadDirection;
 
+// Records per-medium throughput of a payload.
+//
+// OnFrameSent() and OnFrameReceived() are called for every frame and only
+// update atomic counters; the per-medium Throughput results are assembled
+// when the recorder is stopped.
 class ThroughputRecorder {
  public:
   explicit ThroughputRecorder(int64_t payload_id);
@@ -58,7 +65,7 @@ class ThroughputRecorder {
           payload_type_(payload_type),
           payload_direction_(payload_direction) {}
 
-    void Add(int frame_size, int64_t file_io_time, int64_t encryption_time,
+    void Add(int64_t frame_size, int64_t file_io_time, int64_t encryption_time,
              int64_t socket_io_time);
 
     void SetLastTimestamp(absl::Time time_stamp) {
@@ -81,7 +88,9 @@ class ThroughputRecorder {
     int64_t socket_io_time_ = 0;
   };
 
-  Throughput& GetThroughput(Medium medium, int64_t duration_millis);
+  // Returns a snapshot of the throughput recorded so far over `medium`. If no
+  // frame has been recorded for it, the snapshot starts `duration_millis` ago.
+  Throughput GetThroughput(Medium medium, int64_t duration_millis);
   int GetThroughputsSize();
   int GetThroughputKbps();
   int64_t GetDurationMillis();
@@ -90,22 +99,42 @@ class ThroughputRecorder {
   void MarkAsSuccess() { success_ = true; }
 
  private:
+  // Lock-free accumulators for the frames recorded over one medium.
+  struct MediumCounters {
+    std::atomic<int64_t> frame_count{0};
+    std::atomic<int64_t> total_byte_size{0};
+    std::atomic<int64_t> file_io_time{0};
+    std::atomic<int64_t> encryption_time{0};
+    std::atomic<int64_t> socket_io_time{0};
+    // Unix nanoseconds; start_nanos is 0 until the first frame is recorded.
+    std::atomic<int64_t> start_nanos{0};
+    std::atomic<int64_t> last_nanos{0};
+  };
+
+  void OnFrame(Medium medium, PacketMetaData& packetMetaData);
+  MediumCounters* GetMediumCounters(Medium medium);
+  Throughput MakeThroughput(Medium medium, const MediumCounters& counters,
+                            absl::Time default_start_timestamp);
   void CalculateDurationTimes(PacketMetaData packetMetaData);
   static std::string ToString(PayloadType type);
 
+  // Serializes Start() and Stop(); never taken on the per-frame path.
   Mutex mutex_;
   int64_t payload_id_ = 0;
   absl::Time start_timestamp_;
-  PayloadType payload_type_ = PayloadType::kUnknown;
-  PayloadDirection payload_direction_ = PayloadDirection::INCOMING_PAYLOAD;
-  absl::flat_hash_map<Medium, Throughput> throughputs_;
-  bool success_ = false;
-
-  int64_t file_io_time_ = 0;
-  int64_t encryption_time_ = 0;
-  int64_t socket_io_time_ = 0;
-  int64_t duration_millis_ = 0;
-  int throughput_kbps_ = 0;
+  std::atomic<PayloadType> payload_type_{PayloadType::kUnknown};
+  std::atomic<PayloadDirection> payload_direction_{
+      PayloadDirection::INCOMING_PAYLOAD};
+  std::array<MediumCounters,
+             ::location::nearby::proto::connections::Medium_ARRAYSIZE>
+      mediums_;
+  std::atomic<bool> success_{false};
+
+  std::atomic<int64_t> file_io_time_{0};
+  std::atomic<int64_t> encryption_time_{0};
+  std::atomic<int64_t> socket_io_time_{0};
+  std::atomic<int64_t> duration_millis_{0};
+  std::atomic<int> throughput_kbps_{0};
 };
 
 class ThroughputRecorderContainer {
@@ -132,7 +161,14 @@ class ThroughputRecorderContainer {
   ThroughputRecorderContainer() = default;
   ~ThroughputRecorderContainer() = default;
 
-  Mutex mutex_;
+  ThroughputRecorder* GetTPRecorderLocked(int64_t payload_id,
+                                          PayloadDirection payload_direction)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  Mutex mutex_{"ThroughputRecorderContainer::mutex_"};
+  // Bumped whenever a recorder is deleted, invalidating the per-thread
+  // recorder caches used by GetTPRecorder().
+  std::atomic<int64_t> generation_{0};
   // std::pair<int64_t, PayloadDirection> for <payload id, payload direction>
   absl::flat_hash_map<std::pair<int64_t, PayloadDirection>, ThroughputRecorder*>
       throughput_recorders_ ABSL_GUARDED_BY(mutex_);
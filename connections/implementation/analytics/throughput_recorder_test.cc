@@ -18,6 +18,8 @@
 
 #include <ostream>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "absl/time/clock.h"
@@ -220,6 +222,56 @@ TEST_F(ThroughputRecorderTest, OnFrameReceivedCheckDurationMillis) {
                 packet_meta_data.GetSocketIoTimeInMillis());
 }
 
+TEST_F(ThroughputRecorderTest, OnFrameSentFromManyThreadsAddsUp) {
+  constexpr int kThreads = 4;
+  constexpr int kFramesPerThread = 1000;
+  auto TPRecorder = tp_recorder_container_.GetTPRecorder(
+      kPayloadIdA, PayloadDirection::OUTGOING_PAYLOAD);
+  TPRecorder->Start(PayloadType::kFile, PayloadDirection::OUTGOING_PAYLOAD);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([this]() {
+      PacketMetaData packet_meta_data;
+      packet_meta_data.SetPacketSize(kFrameSize);
+      for (int frame = 0; frame < kFramesPerThread; ++frame) {
+        tp_recorder_container_
+            .GetTPRecorder(kPayloadIdA, PayloadDirection::OUTGOING_PAYLOAD)
+            ->OnFrameSent(location::nearby::proto::connections::WIFI_LAN,
+                          packet_meta_data);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(TPRecorder->GetThroughputsSize(), 1);
+  EXPECT_EQ(
+      TPRecorder
+          ->GetThroughput(location::nearby::proto::connections::WIFI_LAN, 0)
+          .GetTotalByteSize(),
+      int64_t{kFrameSize} * kThreads * kFramesPerThread);
+}
+
+TEST(ThroughputRecorderContainer, GetTPRecorderAfterStopReturnsNewInstance) {
+  ThroughputRecorderContainer& TPRecorderContainer =
+      ThroughputRecorderContainer::GetInstance();
+  ThroughputRecorder* recorder = TPRecorderContainer.GetTPRecorder(
+      kPayloadIdA, PayloadDirection::OUTGOING_PAYLOAD);
+  EXPECT_EQ(TPRecorderContainer.GetTPRecorder(
+                kPayloadIdA, PayloadDirection::OUTGOING_PAYLOAD),
+            recorder);
+
+  TPRecorderContainer.StopTPRecorder(kPayloadIdA,
+                                     PayloadDirection::OUTGOING_PAYLOAD);
+  EXPECT_EQ(TPRecorderContainer.GetSize(), 0);
+  TPRecorderContainer.GetTPRecorder(kPayloadIdA,
+                                    PayloadDirection::OUTGOING_PAYLOAD);
+  EXPECT_EQ(TPRecorderContainer.GetSize(), 1);
+  TPRecorderContainer.Shutdown();
+}
+
 TEST_F(ThroughputRecorderTest, OnTPRecorderNotStarted) {
   auto TPRecorder = tp_recorder_container_.GetTPRecorder(
       kPayloadIdA, PayloadDirection::OUTGOING_PAYLOAD);
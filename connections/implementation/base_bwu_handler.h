@@ -55,6 +55,11 @@ class BaseBwuHandler : public BwuHandler {
   virtual void HandleRevertInitiatorStateForService(
       const std::string& upgrade_service_id) = 0;
 
+  // Whether any endpoint is initiating a bandwidth upgrade to this medium.
+  bool HasActiveInitiatorEndpoints() const {
+    return !upgrade_service_id_to_active_endpoint_ids_.empty();
+  }
+
   BwuNotifications bwu_notifications_;
 
  private:
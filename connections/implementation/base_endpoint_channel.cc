@@ -20,12 +20,15 @@
 #include <utility>
 
 #include "absl/strings/str_cat.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/implementation/offline_frames.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/logging.h"
 #include "internal/platform/mutex.h"
 #include "internal/platform/mutex_lock.h"
+#include "internal/platform/tracing.h"
 
 namespace nearby {
 namespace connections {
@@ -108,7 +111,9 @@ ExceptionOr<ByteArray> BaseEndpointChannel::Read() {
 
 ExceptionOr<ByteArray> BaseEndpointChannel::Read(
     PacketMetaData& packet_meta_data) {
+  TraceScope trace("channel", "BaseEndpointChannel::Read");
   ByteArray result;
+  bool decrypted = false;
   {
     MutexLock lock(&reader_mutex_);
 
@@ -118,7 +123,8 @@ ExceptionOr<ByteArray> BaseEndpointChannel::Read(
       return ExceptionOr<ByteArray>(read_int.exception());
     }
 
-    if (read_int.result() < 0 || read_int.result() > kMaxAllowedReadBytes) {
+    if (read_int.result() < 0 ||
+        read_int.result() > transport_config_.max_frame_size) {
       NEARBY_LOGS(WARNING) << __func__ << ": Read an invalid number of bytes: "
                            << read_int.result();
       return ExceptionOr<ByteArray>(Exception::kIo);
@@ -130,17 +136,21 @@ ExceptionOr<ByteArray> BaseEndpointChannel::Read(
     }
     packet_meta_data.StopSocketIo();
     packet_meta_data.SetPacketSize(read_int.result() + sizeof(std::int32_t));
+    trace.SetArg("bytes", packet_meta_data.packet_size);
     result = std::move(read_bytes.result());
   }
 
   {
     MutexLock crypto_lock(&crypto_mutex_);
     if (IsEncryptionEnabledLocked()) {
-      // If encryption is enabled, decode the message.
+      // If encryption is enabled, decode the message. The ciphertext is moved,
+      // not copied, out of |result|.
       std::string input(std::move(result));
       packet_meta_data.StartEncryption();
+      decrypted = true;
       std::unique_ptr<std::string> decrypted_data =
-          crypto_context_->DecodeMessageFromPeer(input);
+          aead_cipher_ ? aead_cipher_->Open(input)
+                       : crypto_context_->DecodeMessageFromPeer(input);
       if (decrypted_data) {
         result = ByteArray(std::move(*decrypted_data));
       } else {
@@ -151,14 +161,15 @@ ExceptionOr<ByteArray> BaseEndpointChannel::Read(
         // and let it through if it is, otherwise message is erased.
         // TODO(apolyudov): verify this happens at most once per session.
         result = {};
-        auto parsed = parser::FromBytes(ByteArray(input));
+        ByteArray unencrypted(std::move(input));
+        auto parsed = parser::FromBytes(unencrypted);
         if (parsed.ok()) {
           if (parser::GetFrameType(parsed.result()) ==
               location::nearby::connections::V1Frame::KEEP_ALIVE) {
             NEARBY_LOGS(INFO)
                 << __func__
                 << ": Read unencrypted KEEP_ALIVE on encrypted channel.";
-            result = ByteArray(input);
+            result = std::move(unencrypted);
           } else {
             NEARBY_LOGS(WARNING)
                 << __func__ << ": Read unexpected unencrypted frame of type "
@@ -181,7 +192,11 @@ ExceptionOr<ByteArray> BaseEndpointChannel::Read(
     MutexLock lock(&last_read_mutex_);
     last_read_timestamp_ = SystemClock::ElapsedRealtime();
   }
-  return ExceptionOr<ByteArray>(result);
+  if (std::shared_ptr<EndpointStatsRecorder> stats_recorder =
+          GetStatsRecorder()) {
+    stats_recorder->RecordRead(packet_meta_data, decrypted);
+  }
+  return ExceptionOr<ByteArray>(std::move(result));
 }
 
 Exception BaseEndpointChannel::Write(const ByteArray& data) {
@@ -191,6 +206,53 @@ Exception BaseEndpointChannel::Write(const ByteArray& data) {
 
 Exception BaseEndpointChannel::Write(const ByteArray& data,
                                      PacketMetaData& packet_meta_data) {
+  return Write(data, packet_meta_data, WritePriority::kControl);
+}
+
+Exception BaseEndpointChannel::Write(const ByteArray& data,
+                                     PacketMetaData& packet_meta_data,
+                                     WritePriority priority) {
+  return DoWrite(absl::MakeConstSpan(&data, 1), packet_meta_data, priority);
+}
+
+Exception BaseEndpointChannel::WriteFrames(const std::vector<ByteArray>& frames,
+                                           PacketMetaData& packet_meta_data,
+                                           WritePriority priority) {
+  return DoWrite(frames, packet_meta_data, priority);
+}
+
+void BaseEndpointChannel::StartWrite(WritePriority priority) {
+  const int priority_index = static_cast<int>(priority);
+  MutexLock lock(&write_queue_mutex_);
+  ++waiting_writers_[priority_index];
+  while (true) {
+    bool higher_priority_waiting = false;
+    for (int i = 0; i < priority_index; ++i) {
+      if (waiting_writers_[i] > 0) {
+        higher_priority_waiting = true;
+        break;
+      }
+    }
+    if (!write_in_progress_ && !higher_priority_waiting) break;
+    write_queue_cond_.Wait();
+  }
+  --waiting_writers_[priority_index];
+  write_in_progress_ = true;
+}
+
+void BaseEndpointChannel::FinishWrite() {
+  MutexLock lock(&write_queue_mutex_);
+  write_in_progress_ = false;
+  write_queue_cond_.Notify();
+}
+
+Exception BaseEndpointChannel::DoWrite(absl::Span<const ByteArray> frames,
+                                       PacketMetaData& packet_meta_data,
+                                       WritePriority priority) {
+  TraceScope trace("channel", "BaseEndpointChannel::Write");
+  trace.SetArg("frames", frames.size());
+  std::shared_ptr<EndpointStatsRecorder> stats_recorder = GetStatsRecorder();
+  if (stats_recorder) stats_recorder->OnWriteQueued();
   {
     MutexLock pause_lock(&is_paused_mutex_);
     if (is_paused_) {
@@ -198,66 +260,144 @@ Exception BaseEndpointChannel::Write(const ByteArray& data,
     }
   }
 
-  ByteArray encrypted_data;
-  const ByteArray* data_to_write = &data;
+  bool schedule_writes = NearbyFlags::GetInstance().GetBoolFlag(
+      config_package_nearby::nearby_connections_feature::
+          kEnablePriorityWriteScheduling);
+  bool coalesce = ShouldCoalesceWrites();
+  if (coalesce) ++pending_writes_;
+  if (schedule_writes) StartWrite(priority);
+  Exception exception;
+  bool encrypted = false;
   {
     // Holding both mutexes is necessary to prevent the keep alive and payload
     // threads from writing encrypted messages out of order which causes a
     // failure to decrypt on the reader side. However we need to release the
     // crypto lock after encrypting to ensure read decryption is not blocked.
     MutexLock lock(&writer_mutex_);
-    {
-      MutexLock crypto_lock(&crypto_mutex_);
-      if (IsEncryptionEnabledLocked()) {
-        // If encryption is enabled, encode the message.
-        packet_meta_data.StartEncryption();
+    exception = DoWriteLocked(frames, packet_meta_data, coalesce);
+    encrypted = write_encrypted_;
+    if (coalesce) --pending_writes_;
+  }
+  if (schedule_writes) FinishWrite();
+  if (stats_recorder) {
+    stats_recorder->OnWriteDone();
+    if (exception.Ok()) {
+      stats_recorder->RecordWrite(frames.size(), packet_meta_data, encrypted);
+    }
+  }
+  if (!exception.Ok()) return exception;
+
+  {
+    MutexLock lock(&last_write_mutex_);
+    last_write_timestamp_ = SystemClock::ElapsedRealtime();
+  }
+  return {Exception::kSuccess};
+}
+
+void BaseEndpointChannel::FlushDeferredLocked() {
+  // Don't strand what an earlier write left for us to flush.
+  if (flush_deferred_) {
+    writer_->Flush();
+    flush_deferred_ = false;
+  }
+}
+
+Exception BaseEndpointChannel::DoWriteLocked(
+    absl::Span<const ByteArray> frames, PacketMetaData& packet_meta_data,
+    bool coalesce) {
+  std::vector<ByteArray> encrypted_frames;
+  {
+    MutexLock crypto_lock(&crypto_mutex_);
+    write_encrypted_ = IsEncryptionEnabledLocked();
+    if (write_encrypted_) {
+      // If encryption is enabled, encode the messages.
+      packet_meta_data.StartEncryption();
+      encrypted_frames.reserve(frames.size());
+      for (const ByteArray& frame : frames) {
         std::unique_ptr<std::string> encrypted =
-            crypto_context_->EncodeMessageToPeer(std::string(data));
-        packet_meta_data.StopEncryption();
+            aead_cipher_
+                ? aead_cipher_->Seal(frame.AsStringView())
+                : crypto_context_->EncodeMessageToPeer(frame.AsStringRef());
         if (!encrypted) {
           NEARBY_LOGS(WARNING) << __func__ << ": Failed to encrypt data.";
+          FlushDeferredLocked();
           return {Exception::kIo};
         }
-        encrypted_data = ByteArray(std::move(*encrypted));
-        data_to_write = &encrypted_data;
+        encrypted_frames.push_back(ByteArray(std::move(*encrypted)));
       }
+      packet_meta_data.StopEncryption();
+      frames = encrypted_frames;
     }
+  }
 
-    size_t data_size = data_to_write->size();
-    if (data_size < 0 || data_size > kMaxAllowedReadBytes) {
+  size_t total_size = 0;
+  packet_meta_data.StartSocketIo();
+  for (const ByteArray& data_to_write : frames) {
+    size_t data_size = data_to_write.size();
+    if (data_size < 0 || data_size > transport_config_.max_frame_size) {
       NEARBY_LOGS(WARNING) << __func__ << ": Write an invalid number of bytes: "
                            << data_size;
+      FlushDeferredLocked();
       return {Exception::kIo};
     }
+    total_size += data_size + sizeof(std::uint32_t);
+  }
 
-    packet_meta_data.StartSocketIo();
-    Exception write_exception =
-        WriteInt(writer_, static_cast<std::int32_t>(data_size));
-    if (write_exception.Raised()) {
-      NEARBY_LOGS(WARNING) << __func__ << ": Failed to write header: "
-                           << write_exception.value;
-      return write_exception;
+  if (coalesce) {
+    // One contiguous buffer keeps each length prefix in the same medium write
+    // as its frame, instead of costing a separate packet.
+    std::string buffer;
+    buffer.reserve(total_size);
+    for (const ByteArray& data_to_write : frames) {
+      ByteArray header =
+          IntToBytes(static_cast<std::int32_t>(data_to_write.size()));
+      buffer.append(header.data(), header.size());
+      buffer.append(data_to_write.data(), data_to_write.size());
     }
-    write_exception = writer_->Write(*data_to_write);
+    Exception write_exception = writer_->Write(ByteArray(std::move(buffer)));
     if (write_exception.Raised()) {
       NEARBY_LOGS(WARNING) << __func__ << ": Failed to write data: "
                            << write_exception.value;
+      FlushDeferredLocked();
       return write_exception;
     }
-    Exception flush_exception = writer_->Flush();
-    if (flush_exception.Raised()) {
-      NEARBY_LOGS(WARNING) << __func__ << ": Failed to flush writer: "
-                           << flush_exception.value;
-      return flush_exception;
+  } else {
+    for (const ByteArray& data_to_write : frames) {
+      Exception write_exception = WriteInt(
+          writer_, static_cast<std::int32_t>(data_to_write.size()));
+      if (write_exception.Raised()) {
+        NEARBY_LOGS(WARNING) << __func__ << ": Failed to write header: "
+                             << write_exception.value;
+        FlushDeferredLocked();
+        return write_exception;
+      }
+      write_exception = writer_->Write(data_to_write);
+      if (write_exception.Raised()) {
+        NEARBY_LOGS(WARNING) << __func__ << ": Failed to write data: "
+                             << write_exception.value;
+        FlushDeferredLocked();
+        return write_exception;
+      }
     }
-    packet_meta_data.StopSocketIo();
-    packet_meta_data.SetPacketSize(data_size + sizeof(std::uint32_t));
   }
 
-  {
-    MutexLock lock(&last_write_mutex_);
-    last_write_timestamp_ = SystemClock::ElapsedRealtime();
+  // pending_writes_ includes this write, so any more means another writer is
+  // waiting and will flush both.
+  if (coalesce && pending_writes_.load() > 1) {
+    flush_deferred_ = true;
+    packet_meta_data.StopSocketIo();
+    packet_meta_data.SetPacketSize(total_size);
+    return {Exception::kSuccess};
   }
+  flush_deferred_ = false;
+  Exception flush_exception = writer_->Flush();
+  if (flush_exception.Raised()) {
+    NEARBY_LOGS(WARNING) << __func__ << ": Failed to flush writer: "
+                         << flush_exception.value;
+    return flush_exception;
+  }
+  packet_meta_data.StopSocketIo();
+  packet_meta_data.SetPacketSize(total_size);
   return {Exception::kSuccess};
 }
 
@@ -302,6 +442,19 @@ void BaseEndpointChannel::SetAnalyticsRecorder(
   endpoint_id_ = endpoint_id;
 }
 
+void BaseEndpointChannel::SetStatsRecorder(
+    std::shared_ptr<EndpointStatsRecorder> stats_recorder) {
+  if (stats_recorder) stats_recorder->SetMedium(GetMedium());
+  MutexLock lock(&stats_mutex_);
+  stats_recorder_ = std::move(stats_recorder);
+}
+
+std::shared_ptr<EndpointStatsRecorder> BaseEndpointChannel::GetStatsRecorder()
+    const {
+  MutexLock lock(&stats_mutex_);
+  return stats_recorder_;
+}
+
 void BaseEndpointChannel::Close(
     location::nearby::proto::connections::DisconnectionReason reason) {
   NEARBY_LOGS(INFO) << __func__
@@ -332,20 +485,34 @@ std::string BaseEndpointChannel::GetServiceId() const { return service_id_; }
 
 std::string BaseEndpointChannel::GetName() const { return channel_name_; }
 
+bool BaseEndpointChannel::ShouldCoalesceWrites() const {
+  return NearbyFlags::GetInstance().GetBoolFlag(
+      config_package_nearby::nearby_connections_feature::
+          kEnableWriteCoalescing);
+}
+
 int BaseEndpointChannel::GetMaxTransmitPacketSize() const {
   // Return default value if the medium never define it's chunk size.
-  return kDefaultMaxTransmitPacketSize;
+  return transport_config_.max_transmit_packet_size;
 }
 
 void BaseEndpointChannel::EnableEncryption(
     std::shared_ptr<EncryptionContext> context) {
   MutexLock crypto_lock(&crypto_mutex_);
   crypto_context_ = context;
+  aead_cipher_.reset();
+}
+
+void BaseEndpointChannel::EnableAeadEncryption(
+    std::shared_ptr<AeadFrameCipher> cipher) {
+  MutexLock crypto_lock(&crypto_mutex_);
+  aead_cipher_ = cipher;
 }
 
 void BaseEndpointChannel::DisableEncryption() {
   MutexLock crypto_lock(&crypto_mutex_);
   crypto_context_.reset();
+  aead_cipher_.reset();
 }
 
 bool BaseEndpointChannel::IsPaused() const {
@@ -392,7 +559,7 @@ int BaseEndpointChannel::GetFrequency() const { return frequency_; }
 int BaseEndpointChannel::GetTryCount() const { return try_count_; }
 
 bool BaseEndpointChannel::IsEncryptionEnabledLocked() const {
-  return crypto_context_ != nullptr;
+  return crypto_context_ != nullptr || aead_cipher_ != nullptr;
 }
 
 void BaseEndpointChannel::BlockUntilUnpaused() {
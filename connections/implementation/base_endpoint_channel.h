@@ -15,13 +15,18 @@
 #ifndef CORE_INTERNAL_BASE_ENDPOINT_CHANNEL_H_
 #define CORE_INTERNAL_BASE_ENDPOINT_CHANNEL_H_
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/types/span.h"
 #include "connections/implementation/analytics/analytics_recorder.h"
 #include "connections/implementation/endpoint_channel.h"
+#include "connections/implementation/endpoint_stats.h"
+#include "connections/implementation/transport_config.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/condition_variable.h"
 #include "internal/platform/input_stream.h"
@@ -54,6 +59,15 @@ class BaseEndpointChannel : public EndpointChannel {
   Exception Write(const ByteArray& data) override;
   Exception Write(const ByteArray& data, PacketMetaData& packet_meta_data)
       ABSL_LOCKS_EXCLUDED(writer_mutex_, crypto_mutex_) override;
+  Exception Write(const ByteArray& data, PacketMetaData& packet_meta_data,
+                  WritePriority priority)
+      ABSL_LOCKS_EXCLUDED(write_queue_mutex_, writer_mutex_,
+                          crypto_mutex_) override;
+  Exception WriteFrames(const std::vector<ByteArray>& frames,
+                        PacketMetaData& packet_meta_data,
+                        WritePriority priority)
+      ABSL_LOCKS_EXCLUDED(write_queue_mutex_, writer_mutex_,
+                          crypto_mutex_) override;
   void Close() ABSL_LOCKS_EXCLUDED(is_paused_mutex_) override;
   void Close(location::nearby::proto::connections::DisconnectionReason reason)
       override;
@@ -67,6 +81,7 @@ class BaseEndpointChannel : public EndpointChannel {
   int GetTryCount() const override;
   int GetMaxTransmitPacketSize() const override;
   void EnableEncryption(std::shared_ptr<EncryptionContext> context) override;
+  void EnableAeadEncryption(std::shared_ptr<AeadFrameCipher> cipher) override;
   void DisableEncryption() override;
   bool IsPaused() const ABSL_LOCKS_EXCLUDED(is_paused_mutex_) override;
   void Pause() ABSL_LOCKS_EXCLUDED(is_paused_mutex_) override;
@@ -77,22 +92,41 @@ class BaseEndpointChannel : public EndpointChannel {
       ABSL_LOCKS_EXCLUDED(last_write_mutex_) override;
   void SetAnalyticsRecorder(analytics::AnalyticsRecorder* analytics_recorder,
                             const std::string& endpoint_id) override;
+  void SetStatsRecorder(std::shared_ptr<EndpointStatsRecorder> stats_recorder)
+      ABSL_LOCKS_EXCLUDED(stats_mutex_) override;
 
  protected:
   virtual void CloseImpl() = 0;
 
- private:
-  // Used to sanity check that our frame sizes are reasonable.
-  static constexpr std::int32_t kMaxAllowedReadBytes = 1048576;  // 1MB
-
-  // The default maximum transmit unit/packet size.
-  static constexpr int kDefaultMaxTransmitPacketSize = 65536;  // 64 KB
+  // Whether writes are coalesced, see DoWriteLocked(). Follows
+  // kEnableWriteCoalescing unless a medium needs it regardless.
+  virtual bool ShouldCoalesceWrites() const;
 
+ private:
+  std::shared_ptr<EndpointStatsRecorder> GetStatsRecorder() const
+      ABSL_LOCKS_EXCLUDED(stats_mutex_);
   bool IsEncryptionEnabledLocked() const
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(crypto_mutex_);
   void UnblockPausedWriter() ABSL_EXCLUSIVE_LOCKS_REQUIRED(is_paused_mutex_);
   void BlockUntilUnpaused() ABSL_EXCLUSIVE_LOCKS_REQUIRED(is_paused_mutex_);
   void CloseIo() ABSL_NO_THREAD_SAFETY_ANALYSIS;
+  // Waits until no write is in progress and no write of a higher priority is
+  // waiting, then marks a write of |priority| as in progress.
+  void StartWrite(WritePriority priority)
+      ABSL_LOCKS_EXCLUDED(write_queue_mutex_);
+  void FinishWrite() ABSL_LOCKS_EXCLUDED(write_queue_mutex_);
+  // Encrypts and writes |frames| under a single writer lock, with one flush.
+  Exception DoWrite(absl::Span<const ByteArray> frames,
+                    PacketMetaData& packet_meta_data, WritePriority priority)
+      ABSL_LOCKS_EXCLUDED(write_queue_mutex_, writer_mutex_, crypto_mutex_);
+  // With |coalesce|, every length prefix and frame goes out in one write, and
+  // the flush is left to a later write if one is already lined up.
+  Exception DoWriteLocked(absl::Span<const ByteArray> frames,
+                          PacketMetaData& packet_meta_data, bool coalesce)
+      ABSL_LOCKS_EXCLUDED(crypto_mutex_)
+          ABSL_EXCLUSIVE_LOCKS_REQUIRED(writer_mutex_);
+  // Flushes what a coalesced write left to this one, on its error paths.
+  void FlushDeferredLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(writer_mutex_);
 
   // We need a separate mutex to protect read timestamp, because if a read
   // blocks on IO, we don't want timestamp read access to block too.
@@ -108,6 +142,9 @@ class BaseEndpointChannel : public EndpointChannel {
 
   const std::string service_id_;
   const std::string channel_name_;
+  // Read once, so that the frame and packet sizes stay the same for the
+  // lifetime of the channel.
+  const TransportConfig transport_config_ = TransportConfig::Get();
 
   // The reader and writer are synchronized independently since we can't have
   // writes waiting on reads that might potentially block forever.
@@ -116,11 +153,29 @@ class BaseEndpointChannel : public EndpointChannel {
 
   Mutex writer_mutex_;
   OutputStream* writer_ ABSL_PT_GUARDED_BY(writer_mutex_);
+  // Set when a coalesced write skipped its flush for the writer after it.
+  bool flush_deferred_ ABSL_GUARDED_BY(writer_mutex_) = false;
+  // Whether the last DoWriteLocked() encrypted its frames.
+  bool write_encrypted_ ABSL_GUARDED_BY(writer_mutex_) = false;
+  // Number of coalescing writers between unpausing and finishing, including
+  // the one holding |writer_mutex_|.
+  std::atomic<int> pending_writes_{0};
+
+  // Orders concurrent writers by WritePriority, so that e.g. a keep-alive
+  // doesn't queue up behind a run of file chunks. Writers of the same
+  // priority are let through in no particular order.
+  Mutex write_queue_mutex_;
+  ConditionVariable write_queue_cond_{&write_queue_mutex_};
+  bool write_in_progress_ ABSL_GUARDED_BY(write_queue_mutex_) = false;
+  int waiting_writers_[static_cast<int>(WritePriority::kFilePayload) + 1]
+      ABSL_GUARDED_BY(write_queue_mutex_) = {};
 
   // An encryptor/decryptor. May be null.
   mutable Mutex crypto_mutex_;
   std::shared_ptr<EncryptionContext> crypto_context_
       ABSL_GUARDED_BY(crypto_mutex_) ABSL_PT_GUARDED_BY(crypto_mutex_);
+  // Used in place of |crypto_context_| if set. May be null.
+  std::shared_ptr<AeadFrameCipher> aead_cipher_ ABSL_GUARDED_BY(crypto_mutex_);
 
   mutable Mutex is_paused_mutex_;
   ConditionVariable is_paused_cond_{&is_paused_mutex_};
@@ -135,6 +190,10 @@ class BaseEndpointChannel : public EndpointChannel {
 
   analytics::AnalyticsRecorder* analytics_recorder_ = nullptr;
   std::string endpoint_id_ = "";
+
+  mutable Mutex stats_mutex_;
+  std::shared_ptr<EndpointStatsRecorder> stats_recorder_
+      ABSL_GUARDED_BY(stats_mutex_);
 };
 
 }  // namespace connections
@@ -14,9 +14,12 @@
 
 #include "connections/implementation/base_endpoint_channel.h"
 
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "securegcm/d2d_connection_context_v1.h"
 #include "securegcm/ukey2_handshake.h"
@@ -25,10 +28,16 @@
 #include "gtest/gtest.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
+#include "connections/implementation/aead_frame_cipher.h"
 #include "connections/implementation/encryption_runner.h"
+#include "connections/implementation/endpoint_stats.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/implementation/offline_frames.h"
+#include "connections/implementation/transport_config.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/exception.h"
+#include "internal/platform/future.h"
 #include "internal/platform/input_stream.h"
 #include "internal/platform/output_stream.h"
 #include "internal/platform/count_down_latch.h"
@@ -55,6 +64,59 @@ class TestEndpointChannel : public BaseEndpointChannel {
   MOCK_METHOD(void, CloseImpl, (), (override));
 };
 
+// Records everything written to it. The first write blocks until Unblock()
+// is called.
+class BlockingOutputStream : public OutputStream {
+ public:
+  Exception Write(const ByteArray& data) override {
+    {
+      absl::MutexLock lock(&mutex_);
+      if (!first_write_started_) {
+        first_write_started_ = true;
+        mutex_.Await(absl::Condition(&unblocked_));
+      }
+      written_ += std::string(data);
+      ++write_count_;
+    }
+    return {Exception::kSuccess};
+  }
+  Exception Flush() override {
+    absl::MutexLock lock(&mutex_);
+    ++flush_count_;
+    return {Exception::kSuccess};
+  }
+  Exception Close() override { return {Exception::kSuccess}; }
+
+  void WaitForFirstWrite() {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(&first_write_started_));
+  }
+  void Unblock() {
+    absl::MutexLock lock(&mutex_);
+    unblocked_ = true;
+  }
+  std::string GetWritten() {
+    absl::MutexLock lock(&mutex_);
+    return written_;
+  }
+  int GetWriteCount() {
+    absl::MutexLock lock(&mutex_);
+    return write_count_;
+  }
+  int GetFlushCount() {
+    absl::MutexLock lock(&mutex_);
+    return flush_count_;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  bool first_write_started_ ABSL_GUARDED_BY(mutex_) = false;
+  bool unblocked_ ABSL_GUARDED_BY(mutex_) = false;
+  std::string written_ ABSL_GUARDED_BY(mutex_);
+  int write_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int flush_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
 std::function<void()> MakeDataPump(
     std::string label, InputStream* input, OutputStream* output,
     std::function<void(const ByteArray&)> monitor = nullptr) {
@@ -178,6 +240,81 @@ TEST(BaseEndpointChannelTest, ReadWrite) {
   EXPECT_EQ(rx_message, tx_message);
 }
 
+TEST(BaseEndpointChannelTest, WriteFramesReadsBackAsSeparateFrames) {
+  Pipe pipe_a;  // channel_a writes to pipe_a, reads from pipe_b.
+  Pipe pipe_b;  // channel_b writes to pipe_b, reads from pipe_a.
+  TestEndpointChannel channel_a(&pipe_b.GetInputStream(),
+                                &pipe_a.GetOutputStream());
+  TestEndpointChannel channel_b(&pipe_a.GetInputStream(),
+                                &pipe_b.GetOutputStream());
+  std::vector<ByteArray> tx_frames{ByteArray{"data chunk"},
+                                   ByteArray{"last chunk"}};
+  PacketMetaData packet_meta_data;
+  EXPECT_TRUE(channel_a
+                  .WriteFrames(tx_frames, packet_meta_data,
+                               WritePriority::kBytesPayload)
+                  .Ok());
+  EXPECT_EQ(channel_b.Read().result(), tx_frames[0]);
+  EXPECT_EQ(channel_b.Read().result(), tx_frames[1]);
+}
+
+TEST(BaseEndpointChannelTest, RecordsStatsOfReadsAndWrites) {
+  Pipe pipe_a;  // channel_a writes to pipe_a, reads from pipe_b.
+  Pipe pipe_b;  // channel_b writes to pipe_b, reads from pipe_a.
+  TestEndpointChannel channel_a(&pipe_b.GetInputStream(),
+                                &pipe_a.GetOutputStream());
+  TestEndpointChannel channel_b(&pipe_a.GetInputStream(),
+                                &pipe_b.GetOutputStream());
+  ON_CALL(channel_a, GetMedium).WillByDefault([]() { return Medium::BLE; });
+  auto stats_a = std::make_shared<EndpointStatsRecorder>();
+  auto stats_b = std::make_shared<EndpointStatsRecorder>();
+  channel_a.SetStatsRecorder(stats_a);
+  channel_b.SetStatsRecorder(stats_b);
+  std::vector<ByteArray> tx_frames{ByteArray{"data chunk"},
+                                   ByteArray{"last chunk"}};
+  PacketMetaData packet_meta_data;
+
+  EXPECT_TRUE(channel_a
+                  .WriteFrames(tx_frames, packet_meta_data,
+                               WritePriority::kBytesPayload)
+                  .Ok());
+  EXPECT_TRUE(channel_b.Read().ok());
+  EXPECT_TRUE(channel_b.Read().ok());
+
+  EndpointStats written = stats_a->GetStats();
+  EXPECT_EQ(written.medium, Medium::BLE);
+  EXPECT_EQ(written.frames_written, 2);
+  EXPECT_EQ(written.bytes_written, 2 * (sizeof(std::int32_t) + 10));
+  EXPECT_GT(written.write_bytes_per_second, 0);
+  EXPECT_GT(written.write_latency_p50, absl::ZeroDuration());
+  EXPECT_EQ(written.write_queue_depth, 0);
+  EndpointStats read = stats_b->GetStats();
+  EXPECT_EQ(read.frames_read, 2);
+  EXPECT_EQ(read.bytes_read, written.bytes_written);
+  EXPECT_EQ(read.frames_written, 0);
+}
+
+TEST(BaseEndpointChannelTest, ReadWriteAsync) {
+  Pipe pipe_a;  // channel_a writes to pipe_a, reads from pipe_b.
+  Pipe pipe_b;  // channel_b writes to pipe_b, reads from pipe_a.
+  TestEndpointChannel channel_a(&pipe_b.GetInputStream(),
+                                &pipe_a.GetOutputStream());
+  TestEndpointChannel channel_b(&pipe_a.GetInputStream(),
+                                &pipe_b.GetOutputStream());
+  SingleThreadExecutor reader;
+  SingleThreadExecutor writer;
+  ByteArray tx_message{"data message"};
+
+  Future<ByteArray> rx_message = channel_b.ReadAsync(&reader);
+  EXPECT_FALSE(rx_message.IsSet());
+  EXPECT_TRUE(
+      channel_a.WriteAsync(tx_message, WritePriority::kBytesPayload, &writer)
+          .Get(absl::Seconds(5))
+          .ok());
+
+  EXPECT_EQ(rx_message.Get(absl::Seconds(5)).result(), tx_message);
+}
+
 TEST(BaseEndpointChannelTest, NotEncryptedReadWriteCanBeIntercepted) {
   // Not encrypted IO; MITM scenario.
 
@@ -287,6 +424,56 @@ TEST(BaseEndpointChannelTest, EncryptedReadWriteCanNotBeIntercepted) {
   channel_b.Close(DisconnectionReason::REMOTE_DISCONNECTION);
 }
 
+TEST(BaseEndpointChannelTest, AeadEncryptedReadWriteCanNotBeIntercepted) {
+  // Setup test communication environment.
+  absl::Mutex mutex;
+  std::string capture_a;
+  std::string capture_b;
+  Pipe client_a;  // Channel "a" writes to client "a", reads from server "a".
+  Pipe client_b;  // Channel "b" writes to client "b", reads from server "b".
+  Pipe server_a;  // Data pump "a" reads from client "a", writes to server "b".
+  Pipe server_b;  // Data pump "b" reads from client "b", writes to server "a".
+  TestEndpointChannel channel_a(&server_a.GetInputStream(),
+                                &client_a.GetOutputStream());
+  TestEndpointChannel channel_b(&server_b.GetInputStream(),
+                                &client_b.GetOutputStream());
+
+  MultiThreadExecutor executor(2);
+  executor.Execute(MakeDataPump(
+      "pump_a", &client_a.GetInputStream(), &server_b.GetOutputStream(),
+      MakeDataMonitor("monitor_a", &capture_a, &mutex)));
+  executor.Execute(MakeDataPump(
+      "pump_b", &client_b.GetInputStream(), &server_a.GetOutputStream(),
+      MakeDataMonitor("monitor_b", &capture_b, &mutex)));
+
+  channel_a.EnableAeadEncryption(std::make_shared<AeadFrameCipher>(
+      "session unique", /*is_server=*/false));
+  channel_b.EnableAeadEncryption(std::make_shared<AeadFrameCipher>(
+      "session unique", /*is_server=*/true));
+
+  // Start data transfer
+  ByteArray tx_message{"data message"};
+  ByteArray reply{"reply message"};
+  channel_a.Write(tx_message);
+  ByteArray rx_message = std::move(channel_b.Read().result());
+  channel_b.Write(reply);
+  ByteArray rx_reply = std::move(channel_a.Read().result());
+
+  // Verify expectations.
+  EXPECT_EQ(rx_message, tx_message);
+  EXPECT_EQ(rx_reply, reply);
+  {
+    absl::MutexLock lock(&mutex);
+    std::string message{tx_message};
+    EXPECT_TRUE(capture_a.find(message) == std::string::npos &&
+                capture_b.find(message) == std::string::npos);
+  }
+
+  // Shutdown test environment.
+  channel_a.Close(DisconnectionReason::LOCAL_DISCONNECTION);
+  channel_b.Close(DisconnectionReason::REMOTE_DISCONNECTION);
+}
+
 TEST(BaseEndpointChannelTest, CanBesuspendedAndResumed) {
   // Setup test communication environment.
   Pipe pipe_a;  // channel_a writes to pipe_a, reads from pipe_b.
@@ -341,6 +528,151 @@ TEST(BaseEndpointChannelTest, CanBesuspendedAndResumed) {
   channel_b.Close(DisconnectionReason::REMOTE_DISCONNECTION);
 }
 
+TEST(BaseEndpointChannelTest, ControlFramesAreWrittenBeforeQueuedFileChunks) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnablePriorityWriteScheduling,
+      true);
+  Pipe pipe;
+  BlockingOutputStream output_stream;
+  TestEndpointChannel channel(&pipe.GetInputStream(), &output_stream);
+  MultiThreadExecutor executor(3);
+
+  // Keep the channel busy with a first file chunk, so the next writes queue.
+  executor.Execute([&channel]() {
+    PacketMetaData packet_meta_data;
+    EXPECT_TRUE(channel
+                    .Write(ByteArray("file-chunk-1"), packet_meta_data,
+                           WritePriority::kFilePayload)
+                    .Ok());
+  });
+  output_stream.WaitForFirstWrite();
+  executor.Execute([&channel]() {
+    PacketMetaData packet_meta_data;
+    EXPECT_TRUE(channel
+                    .Write(ByteArray("file-chunk-2"), packet_meta_data,
+                           WritePriority::kFilePayload)
+                    .Ok());
+  });
+  absl::SleepFor(absl::Milliseconds(100));
+  executor.Execute(
+      [&channel]() { EXPECT_TRUE(channel.Write(ByteArray("control")).Ok()); });
+  absl::SleepFor(absl::Milliseconds(100));
+  output_stream.Unblock();
+  executor.Shutdown();
+
+  std::string written = output_stream.GetWritten();
+  ASSERT_NE(written.find("file-chunk-2"), std::string::npos);
+  EXPECT_LT(written.find("file-chunk-1"), written.find("control"));
+  EXPECT_LT(written.find("control"), written.find("file-chunk-2"));
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST(BaseEndpointChannelTest, CoalescedWriteFramesIsOneMediumWrite) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableWriteCoalescing,
+      true);
+  Pipe pipe;
+  BlockingOutputStream output_stream;
+  output_stream.Unblock();
+  TestEndpointChannel channel_a(&pipe.GetInputStream(), &output_stream);
+  std::vector<ByteArray> tx_frames{ByteArray{"data chunk"},
+                                   ByteArray{"last chunk"}};
+  PacketMetaData packet_meta_data;
+  EXPECT_TRUE(channel_a
+                  .WriteFrames(tx_frames, packet_meta_data,
+                               WritePriority::kBytesPayload)
+                  .Ok());
+  EXPECT_EQ(output_stream.GetWriteCount(), 1);
+  EXPECT_EQ(output_stream.GetFlushCount(), 1);
+
+  // What went out still reads back as the separate frames.
+  Pipe pipe_b;
+  pipe_b.GetOutputStream().Write(ByteArray(output_stream.GetWritten()));
+  TestEndpointChannel channel_b(&pipe_b.GetInputStream(),
+                                &pipe.GetOutputStream());
+  EXPECT_EQ(channel_b.Read().result(), tx_frames[0]);
+  EXPECT_EQ(channel_b.Read().result(), tx_frames[1]);
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST(BaseEndpointChannelTest, MediumCanCoalesceWritesWithoutFlag) {
+  class CoalescingEndpointChannel : public TestEndpointChannel {
+   public:
+    using TestEndpointChannel::TestEndpointChannel;
+
+   protected:
+    bool ShouldCoalesceWrites() const override { return true; }
+  };
+  Pipe pipe;
+  BlockingOutputStream output_stream;
+  output_stream.Unblock();
+  CoalescingEndpointChannel channel(&pipe.GetInputStream(), &output_stream);
+  EXPECT_TRUE(channel.Write(ByteArray("frame")).Ok());
+  EXPECT_EQ(output_stream.GetWriteCount(), 1);
+}
+
+TEST(BaseEndpointChannelTest, CoalescedWritesLeaveFlushToLastQueuedWrite) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableWriteCoalescing,
+      true);
+  Pipe pipe;
+  BlockingOutputStream output_stream;
+  TestEndpointChannel channel(&pipe.GetInputStream(), &output_stream);
+  MultiThreadExecutor executor(3);
+
+  // Keep the channel busy with a first write, so the next writes queue.
+  executor.Execute(
+      [&channel]() { EXPECT_TRUE(channel.Write(ByteArray("frame-1")).Ok()); });
+  output_stream.WaitForFirstWrite();
+  executor.Execute(
+      [&channel]() { EXPECT_TRUE(channel.Write(ByteArray("frame-2")).Ok()); });
+  executor.Execute(
+      [&channel]() { EXPECT_TRUE(channel.Write(ByteArray("frame-3")).Ok()); });
+  absl::SleepFor(absl::Milliseconds(100));
+  output_stream.Unblock();
+  executor.Shutdown();
+
+  std::string written = output_stream.GetWritten();
+  EXPECT_NE(written.find("frame-1"), std::string::npos);
+  EXPECT_NE(written.find("frame-2"), std::string::npos);
+  EXPECT_NE(written.find("frame-3"), std::string::npos);
+  EXPECT_EQ(output_stream.GetWriteCount(), 3);
+  EXPECT_EQ(output_stream.GetFlushCount(), 1);
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST(BaseEndpointChannelTest, FailedWriteFlushesForCoalescedWrite) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableWriteCoalescing,
+      true);
+  Pipe pipe;
+  BlockingOutputStream output_stream;
+  TestEndpointChannel channel(&pipe.GetInputStream(), &output_stream);
+  MultiThreadExecutor executor(2);
+
+  // The first write leaves its flush to the next one, which is too large to
+  // go out.
+  executor.Execute(
+      [&channel]() { EXPECT_TRUE(channel.Write(ByteArray("frame-1")).Ok()); });
+  output_stream.WaitForFirstWrite();
+  executor.Execute([&channel]() {
+    EXPECT_FALSE(
+        channel.Write(ByteArray(TransportConfig::kDefaultMaxFrameSize + 1))
+            .Ok());
+  });
+  absl::SleepFor(absl::Milliseconds(100));
+  output_stream.Unblock();
+  executor.Shutdown();
+
+  EXPECT_EQ(output_stream.GetWriteCount(), 1);
+  EXPECT_EQ(output_stream.GetFlushCount(), 1);
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 TEST(BaseEndpointChannelTest, ReadAfterInputStreamClosed) {
   Pipe pipe;
   InputStream& input_stream = pipe.GetInputStream();
@@ -15,6 +15,7 @@
 #include "connections/implementation/base_pcp_handler.h"
 
 #include <algorithm>
+#include <deque>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -29,9 +30,11 @@
 #include "connections/advertising_options.h"
 #include "connections/connection_options.h"
 #include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "connections/implementation/medium_performance_history.h"
 #include "connections/implementation/mediums/utils.h"
 #include "connections/implementation/offline_frames.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "connections/implementation/transport_config.h"
 #include "connections/medium_selector.h"
 #include "connections/status.h"
 #include "connections/v3/connections_device.h"
@@ -41,10 +44,19 @@
 #include "internal/platform/bluetooth_connection_info.h"
 #include "internal/platform/bluetooth_utils.h"
 #include "internal/platform/cancelable_alarm.h"
+#include "internal/platform/cancellation_flag.h"
+#include "internal/platform/cancellation_flag_listener.h"
+#include "internal/platform/condition_variable.h"
 #include "internal/platform/connection_info.h"
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/future.h"
+#include "internal/platform/implementation/platform.h"
 #include "internal/platform/logging.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/mutex_lock.h"
+#include "internal/platform/os_name.h"
+#include "internal/platform/system_clock.h"
+#include "internal/platform/types.h"
 #include "internal/platform/wifi_lan_connection_info.h"
 #include "proto/connections_enums.pb.h"
 
@@ -60,6 +72,7 @@ using ::location::nearby::connections::ConnectionResponseFrame;
 using ::location::nearby::connections::MediumMetadata;
 using ::location::nearby::connections::OfflineFrame;
 using ::location::nearby::connections::V1Frame;
+using ::securegcm::D2DConnectionContextV1;
 using ::securegcm::UKey2Handshake;
 
 constexpr absl::Duration BasePcpHandler::kConnectionRequestReadTimeout;
@@ -83,6 +96,7 @@ BasePcpHandler::~BasePcpHandler() {
   NEARBY_LOGS(INFO) << "BasePcpHandler(" << strategy_.GetName()
                     << ") is bringing down executors.";
   serial_executor_.Shutdown();
+  connect_race_executor_.Shutdown();
   alarm_executor_.Shutdown();
   NEARBY_LOGS(INFO) << "BasePcpHandler(" << strategy_.GetName()
                     << ") has shut down.";
@@ -95,6 +109,20 @@ void BasePcpHandler::DisconnectFromEndpointManager() {
   // Unregister ourselves from EPM message dispatcher.
   endpoint_manager_->UnregisterFrameProcessor(V1Frame::CONNECTION_RESPONSE,
                                               this);
+  // The clients of queued incoming connections may be gone by the time a
+  // handshake slot frees up, so close them all now.
+  CountDownLatch latch(1);
+  RunOnPcpHandlerThread(
+      "clear-queued-incoming-connections",
+      [this, &latch]() RUN_ON_PCP_HANDLER_THREAD() {
+        for (QueuedIncomingConnection& connection :
+             queued_incoming_connections_) {
+          connection.channel->Close();
+        }
+        queued_incoming_connections_.clear();
+        latch.CountDown();
+      });
+  WaitForLatch("DisconnectFromEndpointManager", &latch);
 }
 
 std::pair<Status, std::vector<ConnectionInfoVariant>>
@@ -153,6 +181,7 @@ void BasePcpHandler::StopListeningForIncomingConnections(ClientProxy* client) {
                         [this, client, &latch]() RUN_ON_PCP_HANDLER_THREAD() {
                           StopListeningForIncomingConnectionsImpl(client);
                           client->StoppedListeningForIncomingConnections();
+                          RejectQueuedIncomingConnections(client);
                           latch.CountDown();
                         });
   WaitForLatch("StopListeningForIncomingConnections", &latch);
@@ -215,11 +244,94 @@ void BasePcpHandler::StopAdvertising(ClientProxy* client) {
                         [this, client, &latch]() RUN_ON_PCP_HANDLER_THREAD() {
                           StopAdvertisingImpl(client);
                           client->StoppedAdvertising();
+                          RejectQueuedIncomingConnections(client);
                           latch.CountDown();
                         });
   WaitForLatch("StopAdvertising", &latch);
 }
 
+Status BasePcpHandler::UpdateAdvertisingOptions(
+    ClientProxy* client, absl::string_view service_id,
+    const AdvertisingOptions& advertising_options) {
+  Future<Status> response;
+
+  AdvertisingOptions compatible_advertising_options =
+      advertising_options.CompatibleOptions();
+  StripOutUnavailableMediums(compatible_advertising_options);
+  NEARBY_LOGS(INFO) << "UpdateAdvertisingOptions with supported mediums: "
+                    << GetStringValueOfSupportedMediums(
+                           compatible_advertising_options);
+
+  RunOnPcpHandlerThread(
+      "update-advertising-options",
+      [this, client, service_id = std::string(service_id),
+       &compatible_advertising_options,
+       &response]() RUN_ON_PCP_HANDLER_THREAD() {
+        if (!client->IsAdvertising() ||
+            client->GetAdvertisingServiceId() != service_id) {
+          response.Set({Status::kOutOfOrderApiCall});
+          return;
+        }
+
+        AdvertisingOptions old_advertising_options =
+            client->GetAdvertisingOptions();
+        ByteArray local_endpoint_info(client->GetLocalEndpointInfo());
+        if (ShouldEnterHighVisibilityMode(old_advertising_options) !=
+            ShouldEnterHighVisibilityMode(compatible_advertising_options)) {
+          // The endpoint id differs between high and low visibility mode, so
+          // every medium has to advertise the new one.
+          StopAdvertisingImpl(client);
+          client->StoppedAdvertising();
+          if (ShouldEnterHighVisibilityMode(compatible_advertising_options)) {
+            client->EnterHighVisibilityMode();
+          }
+          auto result = StartAdvertisingImpl(client, service_id,
+                                             client->GetLocalEndpointId(),
+                                             local_endpoint_info,
+                                             compatible_advertising_options);
+          if (!result.status.Ok()) {
+            client->ExitHighVisibilityMode();
+            response.Set(result.status);
+            return;
+          }
+          client->StartedAdvertising(service_id, GetStrategy(),
+                                     advertising_listener_,
+                                     absl::MakeSpan(result.mediums),
+                                     compatible_advertising_options);
+          client->UpdateLocalEndpointInfo(local_endpoint_info.string_data());
+          response.Set({Status::kSuccess});
+          return;
+        }
+
+        auto result = UpdateAdvertisingImpl(
+            client, service_id, client->GetLocalEndpointId(),
+            local_endpoint_info, old_advertising_options,
+            compatible_advertising_options);
+        if (!result.status.Ok()) {
+          StopAdvertisingImpl(client);
+          client->StoppedAdvertising();
+          response.Set(result.status);
+          return;
+        }
+
+        client->UpdatedAdvertisingOptions(compatible_advertising_options);
+        response.Set({Status::kSuccess});
+      });
+  return WaitForResult(
+      absl::StrCat("UpdateAdvertisingOptions(", service_id, ")"),
+      client->GetClientId(), &response);
+}
+
+BasePcpHandler::StartOperationResult BasePcpHandler::UpdateAdvertisingImpl(
+    ClientProxy* client, const std::string& service_id,
+    const std::string& local_endpoint_id, const ByteArray& local_endpoint_info,
+    const AdvertisingOptions& old_options,
+    const AdvertisingOptions& new_options) {
+  StopAdvertisingImpl(client);
+  return StartAdvertisingImpl(client, service_id, local_endpoint_id,
+                              local_endpoint_info, new_options);
+}
+
 std::string BasePcpHandler::GetStringValueOfSupportedMediums(
     const ConnectionOptions& connection_options) const {
   std::ostringstream result;
@@ -362,6 +474,9 @@ Status BasePcpHandler::StartDiscovery(ClientProxy* client,
 
         // Now that we've succeeded, mark the client as discovering and clear
         // out any old endpoints we had discovered.
+        for (auto& item : discovered_endpoints_) {
+          RememberLostEndpoint(std::move(item.second));
+        }
         discovered_endpoints_.clear();
         client->StartedDiscovery(service_id, GetStrategy(), listener,
                                  absl::MakeSpan(result.mediums),
@@ -384,6 +499,61 @@ void BasePcpHandler::StopDiscovery(ClientProxy* client) {
   WaitForLatch("StopDiscovery", &latch);
 }
 
+Status BasePcpHandler::UpdateDiscoveryOptions(
+    ClientProxy* client, absl::string_view service_id,
+    const DiscoveryOptions& discovery_options) {
+  Future<Status> response;
+  DiscoveryOptions stripped_discovery_options = discovery_options;
+  StripOutUnavailableMediums(stripped_discovery_options);
+  NEARBY_LOGS(INFO) << "UpdateDiscoveryOptions with supported mediums:"
+                    << GetStringValueOfSupportedMediums(
+                           stripped_discovery_options);
+  RunOnPcpHandlerThread(
+      "update-discovery-options",
+      [this, client, service_id = std::string(service_id),
+       &stripped_discovery_options, &response]() RUN_ON_PCP_HANDLER_THREAD() {
+        if (!client->IsDiscoveringServiceId(service_id)) {
+          response.Set({Status::kOutOfOrderApiCall});
+          return;
+        }
+
+        auto result =
+            UpdateDiscoveryImpl(client, service_id,
+                                client->GetDiscoveryOptions(),
+                                stripped_discovery_options);
+        if (!result.status.Ok()) {
+          StopDiscoveryImpl(client);
+          client->StoppedDiscovery();
+          response.Set(result.status);
+          return;
+        }
+
+        // Unlike StartDiscovery(), keep the endpoints still discoverable on
+        // the mediums that kept running.
+        std::vector<std::shared_ptr<DiscoveredEndpoint>> lost_endpoints;
+        for (const auto& item : discovered_endpoints_) {
+          if (std::find(result.mediums.begin(), result.mediums.end(),
+                        item.second->medium) == result.mediums.end()) {
+            lost_endpoints.push_back(item.second);
+          }
+        }
+        for (const auto& endpoint : lost_endpoints) {
+          OnEndpointLost(client, *endpoint);
+        }
+        client->UpdatedDiscoveryOptions(stripped_discovery_options);
+        response.Set({Status::kSuccess});
+      });
+  return WaitForResult(absl::StrCat("UpdateDiscoveryOptions(", service_id, ")"),
+                       client->GetClientId(), &response);
+}
+
+BasePcpHandler::StartOperationResult BasePcpHandler::UpdateDiscoveryImpl(
+    ClientProxy* client, const std::string& service_id,
+    const DiscoveryOptions& old_options, const DiscoveryOptions& new_options) {
+  StopDiscoveryImpl(client);
+  return StartDiscoveryImpl(client, service_id, new_options);
+}
+
 void BasePcpHandler::InjectEndpoint(
     ClientProxy* client, const std::string& service_id,
     const OutOfBandConnectionMetadata& metadata) {
@@ -445,7 +615,25 @@ EncryptionRunner::ResultListener BasePcpHandler::GetResultListener() {
                  raw_auth_token]() RUN_ON_PCP_HANDLER_THREAD() mutable {
                   OnEncryptionSuccessRunnable(
                       endpoint_id, std::unique_ptr<UKey2Handshake>(raw_ukey2),
+                      nullptr, auth_token, raw_auth_token);
+                  ProcessQueuedIncomingConnections();
+                });
+          },
+      .on_resumed_cb =
+          [this](const std::string& endpoint_id,
+                 std::unique_ptr<D2DConnectionContextV1> context,
+                 const std::string& auth_token,
+                 const ByteArray& raw_auth_token) {
+            RunOnPcpHandlerThread(
+                "encryption-resumed",
+                [this, endpoint_id, raw_context = context.release(),
+                 auth_token,
+                 raw_auth_token]() RUN_ON_PCP_HANDLER_THREAD() mutable {
+                  OnEncryptionSuccessRunnable(
+                      endpoint_id, nullptr,
+                      std::unique_ptr<D2DConnectionContextV1>(raw_context),
                       auth_token, raw_auth_token);
+                  ProcessQueuedIncomingConnections();
                 });
           },
       .on_failure_cb =
@@ -459,6 +647,7 @@ EncryptionRunner::ResultListener BasePcpHandler::GetResultListener() {
                       << location::nearby::proto::connections::Medium_Name(
                              channel->GetMedium());
                   OnEncryptionFailureRunnable(endpoint_id, channel);
+                  ProcessQueuedIncomingConnections();
                 });
           },
   };
@@ -466,6 +655,7 @@ EncryptionRunner::ResultListener BasePcpHandler::GetResultListener() {
 
 void BasePcpHandler::OnEncryptionSuccessRunnable(
     const std::string& endpoint_id, std::unique_ptr<UKey2Handshake> ukey2,
+    std::unique_ptr<D2DConnectionContextV1> resumed_context,
     const std::string& auth_token, const ByteArray& raw_auth_token) {
   // Quick fail if we've been removed from pending connections while we were
   // busy running UKEY2.
@@ -480,7 +670,7 @@ void BasePcpHandler::OnEncryptionSuccessRunnable(
   BasePcpHandler::PendingConnectionInfo& connection_info = it->second;
   Medium medium = connection_info.channel->GetMedium();
 
-  if (!ukey2) {
+  if (!ukey2 && !resumed_context) {
     // Fail early, if there is no crypto context.
     ProcessPreConnectionInitiationFailure(
         connection_info.client, medium, endpoint_id,
@@ -490,7 +680,11 @@ void BasePcpHandler::OnEncryptionSuccessRunnable(
     return;
   }
 
-  connection_info.SetCryptoContext(std::move(ukey2));
+  if (resumed_context) {
+    connection_info.SetCryptoContext(std::move(resumed_context));
+  } else {
+    connection_info.SetCryptoContext(std::move(ukey2));
+  }
   connection_info.connection_token = GetHashedConnectionToken(raw_auth_token);
   NEARBY_LOGS(INFO)
       << "Register encrypted connection; wait for response; endpoint_id="
@@ -549,6 +743,10 @@ void BasePcpHandler::OnEncryptionFailureRunnable(
     return;
   }
 
+  if (info.used_compact_handshake) {
+    SetRemoteSupportsCompactHandshake(endpoint_id, info.remote_endpoint_info,
+                                      /*supports=*/false);
+  }
   ProcessPreConnectionInitiationFailure(
       info.client, info.channel->GetMedium(), endpoint_id, info.channel.get(),
       info.is_incoming, info.start_time, {Status::kEndpointIoError},
@@ -621,6 +819,10 @@ Status BasePcpHandler::RequestConnection(
           return;
         }
 
+        RestoreLostEndpoints(endpoint_id);
+        if (GetDiscoveredEndpoint(endpoint_id) == nullptr) {
+          RestoreKnownEndpoint(endpoint_id);
+        }
         DiscoveredEndpoint* endpoint = GetDiscoveredEndpoint(endpoint_id);
         if (endpoint == nullptr) {
           NEARBY_LOGS(INFO)
@@ -643,23 +845,83 @@ Status BasePcpHandler::RequestConnection(
         if (AppendWebRTCEndpoint(endpoint_id, client->GetDiscoveryOptions()))
           NEARBY_LOGS(INFO) << "Appended Web RTC endpoint.";
 
-        auto discovered_endpoints = GetDiscoveredEndpoints(endpoint_id);
+        std::vector<DiscoveredEndpoint*> connect_endpoints;
+        for (auto connect_endpoint : GetDiscoveredEndpoints(endpoint_id)) {
+          if (MediumSupportedByClientOptions(connect_endpoint->medium,
+                                             connection_options))
+            connect_endpoints.push_back(connect_endpoint);
+        }
+
+        // Try the mediums that did well with this device before first.
+        MediumPerformanceHistory* medium_history =
+            bwu_manager_->GetMediumPerformanceHistory();
+        std::string peer_id =
+            MediumPerformanceHistory::GetPeerId(endpoint->endpoint_info);
+        if (medium_history != nullptr) {
+          std::vector<Medium> mediums;
+          for (auto connect_endpoint : connect_endpoints) {
+            mediums.push_back(connect_endpoint->medium);
+          }
+          std::vector<Medium> ranked_mediums =
+              medium_history->Rank(peer_id, mediums);
+          auto get_rank = [&ranked_mediums](DiscoveredEndpoint* discovered) {
+            return std::find(ranked_mediums.begin(), ranked_mediums.end(),
+                             discovered->medium) -
+                   ranked_mediums.begin();
+          };
+          std::stable_sort(connect_endpoints.begin(), connect_endpoints.end(),
+                           [&get_rank](DiscoveredEndpoint* a,
+                                       DiscoveredEndpoint* b) {
+                             return get_rank(a) < get_rank(b);
+                           });
+        }
+
         std::unique_ptr<EndpointChannel> channel;
         ConnectImplResult connect_impl_result;
 
-        for (auto connect_endpoint : discovered_endpoints) {
-          if (!MediumSupportedByClientOptions(connect_endpoint->medium,
-                                              connection_options))
-            continue;
+        // When racing, the most preferred mediums are tried all at once, and
+        // the rest one at a time only if none of them connects. Racing needs
+        // cancellation to stop the attempts that lose.
+        size_t next_endpoint = 0;
+        if (FeatureFlags::GetInstance().GetFlags().enable_cancellation_flag &&
+            NearbyFlags::GetInstance().GetBoolFlag(
+                config_package_nearby::nearby_connections_feature::
+                    kEnableConnectionRacing)) {
+          std::int64_t race_count = std::min<std::int64_t>(
+              {NearbyFlags::GetInstance().GetInt64Flag(
+                   config_package_nearby::nearby_connections_feature::
+                       kConnectionRaceMediumCount),
+               kMaxRacedConnectAttempts,
+               static_cast<std::int64_t>(connect_endpoints.size())});
+          if (race_count > 1) {
+            connect_impl_result = RaceConnectImpl(
+                client, endpoint_id,
+                std::vector<DiscoveredEndpoint*>(
+                    connect_endpoints.begin(),
+                    connect_endpoints.begin() + race_count));
+            if (connect_impl_result.status.Ok()) {
+              channel = std::move(connect_impl_result.endpoint_channel);
+            }
+            next_endpoint = race_count;
+          }
+        }
+
+        for (; channel == nullptr && next_endpoint < connect_endpoints.size();
+             ++next_endpoint) {
+          DiscoveredEndpoint* connect_endpoint =
+              connect_endpoints[next_endpoint];
           NEARBY_LOGS(INFO)
               << "Try to connect with endpoint(id=" << endpoint_id
               << ") by Medium: "
               << location::nearby::proto::connections::Medium_Name(
                      connect_endpoint->medium);
           connect_impl_result = ConnectImpl(client, connect_endpoint);
+          if (medium_history != nullptr) {
+            medium_history->RecordAttempt(peer_id, connect_endpoint->medium,
+                                          connect_impl_result.status.Ok());
+          }
           if (connect_impl_result.status.Ok()) {
             channel = std::move(connect_impl_result.endpoint_channel);
-            break;
           }
         }
 
@@ -683,8 +945,43 @@ Status BasePcpHandler::RequestConnection(
         ConnectionInfo connection_info =
             FillConnectionInfo(client, info, connection_options);
 
-        Exception write_exception =
-            WriteConnectionRequestFrame(connection_info, channel.get());
+        // Offer the session ticket of our last connection to this endpoint,
+        // if we still have one, so that we can skip UKEY2.
+        SessionResumption resumption;
+        parser::SessionResumptionOffer offer;
+        if (NearbyFlags::GetInstance().GetBoolFlag(
+                config_package_nearby::nearby_connections_feature::
+                    kEnableUkey2SessionResumption)) {
+          offer.supports_session_resumption = true;
+          resumption.ticket = outgoing_session_tickets_.Take(
+              endpoint_id, SystemClock::ElapsedRealtime());
+          if (resumption.ticket.has_value()) {
+            resumption.offered = true;
+            resumption.client_nonce =
+                EncryptionRunner::GenerateSessionResumptionNonce();
+            offer.session_ticket_id = resumption.ticket->id;
+            offer.nonce = resumption.client_nonce;
+          }
+        }
+
+        // Send our UKEY2 ClientInit along with the request, saving a message,
+        // if the endpoint told us it takes it there.
+        CompactHandshake compact;
+        parser::CompactHandshakeOffer compact_offer;
+        if (NearbyFlags::GetInstance().GetBoolFlag(
+                config_package_nearby::nearby_connections_feature::
+                    kEnableCompactHandshake)) {
+          compact_offer.supports_compact_handshake = true;
+          if (!resumption.offered &&
+              compact_handshake_endpoints_.contains(GetCompactHandshakeKey(
+                  endpoint_id, endpoint->endpoint_info))) {
+            compact = EncryptionRunner::StartCompactHandshake();
+            compact_offer.ukey2_client_init = compact.client_init;
+          }
+        }
+
+        Exception write_exception = WriteConnectionRequestFrame(
+            connection_info, offer, compact_offer, channel.get());
 
         if (!write_exception.Ok()) {
           NEARBY_LOGS(INFO) << "Failed to send connection request: endpoint_id="
@@ -716,6 +1013,7 @@ Status BasePcpHandler::RequestConnection(
         pendingConnectionInfo.connection_options = connection_options;
         pendingConnectionInfo.result = result;
         pendingConnectionInfo.channel = std::move(channel);
+        pendingConnectionInfo.used_compact_handshake = compact.ukey2 != nullptr;
 
         EndpointChannel* endpoint_channel =
             pending_connections_
@@ -727,7 +1025,9 @@ Status BasePcpHandler::RequestConnection(
         // Next, we'll set up encryption. When it's done, our future will return
         // and RequestConnection() will finish.
         encryption_runner_.StartClient(client, endpoint_id, endpoint_channel,
-                                       GetResultListener());
+                                       GetResultListener(),
+                                       std::move(resumption),
+                                       std::move(compact));
       });
   NEARBY_LOGS(INFO) << "Waiting for connection to complete: endpoint_id="
                     << endpoint_id;
@@ -739,6 +1039,98 @@ Status BasePcpHandler::RequestConnection(
   return status;
 }
 
+BasePcpHandler::ConnectImplResult BasePcpHandler::RaceConnectImpl(
+    ClientProxy* client, const std::string& endpoint_id,
+    const std::vector<DiscoveredEndpoint*>& endpoints) {
+  struct Race {
+    Mutex mutex;
+    ConditionVariable attempt_done{&mutex};
+    int running_attempts = 0;
+    bool connected = false;
+    ConnectImplResult result;
+  } race;
+
+  // Every attempt gets its own flag so that the losers can be cancelled
+  // without cancelling the winner; cancelling the endpoint cancels them all.
+  CancellationFlag* endpoint_flag = client->GetCancellationFlag(endpoint_id);
+  std::vector<std::unique_ptr<CancellationFlag>> attempt_flags;
+  for (size_t i = 0; i < endpoints.size(); ++i) {
+    attempt_flags.push_back(
+        std::make_unique<CancellationFlag>(endpoint_flag->Cancelled()));
+  }
+  auto cancel_attempts = [&attempt_flags]() {
+    for (auto& attempt_flag : attempt_flags) attempt_flag->Cancel();
+  };
+  CancellationFlagListener endpoint_flag_listener(endpoint_flag,
+                                                  cancel_attempts);
+
+  absl::Duration stagger =
+      absl::Milliseconds(NearbyFlags::GetInstance().GetInt64Flag(
+          config_package_nearby::nearby_connections_feature::
+              kConnectionRaceStaggerMillis));
+  {
+    MutexLock lock(&race.mutex);
+    for (size_t i = 0; i < endpoints.size() && !race.connected; ++i) {
+      DiscoveredEndpoint* endpoint = endpoints[i];
+      NEARBY_LOGS(INFO) << "Racing connection with endpoint(id=" << endpoint_id
+                        << ") by Medium: "
+                        << location::nearby::proto::connections::Medium_Name(
+                               endpoint->medium);
+      ++race.running_attempts;
+      // This thread waits below until every attempt is done, so the attempts
+      // can stand in for it while they connect.
+      connect_race_executor_.Execute(
+          "connect-race", [this, client, endpoint, &race,
+                           attempt_flag = attempt_flags[i].get()]()
+                              ABSL_NO_THREAD_SAFETY_ANALYSIS {
+            ConnectImplResult result =
+                ConnectImpl(client, endpoint, attempt_flag);
+            std::unique_ptr<EndpointChannel> lost_channel;
+            {
+              MutexLock lock(&race.mutex);
+              if (!race.connected) {
+                race.connected = result.status.Ok();
+                race.result = std::move(result);
+              } else {
+                lost_channel = std::move(result.endpoint_channel);
+              }
+              --race.running_attempts;
+              race.attempt_done.Notify();
+            }
+            if (lost_channel) lost_channel->Close();
+          });
+
+      // Give this attempt its head start, unless every attempt so far has
+      // already failed.
+      if (i + 1 == endpoints.size()) break;
+      absl::Time deadline = SystemClock::ElapsedRealtime() + stagger;
+      while (!race.connected && race.running_attempts > 0) {
+        absl::Duration remaining = deadline - SystemClock::ElapsedRealtime();
+        if (remaining <= absl::ZeroDuration()) break;
+        race.attempt_done.Wait(remaining);
+      }
+    }
+    while (!race.connected && race.running_attempts > 0) {
+      race.attempt_done.Wait();
+    }
+  }
+
+  // Stop the attempts that lost and wait for them to give up, since they
+  // refer to state owned by this thread.
+  cancel_attempts();
+  MutexLock lock(&race.mutex);
+  while (race.running_attempts > 0) {
+    race.attempt_done.Wait();
+  }
+  if (race.connected) {
+    NEARBY_LOGS(INFO) << "Won connection race with endpoint(id="
+                      << endpoint_id << ") by Medium: "
+                      << location::nearby::proto::connections::Medium_Name(
+                             race.result.medium);
+  }
+  return std::move(race.result);
+}
+
 bool BasePcpHandler::MediumSupportedByClientOptions(
     const location::nearby::proto::connections::Medium& medium,
     const ConnectionOptions& connection_options) const {
@@ -836,6 +1228,151 @@ BasePcpHandler::DiscoveredEndpoint* BasePcpHandler::GetDiscoveredEndpoint(
   return it->second.get();
 }
 
+void BasePcpHandler::RememberLostEndpoint(
+    std::shared_ptr<DiscoveredEndpoint> endpoint) {
+  if (!NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableLostEndpointCache)) {
+    return;
+  }
+  absl::Time now = SystemClock::ElapsedRealtime();
+  for (auto it = lost_endpoints_.begin(); it != lost_endpoints_.end();) {
+    if (it->second.expiry <= now) {
+      it = lost_endpoints_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  absl::Duration ttl =
+      absl::Milliseconds(NearbyFlags::GetInstance().GetInt64Flag(
+          config_package_nearby::nearby_connections_feature::
+              kLostEndpointCacheTtlMillis));
+  std::string endpoint_id = endpoint->endpoint_id;
+  lost_endpoints_.emplace(endpoint_id, LostEndpoint{
+                                           .endpoint = std::move(endpoint),
+                                           .expiry = now + ttl,
+                                       });
+}
+
+void BasePcpHandler::RestoreLostEndpoints(const std::string& endpoint_id) {
+  auto range = lost_endpoints_.equal_range(endpoint_id);
+  if (range.first == range.second) return;
+  absl::Time now = SystemClock::ElapsedRealtime();
+  for (auto it = range.first; it != range.second; ++it) {
+    LostEndpoint& lost = it->second;
+    if (lost.expiry <= now) continue;
+    bool rediscovered = false;
+    for (auto* discovered : GetDiscoveredEndpoints(endpoint_id)) {
+      if (discovered->medium == lost.endpoint->medium) {
+        rediscovered = true;
+        break;
+      }
+    }
+    if (rediscovered) continue;
+    NEARBY_LOGS(INFO) << "Restoring lost endpoint(id=" << endpoint_id
+                      << ") with Medium: "
+                      << location::nearby::proto::connections::Medium_Name(
+                             lost.endpoint->medium);
+    discovered_endpoints_.emplace(endpoint_id, std::move(lost.endpoint));
+  }
+  lost_endpoints_.erase(range.first, range.second);
+}
+
+void BasePcpHandler::RememberKnownEndpoint(
+    const DiscoveredEndpoint& endpoint) {
+  if (!NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableKnownEndpointCache)) {
+    return;
+  }
+  std::string bluetooth_mac_address;
+  std::optional<NsdServiceInfo> wifi_lan_service_info;
+  if (endpoint.medium == location::nearby::proto::connections::BLUETOOTH) {
+    bluetooth_mac_address =
+        down_cast<const BluetoothEndpoint*>(&endpoint)
+            ->bluetooth_device.GetMacAddress();
+  } else if (endpoint.medium ==
+             location::nearby::proto::connections::WIFI_LAN) {
+    wifi_lan_service_info =
+        down_cast<const WifiLanEndpoint*>(&endpoint)->service_info;
+  }
+  if (bluetooth_mac_address.empty() && !wifi_lan_service_info.has_value()) {
+    return;
+  }
+
+  auto it = known_endpoints_.find(endpoint.endpoint_id);
+  if (it == known_endpoints_.end() &&
+      known_endpoints_.size() >= kMaxKnownEndpoints) {
+    auto oldest = std::min_element(
+        known_endpoints_.begin(), known_endpoints_.end(),
+        [](const auto& a, const auto& b) {
+          return a.second.last_seen < b.second.last_seen;
+        });
+    known_endpoints_.erase(oldest);
+  }
+  KnownEndpoint& known = known_endpoints_[endpoint.endpoint_id];
+  // Addresses of another device that took over the endpoint id are stale.
+  if (known.endpoint_info != endpoint.endpoint_info ||
+      known.service_id != endpoint.service_id) {
+    known = KnownEndpoint{
+        .endpoint_info = endpoint.endpoint_info,
+        .service_id = endpoint.service_id,
+    };
+  }
+  if (!bluetooth_mac_address.empty()) {
+    known.bluetooth_mac_address = std::move(bluetooth_mac_address);
+  }
+  if (wifi_lan_service_info.has_value()) {
+    known.wifi_lan_service_info = std::move(wifi_lan_service_info);
+  }
+  known.last_seen = SystemClock::ElapsedRealtime();
+}
+
+bool BasePcpHandler::RestoreKnownEndpoint(const std::string& endpoint_id) {
+  auto it = known_endpoints_.find(endpoint_id);
+  if (it == known_endpoints_.end()) return false;
+  absl::Duration ttl =
+      absl::Milliseconds(NearbyFlags::GetInstance().GetInt64Flag(
+          config_package_nearby::nearby_connections_feature::
+              kKnownEndpointCacheTtlMillis));
+  if (it->second.last_seen + ttl <= SystemClock::ElapsedRealtime()) {
+    known_endpoints_.erase(it);
+    return false;
+  }
+
+  const KnownEndpoint& known = it->second;
+  bool restored = false;
+  if (!known.bluetooth_mac_address.empty()) {
+    BluetoothDevice bluetooth_device =
+        GetRemoteBluetoothDevice(known.bluetooth_mac_address);
+    if (bluetooth_device.IsValid()) {
+      discovered_endpoints_.emplace(
+          endpoint_id,
+          std::make_shared<BluetoothEndpoint>(BluetoothEndpoint{
+              {endpoint_id, known.endpoint_info, known.service_id,
+               location::nearby::proto::connections::BLUETOOTH,
+               WebRtcState::kUnconnectable},
+              bluetooth_device,
+          }));
+      restored = true;
+    }
+  }
+  if (known.wifi_lan_service_info.has_value()) {
+    discovered_endpoints_.emplace(
+        endpoint_id, std::make_shared<WifiLanEndpoint>(WifiLanEndpoint{
+                         {endpoint_id, known.endpoint_info, known.service_id,
+                          location::nearby::proto::connections::WIFI_LAN,
+                          WebRtcState::kUnconnectable},
+                         *known.wifi_lan_service_info,
+                     }));
+    restored = true;
+  }
+  if (restored) {
+    NEARBY_LOGS(INFO) << "Restored known endpoint(id=" << endpoint_id << ")";
+  }
+  return restored;
+}
+
 std::vector<BasePcpHandler::DiscoveredEndpoint*>
 BasePcpHandler::GetDiscoveredEndpoints(const std::string& endpoint_id) {
   std::vector<BasePcpHandler::DiscoveredEndpoint*> result;
@@ -942,8 +1479,34 @@ bool BasePcpHandler::CanReceiveIncomingConnection(ClientProxy* client) const {
 }
 
 Exception BasePcpHandler::WriteConnectionRequestFrame(
-    const ConnectionInfo& conection_info, EndpointChannel* endpoint_channel) {
-  return endpoint_channel->Write(parser::ForConnectionRequest(conection_info));
+    const ConnectionInfo& conection_info,
+    const parser::SessionResumptionOffer& offer,
+    const parser::CompactHandshakeOffer& compact,
+    EndpointChannel* endpoint_channel) {
+  return endpoint_channel->Write(
+      parser::ForConnectionRequest(conection_info, offer, compact));
+}
+
+std::string BasePcpHandler::GetCompactHandshakeKey(
+    const std::string& endpoint_id, const ByteArray& endpoint_info) {
+  // Another device may take over the endpoint id later.
+  return absl::StrCat(endpoint_id, ":", endpoint_info.AsStringView());
+}
+
+void BasePcpHandler::SetRemoteSupportsCompactHandshake(
+    const std::string& endpoint_id, const ByteArray& endpoint_info,
+    bool supports) {
+  std::string key = GetCompactHandshakeKey(endpoint_id, endpoint_info);
+  if (!supports) {
+    compact_handshake_endpoints_.erase(key);
+    return;
+  }
+  // Forgetting an endpoint only costs it the full handshake.
+  if (!compact_handshake_endpoints_.contains(key) &&
+      compact_handshake_endpoints_.size() >= kMaxCompactHandshakeEndpoints) {
+    compact_handshake_endpoints_.erase(compact_handshake_endpoints_.begin());
+  }
+  compact_handshake_endpoints_.insert(std::move(key));
 }
 
 void BasePcpHandler::ProcessPreConnectionInitiationFailure(
@@ -1029,9 +1592,50 @@ Status BasePcpHandler::AcceptConnection(ClientProxy* client,
           return;
         }
 
+        parser::ConnectionResponseFeatures features{
+            .supports_bytes_payload_batching =
+                NearbyFlags::GetInstance().GetBoolFlag(
+                    config_package_nearby::nearby_connections_feature::
+                        kEnableBytesPayloadBatching),
+            .supports_single_frame_bytes_payloads =
+                NearbyFlags::GetInstance().GetBoolFlag(
+                    config_package_nearby::nearby_connections_feature::
+                        kEnableSingleFrameBytesPayloads),
+            .supports_session_resumption =
+                NearbyFlags::GetInstance().GetBoolFlag(
+                    config_package_nearby::nearby_connections_feature::
+                        kEnableUkey2SessionResumption),
+            .supports_aead_frames = NearbyFlags::GetInstance().GetBoolFlag(
+                config_package_nearby::nearby_connections_feature::
+                    kEnableAeadFrameEncryption),
+            .supports_compressed_chunks =
+                NearbyFlags::GetInstance().GetBoolFlag(
+                    config_package_nearby::nearby_connections_feature::
+                        kEnablePayloadCompression),
+            .supports_chunk_dedup = NearbyFlags::GetInstance().GetBoolFlag(
+                config_package_nearby::nearby_connections_feature::
+                    kEnableFilePayloadChunkDedup),
+            // Batches are saved as separate files, which ChromeOS can't do.
+            .supports_file_batch =
+                NearbyFlags::GetInstance().GetBoolFlag(
+                    config_package_nearby::nearby_connections_feature::
+                        kEnableFileBatchPayloads) &&
+                api::ImplementationPlatform::GetCurrentOS() !=
+                    api::OSName::kChromeOS,
+            // Relays need connections to each other.
+            .supports_payload_relay =
+                NearbyFlags::GetInstance().GetBoolFlag(
+                    config_package_nearby::nearby_connections_feature::
+                        kEnableClusterPayloadRelay) &&
+                strategy_ == Strategy::kP2pCluster,
+            .supports_compact_handshake =
+                NearbyFlags::GetInstance().GetBoolFlag(
+                    config_package_nearby::nearby_connections_feature::
+                        kEnableCompactHandshake),
+        };
         Exception write_exception =
             channel->Write(parser::ForConnectionResponse(
-                Status::kSuccess, client->GetLocalOsInfo()));
+                Status::kSuccess, client->GetLocalOsInfo(), features));
         if (!write_exception.Ok()) {
           NEARBY_LOGS(INFO)
               << "AcceptConnection: failed to send response: endpoint_id="
@@ -1157,6 +1761,29 @@ void BasePcpHandler::OnIncomingFrame(
         if (connection_response.has_os_info()) {
           client->SetRemoteOsInfo(endpoint_id, connection_response.os_info());
         }
+        client->SetRemoteSupportsBytesPayloadBatching(
+            endpoint_id, connection_response.supports_bytes_payload_batching());
+        client->SetRemoteSupportsSingleFrameBytesPayloads(
+            endpoint_id,
+            connection_response.supports_single_frame_bytes_payloads());
+        client->SetRemoteSupportsCompressedChunks(
+            endpoint_id, connection_response.supports_compressed_chunks());
+        client->SetRemoteSupportsChunkDedup(
+            endpoint_id, connection_response.supports_chunk_dedup());
+        client->SetRemoteSupportsFileBatch(
+            endpoint_id, connection_response.supports_file_batch());
+        client->SetRemoteSupportsPayloadRelay(
+            endpoint_id, connection_response.supports_payload_relay());
+        auto pending = pending_connections_.find(endpoint_id);
+        if (pending != pending_connections_.end()) {
+          pending->second.remote_supports_session_resumption =
+              connection_response.supports_session_resumption();
+          pending->second.remote_supports_aead_frames =
+              connection_response.supports_aead_frames();
+          SetRemoteSupportsCompactHandshake(
+              endpoint_id, pending->second.remote_endpoint_info,
+              connection_response.supports_compact_handshake());
+        }
 
         EvaluateConnectionResult(client, endpoint_id,
                                  /* can_close_immediately= */ true);
@@ -1200,6 +1827,7 @@ void BasePcpHandler::OnEndpointFound(
   // Check if we've seen this endpoint ID before.
   std::string& endpoint_id = endpoint->endpoint_id;
   NEARBY_LOGS(INFO) << "OnEndpointFound: id=" << endpoint_id << " [enter]";
+  RememberKnownEndpoint(*endpoint);
 
   auto range = discovered_endpoints_.equal_range(endpoint->endpoint_id);
   bool is_range_empty = range.first == range.second;
@@ -1285,6 +1913,7 @@ void BasePcpHandler::OnEndpointLost(
     if (--count == 0) {
       client->OnEndpointLost(endpoint.service_id, endpoint.endpoint_id);
     }
+    RememberLostEndpoint(std::move(item->second));
     discovered_endpoints_.erase(item);
     break;
   }
@@ -1327,6 +1956,132 @@ Exception BasePcpHandler::OnIncomingConnection(
     ClientProxy* client, const ByteArray& remote_endpoint_info,
     std::unique_ptr<EndpointChannel> channel,
     location::nearby::proto::connections::Medium medium) {
+  std::int64_t max_handshakes = NearbyFlags::GetInstance().GetInt64Flag(
+      config_package_nearby::nearby_connections_feature::
+          kMaxConcurrentIncomingHandshakes);
+  if (max_handshakes <= 0 || (queued_incoming_connections_.empty() &&
+                              GetIncomingHandshakeCount() < max_handshakes)) {
+    return ProcessIncomingConnection(client, remote_endpoint_info,
+                                     std::move(channel), medium);
+  }
+
+  absl::Duration queue_timeout =
+      absl::Milliseconds(NearbyFlags::GetInstance().GetInt64Flag(
+          config_package_nearby::nearby_connections_feature::
+              kIncomingConnectionQueueTimeoutMillis));
+  if (queue_timeout <= absl::ZeroDuration()) {
+    NEARBY_LOGS(WARNING) << "Rejecting incoming connection on medium "
+                         << location::nearby::proto::connections::Medium_Name(
+                                medium)
+                         << " because " << max_handshakes
+                         << " handshakes are already running.";
+    RejectBusyIncomingConnection(std::move(channel));
+    return {Exception::kSuccess};
+  }
+
+  NEARBY_LOGS(INFO) << "Queueing incoming connection on medium "
+                    << location::nearby::proto::connections::Medium_Name(
+                           medium)
+                    << " behind " << queued_incoming_connections_.size()
+                    << " others until a handshake finishes.";
+  queued_incoming_connections_.push_back({
+      .client = client,
+      .remote_endpoint_info = remote_endpoint_info,
+      .channel = std::move(channel),
+      .medium = medium,
+      .deadline = SystemClock::ElapsedRealtime() + queue_timeout,
+  });
+  alarm_executor_.Schedule(
+      [this]() {
+        RunOnPcpHandlerThread("process-queued-incoming-connections",
+                              [this]() RUN_ON_PCP_HANDLER_THREAD() {
+                                ProcessQueuedIncomingConnections();
+                              });
+      },
+      queue_timeout);
+  return {Exception::kSuccess};
+}
+
+int BasePcpHandler::GetIncomingHandshakeCount() {
+  int count = 0;
+  for (const auto& [endpoint_id, info] : pending_connections_) {
+    if (info.is_incoming && info.channel != nullptr && info.ukey2 == nullptr &&
+        info.resumed_context == nullptr) {
+      count++;
+    }
+  }
+  return count;
+}
+
+void BasePcpHandler::ProcessQueuedIncomingConnections() {
+  std::int64_t max_handshakes = NearbyFlags::GetInstance().GetInt64Flag(
+      config_package_nearby::nearby_connections_feature::
+          kMaxConcurrentIncomingHandshakes);
+  absl::Time now = SystemClock::ElapsedRealtime();
+  while (!queued_incoming_connections_.empty()) {
+    QueuedIncomingConnection connection =
+        std::move(queued_incoming_connections_.front());
+    queued_incoming_connections_.pop_front();
+    if (max_handshakes <= 0 || GetIncomingHandshakeCount() < max_handshakes) {
+      ProcessIncomingConnection(connection.client,
+                                connection.remote_endpoint_info,
+                                std::move(connection.channel),
+                                connection.medium);
+      continue;
+    }
+    if (connection.deadline > now) {
+      // Later connections were queued after this one, so they can wait too.
+      queued_incoming_connections_.push_front(std::move(connection));
+      break;
+    }
+    NEARBY_LOGS(WARNING) << "Rejecting incoming connection on medium "
+                         << location::nearby::proto::connections::Medium_Name(
+                                connection.medium)
+                         << " because no handshake finished in time.";
+    RejectBusyIncomingConnection(std::move(connection.channel));
+  }
+}
+
+void BasePcpHandler::RejectQueuedIncomingConnections(ClientProxy* client) {
+  if (client->IsAdvertising() || client->IsListeningForIncomingConnections()) {
+    return;
+  }
+  auto it = queued_incoming_connections_.begin();
+  while (it != queued_incoming_connections_.end()) {
+    if (it->client != client) {
+      ++it;
+      continue;
+    }
+    NEARBY_LOGS(INFO) << "Rejecting queued incoming connection on medium "
+                      << location::nearby::proto::connections::Medium_Name(
+                             it->medium)
+                      << " because client=" << client->GetClientId()
+                      << " is no longer waiting for incoming connections.";
+    RejectBusyIncomingConnection(std::move(it->channel));
+    it = queued_incoming_connections_.erase(it);
+  }
+}
+
+void BasePcpHandler::RejectBusyIncomingConnection(
+    std::unique_ptr<EndpointChannel> channel) {
+  absl::Duration retry_after =
+      absl::Milliseconds(NearbyFlags::GetInstance().GetInt64Flag(
+          config_package_nearby::nearby_connections_feature::
+              kBusyConnectionRetryAfterMillis));
+  channel->Write(parser::ForBusyConnectionResponse(retry_after));
+  // Give the remote endpoint time to read the rejection, like
+  // EvaluateConnectionResult() does.
+  alarm_executor_.Schedule(
+      [channel = std::shared_ptr<EndpointChannel>(std::move(channel))]() {
+        channel->Close();
+      },
+      kRejectedConnectionCloseDelay);
+}
+
+Exception BasePcpHandler::ProcessIncomingConnection(
+    ClientProxy* client, const ByteArray& remote_endpoint_info,
+    std::unique_ptr<EndpointChannel> channel,
+    location::nearby::proto::connections::Medium medium) {
   absl::Time start_time = SystemClock::ElapsedRealtime();
 
   //  Fixes an NPE in ClientProxy.OnConnectionAccepted. The crash happened when
@@ -1423,11 +2178,12 @@ Exception BasePcpHandler::OnIncomingConnection(
         << "Incoming connection has wrong keep-alive frame interval="
         << connection_options.keep_alive_interval_millis
         << ", timeout=" << connection_options.keep_alive_timeout_millis
-        << " values; correct them as default.",
-        connection_options.keep_alive_interval_millis =
-            FeatureFlags::GetInstance().GetFlags().keep_alive_interval_millis;
+        << " values; correct them as default.";
+    TransportConfig transport_config = TransportConfig::Get();
+    connection_options.keep_alive_interval_millis =
+        transport_config.keep_alive_interval_millis;
     connection_options.keep_alive_timeout_millis =
-        FeatureFlags::GetInstance().GetFlags().keep_alive_timeout_millis;
+        transport_config.keep_alive_timeout_millis;
   }
 
   const MediumMetadata& medium_metadata = connection_request.medium_metadata();
@@ -1461,16 +2217,53 @@ Exception BasePcpHandler::OnIncomingConnection(
   pendingConnectionInfo.connection_options = connection_options;
   pendingConnectionInfo.supported_mediums =
       parser::ConnectionRequestMediumsToMediums(connection_request);
+  pendingConnectionInfo.remote_supports_session_resumption =
+      connection_request.supports_session_resumption();
   pendingConnectionInfo.channel = std::move(channel);
+  SetRemoteSupportsCompactHandshake(
+      connection_request.endpoint_id(), endpoint_info,
+      connection_request.supports_compact_handshake());
+
+  // A session ticket must always be answered, even when we can't resume from
+  // it, since the client waits for our answer before starting UKEY2.
+  SessionResumption resumption;
+  if (connection_request.has_session_ticket_id()) {
+    resumption.offered = true;
+    if (NearbyFlags::GetInstance().GetBoolFlag(
+            config_package_nearby::nearby_connections_feature::
+                kEnableUkey2SessionResumption)) {
+      resumption.ticket = incoming_session_tickets_.Take(
+          connection_request.session_ticket_id(), start_time);
+    }
+    resumption.client_nonce =
+        ByteArray(connection_request.session_resumption_nonce());
+  }
 
   auto* owned_channel = pending_connections_
                             .emplace(connection_request.endpoint_id(),
                                      std::move(pendingConnectionInfo))
                             .first->second.channel.get();
 
+  // The upgrade that follows if the connection is accepted doesn't need to wait
+  // for its medium to be set up from scratch.
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableBwuPreparation) &&
+      AutoUpgradeBandwidth(client->GetAdvertisingOptions())) {
+    bwu_manager_->PrepareBwuForEndpoint(
+        connection_request.endpoint_id(),
+        ComputeIntersectionOfSupportedMediums(
+            pending_connections_.at(connection_request.endpoint_id()))
+            .GetMediums(true));
+  }
+
   // Next, we'll set up encryption.
-  encryption_runner_.StartServer(client, connection_request.endpoint_id(),
-                                 owned_channel, GetResultListener());
+  // A ClientInit in the request is answered even with the flag off, since
+  // the client won't send it again.
+  encryption_runner_.StartServer(
+      client, connection_request.endpoint_id(), owned_channel,
+      GetResultListener(), std::move(resumption),
+      ByteArray(connection_request.ukey2_client_init()));
   return {Exception::kSuccess};
 }
 
@@ -1667,15 +2460,36 @@ void BasePcpHandler::EvaluateConnectionResult(ClientProxy* client,
     // channels
     // Now, after both parties accepted connection (presumably after verifying &
     // matching security tokens), we are allowed to extract the shared key.
-    auto ukey2 = std::move(connection_info.ukey2);
-    bool succeeded = ukey2->VerifyHandshake();
-    CHECK(succeeded);  // If this fails, it's a UKEY2 protocol bug.
-    auto context = ukey2->ToConnectionContext();
-    CHECK(context);  // there is no way how this can fail, if Verify succeeded.
-    // If it did, it's a UKEY2 protocol bug.
-
-    if (!channel_manager_->EncryptChannelForEndpoint(endpoint_id,
-                                                     std::move(context))) {
+    std::unique_ptr<D2DConnectionContextV1> context;
+    if (connection_info.resumed_context) {
+      context = std::move(connection_info.resumed_context);
+    } else {
+      auto ukey2 = std::move(connection_info.ukey2);
+      bool succeeded = ukey2->VerifyHandshake();
+      CHECK(succeeded);  // If this fails, it's a UKEY2 protocol bug.
+      context = ukey2->ToConnectionContext();
+      CHECK(context);  // there is no way how this can fail, if Verify
+                       // succeeded. If it did, it's a UKEY2 protocol bug.
+    }
+    IssueSessionTicket(endpoint_id, connection_info, *context);
+
+    // Both sides announced AEAD frame support in their connection responses,
+    // so both make the same choice here.
+    std::unique_ptr<AeadFrameCipher> aead_cipher;
+    if (NearbyFlags::GetInstance().GetBoolFlag(
+            config_package_nearby::nearby_connections_feature::
+                kEnableAeadFrameEncryption) &&
+        connection_info.remote_supports_aead_frames) {
+      std::unique_ptr<std::string> session_unique =
+          context->GetSessionUnique();
+      if (session_unique != nullptr) {
+        aead_cipher = std::make_unique<AeadFrameCipher>(
+            *session_unique, /*is_server=*/connection_info.is_incoming);
+      }
+    }
+
+    if (!channel_manager_->EncryptChannelForEndpoint(
+            endpoint_id, std::move(context), std::move(aead_cipher))) {
       response_code = {Status::kEndpointUnknown};
     }
   } else {
@@ -1727,6 +2541,35 @@ void BasePcpHandler::EvaluateConnectionResult(ClientProxy* client,
   }
 }
 
+void BasePcpHandler::IssueSessionTicket(
+    const std::string& endpoint_id,
+    const PendingConnectionInfo& connection_info,
+    D2DConnectionContextV1& context) {
+  if (!NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableUkey2SessionResumption) ||
+      !connection_info.remote_supports_session_resumption) {
+    return;
+  }
+
+  std::unique_ptr<std::string> session_unique = context.GetSessionUnique();
+  if (session_unique == nullptr) return;
+
+  absl::Time now = SystemClock::ElapsedRealtime();
+  SessionTicket ticket = DeriveSessionTicket(
+      *session_unique,
+      now + absl::Milliseconds(NearbyFlags::GetInstance().GetInt64Flag(
+                config_package_nearby::nearby_connections_feature::
+                    kSessionTicketTtlMillis)));
+  NEARBY_LOGS(INFO) << "Issued session ticket for endpoint_id=" << endpoint_id;
+  if (connection_info.is_incoming) {
+    std::string ticket_id(ticket.id);
+    incoming_session_tickets_.Put(ticket_id, std::move(ticket), now);
+  } else {
+    outgoing_session_tickets_.Put(endpoint_id, std::move(ticket), now);
+  }
+}
+
 ExceptionOr<OfflineFrame> BasePcpHandler::ReadConnectionRequestFrame(
     EndpointChannel* endpoint_channel) {
   if (endpoint_channel == nullptr) {
@@ -1852,6 +2695,11 @@ void BasePcpHandler::PendingConnectionInfo::SetCryptoContext(
   this->ukey2 = std::move(ukey2);
 }
 
+void BasePcpHandler::PendingConnectionInfo::SetCryptoContext(
+    std::unique_ptr<D2DConnectionContextV1> context) {
+  this->resumed_context = std::move(context);
+}
+
 BasePcpHandler::PendingConnectionInfo::~PendingConnectionInfo() {
   auto future_status = result.lock();
   if (future_status && !future_status->IsSet()) {
@@ -1867,6 +2715,7 @@ BasePcpHandler::PendingConnectionInfo::~PendingConnectionInfo() {
   // Destroy crypto context now; for some reason, crypto context destructor
   // segfaults if it is not destroyed here.
   this->ukey2.reset();
+  this->resumed_context.reset();
 }
 
 void BasePcpHandler::PendingConnectionInfo::LocalEndpointAcceptedConnection(
@@ -16,14 +16,18 @@
 #define CORE_INTERNAL_BASE_PCP_HANDLER_H_
 
 #include <cstdint>
+#include <deque>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "securegcm/d2d_connection_context_v1.h"
 #include "securegcm/ukey2_handshake.h"
 #include "absl/container/btree_map.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
 #include "connections/implementation/bwu_manager.h"
 #include "connections/implementation/client_proxy.h"
@@ -31,8 +35,10 @@
 #include "connections/implementation/endpoint_channel_manager.h"
 #include "connections/implementation/endpoint_manager.h"
 #include "connections/implementation/mediums/mediums.h"
+#include "connections/implementation/offline_frames.h"
 #include "connections/implementation/pcp.h"
 #include "connections/implementation/pcp_handler.h"
+#include "connections/implementation/session_ticket_store.h"
 #include "connections/listeners.h"
 #include "connections/medium_selector.h"
 #include "connections/status.h"
@@ -40,9 +46,11 @@
 #include "internal/platform/atomic_boolean.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/cancelable_alarm.h"
+#include "internal/platform/cancellation_flag.h"
 #include "internal/platform/connection_info.h"
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/future.h"
+#include "internal/platform/multi_thread_executor.h"
 #include "internal/platform/prng.h"
 #include "internal/platform/scheduled_executor.h"
 #include "internal/platform/single_thread_executor.h"
@@ -99,6 +107,13 @@ class BasePcpHandler : public PcpHandler,
   // otherwise does nothing.
   void StopAdvertising(ClientProxy* client) override;
 
+  // Moves ongoing advertising for service_id to advertising_options, only
+  // restarting the mediums whose parameters changed. Stops advertising if that
+  // fails.
+  Status UpdateAdvertisingOptions(
+      ClientProxy* client, absl::string_view service_id,
+      const AdvertisingOptions& advertising_options) override;
+
   // Starts discovery of endpoints that may be advertising.
   // Updates ClientProxy state once discovery started.
   // DiscoveryListener will get called in case of any event.
@@ -110,6 +125,14 @@ class BasePcpHandler : public PcpHandler,
   // otherwise does nothing.
   void StopDiscovery(ClientProxy* client) override;
 
+  // Moves ongoing discovery for service_id to discovery_options, only
+  // restarting the mediums whose parameters changed. Endpoints only found on
+  // the mediums that were turned off are reported lost. Stops discovery if
+  // that fails.
+  Status UpdateDiscoveryOptions(
+      ClientProxy* client, absl::string_view service_id,
+      const DiscoveryOptions& discovery_options) override;
+
   void InjectEndpoint(ClientProxy* client, const std::string& service_id,
                       const OutOfBandConnectionMetadata& metadata) override;
 
@@ -254,6 +277,9 @@ class BasePcpHandler : public PcpHandler,
   void OnEndpointLost(ClientProxy* client, const DiscoveredEndpoint& endpoint)
       RUN_ON_PCP_HANDLER_THREAD();
 
+  // Processes the connection right away, or, once
+  // kMaxConcurrentIncomingHandshakes are running, queues it until one of them
+  // finishes.
   Exception OnIncomingConnection(
       ClientProxy* client, const ByteArray& remote_endpoint_info,
       std::unique_ptr<EndpointChannel> endpoint_channel,
@@ -276,6 +302,16 @@ class BasePcpHandler : public PcpHandler,
   virtual Status StopAdvertisingImpl(ClientProxy* client)
       RUN_ON_PCP_HANDLER_THREAD() = 0;
 
+  // Moves advertising from old_options to new_options, and returns the
+  // mediums it is running on afterwards. Restarts advertising on every medium
+  // unless overridden.
+  virtual StartOperationResult UpdateAdvertisingImpl(
+      ClientProxy* client, const std::string& service_id,
+      const std::string& local_endpoint_id,
+      const ByteArray& local_endpoint_info,
+      const AdvertisingOptions& old_options,
+      const AdvertisingOptions& new_options) RUN_ON_PCP_HANDLER_THREAD();
+
   virtual StartOperationResult StartDiscoveryImpl(
       ClientProxy* client, const std::string& service_id,
       const DiscoveryOptions& discovery_options)
@@ -284,6 +320,14 @@ class BasePcpHandler : public PcpHandler,
   virtual Status StopDiscoveryImpl(ClientProxy* client)
       RUN_ON_PCP_HANDLER_THREAD() = 0;
 
+  // Moves discovery from old_options to new_options, and returns the mediums
+  // it is running on afterwards. Restarts discovery on every medium unless
+  // overridden.
+  virtual StartOperationResult UpdateDiscoveryImpl(
+      ClientProxy* client, const std::string& service_id,
+      const DiscoveryOptions& old_options,
+      const DiscoveryOptions& new_options) RUN_ON_PCP_HANDLER_THREAD();
+
   virtual StartOperationResult StartListeningForIncomingConnectionsImpl(
       ClientProxy* client_proxy, absl::string_view service_id,
       absl::string_view local_endpoint_id,
@@ -301,6 +345,17 @@ class BasePcpHandler : public PcpHandler,
                                         DiscoveredEndpoint* endpoint)
       RUN_ON_PCP_HANDLER_THREAD() = 0;
 
+  // Same as ConnectImpl(client, endpoint), but gives up once
+  // `cancellation_flag` is cancelled rather than the client's flag for the
+  // endpoint. Used when racing mediums, where losing attempts are cancelled
+  // on their own; the default implementation ignores `cancellation_flag`.
+  virtual ConnectImplResult ConnectImpl(ClientProxy* client,
+                                        DiscoveredEndpoint* endpoint,
+                                        CancellationFlag* cancellation_flag)
+      RUN_ON_PCP_HANDLER_THREAD() {
+    return ConnectImpl(client, endpoint);
+  }
+
   virtual std::vector<location::nearby::proto::connections::Medium>
   GetConnectionMediumsByPriority() = 0;
   virtual location::nearby::proto::connections::Medium
@@ -308,6 +363,18 @@ class BasePcpHandler : public PcpHandler,
 
   // Returns the first discovered endpoint for the given endpoint_id.
   DiscoveredEndpoint* GetDiscoveredEndpoint(const std::string& endpoint_id);
+  // Keeps `endpoint` for kLostEndpointCacheTtlMillis once it is no longer
+  // discovered, if kEnableLostEndpointCache is enabled.
+  void RememberLostEndpoint(std::shared_ptr<DiscoveredEndpoint> endpoint);
+  // Puts the lost endpoints remembered for `endpoint_id` back among the
+  // discovered endpoints, except for mediums it has been discovered on again.
+  void RestoreLostEndpoints(const std::string& endpoint_id);
+  // Remembers the Bluetooth and Wi-Fi LAN addresses of `endpoint`, if
+  // kEnableKnownEndpointCache is enabled.
+  void RememberKnownEndpoint(const DiscoveredEndpoint& endpoint);
+  // Adds discovered endpoints for the addresses remembered for `endpoint_id`.
+  // Returns whether there were any.
+  bool RestoreKnownEndpoint(const std::string& endpoint_id);
 
   // Returns a vector of discovered endpoints, sorted in order of decreasing
   // preference.
@@ -361,6 +428,9 @@ class BasePcpHandler : public PcpHandler,
     // Passes crypto context that we acquired in DH session for temporary
     // ownership here.
     void SetCryptoContext(std::unique_ptr<securegcm::UKey2Handshake> ukey2);
+    // Passes the context of a session resumed from a session ticket.
+    void SetCryptoContext(
+        std::unique_ptr<securegcm::D2DConnectionContextV1> context);
 
     // Pass Accept notification to client.
     void LocalEndpointAcceptedConnection(const std::string& endpoint_id,
@@ -397,11 +467,50 @@ class BasePcpHandler : public PcpHandler,
     // accepted. Crypto context is passed over to channel_manager_ before
     // switching to connected state, where Payload may be exchanged.
     std::unique_ptr<securegcm::UKey2Handshake> ukey2;
+    // Set instead of |ukey2| if the connection was resumed from a session
+    // ticket, in which case there is no handshake left to verify.
+    std::unique_ptr<securegcm::D2DConnectionContextV1> resumed_context;
+
+    // Whether the remote endpoint can resume a later connection from a
+    // session ticket of this one.
+    bool remote_supports_session_resumption = false;
+    // Whether the remote endpoint can encrypt frames with AeadFrameCipher.
+    bool remote_supports_aead_frames = false;
+    // Whether our UKEY2 ClientInit went out in the ConnectionRequestFrame.
+    bool used_compact_handshake = false;
 
     // Used in AnalyticsRecorder for devices connection tracking.
     std::string connection_token;
   };
 
+  // An incoming connection waiting for room to run its handshake.
+  struct QueuedIncomingConnection {
+    ClientProxy* client = nullptr;
+    ByteArray remote_endpoint_info;
+    std::unique_ptr<EndpointChannel> channel;
+    location::nearby::proto::connections::Medium medium =
+        location::nearby::proto::connections::Medium::UNKNOWN_MEDIUM;
+    absl::Time deadline;
+  };
+
+  Exception ProcessIncomingConnection(
+      ClientProxy* client, const ByteArray& remote_endpoint_info,
+      std::unique_ptr<EndpointChannel> endpoint_channel,
+      location::nearby::proto::connections::Medium medium)
+      RUN_ON_PCP_HANDLER_THREAD();
+  // Returns the number of incoming connections still running their handshake.
+  int GetIncomingHandshakeCount() RUN_ON_PCP_HANDLER_THREAD();
+  // Processes queued incoming connections while there is room for their
+  // handshakes, and rejects the ones that can't get it before their deadline.
+  void ProcessQueuedIncomingConnections() RUN_ON_PCP_HANDLER_THREAD();
+  // Rejects the queued incoming connections of |client| once it neither
+  // advertises nor listens for incoming connections anymore.
+  void RejectQueuedIncomingConnections(ClientProxy* client)
+      RUN_ON_PCP_HANDLER_THREAD();
+  // Tells the remote endpoint that we are too busy, then closes |channel|.
+  void RejectBusyIncomingConnection(std::unique_ptr<EndpointChannel> channel)
+      RUN_ON_PCP_HANDLER_THREAD();
+
   // @EncryptionRunnerThread
   // Called internally when DH session has negotiated a key successfully.
   void OnEncryptionSuccessImpl(const std::string& endpoint_id,
@@ -416,20 +525,45 @@ class BasePcpHandler : public PcpHandler,
 
   EncryptionRunner::ResultListener GetResultListener();
 
+  // Exactly one of |ukey2| and |resumed_context| is set on success.
   void OnEncryptionSuccessRunnable(
       const std::string& endpoint_id,
       std::unique_ptr<securegcm::UKey2Handshake> ukey2,
+      std::unique_ptr<securegcm::D2DConnectionContextV1> resumed_context,
       const std::string& auth_token, const ByteArray& raw_auth_token);
   void OnEncryptionFailureRunnable(const std::string& endpoint_id,
                                    EndpointChannel* endpoint_channel);
 
   static Exception WriteConnectionRequestFrame(
-      const ConnectionInfo& conection_info, EndpointChannel* endpoint_channel);
+      const ConnectionInfo& conection_info,
+      const parser::SessionResumptionOffer& offer,
+      const parser::CompactHandshakeOffer& compact,
+      EndpointChannel* endpoint_channel);
+
+  // Identifies a remote endpoint in compact_handshake_endpoints_.
+  static std::string GetCompactHandshakeKey(const std::string& endpoint_id,
+                                            const ByteArray& endpoint_info);
+  // Remembers whether the remote endpoint takes the UKEY2 ClientInit in the
+  // ConnectionRequestFrame of our later connections to it.
+  void SetRemoteSupportsCompactHandshake(const std::string& endpoint_id,
+                                         const ByteArray& endpoint_info,
+                                         bool supports)
+      RUN_ON_PCP_HANDLER_THREAD();
+
+  // Remembers a session ticket of the newly accepted connection, so that a
+  // later connection to the same endpoint can skip UKEY2.
+  void IssueSessionTicket(const std::string& endpoint_id,
+                          const PendingConnectionInfo& connection_info,
+                          securegcm::D2DConnectionContextV1& context)
+      RUN_ON_PCP_HANDLER_THREAD();
   static constexpr absl::Duration kConnectionRequestReadTimeout =
       absl::Seconds(2);
   static constexpr absl::Duration kRejectedConnectionCloseDelay =
       absl::Seconds(2);
   static constexpr int kConnectionTokenLength = 8;
+  static constexpr int kMaxRacedConnectAttempts = 3;
+  static constexpr int kMaxKnownEndpoints = 64;
+  static constexpr int kMaxCompactHandshakeEndpoints = 64;
 
   // Returns true if the new endpoint is preferred over the old endpoint.
   bool IsPreferred(const BasePcpHandler::DiscoveredEndpoint& new_endpoint,
@@ -527,6 +661,16 @@ class BasePcpHandler : public PcpHandler,
   void StripOutUnavailableMediums(AdvertisingOptions& advertising_options);
   void StripOutUnavailableMediums(DiscoveryOptions& discovery_options);
 
+  // Races connection attempts to `endpoints`, given in preference order, and
+  // returns the first one that connects; the others are cancelled. Each
+  // attempt gets a head start of kConnectionRaceStaggerMillis over the next
+  // one, cut short if it fails. If no attempt connects, returns the result of
+  // the last one to fail.
+  ConnectImplResult RaceConnectImpl(
+      ClientProxy* client, const std::string& endpoint_id,
+      const std::vector<DiscoveredEndpoint*>& endpoints)
+      RUN_ON_PCP_HANDLER_THREAD();
+
   // The endpoint id in high visibility mode is stable for 30 seconds, while in
   // low visibility mode it always rotates. We assume a client is trying to
   // rotate endpoint id when the advertising options is "low power" (3P) or
@@ -544,6 +688,8 @@ class BasePcpHandler : public PcpHandler,
 
   ScheduledExecutor alarm_executor_;
   SingleThreadExecutor serial_executor_;
+  // Runs the connection attempts of RaceConnectImpl().
+  MultiThreadExecutor connect_race_executor_{kMaxRacedConnectAttempts};
 
   // A map of endpoint id -> PendingConnectionInfo. Entries in this map imply
   // that there is an active connection to the endpoint and we're waiting for
@@ -551,9 +697,39 @@ class BasePcpHandler : public PcpHandler,
   // the connection is decided (either accepted or rejected), it should be
   // removed from this map.
   absl::flat_hash_map<std::string, PendingConnectionInfo> pending_connections_;
+  // Incoming connections waiting for room to run their handshake, oldest
+  // first.
+  std::deque<QueuedIncomingConnection> queued_incoming_connections_;
   // A map of endpoint id -> DiscoveredEndpoint.
   absl::btree_multimap<std::string, std::shared_ptr<DiscoveredEndpoint>>
       discovered_endpoints_;
+  // A map of endpoint id -> recently lost DiscoveredEndpoint, along with the
+  // time until which it may still be restored.
+  struct LostEndpoint {
+    std::shared_ptr<DiscoveredEndpoint> endpoint;
+    absl::Time expiry;
+  };
+  absl::btree_multimap<std::string, LostEndpoint> lost_endpoints_;
+  // A map of endpoint id -> where the endpoint was last discovered. Unlike
+  // lost_endpoints_, only addresses are kept, and for much longer.
+  struct KnownEndpoint {
+    ByteArray endpoint_info;
+    std::string service_id;
+    // Empty if the endpoint wasn't discovered over Bluetooth.
+    std::string bluetooth_mac_address;
+    std::optional<NsdServiceInfo> wifi_lan_service_info;
+    absl::Time last_seen;
+  };
+  absl::flat_hash_map<std::string, KnownEndpoint> known_endpoints_;
+  // Session tickets of connections we requested, by remote endpoint id.
+  SessionTicketStore outgoing_session_tickets_;
+  // Session tickets of connections we accepted, by ticket id.
+  SessionTicketStore incoming_session_tickets_;
+  // The remote endpoints that take the UKEY2 ClientInit in the
+  // ConnectionRequestFrame, by GetCompactHandshakeKey(). An endpoint is
+  // forgotten if a compact handshake with it fails, so that the next attempt
+  // runs the full one.
+  absl::flat_hash_set<std::string> compact_handshake_endpoints_;
   // A map of endpoint id -> alarm. These alarms delay closing the
   // EndpointChannel to give the other side enough time to read the rejection
   // message. It's expected that the other side will close the connection
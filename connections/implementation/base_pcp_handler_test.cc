@@ -27,6 +27,7 @@
 #include "connections/implementation/bwu_manager.h"
 #include "connections/implementation/client_proxy.h"
 #include "connections/implementation/encryption_runner.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/implementation/offline_frames.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
 #include "connections/listeners.h"
@@ -34,7 +35,9 @@
 #include "connections/status.h"
 #include "connections/strategy.h"
 #include "connections/v3/connection_listening_options.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/count_down_latch.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/medium_environment.h"
 #include "internal/platform/pipe.h"
@@ -45,7 +48,9 @@ namespace nearby {
 namespace connections {
 namespace {
 
+using ::location::nearby::connections::OfflineFrame;
 using ::location::nearby::connections::OsInfo;
+using ::location::nearby::connections::V1Frame;
 using ::location::nearby::proto::connections::Medium;
 using ::testing::_;
 using ::testing::AtLeast;
@@ -130,6 +135,7 @@ class MockPcpHandler : public BasePcpHandler {
   using BasePcpHandler::ConnectImplResult;
   using BasePcpHandler::DiscoveredEndpoint;
   using BasePcpHandler::StartOperationResult;
+  using BasePcpHandler::WifiLanEndpoint;
 
   MOCK_METHOD(Strategy, GetStrategy, (), (const override));
   MOCK_METHOD(Pcp, GetPcp, (), (const override));
@@ -182,6 +188,22 @@ class MockPcpHandler : public BasePcpHandler {
   }
 
   // Mock adapters for protected non-virtual methods of a base class.
+  Exception OnIncomingConnection(ClientProxy* client,
+                                 const ByteArray& remote_endpoint_info,
+                                 std::unique_ptr<EndpointChannel> channel,
+                                 Medium medium) {
+    Exception result;
+    CountDownLatch latch(1);
+    RunOnPcpHandlerThread(
+        "incoming-connection",
+        [&]() RUN_ON_PCP_HANDLER_THREAD() {
+          result = BasePcpHandler::OnIncomingConnection(
+              client, remote_endpoint_info, std::move(channel), medium);
+          latch.CountDown();
+        });
+    latch.Await();
+    return result;
+  }
   void OnEndpointFound(ClientProxy* client,
                        std::shared_ptr<DiscoveredEndpoint> endpoint)
       ABSL_NO_THREAD_SAFETY_ANALYSIS {
@@ -199,6 +221,12 @@ class MockPcpHandler : public BasePcpHandler {
       const std::string& endpoint_id) {
     return BasePcpHandler::GetDiscoveredEndpoints(endpoint_id);
   }
+  void RestoreLostEndpoints(const std::string& endpoint_id) {
+    BasePcpHandler::RestoreLostEndpoints(endpoint_id);
+  }
+  bool RestoreKnownEndpoint(const std::string& endpoint_id) {
+    return BasePcpHandler::RestoreKnownEndpoint(endpoint_id);
+  }
 
   std::vector<BasePcpHandler::DiscoveredEndpoint*> GetDiscoveredEndpoints(
       location::nearby::proto::connections::Medium medium) {
@@ -603,6 +631,89 @@ TEST_P(BasePcpHandlerTest, StopAdvertisingChangesState) {
   env_.Stop();
 }
 
+TEST_F(BasePcpHandlerTest, StopAdvertisingRejectsQueuedIncomingConnections) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kMaxConcurrentIncomingHandshakes,
+      1);
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kIncomingConnectionQueueTimeoutMillis,
+      60000);
+  env_.Start();
+  ClientProxy client;
+  Mediums m;
+  EndpointChannelManager ecm;
+  EndpointManager em(&ecm);
+  BwuManager bwu(m, em, ecm, {}, {});
+  MockPcpHandler pcp_handler(&m, &em, &ecm, &bwu);
+  EXPECT_CALL(pcp_handler, CanReceiveIncomingConnection)
+      .WillRepeatedly(Return(true));
+  EXPECT_CALL(pcp_handler, GetStrategy)
+      .WillRepeatedly(Return(Strategy::kP2pCluster));
+  StartAdvertising(&client, &pcp_handler, {.bluetooth = true});
+
+  // The ClientInit never arrives, so this handshake keeps running and takes
+  // the only slot.
+  auto handshaking_channel =
+      std::make_unique<MockEndpointChannel>(&pipe_a_, &pipe_b_);
+  EXPECT_CALL(*handshaking_channel, Read())
+      .WillOnce(Return(ExceptionOr<ByteArray>(parser::ForConnectionRequest({
+          .local_endpoint_id = "ABCD",
+          .local_endpoint_info = ByteArray{"remote_endpoint"},
+          .nonce = 1,
+      }))))
+      .WillRepeatedly(
+          Invoke([channel = handshaking_channel.get()]() {
+            return channel->DoRead();
+          }));
+  EXPECT_CALL(*handshaking_channel, Write(_))
+      .WillRepeatedly(Return(Exception{Exception::kSuccess}));
+  EXPECT_CALL(*handshaking_channel, GetMedium)
+      .WillRepeatedly(Return(Medium::BLUETOOTH));
+  EXPECT_CALL(*handshaking_channel, IsPaused).WillRepeatedly(Return(false));
+  EXPECT_CALL(*handshaking_channel, GetLastReadTimestamp)
+      .WillRepeatedly(Return(absl::Now()));
+  EXPECT_TRUE(pcp_handler
+                  .OnIncomingConnection(&client, ByteArray{"remote_endpoint"},
+                                        std::move(handshaking_channel),
+                                        Medium::BLUETOOTH)
+                  .Ok());
+
+  auto queued_channel =
+      std::make_unique<MockEndpointChannel>(&pipe_b_, &pipe_a_);
+  ByteArray rejection;
+  CountDownLatch closed(1);
+  EXPECT_CALL(*queued_channel, Read()).Times(0);
+  EXPECT_CALL(*queued_channel, Write(_))
+      .WillOnce(Invoke([&rejection](const ByteArray& data) {
+        rejection = data;
+        return Exception{Exception::kSuccess};
+      }));
+  EXPECT_CALL(*queued_channel, CloseImpl)
+      .WillRepeatedly(Invoke([&closed]() { closed.CountDown(); }));
+  EXPECT_CALL(*queued_channel, GetMedium)
+      .WillRepeatedly(Return(Medium::BLUETOOTH));
+  EXPECT_TRUE(pcp_handler
+                  .OnIncomingConnection(&client, ByteArray{"other_endpoint"},
+                                        std::move(queued_channel),
+                                        Medium::BLUETOOTH)
+                  .Ok());
+
+  EXPECT_CALL(pcp_handler, StopAdvertisingImpl(&client)).Times(1);
+  pcp_handler.StopAdvertising(&client);
+
+  EXPECT_TRUE(closed.Await(absl::Seconds(5)).result());
+  ExceptionOr<OfflineFrame> frame = parser::FromBytes(rejection);
+  ASSERT_TRUE(frame.ok());
+  EXPECT_EQ(parser::GetFrameType(frame.result()), V1Frame::CONNECTION_RESPONSE);
+  // Fails the handshake.
+  pipe_a_.GetOutputStream().Close();
+  bwu.Shutdown();
+  env_.Stop();
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 TEST_P(BasePcpHandlerTest, StartDiscoveryChangesState) {
   env_.Start();
   ClientProxy client;
@@ -683,6 +794,70 @@ TEST_F(BasePcpHandlerTest, WifiMediumFailFallBackToBT) {
   env_.Stop();
 }
 
+TEST_F(BasePcpHandlerTest, RacedWifiMediumFailFallBackToBT) {
+  MediumEnvironment::Instance().SetFeatureFlags(
+      FeatureFlags::Flags{.enable_cancellation_flag = true});
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableConnectionRacing,
+      true);
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kConnectionRaceStaggerMillis,
+      0);
+  env_.Start();
+  std::string service_id{"service"};
+  std::string endpoint_id{"ABCD"};
+  ClientProxy client;
+  Mediums m;
+  EndpointChannelManager ecm;
+  EndpointManager em(&ecm);
+  BwuManager bwu(m, em, ecm, {}, {});
+  MockPcpHandler pcp_handler(&m, &em, &ecm, &bwu);
+  BooleanMediumSelector allowed{
+      .bluetooth = true,
+      .wifi_lan = true,
+  };
+  DiscoveryOptions discovery_options{
+      {
+          Strategy::kP2pCluster,
+          allowed,
+      },
+      false,  // auto_upgrade_bandwidth;
+      false,  // enforce_topology_constraints;
+  };
+  EXPECT_CALL(pcp_handler, StartDiscoveryImpl(&client, service_id, _))
+      .WillOnce(Return(MockPcpHandler::StartOperationResult{
+          .status = {Status::kSuccess},
+          .mediums = allowed.GetMediums(true),
+      }));
+
+  EXPECT_EQ(pcp_handler.StartDiscovery(&client, service_id, discovery_options,
+                                       discovery_listener_),
+            Status{Status::kSuccess});
+  EXPECT_TRUE(client.IsDiscovering());
+
+  // WifiLan and Bluetooth are raced against each other; WifiLan fails and
+  // Bluetooth wins the race.
+  auto mediums = pcp_handler.GetDiscoveryMediums(&client);
+  auto connect_medium = mediums[mediums.size() - 1];
+  auto channel_pair = SetupConnection(pipe_a_, pipe_b_, connect_medium);
+  auto& channel_a = channel_pair.first;
+  auto& channel_b = channel_pair.second;
+  EXPECT_CALL(*channel_a, CloseImpl).Times(1);
+  EXPECT_CALL(*channel_b, CloseImpl).Times(1);
+  EXPECT_CALL(mock_connection_listener_.rejected_cb, Call).Times(AtLeast(0));
+  RequestConnectionWifiLanFail(endpoint_id, std::move(channel_a),
+                               channel_b.get(), &client, &pcp_handler);
+  NEARBY_LOG(INFO, "RequestConnection complete");
+  channel_b->Close();
+  bwu.Shutdown();
+  pcp_handler.DisconnectFromEndpointManager();
+  env_.Stop();
+  NearbyFlags::GetInstance().ResetOverridedValues();
+  MediumEnvironment::Instance().SetFeatureFlags(FeatureFlags::Flags{});
+}
+
 TEST_P(BasePcpHandlerTest, RequestConnectionChangesState) {
   env_.Start();
   std::string endpoint_id{"1234"};
@@ -931,6 +1106,190 @@ TEST_P(BasePcpHandlerTest, MultipleMediumsProduceSingleEndpointLostEvent) {
 INSTANTIATE_TEST_SUITE_P(ParameterizedBasePcpHandlerTest, BasePcpHandlerTest,
                          ::testing::ValuesIn(kTestCases));
 
+TEST_F(BasePcpHandlerTest, LostEndpointCanBeRestored) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableLostEndpointCache,
+      true);
+  env_.Start();
+  std::string endpoint_id{"1234"};
+  ClientProxy client;
+  Mediums m;
+  EndpointChannelManager ecm;
+  EndpointManager em(&ecm);
+  BwuManager bwu(m, em, ecm, {}, {});
+  MockPcpHandler pcp_handler(&m, &em, &ecm, &bwu);
+  StartDiscovery(&client, &pcp_handler,
+                 BooleanMediumSelector{.wifi_lan = true});
+  EXPECT_CALL(mock_discovery_listener_.endpoint_found_cb, Call);
+  EXPECT_CALL(mock_discovery_listener_.endpoint_lost_cb, Call);
+  pcp_handler.OnEndpointFound(
+      &client,
+      std::make_shared<MockDiscoveredEndpoint>(MockDiscoveredEndpoint{
+          {
+              endpoint_id,
+              ByteArray{"ABCD"},
+              "service",
+              location::nearby::proto::connections::WIFI_LAN,
+              WebRtcState::kUndefined,
+          },
+          MockContext{},
+      }));
+  auto* endpoint = pcp_handler.GetDiscoveredEndpoint(endpoint_id);
+  ASSERT_NE(endpoint, nullptr);
+
+  pcp_handler.OnEndpointLost(&client, *endpoint);
+  EXPECT_EQ(pcp_handler.GetDiscoveredEndpoint(endpoint_id), nullptr);
+
+  pcp_handler.RestoreLostEndpoints(endpoint_id);
+  endpoint = pcp_handler.GetDiscoveredEndpoint(endpoint_id);
+  ASSERT_NE(endpoint, nullptr);
+  EXPECT_EQ(endpoint->medium, location::nearby::proto::connections::WIFI_LAN);
+  bwu.Shutdown();
+  pcp_handler.DisconnectFromEndpointManager();
+  env_.Stop();
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST_F(BasePcpHandlerTest, KnownEndpointCanBeRestored) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableKnownEndpointCache,
+      true);
+  env_.Start();
+  std::string endpoint_id{"1234"};
+  ClientProxy client;
+  Mediums m;
+  EndpointChannelManager ecm;
+  EndpointManager em(&ecm);
+  BwuManager bwu(m, em, ecm, {}, {});
+  MockPcpHandler pcp_handler(&m, &em, &ecm, &bwu);
+  StartDiscovery(&client, &pcp_handler,
+                 BooleanMediumSelector{.wifi_lan = true});
+  EXPECT_CALL(mock_discovery_listener_.endpoint_found_cb, Call);
+  EXPECT_CALL(mock_discovery_listener_.endpoint_lost_cb, Call);
+  NsdServiceInfo service_info;
+  service_info.SetIPAddress("192.168.1.2");
+  service_info.SetPort(4321);
+  pcp_handler.OnEndpointFound(
+      &client,
+      std::make_shared<MockPcpHandler::WifiLanEndpoint>(
+          MockPcpHandler::WifiLanEndpoint{
+              {
+                  endpoint_id,
+                  ByteArray{"ABCD"},
+                  "service",
+                  location::nearby::proto::connections::WIFI_LAN,
+                  WebRtcState::kUndefined,
+              },
+              service_info,
+          }));
+  auto* endpoint = pcp_handler.GetDiscoveredEndpoint(endpoint_id);
+  ASSERT_NE(endpoint, nullptr);
+  pcp_handler.OnEndpointLost(&client, *endpoint);
+  EXPECT_EQ(pcp_handler.GetDiscoveredEndpoint(endpoint_id), nullptr);
+
+  EXPECT_FALSE(pcp_handler.RestoreKnownEndpoint("5678"));
+  EXPECT_TRUE(pcp_handler.RestoreKnownEndpoint(endpoint_id));
+  endpoint = pcp_handler.GetDiscoveredEndpoint(endpoint_id);
+  ASSERT_NE(endpoint, nullptr);
+  EXPECT_EQ(endpoint->medium, location::nearby::proto::connections::WIFI_LAN);
+  EXPECT_EQ(endpoint->endpoint_info, ByteArray{"ABCD"});
+  EXPECT_EQ(static_cast<MockPcpHandler::WifiLanEndpoint*>(endpoint)
+                ->service_info.GetPort(),
+            4321);
+  bwu.Shutdown();
+  pcp_handler.DisconnectFromEndpointManager();
+  env_.Stop();
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST_F(BasePcpHandlerTest, UpdateDiscoveryOptionsOnlyLosesStoppedMediums) {
+  env_.Start();
+  ClientProxy client;
+  Mediums m;
+  EndpointChannelManager ecm;
+  EndpointManager em(&ecm);
+  BwuManager bwu(m, em, ecm, {}, {});
+  MockPcpHandler pcp_handler(&m, &em, &ecm, &bwu);
+  StartDiscovery(&client, &pcp_handler,
+                 BooleanMediumSelector{.bluetooth = true, .wifi_lan = true});
+  EXPECT_CALL(mock_discovery_listener_.endpoint_found_cb, Call).Times(2);
+  EXPECT_CALL(mock_discovery_listener_.endpoint_lost_cb, Call("5678"));
+  pcp_handler.OnEndpointFound(
+      &client,
+      std::make_shared<MockDiscoveredEndpoint>(MockDiscoveredEndpoint{
+          {
+              "1234",
+              ByteArray{"ABCD"},
+              "service",
+              location::nearby::proto::connections::WIFI_LAN,
+              WebRtcState::kUndefined,
+          },
+          MockContext{},
+      }));
+  pcp_handler.OnEndpointFound(
+      &client,
+      std::make_shared<MockDiscoveredEndpoint>(MockDiscoveredEndpoint{
+          {
+              "5678",
+              ByteArray{"EFGH"},
+              "service",
+              location::nearby::proto::connections::BLUETOOTH,
+              WebRtcState::kUndefined,
+          },
+          MockContext{},
+      }));
+
+  DiscoveryOptions discovery_options{
+      {
+          Strategy::kP2pCluster,
+          BooleanMediumSelector{.wifi_lan = true},
+      },
+      true,  // auto_upgrade_bandwidth
+      true,  // enforce_topology_constraints
+  };
+  EXPECT_CALL(pcp_handler, StopDiscoveryImpl(&client));
+  EXPECT_CALL(pcp_handler, StartDiscoveryImpl(&client, "service", _))
+      .WillOnce(Return(MockPcpHandler::StartOperationResult{
+          .status = {Status::kSuccess},
+          .mediums = {location::nearby::proto::connections::WIFI_LAN},
+      }));
+  EXPECT_EQ(pcp_handler.UpdateDiscoveryOptions(&client, "service",
+                                               discovery_options),
+            Status{Status::kSuccess});
+  EXPECT_TRUE(client.IsDiscovering());
+  EXPECT_NE(pcp_handler.GetDiscoveredEndpoint("1234"), nullptr);
+  EXPECT_EQ(pcp_handler.GetDiscoveredEndpoint("5678"), nullptr);
+  EXPECT_FALSE(client.GetDiscoveryOptions().allowed.bluetooth);
+  bwu.Shutdown();
+  pcp_handler.DisconnectFromEndpointManager();
+  env_.Stop();
+}
+
+TEST_F(BasePcpHandlerTest, UpdateAdvertisingOptionsRequiresAdvertising) {
+  env_.Start();
+  ClientProxy client;
+  Mediums m;
+  EndpointChannelManager ecm;
+  EndpointManager em(&ecm);
+  BwuManager bwu(m, em, ecm, {}, {});
+  MockPcpHandler pcp_handler(&m, &em, &ecm, &bwu);
+  AdvertisingOptions advertising_options{
+      {
+          Strategy::kP2pCluster,
+          BooleanMediumSelector{.wifi_lan = true},
+      },
+      true,  // auto_upgrade_bandwidth
+      true,  // enforce_topology_constraints
+  };
+  EXPECT_EQ(pcp_handler.UpdateAdvertisingOptions(&client, "service",
+                                                 advertising_options),
+            Status{Status::kOutOfOrderApiCall});
+  bwu.Shutdown();
+  env_.Stop();
+}
+
 TEST_F(BasePcpHandlerTest, InjectEndpoint) {
   env_.Start();
   std::string service_id{"service"};
@@ -55,7 +55,8 @@ location::nearby::proto::connections::Medium BleV2EndpointChannel::GetMedium()
 }
 
 int BleV2EndpointChannel::GetMaxTransmitPacketSize() const {
-  return kDefaultBleMaxTransmitPacketSize;
+  return ble_socket_.IsL2cap() ? kL2capBleMaxTransmitPacketSize
+                               : kDefaultBleMaxTransmitPacketSize;
 }
 
 void BleV2EndpointChannel::CloseImpl() {
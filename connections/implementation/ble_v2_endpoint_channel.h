@@ -35,6 +35,9 @@ class BleV2EndpointChannel final : public BaseEndpointChannel {
 
  private:
   static constexpr int kDefaultBleMaxTransmitPacketSize = 512;  // 512 bytes
+  // L2CAP channels segment SDUs themselves, so chunks are not bound to the
+  // size of a GATT write.
+  static constexpr int kL2capBleMaxTransmitPacketSize = 8192;  // 8 KB
 
   void CloseImpl() override;
 
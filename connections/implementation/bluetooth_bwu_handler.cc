@@ -56,7 +56,7 @@ BluetoothBwuHandler::CreateUpgradedEndpointChannel(
                        << ") for endpoint " << endpoint_id << " and service ID "
                        << service_id;
 
-  BluetoothDevice device = bluetooth_medium_.GetRemoteDevice(mac_address);
+  BluetoothDevice device = bluetooth_medium().GetRemoteDevice(mac_address);
   if (!device.IsValid()) {
     NEARBY_LOGS(ERROR)
         << "BluetoothBwuHandler failed to derive a valid Bluetooth device "
@@ -65,7 +65,7 @@ BluetoothBwuHandler::CreateUpgradedEndpointChannel(
     return nullptr;
   }
 
-  BluetoothSocket socket = bluetooth_medium_.Connect(
+  BluetoothSocket socket = bluetooth_medium().Connect(
       device, service_id, client->GetCancellationFlag(endpoint_id));
   if (!socket.IsValid()) {
     NEARBY_LOGS(ERROR)
@@ -98,7 +98,7 @@ BluetoothBwuHandler::CreateUpgradedEndpointChannel(
 ByteArray BluetoothBwuHandler::HandleInitializeUpgradedMediumForEndpoint(
     ClientProxy* client, const std::string& upgrade_service_id,
     const std::string& endpoint_id) {
-  std::string mac_address = bluetooth_medium_.GetMacAddress();
+  std::string mac_address = bluetooth_medium().GetMacAddress();
   if (mac_address.empty()) {
     NEARBY_LOGS(ERROR) << "BluetoothBwuHandler couldn't initiate the "
                           "BLUETOOTH upgrade for service ID "
@@ -107,8 +107,8 @@ ByteArray BluetoothBwuHandler::HandleInitializeUpgradedMediumForEndpoint(
     return {};
   }
 
-  if (!bluetooth_medium_.IsAcceptingConnections(upgrade_service_id)) {
-    if (!bluetooth_medium_.StartAcceptingConnections(
+  if (!bluetooth_medium().IsAcceptingConnections(upgrade_service_id)) {
+    if (!bluetooth_medium().StartAcceptingConnections(
             upgrade_service_id,
             {
                 .accepted_cb = absl::bind_front(
@@ -134,7 +134,7 @@ ByteArray BluetoothBwuHandler::HandleInitializeUpgradedMediumForEndpoint(
 
 void BluetoothBwuHandler::HandleRevertInitiatorStateForService(
     const std::string& upgrade_service_id) {
-  bluetooth_medium_.StopAcceptingConnections(upgrade_service_id);
+  bluetooth_medium().StopAcceptingConnections(upgrade_service_id);
   NEARBY_LOG(INFO,
              "BluetoothBwuHandler successfully reverted all Bluetooth state.");
 }
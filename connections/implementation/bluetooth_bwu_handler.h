@@ -69,9 +69,12 @@ class BluetoothBwuHandler : public BaseBwuHandler {
                                      const std::string& upgrade_service_id,
                                      BluetoothSocket socket);
 
+  BluetoothRadio& bluetooth_radio() { return mediums_.GetBluetoothRadio(); }
+  BluetoothClassic& bluetooth_medium() {
+    return mediums_.GetBluetoothClassic();
+  }
+
   Mediums& mediums_;
-  BluetoothRadio& bluetooth_radio_{mediums_.GetBluetoothRadio()};
-  BluetoothClassic& bluetooth_medium_{mediums_.GetBluetoothClassic()};
 };
 
 }  // namespace connections
@@ -16,6 +16,8 @@
 
 #include <string>
 
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/bluetooth_classic.h"
 #include "internal/platform/logging.h"
 
@@ -24,6 +26,12 @@ namespace connections {
 
 namespace {
 
+bool IsThroughputModeEnabled() {
+  return NearbyFlags::GetInstance().GetBoolFlag(
+      config_package_nearby::nearby_connections_feature::
+          kEnableBluetoothThroughputMode);
+}
+
 OutputStream* GetOutputStreamOrNull(BluetoothSocket& socket) {
   if (socket.GetRemoteDevice().IsValid()) return &socket.GetOutputStream();
   return nullptr;
@@ -50,7 +58,15 @@ BluetoothEndpointChannel::GetMedium() const {
 }
 
 int BluetoothEndpointChannel::GetMaxTransmitPacketSize() const {
-  return kDefaultBTMaxTransmitPacketSize;
+  return IsThroughputModeEnabled() ? kThroughputModeBTMaxTransmitPacketSize
+                                   : kDefaultBTMaxTransmitPacketSize;
+}
+
+bool BluetoothEndpointChannel::ShouldCoalesceWrites() const {
+  // RFCOMM sends whatever a write hands it right away, so a length prefix
+  // written on its own costs a whole packet.
+  return IsThroughputModeEnabled() ||
+         BaseEndpointChannel::ShouldCoalesceWrites();
 }
 
 void BluetoothEndpointChannel::CloseImpl() {
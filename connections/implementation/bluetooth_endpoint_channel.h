@@ -36,8 +36,13 @@ class BluetoothEndpointChannel final : public BaseEndpointChannel {
 
  private:
   static constexpr int kDefaultBTMaxTransmitPacketSize = 1980;  // 990 * 2 Bytes
+  // Used in throughput mode, where the per-chunk frame and encryption overhead
+  // dominates with the default size.
+  static constexpr int kThroughputModeBTMaxTransmitPacketSize =
+      15840;  // 990 * 16 Bytes
 
   void CloseImpl() override;
+  bool ShouldCoalesceWrites() const override;
 
   BluetoothSocket bluetooth_socket_;
 };
@@ -64,6 +64,17 @@ class BwuHandler {
       ClientProxy* client, const std::string& service_id,
       const std::string& endpoint_id) = 0;
 
+  // Called by the Initiator when an upgrade to this medium is expected for an
+  // endpoint that is still connecting, so that slow setup, e.g. starting a soft
+  // AP, overlaps with the connection being set up.
+  // @BwuHandlerThread
+  virtual void PrepareUpgradedMedium() {}
+
+  // Called to undo PrepareUpgradedMedium() when the expected upgrade doesn't
+  // happen. Leaves the medium alone while upgrades are using it.
+  // @BwuHandlerThread
+  virtual void RevertPreparedUpgradedMedium() {}
+
   // Called to revert any state changed by the Initiator to set up the upgraded
   // medium for an endpoint. Reverts for _all_ services. Use
   // RevertInitiatorState(service_id, endpoint_id) for a more fine-grained
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -24,8 +25,11 @@
 #include "absl/time/time.h"
 #include "connections/implementation/bluetooth_bwu_handler.h"
 #include "connections/implementation/bwu_handler.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "connections/implementation/medium_performance_history.h"
 #include "connections/implementation/offline_frames.h"
 #include "connections/implementation/service_id_constants.h"
+#include "connections/implementation/transport_config.h"
 #ifdef NO_WEBRTC
 #include "connections/implementation/webrtc_bwu_handler_stub.h"
 #else
@@ -34,10 +38,14 @@
 #include "connections/implementation/wifi_direct_bwu_handler.h"
 #include "connections/implementation/wifi_hotspot_bwu_handler.h"
 #include "connections/implementation/wifi_lan_bwu_handler.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/cancelable_alarm.h"
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/feature_flags.h"
+#include "internal/platform/implementation/platform.h"
 #include "internal/platform/logging.h"
+#include "internal/platform/tracing.h"
 
 namespace nearby {
 namespace connections {
@@ -47,8 +55,12 @@ using ::location::nearby::connections::OfflineFrame;
 using ::location::nearby::connections::V1Frame;
 using ::location::nearby::proto::connections::DisconnectionReason;
 
-// Required for C++ 14 support in Chrome
-constexpr absl::Duration BwuManager::kReadClientIntroductionFrameTimeout;
+namespace {
+
+// Where the medium history is kept, relative to the app data directory.
+constexpr char kMediumHistoryPreferencesPath[] = "Google/Nearby/Connections";
+
+}  // namespace
 
 BwuManager::BwuManager(
     Mediums& mediums, EndpointManager& endpoint_manager,
@@ -91,6 +103,18 @@ BwuManager::BwuManager(
     InitBwuHandlers();
   }
 
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableMediumPerformanceHistory)) {
+#ifndef NEARBY_CHROMIUM
+    preferences_manager_ =
+        api::ImplementationPlatform::CreatePreferencesManager(
+            kMediumHistoryPreferencesPath);
+#endif
+    medium_history_ =
+        std::make_unique<MediumPerformanceHistory>(preferences_manager_.get());
+  }
+
   // Register the offline frame processor.
   endpoint_manager_->RegisterFrameProcessor(
       V1Frame::BANDWIDTH_UPGRADE_NEGOTIATION, this);
@@ -149,6 +173,9 @@ void BwuManager::Shutdown() {
   }
 
   CancelAllRetryUpgradeAlarms();
+  while (!prepared_upgrades_.empty()) {
+    RevertPreparedBwuForEndpoint(prepared_upgrades_.begin()->first);
+  }
   medium_ = Medium::UNKNOWN_MEDIUM;
   endpoint_id_to_bwu_medium_.clear();
   for (auto& medium_handler_pair : handlers_) {
@@ -171,6 +198,8 @@ void BwuManager::InvokeOnIncomingConnectionForTesting(
 }
 
 void BwuManager::ShutdownExecutors() {
+  // Pending introductions are still timed out by |alarm_executor_|.
+  introduction_executor_.Shutdown();
   alarm_executor_.Shutdown();
   serial_executor_.Shutdown();
 }
@@ -182,12 +211,13 @@ void BwuManager::InitiateBwuForEndpoint(ClientProxy* client,
   Medium proposed_medium =
       new_medium == Medium::UNKNOWN_MEDIUM
           ? ChooseBestUpgradeMedium(
-                endpoint_id,
-                client->GetUpgradeMediums(endpoint_id).GetMediums(true))
+                endpoint_id, GetRankedUpgradeMediums(client, endpoint_id))
           : new_medium;
 
   RunOnBwuManagerThread("bwu-init", [this, client, endpoint_id,
                                      proposed_medium]() {
+    Tracer::RecordInstant("bwu", "BwuManager::InitiateBwuForEndpoint",
+                          "medium", proposed_medium);
     NEARBY_LOGS(INFO) << "InitiateBwuForEndpoint for endpoint " << endpoint_id
                       << " with medium "
                       << location::nearby::proto::connections::Medium_Name(
@@ -203,6 +233,7 @@ void BwuManager::InitiateBwuForEndpoint(ClientProxy* client,
       return;
     }
 
+    RevertPreparedBwuForEndpoint(endpoint_id, proposed_medium);
     SetBwuMediumForEndpoint(endpoint_id, proposed_medium);
     BwuHandler* handler = GetHandlerForMedium(proposed_medium);
     if (!handler) {
@@ -298,9 +329,61 @@ void BwuManager::InitiateBwuForEndpoint(ClientProxy* client,
         << endpoint_id << " to medium "
         << location::nearby::proto::connections::Medium_Name(proposed_medium);
     in_progress_upgrades_.emplace(endpoint_id, client);
+    upgrade_start_times_[endpoint_id] = SystemClock::ElapsedRealtime();
+  });
+}
+
+void BwuManager::PrepareBwuForEndpoint(const std::string& endpoint_id,
+                                       const std::vector<Medium>& mediums) {
+  RunOnBwuManagerThread("bwu-prepare", [this, endpoint_id, mediums]() {
+    if (in_progress_upgrades_.contains(endpoint_id) ||
+        prepared_upgrades_.contains(endpoint_id)) {
+      return;
+    }
+    Medium medium = ChooseBestUpgradeMedium(endpoint_id, mediums);
+    // InitiateBwuForEndpoint() won't upgrade to WIFI_HOTSPOT in that case.
+    if (channel_manager_->isWifiLanConnected() &&
+        medium == Medium::WIFI_HOTSPOT) {
+      return;
+    }
+    BwuHandler* handler = GetHandlerForMedium(medium);
+    if (!handler) return;
+
+    NEARBY_LOGS(INFO) << "BwuManager is preparing medium "
+                      << location::nearby::proto::connections::Medium_Name(
+                             medium)
+                      << " for endpoint " << endpoint_id;
+    handler->PrepareUpgradedMedium();
+    auto alarm = std::make_unique<CancelableAlarm>(
+        "BWU preparation alarm",
+        [this, endpoint_id]() {
+          RunOnBwuManagerThread("bwu-revert-prepared", [this, endpoint_id]() {
+            RevertPreparedBwuForEndpoint(endpoint_id);
+          });
+        },
+        kPreparedUpgradeTimeout, &alarm_executor_);
+    prepared_upgrades_.emplace(endpoint_id,
+                               std::make_pair(medium, std::move(alarm)));
   });
 }
 
+void BwuManager::RevertPreparedBwuForEndpoint(const std::string& endpoint_id,
+                                              Medium keep_medium) {
+  auto item = prepared_upgrades_.extract(endpoint_id);
+  if (item.empty()) return;
+  auto& [medium, alarm] = item.mapped();
+  alarm->Cancel();
+  if (medium == keep_medium) return;
+  BwuHandler* handler = GetHandlerForMedium(medium);
+  if (!handler) return;
+
+  NEARBY_LOGS(INFO) << "BwuManager is reverting medium "
+                    << location::nearby::proto::connections::Medium_Name(
+                           medium)
+                    << " prepared for endpoint " << endpoint_id;
+  handler->RevertPreparedUpgradedMedium();
+}
+
 void BwuManager::OnIncomingFrame(OfflineFrame& frame,
                                  const std::string& endpoint_id,
                                  ClientProxy* client, Medium medium,
@@ -338,6 +421,17 @@ void BwuManager::OnEndpointDisconnect(ClientProxy* client,
   NEARBY_LOGS(INFO)
       << "BwuManager has processed endpoint disconnection for endpoint "
       << endpoint_id;
+  if (medium_history_) {
+    // Taken now, since the client drops the stats once it has disconnected.
+    std::optional<EndpointStats> stats = client->GetEndpointStats(endpoint_id);
+    if (stats.has_value()) {
+      medium_history_->RecordThroughput(
+          MediumPerformanceHistory::GetPeerId(
+              client->GetRemoteEndpointInfo(endpoint_id)),
+          stats->medium, stats->medium_peak_bytes_per_second,
+          stats->medium_bytes);
+    }
+  }
   RunOnBwuManagerThread("bwu-on-endpoint-disconnect", [this, client, service_id,
                                                        endpoint_id,
                                                        barrier]() mutable {
@@ -355,8 +449,10 @@ void BwuManager::OnEndpointDisconnect(ClientProxy* client,
       }
     }
     in_progress_upgrades_.erase(endpoint_id);
+    upgrade_start_times_.erase(endpoint_id);
     retry_delays_.erase(endpoint_id);
     CancelRetryUpgradeAlarm(endpoint_id);
+    RevertPreparedBwuForEndpoint(endpoint_id);
     successfully_upgraded_endpoints_.erase(endpoint_id);
 
     // Note(nohle): I'm skeptical of the "<= 1", which seems like it should be
@@ -489,7 +585,10 @@ void BwuManager::OnIncomingConnection(
   NEARBY_LOGS(INFO) << "BwuManager process incoming connection";
   std::shared_ptr<BwuHandler::IncomingSocketConnection> connection(
       mutable_connection.release());
-  RunOnBwuManagerThread(
+  // Reading the introduction blocks until the remote endpoint sends it, so it
+  // is done off the BwuManager thread, letting many endpoints upgrading at
+  // once to the same server socket introduce themselves concurrently.
+  RunOnIntroductionThread(
       "bwu-on-incoming-connection", [this, client, connection]() {
         absl::Time connection_attempt_start_time =
             SystemClock::ElapsedRealtime();
@@ -499,9 +598,14 @@ void BwuManager::OnIncomingConnection(
               << "BwuManager failed to create new EndpointChannel for incoming "
                  "socket.";
           connection->socket->Close();
-          AttemptToRecordBandwidthUpgradeErrorForUnknownEndpoint(
-              location::nearby::proto::connections::MEDIUM_ERROR,
-              location::nearby::proto::connections::SOCKET_CREATION);
+          // Recording the error reads |in_progress_upgrades_|, which only
+          // the BwuManager thread may touch.
+          RunOnBwuManagerThread(
+              "bwu-record-incoming-connection-error", [this]() {
+                AttemptToRecordBandwidthUpgradeErrorForUnknownEndpoint(
+                    location::nearby::proto::connections::MEDIUM_ERROR,
+                    location::nearby::proto::connections::SOCKET_CREATION);
+              });
           return;
         }
 
@@ -535,46 +639,59 @@ void BwuManager::OnIncomingConnection(
                                 "OfflineFrame on EndpointChannel "
                              << channel->GetName();
 
-        const std::string& endpoint_id = introduction.endpoint_id();
-        ClientProxy* mapped_client;
-        const auto item = in_progress_upgrades_.find(endpoint_id);
-        if (item == in_progress_upgrades_.end()) return;
-        mapped_client = item->second;
-        CancelRetryUpgradeAlarm(endpoint_id);
-        if (mapped_client == nullptr) {
-          // This was never a fully EstablishedConnection, no need to provide a
-          // closure reason.
-          channel->Close();
-          return;
-        }
-
-        CHECK(client == mapped_client);
-
-        // The ConnectionAttempt has now succeeded, so record it as such.
-        std::unique_ptr<ConnectionAttemptMetadataParams>
-            connections_attempt_metadata_params;
-        if (channel != nullptr) {
-          connections_attempt_metadata_params =
-              client->GetAnalyticsRecorder()
-                  .BuildConnectionAttemptMetadataParams(
-                      channel->GetTechnology(), channel->GetBand(),
-                      channel->GetFrequency(), channel->GetTryCount());
-        }
-        client->GetAnalyticsRecorder().OnIncomingConnectionAttempt(
-            location::nearby::proto::connections::UPGRADE, channel->GetMedium(),
-            location::nearby::proto::connections::RESULT_SUCCESS,
-            SystemClock::ElapsedRealtime() - connection_attempt_start_time,
-            client->GetConnectionToken(endpoint_id),
-            connections_attempt_metadata_params.get());
-
-        // Use the introductory client information sent over to run the upgrade
-        // protocol.
-        RunUpgradeProtocol(mapped_client, endpoint_id,
-                           std::move(connection->channel),
-                           !introduction.supports_disabling_encryption());
+        RunOnBwuManagerThread(
+            "bwu-on-client-introduction",
+            [this, client, connection, introduction,
+             connection_attempt_start_time]() {
+              OnClientIntroduction(client, connection, introduction,
+                                   connection_attempt_start_time);
+            });
       });
 }
 
+void BwuManager::OnClientIntroduction(
+    ClientProxy* client,
+    std::shared_ptr<BwuHandler::IncomingSocketConnection> connection,
+    const ClientIntroduction& introduction,
+    absl::Time connection_attempt_start_time) {
+  EndpointChannel* channel = connection->channel.get();
+  const std::string& endpoint_id = introduction.endpoint_id();
+  ClientProxy* mapped_client;
+  const auto item = in_progress_upgrades_.find(endpoint_id);
+  if (item == in_progress_upgrades_.end()) return;
+  mapped_client = item->second;
+  CancelRetryUpgradeAlarm(endpoint_id);
+  if (mapped_client == nullptr) {
+    // This was never a fully EstablishedConnection, no need to provide a
+    // closure reason.
+    channel->Close();
+    return;
+  }
+
+  CHECK(client == mapped_client);
+
+  // The ConnectionAttempt has now succeeded, so record it as such.
+  std::unique_ptr<ConnectionAttemptMetadataParams>
+      connections_attempt_metadata_params;
+  if (channel != nullptr) {
+    connections_attempt_metadata_params =
+        client->GetAnalyticsRecorder().BuildConnectionAttemptMetadataParams(
+            channel->GetTechnology(), channel->GetBand(),
+            channel->GetFrequency(), channel->GetTryCount());
+  }
+  client->GetAnalyticsRecorder().OnIncomingConnectionAttempt(
+      location::nearby::proto::connections::UPGRADE, channel->GetMedium(),
+      location::nearby::proto::connections::RESULT_SUCCESS,
+      SystemClock::ElapsedRealtime() - connection_attempt_start_time,
+      client->GetConnectionToken(endpoint_id),
+      connections_attempt_metadata_params.get());
+
+  // Use the introductory client information sent over to run the upgrade
+  // protocol.
+  RunUpgradeProtocol(mapped_client, endpoint_id, std::move(connection->channel),
+                     !introduction.supports_disabling_encryption());
+}
+
 void BwuManager::RunOnBwuManagerThread(const std::string& name,
                                        Runnable runnable) {
   if (is_single_threaded_for_testing_) {
@@ -585,9 +702,21 @@ void BwuManager::RunOnBwuManagerThread(const std::string& name,
   serial_executor_.Execute(name, std::move(runnable));
 }
 
+void BwuManager::RunOnIntroductionThread(const std::string& name,
+                                         Runnable runnable) {
+  if (is_single_threaded_for_testing_) {
+    runnable();
+    return;
+  }
+
+  introduction_executor_.Execute(name, std::move(runnable));
+}
+
 void BwuManager::RunUpgradeProtocol(
     ClientProxy* client, const std::string& endpoint_id,
     std::unique_ptr<EndpointChannel> new_channel, bool enable_encryption) {
+  TraceScope trace("bwu", "BwuManager::RunUpgradeProtocol");
+  trace.SetArg("medium", new_channel->GetMedium());
   NEARBY_LOGS(INFO) << "RunUpgradeProtocol new channel @" << new_channel.get()
                     << " name: " << new_channel->GetName() << ", medium: "
                     << location::nearby::proto::connections::Medium_Name(
@@ -655,6 +784,8 @@ void BwuManager::ProcessBwuPathAvailableEvent(
     const UpgradePathInfo& upgrade_path_info) {
   Medium upgrade_medium =
       parser::UpgradePathInfoMediumToMedium(upgrade_path_info.medium());
+  TraceScope trace("bwu", "BwuManager::ProcessBwuPathAvailableEvent");
+  trace.SetArg("medium", upgrade_medium);
   NEARBY_LOGS(INFO) << "ProcessBwuPathAvailableEvent for endpoint "
                     << endpoint_id << " medium "
                     << location::nearby::proto::connections::Medium_Name(
@@ -923,18 +1054,19 @@ bool BwuManager::ReadClientIntroductionFrame(EndpointChannel* channel,
                     << channel->GetName() << ", medium: "
                     << location::nearby::proto::connections::Medium_Name(
                            channel->GetMedium());
+  absl::Duration timeout =
+      TransportConfig::Get().bwu_client_introduction_timeout;
   CancelableAlarm timeout_alarm(
       "BwuManager::ReadClientIntroductionFrame",
-      [channel]() {
+      [channel, timeout]() {
         NEARBY_LOGS(ERROR) << "In BwuManager, failed to read the "
                               "ClientIntroductionFrame after "
-                           << absl::FormatDuration(
-                                  kReadClientIntroductionFrameTimeout)
+                           << absl::FormatDuration(timeout)
                            << ". Timing out and closing EndpointChannel "
                            << channel->GetType();
         channel->Close();
       },
-      kReadClientIntroductionFrameTimeout, &alarm_executor_);
+      timeout, &alarm_executor_);
   auto data = channel->Read();
   timeout_alarm.Cancel();
   if (!data.ok()) return false;
@@ -975,18 +1107,20 @@ bool BwuManager::ReadClientIntroductionAckFrame(EndpointChannel* channel) {
                     << channel->GetName() << ", medium: "
                     << location::nearby::proto::connections::Medium_Name(
                            channel->GetMedium());
+  absl::Duration timeout =
+      TransportConfig::Get().bwu_client_introduction_timeout;
   CancelableAlarm timeout_alarm(
       "BwuManager::ReadClientIntroductionAckFrame",
-      [channel]() {
+      [channel, timeout]() {
         NEARBY_LOGS(ERROR)
             << "In BwuManager, failed to read the ClientIntroductionAckFrame "
                "after "
-            << absl::FormatDuration(kReadClientIntroductionFrameTimeout)
+            << absl::FormatDuration(timeout)
             << ". Timing out and closing EndpointChannel "
             << channel->GetType();
         channel->Close();
       },
-      kReadClientIntroductionFrameTimeout, &alarm_executor_);
+      timeout, &alarm_executor_);
   auto data = channel->Read();
   timeout_alarm.Cancel();
   if (!data.ok()) return false;
@@ -1011,6 +1145,7 @@ bool BwuManager::WriteClientIntroductionAckFrame(EndpointChannel* channel) {
 
 void BwuManager::ProcessLastWriteToPriorChannelEvent(
     ClientProxy* client, const std::string& endpoint_id) {
+  Tracer::RecordInstant("bwu", "BwuManager::LastWriteToPriorChannel");
   // By this point in the upgrade protocol, there is the guarantee that both
   // involved endpoints have registered a new EndpointChannel with the
   // EndpointChannelManager as the official channel for communication; given
@@ -1058,6 +1193,19 @@ void BwuManager::ProcessLastWriteToPriorChannelEvent(
                           "OfflineFrame while trying to upgrade endpoint "
                        << endpoint_id;
 
+  // SAFE_TO_CLOSE_PRIOR_CHANNEL was our last encrypted write over the prior
+  // EndpointChannel (the disconnection frame that follows is sent
+  // unencrypted), so frames encrypted from here on can only follow it in the
+  // UKEY2 sequence. The remote device reads them off the upgraded channel once
+  // it has read that frame, so writers don't have to wait for the round trip.
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableBwuResumeAfterLastPriorChannelWrite)) {
+    std::shared_ptr<EndpointChannel> channel =
+        channel_manager_->GetChannelForEndpoint(endpoint_id);
+    if (channel) channel->Resume();
+  }
+
   // The upgrade protocol's clean shutdown of the prior EndpointChannel will
   // conclude when we receive a corresponding
   // BANDWIDTH_UPGRADE_NEGOTIATION.SAFE_TO_CLOSE_PRIOR_CHANNEL OfflineFrame
@@ -1066,6 +1214,7 @@ void BwuManager::ProcessLastWriteToPriorChannelEvent(
 
 void BwuManager::ProcessSafeToClosePriorChannelEvent(
     ClientProxy* client, const std::string& endpoint_id) {
+  Tracer::RecordInstant("bwu", "BwuManager::SafeToClosePriorChannel");
   NEARBY_LOGS(INFO) << "ProcessSafeToClosePriorChannelEvent for endpoint "
                     << endpoint_id;
   // By this point in the upgrade protocol, there's no more writes happening
@@ -1095,6 +1244,18 @@ void BwuManager::ProcessSafeToClosePriorChannelEvent(
       << "BWU_NEGOTIATION.SAFE_TO_CLOSE_PRIOR_CHANNEL OfflineFrame while "
       << "trying to upgrade endpoint " << endpoint_id;
 
+  // Neither side sends any more encrypted frames over the prior channel, so
+  // the upgraded channel can take over now rather than after the prior channel
+  // has been drained below, which can block for as long as the remote takes to
+  // close it.
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableEarlyBwuChannelResume)) {
+    std::shared_ptr<EndpointChannel> channel =
+        channel_manager_->GetChannelForEndpoint(endpoint_id);
+    if (channel) channel->Resume();
+  }
+
   // Each encrypted message includes the key to decrypt the next message. The
   // disconnect message is optional and may not be received under normal
   // circumstances so it is necessary to send it unencrypted. This way the
@@ -1140,11 +1301,21 @@ void BwuManager::ProcessSafeToClosePriorChannelEvent(
   // Report the success to the client
   client->OnBandwidthChanged(endpoint_id, channel->GetMedium());
   in_progress_upgrades_.erase(endpoint_id);
+
+  auto start_time = upgrade_start_times_.extract(endpoint_id);
+  if (medium_history_ && !start_time.empty()) {
+    medium_history_->RecordAttempt(
+        MediumPerformanceHistory::GetPeerId(
+            client->GetRemoteEndpointInfo(endpoint_id)),
+        channel->GetMedium(), /*success=*/true,
+        SystemClock::ElapsedRealtime() - start_time.mapped());
+  }
 }
 
 void BwuManager::ProcessUpgradeFailureEvent(
     ClientProxy* client, const std::string& endpoint_id,
     const UpgradePathInfo& upgrade_info) {
+  Tracer::RecordInstant("bwu", "BwuManager::UpgradeFailure");
   NEARBY_LOGS(INFO) << "ProcessUpgradeFailureEvent for endpoint " << endpoint_id
                     << " from medium: "
                     << location::nearby::proto::connections::Medium_Name(
@@ -1153,6 +1324,14 @@ void BwuManager::ProcessUpgradeFailureEvent(
   // The remote device failed to upgrade to the new medium we set up for them.
   // That's alright! We'll just try the next available medium (if there is one).
   in_progress_upgrades_.erase(endpoint_id);
+  upgrade_start_times_.erase(endpoint_id);
+  Medium last = parser::UpgradePathInfoMediumToMedium(upgrade_info.medium());
+  if (medium_history_) {
+    medium_history_->RecordAttempt(MediumPerformanceHistory::GetPeerId(
+                                       client->GetRemoteEndpointInfo(
+                                           endpoint_id)),
+                                   last, /*success=*/false);
+  }
 
   // The first thing we have to do is to replace our currentBwuMedium with the
   // next best upgrade medium we share with the remote device. The catch is that
@@ -1190,9 +1369,8 @@ void BwuManager::ProcessUpgradeFailureEvent(
   // Loop through the ordered list of upgrade mediums. One by one, remove the
   // top element until we get to the medium we last attempted to upgrade to. The
   // remainder of the list will contain the mediums we haven't attempted yet.
-  Medium last = parser::UpgradePathInfoMediumToMedium(upgrade_info.medium());
   std::vector<Medium> all_possible_mediums =
-      client->GetUpgradeMediums(endpoint_id).GetMediums(true);
+      GetRankedUpgradeMediums(client, endpoint_id);
   std::vector<Medium> untried_mediums(all_possible_mediums);
   for (Medium medium : all_possible_mediums) {
     untried_mediums.erase(untried_mediums.begin());
@@ -1291,6 +1469,17 @@ std::vector<Medium> BwuManager::StripOutUnavailableMediums(
 // way to prevent mediums, like Wifi Hotspot, from interfering with active
 // connections (although it's suboptimal for bandwidth throughput). When all
 // endpoints disconnect, we reset the bandwidth upgrade medium.
+std::vector<Medium> BwuManager::GetRankedUpgradeMediums(
+    ClientProxy* client, const std::string& endpoint_id) const {
+  std::vector<Medium> mediums =
+      client->GetUpgradeMediums(endpoint_id).GetMediums(true);
+  if (!medium_history_) return mediums;
+  return medium_history_->Rank(
+      MediumPerformanceHistory::GetPeerId(
+          client->GetRemoteEndpointInfo(endpoint_id)),
+      std::move(mediums));
+}
+
 Medium BwuManager::ChooseBestUpgradeMedium(
     const std::string& endpoint_id, const std::vector<Medium>& mediums) const {
   auto available_mediums = StripOutUnavailableMediums(mediums);
@@ -1351,7 +1540,7 @@ void BwuManager::RetryUpgradesAfterDelay(ClientProxy* client,
               }
               TryNextBestUpgradeMediums(
                   client, endpoint_id,
-                  client->GetUpgradeMediums(endpoint_id).GetMediums(true));
+                  GetRankedUpgradeMediums(client, endpoint_id));
             });
       },
       delay, &alarm_executor_);
@@ -27,7 +27,10 @@
 #include "connections/implementation/bwu_handler.h"
 #include "connections/implementation/client_proxy.h"
 #include "connections/implementation/endpoint_manager.h"
+#include "connections/implementation/medium_performance_history.h"
 #include "connections/implementation/mediums/mediums.h"
+#include "internal/platform/implementation/preferences_manager.h"
+#include "internal/platform/multi_thread_executor.h"
 #include "internal/platform/scheduled_executor.h"
 
 namespace nearby {
@@ -80,6 +83,13 @@ class BwuManager : public EndpointManager::FrameProcessor {
                               const std::string& endpoint_id,
                               Medium new_medium = Medium::UNKNOWN_MEDIUM);
 
+  // Prepares the medium that the best of |mediums| would be upgraded to, for
+  // an endpoint that is still connecting, so that InitiateBwuForEndpoint() is
+  // faster once it is connected. Reverted after kPreparedUpgradeTimeout if no
+  // upgrade to that medium has started by then.
+  void PrepareBwuForEndpoint(const std::string& endpoint_id,
+                             const std::vector<Medium>& mediums);
+
   // == EndpointManager::FrameProcessor interface ==.
   // This is also an entry point for handling messages for both outbound and
   // inbound BWU protocol.
@@ -117,16 +127,30 @@ class BwuManager : public EndpointManager::FrameProcessor {
   // Check if BWU is on going for a specific Endpoint
   bool IsUpgradeOngoing(const std::string& endpoint_id);
 
+  // Returns how well each medium did with each remote device, or nullptr if
+  // kEnableMediumPerformanceHistory is off.
+  MediumPerformanceHistory* GetMediumPerformanceHistory() {
+    return medium_history_.get();
+  }
+
  private:
-  static constexpr absl::Duration kReadClientIntroductionFrameTimeout =
-      absl::Seconds(5);
+  // Leaves enough time for both sides to accept the connection.
+  static constexpr absl::Duration kPreparedUpgradeTimeout = absl::Minutes(1);
+  // The number of incoming upgraded connections whose introduction is read at
+  // the same time.
+  static constexpr int kMaxConcurrentIntroductions = 8;
 
   void InitBwuHandlers();
   void RunOnBwuManagerThread(const std::string& name, Runnable runnable);
+  void RunOnIntroductionThread(const std::string& name, Runnable runnable);
   std::vector<Medium> StripOutUnavailableMediums(
       const std::vector<Medium>& mediums) const;
   Medium ChooseBestUpgradeMedium(const std::string& endpoint_id,
                                  const std::vector<Medium>& mediums) const;
+  // The upgrade mediums of |endpoint_id|, ordered by the medium history of the
+  // remote device if there's one.
+  std::vector<Medium> GetRankedUpgradeMediums(
+      ClientProxy* client, const std::string& endpoint_id) const;
 
   // BaseBwuHandler
   using ClientIntroduction = BwuNegotiationFrame::ClientIntroduction;
@@ -150,12 +174,25 @@ class BwuManager : public EndpointManager::FrameProcessor {
 
   BwuHandler* GetHandlerForMedium(Medium medium) const;
 
+  // Reverts the medium prepared for |endpoint_id|, if any, unless it is
+  // |keep_medium|.
+  void RevertPreparedBwuForEndpoint(
+      const std::string& endpoint_id,
+      Medium keep_medium = Medium::UNKNOWN_MEDIUM);
+
   // Common functionality to take an incoming connection and go through the
   // upgrade process. This is a callback, invoked by concrete handlers, once
   // connection is available.
   void OnIncomingConnection(
       ClientProxy* client,
       std::unique_ptr<BwuHandler::IncomingSocketConnection> mutable_connection);
+  // Continues OnIncomingConnection() on the BwuManager thread once the remote
+  // endpoint introduced itself over |connection|.
+  void OnClientIntroduction(
+      ClientProxy* client,
+      std::shared_ptr<BwuHandler::IncomingSocketConnection> connection,
+      const ClientIntroduction& introduction,
+      absl::Time connection_attempt_start_time);
 
   void RunUpgradeProtocol(ClientProxy* client, const std::string& endpoint_id,
                           std::unique_ptr<EndpointChannel> new_channel,
@@ -215,6 +252,9 @@ class BwuManager : public EndpointManager::FrameProcessor {
   EndpointChannelManager* channel_manager_;
   ScheduledExecutor alarm_executor_;
   SingleThreadExecutor serial_executor_;
+  // Reads the introductions of incoming upgraded connections, see
+  // OnIncomingConnection().
+  MultiThreadExecutor introduction_executor_{kMaxConcurrentIntroductions};
   // Stores each upgraded endpoint's previous EndpointChannel (that was
   // displaced in favor of a new EndpointChannel) temporarily, until it can
   // safely be shut down for good in processLastWriteToPriorChannelEvent().
@@ -235,6 +275,16 @@ class BwuManager : public EndpointManager::FrameProcessor {
   // retry happen, then we can not find the last delay used in the alarm. Thus
   // using a different map to keep track of the delays per endpoint.
   absl::flat_hash_map<std::string, absl::Duration> retry_delays_;
+  // Maps endpointId -> the medium prepared by PrepareBwuForEndpoint(), and the
+  // alarm reverting it.
+  absl::flat_hash_map<std::string,
+                      std::pair<Medium, std::unique_ptr<CancelableAlarm>>>
+      prepared_upgrades_;
+  // Maps endpointId -> when the upgrade of an endpoint in
+  // in_progress_upgrades_ started.
+  absl::flat_hash_map<std::string, absl::Time> upgrade_start_times_;
+  std::unique_ptr<api::PreferencesManager> preferences_manager_;
+  std::unique_ptr<MediumPerformanceHistory> medium_history_;
 };
 
 }  // namespace connections
@@ -17,18 +17,24 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "connections/implementation/client_proxy.h"
 #include "connections/implementation/endpoint_channel.h"
 #include "connections/implementation/endpoint_channel_manager.h"
 #include "connections/implementation/endpoint_manager.h"
 #include "connections/implementation/fake_bwu_handler.h"
 #include "connections/implementation/fake_endpoint_channel.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/implementation/mediums/mediums.h"
 #include "connections/implementation/offline_frames.h"
 #include "connections/implementation/service_id_constants.h"
+#include "internal/flags/nearby_flags.h"
+#include "internal/platform/count_down_latch.h"
 #include "internal/platform/exception.h"
 
 namespace nearby {
@@ -50,7 +56,7 @@ constexpr absl::string_view kEndpointId5 = "Endpoint5";
 
 class BwuManagerTest : public ::testing::Test {
  protected:
-  BwuManagerTest() {
+  explicit BwuManagerTest(bool single_threaded = true) {
     // Set up fake BWU handlers for WebRTC and WifiLAN.
     absl::flat_hash_map<Medium, std::unique_ptr<BwuHandler>> handlers;
     auto fake_web_rtc = std::make_unique<FakeBwuHandler>(Medium::WEB_RTC);
@@ -78,7 +84,7 @@ class BwuManagerTest : public ::testing::Test {
                                                 std::move(handlers), config);
 
     // Don't run tasks on other threads. Avoids race conditions in tests.
-    bwu_manager_->MakeSingleThreadedForTesting();
+    if (single_threaded) bwu_manager_->MakeSingleThreadedForTesting();
   }
 
   ~BwuManagerTest() override { bwu_manager_->Shutdown(); }
@@ -274,6 +280,74 @@ TEST_P(BwuManagerTestParam, InitiateBwu_Success) {
             old_channel->disconnection_reason());
 }
 
+TEST_F(BwuManagerTest,
+       InitiateBwu_EarlyResume_ResumesBeforePriorChannelIsRead) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableEarlyBwuChannelResume,
+      true);
+  FakeEndpointChannel* initial_channel =
+      CreateInitialEndpoint(kServiceIdA, kEndpointId1, Medium::BLUETOOTH);
+  std::shared_ptr<EndpointChannel> shared_initial_channel =
+      ecm_.GetChannelForEndpoint(std::string(kEndpointId1));
+  bwu_manager_->InitiateBwuForEndpoint(&client_, std::string(kEndpointId1),
+                                       Medium::WEB_RTC);
+  FakeEndpointChannel* upgraded_channel =
+      fake_web_rtc_bwu_handler_->NotifyBwuManagerOfIncomingConnection(
+          /*initialize_call_index=*/0u, bwu_manager_.get());
+  EXPECT_TRUE(upgraded_channel->IsPaused());
+
+  // Record whether the upgraded channel was already resumed while the prior
+  // channel was being drained.
+  bool paused_during_prior_read = true;
+  initial_channel->set_read_callback([&]() {
+    paused_during_prior_read = upgraded_channel->IsPaused();
+  });
+
+  ExceptionOr<OfflineFrame> last_write_frame =
+      parser::FromBytes(parser::ForBwuLastWrite());
+  bwu_manager_->OnIncomingFrame(last_write_frame.result(),
+                                std::string(kEndpointId1), &client_,
+                                Medium::BLUETOOTH, packet_meta_data_);
+  ExceptionOr<OfflineFrame> safe_to_close_frame =
+      parser::FromBytes(parser::ForBwuSafeToClose());
+  bwu_manager_->OnIncomingFrame(safe_to_close_frame.result(),
+                                std::string(kEndpointId1), &client_,
+                                Medium::BLUETOOTH, packet_meta_data_);
+
+  EXPECT_FALSE(paused_during_prior_read);
+  EXPECT_FALSE(upgraded_channel->IsPaused());
+  EXPECT_TRUE(initial_channel->is_closed());
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST_F(BwuManagerTest, InitiateBwu_ResumesAfterLastPriorChannelWrite) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableBwuResumeAfterLastPriorChannelWrite,
+      true);
+  FakeEndpointChannel* initial_channel =
+      CreateInitialEndpoint(kServiceIdA, kEndpointId1, Medium::BLUETOOTH);
+  bwu_manager_->InitiateBwuForEndpoint(&client_, std::string(kEndpointId1),
+                                       Medium::WEB_RTC);
+  FakeEndpointChannel* upgraded_channel =
+      fake_web_rtc_bwu_handler_->NotifyBwuManagerOfIncomingConnection(
+          /*initialize_call_index=*/0u, bwu_manager_.get());
+  EXPECT_TRUE(upgraded_channel->IsPaused());
+
+  // Receiving LAST_WRITE_TO_PRIOR_CHANNEL makes us write our
+  // SAFE_TO_CLOSE_PRIOR_CHANNEL, after which the upgraded channel is usable
+  // even though the prior channel is still open.
+  ExceptionOr<OfflineFrame> last_write_frame =
+      parser::FromBytes(parser::ForBwuLastWrite());
+  bwu_manager_->OnIncomingFrame(last_write_frame.result(),
+                                std::string(kEndpointId1), &client_,
+                                Medium::BLUETOOTH, packet_meta_data_);
+  EXPECT_FALSE(upgraded_channel->IsPaused());
+  EXPECT_FALSE(initial_channel->is_closed());
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 TEST_P(BwuManagerTestParam,
        InitiateBwu_Error_DontUpgradeIfAlreadyConenctedOverTheRequestedMedium) {
   CreateInitialEndpoint(kServiceIdA, kEndpointId1, Medium::BLUETOOTH);
@@ -842,6 +916,105 @@ TEST_F(BwuManagerTest, InitiateBwu_Revert_OnDisconnect_Wlan) {
   ASSERT_EQ(fake_wifi_lan_bwu_handler_->handle_revert_calls().size(), 0u);
 }
 
+TEST_F(BwuManagerTest, PrepareBwu_KeptForUpgradeToPreparedMedium) {
+  CreateInitialEndpoint(kServiceIdA, kEndpointId1, Medium::BLUETOOTH);
+
+  bwu_manager_->PrepareBwuForEndpoint(std::string(kEndpointId1),
+                                      {Medium::WIFI_LAN});
+  EXPECT_EQ(fake_wifi_lan_bwu_handler_->prepare_calls(), 1);
+
+  bwu_manager_->InitiateBwuForEndpoint(&client_, std::string(kEndpointId1),
+                                       Medium::WIFI_LAN);
+  EXPECT_EQ(fake_wifi_lan_bwu_handler_->handle_initialize_calls().size(), 1u);
+  EXPECT_EQ(fake_wifi_lan_bwu_handler_->revert_prepared_calls(), 0);
+}
+
+TEST_F(BwuManagerTest, PrepareBwu_RevertedForUpgradeToOtherMedium) {
+  CreateInitialEndpoint(kServiceIdA, kEndpointId1, Medium::BLUETOOTH);
+
+  bwu_manager_->PrepareBwuForEndpoint(std::string(kEndpointId1),
+                                      {Medium::WIFI_LAN});
+  bwu_manager_->InitiateBwuForEndpoint(&client_, std::string(kEndpointId1),
+                                       Medium::WEB_RTC);
+
+  EXPECT_EQ(fake_wifi_lan_bwu_handler_->revert_prepared_calls(), 1);
+}
+
+TEST_F(BwuManagerTest, PrepareBwu_RevertedOnDisconnect) {
+  CreateInitialEndpoint(kServiceIdA, kEndpointId1, Medium::BLUETOOTH);
+
+  bwu_manager_->PrepareBwuForEndpoint(std::string(kEndpointId1),
+                                      {Medium::WIFI_LAN});
+  CountDownLatch latch(1);
+  bwu_manager_->OnEndpointDisconnect(&client_, std::string(kServiceIdA),
+                                     std::string(kEndpointId1), latch);
+
+  EXPECT_EQ(fake_wifi_lan_bwu_handler_->revert_prepared_calls(), 1);
+}
+
+class BwuManagerMultiThreadedTest : public BwuManagerTest {
+ protected:
+  class FakeIncomingSocket : public BwuHandler::IncomingSocket {
+   public:
+    std::string ToString() override { return "fake-incoming-socket"; }
+    void Close() override {}
+  };
+
+  BwuManagerMultiThreadedTest() : BwuManagerTest(/*single_threaded=*/false) {}
+};
+
+TEST_F(BwuManagerMultiThreadedTest, ReadsIntroductionsConcurrently) {
+  constexpr absl::string_view kEndpointIds[] = {kEndpointId1, kEndpointId2,
+                                                kEndpointId3};
+  constexpr int kEndpoints = 3;
+  for (absl::string_view endpoint_id : kEndpointIds) {
+    CreateInitialEndpoint(kServiceIdA, endpoint_id, Medium::BLUETOOTH);
+    bwu_manager_->InitiateBwuForEndpoint(&client_, std::string(endpoint_id),
+                                         Medium::WIFI_LAN);
+  }
+
+  // Each introduction is only read once all of them are being read, which
+  // never happens if they are read one after the other.
+  CountDownLatch reading(kEndpoints);
+  std::vector<FakeEndpointChannel*> upgraded_channels;
+  for (absl::string_view endpoint_id : kEndpointIds) {
+    auto channel = std::make_unique<FakeEndpointChannel>(
+        Medium::WIFI_LAN, WrapInitiatorUpgradeServiceId(kServiceIdA));
+    channel->set_read_output(ExceptionOr<ByteArray>(parser::ForBwuIntroduction(
+        std::string(endpoint_id),
+        /*supports_disabling_encryption=*/false)));
+    channel->set_read_callback([&reading]() {
+      reading.CountDown();
+      EXPECT_TRUE(reading.Await(absl::Seconds(10)).result());
+    });
+    upgraded_channels.push_back(channel.get());
+    auto connection = std::make_unique<BwuHandler::IncomingSocketConnection>();
+    connection->socket = std::make_unique<FakeIncomingSocket>();
+    connection->channel = std::move(channel);
+    bwu_manager_->InvokeOnIncomingConnectionForTesting(&client_,
+                                                       std::move(connection));
+  }
+  // An incoming connection without a channel only records an error, which
+  // must not race with the upgrades above.
+  auto failed_connection =
+      std::make_unique<BwuHandler::IncomingSocketConnection>();
+  failed_connection->socket = std::make_unique<FakeIncomingSocket>();
+  bwu_manager_->InvokeOnIncomingConnectionForTesting(
+      &client_, std::move(failed_connection));
+
+  for (int i = 0; i < kEndpoints; ++i) {
+    std::string endpoint_id(kEndpointIds[i]);
+    absl::Time deadline = absl::Now() + absl::Seconds(10);
+    while (ecm_.GetChannelForEndpoint(endpoint_id).get() !=
+               upgraded_channels[i] &&
+           absl::Now() < deadline) {
+      absl::SleepFor(absl::Milliseconds(10));
+    }
+    EXPECT_EQ(ecm_.GetChannelForEndpoint(endpoint_id).get(),
+              upgraded_channels[i]);
+  }
+}
+
 TEST_F(BwuManagerTest, OnReceiveBwuEvent) {
   // TODO(b/235109434): Add more unit tests coverage for BWU module
 }
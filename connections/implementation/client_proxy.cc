@@ -14,6 +14,7 @@
 
 #include "connections/implementation/client_proxy.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <functional>
 #include <ios>
@@ -27,11 +28,16 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/escaping.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/time.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "connections/implementation/memory_accountant.h"
 #include "connections/v3/bandwidth_info.h"
 #include "connections/v3/connection_listening_options.h"
 #include "connections/v3/connections_device_provider.h"
 #include "internal/analytics/event_logger.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/error_code_recorder.h"
 #include "internal/platform/feature_flags.h"
 #include "internal/platform/implementation/platform.h"
@@ -64,11 +70,22 @@ ClientProxy::ClientProxy(::nearby::analytics::EventLogger* event_logger)
       [this](const ErrorCodeParams& params) {
         analytics_recorder_->OnErrorCode(params);
       });
+  memory_accountant_ = MemoryAccountant::Create(
+      NearbyFlags::GetInstance().GetInt64Flag(
+          config_package_nearby::nearby_connections_feature::
+              kMaxBufferedBytesPerEndpoint),
+      NearbyFlags::GetInstance().GetInt64Flag(
+          config_package_nearby::nearby_connections_feature::
+              kMaxBufferedBytesPerClient));
   local_os_info_.set_type(
       OSNameToOsInfoType(api::ImplementationPlatform::GetCurrentOS()));
 }
 
-ClientProxy::~ClientProxy() { Reset(); }
+ClientProxy::~ClientProxy() {
+  Reset();
+  // Pending endpoint found reports must not outlive the state they report.
+  single_thread_executor_.Shutdown();
+}
 
 std::int64_t ClientProxy::GetClientId() const { return client_id_; }
 
@@ -90,14 +107,24 @@ const NearbyDevice* ClientProxy::GetLocalDevice() {
   if (external_device_provider_ == nullptr &&
       connections_device_provider_ == nullptr) {
     // TODO(b/285602283): Plug in actual endpoint info once available.
-    auto provider =
-        v3::ConnectionsDeviceProvider(GetLocalEndpointId(), "V3 endpoint", {});
     RegisterConnectionsDeviceProvider(
-        std::make_unique<v3::ConnectionsDeviceProvider>(provider));
+        std::make_unique<v3::ConnectionsDeviceProvider>(
+            GetLocalEndpointId(), "V3 endpoint",
+            std::vector<ConnectionInfoVariant>{}));
   }
   return GetLocalDeviceProvider()->GetLocalDevice();
 }
 
+std::shared_ptr<const v3::ConnectionsDevice> ClientProxy::GetRemoteDevice(
+    absl::string_view endpoint_id) {
+  if (connections_device_provider_ == nullptr) {
+    return std::make_shared<const v3::ConnectionsDevice>(
+        endpoint_id, "", std::vector<ConnectionInfoVariant>{});
+  }
+  return connections_device_provider_->GetRemoteDevice(
+      connections_device_provider_->InternRemoteDevice(endpoint_id));
+}
+
 std::string ClientProxy::GetConnectionToken(const std::string& endpoint_id) {
   ConnectionPair* item = LookupConnection(endpoint_id);
   if (item != nullptr) {
@@ -125,10 +152,12 @@ std::string ClientProxy::GenerateLocalEndpointId() {
 }
 
 void ClientProxy::Reset() {
+  // Discovery is stopped first since discovery_mutex_ can't be acquired while
+  // holding mutex_.
+  StoppedDiscovery();
   MutexLock lock(&mutex_);
 
   StoppedAdvertising();
-  StoppedDiscovery();
   RemoveAllEndpoints();
   ExitHighVisibilityMode();
 }
@@ -186,6 +215,12 @@ std::string ClientProxy::GetAdvertisingServiceId() const {
   return advertising_info_.service_id;
 }
 
+void ClientProxy::UpdatedAdvertisingOptions(
+    const AdvertisingOptions& advertising_options) {
+  MutexLock lock(&mutex_);
+  advertising_options_ = advertising_options;
+}
+
 void ClientProxy::StartedListeningForIncomingConnections(
     absl::string_view service_id, Strategy strategy,
     v3::ConnectionListener listener,
@@ -237,29 +272,28 @@ ConnectionListener ClientProxy::GetAdvertisingOrIncomingConnectionListener() {
             },
         .accepted_cb =
             [this](const std::string& endpoint_id) {
-              auto remote_device = v3::ConnectionsDevice(endpoint_id, "", {});
               this->listening_info_.listener.result_cb(
-                  remote_device,
+                  *GetRemoteDevice(endpoint_id),
                   v3::ConnectionResult{.status = Status{
                                            .value = Status::kSuccess,
                                        }});
             },
         .rejected_cb =
             [this](const std::string& endpoint_id, Status status) {
-              auto remote_device = v3::ConnectionsDevice(endpoint_id, "", {});
               this->listening_info_.listener.result_cb(
-                  remote_device, v3::ConnectionResult{.status = status});
+                  *GetRemoteDevice(endpoint_id),
+                  v3::ConnectionResult{.status = status});
             },
         .disconnected_cb =
             [this](const std::string& endpoint_id) {
-              auto remote_device = v3::ConnectionsDevice(endpoint_id, "", {});
-              this->listening_info_.listener.disconnected_cb(remote_device);
+              this->listening_info_.listener.disconnected_cb(
+                  *GetRemoteDevice(endpoint_id));
             },
         .bandwidth_changed_cb =
             [this](const std::string& endpoint_id, Medium medium) {
-              auto remote_device = v3::ConnectionsDevice(endpoint_id, "", {});
               this->listening_info_.listener.bandwidth_changed_cb(
-                  remote_device, v3::BandwidthInfo{.medium = medium});
+                  *GetRemoteDevice(endpoint_id),
+                  v3::BandwidthInfo{.medium = medium});
             },
     };
     return listener;
@@ -272,8 +306,9 @@ void ClientProxy::StartedDiscovery(
     const DiscoveryListener& listener,
     absl::Span<location::nearby::proto::connections::Medium> mediums,
     const DiscoveryOptions& discovery_options) {
-  MutexLock lock(&mutex_);
+  MutexLock lock(&discovery_mutex_);
   discovery_info_ = DiscoveryInfo{service_id, listener};
+  is_discovering_.Set(!discovery_info_.IsEmpty());
   discovery_options_ = discovery_options;
 
   const std::vector<location::nearby::proto::connections::Medium> medium_vector(
@@ -282,40 +317,46 @@ void ClientProxy::StartedDiscovery(
 }
 
 void ClientProxy::StoppedDiscovery() {
-  MutexLock lock(&mutex_);
-
-  if (IsDiscovering()) {
-    discovered_endpoint_ids_.clear();
-    discovery_info_.Clear();
-    analytics_recorder_->OnStopDiscovery();
+  {
+    MutexLock lock(&discovery_mutex_);
+
+    if (IsDiscovering()) {
+      discovered_endpoint_ids_.clear();
+      pending_found_endpoints_.clear();
+      discovery_info_.Clear();
+      is_discovering_.Set(false);
+      analytics_recorder_->OnStopDiscovery();
+    }
   }
   // discovery_options_ is purposefully not cleared here.
   OnSessionComplete();
 }
 
 bool ClientProxy::IsDiscoveringServiceId(const std::string& service_id) const {
-  MutexLock lock(&mutex_);
+  MutexLock lock(&discovery_mutex_);
 
   return IsDiscovering() && service_id == discovery_info_.service_id;
 }
 
-bool ClientProxy::IsDiscovering() const {
-  MutexLock lock(&mutex_);
-
-  return !discovery_info_.IsEmpty();
-}
+bool ClientProxy::IsDiscovering() const { return is_discovering_.Get(); }
 
 std::string ClientProxy::GetDiscoveryServiceId() const {
-  MutexLock lock(&mutex_);
+  MutexLock lock(&discovery_mutex_);
 
   return discovery_info_.service_id;
 }
 
+void ClientProxy::UpdatedDiscoveryOptions(
+    const DiscoveryOptions& discovery_options) {
+  MutexLock lock(&discovery_mutex_);
+  discovery_options_ = discovery_options;
+}
+
 void ClientProxy::OnEndpointFound(
     const std::string& service_id, const std::string& endpoint_id,
     const ByteArray& endpoint_info,
     location::nearby::proto::connections::Medium medium) {
-  MutexLock lock(&mutex_);
+  MutexLock lock(&discovery_mutex_);
 
   NEARBY_LOGS(INFO) << "ClientProxy [Endpoint Found]: [enter] id="
                     << endpoint_id << "; service=" << service_id << "; info="
@@ -334,15 +375,66 @@ void ClientProxy::OnEndpointFound(
     return;
   }
 
+  auto pending = pending_found_endpoints_.find(endpoint_id);
+  if (pending != pending_found_endpoints_.end()) {
+    std::vector<location::nearby::proto::connections::Medium>& mediums =
+        pending->second.mediums;
+    if (std::find(mediums.begin(), mediums.end(), medium) == mediums.end()) {
+      mediums.push_back(medium);
+    }
+    pending->second.endpoint_info = endpoint_info;
+    NEARBY_LOGS(INFO) << "ClientProxy [Endpoint Found]: Merged event for id="
+                      << endpoint_id << " into the one not yet reported.";
+    return;
+  }
+
+  absl::Duration window = absl::Milliseconds(
+      NearbyFlags::GetInstance().GetInt64Flag(
+          config_package_nearby::nearby_connections_feature::
+              kDiscoveryCoalescingWindowMillis));
+  if (window > absl::ZeroDuration()) {
+    std::uint64_t generation = next_pending_found_generation_++;
+    pending_found_endpoints_[endpoint_id] = {service_id, endpoint_info,
+                                             {medium}, generation};
+    single_thread_executor_.Schedule(
+        [this, endpoint_id, generation]() {
+          ReportPendingEndpointFound(endpoint_id, generation);
+        },
+        window);
+    return;
+  }
+
   discovered_endpoint_ids_.insert(endpoint_id);
   discovery_info_.listener.endpoint_found_cb(endpoint_id, endpoint_info,
                                              service_id);
   analytics_recorder_->OnEndpointFound(medium);
 }
 
+void ClientProxy::ReportPendingEndpointFound(const std::string& endpoint_id,
+                                             std::uint64_t generation) {
+  MutexLock lock(&discovery_mutex_);
+
+  auto pending = pending_found_endpoints_.find(endpoint_id);
+  if (pending == pending_found_endpoints_.end() ||
+      pending->second.generation != generation) {
+    return;
+  }
+  PendingEndpointFound found = std::move(pending->second);
+  pending_found_endpoints_.erase(pending);
+  if (!IsDiscoveringServiceId(found.service_id)) return;
+
+  NEARBY_LOGS(INFO) << "ClientProxy [Endpoint Found]: Reporting id="
+                    << endpoint_id << " found over " << found.mediums.size()
+                    << " medium(s).";
+  discovered_endpoint_ids_.insert(endpoint_id);
+  discovery_info_.listener.endpoint_found_cb(endpoint_id, found.endpoint_info,
+                                             found.service_id);
+  analytics_recorder_->OnEndpointFound(found.mediums.front());
+}
+
 void ClientProxy::OnEndpointLost(const std::string& service_id,
                                  const std::string& endpoint_id) {
-  MutexLock lock(&mutex_);
+  MutexLock lock(&discovery_mutex_);
 
   NEARBY_LOGS(INFO) << "ClientProxy [Endpoint Lost]: [enter] id=" << endpoint_id
                     << "; service=" << service_id;
@@ -354,6 +446,12 @@ void ClientProxy::OnEndpointLost(const std::string& service_id,
     return;
   }
 
+  if (pending_found_endpoints_.erase(endpoint_id)) {
+    NEARBY_LOGS(INFO) << "ClientProxy [Endpoint Lost]: Dropping id="
+                      << endpoint_id << " before it was reported as found.";
+    return;
+  }
+
   const auto it = discovered_endpoint_ids_.find(endpoint_id);
   if (it == discovered_endpoint_ids_.end()) {
     NEARBY_LOGS(WARNING)
@@ -382,12 +480,14 @@ void ClientProxy::OnConnectionInitiated(
                            .connection_listener = listener,
                            .connection_options = connection_options,
                            .connection_token = connection_token,
+                           .remote_endpoint_info = info.remote_endpoint_info,
                        },
                        PayloadListener{
                            .payload_cb = [](absl::string_view, Payload) {},
                            .payload_progress_cb = [](absl::string_view,
                                                      PayloadProgressInfo) {},
                        }));
+  PublishConnectionsSnapshot();
   // Instead of using structured binding which is nice, but banned
   // (can not use c++17 features, until chromium does) we unpack manually.
   auto& pair_iter = result.first;
@@ -428,6 +528,7 @@ void ClientProxy::OnConnectionAccepted(const std::string& endpoint_id) {
   if (item != nullptr) {
     item->first.connection_listener.accepted_cb(endpoint_id);
     item->first.status = Connection::kConnected;
+    PublishConnectionsSnapshot();
   }
 }
 
@@ -472,10 +573,41 @@ void ClientProxy::OnDisconnected(const std::string& endpoint_id, bool notify) {
       item->first.connection_listener.disconnected_cb({endpoint_id});
     }
     connections_.erase(endpoint_id);
+    PublishConnectionsSnapshot();
     OnSessionComplete();
   }
 
   CancelEndpoint(endpoint_id);
+  {
+    MutexLock endpoint_stats_lock(&endpoint_stats_mutex_);
+    endpoint_stats_recorders_.erase(endpoint_id);
+  }
+  if (connections_device_provider_ != nullptr) {
+    connections_device_provider_->ReleaseRemoteDevice(endpoint_id);
+  }
+}
+
+std::shared_ptr<EndpointStatsRecorder> ClientProxy::GetEndpointStatsRecorder(
+    const std::string& endpoint_id) {
+  MutexLock lock(&endpoint_stats_mutex_);
+  std::shared_ptr<EndpointStatsRecorder>& stats_recorder =
+      endpoint_stats_recorders_[endpoint_id];
+  if (stats_recorder == nullptr) {
+    stats_recorder = std::make_shared<EndpointStatsRecorder>();
+  }
+  return stats_recorder;
+}
+
+std::optional<EndpointStats> ClientProxy::GetEndpointStats(
+    const std::string& endpoint_id) const {
+  std::shared_ptr<EndpointStatsRecorder> stats_recorder;
+  {
+    MutexLock lock(&endpoint_stats_mutex_);
+    auto item = endpoint_stats_recorders_.find(endpoint_id);
+    if (item == endpoint_stats_recorders_.end()) return std::nullopt;
+    stats_recorder = item->second;
+  }
+  return stats_recorder->GetStats();
 }
 
 bool ClientProxy::ConnectionStatusMatches(const std::string& endpoint_id,
@@ -541,7 +673,9 @@ std::string ClientProxy::GetIPAddress(const std::string& endpoint_id) const {
 }
 
 bool ClientProxy::IsConnectedToEndpoint(const std::string& endpoint_id) const {
-  return ConnectionStatusMatches(endpoint_id, Connection::kConnected);
+  std::optional<ConnectionSnapshot> snapshot =
+      LookupConnectionSnapshot(endpoint_id);
+  return snapshot.has_value() && snapshot->status == Connection::kConnected;
 }
 
 std::vector<std::string> ClientProxy::GetMatchingEndpoints(
@@ -717,6 +851,7 @@ void ClientProxy::AddCancellationFlag(const std::string& endpoint_id) {
     return;
   }
 
+  MutexLock lock(&cancellation_flags_mutex_);
   auto item = cancellation_flags_.find(endpoint_id);
   if (item != cancellation_flags_.end()) {
     // A new flag may be added to the map with the same endpoint, even if a
@@ -736,6 +871,7 @@ void ClientProxy::AddCancellationFlag(const std::string& endpoint_id) {
 
 CancellationFlag* ClientProxy::GetCancellationFlag(
     const std::string& endpoint_id) {
+  MutexLock lock(&cancellation_flags_mutex_);
   const auto item = cancellation_flags_.find(endpoint_id);
   if (item == cancellation_flags_.end()) {
     return default_cancellation_flag_.get();
@@ -744,10 +880,18 @@ CancellationFlag* ClientProxy::GetCancellationFlag(
 }
 
 void ClientProxy::CancelEndpoint(const std::string& endpoint_id) {
-  const auto item = cancellation_flags_.find(endpoint_id);
-  if (item != cancellation_flags_.end()) {
-    item->second->Cancel();
+  CancellationFlag* cancellation_flag = nullptr;
+  {
+    MutexLock lock(&cancellation_flags_mutex_);
+    const auto item = cancellation_flags_.find(endpoint_id);
+    if (item == cancellation_flags_.end()) {
+      return;
+    }
+    cancellation_flag = item->second.get();
   }
+  // Cancel() runs listeners, so it is called without holding the lock. Flags
+  // are only destroyed by RemoveAllEndpoints().
+  cancellation_flag->Cancel();
 }
 
 const OsInfo& ClientProxy::GetLocalOsInfo() const {
@@ -763,6 +907,16 @@ std::optional<OsInfo> ClientProxy::GetRemoteOsInfo(
   return std::nullopt;
 }
 
+ByteArray ClientProxy::GetRemoteEndpointInfo(
+    absl::string_view endpoint_id) const {
+  MutexLock lock(&mutex_);
+  const ConnectionPair* item = LookupConnection(endpoint_id);
+  if (item != nullptr) {
+    return item->first.remote_endpoint_info;
+  }
+  return {};
+}
+
 void ClientProxy::SetRemoteOsInfo(absl::string_view endpoint_id,
                                   const OsInfo& remote_os_info) {
   ConnectionPair* item = LookupConnection(endpoint_id);
@@ -770,9 +924,119 @@ void ClientProxy::SetRemoteOsInfo(absl::string_view endpoint_id,
     item->first.os_info.emplace(remote_os_info);
   }
 }
+
+bool ClientProxy::RemoteSupportsBytesPayloadBatching(
+    absl::string_view endpoint_id) const {
+  std::optional<ConnectionSnapshot> snapshot =
+      LookupConnectionSnapshot(endpoint_id);
+  return snapshot.has_value() && snapshot->supports_bytes_payload_batching;
+}
+
+void ClientProxy::SetRemoteSupportsBytesPayloadBatching(
+    absl::string_view endpoint_id, bool supported) {
+  MutexLock lock(&mutex_);
+  ConnectionPair* item = LookupConnection(endpoint_id);
+  if (item != nullptr) {
+    item->first.supports_bytes_payload_batching = supported;
+    PublishConnectionsSnapshot();
+  }
+}
+
+bool ClientProxy::RemoteSupportsSingleFrameBytesPayloads(
+    absl::string_view endpoint_id) const {
+  std::optional<ConnectionSnapshot> snapshot =
+      LookupConnectionSnapshot(endpoint_id);
+  return snapshot.has_value() && snapshot->supports_single_frame_bytes_payloads;
+}
+
+void ClientProxy::SetRemoteSupportsSingleFrameBytesPayloads(
+    absl::string_view endpoint_id, bool supported) {
+  MutexLock lock(&mutex_);
+  ConnectionPair* item = LookupConnection(endpoint_id);
+  if (item != nullptr) {
+    item->first.supports_single_frame_bytes_payloads = supported;
+    PublishConnectionsSnapshot();
+  }
+}
+
+bool ClientProxy::RemoteSupportsCompressedChunks(
+    absl::string_view endpoint_id) const {
+  std::optional<ConnectionSnapshot> snapshot =
+      LookupConnectionSnapshot(endpoint_id);
+  return snapshot.has_value() && snapshot->supports_compressed_chunks;
+}
+
+void ClientProxy::SetRemoteSupportsCompressedChunks(
+    absl::string_view endpoint_id, bool supported) {
+  MutexLock lock(&mutex_);
+  ConnectionPair* item = LookupConnection(endpoint_id);
+  if (item != nullptr) {
+    item->first.supports_compressed_chunks = supported;
+    PublishConnectionsSnapshot();
+  }
+}
+
+bool ClientProxy::RemoteSupportsChunkDedup(
+    absl::string_view endpoint_id) const {
+  std::optional<ConnectionSnapshot> snapshot =
+      LookupConnectionSnapshot(endpoint_id);
+  return snapshot.has_value() && snapshot->supports_chunk_dedup;
+}
+
+void ClientProxy::SetRemoteSupportsChunkDedup(absl::string_view endpoint_id,
+                                              bool supported) {
+  MutexLock lock(&mutex_);
+  ConnectionPair* item = LookupConnection(endpoint_id);
+  if (item != nullptr) {
+    item->first.supports_chunk_dedup = supported;
+    PublishConnectionsSnapshot();
+  }
+}
+
+bool ClientProxy::RemoteSupportsFileBatch(
+    absl::string_view endpoint_id) const {
+  std::optional<ConnectionSnapshot> snapshot =
+      LookupConnectionSnapshot(endpoint_id);
+  return snapshot.has_value() && snapshot->supports_file_batch;
+}
+
+void ClientProxy::SetRemoteSupportsFileBatch(absl::string_view endpoint_id,
+                                             bool supported) {
+  MutexLock lock(&mutex_);
+  ConnectionPair* item = LookupConnection(endpoint_id);
+  if (item != nullptr) {
+    item->first.supports_file_batch = supported;
+    PublishConnectionsSnapshot();
+  }
+}
+
+bool ClientProxy::RemoteSupportsPayloadRelay(
+    absl::string_view endpoint_id) const {
+  std::optional<ConnectionSnapshot> snapshot =
+      LookupConnectionSnapshot(endpoint_id);
+  return snapshot.has_value() && snapshot->supports_payload_relay;
+}
+
+void ClientProxy::SetRemoteSupportsPayloadRelay(absl::string_view endpoint_id,
+                                                bool supported) {
+  MutexLock lock(&mutex_);
+  ConnectionPair* item = LookupConnection(endpoint_id);
+  if (item != nullptr) {
+    item->first.supports_payload_relay = supported;
+    PublishConnectionsSnapshot();
+  }
+}
+
 void ClientProxy::CancelAllEndpoints() {
-  for (const auto& item : cancellation_flags_) {
-    CancellationFlag* cancellation_flag = item.second.get();
+  std::vector<CancellationFlag*> cancellation_flags;
+  {
+    MutexLock lock(&cancellation_flags_mutex_);
+    cancellation_flags.reserve(cancellation_flags_.size());
+    for (const auto& item : cancellation_flags_) {
+      cancellation_flags.push_back(item.second.get());
+    }
+  }
+  for (CancellationFlag* cancellation_flag : cancellation_flags) {
     if (cancellation_flag->Cancelled()) {
       continue;
     }
@@ -781,18 +1045,36 @@ void ClientProxy::CancelAllEndpoints() {
 }
 
 void ClientProxy::OnPayload(const std::string& endpoint_id, Payload payload) {
+  // Checked against the snapshot first so that payloads for endpoints which
+  // aren't connected never wait for mutex_.
+  if (!IsConnectedToEndpoint(endpoint_id)) {
+    return;
+  }
   MutexLock lock(&mutex_);
 
-  if (IsConnectedToEndpoint(endpoint_id)) {
-    const std::pair<ClientProxy::Connection, PayloadListener>* item =
-        LookupConnection(endpoint_id);
-    if (item != nullptr) {
-      NEARBY_LOGS(INFO) << "ClientProxy [reporting onPayloadReceived]: client="
-                        << GetClientId() << "; endpoint_id=" << endpoint_id
-                        << " ; payload_id=" << payload.GetId();
-      item->second.payload_cb(endpoint_id, std::move(payload));
-    }
+  const std::pair<ClientProxy::Connection, PayloadListener>* item =
+      LookupConnection(endpoint_id);
+  if (item != nullptr && item->first.status == Connection::kConnected) {
+    NEARBY_LOGS(INFO) << "ClientProxy [reporting onPayloadReceived]: client="
+                      << GetClientId() << "; endpoint_id=" << endpoint_id
+                      << " ; payload_id=" << payload.GetId();
+    item->second.payload_cb(endpoint_id, std::move(payload));
+  }
+}
+
+IncomingBytesBuffer ClientProxy::GetIncomingBytesBuffer(
+    const std::string& endpoint_id, Payload::Id payload_id, size_t size) {
+  if (!IsConnectedToEndpoint(endpoint_id)) {
+    return {};
+  }
+  MutexLock lock(&mutex_);
+
+  ConnectionPair* item = LookupConnection(endpoint_id);
+  if (item == nullptr || item->first.status != Connection::kConnected ||
+      !item->second.incoming_bytes_buffer_cb) {
+    return {};
   }
+  return item->second.incoming_bytes_buffer_cb(endpoint_id, payload_id, size);
 }
 
 const ClientProxy::ConnectionPair* ClientProxy::LookupConnection(
@@ -807,29 +1089,71 @@ ClientProxy::ConnectionPair* ClientProxy::LookupConnection(
   return item != connections_.end() ? &item->second : nullptr;
 }
 
+void ClientProxy::PublishConnectionsSnapshot() {
+  auto snapshot = std::make_shared<ConnectionsSnapshot>();
+  snapshot->reserve(connections_.size());
+  for (const auto& [endpoint_id, connection_pair] : connections_) {
+    const Connection& connection = connection_pair.first;
+    snapshot->emplace(
+        endpoint_id,
+        ConnectionSnapshot{
+            .status = connection.status,
+            .supports_bytes_payload_batching =
+                connection.supports_bytes_payload_batching,
+            .supports_single_frame_bytes_payloads =
+                connection.supports_single_frame_bytes_payloads,
+            .supports_compressed_chunks = connection.supports_compressed_chunks,
+            .supports_chunk_dedup = connection.supports_chunk_dedup,
+            .supports_file_batch = connection.supports_file_batch,
+            .supports_payload_relay = connection.supports_payload_relay,
+            .connection_token = connection.connection_token,
+            .os_info = connection.os_info,
+        });
+  }
+  std::atomic_store(&connections_snapshot_,
+                    std::shared_ptr<const ConnectionsSnapshot>(
+                        std::move(snapshot)));
+}
+
+std::shared_ptr<const ClientProxy::ConnectionsSnapshot>
+ClientProxy::GetConnectionsSnapshot() const {
+  return std::atomic_load(&connections_snapshot_);
+}
+
+std::optional<ClientProxy::ConnectionSnapshot>
+ClientProxy::LookupConnectionSnapshot(absl::string_view endpoint_id) const {
+  std::shared_ptr<const ConnectionsSnapshot> snapshot =
+      GetConnectionsSnapshot();
+  auto item = snapshot->find(endpoint_id);
+  if (item == snapshot->end()) {
+    return std::nullopt;
+  }
+  return item->second;
+}
+
 void ClientProxy::OnPayloadProgress(const std::string& endpoint_id,
                                     const PayloadProgressInfo& info) {
+  if (!IsConnectedToEndpoint(endpoint_id)) {
+    return;
+  }
   MutexLock lock(&mutex_);
 
-  if (IsConnectedToEndpoint(endpoint_id)) {
-    std::pair<ClientProxy::Connection, PayloadListener>* item =
-        LookupConnection(endpoint_id);
-    if (item != nullptr) {
-      item->second.payload_progress_cb(endpoint_id, info);
-
-      if (info.status == PayloadProgressInfo::Status::kInProgress) {
-        NEARBY_LOGS(VERBOSE)
-            << "ClientProxy [reporting onPayloadProgress]: client="
-            << GetClientId() << "; endpoint_id=" << endpoint_id
-            << "; payload_id=" << info.payload_id
-            << ", payload_status=" << ToString(info.status);
-      } else {
-        NEARBY_LOGS(INFO)
-            << "ClientProxy [reporting onPayloadProgress]: client="
-            << GetClientId() << "; endpoint_id=" << endpoint_id
-            << "; payload_id=" << info.payload_id
-            << ", payload_status=" << ToString(info.status);
-      }
+  std::pair<ClientProxy::Connection, PayloadListener>* item =
+      LookupConnection(endpoint_id);
+  if (item != nullptr && item->first.status == Connection::kConnected) {
+    item->second.payload_progress_cb(endpoint_id, info);
+
+    if (info.status == PayloadProgressInfo::Status::kInProgress) {
+      NEARBY_LOGS(VERBOSE)
+          << "ClientProxy [reporting onPayloadProgress]: client="
+          << GetClientId() << "; endpoint_id=" << endpoint_id
+          << "; payload_id=" << info.payload_id
+          << ", payload_status=" << ToString(info.status);
+    } else {
+      NEARBY_LOGS(INFO) << "ClientProxy [reporting onPayloadProgress]: client="
+                        << GetClientId() << "; endpoint_id=" << endpoint_id
+                        << "; payload_id=" << info.payload_id
+                        << ", payload_status=" << ToString(info.status);
     }
   }
 }
@@ -841,7 +1165,15 @@ void ClientProxy::RemoveAllEndpoints() {
   // endpoint, in the case when this is called from stopAllEndpoints(). For now,
   // just remove without notifying.
   connections_.clear();
-  cancellation_flags_.clear();
+  PublishConnectionsSnapshot();
+  {
+    MutexLock cancellation_flags_lock(&cancellation_flags_mutex_);
+    cancellation_flags_.clear();
+  }
+  {
+    MutexLock endpoint_stats_lock(&endpoint_stats_mutex_);
+    endpoint_stats_recorders_.clear();
+  }
 
   OnSessionComplete();
 }
@@ -871,6 +1203,7 @@ void ClientProxy::AppendConnectionStatus(const std::string& endpoint_id,
   if (item != nullptr) {
     item->first.status =
         static_cast<Connection::Status>(item->first.status | status_to_append);
+    PublishConnectionsSnapshot();
   }
 }
 
@@ -972,35 +1305,119 @@ std::string ClientProxy::ToString(PayloadProgressInfo::Status status) const {
   }
 }
 
-std::string ClientProxy::Dump() {
+namespace {
+
+// Sorts |ids| and keeps the page of them selected by |options|. Returns how
+// many there were.
+int SelectDumpPage(const ClientProxy::DumpOptions& options,
+                   std::vector<std::string>& ids) {
+  std::sort(ids.begin(), ids.end());
+  int total = ids.size();
+  int begin = std::clamp(options.offset, 0, total);
+  int end = options.max_endpoints < 0
+                ? total
+                : begin + std::min(options.max_endpoints, total - begin);
+  ids.erase(ids.begin() + end, ids.end());
+  ids.erase(ids.begin(), ids.begin() + begin);
+  return total;
+}
+
+}  // namespace
+
+ClientProxy::DiagnosticsSnapshot ClientProxy::GetDiagnosticsSnapshot(
+    const DumpOptions& options) {
+  DiagnosticsSnapshot diagnostics;
+  diagnostics.client_id = GetClientId();
+  diagnostics.local_endpoint_id = GetLocalEndpointId();
+  {
+    MutexLock lock(&mutex_);
+    diagnostics.high_vis_mode = high_vis_mode_;
+    diagnostics.advertising_service_id = advertising_info_.service_id;
+  }
+  diagnostics.is_advertising = IsAdvertising();
+  diagnostics.is_discovering = IsDiscovering();
+
+  std::vector<std::string> discovered_endpoint_ids;
+  {
+    MutexLock lock(&discovery_mutex_);
+    diagnostics.discovery_service_id = discovery_info_.service_id;
+    discovered_endpoint_ids.reserve(discovered_endpoint_ids_.size());
+    for (const std::string& endpoint_id : discovered_endpoint_ids_) {
+      if (absl::StartsWith(endpoint_id, options.endpoint_id_prefix)) {
+        discovered_endpoint_ids.push_back(endpoint_id);
+      }
+    }
+  }
+  diagnostics.matching_discovered_endpoints =
+      SelectDumpPage(options, discovered_endpoint_ids);
+  diagnostics.discovered_endpoint_ids = std::move(discovered_endpoint_ids);
+
+  std::shared_ptr<const ConnectionsSnapshot> connections =
+      GetConnectionsSnapshot();
+  std::vector<std::string> connected_endpoint_ids;
+  connected_endpoint_ids.reserve(connections->size());
+  for (const auto& [endpoint_id, connection] : *connections) {
+    if (absl::StartsWith(endpoint_id, options.endpoint_id_prefix)) {
+      connected_endpoint_ids.push_back(endpoint_id);
+    }
+  }
+  diagnostics.matching_connections =
+      SelectDumpPage(options, connected_endpoint_ids);
+  diagnostics.connections.reserve(connected_endpoint_ids.size());
+  for (std::string& endpoint_id : connected_endpoint_ids) {
+    const ConnectionSnapshot& connection = connections->at(endpoint_id);
+    diagnostics.connections.push_back({
+        .endpoint_id = std::move(endpoint_id),
+        .connection_token = connection.connection_token,
+        .os_info = connection.os_info,
+    });
+  }
+  return diagnostics;
+}
+
+std::string ClientProxy::Dump(const DumpOptions& options) {
+  DiagnosticsSnapshot diagnostics = GetDiagnosticsSnapshot(options);
+
   std::stringstream sstream;
   sstream << "Nearby Connections State" << std::endl;
-  sstream << "  Client ID: " << GetClientId() << std::endl;
-  sstream << "  Local Endpoint ID: " << GetLocalEndpointId() << std::endl;
+  sstream << "  Client ID: " << diagnostics.client_id << std::endl;
+  sstream << "  Local Endpoint ID: " << diagnostics.local_endpoint_id
+          << std::endl;
   sstream << std::boolalpha;
-  sstream << "  High Visibility Mode: " << high_vis_mode_ << std::endl;
-  sstream << "  Is Advertising: " << IsAdvertising() << std::endl;
-  sstream << "  Is Discovering: " << IsDiscovering() << std::endl;
+  sstream << "  High Visibility Mode: " << diagnostics.high_vis_mode
+          << std::endl;
+  sstream << "  Is Advertising: " << diagnostics.is_advertising << std::endl;
+  sstream << "  Is Discovering: " << diagnostics.is_discovering << std::endl;
   sstream << std::noboolalpha;
-  sstream << "  Advertising Service ID: " << GetAdvertisingServiceId()
+  sstream << "  Advertising Service ID: " << diagnostics.advertising_service_id
+          << std::endl;
+  sstream << "  Discovery Service ID: " << diagnostics.discovery_service_id
           << std::endl;
-  sstream << "  Discovery Service ID: " << GetDiscoveryServiceId() << std::endl;
   sstream << "  Connections: " << std::endl;
-  for (auto it = connections_.begin(); it != connections_.end(); ++it) {
-    // TODO(deling): write Connection.ToString()
-    sstream << "    " << it->first << " :(connection token) "
-            << it->second.first.connection_token << ", (remote os type) "
-            << (it->second.first.os_info.has_value()
+  for (const auto& connection : diagnostics.connections) {
+    sstream << "    " << connection.endpoint_id << " :(connection token) "
+            << connection.connection_token << ", (remote os type) "
+            << (connection.os_info.has_value()
                     ? location::nearby::connections::OsInfo::OsType_Name(
-                          it->second.first.os_info->type())
+                          connection.os_info->type())
                     : "unknown")
             << std::endl;
   }
+  if (static_cast<int>(diagnostics.connections.size()) <
+      diagnostics.matching_connections) {
+    sstream << "    (" << diagnostics.connections.size() << " of "
+            << diagnostics.matching_connections << " shown)" << std::endl;
+  }
 
   sstream << "  Discovered endpoint IDs: " << std::endl;
-  for (auto it = discovered_endpoint_ids_.begin();
-       it != discovered_endpoint_ids_.end(); ++it) {
-    sstream << "    " << *it << std::endl;
+  for (const std::string& endpoint_id : diagnostics.discovered_endpoint_ids) {
+    sstream << "    " << endpoint_id << std::endl;
+  }
+  if (static_cast<int>(diagnostics.discovered_endpoint_ids.size()) <
+      diagnostics.matching_discovered_endpoints) {
+    sstream << "    (" << diagnostics.discovered_endpoint_ids.size() << " of "
+            << diagnostics.matching_discovered_endpoints << " shown)"
+            << std::endl;
   }
 
   return sstream.str();
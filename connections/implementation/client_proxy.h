@@ -15,6 +15,7 @@
 #ifndef CORE_INTERNAL_CLIENT_PROXY_H_
 #define CORE_INTERNAL_CLIENT_PROXY_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -26,6 +27,8 @@
 #include "connections/advertising_options.h"
 #include "connections/discovery_options.h"
 #include "connections/implementation/analytics/analytics_recorder.h"
+#include "connections/implementation/endpoint_stats.h"
+#include "connections/implementation/memory_accountant.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
 #include "connections/listeners.h"
 #include "connections/status.h"
@@ -36,6 +39,7 @@
 #include "internal/analytics/event_logger.h"
 #include "internal/interop/device.h"
 #include "internal/interop/device_provider.h"
+#include "internal/platform/atomic_boolean.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/cancelable_alarm.h"
 #include "internal/platform/cancellation_flag.h"
@@ -73,6 +77,17 @@ class ClientProxy final {
     return *analytics_recorder_;
   }
 
+  MemoryAccountant& GetMemoryAccountant() const { return *memory_accountant_; }
+
+  // Returns where the channels of |endpoint_id| record transport statistics,
+  // creating it on first use. It's dropped once the endpoint disconnects.
+  std::shared_ptr<EndpointStatsRecorder> GetEndpointStatsRecorder(
+      const std::string& endpoint_id);
+  // Returns the transport statistics of |endpoint_id|, or nullopt if it has
+  // no channel.
+  std::optional<EndpointStats> GetEndpointStats(
+      const std::string& endpoint_id) const;
+
   std::string GetConnectionToken(const std::string& endpoint_id);
   const NearbyDevice* GetLocalDevice();
   NearbyDeviceProvider* GetLocalDeviceProvider() {
@@ -95,6 +110,8 @@ class ClientProxy final {
   void StoppedAdvertising();
   bool IsAdvertising() const;
   std::string GetAdvertisingServiceId() const;
+  // Replaces the options of the ongoing advertising, once it moved to them.
+  void UpdatedAdvertisingOptions(const AdvertisingOptions& advertising_options);
 
   // Marks this client as listening for incoming connections.
   void StartedListeningForIncomingConnections(
@@ -118,6 +135,8 @@ class ClientProxy final {
   bool IsDiscoveringServiceId(const std::string& service_id) const;
   bool IsDiscovering() const;
   std::string GetDiscoveryServiceId() const;
+  // Replaces the options of the ongoing discovery, once it moved to them.
+  void UpdatedDiscoveryOptions(const DiscoveryOptions& discovery_options);
 
   void UpdateLocalEndpointInfo(absl::string_view endpoint_info) {
     MutexLock lock(&mutex_);
@@ -200,6 +219,11 @@ class ClientProxy final {
 
   // Proxies to the client's PayloadListener::OnPayload() callback.
   void OnPayload(const std::string& endpoint_id, Payload payload);
+  // Proxies to the client's PayloadListener incoming_bytes_buffer_cb, if it
+  // has one. Returns a null buffer otherwise.
+  IncomingBytesBuffer GetIncomingBytesBuffer(const std::string& endpoint_id,
+                                             Payload::Id payload_id,
+                                             size_t size);
   // Proxies to the client's PayloadListener::OnPayloadProgress() callback.
   void OnPayloadProgress(const std::string& endpoint_id,
                          const PayloadProgressInfo& info);
@@ -227,14 +251,85 @@ class ClientProxy final {
   // rotates.
   void ExitHighVisibilityMode();
 
-  std::string Dump();
+  // Selects the endpoints Dump() reports, so that a periodic dump stays cheap
+  // with hundreds of them.
+  struct DumpOptions {
+    // Only endpoints whose ID starts with this are reported.
+    std::string endpoint_id_prefix;
+    // Skips this many of the matching endpoints, in ID order, and reports at
+    // most |max_endpoints| of the rest, or all of them if negative. Applies to
+    // connections and discovered endpoints separately.
+    int offset = 0;
+    int max_endpoints = -1;
+  };
+
+  // The state reported by Dump(). Copied with each lock held only for the
+  // copy, and connections read from their lock-free snapshot.
+  struct DiagnosticsSnapshot {
+    struct ConnectionEntry {
+      std::string endpoint_id;
+      std::string connection_token;
+      std::optional<location::nearby::connections::OsInfo> os_info;
+    };
+
+    std::int64_t client_id = 0;
+    std::string local_endpoint_id;
+    bool high_vis_mode = false;
+    bool is_advertising = false;
+    bool is_discovering = false;
+    std::string advertising_service_id;
+    std::string discovery_service_id;
+    // The selected entries, in ID order, and how many matched in total.
+    std::vector<ConnectionEntry> connections;
+    int matching_connections = 0;
+    std::vector<std::string> discovered_endpoint_ids;
+    int matching_discovered_endpoints = 0;
+  };
+
+  DiagnosticsSnapshot GetDiagnosticsSnapshot(const DumpOptions& options);
+  // Formats GetDiagnosticsSnapshot(), without holding any lock.
+  std::string Dump(const DumpOptions& options);
+  std::string Dump() { return Dump(DumpOptions()); }
 
   const location::nearby::connections::OsInfo& GetLocalOsInfo() const;
   std::optional<location::nearby::connections::OsInfo> GetRemoteOsInfo(
       absl::string_view endpoint_id) const;
+  // The endpoint info the remote endpoint sent when the connection was
+  // initiated, or empty if there's no such connection.
+  ByteArray GetRemoteEndpointInfo(absl::string_view endpoint_id) const;
   void SetRemoteOsInfo(
       absl::string_view endpoint_id,
       const location::nearby::connections::OsInfo& remote_os_info);
+  // Whether the remote endpoint announced, in its connection response, that it
+  // can receive several BYTES payloads packed into a single frame.
+  bool RemoteSupportsBytesPayloadBatching(absl::string_view endpoint_id) const;
+  void SetRemoteSupportsBytesPayloadBatching(absl::string_view endpoint_id,
+                                             bool supported);
+  // Whether the remote endpoint announced that it accepts a BYTES payload's
+  // body and last chunk in a single frame.
+  bool RemoteSupportsSingleFrameBytesPayloads(
+      absl::string_view endpoint_id) const;
+  void SetRemoteSupportsSingleFrameBytesPayloads(absl::string_view endpoint_id,
+                                                 bool supported);
+  // Whether the remote endpoint announced that it accepts payload chunks with
+  // compressed bodies.
+  bool RemoteSupportsCompressedChunks(absl::string_view endpoint_id) const;
+  void SetRemoteSupportsCompressedChunks(absl::string_view endpoint_id,
+                                         bool supported);
+  // Whether the remote endpoint announced that it accepts chunk manifests for
+  // FILE payloads.
+  bool RemoteSupportsChunkDedup(absl::string_view endpoint_id) const;
+  void SetRemoteSupportsChunkDedup(absl::string_view endpoint_id,
+                                   bool supported);
+  // Whether the remote endpoint announced that it accepts FILE_BATCH payloads.
+  bool RemoteSupportsFileBatch(absl::string_view endpoint_id) const;
+  void SetRemoteSupportsFileBatch(absl::string_view endpoint_id,
+                                  bool supported);
+  // Whether the remote endpoint announced that it relays payloads over the
+  // tree in their PayloadHeader.
+  bool RemoteSupportsPayloadRelay(absl::string_view endpoint_id) const;
+  void SetRemoteSupportsPayloadRelay(absl::string_view endpoint_id,
+                                     bool supported);
 
   void RegisterDeviceProvider(NearbyDeviceProvider* provider) {
     external_device_provider_ = provider;
@@ -245,6 +340,12 @@ class ClientProxy final {
     connections_device_provider_ = std::move(provider);
   }
 
+  // Returns the v3 device of the remote endpoint `endpoint_id`. It is interned
+  // by the connections device provider, if any, until the endpoint
+  // disconnects, so that v3 callbacks don't build a device for every call.
+  std::shared_ptr<const v3::ConnectionsDevice> GetRemoteDevice(
+      absl::string_view endpoint_id);
+
  private:
   struct Connection {
     // Status: may be either:
@@ -273,10 +374,35 @@ class ClientProxy final {
     DiscoveryOptions discovery_options;
     AdvertisingOptions advertising_options;
     std::string connection_token;
+    ByteArray remote_endpoint_info;
     std::optional<location::nearby::connections::OsInfo> os_info;
+    bool supports_bytes_payload_batching{false};
+    bool supports_single_frame_bytes_payloads{false};
+    bool supports_compressed_chunks{false};
+    bool supports_chunk_dedup{false};
+    bool supports_file_batch{false};
+    bool supports_payload_relay{false};
   };
   using ConnectionPair = std::pair<Connection, PayloadListener>;
 
+  // The subset of a Connection read from the payload path. A copy of it for
+  // every connection is republished whenever `connections_` changes, so those
+  // reads don't need `mutex_`.
+  struct ConnectionSnapshot {
+    Connection::Status status{Connection::kPending};
+    bool supports_bytes_payload_batching{false};
+    bool supports_single_frame_bytes_payloads{false};
+    bool supports_compressed_chunks{false};
+    bool supports_chunk_dedup{false};
+    bool supports_file_batch{false};
+    bool supports_payload_relay{false};
+    // Only read by Dump().
+    std::string connection_token;
+    std::optional<location::nearby::connections::OsInfo> os_info;
+  };
+  using ConnectionsSnapshot =
+      absl::flat_hash_map<std::string, ConnectionSnapshot>;
+
   struct AdvertisingInfo {
     std::string service_id;
     ConnectionListener listener;
@@ -311,6 +437,12 @@ class ClientProxy final {
   void AppendConnectionStatus(const std::string& endpoint_id,
                               Connection::Status status_to_append);
 
+  // Must be called with `mutex_` held after every change to `connections_`.
+  void PublishConnectionsSnapshot();
+  std::shared_ptr<const ConnectionsSnapshot> GetConnectionsSnapshot() const;
+  std::optional<ConnectionSnapshot> LookupConnectionSnapshot(
+      absl::string_view endpoint_id) const;
+
   const ConnectionPair* LookupConnection(absl::string_view endpoint_id) const;
   ConnectionPair* LookupConnection(absl::string_view endpoint_id);
   bool ConnectionStatusMatches(const std::string& endpoint_id,
@@ -319,6 +451,11 @@ class ClientProxy final {
       std::function<bool(const Connection&)> pred) const;
   std::string GenerateLocalEndpointId();
 
+  // Reports the pending endpoint found, unless it was lost or discovery was
+  // stopped since.
+  void ReportPendingEndpointFound(const std::string& endpoint_id,
+                                  std::uint64_t generation);
+
   void ScheduleClearLocalHighVisModeCacheEndpointIdAlarm();
   void CancelClearLocalHighVisModeCacheEndpointIdAlarm();
 
@@ -327,7 +464,16 @@ class ClientProxy final {
 
   std::string ToString(PayloadProgressInfo::Status status) const;
 
-  mutable RecursiveMutex mutex_;
+  // Guards the connection, advertising and listening state. Discovery state
+  // and cancellation flags have their own locks so that discovery callbacks
+  // don't stall the payload path. Lock order is `discovery_mutex_`, then
+  // `mutex_`, then `cancellation_flags_mutex_` or `endpoint_stats_mutex_`,
+  // which are never held while calling out of ClientProxy.
+  mutable RecursiveMutex mutex_{"ClientProxy::mutex_"};
+  mutable RecursiveMutex discovery_mutex_{"ClientProxy::discovery_mutex_"};
+  mutable Mutex cancellation_flags_mutex_{
+      "ClientProxy::cancellation_flags_mutex_"};
+  mutable Mutex endpoint_stats_mutex_{"ClientProxy::endpoint_stats_mutex_"};
   std::int64_t client_id_;
   std::string local_endpoint_id_;
   std::string local_endpoint_info_;
@@ -354,7 +500,10 @@ class ClientProxy final {
   AdvertisingInfo advertising_info_;
 
   // If not empty, we are currently discovering for the given service_id.
+  // Guarded by discovery_mutex_.
   DiscoveryInfo discovery_info_;
+  // Mirrors !discovery_info_.IsEmpty() so it can be read without a lock.
+  AtomicBoolean is_discovering_{false};
 
   // If not empty, we are currently listening for the given service_id.
   ListeningInfo listening_info_;
@@ -377,27 +526,54 @@ class ClientProxy final {
 
   // Maps endpoint_id to endpoint connection state.
   absl::flat_hash_map<std::string, ConnectionPair> connections_;
+  // Read-mostly copy of `connections_`, replaced (never modified in place) by
+  // PublishConnectionsSnapshot(). Accessed with std::atomic_load/atomic_store.
+  std::shared_ptr<const ConnectionsSnapshot> connections_snapshot_ =
+      std::make_shared<const ConnectionsSnapshot>();
 
   // A cache of endpoint ids that we've already notified the discoverer of. We
   // check this cache before calling onEndpointFound() so that we don't notify
   // the client multiple times for the same endpoint. This would otherwise
   // happen because some mediums (like Bluetooth) repeatedly give us the same
-  // endpoints after each scan.
+  // endpoints after each scan. Guarded by discovery_mutex_.
   absl::flat_hash_set<std::string> discovered_endpoint_ids_;
 
+  // An endpoint found within the last kDiscoveryCoalescingWindowMillis, not
+  // yet reported to the discoverer.
+  struct PendingEndpointFound {
+    std::string service_id;
+    ByteArray endpoint_info;
+    // The mediums that found it, in order.
+    std::vector<location::nearby::proto::connections::Medium> mediums;
+    // Tells the report scheduled for this endpoint from earlier ones that were
+    // dropped.
+    std::uint64_t generation = 0;
+  };
+  // Maps endpoint_id to the endpoint waiting to be reported. Guarded by
+  // discovery_mutex_.
+  absl::flat_hash_map<std::string, PendingEndpointFound>
+      pending_found_endpoints_;
+  std::uint64_t next_pending_found_generation_ = 0;
+
   // Maps endpoint_id to CancellationFlag. CancellationFlags are passed around
   // as raw pointers to other classes in Nearby Connections, so it is important
   // that objects in this map are not cleared, even if they are cancelled.
+  // Guarded by cancellation_flags_mutex_.
   absl::flat_hash_map<std::string, std::unique_ptr<CancellationFlag>>
       cancellation_flags_;
   // A default cancellation flag with isCancelled set be true.
   std::unique_ptr<CancellationFlag> default_cancellation_flag_ =
       std::make_unique<CancellationFlag>(true);
+  // Guarded by endpoint_stats_mutex_.
+  absl::flat_hash_map<std::string, std::shared_ptr<EndpointStatsRecorder>>
+      endpoint_stats_recorders_;
 
   // An analytics logger with |EventLogger| provided by client, which is default
   // nullptr as no-op.
   std::unique_ptr<analytics::AnalyticsRecorder> analytics_recorder_;
   std::unique_ptr<ErrorCodeRecorder> error_code_recorder_;
+  // Memory buffered for incoming data of this client's endpoints.
+  std::shared_ptr<MemoryAccountant> memory_accountant_;
   // Local device OS information.
   location::nearby::connections::OsInfo local_os_info_;
   // For device providers not owned by Nearby connections (e.g. Nearby
@@ -27,16 +27,19 @@
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/listeners.h"
 #include "connections/strategy.h"
 #include "connections/v3/bandwidth_info.h"
 #include "connections/v3/connections_device_provider.h"
 #include "internal/analytics/event_logger.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/interop/device_provider.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/feature_flags.h"
 #include "internal/platform/medium_environment.h"
+#include "internal/platform/single_thread_executor.h"
 
 namespace nearby {
 namespace connections {
@@ -454,6 +457,28 @@ TEST_F(ClientProxyTest, DumpString) {
   EXPECT_EQ(dump, expect);
 }
 
+TEST_F(ClientProxyTest, DumpSelectsPageOfMatchingEndpoints) {
+  StartDiscovery(&client1_, discovery_listener_);
+  EXPECT_CALL(mock_discovery_.endpoint_found_cb, Call).Times(3);
+  for (const std::string endpoint_id : {"BBBB", "AAAB", "AAAA"}) {
+    client1_.OnEndpointFound(service_id_, endpoint_id, ByteArray{"info"},
+                             medium_);
+  }
+
+  ClientProxy::DiagnosticsSnapshot diagnostics =
+      client1_.GetDiagnosticsSnapshot({
+          .endpoint_id_prefix = "AA",
+          .offset = 1,
+          .max_endpoints = 1,
+      });
+
+  EXPECT_THAT(diagnostics.discovered_endpoint_ids,
+              ::testing::ElementsAre("AAAB"));
+  EXPECT_EQ(diagnostics.matching_discovered_endpoints, 2);
+  EXPECT_THAT(client1_.Dump({.max_endpoints = 2}),
+              ::testing::HasSubstr("    AAAA\n    AAAB\n    (2 of 3 shown)\n"));
+}
+
 TEST_F(ClientProxyTest, GeneratedEndpointIdIsUnique) {
   EXPECT_NE(client1_.GetLocalEndpointId(), client2_.GetLocalEndpointId());
 }
@@ -509,6 +534,49 @@ TEST_F(ClientProxyTest, OnEndpointLostFiresNotificationInDiscovery) {
   OnDiscoveryEndpointLost(&client2_, advertising_endpoint);
 }
 
+TEST_F(ClientProxyTest, OnEndpointFoundCoalescesMediumsWithinWindow) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kDiscoveryCoalescingWindowMillis,
+      100);
+  Endpoint advertising_endpoint =
+      StartAdvertising(&client1_, advertising_connection_listener_);
+  StartDiscovery(&client2_, discovery_listener_);
+  CountDownLatch found(1);
+  EXPECT_CALL(mock_discovery_.endpoint_found_cb,
+              Call(advertising_endpoint.id, advertising_endpoint.info,
+                   service_id_))
+      .WillOnce([&found]() { found.CountDown(); });
+
+  client2_.OnEndpointFound(service_id_, advertising_endpoint.id,
+                           advertising_endpoint.info,
+                           location::nearby::proto::connections::BLUETOOTH);
+  client2_.OnEndpointFound(service_id_, advertising_endpoint.id,
+                           advertising_endpoint.info,
+                           location::nearby::proto::connections::BLE);
+
+  EXPECT_TRUE(found.Await(absl::Seconds(1)).result());
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST_F(ClientProxyTest, OnEndpointLostWithinWindowReportsNothing) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kDiscoveryCoalescingWindowMillis,
+      100);
+  Endpoint advertising_endpoint =
+      StartAdvertising(&client1_, advertising_connection_listener_);
+  StartDiscovery(&client2_, discovery_listener_);
+
+  // The strict mocks fail on any callback.
+  client2_.OnEndpointFound(service_id_, advertising_endpoint.id,
+                           advertising_endpoint.info, medium_);
+  client2_.OnEndpointLost(service_id_, advertising_endpoint.id);
+
+  absl::SleepFor(absl::Milliseconds(300));
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 TEST_F(ClientProxyTest, OnConnectionInitiatedFiresNotificationInDiscovery) {
   Endpoint advertising_endpoint =
       StartAdvertising(&client1_, advertising_connection_listener_);
@@ -598,6 +666,37 @@ TEST_F(ClientProxyTest, OnPayloadProgressChangesState) {
   OnPayloadProgress(&client2_, advertising_endpoint);
 }
 
+TEST_F(ClientProxyTest, OnPayloadProgressDoesNotWaitForDiscoveryCallbacks) {
+  CountDownLatch found_latch(1);
+  CountDownLatch release_latch(1);
+  DiscoveryListener blocking_listener{
+      .endpoint_found_cb =
+          [&](const std::string&, const ByteArray&, const std::string&) {
+            found_latch.CountDown();
+            release_latch.Await();
+          },
+  };
+  Endpoint advertising_endpoint =
+      StartAdvertising(&client1_, advertising_connection_listener_);
+  StartDiscovery(&client2_, blocking_listener);
+  OnDiscoveryConnectionInitiated(&client2_, advertising_endpoint);
+  OnDiscoveryConnectionLocalAccepted(&client2_, advertising_endpoint);
+  OnDiscoveryConnectionRemoteAccepted(&client2_, advertising_endpoint);
+  OnDiscoveryConnectionAccepted(&client2_, advertising_endpoint);
+
+  SingleThreadExecutor discovery_executor;
+  discovery_executor.Execute([&]() {
+    client2_.OnEndpointFound(service_id_, "ABCD", ByteArray{"other endpoint"},
+                             medium_);
+  });
+  EXPECT_TRUE(found_latch.Await().Ok());
+
+  // The discovery callback is still running; payload progress must not block.
+  EXPECT_TRUE(client2_.IsConnectedToEndpoint(advertising_endpoint.id));
+  OnPayloadProgress(&client2_, advertising_endpoint);
+  release_latch.CountDown();
+}
+
 TEST_F(ClientProxyTest,
        EndpointIdCacheWhenHighVizAdvertisementAgainImmediately) {
   BooleanMediumSelector booleanMediumSelector;
@@ -967,6 +1066,17 @@ TEST_F(ClientProxyTest, SetRemoteInfoCorrect) {
             OsInfo::ANDROID);
 }
 
+TEST_F(ClientProxyTest, GetRemoteEndpointInfoCorrect) {
+  Endpoint advertising_endpoint =
+      StartAdvertising(&client1_, advertising_connection_listener_);
+  EXPECT_TRUE(client1_.GetRemoteEndpointInfo(advertising_endpoint.id).Empty());
+
+  OnAdvertisingConnectionInitiated(&client1_, advertising_endpoint);
+
+  EXPECT_EQ(client1_.GetRemoteEndpointInfo(advertising_endpoint.id),
+            advertising_endpoint.info);
+}
+
 // Test ClientProxy::AddCancellationFlag, where if a flag is already in the map,
 // uncancel it. This addresses the case when users use NS to share/receive a
 // file, then cancel in the middle because the wrong file was selected, and then
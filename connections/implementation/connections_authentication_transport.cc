@@ -14,31 +14,103 @@
 
 #include "connections/implementation/connections_authentication_transport.h"
 
+#include <memory>
 #include <string>
+#include <utility>
 
 #include "absl/strings/string_view.h"
 #include "connections/implementation/endpoint_channel.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/logging.h"
+#include "internal/platform/mutex_lock.h"
+#include "internal/platform/single_thread_executor.h"
 
 namespace nearby {
 namespace connections {
 
 ConnectionsAuthenticationTransport::ConnectionsAuthenticationTransport(
-    const EndpointChannel& channel) {
+    const EndpointChannel& channel, bool pipelined)
+    : pipelined_(pipelined) {
   channel_ = const_cast<EndpointChannel*>(&channel);
 }
 
+ConnectionsAuthenticationTransport::~ConnectionsAuthenticationTransport() {
+  std::unique_ptr<SingleThreadExecutor> write_executor;
+  std::unique_ptr<SingleThreadExecutor> read_executor;
+  {
+    MutexLock lock(&mutex_);
+    write_executor = std::move(write_executor_);
+    read_executor = std::move(read_executor_);
+  }
+  // The prefetching tasks lock mutex_, so shut down without holding it.
+  if (write_executor != nullptr) write_executor->Shutdown();
+  if (read_executor != nullptr) read_executor->Shutdown();
+}
+
 void ConnectionsAuthenticationTransport::WriteMessage(
     absl::string_view message) const {
   // channel_ should never be null.
   CHECK(channel_ != nullptr);
-  channel_->Write(ByteArray(message.data(), message.size()));
+  if (!pipelined_) {
+    channel_->Write(ByteArray(message.data(), message.size()));
+    return;
+  }
+  SingleThreadExecutor* executor;
+  {
+    MutexLock lock(&mutex_);
+    executor = GetExecutor(write_executor_);
+  }
+  executor->Execute(
+      [this, data = ByteArray(message.data(), message.size())]() {
+        if (!channel_->Write(data).Ok()) {
+          NEARBY_LOGS(WARNING)
+              << "ConnectionsAuthenticationTransport: queued write failed.";
+        }
+      });
 }
 
 std::string ConnectionsAuthenticationTransport::ReadMessage() const {
   // channel_ should never be null.
   CHECK(channel_ != nullptr);
+  {
+    MutexLock lock(&mutex_);
+    if (prefetch_count_ > 0) {
+      // Reading here would overtake the prefetched messages.
+      while (messages_.empty()) message_read_.Wait();
+      std::string message = std::move(messages_.front());
+      messages_.pop_front();
+      prefetch_count_--;
+      return message;
+    }
+  }
+  return ReadMessageFromChannel();
+}
+
+void ConnectionsAuthenticationTransport::PrefetchMessages(int count) const {
+  if (!pipelined_) return;
+  for (int i = 0; i < count; ++i) {
+    SingleThreadExecutor* executor;
+    {
+      MutexLock lock(&mutex_);
+      prefetch_count_++;
+      executor = GetExecutor(read_executor_);
+    }
+    executor->Execute([this]() {
+      std::string message = ReadMessageFromChannel();
+      MutexLock lock(&mutex_);
+      messages_.push_back(std::move(message));
+      message_read_.Notify();
+    });
+  }
+}
+
+SingleThreadExecutor* ConnectionsAuthenticationTransport::GetExecutor(
+    std::unique_ptr<SingleThreadExecutor>& executor) const {
+  if (executor == nullptr) executor = std::make_unique<SingleThreadExecutor>();
+  return executor.get();
+}
+
+std::string ConnectionsAuthenticationTransport::ReadMessageFromChannel() const {
   auto response = channel_->Read();
   if (response.ok()) {
     return response.result().string_data();
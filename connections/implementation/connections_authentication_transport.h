@@ -15,11 +15,17 @@
 #ifndef THIRD_PARTY_NEARBY_CONNECTIONS_IMPLEMENTATION_CONNECTIONS_AUTHENTICATION_TRANSPORT_H_
 #define THIRD_PARTY_NEARBY_CONNECTIONS_IMPLEMENTATION_CONNECTIONS_AUTHENTICATION_TRANSPORT_H_
 
+#include <deque>
+#include <memory>
 #include <string>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/strings/string_view.h"
 #include "connections/implementation/endpoint_channel.h"
 #include "internal/interop/authentication_transport.h"
+#include "internal/platform/condition_variable.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/single_thread_executor.h"
 
 namespace nearby {
 namespace connections {
@@ -27,15 +33,55 @@ namespace connections {
 // The messages passed through this channel should not be UTF-8 decoded, as they
 // will consist of protobuf-serialized data, and std::string is used as a
 // container for bytes.
+//
+// In pipelined mode, WriteMessage() queues the message and returns right away,
+// so that several messages go out without waiting for the channel, and
+// PrefetchMessages() reads messages ahead on a dedicated thread. On mediums
+// with long round-trips, like BLE, this keeps the channel busy while the
+// authentication protocol computes its next message.
 class ConnectionsAuthenticationTransport
     : public nearby::AuthenticationTransport {
  public:
-  explicit ConnectionsAuthenticationTransport(const EndpointChannel& channel);
+  explicit ConnectionsAuthenticationTransport(const EndpointChannel& channel,
+                                              bool pipelined = false);
+  // Waits for the queued messages to be written and the prefetched ones to be
+  // read.
+  ~ConnectionsAuthenticationTransport() override;
+
   void WriteMessage(absl::string_view message) const override;
+  // Returns the oldest prefetched message, if any were asked for, or reads
+  // one. Empty if reading failed.
   std::string ReadMessage() const override;
 
+  // Starts reading the next |count| messages in pipelined mode, or does
+  // nothing otherwise. Only messages the protocol guarantees the remote
+  // endpoint sends may be prefetched, since the reads block until they come.
+  void PrefetchMessages(int count) const;
+
  private:
+  std::string ReadMessageFromChannel() const;
+  // Returns |executor|, creating it on first use.
+  SingleThreadExecutor* GetExecutor(
+      std::unique_ptr<SingleThreadExecutor>& executor) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   EndpointChannel* channel_;
+  const bool pipelined_;
+
+  mutable Mutex mutex_;
+  mutable ConditionVariable message_read_{&mutex_};
+  // Prefetched messages, in the order they were read.
+  mutable std::deque<std::string> messages_ ABSL_GUARDED_BY(mutex_);
+  // The messages asked for by PrefetchMessages() and not returned yet by
+  // ReadMessage().
+  mutable int prefetch_count_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  // Only created once a pipelined transport writes or prefetches, so that
+  // the other transports start no threads.
+  mutable std::unique_ptr<SingleThreadExecutor> write_executor_
+      ABSL_GUARDED_BY(mutex_);
+  mutable std::unique_ptr<SingleThreadExecutor> read_executor_
+      ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace connections
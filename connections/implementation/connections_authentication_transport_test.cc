@@ -58,6 +58,8 @@ class MockEndpointChannel : public EndpointChannel {
   MOCK_METHOD(int, GetMaxTransmitPacketSize, (), (const override));
   MOCK_METHOD(void, EnableEncryption, (std::shared_ptr<EncryptionContext>),
               (override));
+  MOCK_METHOD(void, EnableAeadEncryption, (std::shared_ptr<AeadFrameCipher>),
+              (override));
   MOCK_METHOD(void, DisableEncryption, (), (override));
   MOCK_METHOD(bool, IsPaused, (), (const override));
   MOCK_METHOD(void, Pause, (), (override));
@@ -105,6 +107,39 @@ TEST(ConnectionsAuthenticationTransportTest, TestReadMessageFail) {
   EXPECT_EQ(transport.ReadMessage(), "");
 }
 
+TEST(ConnectionsAuthenticationTransportTest, TestPipelinedWriteMessages) {
+  MockEndpointChannel channel;
+  EXPECT_CALL(channel, Write(_))
+      .WillRepeatedly([&channel](const ByteArray& data) {
+        channel.messages_.push_back(data.string_data());
+        return Exception{
+            .value = Exception::Value::kSuccess,
+        };
+      });
+  {
+    ConnectionsAuthenticationTransport transport(channel, /*pipelined=*/true);
+    transport.WriteMessage("hello");
+    transport.WriteMessage("world");
+  }
+  EXPECT_THAT(channel.messages_, testing::ElementsAre("hello", "world"));
+}
+
+TEST(ConnectionsAuthenticationTransportTest, TestPrefetchMessages) {
+  MockEndpointChannel channel;
+  ConnectionsAuthenticationTransport transport(channel, /*pipelined=*/true);
+  channel.messages_ = {"hello", "world", "!"};
+  EXPECT_CALL(channel, Read()).WillRepeatedly([&channel]() {
+    std::string ret = channel.messages_[0];
+    channel.messages_.erase(channel.messages_.begin());
+    return ExceptionOr<ByteArray>(ByteArray(ret));
+  });
+  transport.PrefetchMessages(2);
+  EXPECT_EQ(transport.ReadMessage(), "hello");
+  EXPECT_EQ(transport.ReadMessage(), "world");
+  // Read right away once the prefetched messages are used up.
+  EXPECT_EQ(transport.ReadMessage(), "!");
+}
+
 }  // namespace
 }  // namespace connections
 }  // namespace nearby
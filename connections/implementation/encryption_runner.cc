@@ -14,29 +14,55 @@
 
 #include "connections/implementation/encryption_runner.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <utility>
 
+#include "securegcm/d2d_connection_context_v1.h"
 #include "securegcm/ukey2_handshake.h"
 #include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "connections/implementation/offline_frames.h"
+#include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "connections/implementation/session_ticket_store.h"
+#include "internal/crypto/hkdf.h"
+#include "internal/crypto/random.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/base64_utils.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/cancelable_alarm.h"
 #include "internal/platform/logging.h"
+#include "internal/platform/multi_thread_executor.h"
+#include "internal/platform/submittable_executor.h"
+#include "internal/platform/system_clock.h"
 
 namespace nearby {
 namespace connections {
 namespace {
 
+using ::location::nearby::connections::ConnectionResponseFrame;
+using ::location::nearby::connections::OfflineFrame;
+using ::location::nearby::connections::SessionResumptionFrame;
+using ::location::nearby::connections::V1Frame;
+
 constexpr absl::Duration kTimeout = absl::Seconds(15);
 constexpr std::int32_t kMaxUkey2VerificationStringLength = 32;
 constexpr std::int32_t kTokenLength = 5;
 constexpr securegcm::UKey2Handshake::HandshakeCipher kCipher =
     securegcm::UKey2Handshake::HandshakeCipher::P256_SHA512;
+constexpr absl::string_view kResumptionInfo =
+    "NearbyConnectionsSessionResumption";
+constexpr int kResumptionKeyLength = 32;
+// The protocol version leading D2DConnectionContextV1::SaveSession().
+constexpr char kSavedSessionVersion = 1;
 
 // Transforms a raw UKEY2 token (which is a random ByteArray that's
 // kMaxUkey2VerificationStringLength long) into a kTokenLength string that only
@@ -65,6 +91,44 @@ bool HandleEncryptionSuccess(const std::string& endpoint_id,
   return true;
 }
 
+// Derives the connection context of a resumed session. Both sides derive the
+// same keys and auth token from the ticket secret and both nonces; the
+// client's encode key is the server's decode key and vice versa.
+bool HandleResumptionSuccess(const std::string& endpoint_id,
+                             const SessionTicket& ticket,
+                             const ByteArray& client_nonce,
+                             const ByteArray& server_nonce, bool is_client,
+                             const EncryptionRunner::ResultListener& listener) {
+  std::string key_material = crypto::HkdfSha256(
+      ticket.secret.AsStringView(),
+      absl::StrCat(client_nonce.AsStringView(), server_nonce.AsStringView()),
+      kResumptionInfo, 3 * kResumptionKeyLength);
+  absl::string_view client_key =
+      absl::string_view(key_material).substr(0, kResumptionKeyLength);
+  absl::string_view server_key = absl::string_view(key_material)
+                                     .substr(kResumptionKeyLength,
+                                             kResumptionKeyLength);
+
+  // Laid out like D2DConnectionContextV1::SaveSession(): the version, the
+  // encode and decode sequence numbers (4 bytes each, both starting at 0),
+  // then the encode and decode keys.
+  std::string saved_session = absl::StrCat(
+      absl::string_view(&kSavedSessionVersion, 1), std::string(8, '\0'),
+      is_client ? client_key : server_key, is_client ? server_key : client_key);
+  std::unique_ptr<securegcm::D2DConnectionContextV1> context =
+      securegcm::D2DConnectionContextV1::FromSavedSession(saved_session);
+  if (context == nullptr) {
+    return false;
+  }
+
+  ByteArray raw_authentication_token(
+      key_material.substr(2 * kResumptionKeyLength));
+  listener.on_resumed_cb(endpoint_id, std::move(context),
+                         ToHumanReadableString(raw_authentication_token),
+                         raw_authentication_token);
+  return true;
+}
+
 void CancelableAlarmRunnable(ClientProxy* client,
                              const std::string& endpoint_id,
                              EndpointChannel* endpoint_channel) {
@@ -79,18 +143,60 @@ class ServerRunnable final {
  public:
   ServerRunnable(ClientProxy* client, ScheduledExecutor* alarm_executor,
                  const std::string& endpoint_id, EndpointChannel* channel,
-                 EncryptionRunner::ResultListener&& listener)
+                 EncryptionRunner::ResultListener&& listener,
+                 SessionResumption resumption, ByteArray client_init)
       : client_(client),
         alarm_executor_(alarm_executor),
         endpoint_id_(endpoint_id),
         channel_(channel),
-        listener_(std::move(listener)) {}
+        listener_(std::move(listener)),
+        resumption_(std::move(resumption)),
+        client_init_(std::move(client_init)),
+        deadline_(SystemClock::ElapsedRealtime() + kTimeout) {}
 
   void operator()() const {
+    // The timeout also covers the time spent waiting for a handshake thread.
     CancelableAlarm timeout_alarm(
         "EncryptionRunner.StartServer() timeout",
         [this]() { CancelableAlarmRunnable(client_, endpoint_id_, channel_); },
-        kTimeout, alarm_executor_);
+        std::max(deadline_ - SystemClock::ElapsedRealtime(),
+                 absl::ZeroDuration()),
+        alarm_executor_);
+
+    if (resumption_.offered) {
+      // An empty nonce rejects the ticket.
+      ByteArray server_nonce;
+      if (resumption_.ticket.has_value() &&
+          resumption_.client_nonce.size() ==
+              EncryptionRunner::kSessionResumptionNonceLength) {
+        server_nonce = EncryptionRunner::GenerateSessionResumptionNonce();
+      }
+      Exception write_exception =
+          channel_->Write(parser::ForSessionResumption(server_nonce));
+      if (!write_exception.Ok()) {
+        LogException();
+        HandleHandshakeOrIoException(&timeout_alarm);
+        return;
+      }
+
+      if (!server_nonce.Empty()) {
+        NEARBY_LOGS(INFO)
+            << "In StartServer(), resumed session with endpoint(id="
+            << endpoint_id_ << ").";
+        timeout_alarm.Cancel();
+        if (!HandleResumptionSuccess(endpoint_id_, *resumption_.ticket,
+                                     resumption_.client_nonce, server_nonce,
+                                     /* is_client= */ false, listener_)) {
+          LogException();
+          HandleHandshakeOrIoException(&timeout_alarm);
+        }
+        return;
+      }
+
+      NEARBY_LOGS(INFO)
+          << "In StartServer(), rejected session ticket from endpoint(id="
+          << endpoint_id_ << "); falling back to UKEY2.";
+    }
 
     std::unique_ptr<securegcm::UKey2Handshake> server =
         securegcm::UKey2Handshake::ForResponder(kCipher);
@@ -100,8 +206,10 @@ class ServerRunnable final {
       return;
     }
 
-    // Message 1 (Client Init)
-    ExceptionOr<ByteArray> client_init = channel_->Read();
+    // Message 1 (Client Init), unless the ConnectionRequestFrame carried it.
+    ExceptionOr<ByteArray> client_init =
+        client_init_.Empty() ? channel_->Read()
+                             : ExceptionOr<ByteArray>(client_init_);
     if (!client_init.ok()) {
       LogException();
       HandleHandshakeOrIoException(&timeout_alarm);
@@ -211,56 +319,112 @@ class ServerRunnable final {
   const std::string endpoint_id_;
   EndpointChannel* channel_;
   EncryptionRunner::ResultListener listener_;
+  SessionResumption resumption_;
+  ByteArray client_init_;
+  absl::Time deadline_;
 };
 
 class ClientRunnable final {
  public:
   ClientRunnable(ClientProxy* client, ScheduledExecutor* alarm_executor,
                  const std::string& endpoint_id, EndpointChannel* channel,
-                 EncryptionRunner::ResultListener&& listener)
+                 EncryptionRunner::ResultListener&& listener,
+                 SessionResumption resumption, CompactHandshake compact)
       : client_(client),
         alarm_executor_(alarm_executor),
         endpoint_id_(endpoint_id),
         channel_(channel),
-        listener_(std::move(listener)) {}
+        listener_(std::move(listener)),
+        resumption_(std::move(resumption)),
+        compact_(std::move(compact)),
+        deadline_(SystemClock::ElapsedRealtime() + kTimeout) {}
 
   void operator()() const {
+    // The timeout also covers the time spent waiting for a handshake thread.
     CancelableAlarm timeout_alarm(
         "EncryptionRunner.StartClient() timeout",
         [this]() { CancelableAlarmRunnable(client_, endpoint_id_, channel_); },
-        kTimeout, alarm_executor_);
+        std::max(deadline_ - SystemClock::ElapsedRealtime(),
+                 absl::ZeroDuration()),
+        alarm_executor_);
+
+    if (resumption_.offered && resumption_.ticket.has_value()) {
+      // The server answers our session ticket before any UKEY2 message.
+      ExceptionOr<ByteArray> answer = channel_->Read();
+      if (!answer.ok()) {
+        LogException();
+        HandleHandshakeOrIoException(&timeout_alarm);
+        return;
+      }
+      ExceptionOr<OfflineFrame> frame = parser::FromBytes(answer.result());
+      if (!frame.ok() || parser::GetFrameType(frame.result()) !=
+                             V1Frame::SESSION_RESUMPTION) {
+        if (frame.ok()) LogIfBusy(frame.result());
+        LogException();
+        HandleHandshakeOrIoException(&timeout_alarm);
+        return;
+      }
 
-    std::unique_ptr<securegcm::UKey2Handshake> crypto =
-        securegcm::UKey2Handshake::ForInitiator(kCipher);
+      const SessionResumptionFrame& session_resumption =
+          frame.result().v1().session_resumption();
+      if (session_resumption.nonce().size() ==
+          EncryptionRunner::kSessionResumptionNonceLength) {
+        NEARBY_LOGS(INFO)
+            << "In StartClient(), resumed session with endpoint(id="
+            << endpoint_id_ << ").";
+        timeout_alarm.Cancel();
+        if (!HandleResumptionSuccess(endpoint_id_, *resumption_.ticket,
+                                     resumption_.client_nonce,
+                                     ByteArray(session_resumption.nonce()),
+                                     /* is_client= */ true, listener_)) {
+          LogException();
+          HandleHandshakeOrIoException(&timeout_alarm);
+        }
+        return;
+      }
 
-    // Java code throws a HandshakeException.
-    if (crypto == nullptr) {
-      LogException();
-      HandleHandshakeOrIoException(&timeout_alarm);
-      return;
+      NEARBY_LOGS(INFO)
+          << "In StartClient(), endpoint(id=" << endpoint_id_
+          << ") rejected our session ticket; falling back to UKEY2.";
     }
 
-    // Message 1 (Client Init)
-    std::unique_ptr<std::string> client_init =
-        crypto->GetNextHandshakeMessage();
+    std::unique_ptr<securegcm::UKey2Handshake> crypto;
+    if (compact_.ukey2 != nullptr) {
+      // Message 1 (Client Init) went out in the ConnectionRequestFrame.
+      crypto = std::move(compact_.ukey2);
+    } else {
+      crypto = securegcm::UKey2Handshake::ForInitiator(kCipher);
+
+      // Java code throws a HandshakeException.
+      if (crypto == nullptr) {
+        LogException();
+        HandleHandshakeOrIoException(&timeout_alarm);
+        return;
+      }
 
-    // Java code throws a HandshakeException.
-    if (client_init == nullptr) {
-      LogException();
-      HandleHandshakeOrIoException(&timeout_alarm);
-      return;
-    }
+      // Message 1 (Client Init)
+      std::unique_ptr<std::string> client_init =
+          crypto->GetNextHandshakeMessage();
 
-    Exception write_init_exception = channel_->Write(ByteArray(*client_init));
-    if (!write_init_exception.Ok()) {
-      LogException();
-      HandleHandshakeOrIoException(&timeout_alarm);
-      return;
-    }
+      // Java code throws a HandshakeException.
+      if (client_init == nullptr) {
+        LogException();
+        HandleHandshakeOrIoException(&timeout_alarm);
+        return;
+      }
 
-    NEARBY_LOGS(INFO)
-        << "In StartClient(), wrote UKEY2 Message 1 to endpoint(id="
-        << endpoint_id_ << ").";
+      Exception write_init_exception =
+          channel_->Write(ByteArray(*client_init));
+      if (!write_init_exception.Ok()) {
+        LogException();
+        HandleHandshakeOrIoException(&timeout_alarm);
+        return;
+      }
+
+      NEARBY_LOGS(INFO)
+          << "In StartClient(), wrote UKEY2 Message 1 to endpoint(id="
+          << endpoint_id_ << ").";
+    }
 
     // Message 2 (Server Init)
     ExceptionOr<ByteArray> server_init = channel_->Read();
@@ -276,6 +440,12 @@ class ClientRunnable final {
 
     // Java code throws an AlertException or a HandshakeException.
     if (!parse_result.success) {
+      // The server may have been too busy to start the handshake.
+      ExceptionOr<OfflineFrame> frame = parser::FromBytes(server_init.result());
+      if (frame.ok() && LogIfBusy(frame.result())) {
+        HandleHandshakeOrIoException(&timeout_alarm);
+        return;
+      }
       LogException();
       if (parse_result.alert_to_send != nullptr) {
         HandleAlertException(parse_result);
@@ -331,6 +501,20 @@ class ClientRunnable final {
     listener_.on_failure_cb(endpoint_id_, channel_);
   }
 
+  // Returns whether |frame| is the server rejecting the connection, in place
+  // of answering us, because it is too busy. Logs when it asks to retry.
+  bool LogIfBusy(const OfflineFrame& frame) const {
+    if (parser::GetFrameType(frame) != V1Frame::CONNECTION_RESPONSE) {
+      return false;
+    }
+    const ConnectionResponseFrame& response = frame.v1().connection_response();
+    if (!response.has_retry_after_millis()) return false;
+    NEARBY_LOGS(WARNING) << "In StartClient(), endpoint(id=" << endpoint_id_
+                         << ") is too busy to take the connection; retry after "
+                         << response.retry_after_millis() << "ms.";
+    return true;
+  }
+
   void HandleAlertException(
       const securegcm::UKey2Handshake::ParseResult& parse_result) const {
     Exception write_exception =
@@ -348,25 +532,70 @@ class ClientRunnable final {
   const std::string endpoint_id_;
   EndpointChannel* channel_;
   EncryptionRunner::ResultListener listener_;
+  SessionResumption resumption_;
+  // Moved from once run.
+  mutable CompactHandshake compact_;
+  absl::Time deadline_;
 };
 
 }  // namespace
 
+EncryptionRunner::EncryptionRunner() {
+  std::int64_t handshake_threads = NearbyFlags::GetInstance().GetInt64Flag(
+      config_package_nearby::nearby_connections_feature::
+          kEncryptionHandshakeThreads);
+  if (handshake_threads > 1) {
+    handshake_pool_ = std::make_unique<MultiThreadExecutor>(handshake_threads);
+  }
+}
+
 EncryptionRunner::~EncryptionRunner() {
   // Stop all the ongoing Runnables (as gracefully as possible).
+  if (handshake_pool_) handshake_pool_->Shutdown();
   client_executor_.Shutdown();
   server_executor_.Shutdown();
   alarm_executor_.Shutdown();
 }
 
+SubmittableExecutor* EncryptionRunner::GetServerExecutor() {
+  if (handshake_pool_) return handshake_pool_.get();
+  return &server_executor_;
+}
+
+SubmittableExecutor* EncryptionRunner::GetClientExecutor() {
+  if (handshake_pool_) return handshake_pool_.get();
+  return &client_executor_;
+}
+
+ByteArray EncryptionRunner::GenerateSessionResumptionNonce() {
+  std::string nonce(kSessionResumptionNonceLength, '\0');
+  crypto::RandBytes(nonce.data(), nonce.size());
+  return ByteArray(std::move(nonce));
+}
+
+CompactHandshake EncryptionRunner::StartCompactHandshake() {
+  CompactHandshake compact;
+  std::unique_ptr<securegcm::UKey2Handshake> ukey2 =
+      securegcm::UKey2Handshake::ForInitiator(kCipher);
+  if (ukey2 == nullptr) return compact;
+  std::unique_ptr<std::string> client_init = ukey2->GetNextHandshakeMessage();
+  if (client_init == nullptr) return compact;
+  compact.ukey2 = std::move(ukey2);
+  compact.client_init = ByteArray(std::move(*client_init));
+  return compact;
+}
+
 void EncryptionRunner::StartServer(
     ClientProxy* client, const std::string& endpoint_id,
     EndpointChannel* endpoint_channel,
-    EncryptionRunner::ResultListener&& listener) {
-  server_executor_.Execute(
+    EncryptionRunner::ResultListener&& listener,
+    SessionResumption resumption, ByteArray client_init) {
+  GetServerExecutor()->Execute(
       "encryption-server",
       [runnable{ServerRunnable(client, &alarm_executor_, endpoint_id,
-                               endpoint_channel, std::move(listener))}]() {
+                               endpoint_channel, std::move(listener),
+                               std::move(resumption),
+                               std::move(client_init))}]() {
         runnable();
       });
 }
@@ -374,11 +603,14 @@ void EncryptionRunner::StartServer(
 void EncryptionRunner::StartClient(
     ClientProxy* client, const std::string& endpoint_id,
     EndpointChannel* endpoint_channel,
-    EncryptionRunner::ResultListener&& listener) {
-  client_executor_.Execute(
+    EncryptionRunner::ResultListener&& listener,
+    SessionResumption resumption, CompactHandshake compact) {
+  GetClientExecutor()->Execute(
       "encryption-client",
       [runnable{ClientRunnable(client, &alarm_executor_, endpoint_id,
-                               endpoint_channel, std::move(listener))}]() {
+                               endpoint_channel, std::move(listener),
+                               std::move(resumption),
+                               std::move(compact))}]() {
         runnable();
       });
 }
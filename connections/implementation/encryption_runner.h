@@ -15,27 +15,64 @@
 #ifndef CORE_INTERNAL_ENCRYPTION_RUNNER_H_
 #define CORE_INTERNAL_ENCRYPTION_RUNNER_H_
 
+#include <memory>
+#include <optional>
 #include <string>
 
+#include "securegcm/d2d_connection_context_v1.h"
 #include "securegcm/ukey2_handshake.h"
 #include "connections/implementation/client_proxy.h"
 #include "connections/implementation/endpoint_channel.h"
+#include "connections/implementation/session_ticket_store.h"
 #include "connections/listeners.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/multi_thread_executor.h"
 #include "internal/platform/scheduled_executor.h"
 #include "internal/platform/single_thread_executor.h"
+#include "internal/platform/submittable_executor.h"
 
 namespace nearby {
 namespace connections {
 
+// What the ConnectionRequestFrame said about resuming a session.
+struct SessionResumption {
+  // Whether the ConnectionRequestFrame carried a session ticket id. If so,
+  // the server must answer it before UKEY2 can begin.
+  bool offered = false;
+  // The client's ticket, or on the server, the ticket the id was found for.
+  // Unset on the server if the ticket is unknown or expired.
+  std::optional<SessionTicket> ticket;
+  // The nonce the client sent in the ConnectionRequestFrame.
+  ByteArray client_nonce;
+};
+
+// A UKEY2 handshake whose ClientInit the client sent in the
+// ConnectionRequestFrame, in place of its own message.
+struct CompactHandshake {
+  // The handshake that produced |client_init|.
+  std::unique_ptr<securegcm::UKey2Handshake> ukey2;
+  ByteArray client_init;
+};
+
 // Encrypts a connection over UKEY2.
 //
-// NOTE: Stalled EndpointChannels will be disconnected after kTimeout.
-// This is to prevent unverified endpoints from maintaining an
-// indefinite connection to us.
+// A connection can instead be resumed from the session ticket of an earlier
+// one, if the ConnectionRequestFrame carried one. The server then answers with
+// a SessionResumptionFrame. If it accepts the ticket, both sides derive the
+// keys of the connection from the ticket secret and a fresh nonce from each
+// side, skipping UKEY2. Otherwise, the full UKEY2 handshake follows.
+//
+// Or, if the ConnectionRequestFrame carried the UKEY2 ClientInit, the server
+// answers it with the ServerInit right away, and the client doesn't send it
+// again.
+//
+// NOTE: Stalled EndpointChannels will be disconnected after kTimeout, counted
+// from the moment the handshake was started, including any time spent waiting
+// for a free handshake thread. This is to prevent unverified endpoints from
+// maintaining an indefinite connection to us.
 class EncryptionRunner {
  public:
-  EncryptionRunner() = default;
+  EncryptionRunner();
   ~EncryptionRunner();
 
   struct ResultListener {
@@ -48,6 +85,18 @@ class EncryptionRunner {
                            std::unique_ptr<securegcm::UKey2Handshake>,
                            const std::string&, const ByteArray&) {};
 
+    // The connection was resumed from a session ticket, without UKEY2.
+    //
+    // @EncryptionRunnerThread
+    std::function<void(
+        const std::string& endpoint_id,
+        std::unique_ptr<securegcm::D2DConnectionContextV1> context,
+        const std::string& auth_token, const ByteArray& raw_auth_token)>
+        on_resumed_cb =
+            [](const std::string&,
+               std::unique_ptr<securegcm::D2DConnectionContextV1>,
+               const std::string&, const ByteArray&) {};
+
     // Encryption has failed. The remote_endpoint_id and channel are given so
     // that any pending state can be cleaned up.
     //
@@ -62,19 +111,43 @@ class EncryptionRunner {
         on_failure_cb = [](const std::string&, EndpointChannel*) {};
   };
 
+  static constexpr int kSessionResumptionNonceLength = 32;
+
+  // Returns a random nonce for a SessionResumption.
+  static ByteArray GenerateSessionResumptionNonce();
+
+  // Starts a UKEY2 handshake to send the ClientInit of in the
+  // ConnectionRequestFrame. Its |ukey2| is null on failure.
+  static CompactHandshake StartCompactHandshake();
+
+  // |client_init| is the ClientInit the ConnectionRequestFrame carried, if
+  // any.
+  //
   // @AnyThread
   void StartServer(ClientProxy* client, const std::string& endpoint_id,
                    EndpointChannel* endpoint_channel,
-                   ResultListener&& result_listener);
+                   ResultListener&& result_listener,
+                   SessionResumption resumption = {},
+                   ByteArray client_init = {});
+  // |compact| is set if its ClientInit was sent in the ConnectionRequestFrame.
+  //
   // @AnyThread
   void StartClient(ClientProxy* client, const std::string& endpoint_id,
                    EndpointChannel* endpoint_channel,
-                   ResultListener&& result_listener);
+                   ResultListener&& result_listener,
+                   SessionResumption resumption = {},
+                   CompactHandshake compact = {});
 
  private:
+  SubmittableExecutor* GetServerExecutor();
+  SubmittableExecutor* GetClientExecutor();
+
   ScheduledExecutor alarm_executor_;
   SingleThreadExecutor server_executor_;
   SingleThreadExecutor client_executor_;
+  // Shared by incoming and outgoing handshakes in place of the executors
+  // above, if more than one handshake thread is configured.
+  std::unique_ptr<MultiThreadExecutor> handshake_pool_;
 };
 
 }  // namespace connections
@@ -14,12 +14,20 @@
 
 #include "connections/implementation/encryption_runner.h"
 
+#include <memory>
+#include <string>
+#include <utility>
+
 #include "gmock/gmock.h"
 #include "protobuf-matchers/protocol-buffer-matchers.h"
 #include "gtest/gtest.h"
 #include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "connections/implementation/client_proxy.h"
 #include "connections/implementation/endpoint_channel.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "connections/implementation/session_ticket_store.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/pipe.h"
@@ -81,6 +89,7 @@ class FakeEndpointChannel : public EndpointChannel {
   Medium GetMedium() const override { return Medium::BLE; }
   int GetMaxTransmitPacketSize() const override { return 512; }
   void EnableEncryption(std::shared_ptr<EncryptionContext> context) override {}
+  void EnableAeadEncryption(std::shared_ptr<AeadFrameCipher> cipher) override {}
   void DisableEncryption() override {}
   bool IsPaused() const override { return false; }
   void Pause() override {}
@@ -168,6 +177,256 @@ TEST(EncryptionRunnerTest, ReadWrite) {
   EXPECT_EQ(response.client_status, Response::Status::kDone);
 }
 
+TEST(EncryptionRunnerTest, CompactHandshake) {
+  Pipe from_a_to_b;
+  Pipe from_b_to_a;
+  User user_a(/*reader=*/&from_b_to_a, /*writer=*/&from_a_to_b);
+  User user_b(/*reader=*/&from_a_to_b, /*writer=*/&from_b_to_a);
+  Response response;
+  std::string server_auth_token;
+  std::string client_auth_token;
+
+  // The ClientInit travels in the ConnectionRequestFrame instead of the pipe.
+  CompactHandshake compact = EncryptionRunner::StartCompactHandshake();
+  ASSERT_NE(compact.ukey2, nullptr);
+  ByteArray client_init = compact.client_init;
+
+  user_a.crypto.StartServer(
+      &user_a.client, "endpoint_id", &user_a.channel,
+      {
+          .on_success_cb =
+              [&response, &server_auth_token](
+                  const std::string& endpoint_id,
+                  std::unique_ptr<securegcm::UKey2Handshake> ukey2,
+                  const std::string& auth_token,
+                  const ByteArray& raw_auth_token) {
+                server_auth_token = auth_token;
+                response.server_status = Response::Status::kDone;
+                response.latch.CountDown();
+              },
+          .on_failure_cb =
+              [&response](const std::string& endpoint_id,
+                          EndpointChannel* channel) {
+                response.server_status = Response::Status::kFailed;
+                response.latch.CountDown();
+              },
+      },
+      /*resumption=*/{}, client_init);
+  user_b.crypto.StartClient(
+      &user_b.client, "endpoint_id", &user_b.channel,
+      {
+          .on_success_cb =
+              [&response, &client_auth_token](
+                  const std::string& endpoint_id,
+                  std::unique_ptr<securegcm::UKey2Handshake> ukey2,
+                  const std::string& auth_token,
+                  const ByteArray& raw_auth_token) {
+                client_auth_token = auth_token;
+                response.client_status = Response::Status::kDone;
+                response.latch.CountDown();
+              },
+          .on_failure_cb =
+              [&response](const std::string& endpoint_id,
+                          EndpointChannel* channel) {
+                response.client_status = Response::Status::kFailed;
+                response.latch.CountDown();
+              },
+      },
+      /*resumption=*/{}, std::move(compact));
+  EXPECT_TRUE(response.latch.Await(absl::Milliseconds(5000)).result());
+  EXPECT_EQ(response.server_status, Response::Status::kDone);
+  EXPECT_EQ(response.client_status, Response::Status::kDone);
+  EXPECT_EQ(server_auth_token, client_auth_token);
+}
+
+TEST(EncryptionRunnerTest, ResumesFromSessionTicket) {
+  Pipe from_a_to_b;
+  Pipe from_b_to_a;
+  User user_a(/*reader=*/&from_b_to_a, /*writer=*/&from_a_to_b);
+  User user_b(/*reader=*/&from_a_to_b, /*writer=*/&from_b_to_a);
+  Response response;
+  SessionTicket ticket =
+      DeriveSessionTicket("session unique", absl::InfiniteFuture());
+  ByteArray client_nonce = EncryptionRunner::GenerateSessionResumptionNonce();
+  std::unique_ptr<securegcm::D2DConnectionContextV1> server_context;
+  std::unique_ptr<securegcm::D2DConnectionContextV1> client_context;
+  std::string server_auth_token;
+  std::string client_auth_token;
+
+  user_a.crypto.StartServer(
+      &user_a.client, "endpoint_id", &user_a.channel,
+      {
+          .on_resumed_cb =
+              [&](const std::string& endpoint_id,
+                  std::unique_ptr<securegcm::D2DConnectionContextV1> context,
+                  const std::string& auth_token,
+                  const ByteArray& raw_auth_token) {
+                server_context = std::move(context);
+                server_auth_token = auth_token;
+                response.server_status = Response::Status::kDone;
+                response.latch.CountDown();
+              },
+          .on_failure_cb =
+              [&response](const std::string& endpoint_id,
+                          EndpointChannel* channel) {
+                response.server_status = Response::Status::kFailed;
+                response.latch.CountDown();
+              },
+      },
+      {.offered = true, .ticket = ticket, .client_nonce = client_nonce});
+  user_b.crypto.StartClient(
+      &user_b.client, "endpoint_id", &user_b.channel,
+      {
+          .on_resumed_cb =
+              [&](const std::string& endpoint_id,
+                  std::unique_ptr<securegcm::D2DConnectionContextV1> context,
+                  const std::string& auth_token,
+                  const ByteArray& raw_auth_token) {
+                client_context = std::move(context);
+                client_auth_token = auth_token;
+                response.client_status = Response::Status::kDone;
+                response.latch.CountDown();
+              },
+          .on_failure_cb =
+              [&response](const std::string& endpoint_id,
+                          EndpointChannel* channel) {
+                response.client_status = Response::Status::kFailed;
+                response.latch.CountDown();
+              },
+      },
+      {.offered = true, .ticket = ticket, .client_nonce = client_nonce});
+  EXPECT_TRUE(response.latch.Await(absl::Milliseconds(5000)).result());
+  ASSERT_EQ(response.server_status, Response::Status::kDone);
+  ASSERT_EQ(response.client_status, Response::Status::kDone);
+  EXPECT_EQ(server_auth_token, client_auth_token);
+
+  std::unique_ptr<std::string> encoded =
+      client_context->EncodeMessageToPeer("message");
+  ASSERT_NE(encoded, nullptr);
+  std::unique_ptr<std::string> decoded =
+      server_context->DecodeMessageFromPeer(*encoded);
+  ASSERT_NE(decoded, nullptr);
+  EXPECT_EQ(*decoded, "message");
+}
+
+TEST(EncryptionRunnerTest, RejectedSessionTicketFallsBackToUkey2) {
+  Pipe from_a_to_b;
+  Pipe from_b_to_a;
+  User user_a(/*reader=*/&from_b_to_a, /*writer=*/&from_a_to_b);
+  User user_b(/*reader=*/&from_a_to_b, /*writer=*/&from_b_to_a);
+  Response response;
+  SessionTicket ticket =
+      DeriveSessionTicket("session unique", absl::InfiniteFuture());
+
+  // The server no longer has the ticket the client offers.
+  user_a.crypto.StartServer(
+      &user_a.client, "endpoint_id", &user_a.channel,
+      {
+          .on_success_cb =
+              [&response](const std::string& endpoint_id,
+                          std::unique_ptr<securegcm::UKey2Handshake> ukey2,
+                          const std::string& auth_token,
+                          const ByteArray& raw_auth_token) {
+                response.server_status = Response::Status::kDone;
+                response.latch.CountDown();
+              },
+          .on_failure_cb =
+              [&response](const std::string& endpoint_id,
+                          EndpointChannel* channel) {
+                response.server_status = Response::Status::kFailed;
+                response.latch.CountDown();
+              },
+      },
+      {.offered = true,
+       .client_nonce = EncryptionRunner::GenerateSessionResumptionNonce()});
+  user_b.crypto.StartClient(
+      &user_b.client, "endpoint_id", &user_b.channel,
+      {
+          .on_success_cb =
+              [&response](const std::string& endpoint_id,
+                          std::unique_ptr<securegcm::UKey2Handshake> ukey2,
+                          const std::string& auth_token,
+                          const ByteArray& raw_auth_token) {
+                response.client_status = Response::Status::kDone;
+                response.latch.CountDown();
+              },
+          .on_failure_cb =
+              [&response](const std::string& endpoint_id,
+                          EndpointChannel* channel) {
+                response.client_status = Response::Status::kFailed;
+                response.latch.CountDown();
+              },
+      },
+      {.offered = true,
+       .ticket = ticket,
+       .client_nonce = EncryptionRunner::GenerateSessionResumptionNonce()});
+  EXPECT_TRUE(response.latch.Await(absl::Milliseconds(5000)).result());
+  EXPECT_EQ(response.server_status, Response::Status::kDone);
+  EXPECT_EQ(response.client_status, Response::Status::kDone);
+}
+
+TEST(EncryptionRunnerTest, StalledHandshakeDoesNotBlockOthersInHandshakePool) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEncryptionHandshakeThreads,
+      2);
+  // Nothing is ever written to the stalled channel.
+  Pipe stalled_in;
+  Pipe stalled_out;
+  FakeEndpointChannel stalled_channel(&stalled_in.GetInputStream(),
+                                      &stalled_out.GetOutputStream());
+  Pipe from_a_to_b;
+  Pipe from_b_to_a;
+  User user_a(/*reader=*/&from_b_to_a, /*writer=*/&from_a_to_b);
+  User user_b(/*reader=*/&from_a_to_b, /*writer=*/&from_b_to_a);
+  Response response;
+
+  user_a.crypto.StartServer(&user_a.client, "stalled_endpoint_id",
+                            &stalled_channel, {});
+  user_a.crypto.StartServer(
+      &user_a.client, "endpoint_id", &user_a.channel,
+      {
+          .on_success_cb =
+              [&response](const std::string& endpoint_id,
+                          std::unique_ptr<securegcm::UKey2Handshake> ukey2,
+                          const std::string& auth_token,
+                          const ByteArray& raw_auth_token) {
+                response.server_status = Response::Status::kDone;
+                response.latch.CountDown();
+              },
+          .on_failure_cb =
+              [&response](const std::string& endpoint_id,
+                          EndpointChannel* channel) {
+                response.server_status = Response::Status::kFailed;
+                response.latch.CountDown();
+              },
+      });
+  user_b.crypto.StartClient(
+      &user_b.client, "endpoint_id", &user_b.channel,
+      {
+          .on_success_cb =
+              [&response](const std::string& endpoint_id,
+                          std::unique_ptr<securegcm::UKey2Handshake> ukey2,
+                          const std::string& auth_token,
+                          const ByteArray& raw_auth_token) {
+                response.client_status = Response::Status::kDone;
+                response.latch.CountDown();
+              },
+          .on_failure_cb =
+              [&response](const std::string& endpoint_id,
+                          EndpointChannel* channel) {
+                response.client_status = Response::Status::kFailed;
+                response.latch.CountDown();
+              },
+      });
+  EXPECT_TRUE(response.latch.Await(absl::Milliseconds(5000)).result());
+  EXPECT_EQ(response.server_status, Response::Status::kDone);
+  EXPECT_EQ(response.client_status, Response::Status::kDone);
+
+  stalled_channel.Close();
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 }  // namespace
 }  // namespace connections
 }  // namespace nearby
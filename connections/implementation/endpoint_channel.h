@@ -16,13 +16,20 @@
 #define CORE_INTERNAL_ENDPOINT_CHANNEL_H_
 
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "securegcm/d2d_connection_context_v1.h"
+#include "connections/implementation/aead_frame_cipher.h"
 #include "connections/implementation/analytics/analytics_recorder.h"
 #include "connections/implementation/analytics/packet_meta_data.h"
+#include "connections/implementation/endpoint_stats.h"
+#include "internal/platform/async_stream.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/exception.h"
+#include "internal/platform/future.h"
+#include "internal/platform/implementation/executor.h"
 #include "internal/platform/mutex.h"
 
 namespace nearby {
@@ -30,6 +37,16 @@ namespace connections {
 
 using analytics::PacketMetaData;
 
+// The scheduling class of an outgoing frame. When several threads write to the
+// same channel, higher priority frames (lower values) are written first.
+enum class WritePriority {
+  // Keep-alives, bandwidth upgrade frames and payload control messages.
+  kControl = 0,
+  kBytesPayload = 1,
+  kStreamPayload = 2,
+  kFilePayload = 3,
+};
+
 class EndpointChannel {
  public:
   virtual ~EndpointChannel() = default;
@@ -46,6 +63,51 @@ class EndpointChannel {
   virtual Exception Write(
       const ByteArray& data,
       PacketMetaData& packet_meta_data) = 0;  // throws Exception::IO
+
+  // Writes with the given scheduling class. Channels that don't schedule
+  // writes ignore |priority|.
+  virtual Exception Write(const ByteArray& data,
+                          PacketMetaData& packet_meta_data,
+                          WritePriority priority) {  // throws Exception::IO
+    return Write(data, packet_meta_data);
+  }
+
+  // Writes |frames| back to back, like consecutive Write() calls would, but
+  // lets the channel encrypt and flush them in one go. Stops at the first
+  // frame that fails to write.
+  virtual Exception WriteFrames(const std::vector<ByteArray>& frames,
+                                PacketMetaData& packet_meta_data,
+                                WritePriority priority) {  // throws Exception::IO
+    for (const ByteArray& frame : frames) {
+      Exception exception = Write(frame, packet_meta_data, priority);
+      if (!exception.Ok()) return exception;
+    }
+    return {Exception::kSuccess};
+  }
+
+  // Non-blocking Read(). The default runs the blocking Read() on `executor`;
+  // channels over natively asynchronous transports can do better. The channel
+  // and `executor` must outlive the read.
+  virtual Future<ByteArray> ReadAsync(api::Executor* executor) {
+    Future<ByteArray> future;
+    executor->Execute(
+        [this, future]() mutable { SetFutureFrom(future, Read()); });
+    return future;
+  }
+
+  // Non-blocking Write(), with the same defaults and lifetime rules as
+  // ReadAsync().
+  virtual Future<bool> WriteAsync(const ByteArray& data,
+                                  WritePriority priority,
+                                  api::Executor* executor) {
+    Future<bool> future;
+    executor->Execute([this, data, priority, future]() mutable {
+      PacketMetaData packet_meta_data;
+      SetFutureFrom(future, Write(data, packet_meta_data, priority));
+    });
+    return future;
+  }
+
   // Closes this EndpointChannel, without tracking the closure in analytics.
 
   virtual void Close() = 0;
@@ -88,6 +150,12 @@ class EndpointChannel {
   // Enables encryption on the EndpointChannel.
   virtual void EnableEncryption(std::shared_ptr<EncryptionContext> context) = 0;
 
+  // Enables encryption on the EndpointChannel with the lighter AES-GCM frame
+  // format, in place of |EncryptionContext|'s SecureMessage envelopes. Only
+  // used if both endpoints announced support for it.
+  virtual void EnableAeadEncryption(
+      std::shared_ptr<AeadFrameCipher> cipher) = 0;
+
   // Disables encryption on the EndpointChannel.
   virtual void DisableEncryption() = 0;
 
@@ -113,6 +181,11 @@ class EndpointChannel {
   virtual void SetAnalyticsRecorder(
       analytics::AnalyticsRecorder* analytics_recorder,
       const std::string& endpoint_id) = 0;
+
+  // Sets where this EndpointChannel records the frames it reads and writes.
+  // Channels that don't keep statistics ignore it.
+  virtual void SetStatsRecorder(
+      std::shared_ptr<EndpointStatsRecorder> stats_recorder) {}
 };
 
 inline bool operator==(const EndpointChannel& lhs, const EndpointChannel& rhs) {
@@ -68,11 +68,12 @@ void EndpointChannelManager::ReplaceChannelForEndpoint(
 
 bool EndpointChannelManager::EncryptChannelForEndpoint(
     const std::string& endpoint_id,
-    std::unique_ptr<EncryptionContext> context) {
+    std::unique_ptr<EncryptionContext> context,
+    std::unique_ptr<AeadFrameCipher> aead_cipher) {
   MutexLock lock(&mutex_);
 
-  channel_state_.UpdateEncryptionContextForEndpoint(endpoint_id,
-                                                    std::move(context));
+  channel_state_.UpdateEncryptionContextForEndpoint(
+      endpoint_id, std::move(context), std::move(aead_cipher));
   auto* endpoint = channel_state_.LookupEndpointData(endpoint_id);
   return channel_state_.EncryptChannel(endpoint);
 }
@@ -96,6 +97,7 @@ void EndpointChannelManager::SetActiveEndpointChannel(
   // Update the channel first, then encrypt this new channel, if
   // crypto context is present.
   channel->SetAnalyticsRecorder(&client->GetAnalyticsRecorder(), endpoint_id);
+  channel->SetStatsRecorder(client->GetEndpointStatsRecorder(endpoint_id));
   channel_state_.UpdateChannelForEndpoint(endpoint_id, std::move(channel));
 
   auto* endpoint = channel_state_.LookupEndpointData(endpoint_id);
@@ -120,7 +122,11 @@ bool EndpointChannelManager::ChannelState::EncryptChannel(
     EndpointChannelManager::ChannelState::EndpointData* endpoint) {
   if (endpoint != nullptr && endpoint->channel != nullptr &&
       endpoint->context != nullptr) {
-    endpoint->channel->EnableEncryption(endpoint->context);
+    if (endpoint->aead_cipher != nullptr) {
+      endpoint->channel->EnableAeadEncryption(endpoint->aead_cipher);
+    } else {
+      endpoint->channel->EnableEncryption(endpoint->context);
+    }
     return true;
   }
   return false;
@@ -141,9 +147,12 @@ void EndpointChannelManager::ChannelState::UpdateChannelForEndpoint(
 
 void EndpointChannelManager::ChannelState::UpdateEncryptionContextForEndpoint(
     const std::string& endpoint_id,
-    std::unique_ptr<EncryptionContext> context) {
+    std::unique_ptr<EncryptionContext> context,
+    std::unique_ptr<AeadFrameCipher> aead_cipher) {
   // Create EndpointData instance, if necessary, and populate crypto context.
-  endpoints_[endpoint_id].context = std::move(context);
+  EndpointData& endpoint = endpoints_[endpoint_id];
+  endpoint.context = std::move(context);
+  endpoint.aead_cipher = std::move(aead_cipher);
 }
 
 bool EndpointChannelManager::ChannelState::RemoveEndpoint(
@@ -20,6 +20,7 @@
 
 #include "securegcm/d2d_connection_context_v1.h"
 #include "absl/container/flat_hash_map.h"
+#include "connections/implementation/aead_frame_cipher.h"
 #include "connections/implementation/client_proxy.h"
 #include "connections/implementation/endpoint_channel.h"
 #include "internal/platform/mutex.h"
@@ -64,8 +65,13 @@ class EndpointChannelManager final {
                                  bool enable_encryption)
       ABSL_LOCKS_EXCLUDED(mutex_);
 
-  bool EncryptChannelForEndpoint(const std::string& endpoint_id,
-                                 std::unique_ptr<EncryptionContext> context)
+  // Encrypts the endpoint's channel, and the channels that replace it, with
+  // |context|. If |aead_cipher| is given, frames are encrypted with it
+  // instead.
+  bool EncryptChannelForEndpoint(
+      const std::string& endpoint_id,
+      std::unique_ptr<EncryptionContext> context,
+      std::unique_ptr<AeadFrameCipher> aead_cipher = nullptr)
       ABSL_LOCKS_EXCLUDED(mutex_);
 
   // NOTE(shared_ptr<> usage):
@@ -119,6 +125,8 @@ class EndpointChannelManager final {
 
       std::shared_ptr<EndpointChannel> channel;
       std::shared_ptr<EncryptionContext> context;
+      // Used in place of |context| to encrypt frames, if set.
+      std::shared_ptr<AeadFrameCipher> aead_cipher;
       location::nearby::proto::connections::DisconnectionReason
           disconnect_reason = location::nearby::proto::connections::
               DisconnectionReason::UNKNOWN_DISCONNECTION_REASON;
@@ -143,7 +151,8 @@ class EndpointChannelManager final {
     // Prevoius one is destroyed, if it existed.
     void UpdateEncryptionContextForEndpoint(
         const std::string& endpoint_id,
-        std::unique_ptr<EncryptionContext> context);
+        std::unique_ptr<EncryptionContext> context,
+        std::unique_ptr<AeadFrameCipher> aead_cipher);
 
     // Removes all knowledge of this endpoint, cleaning up as necessary.
     // Returns false if the endpoint was not found.
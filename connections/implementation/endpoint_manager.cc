@@ -21,16 +21,24 @@
 #include <utility>
 #include <vector>
 
+#include "google/protobuf/arena.h"
 #include "connections/implementation/analytics/throughput_recorder.h"
 #include "connections/implementation/endpoint_channel.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "connections/implementation/frame_trace.h"
+#include "connections/implementation/memory_accountant.h"
 #include "connections/implementation/offline_frames.h"
 #include "connections/implementation/payload_manager.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
 #include "connections/implementation/service_id_constants.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/exception.h"
+#include "internal/platform/future.h"
 #include "internal/platform/logging.h"
 #include "internal/platform/mutex_lock.h"
+#include "internal/platform/system_clock.h"
+#include "internal/platform/tracing.h"
 
 namespace nearby {
 namespace connections {
@@ -42,6 +50,40 @@ using ::nearby::connections::PayloadDirection;
 
 constexpr absl::Duration EndpointManager::kProcessEndpointDisconnectionTimeout;
 constexpr absl::Time EndpointManager::kInvalidTimestamp;
+constexpr int EndpointManager::kMaxParallelFanOutWrites;
+constexpr size_t EndpointManager::kFrameArenaBlockSize;
+
+namespace {
+
+// Bulk payload types yield to the more latency-sensitive ones.
+WritePriority GetWritePriority(
+    PayloadTransferFrame::PayloadHeader::PayloadType payload_type) {
+  switch (payload_type) {
+    case PayloadTransferFrame::PayloadHeader::BYTES:
+      return WritePriority::kBytesPayload;
+    case PayloadTransferFrame::PayloadHeader::STREAM:
+      return WritePriority::kStreamPayload;
+    default:
+      return WritePriority::kFilePayload;
+  }
+}
+
+bool IsFrameTraceCaptureEnabled() {
+  return NearbyFlags::GetInstance().GetBoolFlag(
+      config_package_nearby::nearby_connections_feature::
+          kEnableFrameTraceCapture);
+}
+
+void RecordFrame(FrameTrace::Direction direction,
+                 const std::string& endpoint_id,
+                 location::nearby::proto::connections::Medium medium,
+                 const ByteArray& frame) {
+  FrameTraceRecorder::GetInstance().Record(
+      direction, endpoint_id, medium, parser::PeekFrameType(frame),
+      frame.size(), SystemClock::ElapsedRealtime());
+}
+
+}  // namespace
 
 class EndpointManager::LockedFrameProcessor {
  public:
@@ -176,7 +218,26 @@ ExceptionOr<bool> EndpointManager::HandleData(
   // super class will loop back around and try our luck in case there's been
   // a replacement for this endpoint since we last checked with the
   // EndpointChannelManager.
+  //
+  // Every frame is parsed into the same arena, which is reset before the next
+  // one, so frames don't allocate their message trees on the heap.
+  std::vector<char> arena_block(kFrameArenaBlockSize);
+  google::protobuf::Arena arena(arena_block.data(), arena_block.size());
+  // With lazy dispatch, the frame type is peeked from the raw bytes first, and
+  // only frames that have a registered processor are parsed and validated.
+  const bool lazy_frame_dispatch = NearbyFlags::GetInstance().GetBoolFlag(
+      config_package_nearby::nearby_connections_feature::
+          kEnableLazyFrameDispatch);
+  const bool capture_frame_trace = IsFrameTraceCaptureEnabled();
+  // Holds the size of the frame being processed. Waiting for the endpoint to
+  // drop below its memory cap before processing a frame is what holds back
+  // further reads while the client falls behind.
+  std::unique_ptr<MemoryAccountant::Reservation> frame_reservation =
+      client->GetMemoryAccountant().Reserve(
+          endpoint_id, MemoryAccountant::Category::kIncomingFrame);
   while (true) {
+    arena.Reset();
+    frame_reservation->Remove(frame_reservation->GetBytes());
     PacketMetaData packet_meta_data;
     ExceptionOr<ByteArray> bytes = endpoint_channel->Read(packet_meta_data);
     if (!bytes.ok()) {
@@ -184,7 +245,29 @@ ExceptionOr<bool> EndpointManager::HandleData(
                  bytes.exception());
       return ExceptionOr<bool>(bytes.exception());
     }
-    ExceptionOr<OfflineFrame> wrapped_frame = parser::FromBytes(bytes.result());
+    if (capture_frame_trace) {
+      RecordFrame(FrameTrace::Direction::kIncoming, endpoint_id,
+                  endpoint_channel->GetMedium(), bytes.result());
+    }
+    if (!frame_reservation->AddWhenBelowCap(bytes.result().size())) {
+      NEARBY_LOGS(INFO) << "Stop reading, endpoint " << endpoint_id
+                        << " was released while over its memory cap.";
+      return ExceptionOr<bool>(Exception::kInterrupted);
+    }
+
+    V1Frame::FrameType frame_type = V1Frame::UNKNOWN_FRAME_TYPE;
+    LockedFrameProcessor frame_processor;
+    if (lazy_frame_dispatch) {
+      frame_type = parser::PeekFrameType(bytes.result());
+      frame_processor = GetFrameProcessor(frame_type);
+      if (!frame_processor) {
+        HandleUnprocessedFrame(endpoint_id, endpoint_channel, frame_type);
+        continue;
+      }
+    }
+
+    ExceptionOr<OfflineFrame*> wrapped_frame =
+        parser::FromBytes(bytes.result(), &arena);
     if (!wrapped_frame.ok()) {
       if (wrapped_frame.GetException().Raised(
               Exception::kInvalidProtocolBuffer)) {
@@ -197,39 +280,72 @@ ExceptionOr<bool> EndpointManager::HandleData(
         return ExceptionOr<bool>(wrapped_frame.exception());
       }
     }
-    OfflineFrame& frame = wrapped_frame.result();
+    OfflineFrame& frame = *wrapped_frame.result();
 
     // Route the incoming offlineFrame to its registered processor.
-    V1Frame::FrameType frame_type = parser::GetFrameType(frame);
-    LockedFrameProcessor frame_processor = GetFrameProcessor(frame_type);
-    if (!frame_processor) {
-      // report messages without handlers, except KEEP_ALIVE, which has
-      // no explicit handler.
-      if (frame_type == V1Frame::KEEP_ALIVE) {
-        NEARBY_LOG(INFO, "KeepAlive message for endpoint %s",
-                   endpoint_id.c_str());
-      } else if (frame_type == V1Frame::DISCONNECTION) {
-        NEARBY_LOG(INFO, "Disconnect message for endpoint %s",
-                   endpoint_id.c_str());
-        endpoint_channel->Close();
-      } else {
-        NEARBY_LOGS(ERROR) << "Unhandled message: endpoint_id=" << endpoint_id
-                           << ", frame type="
-                           << V1Frame::FrameType_Name(frame_type);
+    if (!lazy_frame_dispatch) {
+      frame_type = parser::GetFrameType(frame);
+      frame_processor = GetFrameProcessor(frame_type);
+      if (!frame_processor) {
+        HandleUnprocessedFrame(endpoint_id, endpoint_channel, frame_type);
+        continue;
       }
-      continue;
     }
 
+    TraceScope trace("channel", "EndpointManager::DispatchFrame");
+    trace.SetArg("frame_type", frame_type);
     frame_processor->OnIncomingFrame(frame, endpoint_id, client,
                                      endpoint_channel->GetMedium(),
                                      packet_meta_data);
   }
 }
 
+void EndpointManager::HandleUnprocessedFrame(
+    const std::string& endpoint_id, EndpointChannel* endpoint_channel,
+    V1Frame::FrameType frame_type) {
+  // report messages without handlers, except KEEP_ALIVE, which has
+  // no explicit handler.
+  if (frame_type == V1Frame::KEEP_ALIVE) {
+    NEARBY_LOG(INFO, "KeepAlive message for endpoint %s",
+               endpoint_id.c_str());
+  } else if (frame_type == V1Frame::DISCONNECTION) {
+    NEARBY_LOG(INFO, "Disconnect message for endpoint %s",
+               endpoint_id.c_str());
+    endpoint_channel->Close();
+  } else {
+    NEARBY_LOGS(ERROR) << "Unhandled message: endpoint_id=" << endpoint_id
+                       << ", frame type="
+                       << V1Frame::FrameType_Name(frame_type);
+  }
+}
+
 ExceptionOr<bool> EndpointManager::HandleKeepAlive(
-    EndpointChannel* endpoint_channel, absl::Duration keep_alive_interval,
-    absl::Duration keep_alive_timeout, Mutex* keep_alive_waiter_mutex,
-    ConditionVariable* keep_alive_waiter) {
+    const std::string& endpoint_id, EndpointChannel* endpoint_channel,
+    absl::Duration keep_alive_interval, absl::Duration keep_alive_timeout,
+    Mutex* keep_alive_waiter_mutex, ConditionVariable* keep_alive_waiter) {
+  ExceptionOr<absl::Duration> wait_for = CheckKeepAlive(
+      endpoint_id, endpoint_channel, keep_alive_interval, keep_alive_timeout);
+  if (!wait_for.ok()) {
+    return ExceptionOr<bool>(wait_for.exception());
+  }
+  if (wait_for.result() <= absl::ZeroDuration()) {
+    return ExceptionOr<bool>(false);
+  }
+
+  {
+    MutexLock lock(keep_alive_waiter_mutex);
+    Exception wait_exception = keep_alive_waiter->Wait(wait_for.result());
+    if (!wait_exception.Ok()) {
+      return ExceptionOr<bool>(wait_exception);
+    }
+  }
+
+  return ExceptionOr<bool>(true);
+}
+
+ExceptionOr<absl::Duration> EndpointManager::CheckKeepAlive(
+    const std::string& endpoint_id, EndpointChannel* endpoint_channel,
+    absl::Duration keep_alive_interval, absl::Duration keep_alive_timeout) {
   // Check if it has been too long since we received a frame from our endpoint.
   absl::Time last_read_time = endpoint_channel->GetLastReadTimestamp();
   absl::Duration duration_until_timeout =
@@ -238,7 +354,19 @@ ExceptionOr<bool> EndpointManager::HandleKeepAlive(
           : last_read_time + keep_alive_timeout -
                 SystemClock::ElapsedRealtime();
   if (duration_until_timeout <= absl::ZeroDuration()) {
-    return ExceptionOr<bool>(false);
+    return ExceptionOr<absl::Duration>(absl::ZeroDuration());
+  }
+
+  // Any frame written to the endpoint serves as a KeepAlive, so one is only
+  // written after the channel has gone idle. Other than over Bluetooth, all the
+  // remote endpoint needs is to hear from us before its keep-alive timeout,
+  // which both endpoints agreed on with the ConnectionRequest, so the interval
+  // can be stretched to spare the radio.
+  if (endpoint_channel->GetMedium() != Medium::BLUETOOTH &&
+      NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableAdaptiveKeepAliveInterval)) {
+    keep_alive_interval = std::max(keep_alive_interval, keep_alive_timeout / 2);
   }
 
   // If we haven't written anything to the endpoint for a while, attempt to send
@@ -252,24 +380,81 @@ ExceptionOr<bool> EndpointManager::HandleKeepAlive(
           : last_write_time + keep_alive_interval -
                 SystemClock::ElapsedRealtime();
   if (duration_until_write_keep_alive <= absl::ZeroDuration()) {
-    Exception write_exception = endpoint_channel->Write(parser::ForKeepAlive());
+    ByteArray keep_alive = parser::ForKeepAlive();
+    Exception write_exception = endpoint_channel->Write(keep_alive);
     if (!write_exception.Ok()) {
-      return ExceptionOr<bool>(write_exception);
+      return ExceptionOr<absl::Duration>(write_exception);
+    }
+    if (IsFrameTraceCaptureEnabled()) {
+      RecordFrame(FrameTrace::Direction::kOutgoing, endpoint_id,
+                  endpoint_channel->GetMedium(), keep_alive);
     }
     duration_until_write_keep_alive = keep_alive_interval;
   }
 
-  absl::Duration wait_for =
-      std::min(duration_until_timeout, duration_until_write_keep_alive);
-  {
-    MutexLock lock(keep_alive_waiter_mutex);
-    Exception wait_exception = keep_alive_waiter->Wait(wait_for);
-    if (!wait_exception.Ok()) {
-      return ExceptionOr<bool>(wait_exception);
+  return ExceptionOr<absl::Duration>(
+      std::min(duration_until_timeout, duration_until_write_keep_alive));
+}
+
+void EndpointManager::RunScheduledKeepAlive(
+    ClientProxy* client, const std::string& endpoint_id,
+    absl::Duration keep_alive_interval, absl::Duration keep_alive_timeout,
+    std::weak_ptr<ScheduledKeepAlive> weak_keep_alive) {
+  std::shared_ptr<ScheduledKeepAlive> keep_alive = weak_keep_alive.lock();
+  if (keep_alive == nullptr) return;
+  MutexLock lock(&keep_alive->mutex);
+  if (keep_alive->stopped) return;
+
+  while (true) {
+    std::shared_ptr<EndpointChannel> channel =
+        channel_manager_->GetChannelForEndpoint(endpoint_id);
+    if (channel == nullptr) {
+      NEARBY_LOG(INFO, "Endpoint channel is nullptr, bail out.");
+      break;
+    }
+    if ((keep_alive->last_failed_medium != Medium::UNKNOWN_MEDIUM) &&
+        (channel->GetMedium() == keep_alive->last_failed_medium)) {
+      NEARBY_LOG(
+          INFO, "No new endpoint channel is found after a failure, exit loop.");
+      break;
     }
+
+    ExceptionOr<absl::Duration> wait_for =
+        CheckKeepAlive(endpoint_id, channel.get(), keep_alive_interval,
+                       keep_alive_timeout);
+    if (!wait_for.ok()) {
+      if (wait_for.GetException().Raised(Exception::kIo)) {
+        keep_alive->last_failed_medium = channel->GetMedium();
+        NEARBY_LOGS(INFO)
+            << "Endpoint channel IO exception; last_failed_medium="
+            << location::nearby::proto::connections::Medium_Name(
+                   keep_alive->last_failed_medium);
+        continue;
+      }
+      break;
+    }
+    if (wait_for.result() <= absl::ZeroDuration()) {
+      NEARBY_LOGS(INFO) << "Dropping current channel: last medium="
+                        << location::nearby::proto::connections::Medium_Name(
+                               keep_alive->last_failed_medium);
+      break;
+    }
+
+    keep_alive->next_check = GetKeepAliveExecutor()->Schedule(
+        [this, client, endpoint_id, keep_alive_interval, keep_alive_timeout,
+         weak_keep_alive]() {
+          RunScheduledKeepAlive(client, endpoint_id, keep_alive_interval,
+                                keep_alive_timeout, weak_keep_alive);
+        },
+        wait_for.result());
+    return;
   }
 
-  return ExceptionOr<bool>(true);
+  keep_alive->stopped = true;
+  NEARBY_LOGS(INFO)
+      << "Worker going down; worker name=KeepAliveManager; endpoint_id="
+      << endpoint_id;
+  DiscardEndpoint(client, endpoint_id);
 }
 
 bool operator==(const EndpointManager::FrameProcessor& lhs,
@@ -309,6 +494,21 @@ EndpointManager::~EndpointManager() {
   });
   latch.Await();
 
+  MultiThreadExecutor* fan_out_executor;
+  {
+    MutexLock lock(&mutex_);
+    fan_out_executor = fan_out_executor_.get();
+  }
+  if (fan_out_executor) fan_out_executor->Shutdown();
+
+  // Every EndpointState has stopped its scheduled keep-alive by now.
+  ScheduledExecutor* keep_alive_executor;
+  {
+    MutexLock lock(&mutex_);
+    keep_alive_executor = keep_alive_executor_.get();
+  }
+  if (keep_alive_executor) keep_alive_executor->Shutdown();
+
   NEARBY_LOG(INFO, "Bringing down control thread");
   serial_executor_->Shutdown();
   NEARBY_LOG(INFO, "EndpointManager is down");
@@ -463,20 +663,43 @@ void EndpointManager::RegisterEndpoint(
     // for the pong.
     NEARBY_LOGS(VERBOSE) << "EndpointManager enabling KeepAlive for endpoint "
                          << endpoint_id;
-    endpoint_state.StartEndpointKeepAliveManager(
-        [this, client, endpoint_id, keep_alive_interval, keep_alive_timeout](
-            Mutex* keep_alive_waiter_mutex,
-            ConditionVariable* keep_alive_waiter) {
-          EndpointChannelLoopRunnable(
-              "KeepAliveManager", client, endpoint_id,
-              [this, keep_alive_interval, keep_alive_timeout,
-               keep_alive_waiter_mutex,
-               keep_alive_waiter](EndpointChannel* channel) {
-                return HandleKeepAlive(
-                    channel, keep_alive_interval, keep_alive_timeout,
-                    keep_alive_waiter_mutex, keep_alive_waiter);
-              });
-        });
+    if (NearbyFlags::GetInstance().GetBoolFlag(
+            config_package_nearby::nearby_connections_feature::
+                kEnableSharedKeepAliveScheduler)) {
+      // The checks are short and spend most of their time waiting, so all
+      // endpoints share a single keep-alive thread.
+      auto keep_alive = std::make_shared<ScheduledKeepAlive>();
+      {
+        MutexLock lock(&keep_alive->mutex);
+        keep_alive->next_check = GetKeepAliveExecutor()->Schedule(
+            [this, client, endpoint_id, keep_alive_interval,
+             keep_alive_timeout,
+             weak_keep_alive = std::weak_ptr<ScheduledKeepAlive>(
+                 keep_alive)]() {
+              RunScheduledKeepAlive(client, endpoint_id, keep_alive_interval,
+                                    keep_alive_timeout, weak_keep_alive);
+            },
+            absl::ZeroDuration());
+      }
+      endpoint_state.SetScheduledKeepAlive(std::move(keep_alive));
+    } else {
+      endpoint_state.StartEndpointKeepAliveManager(
+          [this, client, endpoint_id, keep_alive_interval, keep_alive_timeout](
+              Mutex* keep_alive_waiter_mutex,
+              ConditionVariable* keep_alive_waiter) {
+            EndpointChannelLoopRunnable(
+                "KeepAliveManager", client, endpoint_id,
+                [this, endpoint_id, keep_alive_interval, keep_alive_timeout,
+                 keep_alive_waiter_mutex,
+                 keep_alive_waiter](EndpointChannel* channel) {
+                  return HandleKeepAlive(endpoint_id, channel,
+                                         keep_alive_interval,
+                                         keep_alive_timeout,
+                                         keep_alive_waiter_mutex,
+                                         keep_alive_waiter);
+                });
+          });
+    }
     NEARBY_LOGS(INFO) << "Registering endpoint " << endpoint_id
                       << ", workers started and notifying client.";
 
@@ -512,19 +735,72 @@ int EndpointManager::GetMaxTransmitPacketSize(const std::string& endpoint_id) {
   return channel->GetMaxTransmitPacketSize();
 }
 
+location::nearby::proto::connections::Medium EndpointManager::GetChannelMedium(
+    const std::string& endpoint_id) {
+  std::shared_ptr<EndpointChannel> channel =
+      channel_manager_->GetChannelForEndpoint(endpoint_id);
+  if (channel == nullptr) {
+    return location::nearby::proto::connections::UNKNOWN_MEDIUM;
+  }
+
+  return channel->GetMedium();
+}
+
 std::vector<std::string> EndpointManager::SendPayloadChunk(
     const PayloadTransferFrame::PayloadHeader& payload_header,
     const PayloadTransferFrame::PayloadChunk& payload_chunk,
     const std::vector<std::string>& endpoint_ids,
     PacketMetaData& packet_meta_data) {
-  ByteArray bytes =
-      parser::ForDataPayloadTransfer(payload_header, payload_chunk);
+  std::vector<ByteArray> frames;
+  frames.push_back(
+      parser::ForDataPayloadTransfer(payload_header, payload_chunk));
 
   return SendTransferFrameBytes(
-      endpoint_ids, bytes, payload_header.id(),
+      endpoint_ids, frames, payload_header.id(),
       /*offset=*/payload_chunk.offset(),
       /*packet_type=*/
       PayloadTransferFrame::PacketType_Name(PayloadTransferFrame::DATA),
+      GetWritePriority(payload_header.type()), packet_meta_data);
+}
+
+std::vector<std::string> EndpointManager::SendPayloadChunks(
+    const PayloadTransferFrame::PayloadHeader& payload_header,
+    const std::vector<PayloadTransferFrame::PayloadChunk>& payload_chunks,
+    const std::vector<std::string>& endpoint_ids,
+    PacketMetaData& packet_meta_data) {
+  if (payload_chunks.empty()) return {};
+
+  std::vector<ByteArray> frames;
+  frames.reserve(payload_chunks.size());
+  for (const auto& payload_chunk : payload_chunks) {
+    frames.push_back(
+        parser::ForDataPayloadTransfer(payload_header, payload_chunk));
+  }
+
+  return SendTransferFrameBytes(
+      endpoint_ids, frames, payload_header.id(),
+      /*offset=*/payload_chunks.front().offset(),
+      /*packet_type=*/
+      PayloadTransferFrame::PacketType_Name(PayloadTransferFrame::DATA),
+      GetWritePriority(payload_header.type()), packet_meta_data);
+}
+
+std::vector<std::string> EndpointManager::SendBytesPayloadBatch(
+    const std::vector<PayloadTransferFrame::BytesPayload>& bytes_payloads,
+    const std::vector<std::string>& endpoint_ids,
+    PacketMetaData& packet_meta_data) {
+  if (bytes_payloads.empty()) return {};
+
+  std::vector<ByteArray> frames;
+  frames.push_back(parser::ForBytesPayloadBatch(bytes_payloads));
+
+  // Throughput is attributed to the first payload of the batch.
+  return SendTransferFrameBytes(
+      endpoint_ids, frames, bytes_payloads.front().payload_header().id(),
+      /*offset=*/0,
+      /*packet_type=*/
+      PayloadTransferFrame::PacketType_Name(PayloadTransferFrame::BYTES_BATCH),
+      GetWritePriority(PayloadTransferFrame::PayloadHeader::BYTES),
       packet_meta_data);
 }
 
@@ -584,15 +860,16 @@ std::vector<std::string> EndpointManager::SendControlMessage(
     const PayloadTransferFrame::PayloadHeader& header,
     const PayloadTransferFrame::ControlMessage& control,
     const std::vector<std::string>& endpoint_ids) {
-  ByteArray bytes = parser::ForControlPayloadTransfer(header, control);
+  std::vector<ByteArray> frames;
+  frames.push_back(parser::ForControlPayloadTransfer(header, control));
   PacketMetaData packet_meta_data;
 
   return SendTransferFrameBytes(
-      endpoint_ids, bytes, header.id(),
+      endpoint_ids, frames, header.id(),
       /*offset=*/control.offset(),
       /*packet_type=*/
       PayloadTransferFrame::PacketType_Name(PayloadTransferFrame::CONTROL),
-      packet_meta_data);
+      WritePriority::kControl, packet_meta_data);
 }
 
 // @EndpointManagerThread
@@ -607,6 +884,10 @@ void EndpointManager::RemoveEndpoint(ClientProxy* client,
   std::string service_id =
       channel ? channel->GetServiceId() : std::string(kUnknownServiceId);
 
+  // Releasing the endpoint's memory unblocks its reader if it waits for the
+  // client to drain buffered data.
+  client->GetMemoryAccountant().ReleaseEndpoint(endpoint_id);
+
   // Unregistering from channel_manager_ will also serve to terminate
   // the dedicated handler and KeepAlive threads we started when we registered
   // this endpoint.
@@ -680,41 +961,134 @@ CountDownLatch EndpointManager::NotifyFrameProcessorsOnEndpointDisconnect(
 }
 
 std::vector<std::string> EndpointManager::SendTransferFrameBytes(
-    const std::vector<std::string>& endpoint_ids, const ByteArray& bytes,
-    std::int64_t payload_id, std::int64_t offset,
-    const std::string& packet_type, PacketMetaData& packet_meta_data) {
+    const std::vector<std::string>& endpoint_ids,
+    const std::vector<ByteArray>& frames, std::int64_t payload_id,
+    std::int64_t offset,
+    const std::string& packet_type, WritePriority priority,
+    PacketMetaData& packet_meta_data) {
+  TraceScope trace("payload", "EndpointManager::SendTransferFrameBytes");
+  trace.SetArg("frames", frames.size());
+  if (endpoint_ids.size() > 1 &&
+      NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableParallelFanOutWrites)) {
+    return SendTransferFrameBytesInParallel(endpoint_ids, frames, payload_id,
+                                            offset, packet_type, priority,
+                                            packet_meta_data);
+  }
+
   std::vector<std::string> failed_endpoint_ids;
   for (const std::string& endpoint_id : endpoint_ids) {
-    std::shared_ptr<EndpointChannel> channel =
-        channel_manager_->GetChannelForEndpoint(endpoint_id);
-
-    if (channel == nullptr) {
-      // We no longer know about this endpoint (it was either explicitly
-      // unregistered, or a read/write error made us unregister it internally).
-      NEARBY_LOGS(ERROR) << "EndpointManager failed to find EndpointChannel "
-                            "over which to write "
-                         << packet_type << " at offset " << offset
-                         << " of Payload " << payload_id << " to endpoint "
-                         << endpoint_id;
-
+    if (!SendTransferFrameBytesToEndpoint(endpoint_id, frames, payload_id,
+                                          offset, packet_type, priority,
+                                          packet_meta_data)) {
       failed_endpoint_ids.push_back(endpoint_id);
-      continue;
     }
+  }
 
-    Exception write_exception = channel->Write(bytes, packet_meta_data);
-    if (!write_exception.Ok()) {
-      failed_endpoint_ids.push_back(endpoint_id);
-      NEARBY_LOGS(INFO) << "Failed to send packet; endpoint_id=" << endpoint_id;
-      continue;
+  return failed_endpoint_ids;
+}
+
+std::vector<std::string> EndpointManager::SendTransferFrameBytesInParallel(
+    const std::vector<std::string>& endpoint_ids,
+    const std::vector<ByteArray>& frames, std::int64_t payload_id,
+    std::int64_t offset,
+    const std::string& packet_type, WritePriority priority,
+    PacketMetaData& packet_meta_data) {
+  MultiThreadExecutor* executor = GetFanOutExecutor();
+
+  // Every write records its own timings, so each one gets its own copy of the
+  // meta data. The first endpoint is written from the calling thread and
+  // reports back through |packet_meta_data|, as in the sequential case.
+  std::vector<PacketMetaData> packet_meta_data_copies(endpoint_ids.size() - 1,
+                                                      packet_meta_data);
+  std::vector<Future<bool>> results(endpoint_ids.size() - 1);
+  for (size_t i = 1; i < endpoint_ids.size(); ++i) {
+    PacketMetaData* meta_data = &packet_meta_data_copies[i - 1];
+    executor->Submit<bool>(
+        [this, &endpoint_id = endpoint_ids[i], &frames, payload_id, offset,
+         &packet_type, priority, meta_data]() -> ExceptionOr<bool> {
+          return ExceptionOr<bool>(SendTransferFrameBytesToEndpoint(
+              endpoint_id, frames, payload_id, offset, packet_type, priority,
+              *meta_data));
+        },
+        &results[i - 1]);
+  }
+
+  std::vector<std::string> failed_endpoint_ids;
+  if (!SendTransferFrameBytesToEndpoint(endpoint_ids[0], frames, payload_id,
+                                        offset, packet_type, priority,
+                                        packet_meta_data)) {
+    failed_endpoint_ids.push_back(endpoint_ids[0]);
+  }
+  // Wait for all writes, since they reference |frames|. A write that could not
+  // be scheduled (during shutdown) completes with an exception.
+  for (size_t i = 1; i < endpoint_ids.size(); ++i) {
+    ExceptionOr<bool> result = results[i - 1].Get();
+    if (!result.ok() || !result.result()) {
+      failed_endpoint_ids.push_back(endpoint_ids[i]);
     }
-    analytics::ThroughputRecorderContainer::GetInstance()
-        .GetTPRecorder(payload_id, PayloadDirection::OUTGOING_PAYLOAD)
-        ->OnFrameSent(channel->GetMedium(), packet_meta_data);
   }
 
   return failed_endpoint_ids;
 }
 
+bool EndpointManager::SendTransferFrameBytesToEndpoint(
+    const std::string& endpoint_id, const std::vector<ByteArray>& frames,
+    std::int64_t payload_id, std::int64_t offset,
+    const std::string& packet_type, WritePriority priority,
+    PacketMetaData& packet_meta_data) {
+  std::shared_ptr<EndpointChannel> channel =
+      channel_manager_->GetChannelForEndpoint(endpoint_id);
+
+  if (channel == nullptr) {
+    // We no longer know about this endpoint (it was either explicitly
+    // unregistered, or a read/write error made us unregister it internally).
+    NEARBY_LOGS(ERROR) << "EndpointManager failed to find EndpointChannel "
+                          "over which to write "
+                       << packet_type << " at offset " << offset
+                       << " of Payload " << payload_id << " to endpoint "
+                       << endpoint_id;
+    return false;
+  }
+
+  Exception write_exception =
+      frames.size() == 1
+          ? channel->Write(frames.front(), packet_meta_data, priority)
+          : channel->WriteFrames(frames, packet_meta_data, priority);
+  if (!write_exception.Ok()) {
+    NEARBY_LOGS(INFO) << "Failed to send packet; endpoint_id=" << endpoint_id;
+    return false;
+  }
+  if (IsFrameTraceCaptureEnabled()) {
+    for (const ByteArray& frame : frames) {
+      RecordFrame(FrameTrace::Direction::kOutgoing, endpoint_id,
+                  channel->GetMedium(), frame);
+    }
+  }
+  analytics::ThroughputRecorderContainer::GetInstance()
+      .GetTPRecorder(payload_id, PayloadDirection::OUTGOING_PAYLOAD)
+      ->OnFrameSent(channel->GetMedium(), packet_meta_data);
+  return true;
+}
+
+MultiThreadExecutor* EndpointManager::GetFanOutExecutor() {
+  MutexLock lock(&mutex_);
+  if (!fan_out_executor_) {
+    fan_out_executor_ =
+        std::make_unique<MultiThreadExecutor>(kMaxParallelFanOutWrites);
+  }
+  return fan_out_executor_.get();
+}
+
+ScheduledExecutor* EndpointManager::GetKeepAliveExecutor() {
+  MutexLock lock(&mutex_);
+  if (!keep_alive_executor_) {
+    keep_alive_executor_ = std::make_unique<ScheduledExecutor>();
+  }
+  return keep_alive_executor_.get();
+}
+
 EndpointManager::EndpointState::~EndpointState() {
   // We must unregister the endpoint first to signal the runnables that they
   // should exit their loops. SingleThreadExecutor destructors will wait for the
@@ -730,6 +1104,18 @@ EndpointManager::EndpointState::~EndpointState() {
     MutexLock lock(keep_alive_waiter_mutex_.get());
     keep_alive_waiter_->Notify();
   }
+
+  // Likewise for a scheduled keep-alive. A check that is already running is
+  // waited for, outside of the lock that it takes.
+  if (scheduled_keep_alive_) {
+    Cancelable next_check;
+    {
+      MutexLock lock(&scheduled_keep_alive_->mutex);
+      scheduled_keep_alive_->stopped = true;
+      next_check = scheduled_keep_alive_->next_check;
+    }
+    next_check.Cancel();
+  }
 }
 
 void EndpointManager::EndpointState::StartEndpointReader(Runnable&& runnable) {
@@ -746,6 +1132,11 @@ void EndpointManager::EndpointState::StartEndpointKeepAliveManager(
       });
 }
 
+void EndpointManager::EndpointState::SetScheduledKeepAlive(
+    std::shared_ptr<ScheduledKeepAlive> keep_alive) {
+  scheduled_keep_alive_ = std::move(keep_alive);
+}
+
 void EndpointManager::RunOnEndpointManagerThread(const std::string& name,
                                                  Runnable runnable) {
   serial_executor_->Execute(name, std::move(runnable));
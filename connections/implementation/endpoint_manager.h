@@ -33,9 +33,13 @@
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
 #include "connections/listeners.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/cancelable.h"
 #include "internal/platform/condition_variable.h"
 #include "internal/platform/count_down_latch.h"
+#include "internal/platform/multi_thread_executor.h"
+#include "internal/platform/mutex.h"
 #include "internal/platform/runnable.h"
+#include "internal/platform/scheduled_executor.h"
 #include "internal/platform/single_thread_executor.h"
 
 namespace nearby {
@@ -121,6 +125,10 @@ class EndpointManager {
   // transport.
   int GetMaxTransmitPacketSize(const std::string& endpoint_id);
 
+  // Returns the medium of the channel to |endpoint_id|, or UNKNOWN_MEDIUM.
+  location::nearby::proto::connections::Medium GetChannelMedium(
+      const std::string& endpoint_id);
+
   // Returns the list of endpoints to which sending this chunk failed.
   //
   // Invoked from the PayloadManager's sendPayload() method.
@@ -131,6 +139,27 @@ class EndpointManager {
           payload_chunk,
       const std::vector<std::string>& endpoint_ids,
       analytics::PacketMetaData& packet_meta_data);
+
+  // Like SendPayloadChunk(), but writes several consecutive chunks of the same
+  // payload to each endpoint at once, so they are encrypted and flushed
+  // together. Returns the list of endpoints to which sending any of the chunks
+  // failed.
+  std::vector<std::string> SendPayloadChunks(
+      const location::nearby::connections::PayloadTransferFrame::PayloadHeader&
+          payload_header,
+      const std::vector<
+          location::nearby::connections::PayloadTransferFrame::PayloadChunk>&
+          payload_chunks,
+      const std::vector<std::string>& endpoint_ids,
+      analytics::PacketMetaData& packet_meta_data);
+  // Writes several complete BYTES payloads to each endpoint as a single
+  // frame. Returns the list of endpoints to which sending the frame failed.
+  std::vector<std::string> SendBytesPayloadBatch(
+      const std::vector<
+          location::nearby::connections::PayloadTransferFrame::BytesPayload>&
+          bytes_payloads,
+      const std::vector<std::string>& endpoint_ids,
+      analytics::PacketMetaData& packet_meta_data);
   std::vector<std::string> SendControlMessage(
       const location::nearby::connections::PayloadTransferFrame::PayloadHeader&
           payload_header,
@@ -159,6 +188,18 @@ class EndpointManager {
                   std::unique_ptr<SingleThreadExecutor> serial_executor);
 
  private:
+  // State of an endpoint's keep-alive when it is driven by the shared
+  // keep-alive executor rather than a dedicated thread. Each check holds
+  // |mutex| while it runs, so setting |stopped| waits for a running check.
+  struct ScheduledKeepAlive {
+    Mutex mutex;
+    bool stopped ABSL_GUARDED_BY(mutex) = false;
+    location::nearby::proto::connections::Medium last_failed_medium
+        ABSL_GUARDED_BY(mutex) =
+            location::nearby::proto::connections::UNKNOWN_MEDIUM;
+    Cancelable next_check ABSL_GUARDED_BY(mutex);
+  };
+
   class EndpointState {
    public:
     EndpointState(const std::string& endpoint_id,
@@ -180,7 +221,8 @@ class EndpointManager {
           keep_alive_waiter_mutex_{
               std::exchange(other.keep_alive_waiter_mutex_, nullptr)},
           keep_alive_waiter_{std::exchange(other.keep_alive_waiter_, nullptr)},
-          keep_alive_thread_{std::move(other.keep_alive_thread_)} {}
+          keep_alive_thread_{std::move(other.keep_alive_thread_)},
+          scheduled_keep_alive_{std::move(other.scheduled_keep_alive_)} {}
     EndpointState& operator=(const EndpointState&) = delete;
     EndpointState&& operator=(EndpointState&&) = delete;
     ~EndpointState();
@@ -188,11 +230,13 @@ class EndpointManager {
     void StartEndpointReader(Runnable&& runnable);
     void StartEndpointKeepAliveManager(
         std::function<void(Mutex*, ConditionVariable*)> runnable);
+    // Keeps |keep_alive| running until this EndpointState is destroyed.
+    void SetScheduledKeepAlive(std::shared_ptr<ScheduledKeepAlive> keep_alive);
 
    private:
     const std::string endpoint_id_;
     EndpointChannelManager* channel_manager_;
-    SingleThreadExecutor reader_thread_;
+    SingleThreadExecutor reader_thread_{api::ExecutorQos::kUserInitiated};
 
     // Use a condition variable so we can wait on the thread but still be able
     // to wake it up before shutting down. We don't want to just sleep and risk
@@ -202,6 +246,7 @@ class EndpointManager {
     mutable std::unique_ptr<Mutex> keep_alive_waiter_mutex_;
     std::unique_ptr<ConditionVariable> keep_alive_waiter_;
     SingleThreadExecutor keep_alive_thread_;
+    std::shared_ptr<ScheduledKeepAlive> scheduled_keep_alive_;
   };
 
   // RAII accessor for FrameProcessor
@@ -226,13 +271,35 @@ class EndpointManager {
   ExceptionOr<bool> HandleData(const std::string& endpoint_id,
                                ClientProxy* client_proxy,
                                EndpointChannel* endpoint_channel);
+  // Handles a frame that has no registered FrameProcessor.
+  void HandleUnprocessedFrame(
+      const std::string& endpoint_id, EndpointChannel* endpoint_channel,
+      location::nearby::connections::V1Frame::FrameType frame_type);
 
-  ExceptionOr<bool> HandleKeepAlive(EndpointChannel* endpoint_channel,
+  ExceptionOr<bool> HandleKeepAlive(const std::string& endpoint_id,
+                                    EndpointChannel* endpoint_channel,
                                     absl::Duration keep_alive_interval,
                                     absl::Duration keep_alive_timeout,
                                     Mutex* keep_alive_waiter_mutex,
                                     ConditionVariable* keep_alive_waiter);
 
+  // Times out the endpoint, or writes a KeepAlive frame when one is due.
+  // Returns how long until the next check is needed, or a zero duration if
+  // the endpoint has timed out.
+  ExceptionOr<absl::Duration> CheckKeepAlive(
+      const std::string& endpoint_id, EndpointChannel* endpoint_channel,
+      absl::Duration keep_alive_interval, absl::Duration keep_alive_timeout);
+
+  // Runs a single keep-alive check on the shared keep-alive executor and
+  // schedules the next one. Like EndpointChannelLoopRunnable(), it moves on
+  // to a replacement channel after a write failure, and discards the
+  // endpoint once there is none.
+  void RunScheduledKeepAlive(ClientProxy* client,
+                             const std::string& endpoint_id,
+                             absl::Duration keep_alive_interval,
+                             absl::Duration keep_alive_timeout,
+                             std::weak_ptr<ScheduledKeepAlive> keep_alive);
+
   // Waits for a given endpoint EndpointChannelLoopRunnable() workers to
   // terminate.
   // Is called from RegisterEndpoint to avoid races; also called from
@@ -256,6 +323,12 @@ class EndpointManager {
   static constexpr absl::Duration kProcessEndpointDisconnectionTimeout =
       absl::Milliseconds(11000);
   static constexpr absl::Time kInvalidTimestamp = absl::InfinitePast();
+  // The maximum number of endpoints written to concurrently by a single
+  // parallel fan-out send; further writes queue up behind these.
+  static constexpr int kMaxParallelFanOutWrites = 8;
+  // Size of the block each reader thread preallocates for parsing incoming
+  // frames; it comfortably holds the message tree of any single frame.
+  static constexpr size_t kFrameArenaBlockSize = 4 * 1024;
 
   // It should be noted that this method may be called multiple times (because
   // invoking this method closes the endpoint channel, which causes the
@@ -276,9 +349,36 @@ class EndpointManager {
 
   std::vector<std::string> SendTransferFrameBytes(
       const std::vector<std::string>& endpoint_ids,
-      const ByteArray& payload_transfer_frame_bytes, std::int64_t payload_id,
+      const std::vector<ByteArray>& payload_transfer_frames,
+      std::int64_t payload_id,
       std::int64_t offset, const std::string& packet_type,
-      analytics::PacketMetaData& packet_meta_data);
+      WritePriority priority, analytics::PacketMetaData& packet_meta_data);
+
+  // Writes the frames to all endpoints concurrently, so that a slow channel
+  // doesn't hold up the others. Returns once every write has completed.
+  std::vector<std::string> SendTransferFrameBytesInParallel(
+      const std::vector<std::string>& endpoint_ids,
+      const std::vector<ByteArray>& payload_transfer_frames,
+      std::int64_t payload_id,
+      std::int64_t offset, const std::string& packet_type,
+      WritePriority priority, analytics::PacketMetaData& packet_meta_data);
+
+  // Writes the frames to a single endpoint. Returns false if the endpoint is
+  // unknown or the write failed.
+  bool SendTransferFrameBytesToEndpoint(
+      const std::string& endpoint_id,
+      const std::vector<ByteArray>& payload_transfer_frames,
+      std::int64_t payload_id,
+      std::int64_t offset, const std::string& packet_type,
+      WritePriority priority, analytics::PacketMetaData& packet_meta_data);
+
+  // Returns the executor used for parallel fan-out writes, creating it on
+  // first use.
+  MultiThreadExecutor* GetFanOutExecutor() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the executor that drives scheduled keep-alives, creating it on
+  // first use.
+  ScheduledExecutor* GetKeepAliveExecutor() ABSL_LOCKS_EXCLUDED(mutex_);
 
   // Executes all jobs sequentially, on a serial_executor_.
   void RunOnEndpointManagerThread(const std::string& name, Runnable runnable);
@@ -305,6 +405,16 @@ class EndpointManager {
   mutable RecursiveMutex mutex_;
   bool is_shutdown_ ABSL_GUARDED_BY(mutex_) = false;
 
+  // Runs the extra writes of a multi-endpoint send. Created on first use,
+  // since most clients only ever send to a single endpoint at a time.
+  std::unique_ptr<MultiThreadExecutor> fan_out_executor_
+      ABSL_GUARDED_BY(mutex_);
+
+  // Runs the keep-alive checks of all endpoints when
+  // kEnableSharedKeepAliveScheduler is set. Created on first use.
+  std::unique_ptr<ScheduledExecutor> keep_alive_executor_
+      ABSL_GUARDED_BY(mutex_);
+
   std::unique_ptr<SingleThreadExecutor> serial_executor_;
 };
 
@@ -29,11 +29,14 @@
 #include "connections/connection_options.h"
 #include "connections/implementation/client_proxy.h"
 #include "connections/implementation/endpoint_channel_manager.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/implementation/offline_frames.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/logging.h"
+#include "internal/platform/system_clock.h"
 #include "internal/test/fake_single_thread_executor.h"
 #include "proto/connections_enums.pb.h"
 
@@ -75,6 +78,8 @@ class MockEndpointChannel : public EndpointChannel {
   MOCK_METHOD(int, GetMaxTransmitPacketSize, (), (const override));
   MOCK_METHOD(void, EnableEncryption,
               (std::shared_ptr<EncryptionContext> context), (override));
+  MOCK_METHOD(void, EnableAeadEncryption,
+              (std::shared_ptr<AeadFrameCipher> cipher), (override));
   MOCK_METHOD(void, DisableEncryption, (), (override));
   MOCK_METHOD(bool, IsPaused, (), (const override));
   MOCK_METHOD(void, Pause, (), (override));
@@ -299,6 +304,72 @@ TEST_F(EndpointManagerTest, SendControlMessageWorks) {
   NEARBY_LOG(INFO, "Will call destructors now");
 }
 
+TEST_F(EndpointManagerTest, GetChannelMediumReturnsMediumOfChannel) {
+  auto endpoint_channel = std::make_unique<MockEndpointChannel>();
+  ON_CALL(*endpoint_channel, Read(_))
+      .WillByDefault([channel = endpoint_channel.get()]() {
+        absl::SleepFor(absl::Milliseconds(100));
+        if (channel->IsClosed()) return ExceptionOr<ByteArray>(Exception::kIo);
+        return ExceptionOr<ByteArray>(ByteArray{});
+      });
+  ON_CALL(*endpoint_channel, Close(_))
+      .WillByDefault(
+          [channel = endpoint_channel.get()](DisconnectionReason reason) {
+            channel->DoClose();
+          });
+
+  RegisterEndpoint(std::move(endpoint_channel), false);
+
+  EXPECT_EQ(em_.GetChannelMedium(endpoint_id_), Medium::BLE);
+  EXPECT_EQ(em_.GetChannelMedium("unknown"), Medium::UNKNOWN_MEDIUM);
+  em_.UnregisterEndpoint(client_.get(), endpoint_id_);
+}
+
+TEST_F(EndpointManagerTest, SendControlMessageToMultipleEndpointsInParallel) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableParallelFanOutWrites,
+      true);
+  PayloadTransferFrame::PayloadHeader header;
+  PayloadTransferFrame::ControlMessage control;
+  header.set_id(12345);
+  header.set_type(PayloadTransferFrame::PayloadHeader::FILE);
+  header.set_total_size(1024);
+  control.set_offset(150);
+  control.set_event(PayloadTransferFrame::ControlMessage::PAYLOAD_CANCELED);
+
+  // The first write only completes once the second one has started, which
+  // can't happen if the endpoints are written to one after another.
+  CountDownLatch second_write_started(1);
+  auto first_channel = std::make_unique<MockEndpointChannel>();
+  auto second_channel = std::make_unique<MockEndpointChannel>();
+  EXPECT_CALL(*first_channel, Write(_, _))
+      .WillOnce([&second_write_started]() {
+        return second_write_started.Await(absl::Seconds(1)).result()
+                   ? Exception{Exception::kSuccess}
+                   : Exception{Exception::kIo};
+      });
+  EXPECT_CALL(*second_channel, Write(_, _))
+      .WillOnce([&second_write_started]() {
+        second_write_started.CountDown();
+        return Exception{Exception::kSuccess};
+      });
+  EXPECT_CALL(*first_channel, GetMedium())
+      .WillRepeatedly(Return(Medium::BLUETOOTH));
+  EXPECT_CALL(*second_channel, GetMedium())
+      .WillRepeatedly(Return(Medium::WIFI_LAN));
+  ecm_.RegisterChannelForEndpoint(client_.get(), "first",
+                                  std::move(first_channel));
+  ecm_.RegisterChannelForEndpoint(client_.get(), "second",
+                                  std::move(second_channel));
+
+  auto failed_ids = em_.SendControlMessage(
+      header, control, std::vector<std::string>{"first", "second", "unknown"});
+
+  EXPECT_EQ(failed_ids, std::vector<std::string>{"unknown"});
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 TEST_F(EndpointManagerTest, SingleReadOnInvalidPayload) {
   auto endpoint_channel = std::make_unique<MockEndpointChannel>();
   EXPECT_CALL(*endpoint_channel, Read(_))
@@ -310,6 +381,164 @@ TEST_F(EndpointManagerTest, SingleReadOnInvalidPayload) {
   RegisterEndpoint(std::move(endpoint_channel));
 }
 
+TEST_F(EndpointManagerTest, LazyFrameDispatchParsesOnlyProcessedFrames) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableLazyFrameDispatch,
+      true);
+  auto endpoint_channel = std::make_unique<MockEndpointChannel>();
+  auto connect_request = std::make_unique<MockFrameProcessor>();
+  ConnectionInfo connection_info{
+      "endpoint_id",
+      ByteArray{"endpoint_name"},
+      1234 /*nonce*/,
+      false /*supports_5_ghz*/,
+      "" /*bssid*/,
+      2412 /*ap_frequency*/,
+      "8xqT" /*ip_address in 4 bytes format*/,
+      std::vector<Medium>{Medium::BLE} /*supported_mediums*/,
+      0 /*keep_alive_interval_millis*/,
+      0 /*keep_alive_timeout_millis*/};
+
+  EXPECT_CALL(*connect_request, OnIncomingFrame)
+      .WillOnce([](OfflineFrame& offline_frame, const std::string&,
+                   ClientProxy*, Medium, PacketMetaData&) {
+        EXPECT_EQ(parser::GetFrameType(offline_frame),
+                  V1Frame::CONNECTION_REQUEST);
+      });
+  EXPECT_CALL(*connect_request, OnEndpointDisconnect);
+  EXPECT_CALL(*endpoint_channel, Read(_))
+      .WillOnce(Return(ExceptionOr<ByteArray>(parser::ForKeepAlive())))
+      .WillOnce(Return(ExceptionOr<ByteArray>(
+          parser::ForConnectionRequest(connection_info))))
+      .WillRepeatedly(Return(ExceptionOr<ByteArray>(Exception::kIo)));
+  EXPECT_CALL(*endpoint_channel, Write(_))
+      .WillRepeatedly(Return(Exception{Exception::kSuccess}));
+  em_.RegisterFrameProcessor(V1Frame::CONNECTION_REQUEST,
+                             connect_request.get());
+  processors_.emplace_back(std::move(connect_request));
+  RegisterEndpoint(std::move(endpoint_channel));
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST_F(EndpointManagerTest, SharedKeepAliveSchedulerWritesKeepAlive) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableSharedKeepAliveScheduler,
+      true);
+  auto endpoint_channel = std::make_unique<MockEndpointChannel>();
+  CountDownLatch closed(1);
+  CountDownLatch keep_alive_written(1);
+  EXPECT_CALL(*endpoint_channel, Read(_))
+      .WillRepeatedly([&closed](PacketMetaData& packet_meta_data) {
+        closed.Await();
+        return ExceptionOr<ByteArray>(Exception::kIo);
+      });
+  EXPECT_CALL(*endpoint_channel, Write(_))
+      .WillRepeatedly([&keep_alive_written](const ByteArray& data) {
+        keep_alive_written.CountDown();
+        return Exception{Exception::kSuccess};
+      });
+  EXPECT_CALL(*endpoint_channel, Close(_))
+      .WillRepeatedly([&closed](DisconnectionReason reason) {
+        closed.CountDown();
+      });
+  EXPECT_CALL(*endpoint_channel, GetMedium())
+      .WillRepeatedly(Return(Medium::BLE));
+  EXPECT_CALL(*endpoint_channel, GetLastReadTimestamp())
+      .WillRepeatedly(Return(SystemClock::ElapsedRealtime()));
+  EXPECT_CALL(*endpoint_channel, GetLastWriteTimestamp())
+      .WillRepeatedly(
+          Return(SystemClock::ElapsedRealtime() - absl::Seconds(10)));
+  EXPECT_CALL(mock_listener_.initiated_cb, Call).Times(1);
+  em_.RegisterEndpoint(client_.get(), endpoint_id_, info_, connection_options_,
+                       std::move(endpoint_channel), listener_,
+                       connection_token);
+
+  EXPECT_TRUE(keep_alive_written.Await(absl::Milliseconds(1000)).result());
+  em_.UnregisterEndpoint(client_.get(), endpoint_id_);
+  EXPECT_TRUE(closed.Await(absl::Milliseconds(1000)).result());
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST_F(EndpointManagerTest, SharedKeepAliveSchedulerDiscardsTimedOutEndpoint) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableSharedKeepAliveScheduler,
+      true);
+  auto endpoint_channel = std::make_unique<MockEndpointChannel>();
+  CountDownLatch closed(1);
+  EXPECT_CALL(*endpoint_channel, Read(_))
+      .WillRepeatedly([&closed](PacketMetaData& packet_meta_data) {
+        closed.Await();
+        return ExceptionOr<ByteArray>(Exception::kIo);
+      });
+  EXPECT_CALL(*endpoint_channel, Close(_))
+      .WillRepeatedly([&closed](DisconnectionReason reason) {
+        closed.CountDown();
+      });
+  EXPECT_CALL(*endpoint_channel, GetMedium())
+      .WillRepeatedly(Return(Medium::BLE));
+  // Nothing has been read for longer than the keep-alive timeout.
+  EXPECT_CALL(*endpoint_channel, GetLastReadTimestamp())
+      .WillRepeatedly(
+          Return(SystemClock::ElapsedRealtime() - absl::Seconds(60)));
+  EXPECT_CALL(*endpoint_channel, GetLastWriteTimestamp())
+      .WillRepeatedly(Return(SystemClock::ElapsedRealtime()));
+  EXPECT_CALL(mock_listener_.initiated_cb, Call).Times(1);
+  em_.RegisterEndpoint(client_.get(), endpoint_id_, info_, connection_options_,
+                       std::move(endpoint_channel), listener_,
+                       connection_token);
+
+  EXPECT_TRUE(closed.Await(absl::Milliseconds(1000)).result());
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST_F(EndpointManagerTest, AdaptiveKeepAliveIntervalStretchesOverWifi) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableSharedKeepAliveScheduler,
+      true);
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableAdaptiveKeepAliveInterval,
+      true);
+  auto endpoint_channel = std::make_unique<MockEndpointChannel>();
+  CountDownLatch closed(1);
+  CountDownLatch keep_alive_written(1);
+  EXPECT_CALL(*endpoint_channel, Read(_))
+      .WillRepeatedly([&closed](PacketMetaData& packet_meta_data) {
+        closed.Await();
+        return ExceptionOr<ByteArray>(Exception::kIo);
+      });
+  EXPECT_CALL(*endpoint_channel, Write(_))
+      .WillRepeatedly([&keep_alive_written](const ByteArray& data) {
+        keep_alive_written.CountDown();
+        return Exception{Exception::kSuccess};
+      });
+  EXPECT_CALL(*endpoint_channel, Close(_))
+      .WillRepeatedly([&closed](DisconnectionReason reason) {
+        closed.CountDown();
+      });
+  EXPECT_CALL(*endpoint_channel, GetMedium())
+      .WillRepeatedly(Return(Medium::WIFI_LAN));
+  EXPECT_CALL(*endpoint_channel, GetLastReadTimestamp())
+      .WillRepeatedly(Return(SystemClock::ElapsedRealtime()));
+  // Longer ago than the interval, but not than half the timeout.
+  EXPECT_CALL(*endpoint_channel, GetLastWriteTimestamp())
+      .WillRepeatedly(
+          Return(SystemClock::ElapsedRealtime() - absl::Seconds(10)));
+  EXPECT_CALL(mock_listener_.initiated_cb, Call).Times(1);
+  em_.RegisterEndpoint(client_.get(), endpoint_id_, info_, connection_options_,
+                       std::move(endpoint_channel), listener_,
+                       connection_token);
+
+  EXPECT_FALSE(keep_alive_written.Await(absl::Milliseconds(500)).result());
+  em_.UnregisterEndpoint(client_.get(), endpoint_id_);
+  EXPECT_TRUE(closed.Await(absl::Milliseconds(1000)).result());
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 // Regression test for b/278729669.
 //
 // During the destruction of NearbyConnections, Core (which owns ClientProxy)
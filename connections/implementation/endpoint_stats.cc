@@ -0,0 +1,150 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/endpoint_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "absl/time/time.h"
+#include "connections/implementation/analytics/packet_meta_data.h"
+#include "internal/platform/mutex_lock.h"
+#include "internal/platform/system_clock.h"
+
+namespace nearby {
+namespace connections {
+
+namespace {
+
+absl::Duration GetElapsed(absl::Time start, absl::Time end) {
+  return end > start ? end - start : absl::ZeroDuration();
+}
+
+}  // namespace
+
+constexpr absl::Duration EndpointStatsRecorder::kThroughputTimeConstant;
+
+void EndpointStatsRecorder::SetMedium(
+    location::nearby::proto::connections::Medium medium) {
+  MutexLock lock(&mutex_);
+  stats_.medium = medium;
+  stats_.medium_bytes = 0;
+  stats_.medium_peak_bytes_per_second = 0;
+}
+
+void EndpointStatsRecorder::RecordRead(
+    const analytics::PacketMetaData& packet_meta_data, bool decrypted) {
+  MutexLock lock(&mutex_);
+  stats_.bytes_read += packet_meta_data.packet_size;
+  ++stats_.frames_read;
+  AddSample(read_throughput_, packet_meta_data.packet_size,
+            packet_meta_data.socket_io_end_time);
+  stats_.medium_bytes += packet_meta_data.packet_size;
+  stats_.medium_peak_bytes_per_second =
+      std::max(stats_.medium_peak_bytes_per_second,
+               read_throughput_.bytes_per_second);
+  if (decrypted) {
+    stats_.encryption_time += GetElapsed(packet_meta_data.encryption_start_time,
+                                         packet_meta_data.encryption_end_time);
+  }
+}
+
+void EndpointStatsRecorder::RecordWrite(
+    int frames, const analytics::PacketMetaData& packet_meta_data,
+    bool encrypted) {
+  MutexLock lock(&mutex_);
+  stats_.bytes_written += packet_meta_data.packet_size;
+  stats_.frames_written += frames;
+  AddSample(write_throughput_, packet_meta_data.packet_size,
+            packet_meta_data.socket_io_end_time);
+  stats_.medium_bytes += packet_meta_data.packet_size;
+  stats_.medium_peak_bytes_per_second =
+      std::max(stats_.medium_peak_bytes_per_second,
+               write_throughput_.bytes_per_second);
+  if (encrypted) {
+    stats_.encryption_time += GetElapsed(packet_meta_data.encryption_start_time,
+                                         packet_meta_data.encryption_end_time);
+  }
+
+  std::int64_t micros = absl::ToInt64Microseconds(
+      GetElapsed(packet_meta_data.socket_io_start_time,
+                 packet_meta_data.socket_io_end_time));
+  int bucket = 0;
+  while (bucket < kLatencyBuckets - 1 && (std::int64_t{1} << bucket) < micros) {
+    ++bucket;
+  }
+  ++write_latencies_[bucket];
+  ++write_count_;
+}
+
+EndpointStats EndpointStatsRecorder::GetStats() const {
+  return GetStats(SystemClock::ElapsedRealtime());
+}
+
+EndpointStats EndpointStatsRecorder::GetStats(absl::Time now) const {
+  MutexLock lock(&mutex_);
+  EndpointStats stats = stats_;
+  stats.read_bytes_per_second = GetRate(read_throughput_, now);
+  stats.write_bytes_per_second = GetRate(write_throughput_, now);
+  stats.write_latency_p50 = GetLatencyPercentile(0.5);
+  stats.write_latency_p90 = GetLatencyPercentile(0.9);
+  stats.write_latency_p99 = GetLatencyPercentile(0.99);
+  stats.write_queue_depth = write_queue_depth_.load();
+  return stats;
+}
+
+// Every sample decays the rate by e^(-elapsed / kThroughputTimeConstant) and
+// adds its bytes spread over kThroughputTimeConstant, so a steady stream of
+// samples converges to its actual rate.
+void EndpointStatsRecorder::AddSample(Throughput& throughput,
+                                      std::int64_t bytes, absl::Time now) {
+  if (throughput.last_sample != absl::InfinitePast() &&
+      now > throughput.last_sample) {
+    throughput.bytes_per_second *=
+        std::exp(-absl::FDivDuration(now - throughput.last_sample,
+                                     kThroughputTimeConstant));
+  }
+  throughput.bytes_per_second +=
+      bytes / absl::ToDoubleSeconds(kThroughputTimeConstant);
+  if (now > throughput.last_sample) throughput.last_sample = now;
+}
+
+double EndpointStatsRecorder::GetRate(const Throughput& throughput,
+                                      absl::Time now) {
+  if (throughput.last_sample == absl::InfinitePast() ||
+      now <= throughput.last_sample) {
+    return throughput.bytes_per_second;
+  }
+  return throughput.bytes_per_second *
+         std::exp(-absl::FDivDuration(now - throughput.last_sample,
+                                      kThroughputTimeConstant));
+}
+
+absl::Duration EndpointStatsRecorder::GetLatencyPercentile(
+    double fraction) const {
+  if (write_count_ == 0) return absl::ZeroDuration();
+  // The smallest latency that at least |fraction| of the writes didn't exceed.
+  std::int64_t rank =
+      static_cast<std::int64_t>(std::ceil(fraction * write_count_));
+  std::int64_t count = 0;
+  for (int bucket = 0; bucket < kLatencyBuckets; ++bucket) {
+    count += write_latencies_[bucket];
+    if (count >= rank) return absl::Microseconds(std::int64_t{1} << bucket);
+  }
+  return absl::Microseconds(std::int64_t{1} << (kLatencyBuckets - 1));
+}
+
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,117 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_ENDPOINT_STATS_H_
+#define CORE_INTERNAL_ENDPOINT_STATS_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/time/time.h"
+#include "connections/implementation/analytics/packet_meta_data.h"
+#include "internal/platform/mutex.h"
+#include "proto/connections_enums.pb.h"
+
+namespace nearby {
+namespace connections {
+
+// Transport statistics of a connected endpoint, across all the channels it has
+// used so far.
+struct EndpointStats {
+  // The medium of the current channel of the endpoint.
+  location::nearby::proto::connections::Medium medium =
+      location::nearby::proto::connections::UNKNOWN_MEDIUM;
+  // Bytes on the wire, including length prefixes and encryption overhead.
+  std::int64_t bytes_read = 0;
+  std::int64_t bytes_written = 0;
+  std::int64_t frames_read = 0;
+  std::int64_t frames_written = 0;
+  // Exponentially smoothed throughput over roughly the last
+  // EndpointStatsRecorder::kThroughputTimeConstant, in bytes per second.
+  double read_bytes_per_second = 0;
+  double write_bytes_per_second = 0;
+  // Bytes read and written over the current medium, and the highest of the
+  // above throughputs seen on it.
+  std::int64_t medium_bytes = 0;
+  double medium_peak_bytes_per_second = 0;
+  // Percentiles of the time spent writing to the channel, rounded up to the
+  // next power of two microseconds. Zero until something has been written.
+  absl::Duration write_latency_p50 = absl::ZeroDuration();
+  absl::Duration write_latency_p90 = absl::ZeroDuration();
+  absl::Duration write_latency_p99 = absl::ZeroDuration();
+  // Writes that are waiting for or holding the channel.
+  int write_queue_depth = 0;
+  // Total time spent encrypting and decrypting frames.
+  absl::Duration encryption_time = absl::ZeroDuration();
+};
+
+// Updates the EndpointStats of an endpoint as its channels read and write
+// frames, in constant time and space per frame. Thread-safe.
+class EndpointStatsRecorder {
+ public:
+  static constexpr absl::Duration kThroughputTimeConstant = absl::Seconds(2);
+
+  void SetMedium(location::nearby::proto::connections::Medium medium);
+
+  // Records a frame read, as described by |packet_meta_data|, at the end of
+  // its socket IO. |decrypted| tells whether its encryption times are from
+  // this frame.
+  void RecordRead(const analytics::PacketMetaData& packet_meta_data,
+                  bool decrypted);
+
+  // Records |frames| written in one go, as described by |packet_meta_data|.
+  void RecordWrite(int frames, const analytics::PacketMetaData& packet_meta_data,
+                   bool encrypted);
+
+  // Brackets a write, from before it waits for the channel until it's done.
+  void OnWriteQueued() { ++write_queue_depth_; }
+  void OnWriteDone() { --write_queue_depth_; }
+
+  EndpointStats GetStats() const;
+  // As GetStats(), with throughput decayed up to |now| rather than the
+  // current time.
+  EndpointStats GetStats(absl::Time now) const;
+
+ private:
+  // Buckets of write latencies: bucket i counts latencies of up to 2^i us.
+  static constexpr int kLatencyBuckets = 32;
+
+  struct Throughput {
+    double bytes_per_second = 0;
+    absl::Time last_sample = absl::InfinitePast();
+  };
+
+  static void AddSample(Throughput& throughput, std::int64_t bytes,
+                        absl::Time now);
+  static double GetRate(const Throughput& throughput, absl::Time now);
+  absl::Duration GetLatencyPercentile(double fraction) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  std::atomic<int> write_queue_depth_{0};
+
+  mutable Mutex mutex_;
+  EndpointStats stats_ ABSL_GUARDED_BY(mutex_);
+  Throughput read_throughput_ ABSL_GUARDED_BY(mutex_);
+  Throughput write_throughput_ ABSL_GUARDED_BY(mutex_);
+  std::array<std::int64_t, kLatencyBuckets> write_latencies_
+      ABSL_GUARDED_BY(mutex_) = {};
+  std::int64_t write_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_ENDPOINT_STATS_H_
@@ -0,0 +1,133 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/endpoint_stats.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "connections/implementation/analytics/packet_meta_data.h"
+#include "proto/connections_enums.pb.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+using ::location::nearby::proto::connections::Medium;
+using ::nearby::analytics::PacketMetaData;
+
+const absl::Time kStart = absl::FromUnixSeconds(1000);
+
+PacketMetaData MakePacket(int size, absl::Time end,
+                          absl::Duration socket_io_time = absl::ZeroDuration(),
+                          absl::Duration encryption_time =
+                              absl::ZeroDuration()) {
+  PacketMetaData packet_meta_data;
+  packet_meta_data.packet_size = size;
+  packet_meta_data.socket_io_start_time = end - socket_io_time;
+  packet_meta_data.socket_io_end_time = end;
+  packet_meta_data.encryption_start_time = end - encryption_time;
+  packet_meta_data.encryption_end_time = end;
+  return packet_meta_data;
+}
+
+TEST(EndpointStatsRecorderTest, StartsEmpty) {
+  EndpointStatsRecorder recorder;
+  EndpointStats stats = recorder.GetStats();
+  EXPECT_EQ(stats.medium, Medium::UNKNOWN_MEDIUM);
+  EXPECT_EQ(stats.bytes_read, 0);
+  EXPECT_EQ(stats.frames_written, 0);
+  EXPECT_EQ(stats.read_bytes_per_second, 0);
+  EXPECT_EQ(stats.write_latency_p99, absl::ZeroDuration());
+  EXPECT_EQ(stats.write_queue_depth, 0);
+}
+
+TEST(EndpointStatsRecorderTest, CountsBytesAndFrames) {
+  EndpointStatsRecorder recorder;
+  recorder.SetMedium(Medium::WIFI_LAN);
+  recorder.RecordRead(MakePacket(100, kStart), false);
+  recorder.RecordRead(MakePacket(50, kStart), false);
+  recorder.RecordWrite(3, MakePacket(300, kStart), false);
+
+  EndpointStats stats = recorder.GetStats(kStart);
+  EXPECT_EQ(stats.medium, Medium::WIFI_LAN);
+  EXPECT_EQ(stats.bytes_read, 150);
+  EXPECT_EQ(stats.frames_read, 2);
+  EXPECT_EQ(stats.bytes_written, 300);
+  EXPECT_EQ(stats.frames_written, 3);
+}
+
+TEST(EndpointStatsRecorderTest, SmoothedThroughputConvergesAndDecays) {
+  EndpointStatsRecorder recorder;
+  // 1000 bytes every 10 ms, i.e. 100000 bytes per second.
+  absl::Time now = kStart;
+  for (int i = 0; i < 2000; ++i) {
+    now += absl::Milliseconds(10);
+    recorder.RecordWrite(1, MakePacket(1000, now), false);
+  }
+  EXPECT_NEAR(recorder.GetStats(now).write_bytes_per_second, 100000, 1000);
+  EXPECT_EQ(recorder.GetStats(now).read_bytes_per_second, 0);
+
+  double decayed =
+      recorder
+          .GetStats(now + EndpointStatsRecorder::kThroughputTimeConstant)
+          .write_bytes_per_second;
+  EXPECT_NEAR(decayed, 100000 / std::exp(1), 1000);
+}
+
+TEST(EndpointStatsRecorderTest, ReportsWriteLatencyPercentiles) {
+  EndpointStatsRecorder recorder;
+  for (int i = 0; i < 98; ++i) {
+    recorder.RecordWrite(1, MakePacket(10, kStart, absl::Microseconds(100)),
+                         false);
+  }
+  recorder.RecordWrite(1, MakePacket(10, kStart, absl::Milliseconds(10)),
+                       false);
+  recorder.RecordWrite(1, MakePacket(10, kStart, absl::Seconds(1)), false);
+
+  EndpointStats stats = recorder.GetStats(kStart);
+  EXPECT_EQ(stats.write_latency_p50, absl::Microseconds(128));
+  EXPECT_EQ(stats.write_latency_p90, absl::Microseconds(128));
+  EXPECT_EQ(stats.write_latency_p99, absl::Microseconds(16384));
+}
+
+TEST(EndpointStatsRecorderTest, AddsUpEncryptionTimeOfEncryptedFrames) {
+  EndpointStatsRecorder recorder;
+  recorder.RecordWrite(
+      1, MakePacket(10, kStart, absl::ZeroDuration(), absl::Milliseconds(2)),
+      true);
+  recorder.RecordRead(
+      MakePacket(10, kStart, absl::ZeroDuration(), absl::Milliseconds(3)),
+      true);
+  // Stale encryption times of a frame sent in the clear are ignored.
+  recorder.RecordRead(
+      MakePacket(10, kStart, absl::ZeroDuration(), absl::Milliseconds(5)),
+      false);
+
+  EXPECT_EQ(recorder.GetStats(kStart).encryption_time, absl::Milliseconds(5));
+}
+
+TEST(EndpointStatsRecorderTest, TracksWriteQueueDepth) {
+  EndpointStatsRecorder recorder;
+  recorder.OnWriteQueued();
+  recorder.OnWriteQueued();
+  EXPECT_EQ(recorder.GetStats().write_queue_depth, 2);
+  recorder.OnWriteDone();
+  EXPECT_EQ(recorder.GetStats().write_queue_depth, 1);
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
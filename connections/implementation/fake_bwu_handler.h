@@ -60,6 +60,8 @@ class FakeBwuHandler : public BaseBwuHandler {
   const std::vector<InputData>& handle_revert_calls() const {
     return handle_revert_calls_;
   }
+  int prepare_calls() const { return prepare_calls_; }
+  int revert_prepared_calls() const { return revert_prepared_calls_; }
 
   // Builds an incoming connection corresponding to
   // handle_initialize_calls()[initialize_call_index], and sends it to the
@@ -121,6 +123,10 @@ class FakeBwuHandler : public BaseBwuHandler {
     disconnect_calls_.push_back({.client = client, .endpoint_id = endpoint_id});
   }
 
+  void PrepareUpgradedMedium() final { prepare_calls_++; }
+
+  void RevertPreparedUpgradedMedium() final { revert_prepared_calls_++; }
+
   // BaseBwuHandler:
   ByteArray HandleInitializeUpgradedMediumForEndpoint(
       ClientProxy* client, const std::string& upgrade_service_id,
@@ -170,6 +176,8 @@ class FakeBwuHandler : public BaseBwuHandler {
   std::vector<InputData> disconnect_calls_;
   std::vector<InputData> handle_initialize_calls_;
   std::vector<InputData> handle_revert_calls_;
+  int prepare_calls_ = 0;
+  int revert_prepared_calls_ = 0;
 };
 
 }  // namespace connections
@@ -15,7 +15,9 @@
 #ifndef NEARBY_CONNECTIONS_IMPLEMENTATION_FAKE_ENDPOINT_CHANNEL_H_
 #define NEARBY_CONNECTIONS_IMPLEMENTATION_FAKE_ENDPOINT_CHANNEL_H_
 
+#include <functional>
 #include <string>
+#include <utility>
 
 #include "connections/implementation/endpoint_channel.h"
 #include "internal/platform/byte_array.h"
@@ -37,6 +39,7 @@ class FakeEndpointChannel : public EndpointChannel {
   // EndpointChannel:
   ExceptionOr<ByteArray> Read() override {
     read_timestamp_ = SystemClock::ElapsedRealtime();
+    if (read_callback_) read_callback_();
     return read_output_;
   }
   ExceptionOr<ByteArray> Read(PacketMetaData& packet_meta_data) override {
@@ -45,11 +48,13 @@ class FakeEndpointChannel : public EndpointChannel {
   }
   Exception Write(const ByteArray& data) override {
     write_timestamp_ = SystemClock::ElapsedRealtime();
+    if (write_callback_) write_callback_(data);
     return write_output_;
   }
   Exception Write(const ByteArray& data,
                   PacketMetaData& packet_meta_data) override {
     write_timestamp_ = SystemClock::ElapsedRealtime();
+    if (write_callback_) write_callback_(data);
     return write_output_;
   }
   void Close() override { is_closed_ = true; }
@@ -76,6 +81,7 @@ class FakeEndpointChannel : public EndpointChannel {
   Medium GetMedium() const override { return medium_; }
   int GetMaxTransmitPacketSize() const override { return 512; }
   void EnableEncryption(std::shared_ptr<EncryptionContext> context) override {}
+  void EnableAeadEncryption(std::shared_ptr<AeadFrameCipher> cipher) override {}
   void DisableEncryption() override {}
   bool IsPaused() const override { return is_paused_; }
   void Pause() override { is_paused_ = true; }
@@ -86,7 +92,15 @@ class FakeEndpointChannel : public EndpointChannel {
                             const std::string& endpoint_id) override {}
 
   void set_read_output(ExceptionOr<ByteArray> output) { read_output_ = output; }
+  // Invoked on every Read(), before the read output is returned.
+  void set_read_callback(std::function<void()> callback) {
+    read_callback_ = std::move(callback);
+  }
   void set_write_output(Exception output) { write_output_ = output; }
+  // Invoked on every Write(), with the data written.
+  void set_write_callback(std::function<void(const ByteArray&)> callback) {
+    write_callback_ = std::move(callback);
+  }
   bool is_closed() const { return is_closed_; }
   location::nearby::proto::connections::DisconnectionReason
   disconnection_reason() const {
@@ -95,7 +109,9 @@ class FakeEndpointChannel : public EndpointChannel {
 
  private:
   ExceptionOr<ByteArray> read_output_;
+  std::function<void()> read_callback_;
   Exception write_output_{Exception::kSuccess};
+  std::function<void(const ByteArray&)> write_callback_;
   Medium medium_;
   std::string service_id_;
   absl::Time read_timestamp_ = absl::InfinitePast();
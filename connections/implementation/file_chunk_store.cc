@@ -0,0 +1,166 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/file_chunk_store.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/crypto.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/file.h"
+#include "internal/platform/logging.h"
+#include "internal/platform/mutex_lock.h"
+
+namespace nearby {
+namespace connections {
+
+namespace {
+
+// Reads exactly |size| bytes from |file|, or returns std::nullopt.
+std::optional<ByteArray> ReadFully(InputFile& file, std::int64_t size) {
+  std::string bytes;
+  bytes.reserve(size);
+  while (static_cast<std::int64_t>(bytes.size()) < size) {
+    ExceptionOr<ByteArray> read = file.Read(size - bytes.size());
+    if (!read.ok() || read.result().Empty()) return std::nullopt;
+    bytes.append(read.result().data(), read.result().size());
+  }
+  return ByteArray(std::move(bytes));
+}
+
+}  // namespace
+
+std::optional<FileChunkStore::ChunkManifest> FileChunkStore::CreateManifest(
+    InputFile& file, std::int64_t offset, int max_chunks) {
+  std::int64_t total_size = file.GetTotalSize();
+  if (offset < 0 || offset >= total_size || max_chunks <= 0) {
+    return std::nullopt;
+  }
+
+  ChunkManifest manifest;
+  manifest.set_chunk_size(kChunkSize);
+  std::int64_t end = std::min(total_size, offset + max_chunks * kChunkSize);
+  for (; offset < end; offset += kChunkSize) {
+    std::optional<ByteArray> chunk =
+        ReadFully(file, std::min(kChunkSize, total_size - offset));
+    if (!chunk.has_value()) {
+      NEARBY_LOGS(WARNING) << "Failed to hash file " << file.GetFilePath()
+                           << " at offset " << offset;
+      return std::nullopt;
+    }
+    manifest.add_chunk_hashes(
+        std::string(Crypto::Sha256(chunk->AsStringView())));
+  }
+  return manifest;
+}
+
+std::optional<ByteArray> FileChunkStore::ReadChunk(const Location& location,
+                                                    std::int64_t size,
+                                                    absl::string_view hash) {
+  InputFile file(location.file_path, location.file_size);
+  if (location.offset > 0) {
+    ExceptionOr<size_t> skipped = file.Skip(location.offset);
+    if (!skipped.ok() ||
+        static_cast<std::int64_t>(skipped.result()) != location.offset) {
+      file.Close();
+      return std::nullopt;
+    }
+  }
+  std::optional<ByteArray> chunk = ReadFully(file, size);
+  file.Close();
+  if (!chunk.has_value() ||
+      std::string(Crypto::Sha256(chunk->AsStringView())) != hash) {
+    return std::nullopt;
+  }
+  return chunk;
+}
+
+std::string FileChunkStore::EncodePresentChunks(
+    const std::vector<bool>& present) {
+  std::string bytes((present.size() + 7) / 8, '\0');
+  for (size_t i = 0; i < present.size(); ++i) {
+    if (present[i]) bytes[i / 8] |= static_cast<char>(1 << (i % 8));
+  }
+  return bytes;
+}
+
+std::vector<bool> FileChunkStore::DecodePresentChunks(absl::string_view bytes,
+                                                      int chunk_count) {
+  std::vector<bool> present(chunk_count, false);
+  for (int i = 0; i < chunk_count && i / 8 < static_cast<int>(bytes.size());
+       ++i) {
+    present[i] = (bytes[i / 8] & (1 << (i % 8))) != 0;
+  }
+  return present;
+}
+
+void FileChunkStore::AddFile(const std::string& file_path,
+                             std::int64_t file_size,
+                             const ChunkManifest& manifest,
+                             std::int64_t written_size) {
+  if (file_path.empty() || manifest.chunk_size() <= 0) return;
+
+  MutexLock lock(&mutex_);
+  if (files_.size() >= kMaxFiles) RemoveOldestFile();
+
+  File file{.path = file_path, .size = file_size};
+  std::int64_t file_number = first_file_number_ + files_.size();
+  for (int i = 0; i < manifest.chunk_hashes_size(); ++i) {
+    std::int64_t offset = i * manifest.chunk_size();
+    std::int64_t end = std::min(offset + manifest.chunk_size(), file_size);
+    if (end > written_size) break;
+    file.chunk_hashes.push_back(manifest.chunk_hashes(i));
+    chunks_[manifest.chunk_hashes(i)] =
+        ChunkRef{.file_number = file_number, .offset = offset};
+  }
+  files_.push_back(std::move(file));
+}
+
+std::optional<FileChunkStore::Location> FileChunkStore::Find(
+    absl::string_view hash) const {
+  MutexLock lock(&mutex_);
+  auto it = chunks_.find(hash);
+  if (it == chunks_.end()) return std::nullopt;
+  const File& file = files_[it->second.file_number - first_file_number_];
+  return Location{.file_path = file.path,
+                  .file_size = file.size,
+                  .offset = it->second.offset};
+}
+
+void FileChunkStore::Remove(absl::string_view hash) {
+  MutexLock lock(&mutex_);
+  chunks_.erase(hash);
+}
+
+void FileChunkStore::RemoveOldestFile() {
+  for (const std::string& hash : files_.front().chunk_hashes) {
+    auto it = chunks_.find(hash);
+    // Chunks found again in a newer file now point there.
+    if (it != chunks_.end() && it->second.file_number == first_file_number_) {
+      chunks_.erase(it);
+    }
+  }
+  files_.pop_front();
+  ++first_file_number_;
+}
+
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,121 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_FILE_CHUNK_STORE_H_
+#define CORE_INTERNAL_FILE_CHUNK_STORE_H_
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/file.h"
+#include "internal/platform/mutex.h"
+
+namespace nearby {
+namespace connections {
+
+// The chunks of the FILE payloads received so far, found by content hash, so
+// that a sender's PAYLOAD_MANIFEST can be answered with the chunks that don't
+// need to be sent again.
+//
+// Only the location of each chunk is kept; its content is read back from the
+// received file, and checked against the hash, when it is needed. Files that
+// were moved or changed since simply stop matching. Partially received files
+// are indexed up to where they were written. The index is kept in memory and
+// covers the last kMaxFiles files. Thread-safe.
+class FileChunkStore {
+ public:
+  using ChunkManifest = location::nearby::connections::PayloadTransferFrame::
+      ChunkManifest;
+
+  // Size of the chunks of the manifests sent.
+  static constexpr std::int64_t kChunkSize = 1024 * 1024;
+  // The most chunks a manifest covers. A file is announced one manifest at a
+  // time, as its sender gets to the chunks, so that it isn't read twice before
+  // it starts going out.
+  static constexpr int kMaxChunks = 64;
+  static constexpr int kMaxFiles = 16;
+
+  struct Location {
+    std::string file_path;
+    std::int64_t file_size = 0;
+    std::int64_t offset = 0;
+  };
+
+  // Hashes up to |max_chunks| chunks of |file| from |offset| on, which is
+  // where |file| was read up to. Returns std::nullopt if it can't be read, or
+  // ends before |offset|.
+  static std::optional<ChunkManifest> CreateManifest(InputFile& file,
+                                                     std::int64_t offset,
+                                                     int max_chunks);
+
+  // Reads the |size| bytes at |location| and returns them if they still hash
+  // to |hash|.
+  static std::optional<ByteArray> ReadChunk(const Location& location,
+                                            std::int64_t size,
+                                            absl::string_view hash);
+
+  // Converts between the present_chunks of a PAYLOAD_MANIFEST_REPLY and one
+  // bool per chunk.
+  static std::string EncodePresentChunks(const std::vector<bool>& present);
+  static std::vector<bool> DecodePresentChunks(absl::string_view bytes,
+                                               int chunk_count);
+
+  // Indexes the chunks of the file at |file_path|, whose content is described
+  // by |manifest|, that lie within its first |written_size| bytes.
+  void AddFile(const std::string& file_path, std::int64_t file_size,
+               const ChunkManifest& manifest, std::int64_t written_size)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns where a chunk hashing to |hash| was received, if anywhere.
+  std::optional<Location> Find(absl::string_view hash) const
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Drops the chunk hashing to |hash|, once it was found not to be where it
+  // was received anymore.
+  void Remove(absl::string_view hash) ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  struct File {
+    std::string path;
+    std::int64_t size = 0;
+    std::vector<std::string> chunk_hashes;
+  };
+  struct ChunkRef {
+    // Index into |files_| counted from the first file ever added, so that
+    // evicting a file doesn't move the others.
+    std::int64_t file_number;
+    std::int64_t offset;
+  };
+
+  void RemoveOldestFile() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  mutable Mutex mutex_;
+  std::deque<File> files_ ABSL_GUARDED_BY(mutex_);
+  // The number of the first file in |files_|.
+  std::int64_t first_file_number_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::flat_hash_map<std::string, ChunkRef> chunks_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_FILE_CHUNK_STORE_H_
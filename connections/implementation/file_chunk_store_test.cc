@@ -0,0 +1,190 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/file_chunk_store.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "connections/payload.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/file.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+using ::testing::ElementsAre;
+
+constexpr std::int64_t kChunkSize = FileChunkStore::kChunkSize;
+
+// Writes |contents| to a new file and returns its path.
+std::string CreateFile(const std::string& contents) {
+  Payload::Id payload_id = Payload::GenerateId();
+  OutputFile output_file(payload_id);
+  EXPECT_TRUE(output_file.Write(ByteArray(contents)).Ok());
+  EXPECT_TRUE(output_file.Close().Ok());
+  return InputFile(payload_id, contents.size()).GetFilePath();
+}
+
+std::optional<FileChunkStore::ChunkManifest> CreateManifest(
+    const std::string& path, std::int64_t size) {
+  InputFile file(path, size);
+  std::optional<FileChunkStore::ChunkManifest> manifest =
+      FileChunkStore::CreateManifest(file, 0, FileChunkStore::kMaxChunks);
+  file.Close();
+  return manifest;
+}
+
+std::string CreateContents() {
+  std::string contents(2 * kChunkSize + 100, 'a');
+  for (std::size_t i = kChunkSize; i < 2 * kChunkSize; ++i) contents[i] = 'b';
+  contents.replace(2 * kChunkSize, 100, 100, 'c');
+  return contents;
+}
+
+TEST(FileChunkStoreTest, CreatesManifestWithShorterLastChunk) {
+  std::string contents = CreateContents();
+  std::string path = CreateFile(contents);
+
+  std::optional<FileChunkStore::ChunkManifest> manifest =
+      CreateManifest(path, contents.size());
+
+  ASSERT_TRUE(manifest.has_value());
+  EXPECT_EQ(manifest->chunk_size(), kChunkSize);
+  ASSERT_EQ(manifest->chunk_hashes_size(), 3);
+  EXPECT_NE(manifest->chunk_hashes(0), manifest->chunk_hashes(1));
+  EXPECT_EQ(manifest->chunk_hashes(0).size(), 32);
+}
+
+TEST(FileChunkStoreTest, CreatesManifestOfChunksFromOffset) {
+  std::string contents = CreateContents();
+  std::string path = CreateFile(contents);
+  std::optional<FileChunkStore::ChunkManifest> whole_manifest =
+      CreateManifest(path, contents.size());
+  ASSERT_TRUE(whole_manifest.has_value());
+
+  InputFile file(path, contents.size());
+  ASSERT_TRUE(file.Skip(kChunkSize).ok());
+  std::optional<FileChunkStore::ChunkManifest> manifest =
+      FileChunkStore::CreateManifest(file, kChunkSize, 1);
+  file.Close();
+
+  ASSERT_TRUE(manifest.has_value());
+  ASSERT_EQ(manifest->chunk_hashes_size(), 1);
+  EXPECT_EQ(manifest->chunk_hashes(0), whole_manifest->chunk_hashes(1));
+}
+
+TEST(FileChunkStoreTest, FindsChunksOfAddedFiles) {
+  std::string contents = CreateContents();
+  std::string path = CreateFile(contents);
+  std::optional<FileChunkStore::ChunkManifest> manifest =
+      CreateManifest(path, contents.size());
+  ASSERT_TRUE(manifest.has_value());
+  FileChunkStore store;
+
+  store.AddFile(path, contents.size(), *manifest, contents.size());
+
+  std::optional<FileChunkStore::Location> location =
+      store.Find(manifest->chunk_hashes(2));
+  ASSERT_TRUE(location.has_value());
+  EXPECT_EQ(location->file_path, path);
+  EXPECT_EQ(location->offset, 2 * kChunkSize);
+  std::optional<ByteArray> chunk =
+      FileChunkStore::ReadChunk(*location, 100, manifest->chunk_hashes(2));
+  ASSERT_TRUE(chunk.has_value());
+  EXPECT_EQ(std::string(*chunk), std::string(100, 'c'));
+}
+
+TEST(FileChunkStoreTest, IndexesPartialFilesUpToWrittenSize) {
+  std::string contents = CreateContents();
+  std::string path = CreateFile(contents);
+  std::optional<FileChunkStore::ChunkManifest> manifest =
+      CreateManifest(path, contents.size());
+  ASSERT_TRUE(manifest.has_value());
+  FileChunkStore store;
+
+  store.AddFile(path, contents.size(), *manifest, kChunkSize + 10);
+
+  EXPECT_TRUE(store.Find(manifest->chunk_hashes(0)).has_value());
+  EXPECT_FALSE(store.Find(manifest->chunk_hashes(1)).has_value());
+  EXPECT_FALSE(store.Find(manifest->chunk_hashes(2)).has_value());
+}
+
+TEST(FileChunkStoreTest, DoesNotReadChangedChunks) {
+  std::string contents = CreateContents();
+  std::string path = CreateFile(contents);
+  std::optional<FileChunkStore::ChunkManifest> manifest =
+      CreateManifest(path, contents.size());
+  ASSERT_TRUE(manifest.has_value());
+
+  FileChunkStore::Location location{
+      .file_path = path, .file_size = static_cast<std::int64_t>(contents.size())};
+  EXPECT_FALSE(FileChunkStore::ReadChunk(location, kChunkSize,
+                                         manifest->chunk_hashes(1))
+                   .has_value());
+}
+
+TEST(FileChunkStoreTest, ForgetsRemovedChunks) {
+  FileChunkStore store;
+  FileChunkStore::ChunkManifest manifest;
+  manifest.set_chunk_size(kChunkSize);
+  manifest.add_chunk_hashes("changed");
+  manifest.add_chunk_hashes("kept");
+  store.AddFile("file", 2 * kChunkSize, manifest, 2 * kChunkSize);
+
+  store.Remove("changed");
+
+  EXPECT_FALSE(store.Find("changed").has_value());
+  EXPECT_TRUE(store.Find("kept").has_value());
+}
+
+TEST(FileChunkStoreTest, ForgetsOldestFiles) {
+  FileChunkStore store;
+  FileChunkStore::ChunkManifest first_manifest;
+  first_manifest.set_chunk_size(kChunkSize);
+  first_manifest.add_chunk_hashes("first");
+  store.AddFile("first", 10, first_manifest, 10);
+
+  FileChunkStore::ChunkManifest manifest;
+  manifest.set_chunk_size(kChunkSize);
+  manifest.add_chunk_hashes("other");
+  for (int i = 0; i < FileChunkStore::kMaxFiles; ++i) {
+    store.AddFile("other", 10, manifest, 10);
+  }
+
+  EXPECT_FALSE(store.Find("first").has_value());
+  EXPECT_TRUE(store.Find("other").has_value());
+}
+
+TEST(FileChunkStoreTest, EncodesPresentChunks) {
+  std::vector<bool> present = {true, false, false, true, false,
+                               false, false, false, true};
+
+  std::string bytes = FileChunkStore::EncodePresentChunks(present);
+
+  EXPECT_EQ(bytes, std::string("\x09\x01", 2));
+  EXPECT_EQ(FileChunkStore::DecodePresentChunks(bytes, present.size()),
+            present);
+  EXPECT_THAT(FileChunkStore::DecodePresentChunks("\x01", 3),
+              ElementsAre(true, false, false));
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
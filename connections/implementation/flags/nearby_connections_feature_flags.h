@@ -44,6 +44,360 @@ constexpr auto kEnableGattQueryInThread =
 constexpr auto kEnablePayloadManagerToSkipChunkUpdate =
     flags::Flag<bool>(kConfigPackage, "45415729", false);
 
+// The number of outgoing FILE payload chunks read ahead of the send loop, so
+// disk reads overlap with encryption and socket writes. 0 disables read-ahead.
+constexpr auto kOutgoingFilePayloadPrefetchChunks =
+    flags::Flag<int64_t>(kConfigPackage, "45415730", 0);
+
+// Enable/Disable writing payload frames to multiple endpoints in parallel
+// instead of one after another.
+constexpr auto kEnableParallelFanOutWrites =
+    flags::Flag<bool>(kConfigPackage, "45415731", false);
+
+// Enable/Disable sizing payload chunks per endpoint from the measured write
+// throughput, instead of using the medium's fixed packet size.
+constexpr auto kEnableAdaptiveChunkSize =
+    flags::Flag<bool>(kConfigPackage, "45415732", false);
+
+// Enable/Disable letting control frames and BYTES payloads ahead of STREAM and
+// FILE payload chunks when they wait to be written to the same channel.
+constexpr auto kEnablePriorityWriteScheduling =
+    flags::Flag<bool>(kConfigPackage, "45415733", false);
+
+// The number of outgoing FILE payloads, and separately STREAM payloads, that
+// may be sent at the same time. BYTES payloads are always sent one at a time,
+// in order.
+constexpr auto kOutgoingPayloadThreads =
+    flags::Flag<int64_t>(kConfigPackage, "45415734", 1);
+
+// Drives keep-alives for all endpoints from one shared timer thread instead of
+// a dedicated thread per endpoint. Reads still block on a per-endpoint thread.
+constexpr auto kEnableSharedKeepAliveScheduler =
+    flags::Flag<bool>(kConfigPackage, "45415735", false);
+
+// Preallocates incoming FILE payloads to their total size and gathers small
+// incoming chunks into larger writes.
+constexpr auto kEnableBatchedIncomingFileWrites =
+    flags::Flag<bool>(kConfigPackage, "45415736", false);
+
+// The number of chunks an incoming STREAM payload buffers before the endpoint
+// stops reading further frames until the client catches up. 0 keeps the
+// buffer unbounded.
+constexpr auto kIncomingStreamPipeCapacity =
+    flags::Flag<int64_t>(kConfigPackage, "45415737", 0);
+
+// Enable/Disable reading the frame type of incoming frames before parsing them,
+// so that frames without a registered processor are dropped unparsed.
+constexpr auto kEnableLazyFrameDispatch =
+    flags::Flag<bool>(kConfigPackage, "45415738", false);
+
+// The minimum time, in milliseconds, between two in-progress payload updates
+// reported to the client for the same payload and endpoint. Updates in between
+// are coalesced into the next reported one. Terminal updates are always
+// reported right away. 0 disables the limit.
+constexpr auto kPayloadProgressMinIntervalMillis =
+    flags::Flag<int64_t>(kConfigPackage, "45415739", 0);
+
+// Like kPayloadProgressMinIntervalMillis, but reports an in-progress update
+// once this many bytes were transferred since the last reported one. Whichever
+// limit is reached first triggers the update. 0 disables the limit.
+constexpr auto kPayloadProgressMinBytes =
+    flags::Flag<int64_t>(kConfigPackage, "45415740", 0);
+
+// Enable/Disable packing small outgoing BYTES payloads, sent within a short
+// linger window to the same endpoints, into a single frame. Only used with
+// endpoints that announce support for it, which this flag also turns on.
+constexpr auto kEnableBytesPayloadBatching =
+    flags::Flag<bool>(kConfigPackage, "45415741", false);
+
+// How long, in milliseconds, a small outgoing BYTES payload may wait for more
+// to join its batch. With 0, only payloads that are already queued up behind
+// each other are batched.
+constexpr auto kBytesPayloadBatchLingerMillis =
+    flags::Flag<int64_t>(kConfigPackage, "45415742", 5);
+
+// Enable/Disable sending a BYTES payload that fits in one chunk as a single
+// frame, with LAST_CHUNK set on its data chunk. Only used with endpoints that
+// announce support for it, which this flag also turns on.
+constexpr auto kEnableSingleFrameBytesPayloads =
+    flags::Flag<bool>(kConfigPackage, "45415743", false);
+
+// Enable/Disable coalescing endpoint channel writes: each frame goes to the
+// medium together with its length prefix in a single write, and the flush is
+// skipped while another write is already lined up behind it.
+constexpr auto kEnableWriteCoalescing =
+    flags::Flag<bool>(kConfigPackage, "45415744", false);
+
+// Enable/Disable resuming the upgraded channel as soon as the remote's
+// SAFE_TO_CLOSE_PRIOR_CHANNEL frame arrives, instead of waiting for the prior
+// channel to finish shutting down.
+constexpr auto kEnableEarlyBwuChannelResume =
+    flags::Flag<bool>(kConfigPackage, "45415745", false);
+
+// Enable/Disable resuming the upgraded channel as soon as our own
+// SAFE_TO_CLOSE_PRIOR_CHANNEL frame, the last encrypted frame we send over the
+// prior channel, has been written.
+constexpr auto kEnableBwuResumeAfterLastPriorChannelWrite =
+    flags::Flag<bool>(kConfigPackage, "45415746", false);
+
+// Enable/Disable racing the most preferred discovered mediums against each
+// other when requesting a connection, instead of trying them one at a time.
+constexpr auto kEnableConnectionRacing =
+    flags::Flag<bool>(kConfigPackage, "45415747", false);
+
+// The number of discovered mediums raced against each other when connection
+// racing is enabled. Mediums beyond these are still tried one at a time if
+// every raced medium fails.
+constexpr auto kConnectionRaceMediumCount =
+    flags::Flag<int64_t>(kConfigPackage, "45415748", 2);
+
+// How long a raced connection attempt gets to itself before the next medium
+// starts racing it, unless it fails sooner.
+constexpr auto kConnectionRaceStaggerMillis =
+    flags::Flag<int64_t>(kConfigPackage, "45415749", 250);
+
+// Enable/Disable remembering endpoints after they are lost, so that a
+// connection can still be requested to them for a while without discovering
+// them again.
+constexpr auto kEnableLostEndpointCache =
+    flags::Flag<bool>(kConfigPackage, "45415750", false);
+
+// How long a lost endpoint is remembered for when the lost endpoint cache is
+// enabled.
+constexpr auto kLostEndpointCacheTtlMillis =
+    flags::Flag<int64_t>(kConfigPackage, "45415751", 30000);
+
+// Enable/Disable resuming a connection from a session ticket of an earlier
+// connection to the same endpoint, instead of running a full UKEY2 handshake.
+constexpr auto kEnableUkey2SessionResumption =
+    flags::Flag<bool>(kConfigPackage, "45415752", false);
+
+// How long the session ticket of a connection can be used to resume a later
+// one.
+constexpr auto kSessionTicketTtlMillis =
+    flags::Flag<int64_t>(kConfigPackage, "45415753", 3600000);
+
+// The number of encryption handshakes, incoming and outgoing together, that
+// may run at the same time. With 1, one incoming and one outgoing handshake
+// run at a time.
+constexpr auto kEncryptionHandshakeThreads =
+    flags::Flag<int64_t>(kConfigPackage, "45415754", 1);
+
+// Enable/Disable encrypting frames with AES-GCM, without SecureMessage
+// envelopes, on connections to endpoints that support it too.
+constexpr auto kEnableAeadFrameEncryption =
+    flags::Flag<bool>(kConfigPackage, "45415755", false);
+
+// How many bytes a WebRTC socket may leave queued in its data channel before
+// writers block. Raise it for high-RTT paths, where a small queue drains
+// before the next write refills it. Never lower than one message.
+constexpr auto kWebRtcMaxBufferedAmountBytes =
+    flags::Flag<int64_t>(kConfigPackage, "45415756", 1 * 1024 * 1024);
+
+// Enable/Disable Bluetooth Classic throughput mode: Bluetooth channels send
+// payloads in chunks of 16 RFCOMM frames instead of 2, and always coalesce
+// each frame with its length prefix into one socket write.
+constexpr auto kEnableBluetoothThroughputMode =
+    flags::Flag<bool>(kConfigPackage, "45415757", false);
+
+// Enable/Disable BLE L2CAP connection-oriented channels: BLE advertises the
+// PSM of an L2CAP server socket where the platform has one, and connects over
+// L2CAP to peripherals that advertise a PSM, falling back to GATT.
+constexpr auto kEnableBleL2capChannels =
+    flags::Flag<bool>(kConfigPackage, "45415758", false);
+
+// The window in millis over which identical BLE advertisements from the same
+// peripheral are dropped by batched scan result processing. 0 disables it.
+constexpr auto kBleScanResultDedupWindowMillis =
+    flags::Flag<int64_t>(kConfigPackage, "45415759", 1000);
+
+// The number of advertisement hashes whose GATT advertisements are cached so
+// that headers with unchanged content are not read again. 0 disables it.
+constexpr auto kBleAdvertisementCacheSize =
+    flags::Flag<int64_t>(kConfigPackage, "45415760", 64);
+
+// How often in millis BLE checks for lost peripherals. Peripherals are still
+// reported lost after kBlePeripheralLostTimeoutMillis, but a shorter interval
+// reports them closer to it. 0 checks once per timeout.
+constexpr auto kBlePeripheralLostCheckIntervalMillis =
+    flags::Flag<int64_t>(kConfigPackage, "45415761", 0);
+
+// How long in millis a GATT client used to read BLE advertisements stays
+// connected after a read, so that further reads from the same peripheral can
+// reuse it. 0 disconnects after every read.
+constexpr auto kBleGattClientIdleTimeoutMillis =
+    flags::Flag<int64_t>(kConfigPackage, "45415762", 5000);
+
+// The most bytes of incoming frames, unread STREAM chunks and unwritten FILE
+// chunks buffered for one endpoint before its reader waits for them to drain.
+// 0 leaves it unbounded.
+constexpr auto kMaxBufferedBytesPerEndpoint =
+    flags::Flag<int64_t>(kConfigPackage, "45415763", 0);
+
+// As kMaxBufferedBytesPerEndpoint, summed over all endpoints of a client.
+constexpr auto kMaxBufferedBytesPerClient =
+    flags::Flag<int64_t>(kConfigPackage, "45415764", 0);
+
+// How many bytes of an incoming STREAM payload the sender may send ahead of
+// what the client has read. The window is granted to the sender with
+// PAYLOAD_CREDIT control messages as the client reads. 0 sends no credit, so
+// senders aren't held back.
+constexpr auto kIncomingStreamCreditWindowBytes =
+    flags::Flag<int64_t>(kConfigPackage, "45415765", 0);
+
+// Records the type, size, timing and medium of every frame EndpointManager
+// reads and writes into FrameTraceRecorder, for offline replay. Frame contents
+// are never recorded.
+constexpr auto kEnableFrameTraceCapture =
+    flags::Flag<bool>(kConfigPackage, "45415766", false);
+
+// Enable/Disable compressing the chunks of BYTES and STREAM payloads sent to
+// endpoints that support it too. Chunks that don't get smaller are sent as
+// they are.
+constexpr auto kEnablePayloadCompression =
+    flags::Flag<bool>(kConfigPackage, "45415767", false);
+
+// With kEnablePayloadCompression, compress the chunks of FILE payloads as
+// well. Off by default since most shared files are already compressed.
+constexpr auto kEnableFilePayloadCompression =
+    flags::Flag<bool>(kConfigPackage, "45415768", false);
+
+// Enable/Disable chunk manifests for FILE payloads sent to a single endpoint
+// that supports them too. The receiver answers with the chunks it already has
+// from earlier transfers, and only the others are sent.
+constexpr auto kEnableFilePayloadChunkDedup =
+    flags::Flag<bool>(kConfigPackage, "45415769", false);
+
+// Enable/Disable receiving FILE_BATCH payloads. Batches are only sent to
+// endpoints that announce it.
+constexpr auto kEnableFileBatchPayloads =
+    flags::Flag<bool>(kConfigPackage, "45415770", false);
+
+// Enable/Disable relaying BYTES payloads sent to many endpoints of a
+// P2P_CLUSTER over a tree of those endpoints, instead of sending it to each of
+// them. Used only if every receiver announces it.
+constexpr auto kEnableClusterPayloadRelay =
+    flags::Flag<bool>(kConfigPackage, "45415771", false);
+
+// The number of endpoints each endpoint of a relay tree forwards a payload to.
+// Payloads to no more endpoints than this are sent to each of them directly.
+constexpr auto kClusterPayloadRelayFanOut =
+    flags::Flag<int64_t>(kConfigPackage, "45415772", 4);
+
+// Enable/Disable remembering where discovered endpoints were found, so that a
+// connection can be requested to them later without discovering them again.
+constexpr auto kEnableKnownEndpointCache =
+    flags::Flag<bool>(kConfigPackage, "45415773", false);
+
+// How long the known endpoint cache remembers an endpoint for after it was last
+// discovered.
+constexpr auto kKnownEndpointCacheTtlMillis =
+    flags::Flag<int64_t>(kConfigPackage, "45415774", 24 * 60 * 60 * 1000);
+
+// Enable/Disable stretching the keep-alive interval up to half the keep-alive
+// timeout on mediums other than Bluetooth, which needs a constant stream of
+// writes to keep the socket open.
+constexpr auto kEnableAdaptiveKeepAliveInterval =
+    flags::Flag<bool>(kConfigPackage, "45415775", false);
+
+// Enable/Disable writing incoming FILE payloads on a thread of their own, so
+// that the endpoint's reader thread only queues the chunks it reads.
+constexpr auto kEnableAsyncIncomingFileWrites =
+    flags::Flag<bool>(kConfigPackage, "45415776", false);
+
+// How long an outgoing STREAM payload waits for the client to write a full
+// chunk to its stream before sending what has been written so far. The stream
+// is then read ahead on a thread of its own. 0 sends whatever each read of the
+// stream returns.
+constexpr auto kOutgoingStreamReadAheadLingerMillis =
+    flags::Flag<int64_t>(kConfigPackage, "45415777", 0);
+
+// Enable/Disable taking turns writing outgoing payload chunks between clients
+// sending to the same endpoints, so that one large payload doesn't hold up the
+// others. Chunks to other endpoints are written alongside. FILE and STREAM
+// payloads are then sent on at least kFairSchedulingPayloadThreads threads.
+constexpr auto kEnableFairPayloadScheduling =
+    flags::Flag<bool>(kConfigPackage, "45415778", false);
+
+// The share of writes each service gets when fair payload scheduling is
+// enabled, as "service_id:weight,service_id:weight". Services not listed get
+// a weight of 1.
+constexpr auto kFairPayloadSchedulingWeights =
+    flags::Flag<absl::string_view>(kConfigPackage, "45415779", "");
+
+// Starts preparing the upgrade medium an incoming connection is expected to be
+// upgraded to, e.g. the soft AP for WiFi Hotspot, while the connection is still
+// being encrypted, instead of once it is accepted.
+constexpr auto kEnableBwuPreparation =
+    flags::Flag<bool>(kConfigPackage, "45415780", false);
+
+// Remembers how well each medium did with each remote device, and tries the
+// mediums that did well with it first the next time, both when connecting and
+// when upgrading the bandwidth.
+constexpr auto kEnableMediumPerformanceHistory =
+    flags::Flag<bool>(kConfigPackage, "45415781", false);
+
+// How long a newly found endpoint is held back before it is reported, so that
+// the other mediums finding it in the meantime don't cause more callbacks, and
+// an endpoint lost again before then is never reported at all. Zero reports
+// endpoints as soon as they are found.
+constexpr auto kDiscoveryCoalescingWindowMillis =
+    flags::Flag<int64_t>(kConfigPackage, "45415782", 0);
+
+// Transport parameters, see TransportConfig. Each is read again for every new
+// connection, so changing one takes effect without a restart. 0 keeps the
+// built-in default.
+//
+// The packet size of mediums that don't define their own, in bytes.
+constexpr auto kMaxTransmitPacketSizeBytes =
+    flags::Flag<int64_t>(kConfigPackage, "45415783", 0);
+
+// The largest frame, in bytes, an endpoint channel reads or writes.
+constexpr auto kMaxFrameSizeBytes =
+    flags::Flag<int64_t>(kConfigPackage, "45415784", 0);
+
+// The keep-alive interval and timeout, in milliseconds, used when a
+// connection doesn't ask for valid ones.
+constexpr auto kKeepAliveIntervalMillis =
+    flags::Flag<int64_t>(kConfigPackage, "45415785", 0);
+constexpr auto kKeepAliveTimeoutMillis =
+    flags::Flag<int64_t>(kConfigPackage, "45415786", 0);
+
+// How long, in milliseconds, a bandwidth upgrade waits for the other side to
+// introduce itself on the new channel.
+constexpr auto kBwuClientIntroductionTimeoutMillis =
+    flags::Flag<int64_t>(kConfigPackage, "45415787", 0);
+
+// The number of incoming connections that may run their handshake at the
+// same time. Further ones wait in a queue, or are rejected with a retry hint
+// once they waited kIncomingConnectionQueueTimeoutMillis. 0 admits all of
+// them right away.
+constexpr auto kMaxConcurrentIncomingHandshakes =
+    flags::Flag<int64_t>(kConfigPackage, "45415788", 0);
+
+// How long an incoming connection may wait for room to run its handshake. 0
+// rejects it right away. Stays well below the remote endpoint's handshake
+// timeout.
+constexpr auto kIncomingConnectionQueueTimeoutMillis =
+    flags::Flag<int64_t>(kConfigPackage, "45415789", 5000);
+
+// How long a rejected incoming connection is asked to wait before connecting
+// again.
+constexpr auto kBusyConnectionRetryAfterMillis =
+    flags::Flag<int64_t>(kConfigPackage, "45415790", 1000);
+
+// How long, in milliseconds, a WiFi Direct group and the connection to it are
+// kept once no upgrade uses them anymore, so that upgrading with the same peer
+// again skips forming the group. 0 tears them down right away.
+constexpr auto kWifiDirectPersistentGroupTimeMillis =
+    flags::Flag<int64_t>(kConfigPackage, "45415791", 0);
+
+// Enable/Disable sending the UKEY2 ClientInit in the ConnectionRequestFrame to
+// endpoints that announced they take it there, saving a message on slow
+// mediums like BLE. A received ClientInit is always answered.
+constexpr auto kEnableCompactHandshake =
+    flags::Flag<bool>(kConfigPackage, "45415792", false);
+
 // LINT.ThenChange(
 //   //depot/google3/location/nearby/cpp/sharing/clients/cpp/nearby_sharing_service_adapter_dart.h,
 //   //depot/google3/location/nearby/cpp/sharing/clients/cpp/nearby_sharing_service_adapter_dart.cc,
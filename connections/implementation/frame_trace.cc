@@ -0,0 +1,127 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/frame_trace.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "internal/platform/mutex_lock.h"
+#include "proto/connections_enums.pb.h"
+
+namespace nearby {
+namespace connections {
+
+namespace {
+
+using ::location::nearby::connections::V1Frame;
+using ::location::nearby::proto::connections::Medium;
+using ::location::nearby::proto::connections::Medium_Name;
+using ::location::nearby::proto::connections::Medium_Parse;
+
+constexpr absl::string_view kIncoming = "in";
+constexpr absl::string_view kOutgoing = "out";
+
+}  // namespace
+
+constexpr int FrameTraceRecorder::kMaxFrames;
+
+std::string FrameTrace::ToString() const {
+  std::string text;
+  for (const Frame& frame : frames) {
+    absl::StrAppend(
+        &text, absl::ToInt64Microseconds(frame.time), " ",
+        frame.direction == Direction::kIncoming ? kIncoming : kOutgoing, " ",
+        frame.endpoint_id, " ", Medium_Name(frame.medium), " ",
+        V1Frame::FrameType_Name(frame.frame_type), " ", frame.size, "\n");
+  }
+  return text;
+}
+
+std::optional<FrameTrace> FrameTrace::FromString(absl::string_view text) {
+  FrameTrace trace;
+  for (absl::string_view line : absl::StrSplit(text, '\n', absl::SkipEmpty())) {
+    std::vector<absl::string_view> fields =
+        absl::StrSplit(line, ' ', absl::SkipEmpty());
+    if (fields.size() != 6) return std::nullopt;
+    Frame frame;
+    std::int64_t micros;
+    Medium medium;
+    V1Frame::FrameType frame_type;
+    if (!absl::SimpleAtoi(fields[0], &micros) || micros < 0 ||
+        !Medium_Parse(std::string(fields[3]), &medium) ||
+        !V1Frame::FrameType_Parse(std::string(fields[4]), &frame_type) ||
+        !absl::SimpleAtoi(fields[5], &frame.size) || frame.size < 0) {
+      return std::nullopt;
+    }
+    if (fields[1] == kIncoming) {
+      frame.direction = Direction::kIncoming;
+    } else if (fields[1] == kOutgoing) {
+      frame.direction = Direction::kOutgoing;
+    } else {
+      return std::nullopt;
+    }
+    frame.time = absl::Microseconds(micros);
+    frame.endpoint_id = std::string(fields[2]);
+    frame.medium = medium;
+    frame.frame_type = frame_type;
+    trace.frames.push_back(std::move(frame));
+  }
+  return trace;
+}
+
+FrameTraceRecorder& FrameTraceRecorder::GetInstance() {
+  static FrameTraceRecorder* recorder = new FrameTraceRecorder();
+  return *recorder;
+}
+
+void FrameTraceRecorder::Record(FrameTrace::Direction direction,
+                                absl::string_view endpoint_id, Medium medium,
+                                V1Frame::FrameType frame_type,
+                                std::int64_t size, absl::Time time) {
+  MutexLock lock(&mutex_);
+  if (trace_.frames.size() >= kMaxFrames) {
+    ++trace_.dropped_frames;
+    return;
+  }
+  if (trace_.frames.empty()) start_time_ = time;
+  trace_.frames.push_back(FrameTrace::Frame{
+      .time = std::max(time - start_time_, absl::ZeroDuration()),
+      .direction = direction,
+      .endpoint_id = std::string(endpoint_id),
+      .medium = medium,
+      .frame_type = frame_type,
+      .size = size,
+  });
+}
+
+FrameTrace FrameTraceRecorder::TakeTrace() {
+  MutexLock lock(&mutex_);
+  FrameTrace trace = std::move(trace_);
+  trace_ = FrameTrace();
+  return trace;
+}
+
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,95 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_FRAME_TRACE_H_
+#define CORE_INTERNAL_FRAME_TRACE_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "internal/platform/mutex.h"
+#include "proto/connections_enums.pb.h"
+
+namespace nearby {
+namespace connections {
+
+// The metadata of the frames exchanged with remote endpoints, in the order
+// they were read or written. Frame contents are never part of a trace.
+struct FrameTrace {
+  enum class Direction {
+    kIncoming = 0,
+    kOutgoing = 1,
+  };
+
+  struct Frame {
+    // Time since the first frame of the trace.
+    absl::Duration time = absl::ZeroDuration();
+    Direction direction = Direction::kIncoming;
+    std::string endpoint_id;
+    location::nearby::proto::connections::Medium medium =
+        location::nearby::proto::connections::UNKNOWN_MEDIUM;
+    location::nearby::connections::V1Frame::FrameType frame_type =
+        location::nearby::connections::V1Frame::UNKNOWN_FRAME_TYPE;
+    // Size of the serialized frame, before encryption.
+    std::int64_t size = 0;
+  };
+
+  std::vector<Frame> frames;
+  // Frames that weren't recorded because the trace was full.
+  std::int64_t dropped_frames = 0;
+
+  // Serializes the trace as text, one frame per line:
+  //   <time in us> <in|out> <endpoint id> <medium> <frame type> <size>
+  std::string ToString() const;
+  // Parses the output of ToString(). Returns nullopt if it is malformed.
+  static std::optional<FrameTrace> FromString(absl::string_view text);
+};
+
+// Captures a FrameTrace of the frames EndpointManager reads and writes, so
+// that traffic seen on a device can be replayed offline, see
+// FrameTraceReplayer. Capture is opt-in through kEnableFrameTraceCapture.
+// Thread-safe.
+class FrameTraceRecorder {
+ public:
+  // Bounds the memory of a trace to a few MB.
+  static constexpr int kMaxFrames = 100000;
+
+  static FrameTraceRecorder& GetInstance();
+
+  // Records a frame at |time|. The first frame after TakeTrace() starts a new
+  // trace.
+  void Record(FrameTrace::Direction direction, absl::string_view endpoint_id,
+              location::nearby::proto::connections::Medium medium,
+              location::nearby::connections::V1Frame::FrameType frame_type,
+              std::int64_t size, absl::Time time) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the frames recorded so far, and starts over.
+  FrameTrace TakeTrace() ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  Mutex mutex_;
+  FrameTrace trace_ ABSL_GUARDED_BY(mutex_);
+  absl::Time start_time_ ABSL_GUARDED_BY(mutex_) = absl::InfinitePast();
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_FRAME_TRACE_H_
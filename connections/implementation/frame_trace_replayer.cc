@@ -0,0 +1,177 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/frame_trace_replayer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "connections/implementation/endpoint_channel.h"
+#include "connections/implementation/endpoint_stats.h"
+#include "connections/implementation/frame_trace.h"
+#include "connections/implementation/offline_frames.h"
+#include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "connections/implementation/wifi_lan_endpoint_channel.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/cancellation_flag.h"
+#include "internal/platform/count_down_latch.h"
+#include "internal/platform/medium_environment.h"
+#include "internal/platform/nsd_service_info.h"
+#include "internal/platform/single_thread_executor.h"
+#include "internal/platform/system_clock.h"
+#include "internal/platform/wifi_lan.h"
+
+namespace nearby {
+namespace connections {
+
+namespace {
+
+using ::location::nearby::connections::PayloadTransferFrame;
+using ::location::nearby::connections::V1Frame;
+
+constexpr char kServiceId[] = "frame-trace-replay";
+constexpr char kServiceType[] = "_replay._tcp";
+// Leaves room for the frame around the body, below the largest frame
+// BaseEndpointChannel reads.
+constexpr std::int64_t kMaxBodySize = (1 << 20) - 1024;
+
+// A PAYLOAD_TRANSFER frame of about |size| bytes.
+ByteArray MakeFrame(std::int64_t payload_id, std::int64_t size) {
+  PayloadTransferFrame::PayloadHeader header;
+  header.set_id(payload_id);
+  header.set_type(PayloadTransferFrame::PayloadHeader::BYTES);
+  header.set_total_size(size);
+  PayloadTransferFrame::PayloadChunk chunk;
+  chunk.set_offset(0);
+  chunk.set_flags(0);
+  const std::int64_t overhead =
+      parser::ForDataPayloadTransfer(header, chunk).size();
+  chunk.set_body(std::string(
+      std::clamp(size - overhead, std::int64_t{0}, kMaxBodySize), 'r'));
+  return parser::ForDataPayloadTransfer(header, chunk);
+}
+
+// Reads |frames| frames off |channel|, then counts down |done|.
+void ReadFrames(EndpointChannel* channel, std::int64_t frames,
+                std::atomic<bool>* failed, CountDownLatch* done) {
+  for (std::int64_t i = 0; i < frames; ++i) {
+    if (!channel->Read().ok()) {
+      *failed = true;
+      break;
+    }
+  }
+  done->CountDown();
+}
+
+}  // namespace
+
+constexpr absl::Duration FrameTraceReplayer::kDeliveryTimeout;
+
+std::optional<FrameTraceReplayer::Result> FrameTraceReplayer::Replay(
+    const FrameTrace& trace) {
+  WifiLanMedium local_medium;
+  WifiLanMedium remote_medium;
+  WifiLanServerSocket server_socket = remote_medium.ListenForService();
+  if (!server_socket.IsValid()) return std::nullopt;
+  NsdServiceInfo service_info;
+  service_info.SetServiceName(kServiceId);
+  service_info.SetServiceType(kServiceType);
+  service_info.SetIPAddress(server_socket.GetIPAddress());
+  service_info.SetPort(server_socket.GetPort());
+  remote_medium.StartAdvertising(service_info);
+  MediumEnvironment::Instance().Sync();
+
+  WifiLanSocket local_socket;
+  WifiLanSocket remote_socket;
+  {
+    CancellationFlag flag;
+    SingleThreadExecutor accept_executor;
+    accept_executor.Execute([&server_socket, &remote_socket]() {
+      remote_socket = server_socket.Accept();
+    });
+    local_socket = local_medium.ConnectToService(
+        server_socket.GetIPAddress(), server_socket.GetPort(), &flag);
+    if (!local_socket.IsValid()) server_socket.Close();
+  }
+  server_socket.Close();
+  remote_medium.StopAdvertising(service_info);
+  if (!local_socket.IsValid() || !remote_socket.IsValid()) return std::nullopt;
+
+  WifiLanEndpointChannel local(kServiceId, "replay-local", local_socket);
+  WifiLanEndpointChannel remote(kServiceId, "replay-remote", remote_socket);
+  auto local_stats = std::make_shared<EndpointStatsRecorder>();
+  auto remote_stats = std::make_shared<EndpointStatsRecorder>();
+  local.SetStatsRecorder(local_stats);
+  remote.SetStatsRecorder(remote_stats);
+
+  std::int64_t outgoing = 0;
+  for (const FrameTrace::Frame& frame : trace.frames) {
+    if (frame.direction == FrameTrace::Direction::kOutgoing) ++outgoing;
+  }
+  const std::int64_t incoming = trace.frames.size() - outgoing;
+
+  Result result;
+  std::atomic<bool> failed = false;
+  CountDownLatch done(2);
+  SingleThreadExecutor local_reader;
+  SingleThreadExecutor remote_reader;
+  local_reader.Execute([&local, incoming, &failed, &done]() {
+    ReadFrames(&local, incoming, &failed, &done);
+  });
+  remote_reader.Execute([&remote, outgoing, &failed, &done]() {
+    ReadFrames(&remote, outgoing, &failed, &done);
+  });
+
+  const absl::Time wall_start = absl::Now();
+  const absl::Time start = SystemClock::ElapsedRealtime();
+  for (const FrameTrace::Frame& frame : trace.frames) {
+    // Fast-forwards the simulated clock, if installed.
+    absl::Duration wait = start + frame.time - SystemClock::ElapsedRealtime();
+    if (wait > absl::ZeroDuration()) SystemClock::Sleep(wait);
+
+    ByteArray bytes = MakeFrame(result.frames, frame.size);
+    EndpointChannel& writer =
+        frame.direction == FrameTrace::Direction::kOutgoing ? local : remote;
+    PacketMetaData packet_meta_data;
+    if (!writer
+             .Write(bytes, packet_meta_data,
+                    frame.frame_type == V1Frame::PAYLOAD_TRANSFER
+                        ? WritePriority::kBytesPayload
+                        : WritePriority::kControl)
+             .Ok()) {
+      failed = true;
+      break;
+    }
+    ++result.frames;
+    result.bytes += bytes.size();
+  }
+
+  bool delivered = !failed && done.Await(kDeliveryTimeout).result();
+  result.wall_time = absl::Now() - wall_start;
+  local.Close();
+  remote.Close();
+  if (!delivered || failed) return std::nullopt;
+  result.local = local_stats->GetStats();
+  result.remote = remote_stats->GetStats();
+  return result;
+}
+
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,62 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_FRAME_TRACE_REPLAYER_H_
+#define CORE_INTERNAL_FRAME_TRACE_REPLAYER_H_
+
+#include <cstdint>
+#include <optional>
+
+#include "absl/time/time.h"
+#include "connections/implementation/endpoint_stats.h"
+#include "connections/implementation/frame_trace.h"
+
+namespace nearby {
+namespace connections {
+
+// Replays a FrameTrace between two endpoint channels connected through
+// MediumEnvironment, to reproduce the traffic pattern of a device offline.
+//
+// The local channel writes the trace's outgoing frames and the remote channel
+// its incoming frames, in trace order and at their trace times. Every frame
+// is replaced with a PAYLOAD_TRANSFER frame of the same size, since only
+// metadata is captured. With the simulated clock, waiting for the next frame
+// fast-forwards the clock instead of sleeping, so replays are deterministic
+// and run as fast as the link allows.
+//
+// The channels run over WIFI_LAN sockets, so the link model set for WIFI_LAN
+// is the one the replay sees. MediumEnvironment must be started.
+class FrameTraceReplayer {
+ public:
+  static constexpr absl::Duration kDeliveryTimeout = absl::Seconds(60);
+
+  struct Result {
+    std::int64_t frames = 0;
+    std::int64_t bytes = 0;
+    // Real time from the first write until the last frame was read.
+    absl::Duration wall_time = absl::ZeroDuration();
+    // Statistics of the local and remote channels.
+    EndpointStats local;
+    EndpointStats remote;
+  };
+
+  // Returns nullopt if the channels couldn't connect, or a frame wasn't
+  // delivered within kDeliveryTimeout.
+  static std::optional<Result> Replay(const FrameTrace& trace);
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_FRAME_TRACE_REPLAYER_H_
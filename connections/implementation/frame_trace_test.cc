@@ -0,0 +1,110 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/frame_trace.h"
+
+#include <optional>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "proto/connections_enums.pb.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+using ::location::nearby::connections::V1Frame;
+using ::location::nearby::proto::connections::Medium;
+
+const absl::Time kStart = absl::FromUnixSeconds(1000);
+
+TEST(FrameTraceTest, RecorderTimesFramesFromTheFirstOne) {
+  FrameTraceRecorder& recorder = FrameTraceRecorder::GetInstance();
+  recorder.TakeTrace();
+  recorder.Record(FrameTrace::Direction::kIncoming, "ABCD", Medium::BLUETOOTH,
+                  V1Frame::CONNECTION_REQUEST, 120, kStart);
+  recorder.Record(FrameTrace::Direction::kOutgoing, "ABCD", Medium::WIFI_LAN,
+                  V1Frame::PAYLOAD_TRANSFER, 32768,
+                  kStart + absl::Milliseconds(15));
+
+  FrameTrace trace = recorder.TakeTrace();
+  ASSERT_EQ(trace.frames.size(), 2);
+  EXPECT_EQ(trace.frames[0].time, absl::ZeroDuration());
+  EXPECT_EQ(trace.frames[0].direction, FrameTrace::Direction::kIncoming);
+  EXPECT_EQ(trace.frames[0].frame_type, V1Frame::CONNECTION_REQUEST);
+  EXPECT_EQ(trace.frames[1].time, absl::Milliseconds(15));
+  EXPECT_EQ(trace.frames[1].direction, FrameTrace::Direction::kOutgoing);
+  EXPECT_EQ(trace.frames[1].endpoint_id, "ABCD");
+  EXPECT_EQ(trace.frames[1].medium, Medium::WIFI_LAN);
+  EXPECT_EQ(trace.frames[1].size, 32768);
+  EXPECT_TRUE(recorder.TakeTrace().frames.empty());
+}
+
+TEST(FrameTraceTest, RecorderDropsFramesOfAFullTrace) {
+  FrameTraceRecorder& recorder = FrameTraceRecorder::GetInstance();
+  recorder.TakeTrace();
+  for (int i = 0; i < FrameTraceRecorder::kMaxFrames + 3; ++i) {
+    recorder.Record(FrameTrace::Direction::kIncoming, "ABCD", Medium::BLE,
+                    V1Frame::KEEP_ALIVE, 4, kStart);
+  }
+
+  FrameTrace trace = recorder.TakeTrace();
+  EXPECT_EQ(trace.frames.size(), FrameTraceRecorder::kMaxFrames);
+  EXPECT_EQ(trace.dropped_frames, 3);
+}
+
+TEST(FrameTraceTest, RoundTripsThroughText) {
+  FrameTrace trace;
+  trace.frames.push_back({.time = absl::ZeroDuration(),
+                          .direction = FrameTrace::Direction::kOutgoing,
+                          .endpoint_id = "ABCD",
+                          .medium = Medium::BLE,
+                          .frame_type = V1Frame::KEEP_ALIVE,
+                          .size = 4});
+  trace.frames.push_back({.time = absl::Microseconds(1500),
+                          .direction = FrameTrace::Direction::kIncoming,
+                          .endpoint_id = "WXYZ",
+                          .medium = Medium::WIFI_LAN,
+                          .frame_type = V1Frame::PAYLOAD_TRANSFER,
+                          .size = 65536});
+
+  std::string text = trace.ToString();
+  EXPECT_EQ(text,
+            "0 out ABCD BLE KEEP_ALIVE 4\n"
+            "1500 in WXYZ WIFI_LAN PAYLOAD_TRANSFER 65536\n");
+  std::optional<FrameTrace> parsed = FrameTrace::FromString(text);
+  ASSERT_TRUE(parsed.has_value());
+  ASSERT_EQ(parsed->frames.size(), 2);
+  EXPECT_EQ(parsed->frames[1].time, absl::Microseconds(1500));
+  EXPECT_EQ(parsed->frames[1].direction, FrameTrace::Direction::kIncoming);
+  EXPECT_EQ(parsed->frames[1].endpoint_id, "WXYZ");
+  EXPECT_EQ(parsed->frames[1].medium, Medium::WIFI_LAN);
+  EXPECT_EQ(parsed->frames[1].frame_type, V1Frame::PAYLOAD_TRANSFER);
+  EXPECT_EQ(parsed->frames[1].size, 65536);
+}
+
+TEST(FrameTraceTest, RejectsMalformedText) {
+  EXPECT_FALSE(FrameTrace::FromString("0 out ABCD BLE KEEP_ALIVE\n"));
+  EXPECT_FALSE(FrameTrace::FromString("0 up ABCD BLE KEEP_ALIVE 4\n"));
+  EXPECT_FALSE(FrameTrace::FromString("0 out ABCD MEDIUM KEEP_ALIVE 4\n"));
+  EXPECT_FALSE(FrameTrace::FromString("0 out ABCD BLE KEEP_ALIVE -4\n"));
+  EXPECT_FALSE(FrameTrace::FromString("-1 out ABCD BLE KEEP_ALIVE 4\n"));
+  EXPECT_TRUE(FrameTrace::FromString(""));
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,30 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "connections/implementation/mediums/ble_v2/ble_advertisement_header.h"
+#include "internal/platform/byte_array.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  nearby::ByteArray bytes(reinterpret_cast<const char*>(data), size);
+
+  nearby::connections::mediums::BleAdvertisementHeader header(bytes);
+  if (header.IsValid()) {
+    static_cast<nearby::ByteArray>(header);
+  }
+
+  return 0;
+}
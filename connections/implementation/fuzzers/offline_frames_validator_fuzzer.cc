@@ -0,0 +1,30 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "connections/implementation/offline_frames_validator.h"
+#include "connections/implementation/proto/offline_wire_formats.pb.h"
+
+// Mutations of the proto encoding mostly still parse, so the validator sees
+// structurally valid frames instead of being cut short by the parser.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  location::nearby::connections::OfflineFrame offline_frame;
+  if (!offline_frame.ParseFromArray(data, size)) return 0;
+
+  nearby::connections::parser::EnsureValidOfflineFrame(offline_frame);
+
+  return 0;
+}
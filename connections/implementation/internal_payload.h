@@ -16,6 +16,8 @@
 #define CORE_INTERNAL_INTERNAL_PAYLOAD_H_
 
 #include <cstdint>
+#include <optional>
+#include <string>
 
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
 #include "connections/payload.h"
@@ -92,6 +94,21 @@ class InternalPayload {
   // @return the offset really skipped
   virtual ExceptionOr<size_t> SkipToOffset(size_t offset) = 0;
 
+  // Hashes the content of an outgoing FILE payload chunk by chunk, from
+  // |offset| on, so that chunks the receiver already has can be left out.
+  //
+  // @return The manifest of up to FileChunkStore::kMaxChunks chunks, or
+  // std::nullopt if the payload can't provide one.
+  virtual std::optional<
+      location::nearby::connections::PayloadTransferFrame::ChunkManifest>
+  CreateChunkManifest(std::int64_t offset) {
+    return std::nullopt;
+  }
+
+  // @return The path an incoming FILE payload is written to, or an empty
+  // string if it isn't written to a known path.
+  virtual std::string GetFilePath() const { return {}; }
+
   // Cleans up any resources used by this Payload. Called when we're stopping
   // early, e.g. after being cancelled or having no more recipients left.
   virtual void Close() {}
@@ -14,14 +14,30 @@
 
 #include "connections/implementation/internal_payload_factory.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "connections/implementation/file_chunk_store.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/implementation/offline_frames_validator.h"
+#include "connections/listeners.h"
 #include "connections/payload.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/condition_variable.h"
 #include "internal/platform/exception.h"
@@ -31,8 +47,11 @@
 #include "internal/platform/implementation/shared/file.h"
 #include "internal/platform/logging.h"
 #include "internal/platform/mutex.h"
+#include "internal/platform/mutex_lock.h"
 #include "internal/platform/os_name.h"
 #include "internal/platform/pipe.h"
+#include "internal/platform/single_thread_executor.h"
+#include "internal/platform/system_clock.h"
 
 namespace nearby {
 namespace connections {
@@ -40,11 +59,37 @@ namespace connections {
 namespace {
 using ::location::nearby::connections::PayloadTransferFrame;
 
+// With kEnableBatchedIncomingFileWrites, incoming FILE chunks are gathered up
+// to this size before being written, so that the small chunks that slow
+// mediums deliver don't each cost a write.
+constexpr size_t kIncomingFileWriteBatchSize = 1024 * 1024;
+// ...or until the oldest of them has waited this long, so that on mediums too
+// slow to fill a batch quickly, the file doesn't lag far behind the progress
+// reported to the client.
+constexpr absl::Duration kIncomingFileWriteBatchMaxDelay = absl::Seconds(1);
+
+// With kEnableAsyncIncomingFileWrites, the most data of an incoming FILE
+// payload that may be waiting to be written before reading more of it waits
+// for the file to catch up.
+constexpr size_t kIncomingFileWriteQueueSize = 4 * 1024 * 1024;
+
+// Largest FileBatch a FILE_BATCH payload may start with, so that its first
+// chunk fits in a frame. Enough for many thousands of files.
+constexpr size_t kMaxFileBatchSize = 512 * 1024;
+
+bool ContainsAny(absl::string_view path,
+                 absl::Span<const absl::string_view> patterns) {
+  return std::any_of(patterns.begin(), patterns.end(),
+                     [path](absl::string_view pattern) {
+                       return absl::StrContains(path, pattern);
+                     });
+}
+
 class BytesInternalPayload : public InternalPayload {
  public:
   explicit BytesInternalPayload(Payload payload)
       : InternalPayload(std::move(payload)),
-        total_size_(payload_.AsBytes().size()),
+        total_size_(payload_.AsBytesView().size()),
         detached_only_chunk_(false) {}
 
   location::nearby::connections::PayloadTransferFrame::PayloadHeader::
@@ -64,7 +109,9 @@ class BytesInternalPayload : public InternalPayload {
     }
 
     detached_only_chunk_ = true;
-    return std::move(payload_).AsBytes();
+    // A caller-owned buffer is only copied here, into the chunk.
+    absl::string_view bytes = payload_.AsBytesView();
+    return ByteArray(bytes.data(), bytes.size());
   }
 
   // Does nothing.
@@ -88,7 +135,15 @@ class BytesInternalPayload : public InternalPayload {
 class OutgoingStreamInternalPayload : public InternalPayload {
  public:
   explicit OutgoingStreamInternalPayload(Payload payload)
-      : InternalPayload(std::move(payload)) {}
+      : InternalPayload(std::move(payload)),
+        read_ahead_linger_(absl::Milliseconds(
+            NearbyFlags::GetInstance().GetInt64Flag(
+                config_package_nearby::nearby_connections_feature::
+                    kOutgoingStreamReadAheadLingerMillis))) {}
+  ~OutgoingStreamInternalPayload() override {
+    // Unblock the read-ahead, which is joined when |reader_| is destroyed.
+    if (reader_ != nullptr) Close();
+  }
 
   location::nearby::connections::PayloadTransferFrame::PayloadHeader::
       PayloadType
@@ -102,6 +157,9 @@ class OutgoingStreamInternalPayload : public InternalPayload {
   ByteArray DetachNextChunk(int chunk_size) override {
     InputStream* input_stream = payload_.AsStream();
     if (!input_stream) return {};
+    if (read_ahead_linger_ > absl::ZeroDuration()) {
+      return DetachReadAheadChunk(chunk_size);
+    }
 
     ExceptionOr<ByteArray> bytes_read = input_stream->Read(chunk_size);
     if (!bytes_read.ok()) {
@@ -146,17 +204,146 @@ class OutgoingStreamInternalPayload : public InternalPayload {
   }
 
   void Close() override {
+    {
+      MutexLock lock(&read_ahead_mutex_);
+      read_ahead_closed_ = true;
+      read_ahead_changed_.Notify();
+    }
     // Ignore the potential Exception returned by close(), as a counterpart
     // to Java's closeQuietly().
     InputStream* stream = payload_.AsStream();
     if (stream) stream->Close();
   }
+
+ private:
+  // Returns up to |chunk_size| bytes read ahead from the stream, once that much
+  // has been read, or |read_ahead_linger_| after the first of them was.
+  ByteArray DetachReadAheadChunk(int chunk_size) {
+    MutexLock lock(&read_ahead_mutex_);
+    read_ahead_chunk_size_ = chunk_size;
+    if (reader_ == nullptr) {
+      reader_ = std::make_unique<SingleThreadExecutor>();
+      reader_->Execute("outgoing-stream-read-ahead", [this]() { ReadAhead(); });
+    }
+    absl::Time deadline = absl::InfiniteFuture();
+    while (read_ahead_.size() < chunk_size && !read_ahead_ended_ &&
+           !read_ahead_closed_) {
+      if (read_ahead_.empty()) {
+        read_ahead_changed_.Wait();
+        continue;
+      }
+      absl::Time now = SystemClock::ElapsedRealtime();
+      if (deadline == absl::InfiniteFuture()) deadline = now + read_ahead_linger_;
+      if (now >= deadline) break;
+      read_ahead_changed_.Wait(deadline - now);
+    }
+    if (read_ahead_.empty()) return {};
+
+    std::size_t size = std::min(read_ahead_.size(),
+                                static_cast<std::size_t>(chunk_size));
+    ByteArray chunk(read_ahead_.data(), size);
+    read_ahead_.erase(0, size);
+    read_ahead_changed_.Notify();
+    return chunk;
+  }
+
+  // Runs on |reader_|, reading the stream until it ends or the payload is
+  // closed, while less than two chunks are waiting to be sent.
+  void ReadAhead() {
+    InputStream* input_stream = payload_.AsStream();
+    while (true) {
+      int chunk_size;
+      {
+        MutexLock lock(&read_ahead_mutex_);
+        while (!read_ahead_closed_ &&
+               read_ahead_.size() >= 2 * read_ahead_chunk_size_) {
+          read_ahead_changed_.Wait();
+        }
+        if (read_ahead_closed_) return;
+        chunk_size = read_ahead_chunk_size_;
+      }
+      ExceptionOr<ByteArray> bytes_read = input_stream->Read(chunk_size);
+      MutexLock lock(&read_ahead_mutex_);
+      if (!bytes_read.ok() || bytes_read.result().Empty()) {
+        NEARBY_LOGS(INFO) << "No more data for outgoing payload " << this
+                          << ", closing InputStream.";
+        input_stream->Close();
+        read_ahead_ended_ = true;
+        read_ahead_changed_.Notify();
+        return;
+      }
+      read_ahead_.append(bytes_read.result().data(),
+                         bytes_read.result().size());
+      read_ahead_changed_.Notify();
+    }
+  }
+
+  const absl::Duration read_ahead_linger_;
+  Mutex read_ahead_mutex_;
+  ConditionVariable read_ahead_changed_{&read_ahead_mutex_};
+  // Read from the stream, and not yet detached.
+  std::string read_ahead_ ABSL_GUARDED_BY(read_ahead_mutex_);
+  int read_ahead_chunk_size_ ABSL_GUARDED_BY(read_ahead_mutex_) = 0;
+  bool read_ahead_ended_ ABSL_GUARDED_BY(read_ahead_mutex_) = false;
+  bool read_ahead_closed_ ABSL_GUARDED_BY(read_ahead_mutex_) = false;
+  // Reads the stream ahead when |read_ahead_linger_| is set. Declared last, so
+  // that it is joined before the rest is destroyed.
+  std::unique_ptr<SingleThreadExecutor> reader_;
+};
+
+// The InputStream of an incoming STREAM payload. It gives back the bytes the
+// client reads to the payload's MemoryAccountant::Reservation, and reports the
+// total read so far to |read_observer| until the payload lets go of it. The
+// observer is called under |mutex_|, and is expected not to block.
+class IncomingPipeInputStream : public InputStream {
+ public:
+  IncomingPipeInputStream(
+      std::shared_ptr<Pipe> pipe,
+      std::shared_ptr<MemoryAccountant::Reservation> reservation,
+      std::function<void(std::int64_t)> read_observer)
+      : pipe_(std::move(pipe)),
+        reservation_(std::move(reservation)),
+        read_observer_(std::move(read_observer)) {}
+
+  ExceptionOr<ByteArray> Read(std::int64_t size) override {
+    ExceptionOr<ByteArray> read = pipe_->GetInputStream().Read(size);
+    if (!read.ok() || read.result().Empty()) return read;
+    if (reservation_) reservation_->Remove(read.result().size());
+    MutexLock lock(&mutex_);
+    bytes_read_ += read.result().size();
+    if (read_observer_) read_observer_(bytes_read_);
+    return read;
+  }
+  Exception Close() override { return pipe_->GetInputStream().Close(); }
+
+  // Waits for a running |read_observer_| call to return.
+  void ClearReadObserver() {
+    MutexLock lock(&mutex_);
+    read_observer_ = nullptr;
+  }
+
+ private:
+  std::shared_ptr<Pipe> pipe_;
+  std::shared_ptr<MemoryAccountant::Reservation> reservation_;
+  Mutex mutex_;
+  std::int64_t bytes_read_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::function<void(std::int64_t)> read_observer_ ABSL_GUARDED_BY(mutex_);
 };
 
 class IncomingStreamInternalPayload : public InternalPayload {
  public:
-  IncomingStreamInternalPayload(Payload payload, std::shared_ptr<Pipe> pipe)
-      : InternalPayload(std::move(payload)), pipe_(pipe) {}
+  IncomingStreamInternalPayload(
+      Payload payload, std::shared_ptr<Pipe> pipe,
+      std::shared_ptr<MemoryAccountant::Reservation> reservation = nullptr,
+      std::shared_ptr<IncomingPipeInputStream> input_stream = nullptr)
+      : InternalPayload(std::move(payload)),
+        pipe_(pipe),
+        reservation_(std::move(reservation)),
+        input_stream_(std::move(input_stream)) {}
+  ~IncomingStreamInternalPayload() override {
+    // The client may keep reading after we're gone.
+    if (input_stream_) input_stream_->ClearReadObserver();
+  }
 
   PayloadTransferFrame::PayloadHeader::PayloadType GetType() const override {
     return PayloadTransferFrame::PayloadHeader::STREAM;
@@ -174,7 +361,11 @@ class IncomingStreamInternalPayload : public InternalPayload {
       return {Exception::kSuccess};
     }
 
-    return pipe_->GetOutputStream().Write(chunk);
+    // Added before writing, as the client may read the chunk right away.
+    if (reservation_) reservation_->Add(chunk.size());
+    Exception exception = pipe_->GetOutputStream().Write(chunk);
+    if (exception.Raised() && reservation_) reservation_->Remove(chunk.size());
+    return exception;
   }
 
   ExceptionOr<size_t> SkipToOffset(size_t offset) override {
@@ -187,6 +378,8 @@ class IncomingStreamInternalPayload : public InternalPayload {
 
  private:
   std::shared_ptr<Pipe> pipe_;
+  std::shared_ptr<MemoryAccountant::Reservation> reservation_;
+  std::shared_ptr<IncomingPipeInputStream> input_stream_;
 };
 
 class OutgoingFileInternalPayload : public InternalPayload {
@@ -251,6 +444,28 @@ class OutgoingFileInternalPayload : public InternalPayload {
     return {Exception::kIo};
   }
 
+  std::optional<PayloadTransferFrame::ChunkManifest> CreateChunkManifest(
+      std::int64_t offset) override {
+    InputFile* file = payload_.AsFile();
+    if (!file || file->GetFilePath().empty()) return std::nullopt;
+    // Hashed through a file of its own, leaving the one that is sent where it
+    // was read up to.
+    InputFile hashed_file(file->GetFilePath(), total_size_);
+    bool at_offset = true;
+    if (offset > 0) {
+      ExceptionOr<size_t> skipped = hashed_file.Skip(offset);
+      at_offset = skipped.ok() &&
+                  static_cast<std::int64_t>(skipped.result()) == offset;
+    }
+    std::optional<PayloadTransferFrame::ChunkManifest> manifest;
+    if (at_offset) {
+      manifest = FileChunkStore::CreateManifest(hashed_file, offset,
+                                                FileChunkStore::kMaxChunks);
+    }
+    hashed_file.Close();
+    return manifest;
+  }
+
   void Close() override {
     InputFile* file = payload_.AsFile();
     if (file) file->Close();
@@ -262,11 +477,29 @@ class OutgoingFileInternalPayload : public InternalPayload {
 
 class IncomingFileInternalPayload : public InternalPayload {
  public:
-  IncomingFileInternalPayload(Payload payload, OutputFile output_file,
-                              std::int64_t total_size)
+  IncomingFileInternalPayload(
+      Payload payload, OutputFile output_file, std::string file_path,
+      std::int64_t total_size,
+      std::unique_ptr<MemoryAccountant::Reservation> reservation = nullptr)
       : InternalPayload(std::move(payload)),
         output_file_(std::move(output_file)),
-        total_size_(total_size) {}
+        file_path_(std::move(file_path)),
+        total_size_(total_size),
+        reservation_(std::move(reservation)),
+        batch_writes_(NearbyFlags::GetInstance().GetBoolFlag(
+            config_package_nearby::nearby_connections_feature::
+                kEnableBatchedIncomingFileWrites)) {
+    if (batch_writes_ && total_size_ > 0 &&
+        !output_file_.Preallocate(total_size_).Ok()) {
+      NEARBY_LOGS(INFO) << "Unable to preallocate " << total_size_
+                        << " bytes for incoming file Payload " << this;
+    }
+    if (NearbyFlags::GetInstance().GetBoolFlag(
+            config_package_nearby::nearby_connections_feature::
+                kEnableAsyncIncomingFileWrites)) {
+      file_writer_ = std::make_unique<SingleThreadExecutor>();
+    }
+  }
 
   location::nearby::connections::PayloadTransferFrame::PayloadHeader::
       PayloadType
@@ -282,11 +515,26 @@ class IncomingFileInternalPayload : public InternalPayload {
   Exception AttachNextChunk(const ByteArray& chunk) override {
     if (chunk.Empty()) {
       // Received null last chunk for incoming payload.
+      Exception exception = WritePendingChunks();
+      Exception queued_exception = WaitForQueuedWrites();
       output_file_.Close();
-      return {Exception::kSuccess};
+      return exception.Ok() ? queued_exception : exception;
     }
 
-    return output_file_.Write(chunk);
+    if (!batch_writes_ ||
+        (pending_chunks_.empty() &&
+         chunk.size() >= kIncomingFileWriteBatchSize)) {
+      return Write(chunk);
+    }
+    absl::Time now = SystemClock::ElapsedRealtime();
+    if (pending_chunks_.empty()) pending_since_ = now;
+    pending_chunks_.append(chunk.data(), chunk.size());
+    if (reservation_) reservation_->Add(chunk.size());
+    if (pending_chunks_.size() < kIncomingFileWriteBatchSize &&
+        now - pending_since_ < kIncomingFileWriteBatchMaxDelay) {
+      return {Exception::kSuccess};
+    }
+    return WritePendingChunks();
   }
 
   ExceptionOr<size_t> SkipToOffset(size_t offset) override {
@@ -295,11 +543,259 @@ class IncomingFileInternalPayload : public InternalPayload {
     return {Exception::kIo};
   }
 
-  void Close() override { output_file_.Close(); }
+  void Close() override {
+    WritePendingChunks();
+    WaitForQueuedWrites();
+    output_file_.Close();
+  }
+
+  std::string GetFilePath() const override { return file_path_; }
 
  private:
+  Exception WritePendingChunks() {
+    if (pending_chunks_.empty()) return {Exception::kSuccess};
+    const std::size_t pending_size = pending_chunks_.size();
+    Exception exception = Write(ByteArray(std::move(pending_chunks_)));
+    pending_chunks_.clear();
+    if (reservation_) reservation_->Remove(pending_size);
+    return exception;
+  }
+
+  // Writes |data| to the file, or with |file_writer_|, queues it to be written
+  // there, once less than kIncomingFileWriteQueueSize is queued. Returns the
+  // error of an earlier queued write, if any.
+  Exception Write(ByteArray data) {
+    if (file_writer_ == nullptr) return output_file_.Write(data);
+
+    const std::size_t size = data.size();
+    {
+      MutexLock lock(&write_queue_mutex_);
+      while (write_exception_.Ok() && queued_bytes_ > 0 &&
+             queued_bytes_ + size > kIncomingFileWriteQueueSize) {
+        write_queue_drained_.Wait();
+      }
+      if (!write_exception_.Ok()) return write_exception_;
+      queued_bytes_ += size;
+    }
+    if (reservation_) reservation_->Add(size);
+    file_writer_->Execute(
+        "incoming-file-write", [this, data = std::move(data), size]() {
+          Exception exception = output_file_.Write(data);
+          if (reservation_) reservation_->Remove(size);
+          MutexLock lock(&write_queue_mutex_);
+          queued_bytes_ -= size;
+          if (!exception.Ok() && write_exception_.Ok()) {
+            write_exception_ = exception;
+          }
+          write_queue_drained_.Notify();
+        });
+    return {Exception::kSuccess};
+  }
+
+  // Waits for everything queued by Write() to be written, and returns the first
+  // error writing it.
+  Exception WaitForQueuedWrites() {
+    if (file_writer_ == nullptr) return {Exception::kSuccess};
+    MutexLock lock(&write_queue_mutex_);
+    while (queued_bytes_ > 0) {
+      write_queue_drained_.Wait();
+    }
+    return write_exception_;
+  }
+
   OutputFile output_file_;
+  const std::string file_path_;
   const std::int64_t total_size_;
+  // Holds the size of |pending_chunks_|.
+  const std::unique_ptr<MemoryAccountant::Reservation> reservation_;
+  const bool batch_writes_;
+  // Chunks received but not yet written, when |batch_writes_| is set.
+  std::string pending_chunks_;
+  // When the first of |pending_chunks_| was received.
+  absl::Time pending_since_;
+  Mutex write_queue_mutex_;
+  ConditionVariable write_queue_drained_{&write_queue_mutex_};
+  // Bytes queued on |file_writer_| and not yet written.
+  std::size_t queued_bytes_ ABSL_GUARDED_BY(write_queue_mutex_) = 0;
+  Exception write_exception_ ABSL_GUARDED_BY(write_queue_mutex_) = {
+      Exception::kSuccess};
+  // Writes the file when kEnableAsyncIncomingFileWrites is set. Declared last,
+  // so that its queued writes finish before the rest is destroyed.
+  std::unique_ptr<SingleThreadExecutor> file_writer_;
+};
+
+// Sends the files of a batch one after the other, after a first chunk that
+// lists them. Chunks are filled across files, so that small files share them.
+class OutgoingFileBatchInternalPayload : public InternalPayload {
+ public:
+  OutgoingFileBatchInternalPayload(Payload payload, std::string file_batch)
+      : InternalPayload(std::move(payload)),
+        file_batch_(std::move(file_batch)),
+        total_size_(file_batch_.size()) {
+    for (const Payload::BatchFile& file : *payload_.AsFileBatch()) {
+      total_size_ += file.file.GetTotalSize();
+    }
+  }
+
+  PayloadTransferFrame::PayloadHeader::PayloadType GetType() const override {
+    return PayloadTransferFrame::PayloadHeader::FILE_BATCH;
+  }
+
+  std::int64_t GetTotalSize() const override { return total_size_; }
+
+  ByteArray DetachNextChunk(int chunk_size) override {
+    if (!detached_file_batch_) {
+      detached_file_batch_ = true;
+      return ByteArray(std::move(file_batch_));
+    }
+
+    std::vector<Payload::BatchFile>& files = *payload_.AsFileBatch();
+    std::string chunk;
+    while (static_cast<int>(chunk.size()) < chunk_size &&
+           current_file_ < files.size()) {
+      InputFile& file = files[current_file_].file;
+      std::int64_t remaining = file.GetTotalSize() - current_file_offset_;
+      if (remaining > 0) {
+        ExceptionOr<ByteArray> bytes_read = file.Read(std::min<std::int64_t>(
+            remaining, chunk_size - static_cast<int>(chunk.size())));
+        if (!bytes_read.ok() || bytes_read.result().Empty()) {
+          NEARBY_LOGS(WARNING) << "Failed to read file " << current_file_
+                               << " of batch payload " << this;
+          Close();
+          return {};
+        }
+        chunk.append(bytes_read.result().data(), bytes_read.result().size());
+        current_file_offset_ += bytes_read.result().size();
+        if (current_file_offset_ < file.GetTotalSize()) continue;
+      }
+      file.Close();
+      ++current_file_;
+      current_file_offset_ = 0;
+    }
+    return ByteArray(std::move(chunk));
+  }
+
+  Exception AttachNextChunk(const ByteArray& chunk) override {
+    return {Exception::kIo};
+  }
+
+  ExceptionOr<size_t> SkipToOffset(size_t offset) override {
+    NEARBY_LOGS(WARNING) << "Batch payload does not support offsets";
+    return {Exception::kIo};
+  }
+
+  void Close() override {
+    std::vector<Payload::BatchFile>& files = *payload_.AsFileBatch();
+    for (; current_file_ < files.size(); ++current_file_) {
+      files[current_file_].file.Close();
+    }
+  }
+
+ private:
+  std::string file_batch_;
+  bool detached_file_batch_ = false;
+  std::int64_t total_size_;
+  // The file being read, and how much of it was read.
+  size_t current_file_ = 0;
+  std::int64_t current_file_offset_ = 0;
+};
+
+// Writes the files of an incoming batch one after the other. Each one is only
+// opened once the data before it has been written.
+class IncomingFileBatchInternalPayload : public InternalPayload {
+ public:
+  struct File {
+    std::string path;
+    std::int64_t size;
+  };
+
+  IncomingFileBatchInternalPayload(Payload payload, std::vector<File> files,
+                                   std::int64_t file_batch_size,
+                                   std::int64_t total_size)
+      : InternalPayload(std::move(payload)),
+        files_(std::move(files)),
+        file_batch_size_(file_batch_size),
+        total_size_(total_size) {}
+
+  PayloadTransferFrame::PayloadHeader::PayloadType GetType() const override {
+    return PayloadTransferFrame::PayloadHeader::FILE_BATCH;
+  }
+
+  std::int64_t GetTotalSize() const override { return total_size_; }
+
+  ByteArray DetachNextChunk(int chunk_size) override { return {}; }
+
+  Exception AttachNextChunk(const ByteArray& chunk) override {
+    if (chunk.Empty()) {
+      // Received null last chunk for incoming payload.
+      if (current_file_ < files_.size()) {
+        NEARBY_LOGS(WARNING) << "Batch payload " << this << " ended after "
+                             << current_file_ << " of " << files_.size()
+                             << " files";
+        Close();
+        return {Exception::kIo};
+      }
+      return {Exception::kSuccess};
+    }
+
+    absl::string_view data = chunk.AsStringView();
+    // The FileBatch was read when the payload was created.
+    if (skipped_size_ < file_batch_size_) {
+      std::int64_t length = std::min<std::int64_t>(
+          file_batch_size_ - skipped_size_, data.size());
+      data.remove_prefix(length);
+      skipped_size_ += length;
+      if (skipped_size_ < file_batch_size_) return {Exception::kSuccess};
+    }
+
+    for (; current_file_ < files_.size(); ++current_file_) {
+      const File& file = files_[current_file_];
+      if (!output_file_.has_value()) output_file_.emplace(file.path);
+      std::int64_t length = std::min<std::int64_t>(
+          file.size - current_file_offset_, data.size());
+      if (length > 0) {
+        Exception exception =
+            output_file_->Write(ByteArray(data.data(), length));
+        if (exception.Raised()) return exception;
+        data.remove_prefix(length);
+        current_file_offset_ += length;
+      }
+      if (current_file_offset_ < file.size) break;
+      output_file_->Close();
+      output_file_.reset();
+      current_file_offset_ = 0;
+    }
+    if (!data.empty()) {
+      NEARBY_LOGS(WARNING) << "Batch payload " << this
+                           << " is longer than its files";
+      return {Exception::kIo};
+    }
+    return {Exception::kSuccess};
+  }
+
+  ExceptionOr<size_t> SkipToOffset(size_t offset) override {
+    NEARBY_LOGS(WARNING) << "Cannot skip offset for an incoming batch Payload "
+                         << this;
+    return {Exception::kIo};
+  }
+
+  void Close() override {
+    if (output_file_.has_value()) {
+      output_file_->Close();
+      output_file_.reset();
+    }
+  }
+
+ private:
+  // Kept here, since the payload is handed to the client right away.
+  const std::vector<File> files_;
+  const std::int64_t file_batch_size_;
+  const std::int64_t total_size_;
+  std::int64_t skipped_size_ = 0;
+  // The file being written, and how much of it was written.
+  size_t current_file_ = 0;
+  std::int64_t current_file_offset_ = 0;
+  std::optional<OutputFile> output_file_;
 };
 
 }  // namespace
@@ -321,6 +817,26 @@ std::unique_ptr<InternalPayload> CreateOutgoingInternalPayload(
       return absl::make_unique<OutgoingStreamInternalPayload>(
           std::move(payload));
 
+    case PayloadType::kFileBatch: {
+      PayloadTransferFrame::FileBatch file_batch;
+      for (const Payload::BatchFile& file : *payload.AsFileBatch()) {
+        PayloadTransferFrame::FileBatch::File* entry = file_batch.add_files();
+        entry->set_file_name(file.file_name);
+        if (!file.parent_folder.empty()) {
+          entry->set_parent_folder(file.parent_folder);
+        }
+        entry->set_size(file.file.GetTotalSize());
+      }
+      if (file_batch.ByteSizeLong() > kMaxFileBatchSize) {
+        NEARBY_LOGS(ERROR) << "Batch payload " << payload.GetId()
+                           << " has too many files to be sent: "
+                           << file_batch.files_size();
+        return {};
+      }
+      return absl::make_unique<OutgoingFileBatchInternalPayload>(
+          std::move(payload), file_batch.SerializeAsString());
+    }
+
     default:
       DCHECK(false);  // This should never happen.
       return {};
@@ -350,7 +866,10 @@ std::string make_path(const std::string& custom_save_path,
 
 std::unique_ptr<InternalPayload> CreateIncomingInternalPayload(
     const location::nearby::connections::PayloadTransferFrame& frame,
-    const std::string& custom_save_path) {
+    const std::string& custom_save_path, MemoryAccountant* memory_accountant,
+    const std::string& endpoint_id,
+    std::function<void(std::int64_t)> stream_read_observer,
+    std::function<IncomingBytesBuffer(size_t size)> bytes_buffer_provider) {
   if (frame.packet_type() !=
       location::nearby::connections::PayloadTransferFrame::DATA) {
     return {};
@@ -359,13 +878,43 @@ std::unique_ptr<InternalPayload> CreateIncomingInternalPayload(
   const Payload::Id payload_id = frame.payload_header().id();
   switch (frame.payload_header().type()) {
     case PayloadTransferFrame::PayloadHeader::BYTES: {
+      const std::string& body = frame.payload_chunk().body();
+      if (bytes_buffer_provider) {
+        IncomingBytesBuffer buffer = bytes_buffer_provider(body.size());
+        if (buffer.data != nullptr) {
+          std::memcpy(buffer.data, body.data(), body.size());
+          return absl::make_unique<BytesInternalPayload>(
+              Payload(payload_id, buffer.data, body.size(),
+                      std::move(buffer.release)));
+        }
+      }
       return absl::make_unique<BytesInternalPayload>(
-          Payload(payload_id, ByteArray(frame.payload_chunk().body())));
+          Payload(payload_id, ByteArray(body)));
     }
 
     case PayloadTransferFrame::PayloadHeader::STREAM: {
-      auto pipe = std::make_shared<Pipe>();
-
+      int64_t pipe_capacity = NearbyFlags::GetInstance().GetInt64Flag(
+          config_package_nearby::nearby_connections_feature::
+              kIncomingStreamPipeCapacity);
+      auto pipe = pipe_capacity > 0 ? std::make_shared<Pipe>(pipe_capacity)
+                                    : std::make_shared<Pipe>();
+
+      if (memory_accountant != nullptr || stream_read_observer) {
+        std::shared_ptr<MemoryAccountant::Reservation> reservation;
+        if (memory_accountant != nullptr) {
+          reservation = memory_accountant->Reserve(
+              endpoint_id, payload_id,
+              MemoryAccountant::Category::kStreamBuffer);
+        }
+        auto input_stream = std::make_shared<IncomingPipeInputStream>(
+            pipe, reservation, std::move(stream_read_observer));
+        return absl::make_unique<IncomingStreamInternalPayload>(
+            Payload(payload_id,
+                    [input_stream]() -> InputStream& {
+                      return *input_stream;  // NOLINT
+                    }),
+            pipe, reservation, input_stream);
+      }
       return absl::make_unique<IncomingStreamInternalPayload>(
           Payload(payload_id,
                   [pipe]() -> InputStream& {
@@ -407,20 +956,93 @@ std::unique_ptr<InternalPayload> CreateIncomingInternalPayload(
         total_size = frame.payload_header().total_size();
       }
 
+      std::unique_ptr<MemoryAccountant::Reservation> reservation;
+      if (memory_accountant != nullptr) {
+        reservation = memory_accountant->Reserve(
+            endpoint_id, payload_id,
+            MemoryAccountant::Category::kFileWriteBuffer);
+      }
+
       // These are ordered, the output file must be created first otherwise
       // there will be no input file to open.
       // On Chrome the file path should be empty, so use the payload id.
       if (ImplementationPlatform::GetCurrentOS() == OSName::kChromeOS) {
         return absl::make_unique<IncomingFileInternalPayload>(
             Payload(payload_id, InputFile(payload_id, total_size)),
-            OutputFile(payload_id), total_size);
+            OutputFile(payload_id), /*file_path=*/"", total_size,
+            std::move(reservation));
       } else {
         return absl::make_unique<IncomingFileInternalPayload>(
             Payload(payload_id, parent_folder, file_name,
                     InputFile(file_path, total_size)),
-            OutputFile(file_path), total_size);
+            OutputFile(file_path), file_path, total_size,
+            std::move(reservation));
       }
     }
+
+    case PayloadTransferFrame::PayloadHeader::FILE_BATCH: {
+      // Written in several files, which ChromeOS has no paths for.
+      if (!NearbyFlags::GetInstance().GetBoolFlag(
+              config_package_nearby::nearby_connections_feature::
+                  kEnableFileBatchPayloads) ||
+          ImplementationPlatform::GetCurrentOS() == OSName::kChromeOS) {
+        NEARBY_LOGS(ERROR) << "Batch payloads are not supported.";
+        return {};
+      }
+
+      const std::string& body = frame.payload_chunk().body();
+      PayloadTransferFrame::FileBatch file_batch;
+      if (frame.payload_chunk().offset() != 0 ||
+          body.size() > kMaxFileBatchSize || !file_batch.ParseFromString(body)) {
+        NEARBY_LOGS(ERROR) << "Batch payload " << payload_id
+                           << " doesn't start with its files.";
+        return {};
+      }
+
+      const std::string& parent_folder =
+          frame.payload_header().parent_folder();
+      const std::int64_t total_size = frame.payload_header().total_size();
+      std::int64_t files_size = body.size();
+      std::vector<Payload::BatchFile> batch_files;
+      std::vector<IncomingFileBatchInternalPayload::File> files;
+      batch_files.reserve(file_batch.files_size());
+      files.reserve(file_batch.files_size());
+      for (const PayloadTransferFrame::FileBatch::File& file :
+           file_batch.files()) {
+        // The frame validator only checks the names in payload headers.
+        if (file.file_name().empty() ||
+            ContainsAny(file.file_name(), parser::kIllegalFileNamePatterns) ||
+            ContainsAny(file.parent_folder(),
+                        parser::kIllegalParentFolderPatterns) ||
+            file.size() < 0 || file.size() > total_size - files_size) {
+          NEARBY_LOGS(ERROR) << "Batch payload " << payload_id
+                             << " has an invalid file.";
+          return {};
+        }
+        files_size += file.size();
+
+        std::string file_parent_folder =
+            file.parent_folder().empty() || parent_folder.empty()
+                ? absl::StrCat(parent_folder, file.parent_folder())
+                : absl::StrCat(parent_folder, "/", file.parent_folder());
+        std::string file_name = file.file_name();
+        // if custom_save_path is empty, default download path is used
+        std::string file_path =
+            make_path(custom_save_path, file_parent_folder, file_name);
+        files.push_back({file_path, file.size()});
+        batch_files.push_back({file.parent_folder(), file.file_name(),
+                               InputFile(file_path, file.size())});
+      }
+      if (files_size != total_size) {
+        NEARBY_LOGS(ERROR) << "Batch payload " << payload_id
+                           << " doesn't add up to its size.";
+        return {};
+      }
+
+      return absl::make_unique<IncomingFileBatchInternalPayload>(
+          Payload(payload_id, parent_folder, std::move(batch_files)),
+          std::move(files), body.size(), total_size);
+    }
     default:
       DCHECK(false);  // This should never happen.
       return {};
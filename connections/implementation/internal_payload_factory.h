@@ -15,11 +15,15 @@
 #ifndef CORE_INTERNAL_INTERNAL_PAYLOAD_FACTORY_H_
 #define CORE_INTERNAL_INTERNAL_PAYLOAD_FACTORY_H_
 
-#include <string>
-
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <string>
 
 #include "connections/implementation/internal_payload.h"
+#include "connections/implementation/memory_accountant.h"
+#include "connections/listeners.h"
 #include "connections/payload.h"
 
 namespace nearby {
@@ -29,10 +33,21 @@ namespace connections {
 std::unique_ptr<InternalPayload> CreateOutgoingInternalPayload(Payload payload);
 
 // Creates an InternalPayload representing an incoming Payload from a remote
-// endpoint.
+// endpoint. With |memory_accountant| set, the chunks it buffers are
+// attributed to |endpoint_id|. For a STREAM payload, |stream_read_observer| is
+// called with the total number of bytes read by the client after each read,
+// until the InternalPayload is destroyed. It runs on the client's reading
+// thread, under a lock, so it must not block. For a BYTES payload,
+// |bytes_buffer_provider| is asked for a buffer of the payload's size to copy
+// it into; without one, or if it returns none, the payload holds a ByteArray.
 std::unique_ptr<InternalPayload> CreateIncomingInternalPayload(
     const location::nearby::connections::PayloadTransferFrame& frame,
-    const std::string& custom_save_path);
+    const std::string& custom_save_path,
+    MemoryAccountant* memory_accountant = nullptr,
+    const std::string& endpoint_id = {},
+    std::function<void(std::int64_t)> stream_read_observer = nullptr,
+    std::function<IncomingBytesBuffer(size_t size)> bytes_buffer_provider =
+        nullptr);
 
 }  // namespace connections
 }  // namespace nearby
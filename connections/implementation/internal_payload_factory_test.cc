@@ -14,15 +14,25 @@
 
 #include "connections/implementation/internal_payload_factory.h"
 
+#include <cstdint>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "protobuf-matchers/protocol-buffer-matchers.h"
 #include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "connections/implementation/memory_accountant.h"
 #include "connections/implementation/offline_frames.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/file.h"
+#include "internal/platform/implementation/platform.h"
 #include "internal/platform/pipe.h"
 
 namespace nearby {
@@ -30,6 +40,7 @@ namespace connections {
 namespace {
 
 using ::location::nearby::connections::PayloadTransferFrame;
+using ::testing::ElementsAre;
 constexpr char kText[] = "data chunk";
 
 TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromBytePayload) {
@@ -43,6 +54,22 @@ TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromBytePayload) {
   EXPECT_EQ(payload.AsBytes(), ByteArray(kText));
 }
 
+TEST(InternalPayloadFactoryTest,
+     CanCreateInternalPayloadFromCallerOwnedBytes) {
+  bool released = false;
+  std::unique_ptr<InternalPayload> internal_payload =
+      CreateOutgoingInternalPayload(Payload(
+          kText, sizeof(kText) - 1, [&released]() { released = true; }));
+  ASSERT_NE(internal_payload, nullptr);
+  EXPECT_EQ(internal_payload->GetTotalSize(), sizeof(kText) - 1);
+
+  EXPECT_EQ(internal_payload->DetachNextChunk(512), ByteArray(kText));
+  EXPECT_TRUE(internal_payload->DetachNextChunk(512).Empty());
+  EXPECT_FALSE(released);
+  internal_payload.reset();
+  EXPECT_TRUE(released);
+}
+
 TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromStreamPayload) {
   auto pipe = std::make_shared<Pipe>();
   std::unique_ptr<InternalPayload> internal_payload =
@@ -56,6 +83,48 @@ TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromStreamPayload) {
   EXPECT_EQ(payload.AsBytes(), ByteArray());
 }
 
+TEST(InternalPayloadFactoryTest, ReadAheadStreamCoalescesWrites) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kOutgoingStreamReadAheadLingerMillis,
+      absl::ToInt64Milliseconds(absl::Seconds(10)));
+  auto pipe = std::make_shared<Pipe>();
+  std::unique_ptr<InternalPayload> internal_payload =
+      CreateOutgoingInternalPayload(Payload{[pipe]() -> InputStream& {
+        return pipe->GetInputStream();  // NOLINT
+      }});
+  ASSERT_NE(internal_payload, nullptr);
+
+  EXPECT_TRUE(pipe->GetOutputStream().Write(ByteArray("data ")).Ok());
+  EXPECT_TRUE(pipe->GetOutputStream().Write(ByteArray("chunk")).Ok());
+  EXPECT_EQ(internal_payload->DetachNextChunk(sizeof(kText) - 1),
+            ByteArray(kText));
+
+  pipe->GetOutputStream().Close();
+  EXPECT_TRUE(internal_payload->DetachNextChunk(sizeof(kText) - 1).Empty());
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST(InternalPayloadFactoryTest, ReadAheadStreamSendsPartialChunkAfterLinger) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kOutgoingStreamReadAheadLingerMillis,
+      10);
+  auto pipe = std::make_shared<Pipe>();
+  std::unique_ptr<InternalPayload> internal_payload =
+      CreateOutgoingInternalPayload(Payload{[pipe]() -> InputStream& {
+        return pipe->GetInputStream();  // NOLINT
+      }});
+  ASSERT_NE(internal_payload, nullptr);
+
+  EXPECT_TRUE(pipe->GetOutputStream().Write(ByteArray(kText)).Ok());
+  EXPECT_EQ(internal_payload->DetachNextChunk(512), ByteArray(kText));
+
+  // The payload closes the stream even while the read-ahead is blocked on it.
+  internal_payload.reset();
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromFilePayload) {
   Payload::Id payload_id = Payload::GenerateId();
   InputFile inputFile(payload_id, 512);
@@ -93,6 +162,54 @@ TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromByteMessage) {
   EXPECT_EQ(payload.AsBytes(), ByteArray(kText));
 }
 
+TEST(InternalPayloadFactoryTest, CreatesByteMessageInClientBuffer) {
+  PayloadTransferFrame frame;
+  frame.set_packet_type(PayloadTransferFrame::DATA);
+  auto& header = *frame.mutable_payload_header();
+  header.set_type(PayloadTransferFrame::PayloadHeader::BYTES);
+  header.set_id(12345);
+  header.set_total_size(sizeof(kText) - 1);
+  frame.mutable_payload_chunk()->set_offset(0);
+  frame.mutable_payload_chunk()->set_body(kText);
+  std::string buffer;
+  bool released = false;
+  std::unique_ptr<InternalPayload> internal_payload =
+      CreateIncomingInternalPayload(
+          frame, "C:\\Downloads", nullptr, {}, nullptr,
+          [&buffer, &released](size_t size) {
+            buffer.resize(size);
+            return IncomingBytesBuffer{
+                .data = buffer.data(),
+                .release = [&released]() { released = true; }};
+          });
+  ASSERT_NE(internal_payload, nullptr);
+  {
+    Payload payload = internal_payload->ReleasePayload();
+    EXPECT_EQ(payload.GetId(), 12345);
+    EXPECT_EQ(payload.AsBytesView().data(), buffer.data());
+    EXPECT_EQ(payload.AsBytesView(), kText);
+    EXPECT_FALSE(released);
+  }
+  EXPECT_TRUE(released);
+}
+
+TEST(InternalPayloadFactoryTest, FallsBackToByteArrayWithoutClientBuffer) {
+  PayloadTransferFrame frame;
+  frame.set_packet_type(PayloadTransferFrame::DATA);
+  auto& header = *frame.mutable_payload_header();
+  header.set_type(PayloadTransferFrame::PayloadHeader::BYTES);
+  header.set_id(12345);
+  header.set_total_size(sizeof(kText) - 1);
+  frame.mutable_payload_chunk()->set_offset(0);
+  frame.mutable_payload_chunk()->set_body(kText);
+  std::unique_ptr<InternalPayload> internal_payload =
+      CreateIncomingInternalPayload(
+          frame, "C:\\Downloads", nullptr, {}, nullptr,
+          [](size_t) { return IncomingBytesBuffer{}; });
+  ASSERT_NE(internal_payload, nullptr);
+  EXPECT_EQ(internal_payload->ReleasePayload().AsBytes(), ByteArray(kText));
+}
+
 TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromStreamMessage) {
   PayloadTransferFrame frame;
   std::string path = "C:\\Downloads";
@@ -229,6 +346,267 @@ TEST(InternalPayloadFactoryTest,
   EXPECT_EQ(contents_after_skip, ByteArray("6789"));
 }
 
+TEST(InternalPayloadFactoryTest, BatchedIncomingFileWritesKeepChunkOrder) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableBatchedIncomingFileWrites,
+      true);
+  PayloadTransferFrame frame;
+  frame.set_packet_type(PayloadTransferFrame::DATA);
+  auto& header = *frame.mutable_payload_header();
+  header.set_type(PayloadTransferFrame::PayloadHeader::FILE);
+  header.set_id(Payload::GenerateId());
+  header.set_total_size(10);
+  std::unique_ptr<InternalPayload> internal_payload =
+      CreateIncomingInternalPayload(frame, "");
+  ASSERT_NE(internal_payload, nullptr);
+  std::string parent_folder;
+  std::string file_path = api::ImplementationPlatform::GetDownloadPath(
+      parent_folder, std::to_string(header.id()));
+
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray("0123")).Ok());
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray("456789")).Ok());
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray()).Ok());
+
+  InputFile file(file_path, 10);
+  ExceptionOr<ByteArray> contents = file.Read(512);
+  ASSERT_TRUE(contents.ok());
+  EXPECT_EQ(contents.result(), ByteArray("0123456789"));
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST(InternalPayloadFactoryTest, BatchedIncomingFileWritesFlushAfterDelay) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableBatchedIncomingFileWrites,
+      true);
+  PayloadTransferFrame frame;
+  frame.set_packet_type(PayloadTransferFrame::DATA);
+  auto& header = *frame.mutable_payload_header();
+  header.set_type(PayloadTransferFrame::PayloadHeader::FILE);
+  header.set_id(Payload::GenerateId());
+  header.set_total_size(10);
+  std::unique_ptr<InternalPayload> internal_payload =
+      CreateIncomingInternalPayload(frame, "");
+  ASSERT_NE(internal_payload, nullptr);
+  std::string parent_folder;
+  std::string file_path = api::ImplementationPlatform::GetDownloadPath(
+      parent_folder, std::to_string(header.id()));
+
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray("0123")).Ok());
+  absl::SleepFor(absl::Milliseconds(1100));
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray("45")).Ok());
+
+  InputFile file(file_path, 10);
+  ExceptionOr<ByteArray> contents = file.Read(6);
+  ASSERT_TRUE(contents.ok());
+  EXPECT_EQ(contents.result(), ByteArray("012345"));
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray()).Ok());
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST(InternalPayloadFactoryTest, AsyncIncomingFileWritesKeepChunkOrder) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableAsyncIncomingFileWrites,
+      true);
+  PayloadTransferFrame frame;
+  frame.set_packet_type(PayloadTransferFrame::DATA);
+  auto& header = *frame.mutable_payload_header();
+  header.set_type(PayloadTransferFrame::PayloadHeader::FILE);
+  header.set_id(Payload::GenerateId());
+  header.set_total_size(10);
+  std::unique_ptr<InternalPayload> internal_payload =
+      CreateIncomingInternalPayload(frame, "");
+  ASSERT_NE(internal_payload, nullptr);
+  std::string parent_folder;
+  std::string file_path = api::ImplementationPlatform::GetDownloadPath(
+      parent_folder, std::to_string(header.id()));
+
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray("0123")).Ok());
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray("456")).Ok());
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray("789")).Ok());
+  // The last chunk returns once everything before it is written.
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray()).Ok());
+
+  InputFile file(file_path, 10);
+  ExceptionOr<ByteArray> contents = file.Read(512);
+  ASSERT_TRUE(contents.ok());
+  EXPECT_EQ(contents.result(), ByteArray("0123456789"));
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST(InternalPayloadFactoryTest, BoundedIncomingStreamDeliversChunks) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kIncomingStreamPipeCapacity,
+      1);
+  PayloadTransferFrame frame;
+  frame.set_packet_type(PayloadTransferFrame::DATA);
+  auto& header = *frame.mutable_payload_header();
+  header.set_type(PayloadTransferFrame::PayloadHeader::STREAM);
+  header.set_id(12345);
+  header.set_total_size(0);
+  std::unique_ptr<InternalPayload> internal_payload =
+      CreateIncomingInternalPayload(frame, "");
+  ASSERT_NE(internal_payload, nullptr);
+  Payload payload = internal_payload->ReleasePayload();
+  ASSERT_NE(payload.AsStream(), nullptr);
+
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray(kText)).Ok());
+  ExceptionOr<ByteArray> read_data = payload.AsStream()->Read(Pipe::kChunkSize);
+  ASSERT_TRUE(read_data.ok());
+  EXPECT_EQ(read_data.result(), ByteArray(kText));
+
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray()).Ok());
+  read_data = payload.AsStream()->Read(Pipe::kChunkSize);
+  ASSERT_TRUE(read_data.ok());
+  EXPECT_TRUE(read_data.result().Empty());
+  internal_payload->Close();
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST(InternalPayloadFactoryTest, IncomingStreamAccountsForUnreadChunks) {
+  std::shared_ptr<MemoryAccountant> accountant = MemoryAccountant::Create();
+  PayloadTransferFrame frame;
+  frame.set_packet_type(PayloadTransferFrame::DATA);
+  auto& header = *frame.mutable_payload_header();
+  header.set_type(PayloadTransferFrame::PayloadHeader::STREAM);
+  header.set_id(12345);
+  header.set_total_size(0);
+  std::unique_ptr<InternalPayload> internal_payload =
+      CreateIncomingInternalPayload(frame, "", accountant.get(), "ABCD");
+  ASSERT_NE(internal_payload, nullptr);
+  Payload payload = internal_payload->ReleasePayload();
+  ASSERT_NE(payload.AsStream(), nullptr);
+
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray(kText)).Ok());
+  EXPECT_EQ(accountant->GetEndpointUsage("ABCD").live_bytes, sizeof(kText) - 1);
+  EXPECT_EQ(accountant->GetPayloadUsage(12345).live_bytes, sizeof(kText) - 1);
+
+  ExceptionOr<ByteArray> read_data = payload.AsStream()->Read(Pipe::kChunkSize);
+  ASSERT_TRUE(read_data.ok());
+  EXPECT_EQ(read_data.result(), ByteArray(kText));
+  EXPECT_EQ(accountant->GetEndpointUsage("ABCD").live_bytes, 0);
+  EXPECT_EQ(accountant->GetEndpointUsage("ABCD").high_water_bytes,
+            sizeof(kText) - 1);
+  internal_payload->Close();
+}
+
+TEST(InternalPayloadFactoryTest, IncomingStreamReportsBytesRead) {
+  std::vector<std::int64_t> bytes_read;
+  PayloadTransferFrame frame;
+  frame.set_packet_type(PayloadTransferFrame::DATA);
+  auto& header = *frame.mutable_payload_header();
+  header.set_type(PayloadTransferFrame::PayloadHeader::STREAM);
+  header.set_id(12345);
+  header.set_total_size(0);
+  std::unique_ptr<InternalPayload> internal_payload =
+      CreateIncomingInternalPayload(
+          frame, "", nullptr, "ABCD",
+          [&bytes_read](std::int64_t read) { bytes_read.push_back(read); });
+  ASSERT_NE(internal_payload, nullptr);
+  Payload payload = internal_payload->ReleasePayload();
+  ASSERT_NE(payload.AsStream(), nullptr);
+
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray(kText)).Ok());
+  ASSERT_TRUE(payload.AsStream()->Read(Pipe::kChunkSize).ok());
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray(kText)).Ok());
+  ASSERT_TRUE(payload.AsStream()->Read(Pipe::kChunkSize).ok());
+
+  EXPECT_THAT(bytes_read,
+              ElementsAre(sizeof(kText) - 1, 2 * (sizeof(kText) - 1)));
+  internal_payload->Close();
+}
+
+TEST(InternalPayloadFactoryTest, FileBatchRoundTrip) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableFileBatchPayloads,
+      true);
+  std::string id = std::to_string(Payload::GenerateId());
+  std::vector<std::string> contents = {"0123456789", "", "abc"};
+  std::vector<Payload::BatchFile> files;
+  for (int i = 0; i < contents.size(); ++i) {
+    std::string path =
+        absl::StrCat(testing::TempDir(), "/source_", id, "_", i);
+    OutputFile output_file(path);
+    output_file.Write(ByteArray(contents[i]));
+    output_file.Close();
+    files.push_back({.parent_folder = i == 2 ? "sub" : "",
+                     .file_name = absl::StrCat(id, "_", i),
+                     .file = InputFile(path, contents[i].size())});
+  }
+  std::unique_ptr<InternalPayload> outgoing =
+      CreateOutgoingInternalPayload(Payload("batch", std::move(files)));
+  ASSERT_NE(outgoing, nullptr);
+
+  PayloadTransferFrame frame;
+  frame.set_packet_type(PayloadTransferFrame::DATA);
+  auto& header = *frame.mutable_payload_header();
+  header.set_type(outgoing->GetType());
+  header.set_id(outgoing->GetId());
+  header.set_parent_folder("batch");
+  header.set_total_size(outgoing->GetTotalSize());
+  frame.mutable_payload_chunk()->set_offset(0);
+  ByteArray first_chunk = outgoing->DetachNextChunk(4);
+  frame.mutable_payload_chunk()->set_body(std::string(first_chunk));
+  std::unique_ptr<InternalPayload> incoming =
+      CreateIncomingInternalPayload(frame, "");
+  ASSERT_NE(incoming, nullptr);
+  Payload payload = incoming->ReleasePayload();
+  EXPECT_EQ(payload.GetType(), PayloadType::kFileBatch);
+  EXPECT_EQ(payload.GetParentFolder(), "batch");
+  ASSERT_NE(payload.AsFileBatch(), nullptr);
+  ASSERT_EQ(payload.AsFileBatch()->size(), 3);
+  EXPECT_EQ(payload.AsFileBatch()->at(2).parent_folder, "sub");
+
+  // Chunks span files.
+  EXPECT_TRUE(incoming->AttachNextChunk(first_chunk).Ok());
+  std::vector<ByteArray> chunks;
+  for (ByteArray chunk = outgoing->DetachNextChunk(4); !chunk.Empty();
+       chunk = outgoing->DetachNextChunk(4)) {
+    EXPECT_TRUE(incoming->AttachNextChunk(chunk).Ok());
+    chunks.push_back(std::move(chunk));
+  }
+  EXPECT_THAT(chunks, ElementsAre(ByteArray("0123"), ByteArray("4567"),
+                                  ByteArray("89ab"), ByteArray("c")));
+  EXPECT_TRUE(incoming->AttachNextChunk(ByteArray()).Ok());
+
+  for (int i = 0; i < contents.size(); ++i) {
+    InputFile file(payload.AsFileBatch()->at(i).file.GetFilePath(),
+                   contents[i].size());
+    if (contents[i].empty()) continue;
+    ExceptionOr<ByteArray> read = file.Read(512);
+    ASSERT_TRUE(read.ok());
+    EXPECT_EQ(read.result(), ByteArray(contents[i]));
+  }
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST(InternalPayloadFactoryTest, RejectsFileBatchLeavingItsFolder) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableFileBatchPayloads,
+      true);
+  PayloadTransferFrame::FileBatch file_batch;
+  auto& file = *file_batch.add_files();
+  file.set_file_name("passwd");
+  file.set_parent_folder("../../etc");
+  file.set_size(0);
+  PayloadTransferFrame frame;
+  frame.set_packet_type(PayloadTransferFrame::DATA);
+  auto& header = *frame.mutable_payload_header();
+  header.set_type(PayloadTransferFrame::PayloadHeader::FILE_BATCH);
+  header.set_id(Payload::GenerateId());
+  header.set_total_size(file_batch.ByteSizeLong());
+  frame.mutable_payload_chunk()->set_offset(0);
+  frame.mutable_payload_chunk()->set_body(file_batch.SerializeAsString());
+
+  EXPECT_EQ(CreateIncomingInternalPayload(frame, ""), nullptr);
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 }  // namespace
 }  // namespace connections
 }  // namespace nearby
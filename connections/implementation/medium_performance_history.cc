@@ -0,0 +1,197 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/medium_performance_history.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/escaping.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "nlohmann/json.hpp"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/crypto.h"
+#include "internal/platform/mutex_lock.h"
+
+namespace nearby {
+namespace connections {
+
+namespace {
+
+// Bytes of the endpoint info hash kept in a peer ID.
+constexpr int kPeerIdBytes = 8;
+
+double Average(double average, double sample) {
+  if (average == 0) return sample;
+  return average +
+         MediumPerformanceHistory::kSampleWeight * (sample - average);
+}
+
+}  // namespace
+
+MediumPerformanceHistory::MediumPerformanceHistory(
+    api::PreferencesManager* preferences)
+    : preferences_(preferences) {
+  MutexLock lock(&mutex_);
+  LoadLocked();
+}
+
+std::string MediumPerformanceHistory::GetPeerId(
+    const ByteArray& endpoint_info) {
+  if (endpoint_info.Empty()) return {};
+  ByteArray hash = Crypto::Sha256(std::string(endpoint_info));
+  return absl::BytesToHexString(
+      absl::string_view(hash.data(), std::min<size_t>(hash.size(),
+                                                      kPeerIdBytes)));
+}
+
+void MediumPerformanceHistory::RecordAttempt(absl::string_view peer_id,
+                                             Medium medium, bool success,
+                                             absl::Duration upgrade_time) {
+  if (peer_id.empty()) return;
+  MutexLock lock(&mutex_);
+  Stats& stats = GetStatsLocked(peer_id, medium);
+  stats.attempts++;
+  if (!success) stats.failures++;
+  if (success && upgrade_time > absl::ZeroDuration()) {
+    stats.upgrade_time = absl::Seconds(
+        Average(absl::ToDoubleSeconds(stats.upgrade_time),
+                absl::ToDoubleSeconds(upgrade_time)));
+  }
+  SaveLocked();
+}
+
+void MediumPerformanceHistory::RecordThroughput(absl::string_view peer_id,
+                                                Medium medium,
+                                                double bytes_per_second,
+                                                std::int64_t bytes) {
+  if (peer_id.empty() || bytes < kMinThroughputSampleBytes ||
+      bytes_per_second <= 0) {
+    return;
+  }
+  MutexLock lock(&mutex_);
+  Stats& stats = GetStatsLocked(peer_id, medium);
+  stats.bytes_per_second = Average(stats.bytes_per_second, bytes_per_second);
+  SaveLocked();
+}
+
+std::vector<MediumPerformanceHistory::Medium> MediumPerformanceHistory::Rank(
+    absl::string_view peer_id, std::vector<Medium> mediums) const {
+  MutexLock lock(&mutex_);
+  auto peer = peers_.find(peer_id);
+  if (peer == peers_.end()) return mediums;
+
+  auto get_key = [&peer](Medium medium) {
+    auto stats = peer->second.mediums.find(medium);
+    if (stats == peer->second.mediums.end()) {
+      return std::make_pair(1, 0.0);
+    }
+    int tier = GetTier(stats->second);
+    // Mediums that did well, or are slow, are tried fastest first.
+    double bytes_per_second =
+        tier == 0 || tier == 2 ? stats->second.bytes_per_second : 0;
+    return std::make_pair(tier, -bytes_per_second);
+  };
+  std::stable_sort(mediums.begin(), mediums.end(),
+                   [&get_key](Medium a, Medium b) {
+                     return get_key(a) < get_key(b);
+                   });
+  return mediums;
+}
+
+int MediumPerformanceHistory::GetTier(const Stats& stats) {
+  if (stats.attempts >= kMinAttempts &&
+      stats.failures > kMaxFailureRate * stats.attempts) {
+    return 3;
+  }
+  if ((stats.bytes_per_second > 0 &&
+       stats.bytes_per_second < kMinBytesPerSecond) ||
+      stats.upgrade_time > kMaxUpgradeTime) {
+    return 2;
+  }
+  if (stats.bytes_per_second > 0) return 0;
+  return 1;
+}
+
+MediumPerformanceHistory::Stats& MediumPerformanceHistory::GetStatsLocked(
+    absl::string_view peer_id, Medium medium) {
+  peers_[peer_id].last_seen = absl::Now();
+  if (peers_.size() > kMaxPeers) {
+    auto oldest = std::min_element(
+        peers_.begin(), peers_.end(), [](const auto& a, const auto& b) {
+          return a.second.last_seen < b.second.last_seen;
+        });
+    peers_.erase(oldest);
+  }
+  // Erasing may have moved the peer.
+  return peers_[peer_id].mediums[medium];
+}
+
+void MediumPerformanceHistory::LoadLocked() {
+  if (preferences_ == nullptr) return;
+  nlohmann::json history =
+      preferences_->Get(kPreferencesKey, nlohmann::json::object());
+  if (!history.is_object()) return;
+  for (const auto& [peer_id, peer_json] : history.items()) {
+    if (!peer_json.is_object()) continue;
+    Peer peer;
+    peer.last_seen = absl::FromUnixSeconds(peer_json.value("last_seen", 0));
+    auto mediums = peer_json.find("mediums");
+    if (mediums == peer_json.end() || !mediums->is_object()) continue;
+    for (const auto& [medium_name, stats_json] : mediums->items()) {
+      Medium medium;
+      if (!location::nearby::proto::connections::Medium_Parse(medium_name,
+                                                              &medium) ||
+          !stats_json.is_object()) {
+        continue;
+      }
+      Stats& stats = peer.mediums[medium];
+      stats.attempts = stats_json.value("attempts", 0);
+      stats.failures = stats_json.value("failures", 0);
+      stats.bytes_per_second = stats_json.value("bytes_per_second", 0.0);
+      stats.upgrade_time =
+          absl::Milliseconds(stats_json.value("upgrade_millis", 0));
+    }
+    peers_.emplace(peer_id, std::move(peer));
+  }
+}
+
+void MediumPerformanceHistory::SaveLocked() {
+  if (preferences_ == nullptr) return;
+  nlohmann::json history = nlohmann::json::object();
+  for (const auto& [peer_id, peer] : peers_) {
+    nlohmann::json mediums = nlohmann::json::object();
+    for (const auto& [medium, stats] : peer.mediums) {
+      mediums[location::nearby::proto::connections::Medium_Name(medium)] = {
+          {"attempts", stats.attempts},
+          {"failures", stats.failures},
+          {"bytes_per_second", stats.bytes_per_second},
+          {"upgrade_millis", absl::ToInt64Milliseconds(stats.upgrade_time)},
+      };
+    }
+    history[peer_id] = {
+        {"last_seen", absl::ToUnixSeconds(peer.last_seen)},
+        {"mediums", std::move(mediums)},
+    };
+  }
+  preferences_->Set(kPreferencesKey, history);
+}
+
+}  // namespace connections
+}  // namespace nearby
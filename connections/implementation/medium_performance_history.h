@@ -0,0 +1,118 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_MEDIUM_PERFORMANCE_HISTORY_H_
+#define CORE_INTERNAL_MEDIUM_PERFORMANCE_HISTORY_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/implementation/preferences_manager.h"
+#include "internal/platform/mutex.h"
+#include "proto/connections_enums.pb.h"
+
+namespace nearby {
+namespace connections {
+
+// Remembers how well each medium did with each remote device: how often
+// connecting or upgrading to it failed, how long upgrading took, and the
+// throughput it achieved. Ranks mediums for a device based on that, so that a
+// medium that is available but does badly with it, e.g. WIFI_LAN behind an
+// access point isolating its clients, is tried after the others next time.
+//
+// Kept in |preferences|, if given, so that it outlives the process.
+//
+// Thread-safe.
+class MediumPerformanceHistory {
+ public:
+  using Medium = ::location::nearby::proto::connections::Medium;
+
+  // Failure rates are only trusted after this many attempts.
+  static constexpr int kMinAttempts = 2;
+  // Mediums failing more often than this are tried last.
+  static constexpr double kMaxFailureRate = 0.5;
+  // Mediums slower than this, or taking longer than kMaxUpgradeTime to upgrade
+  // to, are tried after the mediums without history.
+  static constexpr double kMinBytesPerSecond = 256 * 1024;
+  static constexpr absl::Duration kMaxUpgradeTime = absl::Seconds(10);
+  // Throughput is only recorded once this much has been transferred.
+  static constexpr std::int64_t kMinThroughputSampleBytes = 1024 * 1024;
+  // Weight of the latest sample in the averages of throughput and upgrade
+  // time.
+  static constexpr double kSampleWeight = 0.3;
+  // The least recently seen devices are forgotten beyond this.
+  static constexpr int kMaxPeers = 64;
+  static constexpr char kPreferencesKey[] = "nearby_connections_medium_history";
+
+  explicit MediumPerformanceHistory(
+      api::PreferencesManager* preferences = nullptr);
+
+  // Identifies a remote device across connections by its endpoint info.
+  // Empty if |endpoint_info| is.
+  static std::string GetPeerId(const ByteArray& endpoint_info);
+
+  // Records an attempt to connect or upgrade to |medium|. |upgrade_time| is
+  // how long a successful upgrade took, or zero if unknown.
+  void RecordAttempt(absl::string_view peer_id, Medium medium, bool success,
+                     absl::Duration upgrade_time = absl::ZeroDuration());
+
+  // Records the throughput achieved over |medium|, if at least
+  // kMinThroughputSampleBytes were transferred.
+  void RecordThroughput(absl::string_view peer_id, Medium medium,
+                        double bytes_per_second, std::int64_t bytes);
+
+  // Returns |mediums|, ordered from the most to the least promising for
+  // |peer_id|. Mediums without history keep their order relative to each
+  // other, and come after the ones that did well and before the ones that
+  // didn't.
+  std::vector<Medium> Rank(absl::string_view peer_id,
+                           std::vector<Medium> mediums) const;
+
+ private:
+  struct Stats {
+    int attempts = 0;
+    int failures = 0;
+    // Zero if unknown.
+    double bytes_per_second = 0;
+    absl::Duration upgrade_time = absl::ZeroDuration();
+  };
+  struct Peer {
+    absl::flat_hash_map<Medium, Stats> mediums;
+    absl::Time last_seen = absl::UnixEpoch();
+  };
+
+  // Returns 0 for mediums that did well, 1 for those without history, 2 for
+  // slow ones and 3 for failing ones.
+  static int GetTier(const Stats& stats);
+
+  Stats& GetStatsLocked(absl::string_view peer_id, Medium medium)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void LoadLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void SaveLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  api::PreferencesManager* const preferences_;
+  mutable Mutex mutex_;
+  absl::flat_hash_map<std::string, Peer> peers_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_MEDIUM_PERFORMANCE_HISTORY_H_
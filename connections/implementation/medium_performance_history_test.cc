@@ -0,0 +1,132 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/medium_performance_history.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/implementation/platform.h"
+#include "internal/platform/implementation/preferences_manager.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+using ::location::nearby::proto::connections::BLUETOOTH;
+using ::location::nearby::proto::connections::WEB_RTC;
+using ::location::nearby::proto::connections::WIFI_HOTSPOT;
+using ::location::nearby::proto::connections::WIFI_LAN;
+using ::testing::ElementsAre;
+
+constexpr char kPeerId[] = "peer";
+constexpr std::int64_t kSampleBytes =
+    MediumPerformanceHistory::kMinThroughputSampleBytes;
+
+TEST(MediumPerformanceHistoryTest, GetPeerIdIsStable) {
+  ByteArray endpoint_info("endpoint info");
+
+  EXPECT_FALSE(MediumPerformanceHistory::GetPeerId(endpoint_info).empty());
+  EXPECT_EQ(MediumPerformanceHistory::GetPeerId(endpoint_info),
+            MediumPerformanceHistory::GetPeerId(ByteArray("endpoint info")));
+  EXPECT_NE(MediumPerformanceHistory::GetPeerId(endpoint_info),
+            MediumPerformanceHistory::GetPeerId(ByteArray("other info")));
+  EXPECT_TRUE(MediumPerformanceHistory::GetPeerId(ByteArray()).empty());
+}
+
+TEST(MediumPerformanceHistoryTest, KeepsOrderWithoutHistory) {
+  MediumPerformanceHistory history;
+
+  EXPECT_THAT(history.Rank(kPeerId, {WIFI_LAN, WIFI_HOTSPOT, BLUETOOTH}),
+              ElementsAre(WIFI_LAN, WIFI_HOTSPOT, BLUETOOTH));
+}
+
+TEST(MediumPerformanceHistoryTest, TriesFailingMediumLast) {
+  MediumPerformanceHistory history;
+
+  history.RecordAttempt(kPeerId, WIFI_LAN, /*success=*/false);
+  history.RecordAttempt(kPeerId, WIFI_LAN, /*success=*/false);
+
+  EXPECT_THAT(history.Rank(kPeerId, {WIFI_LAN, WIFI_HOTSPOT, BLUETOOTH}),
+              ElementsAre(WIFI_HOTSPOT, BLUETOOTH, WIFI_LAN));
+  // Other devices are unaffected.
+  EXPECT_THAT(history.Rank("other peer", {WIFI_LAN, WIFI_HOTSPOT}),
+              ElementsAre(WIFI_LAN, WIFI_HOTSPOT));
+}
+
+TEST(MediumPerformanceHistoryTest, SingleFailureIsNotTrusted) {
+  MediumPerformanceHistory history;
+
+  history.RecordAttempt(kPeerId, WIFI_LAN, /*success=*/false);
+
+  EXPECT_THAT(history.Rank(kPeerId, {WIFI_LAN, WIFI_HOTSPOT}),
+              ElementsAre(WIFI_LAN, WIFI_HOTSPOT));
+}
+
+TEST(MediumPerformanceHistoryTest, TriesFastestMediumFirst) {
+  MediumPerformanceHistory history;
+
+  history.RecordThroughput(kPeerId, WIFI_HOTSPOT, 10e6, kSampleBytes);
+  history.RecordThroughput(kPeerId, WEB_RTC, 20e6, kSampleBytes);
+  history.RecordThroughput(kPeerId, BLUETOOTH, 10e3, kSampleBytes);
+
+  EXPECT_THAT(
+      history.Rank(kPeerId, {BLUETOOTH, WIFI_LAN, WIFI_HOTSPOT, WEB_RTC}),
+      ElementsAre(WEB_RTC, WIFI_HOTSPOT, WIFI_LAN, BLUETOOTH));
+}
+
+TEST(MediumPerformanceHistoryTest, IgnoresSmallThroughputSamples) {
+  MediumPerformanceHistory history;
+
+  history.RecordThroughput(kPeerId, WIFI_LAN, 10e3, kSampleBytes - 1);
+
+  EXPECT_THAT(history.Rank(kPeerId, {WIFI_LAN, WIFI_HOTSPOT}),
+              ElementsAre(WIFI_LAN, WIFI_HOTSPOT));
+}
+
+TEST(MediumPerformanceHistoryTest, TriesSlowUpgradeAfterOthers) {
+  MediumPerformanceHistory history;
+
+  history.RecordAttempt(kPeerId, WIFI_HOTSPOT, /*success=*/true,
+                        absl::Seconds(30));
+
+  EXPECT_THAT(history.Rank(kPeerId, {WIFI_HOTSPOT, WIFI_LAN}),
+              ElementsAre(WIFI_LAN, WIFI_HOTSPOT));
+}
+
+TEST(MediumPerformanceHistoryTest, KeepsHistoryInPreferences) {
+  std::unique_ptr<api::PreferencesManager> preferences =
+      api::ImplementationPlatform::CreatePreferencesManager(
+          "medium_performance_history_test");
+  preferences->Remove(MediumPerformanceHistory::kPreferencesKey);
+  {
+    MediumPerformanceHistory history(preferences.get());
+    history.RecordAttempt(kPeerId, WIFI_LAN, /*success=*/false);
+    history.RecordAttempt(kPeerId, WIFI_LAN, /*success=*/false);
+  }
+
+  MediumPerformanceHistory history(preferences.get());
+
+  EXPECT_THAT(history.Rank(kPeerId, {WIFI_LAN, WIFI_HOTSPOT}),
+              ElementsAre(WIFI_HOTSPOT, WIFI_LAN));
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
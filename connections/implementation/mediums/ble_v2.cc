@@ -56,7 +56,12 @@ void AssumeHeld(Mutex& m) ABSL_ASSERT_EXCLUSIVE_LOCK(m) {}
 }  // namespace
 
 BleV2::BleV2(BluetoothRadio& radio)
-    : radio_(radio), adapter_(radio_.GetBluetoothAdapter()) {}
+    : radio_(radio),
+      adapter_(radio_.GetBluetoothAdapter()),
+      gatt_client_pool_(absl::Milliseconds(std::max<int64_t>(
+          0, NearbyFlags::GetInstance().GetInt64Flag(
+                 config_package_nearby::nearby_connections_feature::
+                     kBleGattClientIdleTimeoutMillis)))) {}
 
 BleV2::~BleV2() {
   // Destructor is not taking locks, but methods it is calling are.
@@ -93,11 +98,19 @@ bool BleV2::StartAdvertising(const std::string& service_id,
     return false;
   }
 
-  if (advertisement_bytes.size() > kMaxAdvertisementLength) {
+  // With extended advertising, a regular advertisement doesn't have to fit in
+  // a GATT characteristic.
+  bool extended_advertisement =
+      !is_fast_advertisement && medium_.IsExtendedAdvertisementsAvailable();
+  int max_advertisement_length =
+      extended_advertisement
+          ? mediums::BleAdvertisement::kMaxExtendedAdvertisementLength
+          : kMaxAdvertisementLength;
+  if (advertisement_bytes.size() > max_advertisement_length) {
     NEARBY_LOG(INFO,
                "Refusing to start BLE advertising because the advertisement "
                "was too long. Expected at most %d bytes but received %d.",
-               kMaxAdvertisementLength, advertisement_bytes.size());
+               max_advertisement_length, advertisement_bytes.size());
     return false;
   }
 
@@ -121,16 +134,20 @@ bool BleV2::StartAdvertising(const std::string& service_id,
   // Wrap the connections advertisement to the medium advertisement.
   ByteArray service_id_hash = mediums::bleutils::GenerateHash(
       service_id, mediums::BleAdvertisement::kServiceIdHashLength);
-  // Get psm value from L2CAP server if L2CAP is supported. Now just use the
-  // default value.
+  // Get psm value from L2CAP server if L2CAP is supported.
   int psm = mediums::BleAdvertisementHeader::kDefaultPsmValue;
+  const auto l2cap_it = l2cap_server_sockets_.find(service_id);
+  if (l2cap_it != l2cap_server_sockets_.end()) {
+    psm = l2cap_it->second.GetPsm();
+  }
   mediums::BleAdvertisement medium_advertisement = {
       mediums::BleAdvertisement::Version::kV2,
       mediums::BleAdvertisement::SocketVersion::kV2,
       /*service_id_hash=*/is_fast_advertisement ? ByteArray{} : service_id_hash,
       advertisement_bytes,
       mediums::bleutils::GenerateDeviceToken(),
-      psm};
+      psm,
+      extended_advertisement};
   if (!medium_advertisement.IsValid()) {
     NEARBY_LOGS(INFO) << "Failed to BLE advertise because we could not wrap a "
                          "connection advertisement to medium advertisement.";
@@ -243,10 +260,30 @@ bool BleV2::StartScanning(const std::string& service_id, PowerLevel power_level,
     return false;
   }
 
+  // Check for lost peripherals every `lost_check_interval`, which divides the
+  // lost timeout into `lost_after_rounds` rounds.
+  absl::Duration peripheral_lost_timeout =
+      absl::Milliseconds(NearbyFlags::GetInstance().GetInt64Flag(
+          config_package_nearby::nearby_connections_feature::
+              kBlePeripheralLostTimeoutMillis));
+  absl::Duration lost_check_interval =
+      absl::Milliseconds(NearbyFlags::GetInstance().GetInt64Flag(
+          config_package_nearby::nearby_connections_feature::
+              kBlePeripheralLostCheckIntervalMillis));
+  int lost_after_rounds = 1;
+  if (lost_check_interval > absl::ZeroDuration() &&
+      lost_check_interval < peripheral_lost_timeout) {
+    lost_after_rounds = static_cast<int>(
+        absl::Ceil(peripheral_lost_timeout, lost_check_interval) /
+        lost_check_interval);
+  } else {
+    lost_check_interval = peripheral_lost_timeout;
+  }
+
   // Start to track the advertisement found for specific `service_id`.
   discovered_peripheral_tracker_.StartTracking(
       service_id, std::move(callback),
-      mediums::bleutils::kCopresenceServiceUuid);
+      mediums::bleutils::kCopresenceServiceUuid, lost_after_rounds);
 
   // Check if scan has been activated, if yes, no need to notify client
   // to scan again.
@@ -303,10 +340,6 @@ bool BleV2::StartScanning(const std::string& service_id, PowerLevel power_level,
     return false;
   }
 
-  absl::Duration peripheral_lost_timeout =
-      absl::Milliseconds(NearbyFlags::GetInstance().GetInt64Flag(
-          config_package_nearby::nearby_connections_feature::
-              kBlePeripheralLostTimeoutMillis));
   // Set up lost alarm.
   lost_alarm_ = std::make_unique<CancelableAlarm>(
       "BLE.StartScanning() onLost",
@@ -314,7 +347,7 @@ bool BleV2::StartScanning(const std::string& service_id, PowerLevel power_level,
         MutexLock lock(&mutex_);
         discovered_peripheral_tracker_.ProcessLostGattAdvertisements();
       },
-      peripheral_lost_timeout, &alarm_executor_, /*is_recurring=*/true);
+      lost_check_interval, &alarm_executor_, /*is_recurring=*/true);
 
   NEARBY_LOGS(INFO) << "Turned on BLE scanning with service id=" << service_id;
   return true;
@@ -343,6 +376,7 @@ bool BleV2::StopScanning(const std::string& service_id) {
   if (lost_alarm_->IsValid()) {
     lost_alarm_->Cancel();
   }
+  gatt_client_pool_.Clear();
   return medium_.StopScanning();
 }
 
@@ -394,14 +428,44 @@ bool BleV2::StartAcceptingConnections(const std::string& service_id,
   auto owned_server_socket =
       server_sockets_.insert({service_id, std::move(server_socket)})
           .first->second;
+  auto shared_callback =
+      std::make_shared<AcceptedConnectionCallback>(std::move(callback));
+  StartAcceptLoopLocked(service_id, std::move(owned_server_socket),
+                        shared_callback);
+
+  // Also listen on an L2CAP channel where the platform has them, so that
+  // peers can skip the GATT socket's per-packet overhead.
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableBleL2capChannels)) {
+    BleV2ServerSocket l2cap_server_socket =
+        medium_.OpenL2capServerSocket(service_id);
+    if (l2cap_server_socket.IsValid()) {
+      auto owned_l2cap_server_socket =
+          l2cap_server_sockets_
+              .insert({service_id, std::move(l2cap_server_socket)})
+              .first->second;
+      StartAcceptLoopLocked(service_id, std::move(owned_l2cap_server_socket),
+                            shared_callback);
+    } else {
+      NEARBY_LOGS(INFO) << "No L2CAP server socket for service_id="
+                        << service_id << ", accepting over GATT only.";
+    }
+  }
+
+  return true;
+}
 
+void BleV2::StartAcceptLoopLocked(
+    const std::string& service_id, BleV2ServerSocket server_socket,
+    std::shared_ptr<AcceptedConnectionCallback> callback) {
   // Start the accept loop on a dedicated thread - this stays alive and
   // listening for new incoming connections until StopAcceptingConnections() is
   // invoked.
   accept_loops_runner_.Execute(
       "ble-accept",
       [this, service_id = service_id, callback = std::move(callback),
-       server_socket = std::move(owned_server_socket)]() mutable {
+       server_socket = std::move(server_socket)]() mutable {
         while (true) {
           BleV2Socket client_socket = server_socket.Accept();
           if (!client_socket.IsValid()) {
@@ -417,11 +481,9 @@ bool BleV2::StartAcceptingConnections(const std::string& service_id,
             });
             incoming_sockets_.insert({service_id, client_socket});
           }
-          callback.accepted_cb(std::move(client_socket), service_id);
+          callback->accepted_cb(std::move(client_socket), service_id);
         }
       });
-
-  return true;
 }
 
 bool BleV2::StopAcceptingConnections(const std::string& service_id) {
@@ -440,6 +502,16 @@ bool BleV2::StopAcceptingConnections(const std::string& service_id) {
   // wait around for it.
   auto item = server_sockets_.extract(it);
 
+  const auto l2cap_it = l2cap_server_sockets_.find(service_id);
+  if (l2cap_it != l2cap_server_sockets_.end()) {
+    auto l2cap_item = l2cap_server_sockets_.extract(l2cap_it);
+    if (!l2cap_item.mapped().Close().Ok()) {
+      NEARBY_LOGS(INFO)
+          << "Failed to close Ble L2CAP server socket for service_id="
+          << service_id;
+    }
+  }
+
   // Store a handle to the BleServerSocket, so we can use it after
   // removing the entry from server_sockets_; making it scoped
   // is a bonus that takes care of deallocation before we leave this method.
@@ -488,6 +560,22 @@ BleV2Socket BleV2::Connect(const std::string& service_id,
     return socket;
   }
 
+  // Prefer the L2CAP channel when the peripheral advertised one.
+  int psm = peripheral.GetPsm();
+  if (psm != mediums::BleAdvertisementHeader::kDefaultPsmValue &&
+      NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableBleL2capChannels)) {
+    socket = medium_.ConnectOverL2cap(
+        psm, service_id, PowerLevelToTxPowerLevel(PowerLevel::kHighPower),
+        peripheral, cancellation_flag);
+    if (socket.IsValid()) return socket;
+    NEARBY_LOGS(INFO) << "Failed to Connect via Ble L2CAP [service_id="
+                      << service_id << ", psm=" << psm
+                      << "], falling back to GATT.";
+    if (cancellation_flag->Cancelled()) return socket;
+  }
+
   socket = medium_.Connect(service_id,
                            PowerLevelToTxPowerLevel(PowerLevel::kHighPower),
                            peripheral, cancellation_flag);
@@ -601,13 +689,18 @@ void BleV2::ProcessFetchGattAdvertisementsRequest(
     return;
   }
 
-  // Connect to a GATT server, reads advertisement data, and then disconnect
-  // from the GATT server.
+  // Connect to a GATT server, or reuse a pooled connection to it, and read
+  // advertisement data. The connection goes back to the pool afterwards.
+  // Peripherals without an address can't be pooled, so their connection is
+  // always dropped.
+  std::string address = peripheral.GetAddress().value_or("");
   bool read_success = true;
-  std::unique_ptr<GattClient> gatt_client = medium_.ConnectToGattServer(
-      std::move(peripheral), PowerLevelToTxPowerLevel(PowerLevel::kHighPower),
-      /*ClientGattConnectionCallback=*/{});
-  if (!gatt_client || !gatt_client->IsValid()) {
+  GattClient* gatt_client = gatt_client_pool_.Acquire(address, [&]() {
+    return medium_.ConnectToGattServer(
+        std::move(peripheral), PowerLevelToTxPowerLevel(PowerLevel::kHighPower),
+        /*ClientGattConnectionCallback=*/{});
+  });
+  if (gatt_client == nullptr) {
     advertisement_read_result.RecordLastReadStatus(false);
     return;
   }
@@ -635,6 +728,7 @@ void BleV2::ProcessFetchGattAdvertisementsRequest(
   if (slot_characteristic_uuids.empty()) {
     // TODO(b/222392304): More test coverage.
     NEARBY_LOGS(WARNING) << "GATT client doesn't have characteristics.";
+    gatt_client_pool_.Release(address, /*reusable=*/true);
     advertisement_read_result.RecordLastReadStatus(false);
     return;
   }
@@ -645,10 +739,12 @@ void BleV2::ProcessFetchGattAdvertisementsRequest(
                  slot_characteristic_uuids.end(),
                  std::back_inserter(characteristic_uuids),
                  [](auto& kv) { return kv.second; });
-  if (!gatt_client->DiscoverServiceAndCharacteristics(
-          mediums::bleutils::kCopresenceServiceUuid, characteristic_uuids)) {
+  if (!gatt_client_pool_.DiscoverServiceAndCharacteristics(
+          address, mediums::bleutils::kCopresenceServiceUuid,
+          characteristic_uuids)) {
     // TODO(b/222392304): More test coverage.
     NEARBY_LOGS(WARNING) << "GATT client doesn't have characteristics.";
+    gatt_client_pool_.Release(address, /*reusable=*/false);
     advertisement_read_result.RecordLastReadStatus(false);
     return;
   }
@@ -681,7 +777,7 @@ void BleV2::ProcessFetchGattAdvertisementsRequest(
     // other slots to get as many advertisements as possible before
     // returning a success or failure.
   }
-  gatt_client->Disconnect();
+  gatt_client_pool_.Release(address, /*reusable=*/read_success);
 
   advertisement_read_result.RecordLastReadStatus(read_success);
 }
@@ -704,9 +800,9 @@ ByteArray BleV2::CreateAdvertisementHeader(
       Utils::GenerateRandomBytes(kDummyServiceIdLength);
   std::string dummy_service_id{dummy_service_id_bytes};
 
-  mediums::BloomFilter bloom_filter(
-      std::make_unique<mediums::BitSetImpl<
-          mediums::BleAdvertisementHeader::kServiceIdBloomFilterByteLength>>());
+  mediums::FixedBloomFilter<
+      mediums::BleAdvertisementHeader::kServiceIdBloomFilterByteLength>
+      bloom_filter;
   bloom_filter.Add(dummy_service_id);
 
   ByteArray advertisement_hash =
@@ -804,6 +900,17 @@ bool BleV2::StartRegularAdvertisingLocked(
     }
   }
 
+  // An advertisement that doesn't fit in a GATT characteristic can only be
+  // discovered by scanners that support extended advertising.
+  if (medium_advertisement_bytes.size() > kMaxAdvertisementLength) {
+    if (extended_regular_advertisement_success) {
+      NEARBY_LOGS(INFO) << "Skipping BLE GATT advertising for service_id="
+                        << service_id << " because the advertisement is "
+                        << medium_advertisement_bytes.size() << " bytes long.";
+    }
+    return extended_regular_advertisement_success;
+  }
+
   // Start GATT advertisement no matter extended advertisment succeeded or not.
   // This is to ensure that legacy devices which don't support extended
   // advertisement can get the advertisement via GATT connection.
@@ -26,6 +26,7 @@
 #include "connections/implementation/mediums/ble_v2/advertisement_read_result.h"
 #include "connections/implementation/mediums/ble_v2/ble_advertisement.h"
 #include "connections/implementation/mediums/ble_v2/discovered_peripheral_tracker.h"
+#include "connections/implementation/mediums/ble_v2/gatt_client_pool.h"
 #include "connections/implementation/mediums/bluetooth_radio.h"
 #include "connections/power_level.h"
 #include "internal/platform/ble_v2.h"
@@ -149,6 +150,13 @@ class BleV2 final {
   bool IsAcceptingConnectionsLocked(const std::string& service_id)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Accepts connections on |server_socket| on a thread of
+  // |accept_loops_runner_| until it is closed.
+  void StartAcceptLoopLocked(
+      const std::string& service_id, BleV2ServerSocket server_socket,
+      std::shared_ptr<AcceptedConnectionCallback> callback)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   bool IsAdvertisementGattServerRunningLocked()
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
   bool StartAdvertisementGattServerLocked(const std::string& service_id,
@@ -189,9 +197,10 @@ class BleV2 final {
 
   void RunOnBleThread(Runnable runnable);
 
-  static constexpr int kMaxConcurrentAcceptLoops = 5;
+  // Each service accepts on a GATT socket and, with L2CAP, on an L2CAP one.
+  static constexpr int kMaxConcurrentAcceptLoops = 10;
 
-  SingleThreadExecutor serial_executor_;
+  SingleThreadExecutor serial_executor_{api::ExecutorQos::kUtility};
   ScheduledExecutor alarm_executor_;
 
   mutable Mutex mutex_;
@@ -209,6 +218,8 @@ class BleV2 final {
   std::unique_ptr<CancelableAlarm> lost_alarm_;
   mediums::DiscoveredPeripheralTracker discovered_peripheral_tracker_
       ABSL_GUARDED_BY(mutex_){medium_.IsExtendedAdvertisementsAvailable()};
+  // GATT clients kept connected between advertisement reads while scanning.
+  mediums::GattClientPool gatt_client_pool_ ABSL_GUARDED_BY(mutex_);
 
   // A thread pool dedicated to running all the accept loops from
   // StartAcceptingConnections().
@@ -219,6 +230,11 @@ class BleV2 final {
   absl::flat_hash_map<std::string, BleV2ServerSocket> server_sockets_
       ABSL_GUARDED_BY(mutex_);
 
+  // A map of service_id -> L2CAP ServerSocket, for the services that accept
+  // connections over L2CAP too. Its PSM goes into their advertisements.
+  absl::flat_hash_map<std::string, BleV2ServerSocket> l2cap_server_sockets_
+      ABSL_GUARDED_BY(mutex_);
+
   // Tracks currently connected incoming sockets. This lets the device know when
   // it's okay to restart GATT server related operations.
   absl::flat_hash_map<std::string, BleV2Socket> incoming_sockets_
@@ -0,0 +1,69 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "connections/implementation/mediums/ble_v2/advertisement_cache.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "connections/implementation/mediums/ble_v2/ble_advertisement_header.h"
+#include "internal/platform/byte_array.h"
+
+namespace nearby {
+namespace connections {
+namespace mediums {
+
+const std::vector<ByteArray>* AdvertisementCache::Get(
+    const BleAdvertisementHeader& advertisement_header) {
+  const auto it = index_.find(GetKey(advertisement_header));
+  if (it == index_.end()) {
+    return nullptr;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return &it->second->second;
+}
+
+void AdvertisementCache::Put(const BleAdvertisementHeader& advertisement_header,
+                             std::vector<ByteArray> advertisements) {
+  if (capacity_ == 0) {
+    return;
+  }
+
+  Key key = GetKey(advertisement_header);
+  const auto it = index_.find(key);
+  if (it != index_.end()) {
+    it->second->second = std::move(advertisements);
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return;
+  }
+
+  if (entries_.size() >= capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  entries_.emplace_front(key, std::move(advertisements));
+  index_.insert({std::move(key), entries_.begin()});
+}
+
+AdvertisementCache::Key AdvertisementCache::GetKey(
+    const BleAdvertisementHeader& advertisement_header) {
+  return {std::string(advertisement_header.GetAdvertisementHash()),
+          advertisement_header.GetNumSlots()};
+}
+
+}  // namespace mediums
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,77 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef CORE_INTERNAL_MEDIUMS_BLE_V2_ADVERTISEMENT_CACHE_H_
+#define CORE_INTERNAL_MEDIUMS_BLE_V2_ADVERTISEMENT_CACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "connections/implementation/mediums/ble_v2/ble_advertisement_header.h"
+#include "internal/platform/byte_array.h"
+
+namespace nearby {
+namespace connections {
+namespace mediums {
+
+// A least recently used cache of the raw advertisements read from a
+// peripheral's GATT server, keyed by the advertisement hash and slot count of
+// the advertisement header they were read for.
+//
+// The advertisement hash covers the content of every slot, so a header that
+// only differs in version or PSM maps to the same entry and the advertisements
+// don't have to be read again. Entries hold every slot, regardless of which
+// service IDs were tracked when they were read.
+//
+// This class is not thread-safe.
+class AdvertisementCache {
+ public:
+  // A cache with a `capacity` of 0 never holds any entries.
+  explicit AdvertisementCache(size_t capacity) : capacity_(capacity) {}
+
+  // Returns the advertisements cached for `advertisement_header` and marks
+  // them as most recently used, or returns nullptr if there are none. The
+  // pointer is invalidated by the next call to Put().
+  const std::vector<ByteArray>* Get(
+      const BleAdvertisementHeader& advertisement_header);
+
+  // Caches `advertisements` for `advertisement_header`, replacing any previous
+  // entry and evicting the least recently used one if the cache is full.
+  void Put(const BleAdvertisementHeader& advertisement_header,
+           std::vector<ByteArray> advertisements);
+
+  size_t Size() const { return entries_.size(); }
+
+ private:
+  using Key = std::pair<std::string, int>;
+  using Entry = std::pair<Key, std::vector<ByteArray>>;
+
+  static Key GetKey(const BleAdvertisementHeader& advertisement_header);
+
+  const size_t capacity_;
+  // Most recently used first.
+  std::list<Entry> entries_;
+  absl::flat_hash_map<Key, std::list<Entry>::iterator> index_;
+};
+
+}  // namespace mediums
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_MEDIUMS_BLE_V2_ADVERTISEMENT_CACHE_H_
@@ -0,0 +1,127 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "connections/implementation/mediums/ble_v2/advertisement_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/string_view.h"
+#include "connections/implementation/mediums/ble_v2/ble_advertisement_header.h"
+#include "internal/platform/byte_array.h"
+
+namespace nearby {
+namespace connections {
+namespace mediums {
+namespace {
+
+constexpr absl::string_view kAdvertisementHash = "\x0a\x0b\x0c\x0d";
+constexpr absl::string_view kAdvertisementHash2 = "\x0d\x0c\x0b\x0a";
+constexpr absl::string_view kAdvertisementHash3 = "\x01\x02\x03\x04";
+constexpr absl::string_view kServiceIdBloomFilter =
+    "\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a";
+constexpr absl::string_view kAdvertisement = "advertisement";
+constexpr absl::string_view kAdvertisement2 = "advertisement2";
+
+BleAdvertisementHeader CreateHeader(absl::string_view advertisement_hash,
+                                    int num_slots = 1, int psm = 0) {
+  return BleAdvertisementHeader(
+      BleAdvertisementHeader::Version::kV2,
+      /*support_extended_advertisement=*/false, num_slots,
+      ByteArray(std::string(kServiceIdBloomFilter)),
+      ByteArray(std::string(advertisement_hash)), psm);
+}
+
+std::vector<ByteArray> CreateAdvertisements(absl::string_view advertisement) {
+  return {ByteArray(std::string(advertisement))};
+}
+
+TEST(AdvertisementCacheTest, GetReturnsNullWhenEmpty) {
+  AdvertisementCache cache(/*capacity=*/2);
+
+  EXPECT_EQ(cache.Get(CreateHeader(kAdvertisementHash)), nullptr);
+}
+
+TEST(AdvertisementCacheTest, GetReturnsPutAdvertisements) {
+  AdvertisementCache cache(/*capacity=*/2);
+
+  cache.Put(CreateHeader(kAdvertisementHash),
+            CreateAdvertisements(kAdvertisement));
+
+  const std::vector<ByteArray>* advertisements =
+      cache.Get(CreateHeader(kAdvertisementHash));
+  ASSERT_NE(advertisements, nullptr);
+  EXPECT_EQ(*advertisements, CreateAdvertisements(kAdvertisement));
+}
+
+TEST(AdvertisementCacheTest, GetIgnoresPsm) {
+  AdvertisementCache cache(/*capacity=*/2);
+
+  cache.Put(CreateHeader(kAdvertisementHash, /*num_slots=*/1, /*psm=*/0),
+            CreateAdvertisements(kAdvertisement));
+
+  EXPECT_NE(
+      cache.Get(CreateHeader(kAdvertisementHash, /*num_slots=*/1, /*psm=*/5)),
+      nullptr);
+  EXPECT_EQ(cache.Get(CreateHeader(kAdvertisementHash, /*num_slots=*/2)),
+            nullptr);
+}
+
+TEST(AdvertisementCacheTest, PutReplacesExistingEntry) {
+  AdvertisementCache cache(/*capacity=*/2);
+
+  cache.Put(CreateHeader(kAdvertisementHash),
+            CreateAdvertisements(kAdvertisement));
+  cache.Put(CreateHeader(kAdvertisementHash),
+            CreateAdvertisements(kAdvertisement2));
+
+  EXPECT_EQ(cache.Size(), 1);
+  EXPECT_EQ(*cache.Get(CreateHeader(kAdvertisementHash)),
+            CreateAdvertisements(kAdvertisement2));
+}
+
+TEST(AdvertisementCacheTest, PutEvictsLeastRecentlyUsed) {
+  AdvertisementCache cache(/*capacity=*/2);
+
+  cache.Put(CreateHeader(kAdvertisementHash),
+            CreateAdvertisements(kAdvertisement));
+  cache.Put(CreateHeader(kAdvertisementHash2),
+            CreateAdvertisements(kAdvertisement));
+  // Make the first entry the most recently used one.
+  cache.Get(CreateHeader(kAdvertisementHash));
+  cache.Put(CreateHeader(kAdvertisementHash3),
+            CreateAdvertisements(kAdvertisement));
+
+  EXPECT_EQ(cache.Size(), 2);
+  EXPECT_NE(cache.Get(CreateHeader(kAdvertisementHash)), nullptr);
+  EXPECT_EQ(cache.Get(CreateHeader(kAdvertisementHash2)), nullptr);
+  EXPECT_NE(cache.Get(CreateHeader(kAdvertisementHash3)), nullptr);
+}
+
+TEST(AdvertisementCacheTest, ZeroCapacityNeverCaches) {
+  AdvertisementCache cache(/*capacity=*/0);
+
+  cache.Put(CreateHeader(kAdvertisementHash),
+            CreateAdvertisements(kAdvertisement));
+
+  EXPECT_EQ(cache.Size(), 0);
+  EXPECT_EQ(cache.Get(CreateHeader(kAdvertisementHash)), nullptr);
+}
+
+}  // namespace
+}  // namespace mediums
+}  // namespace connections
+}  // namespace nearby
@@ -43,16 +43,19 @@ BleAdvertisement::BleAdvertisement(Version version,
                                    SocketVersion socket_version,
                                    const ByteArray &service_id_hash,
                                    const ByteArray &data,
-                                   const ByteArray &device_token, int psm) {
+                                   const ByteArray &device_token, int psm,
+                                   bool extended_advertisement) {
   DoInitialize(/*fast_advertisement=*/service_id_hash.Empty(), version,
-               socket_version, service_id_hash, data, device_token, psm);
+               socket_version, service_id_hash, data, device_token, psm,
+               extended_advertisement);
 }
 
 void BleAdvertisement::DoInitialize(bool fast_advertisement, Version version,
                                     SocketVersion socket_version,
                                     const ByteArray &service_id_hash,
                                     const ByteArray &data,
-                                    const ByteArray &device_token, int psm) {
+                                    const ByteArray &device_token, int psm,
+                                    bool extended_advertisement) {
   // Check that the given input is valid.
   fast_advertisement_ = fast_advertisement;
   if (!fast_advertisement_) {
@@ -66,9 +69,12 @@ void BleAdvertisement::DoInitialize(bool fast_advertisement, Version version,
 
   int advertisement_Length = ComputeAdvertisementLength(
       data.size(), device_token.size(), fast_advertisement_);
-  int max_advertisement_length = fast_advertisement
-                                     ? kMaxFastAdvertisementLength
-                                     : kMaxAdvertisementLength;
+  int max_advertisement_length = kMaxAdvertisementLength;
+  if (fast_advertisement) {
+    max_advertisement_length = kMaxFastAdvertisementLength;
+  } else if (extended_advertisement) {
+    max_advertisement_length = kMaxExtendedAdvertisementLength;
+  }
   if (advertisement_Length > max_advertisement_length) {
     return;
   }
@@ -58,6 +58,11 @@ class BleAdvertisement {
 
   static constexpr int kServiceIdHashLength = 3;
   static constexpr int kDeviceTokenLength = 2;
+  // The maximum length for extended advertising data is 1650 bytes. Leave room
+  // for the flags (3 bytes) and the service data header (4 bytes) that come
+  // before the advertisement, and for the extra fields (3 bytes) that
+  // ByteArrayWithExtraField() appends.
+  static constexpr int kMaxExtendedAdvertisementLength = 1640;
 
   // Hashable
   bool operator==(const BleAdvertisement &rhs) const;
@@ -69,10 +74,14 @@ class BleAdvertisement {
   }
 
   BleAdvertisement() = default;
+  // If `extended_advertisement` is true, a regular advertisement may be up to
+  // kMaxExtendedAdvertisementLength long instead of what fits in a GATT
+  // characteristic. It can then only be delivered by extended advertising.
   BleAdvertisement(Version version, SocketVersion socket_version,
                    const ByteArray &service_id_hash, const ByteArray &data,
                    const ByteArray &device_token,
-                   int psm = BleAdvertisementHeader::kDefaultPsmValue);
+                   int psm = BleAdvertisementHeader::kDefaultPsmValue,
+                   bool extended_advertisement = false);
   explicit BleAdvertisement(const ByteArray &ble_advertisement_bytes);
   BleAdvertisement(const BleAdvertisement &) = default;
   BleAdvertisement &operator=(const BleAdvertisement &) = default;
@@ -127,7 +136,8 @@ class BleAdvertisement {
   void DoInitialize(bool fast_advertisement, Version version,
                     SocketVersion socket_version,
                     const ByteArray &service_id_hash, const ByteArray &data,
-                    const ByteArray &device_token, int psm);
+                    const ByteArray &device_token, int psm,
+                    bool extended_advertisement);
   bool IsSupportedVersion(Version version) const;
   bool IsSupportedSocketVersion(SocketVersion socket_version) const;
   void SerializeDataSize(bool fast_advertisement,
@@ -156,6 +156,50 @@ TEST(BleAdvertisementTest, ConstructionFailsWithLongData) {
   EXPECT_FALSE(fast_ble_advertisement.IsValid());
 }
 
+TEST(BleAdvertisementTest, ExtendedConstructionWorksWithLongData) {
+  // Data that doesn't fit in a GATT attribute fits in an extended
+  // advertisement, and survives a round trip with the extra fields.
+  ByteArray service_id_hash{std::string(kServiceIDHashBytes)};
+  ByteArray long_data{std::string(1000, 'a')};
+  ByteArray device_token{std::string(kDeviceToken)};
+
+  BleAdvertisement ble_advertisement{
+      kVersion,     kSocketVersion, service_id_hash,
+      long_data,    device_token,   BleAdvertisementHeader::kDefaultPsmValue,
+      /*extended_advertisement=*/true};
+  ASSERT_TRUE(ble_advertisement.IsValid());
+
+  BleAdvertisement parsed_ble_advertisement{
+      ble_advertisement.ByteArrayWithExtraField()};
+  EXPECT_TRUE(parsed_ble_advertisement.IsValid());
+  EXPECT_EQ(long_data, parsed_ble_advertisement.GetData());
+  EXPECT_EQ(ble_advertisement, parsed_ble_advertisement);
+}
+
+TEST(BleAdvertisementTest, ExtendedConstructionFailsWithTooLongData) {
+  ByteArray service_id_hash{std::string(kServiceIDHashBytes)};
+  ByteArray bad_data{std::string(
+      BleAdvertisement::kMaxExtendedAdvertisementLength, 'a')};
+  ByteArray device_token{std::string(kDeviceToken)};
+
+  BleAdvertisement ble_advertisement{
+      kVersion,  kSocketVersion, service_id_hash,
+      bad_data,  device_token,   BleAdvertisementHeader::kDefaultPsmValue,
+      /*extended_advertisement=*/true};
+  EXPECT_FALSE(ble_advertisement.IsValid());
+
+  // Fast advertisements are never extended.
+  BleAdvertisement fast_ble_advertisement{
+      kVersion,
+      kSocketVersion,
+      ByteArray{},
+      ByteArray{std::string(kData)},
+      device_token,
+      BleAdvertisementHeader::kDefaultPsmValue,
+      /*extended_advertisement=*/true};
+  EXPECT_FALSE(fast_ble_advertisement.IsValid());
+}
+
 TEST(BleAdvertisementTest, ConstructionWorksWithEmptyDeviceToken) {
   ByteArray service_id_hash{std::string(kServiceIDHashBytes)};
   ByteArray data{std::string(kData)};
@@ -14,12 +14,11 @@
 
 #include "connections/implementation/mediums/ble_v2/ble_packet.h"
 
+#include <cstring>
 #include <limits>
-#include <string>
-#include <utility>
 
 #include "absl/strings/str_cat.h"
-#include "internal/platform/base_input_stream.h"
+#include "absl/strings/string_view.h"
 #include "internal/platform/logging.h"
 #include "proto/mediums/ble_frames.pb.h"
 
@@ -35,6 +34,24 @@ constexpr char kControlPacketServiceIdHash[] = "\x00\x00\x00";
 constexpr std::uint32_t kMaxDataSize =
     std::numeric_limits<int32_t>::max() - BlePacket::kServiceIdHashLength;
 
+constexpr absl::string_view GetControlPacketServiceIdHash() {
+  return absl::string_view(kControlPacketServiceIdHash,
+                           BlePacket::kServiceIdHashLength);
+}
+
+// Writes the service ID hash prefix and the data into one buffer.
+ByteArray SerializePacket(absl::string_view service_id_hash,
+                          absl::string_view data) {
+  ByteArray packet_bytes(service_id_hash.size() + data.size());
+  std::memcpy(packet_bytes.data(), service_id_hash.data(),
+              service_id_hash.size());
+  if (!data.empty()) {
+    std::memcpy(packet_bytes.data() + service_id_hash.size(), data.data(),
+                data.size());
+  }
+  return packet_bytes;
+}
+
 absl::StatusOr<BlePacket> BlePacket::CreateControlIntroductionPacket(
     const ByteArray& service_id_hash) {
   if (service_id_hash.size() != kServiceIdHashLength) {
@@ -120,34 +137,32 @@ absl::StatusOr<BlePacket> BlePacket::CreateDataPacket(
   return ble_packet;
 }
 
-BlePacket::BlePacket(const ByteArray& ble_packet_bytes) {
-  if (ble_packet_bytes.Empty()) {
-    NEARBY_LOG(ERROR, "Cannot deserialize BlePacket: null bytes passed in");
-    return;
+absl::StatusOr<ByteArray> BlePacket::SerializeDataPacket(
+    const ByteArray& service_id_hash, absl::string_view data) {
+  if (data.size() > kMaxDataSize) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Packet size: ", data.size(), " > ", kMaxDataSize));
   }
-
-  if (ble_packet_bytes.size() < kServiceIdHashLength) {
-    NEARBY_LOG(
-        INFO,
-        "Cannot deserialize BlePacket: expecting min %u raw bytes, got %zu",
-        kServiceIdHashLength, ble_packet_bytes.size());
-    return;
+  if (service_id_hash.size() != kServiceIdHashLength ||
+      service_id_hash.AsStringView() == GetControlPacketServiceIdHash()) {
+    return absl::InvalidArgumentError("service_id_hash is incorrect.");
   }
 
-  ByteArray packet_bytes(ble_packet_bytes);
-  BaseInputStream base_input_stream{packet_bytes};
-  // The first 3 bytes are supposed to be the service_id_hash.
-  service_id_hash_ = base_input_stream.ReadBytes(kServiceIdHashLength);
-  if (service_id_hash_ ==
-      ByteArray(kControlPacketServiceIdHash, kServiceIdHashLength)) {
-    packet_type_ = BlePacketType::kControl;
-  } else {
-    packet_type_ = BlePacketType::kData;
+  return SerializePacket(service_id_hash.AsStringView(), data);
+}
+
+BlePacket::BlePacket(const ByteArray& ble_packet_bytes) {
+  BlePacketView ble_packet_view(ble_packet_bytes.AsStringView());
+  if (!ble_packet_view.IsValid()) {
+    return;
   }
 
-  // The rest bytes are supposed to be the data.
-  data_ = base_input_stream.ReadBytes(ble_packet_bytes.size() -
-                                      kServiceIdHashLength);
+  packet_type_ = ble_packet_view.IsControlPacket() ? BlePacketType::kControl
+                                                   : BlePacketType::kData;
+  service_id_hash_ = ByteArray(ble_packet_view.GetServiceIdHash().data(),
+                               kServiceIdHashLength);
+  data_ = ByteArray(ble_packet_view.GetData().data(),
+                    ble_packet_view.GetData().size());
 }
 
 BlePacket::operator ByteArray() const {
@@ -155,10 +170,8 @@ BlePacket::operator ByteArray() const {
     return ByteArray();
   }
 
-  std::string out =
-      absl::StrCat(std::string(service_id_hash_), std::string(data_));
-
-  return ByteArray(std::move(out));
+  return SerializePacket(service_id_hash_.AsStringView(),
+                         data_.AsStringView());
 }
 
 bool BlePacket::IsValid() const {
@@ -169,6 +182,35 @@ bool BlePacket::IsControlPacket() const {
   return packet_type_ == BlePacketType::kControl;
 }
 
+BlePacketView::BlePacketView(absl::string_view ble_packet_bytes) {
+  if (ble_packet_bytes.empty()) {
+    NEARBY_LOG(ERROR, "Cannot deserialize BlePacket: null bytes passed in");
+    return;
+  }
+
+  if (ble_packet_bytes.size() < BlePacket::kServiceIdHashLength) {
+    NEARBY_LOG(
+        INFO,
+        "Cannot deserialize BlePacket: expecting min %u raw bytes, got %zu",
+        BlePacket::kServiceIdHashLength, ble_packet_bytes.size());
+    return;
+  }
+
+  // The first 3 bytes are supposed to be the service_id_hash, and the rest
+  // the data.
+  service_id_hash_ =
+      ble_packet_bytes.substr(0, BlePacket::kServiceIdHashLength);
+  data_ = ble_packet_bytes.substr(BlePacket::kServiceIdHashLength);
+}
+
+bool BlePacketView::IsControlPacket() const {
+  return IsValid() && service_id_hash_ == GetControlPacketServiceIdHash();
+}
+
+bool BlePacketView::HasServiceIdHash(const ByteArray& service_id_hash) const {
+  return IsValid() && service_id_hash_ == service_id_hash.AsStringView();
+}
+
 }  // namespace mediums
 }  // namespace connections
 }  // namespace nearby
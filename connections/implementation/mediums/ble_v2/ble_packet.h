@@ -16,6 +16,7 @@
 #define CORE_INTERNAL_MEDIUMS_BLE_V2_BLE_PACKET_H_
 
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
 #include "internal/platform/byte_array.h"
 
 namespace nearby {
@@ -72,6 +73,11 @@ class BlePacket {
   static absl::StatusOr<BlePacket> CreateDataPacket(
       const ByteArray& service_id_hash, const ByteArray& data);
 
+  // Same as CreateDataPacket(), but writes the serialized packet straight into
+  // the returned buffer instead of copying `data` into a BlePacket first.
+  static absl::StatusOr<ByteArray> SerializeDataPacket(
+      const ByteArray& service_id_hash, absl::string_view data);
+
   explicit BlePacket(const ByteArray& ble_packet_byte);
   BlePacket(const BlePacket&) = default;
   BlePacket& operator=(const BlePacket&) = default;
@@ -82,8 +88,8 @@ class BlePacket {
   explicit operator ByteArray() const;
 
   bool IsValid() const;
-  ByteArray GetServiceIdHash() const { return service_id_hash_; }
-  ByteArray GetData() const { return data_; }
+  const ByteArray& GetServiceIdHash() const { return service_id_hash_; }
+  const ByteArray& GetData() const { return data_; }
   int GetPacketSize() const { return data_.size() + kServiceIdHashLength; }
   bool IsControlPacket() const;
 
@@ -101,6 +107,25 @@ class BlePacket {
   ByteArray data_;
 };
 
+// A read-only view of a BlePacket in a received buffer, for demultiplexing
+// packets by service ID hash without copying them. The buffer must outlive
+// the view.
+class BlePacketView {
+ public:
+  explicit BlePacketView(absl::string_view ble_packet_bytes);
+
+  bool IsValid() const { return !service_id_hash_.empty(); }
+  bool IsControlPacket() const;
+  // Compares `service_id_hash` with the one in the buffer, in place.
+  bool HasServiceIdHash(const ByteArray& service_id_hash) const;
+  absl::string_view GetServiceIdHash() const { return service_id_hash_; }
+  absl::string_view GetData() const { return data_; }
+
+ private:
+  absl::string_view service_id_hash_;
+  absl::string_view data_;
+};
+
 }  // namespace mediums
 }  // namespace connections
 }  // namespace nearby
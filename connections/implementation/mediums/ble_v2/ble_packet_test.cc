@@ -219,6 +219,67 @@ TEST(BlePacketTest,
   EXPECT_FALSE(new_ble_packet.IsControlPacket());
 }
 
+TEST(BlePacketTest, SerializingDataPacketMatchesCreatedDataPacket) {
+  ByteArray service_id_hash((std::string(kServiceIDHash)));
+  ByteArray data((std::string(kData)));
+
+  absl::StatusOr<BlePacket> ble_packet_status_or =
+      BlePacket::CreateDataPacket(service_id_hash, data);
+  absl::StatusOr<ByteArray> ble_packet_bytes_status_or =
+      BlePacket::SerializeDataPacket(service_id_hash, kData);
+
+  ASSERT_OK(ble_packet_status_or);
+  ASSERT_OK(ble_packet_bytes_status_or);
+  EXPECT_EQ(ByteArray(ble_packet_status_or.value()),
+            ble_packet_bytes_status_or.value());
+}
+
+TEST(BlePacketTest, SerializingDataPacketFailsWithControlServiceIdHash) {
+  ByteArray service_id_hash(std::string("\x00\x00\x00", 3));
+
+  EXPECT_FALSE(BlePacket::SerializeDataPacket(service_id_hash, kData).ok());
+}
+
+TEST(BlePacketViewTest, ViewsSerializedDataPacket) {
+  ByteArray service_id_hash((std::string(kServiceIDHash)));
+  absl::StatusOr<ByteArray> ble_packet_bytes_status_or =
+      BlePacket::SerializeDataPacket(service_id_hash, kData);
+  ASSERT_OK(ble_packet_bytes_status_or);
+
+  BlePacketView ble_packet_view(
+      ble_packet_bytes_status_or.value().AsStringView());
+
+  EXPECT_TRUE(ble_packet_view.IsValid());
+  EXPECT_FALSE(ble_packet_view.IsControlPacket());
+  EXPECT_TRUE(ble_packet_view.HasServiceIdHash(service_id_hash));
+  EXPECT_FALSE(ble_packet_view.HasServiceIdHash(
+      ByteArray(std::string("\x03\x02\x01"))));
+  EXPECT_EQ(ble_packet_view.GetServiceIdHash(), kServiceIDHash);
+  EXPECT_EQ(ble_packet_view.GetData(), kData);
+}
+
+TEST(BlePacketViewTest, ViewsControlPacket) {
+  absl::StatusOr<BlePacket> ble_packet_status_or =
+      BlePacket::CreateControlPacket(ByteArray(std::string(kData)));
+  ASSERT_OK(ble_packet_status_or);
+  ByteArray ble_packet_bytes(ble_packet_status_or.value());
+
+  BlePacketView ble_packet_view(ble_packet_bytes.AsStringView());
+
+  EXPECT_TRUE(ble_packet_view.IsValid());
+  EXPECT_TRUE(ble_packet_view.IsControlPacket());
+  EXPECT_EQ(ble_packet_view.GetData(), kData);
+}
+
+TEST(BlePacketViewTest, ViewOfShortBytesIsInvalid) {
+  BlePacketView ble_packet_view(kServiceIDHash.substr(0, 2));
+
+  EXPECT_FALSE(ble_packet_view.IsValid());
+  EXPECT_FALSE(ble_packet_view.IsControlPacket());
+  EXPECT_FALSE(
+      ble_packet_view.HasServiceIdHash(ByteArray(std::string(kServiceIDHash))));
+}
+
 }  // namespace
 }  // namespace mediums
 }  // namespace connections
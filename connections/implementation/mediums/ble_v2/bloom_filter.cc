@@ -15,7 +15,7 @@
 #include "connections/implementation/mediums/ble_v2/bloom_filter.h"
 
 #include "absl/numeric/int128.h"
-#include "absl/strings/numbers.h"
+#include "absl/strings/string_view.h"
 #include "internal/platform/logging.h"
 #include "src/MurmurHash3.h"
 
@@ -23,10 +23,6 @@ namespace nearby {
 namespace connections {
 namespace mediums {
 
-namespace {
-constexpr int kHasherNumberOfRepetitions = 5;
-}
-
 BloomFilter::BloomFilter(std::unique_ptr<BitSet> bit_set,
                          const ByteArray& bytes)
     : bit_set_(std::move(bit_set)) {
@@ -53,34 +49,30 @@ BloomFilter::BloomFilter(std::unique_ptr<BitSet> bit_set,
 }
 
 BloomFilter::operator ByteArray() const {
-  std::string bitset_binary_string = bit_set_->ToString();
-
   ByteArray result_bytes(GetMinBytesForBits());
   char* result_bytes_write_ptr = result_bytes.data();
-  // We go through the string backwards because the rightmost character
-  // corresponds to position 0 in the bitset.
-  for (size_t i = bit_set_->Size(); i > 0; i -= 8) {
-    std::string byte_binary_string = bitset_binary_string.substr(i - 8, 8);
-    std::uint32_t byte_value;
-    absl::numbers_internal::safe_strtou32_base(byte_binary_string, &byte_value,
-                                               /* base= */ 2);
-    *result_bytes_write_ptr = static_cast<char>(byte_value & 0x000000FF);
+  for (size_t byte_index = 0; byte_index < result_bytes.size(); byte_index++) {
+    std::uint8_t byte_value = 0;
+    for (size_t bit_index = 0; bit_index < 8; bit_index++) {
+      if (bit_set_->Test((byte_index * 8) + bit_index)) {
+        byte_value |= 1 << bit_index;
+      }
+    }
+    *result_bytes_write_ptr = static_cast<char>(byte_value);
     result_bytes_write_ptr++;
   }
   return result_bytes;
 }
 
 void BloomFilter::Add(const std::string& s) {
-  std::vector<std::int32_t> hashes = GetHashes(s);
-  for (int32_t hash : hashes) {
+  for (int32_t hash : GetBloomFilterHashes(s)) {
     size_t position = static_cast<size_t>(hash) % bit_set_->Size();
     bit_set_->Set(position, true);
   }
 }
 
 bool BloomFilter::PossiblyContains(const std::string& s) {
-  std::vector<std::int32_t> hashes = GetHashes(s);
-  for (int32_t hash : hashes) {
+  for (int32_t hash : GetBloomFilterHashes(s)) {
     size_t position = static_cast<size_t>(hash) % bit_set_->Size();
     if (!bit_set_->Test(position)) {
       return false;
@@ -89,8 +81,9 @@ bool BloomFilter::PossiblyContains(const std::string& s) {
   return true;
 }
 
-std::vector<std::int32_t> BloomFilter::GetHashes(const std::string& s) {
-  std::vector<std::int32_t> hashes(kHasherNumberOfRepetitions, 0);
+std::array<std::int32_t, kBloomFilterHashCount> GetBloomFilterHashes(
+    absl::string_view s) {
+  std::array<std::int32_t, kBloomFilterHashCount> hashes;
 
   absl::uint128 hash128;
   MurmurHash3_x64_128(s.data(), s.size(), 0, &hash128);
@@ -100,7 +93,7 @@ std::vector<std::int32_t> BloomFilter::GetHashes(const std::string& s) {
       hash64 & 0x00000000FFFFFFFF);  // the lower 32 bits of the 64-bit hash
   std::int32_t hash2 = static_cast<std::int32_t>(
       (hash64 >> 32) & 0x0FFFFFFFF);  // the upper 32 bits of the 64-bit hash
-  for (size_t i = 1; i <= kHasherNumberOfRepetitions; i++) {
+  for (size_t i = 1; i <= kBloomFilterHashCount; i++) {
     std::int32_t combinedHash = static_cast<std::int32_t>(hash1 + (i * hash2));
     // Flip all the bits if it's negative (guaranteed positive number)
     if (combinedHash < 0) combinedHash = ~combinedHash;
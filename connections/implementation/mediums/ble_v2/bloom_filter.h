@@ -15,15 +15,29 @@
 #ifndef CORE_INTERNAL_MEDIUMS_BLE_V2_BLOOM_FILTER_H_
 #define CORE_INTERNAL_MEDIUMS_BLE_V2_BLOOM_FILTER_H_
 
+#include <array>
 #include <bitset>
-#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
 
+#include "absl/strings/string_view.h"
 #include "internal/platform/byte_array.h"
 
 namespace nearby {
 namespace connections {
 namespace mediums {
 
+// The number of bit positions an element maps to in a bloom filter.
+inline constexpr size_t kBloomFilterHashCount = 5;
+
+// Computes the bit positions, before reduction modulo the filter size, that
+// `s` maps to. Shared by BloomFilter and FixedBloomFilter so that both produce
+// identical bits for the same element.
+std::array<std::int32_t, kBloomFilterHashCount> GetBloomFilterHashes(
+    absl::string_view s);
+
 // Interface to set bits of the given bit array, by inserting a user element.
 class BitSet {
  public:
@@ -69,7 +83,6 @@ class BloomFilter {
   bool PossiblyContains(const std::string& s);
 
  private:
-  std::vector<std::int32_t> GetHashes(const std::string& s);
   int GetMinBytesForBits() const { return (bit_set_->Size() + 7) >> 3; }
 
   std::unique_ptr<BitSet> bit_set_;
@@ -92,6 +105,84 @@ class BitSetImpl final : public BitSet {
   std::bitset<CapacityInBytes * 8> bits_;
 };
 
+// A bloom filter over a fixed array of CapacityInBytes bytes.
+//
+// Unlike BloomFilter, there is no virtual dispatch or heap allocation: the
+// bits live inline in 64-bit words and hashes are computed on the stack. The
+// serialized bytes are identical to those of a BloomFilter backed by
+// BitSetImpl<CapacityInBytes>, so the two can be used interchangeably on the
+// wire.
+template <size_t CapacityInBytes>
+class FixedBloomFilter final {
+ public:
+  static constexpr size_t kSizeInBits = CapacityInBytes * 8;
+
+  // Constructs an empty bloom filter.
+  constexpr FixedBloomFilter() = default;
+
+  // Constructs from the bytes of another bloom filter.
+  //
+  // Note: `bytes` must be exactly CapacityInBytes long, or they are ignored
+  // and the filter is left empty.
+  explicit FixedBloomFilter(absl::string_view bytes) {
+    if (bytes.size() != CapacityInBytes) return;
+    for (size_t i = 0; i < CapacityInBytes; ++i) {
+      words_[i / 8] |= static_cast<std::uint64_t>(
+                           static_cast<std::uint8_t>(bytes[i]))
+                       << ((i % 8) * 8);
+    }
+  }
+  explicit FixedBloomFilter(const ByteArray& bytes)
+      : FixedBloomFilter(bytes.AsStringView()) {}
+
+  explicit operator ByteArray() const {
+    ByteArray result(CapacityInBytes);
+    char* out = result.data();
+    for (size_t i = 0; i < CapacityInBytes; ++i) {
+      out[i] = static_cast<char>((words_[i / 8] >> ((i % 8) * 8)) & 0xFF);
+    }
+    return result;
+  }
+
+  void Add(absl::string_view s) {
+    for (std::int32_t hash : GetBloomFilterHashes(s)) {
+      size_t position = static_cast<size_t>(hash) % kSizeInBits;
+      words_[position / 64] |= std::uint64_t{1} << (position % 64);
+    }
+  }
+
+  bool PossiblyContains(absl::string_view s) const {
+    for (std::int32_t hash : GetBloomFilterHashes(s)) {
+      size_t position = static_cast<size_t>(hash) % kSizeInBits;
+      if ((words_[position / 64] & (std::uint64_t{1} << (position % 64))) ==
+          0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Returns true if no element has been added.
+  bool IsEmpty() const {
+    for (std::uint64_t word : words_) {
+      if (word != 0) return false;
+    }
+    return true;
+  }
+
+  friend bool operator==(const FixedBloomFilter& lhs,
+                         const FixedBloomFilter& rhs) {
+    return lhs.words_ == rhs.words_;
+  }
+  friend bool operator!=(const FixedBloomFilter& lhs,
+                         const FixedBloomFilter& rhs) {
+    return !(lhs == rhs);
+  }
+
+ private:
+  std::array<std::uint64_t, (CapacityInBytes + 7) / 8> words_{};
+};
+
 }  // namespace mediums
 }  // namespace connections
 }  // namespace nearby
@@ -15,6 +15,8 @@
 #include "connections/implementation/mediums/ble_v2/bloom_filter.h"
 
 #include <algorithm>
+#include <memory>
+#include <string>
 
 #include "gtest/gtest.h"
 
@@ -212,6 +214,70 @@ TEST(BloomFilterTest, ConstructLongByteArrayFails) {
   EXPECT_FALSE(bloom_filter_inherited.PossiblyContains("ELEMENT_1"));
 }
 
+TEST(FixedBloomFilterTest, EmptyFilterReturnsEmptyArray) {
+  FixedBloomFilter<kByteArrayLength> bloom_filter;
+
+  ByteArray bloom_filter_bytes(bloom_filter);
+  std::string empty_string(kByteArrayLength, '\0');
+
+  EXPECT_EQ(empty_string, std::string(bloom_filter_bytes));
+  EXPECT_TRUE(bloom_filter.IsEmpty());
+  EXPECT_FALSE(bloom_filter.PossiblyContains("ELEMENT_1"));
+}
+
+TEST(FixedBloomFilterTest, AddMultipleArgs) {
+  FixedBloomFilter<kByteArrayLength> bloom_filter;
+
+  bloom_filter.Add("ELEMENT_1");
+  bloom_filter.Add("ELEMENT_2");
+
+  EXPECT_FALSE(bloom_filter.IsEmpty());
+  EXPECT_TRUE(bloom_filter.PossiblyContains("ELEMENT_1"));
+  EXPECT_TRUE(bloom_filter.PossiblyContains("ELEMENT_2"));
+  EXPECT_FALSE(bloom_filter.PossiblyContains("ELEMENT_3"));
+}
+
+TEST(FixedBloomFilterTest, BytesMatchBloomFilter) {
+  // Use a capacity that is not a multiple of the word size to cover the
+  // partially used trailing word.
+  BloomFilter bloom_filter(std::make_unique<BitSetImpl<10>>());
+  FixedBloomFilter<10> fixed_bloom_filter;
+
+  for (int i = 0; i < 5; i++) {
+    bloom_filter.Add("ELEMENT_" + std::to_string(i));
+    fixed_bloom_filter.Add("ELEMENT_" + std::to_string(i));
+  }
+
+  EXPECT_EQ(ByteArray(bloom_filter), ByteArray(fixed_bloom_filter));
+}
+
+TEST(FixedBloomFilterTest, ConstructWithBloomFilterBytesWorks) {
+  BloomFilter bloom_filter(std::make_unique<BitSetImpl<10>>());
+  bloom_filter.Add("ELEMENT_1");
+
+  FixedBloomFilter<10> fixed_bloom_filter{ByteArray(bloom_filter)};
+
+  EXPECT_TRUE(fixed_bloom_filter.PossiblyContains("ELEMENT_1"));
+  EXPECT_EQ(ByteArray(bloom_filter), ByteArray(fixed_bloom_filter));
+
+  BloomFilter bloom_filter_inherited(std::make_unique<BitSetImpl<10>>(),
+                                     ByteArray(fixed_bloom_filter));
+  EXPECT_TRUE(bloom_filter_inherited.PossiblyContains("ELEMENT_1"));
+}
+
+TEST(FixedBloomFilterTest, ConstructMismatchedByteArrayFails) {
+  FixedBloomFilter<kByteArrayLength + 1> long_bloom_filter;
+  long_bloom_filter.Add("ELEMENT_1");
+  FixedBloomFilter<kByteArrayLength - 1> short_bloom_filter;
+  short_bloom_filter.Add("ELEMENT_1");
+
+  FixedBloomFilter<kByteArrayLength> from_long{ByteArray(long_bloom_filter)};
+  FixedBloomFilter<kByteArrayLength> from_short{ByteArray(short_bloom_filter)};
+
+  EXPECT_TRUE(from_long.IsEmpty());
+  EXPECT_TRUE(from_short.IsEmpty());
+}
+
 }  // namespace
 }  // namespace mediums
 }  // namespace connections
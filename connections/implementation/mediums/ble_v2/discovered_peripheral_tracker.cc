@@ -15,6 +15,7 @@
 #include "connections/implementation/mediums/ble_v2/discovered_peripheral_tracker.h"
 
 #include <algorithm>
+#include <array>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -22,6 +23,8 @@
 #include <vector>
 
 #include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
 #include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/implementation/mediums/ble_v2/advertisement_read_result.h"
 #include "connections/implementation/mediums/ble_v2/ble_advertisement.h"
@@ -33,6 +36,7 @@
 #include "internal/platform/logging.h"
 #include "internal/platform/multi_thread_executor.h"
 #include "internal/platform/mutex_lock.h"
+#include "internal/platform/system_clock.h"
 
 namespace nearby {
 namespace connections {
@@ -44,7 +48,11 @@ constexpr int kGattThreadCount = 1;
 DiscoveredPeripheralTracker::DiscoveredPeripheralTracker(
     bool is_extended_advertisement_available)
     : is_extended_advertisement_available_(
-          is_extended_advertisement_available) {
+          is_extended_advertisement_available),
+      advertisement_cache_(std::max<int64_t>(
+          0, NearbyFlags::GetInstance().GetInt64Flag(
+                 config_package_nearby::nearby_connections_feature::
+                     kBleAdvertisementCacheSize))) {
   if (NearbyFlags::GetInstance().GetBoolFlag(
           config_package_nearby::nearby_connections_feature::
               kEnableGattQueryInThread)) {
@@ -66,14 +74,15 @@ DiscoveredPeripheralTracker::~DiscoveredPeripheralTracker() {
 void DiscoveredPeripheralTracker::StartTracking(
     const std::string& service_id,
     const DiscoveredPeripheralCallback& discovered_peripheral_callback,
-    const Uuid& fast_advertisement_service_uuid) {
+    const Uuid& fast_advertisement_service_uuid, int lost_after_rounds) {
   MutexLock lock(&mutex_);
 
   ServiceIdInfo service_id_info = {
       .discovered_peripheral_callback =
           std::move(discovered_peripheral_callback),
       .lost_entity_tracker =
-          std::make_unique<LostEntityTracker<BleAdvertisement>>(),
+          std::make_unique<LostEntityTracker<BleAdvertisement>>(
+              lost_after_rounds),
       .fast_advertisement_service_uuid = fast_advertisement_service_uuid};
 
   // Replace if key exists.
@@ -87,12 +96,14 @@ void DiscoveredPeripheralTracker::StartTracking(
 
   // Remove stale data from any previous sessions.
   ClearDataForServiceId(service_id);
+  UpdateScreeningState();
 }
 
 void DiscoveredPeripheralTracker::StopTracking(const std::string& service_id) {
   MutexLock lock(&mutex_);
 
   service_id_infos_.erase(service_id);
+  UpdateScreeningState();
 }
 
 void DiscoveredPeripheralTracker::ProcessFoundBleAdvertisement(
@@ -101,6 +112,60 @@ void DiscoveredPeripheralTracker::ProcessFoundBleAdvertisement(
     AdvertisementFetcher advertisement_fetcher) {
   MutexLock lock(&mutex_);
 
+  ProcessFoundBleAdvertisementLocked(std::move(peripheral), advertisement_data,
+                                     std::move(advertisement_fetcher));
+}
+
+void DiscoveredPeripheralTracker::ProcessFoundBleAdvertisements(
+    std::vector<FoundBleAdvertisement> advertisements) {
+  absl::Duration dedup_window =
+      absl::Milliseconds(NearbyFlags::GetInstance().GetInt64Flag(
+          config_package_nearby::nearby_connections_feature::
+              kBleScanResultDedupWindowMillis));
+  std::vector<FoundBleAdvertisement> screened_advertisements;
+  {
+    MutexLock lock(&screening_mutex_);
+    absl::Time now = SystemClock::ElapsedRealtime();
+    for (auto it = recent_scan_results_.begin();
+         it != recent_scan_results_.end();) {
+      auto current = it++;
+      if (now - current->second >= dedup_window) {
+        recent_scan_results_.erase(current);
+      }
+    }
+
+    for (FoundBleAdvertisement& advertisement : advertisements) {
+      if (!IsNewScanResult(advertisement.peripheral,
+                           advertisement.advertisement_data, now,
+                           dedup_window)) {
+        continue;
+      }
+      if (!MayContainTrackedServiceId(advertisement.advertisement_data)) {
+        continue;
+      }
+      screened_advertisements.push_back(std::move(advertisement));
+    }
+  }
+
+  if (screened_advertisements.empty()) {
+    return;
+  }
+  NEARBY_LOGS(VERBOSE) << "Processing " << screened_advertisements.size()
+                       << " of " << advertisements.size()
+                       << " found BLE advertisements after screening.";
+
+  MutexLock lock(&mutex_);
+  for (FoundBleAdvertisement& advertisement : screened_advertisements) {
+    ProcessFoundBleAdvertisementLocked(
+        std::move(advertisement.peripheral), advertisement.advertisement_data,
+        std::move(advertisement.advertisement_fetcher));
+  }
+}
+
+void DiscoveredPeripheralTracker::ProcessFoundBleAdvertisementLocked(
+    BleV2Peripheral peripheral,
+    const ::nearby::api::ble_v2::BleAdvertisementData& advertisement_data,
+    AdvertisementFetcher advertisement_fetcher) {
   if (service_id_infos_.empty()) {
     NEARBY_LOGS(INFO) << "Ignoring BLE advertisement header because we are not "
                          "tracking any service IDs.";
@@ -155,6 +220,94 @@ void DiscoveredPeripheralTracker::ProcessLostGattAdvertisements() {
   }
 }
 
+void DiscoveredPeripheralTracker::UpdateScreeningState() {
+  MutexLock lock(&screening_mutex_);
+
+  screening_service_ids_.clear();
+  screening_fast_advertisement_uuids_.clear();
+  for (const auto& item : service_id_infos_) {
+    screening_service_ids_.push_back(item.first);
+    if (!item.second.fast_advertisement_service_uuid.IsEmpty()) {
+      screening_fast_advertisement_uuids_.insert(
+          item.second.fast_advertisement_service_uuid);
+    }
+  }
+}
+
+bool DiscoveredPeripheralTracker::IsNewScanResult(
+    const BleV2Peripheral& peripheral,
+    const api::ble_v2::BleAdvertisementData& advertisement_data,
+    absl::Time now, absl::Duration dedup_window) {
+  if (dedup_window <= absl::ZeroDuration()) {
+    return true;
+  }
+  absl::optional<std::string> address = peripheral.GetAddress();
+  if (!address.has_value() || address->empty()) {
+    return true;
+  }
+
+  // Service data is keyed by UUID in a hash map, so sort it to build the same
+  // key for identical advertisements.
+  // UUIDs are appended as their 16 raw bytes rather than formatted.
+  std::vector<std::pair<Uuid, absl::string_view>> service_data;
+  service_data.reserve(advertisement_data.service_data.size());
+  for (const auto& item : advertisement_data.service_data) {
+    service_data.emplace_back(item.first, item.second.AsStringView());
+  }
+  std::sort(service_data.begin(), service_data.end());
+
+  std::string key = absl::StrCat(
+      *address, "|", advertisement_data.is_extended_advertisement ? 1 : 0);
+  for (const auto& item : service_data) {
+    std::array<char, 16> uuid = item.first.data();
+    absl::StrAppend(&key, "|", absl::string_view(uuid.data(), uuid.size()),
+                    ":", item.second.size(), ":", item.second);
+  }
+
+  auto [it, inserted] = recent_scan_results_.try_emplace(std::move(key), now);
+  if (inserted) {
+    return true;
+  }
+  bool is_new = now - it->second >= dedup_window;
+  it->second = now;
+  return is_new;
+}
+
+bool DiscoveredPeripheralTracker::MayContainTrackedServiceId(
+    const api::ble_v2::BleAdvertisementData& advertisement_data) {
+  if (screening_service_ids_.empty()) {
+    return false;
+  }
+
+  // Fast and extended regular advertisements are matched by UUID or service
+  // ID hash later on, so keep anything that parses as one.
+  for (const Uuid& uuid : screening_fast_advertisement_uuids_) {
+    const auto it = advertisement_data.service_data.find(uuid);
+    if (it != advertisement_data.service_data.end() &&
+        BleAdvertisement(it->second).IsValid()) {
+      return true;
+    }
+  }
+
+  const auto it =
+      advertisement_data.service_data.find(bleutils::kCopresenceServiceUuid);
+  if (it == advertisement_data.service_data.end()) {
+    return false;
+  }
+  BleAdvertisementHeader advertisement_header(it->second);
+  if (!advertisement_header.IsValid()) {
+    return false;
+  }
+  FixedBloomFilter<BleAdvertisementHeader::kServiceIdBloomFilterByteLength>
+      bloom_filter(advertisement_header.GetServiceIdBloomFilter());
+  for (const std::string& service_id : screening_service_ids_) {
+    if (bloom_filter.PossiblyContains(service_id)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void DiscoveredPeripheralTracker::ClearDataForServiceId(
     const std::string& service_id) {
   std::vector<BleAdvertisement> advertisement_list;
@@ -282,9 +435,8 @@ BleAdvertisementHeader DiscoveredPeripheralTracker::CreateAdvertisementHeader(
     const ByteArray& advertisement_bytes) {
   // Our end goal is to have a fully zeroed-out byte array of the correct
   // length representing an empty bloom filter.
-  BloomFilter bloom_filter(
-      std::make_unique<BitSetImpl<
-          BleAdvertisementHeader::kServiceIdBloomFilterByteLength>>());
+  FixedBloomFilter<BleAdvertisementHeader::kServiceIdBloomFilterByteLength>
+      bloom_filter;
 
   return BleAdvertisementHeader(
       BleAdvertisementHeader::Version::kV2, /*extended_advertisement=*/false,
@@ -478,9 +630,8 @@ bool DiscoveredPeripheralTracker::IsDummyAdvertisementHeader(
   // regular advertisement has different value, it will include PSM value if
   // received it from extended advertisement protocol and it will not has PSM
   // value if it fetcted from GATT connection.
-  BloomFilter bloom_filter(
-      std::make_unique<BitSetImpl<
-          BleAdvertisementHeader::kServiceIdBloomFilterByteLength>>());
+  FixedBloomFilter<BleAdvertisementHeader::kServiceIdBloomFilterByteLength>
+      bloom_filter;
   return advertisement_header.GetVersion() ==
              BleAdvertisementHeader::Version::kV2 &&
          advertisement_header.GetNumSlots() == 1 &&
@@ -513,6 +664,11 @@ void DiscoveredPeripheralTracker::HandleAdvertisementHeader(
 
   // Determine whether or not we need to read a fresh GATT advertisement.
   if (ShouldReadRawAdvertisementFromServer(advertisement_header)) {
+    if (HandleCachedRawAdvertisements(peripheral, advertisement_header)) {
+      UpdateCommonStateForFoundBleAdvertisement(advertisement_header);
+      return;
+    }
+
     // Determine whether or not we need to read a fresh GATT advertisement.
     if (NearbyFlags::GetInstance().GetBoolFlag(
             config_package_nearby::nearby_connections_feature::
@@ -533,6 +689,7 @@ void DiscoveredPeripheralTracker::HandleAdvertisementHeader(
                                            std::move(advertisement_fetcher));
         {
           MutexLock lock(&mutex_);
+          CacheRawAdvertisements(advertisement_header);
           HandleRawGattAdvertisements(peripheral, advertisement_header,
                                       gatt_advertisement_bytes_list,
                                       /*service_uuid=*/{});
@@ -548,6 +705,7 @@ void DiscoveredPeripheralTracker::HandleAdvertisementHeader(
       std::vector<const ByteArray*> gatt_advertisement_bytes_list =
           FetchRawAdvertisements(peripheral, advertisement_header,
                                  std::move(advertisement_fetcher));
+      CacheRawAdvertisements(advertisement_header);
       if (!gatt_advertisement_bytes_list.empty()) {
         HandleRawGattAdvertisements(peripheral, advertisement_header,
                                     gatt_advertisement_bytes_list,
@@ -577,10 +735,8 @@ ByteArray DiscoveredPeripheralTracker::ExtractAdvertisementHeaderBytes(
 
 bool DiscoveredPeripheralTracker::IsInterestingAdvertisementHeader(
     const BleAdvertisementHeader& advertisement_header) {
-  BloomFilter bloom_filter(
-      std::make_unique<BitSetImpl<
-          BleAdvertisementHeader::kServiceIdBloomFilterByteLength>>(),
-      advertisement_header.GetServiceIdBloomFilter());
+  FixedBloomFilter<BleAdvertisementHeader::kServiceIdBloomFilterByteLength>
+      bloom_filter(advertisement_header.GetServiceIdBloomFilter());
 
   for (const auto& item : service_id_infos_) {
     const std::string& service_id = item.first;
@@ -666,6 +822,55 @@ DiscoveredPeripheralTracker::FetchRawAdvertisements(
   return result->GetAdvertisements();
 }
 
+bool DiscoveredPeripheralTracker::HandleCachedRawAdvertisements(
+    BleV2Peripheral peripheral,
+    const BleAdvertisementHeader& advertisement_header) {
+  const std::vector<ByteArray>* cached_advertisements =
+      advertisement_cache_.Get(advertisement_header);
+  if (cached_advertisements == nullptr) {
+    return false;
+  }
+
+  // Record a successful read so the header is not read again.
+  auto result = std::make_unique<AdvertisementReadResult>();
+  for (int slot = 0; slot < static_cast<int>(cached_advertisements->size());
+       ++slot) {
+    result->AddAdvertisement(slot, (*cached_advertisements)[slot]);
+  }
+  result->RecordLastReadStatus(/*is_success=*/true);
+  std::vector<const ByteArray*> gatt_advertisement_bytes_list =
+      result->GetAdvertisements();
+  advertisement_read_results_.insert_or_assign(advertisement_header,
+                                               std::move(result));
+
+  NEARBY_LOGS(INFO) << "Reusing " << gatt_advertisement_bytes_list.size()
+                    << " cached GATT advertisements for advertisement header="
+                    << absl::BytesToHexString(
+                           ByteArray(advertisement_header).data());
+  HandleRawGattAdvertisements(std::move(peripheral), advertisement_header,
+                              gatt_advertisement_bytes_list,
+                              /*service_uuid=*/{});
+  return true;
+}
+
+void DiscoveredPeripheralTracker::CacheRawAdvertisements(
+    const BleAdvertisementHeader& advertisement_header) {
+  const auto it = advertisement_read_results_.find(advertisement_header);
+  if (it == advertisement_read_results_.end() ||
+      it->second->EvaluateRetryStatus() !=
+          AdvertisementReadResult::RetryStatus::kPreviouslySucceeded) {
+    return;
+  }
+
+  std::vector<ByteArray> advertisements;
+  for (const ByteArray* advertisement : it->second->GetAdvertisements()) {
+    advertisements.push_back(*advertisement);
+  }
+  if (!advertisements.empty()) {
+    advertisement_cache_.Put(advertisement_header, std::move(advertisements));
+  }
+}
+
 std::vector<const ByteArray*>
 DiscoveredPeripheralTracker::FetchRawAdvertisementsInThread(
     BleV2Peripheral peripheral,
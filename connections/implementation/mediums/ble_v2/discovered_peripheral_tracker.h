@@ -21,11 +21,15 @@
 #include <vector>
 
 #include "connections/implementation/mediums//lost_entity_tracker.h"
+#include "connections/implementation/mediums/ble_v2/advertisement_cache.h"
 #include "connections/implementation/mediums/ble_v2/advertisement_read_result.h"
 #include "connections/implementation/mediums/ble_v2/ble_advertisement.h"
 #include "connections/implementation/mediums/ble_v2/ble_advertisement_header.h"
 #include "connections/implementation/mediums/ble_v2/discovered_peripheral_callback.h"
 #include "connections/implementation/mediums/lost_entity_tracker.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/time/time.h"
 #include "internal/platform/bluetooth_adapter.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/multi_thread_executor.h"
@@ -59,6 +63,13 @@ class DiscoveredPeripheralTracker {
                                   mediums::AdvertisementReadResult&) {};
   };
 
+  // A BLE advertisement found by a scan, for batched processing.
+  struct FoundBleAdvertisement {
+    BleV2Peripheral peripheral;
+    api::ble_v2::BleAdvertisementData advertisement_data;
+    AdvertisementFetcher advertisement_fetcher;
+  };
+
   explicit DiscoveredPeripheralTracker(
       bool is_extended_advertisement_available = false);
 
@@ -71,13 +82,17 @@ class DiscoveredPeripheralTracker {
   //                                   events.
   // fast_advertisement_service_uuid - The service UUID to look for fast
   //                                   advertisements on.
+  // lost_after_rounds               - The number of calls to
+  //                                   ProcessLostGattAdvertisements() without
+  //                                   seeing a peripheral before it is lost.
   // Note: fast_advertisement_service_uuid can be empty UUID to indicate
   // that `fast_advertisement_service_uuid` will be ignored for regular
   // advertisement.
   void StartTracking(
       const std::string& service_id,
       const DiscoveredPeripheralCallback& discovered_peripheral_callback,
-      const Uuid& fast_advertisement_service_uuid) ABSL_LOCKS_EXCLUDED(mutex_);
+      const Uuid& fast_advertisement_service_uuid, int lost_after_rounds = 1)
+      ABSL_LOCKS_EXCLUDED(mutex_);
 
   // Stops tracking discoveries for a particular service Id.
   void StopTracking(const std::string& service_id) ABSL_LOCKS_EXCLUDED(mutex_);
@@ -95,6 +110,17 @@ class DiscoveredPeripheralTracker {
       api::ble_v2::BleAdvertisementData advertisement_data,
       AdvertisementFetcher advertisement_fetcher) ABSL_LOCKS_EXCLUDED(mutex_);
 
+  // Processes a batch of found BLE advertisements.
+  //
+  // Before `mutex_` is taken, the batch is screened: an advertisement is
+  // dropped if the same peripheral sent identical bytes within
+  // kBleScanResultDedupWindowMillis, or if it cannot belong to a tracked
+  // service ID. The remaining advertisements are then processed in order, as
+  // by ProcessFoundBleAdvertisement(), under a single lock acquisition.
+  void ProcessFoundBleAdvertisements(
+      std::vector<FoundBleAdvertisement> advertisements)
+      ABSL_LOCKS_EXCLUDED(mutex_, screening_mutex_);
+
   // Processes the set of lost GATT advertisements and notifies the client of
   // any lost peripherals.
   void ProcessLostGattAdvertisements() ABSL_LOCKS_EXCLUDED(mutex_);
@@ -133,6 +159,33 @@ class DiscoveredPeripheralTracker {
     BleV2Peripheral peripheral;
   };
 
+  // Processes a found BLE advertisement with `mutex_` held.
+  void ProcessFoundBleAdvertisementLocked(
+      BleV2Peripheral peripheral,
+      const api::ble_v2::BleAdvertisementData& advertisement_data,
+      AdvertisementFetcher advertisement_fetcher)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Copies the tracked service IDs and fast advertisement UUIDs into the
+  // screening state after `service_id_infos_` changes.
+  void UpdateScreeningState() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_)
+      ABSL_LOCKS_EXCLUDED(screening_mutex_);
+
+  // Returns false if `peripheral` sent identical `advertisement_data` less than
+  // `dedup_window` before `now`. Records the advertisement as seen at `now`.
+  bool IsNewScanResult(
+      const BleV2Peripheral& peripheral,
+      const api::ble_v2::BleAdvertisementData& advertisement_data,
+      absl::Time now, absl::Duration dedup_window)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(screening_mutex_);
+
+  // Returns false only if `advertisement_data` can't belong to any tracked
+  // service ID: it carries no parsable fast/regular advertisement and its
+  // advertisement header's bloom filter matches none of them.
+  bool MayContainTrackedServiceId(
+      const api::ble_v2::BleAdvertisementData& advertisement_data)
+      ABSL_SHARED_LOCKS_REQUIRED(screening_mutex_);
+
   // Clears stale data from any previous sessions.
   void ClearDataForServiceId(const std::string& service_id)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
@@ -236,6 +289,19 @@ class DiscoveredPeripheralTracker {
       AdvertisementFetcher advertisement_fetcher)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Handles the advertisements cached for `advertisement_header` as if they
+  // were just read from the GATT server. Returns false if none are cached.
+  bool HandleCachedRawAdvertisements(
+      BleV2Peripheral peripheral,
+      const BleAdvertisementHeader& advertisement_header)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Caches the advertisements read for `advertisement_header` if the read
+  // succeeded.
+  void CacheRawAdvertisements(
+      const BleAdvertisementHeader& advertisement_header)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   std::vector<const ByteArray*> FetchRawAdvertisementsInThread(
       BleV2Peripheral peripheral,
       const BleAdvertisementHeader& advertisement_header,
@@ -291,6 +357,29 @@ class DiscoveredPeripheralTracker {
 
   std::unique_ptr<MultiThreadExecutor> executor_ ABSL_GUARDED_BY(mutex_) =
       nullptr;
+
+  // Advertisements read from GATT servers, reused when a header changes but
+  // its advertisement hash doesn't. Unlike advertisement_read_results_, this
+  // is not cleared by StartTracking, since entries hold every slot.
+  AdvertisementCache advertisement_cache_ ABSL_GUARDED_BY(mutex_);
+
+  // ------------ BATCH SCREENING STATE ------------
+  // Guards the state used to screen batches without taking `mutex_`. When
+  // both are taken, `mutex_` is taken first.
+  Mutex screening_mutex_;
+
+  // Copies of the keys of `service_id_infos_` and their fast advertisement
+  // UUIDs.
+  std::vector<std::string> screening_service_ids_
+      ABSL_GUARDED_BY(screening_mutex_);
+  absl::flat_hash_set<Uuid> screening_fast_advertisement_uuids_
+      ABSL_GUARDED_BY(screening_mutex_);
+
+  // Maps a peripheral address and its advertisement bytes to the last time
+  // they were seen in a batch. Entries older than the dedup window are pruned
+  // on every batch.
+  absl::flat_hash_map<std::string, absl::Time> recent_scan_results_
+      ABSL_GUARDED_BY(screening_mutex_);
 };
 
 }  // namespace mediums
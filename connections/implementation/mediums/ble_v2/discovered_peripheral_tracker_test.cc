@@ -16,10 +16,13 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/implementation/mediums/ble_v2/ble_utils.h"
 #include "connections/implementation/mediums/ble_v2/bloom_filter.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/ble_v2.h"
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/medium_environment.h"
@@ -111,7 +114,10 @@ class DiscoveredPeripheralTrackerTest : public testing::Test {
     ble_central_ = std::make_unique<BleV2Medium>(*adapter_central_);
   }
 
-  void TearDown() override { MediumEnvironment::Instance().Stop(); }
+  void TearDown() override {
+    MediumEnvironment::Instance().Stop();
+    NearbyFlags::GetInstance().ResetOverridedValues();
+  }
 
   BleV2Peripheral CreateBlePeripheral() {
     return ble_central_->GetRemotePeripheral(
@@ -148,6 +154,21 @@ class DiscoveredPeripheralTrackerTest : public testing::Test {
   }
 
  protected:
+  // A stub Advertisement fetcher that never records a read status, so the
+  // tracker retries the read every time it processes the header.
+  DiscoveredPeripheralTracker::AdvertisementFetcher
+  GetRetryingAdvertisementFetcher() {
+    return {
+        .fetch_advertisements =
+            [this](BleV2Peripheral peripheral, int num_slots, int psm,
+                   const std::vector<std::string>& interesting_service_ids,
+                   mediums::AdvertisementReadResult& advertisement_read_result) {
+              MutexLock lock(&mutex_);
+              fetch_count_++;
+            },
+    };
+  }
+
   // A stub Advertisement fetcher.
   DiscoveredPeripheralTracker::AdvertisementFetcher GetAdvertisementFetcher(
       CountDownLatch& fetch_latch,
@@ -608,6 +629,50 @@ TEST_F(DiscoveredPeripheralTrackerTest,
   EXPECT_EQ(GetFetchAdvertisementCallbackCount(), 1);
 }
 
+TEST_F(DiscoveredPeripheralTrackerTest,
+       FoundBleAdvertisementReusesCachedAdvertisementsForChangedHeader) {
+  std::vector<std::string> service_ids = {std::string(kServiceIdA)};
+  ByteArray advertisement_hash = GenerateRandomAdvertisementHash();
+  ByteArray advertisement_bytes = CreateBleAdvertisement(
+      std::string(kServiceIdA), ByteArray(std::string(kData)),
+      ByteArray(std::string(kDeviceToken)));
+  CountDownLatch found_latch(1);
+  CountDownLatch fetch_latch(2);
+
+  discovered_peripheral_tracker_.StartTracking(
+      std::string(kServiceIdA),
+      {
+          .peripheral_discovered_cb =
+              [&found_latch](BleV2Peripheral peripheral,
+                             const std::string& service_id,
+                             const ByteArray& advertisement_bytes,
+                             bool fast_advertisement) {
+                found_latch.CountDown();
+              },
+      },
+      {});
+
+  api::ble_v2::BleAdvertisementData advertisement_data;
+  advertisement_data.service_data.insert(
+      {bleutils::kCopresenceServiceUuid,
+       CreateBleAdvertisementHeader(advertisement_hash, service_ids)});
+  FindAdvertisement(advertisement_data, {advertisement_bytes}, fetch_latch);
+  EXPECT_TRUE(found_latch.Await(kWaitDuration).result());
+
+  // The same content advertised with a PSM is a different header, but its
+  // advertisements should come from the cache instead of a GATT read.
+  api::ble_v2::BleAdvertisementData psm_advertisement_data;
+  psm_advertisement_data.service_data.insert(
+      {bleutils::kCopresenceServiceUuid,
+       CreateBleAdvertisementHeader(advertisement_hash, /*psm=*/1,
+                                    service_ids)});
+  FindAdvertisement(psm_advertisement_data, {advertisement_bytes},
+                    fetch_latch);
+
+  EXPECT_FALSE(fetch_latch.Await(kWaitDuration).result());
+  EXPECT_EQ(GetFetchAdvertisementCallbackCount(), 1);
+}
+
 TEST_F(DiscoveredPeripheralTrackerTest,
        FoundBleAdvertisementUntrackedServiceId) {
   std::vector<std::string> service_ids = {std::string(kServiceIdA),
@@ -959,6 +1024,132 @@ TEST_F(DiscoveredPeripheralTrackerTest,
   EXPECT_FALSE(lost_latch.Await(kWaitDuration).result());
 }
 
+TEST_F(DiscoveredPeripheralTrackerTest,
+       ProcessBatchDropsAdvertisementsForUntrackedServiceIds) {
+  std::vector<std::string> tracked_service_ids = {std::string(kServiceIdA)};
+  std::vector<std::string> untracked_service_ids = {std::string(kServiceIdB)};
+  ByteArray advertisement_bytes = CreateBleAdvertisement(
+      std::string(kServiceIdA), ByteArray(std::string(kData)),
+      ByteArray(std::string(kDeviceToken)));
+  CountDownLatch found_latch(1);
+  CountDownLatch fetch_latch(1);
+
+  discovered_peripheral_tracker_.StartTracking(
+      std::string(kServiceIdA),
+      {
+          .peripheral_discovered_cb =
+              [&found_latch](BleV2Peripheral peripheral,
+                             const std::string& service_id,
+                             const ByteArray& advertisement_bytes,
+                             bool fast_advertisement) {
+                EXPECT_EQ(service_id, std::string(kServiceIdA));
+                found_latch.CountDown();
+              },
+      },
+      {});
+
+  api::ble_v2::BleAdvertisementData untracked_advertisement_data;
+  untracked_advertisement_data.service_data.insert(
+      {bleutils::kCopresenceServiceUuid,
+       CreateBleAdvertisementHeader(GenerateRandomAdvertisementHash(),
+                                    untracked_service_ids)});
+  api::ble_v2::BleAdvertisementData tracked_advertisement_data;
+  tracked_advertisement_data.service_data.insert(
+      {bleutils::kCopresenceServiceUuid,
+       CreateBleAdvertisementHeader(GenerateRandomAdvertisementHash(),
+                                    tracked_service_ids)});
+
+  std::vector<DiscoveredPeripheralTracker::FoundBleAdvertisement> batch;
+  batch.push_back({
+      .peripheral = CreateBlePeripheral(),
+      .advertisement_data = untracked_advertisement_data,
+      .advertisement_fetcher =
+          GetAdvertisementFetcher(fetch_latch, {advertisement_bytes}),
+  });
+  batch.push_back({
+      .peripheral = CreateBlePeripheral(),
+      .advertisement_data = tracked_advertisement_data,
+      .advertisement_fetcher =
+          GetAdvertisementFetcher(fetch_latch, {advertisement_bytes}),
+  });
+  discovered_peripheral_tracker_.ProcessFoundBleAdvertisements(
+      std::move(batch));
+
+  // Only the header carrying the tracked service ID should be read.
+  fetch_latch.Await(kWaitDuration);
+  EXPECT_TRUE(found_latch.Await(kWaitDuration).result());
+  EXPECT_EQ(GetFetchAdvertisementCallbackCount(), 1);
+}
+
+TEST_F(DiscoveredPeripheralTrackerTest,
+       ProcessBatchDropsIdenticalAdvertisementsFromSamePeripheral) {
+  std::vector<std::string> service_ids = {std::string(kServiceIdA)};
+  api::ble_v2::BleAdvertisementData advertisement_data;
+  advertisement_data.service_data.insert(
+      {bleutils::kCopresenceServiceUuid,
+       CreateBleAdvertisementHeader(GenerateRandomAdvertisementHash(),
+                                    service_ids)});
+
+  discovered_peripheral_tracker_.StartTracking(std::string(kServiceIdA), {},
+                                               {});
+
+  std::vector<DiscoveredPeripheralTracker::FoundBleAdvertisement> batch;
+  for (int i = 0; i < 3; i++) {
+    batch.push_back({
+        .peripheral = CreateBlePeripheral(),
+        .advertisement_data = advertisement_data,
+        .advertisement_fetcher = GetRetryingAdvertisementFetcher(),
+    });
+  }
+  discovered_peripheral_tracker_.ProcessFoundBleAdvertisements(
+      std::move(batch));
+
+  // The read is never recorded, so every header that gets through is read.
+  EXPECT_EQ(GetFetchAdvertisementCallbackCount(), 1);
+
+  // The same advertisement in the next batch is still within the window.
+  batch.clear();
+  batch.push_back({
+      .peripheral = CreateBlePeripheral(),
+      .advertisement_data = advertisement_data,
+      .advertisement_fetcher = GetRetryingAdvertisementFetcher(),
+  });
+  discovered_peripheral_tracker_.ProcessFoundBleAdvertisements(
+      std::move(batch));
+
+  EXPECT_EQ(GetFetchAdvertisementCallbackCount(), 1);
+}
+
+TEST_F(DiscoveredPeripheralTrackerTest,
+       ProcessBatchKeepsIdenticalAdvertisementsWithoutDedupWindow) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kBleScanResultDedupWindowMillis,
+      0);
+  std::vector<std::string> service_ids = {std::string(kServiceIdA)};
+  api::ble_v2::BleAdvertisementData advertisement_data;
+  advertisement_data.service_data.insert(
+      {bleutils::kCopresenceServiceUuid,
+       CreateBleAdvertisementHeader(GenerateRandomAdvertisementHash(),
+                                    service_ids)});
+
+  discovered_peripheral_tracker_.StartTracking(std::string(kServiceIdA), {},
+                                               {});
+
+  std::vector<DiscoveredPeripheralTracker::FoundBleAdvertisement> batch;
+  for (int i = 0; i < 3; i++) {
+    batch.push_back({
+        .peripheral = CreateBlePeripheral(),
+        .advertisement_data = advertisement_data,
+        .advertisement_fetcher = GetRetryingAdvertisementFetcher(),
+    });
+  }
+  discovered_peripheral_tracker_.ProcessFoundBleAdvertisements(
+      std::move(batch));
+
+  EXPECT_EQ(GetFetchAdvertisementCallbackCount(), 3);
+}
+
 }  // namespace
 
 }  // namespace mediums
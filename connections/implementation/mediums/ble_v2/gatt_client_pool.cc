@@ -0,0 +1,124 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "connections/implementation/mediums/ble_v2/gatt_client_pool.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "internal/platform/ble_v2.h"
+#include "internal/platform/logging.h"
+#include "internal/platform/system_clock.h"
+#include "internal/platform/uuid.h"
+
+namespace nearby {
+namespace connections {
+namespace mediums {
+
+GattClient* GattClientPool::Acquire(const std::string& address,
+                                    ConnectCallback connect) {
+  absl::Time now = SystemClock::ElapsedRealtime();
+  DisconnectIdleClients(now);
+
+  auto it = clients_.find(address);
+  if (it != clients_.end()) {
+    NEARBY_LOGS(VERBOSE) << "Reusing pooled GATT client for peripheral "
+                         << address;
+    it->second.last_used_time = now;
+    return it->second.client.get();
+  }
+
+  std::unique_ptr<GattClient> client = connect();
+  if (!client || !client->IsValid()) {
+    return nullptr;
+  }
+  PooledClient& pooled_client = clients_[address];
+  pooled_client.client = std::move(client);
+  pooled_client.last_used_time = now;
+  return pooled_client.client.get();
+}
+
+bool GattClientPool::DiscoverServiceAndCharacteristics(
+    const std::string& address, const Uuid& service_uuid,
+    const std::vector<Uuid>& characteristic_uuids) {
+  auto it = clients_.find(address);
+  if (it == clients_.end()) {
+    return false;
+  }
+
+  PooledClient& pooled_client = it->second;
+  std::vector<Uuid> undiscovered_uuids;
+  for (const Uuid& characteristic_uuid : characteristic_uuids) {
+    if (!pooled_client.discovered_characteristics.contains(
+            {service_uuid, characteristic_uuid})) {
+      undiscovered_uuids.push_back(characteristic_uuid);
+    }
+  }
+  if (undiscovered_uuids.empty()) {
+    return true;
+  }
+
+  if (!pooled_client.client->DiscoverServiceAndCharacteristics(
+          service_uuid, undiscovered_uuids)) {
+    return false;
+  }
+  for (const Uuid& characteristic_uuid : undiscovered_uuids) {
+    pooled_client.discovered_characteristics.insert(
+        {service_uuid, characteristic_uuid});
+  }
+  return true;
+}
+
+void GattClientPool::Release(const std::string& address, bool reusable) {
+  auto it = clients_.find(address);
+  if (it == clients_.end()) {
+    return;
+  }
+
+  if (reusable && !address.empty() && idle_timeout_ > absl::ZeroDuration()) {
+    it->second.last_used_time = SystemClock::ElapsedRealtime();
+    return;
+  }
+
+  it->second.client->Disconnect();
+  clients_.erase(it);
+}
+
+void GattClientPool::Clear() {
+  for (auto& item : clients_) {
+    item.second.client->Disconnect();
+  }
+  clients_.clear();
+}
+
+void GattClientPool::DisconnectIdleClients(absl::Time now) {
+  for (auto it = clients_.begin(); it != clients_.end();) {
+    if (now - it->second.last_used_time < idle_timeout_) {
+      ++it;
+      continue;
+    }
+    NEARBY_LOGS(VERBOSE) << "Disconnecting idle GATT client for peripheral "
+                         << it->first;
+    it->second.client->Disconnect();
+    clients_.erase(it++);
+  }
+}
+
+}  // namespace mediums
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,97 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef CORE_INTERNAL_MEDIUMS_BLE_V2_GATT_CLIENT_POOL_H_
+#define CORE_INTERNAL_MEDIUMS_BLE_V2_GATT_CLIENT_POOL_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/time/time.h"
+#include "internal/platform/ble_v2.h"
+#include "internal/platform/uuid.h"
+
+namespace nearby {
+namespace connections {
+namespace mediums {
+
+// A pool of GATT client connections used to read advertisements, keyed by
+// peripheral address.
+//
+// A client released back to the pool stays connected for `idle_timeout`, so
+// that reads for other service IDs on the same peripheral, or retries of a
+// failed read, don't pay for a new connection. The services and
+// characteristics discovered on a pooled client are remembered, and
+// discovering them again is skipped.
+//
+// This class is not thread-safe.
+class GattClientPool {
+ public:
+  using ConnectCallback = absl::AnyInvocable<std::unique_ptr<GattClient>()>;
+
+  // A pool with an `idle_timeout` of zero disconnects clients as soon as they
+  // are released.
+  explicit GattClientPool(absl::Duration idle_timeout)
+      : idle_timeout_(idle_timeout) {}
+  ~GattClientPool() { Clear(); }
+
+  // Returns the client pooled for `address` or, if there is none, one created
+  // by `connect`. Returns nullptr if `connect` fails. Pooled clients idle for
+  // longer than the idle timeout are disconnected first.
+  //
+  // The client is owned by the pool and must be handed back with Release().
+  GattClient* Acquire(const std::string& address, ConnectCallback connect);
+
+  // Discovers `characteristic_uuids` of `service_uuid` on the client acquired
+  // for `address`, unless they were already discovered on it.
+  bool DiscoverServiceAndCharacteristics(
+      const std::string& address, const Uuid& service_uuid,
+      const std::vector<Uuid>& characteristic_uuids);
+
+  // Hands the client acquired for `address` back to the pool. A client that
+  // isn't `reusable`, e.g. because a read on it failed, or whose `address` is
+  // empty is disconnected.
+  void Release(const std::string& address, bool reusable);
+
+  // Disconnects all pooled clients.
+  void Clear();
+
+  size_t Size() const { return clients_.size(); }
+
+ private:
+  struct PooledClient {
+    std::unique_ptr<GattClient> client;
+    // The (service, characteristic) pairs discovered on `client`.
+    absl::flat_hash_set<std::pair<Uuid, Uuid>> discovered_characteristics;
+    absl::Time last_used_time;
+  };
+
+  void DisconnectIdleClients(absl::Time now);
+
+  const absl::Duration idle_timeout_;
+  absl::flat_hash_map<std::string, PooledClient> clients_;
+};
+
+}  // namespace mediums
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_MEDIUMS_BLE_V2_GATT_CLIENT_POOL_H_
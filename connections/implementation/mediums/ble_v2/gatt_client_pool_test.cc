@@ -0,0 +1,247 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "connections/implementation/mediums/ble_v2/gatt_client_pool.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "internal/platform/ble_v2.h"
+#include "internal/platform/implementation/ble_v2.h"
+#include "internal/platform/uuid.h"
+
+namespace nearby {
+namespace connections {
+namespace mediums {
+namespace {
+
+constexpr absl::string_view kAddress = "00:11:22:33:44:55";
+constexpr absl::string_view kAddress2 = "66:77:88:99:AA:BB";
+
+const Uuid kServiceUuid{0x0000FEF300001000, 0x800000805F9B34FB};
+const Uuid kCharacteristicUuid{0x1111, 0x2222};
+const Uuid kCharacteristicUuid2{0x3333, 0x4444};
+
+struct FakeGattClientStats {
+  int connect_count = 0;
+  int discover_count = 0;
+  int disconnect_count = 0;
+  std::vector<Uuid> last_discovered_uuids;
+};
+
+class FakeGattClient : public api::ble_v2::GattClient {
+ public:
+  explicit FakeGattClient(FakeGattClientStats& stats) : stats_(stats) {}
+
+  bool DiscoverServiceAndCharacteristics(
+      const Uuid& service_uuid,
+      const std::vector<Uuid>& characteristic_uuids) override {
+    ++stats_.discover_count;
+    stats_.last_discovered_uuids = characteristic_uuids;
+    return discovery_succeeds_;
+  }
+  // NOLINTNEXTLINE(google3-legacy-absl-backports)
+  absl::optional<api::ble_v2::GattCharacteristic> GetCharacteristic(
+      const Uuid& service_uuid, const Uuid& characteristic_uuid) override {
+    return absl::nullopt;
+  }
+  // NOLINTNEXTLINE(google3-legacy-absl-backports)
+  absl::optional<std::string> ReadCharacteristic(
+      const api::ble_v2::GattCharacteristic& characteristic) override {
+    return absl::nullopt;
+  }
+  bool WriteCharacteristic(
+      const api::ble_v2::GattCharacteristic& characteristic,
+      absl::string_view value, WriteType type) override {
+    return false;
+  }
+  bool SetCharacteristicSubscription(
+      const api::ble_v2::GattCharacteristic& characteristic, bool enable,
+      absl::AnyInvocable<void(absl::string_view value)>
+          on_characteristic_changed_cb) override {
+    return false;
+  }
+  void Disconnect() override { ++stats_.disconnect_count; }
+
+  void SetDiscoverySucceeds(bool discovery_succeeds) {
+    discovery_succeeds_ = discovery_succeeds;
+  }
+
+ private:
+  FakeGattClientStats& stats_;
+  bool discovery_succeeds_ = true;
+};
+
+GattClientPool::ConnectCallback Connect(FakeGattClientStats& stats) {
+  return [&stats]() {
+    ++stats.connect_count;
+    return std::make_unique<GattClient>(
+        std::make_unique<FakeGattClient>(stats));
+  };
+}
+
+TEST(GattClientPoolTest, ReusesReleasedClient) {
+  FakeGattClientStats stats;
+  GattClientPool pool{absl::Minutes(1)};
+
+  GattClient* gatt_client =
+      pool.Acquire(std::string(kAddress), Connect(stats));
+  ASSERT_NE(gatt_client, nullptr);
+  pool.Release(std::string(kAddress), /*reusable=*/true);
+
+  EXPECT_EQ(pool.Acquire(std::string(kAddress), Connect(stats)), gatt_client);
+  EXPECT_EQ(stats.connect_count, 1);
+  EXPECT_EQ(stats.disconnect_count, 0);
+  EXPECT_EQ(pool.Size(), 1);
+}
+
+TEST(GattClientPoolTest, KeysClientsByAddress) {
+  FakeGattClientStats stats;
+  GattClientPool pool{absl::Minutes(1)};
+
+  GattClient* gatt_client =
+      pool.Acquire(std::string(kAddress), Connect(stats));
+  pool.Release(std::string(kAddress), /*reusable=*/true);
+  GattClient* gatt_client2 =
+      pool.Acquire(std::string(kAddress2), Connect(stats));
+  pool.Release(std::string(kAddress2), /*reusable=*/true);
+
+  EXPECT_NE(gatt_client, gatt_client2);
+  EXPECT_EQ(stats.connect_count, 2);
+  EXPECT_EQ(pool.Size(), 2);
+}
+
+TEST(GattClientPoolTest, ReturnsNullptrWhenConnectFails) {
+  GattClientPool pool{absl::Minutes(1)};
+
+  EXPECT_EQ(pool.Acquire(std::string(kAddress),
+                         []() { return std::unique_ptr<GattClient>(); }),
+            nullptr);
+  EXPECT_EQ(pool.Size(), 0);
+}
+
+TEST(GattClientPoolTest, DisconnectsClientThatIsNotReusable) {
+  FakeGattClientStats stats;
+  GattClientPool pool{absl::Minutes(1)};
+
+  pool.Acquire(std::string(kAddress), Connect(stats));
+  pool.Release(std::string(kAddress), /*reusable=*/false);
+
+  EXPECT_EQ(stats.disconnect_count, 1);
+  EXPECT_EQ(pool.Size(), 0);
+}
+
+TEST(GattClientPoolTest, DisconnectsClientWithoutAddress) {
+  FakeGattClientStats stats;
+  GattClientPool pool{absl::Minutes(1)};
+
+  pool.Acquire("", Connect(stats));
+  pool.Release("", /*reusable=*/true);
+
+  EXPECT_EQ(stats.disconnect_count, 1);
+  EXPECT_EQ(pool.Size(), 0);
+}
+
+TEST(GattClientPoolTest, ZeroIdleTimeoutDisconnectsOnRelease) {
+  FakeGattClientStats stats;
+  GattClientPool pool{absl::ZeroDuration()};
+
+  pool.Acquire(std::string(kAddress), Connect(stats));
+  pool.Release(std::string(kAddress), /*reusable=*/true);
+  pool.Acquire(std::string(kAddress), Connect(stats));
+
+  EXPECT_EQ(stats.connect_count, 2);
+  EXPECT_EQ(stats.disconnect_count, 1);
+}
+
+TEST(GattClientPoolTest, DisconnectsIdleClients) {
+  FakeGattClientStats stats;
+  GattClientPool pool{absl::Milliseconds(10)};
+
+  pool.Acquire(std::string(kAddress), Connect(stats));
+  pool.Release(std::string(kAddress), /*reusable=*/true);
+  absl::SleepFor(absl::Milliseconds(50));
+  pool.Acquire(std::string(kAddress2), Connect(stats));
+
+  EXPECT_EQ(stats.disconnect_count, 1);
+  EXPECT_EQ(pool.Size(), 1);
+}
+
+TEST(GattClientPoolTest, CachesDiscoveredCharacteristics) {
+  FakeGattClientStats stats;
+  GattClientPool pool{absl::Minutes(1)};
+
+  pool.Acquire(std::string(kAddress), Connect(stats));
+  EXPECT_TRUE(pool.DiscoverServiceAndCharacteristics(
+      std::string(kAddress), kServiceUuid, {kCharacteristicUuid}));
+  EXPECT_TRUE(pool.DiscoverServiceAndCharacteristics(
+      std::string(kAddress), kServiceUuid, {kCharacteristicUuid}));
+  EXPECT_EQ(stats.discover_count, 1);
+
+  // Only the characteristics that weren't discovered yet are discovered.
+  EXPECT_TRUE(pool.DiscoverServiceAndCharacteristics(
+      std::string(kAddress), kServiceUuid,
+      {kCharacteristicUuid, kCharacteristicUuid2}));
+  EXPECT_EQ(stats.discover_count, 2);
+  EXPECT_EQ(stats.last_discovered_uuids,
+            std::vector<Uuid>{kCharacteristicUuid2});
+}
+
+TEST(GattClientPoolTest, DoesNotCacheFailedDiscovery) {
+  FakeGattClientStats stats;
+  GattClientPool pool{absl::Minutes(1)};
+  FakeGattClient* fake_gatt_client = nullptr;
+
+  pool.Acquire(std::string(kAddress), [&]() {
+    auto fake = std::make_unique<FakeGattClient>(stats);
+    fake_gatt_client = fake.get();
+    return std::make_unique<GattClient>(std::move(fake));
+  });
+  fake_gatt_client->SetDiscoverySucceeds(false);
+  EXPECT_FALSE(pool.DiscoverServiceAndCharacteristics(
+      std::string(kAddress), kServiceUuid, {kCharacteristicUuid}));
+  fake_gatt_client->SetDiscoverySucceeds(true);
+  EXPECT_TRUE(pool.DiscoverServiceAndCharacteristics(
+      std::string(kAddress), kServiceUuid, {kCharacteristicUuid}));
+
+  EXPECT_EQ(stats.discover_count, 2);
+}
+
+TEST(GattClientPoolTest, ClearDisconnectsAllClients) {
+  FakeGattClientStats stats;
+  GattClientPool pool{absl::Minutes(1)};
+
+  pool.Acquire(std::string(kAddress), Connect(stats));
+  pool.Release(std::string(kAddress), /*reusable=*/true);
+  pool.Acquire(std::string(kAddress2), Connect(stats));
+  pool.Release(std::string(kAddress2), /*reusable=*/true);
+  pool.Clear();
+
+  EXPECT_EQ(stats.disconnect_count, 2);
+  EXPECT_EQ(pool.Size(), 0);
+}
+
+}  // namespace
+}  // namespace mediums
+}  // namespace connections
+}  // namespace nearby
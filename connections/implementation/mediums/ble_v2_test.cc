@@ -196,6 +196,69 @@ TEST_P(BleV2Test, CanCancelConnect) {
 INSTANTIATE_TEST_SUITE_P(ParametrisedBleTest, BleV2Test,
                          ::testing::ValuesIn(kTestCases));
 
+TEST_F(BleV2Test, ConnectsOverL2capWhenPeripheralAdvertisesPsm) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableBleL2capChannels,
+      true);
+  env_.Start();
+  BluetoothRadio radio_client;
+  BluetoothRadio radio_server;
+  BleV2 ble_client{radio_client};
+  BleV2 ble_server{radio_server};
+  radio_client.Enable();
+  radio_server.Enable();
+  std::string service_id(kServiceIDA);
+  ByteArray advertisement_bytes{std::string(kAdvertisementString)};
+  CountDownLatch discovered_latch(1);
+  CountDownLatch accept_latch(1);
+
+  BleV2Socket socket_for_server;
+  EXPECT_TRUE(ble_server.StartAcceptingConnections(
+      service_id, {
+                      .accepted_cb =
+                          [&socket_for_server, &accept_latch](
+                              BleV2Socket socket, const std::string&) {
+                            socket_for_server = std::move(socket);
+                            accept_latch.CountDown();
+                          },
+                  }));
+  // The PSM travels in the advertisement header of regular advertisements.
+  ble_server.StartAdvertising(service_id, advertisement_bytes,
+                              PowerLevel::kHighPower,
+                              /*is_fast_advertisement=*/false);
+
+  BleV2Peripheral discovered_peripheral;
+  ble_client.StartScanning(
+      service_id, PowerLevel::kHighPower,
+      mediums::DiscoveredPeripheralCallback{
+          .peripheral_discovered_cb =
+              [&discovered_latch, &discovered_peripheral](
+                  BleV2Peripheral peripheral, const std::string& service_id,
+                  const ByteArray& advertisement_bytes,
+                  bool fast_advertisement) {
+                discovered_peripheral = peripheral;
+                discovered_latch.CountDown();
+              },
+      });
+  discovered_latch.Await(kWaitDuration).result();
+  ASSERT_TRUE(discovered_peripheral.IsValid());
+  EXPECT_NE(discovered_peripheral.GetPsm(), 0);
+
+  CancellationFlag flag;
+  BleV2Socket socket_for_client =
+      ble_client.Connect(service_id, discovered_peripheral, &flag);
+  EXPECT_TRUE(accept_latch.Await(kWaitDuration).result());
+  EXPECT_TRUE(socket_for_client.IsValid());
+  EXPECT_TRUE(socket_for_client.IsL2cap());
+  EXPECT_TRUE(socket_for_server.IsL2cap());
+  ble_client.StopScanning(service_id);
+  EXPECT_TRUE(ble_server.StopAcceptingConnections(service_id));
+  EXPECT_TRUE(ble_server.StopAdvertising(service_id));
+  env_.Stop();
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 TEST_F(BleV2Test, CanConstructValidObject) {
   env_.Start();
   BluetoothRadio radio_a;
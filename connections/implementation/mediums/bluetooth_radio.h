@@ -15,10 +15,10 @@
 #ifndef CORE_INTERNAL_MEDIUMS_BLUETOOTH_RADIO_H_
 #define CORE_INTERNAL_MEDIUMS_BLUETOOTH_RADIO_H_
 
-#include <cstdint>
+#include <memory>
 
-#include "internal/platform/atomic_boolean.h"
 #include "internal/platform/bluetooth_adapter.h"
+#include "internal/platform/bluetooth_radio_state.h"
 
 namespace nearby {
 namespace connections {
@@ -30,7 +30,8 @@ class BluetoothRadio {
   BluetoothRadio(BluetoothRadio&&) = default;
   BluetoothRadio& operator=(BluetoothRadio&&) = default;
 
-  // Reverts the Bluetooth radio to its original state.
+  // Reverts the Bluetooth radio to its original state, unless another user
+  // of the radio still relies on it.
   ~BluetoothRadio();
 
   // Enables Bluetooth.
@@ -41,7 +42,7 @@ class BluetoothRadio {
   // Returns true if enabled successfully.
   bool Enable();
 
-  // Disables Bluetooth.
+  // Disables Bluetooth, unless another user of the radio holds it enabled.
   //
   // Returns true if disabled successfully.
   bool Disable();
@@ -55,24 +56,13 @@ class BluetoothRadio {
   BluetoothAdapter& GetBluetoothAdapter() { return bluetooth_adapter_; }
 
  private:
-  bool SetBluetoothState(bool enable);
-  bool IsInDesiredState(bool should_be_enabled) const;
-  // To be called in enable() and disable(). This will remember the
-  // original state of the radio before any radio state has been modified.
-  // Returns false if Bluetooth doesn't exist on the device and the state cannot
-  // be obtained.
-  bool SaveOriginalState();
-
   // BluetoothAdapter::IsValid() will return false if BT is not supported.
   BluetoothAdapter bluetooth_adapter_;
 
-  // The Bluetooth radio's original state, before we modified it. True if
-  // originally enabled, false if originally disabled.
-  // We restore the radio to its original state in the destructor.
-
-  AtomicBoolean originally_enabled_{false};
-  // false if we never modified the radio state, true otherwise.
-  AtomicBoolean ever_saved_state_{false};
+  // Shared with the other users of the radio, e.g. Fast Pair, Connections.
+  // Null once moved from.
+  std::shared_ptr<BluetoothRadioState> state_;
+  int user_id_ = 0;
 };
 
 }  // namespace connections
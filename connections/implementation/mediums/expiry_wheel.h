@@ -0,0 +1,101 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef CORE_INTERNAL_MEDIUMS_EXPIRY_WHEEL_H_
+#define CORE_INTERNAL_MEDIUMS_EXPIRY_WHEEL_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+
+namespace nearby {
+namespace connections {
+namespace mediums {
+
+// A timer wheel that expires entities a fixed number of ticks after they were
+// last scheduled. The caller decides how long a tick is, which sets the timing
+// granularity.
+//
+// Scheduling an entity and expiring it are both O(1), so advancing the wheel
+// costs O(expired entities), not O(scheduled entities).
+//
+// This class is not thread-safe.
+//
+// Note: Entity must be hashable and overload the == operator.
+template <typename Entity>
+class ExpiryWheel {
+ public:
+  using EntitySet = absl::flat_hash_set<Entity>;
+
+  // Entities expire once `timeout_ticks` full ticks have passed since they
+  // were last scheduled. The partial tick in which an entity is scheduled does
+  // not count.
+  explicit ExpiryWheel(int timeout_ticks)
+      : slots_(std::max(timeout_ticks, 1) + 1) {}
+
+  // Schedules `entity` to expire, replacing its previous expiry if it was
+  // already scheduled.
+  void Schedule(const Entity& entity);
+
+  // Moves to the next tick and returns the entities that expired.
+  EntitySet Advance();
+
+  size_t Size() const { return entity_slots_.size(); }
+
+ private:
+  // Holds `timeout_ticks` + 1 slots. The slot for the current tick collects
+  // the entities scheduled during it; they expire when the wheel comes back
+  // around to it.
+  std::vector<EntitySet> slots_;
+  absl::flat_hash_map<Entity, size_t> entity_slots_;
+  std::uint64_t current_tick_ = 0;
+};
+
+template <typename Entity>
+void ExpiryWheel<Entity>::Schedule(const Entity& entity) {
+  size_t slot = current_tick_ % slots_.size();
+  auto [it, inserted] = entity_slots_.try_emplace(entity, slot);
+  if (!inserted) {
+    if (it->second == slot) {
+      return;
+    }
+    slots_[it->second].erase(entity);
+    it->second = slot;
+  }
+  slots_[slot].insert(entity);
+}
+
+template <typename Entity>
+typename ExpiryWheel<Entity>::EntitySet ExpiryWheel<Entity>::Advance() {
+  ++current_tick_;
+  EntitySet expired_entities =
+      std::move(slots_[current_tick_ % slots_.size()]);
+  slots_[current_tick_ % slots_.size()] = {};
+  for (const auto& entity : expired_entities) {
+    entity_slots_.erase(entity);
+  }
+  return expired_entities;
+}
+
+}  // namespace mediums
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_MEDIUMS_EXPIRY_WHEEL_H_
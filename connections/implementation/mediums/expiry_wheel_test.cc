@@ -0,0 +1,79 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "connections/implementation/mediums/expiry_wheel.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace nearby {
+namespace connections {
+namespace mediums {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+TEST(ExpiryWheelTest, EntityExpiresAfterTimeoutTicks) {
+  ExpiryWheel<int> expiry_wheel(/*timeout_ticks=*/3);
+
+  expiry_wheel.Schedule(1);
+
+  // The tick in which the entity was scheduled doesn't count.
+  EXPECT_THAT(expiry_wheel.Advance(), IsEmpty());
+  EXPECT_THAT(expiry_wheel.Advance(), IsEmpty());
+  EXPECT_THAT(expiry_wheel.Advance(), IsEmpty());
+  EXPECT_THAT(expiry_wheel.Advance(), UnorderedElementsAre(1));
+  EXPECT_EQ(expiry_wheel.Size(), 0);
+  EXPECT_THAT(expiry_wheel.Advance(), IsEmpty());
+}
+
+TEST(ExpiryWheelTest, RescheduleDelaysExpiry) {
+  ExpiryWheel<int> expiry_wheel(/*timeout_ticks=*/2);
+
+  expiry_wheel.Schedule(1);
+  expiry_wheel.Schedule(2);
+  EXPECT_THAT(expiry_wheel.Advance(), IsEmpty());
+
+  expiry_wheel.Schedule(1);
+  EXPECT_THAT(expiry_wheel.Advance(), IsEmpty());
+  EXPECT_THAT(expiry_wheel.Advance(), UnorderedElementsAre(2));
+  EXPECT_THAT(expiry_wheel.Advance(), UnorderedElementsAre(1));
+}
+
+TEST(ExpiryWheelTest, RescheduleInSameTickKeepsOneEntry) {
+  ExpiryWheel<int> expiry_wheel(/*timeout_ticks=*/1);
+
+  expiry_wheel.Schedule(1);
+  expiry_wheel.Schedule(1);
+
+  EXPECT_EQ(expiry_wheel.Size(), 1);
+  EXPECT_THAT(expiry_wheel.Advance(), IsEmpty());
+  EXPECT_THAT(expiry_wheel.Advance(), UnorderedElementsAre(1));
+}
+
+TEST(ExpiryWheelTest, NonPositiveTimeoutActsAsOneTick) {
+  ExpiryWheel<int> expiry_wheel(/*timeout_ticks=*/0);
+
+  expiry_wheel.Schedule(1);
+
+  EXPECT_THAT(expiry_wheel.Advance(), IsEmpty());
+  EXPECT_THAT(expiry_wheel.Advance(), UnorderedElementsAre(1));
+}
+
+}  // namespace
+}  // namespace mediums
+}  // namespace connections
+}  // namespace nearby
@@ -16,6 +16,7 @@
 #define CORE_INTERNAL_MEDIUMS_LOST_ENTITY_TRACKER_H_
 
 #include "absl/container/flat_hash_set.h"
+#include "connections/implementation/mediums/expiry_wheel.h"
 #include "internal/platform/mutex.h"
 #include "internal/platform/mutex_lock.h"
 
@@ -25,8 +26,8 @@ namespace mediums {
 
 // Tracks "lost" entities based on a manual update/compute model. Used by
 // mediums that only report found devices. Lost entities are computed based off
-// of whether a specific entity was rediscovered since the last call to
-// ComputeLostEntities.
+// of whether a specific entity was rediscovered in the last rounds, where a
+// round ends with each call to ComputeLostEntities.
 //
 // Note: Entity must overload the < and == operators.
 template <typename Entity>
@@ -34,38 +35,34 @@ class LostEntityTracker {
  public:
   using EntitySet = absl::flat_hash_set<Entity>;
 
-  LostEntityTracker();
-  ~LostEntityTracker();
+  // An entity is lost once `lost_after_rounds` full rounds pass without it
+  // being found. Mediums that call ComputeLostEntities more often than their
+  // lost timeout use this to keep the timeout while reporting losses sooner.
+  explicit LostEntityTracker(int lost_after_rounds = 1);
 
   // Records the given entity as being recently found, whether or not this is
   // our first time discovering the entity.
   void RecordFoundEntity(const Entity& entity) ABSL_LOCKS_EXCLUDED(mutex_);
 
-  // Computes and returns the set of entities considered lost since the last
-  // time this method was called.
+  // Ends the current round and returns the set of entities that became lost.
+  // This only looks at the entities that became lost, not at every tracked
+  // entity.
   EntitySet ComputeLostEntities() ABSL_LOCKS_EXCLUDED(mutex_);
 
  private:
   Mutex mutex_;
-  EntitySet current_entities_ ABSL_GUARDED_BY(mutex_);
-  EntitySet previously_found_entities_ ABSL_GUARDED_BY(mutex_);
+  ExpiryWheel<Entity> expiry_wheel_ ABSL_GUARDED_BY(mutex_);
 };
 
 template <typename Entity>
-LostEntityTracker<Entity>::LostEntityTracker()
-    : current_entities_{}, previously_found_entities_{} {}
-
-template <typename Entity>
-LostEntityTracker<Entity>::~LostEntityTracker() {
-  previously_found_entities_.clear();
-  current_entities_.clear();
-}
+LostEntityTracker<Entity>::LostEntityTracker(int lost_after_rounds)
+    : expiry_wheel_(lost_after_rounds) {}
 
 template <typename Entity>
 void LostEntityTracker<Entity>::RecordFoundEntity(const Entity& entity) {
   MutexLock lock(&mutex_);
 
-  current_entities_.insert(entity);
+  expiry_wheel_.Schedule(entity);
 }
 
 template <typename Entity>
@@ -73,16 +70,7 @@ typename LostEntityTracker<Entity>::EntitySet
 LostEntityTracker<Entity>::ComputeLostEntities() {
   MutexLock lock(&mutex_);
 
-  // The set of lost entities is the previously found set MINUS the currently
-  // found set.
-  for (const auto& item : current_entities_) {
-    previously_found_entities_.erase(item);
-  }
-  auto lost_entities = std::move(previously_found_entities_);
-  previously_found_entities_ = std::move(current_entities_);
-  current_entities_ = {};
-
-  return lost_entities;
+  return expiry_wheel_.Advance();
 }
 
 }  // namespace mediums
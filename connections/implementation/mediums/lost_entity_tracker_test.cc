@@ -129,6 +129,31 @@ TEST(LostEntityTrackerTest, SameEntityMultipleCopies) {
   EXPECT_TRUE(lost_entities.find(entity_1_copy) != lost_entities.end());
 }
 
+TEST(LostEntityTrackerTest, EntityLostAfterConfiguredRounds) {
+  LostEntityTracker<TestEntity> lost_entity_tracker(/*lost_after_rounds=*/3);
+  TestEntity entity_1{1};
+  TestEntity entity_2{2};
+
+  // Discover some entities.
+  lost_entity_tracker.RecordFoundEntity(entity_1);
+  lost_entity_tracker.RecordFoundEntity(entity_2);
+  EXPECT_TRUE(lost_entity_tracker.ComputeLostEntities().empty());
+
+  // Only rediscover one of them, and verify that the other is kept until three
+  // full rounds have passed without it.
+  lost_entity_tracker.RecordFoundEntity(entity_1);
+  EXPECT_TRUE(lost_entity_tracker.ComputeLostEntities().empty());
+  EXPECT_TRUE(lost_entity_tracker.ComputeLostEntities().empty());
+  typename LostEntityTracker<TestEntity>::EntitySet lost_entities =
+      lost_entity_tracker.ComputeLostEntities();
+  EXPECT_EQ(lost_entities.size(), 1);
+  EXPECT_TRUE(lost_entities.find(entity_2) != lost_entities.end());
+
+  lost_entities = lost_entity_tracker.ComputeLostEntities();
+  EXPECT_EQ(lost_entities.size(), 1);
+  EXPECT_TRUE(lost_entities.find(entity_1) != lost_entities.end());
+}
+
 }  // namespace
 }  // namespace mediums
 }  // namespace connections
@@ -14,26 +14,90 @@
 
 #include "connections/implementation/mediums/mediums.h"
 
+#include <memory>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "internal/platform/logging.h"
+#include "internal/platform/mutex_lock.h"
+#include "internal/platform/system_clock.h"
+
 namespace nearby {
 namespace connections {
 
-BluetoothRadio& Mediums::GetBluetoothRadio() { return bluetooth_radio_; }
+Mediums::~Mediums() {
+  MutexLock lock(&mutex_);
+  webrtc_.reset();
+  wifi_direct_.reset();
+  wifi_hotspot_.reset();
+  wifi_lan_.reset();
+  wifi_.reset();
+  ble_v2_.reset();
+  ble_.reset();
+  bluetooth_classic_.reset();
+  bluetooth_radio_.reset();
+}
+
+template <typename T, typename... Args>
+T& Mediums::GetOrCreateLocked(std::unique_ptr<T>& medium,
+                              absl::string_view name, Args&... args) {
+  if (medium == nullptr) {
+    absl::Time start_time = SystemClock::ElapsedRealtime();
+    medium = std::make_unique<T>(args...);
+    NEARBY_LOGS(INFO) << "Initialized " << name << " in "
+                      << absl::FormatDuration(SystemClock::ElapsedRealtime() -
+                                              start_time);
+  }
+  return *medium;
+}
+
+BluetoothRadio& Mediums::GetBluetoothRadio() {
+  MutexLock lock(&mutex_);
+  return GetOrCreateLocked(bluetooth_radio_, "Bluetooth radio");
+}
 
-BluetoothClassic& Mediums::GetBluetoothClassic() { return bluetooth_classic_; }
+BluetoothClassic& Mediums::GetBluetoothClassic() {
+  BluetoothRadio& radio = GetBluetoothRadio();
+  MutexLock lock(&mutex_);
+  return GetOrCreateLocked(bluetooth_classic_, "Bluetooth Classic", radio);
+}
 
-Ble& Mediums::GetBle() { return ble_; }
+Ble& Mediums::GetBle() {
+  BluetoothRadio& radio = GetBluetoothRadio();
+  MutexLock lock(&mutex_);
+  return GetOrCreateLocked(ble_, "BLE", radio);
+}
 
-BleV2& Mediums::GetBleV2() { return ble_v2_; }
+BleV2& Mediums::GetBleV2() {
+  BluetoothRadio& radio = GetBluetoothRadio();
+  MutexLock lock(&mutex_);
+  return GetOrCreateLocked(ble_v2_, "BLE v2", radio);
+}
 
-Wifi& Mediums::GetWifi() { return wifi_; }
+Wifi& Mediums::GetWifi() {
+  MutexLock lock(&mutex_);
+  return GetOrCreateLocked(wifi_, "Wifi");
+}
 
-WifiLan& Mediums::GetWifiLan() { return wifi_lan_; }
+WifiLan& Mediums::GetWifiLan() {
+  MutexLock lock(&mutex_);
+  return GetOrCreateLocked(wifi_lan_, "Wifi-Lan");
+}
 
-WifiHotspot& Mediums::GetWifiHotspot() { return wifi_hotspot_; }
+WifiHotspot& Mediums::GetWifiHotspot() {
+  MutexLock lock(&mutex_);
+  return GetOrCreateLocked(wifi_hotspot_, "Wifi-Hotspot");
+}
 
-WifiDirect& Mediums::GetWifiDirect() { return wifi_direct_; }
+WifiDirect& Mediums::GetWifiDirect() {
+  MutexLock lock(&mutex_);
+  return GetOrCreateLocked(wifi_direct_, "Wifi-Direct");
+}
 
-mediums::WebRtc& Mediums::GetWebRtc() { return webrtc_; }
+mediums::WebRtc& Mediums::GetWebRtc() {
+  MutexLock lock(&mutex_);
+  return GetOrCreateLocked(webrtc_, "WebRtc");
+}
 
 }  // namespace connections
 }  // namespace nearby
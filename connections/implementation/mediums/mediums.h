@@ -15,6 +15,10 @@
 #ifndef CORE_INTERNAL_MEDIUMS_MEDIUMS_H_
 #define CORE_INTERNAL_MEDIUMS_MEDIUMS_H_
 
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
 #include "connections/implementation/mediums/ble.h"
 #include "connections/implementation/mediums/ble_v2.h"
 #include "connections/implementation/mediums/bluetooth_classic.h"
@@ -28,15 +32,22 @@
 #include "connections/implementation/mediums/wifi_hotspot.h"
 #include "connections/implementation/mediums/wifi_direct.h"
 #include "connections/implementation/mediums/wifi_lan.h"
+#include "internal/platform/mutex.h"
 
 namespace nearby {
 namespace connections {
 
 // Facilitates convenient and reliable usage of various wireless mediums.
+//
+// Each medium is initialized the first time it's asked for, since creating
+// the platform objects behind it can take a while, and most clients only ever
+// use a few of them. How long that took is logged. Users look their mediums
+// up here each time they need them, instead of holding on to them from their
+// constructor, so that no medium is initialized before it's used.
 class Mediums {
  public:
   Mediums() = default;
-  ~Mediums() = default;
+  ~Mediums();
 
   // Returns a handle to the Bluetooth radio.
   BluetoothRadio& GetBluetoothRadio();
@@ -66,23 +77,24 @@ class Mediums {
   mediums::WebRtc& GetWebRtc();
 
  private:
-  // The order of declaration is critical for both construction and
-  // destruction.
-  //
-  // 1) Construction: The individual mediums have a dependency on the
-  // corresponding radio, so the radio must be initialized first.
-  //
-  // 2) Destruction: The individual mediums should be shut down before the
-  // corresponding radio.
-  BluetoothRadio bluetooth_radio_;
-  BluetoothClassic bluetooth_classic_{bluetooth_radio_};
-  Ble ble_{bluetooth_radio_};
-  BleV2 ble_v2_{bluetooth_radio_};
-  Wifi wifi_;
-  WifiLan wifi_lan_;
-  WifiHotspot wifi_hotspot_;
-  WifiDirect wifi_direct_;
-  mediums::WebRtc webrtc_;
+  // Returns |medium|, constructing it from |args| first if needed.
+  template <typename T, typename... Args>
+  T& GetOrCreateLocked(std::unique_ptr<T>& medium, absl::string_view name,
+                       Args&... args) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  Mutex mutex_;
+  // The individual mediums have a dependency on the corresponding radio, so
+  // the radio must be initialized first, and the mediums must be shut down
+  // before it. The destructor resets them in the reverse order of declaration.
+  std::unique_ptr<BluetoothRadio> bluetooth_radio_ ABSL_GUARDED_BY(mutex_);
+  std::unique_ptr<BluetoothClassic> bluetooth_classic_ ABSL_GUARDED_BY(mutex_);
+  std::unique_ptr<Ble> ble_ ABSL_GUARDED_BY(mutex_);
+  std::unique_ptr<BleV2> ble_v2_ ABSL_GUARDED_BY(mutex_);
+  std::unique_ptr<Wifi> wifi_ ABSL_GUARDED_BY(mutex_);
+  std::unique_ptr<WifiLan> wifi_lan_ ABSL_GUARDED_BY(mutex_);
+  std::unique_ptr<WifiHotspot> wifi_hotspot_ ABSL_GUARDED_BY(mutex_);
+  std::unique_ptr<WifiDirect> wifi_direct_ ABSL_GUARDED_BY(mutex_);
+  std::unique_ptr<mediums::WebRtc> webrtc_ ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace connections
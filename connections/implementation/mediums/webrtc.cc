@@ -140,6 +140,11 @@ bool WebRtc::StartAcceptingConnections(const std::string& service_id,
   NEARBY_LOG(INFO,
              "Started listening for WebRTC connections as %s on service %s",
              self_peer_id.GetId().c_str(), service_id.c_str());
+
+  // Create the peer connection for the first incoming connection now, so that
+  // its poke is answered without waiting for one.
+  OffloadFromThread("rtc-warm-connection-flow",
+                    [this, service_id]() { WarmConnectionFlow(service_id); });
   return true;
 }
 
@@ -260,18 +265,6 @@ WebRtcSocketWrapper WebRtc::AttemptToConnect(
       return WebRtcSocketWrapper();
     }
 
-    // Create a new ConnectionFlow for this connection attempt.
-    std::unique_ptr<ConnectionFlow> connection_flow =
-        CreateConnectionFlow(service_id, remote_peer_id);
-    if (!connection_flow) {
-      NEARBY_LOG(
-          INFO,
-          "Cannot connect to WebRTC peer %s because we failed to create a "
-          "ConnectionFlow.",
-          remote_peer_id.GetId().c_str());
-      return WebRtcSocketWrapper();
-    }
-
     // Create a new SignalingMessenger so that we can communicate over Tachyon.
     info.signaling_messenger = medium_->GetSignalingMessenger(
         info.self_peer_id.GetId(), location_hint);
@@ -314,6 +307,21 @@ WebRtcSocketWrapper WebRtc::AttemptToConnect(
       return WebRtcSocketWrapper();
     }
 
+    // Create a new ConnectionFlow for this connection attempt while the remote
+    // device creates its Offer. The Offer is only processed once we release
+    // the mutex, so the ConnectionFlow is in place by then.
+    std::unique_ptr<ConnectionFlow> connection_flow =
+        CreateConnectionFlow(service_id, remote_peer_id);
+    if (!connection_flow) {
+      NEARBY_LOG(
+          INFO,
+          "Cannot connect to WebRTC peer %s because we failed to create a "
+          "ConnectionFlow.",
+          remote_peer_id.GetId().c_str());
+      info.signaling_messenger.reset();
+      return WebRtcSocketWrapper();
+    }
+
     // Create a new ConnectionRequest entry. This map will be used later to look
     // up state as we negotiate the connection over Tachyon.
     requesting_connections_info_.emplace(remote_peer_id.GetId(),
@@ -494,8 +502,22 @@ void WebRtc::ProcessTachyonInboxMessage(const std::string& service_id,
 
 void WebRtc::SendOffer(const std::string& service_id,
                        const WebrtcPeerId& remote_peer_id) {
-  std::unique_ptr<ConnectionFlow> connection_flow =
-      CreateConnectionFlow(service_id, remote_peer_id);
+  // Grab our info from the map.
+  auto& info = accepting_connections_info_.find(service_id)->second;
+
+  // Use the warm ConnectionFlow if it's ready, and get another one ready for
+  // the next connection.
+  std::unique_ptr<ConnectionFlow> connection_flow;
+  if (info.warm_connection_flow) {
+    RemoveConnectionFlow(remote_peer_id);
+    *info.warm_remote_peer_id = remote_peer_id;
+    info.warm_remote_peer_id.reset();
+    connection_flow = std::move(info.warm_connection_flow);
+  } else {
+    connection_flow = CreateConnectionFlow(service_id, remote_peer_id);
+  }
+  OffloadFromThread("rtc-warm-connection-flow",
+                    [this, service_id]() { WarmConnectionFlow(service_id); });
   if (!connection_flow) {
     NEARBY_LOG(INFO,
                "Unable to send offer. Failed to create a ConnectionFlow.");
@@ -518,9 +540,6 @@ void WebRtc::SendOffer(const std::string& service_id,
     return;
   }
 
-  // Grab our info from the map.
-  auto& info = accepting_connections_info_.find(service_id)->second;
-
   // Pass the offer to the remote side.
   if (!info.signaling_messenger->SendMessage(
           remote_peer_id.GetId(),
@@ -715,6 +734,13 @@ std::unique_ptr<ConnectionFlow> WebRtc::CreateConnectionFlow(
     const std::string& service_id, const WebrtcPeerId& remote_peer_id) {
   RemoveConnectionFlow(remote_peer_id);
 
+  return CreateConnectionFlow(
+      service_id, std::make_shared<const WebrtcPeerId>(remote_peer_id));
+}
+
+std::unique_ptr<ConnectionFlow> WebRtc::CreateConnectionFlow(
+    const std::string& service_id,
+    std::shared_ptr<const WebrtcPeerId> remote_peer_id) {
   return ConnectionFlow::Create(
       {.local_ice_candidate_found_cb =
            {[this, service_id, remote_peer_id](
@@ -727,7 +753,7 @@ std::unique_ptr<ConnectionFlow> WebRtc::CreateConnectionFlow(
              OffloadFromThread(
                  "rtc-ice-candidates",
                  [this, service_id, remote_peer_id, encoded_ice_candidate]() {
-                   ProcessLocalIceCandidate(service_id, remote_peer_id,
+                   ProcessLocalIceCandidate(service_id, *remote_peer_id,
                                             encoded_ice_candidate);
                  });
            }}},
@@ -737,19 +763,50 @@ std::unique_ptr<ConnectionFlow> WebRtc::CreateConnectionFlow(
             OffloadFromThread(
                 "rtc-channel-created",
                 [this, service_id, remote_peer_id, socket_wrapper]() {
-                  ProcessDataChannelOpen(service_id, remote_peer_id,
+                  ProcessDataChannelOpen(service_id, *remote_peer_id,
                                          socket_wrapper);
                 });
           }},
           .data_channel_closed_cb = {[this, remote_peer_id]() {
             OffloadFromThread("rtc-channel-closed", [this, remote_peer_id]() {
-              ProcessDataChannelClosed(remote_peer_id);
+              ProcessDataChannelClosed(*remote_peer_id);
             });
           }},
       },
       *medium_);
 }
 
+void WebRtc::WarmConnectionFlow(const std::string& service_id) {
+  {
+    MutexLock lock(&mutex_);
+    const auto& entry = accepting_connections_info_.find(service_id);
+    if (entry == accepting_connections_info_.end() ||
+        entry->second.warm_connection_flow) {
+      return;
+    }
+  }
+
+  // Creating the peer connection may block for a while, so don't hold the
+  // mutex meanwhile.
+  auto remote_peer_id = std::make_shared<WebrtcPeerId>();
+  std::unique_ptr<ConnectionFlow> connection_flow =
+      CreateConnectionFlow(service_id, remote_peer_id);
+  if (!connection_flow) {
+    NEARBY_LOG(INFO, "Failed to create a warm ConnectionFlow for service %s.",
+               service_id.c_str());
+    return;
+  }
+
+  MutexLock lock(&mutex_);
+  const auto& entry = accepting_connections_info_.find(service_id);
+  if (entry == accepting_connections_info_.end() ||
+      entry->second.warm_connection_flow) {
+    return;
+  }
+  entry->second.warm_connection_flow = std::move(connection_flow);
+  entry->second.warm_remote_peer_id = std::move(remote_peer_id);
+}
+
 void WebRtc::RemoveConnectionFlow(const WebrtcPeerId& remote_peer_id) {
   if (!connection_flows_.erase(remote_peer_id.GetId())) {
     return;
@@ -128,6 +128,12 @@ class WebRtc {
     // failure. We limit the number to prevent endless restarts if we are
     // repeatedly unable to communicate with Tachyon.
     int restart_accept_connections_count = 0;
+
+    // A ConnectionFlow created ahead of the next incoming connection, so that
+    // answering its poke doesn't wait for a new peer connection to be created.
+    // |warm_remote_peer_id| is filled in once the flow is handed to a peer.
+    std::unique_ptr<ConnectionFlow> warm_connection_flow;
+    std::shared_ptr<WebrtcPeerId> warm_remote_peer_id;
   };
 
   struct ConnectionRequestInfo {
@@ -198,6 +204,18 @@ class WebRtc {
       const std::string& service_id, const WebrtcPeerId& remote_peer_id)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Creates a ConnectionFlow whose callbacks report to whichever peer
+  // |remote_peer_id| holds by the time they run.
+  std::unique_ptr<ConnectionFlow> CreateConnectionFlow(
+      const std::string& service_id,
+      std::shared_ptr<const WebrtcPeerId> remote_peer_id);
+
+  // Creates the warm ConnectionFlow of |service_id|, if it is still accepting
+  // connections and doesn't have one.
+  // Runs on |single_thread_executor_|.
+  void WarmConnectionFlow(const std::string& service_id)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
   // Runs on |single_thread_executor_|.
   std::unique_ptr<ConnectionFlow> GetConnectionFlow(
       const WebrtcPeerId& remote_peer_id) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
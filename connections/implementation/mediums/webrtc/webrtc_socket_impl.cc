@@ -16,6 +16,11 @@
 
 #include "connections/implementation/mediums/webrtc/webrtc_socket_impl.h"
 
+#include <algorithm>
+#include <cstdint>
+
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/logging.h"
 #include "internal/platform/mutex_lock.h"
 
@@ -58,7 +63,13 @@ Exception WebRtcSocket::OutputStreamImpl::Close() {
 WebRtcSocket::WebRtcSocket(
     const std::string& name,
     rtc::scoped_refptr<webrtc::DataChannelInterface> data_channel)
-    : name_(name), data_channel_(std::move(data_channel)) {
+    : name_(name),
+      data_channel_(std::move(data_channel)),
+      max_buffered_amount_(static_cast<uint64_t>(std::max<int64_t>(
+          NearbyFlags::GetInstance().GetInt64Flag(
+              config_package_nearby::nearby_connections_feature::
+                  kWebRtcMaxBufferedAmountBytes),
+          kMaxDataSize))) {
   NEARBY_LOGS(INFO) << "WebRtcSocket::WebRtcSocket(" << name_
                     << ") this: " << this;
   data_channel_->RegisterObserver(this);
@@ -142,7 +153,10 @@ void WebRtcSocket::OnMessage(const webrtc::DataBuffer& buffer) {
 
 void WebRtcSocket::OnBufferedAmountChange(uint64_t sent_data_size) {
   // This is a data channel callback on the signaling thread, lets off load so
-  // we don't block signaling.
+  // we don't block signaling. Waking the writer on every sent message would
+  // cost a thread hop per message, so hold off until the buffer has drained
+  // far enough to take a full batch of writes again.
+  if (data_channel_->buffered_amount() > max_buffered_amount_ / 2) return;
   OffloadFromSignalingThread([this] { WakeUpWriter(); });
 }
 
@@ -179,7 +193,7 @@ void WebRtcSocket::SetSocketListener(SocketListener&& listener) {
 void WebRtcSocket::BlockUntilSufficientSpaceInBuffer(int length) {
   MutexLock lock(&backpressure_mutex_);
   while (!IsClosed() &&
-         (data_channel_->buffered_amount() + length > kMaxDataSize)) {
+         (data_channel_->buffered_amount() + length > max_buffered_amount_)) {
     // TODO(himanshujaju): Add wait with timeout.
     buffer_variable_.Wait();
   }
@@ -17,6 +17,7 @@
 
 #ifndef NO_WEBRTC
 
+#include <cstdint>
 #include <memory>
 
 #include "connections/listeners.h"
@@ -108,6 +109,10 @@ class WebRtcSocket : public Socket, public webrtc::DataChannelObserver {
 
   SocketListener socket_listener_;
 
+  // Writers block once the data channel has more than this queued, and are
+  // woken by OnBufferedAmountChange() once it drained to half of it.
+  const uint64_t max_buffered_amount_;
+
   mutable Mutex backpressure_mutex_;
   ConditionVariable buffer_variable_{&backpressure_mutex_};
 
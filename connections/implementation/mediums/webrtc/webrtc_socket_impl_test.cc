@@ -19,6 +19,8 @@
 #include "gmock/gmock.h"
 #include "protobuf-matchers/protocol-buffer-matchers.h"
 #include "gtest/gtest.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
 #include "webrtc/api/data_channel_interface.h"
 
@@ -102,6 +104,24 @@ TEST(WebRtcSocketTest, WriteToSocket) {
   EXPECT_TRUE(webrtc_socket.GetOutputStream().Write(kMessage).Ok());
 }
 
+TEST(WebRtcSocketTest, WriteFitsInConfiguredBufferedAmount) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kWebRtcMaxBufferedAmountBytes,
+      4 * kMaxDataSize);
+  const ByteArray kMessage{kMaxDataSize};
+  rtc::scoped_refptr<MockDataChannel> mock_data_channel(new MockDataChannel());
+  WebRtcSocket webrtc_socket(kSocketName, mock_data_channel);
+
+  // Would block with the default limit of a single message.
+  ON_CALL(*mock_data_channel, buffered_amount())
+      .WillByDefault(testing::Return(2 * kMaxDataSize));
+  EXPECT_CALL(*mock_data_channel, Send(testing::_))
+      .WillOnce(testing::Return(true));
+  EXPECT_TRUE(webrtc_socket.GetOutputStream().Write(kMessage).Ok());
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 TEST(WebRtcSocketTest, SendDataBiggerThanMax) {
   const ByteArray kMessage{kMaxDataSize + 1};
   rtc::scoped_refptr<MockDataChannel> mock_data_channel(new MockDataChannel());
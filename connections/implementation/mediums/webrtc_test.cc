@@ -21,7 +21,9 @@
 #include "gmock/gmock.h"
 #include "protobuf-matchers/protocol-buffer-matchers.h"
 #include "gtest/gtest.h"
+#include "absl/time/time.h"
 #include "connections/implementation/mediums/webrtc_socket.h"
+#include "internal/platform/count_down_latch.h"
 #include "internal/platform/listeners.h"
 #include "internal/platform/medium_environment.h"
 #include "internal/platform/mutex_lock.h"
@@ -367,6 +369,38 @@ TEST_F(WebRtcTest, ConnectBothDevicesAndSendData) {
   env_.Stop();
 }
 
+// Tests that each incoming connection gets a ConnectionFlow, whether or not a
+// warm one was ready for it.
+TEST_F(WebRtcTest, AcceptConsecutiveConnections) {
+  env_.Start({.webrtc_enabled = true});
+  WebRtc receiver, first_sender, second_sender;
+  const WebrtcPeerId self_id("self_id");
+  const std::string service_id("NearbySharing");
+  LocationHint location_hint;
+  CountDownLatch accepted_latch(2);
+
+  ASSERT_TRUE(receiver.StartAcceptingConnections(
+      service_id, self_id, location_hint,
+      {[&accepted_latch](const std::string& service_id,
+                         WebRtcSocketWrapper wrapper) {
+        if (wrapper.IsValid()) accepted_latch.CountDown();
+      }}));
+
+  CancellationFlag flag;
+  WebRtcSocketWrapper first_socket =
+      first_sender.Connect(service_id, self_id, location_hint, &flag);
+  EXPECT_TRUE(first_socket.IsValid());
+  WebRtcSocketWrapper second_socket =
+      second_sender.Connect(service_id, self_id, location_hint, &flag);
+  EXPECT_TRUE(second_socket.IsValid());
+  EXPECT_TRUE(accepted_latch.Await(absl::Seconds(5)).result());
+
+  first_socket.Close();
+  second_socket.Close();
+  receiver.StopAcceptingConnections(service_id);
+  env_.Stop();
+}
+
 TEST_F(WebRtcTest, Connect_NullPeerConnection) {
   env_.Start({.webrtc_enabled = true});
   testing::StrictMock<MockAcceptedCallback> mock_accepted_callback_;
@@ -14,15 +14,24 @@
 
 #include "connections/implementation/mediums/wifi_direct.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
 
+#include "absl/time/time.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "internal/flags/nearby_flags.h"
+#include "internal/platform/cancelable_alarm.h"
 #include "internal/platform/logging.h"
 
 namespace nearby {
 namespace connections {
 
 WifiDirect::~WifiDirect() {
+  // Released groups and connections are stopped right away below.
+  release_executor_.Shutdown();
   while (!server_sockets_.empty()) {
     StopAcceptingConnections(server_sockets_.begin()->first);
   }
@@ -64,6 +73,10 @@ bool WifiDirect::IsGOStarted() {
 // connect
 bool WifiDirect::StartWifiDirect() {
   MutexLock lock(&mutex_);
+  if (stop_go_alarm_ != nullptr) {
+    stop_go_alarm_->Cancel();
+    stop_go_alarm_.reset();
+  }
   if (is_go_started_) {
     NEARBY_LOGS(INFO) << "No need to start GO because it is already started.";
     return true;
@@ -74,6 +87,45 @@ bool WifiDirect::StartWifiDirect() {
 
 bool WifiDirect::StopWifiDirect() {
   MutexLock lock(&mutex_);
+  if (stop_go_alarm_ != nullptr) {
+    stop_go_alarm_->Cancel();
+    stop_go_alarm_.reset();
+  }
+  return StopWifiDirectLocked();
+}
+
+bool WifiDirect::ReleaseWifiDirect() {
+  MutexLock lock(&mutex_);
+  if (!is_go_started_ || stop_go_alarm_ != nullptr) return true;
+  if (!server_sockets_.empty()) {
+    NEARBY_LOGS(INFO) << "Keeping GO started for the other "
+                      << server_sockets_.size() << " services using it.";
+    return true;
+  }
+  absl::Duration persistent_group_time = GetPersistentGroupTime();
+  if (persistent_group_time == absl::ZeroDuration()) {
+    return StopWifiDirectLocked();
+  }
+  NEARBY_LOGS(INFO) << "Keeping GO started for " << persistent_group_time
+                    << " to reuse its group.";
+  std::int64_t release_id = ++go_release_id_;
+  stop_go_alarm_ = std::make_unique<CancelableAlarm>(
+      "stop_wifi_direct_go",
+      [this, release_id]() { OnGoReleaseTimeout(release_id); },
+      persistent_group_time, &release_executor_);
+  return true;
+}
+
+void WifiDirect::OnGoReleaseTimeout(std::int64_t release_id) {
+  MutexLock lock(&mutex_);
+  // The group was started again, or released again since.
+  if (stop_go_alarm_ == nullptr || release_id != go_release_id_) return;
+  stop_go_alarm_.reset();
+  if (!server_sockets_.empty()) return;
+  StopWifiDirectLocked();
+}
+
+bool WifiDirect::StopWifiDirectLocked() {
   if (!is_go_started_) {
     NEARBY_LOGS(INFO) << "No need to stop GO because it is not started.";
     return true;
@@ -92,26 +144,79 @@ bool WifiDirect::IsConnectedToGO() {
 bool WifiDirect::ConnectWifiDirect(const std::string& ssid,
                                    const std::string& password) {
   MutexLock lock(&mutex_);
+  if (disconnect_alarm_ != nullptr) {
+    disconnect_alarm_->Cancel();
+    disconnect_alarm_.reset();
+  }
   if (is_connected_to_go_) {
-    NEARBY_LOGS(INFO)
-        << "No need to connect to GO because it is already connected.";
-    return true;
+    if (connected_ssid_ == ssid) {
+      NEARBY_LOGS(INFO)
+          << "No need to connect to GO because it is already connected.";
+      return true;
+    }
+    NEARBY_LOGS(INFO) << "Leaving group " << connected_ssid_
+                      << " to connect to GO " << ssid;
+    DisconnectWifiDirectLocked();
   }
   is_connected_to_go_ = medium_.ConnectWifiDirect(ssid, password);
+  if (is_connected_to_go_) connected_ssid_ = ssid;
   return is_connected_to_go_;
 }
 
 bool WifiDirect::DisconnectWifiDirect() {
   MutexLock lock(&mutex_);
+  if (disconnect_alarm_ != nullptr) {
+    disconnect_alarm_->Cancel();
+    disconnect_alarm_.reset();
+  }
+  return DisconnectWifiDirectLocked();
+}
+
+bool WifiDirect::ReleaseConnectionToGO() {
+  MutexLock lock(&mutex_);
+  if (!is_connected_to_go_ || disconnect_alarm_ != nullptr) return true;
+  absl::Duration persistent_group_time = GetPersistentGroupTime();
+  if (persistent_group_time == absl::ZeroDuration()) {
+    return DisconnectWifiDirectLocked();
+  }
+  NEARBY_LOGS(INFO) << "Keeping the connection to GO " << connected_ssid_
+                    << " for " << persistent_group_time << " to reuse it.";
+  std::int64_t release_id = ++connection_release_id_;
+  disconnect_alarm_ = std::make_unique<CancelableAlarm>(
+      "disconnect_wifi_direct_gc",
+      [this, release_id]() { OnConnectionReleaseTimeout(release_id); },
+      persistent_group_time, &release_executor_);
+  return true;
+}
+
+void WifiDirect::OnConnectionReleaseTimeout(std::int64_t release_id) {
+  MutexLock lock(&mutex_);
+  // The connection was reused, or released again since.
+  if (disconnect_alarm_ == nullptr || release_id != connection_release_id_) {
+    return;
+  }
+  disconnect_alarm_.reset();
+  DisconnectWifiDirectLocked();
+}
+
+bool WifiDirect::DisconnectWifiDirectLocked() {
   if (!is_connected_to_go_) {
     NEARBY_LOGS(INFO)
         << "No need to disconnect to GO because it is not connected.";
     return true;
   }
   is_connected_to_go_ = false;
+  connected_ssid_.clear();
   return medium_.DisconnectWifiDirect();
 }
 
+absl::Duration WifiDirect::GetPersistentGroupTime() {
+  return absl::Milliseconds(std::max<std::int64_t>(
+      0, NearbyFlags::GetInstance().GetInt64Flag(
+             config_package_nearby::nearby_connections_feature::
+                 kWifiDirectPersistentGroupTimeMillis)));
+}
+
 WifiDirectCredentials* WifiDirect::GetCredentials(
     absl::string_view service_id) {
   MutexLock lock(&mutex_);
@@ -17,15 +17,24 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
 
+#include "absl/time/time.h"
+#include "internal/platform/cancelable_alarm.h"
 #include "internal/platform/multi_thread_executor.h"
 #include "internal/platform/mutex.h"
+#include "internal/platform/scheduled_executor.h"
 #include "internal/platform/wifi_direct.h"
 
 namespace nearby {
 namespace connections {
 
+// Forming a WifiDirect group dominates the time a bandwidth upgrade takes, so
+// the group is shared by all the services upgrading to it, and, in persistent
+// group mode, kept for a while once the last of them is done with it. A repeat
+// peer upgrading again then reuses the group and its credentials, as does the
+// Group Client side with its connection to the Group Owner.
 class WifiDirect {
  public:
   // Callback that is invoked when a new connection is accepted.
@@ -54,14 +63,28 @@ class WifiDirect {
   bool StartWifiDirect() ABSL_LOCKS_EXCLUDED(mutex_);
   // Stop WifiDirect Group Owner
   bool StopWifiDirect() ABSL_LOCKS_EXCLUDED(mutex_);
+  // Stops the Group Owner once no service accepts connections on it anymore.
+  // In persistent group mode, it is only stopped after GetPersistentGroupTime()
+  // unless StartWifiDirect() is called again in the meantime.
+  bool ReleaseWifiDirect() ABSL_LOCKS_EXCLUDED(mutex_);
 
   // If WifiDirect Group Client connects to Group Owner
   bool IsConnectedToGO() ABSL_LOCKS_EXCLUDED(mutex_);
-  // WifiDirect Group Client request to connect to the Group Owner
+  // WifiDirect Group Client request to connect to the Group Owner. Reuses the
+  // connection if already connected to the group |ssid|, and leaves any other
+  // group first.
   bool ConnectWifiDirect(const std::string& ssid, const std::string& password)
       ABSL_LOCKS_EXCLUDED(mutex_);
   // WifiDirect Group Client request to disconnect from the Group Owner
   bool DisconnectWifiDirect() ABSL_LOCKS_EXCLUDED(mutex_);
+  // Disconnects from the Group Owner. In persistent group mode, only after
+  // GetPersistentGroupTime() unless ConnectWifiDirect() reuses the connection
+  // in the meantime.
+  bool ReleaseConnectionToGO() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // How long a group is kept once released. Zero outside of persistent group
+  // mode.
+  static absl::Duration GetPersistentGroupTime();
 
   // Starts a worker thread, creates a WifiDirect socket, associates it with a
   // service id.
@@ -101,15 +124,32 @@ class WifiDirect {
   // Same as IsAcceptingConnections(), but must be called with mutex_ held.
   bool IsAcceptingConnectionsLocked(const std::string& service_id)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  bool StopWifiDirectLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  bool DisconnectWifiDirectLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Called once a released group or connection has been kept long enough.
+  // |release_id| tells apart the releases of the same group or connection.
+  void OnGoReleaseTimeout(std::int64_t release_id) ABSL_LOCKS_EXCLUDED(mutex_);
+  void OnConnectionReleaseTimeout(std::int64_t release_id)
+      ABSL_LOCKS_EXCLUDED(mutex_);
 
   bool is_go_started_ ABSL_GUARDED_BY(mutex_);
   bool is_connected_to_go_ ABSL_GUARDED_BY(mutex_);
+  // The group the Group Client is connected to.
+  std::string connected_ssid_ ABSL_GUARDED_BY(mutex_);
+  // Set while a released group or connection is kept.
+  std::unique_ptr<CancelableAlarm> stop_go_alarm_ ABSL_GUARDED_BY(mutex_);
+  std::unique_ptr<CancelableAlarm> disconnect_alarm_ ABSL_GUARDED_BY(mutex_);
+  std::int64_t go_release_id_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::int64_t connection_release_id_ ABSL_GUARDED_BY(mutex_) = 0;
   WifiDirectMedium medium_ ABSL_GUARDED_BY(mutex_);
 
   // A thread pool dedicated to running all the accept loops from
   // StartAcceptingConnections().
   MultiThreadExecutor accept_loops_runner_{kMaxConcurrentAcceptLoops};
 
+  // Runs the alarms stopping released groups and connections.
+  ScheduledExecutor release_executor_;
+
   // A map of service_id -> ServerSocket. If map is non-empty, we are currently
   // listening for incoming connections. WifiDirectServerSocket instances are
   // used from accept_loops_runner_, and thus require pointer stability.
@@ -18,6 +18,10 @@
 #include <string>
 
 #include "gtest/gtest.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/medium_environment.h"
 #include "internal/platform/wifi_direct.h"
 
@@ -180,6 +184,58 @@ TEST_F(WifiDirectTest, CanStartGOTheOtherFailConnect) {
   EXPECT_TRUE(wifi_direct_a.StopWifiDirect());
 }
 
+TEST_F(WifiDirectTest, ReleaseKeepsGOForOtherServices) {
+  WifiDirect wifi_direct_a;
+
+  EXPECT_TRUE(wifi_direct_a.StartWifiDirect());
+  EXPECT_TRUE(wifi_direct_a.StartAcceptingConnections("A", {}));
+  EXPECT_TRUE(wifi_direct_a.StartAcceptingConnections("B", {}));
+  EXPECT_TRUE(wifi_direct_a.StopAcceptingConnections("A"));
+  EXPECT_TRUE(wifi_direct_a.ReleaseWifiDirect());
+  EXPECT_TRUE(wifi_direct_a.IsGOStarted());
+
+  EXPECT_TRUE(wifi_direct_a.StopAcceptingConnections("B"));
+  EXPECT_TRUE(wifi_direct_a.ReleaseWifiDirect());
+  EXPECT_FALSE(wifi_direct_a.IsGOStarted());
+}
+
+TEST_F(WifiDirectTest, PersistentGroupIsReused) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kWifiDirectPersistentGroupTimeMillis,
+      200);
+  std::string service_id(kServiceID);
+  WifiDirect wifi_direct_a, wifi_direct_b;
+
+  EXPECT_TRUE(wifi_direct_a.StartWifiDirect());
+  EXPECT_TRUE(wifi_direct_a.StartAcceptingConnections(service_id, {}));
+  WifiDirectCredentials* wifi_direct_credentials =
+      wifi_direct_a.GetCredentials(service_id);
+  std::string ssid = wifi_direct_credentials->GetSSID();
+  std::string password = wifi_direct_credentials->GetPassword();
+  EXPECT_TRUE(wifi_direct_b.ConnectWifiDirect(ssid, password));
+
+  EXPECT_TRUE(wifi_direct_b.ReleaseConnectionToGO());
+  EXPECT_TRUE(wifi_direct_a.StopAcceptingConnections(service_id));
+  EXPECT_TRUE(wifi_direct_a.ReleaseWifiDirect());
+  EXPECT_TRUE(wifi_direct_a.IsGOStarted());
+  EXPECT_TRUE(wifi_direct_b.IsConnectedToGO());
+
+  // Upgrading again reuses the group and the connection to it.
+  EXPECT_TRUE(wifi_direct_a.StartWifiDirect());
+  EXPECT_TRUE(wifi_direct_a.StartAcceptingConnections(service_id, {}));
+  EXPECT_EQ(wifi_direct_a.GetCredentials(service_id)->GetSSID(), ssid);
+  EXPECT_TRUE(wifi_direct_b.ConnectWifiDirect(ssid, password));
+
+  EXPECT_TRUE(wifi_direct_b.ReleaseConnectionToGO());
+  EXPECT_TRUE(wifi_direct_a.StopAcceptingConnections(service_id));
+  EXPECT_TRUE(wifi_direct_a.ReleaseWifiDirect());
+  absl::SleepFor(absl::Seconds(1));
+  EXPECT_FALSE(wifi_direct_a.IsGOStarted());
+  EXPECT_FALSE(wifi_direct_b.IsConnectedToGO());
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 }  // namespace
 }  // namespace connections
 }  // namespace nearby
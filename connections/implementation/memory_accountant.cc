@@ -0,0 +1,206 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/memory_accountant.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "internal/platform/exception.h"
+#include "internal/platform/mutex_lock.h"
+
+namespace nearby {
+namespace connections {
+
+namespace {
+
+void AddToUsage(MemoryAccountant::Usage& usage,
+                MemoryAccountant::Category category, std::int64_t bytes) {
+  usage.live_bytes += bytes;
+  usage.category_bytes[static_cast<int>(category)] += bytes;
+  usage.high_water_bytes = std::max(usage.high_water_bytes, usage.live_bytes);
+}
+
+}  // namespace
+
+constexpr int MemoryAccountant::kCategoryCount;
+
+MemoryAccountant::Reservation::Reservation(
+    std::shared_ptr<MemoryAccountant> accountant, std::string endpoint_id,
+    std::optional<Payload::Id> payload_id, Category category,
+    std::int64_t generation)
+    : accountant_(std::move(accountant)),
+      endpoint_id_(std::move(endpoint_id)),
+      payload_id_(payload_id),
+      category_(category),
+      generation_(generation) {}
+
+MemoryAccountant::Reservation::~Reservation() {
+  accountant_->OnReservationDestroyed(*this);
+}
+
+void MemoryAccountant::Reservation::Add(std::size_t bytes) {
+  MutexLock lock(&accountant_->mutex_);
+  accountant_->AddLocked(*this, static_cast<std::int64_t>(bytes));
+}
+
+void MemoryAccountant::Reservation::Remove(std::size_t bytes) {
+  MutexLock lock(&accountant_->mutex_);
+  accountant_->AddLocked(
+      *this, -std::min(static_cast<std::int64_t>(bytes), bytes_));
+}
+
+bool MemoryAccountant::Reservation::AddWhenBelowCap(std::size_t bytes) {
+  MemoryAccountant& accountant = *accountant_;
+  MutexLock lock(&accountant.mutex_);
+  while (true) {
+    // The endpoint state is kept for as long as it has reservations.
+    auto it = accountant.endpoints_.find(endpoint_id_);
+    if (it == accountant.endpoints_.end() ||
+        it->second.generation != generation_) {
+      return false;
+    }
+    if (!accountant.IsOverCapLocked(it->second)) break;
+    ++accountant.waiters_;
+    Exception wait_result = accountant.cond_.Wait();
+    --accountant.waiters_;
+    if (!wait_result.Ok()) return false;
+  }
+  accountant.AddLocked(*this, static_cast<std::int64_t>(bytes));
+  return true;
+}
+
+std::int64_t MemoryAccountant::Reservation::GetBytes() const {
+  MutexLock lock(&accountant_->mutex_);
+  return bytes_;
+}
+
+std::shared_ptr<MemoryAccountant> MemoryAccountant::Create(
+    std::int64_t max_endpoint_bytes, std::int64_t max_total_bytes) {
+  return std::shared_ptr<MemoryAccountant>(
+      new MemoryAccountant(max_endpoint_bytes, max_total_bytes));
+}
+
+MemoryAccountant::MemoryAccountant(std::int64_t max_endpoint_bytes,
+                                   std::int64_t max_total_bytes)
+    : max_endpoint_bytes_(max_endpoint_bytes),
+      max_total_bytes_(max_total_bytes) {}
+
+std::unique_ptr<MemoryAccountant::Reservation> MemoryAccountant::Reserve(
+    const std::string& endpoint_id, Category category) {
+  return DoReserve(endpoint_id, std::nullopt, category);
+}
+
+std::unique_ptr<MemoryAccountant::Reservation> MemoryAccountant::Reserve(
+    const std::string& endpoint_id, Payload::Id payload_id,
+    Category category) {
+  return DoReserve(endpoint_id, payload_id, category);
+}
+
+std::unique_ptr<MemoryAccountant::Reservation> MemoryAccountant::DoReserve(
+    const std::string& endpoint_id, std::optional<Payload::Id> payload_id,
+    Category category) {
+  MutexLock lock(&mutex_);
+  EndpointState& endpoint = endpoints_[endpoint_id];
+  if (endpoint.released) {
+    endpoint.released = false;
+    endpoint.usage.high_water_bytes = endpoint.usage.live_bytes;
+  }
+  ++endpoint.reservations;
+  if (payload_id.has_value()) ++payloads_[*payload_id].reservations;
+  return std::unique_ptr<Reservation>(new Reservation(
+      shared_from_this(), endpoint_id, payload_id, category,
+      endpoint.generation));
+}
+
+void MemoryAccountant::OnReservationDestroyed(Reservation& reservation) {
+  MutexLock lock(&mutex_);
+  AddLocked(reservation, -reservation.bytes_);
+  auto endpoint = endpoints_.find(reservation.endpoint_id_);
+  if (endpoint != endpoints_.end() && --endpoint->second.reservations == 0 &&
+      endpoint->second.released) {
+    endpoints_.erase(endpoint);
+  }
+  if (reservation.payload_id_.has_value()) {
+    auto payload = payloads_.find(*reservation.payload_id_);
+    if (payload != payloads_.end() && --payload->second.reservations == 0) {
+      payloads_.erase(payload);
+    }
+  }
+}
+
+void MemoryAccountant::AddLocked(Reservation& reservation, std::int64_t bytes) {
+  if (bytes == 0) return;
+  reservation.bytes_ += bytes;
+  AddToUsage(total_, reservation.category_, bytes);
+  auto endpoint = endpoints_.find(reservation.endpoint_id_);
+  if (endpoint != endpoints_.end()) {
+    AddToUsage(endpoint->second.usage, reservation.category_, bytes);
+  }
+  if (reservation.payload_id_.has_value()) {
+    auto payload = payloads_.find(*reservation.payload_id_);
+    if (payload != payloads_.end()) {
+      AddToUsage(payload->second.usage, reservation.category_, bytes);
+    }
+  }
+  if (bytes < 0 && waiters_ > 0) cond_.Notify();
+}
+
+bool MemoryAccountant::IsOverCapLocked(const EndpointState& endpoint) const {
+  return (max_endpoint_bytes_ > 0 &&
+          endpoint.usage.live_bytes >= max_endpoint_bytes_) ||
+         (max_total_bytes_ > 0 && total_.live_bytes >= max_total_bytes_);
+}
+
+MemoryAccountant::Usage MemoryAccountant::GetEndpointUsage(
+    const std::string& endpoint_id) const {
+  MutexLock lock(&mutex_);
+  auto it = endpoints_.find(endpoint_id);
+  if (it == endpoints_.end()) return {};
+  return it->second.usage;
+}
+
+MemoryAccountant::Usage MemoryAccountant::GetPayloadUsage(
+    Payload::Id payload_id) const {
+  MutexLock lock(&mutex_);
+  auto it = payloads_.find(payload_id);
+  if (it == payloads_.end()) return {};
+  return it->second.usage;
+}
+
+MemoryAccountant::Usage MemoryAccountant::GetTotalUsage() const {
+  MutexLock lock(&mutex_);
+  return total_;
+}
+
+void MemoryAccountant::ReleaseEndpoint(const std::string& endpoint_id) {
+  MutexLock lock(&mutex_);
+  auto it = endpoints_.find(endpoint_id);
+  if (it == endpoints_.end()) return;
+  if (it->second.reservations == 0) {
+    endpoints_.erase(it);
+  } else {
+    ++it->second.generation;
+    it->second.released = true;
+  }
+  if (waiters_ > 0) cond_.Notify();
+}
+
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,175 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_MEMORY_ACCOUNTANT_H_
+#define CORE_INTERNAL_MEMORY_ACCOUNTANT_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "connections/payload.h"
+#include "internal/platform/condition_variable.h"
+#include "internal/platform/mutex.h"
+
+namespace nearby {
+namespace connections {
+
+// Keeps track of the memory that incoming data holds on behalf of each
+// endpoint and payload of a client: frames read off an endpoint channel and
+// not yet processed, STREAM payload chunks the client hasn't read yet, and
+// FILE payload chunks gathered before being written.
+//
+// Bytes are attributed through Reservations, each of which belongs to one
+// endpoint, optionally one payload, and one Category. With a cap set, the
+// reader of an endpoint that is over it (or of any endpoint, while the client
+// is over its total cap) waits in AddWhenBelowCap() before processing the next
+// frame, so a client that doesn't keep up slows down its remote endpoints
+// instead of buffering without bound.
+//
+// Must be created with Create(), as Reservations keep it alive. Thread-safe.
+class MemoryAccountant : public std::enable_shared_from_this<MemoryAccountant> {
+ public:
+  enum class Category {
+    // A frame read off an endpoint channel, until it has been processed.
+    kIncomingFrame = 0,
+    // Chunks of an incoming STREAM payload, until the client reads them.
+    kStreamBuffer = 1,
+    // Chunks of an incoming FILE payload, until they are written.
+    kFileWriteBuffer = 2,
+  };
+  static constexpr int kCategoryCount = 3;
+
+  struct Usage {
+    std::int64_t live_bytes = 0;
+    // The most live bytes held at once.
+    std::int64_t high_water_bytes = 0;
+    // Live bytes per Category.
+    std::array<std::int64_t, kCategoryCount> category_bytes = {};
+  };
+
+  // Bytes held for one endpoint. Returns whatever it still holds when
+  // destroyed.
+  class Reservation {
+   public:
+    ~Reservation();
+    Reservation(const Reservation&) = delete;
+    Reservation& operator=(const Reservation&) = delete;
+
+    void Add(std::size_t bytes);
+    void Remove(std::size_t bytes);
+
+    // Waits until the endpoint and the client are below their caps, then adds
+    // |bytes|. Returns false without adding anything if the endpoint is
+    // released first.
+    bool AddWhenBelowCap(std::size_t bytes);
+
+    std::int64_t GetBytes() const;
+
+   private:
+    friend class MemoryAccountant;
+
+    Reservation(std::shared_ptr<MemoryAccountant> accountant,
+                std::string endpoint_id, std::optional<Payload::Id> payload_id,
+                Category category, std::int64_t generation);
+
+    const std::shared_ptr<MemoryAccountant> accountant_;
+    const std::string endpoint_id_;
+    const std::optional<Payload::Id> payload_id_;
+    const Category category_;
+    // The endpoint generation this reservation was made in, see
+    // ReleaseEndpoint().
+    const std::int64_t generation_;
+    // Guarded by accountant_->mutex_.
+    std::int64_t bytes_ = 0;
+  };
+
+  // A cap of 0 leaves that usage unbounded.
+  static std::shared_ptr<MemoryAccountant> Create(
+      std::int64_t max_endpoint_bytes = 0, std::int64_t max_total_bytes = 0);
+
+  MemoryAccountant(const MemoryAccountant&) = delete;
+  MemoryAccountant& operator=(const MemoryAccountant&) = delete;
+
+  std::unique_ptr<Reservation> Reserve(const std::string& endpoint_id,
+                                       Category category)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  std::unique_ptr<Reservation> Reserve(const std::string& endpoint_id,
+                                       Payload::Id payload_id,
+                                       Category category)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Usage of an endpoint since it last (re)connected.
+  Usage GetEndpointUsage(const std::string& endpoint_id) const
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  // Usage of a payload while any of its chunks are held.
+  Usage GetPayloadUsage(Payload::Id payload_id) const
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  Usage GetTotalUsage() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Called once an endpoint disconnects. Pending AddWhenBelowCap() calls for
+  // its current reservations return false, and its usage starts over when it
+  // reconnects. Bytes its reservations still hold keep counting towards it
+  // until they are released.
+  void ReleaseEndpoint(const std::string& endpoint_id)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  struct EndpointState {
+    Usage usage;
+    std::int64_t generation = 0;
+    int reservations = 0;
+    bool released = false;
+  };
+  struct PayloadState {
+    Usage usage;
+    int reservations = 0;
+  };
+
+  MemoryAccountant(std::int64_t max_endpoint_bytes,
+                   std::int64_t max_total_bytes);
+
+  std::unique_ptr<Reservation> DoReserve(const std::string& endpoint_id,
+                                         std::optional<Payload::Id> payload_id,
+                                         Category category)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  void OnReservationDestroyed(Reservation& reservation)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  void AddLocked(Reservation& reservation, std::int64_t bytes)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  bool IsOverCapLocked(const EndpointState& endpoint) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const std::int64_t max_endpoint_bytes_;
+  const std::int64_t max_total_bytes_;
+
+  mutable Mutex mutex_;
+  ConditionVariable cond_{&mutex_};
+  absl::flat_hash_map<std::string, EndpointState> endpoints_
+      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<Payload::Id, PayloadState> payloads_
+      ABSL_GUARDED_BY(mutex_);
+  Usage total_ ABSL_GUARDED_BY(mutex_);
+  int waiters_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_MEMORY_ACCOUNTANT_H_
@@ -0,0 +1,221 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/memory_accountant.h"
+
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "internal/platform/count_down_latch.h"
+#include "internal/platform/single_thread_executor.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+using Category = MemoryAccountant::Category;
+
+constexpr char kEndpointId[] = "ABCD";
+constexpr char kOtherEndpointId[] = "EFGH";
+constexpr Payload::Id kPayloadId = 1234;
+
+TEST(MemoryAccountantTest, TracksLiveAndHighWaterBytes) {
+  std::shared_ptr<MemoryAccountant> accountant = MemoryAccountant::Create();
+  std::unique_ptr<MemoryAccountant::Reservation> reservation =
+      accountant->Reserve(kEndpointId, kPayloadId, Category::kStreamBuffer);
+
+  reservation->Add(100);
+  reservation->Add(50);
+  reservation->Remove(120);
+
+  MemoryAccountant::Usage usage = accountant->GetEndpointUsage(kEndpointId);
+  EXPECT_EQ(usage.live_bytes, 30);
+  EXPECT_EQ(usage.high_water_bytes, 150);
+  EXPECT_EQ(usage.category_bytes[static_cast<int>(Category::kStreamBuffer)],
+            30);
+  EXPECT_EQ(accountant->GetPayloadUsage(kPayloadId).live_bytes, 30);
+  EXPECT_EQ(accountant->GetTotalUsage().live_bytes, 30);
+}
+
+TEST(MemoryAccountantTest, AttributesBytesToEndpointAndPayload) {
+  std::shared_ptr<MemoryAccountant> accountant = MemoryAccountant::Create();
+  std::unique_ptr<MemoryAccountant::Reservation> frame =
+      accountant->Reserve(kEndpointId, Category::kIncomingFrame);
+  std::unique_ptr<MemoryAccountant::Reservation> stream =
+      accountant->Reserve(kEndpointId, kPayloadId, Category::kStreamBuffer);
+  std::unique_ptr<MemoryAccountant::Reservation> other =
+      accountant->Reserve(kOtherEndpointId, Category::kIncomingFrame);
+
+  frame->Add(10);
+  stream->Add(20);
+  other->Add(40);
+
+  EXPECT_EQ(accountant->GetEndpointUsage(kEndpointId).live_bytes, 30);
+  EXPECT_EQ(accountant->GetEndpointUsage(kOtherEndpointId).live_bytes, 40);
+  EXPECT_EQ(accountant->GetPayloadUsage(kPayloadId).live_bytes, 20);
+  EXPECT_EQ(accountant->GetTotalUsage().live_bytes, 70);
+}
+
+TEST(MemoryAccountantTest, RemoveDoesNotGoBelowZero) {
+  std::shared_ptr<MemoryAccountant> accountant = MemoryAccountant::Create();
+  std::unique_ptr<MemoryAccountant::Reservation> reservation =
+      accountant->Reserve(kEndpointId, Category::kIncomingFrame);
+
+  reservation->Add(10);
+  reservation->Remove(20);
+
+  EXPECT_EQ(reservation->GetBytes(), 0);
+  EXPECT_EQ(accountant->GetEndpointUsage(kEndpointId).live_bytes, 0);
+}
+
+TEST(MemoryAccountantTest, DestroyedReservationReturnsItsBytes) {
+  std::shared_ptr<MemoryAccountant> accountant = MemoryAccountant::Create();
+  std::unique_ptr<MemoryAccountant::Reservation> reservation =
+      accountant->Reserve(kEndpointId, kPayloadId, Category::kFileWriteBuffer);
+  reservation->Add(100);
+
+  reservation.reset();
+
+  EXPECT_EQ(accountant->GetEndpointUsage(kEndpointId).live_bytes, 0);
+  EXPECT_EQ(accountant->GetTotalUsage().live_bytes, 0);
+  // Payloads are forgotten along with their last reservation.
+  EXPECT_EQ(accountant->GetPayloadUsage(kPayloadId).high_water_bytes, 0);
+}
+
+TEST(MemoryAccountantTest, ReservationKeepsAccountantAlive) {
+  std::shared_ptr<MemoryAccountant> accountant = MemoryAccountant::Create();
+  std::unique_ptr<MemoryAccountant::Reservation> reservation =
+      accountant->Reserve(kEndpointId, Category::kStreamBuffer);
+
+  accountant.reset();
+
+  reservation->Add(10);
+  EXPECT_EQ(reservation->GetBytes(), 10);
+}
+
+TEST(MemoryAccountantTest, AddWhenBelowCapDoesNotWaitWithoutCap) {
+  std::shared_ptr<MemoryAccountant> accountant = MemoryAccountant::Create();
+  std::unique_ptr<MemoryAccountant::Reservation> reservation =
+      accountant->Reserve(kEndpointId, Category::kIncomingFrame);
+
+  EXPECT_TRUE(reservation->AddWhenBelowCap(1 << 20));
+  EXPECT_TRUE(reservation->AddWhenBelowCap(1 << 20));
+  EXPECT_EQ(reservation->GetBytes(), 2 << 20);
+}
+
+TEST(MemoryAccountantTest, AddWhenBelowCapWaitsForEndpointToDrain) {
+  std::shared_ptr<MemoryAccountant> accountant =
+      MemoryAccountant::Create(/*max_endpoint_bytes=*/100);
+  std::unique_ptr<MemoryAccountant::Reservation> stream =
+      accountant->Reserve(kEndpointId, kPayloadId, Category::kStreamBuffer);
+  std::unique_ptr<MemoryAccountant::Reservation> frame =
+      accountant->Reserve(kEndpointId, Category::kIncomingFrame);
+  std::unique_ptr<MemoryAccountant::Reservation> other =
+      accountant->Reserve(kOtherEndpointId, Category::kIncomingFrame);
+  stream->Add(100);
+
+  // Other endpoints are not held back.
+  EXPECT_TRUE(other->AddWhenBelowCap(100));
+
+  CountDownLatch added(1);
+  SingleThreadExecutor executor;
+  executor.Execute([&]() {
+    EXPECT_TRUE(frame->AddWhenBelowCap(10));
+    added.CountDown();
+  });
+  EXPECT_FALSE(added.Await(absl::Milliseconds(100)).result());
+
+  stream->Remove(1);
+  EXPECT_TRUE(added.Await(absl::Seconds(1)).result());
+  EXPECT_EQ(accountant->GetEndpointUsage(kEndpointId).live_bytes, 109);
+}
+
+TEST(MemoryAccountantTest, AddWhenBelowCapWaitsForTotalToDrain) {
+  std::shared_ptr<MemoryAccountant> accountant = MemoryAccountant::Create(
+      /*max_endpoint_bytes=*/0, /*max_total_bytes=*/100);
+  std::unique_ptr<MemoryAccountant::Reservation> stream =
+      accountant->Reserve(kOtherEndpointId, Category::kStreamBuffer);
+  std::unique_ptr<MemoryAccountant::Reservation> frame =
+      accountant->Reserve(kEndpointId, Category::kIncomingFrame);
+  stream->Add(100);
+
+  CountDownLatch added(1);
+  SingleThreadExecutor executor;
+  executor.Execute([&]() {
+    EXPECT_TRUE(frame->AddWhenBelowCap(10));
+    added.CountDown();
+  });
+  EXPECT_FALSE(added.Await(absl::Milliseconds(100)).result());
+
+  stream.reset();
+  EXPECT_TRUE(added.Await(absl::Seconds(1)).result());
+}
+
+TEST(MemoryAccountantTest, ReleaseEndpointUnblocksAddWhenBelowCap) {
+  std::shared_ptr<MemoryAccountant> accountant =
+      MemoryAccountant::Create(/*max_endpoint_bytes=*/100);
+  std::unique_ptr<MemoryAccountant::Reservation> stream =
+      accountant->Reserve(kEndpointId, kPayloadId, Category::kStreamBuffer);
+  std::unique_ptr<MemoryAccountant::Reservation> frame =
+      accountant->Reserve(kEndpointId, Category::kIncomingFrame);
+  stream->Add(100);
+
+  CountDownLatch done(1);
+  SingleThreadExecutor executor;
+  executor.Execute([&]() {
+    EXPECT_FALSE(frame->AddWhenBelowCap(10));
+    done.CountDown();
+  });
+  accountant->ReleaseEndpoint(kEndpointId);
+
+  EXPECT_TRUE(done.Await(absl::Seconds(1)).result());
+  EXPECT_FALSE(frame->AddWhenBelowCap(10));
+  EXPECT_EQ(frame->GetBytes(), 0);
+}
+
+TEST(MemoryAccountantTest, ReconnectedEndpointStartsOver) {
+  std::shared_ptr<MemoryAccountant> accountant =
+      MemoryAccountant::Create(/*max_endpoint_bytes=*/100);
+  std::unique_ptr<MemoryAccountant::Reservation> old_stream =
+      accountant->Reserve(kEndpointId, kPayloadId, Category::kStreamBuffer);
+  old_stream->Add(50);
+  accountant->ReleaseEndpoint(kEndpointId);
+  old_stream->Remove(40);
+
+  std::unique_ptr<MemoryAccountant::Reservation> frame =
+      accountant->Reserve(kEndpointId, Category::kIncomingFrame);
+
+  MemoryAccountant::Usage usage = accountant->GetEndpointUsage(kEndpointId);
+  EXPECT_EQ(usage.live_bytes, 10);
+  EXPECT_EQ(usage.high_water_bytes, 10);
+  EXPECT_TRUE(frame->AddWhenBelowCap(10));
+}
+
+TEST(MemoryAccountantTest, ReleasedEndpointIsForgottenWithItsReservations) {
+  std::shared_ptr<MemoryAccountant> accountant = MemoryAccountant::Create();
+  std::unique_ptr<MemoryAccountant::Reservation> reservation =
+      accountant->Reserve(kEndpointId, Category::kIncomingFrame);
+  reservation->Add(10);
+  accountant->ReleaseEndpoint(kEndpointId);
+
+  EXPECT_EQ(accountant->GetEndpointUsage(kEndpointId).live_bytes, 10);
+
+  reservation.reset();
+  EXPECT_EQ(accountant->GetEndpointUsage(kEndpointId).high_water_bytes, 0);
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
@@ -88,6 +88,17 @@ class MockServiceControllerRouter : public ServiceControllerRouter {
                const ResultCallback& callback),
               (override));
 
+  MOCK_METHOD(void, AcceptConnections,
+              (ClientProxy * client,
+               (std::vector<std::pair<std::string, PayloadListener>>),
+               const ResultCallback& callback),
+              (override));
+
+  MOCK_METHOD(void, DisconnectFromEndpoints,
+              (ClientProxy * client, absl::Span<const std::string> endpoint_ids,
+               const ResultCallback& callback),
+              (override));
+
   MOCK_METHOD(void, StopAllEndpoints,
               (ClientProxy * client, const ResultCallback& callback),
               (override));
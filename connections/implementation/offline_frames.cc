@@ -19,6 +19,10 @@
 #include <utility>
 #include <vector>
 
+#include "google/protobuf/arena.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/wire_format_lite.h"
+#include "absl/time/time.h"
 #include "connections/implementation/offline_frames_validator.h"
 #include "connections/status.h"
 #include "internal/platform/byte_array.h"
@@ -64,6 +68,22 @@ ExceptionOrOfflineFrame FromBytes(const ByteArray& bytes) {
   }
 }
 
+ExceptionOr<OfflineFrame*> FromBytes(const ByteArray& bytes,
+                                     google::protobuf::Arena* arena) {
+  OfflineFrame* frame =
+      google::protobuf::Arena::CreateMessage<OfflineFrame>(arena);
+
+  if (frame->ParseFromArray(bytes.data(), bytes.size())) {
+    Exception validation_exception = EnsureValidOfflineFrame(*frame);
+    if (validation_exception.Raised()) {
+      return ExceptionOr<OfflineFrame*>(validation_exception);
+    }
+    return ExceptionOr<OfflineFrame*>(frame);
+  } else {
+    return ExceptionOr<OfflineFrame*>(Exception::kInvalidProtocolBuffer);
+  }
+}
+
 V1Frame::FrameType GetFrameType(const OfflineFrame& frame) {
   if ((frame.version() == OfflineFrame::V1) && frame.has_v1()) {
     return frame.v1().type();
@@ -72,7 +92,60 @@ V1Frame::FrameType GetFrameType(const OfflineFrame& frame) {
   return V1Frame::UNKNOWN_FRAME_TYPE;
 }
 
-ByteArray ForConnectionRequest(const ConnectionInfo& conection_info) {
+V1Frame::FrameType PeekFrameType(const ByteArray& bytes) {
+  using ::google::protobuf::io::CodedInputStream;
+  using ::google::protobuf::internal::WireFormatLite;
+
+  // Walks the wire format the way the parser would, keeping the last valid
+  // value of each field, and skipping everything else without copying it.
+  CodedInputStream input(reinterpret_cast<const uint8_t*>(bytes.data()),
+                         bytes.size());
+  bool is_v1 = false;
+  bool has_v1 = false;
+  V1Frame::FrameType frame_type = V1Frame::UNKNOWN_FRAME_TYPE;
+  while (std::uint32_t tag = input.ReadTag()) {
+    if (tag == WireFormatLite::MakeTag(
+                   OfflineFrame::kVersionFieldNumber,
+                   WireFormatLite::WIRETYPE_VARINT)) {
+      std::uint32_t version;
+      if (!input.ReadVarint32(&version)) return V1Frame::UNKNOWN_FRAME_TYPE;
+      if (OfflineFrame::Version_IsValid(version)) {
+        is_v1 = version == OfflineFrame::V1;
+      }
+    } else if (tag == WireFormatLite::MakeTag(
+                          OfflineFrame::kV1FieldNumber,
+                          WireFormatLite::WIRETYPE_LENGTH_DELIMITED)) {
+      std::uint32_t length;
+      if (!input.ReadVarint32(&length)) return V1Frame::UNKNOWN_FRAME_TYPE;
+      CodedInputStream::Limit limit = input.PushLimit(length);
+      has_v1 = true;
+      while (std::uint32_t v1_tag = input.ReadTag()) {
+        if (v1_tag == WireFormatLite::MakeTag(
+                          V1Frame::kTypeFieldNumber,
+                          WireFormatLite::WIRETYPE_VARINT)) {
+          std::uint32_t type;
+          if (!input.ReadVarint32(&type)) return V1Frame::UNKNOWN_FRAME_TYPE;
+          if (V1Frame::FrameType_IsValid(type)) {
+            frame_type = static_cast<V1Frame::FrameType>(type);
+          }
+        } else if (!WireFormatLite::SkipField(&input, v1_tag)) {
+          return V1Frame::UNKNOWN_FRAME_TYPE;
+        }
+      }
+      if (!input.ConsumedEntireMessage()) return V1Frame::UNKNOWN_FRAME_TYPE;
+      input.PopLimit(limit);
+    } else if (!WireFormatLite::SkipField(&input, tag)) {
+      return V1Frame::UNKNOWN_FRAME_TYPE;
+    }
+  }
+  if (!input.ConsumedEntireMessage()) return V1Frame::UNKNOWN_FRAME_TYPE;
+
+  return is_v1 && has_v1 ? frame_type : V1Frame::UNKNOWN_FRAME_TYPE;
+}
+
+ByteArray ForConnectionRequest(const ConnectionInfo& conection_info,
+                               const SessionResumptionOffer& offer,
+                               const CompactHandshakeOffer& compact) {
   OfflineFrame frame;
 
   frame.set_version(OfflineFrame::V1);
@@ -108,11 +181,27 @@ ByteArray ForConnectionRequest(const ConnectionInfo& conection_info) {
     connection_request->set_keep_alive_timeout_millis(
         conection_info.keep_alive_timeout_millis);
   }
+  if (offer.supports_session_resumption) {
+    connection_request->set_supports_session_resumption(true);
+  }
+  if (!offer.session_ticket_id.Empty()) {
+    connection_request->set_session_ticket_id(
+        std::string(offer.session_ticket_id));
+    connection_request->set_session_resumption_nonce(std::string(offer.nonce));
+  }
+  if (compact.supports_compact_handshake) {
+    connection_request->set_supports_compact_handshake(true);
+  }
+  if (!compact.ukey2_client_init.Empty()) {
+    connection_request->set_ukey2_client_init(
+        std::string(compact.ukey2_client_init));
+  }
 
   return ToBytes(std::move(frame));
 }
 
-ByteArray ForConnectionResponse(std::int32_t status, const OsInfo& os_info) {
+ByteArray ForConnectionResponse(std::int32_t status, const OsInfo& os_info,
+                                const ConnectionResponseFeatures& features) {
   OfflineFrame frame;
 
   frame.set_version(OfflineFrame::V1);
@@ -128,6 +217,61 @@ ByteArray ForConnectionResponse(std::int32_t status, const OsInfo& os_info) {
                               ? ConnectionResponseFrame::ACCEPT
                               : ConnectionResponseFrame::REJECT);
   *sub_frame->mutable_os_info() = os_info;
+  if (features.supports_bytes_payload_batching) {
+    sub_frame->set_supports_bytes_payload_batching(true);
+  }
+  if (features.supports_single_frame_bytes_payloads) {
+    sub_frame->set_supports_single_frame_bytes_payloads(true);
+  }
+  if (features.supports_session_resumption) {
+    sub_frame->set_supports_session_resumption(true);
+  }
+  if (features.supports_aead_frames) {
+    sub_frame->set_supports_aead_frames(true);
+  }
+  if (features.supports_compressed_chunks) {
+    sub_frame->set_supports_compressed_chunks(true);
+  }
+  if (features.supports_chunk_dedup) {
+    sub_frame->set_supports_chunk_dedup(true);
+  }
+  if (features.supports_file_batch) {
+    sub_frame->set_supports_file_batch(true);
+  }
+  if (features.supports_payload_relay) {
+    sub_frame->set_supports_payload_relay(true);
+  }
+  if (features.supports_compact_handshake) {
+    sub_frame->set_supports_compact_handshake(true);
+  }
+
+  return ToBytes(std::move(frame));
+}
+
+ByteArray ForBusyConnectionResponse(absl::Duration retry_after) {
+  OfflineFrame frame;
+
+  frame.set_version(OfflineFrame::V1);
+  auto* v1_frame = frame.mutable_v1();
+  v1_frame->set_type(V1Frame::CONNECTION_RESPONSE);
+  auto* sub_frame = v1_frame->mutable_connection_response();
+  sub_frame->set_status(Status::kConnectionRejected);
+  sub_frame->set_response(ConnectionResponseFrame::REJECT);
+  sub_frame->set_retry_after_millis(absl::ToInt64Milliseconds(retry_after));
+
+  return ToBytes(std::move(frame));
+}
+
+ByteArray ForSessionResumption(const ByteArray& nonce) {
+  OfflineFrame frame;
+
+  frame.set_version(OfflineFrame::V1);
+  auto* v1_frame = frame.mutable_v1();
+  v1_frame->set_type(V1Frame::SESSION_RESUMPTION);
+  auto* sub_frame = v1_frame->mutable_session_resumption();
+  if (!nonce.Empty()) {
+    sub_frame->set_nonce(std::string(nonce));
+  }
 
   return ToBytes(std::move(frame));
 }
@@ -143,7 +287,31 @@ ByteArray ForDataPayloadTransfer(
   auto* sub_frame = v1_frame->mutable_payload_transfer();
   sub_frame->set_packet_type(PayloadTransferFrame::DATA);
   *sub_frame->mutable_payload_header() = header;
-  *sub_frame->mutable_payload_chunk() = chunk;
+  // The chunk body is the bulk of a DATA frame, so borrow the caller's chunk
+  // for the duration of serialization instead of copying it into the frame.
+  // Neither message lives on an arena, so the borrowed pointer can be handed
+  // back untouched once the frame bytes are produced.
+  sub_frame->unsafe_arena_set_allocated_payload_chunk(
+      const_cast<PayloadTransferFrame::PayloadChunk*>(&chunk));
+
+  ByteArray bytes(frame.ByteSizeLong());
+  frame.SerializeToArray(bytes.data(), bytes.size());
+  sub_frame->unsafe_arena_release_payload_chunk();
+  return bytes;
+}
+
+ByteArray ForBytesPayloadBatch(
+    std::vector<PayloadTransferFrame::BytesPayload> payloads) {
+  OfflineFrame frame;
+
+  frame.set_version(OfflineFrame::V1);
+  auto* v1_frame = frame.mutable_v1();
+  v1_frame->set_type(V1Frame::PAYLOAD_TRANSFER);
+  auto* sub_frame = v1_frame->mutable_payload_transfer();
+  sub_frame->set_packet_type(PayloadTransferFrame::BYTES_BATCH);
+  for (auto& payload : payloads) {
+    *sub_frame->add_bytes_payloads() = std::move(payload);
+  }
 
   return ToBytes(std::move(frame));
 }
@@ -19,6 +19,8 @@
 #include <string>
 #include <vector>
 
+#include "google/protobuf/arena.h"
+#include "absl/time/time.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
 #include "connections/connection_options.h"
 #include "internal/platform/byte_array.h"
@@ -39,15 +41,66 @@ using UpgradePathInfo = ::location::nearby::connections::
 ExceptionOr<location::nearby::connections::OfflineFrame> FromBytes(
     const ByteArray& offline_frame_bytes);
 
+// Like FromBytes() above, but allocates the OfflineFrame on `arena`, which must
+// outlive the returned frame. Reusing one arena across frames, and resetting it
+// between them, saves allocating each frame's message tree on the heap.
+ExceptionOr<location::nearby::connections::OfflineFrame*> FromBytes(
+    const ByteArray& offline_frame_bytes, google::protobuf::Arena* arena);
+
 // Returns FrameType of a parsed message, or
 // V1Frame::UNKNOWN_FRAME_TYPE, if frame contents is not recognized.
 location::nearby::connections::V1Frame::FrameType GetFrameType(
     const location::nearby::connections::OfflineFrame& offline_frame);
 
+// Returns the FrameType that GetFrameType() would return for the message in
+// `offline_frame_bytes`, reading only the fields needed for it instead of
+// parsing the whole message. Returns V1Frame::UNKNOWN_FRAME_TYPE if the bytes
+// can't be read that far; this does not validate the rest of the message.
+location::nearby::connections::V1Frame::FrameType PeekFrameType(
+    const ByteArray& offline_frame_bytes);
+
+// Optional protocol features announced in a ConnectionResponseFrame.
+struct ConnectionResponseFeatures {
+  bool supports_bytes_payload_batching = false;
+  bool supports_single_frame_bytes_payloads = false;
+  bool supports_session_resumption = false;
+  bool supports_aead_frames = false;
+  bool supports_compressed_chunks = false;
+  bool supports_chunk_dedup = false;
+  bool supports_file_batch = false;
+  bool supports_payload_relay = false;
+  bool supports_compact_handshake = false;
+};
+
+// Session resumption fields of a ConnectionRequestFrame.
+struct SessionResumptionOffer {
+  bool supports_session_resumption = false;
+  // Left empty unless resuming from a session ticket.
+  ByteArray session_ticket_id;
+  ByteArray nonce;
+};
+
+// Compact handshake fields of a ConnectionRequestFrame.
+struct CompactHandshakeOffer {
+  bool supports_compact_handshake = false;
+  // Left empty unless the receiver is known to take the ClientInit here.
+  ByteArray ukey2_client_init;
+};
+
 // Builds Connection Request / Response messages.
-ByteArray ForConnectionRequest(const ConnectionInfo& conection_info);
+ByteArray ForConnectionRequest(const ConnectionInfo& conection_info,
+                               const SessionResumptionOffer& offer = {},
+                               const CompactHandshakeOffer& compact = {});
 ByteArray ForConnectionResponse(
-    std::int32_t status, const location::nearby::connections::OsInfo& os_info);
+    std::int32_t status, const location::nearby::connections::OsInfo& os_info,
+    const ConnectionResponseFeatures& features = {});
+
+// Builds the rejection of a connection that the endpoint is too busy to take,
+// sent before the handshake, asking to connect again after |retry_after|.
+ByteArray ForBusyConnectionResponse(absl::Duration retry_after);
+
+// Builds the answer to a session ticket. An empty |nonce| rejects it.
+ByteArray ForSessionResumption(const ByteArray& nonce);
 
 // Builds Payload transfer messages.
 ByteArray ForDataPayloadTransfer(
@@ -60,6 +113,12 @@ ByteArray ForControlPayloadTransfer(
         header,
     const location::nearby::connections::PayloadTransferFrame::ControlMessage&
         control);
+// Builds a single frame carrying several complete BYTES payloads, each with
+// its own header.
+ByteArray ForBytesPayloadBatch(
+    std::vector<location::nearby::connections::PayloadTransferFrame::
+                    BytesPayload>
+        payloads);
 
 // Builds Bandwidth Upgrade [BWU] messages.
 ByteArray ForBwuIntroduction(const std::string& endpoint_id,
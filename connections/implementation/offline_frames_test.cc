@@ -24,6 +24,7 @@
 #include "protobuf-matchers/protocol-buffer-matchers.h"
 #include "gtest/gtest.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
 #include "internal/platform/byte_array.h"
 
@@ -32,6 +33,7 @@ namespace connections {
 namespace parser {
 namespace {
 
+using ::location::nearby::connections::ConnectionRequestFrame;
 using ::location::nearby::connections::OfflineFrame;
 using ::location::nearby::connections::OsInfo;
 using ::location::nearby::connections::PayloadTransferFrame;
@@ -90,6 +92,73 @@ TEST(OfflineFramesTest, CanParseMessageFromBytes) {
       std::vector(kMediums.begin(), kMediums.end()));
 }
 
+TEST(OfflineFramesTest, CanParseMessageFromBytesOntoArena) {
+  OfflineFrame tx_message;
+  tx_message.set_version(OfflineFrame::V1);
+  auto* v1_frame = tx_message.mutable_v1();
+  v1_frame->set_type(V1Frame::PAYLOAD_TRANSFER);
+  auto* sub_frame = v1_frame->mutable_payload_transfer();
+  sub_frame->set_packet_type(PayloadTransferFrame::DATA);
+  sub_frame->mutable_payload_header()->set_id(12345);
+  sub_frame->mutable_payload_header()->set_type(
+      PayloadTransferFrame::PayloadHeader::BYTES);
+  sub_frame->mutable_payload_header()->set_total_size(4);
+  sub_frame->mutable_payload_chunk()->set_body("ABCD");
+  sub_frame->mutable_payload_chunk()->set_offset(0);
+  sub_frame->mutable_payload_chunk()->set_flags(0);
+  auto serialized_bytes = ByteArray(tx_message.SerializeAsString());
+
+  google::protobuf::Arena arena;
+  for (int i = 0; i < 3; ++i) {
+    arena.Reset();
+    auto ret_value = FromBytes(serialized_bytes, &arena);
+    ASSERT_TRUE(ret_value.ok());
+    ASSERT_NE(ret_value.result(), nullptr);
+    EXPECT_EQ(ret_value.result()->GetArena(), &arena);
+    EXPECT_THAT(*ret_value.result(), EqualsProto(tx_message));
+  }
+  EXPECT_TRUE(FromBytes(ByteArray("\xff\xff"), &arena)
+                  .GetException()
+                  .Raised(Exception::kInvalidProtocolBuffer));
+}
+
+TEST(OfflineFramesTest, PeekFrameTypeMatchesParsedFrameType) {
+  PayloadTransferFrame::PayloadHeader header;
+  header.set_id(12345);
+  header.set_type(PayloadTransferFrame::PayloadHeader::BYTES);
+  header.set_total_size(4);
+  PayloadTransferFrame::PayloadChunk chunk;
+  chunk.set_body("ABCD");
+  chunk.set_offset(0);
+  chunk.set_flags(0);
+  OsInfo os_info;
+
+  for (const ByteArray& bytes :
+       {ForDataPayloadTransfer(header, chunk), ForKeepAlive(),
+        ForDisconnection(), ForConnectionResponse(0, os_info),
+        ForBwuIntroductionAck()}) {
+    auto ret_value = FromBytes(bytes);
+    ASSERT_TRUE(ret_value.ok());
+    EXPECT_EQ(PeekFrameType(bytes), GetFrameType(ret_value.result()));
+  }
+}
+
+TEST(OfflineFramesTest, PeekFrameTypeRejectsUnknownVersionAndGarbage) {
+  OfflineFrame frame;
+  frame.mutable_v1()->set_type(V1Frame::KEEP_ALIVE);
+  EXPECT_EQ(PeekFrameType(ByteArray(frame.SerializeAsString())),
+            V1Frame::UNKNOWN_FRAME_TYPE);
+
+  frame.set_version(OfflineFrame::V1);
+  std::string serialized = frame.SerializeAsString();
+  EXPECT_EQ(PeekFrameType(ByteArray(serialized)), V1Frame::KEEP_ALIVE);
+  EXPECT_EQ(PeekFrameType(ByteArray(serialized.substr(
+                0, serialized.size() - 1))),
+            V1Frame::UNKNOWN_FRAME_TYPE);
+  EXPECT_EQ(PeekFrameType(ByteArray("\xff\xff")),
+            V1Frame::UNKNOWN_FRAME_TYPE);
+}
+
 TEST(OfflineFramesTest, CanGenerateConnectionRequest) {
   constexpr char kExpected[] =
       R"pb(
@@ -161,6 +230,122 @@ TEST(OfflineFramesTest, CanGenerateConnectionResponse) {
   EXPECT_THAT(message, EqualsProto(kExpected));
 }
 
+TEST(OfflineFramesTest, CanGenerateConnectionResponseWithFeatures) {
+  constexpr char kExpected[] =
+      R"pb(
+    version: V1
+    v1: <
+      type: CONNECTION_RESPONSE
+      connection_response: <
+        status: 0
+        response: ACCEPT
+        os_info { type: LINUX }
+        supports_bytes_payload_batching: true
+        supports_single_frame_bytes_payloads: true
+        supports_session_resumption: true
+        supports_aead_frames: true
+        supports_compressed_chunks: true
+        supports_chunk_dedup: true
+        supports_file_batch: true
+        supports_payload_relay: true
+      >
+    >)pb";
+
+  OsInfo os_info;
+  os_info.set_type(OsInfo::LINUX);
+  ByteArray bytes = ForConnectionResponse(
+      0, os_info,
+      {.supports_bytes_payload_batching = true,
+       .supports_single_frame_bytes_payloads = true,
+       .supports_session_resumption = true,
+       .supports_aead_frames = true,
+       .supports_compressed_chunks = true,
+       .supports_chunk_dedup = true,
+       .supports_file_batch = true,
+       .supports_payload_relay = true});
+  auto response = FromBytes(bytes);
+  ASSERT_TRUE(response.ok());
+  OfflineFrame message = FromBytes(bytes).result();
+  EXPECT_THAT(message, EqualsProto(kExpected));
+}
+
+TEST(OfflineFramesTest, CanGenerateConnectionRequestWithSessionTicket) {
+  ConnectionInfo connection_info{
+      .local_endpoint_id = std::string(kEndpointId),
+      .local_endpoint_info = ByteArray{std::string(kEndpointName)},
+      .nonce = kNonce};
+  ByteArray bytes = ForConnectionRequest(
+      connection_info, {.supports_session_resumption = true,
+                        .session_ticket_id = ByteArray("ticket"),
+                        .nonce = ByteArray("nonce")});
+  auto response = FromBytes(bytes);
+  ASSERT_TRUE(response.ok());
+  const ConnectionRequestFrame& connection_request =
+      response.result().v1().connection_request();
+  EXPECT_TRUE(connection_request.supports_session_resumption());
+  EXPECT_EQ(connection_request.session_ticket_id(), "ticket");
+  EXPECT_EQ(connection_request.session_resumption_nonce(), "nonce");
+}
+
+TEST(OfflineFramesTest, CanGenerateConnectionRequestWithClientInit) {
+  ConnectionInfo connection_info{
+      .local_endpoint_id = std::string(kEndpointId),
+      .local_endpoint_info = ByteArray{std::string(kEndpointName)},
+      .nonce = kNonce};
+  ByteArray bytes = ForConnectionRequest(
+      connection_info, {},
+      {.supports_compact_handshake = true,
+       .ukey2_client_init = ByteArray("client_init")});
+  auto response = FromBytes(bytes);
+  ASSERT_TRUE(response.ok());
+  const ConnectionRequestFrame& connection_request =
+      response.result().v1().connection_request();
+  EXPECT_TRUE(connection_request.supports_compact_handshake());
+  EXPECT_EQ(connection_request.ukey2_client_init(), "client_init");
+  EXPECT_FALSE(connection_request.has_session_ticket_id());
+}
+
+TEST(OfflineFramesTest, CanGenerateBusyConnectionResponse) {
+  constexpr char kExpected[] =
+      R"pb(
+    version: V1
+    v1: <
+      type: CONNECTION_RESPONSE
+      connection_response: <
+        status: 9
+        response: REJECT
+        retry_after_millis: 1500
+      >
+    >)pb";
+
+  ByteArray bytes = ForBusyConnectionResponse(absl::Milliseconds(1500));
+  auto response = FromBytes(bytes);
+  ASSERT_TRUE(response.ok());
+  OfflineFrame message = FromBytes(bytes).result();
+  EXPECT_THAT(message, EqualsProto(kExpected));
+}
+
+TEST(OfflineFramesTest, CanGenerateSessionResumption) {
+  constexpr char kExpected[] =
+      R"pb(
+    version: V1
+    v1: <
+      type: SESSION_RESUMPTION
+      session_resumption: < nonce: "nonce" >
+    >)pb";
+
+  ByteArray bytes = ForSessionResumption(ByteArray("nonce"));
+  auto response = FromBytes(bytes);
+  ASSERT_TRUE(response.ok());
+  OfflineFrame message = FromBytes(bytes).result();
+  EXPECT_THAT(message, EqualsProto(kExpected));
+  EXPECT_FALSE(FromBytes(ForSessionResumption(ByteArray()))
+                   .result()
+                   .v1()
+                   .session_resumption()
+                   .has_nonce());
+}
+
 TEST(OfflineFramesTest, CanGenerateControlPayloadTransfer) {
   PayloadTransferFrame::PayloadHeader header;
   PayloadTransferFrame::ControlMessage control;
@@ -216,6 +401,65 @@ TEST(OfflineFramesTest, CanGenerateDataPayloadTransfer) {
   EXPECT_THAT(message, EqualsProto(kExpected));
 }
 
+TEST(OfflineFramesTest, DataPayloadTransferLeavesChunkIntact) {
+  PayloadTransferFrame::PayloadHeader header;
+  PayloadTransferFrame::PayloadChunk chunk;
+  header.set_id(12345);
+  header.set_type(PayloadTransferFrame::PayloadHeader::FILE);
+  header.set_total_size(1024);
+  chunk.set_body(std::string(512, 'x'));
+  chunk.set_offset(512);
+  chunk.set_flags(0);
+
+  ByteArray bytes = ForDataPayloadTransfer(header, chunk);
+  // The chunk is only borrowed while the frame is serialized.
+  EXPECT_EQ(chunk.body(), std::string(512, 'x'));
+  EXPECT_EQ(chunk.offset(), 512);
+  auto response = FromBytes(bytes);
+  ASSERT_TRUE(response.ok());
+  const auto& payload_chunk =
+      response.result().v1().payload_transfer().payload_chunk();
+  EXPECT_EQ(payload_chunk.body(), chunk.body());
+  EXPECT_EQ(payload_chunk.offset(), chunk.offset());
+}
+
+TEST(OfflineFramesTest, CanGenerateBytesPayloadBatch) {
+  std::vector<PayloadTransferFrame::BytesPayload> payloads(2);
+  payloads[0].mutable_payload_header()->set_id(12345);
+  payloads[0].mutable_payload_header()->set_type(
+      PayloadTransferFrame::PayloadHeader::BYTES);
+  payloads[0].mutable_payload_header()->set_total_size(5);
+  payloads[0].set_body("hello");
+  payloads[1].mutable_payload_header()->set_id(12346);
+  payloads[1].mutable_payload_header()->set_type(
+      PayloadTransferFrame::PayloadHeader::BYTES);
+  payloads[1].mutable_payload_header()->set_total_size(5);
+  payloads[1].set_body("world");
+
+  constexpr char kExpected[] =
+      R"pb(
+    version: V1
+    v1: <
+      type: PAYLOAD_TRANSFER
+      payload_transfer: <
+        packet_type: BYTES_BATCH,
+        bytes_payloads: <
+          payload_header: < type: BYTES id: 12345 total_size: 5 >
+          body: "hello"
+        >
+        bytes_payloads: <
+          payload_header: < type: BYTES id: 12346 total_size: 5 >
+          body: "world"
+        >
+      >
+    >)pb";
+  ByteArray bytes = ForBytesPayloadBatch(std::move(payloads));
+  auto response = FromBytes(bytes);
+  ASSERT_TRUE(response.ok());
+  OfflineFrame message = FromBytes(bytes).result();
+  EXPECT_THAT(message, EqualsProto(kExpected));
+}
+
 TEST(OfflineFramesTest, CanGenerateBwuWifiHotspotPathAvailable) {
   constexpr char kExpected[] =
       R"pb(
@@ -15,6 +15,7 @@
 #include "connections/implementation/offline_frames_validator.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <regex>  //NOLINT
 #include <string>
 
@@ -29,6 +30,8 @@ namespace connections {
 namespace parser {
 namespace {
 
+using PayloadHeader =
+    ::location::nearby::connections::PayloadTransferFrame::PayloadHeader;
 using PayloadChunk =
     ::location::nearby::connections::PayloadTransferFrame::PayloadChunk;
 using ControlMessage =
@@ -124,7 +127,26 @@ Exception EnsureValidPayloadTransferControlFrame(
   return {Exception::kSuccess};
 }
 
+Exception EnsureValidBytesPayloadBatch(const PayloadTransferFrame& frame) {
+  if (frame.bytes_payloads_size() == 0)
+    return {Exception::kInvalidProtocolBuffer};
+  for (const auto& bytes_payload : frame.bytes_payloads()) {
+    if (!bytes_payload.has_payload_header() ||
+        !bytes_payload.payload_header().has_id() ||
+        bytes_payload.payload_header().type() != PayloadHeader::BYTES ||
+        !bytes_payload.has_body() ||
+        bytes_payload.payload_header().total_size() !=
+            static_cast<std::int64_t>(bytes_payload.body().size()))
+      return {Exception::kInvalidProtocolBuffer};
+  }
+  return {Exception::kSuccess};
+}
+
 Exception EnsureValidPayloadTransferFrame(const PayloadTransferFrame& frame) {
+  // Batched BYTES payloads carry a header per payload instead of a frame-level
+  // one.
+  if (frame.packet_type() == PayloadTransferFrame::BYTES_BATCH)
+    return EnsureValidBytesPayloadBatch(frame);
   if (!frame.has_payload_header()) return {Exception::kInvalidProtocolBuffer};
   if (!frame.payload_header().has_total_size() ||
       (frame.payload_header().total_size() < 0 &&
@@ -341,7 +363,7 @@ Exception EnsureValidBandwidthUpgradeNegotiationFrame(
   return {Exception::kSuccess};
 }
 
-bool CheckForIllegalCharacters(std::string toBeValidated,
+bool CheckForIllegalCharacters(absl::string_view toBeValidated,
                                const absl::string_view illegalPatterns[],
                                size_t illegalPatternsSize) {
   if (toBeValidated.empty()) {
@@ -352,7 +374,7 @@ bool CheckForIllegalCharacters(std::string toBeValidated,
 
   size_t found = 0;
   for (int index = 0; index < illegalPatternsSize; index++) {
-    found = toBeValidated.find(std::string(illegalPatterns[index]));
+    found = toBeValidated.find(illegalPatterns[index]);
 
     if (found != std::string::npos) {
       // TODO(jfcarroll): Find a way to issue a log statement here.
@@ -369,6 +391,29 @@ bool CheckForIllegalCharacters(std::string toBeValidated,
 
 }  // namespace
 
+Exception EnsureValidPayloadDataFrame(const PayloadTransferFrame& frame) {
+  const PayloadHeader& header = frame.payload_header();
+  if (header.type() == PayloadHeader::FILE ||
+      header.type() == PayloadHeader::FILE_BATCH) {
+    if (CheckForIllegalCharacters(header.file_name(), kIllegalFileNamePatterns,
+                                  kIllegalFileNamePatternsSize) ||
+        CheckForIllegalCharacters(header.parent_folder(),
+                                  kIllegalParentFolderPatterns,
+                                  kIllegalParentFolderPatternsSize)) {
+      return {Exception::kIllegalCharacters};
+    }
+  }
+  if (!frame.has_payload_header() || !header.has_total_size() ||
+      (header.total_size() < 0 &&
+       header.total_size() != InternalPayload::kIndeterminateSize))
+    return {Exception::kInvalidProtocolBuffer};
+  if (frame.packet_type() != PayloadTransferFrame::DATA ||
+      !frame.has_payload_chunk())
+    return {Exception::kInvalidProtocolBuffer};
+  return EnsureValidPayloadTransferDataFrame(frame.payload_chunk(),
+                                             header.total_size());
+}
+
 Exception EnsureValidOfflineFrame(
     const location::nearby::connections::OfflineFrame& offline_frame) {
   V1Frame::FrameType frame_type = GetFrameType(offline_frame);
@@ -390,12 +435,21 @@ Exception EnsureValidOfflineFrame(
       return {Exception::kInvalidProtocolBuffer};
 
     case V1Frame::PAYLOAD_TRANSFER:
+      if (offline_frame.has_v1() &&
+          offline_frame.v1().payload_transfer().packet_type() ==
+              PayloadTransferFrame::DATA) {
+        return EnsureValidPayloadDataFrame(
+            offline_frame.v1().payload_transfer());
+      }
       if (offline_frame.has_v1() &&
           (offline_frame.v1().payload_transfer().payload_header().has_type() &&
-           offline_frame.v1().payload_transfer().payload_header().type() ==
-               location::nearby::connections::
-                   PayloadTransferFrame_PayloadHeader_PayloadType::
-                       PayloadTransferFrame_PayloadHeader_PayloadType_FILE)) {
+           (offline_frame.v1().payload_transfer().payload_header().type() ==
+                location::nearby::connections::
+                    PayloadTransferFrame_PayloadHeader_PayloadType::
+                        PayloadTransferFrame_PayloadHeader_PayloadType_FILE ||
+            offline_frame.v1().payload_transfer().payload_header().type() ==
+                location::nearby::connections::PayloadTransferFrame::
+                    PayloadHeader::FILE_BATCH))) {
         if (offline_frame.v1()
                 .payload_transfer()
                 .payload_header()
@@ -39,6 +39,12 @@ const size_t kIllegalParentFolderPatternsSize =
 Exception EnsureValidOfflineFrame(
     const location::nearby::connections::OfflineFrame& offline_frame);
 
+// Validates a PAYLOAD_TRANSFER frame of the DATA packet type, the one each
+// payload chunk comes in. EnsureValidOfflineFrame() takes this path for them;
+// it checks just the payload header and chunk, without copying any strings.
+Exception EnsureValidPayloadDataFrame(
+    const location::nearby::connections::PayloadTransferFrame& frame);
+
 }  // namespace parser
 }  // namespace connections
 }  // namespace nearby
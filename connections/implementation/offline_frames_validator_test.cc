@@ -16,6 +16,7 @@
 
 #include <array>
 #include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "absl/strings/string_view.h"
@@ -216,6 +217,59 @@ TEST(OfflineFramesValidatorTest, ValidatesAsOkWithValidPayloadTransferFrame) {
   ASSERT_TRUE(ret_value.Ok());
 }
 
+TEST(OfflineFramesValidatorTest, ValidatesAsOkWithValidBytesPayloadBatch) {
+  std::vector<PayloadTransferFrame::BytesPayload> payloads(2);
+  payloads[0].mutable_payload_header()->set_id(1);
+  payloads[0].mutable_payload_header()->set_type(
+      PayloadTransferFrame::PayloadHeader::BYTES);
+  payloads[0].mutable_payload_header()->set_total_size(5);
+  payloads[0].set_body("hello");
+  payloads[1].mutable_payload_header()->set_id(2);
+  payloads[1].mutable_payload_header()->set_type(
+      PayloadTransferFrame::PayloadHeader::BYTES);
+  payloads[1].mutable_payload_header()->set_total_size(5);
+  payloads[1].set_body("world");
+
+  OfflineFrame offline_frame;
+
+  ByteArray bytes = ForBytesPayloadBatch(payloads);
+  offline_frame.ParseFromString(std::string(bytes));
+
+  auto ret_value = EnsureValidOfflineFrame(offline_frame);
+
+  ASSERT_TRUE(ret_value.Ok());
+}
+
+TEST(OfflineFramesValidatorTest,
+     ValidatesAsFailWithBytesPayloadBatchSizeMismatch) {
+  std::vector<PayloadTransferFrame::BytesPayload> payloads(1);
+  payloads[0].mutable_payload_header()->set_id(1);
+  payloads[0].mutable_payload_header()->set_type(
+      PayloadTransferFrame::PayloadHeader::BYTES);
+  payloads[0].mutable_payload_header()->set_total_size(1024);
+  payloads[0].set_body("hello");
+
+  OfflineFrame offline_frame;
+
+  ByteArray bytes = ForBytesPayloadBatch(payloads);
+  offline_frame.ParseFromString(std::string(bytes));
+
+  auto ret_value = EnsureValidOfflineFrame(offline_frame);
+
+  ASSERT_FALSE(ret_value.Ok());
+}
+
+TEST(OfflineFramesValidatorTest, ValidatesAsFailWithEmptyBytesPayloadBatch) {
+  OfflineFrame offline_frame;
+
+  ByteArray bytes = ForBytesPayloadBatch({});
+  offline_frame.ParseFromString(std::string(bytes));
+
+  auto ret_value = EnsureValidOfflineFrame(offline_frame);
+
+  ASSERT_FALSE(ret_value.Ok());
+}
+
 TEST(OfflineFramesValidatorTest,
      ValidatesAsOkTypeFileWithEmptyFilePathAndParent) {
   PayloadTransferFrame::PayloadHeader header;
@@ -341,6 +395,60 @@ TEST(OfflineFramesValidatorTest,
 
   ASSERT_TRUE(ret_value.value == Exception::kIllegalCharacters);
 }
+TEST(OfflineFramesValidatorTest, ValidatesPayloadDataFrameLikeOfflineFrame) {
+  PayloadTransferFrame::PayloadHeader header;
+  PayloadTransferFrame::PayloadChunk chunk;
+  header.set_id(12345);
+  header.set_type(PayloadTransferFrame::PayloadHeader::FILE);
+  header.set_total_size(1024);
+  header.set_file_name("earth.jpg");
+  chunk.set_body("payload data");
+  chunk.set_offset(150);
+  chunk.set_flags(0);
+
+  OfflineFrame offline_frame;
+  offline_frame.ParseFromString(
+      std::string(ForDataPayloadTransfer(header, chunk)));
+  EXPECT_TRUE(
+      EnsureValidPayloadDataFrame(offline_frame.v1().payload_transfer()).Ok());
+
+  header.set_file_name("../earth.jpg");
+  offline_frame.ParseFromString(
+      std::string(ForDataPayloadTransfer(header, chunk)));
+  EXPECT_EQ(
+      EnsureValidPayloadDataFrame(offline_frame.v1().payload_transfer()).value,
+      Exception::kIllegalCharacters);
+
+  header.set_file_name("earth.jpg");
+  chunk.set_offset(2048);
+  offline_frame.ParseFromString(
+      std::string(ForDataPayloadTransfer(header, chunk)));
+  EXPECT_EQ(
+      EnsureValidPayloadDataFrame(offline_frame.v1().payload_transfer()).value,
+      Exception::kInvalidProtocolBuffer);
+  EXPECT_EQ(EnsureValidOfflineFrame(offline_frame).value,
+            Exception::kInvalidProtocolBuffer);
+}
+
+TEST(OfflineFramesValidatorTest, PayloadDataFrameValidatorRejectsControlFrame) {
+  PayloadTransferFrame::PayloadHeader header;
+  PayloadTransferFrame::ControlMessage control;
+  header.set_id(12345);
+  header.set_type(PayloadTransferFrame::PayloadHeader::BYTES);
+  header.set_total_size(1024);
+  control.set_event(PayloadTransferFrame::ControlMessage::PAYLOAD_CANCELED);
+  control.set_offset(150);
+
+  OfflineFrame offline_frame;
+  offline_frame.ParseFromString(
+      std::string(ForControlPayloadTransfer(header, control)));
+
+  EXPECT_EQ(
+      EnsureValidPayloadDataFrame(offline_frame.v1().payload_transfer()).value,
+      Exception::kInvalidProtocolBuffer);
+  EXPECT_TRUE(EnsureValidOfflineFrame(offline_frame).Ok());
+}
+
 TEST(OfflineFramesValidatorTest, ValidatesAsFailWithNullPayloadTransferFrame) {
   PayloadTransferFrame::PayloadHeader header;
   PayloadTransferFrame::PayloadChunk chunk;
@@ -56,6 +56,11 @@ void OfflineSimulationUser::OnEndpointDisconnect(
   if (disconnect_latch_) disconnect_latch_->CountDown();
 }
 
+void OfflineSimulationUser::OnBandwidthChanged(const std::string& endpoint_id,
+                                               Medium medium) {
+  if (bandwidth_changed_latch_) bandwidth_changed_latch_->CountDown();
+}
+
 void OfflineSimulationUser::OnEndpointFound(const std::string& endpoint_id,
                                             const ByteArray& endpoint_info,
                                             const std::string& service_id) {
@@ -118,6 +123,8 @@ Status OfflineSimulationUser::StartAdvertising(const std::string& service_id,
           absl::bind_front(&OfflineSimulationUser::OnConnectionRejected, this),
       .disconnected_cb =
           absl::bind_front(&OfflineSimulationUser::OnEndpointDisconnect, this),
+      .bandwidth_changed_cb =
+          absl::bind_front(&OfflineSimulationUser::OnBandwidthChanged, this),
   };
   return ctrl_.StartAdvertising(&client_, service_id_, advertising_options_,
                                 {
@@ -165,6 +172,8 @@ Status OfflineSimulationUser::RequestConnection(CountDownLatch* latch) {
           absl::bind_front(&OfflineSimulationUser::OnConnectionRejected, this),
       .disconnected_cb =
           absl::bind_front(&OfflineSimulationUser::OnEndpointDisconnect, this),
+      .bandwidth_changed_cb =
+          absl::bind_front(&OfflineSimulationUser::OnBandwidthChanged, this),
   };
   client_.AddCancellationFlag(discovered_.endpoint_id);
   return ctrl_.RequestConnection(&client_, discovered_.endpoint_id,
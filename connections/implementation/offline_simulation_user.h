@@ -21,6 +21,8 @@
 #include "absl/strings/string_view.h"
 #include "connections/implementation/client_proxy.h"
 #include "connections/implementation/offline_service_controller.h"
+#include "connections/implementation/transport_config.h"
+#include "internal/analytics/event_logger.h"
 #include "internal/platform/atomic_boolean.h"
 #include "internal/platform/condition_variable.h"
 #include "internal/platform/count_down_latch.h"
@@ -48,7 +50,8 @@ class OfflineSimulationUser {
 
   explicit OfflineSimulationUser(
       absl::string_view device_name,
-      BooleanMediumSelector allowed = BooleanMediumSelector())
+      BooleanMediumSelector allowed = BooleanMediumSelector(),
+      analytics::EventLogger* event_logger = nullptr)
       : info_{ByteArray{std::string(device_name)}},
         advertising_options_{
             {
@@ -57,17 +60,16 @@ class OfflineSimulationUser {
             },
         },
         connection_options_{
-            .keep_alive_interval_millis = FeatureFlags::GetInstance()
-                                              .GetFlags()
-                                              .keep_alive_interval_millis,
-            .keep_alive_timeout_millis = FeatureFlags::GetInstance()
-                                             .GetFlags()
-                                             .keep_alive_timeout_millis,
+            .keep_alive_interval_millis =
+                TransportConfig::Get().keep_alive_interval_millis,
+            .keep_alive_timeout_millis =
+                TransportConfig::Get().keep_alive_timeout_millis,
         },
         discovery_options_{{
             Strategy::kP2pCluster,
             allowed,
-        }} {}
+        }},
+        client_{event_logger} {}
   virtual ~OfflineSimulationUser() = default;
 
   // Calls PcpManager::StartAdvertising().
@@ -119,6 +121,11 @@ class OfflineSimulationUser {
 
   void ExpectPayload(CountDownLatch& latch) { payload_latch_ = &latch; }
   void ExpectDisconnect(CountDownLatch& latch) { disconnect_latch_ = &latch; }
+  // latch.CountDown() will be called in the bandwidth_changed_cb callback,
+  // i.e. once a bandwidth upgrade has completed.
+  void ExpectBandwidthChanged(CountDownLatch& latch) {
+    bandwidth_changed_latch_ = &latch;
+  }
 
   const DiscoveredInfo& GetDiscovered() const { return discovered_; }
   ByteArray GetInfo() const { return info_; }
@@ -164,6 +171,7 @@ class OfflineSimulationUser {
   void OnConnectionAccepted(const std::string& endpoint_id);
   void OnConnectionRejected(const std::string& endpoint_id, Status status);
   void OnEndpointDisconnect(const std::string& endpoint_id);
+  void OnBandwidthChanged(const std::string& endpoint_id, Medium medium);
 
   // DiscoveryListener callbacks
   void OnEndpointFound(const std::string& endpoint_id,
@@ -194,6 +202,7 @@ class OfflineSimulationUser {
   CountDownLatch* lost_latch_ = nullptr;
   CountDownLatch* payload_latch_ = nullptr;
   CountDownLatch* disconnect_latch_ = nullptr;
+  CountDownLatch* bandwidth_changed_latch_ = nullptr;
   Future<bool>* future_ = nullptr;
   std::function<bool(const PayloadProgressInfo&)> predicate_;
   ClientProxy client_;
@@ -64,14 +64,6 @@ P2pClusterPcpHandler::P2pClusterPcpHandler(
     InjectedBluetoothDeviceStore& injected_bluetooth_device_store, Pcp pcp)
     : BasePcpHandler(mediums, endpoint_manager, endpoint_channel_manager,
                      bwu_manager, pcp),
-      bluetooth_radio_(mediums->GetBluetoothRadio()),
-      bluetooth_medium_(mediums->GetBluetoothClassic()),
-      ble_medium_(mediums->GetBle()),
-      ble_v2_medium_(mediums->GetBleV2()),
-      wifi_lan_medium_(mediums->GetWifiLan()),
-      wifi_hotspot_medium_(mediums->GetWifiHotspot()),
-      wifi_direct_medium_(mediums->GetWifiDirect()),
-      webrtc_medium_(mediums->GetWebRtc()),
       injected_bluetooth_device_store_(injected_bluetooth_device_store) {}
 
 // Returns a vector or mediums sorted in order or decreasing priority for
@@ -80,22 +72,22 @@ P2pClusterPcpHandler::P2pClusterPcpHandler(
 std::vector<location::nearby::proto::connections::Medium>
 P2pClusterPcpHandler::GetConnectionMediumsByPriority() {
   std::vector<location::nearby::proto::connections::Medium> mediums;
-  if (wifi_lan_medium_.IsAvailable()) {
+  if (wifi_lan_medium().IsAvailable()) {
     mediums.push_back(location::nearby::proto::connections::WIFI_LAN);
   }
-  if (webrtc_medium_.IsAvailable()) {
+  if (webrtc_medium().IsAvailable()) {
     mediums.push_back(location::nearby::proto::connections::WEB_RTC);
   }
-  if (bluetooth_medium_.IsAvailable()) {
+  if (bluetooth_medium().IsAvailable()) {
     mediums.push_back(location::nearby::proto::connections::BLUETOOTH);
   }
   if (NearbyFlags::GetInstance().GetBoolFlag(
           config_package_nearby::nearby_connections_feature::kEnableBleV2)) {
-    if (ble_v2_medium_.IsAvailable()) {
+    if (ble_v2_medium().IsAvailable()) {
       mediums.push_back(location::nearby::proto::connections::BLE);
     }
   } else {
-    if (ble_medium_.IsAvailable()) {
+    if (ble_medium().IsAvailable()) {
       mediums.push_back(location::nearby::proto::connections::BLE);
     }
   }
@@ -191,7 +183,7 @@ BasePcpHandler::StartOperationResult P2pClusterPcpHandler::StartAdvertisingImpl(
 
 Status P2pClusterPcpHandler::StopAdvertisingImpl(ClientProxy* client) {
   if (client->GetClientId() == bluetooth_classic_advertiser_client_id_) {
-    bluetooth_medium_.TurnOffDiscoverability();
+    bluetooth_medium().TurnOffDiscoverability();
     bluetooth_classic_advertiser_client_id_ = 0;
   } else {
     NEARBY_LOGS(INFO) << "Skipped BT TurnOffDiscoverability for client="
@@ -200,23 +192,121 @@ Status P2pClusterPcpHandler::StopAdvertisingImpl(ClientProxy* client) {
                       << bluetooth_classic_advertiser_client_id_;
   }
 
-  bluetooth_medium_.StopAcceptingConnections(client->GetAdvertisingServiceId());
+  bluetooth_medium().StopAcceptingConnections(
+      client->GetAdvertisingServiceId());
 
   if (NearbyFlags::GetInstance().GetBoolFlag(
           config_package_nearby::nearby_connections_feature::kEnableBleV2)) {
-    ble_v2_medium_.StopAdvertising(client->GetAdvertisingServiceId());
-    ble_v2_medium_.StopAcceptingConnections(client->GetAdvertisingServiceId());
+    ble_v2_medium().StopAdvertising(client->GetAdvertisingServiceId());
+    ble_v2_medium().StopAcceptingConnections(client->GetAdvertisingServiceId());
   } else {
-    ble_medium_.StopAdvertising(client->GetAdvertisingServiceId());
-    ble_medium_.StopAcceptingConnections(client->GetAdvertisingServiceId());
+    ble_medium().StopAdvertising(client->GetAdvertisingServiceId());
+    ble_medium().StopAcceptingConnections(client->GetAdvertisingServiceId());
   }
 
-  wifi_lan_medium_.StopAdvertising(client->GetAdvertisingServiceId());
-  wifi_lan_medium_.StopAcceptingConnections(client->GetAdvertisingServiceId());
+  wifi_lan_medium().StopAdvertising(client->GetAdvertisingServiceId());
+  wifi_lan_medium().StopAcceptingConnections(client->GetAdvertisingServiceId());
 
   return {Status::kSuccess};
 }
 
+BasePcpHandler::StartOperationResult
+P2pClusterPcpHandler::UpdateAdvertisingImpl(
+    ClientProxy* client, const std::string& service_id,
+    const std::string& local_endpoint_id, const ByteArray& local_endpoint_info,
+    const AdvertisingOptions& old_options,
+    const AdvertisingOptions& new_options) {
+  bool is_ble_v2 = NearbyFlags::GetInstance().GetBoolFlag(
+      config_package_nearby::nearby_connections_feature::kEnableBleV2);
+  // The BLE advertisement depends on the power level and the fast
+  // advertisement service UUID, so BLE is the only medium that has to restart
+  // when they change. The mediums that are kept on keep running untouched.
+  bool restart_ble =
+      old_options.allowed.ble &&
+      (!new_options.allowed.ble ||
+       old_options.low_power != new_options.low_power ||
+       old_options.fast_advertisement_service_uuid !=
+           new_options.fast_advertisement_service_uuid ||
+       old_options.enable_bluetooth_listening !=
+           new_options.enable_bluetooth_listening);
+
+  if (old_options.allowed.wifi_lan && !new_options.allowed.wifi_lan) {
+    wifi_lan_medium().StopAdvertising(service_id);
+    wifi_lan_medium().StopAcceptingConnections(service_id);
+  }
+  if (old_options.allowed.bluetooth && !new_options.allowed.bluetooth &&
+      client->GetClientId() == bluetooth_classic_advertiser_client_id_) {
+    bluetooth_medium().TurnOffDiscoverability();
+    bluetooth_classic_advertiser_client_id_ = 0;
+  }
+  if (restart_ble) {
+    if (is_ble_v2) {
+      ble_v2_medium().StopAdvertising(service_id);
+      if (!new_options.allowed.ble) {
+        ble_v2_medium().StopAcceptingConnections(service_id);
+      }
+    } else {
+      ble_medium().StopAdvertising(service_id);
+      if (!new_options.allowed.ble) {
+        ble_medium().StopAcceptingConnections(service_id);
+      }
+    }
+  }
+  // BLE may accept Bluetooth connections on its own, see
+  // StartBleAdvertising().
+  PowerLevel power_level = new_options.low_power ? PowerLevel::kLowPower
+                                                 : PowerLevel::kHighPower;
+  if (!new_options.allowed.bluetooth &&
+      !(new_options.allowed.ble &&
+        (ShouldAdvertiseBluetoothMacOverBle(power_level) ||
+         ShouldAcceptBluetoothConnections(new_options)))) {
+    bluetooth_medium().StopAcceptingConnections(service_id);
+  }
+
+  std::vector<location::nearby::proto::connections::Medium> mediums;
+  if (old_options.allowed.wifi_lan && new_options.allowed.wifi_lan &&
+      wifi_lan_medium().IsAdvertising(service_id)) {
+    mediums.push_back(location::nearby::proto::connections::WIFI_LAN);
+  }
+  if (old_options.allowed.bluetooth && new_options.allowed.bluetooth &&
+      client->GetClientId() == bluetooth_classic_advertiser_client_id_) {
+    mediums.push_back(location::nearby::proto::connections::BLUETOOTH);
+  }
+  if (old_options.allowed.ble && !restart_ble &&
+      (is_ble_v2 ? ble_v2_medium().IsAdvertising(service_id)
+                 : ble_medium().IsAdvertising(service_id))) {
+    mediums.push_back(location::nearby::proto::connections::BLE);
+  }
+
+  AdvertisingOptions started_options = new_options;
+  started_options.allowed.wifi_lan =
+      new_options.allowed.wifi_lan && !old_options.allowed.wifi_lan;
+  started_options.allowed.bluetooth =
+      new_options.allowed.bluetooth && !old_options.allowed.bluetooth;
+  started_options.allowed.ble =
+      new_options.allowed.ble && (!old_options.allowed.ble || restart_ble);
+  if (started_options.allowed.wifi_lan || started_options.allowed.bluetooth ||
+      started_options.allowed.ble) {
+    StartOperationResult result =
+        StartAdvertisingImpl(client, service_id, local_endpoint_id,
+                             local_endpoint_info, started_options);
+    mediums.insert(mediums.end(), result.mediums.begin(), result.mediums.end());
+  }
+
+  if (mediums.empty()) {
+    NEARBY_LOGS(ERROR) << "Failed UpdateAdvertisingOptions("
+                       << absl::BytesToHexString(local_endpoint_info.data())
+                       << ") for client=" << client->GetClientId();
+    return {
+        .status = {Status::kBluetoothError},
+    };
+  }
+  return {
+      .status = {Status::kSuccess},
+      .mediums = std::move(mediums),
+  };
+}
+
 bool P2pClusterPcpHandler::IsRecognizedBluetoothEndpoint(
     const std::string& name_string, const std::string& service_id,
     const BluetoothDeviceName& name) const {
@@ -523,7 +613,7 @@ void P2pClusterPcpHandler::BlePeripheralDiscoveredHandler(
         }
 
         BluetoothDevice remote_bluetooth_device =
-            bluetooth_medium_.GetRemoteDevice(remote_bluetooth_mac_address);
+            bluetooth_medium().GetRemoteDevice(remote_bluetooth_mac_address);
         if (!remote_bluetooth_device.IsValid()) {
           NEARBY_LOGS(INFO)
               << "A valid Bluetooth device could not be derived from the MAC "
@@ -700,7 +790,7 @@ void P2pClusterPcpHandler::BleV2PeripheralDiscoveredHandler(
         }
 
         BluetoothDevice remote_bluetooth_device =
-            bluetooth_medium_.GetRemoteDevice(remote_bluetooth_mac_address);
+            bluetooth_medium().GetRemoteDevice(remote_bluetooth_mac_address);
         if (!remote_bluetooth_device.IsValid()) {
           NEARBY_LOGS(INFO)
               << "A valid Bluetooth device could not be derived from the MAC "
@@ -1046,9 +1136,9 @@ BasePcpHandler::StartOperationResult P2pClusterPcpHandler::StartDiscoveryImpl(
 }
 
 Status P2pClusterPcpHandler::StopDiscoveryImpl(ClientProxy* client) {
-  wifi_lan_medium_.StopDiscovery(client->GetDiscoveryServiceId());
+  wifi_lan_medium().StopDiscovery(client->GetDiscoveryServiceId());
   if (client->GetClientId() == bluetooth_classic_discoverer_client_id_) {
-    bluetooth_medium_.StopDiscovery();
+    bluetooth_medium().StopDiscovery();
     bluetooth_classic_discoverer_client_id_ = 0;
   } else {
     NEARBY_LOGS(INFO) << "Skipped BT StopDiscovery for client="
@@ -1059,13 +1149,93 @@ Status P2pClusterPcpHandler::StopDiscoveryImpl(ClientProxy* client) {
 
   if (NearbyFlags::GetInstance().GetBoolFlag(
           config_package_nearby::nearby_connections_feature::kEnableBleV2)) {
-    ble_v2_medium_.StopScanning(client->GetDiscoveryServiceId());
+    ble_v2_medium().StopScanning(client->GetDiscoveryServiceId());
   } else {
-    ble_medium_.StopScanning(client->GetDiscoveryServiceId());
+    ble_medium().StopScanning(client->GetDiscoveryServiceId());
   }
   return {Status::kSuccess};
 }
 
+BasePcpHandler::StartOperationResult P2pClusterPcpHandler::UpdateDiscoveryImpl(
+    ClientProxy* client, const std::string& service_id,
+    const DiscoveryOptions& old_options, const DiscoveryOptions& new_options) {
+  // Out-of-band discovery doesn't run on any medium.
+  if (old_options.is_out_of_band_connection ||
+      new_options.is_out_of_band_connection) {
+    return BasePcpHandler::UpdateDiscoveryImpl(client, service_id, old_options,
+                                               new_options);
+  }
+
+  bool is_ble_v2 = NearbyFlags::GetInstance().GetBoolFlag(
+      config_package_nearby::nearby_connections_feature::kEnableBleV2);
+  // BLE scans with the power level and the fast advertisement service UUID,
+  // so it is the only medium that has to restart when they change.
+  bool restart_ble =
+      old_options.allowed.ble &&
+      (!new_options.allowed.ble ||
+       old_options.low_power != new_options.low_power ||
+       old_options.fast_advertisement_service_uuid !=
+           new_options.fast_advertisement_service_uuid);
+
+  if (old_options.allowed.wifi_lan && !new_options.allowed.wifi_lan) {
+    wifi_lan_medium().StopDiscovery(service_id);
+  }
+  if (old_options.allowed.bluetooth && !new_options.allowed.bluetooth &&
+      client->GetClientId() == bluetooth_classic_discoverer_client_id_) {
+    bluetooth_medium().StopDiscovery();
+    bluetooth_classic_discoverer_client_id_ = 0;
+  }
+  if (restart_ble) {
+    if (is_ble_v2) {
+      ble_v2_medium().StopScanning(service_id);
+    } else {
+      ble_medium().StopScanning(service_id);
+    }
+  }
+
+  std::vector<location::nearby::proto::connections::Medium> mediums;
+  if (old_options.allowed.wifi_lan && new_options.allowed.wifi_lan &&
+      wifi_lan_medium().IsDiscovering(service_id)) {
+    mediums.push_back(location::nearby::proto::connections::WIFI_LAN);
+  }
+  if (old_options.allowed.bluetooth && new_options.allowed.bluetooth &&
+      client->GetClientId() == bluetooth_classic_discoverer_client_id_) {
+    mediums.push_back(location::nearby::proto::connections::BLUETOOTH);
+  }
+  if (old_options.allowed.ble && !restart_ble &&
+      (is_ble_v2 ? ble_v2_medium().IsScanning(service_id)
+                 : ble_medium().IsScanning(service_id))) {
+    mediums.push_back(location::nearby::proto::connections::BLE);
+  }
+
+  DiscoveryOptions started_options = new_options;
+  started_options.allowed.wifi_lan =
+      new_options.allowed.wifi_lan && !old_options.allowed.wifi_lan;
+  started_options.allowed.bluetooth =
+      new_options.allowed.bluetooth && !old_options.allowed.bluetooth;
+  started_options.allowed.ble =
+      new_options.allowed.ble && (!old_options.allowed.ble || restart_ble);
+  if (started_options.allowed.wifi_lan || started_options.allowed.bluetooth ||
+      started_options.allowed.ble) {
+    StartOperationResult result =
+        StartDiscoveryImpl(client, service_id, started_options);
+    mediums.insert(mediums.end(), result.mediums.begin(), result.mediums.end());
+  }
+
+  if (mediums.empty()) {
+    NEARBY_LOGS(ERROR) << "Failed UpdateDiscoveryOptions() for client="
+                       << client->GetClientId()
+                       << " for service_id=" << service_id;
+    return {
+        .status = {Status::kBluetoothError},
+    };
+  }
+  return {
+      .status = {Status::kSuccess},
+      .mediums = std::move(mediums),
+  };
+}
+
 Status P2pClusterPcpHandler::InjectEndpointImpl(
     ClientProxy* client, const std::string& service_id,
     const OutOfBandConnectionMetadata& metadata) {
@@ -1099,11 +1269,24 @@ BasePcpHandler::ConnectImplResult P2pClusterPcpHandler::ConnectImpl(
         .status = {Status::kError},
     };
   }
+  return ConnectImpl(client, endpoint,
+                     client->GetCancellationFlag(endpoint->endpoint_id));
+}
+
+BasePcpHandler::ConnectImplResult P2pClusterPcpHandler::ConnectImpl(
+    ClientProxy* client, BasePcpHandler::DiscoveredEndpoint* endpoint,
+    CancellationFlag* cancellation_flag) {
+  if (!endpoint) {
+    return BasePcpHandler::ConnectImplResult{
+        .status = {Status::kError},
+    };
+  }
   switch (endpoint->medium) {
     case location::nearby::proto::connections::Medium::BLUETOOTH: {
       auto* bluetooth_endpoint = down_cast<BluetoothEndpoint*>(endpoint);
       if (bluetooth_endpoint) {
-        return BluetoothConnectImpl(client, bluetooth_endpoint);
+        return BluetoothConnectImpl(client, bluetooth_endpoint,
+                                    cancellation_flag);
       }
       break;
     }
@@ -1113,13 +1296,13 @@ BasePcpHandler::ConnectImplResult P2pClusterPcpHandler::ConnectImpl(
                   kEnableBleV2)) {
         auto* ble_v2_endpoint = down_cast<BleV2Endpoint*>(endpoint);
         if (ble_v2_endpoint) {
-          return BleV2ConnectImpl(client, ble_v2_endpoint);
+          return BleV2ConnectImpl(client, ble_v2_endpoint, cancellation_flag);
         }
 
       } else {
         auto* ble_endpoint = down_cast<BleEndpoint*>(endpoint);
         if (ble_endpoint) {
-          return BleConnectImpl(client, ble_endpoint);
+          return BleConnectImpl(client, ble_endpoint, cancellation_flag);
         }
       }
       break;
@@ -1127,7 +1310,7 @@ BasePcpHandler::ConnectImplResult P2pClusterPcpHandler::ConnectImpl(
     case location::nearby::proto::connections::Medium::WIFI_LAN: {
       auto* wifi_lan_endpoint = down_cast<WifiLanEndpoint*>(endpoint);
       if (wifi_lan_endpoint) {
-        return WifiLanConnectImpl(client, wifi_lan_endpoint);
+        return WifiLanConnectImpl(client, wifi_lan_endpoint, cancellation_flag);
       }
       break;
     }
@@ -1150,8 +1333,8 @@ P2pClusterPcpHandler::StartListeningForIncomingConnectionsImpl(
     v3::ConnectionListeningOptions options) {
   std::vector<Medium> started_mediums;
   if (options.enable_bluetooth_listening &&
-      !bluetooth_medium_.IsAcceptingConnections(std::string(service_id))) {
-    if (!bluetooth_medium_.StartAcceptingConnections(
+      !bluetooth_medium().IsAcceptingConnections(std::string(service_id))) {
+    if (!bluetooth_medium().StartAcceptingConnections(
             std::string(service_id),
             {.accepted_cb = absl::bind_front(
                  &P2pClusterPcpHandler::BluetoothConnectionAcceptedHandler,
@@ -1168,8 +1351,8 @@ P2pClusterPcpHandler::StartListeningForIncomingConnectionsImpl(
           config_package_nearby::nearby_connections_feature::kEnableBleV2)) {
     // ble_v2
     if (options.enable_ble_listening &&
-        !ble_v2_medium_.IsAcceptingConnections(std::string(service_id))) {
-      if (!ble_v2_medium_.StartAcceptingConnections(
+        !ble_v2_medium().IsAcceptingConnections(std::string(service_id))) {
+      if (!ble_v2_medium().StartAcceptingConnections(
               std::string(service_id),
               {.accepted_cb = absl::bind_front(
                    &P2pClusterPcpHandler::BleV2ConnectionAcceptedHandler, this,
@@ -1183,8 +1366,8 @@ P2pClusterPcpHandler::StartListeningForIncomingConnectionsImpl(
   } else {
     // ble v1
     if (options.enable_ble_listening &&
-        !ble_medium_.IsAcceptingConnections(std::string(service_id))) {
-      if (!ble_medium_.StartAcceptingConnections(
+        !ble_medium().IsAcceptingConnections(std::string(service_id))) {
+      if (!ble_medium().StartAcceptingConnections(
               std::string(service_id),
               {.accepted_cb = absl::bind_front(
                    &P2pClusterPcpHandler::BleConnectionAcceptedHandler, this,
@@ -1197,8 +1380,8 @@ P2pClusterPcpHandler::StartListeningForIncomingConnectionsImpl(
     }
   }
   if (options.enable_wlan_listening &&
-      !wifi_lan_medium_.IsAcceptingConnections(std::string(service_id))) {
-    if (!wifi_lan_medium_.StartAcceptingConnections(
+      !wifi_lan_medium().IsAcceptingConnections(std::string(service_id))) {
+    if (!wifi_lan_medium().StartAcceptingConnections(
             std::string(service_id),
             {.accepted_cb = absl::bind_front(
                  &P2pClusterPcpHandler::WifiLanConnectionAcceptedHandler, this,
@@ -1224,17 +1407,17 @@ P2pClusterPcpHandler::StartListeningForIncomingConnectionsImpl(
 
 void P2pClusterPcpHandler::StopListeningForIncomingConnectionsImpl(
     ClientProxy* client) {
-  if (wifi_lan_medium_.IsAcceptingConnections(
+  if (wifi_lan_medium().IsAcceptingConnections(
           client->GetListeningForIncomingConnectionsServiceId())) {
-    if (!wifi_lan_medium_.StopAcceptingConnections(
+    if (!wifi_lan_medium().StopAcceptingConnections(
             client->GetListeningForIncomingConnectionsServiceId())) {
       NEARBY_LOGS(WARNING)
           << "Unable to stop wifi lan from accepting connections.";
     }
   }
-  if (bluetooth_medium_.IsAcceptingConnections(
+  if (bluetooth_medium().IsAcceptingConnections(
           client->GetListeningForIncomingConnectionsServiceId())) {
-    if (!bluetooth_medium_.StopAcceptingConnections(
+    if (!bluetooth_medium().StopAcceptingConnections(
             client->GetListeningForIncomingConnectionsServiceId())) {
       NEARBY_LOGS(WARNING)
           << "Unable to stop bluetooth medium from accepting connections.";
@@ -1242,18 +1425,18 @@ void P2pClusterPcpHandler::StopListeningForIncomingConnectionsImpl(
   }
   if (NearbyFlags::GetInstance().GetBoolFlag(
           config_package_nearby::nearby_connections_feature::kEnableBleV2)) {
-    if (ble_v2_medium_.IsAcceptingConnections(
+    if (ble_v2_medium().IsAcceptingConnections(
             client->GetListeningForIncomingConnectionsServiceId())) {
-      if (!ble_v2_medium_.StopAcceptingConnections(
+      if (!ble_v2_medium().StopAcceptingConnections(
               client->GetListeningForIncomingConnectionsServiceId())) {
         NEARBY_LOGS(WARNING)
             << "Unable to stop ble_v2 medium from accepting connections.";
       }
     }
   } else {
-    if (ble_medium_.IsAcceptingConnections(
+    if (ble_medium().IsAcceptingConnections(
             client->GetListeningForIncomingConnectionsServiceId())) {
-      if (!ble_medium_.StopAcceptingConnections(
+      if (!ble_medium().StopAcceptingConnections(
               client->GetListeningForIncomingConnectionsServiceId())) {
         NEARBY_LOGS(WARNING)
             << "Unable to stop ble medium from accepting connections.";
@@ -1298,9 +1481,9 @@ P2pClusterPcpHandler::StartBluetoothAdvertising(
       INFO,
       "P2pClusterPcpHandler::StartBluetoothAdvertising: service=%s: start",
       service_id.c_str());
-  if (!bluetooth_medium_.IsAcceptingConnections(service_id)) {
-    if (!bluetooth_radio_.Enable() ||
-        !bluetooth_medium_.StartAcceptingConnections(
+  if (!bluetooth_medium().IsAcceptingConnections(service_id)) {
+    if (!bluetooth_radio().Enable() ||
+        !bluetooth_medium().StartAcceptingConnections(
             service_id,
             {.accepted_cb = absl::bind_front(
                  &P2pClusterPcpHandler::BluetoothConnectionAcceptedHandler,
@@ -1342,7 +1525,7 @@ P2pClusterPcpHandler::StartBluetoothAdvertising(
                          << ", endpoint_info="
                          << absl::BytesToHexString(local_endpoint_info.data())
                          << "}.";
-    bluetooth_medium_.StopAcceptingConnections(service_id);
+    bluetooth_medium().StopAcceptingConnections(service_id);
     return location::nearby::proto::connections::UNKNOWN_MEDIUM;
   }
   NEARBY_LOGS(INFO) << "In StartBluetoothAdvertising("
@@ -1352,14 +1535,14 @@ P2pClusterPcpHandler::StartBluetoothAdvertising(
                     << " with service_id=" << service_id;
 
   // Become Bluetooth discoverable.
-  if (!bluetooth_medium_.TurnOnDiscoverability(device_name)) {
+  if (!bluetooth_medium().TurnOnDiscoverability(device_name)) {
     NEARBY_LOGS(INFO)
         << "In StartBluetoothAdvertising("
         << absl::BytesToHexString(local_endpoint_info.data())
         << "), client=" << client->GetClientId()
         << " couldn't start Bluetooth advertising with BluetoothDeviceName "
         << device_name;
-    bluetooth_medium_.StopAcceptingConnections(service_id);
+    bluetooth_medium().StopAcceptingConnections(service_id);
     return location::nearby::proto::connections::UNKNOWN_MEDIUM;
   }
   NEARBY_LOGS(INFO)
@@ -1375,8 +1558,8 @@ location::nearby::proto::connections::Medium
 P2pClusterPcpHandler::StartBluetoothDiscovery(
     BluetoothDiscoveredDeviceCallback callback, ClientProxy* client,
     const std::string& service_id) {
-  if (bluetooth_radio_.Enable() &&
-      bluetooth_medium_.StartDiscovery(std::move(callback))) {
+  if (bluetooth_radio().Enable() &&
+      bluetooth_medium().StartDiscovery(std::move(callback))) {
     NEARBY_LOGS(INFO) << "In StartBluetoothDiscovery(), client="
                       << client->GetClientId()
                       << " started scanning for Bluetooth for service_id="
@@ -1392,15 +1575,15 @@ P2pClusterPcpHandler::StartBluetoothDiscovery(
 }
 
 BasePcpHandler::ConnectImplResult P2pClusterPcpHandler::BluetoothConnectImpl(
-    ClientProxy* client, BluetoothEndpoint* endpoint) {
+    ClientProxy* client, BluetoothEndpoint* endpoint,
+    CancellationFlag* cancellation_flag) {
   NEARBY_LOGS(VERBOSE) << "Client " << client->GetClientId()
                        << " is attempting to connect to endpoint(id="
                        << endpoint->endpoint_id << ") over Bluetooth Classic.";
   BluetoothDevice& device = endpoint->bluetooth_device;
 
-  BluetoothSocket bluetooth_socket = bluetooth_medium_.Connect(
-      device, endpoint->service_id,
-      client->GetCancellationFlag(endpoint->endpoint_id));
+  BluetoothSocket bluetooth_socket = bluetooth_medium().Connect(
+      device, endpoint->service_id, cancellation_flag);
   if (!bluetooth_socket.IsValid()) {
     NEARBY_LOGS(ERROR)
         << "In BluetoothConnectImpl(), failed to connect to Bluetooth device "
@@ -1467,9 +1650,9 @@ P2pClusterPcpHandler::StartBleAdvertising(
   // Bluetooth Classic.
   NEARBY_LOGS(INFO) << "P2pClusterPcpHandler::StartBleAdvertising: service_id="
                     << service_id << " : start";
-  if (!ble_medium_.IsAcceptingConnections(service_id)) {
-    if (!bluetooth_radio_.Enable() ||
-        !ble_medium_.StartAcceptingConnections(
+  if (!ble_medium().IsAcceptingConnections(service_id)) {
+    if (!bluetooth_radio().Enable() ||
+        !ble_medium().StartAcceptingConnections(
             service_id,
             {.accepted_cb = absl::bind_front(
                  &P2pClusterPcpHandler::BleConnectionAcceptedHandler, this,
@@ -1493,10 +1676,10 @@ P2pClusterPcpHandler::StartBleAdvertising(
 
   if (ShouldAdvertiseBluetoothMacOverBle(power_level) ||
       ShouldAcceptBluetoothConnections(advertising_options)) {
-    if (bluetooth_medium_.IsAvailable() &&
-        !bluetooth_medium_.IsAcceptingConnections(service_id)) {
-      if (!bluetooth_radio_.Enable() ||
-          !bluetooth_medium_.StartAcceptingConnections(
+    if (bluetooth_medium().IsAvailable() &&
+        !bluetooth_medium().IsAcceptingConnections(service_id)) {
+      if (!bluetooth_radio().Enable() ||
+          !bluetooth_medium().StartAcceptingConnections(
               service_id,
               {.accepted_cb = absl::bind_front(
                    &P2pClusterPcpHandler::BluetoothConnectionAcceptedHandler,
@@ -1508,7 +1691,7 @@ P2pClusterPcpHandler::StartBleAdvertising(
             << " failed to start accepting for incoming BLE connections to "
                "service_id="
             << service_id;
-        ble_medium_.StopAcceptingConnections(service_id);
+        ble_medium().StopAcceptingConnections(service_id);
         return location::nearby::proto::connections::UNKNOWN_MEDIUM;
       }
       NEARBY_LOGS(INFO)
@@ -1538,9 +1721,9 @@ P2pClusterPcpHandler::StartBleAdvertising(
     const ByteArray service_id_hash =
         GenerateHash(service_id, BleAdvertisement::kServiceIdHashLength);
     std::string bluetooth_mac_address;
-    if (bluetooth_medium_.IsAvailable() &&
+    if (bluetooth_medium().IsAvailable() &&
         ShouldAdvertiseBluetoothMacOverBle(power_level))
-      bluetooth_mac_address = bluetooth_medium_.GetMacAddress();
+      bluetooth_mac_address = bluetooth_medium().GetMacAddress();
 
     advertisement_bytes = ByteArray(
         BleAdvertisement(kBleAdvertisementVersion, GetPcp(), service_id_hash,
@@ -1552,7 +1735,7 @@ P2pClusterPcpHandler::StartBleAdvertising(
                          << absl::BytesToHexString(local_endpoint_info.data())
                          << "), client=" << client->GetClientId()
                          << " failed to create an advertisement.";
-    ble_medium_.StopAcceptingConnections(service_id);
+    ble_medium().StopAcceptingConnections(service_id);
     return location::nearby::proto::connections::UNKNOWN_MEDIUM;
   }
 
@@ -1562,7 +1745,7 @@ P2pClusterPcpHandler::StartBleAdvertising(
                     << " generated BleAdvertisement with service_id="
                     << service_id;
 
-  if (!ble_medium_.StartAdvertising(
+  if (!ble_medium().StartAdvertising(
           service_id, advertisement_bytes,
           advertising_options.fast_advertisement_service_uuid)) {
     NEARBY_LOGS(WARNING)
@@ -1571,7 +1754,7 @@ P2pClusterPcpHandler::StartBleAdvertising(
         << "), client=" << client->GetClientId()
         << " couldn't start BLE Advertising with BleAdvertisement "
         << absl::BytesToHexString(advertisement_bytes.data());
-    ble_medium_.StopAcceptingConnections(service_id);
+    ble_medium().StopAcceptingConnections(service_id);
     return location::nearby::proto::connections::UNKNOWN_MEDIUM;
   }
   NEARBY_LOGS(INFO) << "In startBleAdvertising("
@@ -1587,9 +1770,9 @@ P2pClusterPcpHandler::StartBleScanning(
     BleDiscoveredPeripheralCallback callback, ClientProxy* client,
     const std::string& service_id,
     const std::string& fast_advertisement_service_uuid) {
-  if (bluetooth_radio_.Enable() &&
-      ble_medium_.StartScanning(service_id, fast_advertisement_service_uuid,
-                                std::move(callback))) {
+  if (bluetooth_radio().Enable() &&
+      ble_medium().StartScanning(service_id, fast_advertisement_service_uuid,
+                                 std::move(callback))) {
     NEARBY_LOGS(INFO)
         << "In StartBleScanning(), client=" << client->GetClientId()
         << " started scanning for BLE advertisements for service_id="
@@ -1605,7 +1788,8 @@ P2pClusterPcpHandler::StartBleScanning(
 }
 
 BasePcpHandler::ConnectImplResult P2pClusterPcpHandler::BleConnectImpl(
-    ClientProxy* client, BleEndpoint* endpoint) {
+    ClientProxy* client, BleEndpoint* endpoint,
+    CancellationFlag* cancellation_flag) {
   NEARBY_LOGS(VERBOSE) << "Client " << client->GetClientId()
                        << " is attempting to connect to endpoint(id="
                        << endpoint->endpoint_id << ") over BLE.";
@@ -1613,8 +1797,7 @@ BasePcpHandler::ConnectImplResult P2pClusterPcpHandler::BleConnectImpl(
   BlePeripheral& peripheral = endpoint->ble_peripheral;
 
   BleSocket ble_socket =
-      ble_medium_.Connect(peripheral, endpoint->service_id,
-                          client->GetCancellationFlag(endpoint->endpoint_id));
+      ble_medium().Connect(peripheral, endpoint->service_id, cancellation_flag);
   if (!ble_socket.IsValid()) {
     NEARBY_LOGS(ERROR)
         << "In BleConnectImpl(), failed to connect to BLE device "
@@ -1668,9 +1851,9 @@ P2pClusterPcpHandler::StartBleV2Advertising(
   // Bluetooth Classic.
   NEARBY_LOGS(INFO) << "P2pClusterPcpHandler::StartBleAdvertising: service_id="
                     << service_id << " : start";
-  if (!ble_v2_medium_.IsAcceptingConnections(service_id)) {
-    if (!bluetooth_radio_.Enable() ||
-        !ble_v2_medium_.StartAcceptingConnections(
+  if (!ble_v2_medium().IsAcceptingConnections(service_id)) {
+    if (!bluetooth_radio().Enable() ||
+        !ble_v2_medium().StartAcceptingConnections(
             service_id,
             {.accepted_cb = absl::bind_front(
                  &P2pClusterPcpHandler::BleV2ConnectionAcceptedHandler, this,
@@ -1697,10 +1880,10 @@ P2pClusterPcpHandler::StartBleV2Advertising(
                                : PowerLevel::kHighPower;
   if (ShouldAdvertiseBluetoothMacOverBle(power_level) ||
       ShouldAcceptBluetoothConnections(advertising_options)) {
-    if (bluetooth_medium_.IsAvailable() &&
-        !bluetooth_medium_.IsAcceptingConnections(service_id)) {
-      if (!bluetooth_radio_.Enable() ||
-          !bluetooth_medium_.StartAcceptingConnections(
+    if (bluetooth_medium().IsAvailable() &&
+        !bluetooth_medium().IsAcceptingConnections(service_id)) {
+      if (!bluetooth_radio().Enable() ||
+          !bluetooth_medium().StartAcceptingConnections(
               service_id, {.accepted_cb = [this, client, local_endpoint_info](
                                               const std::string& service_id,
                                               BluetoothSocket socket) {
@@ -1737,7 +1920,7 @@ P2pClusterPcpHandler::StartBleV2Advertising(
             << " failed to start accepting for incoming BLE connections to "
                "service_id="
             << service_id;
-        ble_v2_medium_.StopAcceptingConnections(service_id);
+        ble_v2_medium().StopAcceptingConnections(service_id);
         return location::nearby::proto::connections::UNKNOWN_MEDIUM;
       }
       NEARBY_LOGS(INFO)
@@ -1768,9 +1951,9 @@ P2pClusterPcpHandler::StartBleV2Advertising(
     const ByteArray service_id_hash =
         GenerateHash(service_id, BleAdvertisement::kServiceIdHashLength);
     std::string bluetooth_mac_address;
-    if (bluetooth_medium_.IsAvailable() &&
+    if (bluetooth_medium().IsAvailable() &&
         ShouldAdvertiseBluetoothMacOverBle(power_level))
-      bluetooth_mac_address = bluetooth_medium_.GetMacAddress();
+      bluetooth_mac_address = bluetooth_medium().GetMacAddress();
 
     advertisement_bytes = ByteArray(BleAdvertisement(
         kBleAdvertisementVersion, GetPcp(), service_id_hash, local_endpoint_id,
@@ -1782,7 +1965,7 @@ P2pClusterPcpHandler::StartBleV2Advertising(
                          << absl::BytesToHexString(local_endpoint_info.data())
                          << "), client=" << client->GetClientId()
                          << " failed to create an advertisement.";
-    ble_v2_medium_.StopAcceptingConnections(service_id);
+    ble_v2_medium().StopAcceptingConnections(service_id);
     return location::nearby::proto::connections::UNKNOWN_MEDIUM;
   }
 
@@ -1792,7 +1975,7 @@ P2pClusterPcpHandler::StartBleV2Advertising(
                     << " generated BleAdvertisement with service_id="
                     << service_id;
 
-  if (!ble_v2_medium_.StartAdvertising(
+  if (!ble_v2_medium().StartAdvertising(
           service_id, advertisement_bytes, power_level,
           !advertising_options.fast_advertisement_service_uuid.empty())) {
     NEARBY_LOGS(WARNING)
@@ -1801,7 +1984,7 @@ P2pClusterPcpHandler::StartBleV2Advertising(
         << "), client=" << client->GetClientId()
         << " couldn't start BLE Advertising with BleAdvertisement "
         << absl::BytesToHexString(advertisement_bytes.data());
-    ble_v2_medium_.StopAcceptingConnections(service_id);
+    ble_v2_medium().StopAcceptingConnections(service_id);
     return location::nearby::proto::connections::UNKNOWN_MEDIUM;
   }
   NEARBY_LOGS(INFO) << "In startBleAdvertising("
@@ -1818,9 +2001,9 @@ P2pClusterPcpHandler::StartBleV2Scanning(
     const std::string& service_id, const DiscoveryOptions& discovery_options) {
   PowerLevel power_level = discovery_options.low_power ? PowerLevel::kLowPower
                                                        : PowerLevel::kHighPower;
-  if (bluetooth_radio_.Enable() &&
-      ble_v2_medium_.StartScanning(service_id, power_level,
-                                   std::move(callback))) {
+  if (bluetooth_radio().Enable() &&
+      ble_v2_medium().StartScanning(service_id, power_level,
+                                    std::move(callback))) {
     NEARBY_LOGS(INFO)
         << "In StartBleScanning(), client=" << client->GetClientId()
         << " started scanning for BLE advertisements for service_id="
@@ -1835,16 +2018,16 @@ P2pClusterPcpHandler::StartBleV2Scanning(
 }
 
 BasePcpHandler::ConnectImplResult P2pClusterPcpHandler::BleV2ConnectImpl(
-    ClientProxy* client, BleV2Endpoint* endpoint) {
+    ClientProxy* client, BleV2Endpoint* endpoint,
+    CancellationFlag* cancellation_flag) {
   NEARBY_LOGS(VERBOSE) << "Client " << client->GetClientId()
                        << " is attempting to connect to endpoint(id="
                        << endpoint->endpoint_id << ") over BLE.";
 
   BleV2Peripheral& peripheral = endpoint->ble_peripheral;
 
-  BleV2Socket ble_socket = ble_v2_medium_.Connect(
-      endpoint->service_id, peripheral,
-      client->GetCancellationFlag(endpoint->endpoint_id));
+  BleV2Socket ble_socket = ble_v2_medium().Connect(
+      endpoint->service_id, peripheral, cancellation_flag);
   if (!ble_socket.IsValid()) {
     NEARBY_LOGS(ERROR)
         << "In BleConnectImpl(), failed to connect to BLE device "
@@ -1899,8 +2082,8 @@ P2pClusterPcpHandler::StartWifiLanAdvertising(
   // request comes in very quickly.
   NEARBY_LOGS(INFO) << "P2pClusterPcpHandler::StartWifiLanAdvertising: service="
                     << service_id << ": start";
-  if (!wifi_lan_medium_.IsAcceptingConnections(service_id)) {
-    if (!wifi_lan_medium_.StartAcceptingConnections(
+  if (!wifi_lan_medium().IsAcceptingConnections(service_id)) {
+    if (!wifi_lan_medium().StartAcceptingConnections(
             service_id,
             {.accepted_cb = absl::bind_front(
                  &P2pClusterPcpHandler::WifiLanConnectionAcceptedHandler, this,
@@ -1948,7 +2131,7 @@ P2pClusterPcpHandler::StartWifiLanAdvertising(
                          << ", endpoint_info="
                          << absl::BytesToHexString(local_endpoint_info.data())
                          << "}.";
-    wifi_lan_medium_.StopAcceptingConnections(service_id);
+    wifi_lan_medium().StopAcceptingConnections(service_id);
     return location::nearby::proto::connections::UNKNOWN_MEDIUM;
   }
   NEARBY_LOGS(INFO) << "In StartWifiLanAdvertising("
@@ -1958,13 +2141,13 @@ P2pClusterPcpHandler::StartWifiLanAdvertising(
                     << nsd_service_info.GetServiceName()
                     << " with service_id=" << service_id;
 
-  if (!wifi_lan_medium_.StartAdvertising(service_id, nsd_service_info)) {
+  if (!wifi_lan_medium().StartAdvertising(service_id, nsd_service_info)) {
     NEARBY_LOGS(INFO) << "In StartWifiLanAdvertising("
                       << absl::BytesToHexString(local_endpoint_info.data())
                       << "), client=" << client->GetClientId()
                       << " couldn't advertise with WifiLanServiceInfo "
                       << nsd_service_info.GetServiceName();
-    wifi_lan_medium_.StopAcceptingConnections(service_id);
+    wifi_lan_medium().StopAcceptingConnections(service_id);
     return location::nearby::proto::connections::UNKNOWN_MEDIUM;
   }
   NEARBY_LOGS(INFO) << "In StartWifiLanAdvertising("
@@ -1979,7 +2162,7 @@ location::nearby::proto::connections::Medium
 P2pClusterPcpHandler::StartWifiLanDiscovery(
     WifiLanDiscoveredServiceCallback callback, ClientProxy* client,
     const std::string& service_id) {
-  if (wifi_lan_medium_.StartDiscovery(service_id, std::move(callback))) {
+  if (wifi_lan_medium().StartDiscovery(service_id, std::move(callback))) {
     NEARBY_LOGS(INFO) << "In StartWifiLanDiscovery(), client="
                       << client->GetClientId()
                       << " started scanning for Wifi devices for service_id="
@@ -1995,13 +2178,13 @@ P2pClusterPcpHandler::StartWifiLanDiscovery(
 }
 
 BasePcpHandler::ConnectImplResult P2pClusterPcpHandler::WifiLanConnectImpl(
-    ClientProxy* client, WifiLanEndpoint* endpoint) {
+    ClientProxy* client, WifiLanEndpoint* endpoint,
+    CancellationFlag* cancellation_flag) {
   NEARBY_LOGS(INFO) << "Client " << client->GetClientId()
                     << " is attempting to connect to endpoint(id="
                     << endpoint->endpoint_id << ") over WifiLan.";
-  WifiLanSocket socket = wifi_lan_medium_.Connect(
-      endpoint->service_id, endpoint->service_info,
-      client->GetCancellationFlag(endpoint->endpoint_id));
+  WifiLanSocket socket = wifi_lan_medium().Connect(
+      endpoint->service_id, endpoint->service_info, cancellation_flag);
   NEARBY_LOGS(INFO) << "In WifiLanConnectImpl(), connect to service "
                     << " socket=" << &socket.GetImpl()
                     << " for endpoint(id=" << endpoint->endpoint_id << ").";
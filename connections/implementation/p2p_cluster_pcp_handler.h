@@ -38,6 +38,7 @@
 #include "connections/implementation/pcp.h"
 #include "connections/implementation/wifi_lan_service_info.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/cancellation_flag.h"
 
 namespace nearby {
 namespace connections {
@@ -74,6 +75,14 @@ class P2pClusterPcpHandler : public BasePcpHandler {
   // @PCPHandlerThread
   Status StopAdvertisingImpl(ClientProxy* client) override;
 
+  // @PCPHandlerThread
+  BasePcpHandler::StartOperationResult UpdateAdvertisingImpl(
+      ClientProxy* client, const std::string& service_id,
+      const std::string& local_endpoint_id,
+      const ByteArray& local_endpoint_info,
+      const AdvertisingOptions& old_options,
+      const AdvertisingOptions& new_options) override;
+
   // @PCPHandlerThread
   BasePcpHandler::StartOperationResult StartDiscoveryImpl(
       ClientProxy* client, const std::string& service_id,
@@ -82,6 +91,12 @@ class P2pClusterPcpHandler : public BasePcpHandler {
   // @PCPHandlerThread
   Status StopDiscoveryImpl(ClientProxy* client) override;
 
+  // @PCPHandlerThread
+  BasePcpHandler::StartOperationResult UpdateDiscoveryImpl(
+      ClientProxy* client, const std::string& service_id,
+      const DiscoveryOptions& old_options,
+      const DiscoveryOptions& new_options) override;
+
   // @PCPHandlerThread
   Status InjectEndpointImpl(
       ClientProxy* client, const std::string& service_id,
@@ -92,6 +107,11 @@ class P2pClusterPcpHandler : public BasePcpHandler {
       ClientProxy* client,
       BasePcpHandler::DiscoveredEndpoint* endpoint) override;
 
+  // @PCPHandlerThread
+  BasePcpHandler::ConnectImplResult ConnectImpl(
+      ClientProxy* client, BasePcpHandler::DiscoveredEndpoint* endpoint,
+      CancellationFlag* cancellation_flag) override;
+
   // @PCPHandlerThread
   BasePcpHandler::StartOperationResult StartListeningForIncomingConnectionsImpl(
       ClientProxy* client_proxy, absl::string_view service_id,
@@ -164,7 +184,8 @@ class P2pClusterPcpHandler : public BasePcpHandler {
       BluetoothDiscoveredDeviceCallback callback, ClientProxy* client,
       const std::string& service_id);
   BasePcpHandler::ConnectImplResult BluetoothConnectImpl(
-      ClientProxy* client, BluetoothEndpoint* endpoint);
+      ClientProxy* client, BluetoothEndpoint* endpoint,
+      CancellationFlag* cancellation_flag);
 
   // Ble
   bool IsRecognizedBleEndpoint(const std::string& service_id,
@@ -189,8 +210,9 @@ class P2pClusterPcpHandler : public BasePcpHandler {
       BleDiscoveredPeripheralCallback callback, ClientProxy* client,
       const std::string& service_id,
       const std::string& fast_advertisement_service_uuid);
-  BasePcpHandler::ConnectImplResult BleConnectImpl(ClientProxy* client,
-                                                   BleEndpoint* endpoint);
+  BasePcpHandler::ConnectImplResult BleConnectImpl(
+      ClientProxy* client, BleEndpoint* endpoint,
+      CancellationFlag* cancellation_flag);
 
   // BleV2
   bool IsRecognizedBleV2Endpoint(absl::string_view service_id,
@@ -217,8 +239,9 @@ class P2pClusterPcpHandler : public BasePcpHandler {
   location::nearby::proto::connections::Medium StartBleV2Scanning(
       BleV2DiscoveredPeripheralCallback callback, ClientProxy* client,
       const std::string& service_id, const DiscoveryOptions& discovery_options);
-  BasePcpHandler::ConnectImplResult BleV2ConnectImpl(ClientProxy* client,
-                                                     BleV2Endpoint* endpoint);
+  BasePcpHandler::ConnectImplResult BleV2ConnectImpl(
+      ClientProxy* client, BleV2Endpoint* endpoint,
+      CancellationFlag* cancellation_flag);
 
   // WifiLan
   bool IsRecognizedWifiLanEndpoint(
@@ -243,16 +266,20 @@ class P2pClusterPcpHandler : public BasePcpHandler {
       WifiLanDiscoveredServiceCallback callback, ClientProxy* client,
       const std::string& service_id);
   BasePcpHandler::ConnectImplResult WifiLanConnectImpl(
-      ClientProxy* client, WifiLanEndpoint* endpoint);
-
-  BluetoothRadio& bluetooth_radio_;
-  BluetoothClassic& bluetooth_medium_;
-  Ble& ble_medium_;
-  BleV2& ble_v2_medium_;
-  WifiLan& wifi_lan_medium_;
-  WifiHotspot& wifi_hotspot_medium_;
-  WifiDirect& wifi_direct_medium_;
-  mediums::WebRtc& webrtc_medium_;
+      ClientProxy* client, WifiLanEndpoint* endpoint,
+      CancellationFlag* cancellation_flag);
+
+  BluetoothRadio& bluetooth_radio() { return mediums_->GetBluetoothRadio(); }
+  BluetoothClassic& bluetooth_medium() {
+    return mediums_->GetBluetoothClassic();
+  }
+  Ble& ble_medium() { return mediums_->GetBle(); }
+  BleV2& ble_v2_medium() { return mediums_->GetBleV2(); }
+  WifiLan& wifi_lan_medium() { return mediums_->GetWifiLan(); }
+  WifiHotspot& wifi_hotspot_medium() { return mediums_->GetWifiHotspot(); }
+  WifiDirect& wifi_direct_medium() { return mediums_->GetWifiDirect(); }
+  mediums::WebRtc& webrtc_medium() { return mediums_->GetWebRtc(); }
+
   InjectedBluetoothDeviceStore& injected_bluetooth_device_store_;
   std::int64_t bluetooth_classic_discoverer_client_id_{0};
   std::int64_t bluetooth_classic_advertiser_client_id_{0};
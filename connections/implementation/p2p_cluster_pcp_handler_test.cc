@@ -313,6 +313,98 @@ TEST_P(P2pClusterPcpHandlerTest, CanConnect) {
   env_.Stop();
 }
 
+TEST_P(P2pClusterPcpHandlerTest, QueuesIncomingConnectionsBeyondLimit) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kMaxConcurrentIncomingHandshakes,
+      1);
+  env_.Start();
+  std::string endpoint_name_a{"endpoint_name"};
+  ClientProxy client_c;
+  Mediums mediums_a;
+  Mediums mediums_b;
+  Mediums mediums_c;
+  mediums_a.GetBluetoothRadio().GetBluetoothAdapter().SetName("BT Device A");
+  mediums_b.GetBluetoothRadio().GetBluetoothAdapter().SetName("BT Device B");
+  mediums_c.GetBluetoothRadio().GetBluetoothAdapter().SetName("BT Device C");
+  EndpointChannelManager ecm_a;
+  EndpointChannelManager ecm_b;
+  EndpointChannelManager ecm_c;
+  EndpointManager em_a(&ecm_a);
+  EndpointManager em_b(&ecm_b);
+  EndpointManager em_c(&ecm_c);
+  BwuManager bwu_a(mediums_a, em_a, ecm_a, {},
+                   {.allow_upgrade_to = {.bluetooth = true}});
+  BwuManager bwu_b(mediums_b, em_b, ecm_b, {},
+                   {.allow_upgrade_to = {.bluetooth = true}});
+  BwuManager bwu_c(mediums_c, em_c, ecm_c, {},
+                   {.allow_upgrade_to = {.bluetooth = true}});
+  InjectedBluetoothDeviceStore ibds_a;
+  InjectedBluetoothDeviceStore ibds_b;
+  InjectedBluetoothDeviceStore ibds_c;
+  P2pClusterPcpHandler handler_a(&mediums_a, &em_a, &ecm_a, &bwu_a, ibds_a);
+  P2pClusterPcpHandler handler_b(&mediums_b, &em_b, &ecm_b, &bwu_b, ibds_b);
+  P2pClusterPcpHandler handler_c(&mediums_c, &em_c, &ecm_c, &bwu_c, ibds_c);
+  CountDownLatch discover_latch(2);
+  // Both requesters and the advertiser, for each of the two connections.
+  CountDownLatch connect_latch(4);
+  std::string endpoint_id_a_for_b;
+  std::string endpoint_id_a_for_c;
+  auto initiated_cb = [&connect_latch](const std::string& endpoint_id,
+                                       const ConnectionResponseInfo& info) {
+    connect_latch.CountDown();
+  };
+  EXPECT_EQ(handler_a.StartAdvertising(
+                &client_a_, service_id_, advertising_options_,
+                {
+                    .endpoint_info = ByteArray{endpoint_name_a},
+                    .listener = {.initiated_cb = initiated_cb},
+                }),
+            Status{Status::kSuccess});
+  auto discover = [&](P2pClusterPcpHandler& handler, ClientProxy* client,
+                      std::string* endpoint_id_a) {
+    return handler.StartDiscovery(
+        client, service_id_, discovery_options_,
+        {
+            .endpoint_found_cb =
+                [&discover_latch, endpoint_id_a](
+                    const std::string& endpoint_id, const ByteArray&,
+                    const std::string&) {
+                  if (endpoint_id_a->empty()) {
+                    *endpoint_id_a = endpoint_id;
+                    discover_latch.CountDown();
+                  }
+                },
+        });
+  };
+  EXPECT_EQ(discover(handler_b, &client_b_, &endpoint_id_a_for_b),
+            Status{Status::kSuccess});
+  EXPECT_EQ(discover(handler_c, &client_c, &endpoint_id_a_for_c),
+            Status{Status::kSuccess});
+  EXPECT_TRUE(discover_latch.Await(absl::Milliseconds(1000)).result());
+
+  client_b_.AddCancellationFlag(endpoint_id_a_for_b);
+  client_c.AddCancellationFlag(endpoint_id_a_for_c);
+  handler_b.RequestConnection(&client_b_, endpoint_id_a_for_b,
+                              {.endpoint_info = ByteArray{"B"},
+                               .listener = {.initiated_cb = initiated_cb}},
+                              connection_options_);
+  handler_c.RequestConnection(&client_c, endpoint_id_a_for_c,
+                              {.endpoint_info = ByteArray{"C"},
+                               .listener = {.initiated_cb = initiated_cb}},
+                              connection_options_);
+
+  // Whichever connection comes second waits for the first handshake instead
+  // of being turned away.
+  EXPECT_TRUE(connect_latch.Await(absl::Milliseconds(5000)).result());
+
+  bwu_a.Shutdown();
+  bwu_b.Shutdown();
+  bwu_c.Shutdown();
+  env_.Stop();
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 TEST_P(P2pClusterPcpHandlerTest, CanStartListeningForIncomingConnections) {
   env_.Start();
   std::string endpoint_name_a{"endpoint_name"};
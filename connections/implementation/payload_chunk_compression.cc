@@ -0,0 +1,102 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/payload_chunk_compression.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "zlib.h"
+
+namespace nearby {
+namespace connections {
+
+namespace {
+// Negative window bits select raw DEFLATE, without the zlib header and
+// checksum; the frames are already authenticated.
+constexpr int kWindowBits = -15;
+constexpr int kMemLevel = 8;
+}  // namespace
+
+std::optional<std::string> PayloadChunkCompression::Compress(
+    absl::string_view body) {
+  if (body.size() < kMinCompressedSize) {
+    return std::nullopt;
+  }
+
+  z_stream stream = {};
+  if (deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, kWindowBits, kMemLevel,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    return std::nullopt;
+  }
+  // Output that doesn't fit in fewer bytes than |body| isn't worth sending, so
+  // there is no need to make room for more.
+  std::string compressed(body.size() - 1, '\0');
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(body.data()));
+  stream.avail_in = body.size();
+  stream.next_out = reinterpret_cast<Bytef*>(compressed.data());
+  stream.avail_out = compressed.size();
+  int result = deflate(&stream, Z_FINISH);
+  size_t compressed_size = stream.total_out;
+  deflateEnd(&stream);
+  if (result != Z_STREAM_END) {
+    return std::nullopt;
+  }
+  compressed.resize(compressed_size);
+  return compressed;
+}
+
+std::optional<std::string> PayloadChunkCompression::Decompress(
+    absl::string_view body, size_t max_size) {
+  z_stream stream = {};
+  if (inflateInit2(&stream, kWindowBits) != Z_OK) {
+    return std::nullopt;
+  }
+  std::string decompressed(
+      std::min(max_size, std::max<size_t>(4 * body.size(), 4096)), '\0');
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(body.data()));
+  stream.avail_in = body.size();
+  int result = Z_OK;
+  while (true) {
+    stream.next_out =
+        reinterpret_cast<Bytef*>(decompressed.data() + stream.total_out);
+    stream.avail_out = decompressed.size() - stream.total_out;
+    result = inflate(&stream, Z_FINISH);
+    if (result == Z_STREAM_END || (result != Z_OK && result != Z_BUF_ERROR)) {
+      break;
+    }
+    // Out of input before the end of the stream: the body is truncated.
+    if (stream.avail_out != 0 || decompressed.size() >= max_size) {
+      result = Z_DATA_ERROR;
+      break;
+    }
+    decompressed.resize(std::min(max_size, 2 * decompressed.size()));
+  }
+  size_t decompressed_size = stream.total_out;
+  bool trailing_data = stream.avail_in != 0;
+  inflateEnd(&stream);
+  if (result != Z_STREAM_END || trailing_data) {
+    return std::nullopt;
+  }
+  decompressed.resize(decompressed_size);
+  return decompressed;
+}
+
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,55 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_PAYLOAD_CHUNK_COMPRESSION_H_
+#define CORE_INTERNAL_PAYLOAD_CHUNK_COMPRESSION_H_
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+#include "absl/strings/string_view.h"
+
+namespace nearby {
+namespace connections {
+
+// Compression of the bodies of PayloadChunks sent with the COMPRESSED flag.
+//
+// Bodies are compressed as raw DEFLATE streams at zlib's fastest level, which
+// keeps up with the faster mediums while still shrinking text and other
+// redundant data considerably.
+class PayloadChunkCompression {
+ public:
+  // Bodies smaller than this are sent as they are; the saving wouldn't be
+  // worth the CPU time.
+  static constexpr size_t kMinCompressedSize = 512;
+  // No chunk body decompresses to more than one frame could carry
+  // uncompressed.
+  static constexpr size_t kMaxDecompressedSize = 1024 * 1024;
+
+  // Returns the compressed |body|, or std::nullopt if it's too small to be
+  // worth compressing or doesn't get any smaller, e.g. because it is already
+  // compressed.
+  static std::optional<std::string> Compress(absl::string_view body);
+
+  // Returns the decompressed |body|, or std::nullopt if it is corrupt or would
+  // decompress to more than |max_size| bytes.
+  static std::optional<std::string> Decompress(absl::string_view body,
+                                               size_t max_size);
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_PAYLOAD_CHUNK_COMPRESSION_H_
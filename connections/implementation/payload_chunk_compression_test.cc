@@ -0,0 +1,98 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/payload_chunk_compression.h"
+
+#include <cstddef>
+#include <optional>
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+std::string CompressibleBody(size_t size) {
+  std::string body;
+  for (int i = 0; body.size() < size; ++i) {
+    absl::StrAppend(&body, "line ", i, " of the payload\n");
+  }
+  body.resize(size);
+  return body;
+}
+
+std::string RandomBody(size_t size) {
+  std::mt19937 generator(42);
+  std::string body(size, '\0');
+  for (char& c : body) {
+    c = static_cast<char>(generator());
+  }
+  return body;
+}
+
+TEST(PayloadChunkCompressionTest, RoundTrips) {
+  std::string body = CompressibleBody(64 * 1024);
+
+  std::optional<std::string> compressed =
+      PayloadChunkCompression::Compress(body);
+  ASSERT_TRUE(compressed.has_value());
+  EXPECT_LT(compressed->size(), body.size() / 2);
+
+  std::optional<std::string> decompressed =
+      PayloadChunkCompression::Decompress(*compressed, body.size());
+  ASSERT_TRUE(decompressed.has_value());
+  EXPECT_EQ(*decompressed, body);
+}
+
+TEST(PayloadChunkCompressionTest, SkipsSmallBodies) {
+  EXPECT_FALSE(PayloadChunkCompression::Compress(CompressibleBody(
+                   PayloadChunkCompression::kMinCompressedSize - 1))
+                   .has_value());
+}
+
+TEST(PayloadChunkCompressionTest, SkipsIncompressibleBodies) {
+  EXPECT_FALSE(
+      PayloadChunkCompression::Compress(RandomBody(64 * 1024)).has_value());
+}
+
+TEST(PayloadChunkCompressionTest, RejectsBodiesOverMaxSize) {
+  std::string body = CompressibleBody(64 * 1024);
+  std::optional<std::string> compressed =
+      PayloadChunkCompression::Compress(body);
+  ASSERT_TRUE(compressed.has_value());
+
+  EXPECT_FALSE(PayloadChunkCompression::Decompress(*compressed, body.size() - 1)
+                   .has_value());
+}
+
+TEST(PayloadChunkCompressionTest, RejectsCorruptBodies) {
+  std::string body = CompressibleBody(64 * 1024);
+  std::optional<std::string> compressed =
+      PayloadChunkCompression::Compress(body);
+  ASSERT_TRUE(compressed.has_value());
+
+  EXPECT_FALSE(PayloadChunkCompression::Decompress(
+                   compressed->substr(0, compressed->size() / 2), body.size())
+                   .has_value());
+  EXPECT_FALSE(
+      PayloadChunkCompression::Decompress(RandomBody(1024), body.size())
+          .has_value());
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
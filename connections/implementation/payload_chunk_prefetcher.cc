@@ -0,0 +1,108 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/payload_chunk_prefetcher.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include "internal/platform/byte_array.h"
+#include "internal/platform/byte_slice.h"
+#include "internal/platform/mutex_lock.h"
+
+namespace nearby {
+namespace connections {
+
+PayloadChunkPrefetcher::PayloadChunkPrefetcher(
+    InternalPayload* internal_payload, std::size_t max_chunks)
+    : internal_payload_(internal_payload),
+      max_chunks_(std::max<std::size_t>(max_chunks, 1)) {}
+
+PayloadChunkPrefetcher::~PayloadChunkPrefetcher() {
+  Stop();
+  reader_executor_.Shutdown();
+}
+
+void PayloadChunkPrefetcher::Start(int chunk_size) {
+  {
+    MutexLock lock(&mutex_);
+    if (started_ || stopped_) return;
+    started_ = true;
+  }
+  reader_executor_.Execute("prefetch-payload-chunks",
+                           [this, chunk_size]() { ReadLoop(chunk_size); });
+}
+
+bool PayloadChunkPrefetcher::IsStarted() const {
+  MutexLock lock(&mutex_);
+  return started_;
+}
+
+ByteArray PayloadChunkPrefetcher::DetachNextChunk(int chunk_size) {
+  MutexLock lock(&mutex_);
+  while (chunks_.empty() && !reached_end_ && !stopped_) {
+    if (cond_.Wait().Raised()) return {};
+  }
+  if (chunks_.empty()) return {};
+
+  ByteSlice& next_chunk = chunks_.front();
+  ByteArray result;
+  if (chunk_size > 0 && next_chunk.size() > static_cast<size_t>(chunk_size)) {
+    result = next_chunk.Subslice(0, chunk_size).ToByteArray();
+    next_chunk = next_chunk.Subslice(chunk_size);
+  } else {
+    result = std::move(next_chunk).ToByteArray();
+    chunks_.pop_front();
+    // Let the reader know there is room in the queue again.
+    cond_.Notify();
+  }
+  return result;
+}
+
+void PayloadChunkPrefetcher::Stop() {
+  MutexLock lock(&mutex_);
+  stopped_ = true;
+  chunks_.clear();
+  cond_.Notify();
+}
+
+void PayloadChunkPrefetcher::ReadLoop(int chunk_size) {
+  while (true) {
+    {
+      MutexLock lock(&mutex_);
+      while (chunks_.size() >= max_chunks_ && !stopped_) {
+        if (cond_.Wait().Raised()) return;
+      }
+      if (stopped_) return;
+    }
+
+    // Read without holding the lock, so the send loop can keep consuming the
+    // chunks that are already queued.
+    ByteArray chunk = internal_payload_->DetachNextChunk(chunk_size);
+
+    MutexLock lock(&mutex_);
+    if (stopped_) return;
+    if (chunk.Empty()) {
+      reached_end_ = true;
+      cond_.Notify();
+      return;
+    }
+    chunks_.push_back(ByteSlice(std::move(chunk)));
+    cond_.Notify();
+  }
+}
+
+}  // namespace connections
+}  // namespace nearby
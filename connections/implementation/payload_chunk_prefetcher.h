@@ -0,0 +1,83 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_PAYLOAD_CHUNK_PREFETCHER_H_
+#define CORE_INTERNAL_PAYLOAD_CHUNK_PREFETCHER_H_
+
+#include <cstddef>
+#include <deque>
+
+#include "absl/base/thread_annotations.h"
+#include "connections/implementation/internal_payload.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/byte_slice.h"
+#include "internal/platform/condition_variable.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/single_thread_executor.h"
+
+namespace nearby {
+namespace connections {
+
+// Reads the chunks of an outgoing InternalPayload ahead of the send loop.
+//
+// While PayloadManager encrypts and writes the current chunk, a dedicated
+// reader thread detaches up to |max_chunks| further chunks from the payload,
+// so disk reads overlap with socket writes. The reader blocks once the queue
+// is full, which ties read-ahead to the pace at which the channels accept
+// writes.
+class PayloadChunkPrefetcher {
+ public:
+  PayloadChunkPrefetcher(InternalPayload* internal_payload,
+                         std::size_t max_chunks);
+  ~PayloadChunkPrefetcher();
+
+  PayloadChunkPrefetcher(const PayloadChunkPrefetcher&) = delete;
+  PayloadChunkPrefetcher& operator=(const PayloadChunkPrefetcher&) = delete;
+
+  // Starts reading chunks of |chunk_size| bytes in the background. Must be
+  // called at most once, after any SkipToOffset() on the payload.
+  void Start(int chunk_size) ABSL_LOCKS_EXCLUDED(mutex_);
+  bool IsStarted() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the next chunk of at most |chunk_size| bytes, blocking until one
+  // has been read. Prefetched chunks larger than |chunk_size| are split, so a
+  // shrinking chunk size (e.g. after a bandwidth upgrade) is still honored.
+  // Returns an empty chunk at the end of the payload, or after Stop().
+  ByteArray DetachNextChunk(int chunk_size) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Stops reading ahead and unblocks any pending DetachNextChunk() call.
+  void Stop() ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  void ReadLoop(int chunk_size) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  InternalPayload* const internal_payload_;
+  const std::size_t max_chunks_;
+
+  mutable Mutex mutex_;
+  ConditionVariable cond_{&mutex_};
+  std::deque<ByteSlice> chunks_ ABSL_GUARDED_BY(mutex_);
+  bool started_ ABSL_GUARDED_BY(mutex_) = false;
+  bool reached_end_ ABSL_GUARDED_BY(mutex_) = false;
+  bool stopped_ ABSL_GUARDED_BY(mutex_) = false;
+
+  // Must be declared last, so the reader thread is joined before the state it
+  // uses is destroyed.
+  SingleThreadExecutor reader_executor_{api::ExecutorQos::kUserInitiated};
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_PAYLOAD_CHUNK_PREFETCHER_H_
@@ -0,0 +1,109 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/payload_chunk_prefetcher.h"
+
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "connections/implementation/internal_payload.h"
+#include "connections/implementation/internal_payload_factory.h"
+#include "connections/payload.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/pipe.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+class PayloadChunkPrefetcherTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    pipe_ = std::make_shared<Pipe>();
+    auto pipe = pipe_;
+    internal_payload_ =
+        CreateOutgoingInternalPayload(Payload{[pipe]() -> InputStream& {
+          return pipe->GetInputStream();  // NOLINT
+        }});
+  }
+
+  void WriteAndClose(const std::string& data, int pieces) {
+    size_t piece_size = data.size() / pieces;
+    for (int i = 0; i < pieces; ++i) {
+      size_t size = (i == pieces - 1) ? data.size() - i * piece_size
+                                      : piece_size;
+      pipe_->GetOutputStream().Write(
+          ByteArray(data.data() + i * piece_size, size));
+    }
+    pipe_->GetOutputStream().Close();
+  }
+
+  std::shared_ptr<Pipe> pipe_;
+  std::unique_ptr<InternalPayload> internal_payload_;
+};
+
+TEST_F(PayloadChunkPrefetcherTest, ReturnsAllChunksInOrder) {
+  std::string data = "The quick brown fox jumps over the lazy dog";
+  WriteAndClose(data, 5);
+  PayloadChunkPrefetcher prefetcher(internal_payload_.get(),
+                                    /*max_chunks=*/2);
+
+  EXPECT_FALSE(prefetcher.IsStarted());
+  prefetcher.Start(/*chunk_size=*/8);
+  EXPECT_TRUE(prefetcher.IsStarted());
+
+  std::string received;
+  while (true) {
+    ByteArray chunk = prefetcher.DetachNextChunk(/*chunk_size=*/8);
+    if (chunk.Empty()) break;
+    EXPECT_LE(chunk.size(), 8);
+    received += std::string(chunk);
+  }
+  EXPECT_EQ(received, data);
+  EXPECT_TRUE(prefetcher.DetachNextChunk(/*chunk_size=*/8).Empty());
+}
+
+TEST_F(PayloadChunkPrefetcherTest, SplitsChunksLargerThanRequested) {
+  WriteAndClose("ABCDEFGH", 1);
+  PayloadChunkPrefetcher prefetcher(internal_payload_.get(),
+                                    /*max_chunks=*/4);
+  prefetcher.Start(/*chunk_size=*/8);
+
+  EXPECT_EQ(prefetcher.DetachNextChunk(/*chunk_size=*/3), ByteArray("ABC"));
+  EXPECT_EQ(prefetcher.DetachNextChunk(/*chunk_size=*/3), ByteArray("DEF"));
+  EXPECT_EQ(prefetcher.DetachNextChunk(/*chunk_size=*/3), ByteArray("GH"));
+  EXPECT_TRUE(prefetcher.DetachNextChunk(/*chunk_size=*/3).Empty());
+}
+
+TEST_F(PayloadChunkPrefetcherTest, StopUnblocksDetach) {
+  PayloadChunkPrefetcher prefetcher(internal_payload_.get(),
+                                    /*max_chunks=*/2);
+  prefetcher.Start(/*chunk_size=*/8);
+  prefetcher.Stop();
+
+  EXPECT_TRUE(prefetcher.DetachNextChunk(/*chunk_size=*/8).Empty());
+  // Let the reader thread observe the end of the payload.
+  pipe_->GetOutputStream().Close();
+}
+
+TEST_F(PayloadChunkPrefetcherTest, DestroyWithoutStart) {
+  PayloadChunkPrefetcher prefetcher(internal_payload_.get(),
+                                    /*max_chunks=*/2);
+  SUCCEED();
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
@@ -18,21 +18,27 @@
 #include <functional>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/time/time.h"
 #include "connections/implementation/analytics/throughput_recorder.h"
 #include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/implementation/internal_payload_factory.h"
+#include "connections/implementation/payload_chunk_compression.h"
 #include "internal/flags/nearby_flags.h"
+#include "internal/platform/cancellation_flag_listener.h"
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/logging.h"
 #include "internal/platform/mutex_lock.h"
 #include "internal/platform/single_thread_executor.h"
+#include "internal/platform/system_clock.h"
+#include "internal/platform/tracing.h"
 
 namespace nearby {
 namespace connections {
@@ -46,11 +52,15 @@ using ::nearby::connections::PayloadDirection;
 // C++14 requires to declare this.
 // TODO(apolyudov): remove when migration to c++17 is possible.
 constexpr absl::Duration PayloadManager::kWaitCloseTimeout;
+constexpr absl::Duration PayloadManager::kStreamCreditWaitTimeout;
 
 bool PayloadManager::SendPayloadLoop(
     ClientProxy* client, PendingPayload& pending_payload,
     PayloadTransferFrame::PayloadHeader& payload_header,
-    std::int64_t& next_chunk_offset, size_t resume_offset) {
+    std::int64_t& next_chunk_offset, size_t resume_offset,
+    PayloadChunkPrefetcher* prefetcher, int send_weight) {
+  TraceScope trace("payload", "PayloadManager::SendPayloadLoop");
+  trace.SetArg("offset", next_chunk_offset);
   // in lieu of structured binding:
   auto pair = GetAvailableAndUnavailableEndpoints(pending_payload);
   const EndpointIds& available_endpoint_ids =
@@ -111,6 +121,32 @@ bool PayloadManager::SendPayloadLoop(
                          << pending_payload.GetInternalPayload()->GetId();
     next_chunk_offset = real_offset.GetResult();
   }
+  // Jump over the chunks the receiver already has, announcing the ones after
+  // them first if needed. The payload skips from where it was read up to.
+  const SkippedChunks* skipped_chunks = pending_payload.GetSkippedChunks();
+  std::int64_t total_size = pending_payload.GetInternalPayload()->GetTotalSize();
+  while (skipped_chunks != nullptr) {
+    if (skipped_chunks->sends_manifests && next_chunk_offset < total_size &&
+        next_chunk_offset >= skipped_chunks->CoveredBytes(total_size)) {
+      SendChunkManifest(pending_payload, payload_header,
+                        available_endpoint_ids.front(), next_chunk_offset);
+    }
+    std::int64_t skipped_bytes =
+        skipped_chunks->SkippedBytesAt(next_chunk_offset, total_size);
+    if (skipped_bytes == 0) break;
+    ExceptionOr<size_t> real_offset =
+        pending_payload.GetInternalPayload()->SkipToOffset(skipped_bytes);
+    if (!real_offset.ok()) {
+      NEARBY_LOGS(WARNING) << "PayloadManager failed to skip " << skipped_bytes
+                           << " present bytes on payload_id "
+                           << pending_payload.GetInternalPayload()->GetId();
+      HandleFinishedOutgoingPayload(
+          client, available_endpoint_ids, payload_header, next_chunk_offset,
+          location::nearby::proto::connections::PayloadStatus::LOCAL_ERROR);
+      return false;
+    }
+    next_chunk_offset += skipped_bytes;
+  }
   for (const auto& endpoint_id : available_endpoint_ids) {
     pending_payload.SetOffsetForEndpoint(endpoint_id, next_chunk_offset);
   }
@@ -118,11 +154,48 @@ bool PayloadManager::SendPayloadLoop(
   // This will block if there is no data to transfer.
   // It will resume when new data arrives, or if Close() is called.
   int chunk_size = GetOptimalChunkSize(available_endpoint_ids);
+  if (skipped_chunks != nullptr) {
+    std::int64_t sent_bytes =
+        skipped_chunks->SentBytesAt(next_chunk_offset, total_size);
+    if (sent_bytes > 0) {
+      chunk_size = static_cast<int>(
+          std::min(static_cast<std::int64_t>(chunk_size), sent_bytes));
+    }
+  }
+  if (payload_header.type() == PayloadTransferFrame::PayloadHeader::STREAM) {
+    std::int64_t credit = WaitForStreamCredit(
+        pending_payload, available_endpoint_ids, next_chunk_offset);
+    // Loop around to check that the payload is still wanted.
+    if (credit == 0) return true;
+    chunk_size = static_cast<int>(
+        std::min(static_cast<std::int64_t>(chunk_size), credit));
+  }
   packet_meta_data.StartFileIo();
-  ByteArray next_chunk =
-      pending_payload.GetInternalPayload()->DetachNextChunk(chunk_size);
+  ByteArray next_chunk;
+  if (prefetcher != nullptr) {
+    // Read-ahead can only start once any resume offset has been skipped.
+    if (!prefetcher->IsStarted()) prefetcher->Start(chunk_size);
+    next_chunk = prefetcher->DetachNextChunk(chunk_size);
+  } else {
+    // Reading a stream blocks until the client writes more to it. Closing the
+    // stream once the payload is canceled lets the read return right away.
+    std::unique_ptr<CancellationFlagListener> cancel_listener;
+    if (payload_header.type() == PayloadTransferFrame::PayloadHeader::STREAM) {
+      cancel_listener = std::make_unique<CancellationFlagListener>(
+          pending_payload.GetCancellationFlag(), [&pending_payload]() {
+            pending_payload.GetInternalPayload()->Close();
+          });
+    }
+    if (!pending_payload.IsLocallyCanceled()) {
+      next_chunk =
+          pending_payload.GetInternalPayload()->DetachNextChunk(chunk_size);
+    }
+  }
   packet_meta_data.StopFileIo();
   if (shutdown_.Get()) return false;
+  // Loop around to tell the remaining recipients, rather than sending what
+  // the canceled read returned as the last chunk.
+  if (pending_payload.IsLocallyCanceled()) return true;
   // Save chunk size. We'll need it after we move next_chunk.
   auto next_chunk_size = next_chunk.size();
   if (!next_chunk_size &&
@@ -141,10 +214,68 @@ bool PayloadManager::SendPayloadLoop(
   // used to decide if the received chunk is the initial payload chunk.
   // In other cases, the offset should only be used in both side logs when error
   // happened.
-  PayloadTransferFrame::PayloadChunk payload_chunk(CreatePayloadChunk(
+  std::vector<PayloadTransferFrame::PayloadChunk> payload_chunks;
+  payload_chunks.push_back(CreatePayloadChunk(
       next_chunk_offset - resume_offset, std::move(next_chunk)));
-  const EndpointIds& failed_endpoint_ids = endpoint_manager_->SendPayloadChunk(
-      payload_header, payload_chunk, available_endpoint_ids, packet_meta_data);
+  // Chunks are compressed before EndpointManager encrypts their frames. Those
+  // that don't get smaller go out as they are. The receiver of a FILE_BATCH
+  // payload reads its first chunk before any could be decompressed.
+  bool is_file_batch_start =
+      payload_header.type() ==
+          PayloadTransferFrame::PayloadHeader::FILE_BATCH &&
+      next_chunk_offset == 0;
+  if (next_chunk_size > 0 && !is_file_batch_start &&
+      CanCompressPayloadChunks(client, available_endpoint_ids,
+                               payload_header.type())) {
+    std::optional<std::string> compressed_body =
+        PayloadChunkCompression::Compress(payload_chunks.back().body());
+    if (compressed_body.has_value()) {
+      payload_chunks.back().set_body(*std::move(compressed_body));
+      payload_chunks.back().set_flags(
+          payload_chunks.back().flags() |
+          PayloadTransferFrame::PayloadChunk::COMPRESSED);
+    }
+  }
+  // A BYTES payload fits in a single chunk, so its last chunk goes out in the
+  // same write instead of taking another trip around the send loop. Endpoints
+  // that accept it get the LAST_CHUNK flag on the data chunk itself, saving a
+  // frame.
+  if (payload_header.type() == PayloadTransferFrame::PayloadHeader::BYTES &&
+      next_chunk_size > 0 &&
+      next_chunk_offset + next_chunk_size >=
+          pending_payload.GetInternalPayload()->GetTotalSize()) {
+    if (CanSendSingleFrameBytesPayload(client, available_endpoint_ids)) {
+      payload_chunks.back().set_flags(
+          payload_chunks.back().flags() |
+          PayloadTransferFrame::PayloadChunk::LAST_CHUNK);
+    } else {
+      payload_chunks.push_back(CreatePayloadChunk(
+          next_chunk_offset + next_chunk_size - resume_offset, ByteArray()));
+    }
+  }
+  std::string send_channel_id;
+  std::string send_flow_id;
+  if (send_scheduler_) {
+    send_channel_id = GetSendChannelId(available_endpoint_ids);
+    send_flow_id = absl::StrCat(client->GetClientId());
+    send_scheduler_->StartTurn(send_channel_id, send_flow_id, send_weight,
+                               next_chunk_size);
+  }
+  absl::Time chunk_write_start_time = SystemClock::ElapsedRealtime();
+  const EndpointIds& failed_endpoint_ids =
+      payload_chunks.size() == 1
+          ? endpoint_manager_->SendPayloadChunk(
+                payload_header, payload_chunks.front(), available_endpoint_ids,
+                packet_meta_data)
+          : endpoint_manager_->SendPayloadChunks(
+                payload_header, payload_chunks, available_endpoint_ids,
+                packet_meta_data);
+  absl::Duration chunk_write_time =
+      SystemClock::ElapsedRealtime() - chunk_write_start_time;
+  if (send_scheduler_) {
+    send_scheduler_->EndTurn(send_channel_id, send_flow_id,
+                             /*more=*/next_chunk_size > 0);
+  }
   // Check whether at least one endpoint failed.
   if (!failed_endpoint_ids.empty()) {
     NEARBY_LOGS(INFO) << "Payload xfer: endpoints failed: payload_id="
@@ -160,20 +291,32 @@ bool PayloadManager::SendPayloadLoop(
   // we'll just go right back to the top of the loop and break out when
   // availableEndpointIds is re-synced and found to be empty at that point.
   if (failed_endpoint_ids.size() < available_endpoint_ids.size()) {
+    EndpointIds succeeded_endpoint_ids;
     for (const auto& endpoint_id : available_endpoint_ids) {
       if (std::find(failed_endpoint_ids.begin(), failed_endpoint_ids.end(),
                     endpoint_id) == failed_endpoint_ids.end()) {
-        HandleSuccessfulOutgoingChunk(
-            client, endpoint_id, payload_header, payload_chunk.flags(),
-            payload_chunk.offset(), payload_chunk.body().size());
+        for (const auto& payload_chunk : payload_chunks) {
+          // Progress counts the bytes of the payload, not those on the wire.
+          HandleSuccessfulOutgoingChunk(
+              client, endpoint_id, payload_header, payload_chunk.flags(),
+              payload_chunk.offset(),
+              (payload_chunk.flags() &
+               PayloadTransferFrame::PayloadChunk::COMPRESSED) != 0
+                  ? next_chunk_size
+                  : payload_chunk.body().size());
+        }
+        succeeded_endpoint_ids.push_back(endpoint_id);
       }
     }
-    NEARBY_LOGS(VERBOSE) << "PayloadManager done sending chunk at offset "
-                         << next_chunk_offset << " of payload_id="
-                         << pending_payload.GetInternalPayload()->GetId();
+    RecordChunkWriteTime(succeeded_endpoint_ids, next_chunk_size,
+                         chunk_write_time);
+    NEARBY_LOGS_EVERY_N_SEC(VERBOSE, 1)
+        << "PayloadManager done sending chunk at offset " << next_chunk_offset
+        << " of payload_id=" << pending_payload.GetInternalPayload()->GetId();
     next_chunk_offset += next_chunk_size;
 
-    if (!next_chunk_size) {
+    if ((payload_chunks.back().flags() &
+         PayloadTransferFrame::PayloadChunk::LAST_CHUNK) != 0) {
       // That was the last chunk, we're outta here.
       NEARBY_LOGS(INFO) << "Payload xfer done: payload_id="
                         << pending_payload.GetInternalPayload()->GetId()
@@ -253,6 +396,8 @@ std::string PayloadManager::ToString(PayloadType type) {
       return std::string("Stream");
     case PayloadType::kFile:
       return std::string("File");
+    case PayloadType::kFileBatch:
+      return std::string("FileBatch");
     case PayloadType::kUnknown:
       return std::string("Unknown");
   }
@@ -274,8 +419,10 @@ std::string PayloadManager::ToString(EndpointInfo::Status status) {
 // Creates and starts tracking a PendingPayload for this Payload.
 Payload::Id PayloadManager::CreateOutgoingPayload(
     Payload payload, const EndpointIds& endpoint_ids) {
+  Payload::Id payload_id = payload.GetId();
   auto internal_payload{CreateOutgoingInternalPayload(std::move(payload))};
-  Payload::Id payload_id = internal_payload->GetId();
+  // Left untracked, so that sending it fails.
+  if (!internal_payload) return payload_id;
   NEARBY_LOGS(INFO) << "CreateOutgoingPayload: payload_id=" << payload_id;
   MutexLock lock(&mutex_);
   pending_payloads_.StartTrackingPayload(
@@ -288,6 +435,28 @@ Payload::Id PayloadManager::CreateOutgoingPayload(
 
 PayloadManager::PayloadManager(EndpointManager& endpoint_manager)
     : endpoint_manager_(&endpoint_manager) {
+  std::int64_t outgoing_payload_threads =
+      NearbyFlags::GetInstance().GetInt64Flag(
+          config_package_nearby::nearby_connections_feature::
+              kOutgoingPayloadThreads);
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableFairPayloadScheduling)) {
+    send_scheduler_ = std::make_unique<PayloadSendScheduler>();
+    send_weights_ = PayloadSendScheduler::ParseWeights(
+        NearbyFlags::GetInstance().GetStringFlag(
+            config_package_nearby::nearby_connections_feature::
+                kFairPayloadSchedulingWeights));
+    outgoing_payload_threads =
+        std::max<std::int64_t>(outgoing_payload_threads,
+                               kFairSchedulingPayloadThreads);
+  }
+  if (outgoing_payload_threads > 1) {
+    file_payload_pool_ = std::make_unique<RoundRobinExecutor>(
+        outgoing_payload_threads, api::ExecutorQos::kUserInitiated);
+    stream_payload_pool_ = std::make_unique<RoundRobinExecutor>(
+        outgoing_payload_threads, api::ExecutorQos::kUserInitiated);
+  }
   endpoint_manager_->RegisterFrameProcessor(V1Frame::PAYLOAD_TRANSFER, this);
   custom_save_path_ = "";
 }
@@ -303,6 +472,11 @@ void PayloadManager::CancelAllPayloads() {
       pending->MarkLocallyCanceled();
       pending->Close();  // To unblock the sender thread, if there is no data.
     }
+    {
+      // Don't leave batched payloads waiting for their linger alarm.
+      MutexLock batch_lock(&bytes_batch_mutex_);
+      FlushBytesPayloadBatchLocked();
+    }
     if (pending_outgoing_payloads) {
       shutdown_barrier_ =
           absl::make_unique<CountDownLatch>(pending_outgoing_payloads);
@@ -330,9 +504,13 @@ PayloadManager::~PayloadManager() {
   CancelAllPayloads();
   NEARBY_LOG(INFO, "PayloadManager: turn down payload executors; self=%p",
              this);
+  bytes_batch_alarm_executor_.Shutdown();
   bytes_payload_executor_.Shutdown();
   stream_payload_executor_.Shutdown();
   file_payload_executor_.Shutdown();
+  stream_credit_executor_.Shutdown();
+  if (stream_payload_pool_) stream_payload_pool_->Shutdown();
+  if (file_payload_pool_) file_payload_pool_->Shutdown();
 
   CountDownLatch stop_latch(1);
   // Clear our tracked pending payloads.
@@ -377,11 +555,17 @@ void PayloadManager::SendPayload(ClientProxy* client,
   std::int64_t payload_total_size;
   switch (payload.GetType()) {
     case connections::PayloadType::kBytes:
-      payload_total_size = payload.AsBytes().size();
+      payload_total_size = payload.AsBytesView().size();
       break;
     case connections::PayloadType::kFile:
       payload_total_size = payload.AsFile()->GetTotalSize();
       break;
+    case connections::PayloadType::kFileBatch:
+      payload_total_size = 0;
+      for (const Payload::BatchFile& file : *payload.AsFileBatch()) {
+        payload_total_size += file.file.GetTotalSize();
+      }
+      break;
     case connections::PayloadType::kStream:
     case connections::PayloadType::kUnknown:
       payload_total_size = -1;
@@ -405,67 +589,716 @@ void PayloadManager::SendPayload(ClientProxy* client,
 
   // Each payload is sent in FCFS order within each Payload type, blocking any
   // other payload of the same type from even starting until this one is
-  // completely done with. If we ever want to provide isolation across
-  // ClientProxy objects this will need to be significantly re-architected.
+  // completely done with. The exception are FILE and STREAM payloads when
+  // kOutgoingPayloadThreads allows several of them to be sent at a time; they
+  // are started in FCFS order for each endpoint, taking turns between the
+  // endpoints. If we ever want to provide isolation
+  // across ClientProxy objects this will need to be significantly
+  // re-architected.
   PayloadType payload_type = payload.GetType();
   size_t resume_offset =
       FeatureFlags::GetInstance().GetFlags().enable_send_payload_offset
           ? payload.GetOffset()
           : 0;
 
+  // A BYTES payload for many endpoints of a cluster is only sent to a few of
+  // them, which relay it to the rest.
+  std::shared_ptr<PayloadRelayTracker::Relay> relay;
+  EndpointIds send_endpoint_ids = endpoint_ids;
+  if (payload_type == PayloadType::kBytes &&
+      CanRelayPayload(client, endpoint_ids, payload_total_size,
+                      resume_offset)) {
+    // Endpoints on the local Wi-Fi LAN are the ones to relay to the others,
+    // taking the copies off the slower mediums of the sender.
+    EndpointIds tree_endpoint_ids = endpoint_ids;
+    std::stable_partition(
+        tree_endpoint_ids.begin(), tree_endpoint_ids.end(),
+        [this](const std::string& endpoint_id) {
+          return endpoint_manager_->GetChannelMedium(endpoint_id) ==
+                 Medium::WIFI_LAN;
+        });
+    relay = std::make_shared<PayloadRelayTracker::Relay>();
+    relay->tree = PayloadRelayTree::Build(
+        client->GetLocalEndpointId(), tree_endpoint_ids,
+        NearbyFlags::GetInstance().GetInt64Flag(
+            config_package_nearby::nearby_connections_feature::
+                kClusterPayloadRelayFanOut));
+    relay->body = ByteArray(std::string(payload.AsBytesView()));
+    send_endpoint_ids = relay->tree.GetChildren(client->GetLocalEndpointId());
+  }
+
   Payload::Id payload_id =
-      CreateOutgoingPayload(std::move(payload), endpoint_ids);
-  executor->Execute(
-      "send-payload", [this, client, endpoint_ids, payload_id, payload_type,
-                       resume_offset, payload_total_size]() {
+      CreateOutgoingPayload(std::move(payload), send_endpoint_ids);
+  if (relay != nullptr) {
+    PendingPayload* pending_payload = GetPayload(payload_id);
+    if (pending_payload != nullptr) {
+      relay->header =
+          CreatePayloadHeader(*pending_payload->GetInternalPayload(),
+                              /*offset=*/0, /*parent_folder=*/"",
+                              /*file_name=*/"");
+      relay_tracker_.Start(payload_id, std::move(relay), send_endpoint_ids);
+      NEARBY_LOGS(INFO) << "PayloadManager: xfer relayed: payload_id="
+                        << payload_id << " over " << endpoint_ids.size()
+                        << " endpoints";
+    }
+  }
+  if (payload_type == PayloadType::kBytes) {
+    if (relay == nullptr &&
+        CanBatchBytesPayload(client, endpoint_ids, payload_total_size,
+                             resume_offset)) {
+      AddToBytesPayloadBatch(client, endpoint_ids, payload_id,
+                             payload_total_size);
+      NEARBY_LOGS(INFO) << "PayloadManager: xfer batched: self=" << this
+                        << "; payload_id=" << payload_id;
+      return;
+    }
+    // Keep BYTES payloads in order: whatever is batched goes out first.
+    MutexLock lock(&bytes_batch_mutex_);
+    FlushBytesPayloadBatchLocked();
+  }
+  Runnable send_payload = [this, client, send_endpoint_ids, payload_id,
+                           payload_type, resume_offset, payload_total_size]() {
+    SendPendingPayload(client, send_endpoint_ids, payload_id, payload_type,
+                       resume_offset, payload_total_size);
+  };
+  RoundRobinExecutor* pool = GetOutgoingPayloadPool(payload_type);
+  if (pool) {
+    pool->Execute(GetSendChannelId(send_endpoint_ids), "send-payload",
+                  std::move(send_payload));
+  } else {
+    executor->Execute("send-payload", std::move(send_payload));
+  }
+  NEARBY_LOGS(INFO) << "PayloadManager: xfer scheduled: self=" << this
+                    << "; payload_id=" << payload_id
+                    << ", payload_type=" << ToString(payload_type);
+}
+
+void PayloadManager::SendPendingPayload(ClientProxy* client,
+                                        const EndpointIds& endpoint_ids,
+                                        Payload::Id payload_id,
+                                        PayloadType payload_type,
+                                        size_t resume_offset,
+                                        std::int64_t payload_total_size) {
+  if (shutdown_.Get()) return;
+  PendingPayload* pending_payload = GetPayload(payload_id);
+  if (!pending_payload) {
+    RecordInvalidPayloadAnalytics(client, endpoint_ids, payload_id,
+                                  payload_type, resume_offset,
+                                  payload_total_size);
+    NEARBY_LOGS(INFO)
+        << "PayloadManager failed to create InternalPayload for outgoing "
+           "payload_id="
+        << payload_id << ", payload_type=" << ToString(payload_type)
+        << ", aborting sendPayload().";
+    return;
+  }
+  auto* internal_payload = pending_payload->GetInternalPayload();
+  if (!internal_payload) return;
+
+  RecordPayloadStartedAnalytics(client, endpoint_ids, payload_id,
+                                payload_type, resume_offset,
+                                internal_payload->GetTotalSize());
+
+  PayloadTransferFrame::PayloadHeader payload_header{
+      CreatePayloadHeader(*internal_payload, resume_offset,
+                          internal_payload->GetParentFolder(),
+                          internal_payload->GetFileName())};
+  std::shared_ptr<const PayloadRelayTracker::Relay> relay =
+      relay_tracker_.GetRelay(payload_id);
+  if (relay != nullptr && relay->parent_endpoint_id.empty()) {
+    relay->tree.AddToHeader(payload_header);
+  }
+
+  bool should_continue = true;
+  std::int64_t next_chunk_offset = 0;
+
+  // The send loop fails the endpoints that can't receive a batch before its
+  // first chunk goes out.
+  if (payload_type == PayloadType::kFileBatch) {
+    for (const auto& endpoint_id : endpoint_ids) {
+      EndpointInfo* endpoint_info = pending_payload->GetEndpoint(endpoint_id);
+      if (endpoint_info != nullptr &&
+          !client->RemoteSupportsFileBatch(endpoint_id)) {
+        NEARBY_LOGS(WARNING) << "Batch payload_id=" << payload_id
+                             << " can't be sent to endpoint_id="
+                             << endpoint_id;
+        endpoint_info->status.Set(EndpointInfo::Status::kError);
+      }
+    }
+  }
+
+  // The send loop announces the chunks with manifests as it gets to them.
+  if (payload_type == PayloadType::kFile && resume_offset == 0 &&
+      CanSendChunkManifest(client, endpoint_ids)) {
+    pending_payload->SetSkippedChunks(
+        SkippedChunks{.chunk_size = FileChunkStore::kChunkSize});
+  }
+
+  // Reading ahead can't jump over skipped chunks.
+  std::unique_ptr<PayloadChunkPrefetcher> prefetcher;
+  std::int64_t prefetch_chunks = NearbyFlags::GetInstance().GetInt64Flag(
+      config_package_nearby::nearby_connections_feature::
+          kOutgoingFilePayloadPrefetchChunks);
+  if (payload_type == PayloadType::kFile && prefetch_chunks > 0 &&
+      pending_payload->GetSkippedChunks() == nullptr) {
+    prefetcher = std::make_unique<PayloadChunkPrefetcher>(internal_payload,
+                                                          prefetch_chunks);
+  }
+
+  ThroughputRecorderContainer::GetInstance()
+      .GetTPRecorder(payload_id, PayloadDirection::OUTGOING_PAYLOAD)
+      ->Start(payload_type, PayloadDirection::OUTGOING_PAYLOAD);
+  // The weight only depends on the client's service IDs, which take locks to
+  // read, so it isn't looked up again for every chunk.
+  int send_weight = send_scheduler_ ? GetSendWeight(client) : 1;
+  while (should_continue && !shutdown_.Get()) {
+    should_continue = SendPayloadLoop(client, *pending_payload, payload_header,
+                                      next_chunk_offset, resume_offset,
+                                      prefetcher.get(), send_weight);
+  }
+  // Stop reading ahead before the pending payload can be destroyed.
+  prefetcher.reset();
+
+  ThroughputRecorderContainer::GetInstance().StopTPRecorder(
+      payload_id, PayloadDirection::OUTGOING_PAYLOAD);
+  RunOnStatusUpdateThread(
+      "destroy-payload",
+      [this, payload_id]() RUN_ON_PAYLOAD_STATUS_UPDATE_THREAD() {
+        DestroyPendingPayload(payload_id);
+      });
+}
+
+bool PayloadManager::CanSendSingleFrameBytesPayload(
+    ClientProxy* client, const EndpointIds& endpoint_ids) {
+  if (!NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableSingleFrameBytesPayloads)) {
+    return false;
+  }
+  for (const auto& endpoint_id : endpoint_ids) {
+    if (!client->RemoteSupportsSingleFrameBytesPayloads(endpoint_id)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PayloadManager::CanSendChunkManifest(ClientProxy* client,
+                                          const EndpointIds& endpoint_ids) {
+  if (!NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableFilePayloadChunkDedup)) {
+    return false;
+  }
+  // Each receiver could have different chunks, but all are sent the same.
+  return endpoint_ids.size() == 1 &&
+         client->RemoteSupportsChunkDedup(endpoint_ids.front());
+}
+
+void PayloadManager::SendChunkManifest(
+    PendingPayload& pending_payload,
+    const PayloadTransferFrame::PayloadHeader& header,
+    const std::string& endpoint_id, std::int64_t offset) {
+  SkippedChunks& skipped_chunks = *pending_payload.GetSkippedChunks();
+  // Only sent again once this one is answered.
+  skipped_chunks.sends_manifests = false;
+  std::optional<FileChunkStore::ChunkManifest> manifest =
+      pending_payload.GetInternalPayload()->CreateChunkManifest(offset);
+  EndpointInfo* endpoint_info = pending_payload.GetEndpoint(endpoint_id);
+  if (!manifest.has_value() || endpoint_info == nullptr ||
+      manifest->chunk_size() != skipped_chunks.chunk_size) {
+    return;
+  }
+  const int chunk_count = manifest->chunk_hashes_size();
+
+  {
+    MutexLock lock(&credit_mutex_);
+    endpoint_info->present_chunks.reset();
+  }
+  PayloadTransferFrame::ControlMessage control_message;
+  control_message.set_event(
+      PayloadTransferFrame::ControlMessage::PAYLOAD_MANIFEST);
+  control_message.set_offset(offset);
+  *control_message.mutable_chunk_manifest() = std::move(*manifest);
+  if (!endpoint_manager_
+           ->SendControlMessage(header, control_message, {endpoint_id})
+           .empty()) {
+    return;
+  }
+
+  std::optional<std::string> present_chunks;
+  {
+    MutexLock lock(&credit_mutex_);
+    absl::Time deadline =
+        SystemClock::ElapsedRealtime() + kChunkManifestReplyTimeout;
+    while (!endpoint_info->present_chunks.has_value() &&
+           !pending_payload.IsLocallyCanceled() && !shutdown_.Get() &&
+           endpoint_info->status.Get() == EndpointInfo::Status::kAvailable &&
+           SystemClock::ElapsedRealtime() < deadline) {
+      credit_cond_.Wait(kStreamCreditWaitTimeout);
+    }
+    present_chunks = std::move(endpoint_info->present_chunks);
+  }
+  // A receiver that can't use the manifests answers without present chunks.
+  if (!present_chunks.has_value() || present_chunks->empty()) {
+    NEARBY_LOGS(INFO) << "No chunks of payload_id=" << header.id()
+                      << " from offset " << offset
+                      << " are left out, sending all that remain.";
+    return;
+  }
+  std::vector<bool> present =
+      FileChunkStore::DecodePresentChunks(*present_chunks, chunk_count);
+  NEARBY_LOGS(INFO) << "Endpoint " << endpoint_id << " has "
+                    << std::count(present.begin(), present.end(), true)
+                    << " of " << chunk_count << " chunks of payload_id="
+                    << header.id() << " from offset " << offset;
+  skipped_chunks.chunks.insert(skipped_chunks.chunks.end(), present.begin(),
+                               present.end());
+  skipped_chunks.sends_manifests = true;
+}
+
+void PayloadManager::OnChunkManifestReply(
+    PendingPayload& pending_payload, const std::string& endpoint_id,
+    const PayloadTransferFrame::ControlMessage& control_message) {
+  EndpointInfo* endpoint_info = pending_payload.GetEndpoint(endpoint_id);
+  if (endpoint_info == nullptr) return;
+  MutexLock lock(&credit_mutex_);
+  endpoint_info->present_chunks = control_message.present_chunks();
+  credit_cond_.Notify();
+}
+
+bool PayloadManager::CanCompressPayloadChunks(
+    ClientProxy* client, const EndpointIds& endpoint_ids,
+    PayloadTransferFrame::PayloadHeader::PayloadType payload_type) {
+  if (!NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnablePayloadCompression)) {
+    return false;
+  }
+  if (payload_type == PayloadTransferFrame::PayloadHeader::FILE &&
+      !NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableFilePayloadCompression)) {
+    return false;
+  }
+  for (const auto& endpoint_id : endpoint_ids) {
+    if (!client->RemoteSupportsCompressedChunks(endpoint_id)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PayloadManager::CanBatchBytesPayload(ClientProxy* client,
+                                          const EndpointIds& endpoint_ids,
+                                          std::int64_t total_size,
+                                          size_t resume_offset) {
+  if (!NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableBytesPayloadBatching)) {
+    return false;
+  }
+  if (total_size <= 0 || total_size > kMaxBatchedBytesPayloadSize ||
+      resume_offset != 0 || endpoint_ids.empty()) {
+    return false;
+  }
+  for (const auto& endpoint_id : endpoint_ids) {
+    if (!client->RemoteSupportsBytesPayloadBatching(endpoint_id)) return false;
+  }
+  return true;
+}
+
+void PayloadManager::AddToBytesPayloadBatch(ClientProxy* client,
+                                            const EndpointIds& endpoint_ids,
+                                            Payload::Id payload_id,
+                                            std::int64_t total_size) {
+  MutexLock lock(&bytes_batch_mutex_);
+  if (!bytes_batch_.entries.empty() &&
+      (bytes_batch_.client != client ||
+       bytes_batch_.endpoint_ids != endpoint_ids)) {
+    FlushBytesPayloadBatchLocked();
+  }
+  bool is_new_batch = bytes_batch_.entries.empty();
+  bytes_batch_.client = client;
+  bytes_batch_.endpoint_ids = endpoint_ids;
+  bytes_batch_.entries.push_back({payload_id, total_size});
+  bytes_batch_.total_size += total_size;
+
+  if (bytes_batch_.entries.size() >=
+          static_cast<size_t>(kMaxBytesPayloadBatchCount) ||
+      bytes_batch_.total_size >= kMaxBytesPayloadBatchSize) {
+    FlushBytesPayloadBatchLocked();
+    return;
+  }
+  if (!is_new_batch) return;
+
+  // The first payload of a batch decides when it goes out.
+  std::int64_t generation = bytes_batch_generation_;
+  absl::Duration linger =
+      absl::Milliseconds(NearbyFlags::GetInstance().GetInt64Flag(
+          config_package_nearby::nearby_connections_feature::
+              kBytesPayloadBatchLingerMillis));
+  if (linger <= absl::ZeroDuration()) {
+    // Whatever gets queued before the BYTES executor comes around joins in.
+    bytes_payload_executor_.Execute(
+        "flush-bytes-batch",
+        [this, generation]() { FlushBytesPayloadBatch(generation); });
+    return;
+  }
+  bytes_batch_alarm_executor_.Schedule(
+      [this, generation]() {
+        bytes_payload_executor_.Execute(
+            "flush-bytes-batch",
+            [this, generation]() { FlushBytesPayloadBatch(generation); });
+      },
+      linger);
+}
+
+void PayloadManager::FlushBytesPayloadBatchLocked() {
+  if (bytes_batch_.entries.empty()) return;
+  ++bytes_batch_generation_;
+  bytes_payload_executor_.Execute(
+      "send-bytes-batch",
+      [this, batch = std::move(bytes_batch_)]() mutable {
+        SendBytesPayloadBatch(std::move(batch));
+      });
+  bytes_batch_ = BytesPayloadBatch();
+}
+
+void PayloadManager::FlushBytesPayloadBatch(std::int64_t generation) {
+  MutexLock lock(&bytes_batch_mutex_);
+  if (generation != bytes_batch_generation_) return;
+  FlushBytesPayloadBatchLocked();
+}
+
+void PayloadManager::SendBytesPayloadBatch(BytesPayloadBatch batch) {
+  if (shutdown_.Get()) return;
+  std::vector<PendingPayload*> batchable;
+  for (const auto& entry : batch.entries) {
+    PendingPayload* pending_payload = GetPayload(entry.payload_id);
+    if (pending_payload != nullptr && !pending_payload->IsLocallyCanceled() &&
+        GetAvailableAndUnavailableEndpoints(*pending_payload).second.empty()) {
+      batchable.push_back(pending_payload);
+      continue;
+    }
+    // Everything queued ahead of this payload goes first, then it is taken
+    // through the regular send path, which reports the cancellation or error.
+    WriteBytesPayloadBatch(batch.client, batch.endpoint_ids, batchable);
+    batchable.clear();
+    SendPendingPayload(batch.client, batch.endpoint_ids, entry.payload_id,
+                       PayloadType::kBytes, /*resume_offset=*/0,
+                       entry.total_size);
+  }
+  WriteBytesPayloadBatch(batch.client, batch.endpoint_ids, batchable);
+}
+
+void PayloadManager::WriteBytesPayloadBatch(
+    ClientProxy* client, const EndpointIds& endpoint_ids,
+    const std::vector<PendingPayload*>& payloads) {
+  if (payloads.empty()) return;
+
+  std::vector<PayloadTransferFrame::BytesPayload> bytes_payloads;
+  bytes_payloads.reserve(payloads.size());
+  for (PendingPayload* pending_payload : payloads) {
+    InternalPayload* internal_payload = pending_payload->GetInternalPayload();
+    RecordPayloadStartedAnalytics(client, endpoint_ids, pending_payload->GetId(),
+                                  PayloadType::kBytes, /*offset=*/0,
+                                  internal_payload->GetTotalSize());
+    ThroughputRecorderContainer::GetInstance()
+        .GetTPRecorder(pending_payload->GetId(),
+                       PayloadDirection::OUTGOING_PAYLOAD)
+        ->Start(PayloadType::kBytes, PayloadDirection::OUTGOING_PAYLOAD);
+    for (const auto& endpoint_id : endpoint_ids) {
+      pending_payload->SetOffsetForEndpoint(endpoint_id, 0);
+    }
+
+    PayloadTransferFrame::BytesPayload bytes_payload;
+    *bytes_payload.mutable_payload_header() =
+        CreatePayloadHeader(*internal_payload, /*offset=*/0,
+                            /*parent_folder=*/"", /*file_name=*/"");
+    bytes_payload.set_body(std::string(internal_payload->DetachNextChunk(
+        internal_payload->GetTotalSize())));
+    bytes_payloads.push_back(std::move(bytes_payload));
+  }
+
+  PacketMetaData packet_meta_data;
+  absl::Time write_start_time = SystemClock::ElapsedRealtime();
+  const EndpointIds& failed_endpoint_ids =
+      endpoint_manager_->SendBytesPayloadBatch(bytes_payloads, endpoint_ids,
+                                               packet_meta_data);
+  absl::Duration write_time = SystemClock::ElapsedRealtime() - write_start_time;
+
+  EndpointIds succeeded_endpoint_ids;
+  for (const auto& endpoint_id : endpoint_ids) {
+    if (std::find(failed_endpoint_ids.begin(), failed_endpoint_ids.end(),
+                  endpoint_id) == failed_endpoint_ids.end()) {
+      succeeded_endpoint_ids.push_back(endpoint_id);
+    }
+  }
+  std::int64_t batch_size = 0;
+  for (const auto& bytes_payload : bytes_payloads) {
+    const PayloadTransferFrame::PayloadHeader& payload_header =
+        bytes_payload.payload_header();
+    std::int64_t body_size = bytes_payload.body().size();
+    batch_size += body_size;
+    if (!failed_endpoint_ids.empty()) {
+      NEARBY_LOGS(INFO) << "Payload xfer: endpoints failed: payload_id="
+                        << payload_header.id() << "; endpoint_ids={"
+                        << ToString(failed_endpoint_ids) << "}";
+      HandleFinishedOutgoingPayload(
+          client, failed_endpoint_ids, payload_header,
+          /*num_bytes_successfully_transferred=*/0,
+          location::nearby::proto::connections::PayloadStatus::
+              ENDPOINT_IO_ERROR);
+    }
+    // The remote end unpacks each payload into its data chunk and last chunk,
+    // so report both here as well.
+    for (const auto& endpoint_id : succeeded_endpoint_ids) {
+      HandleSuccessfulOutgoingChunk(client, endpoint_id, payload_header,
+                                    /*payload_chunk_flags=*/0,
+                                    /*payload_chunk_offset=*/0, body_size);
+      HandleSuccessfulOutgoingChunk(
+          client, endpoint_id, payload_header,
+          PayloadTransferFrame::PayloadChunk::LAST_CHUNK,
+          /*payload_chunk_offset=*/body_size, /*payload_chunk_body_size=*/0);
+    }
+    if (!succeeded_endpoint_ids.empty()) {
+      ThroughputRecorderContainer::GetInstance()
+          .GetTPRecorder(payload_header.id(),
+                         PayloadDirection::OUTGOING_PAYLOAD)
+          ->MarkAsSuccess();
+    }
+    ThroughputRecorderContainer::GetInstance().StopTPRecorder(
+        payload_header.id(), PayloadDirection::OUTGOING_PAYLOAD);
+    Payload::Id payload_id = payload_header.id();
+    RunOnStatusUpdateThread(
+        "destroy-payload",
+        [this, payload_id]() RUN_ON_PAYLOAD_STATUS_UPDATE_THREAD() {
+          DestroyPendingPayload(payload_id);
+        });
+  }
+  RecordChunkWriteTime(succeeded_endpoint_ids, batch_size, write_time);
+  NEARBY_LOGS(VERBOSE) << "PayloadManager done sending " << payloads.size()
+                       << " batched BYTES payloads; size=" << batch_size;
+}
+
+bool PayloadManager::CanRelayPayload(ClientProxy* client,
+                                     const EndpointIds& endpoint_ids,
+                                     std::int64_t total_size,
+                                     size_t resume_offset) {
+  if (!NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableClusterPayloadRelay)) {
+    return false;
+  }
+  std::int64_t fan_out = NearbyFlags::GetInstance().GetInt64Flag(
+      config_package_nearby::nearby_connections_feature::
+          kClusterPayloadRelayFanOut);
+  if (total_size <= 0 || resume_offset != 0 || fan_out <= 0 ||
+      endpoint_ids.size() <= fan_out) {
+    return false;
+  }
+  // Relays forward the payload as a single chunk.
+  for (const auto& endpoint_id : endpoint_ids) {
+    if (!client->RemoteSupportsPayloadRelay(endpoint_id) ||
+        total_size > endpoint_manager_->GetMaxTransmitPacketSize(endpoint_id)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::optional<std::string> PayloadManager::GetRelayOrigin(
+    ClientProxy* client, const std::string& from_endpoint_id,
+    const PayloadTransferFrame::PayloadHeader& payload_header) {
+  // Only relayed if the local endpoint said it would.
+  if (payload_header.relay_nodes_size() == 0 ||
+      payload_header.type() != PayloadTransferFrame::PayloadHeader::BYTES ||
+      !NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableClusterPayloadRelay) ||
+      !client->RemoteSupportsPayloadRelay(from_endpoint_id)) {
+    return std::nullopt;
+  }
+  PayloadRelayTree tree = PayloadRelayTree::FromHeader(payload_header);
+  const std::string& origin_endpoint_id = tree.GetRoot();
+  const std::string& local_endpoint_id = client->GetLocalEndpointId();
+  std::int64_t fan_out = NearbyFlags::GetInstance().GetInt64Flag(
+      config_package_nearby::nearby_connections_feature::
+          kClusterPayloadRelayFanOut);
+  if (origin_endpoint_id == local_endpoint_id ||
+      !tree.IsChildOf(local_endpoint_id, from_endpoint_id) ||
+      (origin_endpoint_id != from_endpoint_id &&
+       !client->IsConnectedToEndpoint(origin_endpoint_id)) ||
+      static_cast<std::int64_t>(tree.GetChildren(local_endpoint_id).size()) >
+          fan_out) {
+    NEARBY_LOGS(WARNING) << "PayloadManager: not relaying payload_id="
+                         << payload_header.id() << " from endpoint_id="
+                         << from_endpoint_id << " with an invalid relay tree";
+    return std::nullopt;
+  }
+  return origin_endpoint_id;
+}
+
+void PayloadManager::RelayIncomingPayload(
+    ClientProxy* client, const std::string& from_endpoint_id,
+    const PayloadTransferFrame::PayloadHeader& payload_header,
+    ByteArray body) {
+  auto relay = std::make_shared<PayloadRelayTracker::Relay>();
+  relay->parent_endpoint_id = from_endpoint_id;
+  relay->tree = PayloadRelayTree::FromHeader(payload_header);
+  relay->header = payload_header;
+  relay->body = std::move(body);
+  EndpointIds child_endpoint_ids =
+      relay->tree.GetChildren(client->GetLocalEndpointId());
+  child_endpoint_ids.erase(
+      std::remove(child_endpoint_ids.begin(), child_endpoint_ids.end(),
+                  from_endpoint_id),
+      child_endpoint_ids.end());
+  if (child_endpoint_ids.empty()) {
+    PayloadRelayTracker::ChildResult result;
+    result.relay = std::move(relay);
+    result.all_failed_endpoint_ids.emplace();
+    OnRelayChildDone(client, std::move(result));
+    return;
+  }
+
+  NEARBY_LOGS(INFO) << "PayloadManager: relaying payload_id="
+                    << payload_header.id() << " from endpoint_id="
+                    << from_endpoint_id << " to endpoint_ids={"
+                    << ToString(child_endpoint_ids) << "}";
+  relay_tracker_.Start(payload_header.id(), relay, child_endpoint_ids);
+  bytes_payload_executor_.Execute(
+      "relay-payload", [this, client, relay, child_endpoint_ids]() {
         if (shutdown_.Get()) return;
-        PendingPayload* pending_payload = GetPayload(payload_id);
-        if (!pending_payload) {
-          RecordInvalidPayloadAnalytics(client, endpoint_ids, payload_id,
-                                        payload_type, resume_offset,
-                                        payload_total_size);
-          NEARBY_LOGS(INFO)
-              << "PayloadManager failed to create InternalPayload for outgoing "
-                 "payload_id="
-              << payload_id << ", payload_type=" << ToString(payload_type)
-              << ", aborting sendPayload().";
-          return;
-        }
-        auto* internal_payload = pending_payload->GetInternalPayload();
-        if (!internal_payload) return;
-
-        RecordPayloadStartedAnalytics(client, endpoint_ids, payload_id,
-                                      payload_type, resume_offset,
-                                      internal_payload->GetTotalSize());
-
-        PayloadTransferFrame::PayloadHeader payload_header{
-            CreatePayloadHeader(*internal_payload, resume_offset,
-                                internal_payload->GetParentFolder(),
-                                internal_payload->GetFileName())};
-
-        bool should_continue = true;
-        std::int64_t next_chunk_offset = 0;
-
-        ThroughputRecorderContainer::GetInstance()
-            .GetTPRecorder(payload_id, PayloadDirection::OUTGOING_PAYLOAD)
-            ->Start(payload_type, PayloadDirection::OUTGOING_PAYLOAD);
-        while (should_continue && !shutdown_.Get()) {
-          should_continue =
-              SendPayloadLoop(client, *pending_payload, payload_header,
-                              next_chunk_offset, resume_offset);
+        for (const auto& endpoint_id : WriteRelayPayload(
+                 client, relay->header, relay->body, child_endpoint_ids)) {
+          std::optional<PayloadRelayTracker::ChildResult> result =
+              relay_tracker_.OnChildDone(relay->header.id(), endpoint_id, {},
+                                         /*child_failed=*/true);
+          if (result.has_value()) {
+            OnRelayChildDone(client, *std::move(result));
+          }
         }
+      });
+}
 
-        ThroughputRecorderContainer::GetInstance().StopTPRecorder(
-            payload_id, PayloadDirection::OUTGOING_PAYLOAD);
-        RunOnStatusUpdateThread("destroy-payload",
-                                [this, payload_id]()
-                                    RUN_ON_PAYLOAD_STATUS_UPDATE_THREAD() {
-                                      DestroyPendingPayload(payload_id);
-                                    });
+std::vector<std::string> PayloadManager::WriteRelayPayload(
+    ClientProxy* client,
+    const PayloadTransferFrame::PayloadHeader& payload_header,
+    const ByteArray& body, const EndpointIds& endpoint_ids) {
+  std::vector<std::string> failed_endpoint_ids;
+  EndpointIds reachable_endpoint_ids;
+  for (const auto& endpoint_id : endpoint_ids) {
+    if (client->IsConnectedToEndpoint(endpoint_id) &&
+        client->RemoteSupportsPayloadRelay(endpoint_id) &&
+        body.size() <=
+            endpoint_manager_->GetMaxTransmitPacketSize(endpoint_id)) {
+      reachable_endpoint_ids.push_back(endpoint_id);
+    } else {
+      failed_endpoint_ids.push_back(endpoint_id);
+    }
+  }
+  if (reachable_endpoint_ids.empty()) return failed_endpoint_ids;
+
+  PacketMetaData packet_meta_data;
+  std::vector<std::string> write_failed_endpoint_ids =
+      endpoint_manager_->SendPayloadChunks(
+          payload_header,
+          {CreatePayloadChunk(/*payload_chunk_offset=*/0, body),
+           CreatePayloadChunk(body.size(), ByteArray())},
+          reachable_endpoint_ids, packet_meta_data);
+  failed_endpoint_ids.insert(failed_endpoint_ids.end(),
+                             write_failed_endpoint_ids.begin(),
+                             write_failed_endpoint_ids.end());
+  return failed_endpoint_ids;
+}
+
+void PayloadManager::OnRelayChildDone(ClientProxy* client,
+                                      PayloadRelayTracker::ChildResult result) {
+  std::shared_ptr<const PayloadRelayTracker::Relay> relay =
+      std::move(result.relay);
+  const PayloadTransferFrame::PayloadHeader& payload_header = relay->header;
+
+  // A relay answers where the payload came from once it is done with all the
+  // endpoints below it.
+  if (!relay->parent_endpoint_id.empty()) {
+    if (!result.all_failed_endpoint_ids.has_value()) return;
+    PayloadTransferFrame::PayloadHeader header;
+    header.set_id(payload_header.id());
+    header.set_type(payload_header.type());
+    header.set_total_size(payload_header.total_size());
+    PayloadTransferFrame::ControlMessage control_message;
+    control_message.set_event(
+        PayloadTransferFrame::ControlMessage::PAYLOAD_RELAYED);
+    control_message.set_offset(payload_header.total_size());
+    for (const auto& endpoint_id : *result.all_failed_endpoint_ids) {
+      control_message.add_failed_endpoint_ids(endpoint_id);
+    }
+    endpoint_manager_->SendControlMessage(header, control_message,
+                                          {relay->parent_endpoint_id});
+    return;
+  }
+
+  // Where the payload was sent from, the child itself was already reported by
+  // the regular send path.
+  EndpointIds delivered_endpoint_ids;
+  for (auto& endpoint_id : result.delivered_endpoint_ids) {
+    if (endpoint_id != result.child_endpoint_id) {
+      delivered_endpoint_ids.push_back(std::move(endpoint_id));
+    }
+  }
+  EndpointIds fallback_endpoint_ids;
+  for (auto& endpoint_id : result.failed_endpoint_ids) {
+    if (endpoint_id != result.child_endpoint_id) {
+      fallback_endpoint_ids.push_back(std::move(endpoint_id));
+    }
+  }
+
+  auto report = [this, client, payload_header](
+                    EndpointIds endpoint_ids,
+                    PayloadProgressInfo::Status status) {
+    if (endpoint_ids.empty()) return;
+    RunOnStatusUpdateThread(
+        "relayed-payload-callbacks",
+        [this, client, payload_header, endpoint_ids,
+         status]() RUN_ON_PAYLOAD_STATUS_UPDATE_THREAD() {
+          PayloadProgressInfo update{
+              payload_header.id(), status, payload_header.total_size(),
+              status == PayloadProgressInfo::Status::kSuccess
+                  ? payload_header.total_size()
+                  : 0};
+          for (const auto& endpoint_id : endpoint_ids) {
+            client->OnPayloadProgress(endpoint_id, update);
+          }
+        });
+  };
+  report(std::move(delivered_endpoint_ids),
+         PayloadProgressInfo::Status::kSuccess);
+  if (fallback_endpoint_ids.empty()) return;
+
+  NEARBY_LOGS(INFO) << "PayloadManager: relaying payload_id="
+                    << payload_header.id()
+                    << " failed, sending it directly to endpoint_ids={"
+                    << ToString(fallback_endpoint_ids) << "}";
+  bytes_payload_executor_.Execute(
+      "relay-payload-fallback",
+      [this, client, relay, fallback_endpoint_ids, report]() {
+        if (shutdown_.Get()) return;
+        std::vector<std::string> failed_endpoint_ids = WriteRelayPayload(
+            client, relay->header, relay->body, fallback_endpoint_ids);
+        EndpointIds sent_endpoint_ids;
+        for (const auto& endpoint_id : fallback_endpoint_ids) {
+          if (std::find(failed_endpoint_ids.begin(), failed_endpoint_ids.end(),
+                        endpoint_id) == failed_endpoint_ids.end()) {
+            sent_endpoint_ids.push_back(endpoint_id);
+          }
+        }
+        report(std::move(sent_endpoint_ids),
+               PayloadProgressInfo::Status::kSuccess);
+        report(std::move(failed_endpoint_ids),
+               PayloadProgressInfo::Status::kFailure);
       });
-  NEARBY_LOGS(INFO) << "PayloadManager: xfer scheduled: self=" << this
-                    << "; payload_id=" << payload_id
-                    << ", payload_type=" << ToString(payload_type);
 }
 
 PayloadManager::PendingPayload* PayloadManager::GetPayload(
@@ -485,6 +1318,7 @@ Status PayloadManager::CancelPayload(ClientProxy* client,
 
   // Mark the payload as canceled.
   canceled_payload->MarkLocallyCanceled();
+  NotifyStreamCreditWaiters();
   NEARBY_LOGS(INFO) << "Cancelling "
                     << (canceled_payload->IsIncoming() ? "incoming"
                                                        : "outgoing")
@@ -514,6 +1348,10 @@ void PayloadManager::OnIncomingFrame(
       ProcessDataPacket(to_client, from_endpoint_id, frame, current_medium,
                         packet_meta_data);
       break;
+    case PayloadTransferFrame::BYTES_BATCH:
+      ProcessBytesPayloadBatch(to_client, from_endpoint_id, frame,
+                               current_medium, packet_meta_data);
+      break;
     default:
       NEARBY_LOGS(WARNING)
           << "PayloadManager: invalid frame; remote endpoint: self=" << this
@@ -530,6 +1368,14 @@ void PayloadManager::OnEndpointDisconnect(ClientProxy* client,
     barrier.CountDown();
     return;
   }
+  {
+    MutexLock lock(&chunk_sizers_mutex_);
+    chunk_sizers_.erase(endpoint_id);
+  }
+  for (PayloadRelayTracker::ChildResult& result :
+       relay_tracker_.OnEndpointDisconnected(endpoint_id)) {
+    OnRelayChildDone(client, std::move(result));
+  }
   RunOnStatusUpdateThread(
       "payload-manager-on-disconnect",
       [this, client, endpoint_id, barrier]()
@@ -574,6 +1420,7 @@ void PayloadManager::OnEndpointDisconnect(ClientProxy* client,
                     location::nearby::proto::connections::ENDPOINT_IO_ERROR);
               }
             }
+            NotifyStreamCreditWaiters();
 
             barrier.CountDown();
           });
@@ -625,12 +1472,13 @@ PayloadProgressInfo::Status PayloadManager::PayloadStatusToTransferUpdateStatus(
   }
 }
 
-SingleThreadExecutor* PayloadManager::GetOutgoingPayloadExecutor(
+SubmittableExecutor* PayloadManager::GetOutgoingPayloadExecutor(
     PayloadType payload_type) {
   switch (payload_type) {
     case PayloadType::kBytes:
       return &bytes_payload_executor_;
     case PayloadType::kFile:
+    case PayloadType::kFileBatch:
       return &file_payload_executor_;
     case PayloadType::kStream:
       return &stream_payload_executor_;
@@ -639,15 +1487,114 @@ SingleThreadExecutor* PayloadManager::GetOutgoingPayloadExecutor(
   }
 }
 
+RoundRobinExecutor* PayloadManager::GetOutgoingPayloadPool(
+    PayloadType payload_type) {
+  switch (payload_type) {
+    case PayloadType::kFile:
+    case PayloadType::kFileBatch:
+      return file_payload_pool_.get();
+    case PayloadType::kStream:
+      return stream_payload_pool_.get();
+    default:
+      return nullptr;
+  }
+}
+
 int PayloadManager::GetOptimalChunkSize(EndpointIds endpoint_ids) {
   int minChunkSize = std::numeric_limits<int>::max();
+  if (!NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableAdaptiveChunkSize)) {
+    for (const auto& endpoint_id : endpoint_ids) {
+      minChunkSize =
+          std::min(minChunkSize,
+                   endpoint_manager_->GetMaxTransmitPacketSize(endpoint_id));
+    }
+    return minChunkSize;
+  }
+
+  MutexLock lock(&chunk_sizers_mutex_);
   for (const auto& endpoint_id : endpoint_ids) {
-    minChunkSize = std::min(
-        minChunkSize, endpoint_manager_->GetMaxTransmitPacketSize(endpoint_id));
+    auto it = chunk_sizers_.find(endpoint_id);
+    if (it == chunk_sizers_.end()) {
+      it = chunk_sizers_
+               .emplace(endpoint_id,
+                        AdaptiveChunkSizer(
+                            endpoint_manager_->GetMaxTransmitPacketSize(
+                                endpoint_id)))
+               .first;
+    }
+    minChunkSize = std::min(minChunkSize, it->second.GetChunkSize());
   }
   return minChunkSize;
 }
 
+void PayloadManager::RecordChunkWriteTime(const EndpointIds& endpoint_ids,
+                                          int chunk_size,
+                                          absl::Duration write_time) {
+  MutexLock lock(&chunk_sizers_mutex_);
+  for (const auto& endpoint_id : endpoint_ids) {
+    auto it = chunk_sizers_.find(endpoint_id);
+    if (it != chunk_sizers_.end()) {
+      it->second.OnChunkWritten(chunk_size, write_time);
+    }
+  }
+}
+
+std::string PayloadManager::GetSendChannelId(
+    const EndpointIds& endpoint_ids) {
+  return absl::StrJoin(endpoint_ids, ",");
+}
+
+int PayloadManager::GetSendWeight(ClientProxy* client) const {
+  if (send_weights_.empty()) return 1;
+  for (const std::string& service_id :
+       {client->GetAdvertisingServiceId(), client->GetDiscoveryServiceId(),
+        client->GetListeningForIncomingConnectionsServiceId()}) {
+    auto it = send_weights_.find(service_id);
+    if (it != send_weights_.end()) return it->second;
+  }
+  return 1;
+}
+
+std::int64_t PayloadManager::WaitForStreamCredit(
+    PendingPayload& pending_payload, const EndpointIds& endpoint_ids,
+    std::int64_t offset) {
+  MutexLock lock(&credit_mutex_);
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    std::int64_t credit = std::numeric_limits<std::int64_t>::max();
+    for (const auto& endpoint_id : endpoint_ids) {
+      EndpointInfo* endpoint_info = pending_payload.GetEndpoint(endpoint_id);
+      if (endpoint_info == nullptr) continue;
+      std::int64_t credit_limit = endpoint_info->credit_limit.load();
+      if (credit_limit < 0) continue;
+      credit =
+          std::min(credit, std::max<std::int64_t>(credit_limit - offset, 0));
+    }
+    if (credit > 0 || attempt > 0) return credit;
+    credit_cond_.Wait(kStreamCreditWaitTimeout);
+  }
+  return 0;
+}
+
+void PayloadManager::OnStreamCreditGranted(PendingPayload& pending_payload,
+                                           const std::string& endpoint_id,
+                                           std::int64_t credit_limit) {
+  EndpointInfo* endpoint_info = pending_payload.GetEndpoint(endpoint_id);
+  if (endpoint_info == nullptr) return;
+  MutexLock lock(&credit_mutex_);
+  // Credit only grows; a reordered older grant is ignored.
+  if (credit_limit > endpoint_info->credit_limit.load()) {
+    endpoint_info->credit_limit.store(credit_limit);
+    credit_cond_.Notify();
+  }
+}
+
+void PayloadManager::NotifyStreamCreditWaiters() {
+  MutexLock lock(&credit_mutex_);
+  credit_cond_.Notify();
+}
+
 PayloadTransferFrame::PayloadHeader PayloadManager::CreatePayloadHeader(
     const InternalPayload& internal_payload, size_t offset,
     const std::string& parent_folder, const std::string& file_name) {
@@ -661,6 +1608,9 @@ PayloadTransferFrame::PayloadHeader PayloadManager::CreatePayloadHeader(
           PayloadHeader::FILE) {
     payload_header.set_file_name(file_name);
     payload_header.set_parent_folder(parent_folder);
+  } else if (internal_payload.GetType() ==
+             PayloadTransferFrame::PayloadHeader::FILE_BATCH) {
+    payload_header.set_parent_folder(parent_folder);
   }
   payload_header.set_total_size(payload_size ==
                                         InternalPayload::kIndeterminateSize
@@ -686,13 +1636,104 @@ PayloadTransferFrame::PayloadChunk PayloadManager::CreatePayloadChunk(
   return payload_chunk;
 }
 
+PayloadManager::PendingPayload* PayloadManager::StartIncomingPayload(
+    ClientProxy* to_client, const std::string& from_endpoint_id,
+    const PayloadTransferFrame& frame) {
+  const PayloadTransferFrame::PayloadHeader& payload_header =
+      frame.payload_header();
+  ThroughputRecorderContainer::GetInstance()
+      .GetTPRecorder(payload_header.id(), PayloadDirection::INCOMING_PAYLOAD)
+      ->Start((PayloadType)payload_header.type(),
+              PayloadDirection::INCOMING_PAYLOAD);
+  RunOnStatusUpdateThread(
+      "process-data-packet", [to_client, from_endpoint_id, payload_header,
+                              this]() RUN_ON_PAYLOAD_STATUS_UPDATE_THREAD() {
+        // This is the first chunk of a new incoming
+        // payload. Start the analysis.
+        to_client->GetAnalyticsRecorder().OnIncomingPayloadStarted(
+            from_endpoint_id, payload_header.id(),
+            FramePayloadTypeToPayloadType(payload_header.type()),
+            payload_header.total_size());
+      });
+
+  PendingPayload* pending_payload =
+      CreateIncomingPayload(to_client, frame, from_endpoint_id);
+  if (!pending_payload) {
+    NEARBY_LOGS(WARNING)
+        << "PayloadManager failed to create InternalPayload from "
+           "PayloadTransferFrame with payload_id="
+        << payload_header.id() << " and type " << payload_header.type()
+        << ", aborting receipt.";
+    // Send the error to the remote endpoint.
+    SendControlMessage({from_endpoint_id}, payload_header,
+                       frame.payload_chunk().offset(),
+                       PayloadTransferFrame::ControlMessage::PAYLOAD_ERROR);
+    return nullptr;
+  }
+
+  // Also, let the client know of this new incoming payload.
+  RunOnStatusUpdateThread(
+      "process-data-packet",
+      [to_client, from_endpoint_id, pending_payload]()
+          RUN_ON_PAYLOAD_STATUS_UPDATE_THREAD() {
+            NEARBY_LOGS(INFO)
+                << "PayloadManager received new payload_id="
+                << pending_payload->GetInternalPayload()->GetId()
+                << " from endpoint_id=" << from_endpoint_id;
+            to_client->OnPayload(
+                from_endpoint_id,
+                pending_payload->GetInternalPayload()->ReleasePayload());
+          });
+  return pending_payload;
+}
+
 PayloadManager::PendingPayload* PayloadManager::CreateIncomingPayload(
-    const PayloadTransferFrame& frame, const std::string& endpoint_id) {
-  auto internal_payload =
-      CreateIncomingInternalPayload(frame, custom_save_path_);
+    ClientProxy* client, const PayloadTransferFrame& frame,
+    const std::string& endpoint_id) {
+  // The sender of a STREAM payload may stay |credit_window| bytes ahead of the
+  // client. Credit is granted again once the client has read half of it. The
+  // grant is recorded on the client's reading thread, and sent from
+  // |stream_credit_executor_|, so that the read isn't held up by the write.
+  std::function<void(std::int64_t)> stream_read_observer;
+  std::int64_t credit_window = NearbyFlags::GetInstance().GetInt64Flag(
+      config_package_nearby::nearby_connections_feature::
+          kIncomingStreamCreditWindowBytes);
+  const bool grant_credit = credit_window > 0 &&
+                            frame.payload_header().type() ==
+                                PayloadTransferFrame::PayloadHeader::STREAM;
+  if (grant_credit) {
+    stream_read_observer =
+        [this, endpoint_id, payload_header = frame.payload_header(),
+         credit_window,
+         credit_limit = credit_window](std::int64_t bytes_read) mutable {
+          if (bytes_read + credit_window - credit_limit < credit_window / 2) {
+            return;
+          }
+          credit_limit = bytes_read + credit_window;
+          stream_credit_executor_.Execute(
+              "stream-credit",
+              [this, endpoint_id, payload_header, credit_limit]() {
+                SendControlMessage({endpoint_id}, payload_header,
+                                   credit_limit,
+                                   PayloadTransferFrame::ControlMessage::
+                                       PAYLOAD_CREDIT);
+              });
+        };
+  }
+  auto internal_payload = CreateIncomingInternalPayload(
+      frame, custom_save_path_, &client->GetMemoryAccountant(), endpoint_id,
+      std::move(stream_read_observer),
+      [client, endpoint_id,
+       payload_id = frame.payload_header().id()](size_t size) {
+        return client->GetIncomingBytesBuffer(endpoint_id, payload_id, size);
+      });
   if (!internal_payload) {
     return nullptr;
   }
+  if (grant_credit) {
+    SendControlMessage({endpoint_id}, frame.payload_header(), credit_window,
+                       PayloadTransferFrame::ControlMessage::PAYLOAD_CREDIT);
+  }
 
   Payload::Id payload_id = internal_payload->GetId();
   NEARBY_LOGS(INFO) << "CreateIncomingPayload: payload_id=" << payload_id;
@@ -803,6 +1844,18 @@ void PayloadManager::HandleFinishedOutgoingPayload(
       client, finished_endpoint_ids, payload_header,
       num_bytes_successfully_transferred, status);
 
+  // The endpoints a relayed payload didn't get to are now below nobody.
+  if (status != location::nearby::proto::connections::PayloadStatus::SUCCESS) {
+    for (const auto& endpoint_id : finished_endpoint_ids) {
+      std::optional<PayloadRelayTracker::ChildResult> result =
+          relay_tracker_.OnChildDone(payload_header.id(), endpoint_id, {},
+                                     /*child_failed=*/true);
+      if (result.has_value()) {
+        OnRelayChildDone(client, *std::move(result));
+      }
+    }
+  }
+
   switch (status) {
     case location::nearby::proto::connections::PayloadStatus::LOCAL_ERROR:
       SendControlMessage(finished_endpoint_ids, payload_header,
@@ -847,6 +1900,17 @@ void PayloadManager::HandleFinishedIncomingPayload(
     location::nearby::proto::connections::PayloadStatus status) {
   ThroughputRecorderContainer::GetInstance().StopTPRecorder(
       payload_header.id(), PayloadDirection::INCOMING_PAYLOAD);
+  // What was written of a file announced with a chunk manifest can still
+  // serve a later attempt.
+  if (PendingPayload* pending_payload = GetPayload(payload_header.id())) {
+    if (IncomingChunkManifest* incoming_chunk_manifest =
+            pending_payload->GetIncomingChunkManifest()) {
+      file_chunk_store_.AddFile(incoming_chunk_manifest->file_path,
+                                payload_header.total_size(),
+                                incoming_chunk_manifest->manifest,
+                                incoming_chunk_manifest->written_size);
+    }
+  }
   SendClientCallbacksForFinishedIncomingPayload(
       client, endpoint_id, payload_header, offset_bytes, status);
 
@@ -909,7 +1973,10 @@ void PayloadManager::HandleSuccessfulOutgoingChunk(
         }
 
         PendingPayload* pending_payload = GetPayload(payload_header.id());
-        if (!pending_payload || !pending_payload->GetEndpoint(endpoint_id)) {
+        EndpointInfo* endpoint_info =
+            pending_payload ? pending_payload->GetEndpoint(endpoint_id)
+                            : nullptr;
+        if (!endpoint_info) {
           NEARBY_LOGS(INFO)
               << "HandleSuccessfulOutgoingChunk: endpoint not found: "
                  "endpoint_id="
@@ -922,13 +1989,21 @@ void PayloadManager::HandleSuccessfulOutgoingChunk(
             is_last_chunk ? PayloadProgressInfo::Status::kSuccess
                           : PayloadProgressInfo::Status::kInProgress,
             payload_header.total_size(),
-            is_last_chunk ? payload_chunk_offset
-                          : payload_chunk_offset + payload_chunk_body_size};
+            payload_chunk_offset + payload_chunk_body_size};
 
-        // Notify the client.
-        client->OnPayloadProgress(endpoint_id, update);
+        // Notify the client, unless this in-progress update is coalesced into
+        // a later one.
+        if (is_last_chunk || endpoint_info->progress_throttle.ShouldReport(
+                                 update.bytes_transferred,
+                                 SystemClock::ElapsedRealtime())) {
+          client->OnPayloadProgress(endpoint_id, update);
+        }
 
         if (is_last_chunk) {
+          if (payload_chunk_body_size > 0) {
+            client->GetAnalyticsRecorder().OnPayloadChunkSent(
+                endpoint_id, payload_header.id(), payload_chunk_body_size);
+          }
           client->GetAnalyticsRecorder().OnOutgoingPayloadDone(
               endpoint_id, payload_header.id(),
               location::nearby::proto::connections::SUCCESS);
@@ -1013,14 +2088,24 @@ void PayloadManager::HandleSuccessfulIncomingChunk(
             is_last_chunk ? PayloadProgressInfo::Status::kSuccess
                           : PayloadProgressInfo::Status::kInProgress,
             payload_header.total_size(),
-            is_last_chunk ? payload_chunk_offset
-                          : payload_chunk_offset + payload_chunk_body_size};
-
-        // Notify the client of this update.
-        NotifyClientOfIncomingPayloadProgressInfo(client, endpoint_id, update);
+            payload_chunk_offset + payload_chunk_body_size};
+
+        // Notify the client of this update, unless this in-progress update is
+        // coalesced into a later one.
+        EndpointInfo* endpoint_info = pending_payload->GetEndpoint(endpoint_id);
+        if (is_last_chunk || !endpoint_info ||
+            endpoint_info->progress_throttle.ShouldReport(
+                update.bytes_transferred, SystemClock::ElapsedRealtime())) {
+          NotifyClientOfIncomingPayloadProgressInfo(client, endpoint_id,
+                                                    update);
+        }
 
         // Analyze the success.
         if (is_last_chunk) {
+          if (payload_chunk_body_size > 0) {
+            client->GetAnalyticsRecorder().OnPayloadChunkReceived(
+                endpoint_id, payload_header.id(), payload_chunk_body_size);
+          }
           client->GetAnalyticsRecorder().OnIncomingPayloadDone(
               endpoint_id, payload_header.id(),
               location::nearby::proto::connections::SUCCESS);
@@ -1045,57 +2130,47 @@ void PayloadManager::ProcessDataPacket(
                        << " from endpoint_id=" << from_endpoint_id
                        << " at offset " << payload_chunk.offset();
 
-  PendingPayload* pending_payload;
-  if (payload_chunk.offset() == 0) {
-    ThroughputRecorderContainer::GetInstance()
-        .GetTPRecorder(payload_header.id(), PayloadDirection::INCOMING_PAYLOAD)
-        ->Start((PayloadType)payload_header.type(),
-                PayloadDirection::INCOMING_PAYLOAD);
-    packet_meta_data.Reset();
-    RunOnStatusUpdateThread(
-        "process-data-packet", [to_client, from_endpoint_id, payload_header,
-                                this]() RUN_ON_PAYLOAD_STATUS_UPDATE_THREAD() {
-          // This is the first chunk of a new incoming
-          // payload. Start the analysis.
-          to_client->GetAnalyticsRecorder().OnIncomingPayloadStarted(
-              from_endpoint_id, payload_header.id(),
-              FramePayloadTypeToPayloadType(payload_header.type()),
-              payload_header.total_size());
-        });
-
-    pending_payload =
-        CreateIncomingPayload(payload_transfer_frame, from_endpoint_id);
-    if (!pending_payload) {
-      NEARBY_LOGS(WARNING)
-          << "PayloadManager failed to create InternalPayload from "
-             "PayloadTransferFrame with payload_id="
-          << payload_header.id() << " and type " << payload_header.type()
-          << ", aborting receipt.";
-      // Send the error to the remote endpoint.
-      SendControlMessage({from_endpoint_id}, payload_header,
-                         payload_chunk.offset(),
-                         PayloadTransferFrame::ControlMessage::PAYLOAD_ERROR);
+  // Decompressed first, since the first chunk of a BYTES payload is its
+  // content.
+  if ((payload_chunk.flags() & PayloadTransferFrame::PayloadChunk::COMPRESSED) !=
+      0) {
+    std::optional<std::string> body = PayloadChunkCompression::Decompress(
+        payload_chunk.body(), PayloadChunkCompression::kMaxDecompressedSize);
+    if (!body.has_value()) {
+      NEARBY_LOGS(ERROR) << "ProcessDataPacket: [data: corrupt] endpoint_id="
+                         << from_endpoint_id
+                         << "; payload_id=" << payload_header.id();
+      HandleFinishedIncomingPayload(
+          to_client, from_endpoint_id, payload_header, payload_chunk.offset(),
+          location::nearby::proto::connections::PayloadStatus::LOCAL_ERROR);
       return;
     }
+    payload_chunk.set_body(*std::move(body));
+  }
 
-    // Also, let the client know of this new incoming payload.
-    RunOnStatusUpdateThread(
-        "process-data-packet",
-        [to_client, from_endpoint_id, pending_payload]()
-            RUN_ON_PAYLOAD_STATUS_UPDATE_THREAD() {
-              NEARBY_LOGS(INFO)
-                  << "PayloadManager received new payload_id="
-                  << pending_payload->GetInternalPayload()->GetId()
-                  << " from endpoint_id=" << from_endpoint_id;
-              to_client->OnPayload(
-                  from_endpoint_id,
-                  pending_payload->GetInternalPayload()->ReleasePayload());
-            });
+  // A relayed payload is delivered as coming from where it was sent from.
+  std::optional<std::string> relay_origin_endpoint_id =
+      GetRelayOrigin(to_client, from_endpoint_id, payload_header);
+  bool is_relayed = relay_origin_endpoint_id.has_value();
+  const std::string& sender_endpoint_id =
+      is_relayed ? *relay_origin_endpoint_id : from_endpoint_id;
+
+  PendingPayload* pending_payload = nullptr;
+  if (payload_chunk.offset() == 0) {
+    // A payload announced with a chunk manifest was already started.
+    pending_payload = GetPayload(payload_header.id());
+    if (pending_payload == nullptr ||
+        pending_payload->GetIncomingChunkManifest() == nullptr) {
+      packet_meta_data.Reset();
+      pending_payload = StartIncomingPayload(to_client, sender_endpoint_id,
+                                             payload_transfer_frame);
+      if (!pending_payload) return;
+    }
   } else {
     pending_payload = GetPayload(payload_header.id());
     if (!pending_payload) {
       NEARBY_LOGS(WARNING) << "ProcessDataPacket: [missing] endpoint_id="
-                           << from_endpoint_id
+                           << sender_endpoint_id
                            << "; payload_id=" << payload_header.id();
       return;
     }
@@ -1105,9 +2180,9 @@ void PayloadManager::ProcessDataPacket(
     // This incoming payload was canceled by the client. Drop this frame and do
     // all the cleanup. See go/nc-cancel-payload
     NEARBY_LOGS(INFO) << "ProcessDataPacket: [cancel] endpoint_id="
-                      << from_endpoint_id
+                      << sender_endpoint_id
                       << "; payload_id=" << pending_payload->GetId();
-    HandleFinishedIncomingPayload(to_client, from_endpoint_id, payload_header,
+    HandleFinishedIncomingPayload(to_client, sender_endpoint_id, payload_header,
                                   payload_chunk.offset(),
                                   location::nearby::proto::connections::
                                       PayloadStatus::LOCAL_CANCELLATION);
@@ -1119,34 +2194,72 @@ void PayloadManager::ProcessDataPacket(
   // back to the client. For the sake of accuracy, we update the pending payload
   // here because it's after all payload terminating events are handled, but
   // right before we actually start attaching the next chunk.
-  pending_payload->SetOffsetForEndpoint(from_endpoint_id,
+  pending_payload->SetOffsetForEndpoint(sender_endpoint_id,
                                         payload_chunk.offset());
 
+  if (is_relayed) {
+    pending_payload->AppendToRelayBody(payload_chunk.body());
+  }
+
   // Save size of packet before we move it.
   std::int64_t payload_body_size = payload_chunk.body().size();
   packet_meta_data.StartFileIo();
+  IncomingChunkManifest* incoming_chunk_manifest =
+      pending_payload->GetIncomingChunkManifest();
+  if (incoming_chunk_manifest != nullptr &&
+      !CopyPresentChunks(*incoming_chunk_manifest,
+                         *pending_payload->GetInternalPayload(),
+                         payload_chunk.offset())) {
+    NEARBY_LOGS(ERROR) << "ProcessDataPacket: [data: missing chunk] endpoint_id="
+                       << sender_endpoint_id
+                       << "; payload_id=" << pending_payload->GetId();
+    HandleFinishedIncomingPayload(
+        to_client, sender_endpoint_id, payload_header, payload_chunk.offset(),
+        location::nearby::proto::connections::PayloadStatus::LOCAL_ERROR);
+    return;
+  }
   if (pending_payload->GetInternalPayload()
           ->AttachNextChunk(ByteArray(std::move(*payload_chunk.mutable_body())))
           .Raised()) {
     NEARBY_LOGS(ERROR) << "ProcessDataPacket: [data: error] endpoint_id="
-                       << from_endpoint_id
+                       << sender_endpoint_id
                        << "; payload_id=" << pending_payload->GetId();
     HandleFinishedIncomingPayload(
-        to_client, from_endpoint_id, payload_header, payload_chunk.offset(),
+        to_client, sender_endpoint_id, payload_header, payload_chunk.offset(),
         location::nearby::proto::connections::PayloadStatus::LOCAL_ERROR);
     return;
   }
   packet_meta_data.StopFileIo();
+  bool is_last_chunk = (payload_chunk.flags() &
+                        PayloadTransferFrame::PayloadChunk::LAST_CHUNK) != 0;
+  if (incoming_chunk_manifest != nullptr) {
+    incoming_chunk_manifest->written_size += payload_body_size;
+    if (is_last_chunk) {
+      file_chunk_store_.AddFile(incoming_chunk_manifest->file_path,
+                                payload_header.total_size(),
+                                incoming_chunk_manifest->manifest,
+                                incoming_chunk_manifest->written_size);
+    }
+  }
 
-  HandleSuccessfulIncomingChunk(to_client, from_endpoint_id, payload_header,
+  // Taken before the pending payload can be destroyed.
+  std::optional<ByteArray> relay_body;
+  if (is_relayed && is_last_chunk) {
+    relay_body = pending_payload->TakeRelayBody();
+  }
+
+  HandleSuccessfulIncomingChunk(to_client, sender_endpoint_id, payload_header,
                                 payload_chunk.flags(), payload_chunk.offset(),
                                 payload_body_size);
+  if (relay_body.has_value() &&
+      relay_body->size() == payload_header.total_size()) {
+    RelayIncomingPayload(to_client, from_endpoint_id, payload_header,
+                         *std::move(relay_body));
+  }
 
   ThroughputRecorderContainer::GetInstance()
       .GetTPRecorder(payload_header.id(), PayloadDirection::INCOMING_PAYLOAD)
       ->OnFrameReceived(medium, packet_meta_data);
-  bool is_last_chunk = (payload_chunk.flags() &
-                        PayloadTransferFrame::PayloadChunk::LAST_CHUNK) != 0;
   if (is_last_chunk) {
     ThroughputRecorderContainer::GetInstance()
         .GetTPRecorder(payload_header.id(), PayloadDirection::INCOMING_PAYLOAD)
@@ -1157,6 +2270,42 @@ void PayloadManager::ProcessDataPacket(
   }
 }
 
+// @EndpointManagerDataPool
+void PayloadManager::ProcessBytesPayloadBatch(
+    ClientProxy* to_client, const std::string& from_endpoint_id,
+    PayloadTransferFrame& payload_transfer_frame, Medium medium,
+    PacketMetaData& packet_meta_data) {
+  NEARBY_LOGS(VERBOSE) << "PayloadManager got "
+                       << payload_transfer_frame.bytes_payloads_size()
+                       << " batched BYTES payloads from endpoint_id="
+                       << from_endpoint_id;
+  // Each payload is taken apart into the data chunk and last chunk it would
+  // have been sent as on its own.
+  for (auto& bytes_payload : *payload_transfer_frame.mutable_bytes_payloads()) {
+    std::int64_t total_size = bytes_payload.payload_header().total_size();
+
+    PayloadTransferFrame data_frame;
+    data_frame.set_packet_type(PayloadTransferFrame::DATA);
+    *data_frame.mutable_payload_header() = bytes_payload.payload_header();
+    data_frame.mutable_payload_chunk()->set_offset(0);
+    data_frame.mutable_payload_chunk()->set_flags(0);
+    *data_frame.mutable_payload_chunk()->mutable_body() =
+        std::move(*bytes_payload.mutable_body());
+    ProcessDataPacket(to_client, from_endpoint_id, data_frame, medium,
+                      packet_meta_data);
+
+    PayloadTransferFrame last_chunk_frame;
+    last_chunk_frame.set_packet_type(PayloadTransferFrame::DATA);
+    *last_chunk_frame.mutable_payload_header() =
+        std::move(*bytes_payload.mutable_payload_header());
+    last_chunk_frame.mutable_payload_chunk()->set_offset(total_size);
+    last_chunk_frame.mutable_payload_chunk()->set_flags(
+        PayloadTransferFrame::PayloadChunk::LAST_CHUNK);
+    ProcessDataPacket(to_client, from_endpoint_id, last_chunk_frame, medium,
+                      packet_meta_data);
+  }
+}
+
 // @EndpointManagerDataPool
 void PayloadManager::ProcessControlPacket(
     ClientProxy* to_client, const std::string& from_endpoint_id,
@@ -1165,6 +2314,30 @@ void PayloadManager::ProcessControlPacket(
       payload_transfer_frame.payload_header();
   const PayloadTransferFrame::ControlMessage& control_message =
       payload_transfer_frame.control_message();
+  // The manifest of an incoming payload arrives before the payload exists.
+  if (control_message.event() ==
+      PayloadTransferFrame::ControlMessage::PAYLOAD_MANIFEST) {
+    ProcessChunkManifest(to_client, from_endpoint_id, payload_transfer_frame);
+    return;
+  }
+  // Payloads are relayed without being tracked as outgoing ones.
+  if (control_message.event() ==
+      PayloadTransferFrame::ControlMessage::PAYLOAD_RELAYED) {
+    ProcessPayloadRelayed(to_client, from_endpoint_id, payload_transfer_frame);
+    return;
+  }
+  if (control_message.event() ==
+          PayloadTransferFrame::ControlMessage::PAYLOAD_ERROR ||
+      control_message.event() ==
+          PayloadTransferFrame::ControlMessage::PAYLOAD_CANCELED) {
+    std::optional<PayloadRelayTracker::ChildResult> result =
+        relay_tracker_.OnForwardingFailed(payload_header.id(),
+                                          from_endpoint_id);
+    if (result.has_value()) {
+      OnRelayChildDone(to_client, *std::move(result));
+      return;
+    }
+  }
   PendingPayload* pending_payload = GetPayload(payload_header.id());
   if (!pending_payload) {
     NEARBY_LOGS(INFO) << "Got ControlMessage for unknown payload_id="
@@ -1191,6 +2364,7 @@ void PayloadManager::ProcessControlPacket(
         // Mark the payload as canceled *for this endpoint*.
         pending_payload->SetEndpointStatusFromControlMessage(from_endpoint_id,
                                                              control_message);
+        NotifyStreamCreditWaiters();
       }
       NEARBY_LOGS(VERBOSE)
           << "Marked "
@@ -1207,6 +2381,19 @@ void PayloadManager::ProcessControlPacket(
       } else {
         pending_payload->SetEndpointStatusFromControlMessage(from_endpoint_id,
                                                              control_message);
+        NotifyStreamCreditWaiters();
+      }
+      break;
+    case PayloadTransferFrame::ControlMessage::PAYLOAD_CREDIT:
+      if (!pending_payload->IsIncoming()) {
+        OnStreamCreditGranted(*pending_payload, from_endpoint_id,
+                              control_message.offset());
+      }
+      break;
+    case PayloadTransferFrame::ControlMessage::PAYLOAD_MANIFEST_REPLY:
+      if (!pending_payload->IsIncoming()) {
+        OnChunkManifestReply(*pending_payload, from_endpoint_id,
+                             control_message);
       }
       break;
     default:
@@ -1217,6 +2404,160 @@ void PayloadManager::ProcessControlPacket(
   }
 }
 
+// @EndpointManagerDataPool
+void PayloadManager::ProcessPayloadRelayed(
+    ClientProxy* to_client, const std::string& from_endpoint_id,
+    const PayloadTransferFrame& payload_transfer_frame) {
+  const PayloadTransferFrame::ControlMessage& control_message =
+      payload_transfer_frame.control_message();
+  std::vector<std::string> failed_endpoint_ids(
+      control_message.failed_endpoint_ids().begin(),
+      control_message.failed_endpoint_ids().end());
+  std::optional<PayloadRelayTracker::ChildResult> result =
+      relay_tracker_.OnChildDone(payload_transfer_frame.payload_header().id(),
+                                 from_endpoint_id, failed_endpoint_ids,
+                                 /*child_failed=*/false);
+  if (!result.has_value()) {
+    NEARBY_LOGS(INFO) << "Got PAYLOAD_RELAYED for unknown payload_id="
+                      << payload_transfer_frame.payload_header().id()
+                      << " from endpoint_id=" << from_endpoint_id;
+    return;
+  }
+  OnRelayChildDone(to_client, *std::move(result));
+}
+
+// @EndpointManagerDataPool
+void PayloadManager::ProcessChunkManifest(
+    ClientProxy* to_client, const std::string& from_endpoint_id,
+    const PayloadTransferFrame& payload_transfer_frame) {
+  const PayloadTransferFrame::PayloadHeader& payload_header =
+      payload_transfer_frame.payload_header();
+  const PayloadTransferFrame::ControlMessage& control_message =
+      payload_transfer_frame.control_message();
+  const FileChunkStore::ChunkManifest& manifest =
+      control_message.chunk_manifest();
+  PendingPayload* pending_payload = GetPayload(payload_header.id());
+  IncomingChunkManifest* incoming_chunk_manifest =
+      pending_payload != nullptr ? pending_payload->GetIncomingChunkManifest()
+                                 : nullptr;
+  // The first manifest starts the payload, the next ones continue where the
+  // ones before ended.
+  std::int64_t offset = control_message.offset();
+  if ((offset == 0) != (pending_payload == nullptr) ||
+      (offset > 0 &&
+       (incoming_chunk_manifest == nullptr ||
+        manifest.chunk_size() !=
+            incoming_chunk_manifest->manifest.chunk_size() ||
+        offset != incoming_chunk_manifest->manifest.chunk_hashes_size() *
+                      manifest.chunk_size()))) {
+    NEARBY_LOGS(INFO) << "Got chunk manifest at unexpected offset " << offset
+                      << " for payload_id=" << payload_header.id()
+                      << ", ignoring.";
+    return;
+  }
+
+  PayloadTransferFrame::ControlMessage reply;
+  reply.set_event(PayloadTransferFrame::ControlMessage::PAYLOAD_MANIFEST_REPLY);
+  reply.set_offset(offset);
+  std::int64_t total_size = payload_header.total_size();
+  std::int64_t chunk_size = manifest.chunk_size();
+  bool valid =
+      NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableFilePayloadChunkDedup) &&
+      payload_header.type() == PayloadTransferFrame::PayloadHeader::FILE &&
+      total_size > offset && chunk_size > 0 &&
+      manifest.chunk_hashes_size() > 0 &&
+      manifest.chunk_hashes_size() <= FileChunkStore::kMaxChunks &&
+      manifest.chunk_hashes_size() <=
+          (total_size - offset + chunk_size - 1) / chunk_size;
+  if (!valid) {
+    // Without any present chunks, the payload is sent as usual.
+    NEARBY_LOGS(WARNING) << "Got unusable chunk manifest for payload_id="
+                         << payload_header.id();
+    endpoint_manager_->SendControlMessage(payload_header, reply,
+                                          {from_endpoint_id});
+    return;
+  }
+
+  if (pending_payload == nullptr) {
+    // Started as if by the first DATA packet, which the payload is made from.
+    PayloadTransferFrame first_chunk_frame;
+    first_chunk_frame.set_packet_type(PayloadTransferFrame::DATA);
+    *first_chunk_frame.mutable_payload_header() = payload_header;
+    first_chunk_frame.mutable_payload_chunk()->set_offset(0);
+    first_chunk_frame.mutable_payload_chunk()->set_flags(0);
+    pending_payload =
+        StartIncomingPayload(to_client, from_endpoint_id, first_chunk_frame);
+    if (!pending_payload) return;
+    auto new_incoming_chunk_manifest =
+        std::make_unique<IncomingChunkManifest>();
+    new_incoming_chunk_manifest->manifest.set_chunk_size(chunk_size);
+    new_incoming_chunk_manifest->file_path =
+        pending_payload->GetInternalPayload()->GetFilePath();
+    incoming_chunk_manifest = new_incoming_chunk_manifest.get();
+    pending_payload->SetIncomingChunkManifest(
+        std::move(new_incoming_chunk_manifest));
+  }
+
+  // Only looked up here; CopyPresentChunks() checks them once it gets there.
+  std::vector<bool> present(manifest.chunk_hashes_size(), false);
+  for (int i = 0; i < manifest.chunk_hashes_size(); ++i) {
+    std::optional<FileChunkStore::Location> location =
+        file_chunk_store_.Find(manifest.chunk_hashes(i));
+    incoming_chunk_manifest->manifest.add_chunk_hashes(
+        manifest.chunk_hashes(i));
+    // The file being received can't be a source of its own chunks.
+    if (location.has_value() &&
+        location->file_path == incoming_chunk_manifest->file_path) {
+      location.reset();
+    }
+    present[i] = location.has_value();
+    incoming_chunk_manifest->present_chunks.push_back(std::move(location));
+  }
+  NEARBY_LOGS(INFO) << "Have "
+                    << std::count(present.begin(), present.end(), true)
+                    << " of " << present.size() << " chunks of payload_id="
+                    << payload_header.id() << " from offset " << offset;
+
+  reply.set_present_chunks(FileChunkStore::EncodePresentChunks(present));
+  endpoint_manager_->SendControlMessage(payload_header, reply,
+                                        {from_endpoint_id});
+}
+
+bool PayloadManager::CopyPresentChunks(
+    IncomingChunkManifest& incoming_chunk_manifest,
+    InternalPayload& internal_payload, std::int64_t offset) {
+  const std::int64_t total_size = internal_payload.GetTotalSize();
+  const std::int64_t chunk_size = incoming_chunk_manifest.manifest.chunk_size();
+  std::int64_t written_size = incoming_chunk_manifest.written_size;
+  while (written_size < offset) {
+    std::int64_t index = written_size / chunk_size;
+    if (written_size % chunk_size != 0 ||
+        index >= static_cast<std::int64_t>(
+                     incoming_chunk_manifest.present_chunks.size()) ||
+        !incoming_chunk_manifest.present_chunks[index].has_value()) {
+      return false;
+    }
+    std::int64_t size = std::min(chunk_size, total_size - written_size);
+    const std::string& hash =
+        incoming_chunk_manifest.manifest.chunk_hashes(index);
+    std::optional<ByteArray> chunk = FileChunkStore::ReadChunk(
+        *incoming_chunk_manifest.present_chunks[index], size, hash);
+    if (!chunk.has_value()) {
+      // Not offered again, so that the payload can be sent again in full.
+      NEARBY_LOGS(WARNING) << "Chunk at offset " << written_size
+                           << " changed since it was received.";
+      file_chunk_store_.Remove(hash);
+      return false;
+    }
+    if (internal_payload.AttachNextChunk(*chunk).Raised()) return false;
+    written_size += size;
+    incoming_chunk_manifest.written_size = written_size;
+  }
+  return written_size == offset;
+}
+
 // @PayloadManagerStatusUpdateThread
 void PayloadManager::NotifyClientOfIncomingPayloadProgressInfo(
     ClientProxy* client, const std::string& endpoint_id,
@@ -1254,6 +2595,8 @@ PayloadType PayloadManager::FramePayloadTypeToPayloadType(
       return connections::PayloadType::kBytes;
     case PayloadTransferFrame::PayloadHeader::FILE:
       return connections::PayloadType::kFile;
+    case PayloadTransferFrame::PayloadHeader::FILE_BATCH:
+      return connections::PayloadType::kFileBatch;
     case PayloadTransferFrame::PayloadHeader::STREAM:
       return connections::PayloadType::kStream;
     default:
@@ -1266,6 +2609,36 @@ void PayloadManager::SetCustomSavePath(ClientProxy* client,
   custom_save_path_ = path;
 }
 
+//////////////////////////////// SkippedChunks ////////////////////////////////
+
+std::int64_t PayloadManager::SkippedChunks::SkippedBytesAt(
+    std::int64_t offset, std::int64_t total_size) const {
+  std::int64_t end = offset;
+  while (end < total_size && end % chunk_size == 0) {
+    std::int64_t index = end / chunk_size;
+    if (index >= static_cast<std::int64_t>(chunks.size()) || !chunks[index]) {
+      break;
+    }
+    end = std::min(end + chunk_size, total_size);
+  }
+  return end - offset;
+}
+
+std::int64_t PayloadManager::SkippedChunks::SentBytesAt(
+    std::int64_t offset, std::int64_t total_size) const {
+  std::int64_t index = offset / chunk_size + 1;
+  while (index < static_cast<std::int64_t>(chunks.size()) && !chunks[index]) {
+    ++index;
+  }
+  return std::min(index * chunk_size, total_size) - offset;
+}
+
+std::int64_t PayloadManager::SkippedChunks::CoveredBytes(
+    std::int64_t total_size) const {
+  return std::min(static_cast<std::int64_t>(chunks.size()) * chunk_size,
+                  total_size);
+}
+
 ///////////////////////////////// EndpointInfo /////////////////////////////////
 
 PayloadManager::EndpointInfo::Status
@@ -1303,10 +2676,19 @@ PayloadManager::PendingPayload::PendingPayload(
   // Later on some may become canceled, some may experience data transfer
   // failures. Any of these situations will cause endpoint to be marked as
   // unavailable.
+  absl::Duration progress_min_interval = absl::Milliseconds(
+      NearbyFlags::GetInstance().GetInt64Flag(
+          config_package_nearby::nearby_connections_feature::
+              kPayloadProgressMinIntervalMillis));
+  std::int64_t progress_min_bytes = NearbyFlags::GetInstance().GetInt64Flag(
+      config_package_nearby::nearby_connections_feature::
+          kPayloadProgressMinBytes);
   for (const auto& id : endpoint_ids) {
-    EndpointInfo endpoint_info{};
-    endpoint_info.id = id;
-    endpoint_info.status.Set(EndpointInfo::Status::kAvailable);
+    auto endpoint_info = std::make_unique<EndpointInfo>();
+    endpoint_info->id = id;
+    endpoint_info->status.Set(EndpointInfo::Status::kAvailable);
+    endpoint_info->progress_throttle =
+        PayloadProgressThrottle(progress_min_interval, progress_min_bytes);
 
     endpoints_.emplace(id, std::move(endpoint_info));
   }
@@ -1326,60 +2708,54 @@ bool PayloadManager::PendingPayload::IsLocallyCanceled() const {
 
 void PayloadManager::PendingPayload::MarkLocallyCanceled() {
   is_locally_canceled_.Set(true);
+  cancellation_flag_.Cancel();
 }
 
 bool PayloadManager::PendingPayload::IsIncoming() const { return is_incoming_; }
 
 std::vector<const PayloadManager::EndpointInfo*>
 PayloadManager::PendingPayload::GetEndpoints() const {
-  MutexLock lock(&mutex_);
-
   std::vector<const EndpointInfo*> result;
   for (const auto& item : endpoints_) {
-    result.push_back(&item.second);
+    if (!item.second->removed) {
+      result.push_back(item.second.get());
+    }
   }
   return result;
 }
 
 PayloadManager::EndpointInfo* PayloadManager::PendingPayload::GetEndpoint(
     const std::string& endpoint_id) {
-  MutexLock lock(&mutex_);
-
   auto it = endpoints_.find(endpoint_id);
-  if (it == endpoints_.end()) {
+  if (it == endpoints_.end() || it->second->removed) {
     return {};
   }
 
-  return &it->second;
+  return it->second.get();
 }
 
 void PayloadManager::PendingPayload::RemoveEndpoints(
     const EndpointIds& endpoint_ids) {
-  MutexLock lock(&mutex_);
-
   for (const auto& id : endpoint_ids) {
-    endpoints_.erase(id);
+    auto item = endpoints_.find(id);
+    if (item != endpoints_.end()) {
+      item->second->removed = true;
+    }
   }
 }
 
 void PayloadManager::PendingPayload::SetEndpointStatusFromControlMessage(
     const std::string& endpoint_id,
     const PayloadTransferFrame::ControlMessage& control_message) {
-  MutexLock lock(&mutex_);
-
-  auto item = endpoints_.find(endpoint_id);
-  if (item != endpoints_.end()) {
-    item->second.SetStatusFromControlMessage(control_message);
+  if (EndpointInfo* endpoint_info = GetEndpoint(endpoint_id)) {
+    endpoint_info->SetStatusFromControlMessage(control_message);
   }
 }
 
 void PayloadManager::PendingPayload::SetOffsetForEndpoint(
     const std::string& endpoint_id, std::int64_t offset) {
-  MutexLock lock(&mutex_);
-
-  auto item = endpoints_.find(endpoint_id);
-  if (item != endpoints_.end()) {
-    item->second.offset = offset;
+  if (EndpointInfo* endpoint_info = GetEndpoint(endpoint_id)) {
+    endpoint_info->offset = offset;
   }
 }
 
@@ -1405,46 +2781,56 @@ void PayloadManager::RunOnStatusUpdateThread(const std::string& name,
 
 void PayloadManager::PendingPayloads::StartTrackingPayload(
     Payload::Id payload_id, std::unique_ptr<PendingPayload> pending_payload) {
-  MutexLock lock(&mutex_);
+  Shard& shard = GetShard(payload_id);
+  MutexLock lock(&shard.mutex);
 
   // If the |payload_id| is being re-used, always prefer the newer payload.
-  auto it = pending_payloads_.find(payload_id);
-  if (it != pending_payloads_.end()) {
-    pending_payloads_.erase(payload_id);
+  auto it = shard.pending_payloads.find(payload_id);
+  if (it != shard.pending_payloads.end()) {
+    shard.pending_payloads.erase(payload_id);
   }
-  auto pair = pending_payloads_.emplace(payload_id, std::move(pending_payload));
+  auto pair =
+      shard.pending_payloads.emplace(payload_id, std::move(pending_payload));
   NEARBY_LOGS(INFO) << "StartTrackingPayload: payload_id=" << payload_id
                     << "; inserted=" << pair.second;
 }
 
 std::unique_ptr<PayloadManager::PendingPayload>
 PayloadManager::PendingPayloads::StopTrackingPayload(Payload::Id payload_id) {
-  MutexLock lock(&mutex_);
+  Shard& shard = GetShard(payload_id);
+  MutexLock lock(&shard.mutex);
 
-  auto it = pending_payloads_.find(payload_id);
-  if (it == pending_payloads_.end()) return {};
+  auto it = shard.pending_payloads.find(payload_id);
+  if (it == shard.pending_payloads.end()) return {};
 
-  auto item = pending_payloads_.extract(it);
+  auto item = shard.pending_payloads.extract(it);
   return std::move(item.mapped());
 }
 
 PayloadManager::PendingPayload* PayloadManager::PendingPayloads::GetPayload(
     Payload::Id payload_id) const {
-  MutexLock lock(&mutex_);
+  Shard& shard = GetShard(payload_id);
+  MutexLock lock(&shard.mutex);
 
-  auto item = pending_payloads_.find(payload_id);
-  return item != pending_payloads_.end() ? item->second.get() : nullptr;
+  auto item = shard.pending_payloads.find(payload_id);
+  return item != shard.pending_payloads.end() ? item->second.get() : nullptr;
 }
 
 std::vector<Payload::Id> PayloadManager::PendingPayloads::GetAllPayloads() {
-  MutexLock lock(&mutex_);
-
   std::vector<Payload::Id> result;
-  for (const auto& item : pending_payloads_) {
-    result.push_back(item.first);
+  for (Shard& shard : shards_) {
+    MutexLock lock(&shard.mutex);
+    for (const auto& item : shard.pending_payloads) {
+      result.push_back(item.first);
+    }
   }
   return result;
 }
 
+PayloadManager::PendingPayloads::Shard&
+PayloadManager::PendingPayloads::GetShard(Payload::Id payload_id) const {
+  return shards_[static_cast<std::uint64_t>(payload_id) % kShardCount];
+}
+
 }  // namespace connections
 }  // namespace nearby
@@ -15,26 +15,41 @@
 #ifndef CORE_INTERNAL_PAYLOAD_MANAGER_H_
 #define CORE_INTERNAL_PAYLOAD_MANAGER_H_
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "connections/implementation/adaptive_chunk_sizer.h"
 #include "connections/implementation/analytics/packet_meta_data.h"
 #include "connections/implementation/client_proxy.h"
 #include "connections/implementation/endpoint_manager.h"
+#include "connections/implementation/file_chunk_store.h"
 #include "connections/implementation/internal_payload.h"
+#include "connections/implementation/payload_chunk_prefetcher.h"
+#include "connections/implementation/payload_progress_throttle.h"
+#include "connections/implementation/payload_relay.h"
+#include "connections/implementation/payload_send_scheduler.h"
+#include "connections/implementation/round_robin_executor.h"
 #include "connections/listeners.h"
 #include "connections/payload.h"
 #include "connections/status.h"
 #include "internal/platform/atomic_boolean.h"
 #include "internal/platform/atomic_reference.h"
+#include "internal/platform/cancellation_flag.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/condition_variable.h"
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/mutex.h"
+#include "internal/platform/scheduled_executor.h"
 
 namespace nearby {
 namespace connections {
@@ -50,6 +65,43 @@ class PayloadManager : public EndpointManager::FrameProcessor {
   using EndpointIds = std::vector<std::string>;
   constexpr static const absl::Duration kWaitCloseTimeout =
       absl::Milliseconds(5000);
+  // Limits for packing outgoing BYTES payloads into a single frame, see
+  // kEnableBytesPayloadBatching.
+  constexpr static const std::int64_t kMaxBatchedBytesPayloadSize = 1024;
+  constexpr static const std::int64_t kMaxBytesPayloadBatchSize = 32 * 1024;
+  constexpr static const int kMaxBytesPayloadBatchCount = 64;
+  // How long an outgoing STREAM payload out of credit waits for more before
+  // its send loop checks again whether it was canceled.
+  constexpr static const absl::Duration kStreamCreditWaitTimeout =
+      absl::Seconds(1);
+  // How long the sender of a FILE payload waits for the answer to its chunk
+  // manifest before it sends all chunks instead.
+  constexpr static const absl::Duration kChunkManifestReplyTimeout =
+      absl::Seconds(10);
+  // The fewest threads FILE and STREAM payloads are each sent on when fair
+  // payload scheduling is enabled, so that more than one can take turns.
+  constexpr static const int kFairSchedulingPayloadThreads = 4;
+
+  // The chunks of an outgoing FILE payload that are left out because its
+  // receiver already has them, see kEnableFilePayloadChunkDedup.
+  struct SkippedChunks {
+    // Returns how many bytes from |offset| on are left out.
+    std::int64_t SkippedBytesAt(std::int64_t offset,
+                                std::int64_t total_size) const;
+    // Returns how many bytes from |offset| on are sent before the next chunk
+    // that is left out, or the end of the chunks covered so far.
+    std::int64_t SentBytesAt(std::int64_t offset,
+                             std::int64_t total_size) const;
+    // Returns how many bytes the manifests answered so far cover.
+    std::int64_t CoveredBytes(std::int64_t total_size) const;
+
+    std::int64_t chunk_size = 0;
+    // One per chunk covered by the manifests answered so far, set if the
+    // chunk is left out.
+    std::vector<bool> chunks;
+    // Cleared once a manifest goes unanswered, or can't be sent.
+    bool sends_manifests = true;
+  };
 
   explicit PayloadManager(EndpointManager& endpoint_manager);
   ~PayloadManager() override;
@@ -93,7 +145,32 @@ class PayloadManager : public EndpointManager::FrameProcessor {
 
     std::string id;
     AtomicReference<Status> status{Status::kUnknown};
-    std::int64_t offset = 0;
+    // Updated for every chunk, so kept lock-free.
+    std::atomic<std::int64_t> offset{0};
+    // Set by PendingPayload::RemoveEndpoints() in place of erasing the entry.
+    std::atomic<bool> removed{false};
+    // For outgoing STREAM payloads, the offset up to which the endpoint has
+    // granted credit with PAYLOAD_CREDIT, or -1 if it never did.
+    std::atomic<std::int64_t> credit_limit{-1};
+    // For outgoing FILE payloads sent with a chunk manifest, the
+    // present_chunks of the endpoint's PAYLOAD_MANIFEST_REPLY once it arrived.
+    // Guarded by PayloadManager::credit_mutex_.
+    std::optional<std::string> present_chunks;
+    // Only used on the status update thread.
+    PayloadProgressThrottle progress_throttle;
+  };
+
+  // An incoming FILE payload announced with a chunk manifest. The chunks the
+  // receiver already had are copied into the file in between the received
+  // ones.
+  struct IncomingChunkManifest {
+    // The chunk manifests received so far, joined.
+    FileChunkStore::ChunkManifest manifest;
+    // Where each chunk that isn't sent is copied from.
+    std::vector<std::optional<FileChunkStore::Location>> present_chunks;
+    std::string file_path;
+    // Bytes of the file written so far, received or copied.
+    std::atomic<std::int64_t> written_size{0};
   };
 
   // Tracks state for an InternalPayload and the endpoints associated with it.
@@ -112,30 +189,58 @@ class PayloadManager : public EndpointManager::FrameProcessor {
 
     bool IsLocallyCanceled() const;
     void MarkLocallyCanceled();
+    // Cancelled along with MarkLocallyCanceled(), for listeners that unblock
+    // work on the payload that would otherwise only notice much later.
+    CancellationFlag* GetCancellationFlag() { return &cancellation_flag_; }
     bool IsIncoming() const;
 
     // Gets the EndpointInfo objects for the endpoints (still) associated with
     // this payload.
-    std::vector<const EndpointInfo*> GetEndpoints() const
-        ABSL_LOCKS_EXCLUDED(mutex_);
+    std::vector<const EndpointInfo*> GetEndpoints() const;
     // Returns the EndpointInfo for a given endpoint ID. Returns null if the
     // endpoint is not associated with this payload.
-    EndpointInfo* GetEndpoint(const std::string& endpoint_id)
-        ABSL_LOCKS_EXCLUDED(mutex_);
+    EndpointInfo* GetEndpoint(const std::string& endpoint_id);
 
     // Removes the given endpoints, e.g. on error.
-    void RemoveEndpoints(const EndpointIds& endpoint_ids_to_remove)
-        ABSL_LOCKS_EXCLUDED(mutex_);
+    void RemoveEndpoints(const EndpointIds& endpoint_ids_to_remove);
 
     // Sets the status for a particular endpoint.
     void SetEndpointStatusFromControlMessage(
         const std::string& endpoint_id,
-        const PayloadTransferFrame::ControlMessage& control_message)
-        ABSL_LOCKS_EXCLUDED(mutex_);
+        const PayloadTransferFrame::ControlMessage& control_message);
 
     // Sets the offset for a particular endpoint.
     void SetOffsetForEndpoint(const std::string& endpoint_id,
-                              std::int64_t offset) ABSL_LOCKS_EXCLUDED(mutex_);
+                              std::int64_t offset);
+
+    // Only used by the thread sending an outgoing payload, before and while
+    // it does.
+    SkippedChunks* GetSkippedChunks() {
+      return skipped_chunks_.has_value() ? &*skipped_chunks_ : nullptr;
+    }
+    void SetSkippedChunks(SkippedChunks skipped_chunks) {
+      skipped_chunks_ = std::move(skipped_chunks);
+    }
+
+    // Set for an incoming payload before its first chunk arrives.
+    IncomingChunkManifest* GetIncomingChunkManifest() {
+      return incoming_chunk_manifest_.get();
+    }
+    void SetIncomingChunkManifest(
+        std::unique_ptr<IncomingChunkManifest> incoming_chunk_manifest) {
+      incoming_chunk_manifest_ = std::move(incoming_chunk_manifest);
+    }
+
+    // The content of an incoming BYTES payload that is relayed further,
+    // collected until its last chunk arrives.
+    void AppendToRelayBody(absl::string_view chunk) {
+      relay_body_.append(chunk.data(), chunk.size());
+    }
+    ByteArray TakeRelayBody() {
+      ByteArray relay_body(std::move(relay_body_));
+      relay_body_.clear();
+      return relay_body;
+    }
 
     // Closes internal_payload_ and triggers close_event_.
     // Close is called when a pending peyload does not have associated
@@ -148,13 +253,17 @@ class PayloadManager : public EndpointManager::FrameProcessor {
     bool IsClosed();
 
    private:
-    mutable Mutex mutex_;
     bool is_incoming_;
     AtomicBoolean is_locally_canceled_{false};
+    CancellationFlag cancellation_flag_;
     CountDownLatch close_event_{1};
     std::unique_ptr<InternalPayload> internal_payload_;
-    absl::flat_hash_map<std::string, EndpointInfo> endpoints_
-        ABSL_GUARDED_BY(mutex_);
+    // Filled in by the constructor and never modified afterwards, so it can be
+    // read without a lock; removed endpoints are only flagged as such.
+    absl::flat_hash_map<std::string, std::unique_ptr<EndpointInfo>> endpoints_;
+    std::optional<SkippedChunks> skipped_chunks_;
+    std::unique_ptr<IncomingChunkManifest> incoming_chunk_manifest_;
+    std::string relay_body_;
   };
 
   // Tracks and manages PendingPayload objects in a synchronized manner.
@@ -164,18 +273,39 @@ class PayloadManager : public EndpointManager::FrameProcessor {
     ~PendingPayloads() = default;
 
     void StartTrackingPayload(Payload::Id payload_id,
-                              std::unique_ptr<PendingPayload> pending_payload)
-        ABSL_LOCKS_EXCLUDED(mutex_);
-    std::unique_ptr<PendingPayload> StopTrackingPayload(Payload::Id payload_id)
-        ABSL_LOCKS_EXCLUDED(mutex_);
-    PendingPayload* GetPayload(Payload::Id payload_id) const
-        ABSL_LOCKS_EXCLUDED(mutex_);
-    std::vector<Payload::Id> GetAllPayloads() ABSL_LOCKS_EXCLUDED(mutex_);
+                              std::unique_ptr<PendingPayload> pending_payload);
+    std::unique_ptr<PendingPayload> StopTrackingPayload(Payload::Id payload_id);
+    PendingPayload* GetPayload(Payload::Id payload_id) const;
+    std::vector<Payload::Id> GetAllPayloads();
 
    private:
-    mutable Mutex mutex_;
-    absl::flat_hash_map<Payload::Id, std::unique_ptr<PendingPayload>>
-        pending_payloads_ ABSL_GUARDED_BY(mutex_);
+    // Payloads are spread over shards by ID, so that lookups for different
+    // payloads rarely wait on the same lock.
+    static constexpr int kShardCount = 16;
+
+    struct Shard {
+      mutable Mutex mutex{"PendingPayloads::mutex"};
+      absl::flat_hash_map<Payload::Id, std::unique_ptr<PendingPayload>>
+          pending_payloads ABSL_GUARDED_BY(mutex);
+    };
+
+    Shard& GetShard(Payload::Id payload_id) const;
+
+    mutable std::array<Shard, kShardCount> shards_;
+  };
+
+  // Small outgoing BYTES payloads waiting to be sent together in a single
+  // frame. All of them go to the same endpoints of the same client.
+  struct BytesPayloadBatch {
+    struct Entry {
+      Payload::Id payload_id;
+      std::int64_t total_size;
+    };
+
+    ClientProxy* client = nullptr;
+    EndpointIds endpoint_ids;
+    std::vector<Entry> entries;
+    std::int64_t total_size = 0;
   };
 
   using Endpoints = std::vector<const EndpointInfo*>;
@@ -194,9 +324,122 @@ class PayloadManager : public EndpointManager::FrameProcessor {
   // Returns list of endpoint ids.
   static EndpointIds EndpointsToEndpointIds(const Endpoints& endpoints);
 
+  // Sends the next chunk of |pending_payload|. If |prefetcher| is not null,
+  // chunks are taken from it instead of being read from the payload inline.
+  // |send_weight| is the client's weight in the send scheduler.
   bool SendPayloadLoop(ClientProxy* client, PendingPayload& pending_payload,
                        PayloadTransferFrame::PayloadHeader& payload_header,
-                       std::int64_t& next_chunk_offset, size_t resume_offset);
+                       std::int64_t& next_chunk_offset, size_t resume_offset,
+                       PayloadChunkPrefetcher* prefetcher, int send_weight);
+  // Sends a tracked outgoing payload from start to finish. Runs on the
+  // payload's outgoing executor.
+  void SendPendingPayload(ClientProxy* client, const EndpointIds& endpoint_ids,
+                          Payload::Id payload_id, PayloadType payload_type,
+                          size_t resume_offset,
+                          std::int64_t payload_total_size);
+
+  // Returns whether a BYTES payload's data chunk may carry the LAST_CHUNK flag
+  // when sent to |endpoint_ids|.
+  bool CanSendSingleFrameBytesPayload(ClientProxy* client,
+                                      const EndpointIds& endpoint_ids);
+  // Returns whether the data chunks of a payload of |payload_type| may be
+  // compressed when sent to |endpoint_ids|.
+  bool CanCompressPayloadChunks(
+      ClientProxy* client, const EndpointIds& endpoint_ids,
+      PayloadTransferFrame::PayloadHeader::PayloadType payload_type);
+  // Returns whether an outgoing FILE payload may be announced to
+  // |endpoint_ids| with a chunk manifest.
+  bool CanSendChunkManifest(ClientProxy* client,
+                            const EndpointIds& endpoint_ids);
+  // Sends the manifest of the chunks of an outgoing FILE payload from
+  // |offset| on to |endpoint_id|, and waits up to kChunkManifestReplyTimeout
+  // for the ones it already has, which are then left out.
+  void SendChunkManifest(PendingPayload& pending_payload,
+                         const PayloadTransferFrame::PayloadHeader& header,
+                         const std::string& endpoint_id, std::int64_t offset)
+      ABSL_LOCKS_EXCLUDED(credit_mutex_);
+  void OnChunkManifestReply(
+      PendingPayload& pending_payload, const std::string& endpoint_id,
+      const PayloadTransferFrame::ControlMessage& control_message)
+      ABSL_LOCKS_EXCLUDED(credit_mutex_);
+  // Starts receiving the FILE payload of a first PAYLOAD_MANIFEST, and answers
+  // each with the chunks found in |file_chunk_store_|. Those are only read once
+  // CopyPresentChunks() gets to them.
+  void ProcessChunkManifest(ClientProxy* to_client,
+                            const std::string& from_endpoint_id,
+                            const PayloadTransferFrame& payload_transfer_frame);
+  // Copies the chunks of an incoming payload that weren't sent, up to
+  // |offset|, if they still match their hash. Returns false if one of them
+  // doesn't anymore, or |offset| isn't where the payload continues.
+  bool CopyPresentChunks(IncomingChunkManifest& incoming_chunk_manifest,
+                         InternalPayload& internal_payload,
+                         std::int64_t offset);
+  // Returns whether an outgoing BYTES payload of |total_size| may wait in
+  // |bytes_batch_| to be sent together with others.
+  bool CanBatchBytesPayload(ClientProxy* client,
+                            const EndpointIds& endpoint_ids,
+                            std::int64_t total_size, size_t resume_offset);
+  // Adds a payload to |bytes_batch_|, first flushing a batch that is bound for
+  // other endpoints, and flushes the batch once it is full.
+  void AddToBytesPayloadBatch(ClientProxy* client,
+                              const EndpointIds& endpoint_ids,
+                              Payload::Id payload_id, std::int64_t total_size)
+      ABSL_LOCKS_EXCLUDED(bytes_batch_mutex_);
+  // Hands |bytes_batch_|, if not empty, to the BYTES executor, behind any
+  // payload queued before it.
+  void FlushBytesPayloadBatchLocked()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(bytes_batch_mutex_);
+  // Flushes |bytes_batch_| unless it was already flushed since |generation|.
+  void FlushBytesPayloadBatch(std::int64_t generation)
+      ABSL_LOCKS_EXCLUDED(bytes_batch_mutex_);
+  // Sends the payloads of a flushed batch, in order. Payloads that can no
+  // longer go out as part of a batch, e.g. because they were canceled in the
+  // meantime, are sent on their own. Runs on the BYTES executor.
+  void SendBytesPayloadBatch(BytesPayloadBatch batch);
+  void WriteBytesPayloadBatch(ClientProxy* client,
+                              const EndpointIds& endpoint_ids,
+                              const std::vector<PendingPayload*>& payloads);
+  // Returns whether an outgoing BYTES payload of |total_size| should be sent
+  // to a few of |endpoint_ids| and relayed by them to the rest.
+  bool CanRelayPayload(ClientProxy* client, const EndpointIds& endpoint_ids,
+                       std::int64_t total_size, size_t resume_offset);
+  // Returns the endpoint an incoming payload with relay_nodes was sent from, if
+  // the local endpoint should take it as relayed by |from_endpoint_id|: it is
+  // right below |from_endpoint_id| in the relay tree, is connected to the
+  // origin, and has no more children than it would give itself. Otherwise the
+  // payload is neither forwarded nor delivered as coming from the origin.
+  std::optional<std::string> GetRelayOrigin(
+      ClientProxy* client, const std::string& from_endpoint_id,
+      const PayloadTransferFrame::PayloadHeader& payload_header);
+  // Forwards an incoming BYTES payload to the children of the local endpoint
+  // in the relay tree of |payload_header|.
+  void RelayIncomingPayload(
+      ClientProxy* client, const std::string& from_endpoint_id,
+      const PayloadTransferFrame::PayloadHeader& payload_header,
+      ByteArray body);
+  // Writes a whole BYTES payload to |endpoint_ids| as a data chunk and its last
+  // chunk, without tracking it as a pending payload. Returns the endpoints it
+  // couldn't be written to. Runs on the BYTES executor.
+  std::vector<std::string> WriteRelayPayload(
+      ClientProxy* client,
+      const PayloadTransferFrame::PayloadHeader& payload_header,
+      const ByteArray& body, const EndpointIds& endpoint_ids);
+  // Reports the endpoints below a child of the local endpoint that got a
+  // relayed payload, or didn't; where the payload was sent from, those that
+  // didn't are sent it directly instead.
+  void OnRelayChildDone(ClientProxy* client,
+                        PayloadRelayTracker::ChildResult result);
+  // Handles the PAYLOAD_RELAYED answer of a child of the local endpoint.
+  void ProcessPayloadRelayed(
+      ClientProxy* to_client, const std::string& from_endpoint_id,
+      const PayloadTransferFrame& payload_transfer_frame);
+
+  void ProcessBytesPayloadBatch(ClientProxy* to_client,
+                                const std::string& from_endpoint_id,
+                                PayloadTransferFrame& payload_transfer_frame,
+                                Medium medium,
+                                analytics::PacketMetaData& packet_meta_data);
+
   void SendClientCallbacksForFinishedIncomingPayloadRunnable(
       ClientProxy* client, const std::string& endpoint_id,
       const PayloadTransferFrame::PayloadHeader& payload_header,
@@ -217,7 +460,32 @@ class PayloadManager : public EndpointManager::FrameProcessor {
   static PayloadProgressInfo::Status PayloadStatusToTransferUpdateStatus(
       location::nearby::proto::connections::PayloadStatus status);
 
-  int GetOptimalChunkSize(EndpointIds endpoint_ids);
+  int GetOptimalChunkSize(EndpointIds endpoint_ids)
+      ABSL_LOCKS_EXCLUDED(chunk_sizers_mutex_);
+  // Returns how many more bytes of an outgoing STREAM payload may be sent to
+  // all of |endpoint_ids| from |offset|, as far as their PAYLOAD_CREDIT allows.
+  // Waits up to kStreamCreditWaitTimeout if any of them is out of credit, and
+  // returns 0 if it still is.
+  std::int64_t WaitForStreamCredit(PendingPayload& pending_payload,
+                                   const EndpointIds& endpoint_ids,
+                                   std::int64_t offset)
+      ABSL_LOCKS_EXCLUDED(credit_mutex_);
+  void OnStreamCreditGranted(PendingPayload& pending_payload,
+                             const std::string& endpoint_id,
+                             std::int64_t credit_limit)
+      ABSL_LOCKS_EXCLUDED(credit_mutex_);
+  // Wakes up the send loops waiting in WaitForStreamCredit().
+  void NotifyStreamCreditWaiters() ABSL_LOCKS_EXCLUDED(credit_mutex_);
+  // Feeds the time it took to write a chunk to |endpoint_ids| back into their
+  // adaptive chunk sizes.
+  void RecordChunkWriteTime(const EndpointIds& endpoint_ids, int chunk_size,
+                            absl::Duration write_time)
+      ABSL_LOCKS_EXCLUDED(chunk_sizers_mutex_);
+  // The scheduler channel that chunks sent to |endpoint_ids| are written to.
+  // Each client sending to it is a flow of its own.
+  static std::string GetSendChannelId(const EndpointIds& endpoint_ids);
+  // The weight of |client|'s flows, looked up once per payload.
+  int GetSendWeight(ClientProxy* client) const;
 
   PayloadTransferFrame::PayloadHeader CreatePayloadHeader(
       const InternalPayload& internal_payload, size_t offset,
@@ -226,7 +494,15 @@ class PayloadManager : public EndpointManager::FrameProcessor {
   PayloadTransferFrame::PayloadChunk CreatePayloadChunk(std::int64_t offset,
                                                         ByteArray body);
 
-  PendingPayload* CreateIncomingPayload(const PayloadTransferFrame& frame,
+  // Creates the PendingPayload for the first frame of an incoming payload,
+  // records its start and hands it to the client. Returns nullptr, after
+  // telling the sender, if the payload can't be created.
+  PendingPayload* StartIncomingPayload(ClientProxy* to_client,
+                                       const std::string& from_endpoint_id,
+                                       const PayloadTransferFrame& frame);
+
+  PendingPayload* CreateIncomingPayload(ClientProxy* client,
+                                        const PayloadTransferFrame& frame,
                                         const std::string& endpoint_id)
       ABSL_LOCKS_EXCLUDED(mutex_);
 
@@ -290,7 +566,10 @@ class PayloadManager : public EndpointManager::FrameProcessor {
       const PayloadProgressInfo& payload_transfer_update)
       RUN_ON_PAYLOAD_STATUS_UPDATE_THREAD();
 
-  SingleThreadExecutor* GetOutgoingPayloadExecutor(PayloadType payload_type);
+  SubmittableExecutor* GetOutgoingPayloadExecutor(PayloadType payload_type);
+  // Returns the pool that sends payloads of |payload_type| several at a time,
+  // or null if they are sent one at a time.
+  RoundRobinExecutor* GetOutgoingPayloadPool(PayloadType payload_type);
 
   void RunOnStatusUpdateThread(const std::string& name,
                                std::function<void()> runnable);
@@ -323,10 +602,22 @@ class PayloadManager : public EndpointManager::FrameProcessor {
   std::unique_ptr<CountDownLatch> shutdown_barrier_;
   int send_payload_count_ = 0;
   PendingPayloads pending_payloads_ ABSL_GUARDED_BY(mutex_);
-  SingleThreadExecutor bytes_payload_executor_;
-  SingleThreadExecutor file_payload_executor_;
-  SingleThreadExecutor stream_payload_executor_;
-  SingleThreadExecutor payload_status_update_executor_;
+  SingleThreadExecutor bytes_payload_executor_{api::ExecutorQos::kUserInitiated};
+  SingleThreadExecutor file_payload_executor_{api::ExecutorQos::kUserInitiated};
+  SingleThreadExecutor stream_payload_executor_{
+      api::ExecutorQos::kUserInitiated};
+  // Used instead of the file and stream executors above when more than one
+  // outgoing payload of these types may be sent at a time. Keyed by the send
+  // channel, so that the payloads queued for one endpoint don't hold up those
+  // for the others.
+  std::unique_ptr<RoundRobinExecutor> file_payload_pool_;
+  std::unique_ptr<RoundRobinExecutor> stream_payload_pool_;
+  // Sends the PAYLOAD_CREDIT granted as the client reads incoming STREAM
+  // payloads, in the order they are granted.
+  SingleThreadExecutor stream_credit_executor_{
+      api::ExecutorQos::kUserInitiated};
+  SingleThreadExecutor payload_status_update_executor_{
+      api::ExecutorQos::kUserInitiated};
 
   EndpointManager* endpoint_manager_;
 
@@ -337,6 +628,37 @@ class PayloadManager : public EndpointManager::FrameProcessor {
   mutable Mutex chunk_update_mutex_;
   int outgoing_chunk_update_count_ ABSL_GUARDED_BY(chunk_update_mutex_) = 0;
   int incoming_chunk_update_count_ ABSL_GUARDED_BY(chunk_update_mutex_) = 0;
+
+  // Outgoing BYTES payloads waiting to be sent as a single frame, tracked when
+  // BYTES payload batching is enabled. |bytes_batch_generation_| is bumped on
+  // every flush so that a stale linger alarm leaves a newer batch alone.
+  mutable Mutex bytes_batch_mutex_;
+  BytesPayloadBatch bytes_batch_ ABSL_GUARDED_BY(bytes_batch_mutex_);
+  std::int64_t bytes_batch_generation_ ABSL_GUARDED_BY(bytes_batch_mutex_) = 0;
+  ScheduledExecutor bytes_batch_alarm_executor_;
+
+  // Chunk size per endpoint, tracked when adaptive chunk sizing is enabled.
+  mutable Mutex chunk_sizers_mutex_;
+  absl::flat_hash_map<std::string, AdaptiveChunkSizer> chunk_sizers_
+      ABSL_GUARDED_BY(chunk_sizers_mutex_);
+
+  // Signaled when an outgoing STREAM payload is granted credit, when an
+  // outgoing FILE payload gets the answer to its chunk manifest, or when a
+  // payload waiting for either may have been canceled.
+  mutable Mutex credit_mutex_;
+  ConditionVariable credit_cond_{&credit_mutex_};
+
+  // The chunks of the files received with a chunk manifest.
+  FileChunkStore file_chunk_store_;
+
+  // The BYTES payloads relayed over a tree of P2P_CLUSTER endpoints.
+  PayloadRelayTracker relay_tracker_;
+
+  // Takes turns writing chunks between the clients sending to the same
+  // endpoints, set when fair payload scheduling is enabled. Weighs them by
+  // service ID.
+  std::unique_ptr<PayloadSendScheduler> send_scheduler_;
+  absl::flat_hash_map<std::string, int> send_weights_;
 };
 
 }  // namespace connections
@@ -17,9 +17,24 @@
 #include "gmock/gmock.h"
 #include "protobuf-matchers/protocol-buffer-matchers.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "connections/implementation/client_proxy.h"
+#include "connections/implementation/endpoint_channel_manager.h"
+#include "connections/implementation/endpoint_manager.h"
+#include "connections/implementation/fake_endpoint_channel.h"
+#include "connections/implementation/file_chunk_store.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "connections/implementation/offline_frames.h"
+#include "connections/implementation/payload_relay.h"
 #include "connections/implementation/simulation_user.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/condition_variable.h"
+#include "internal/platform/feature_flags.h"
+#include "internal/platform/file.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/mutex_lock.h"
 #include "internal/platform/pipe.h"
 #include "internal/platform/system_clock.h"
 
@@ -27,6 +42,10 @@ namespace nearby {
 namespace connections {
 namespace {
 
+using ::location::nearby::connections::OfflineFrame;
+using ::location::nearby::connections::PayloadTransferFrame;
+using ::testing::ElementsAre;
+
 constexpr absl::string_view kServiceId = "service-id";
 constexpr absl::string_view kDeviceA = "device-a";
 constexpr absl::string_view kDeviceB = "device-b";
@@ -159,6 +178,92 @@ TEST_P(PayloadManagerTest, CanSendBytePayload) {
   env_.Stop();
 }
 
+TEST_P(PayloadManagerTest, CanSendSingleFrameBytePayload) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableSingleFrameBytesPayloads,
+      true);
+  env_.Start();
+  PayloadSimulationUser user_a(kDeviceA, GetParam());
+  PayloadSimulationUser user_b(kDeviceB, GetParam());
+  ASSERT_TRUE(SetupConnection(user_a, user_b));
+
+  user_a.ExpectPayload(payload_latch_);
+  user_b.SendPayload(Payload(ByteArray{std::string(kMessage)}));
+  EXPECT_TRUE(payload_latch_.Await(kDefaultTimeout).result());
+  EXPECT_EQ(user_a.GetPayload().AsBytes(), ByteArray(std::string(kMessage)));
+  EXPECT_TRUE(user_a.WaitForProgress(
+      [](const PayloadProgressInfo& info) {
+        return info.status == PayloadProgressInfo::Status::kSuccess &&
+               info.bytes_transferred ==
+                   static_cast<std::int64_t>(kMessage.size());
+      },
+      kProgressTimeout));
+  NEARBY_LOG(INFO, "Test completed.");
+
+  user_a.Stop();
+  user_b.Stop();
+  env_.Stop();
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST_P(PayloadManagerTest, CanSendCompressedBytePayload) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnablePayloadCompression,
+      true);
+  env_.Start();
+  PayloadSimulationUser user_a(kDeviceA, GetParam());
+  PayloadSimulationUser user_b(kDeviceB, GetParam());
+  ASSERT_TRUE(SetupConnection(user_a, user_b));
+
+  const std::string message(16 * 1024, 'a');
+  user_a.ExpectPayload(payload_latch_);
+  user_b.SendPayload(Payload(ByteArray{message}));
+  EXPECT_TRUE(payload_latch_.Await(kDefaultTimeout).result());
+  EXPECT_EQ(user_a.GetPayload().AsBytes(), ByteArray(message));
+  // Progress counts the uncompressed bytes.
+  EXPECT_TRUE(user_a.WaitForProgress(
+      [&message](const PayloadProgressInfo& info) {
+        return info.status == PayloadProgressInfo::Status::kSuccess &&
+               info.bytes_transferred ==
+                   static_cast<std::int64_t>(message.size());
+      },
+      kProgressTimeout));
+  NEARBY_LOG(INFO, "Test completed.");
+
+  user_a.Stop();
+  user_b.Stop();
+  env_.Stop();
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST_P(PayloadManagerTest, CanSendBatchedBytePayloads) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableBytesPayloadBatching,
+      true);
+  env_.Start();
+  PayloadSimulationUser user_a(kDeviceA, GetParam());
+  PayloadSimulationUser user_b(kDeviceB, GetParam());
+  ASSERT_TRUE(SetupConnection(user_a, user_b));
+
+  CountDownLatch payloads_latch(3);
+  user_a.ExpectPayload(payloads_latch);
+  user_b.SendPayload(Payload(ByteArray{std::string("first")}));
+  user_b.SendPayload(Payload(ByteArray{std::string("second")}));
+  user_b.SendPayload(Payload(ByteArray{std::string(kMessage)}));
+  EXPECT_TRUE(payloads_latch.Await(kDefaultTimeout).result());
+  // Batched payloads are still delivered in order.
+  EXPECT_EQ(user_a.GetPayload().AsBytes(), ByteArray(std::string(kMessage)));
+  NEARBY_LOG(INFO, "Test completed.");
+
+  user_a.Stop();
+  user_b.Stop();
+  env_.Stop();
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 TEST_P(PayloadManagerTest, CanSendStreamPayload) {
   env_.Start();
   PayloadSimulationUser user_a(kDeviceA, GetParam());
@@ -325,6 +430,45 @@ TEST_P(PayloadManagerTest, CanCancelPayloadOnSenderSide) {
   env_.Stop();
 }
 
+TEST_P(PayloadManagerTest, CancelOnSenderSideUnblocksStreamRead) {
+  env_.Start();
+  env_.SetFeatureFlags(FeatureFlags::Flags{.enable_cancellation_flag = true});
+  PayloadSimulationUser user_a(kDeviceA, GetParam());
+  PayloadSimulationUser user_b(kDeviceB, GetParam());
+  ASSERT_TRUE(SetupConnection(user_a, user_b));
+
+  auto pipe = std::make_shared<Pipe>();
+  OutputStream& tx = pipe->GetOutputStream();
+
+  user_a.ExpectPayload(payload_latch_);
+  const ByteArray message{std::string(kMessage)};
+  tx.Write(message);
+
+  user_b.SendPayload(Payload([pipe]() -> InputStream& {
+    return pipe->GetInputStream();  // NOLINT
+  }));
+  ASSERT_TRUE(payload_latch_.Await(kDefaultTimeout).result());
+  EXPECT_TRUE(user_a.WaitForProgress(
+      [&message](const PayloadProgressInfo& info) {
+        return info.bytes_transferred >= message.size();
+      },
+      kProgressTimeout));
+
+  // The sender is blocked reading the stream; nothing more is written to it.
+  EXPECT_EQ(user_b.CancelPayload(), Status{Status::kSuccess});
+
+  EXPECT_TRUE(user_a.WaitForProgress(
+      [status = PayloadProgressInfo::Status::kCanceled](
+          const PayloadProgressInfo& info) { return info.status == status; },
+      kProgressTimeout));
+
+  tx.Close();
+  user_a.Stop();
+  user_b.Stop();
+  env_.SetFeatureFlags(FeatureFlags::Flags{});
+  env_.Stop();
+}
+
 TEST_P(PayloadManagerTest, SendPayloadWithSkip_StreamPayload) {
   constexpr size_t kOffset = 3;
   env_.Start();
@@ -381,6 +525,446 @@ TEST_P(PayloadManagerTest, SendPayloadWithSkip_StreamPayload) {
 INSTANTIATE_TEST_SUITE_P(ParametrisedPayloadManagerTest, PayloadManagerTest,
                          ::testing::ValuesIn(kTestCases));
 
+constexpr absl::string_view kOrigin = "origin";
+constexpr absl::string_view kRelay = "relay";
+constexpr absl::string_view kChild = "child";
+
+// Drives a PayloadManager with frames, over FakeEndpointChannels that record
+// the frames written to them.
+class PayloadFrameTest : public ::testing::Test {
+ protected:
+  ~PayloadFrameTest() override {
+    NearbyFlags::GetInstance().ResetOverridedValues();
+  }
+
+  void Connect(absl::string_view endpoint_id) {
+    std::string id(endpoint_id);
+    client_.OnConnectionInitiated(id, ConnectionResponseInfo(),
+                                  ConnectionOptions(), ConnectionListener(),
+                                  "conntokn");
+    PayloadListener listener;
+    listener.payload_cb = [this](absl::string_view endpoint_id,
+                                 Payload payload) {
+      MutexLock lock(&mutex_);
+      payload_endpoint_ids_.push_back(std::string(endpoint_id));
+      if (payload.AsFile() != nullptr) {
+        file_paths_.push_back(payload.AsFile()->GetFilePath());
+      }
+      cond_.Notify();
+    };
+    client_.LocalEndpointAcceptedConnection(id, std::move(listener));
+    client_.RemoteEndpointAcceptedConnection(id);
+    client_.OnConnectionAccepted(id);
+    client_.SetRemoteSupportsPayloadRelay(id, true);
+    client_.SetRemoteSupportsChunkDedup(id, true);
+    auto channel = std::make_unique<FakeEndpointChannel>(
+        location::nearby::proto::connections::BLUETOOTH,
+        std::string(kServiceId));
+    channel->set_write_callback([this, id](const ByteArray& data) {
+      ExceptionOr<OfflineFrame> frame = parser::FromBytes(data);
+      if (!frame.ok()) return;
+      MutexLock lock(&mutex_);
+      written_frames_[id].push_back(frame.result().v1().payload_transfer());
+      cond_.Notify();
+    });
+    ecm_.RegisterChannelForEndpoint(&client_, id, std::move(channel));
+  }
+
+  // Hands |payload_header| to the PayloadManager as a BYTES payload of
+  // |kMessage| from |endpoint_id|.
+  void ReceiveBytes(absl::string_view endpoint_id,
+                    PayloadTransferFrame::PayloadHeader payload_header) {
+    payload_header.set_type(PayloadTransferFrame::PayloadHeader::BYTES);
+    payload_header.set_total_size(kMessage.size());
+    PayloadTransferFrame::PayloadChunk chunk;
+    chunk.set_offset(0);
+    chunk.set_flags(0);
+    chunk.set_body(std::string(kMessage));
+    Receive(endpoint_id,
+            parser::ForDataPayloadTransfer(payload_header, chunk));
+    chunk.set_offset(kMessage.size());
+    chunk.set_flags(PayloadTransferFrame::PayloadChunk::LAST_CHUNK);
+    chunk.clear_body();
+    Receive(endpoint_id,
+            parser::ForDataPayloadTransfer(payload_header, chunk));
+  }
+
+  void ReceiveRelayed(absl::string_view endpoint_id, Payload::Id payload_id,
+                      const std::vector<std::string>& failed_endpoint_ids) {
+    PayloadTransferFrame::PayloadHeader payload_header;
+    payload_header.set_id(payload_id);
+    payload_header.set_type(PayloadTransferFrame::PayloadHeader::BYTES);
+    payload_header.set_total_size(kMessage.size());
+    PayloadTransferFrame::ControlMessage control_message;
+    control_message.set_event(
+        PayloadTransferFrame::ControlMessage::PAYLOAD_RELAYED);
+    control_message.set_offset(kMessage.size());
+    for (const auto& failed_endpoint_id : failed_endpoint_ids) {
+      control_message.add_failed_endpoint_ids(failed_endpoint_id);
+    }
+    Receive(endpoint_id,
+            parser::ForControlPayloadTransfer(payload_header, control_message));
+  }
+
+  // Returns the frames written to |endpoint_id|, once there are |count|.
+  std::vector<PayloadTransferFrame> WaitForFrames(absl::string_view endpoint_id,
+                                                  int count) {
+    MutexLock lock(&mutex_);
+    std::vector<PayloadTransferFrame>& frames =
+        written_frames_[std::string(endpoint_id)];
+    absl::Time deadline = SystemClock::ElapsedRealtime() + kDefaultTimeout;
+    while (frames.size() < count && SystemClock::ElapsedRealtime() < deadline) {
+      cond_.Wait(deadline - SystemClock::ElapsedRealtime());
+    }
+    return frames;
+  }
+
+  // Returns the frames written to |endpoint_id|, once the last one ends a
+  // payload.
+  std::vector<PayloadTransferFrame> WaitForLastChunk(
+      absl::string_view endpoint_id) {
+    MutexLock lock(&mutex_);
+    std::vector<PayloadTransferFrame>& frames =
+        written_frames_[std::string(endpoint_id)];
+    absl::Time deadline = SystemClock::ElapsedRealtime() + kDefaultTimeout;
+    while ((frames.empty() ||
+            (frames.back().payload_chunk().flags() &
+             PayloadTransferFrame::PayloadChunk::LAST_CHUNK) == 0) &&
+           SystemClock::ElapsedRealtime() < deadline) {
+      cond_.Wait(deadline - SystemClock::ElapsedRealtime());
+    }
+    return frames;
+  }
+
+  // Returns the endpoints payloads were received from, once there are |count|.
+  std::vector<std::string> WaitForPayloads(int count) {
+    MutexLock lock(&mutex_);
+    absl::Time deadline = SystemClock::ElapsedRealtime() + kDefaultTimeout;
+    while (payload_endpoint_ids_.size() < count &&
+           SystemClock::ElapsedRealtime() < deadline) {
+      cond_.Wait(deadline - SystemClock::ElapsedRealtime());
+    }
+    return payload_endpoint_ids_;
+  }
+
+  // Returns the paths of the received FILE payloads.
+  std::vector<std::string> GetFilePaths() {
+    MutexLock lock(&mutex_);
+    return file_paths_;
+  }
+
+  std::string GetLocalEndpointId() { return client_.GetLocalEndpointId(); }
+
+  void Receive(absl::string_view endpoint_id, const ByteArray& bytes) {
+    OfflineFrame frame = parser::FromBytes(bytes).result();
+    PacketMetaData packet_meta_data;
+    pm_.OnIncomingFrame(frame, std::string(endpoint_id), &client_,
+                        location::nearby::proto::connections::BLUETOOTH,
+                        packet_meta_data);
+  }
+
+ private:
+  Mutex mutex_;
+  ConditionVariable cond_{&mutex_};
+  absl::flat_hash_map<std::string, std::vector<PayloadTransferFrame>>
+      written_frames_ ABSL_GUARDED_BY(mutex_);
+  std::vector<std::string> payload_endpoint_ids_ ABSL_GUARDED_BY(mutex_);
+  std::vector<std::string> file_paths_ ABSL_GUARDED_BY(mutex_);
+
+ protected:
+  ClientProxy client_;
+  EndpointChannelManager ecm_;
+  EndpointManager em_{&ecm_};
+  PayloadManager pm_{em_};
+};
+
+class PayloadRelayTest : public PayloadFrameTest {
+ protected:
+  PayloadRelayTest() {
+    NearbyFlags::GetInstance().OverrideBoolFlagValue(
+        config_package_nearby::nearby_connections_feature::
+            kEnableClusterPayloadRelay,
+        true);
+    NearbyFlags::GetInstance().OverrideInt64FlagValue(
+        config_package_nearby::nearby_connections_feature::
+            kClusterPayloadRelayFanOut,
+        1);
+  }
+};
+
+TEST_F(PayloadRelayTest, ForwardsAndAcksRelayedPayload) {
+  Connect(kOrigin);
+  Connect(kRelay);
+  Connect(kChild);
+  PayloadTransferFrame::PayloadHeader payload_header;
+  payload_header.set_id(1);
+  PayloadRelayTree::Build(
+      kOrigin, {std::string(kRelay), GetLocalEndpointId(), std::string(kChild)},
+      /*fan_out=*/1)
+      .AddToHeader(payload_header);
+
+  ReceiveBytes(kRelay, payload_header);
+
+  EXPECT_THAT(WaitForPayloads(1), ElementsAre(kOrigin));
+  std::vector<PayloadTransferFrame> forwarded = WaitForFrames(kChild, 2);
+  ASSERT_EQ(forwarded.size(), 2);
+  EXPECT_EQ(forwarded[0].payload_chunk().body(), kMessage);
+  EXPECT_EQ(forwarded[0].payload_header().relay_origin_endpoint_id(), kOrigin);
+  EXPECT_EQ(forwarded[0].payload_header().relay_nodes_size(), 3);
+
+  ReceiveRelayed(kChild, 1, {});
+
+  std::vector<PayloadTransferFrame> acks = WaitForFrames(kRelay, 1);
+  ASSERT_EQ(acks.size(), 1);
+  EXPECT_EQ(acks[0].control_message().event(),
+            PayloadTransferFrame::ControlMessage::PAYLOAD_RELAYED);
+  EXPECT_EQ(acks[0].control_message().failed_endpoint_ids_size(), 0);
+  EXPECT_TRUE(WaitForFrames(kOrigin, 0).empty());
+}
+
+TEST_F(PayloadRelayTest, DoesNotTakePayloadFromOutsideTree) {
+  Connect(kOrigin);
+  Connect(kRelay);
+  Connect(kChild);
+  PayloadTransferFrame::PayloadHeader payload_header;
+  payload_header.set_id(1);
+  PayloadRelayTree::Build(
+      kOrigin, {std::string(kRelay), GetLocalEndpointId(), std::string(kChild)},
+      /*fan_out=*/1)
+      .AddToHeader(payload_header);
+
+  // Only |kRelay| is above the local endpoint.
+  ReceiveBytes(kChild, payload_header);
+
+  EXPECT_THAT(WaitForPayloads(1), ElementsAre(kChild));
+  EXPECT_TRUE(WaitForFrames(kOrigin, 0).empty());
+  EXPECT_TRUE(WaitForFrames(kRelay, 0).empty());
+}
+
+TEST_F(PayloadRelayTest, SendsDirectlyWhereRelayFailed) {
+  Connect(kRelay);
+  Connect(kChild);
+
+  pm_.SendPayload(&client_, {std::string(kRelay), std::string(kChild)},
+                  Payload(ByteArray(std::string(kMessage))));
+
+  std::vector<PayloadTransferFrame> relayed = WaitForFrames(kRelay, 1);
+  ASSERT_FALSE(relayed.empty());
+  const PayloadTransferFrame::PayloadHeader& payload_header =
+      relayed[0].payload_header();
+  EXPECT_EQ(payload_header.relay_origin_endpoint_id(), GetLocalEndpointId());
+  EXPECT_EQ(payload_header.relay_nodes_size(), 2);
+  EXPECT_TRUE(WaitForFrames(kChild, 0).empty());
+
+  ReceiveRelayed(kRelay, payload_header.id(), {std::string(kChild)});
+
+  std::vector<PayloadTransferFrame> direct = WaitForFrames(kChild, 1);
+  ASSERT_FALSE(direct.empty());
+  EXPECT_EQ(direct[0].payload_header().id(), payload_header.id());
+  EXPECT_EQ(direct[0].payload_header().relay_nodes_size(), 0);
+  EXPECT_EQ(direct[0].payload_chunk().body(), kMessage);
+}
+
+TEST_F(PayloadFrameTest, StreamWaitsForCredit) {
+  Connect(kDeviceA);
+  auto pipe = std::make_shared<Pipe>();
+  OutputStream& tx = pipe->GetOutputStream();
+  tx.Write(ByteArray(std::string(100, 'a')));
+  Payload payload([pipe]() -> InputStream& {
+    return pipe->GetInputStream();  // NOLINT
+  });
+  Payload::Id payload_id = payload.GetId();
+  pm_.SendPayload(&client_, {std::string(kDeviceA)}, std::move(payload));
+  std::vector<PayloadTransferFrame> frames = WaitForFrames(kDeviceA, 1);
+  ASSERT_EQ(frames.size(), 1);
+  PayloadTransferFrame::PayloadHeader payload_header =
+      frames[0].payload_header();
+  EXPECT_EQ(payload_header.id(), payload_id);
+  auto grant_credit = [&](std::int64_t credit_limit) {
+    PayloadTransferFrame::ControlMessage control_message;
+    control_message.set_event(
+        PayloadTransferFrame::ControlMessage::PAYLOAD_CREDIT);
+    control_message.set_offset(credit_limit);
+    Receive(kDeviceA,
+            parser::ForControlPayloadTransfer(payload_header, control_message));
+  };
+
+  // The sender is already reading on, so the next write still goes out.
+  grant_credit(200);
+  tx.Write(ByteArray(std::string(100, 'b')));
+  frames = WaitForFrames(kDeviceA, 2);
+  ASSERT_EQ(frames.size(), 2);
+  EXPECT_EQ(frames[1].payload_chunk().offset(), 100);
+  tx.Write(ByteArray(std::string(100, 'c')));
+  EXPECT_EQ(WaitForFrames(kDeviceA, 3).size(), 2);
+
+  grant_credit(300);
+
+  frames = WaitForFrames(kDeviceA, 3);
+  ASSERT_EQ(frames.size(), 3);
+  EXPECT_EQ(frames[2].payload_chunk().offset(), 200);
+  EXPECT_EQ(frames[2].payload_chunk().body(), std::string(100, 'c'));
+  tx.Close();
+}
+
+constexpr std::int64_t kChunkSize = FileChunkStore::kChunkSize;
+
+// Sends a FILE of 2 chunks and a shorter last one over to the receiver.
+class PayloadChunkDedupTest : public PayloadFrameTest {
+ protected:
+  PayloadChunkDedupTest() {
+    NearbyFlags::GetInstance().OverrideBoolFlagValue(
+        config_package_nearby::nearby_connections_feature::
+            kEnableFilePayloadChunkDedup,
+        true);
+    contents_.replace(kChunkSize, kChunkSize, kChunkSize, 'b');
+    Payload::Id payload_id = Payload::GenerateId();
+    OutputFile output_file(payload_id);
+    EXPECT_TRUE(output_file.Write(ByteArray(contents_)).Ok());
+    EXPECT_TRUE(output_file.Close().Ok());
+    file_path_ = InputFile(payload_id, GetTotalSize()).GetFilePath();
+  }
+
+  std::int64_t GetTotalSize() const { return contents_.size(); }
+
+  FileChunkStore::ChunkManifest CreateManifest() {
+    InputFile file(file_path_, GetTotalSize());
+    std::optional<FileChunkStore::ChunkManifest> manifest =
+        FileChunkStore::CreateManifest(file, 0, FileChunkStore::kMaxChunks);
+    file.Close();
+    EXPECT_TRUE(manifest.has_value());
+    return manifest.value_or(FileChunkStore::ChunkManifest());
+  }
+
+  PayloadTransferFrame::PayloadHeader CreateHeader(Payload::Id payload_id) {
+    PayloadTransferFrame::PayloadHeader payload_header;
+    payload_header.set_id(payload_id);
+    payload_header.set_type(PayloadTransferFrame::PayloadHeader::FILE);
+    payload_header.set_total_size(GetTotalSize());
+    return payload_header;
+  }
+
+  void ReceiveManifest(const PayloadTransferFrame::PayloadHeader& header,
+                       const FileChunkStore::ChunkManifest& manifest) {
+    PayloadTransferFrame::ControlMessage control_message;
+    control_message.set_event(
+        PayloadTransferFrame::ControlMessage::PAYLOAD_MANIFEST);
+    control_message.set_offset(0);
+    *control_message.mutable_chunk_manifest() = manifest;
+    Receive(kDeviceA,
+            parser::ForControlPayloadTransfer(header, control_message));
+  }
+
+  // Hands the PayloadManager the data from |offset| on, ending in the last
+  // chunk.
+  void ReceiveData(const PayloadTransferFrame::PayloadHeader& header,
+                   std::int64_t offset) {
+    PayloadTransferFrame::PayloadChunk chunk;
+    chunk.set_flags(0);
+    for (; offset < GetTotalSize(); offset += kChunkSize) {
+      chunk.set_offset(offset);
+      chunk.set_body(contents_.substr(offset, kChunkSize));
+      Receive(kDeviceA, parser::ForDataPayloadTransfer(header, chunk));
+    }
+    chunk.set_offset(GetTotalSize());
+    chunk.set_flags(PayloadTransferFrame::PayloadChunk::LAST_CHUNK);
+    chunk.clear_body();
+    Receive(kDeviceA, parser::ForDataPayloadTransfer(header, chunk));
+  }
+
+  std::string contents_ = std::string(2 * kChunkSize + 100, 'a');
+  std::string file_path_;
+};
+
+TEST(SkippedChunksTest, SkipsUpToNextSentChunk) {
+  PayloadManager::SkippedChunks skipped_chunks{
+      .chunk_size = 10, .chunks = {true, true, false, true}};
+
+  EXPECT_EQ(skipped_chunks.SkippedBytesAt(0, 35), 20);
+  EXPECT_EQ(skipped_chunks.SkippedBytesAt(20, 35), 0);
+  EXPECT_EQ(skipped_chunks.SkippedBytesAt(30, 35), 5);
+  // Only whole chunks are left out.
+  EXPECT_EQ(skipped_chunks.SkippedBytesAt(5, 35), 0);
+}
+
+TEST(SkippedChunksTest, SendsUpToNextSkippedChunk) {
+  PayloadManager::SkippedChunks skipped_chunks{
+      .chunk_size = 10, .chunks = {false, false, true, false}};
+
+  EXPECT_EQ(skipped_chunks.SentBytesAt(0, 100), 20);
+  EXPECT_EQ(skipped_chunks.SentBytesAt(15, 100), 5);
+  // Stops where the manifests answered so far end.
+  EXPECT_EQ(skipped_chunks.SentBytesAt(30, 100), 10);
+  EXPECT_EQ(skipped_chunks.CoveredBytes(100), 40);
+  EXPECT_EQ(skipped_chunks.CoveredBytes(35), 35);
+}
+
+TEST_F(PayloadChunkDedupTest, SendsOnlyChunksTheReceiverLacks) {
+  Connect(kDeviceA);
+
+  pm_.SendPayload(&client_, {std::string(kDeviceA)},
+                  Payload(InputFile(file_path_, GetTotalSize())));
+
+  std::vector<PayloadTransferFrame> frames = WaitForFrames(kDeviceA, 1);
+  ASSERT_EQ(frames.size(), 1);
+  const PayloadTransferFrame::ControlMessage& manifest_message =
+      frames[0].control_message();
+  EXPECT_EQ(manifest_message.event(),
+            PayloadTransferFrame::ControlMessage::PAYLOAD_MANIFEST);
+  EXPECT_EQ(manifest_message.offset(), 0);
+  EXPECT_EQ(manifest_message.chunk_manifest().chunk_hashes_size(), 3);
+
+  PayloadTransferFrame::ControlMessage reply;
+  reply.set_event(PayloadTransferFrame::ControlMessage::PAYLOAD_MANIFEST_REPLY);
+  reply.set_offset(0);
+  reply.set_present_chunks(
+      FileChunkStore::EncodePresentChunks({true, false, true}));
+  Receive(kDeviceA,
+          parser::ForControlPayloadTransfer(frames[0].payload_header(), reply));
+
+  frames = WaitForLastChunk(kDeviceA);
+  ASSERT_GE(frames.size(), 3);
+  std::string sent;
+  for (int i = 1; i < frames.size() - 1; ++i) {
+    EXPECT_EQ(frames[i].payload_chunk().offset(), kChunkSize + sent.size());
+    sent += frames[i].payload_chunk().body();
+  }
+  EXPECT_TRUE(sent == contents_.substr(kChunkSize, kChunkSize));
+  const PayloadTransferFrame::PayloadChunk& last_chunk =
+      frames.back().payload_chunk();
+  EXPECT_EQ(last_chunk.offset(), GetTotalSize());
+  EXPECT_NE(last_chunk.flags() & PayloadTransferFrame::PayloadChunk::LAST_CHUNK,
+            0);
+}
+
+TEST_F(PayloadChunkDedupTest, CopiesChunksOfEarlierFile) {
+  Connect(kDeviceA);
+  FileChunkStore::ChunkManifest manifest = CreateManifest();
+  PayloadTransferFrame::PayloadHeader first_header = CreateHeader(1);
+  ReceiveManifest(first_header, manifest);
+  ReceiveData(first_header, 0);
+
+  PayloadTransferFrame::PayloadHeader second_header = CreateHeader(2);
+  ReceiveManifest(second_header, manifest);
+  ReceiveData(second_header, GetTotalSize());
+
+  std::vector<PayloadTransferFrame> replies = WaitForFrames(kDeviceA, 2);
+  ASSERT_EQ(replies.size(), 2);
+  EXPECT_EQ(replies[0].control_message().present_chunks(),
+            FileChunkStore::EncodePresentChunks({false, false, false}));
+  EXPECT_EQ(replies[1].control_message().event(),
+            PayloadTransferFrame::ControlMessage::PAYLOAD_MANIFEST_REPLY);
+  EXPECT_EQ(replies[1].control_message().present_chunks(),
+            FileChunkStore::EncodePresentChunks({true, true, true}));
+  std::vector<std::string> file_paths = GetFilePaths();
+  ASSERT_EQ(file_paths.size(), 2);
+  InputFile copied_file(file_paths[1], GetTotalSize());
+  ExceptionOr<ByteArray> copied = copied_file.Read(GetTotalSize());
+  copied_file.Close();
+  ASSERT_TRUE(copied.ok());
+  EXPECT_TRUE(std::string(copied.result()) == contents_);
+}
+
 }  // namespace
 }  // namespace connections
 }  // namespace nearby
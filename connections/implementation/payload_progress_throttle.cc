@@ -0,0 +1,46 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/payload_progress_throttle.h"
+
+#include <cstdint>
+
+#include "absl/time/time.h"
+
+namespace nearby {
+namespace connections {
+
+PayloadProgressThrottle::PayloadProgressThrottle(absl::Duration min_interval,
+                                                 std::int64_t min_bytes)
+    : min_interval_(min_interval), min_bytes_(min_bytes) {}
+
+bool PayloadProgressThrottle::ShouldReport(std::int64_t bytes_transferred,
+                                           absl::Time now) {
+  bool throttled = min_interval_ > absl::ZeroDuration() || min_bytes_ > 0;
+  if (throttled && reported_) {
+    bool interval_passed = min_interval_ > absl::ZeroDuration() &&
+                           now - last_report_time_ >= min_interval_;
+    bool bytes_passed =
+        min_bytes_ > 0 && bytes_transferred - last_reported_bytes_ >= min_bytes_;
+    if (!interval_passed && !bytes_passed) return false;
+  }
+
+  reported_ = true;
+  last_report_time_ = now;
+  last_reported_bytes_ = bytes_transferred;
+  return true;
+}
+
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,54 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_PAYLOAD_PROGRESS_THROTTLE_H_
+#define CORE_INTERNAL_PAYLOAD_PROGRESS_THROTTLE_H_
+
+#include <cstdint>
+
+#include "absl/time/time.h"
+
+namespace nearby {
+namespace connections {
+
+// Decides which in-progress updates of one payload transfer are reported to
+// the client, so that a fast transfer doesn't report every single chunk.
+//
+// An update is reported once |min_interval| has passed, or |min_bytes| more
+// bytes were transferred, since the last reported one. The first update is
+// always reported. With both limits at zero, every update is reported.
+// Terminal updates (success, failure, cancellation) must bypass the throttle.
+//
+// Not thread-safe.
+class PayloadProgressThrottle {
+ public:
+  PayloadProgressThrottle() = default;
+  PayloadProgressThrottle(absl::Duration min_interval, std::int64_t min_bytes);
+
+  // Returns whether the in-progress update with |bytes_transferred| bytes at
+  // time |now| should be reported, and if so, remembers it as the last one.
+  bool ShouldReport(std::int64_t bytes_transferred, absl::Time now);
+
+ private:
+  absl::Duration min_interval_ = absl::ZeroDuration();
+  std::int64_t min_bytes_ = 0;
+  bool reported_ = false;
+  absl::Time last_report_time_;
+  std::int64_t last_reported_bytes_ = 0;
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_PAYLOAD_PROGRESS_THROTTLE_H_
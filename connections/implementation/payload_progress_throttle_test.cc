@@ -0,0 +1,71 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/payload_progress_throttle.h"
+
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+constexpr absl::Time kStartTime = absl::FromUnixSeconds(1000);
+
+TEST(PayloadProgressThrottleTest, ReportsEveryUpdateWithoutLimits) {
+  PayloadProgressThrottle throttle;
+
+  EXPECT_TRUE(throttle.ShouldReport(10, kStartTime));
+  EXPECT_TRUE(throttle.ShouldReport(20, kStartTime));
+  EXPECT_TRUE(throttle.ShouldReport(30, kStartTime));
+}
+
+TEST(PayloadProgressThrottleTest, AlwaysReportsFirstUpdate) {
+  PayloadProgressThrottle throttle(absl::Seconds(1), 1000);
+
+  EXPECT_TRUE(throttle.ShouldReport(10, kStartTime));
+  EXPECT_FALSE(throttle.ShouldReport(20, kStartTime));
+}
+
+TEST(PayloadProgressThrottleTest, ReportsOnceIntervalPassed) {
+  PayloadProgressThrottle throttle(absl::Milliseconds(100), 0);
+
+  EXPECT_TRUE(throttle.ShouldReport(10, kStartTime));
+  EXPECT_FALSE(
+      throttle.ShouldReport(1000000, kStartTime + absl::Milliseconds(99)));
+  EXPECT_TRUE(throttle.ShouldReport(20, kStartTime + absl::Milliseconds(100)));
+  EXPECT_FALSE(throttle.ShouldReport(30, kStartTime + absl::Milliseconds(150)));
+}
+
+TEST(PayloadProgressThrottleTest, ReportsOnceBytesPassed) {
+  PayloadProgressThrottle throttle(absl::ZeroDuration(), 100);
+
+  EXPECT_TRUE(throttle.ShouldReport(0, kStartTime));
+  EXPECT_FALSE(throttle.ShouldReport(99, kStartTime + absl::Hours(1)));
+  EXPECT_TRUE(throttle.ShouldReport(100, kStartTime + absl::Hours(1)));
+  EXPECT_FALSE(throttle.ShouldReport(150, kStartTime + absl::Hours(2)));
+}
+
+TEST(PayloadProgressThrottleTest, ReportsWhicheverLimitPassesFirst) {
+  PayloadProgressThrottle throttle(absl::Seconds(1), 100);
+
+  EXPECT_TRUE(throttle.ShouldReport(0, kStartTime));
+  EXPECT_TRUE(throttle.ShouldReport(100, kStartTime + absl::Milliseconds(1)));
+  EXPECT_TRUE(throttle.ShouldReport(110, kStartTime + absl::Seconds(2)));
+  EXPECT_FALSE(throttle.ShouldReport(120, kStartTime + absl::Seconds(2)));
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
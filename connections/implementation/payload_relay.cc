@@ -0,0 +1,224 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/payload_relay.h"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "internal/platform/mutex_lock.h"
+
+namespace nearby {
+namespace connections {
+
+PayloadRelayTree PayloadRelayTree::Build(
+    absl::string_view root_endpoint_id,
+    absl::Span<const std::string> endpoint_ids, int fan_out) {
+  PayloadRelayTree tree;
+  tree.root_endpoint_id_ = std::string(root_endpoint_id);
+  fan_out = std::max(fan_out, 1);
+  tree.nodes_.reserve(endpoint_ids.size());
+  for (int i = 0; i < endpoint_ids.size(); ++i) {
+    // The first |fan_out| endpoints hang off the root, the next |fan_out| off
+    // the first of them, and so on.
+    int parent = i / fan_out - 1;
+    tree.nodes_.emplace_back(endpoint_ids[i],
+                             parent < 0 ? std::string(root_endpoint_id)
+                                        : endpoint_ids[parent]);
+  }
+  return tree;
+}
+
+PayloadRelayTree PayloadRelayTree::FromHeader(const PayloadHeader& header) {
+  PayloadRelayTree tree;
+  tree.root_endpoint_id_ = header.relay_origin_endpoint_id();
+  tree.nodes_.reserve(header.relay_nodes_size());
+  for (const auto& node : header.relay_nodes()) {
+    tree.nodes_.emplace_back(node.endpoint_id(), node.parent_endpoint_id());
+  }
+  return tree;
+}
+
+void PayloadRelayTree::AddToHeader(PayloadHeader& header) const {
+  header.set_relay_origin_endpoint_id(root_endpoint_id_);
+  for (const auto& [endpoint_id, parent_endpoint_id] : nodes_) {
+    auto* node = header.add_relay_nodes();
+    node->set_endpoint_id(endpoint_id);
+    node->set_parent_endpoint_id(parent_endpoint_id);
+  }
+}
+
+std::vector<std::string> PayloadRelayTree::GetChildren(
+    absl::string_view endpoint_id) const {
+  std::vector<std::string> children;
+  for (const auto& [child, parent] : nodes_) {
+    if (parent == endpoint_id && child != endpoint_id) {
+      children.push_back(child);
+    }
+  }
+  return children;
+}
+
+bool PayloadRelayTree::IsChildOf(absl::string_view endpoint_id,
+                                 absl::string_view parent_endpoint_id) const {
+  if (root_endpoint_id_.empty()) return false;
+  absl::flat_hash_map<std::string, std::string> parents;
+  for (const auto& [child, parent] : nodes_) {
+    // An endpoint listed twice could be sent the payload twice.
+    if (!parents.emplace(child, parent).second) return false;
+  }
+  if (parents.contains(root_endpoint_id_)) return false;
+  auto it = parents.find(endpoint_id);
+  if (it == parents.end() || it->second != parent_endpoint_id) return false;
+  // The tree comes from the remote endpoint; don't trust it to have no cycles.
+  for (int i = 0; i < nodes_.size(); ++i) {
+    if (it->second == root_endpoint_id_) return true;
+    it = parents.find(it->second);
+    if (it == parents.end()) return false;
+  }
+  return false;
+}
+
+std::vector<std::string> PayloadRelayTree::GetDescendants(
+    absl::string_view endpoint_id) const {
+  std::vector<std::string> descendants;
+  // The tree comes from the remote endpoint; don't trust it to have no cycles.
+  absl::flat_hash_set<std::string> visited = {std::string(endpoint_id)};
+  std::deque<std::string> queue = {std::string(endpoint_id)};
+  while (!queue.empty()) {
+    for (std::string& child : GetChildren(queue.front())) {
+      if (visited.insert(child).second) {
+        descendants.push_back(child);
+        queue.push_back(std::move(child));
+      }
+    }
+    queue.pop_front();
+  }
+  return descendants;
+}
+
+void PayloadRelayTracker::Start(
+    Payload::Id payload_id, std::shared_ptr<const Relay> relay,
+    absl::Span<const std::string> child_endpoint_ids) {
+  MutexLock lock(&mutex_);
+  Entry& entry = entries_[payload_id];
+  entry.relay = std::move(relay);
+  entry.pending_child_endpoint_ids.insert(child_endpoint_ids.begin(),
+                                          child_endpoint_ids.end());
+  entry.failed_endpoint_ids.clear();
+}
+
+std::shared_ptr<const PayloadRelayTracker::Relay> PayloadRelayTracker::GetRelay(
+    Payload::Id payload_id) const {
+  MutexLock lock(&mutex_);
+  auto it = entries_.find(payload_id);
+  return it == entries_.end() ? nullptr : it->second.relay;
+}
+
+std::optional<PayloadRelayTracker::ChildResult>
+PayloadRelayTracker::OnChildDone(
+    Payload::Id payload_id, absl::string_view child_endpoint_id,
+    absl::Span<const std::string> failed_endpoint_ids, bool child_failed) {
+  MutexLock lock(&mutex_);
+  return OnChildDoneLocked(payload_id, child_endpoint_id, failed_endpoint_ids,
+                           child_failed);
+}
+
+std::optional<PayloadRelayTracker::ChildResult>
+PayloadRelayTracker::OnForwardingFailed(Payload::Id payload_id,
+                                        absl::string_view child_endpoint_id) {
+  MutexLock lock(&mutex_);
+  auto it = entries_.find(payload_id);
+  if (it == entries_.end() || it->second.relay->parent_endpoint_id.empty()) {
+    return std::nullopt;
+  }
+  return OnChildDoneLocked(payload_id, child_endpoint_id, {},
+                           /*child_failed=*/true);
+}
+
+std::vector<PayloadRelayTracker::ChildResult>
+PayloadRelayTracker::OnEndpointDisconnected(absl::string_view endpoint_id) {
+  MutexLock lock(&mutex_);
+  std::vector<Payload::Id> payload_ids;
+  for (const auto& [payload_id, entry] : entries_) {
+    if (entry.pending_child_endpoint_ids.contains(endpoint_id)) {
+      payload_ids.push_back(payload_id);
+    }
+  }
+
+  std::vector<ChildResult> results;
+  for (Payload::Id payload_id : payload_ids) {
+    std::optional<ChildResult> result = OnChildDoneLocked(
+        payload_id, endpoint_id, {}, /*child_failed=*/true);
+    if (result.has_value()) {
+      results.push_back(*std::move(result));
+    }
+  }
+  return results;
+}
+
+std::optional<PayloadRelayTracker::ChildResult>
+PayloadRelayTracker::OnChildDoneLocked(
+    Payload::Id payload_id, absl::string_view child_endpoint_id,
+    absl::Span<const std::string> failed_endpoint_ids, bool child_failed) {
+  auto it = entries_.find(payload_id);
+  if (it == entries_.end()) return std::nullopt;
+  Entry& entry = it->second;
+  auto child = entry.pending_child_endpoint_ids.find(child_endpoint_id);
+  if (child == entry.pending_child_endpoint_ids.end()) return std::nullopt;
+  entry.pending_child_endpoint_ids.erase(child);
+
+  ChildResult result;
+  result.relay = entry.relay;
+  result.child_endpoint_id = std::string(child_endpoint_id);
+  std::vector<std::string> descendants =
+      entry.relay->tree.GetDescendants(child_endpoint_id);
+  if (child_failed) {
+    result.failed_endpoint_ids.push_back(result.child_endpoint_id);
+    result.failed_endpoint_ids.insert(result.failed_endpoint_ids.end(),
+                                      descendants.begin(), descendants.end());
+  } else {
+    // Only the endpoints that are actually below the child count; the rest of
+    // what it answered with is ignored.
+    absl::flat_hash_set<absl::string_view> failed(failed_endpoint_ids.begin(),
+                                                  failed_endpoint_ids.end());
+    result.delivered_endpoint_ids.push_back(result.child_endpoint_id);
+    for (std::string& descendant : descendants) {
+      (failed.contains(descendant) ? result.failed_endpoint_ids
+                                   : result.delivered_endpoint_ids)
+          .push_back(std::move(descendant));
+    }
+  }
+  entry.failed_endpoint_ids.insert(entry.failed_endpoint_ids.end(),
+                                   result.failed_endpoint_ids.begin(),
+                                   result.failed_endpoint_ids.end());
+
+  if (entry.pending_child_endpoint_ids.empty()) {
+    result.all_failed_endpoint_ids = std::move(entry.failed_endpoint_ids);
+    entries_.erase(it);
+  }
+  return result;
+}
+
+}  // namespace connections
+}  // namespace nearby
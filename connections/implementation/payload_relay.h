@@ -0,0 +1,155 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_PAYLOAD_RELAY_H_
+#define CORE_INTERNAL_PAYLOAD_RELAY_H_
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "connections/payload.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/mutex.h"
+
+namespace nearby {
+namespace connections {
+
+// The tree a payload for many endpoints of a P2P_CLUSTER is relayed over: the
+// sender sends it to a few of the endpoints, each of which forwards it to a
+// few others, and so on.
+class PayloadRelayTree {
+ public:
+  using PayloadHeader =
+      location::nearby::connections::PayloadTransferFrame::PayloadHeader;
+
+  PayloadRelayTree() = default;
+
+  // Spreads |endpoint_ids| over a tree below |root_endpoint_id|, filled level
+  // by level, where every endpoint has at most |fan_out| children.
+  static PayloadRelayTree Build(absl::string_view root_endpoint_id,
+                                absl::Span<const std::string> endpoint_ids,
+                                int fan_out);
+  // Reads the relay_nodes and relay_origin_endpoint_id of |header|. The tree
+  // is empty if there are no relay_nodes.
+  static PayloadRelayTree FromHeader(const PayloadHeader& header);
+
+  void AddToHeader(PayloadHeader& header) const;
+
+  bool Empty() const { return nodes_.empty(); }
+
+  // The endpoint the payload is sent from.
+  const std::string& GetRoot() const { return root_endpoint_id_; }
+  std::vector<std::string> GetChildren(absl::string_view endpoint_id) const;
+  // All the endpoints below |endpoint_id|, children first.
+  std::vector<std::string> GetDescendants(absl::string_view endpoint_id) const;
+  // Returns whether |endpoint_id| is in the tree once, right below
+  // |parent_endpoint_id|, with a path from there up to the root.
+  bool IsChildOf(absl::string_view endpoint_id,
+                 absl::string_view parent_endpoint_id) const;
+
+ private:
+  std::string root_endpoint_id_;
+  // Each endpoint with its parent, level by level.
+  std::vector<std::pair<std::string, std::string>> nodes_;
+};
+
+// The payloads the local endpoint sent or forwarded over a relay tree, until
+// each endpoint it sent them to is done with the endpoints below it: it
+// answered with PAYLOAD_RELAYED, or couldn't be sent the payload, or went
+// away. Thread-safe.
+class PayloadRelayTracker {
+ public:
+  using PayloadHeader = PayloadRelayTree::PayloadHeader;
+
+  struct Relay {
+    // Where the payload came from; empty where it was sent from.
+    std::string parent_endpoint_id;
+    PayloadRelayTree tree;
+    // The payload, to send it again with. Where the payload was sent from, the
+    // header has no relay_nodes.
+    PayloadHeader header;
+    ByteArray body;
+  };
+
+  // A child of the local endpoint that is done.
+  struct ChildResult {
+    std::shared_ptr<const Relay> relay;
+    std::string child_endpoint_id;
+    // The endpoints below the child that got the payload, and those that
+    // didn't, starting with the child itself if it didn't either.
+    std::vector<std::string> delivered_endpoint_ids;
+    std::vector<std::string> failed_endpoint_ids;
+    // Set once every child is done, to the endpoints below the local one that
+    // didn't get the payload.
+    std::optional<std::vector<std::string>> all_failed_endpoint_ids;
+  };
+
+  // Starts waiting for |child_endpoint_ids|, the children of the local
+  // endpoint in |relay|'s tree.
+  void Start(Payload::Id payload_id, std::shared_ptr<const Relay> relay,
+             absl::Span<const std::string> child_endpoint_ids)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the relay of |payload_id|, or nullptr.
+  std::shared_ptr<const Relay> GetRelay(Payload::Id payload_id) const
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Called when |child_endpoint_id| answered with PAYLOAD_RELAYED, with
+  // |failed_endpoint_ids| below it, or if |child_failed|, when it didn't get
+  // the payload itself. Returns std::nullopt if the local endpoint isn't
+  // waiting for it.
+  std::optional<ChildResult> OnChildDone(
+      Payload::Id payload_id, absl::string_view child_endpoint_id,
+      absl::Span<const std::string> failed_endpoint_ids, bool child_failed)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Like OnChildDone() with |child_failed|, but only for payloads the local
+  // endpoint forwarded, rather than sent.
+  std::optional<ChildResult> OnForwardingFailed(
+      Payload::Id payload_id, absl::string_view child_endpoint_id)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Fails |endpoint_id| for all the payloads waiting for it.
+  std::vector<ChildResult> OnEndpointDisconnected(
+      absl::string_view endpoint_id) ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  struct Entry {
+    std::shared_ptr<const Relay> relay;
+    absl::flat_hash_set<std::string> pending_child_endpoint_ids;
+    std::vector<std::string> failed_endpoint_ids;
+  };
+
+  std::optional<ChildResult> OnChildDoneLocked(
+      Payload::Id payload_id, absl::string_view child_endpoint_id,
+      absl::Span<const std::string> failed_endpoint_ids, bool child_failed)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  mutable Mutex mutex_;
+  absl::flat_hash_map<Payload::Id, Entry> entries_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_PAYLOAD_RELAY_H_
@@ -0,0 +1,204 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/payload_relay.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::UnorderedElementsAre;
+
+constexpr int kFanOut = 2;
+
+std::shared_ptr<const PayloadRelayTracker::Relay> MakeRelay() {
+  auto relay = std::make_shared<PayloadRelayTracker::Relay>();
+  relay->tree =
+      PayloadRelayTree::Build("root", {"a", "b", "c", "d", "e"}, kFanOut);
+  return relay;
+}
+
+TEST(PayloadRelayTreeTest, FillsTreeLevelByLevel) {
+  PayloadRelayTree tree =
+      PayloadRelayTree::Build("root", {"a", "b", "c", "d", "e"}, kFanOut);
+
+  EXPECT_THAT(tree.GetChildren("root"), ElementsAre("a", "b"));
+  EXPECT_THAT(tree.GetChildren("a"), ElementsAre("c", "d"));
+  EXPECT_THAT(tree.GetChildren("b"), ElementsAre("e"));
+  EXPECT_THAT(tree.GetChildren("c"), ElementsAre());
+  EXPECT_THAT(tree.GetDescendants("a"), ElementsAre("c", "d"));
+  EXPECT_THAT(tree.GetDescendants("root"),
+              ElementsAre("a", "b", "c", "d", "e"));
+}
+
+TEST(PayloadRelayTreeTest, SurvivesHeaderRoundTrip) {
+  PayloadRelayTree::PayloadHeader header;
+  PayloadRelayTree::Build("root", {"a", "b", "c"}, kFanOut)
+      .AddToHeader(header);
+
+  PayloadRelayTree tree = PayloadRelayTree::FromHeader(header);
+
+  EXPECT_EQ(header.relay_nodes_size(), 3);
+  EXPECT_EQ(header.relay_origin_endpoint_id(), "root");
+  EXPECT_EQ(tree.GetRoot(), "root");
+  EXPECT_THAT(tree.GetChildren("root"), ElementsAre("a", "b"));
+  EXPECT_THAT(tree.GetChildren("a"), ElementsAre("c"));
+}
+
+TEST(PayloadRelayTreeTest, EmptyWithoutRelayNodes) {
+  EXPECT_TRUE(
+      PayloadRelayTree::FromHeader(PayloadRelayTree::PayloadHeader()).Empty());
+}
+
+TEST(PayloadRelayTreeTest, DescendantsIgnoreCycles) {
+  PayloadRelayTree::PayloadHeader header;
+  auto* node = header.add_relay_nodes();
+  node->set_endpoint_id("a");
+  node->set_parent_endpoint_id("b");
+  node = header.add_relay_nodes();
+  node->set_endpoint_id("b");
+  node->set_parent_endpoint_id("a");
+
+  EXPECT_THAT(PayloadRelayTree::FromHeader(header).GetDescendants("a"),
+              ElementsAre("b"));
+}
+
+TEST(PayloadRelayTreeTest, ChildOfItsParentOnly) {
+  PayloadRelayTree tree =
+      PayloadRelayTree::Build("root", {"a", "b", "c", "d", "e"}, kFanOut);
+
+  EXPECT_TRUE(tree.IsChildOf("a", "root"));
+  EXPECT_TRUE(tree.IsChildOf("e", "b"));
+  EXPECT_FALSE(tree.IsChildOf("e", "a"));
+  EXPECT_FALSE(tree.IsChildOf("root", "a"));
+  EXPECT_FALSE(tree.IsChildOf("x", "a"));
+}
+
+TEST(PayloadRelayTreeTest, NotChildOfMalformedTree) {
+  auto add_node = [](PayloadRelayTree::PayloadHeader& header,
+                     const std::string& endpoint_id,
+                     const std::string& parent_endpoint_id) {
+    auto* node = header.add_relay_nodes();
+    node->set_endpoint_id(endpoint_id);
+    node->set_parent_endpoint_id(parent_endpoint_id);
+  };
+  PayloadRelayTree::PayloadHeader no_origin;
+  add_node(no_origin, "a", "root");
+  PayloadRelayTree::PayloadHeader listed_twice;
+  listed_twice.set_relay_origin_endpoint_id("root");
+  add_node(listed_twice, "a", "root");
+  add_node(listed_twice, "b", "a");
+  add_node(listed_twice, "b", "root");
+  PayloadRelayTree::PayloadHeader cycle;
+  cycle.set_relay_origin_endpoint_id("root");
+  add_node(cycle, "a", "b");
+  add_node(cycle, "b", "a");
+  PayloadRelayTree::PayloadHeader origin_below;
+  origin_below.set_relay_origin_endpoint_id("root");
+  add_node(origin_below, "a", "root");
+  add_node(origin_below, "root", "a");
+
+  EXPECT_FALSE(PayloadRelayTree::FromHeader(no_origin).IsChildOf("a", "root"));
+  EXPECT_FALSE(
+      PayloadRelayTree::FromHeader(listed_twice).IsChildOf("b", "root"));
+  EXPECT_FALSE(PayloadRelayTree::FromHeader(cycle).IsChildOf("a", "b"));
+  EXPECT_FALSE(
+      PayloadRelayTree::FromHeader(origin_below).IsChildOf("a", "root"));
+}
+
+TEST(PayloadRelayTrackerTest, ReportsDeliveredAndFailedDescendants) {
+  PayloadRelayTracker tracker;
+  tracker.Start(1, MakeRelay(), {"a", "b"});
+
+  std::optional<PayloadRelayTracker::ChildResult> result =
+      tracker.OnChildDone(1, "a", {"d"}, /*child_failed=*/false);
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->child_endpoint_id, "a");
+  EXPECT_THAT(result->delivered_endpoint_ids, ElementsAre("a", "c"));
+  EXPECT_THAT(result->failed_endpoint_ids, ElementsAre("d"));
+  EXPECT_FALSE(result->all_failed_endpoint_ids.has_value());
+  EXPECT_NE(tracker.GetRelay(1), nullptr);
+}
+
+TEST(PayloadRelayTrackerTest, FinishesOnceEveryChildIsDone) {
+  PayloadRelayTracker tracker;
+  tracker.Start(1, MakeRelay(), {"a", "b"});
+  tracker.OnChildDone(1, "a", {"d"}, /*child_failed=*/false);
+
+  std::optional<PayloadRelayTracker::ChildResult> result =
+      tracker.OnChildDone(1, "b", {}, /*child_failed=*/true);
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_THAT(result->failed_endpoint_ids, ElementsAre("b", "e"));
+  ASSERT_TRUE(result->all_failed_endpoint_ids.has_value());
+  EXPECT_THAT(*result->all_failed_endpoint_ids,
+              UnorderedElementsAre("d", "b", "e"));
+  EXPECT_EQ(tracker.GetRelay(1), nullptr);
+}
+
+TEST(PayloadRelayTrackerTest, IgnoresUnknownChildren) {
+  PayloadRelayTracker tracker;
+  tracker.Start(1, MakeRelay(), {"a", "b"});
+
+  EXPECT_FALSE(tracker.OnChildDone(1, "c", {}, false).has_value());
+  EXPECT_FALSE(tracker.OnChildDone(2, "a", {}, false).has_value());
+  EXPECT_TRUE(tracker.OnChildDone(1, "a", {}, false).has_value());
+  EXPECT_FALSE(tracker.OnChildDone(1, "a", {}, false).has_value());
+}
+
+TEST(PayloadRelayTrackerTest, ForwardingFailuresOnlyCountWhereForwarded) {
+  PayloadRelayTracker tracker;
+  tracker.Start(1, MakeRelay(), {"a", "b"});
+  auto forwarded = std::make_shared<PayloadRelayTracker::Relay>(*MakeRelay());
+  forwarded->parent_endpoint_id = "root";
+  tracker.Start(2, forwarded, {"c", "d"});
+
+  EXPECT_FALSE(tracker.OnForwardingFailed(1, "a").has_value());
+  std::optional<PayloadRelayTracker::ChildResult> result =
+      tracker.OnForwardingFailed(2, "c");
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_THAT(result->failed_endpoint_ids, ElementsAre("c"));
+}
+
+TEST(PayloadRelayTrackerTest, DisconnectFailsPendingChild) {
+  PayloadRelayTracker tracker;
+  tracker.Start(1, MakeRelay(), {"a", "b"});
+  tracker.Start(2, MakeRelay(), {"b"});
+
+  std::vector<PayloadRelayTracker::ChildResult> results =
+      tracker.OnEndpointDisconnected("b");
+
+  ASSERT_EQ(results.size(), 2);
+  for (const auto& result : results) {
+    EXPECT_EQ(result.child_endpoint_id, "b");
+    EXPECT_THAT(result.failed_endpoint_ids, ElementsAre("b", "e"));
+  }
+  EXPECT_NE(tracker.GetRelay(1), nullptr);
+  EXPECT_EQ(tracker.GetRelay(2), nullptr);
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
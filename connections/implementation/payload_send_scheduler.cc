@@ -0,0 +1,127 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/payload_send_scheduler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "internal/platform/mutex_lock.h"
+#include "internal/platform/system_clock.h"
+
+namespace nearby {
+namespace connections {
+
+absl::flat_hash_map<std::string, int> PayloadSendScheduler::ParseWeights(
+    absl::string_view weights) {
+  absl::flat_hash_map<std::string, int> parsed;
+  for (absl::string_view entry :
+       absl::StrSplit(weights, ',', absl::SkipWhitespace())) {
+    std::pair<absl::string_view, absl::string_view> service_and_weight =
+        absl::StrSplit(entry, absl::MaxSplits(':', 1));
+    int weight;
+    if (!absl::SimpleAtoi(service_and_weight.second, &weight) || weight <= 0) {
+      continue;
+    }
+    parsed[absl::StripAsciiWhitespace(service_and_weight.first)] = weight;
+  }
+  return parsed;
+}
+
+void PayloadSendScheduler::StartTurn(absl::string_view channel_id,
+                                     absl::string_view flow_id, int weight,
+                                     std::int64_t size) {
+  MutexLock lock(&mutex_);
+  std::unique_ptr<Channel>& channel_ptr = channels_[channel_id];
+  if (channel_ptr == nullptr) channel_ptr = std::make_unique<Channel>();
+  // Unlike the map entry, the channel stays put while waiting.
+  Channel& channel = *channel_ptr;
+  Flow& flow = channel.flows[flow_id];
+  double start_tag = std::max(channel.virtual_time, flow.finish_tag);
+  flow.last_cost = static_cast<double>(size) / std::max(weight, 1);
+  flow.finish_tag = start_tag + flow.last_cost;
+  flow.waiting++;
+  Ticket ticket = {flow.finish_tag, next_ticket_++};
+  channel.waiting.insert(ticket);
+
+  while (true) {
+    if (!channel.writing) {
+      if (channel.reserved_flow_id == flow_id) break;
+      absl::Time now = SystemClock::ElapsedRealtime();
+      if (!channel.reserved_flow_id.empty() && now < channel.reserved_until) {
+        turn_changed_.Wait(channel.reserved_until - now);
+        continue;
+      }
+      if (*channel.waiting.begin() == ticket) break;
+    }
+    turn_changed_.Wait();
+  }
+
+  channel.waiting.erase(ticket);
+  // |flow| may have been rehashed away from while waiting.
+  channel.flows[flow_id].waiting--;
+  channel.writing = true;
+  channel.reserved_flow_id.clear();
+  channel.virtual_time = std::max(channel.virtual_time, start_tag);
+}
+
+void PayloadSendScheduler::EndTurn(absl::string_view channel_id,
+                                   absl::string_view flow_id, bool more) {
+  MutexLock lock(&mutex_);
+  auto channel_it = channels_.find(channel_id);
+  if (channel_it == channels_.end()) return;
+  Channel& channel = *channel_it->second;
+  channel.writing = false;
+  auto it = channel.flows.find(flow_id);
+  if (more && it != channel.flows.end() && !channel.waiting.empty()) {
+    // Assume the next chunk costs as much as this one.
+    double next_finish_tag =
+        std::max(channel.virtual_time, it->second.finish_tag) +
+        it->second.last_cost;
+    if (next_finish_tag <= channel.waiting.begin()->first) {
+      channel.reserved_flow_id = std::string(flow_id);
+      channel.reserved_until =
+          SystemClock::ElapsedRealtime() + kTurnReservation;
+    }
+  }
+  PruneFlows(channel);
+  if (channel.flows.empty()) channels_.erase(channel_it);
+  turn_changed_.Notify();
+}
+
+void PayloadSendScheduler::PruneFlows(Channel& channel) {
+  std::vector<std::string> idle_flow_ids;
+  for (const auto& [flow_id, flow] : channel.flows) {
+    if (flow.waiting == 0 && flow.finish_tag <= channel.virtual_time &&
+        flow_id != channel.reserved_flow_id) {
+      idle_flow_ids.push_back(flow_id);
+    }
+  }
+  for (const std::string& flow_id : idle_flow_ids) {
+    channel.flows.erase(flow_id);
+  }
+}
+
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,103 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_PAYLOAD_SEND_SCHEDULER_H_
+#define CORE_INTERNAL_PAYLOAD_SEND_SCHEDULER_H_
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "internal/platform/condition_variable.h"
+#include "internal/platform/mutex.h"
+
+namespace nearby {
+namespace connections {
+
+// Takes turns writing outgoing payload chunks between flows, using weighted
+// fair queuing: a flow that has chunks waiting gets a share of the writes to a
+// channel, in bytes, in proportion to its weight, however large its payloads
+// are.
+//
+// Only one chunk is written at a time to each channel, while chunks to other
+// channels are written alongside it. A flow that just wrote a chunk, and is
+// next in line with its following one, keeps its turn for up to
+// kTurnReservation while its sender reads that chunk. Without it, a sender
+// with one chunk in flight would always find the others already waiting, and
+// every flow would get the same share.
+//
+// Thread-safe.
+class PayloadSendScheduler {
+ public:
+  static constexpr absl::Duration kTurnReservation = absl::Milliseconds(10);
+
+  // Parses weights in the form "service_id:weight,service_id:weight". Entries
+  // that don't parse, or whose weight isn't positive, are left out.
+  static absl::flat_hash_map<std::string, int> ParseWeights(
+      absl::string_view weights);
+
+  // Blocks until |flow_id| may write a chunk of |size| bytes to |channel_id|.
+  void StartTurn(absl::string_view channel_id, absl::string_view flow_id,
+                 int weight, std::int64_t size);
+
+  // Called once the chunk is written. |more| is whether |flow_id| has another
+  // chunk to send to |channel_id| after it.
+  void EndTurn(absl::string_view channel_id, absl::string_view flow_id,
+               bool more);
+
+ private:
+  struct Flow {
+    // The virtual time by which the flow's last queued chunk is written.
+    double finish_tag = 0;
+    // Virtual time taken by the flow's last queued chunk.
+    double last_cost = 0;
+    int waiting = 0;
+  };
+  // Finish tag and arrival order of a waiting chunk.
+  using Ticket = std::pair<double, std::int64_t>;
+
+  // The flows writing to one channel, which take turns with each other only.
+  struct Channel {
+    absl::flat_hash_map<std::string, Flow> flows;
+    std::set<Ticket> waiting;
+    // Start tag of the chunk written last.
+    double virtual_time = 0;
+    bool writing = false;
+    // Empty when no flow holds on to its turn.
+    std::string reserved_flow_id;
+    absl::Time reserved_until;
+  };
+
+  // Forgets the idle flows of |channel| that a new chunk would be queued for
+  // as if they were new anyway.
+  static void PruneFlows(Channel& channel);
+
+  Mutex mutex_;
+  ConditionVariable turn_changed_{&mutex_};
+  // Channels are forgotten once they have no flows left.
+  absl::flat_hash_map<std::string, std::unique_ptr<Channel>> channels_
+      ABSL_GUARDED_BY(mutex_);
+  std::int64_t next_ticket_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_PAYLOAD_SEND_SCHEDULER_H_
@@ -0,0 +1,115 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/payload_send_scheduler.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "internal/platform/count_down_latch.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/mutex_lock.h"
+#include "internal/platform/single_thread_executor.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+constexpr absl::string_view kChannelId = "endpoint";
+constexpr int kChunkSize = 1024;
+constexpr int kChunks = 40;
+
+TEST(PayloadSendSchedulerTest, ParsesWeights) {
+  EXPECT_THAT(PayloadSendScheduler::ParseWeights(
+                  "com.example.a:3, com.example.b:1,bad,com.example.c:0"),
+              UnorderedElementsAre(Pair("com.example.a", 3),
+                                   Pair("com.example.b", 1)));
+}
+
+TEST(PayloadSendSchedulerTest, LoneFlowNeverWaits) {
+  PayloadSendScheduler scheduler;
+
+  for (int i = 0; i < kChunks; ++i) {
+    scheduler.StartTurn(kChannelId, "a", 1, kChunkSize);
+    scheduler.EndTurn(kChannelId, "a", /*more=*/i + 1 < kChunks);
+  }
+}
+
+TEST(PayloadSendSchedulerTest, SharesWritesByWeight) {
+  PayloadSendScheduler scheduler;
+  Mutex mutex;
+  std::vector<std::string> writes;
+  CountDownLatch done(2);
+  auto send = [&](const std::string& flow_id, int weight) {
+    for (int i = 0; i < kChunks; ++i) {
+      scheduler.StartTurn(kChannelId, flow_id, weight, kChunkSize);
+      {
+        MutexLock lock(&mutex);
+        writes.push_back(flow_id);
+      }
+      // Writing a chunk takes a while.
+      absl::SleepFor(absl::Milliseconds(1));
+      scheduler.EndTurn(kChannelId, flow_id, /*more=*/i + 1 < kChunks);
+    }
+    done.CountDown();
+  };
+
+  // Hold the first turn until both flows are waiting.
+  scheduler.StartTurn(kChannelId, "blocker", 1, kChunkSize);
+  SingleThreadExecutor a;
+  SingleThreadExecutor b;
+  a.Execute([&]() { send("a", 3); });
+  b.Execute([&]() { send("b", 1); });
+  absl::SleepFor(absl::Milliseconds(100));
+  scheduler.EndTurn(kChannelId, "blocker", /*more=*/false);
+  EXPECT_TRUE(done.Await(absl::Seconds(10)).result());
+
+  MutexLock lock(&mutex);
+  ASSERT_EQ(writes.size(), 2 * kChunks);
+  // While both have chunks to send, "a" writes three for every one of "b".
+  std::vector<std::string> first_writes(writes.begin(),
+                                        writes.begin() + kChunks);
+  EXPECT_GE(std::count(first_writes.begin(), first_writes.end(), "a"),
+            kChunks * 3 / 4 - 4);
+}
+
+TEST(PayloadSendSchedulerTest, OtherChannelsDontWait) {
+  PayloadSendScheduler scheduler;
+  CountDownLatch done(1);
+
+  // A chunk is still being written to "endpoint".
+  scheduler.StartTurn(kChannelId, "a", 1, kChunkSize);
+  SingleThreadExecutor other;
+  other.Execute([&]() {
+    scheduler.StartTurn("other-endpoint", "b", 1, kChunkSize);
+    scheduler.EndTurn("other-endpoint", "b", /*more=*/false);
+    done.CountDown();
+  });
+
+  EXPECT_TRUE(done.Await(absl::Seconds(10)).result());
+  scheduler.EndTurn(kChannelId, "a", /*more=*/false);
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
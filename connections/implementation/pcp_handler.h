@@ -76,6 +76,12 @@ class PcpHandler {
   // otherwise do nothing.
   virtual void StopAdvertising(ClientProxy* client) = 0;
 
+  // If Advertising is active for service_id, moves it to advertising_options,
+  // only restarting the mediums whose parameters changed.
+  virtual Status UpdateAdvertisingOptions(
+      ClientProxy* client, absl::string_view service_id,
+      const AdvertisingOptions& advertising_options) = 0;
+
   // Start discovery of endpoints that may be advertising.
   // Update ClientProxy state once discovery started.
   // DiscoveryListener will get called in case of any event.
@@ -88,6 +94,12 @@ class PcpHandler {
   // otherwise do nothing.
   virtual void StopDiscovery(ClientProxy* client) = 0;
 
+  // If Discovery is active for service_id, moves it to discovery_options,
+  // only restarting the mediums whose parameters changed.
+  virtual Status UpdateDiscoveryOptions(
+      ClientProxy* client, absl::string_view service_id,
+      const DiscoveryOptions& discovery_options) = 0;
+
   virtual std::pair<Status, std::vector<ConnectionInfoVariant>>
   StartListeningForIncomingConnections(
       ClientProxy* client, absl::string_view service_id,
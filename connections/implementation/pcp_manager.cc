@@ -72,6 +72,17 @@ void PcpManager::StopAdvertising(ClientProxy* client) {
   }
 }
 
+Status PcpManager::UpdateAdvertisingOptions(
+    ClientProxy* client, absl::string_view service_id,
+    const AdvertisingOptions& advertising_options) {
+  if (!current_) {
+    return {Status::kOutOfOrderApiCall};
+  }
+
+  return current_->UpdateAdvertisingOptions(client, service_id,
+                                            advertising_options);
+}
+
 Status PcpManager::StartDiscovery(ClientProxy* client, const string& service_id,
                                   const DiscoveryOptions& discovery_options,
                                   DiscoveryListener listener) {
@@ -89,6 +100,17 @@ void PcpManager::StopDiscovery(ClientProxy* client) {
   }
 }
 
+Status PcpManager::UpdateDiscoveryOptions(
+    ClientProxy* client, absl::string_view service_id,
+    const DiscoveryOptions& discovery_options) {
+  if (!current_) {
+    return {Status::kOutOfOrderApiCall};
+  }
+
+  return current_->UpdateDiscoveryOptions(client, service_id,
+                                          discovery_options);
+}
+
 std::pair<Status, std::vector<ConnectionInfoVariant>>
 PcpManager::StartListeningForIncomingConnections(
     ClientProxy* client, absl::string_view service_id,
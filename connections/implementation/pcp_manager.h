@@ -51,11 +51,17 @@ class PcpManager {
                           const AdvertisingOptions& advertising_options,
                           const ConnectionRequestInfo& info);
   void StopAdvertising(ClientProxy* client);
+  Status UpdateAdvertisingOptions(
+      ClientProxy* client, absl::string_view service_id,
+      const AdvertisingOptions& advertising_options);
 
   Status StartDiscovery(ClientProxy* client, const string& service_id,
                         const DiscoveryOptions& discovery_options,
                         DiscoveryListener listener);
   void StopDiscovery(ClientProxy* client);
+  Status UpdateDiscoveryOptions(ClientProxy* client,
+                                absl::string_view service_id,
+                                const DiscoveryOptions& discovery_options);
 
   std::pair<Status, std::vector<ConnectionInfoVariant>>
   StartListeningForIncomingConnections(
@@ -0,0 +1,75 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/round_robin_executor.h"
+
+#include <deque>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "internal/platform/mutex_lock.h"
+#include "internal/platform/runnable.h"
+
+namespace nearby {
+namespace connections {
+
+RoundRobinExecutor::RoundRobinExecutor(int max_parallelism)
+    : pool_(max_parallelism) {}
+
+RoundRobinExecutor::RoundRobinExecutor(int max_parallelism,
+                                       api::ExecutorQos qos)
+    : pool_(max_parallelism, qos) {}
+
+void RoundRobinExecutor::Execute(absl::string_view key, absl::string_view name,
+                                 Runnable&& runnable) {
+  {
+    MutexLock lock(&mutex_);
+    std::deque<Runnable>& tasks = tasks_[key];
+    if (tasks.empty()) turns_.emplace_back(key);
+    tasks.push_back(std::move(runnable));
+  }
+  // Each task queues one run on the pool, which picks the task to run only
+  // once it starts.
+  pool_.Execute(name, [this]() { RunNext(); });
+}
+
+void RoundRobinExecutor::Shutdown() {
+  pool_.Shutdown();
+  MutexLock lock(&mutex_);
+  tasks_.clear();
+  turns_.clear();
+}
+
+void RoundRobinExecutor::RunNext() {
+  Runnable runnable;
+  {
+    MutexLock lock(&mutex_);
+    if (turns_.empty()) return;
+    std::string key = std::move(turns_.front());
+    turns_.pop_front();
+    auto it = tasks_.find(key);
+    runnable = std::move(it->second.front());
+    it->second.pop_front();
+    if (it->second.empty()) {
+      tasks_.erase(it);
+    } else {
+      turns_.push_back(std::move(key));
+    }
+  }
+  runnable();
+}
+
+}  // namespace connections
+}  // namespace nearby
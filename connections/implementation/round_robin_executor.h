@@ -0,0 +1,66 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_ROUND_ROBIN_EXECUTOR_H_
+#define CORE_INTERNAL_ROUND_ROBIN_EXECUTOR_H_
+
+#include <deque>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "internal/platform/implementation/executor.h"
+#include "internal/platform/multi_thread_executor.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/runnable.h"
+
+namespace nearby {
+namespace connections {
+
+// Runs tasks on a pool of |max_parallelism| threads, taking turns between
+// keys: whenever a thread frees up, it runs the oldest task of the next key
+// with tasks waiting. A key with many queued tasks thus doesn't hold up the
+// tasks of the other keys, as it would in the pool's FIFO queue. Tasks of the
+// same key start in the order they were added.
+//
+// Thread-safe.
+class RoundRobinExecutor {
+ public:
+  explicit RoundRobinExecutor(int max_parallelism);
+  RoundRobinExecutor(int max_parallelism, api::ExecutorQos qos);
+
+  // Queues |runnable| behind the other tasks of |key|.
+  void Execute(absl::string_view key, absl::string_view name,
+               Runnable&& runnable);
+
+  // Shuts down the pool, then drops the tasks it didn't get to.
+  void Shutdown();
+
+ private:
+  // Runs the oldest task of the key whose turn it is.
+  void RunNext();
+
+  Mutex mutex_;
+  absl::flat_hash_map<std::string, std::deque<Runnable>> tasks_
+      ABSL_GUARDED_BY(mutex_);
+  // The keys with tasks waiting, the one whose turn it is first.
+  std::deque<std::string> turns_ ABSL_GUARDED_BY(mutex_);
+  MultiThreadExecutor pool_;
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_ROUND_ROBIN_EXECUTOR_H_
@@ -0,0 +1,69 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/round_robin_executor.h"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "internal/platform/count_down_latch.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/mutex_lock.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(RoundRobinExecutorTest, TakesTurnsBetweenKeys) {
+  RoundRobinExecutor executor(1);
+  CountDownLatch blocked(1);
+  CountDownLatch release(1);
+  CountDownLatch done(5);
+  Mutex mutex;
+  std::vector<std::string> order;
+  auto record = [&](std::string task) {
+    return [&, task]() {
+      {
+        MutexLock lock(&mutex);
+        order.push_back(task);
+      }
+      done.CountDown();
+    };
+  };
+
+  executor.Execute("blocker", "blocker", [&]() {
+    blocked.CountDown();
+    release.Await();
+  });
+  ASSERT_TRUE(blocked.Await(absl::Seconds(1)).result());
+  executor.Execute("a", "task", record("a1"));
+  executor.Execute("a", "task", record("a2"));
+  executor.Execute("a", "task", record("a3"));
+  executor.Execute("b", "task", record("b1"));
+  executor.Execute("b", "task", record("b2"));
+  release.CountDown();
+
+  ASSERT_TRUE(done.Await(absl::Seconds(1)).result());
+  MutexLock lock(&mutex);
+  EXPECT_THAT(order, ElementsAre("a1", "b1", "a2", "b2", "a3"));
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
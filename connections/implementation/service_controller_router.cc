@@ -18,8 +18,10 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/types/span.h"
 #include "connections/implementation/client_proxy.h"
 #include "connections/implementation/offline_service_controller.h"
 #include "connections/listeners.h"
@@ -29,7 +31,9 @@
 #include "connections/v3/connection_result.h"
 #include "connections/v3/connections_device.h"
 #include "connections/v3/listening_result.h"
+#include "internal/platform/count_down_latch.h"
 #include "internal/platform/logging.h"
+#include "internal/platform/mutex_lock.h"
 
 // TODO(b/285657711): Add tests for uncovered logic, even if trivial.
 namespace nearby {
@@ -88,11 +92,25 @@ ServiceControllerRouter::ServiceControllerRouter() {
 ServiceControllerRouter::~ServiceControllerRouter() {
   NEARBY_LOGS(INFO) << "ServiceControllerRouter going down.";
 
-  if (service_controller_) {
-    service_controller_->Stop();
+  ServiceController* service_controller;
+  {
+    MutexLock lock(&service_controller_mutex_);
+    service_controller = service_controller_.get();
+  }
+  if (service_controller) {
+    service_controller->Stop();
   }
   // And make sure that cleanup is the last thing we do.
   serializer_.Shutdown();
+  absl::flat_hash_map<ClientProxy*, std::unique_ptr<SingleThreadExecutor>>
+      client_serializers;
+  {
+    MutexLock lock(&client_serializers_mutex_);
+    client_serializers = std::move(client_serializers_);
+  }
+  for (auto& [client, client_serializer] : client_serializers) {
+    client_serializer->Shutdown();
+  }
 }
 
 void ServiceControllerRouter::StartAdvertising(
@@ -297,29 +315,30 @@ void ServiceControllerRouter::SendPayload(
   const std::vector<std::string> endpoints =
       std::vector<std::string>(endpoint_ids.begin(), endpoint_ids.end());
 
-  RouteToServiceController("scr-send-payload", [this, client,
-                                                payload = std::move(payload),
-                                                endpoints, callback]() mutable {
-    if (!ClientHasConnectionToAtLeastOneEndpoint(client, endpoints)) {
-      callback.result_cb({Status::kEndpointUnknown});
-      return;
-    }
+  RoutePayloadToServiceController(
+      client, "scr-send-payload", [this, client, payload = std::move(payload),
+                           endpoints, callback]() mutable {
+        if (!ClientHasConnectionToAtLeastOneEndpoint(client, endpoints)) {
+          callback.result_cb({Status::kEndpointUnknown});
+          return;
+        }
 
-    GetServiceController()->SendPayload(client, endpoints, std::move(payload));
+        GetServiceController()->SendPayload(client, endpoints,
+                                            std::move(payload));
 
-    // At this point, we've queued up the send Payload request with the
-    // ServiceController; any further failures (e.g. one of the endpoints is
-    // unknown, goes away, or otherwise fails) will be returned to the
-    // client as a PayloadTransferUpdate.
-    callback.result_cb({Status::kSuccess});
-  });
+        // At this point, we've queued up the send Payload request with the
+        // ServiceController; any further failures (e.g. one of the endpoints
+        // is unknown, goes away, or otherwise fails) will be returned to the
+        // client as a PayloadTransferUpdate.
+        callback.result_cb({Status::kSuccess});
+      });
 }
 
 void ServiceControllerRouter::CancelPayload(ClientProxy* client,
                                             std::uint64_t payload_id,
                                             const ResultCallback& callback) {
-  RouteToServiceController(
-      "scr-cancel-payload", [this, client, payload_id, callback]() {
+  RoutePayloadToServiceController(
+      client, "scr-cancel-payload", [this, client, payload_id, callback]() {
         callback.result_cb(
             GetServiceController()->CancelPayload(client, payload_id));
       });
@@ -346,6 +365,66 @@ void ServiceControllerRouter::DisconnectFromEndpoint(
       });
 }
 
+void ServiceControllerRouter::AcceptConnections(
+    ClientProxy* client,
+    std::vector<std::pair<std::string, PayloadListener>> connections,
+    const ResultCallback& callback) {
+  RouteToServiceController(
+      "scr-accept-connections",
+      [this, client, connections = std::move(connections),
+       callback]() mutable {
+        Status result = {Status::kSuccess};
+        for (auto& [endpoint_id, listener] : connections) {
+          Status status;
+          if (client->IsConnectedToEndpoint(endpoint_id)) {
+            status = {Status::kAlreadyConnectedToEndpoint};
+          } else if (client->HasLocalEndpointResponded(endpoint_id)) {
+            NEARBY_LOGS(WARNING)
+                << "Client " << client->GetClientId()
+                << " invoked acceptConnectionRequest() after having already "
+                   "accepted/rejected the connection to endpoint(id="
+                << endpoint_id << ")";
+            status = {Status::kOutOfOrderApiCall};
+          } else {
+            status = GetServiceController()->AcceptConnection(
+                client, endpoint_id, std::move(listener));
+          }
+          if (result.Ok() && !status.Ok()) {
+            result = status;
+          }
+        }
+        callback.result_cb(result);
+      });
+}
+
+void ServiceControllerRouter::DisconnectFromEndpoints(
+    ClientProxy* client, absl::Span<const std::string> endpoint_ids,
+    const ResultCallback& callback) {
+  for (const std::string& endpoint_id : endpoint_ids) {
+    client->CancelEndpoint(endpoint_id);
+  }
+
+  RouteToServiceController(
+      "scr-disconnect-endpoints",
+      [this, client,
+       endpoint_ids =
+           std::vector<std::string>(endpoint_ids.begin(), endpoint_ids.end()),
+       callback]() {
+        Status result = {Status::kSuccess};
+        for (const std::string& endpoint_id : endpoint_ids) {
+          if (!client->IsConnectedToEndpoint(endpoint_id) &&
+              !client->HasPendingConnectionToEndpoint(endpoint_id)) {
+            if (result.Ok()) {
+              result = {Status::kOutOfOrderApiCall};
+            }
+            continue;
+          }
+          GetServiceController()->DisconnectFromEndpoint(client, endpoint_id);
+        }
+        callback.result_cb(result);
+      });
+}
+
 void ServiceControllerRouter::StartListeningForIncomingConnectionsV3(
     ClientProxy* client, absl::string_view service_id,
     v3::ConnectionListener listener,
@@ -499,18 +578,22 @@ void ServiceControllerRouter::AcceptConnectionV3(
           return;
         }
 
+        // The listener only hears about this endpoint, so the device is
+        // looked up once rather than for every payload and progress update.
+        std::shared_ptr<const v3::ConnectionsDevice> remote_device =
+            client->GetRemoteDevice(endpoint_id);
         PayloadListener old_listener = {
             .payload_cb =
-                [v3_received = std::move(v3_listener.payload_received_cb)](
-                    absl::string_view endpoint_id, Payload payload) {
-                  v3_received(v3::ConnectionsDevice(endpoint_id, "", {}),
-                              std::move(payload));
+                [v3_received = std::move(v3_listener.payload_received_cb),
+                 remote_device](absl::string_view endpoint_id,
+                                Payload payload) {
+                  v3_received(*remote_device, std::move(payload));
                 },
             .payload_progress_cb =
-                [v3_cb = std::move(v3_listener.payload_progress_cb)](
-                    absl::string_view endpoint_id,
-                    const PayloadProgressInfo& info) mutable {
-                  v3_cb(v3::ConnectionsDevice(endpoint_id, "", {}), info);
+                [v3_cb = std::move(v3_listener.payload_progress_cb),
+                 remote_device](absl::string_view endpoint_id,
+                                const PayloadProgressInfo& info) mutable {
+                  v3_cb(*remote_device, info);
                 }};
 
         callback.result_cb(GetServiceController()->AcceptConnection(
@@ -568,8 +651,8 @@ void ServiceControllerRouter::InitiateBandwidthUpgradeV3(
 void ServiceControllerRouter::SendPayloadV3(
     ClientProxy* client, const NearbyDevice& recipient_device, Payload payload,
     const ResultCallback& callback) {
-  RouteToServiceController(
-      "scr-send-payload",
+  RoutePayloadToServiceController(
+      client, "scr-send-payload",
       [this, client, payload = std::move(payload),
        endpoint_id = recipient_device.GetEndpointId(), callback]() mutable {
         if (!client->IsConnectedToEndpoint(endpoint_id)) {
@@ -591,8 +674,8 @@ void ServiceControllerRouter::SendPayloadV3(
 void ServiceControllerRouter::CancelPayloadV3(
     ClientProxy* client, const NearbyDevice& recipient_device,
     uint64_t payload_id, const ResultCallback& callback) {
-  RouteToServiceController(
-      "scr-cancel-payload", [this, client, payload_id, callback]() {
+  RoutePayloadToServiceController(
+      client, "scr-cancel-payload", [this, client, payload_id, callback]() {
         callback.result_cb(
             GetServiceController()->CancelPayload(client, payload_id));
       });
@@ -653,6 +736,7 @@ void ServiceControllerRouter::StopAllEndpoints(ClientProxy* client,
                           << " has requested us to stop all endpoints. We will "
                              "now reset the client.";
         FinishClientSession(client);
+        FinishClientPayloads(client);
         callback.result_cb({Status::kSuccess});
       });
 }
@@ -673,10 +757,12 @@ void ServiceControllerRouter::SetCustomSavePath(
 
 void ServiceControllerRouter::SetServiceControllerForTesting(
     std::unique_ptr<ServiceController> service_controller) {
+  MutexLock lock(&service_controller_mutex_);
   service_controller_ = std::move(service_controller);
 }
 
 ServiceController* ServiceControllerRouter::GetServiceController() {
+  MutexLock lock(&service_controller_mutex_);
   if (!service_controller_) {
     service_controller_ = std::make_unique<OfflineServiceController>();
   }
@@ -707,5 +793,32 @@ void ServiceControllerRouter::RouteToServiceController(const std::string& name,
   serializer_.Execute(name, std::move(runnable));
 }
 
+void ServiceControllerRouter::RoutePayloadToServiceController(
+    ClientProxy* client, const std::string& name, Runnable runnable) {
+  MutexLock lock(&client_serializers_mutex_);
+  std::unique_ptr<SingleThreadExecutor>& client_serializer =
+      client_serializers_[client];
+  if (!client_serializer) {
+    client_serializer = std::make_unique<SingleThreadExecutor>();
+  }
+  client_serializer->Execute(name, std::move(runnable));
+}
+
+void ServiceControllerRouter::FinishClientPayloads(ClientProxy* client) {
+  std::unique_ptr<SingleThreadExecutor> client_serializer;
+  {
+    MutexLock lock(&client_serializers_mutex_);
+    auto it = client_serializers_.find(client);
+    if (it == client_serializers_.end()) return;
+    client_serializer = std::move(it->second);
+    client_serializers_.erase(it);
+  }
+  CountDownLatch latch(1);
+  client_serializer->Execute("scr-finish-client-payloads",
+                             [&latch]() { latch.CountDown(); });
+  latch.Await();
+  client_serializer->Shutdown();
+}
+
 }  // namespace connections
 }  // namespace nearby
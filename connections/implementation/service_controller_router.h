@@ -17,8 +17,11 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
@@ -31,6 +34,7 @@
 #include "connections/v3/listening_result.h"
 #include "connections/v3/params.h"
 #include "internal/interop/device.h"
+#include "internal/platform/mutex.h"
 #include "internal/platform/runnable.h"
 #include "internal/platform/single_thread_executor.h"
 
@@ -55,6 +59,11 @@ namespace connections {
 //    which makes locking unnecessary, when internal data is being manipulated.
 // 3) activity handlers are delegating much of their work to an implementation
 //    of a ServiceController interface, which does the actual job.
+//
+// Sending and canceling payloads only involves the PayloadManager, so those
+// are scheduled on an executor of each client instead. They don't wait behind
+// the activities that change the state of the radios, or behind the payloads
+// of other clients.
 class ServiceControllerRouter {
  public:
   ServiceControllerRouter();
@@ -117,6 +126,18 @@ class ServiceControllerRouter {
                                       absl::string_view endpoint_id,
                                       const ResultCallback& callback);
 
+  // Bulk variants of AcceptConnection() and DisconnectFromEndpoint(), handled
+  // as a single activity. Every endpoint is tried, and |callback| is called
+  // once, with kSuccess if all of them succeeded or with the status of the
+  // first one that failed.
+  virtual void AcceptConnections(
+      ClientProxy* client,
+      std::vector<std::pair<std::string, PayloadListener>> connections,
+      const ResultCallback& callback);
+  virtual void DisconnectFromEndpoints(
+      ClientProxy* client, absl::Span<const std::string> endpoint_ids,
+      const ResultCallback& callback);
+
   ////////////////////////////// V3 ////////////////////////////////////////////
   virtual void StartListeningForIncomingConnectionsV3(
       ClientProxy* client, absl::string_view service_id,
@@ -183,10 +204,22 @@ class ServiceControllerRouter {
   ServiceController* GetServiceController();
 
   void RouteToServiceController(const std::string& name, Runnable runnable);
+  // Like RouteToServiceController(), for the payload activities of |client|.
+  void RoutePayloadToServiceController(ClientProxy* client,
+                                       const std::string& name,
+                                       Runnable runnable);
+  // Runs the payload activities of |client| that were already scheduled, and
+  // drops its executor.
+  void FinishClientPayloads(ClientProxy* client);
   void FinishClientSession(ClientProxy* client);
 
-  std::unique_ptr<ServiceController> service_controller_;
+  Mutex service_controller_mutex_;
+  std::unique_ptr<ServiceController> service_controller_
+      ABSL_GUARDED_BY(service_controller_mutex_);
   SingleThreadExecutor serializer_;
+  Mutex client_serializers_mutex_;
+  absl::flat_hash_map<ClientProxy*, std::unique_ptr<SingleThreadExecutor>>
+      client_serializers_ ABSL_GUARDED_BY(client_serializers_mutex_);
 };
 
 }  // namespace connections
@@ -20,6 +20,7 @@
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "protobuf-matchers/protocol-buffer-matchers.h"
@@ -653,6 +654,65 @@ TEST_F(ServiceControllerRouterTest, DisconnectFromEndpointCalled) {
   DisconnectFromEndpoint(&client_, kRemoteEndpointId, kCallback);
 }
 
+TEST_F(ServiceControllerRouterTest, AcceptConnectionsReportsFirstFailure) {
+  StartDiscovery(&client_, kServiceId, kDiscoveryOptions, discovery_listener_,
+                 kCallback);
+  RequestConnection(&client_, kRemoteEndpointId, kConnectionRequestInfo,
+                    kCallback);
+  EXPECT_CALL(*mock_, AcceptConnection)
+      .WillOnce(Return(Status{Status::kSuccess}))
+      .WillOnce(Return(Status{Status::kEndpointUnknown}));
+  std::vector<std::pair<std::string, PayloadListener>> connections;
+  connections.emplace_back(kRemoteEndpointId, PayloadListener{});
+  connections.emplace_back("WXYZ", PayloadListener{});
+  {
+    MutexLock lock(&mutex_);
+    complete_ = false;
+    router_.AcceptConnections(&client_, std::move(connections), kCallback);
+    while (!complete_) cond_.Wait();
+    EXPECT_EQ(result_, Status{Status::kEndpointUnknown});
+  }
+}
+
+TEST_F(ServiceControllerRouterTest, DisconnectFromEndpointsCalled) {
+  StartDiscovery(&client_, kServiceId, kDiscoveryOptions, discovery_listener_,
+                 kCallback);
+  RequestConnection(&client_, kRemoteEndpointId, kConnectionRequestInfo,
+                    kCallback);
+  AcceptConnection(&client_, kRemoteEndpointId, kCallback);
+  // Only the connected endpoint is disconnected; the unknown one fails.
+  EXPECT_CALL(*mock_, DisconnectFromEndpoint).Times(1);
+  std::vector<std::string> endpoint_ids = {kRemoteEndpointId, "WXYZ"};
+  {
+    MutexLock lock(&mutex_);
+    complete_ = false;
+    router_.DisconnectFromEndpoints(&client_, endpoint_ids, kCallback);
+    while (!complete_) cond_.Wait();
+    EXPECT_EQ(result_, Status{Status::kOutOfOrderApiCall});
+  }
+}
+
+TEST_F(ServiceControllerRouterTest, PayloadsDoNotWaitForRadioActivities) {
+  CountDownLatch advertising_latch(1);
+  CountDownLatch advertising_done_latch(1);
+  EXPECT_CALL(*mock_, StartAdvertising)
+      .WillOnce([&advertising_latch]() {
+        advertising_latch.Await();
+        return Status{Status::kSuccess};
+      });
+  router_.StartAdvertising(
+      &client_, kServiceId, kAdvertisingOptions, kConnectionRequestInfo,
+      {.result_cb = [&advertising_done_latch](Status) {
+        advertising_done_latch.CountDown();
+      }});
+
+  // Canceling a payload completes while advertising is still starting.
+  CancelPayload(&client_, kPayloadId, kCallback);
+
+  advertising_latch.CountDown();
+  EXPECT_TRUE(advertising_done_latch.Await().Ok());
+}
+
 TEST_F(ServiceControllerRouterTest, RequestConnectionCalledV3) {
   // Either Advertising, or Discovery should be ongoing.
   StartDiscovery(&client_, kServiceId, kDiscoveryOptions, discovery_listener_,
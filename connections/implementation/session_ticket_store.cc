@@ -0,0 +1,78 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/session_ticket_store.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "internal/crypto/hkdf.h"
+#include "internal/platform/byte_array.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+constexpr absl::string_view kTicketSalt = "NearbyConnectionsSessionTicket";
+constexpr absl::string_view kTicketIdInfo = "TicketId";
+constexpr absl::string_view kTicketSecretInfo = "TicketSecret";
+constexpr int kTicketIdLength = 16;
+constexpr int kTicketSecretLength = 32;
+
+}  // namespace
+
+SessionTicket DeriveSessionTicket(absl::string_view session_unique,
+                                  absl::Time expiry) {
+  return {
+      .id = ByteArray(crypto::HkdfSha256(session_unique, kTicketSalt,
+                                         kTicketIdInfo, kTicketIdLength)),
+      .secret = ByteArray(crypto::HkdfSha256(session_unique, kTicketSalt,
+                                             kTicketSecretInfo,
+                                             kTicketSecretLength)),
+      .expiry = expiry,
+  };
+}
+
+void SessionTicketStore::Put(const std::string& key, SessionTicket ticket,
+                             absl::Time now) {
+  RemoveExpired(now);
+  tickets_.erase(key);
+  if (tickets_.size() >= kMaxTickets) {
+    auto oldest = tickets_.begin();
+    for (auto it = tickets_.begin(); it != tickets_.end(); ++it) {
+      if (it->second.expiry < oldest->second.expiry) oldest = it;
+    }
+    tickets_.erase(oldest);
+  }
+  tickets_.emplace(key, std::move(ticket));
+}
+
+std::optional<SessionTicket> SessionTicketStore::Take(const std::string& key,
+                                                      absl::Time now) {
+  auto node = tickets_.extract(key);
+  if (node.empty() || node.mapped().expiry <= now) return std::nullopt;
+  return std::move(node.mapped());
+}
+
+void SessionTicketStore::RemoveExpired(absl::Time now) {
+  absl::erase_if(tickets_, [now](const auto& entry) {
+    return entry.second.expiry <= now;
+  });
+}
+
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,72 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_SESSION_TICKET_STORE_H_
+#define CORE_INTERNAL_SESSION_TICKET_STORE_H_
+
+#include <optional>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "internal/platform/byte_array.h"
+
+namespace nearby {
+namespace connections {
+
+// A secret shared by both sides of an earlier encrypted connection, which
+// lets them derive the keys of a later connection without running UKEY2.
+struct SessionTicket {
+  // Identifies the ticket on the wire. Not secret.
+  ByteArray id;
+  // Never sent over the wire.
+  ByteArray secret;
+  absl::Time expiry;
+};
+
+// Derives a session ticket from the session unique of an established
+// D2DConnectionContextV1. Both sides of the connection derive the same ticket.
+SessionTicket DeriveSessionTicket(absl::string_view session_unique,
+                                  absl::Time expiry);
+
+// Keeps the session tickets of recently established connections. Each ticket
+// can be taken at most once, so that it is never used for two connections.
+//
+// Not thread-safe.
+class SessionTicketStore {
+ public:
+  static constexpr int kMaxTickets = 64;
+
+  // Remembers |ticket| under |key|, replacing any ticket stored before. If the
+  // store is full, the ticket closest to expiry is dropped first.
+  void Put(const std::string& key, SessionTicket ticket, absl::Time now);
+
+  // Removes and returns the ticket stored under |key|, if it hasn't expired
+  // by |now|.
+  std::optional<SessionTicket> Take(const std::string& key, absl::Time now);
+
+  void Clear() { tickets_.clear(); }
+  int Size() const { return tickets_.size(); }
+
+ private:
+  void RemoveExpired(absl::Time now);
+
+  absl::flat_hash_map<std::string, SessionTicket> tickets_;
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_SESSION_TICKET_STORE_H_
@@ -0,0 +1,84 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/session_ticket_store.h"
+
+#include <optional>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+constexpr absl::Time kNow = absl::FromUnixSeconds(1000);
+constexpr absl::string_view kSessionUnique = "session unique";
+
+TEST(SessionTicketStoreTest, DerivesSameTicketFromSameSession) {
+  SessionTicket ticket = DeriveSessionTicket(kSessionUnique, kNow);
+  SessionTicket other = DeriveSessionTicket(kSessionUnique, kNow);
+
+  EXPECT_EQ(ticket.id, other.id);
+  EXPECT_EQ(ticket.secret, other.secret);
+  EXPECT_NE(ticket.id, ticket.secret);
+  EXPECT_NE(ticket.id, DeriveSessionTicket("other session", kNow).id);
+}
+
+TEST(SessionTicketStoreTest, TicketCanOnlyBeTakenOnce) {
+  SessionTicketStore store;
+  SessionTicket ticket =
+      DeriveSessionTicket(kSessionUnique, kNow + absl::Minutes(1));
+  store.Put("endpoint", ticket, kNow);
+
+  std::optional<SessionTicket> taken = store.Take("endpoint", kNow);
+
+  ASSERT_TRUE(taken.has_value());
+  EXPECT_EQ(taken->id, ticket.id);
+  EXPECT_EQ(taken->secret, ticket.secret);
+  EXPECT_FALSE(store.Take("endpoint", kNow).has_value());
+}
+
+TEST(SessionTicketStoreTest, ExpiredTicketIsNotReturned) {
+  SessionTicketStore store;
+  store.Put("endpoint",
+            DeriveSessionTicket(kSessionUnique, kNow + absl::Minutes(1)), kNow);
+
+  EXPECT_FALSE(store.Take("endpoint", kNow + absl::Minutes(1)).has_value());
+  EXPECT_EQ(store.Size(), 0);
+}
+
+TEST(SessionTicketStoreTest, DropsTicketClosestToExpiryWhenFull) {
+  SessionTicketStore store;
+  for (int i = 0; i < SessionTicketStore::kMaxTickets; ++i) {
+    store.Put(absl::StrCat("endpoint", i),
+              DeriveSessionTicket(kSessionUnique, kNow + absl::Seconds(i + 1)),
+              kNow);
+  }
+
+  store.Put("new endpoint",
+            DeriveSessionTicket(kSessionUnique, kNow + absl::Minutes(10)),
+            kNow);
+
+  EXPECT_EQ(store.Size(), SessionTicketStore::kMaxTickets);
+  EXPECT_FALSE(store.Take("endpoint0", kNow).has_value());
+  EXPECT_TRUE(store.Take("endpoint1", kNow).has_value());
+  EXPECT_TRUE(store.Take("new endpoint", kNow).has_value());
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
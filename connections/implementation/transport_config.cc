@@ -0,0 +1,75 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/transport_config.h"
+
+#include <cstdint>
+#include <limits>
+
+#include "absl/time/time.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "internal/flags/flag.h"
+#include "internal/flags/nearby_flags.h"
+#include "internal/platform/feature_flags.h"
+
+namespace nearby {
+namespace connections {
+
+namespace {
+
+// Returns |flag|, or 0 if it isn't positive or doesn't fit in an int32_t.
+std::int32_t GetPositiveInt32Flag(const flags::Flag<int64_t>& flag) {
+  int64_t value = NearbyFlags::GetInstance().GetInt64Flag(flag);
+  return value > 0 && value <= std::numeric_limits<std::int32_t>::max()
+             ? static_cast<std::int32_t>(value)
+             : 0;
+}
+
+}  // namespace
+
+// Required for C++ 14 support in Chrome
+constexpr absl::Duration TransportConfig::kDefaultBwuClientIntroductionTimeout;
+
+TransportConfig TransportConfig::Get() {
+  namespace feature = config_package_nearby::nearby_connections_feature;
+  const FeatureFlags::Flags& feature_flags =
+      FeatureFlags::GetInstance().GetFlags();
+  TransportConfig config;
+  config.keep_alive_interval_millis = feature_flags.keep_alive_interval_millis;
+  config.keep_alive_timeout_millis = feature_flags.keep_alive_timeout_millis;
+
+  if (std::int32_t size =
+          GetPositiveInt32Flag(feature::kMaxTransmitPacketSizeBytes)) {
+    config.max_transmit_packet_size = size;
+  }
+  if (std::int32_t size = GetPositiveInt32Flag(feature::kMaxFrameSizeBytes)) {
+    config.max_frame_size = size;
+  }
+  std::int32_t interval =
+      GetPositiveInt32Flag(feature::kKeepAliveIntervalMillis);
+  std::int32_t timeout = GetPositiveInt32Flag(feature::kKeepAliveTimeoutMillis);
+  // Only take both, so that the interval stays below the timeout.
+  if (interval > 0 && timeout > interval) {
+    config.keep_alive_interval_millis = interval;
+    config.keep_alive_timeout_millis = timeout;
+  }
+  if (std::int32_t millis =
+          GetPositiveInt32Flag(feature::kBwuClientIntroductionTimeoutMillis)) {
+    config.bwu_client_introduction_timeout = absl::Milliseconds(millis);
+  }
+  return config;
+}
+
+}  // namespace connections
+}  // namespace nearby
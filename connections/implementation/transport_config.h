@@ -0,0 +1,55 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_TRANSPORT_CONFIG_H_
+#define CORE_INTERNAL_TRANSPORT_CONFIG_H_
+
+#include <cstdint>
+
+#include "absl/time/time.h"
+
+namespace nearby {
+namespace connections {
+
+// The transport parameters that tune throughput and liveness, e.g. the
+// packet and frame sizes of endpoint channels and the keep-alive defaults.
+//
+// Get() reads them from NearbyFlags every time, so callers read them once per
+// new connection or payload and pick up changed flags without a restart.
+struct TransportConfig {
+  static constexpr int kDefaultMaxTransmitPacketSize = 65536;  // 64 KB
+  static constexpr std::int32_t kDefaultMaxFrameSize = 1048576;  // 1MB
+  static constexpr absl::Duration kDefaultBwuClientIntroductionTimeout =
+      absl::Seconds(5);
+
+  // The packet size of mediums that don't define their own.
+  int max_transmit_packet_size = kDefaultMaxTransmitPacketSize;
+  // Used to sanity check that frame sizes are reasonable.
+  std::int32_t max_frame_size = kDefaultMaxFrameSize;
+  // Used when a connection doesn't ask for a valid keep-alive interval and
+  // timeout. Get() defaults them to FeatureFlags.
+  std::int32_t keep_alive_interval_millis = 0;
+  std::int32_t keep_alive_timeout_millis = 0;
+  absl::Duration bwu_client_introduction_timeout =
+      kDefaultBwuClientIntroductionTimeout;
+
+  // Returns the current config, with the built-in default for every flag that
+  // is unset or out of range.
+  static TransportConfig Get();
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_TRANSPORT_CONFIG_H_
@@ -0,0 +1,100 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/transport_config.h"
+
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "internal/flags/nearby_flags.h"
+#include "internal/platform/feature_flags.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+namespace feature = config_package_nearby::nearby_connections_feature;
+
+class TransportConfigTest : public ::testing::Test {
+ protected:
+  void TearDown() override {
+    NearbyFlags::GetInstance().ResetOverridedValues();
+  }
+};
+
+TEST_F(TransportConfigTest, UsesDefaultsWithoutFlags) {
+  TransportConfig config = TransportConfig::Get();
+
+  EXPECT_EQ(config.max_transmit_packet_size,
+            TransportConfig::kDefaultMaxTransmitPacketSize);
+  EXPECT_EQ(config.max_frame_size, TransportConfig::kDefaultMaxFrameSize);
+  EXPECT_EQ(config.keep_alive_interval_millis,
+            FeatureFlags::GetInstance().GetFlags().keep_alive_interval_millis);
+  EXPECT_EQ(config.keep_alive_timeout_millis,
+            FeatureFlags::GetInstance().GetFlags().keep_alive_timeout_millis);
+  EXPECT_EQ(config.bwu_client_introduction_timeout,
+            TransportConfig::kDefaultBwuClientIntroductionTimeout);
+}
+
+TEST_F(TransportConfigTest, FollowsChangedFlags) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      feature::kMaxTransmitPacketSizeBytes, 32768);
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      feature::kMaxFrameSizeBytes, 2097152);
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      feature::kKeepAliveIntervalMillis, 1000);
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      feature::kKeepAliveTimeoutMillis, 4000);
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      feature::kBwuClientIntroductionTimeoutMillis, 2500);
+
+  TransportConfig config = TransportConfig::Get();
+
+  EXPECT_EQ(config.max_transmit_packet_size, 32768);
+  EXPECT_EQ(config.max_frame_size, 2097152);
+  EXPECT_EQ(config.keep_alive_interval_millis, 1000);
+  EXPECT_EQ(config.keep_alive_timeout_millis, 4000);
+  EXPECT_EQ(config.bwu_client_introduction_timeout, absl::Milliseconds(2500));
+
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      feature::kMaxTransmitPacketSizeBytes, 16384);
+
+  EXPECT_EQ(TransportConfig::Get().max_transmit_packet_size, 16384);
+}
+
+TEST_F(TransportConfigTest, IgnoresInvalidFlags) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      feature::kMaxFrameSizeBytes, -1);
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      feature::kMaxTransmitPacketSizeBytes, int64_t{1} << 40);
+  // The interval must stay below the timeout.
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      feature::kKeepAliveIntervalMillis, 4000);
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      feature::kKeepAliveTimeoutMillis, 1000);
+
+  TransportConfig config = TransportConfig::Get();
+
+  EXPECT_EQ(config.max_frame_size, TransportConfig::kDefaultMaxFrameSize);
+  EXPECT_EQ(config.max_transmit_packet_size,
+            TransportConfig::kDefaultMaxTransmitPacketSize);
+  EXPECT_EQ(config.keep_alive_interval_millis,
+            FeatureFlags::GetInstance().GetFlags().keep_alive_interval_millis);
+  EXPECT_EQ(config.keep_alive_timeout_millis,
+            FeatureFlags::GetInstance().GetFlags().keep_alive_timeout_millis);
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
@@ -65,8 +65,8 @@ WebrtcBwuHandler::CreateUpgradedEndpointChannel(
              peer_id.GetId().c_str(), location_hint.DebugString().c_str());
 
   mediums::WebRtcSocketWrapper socket =
-      webrtc_.Connect(service_id, peer_id, location_hint,
-                      client->GetCancellationFlag(endpoint_id));
+      webrtc().Connect(service_id, peer_id, location_hint,
+                       client->GetCancellationFlag(endpoint_id));
   if (!socket.IsValid()) {
     NEARBY_LOG(ERROR,
                "WebRtcBwuHandler failed to connect to remote peer (%s) on "
@@ -95,7 +95,7 @@ WebrtcBwuHandler::CreateUpgradedEndpointChannel(
 
 void WebrtcBwuHandler::HandleRevertInitiatorStateForService(
     const std::string& upgrade_service_id) {
-  webrtc_.StopAcceptingConnections(upgrade_service_id);
+  webrtc().StopAcceptingConnections(upgrade_service_id);
   NEARBY_LOGS(INFO)
       << "WebrtcBwuHandler successfully reverted state for service "
       << upgrade_service_id;
@@ -108,11 +108,11 @@ ByteArray WebrtcBwuHandler::HandleInitializeUpgradedMediumForEndpoint(
     ClientProxy* client, const std::string& upgrade_service_id,
     const std::string& endpoint_id) {
   LocationHint location_hint =
-      Utils::BuildLocationHint(webrtc_.GetDefaultCountryCode());
+      Utils::BuildLocationHint(webrtc().GetDefaultCountryCode());
 
   mediums::WebrtcPeerId self_id{mediums::WebrtcPeerId::FromRandom()};
-  if (!webrtc_.IsAcceptingConnections(upgrade_service_id)) {
-    if (!webrtc_.StartAcceptingConnections(
+  if (!webrtc().IsAcceptingConnections(upgrade_service_id)) {
+    if (!webrtc().StartAcceptingConnections(
             upgrade_service_id, self_id, location_hint,
             {
                 .accepted_cb = absl::bind_front(
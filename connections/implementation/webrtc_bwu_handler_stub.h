@@ -72,8 +72,9 @@ class WebrtcBwuHandler : public BaseBwuHandler {
                                   const std::string& upgrade_service_id,
                                   mediums::WebRtcSocketWrapper socket);
 
+  mediums::WebRtc& webrtc() { return mediums_.GetWebRtc(); }
+
   Mediums& mediums_;
-  mediums::WebRtc& webrtc_{mediums_.GetWebRtc()};
 };
 
 }  // namespace connections
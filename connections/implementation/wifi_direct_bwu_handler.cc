@@ -35,14 +35,14 @@ WifiDirectBwuHandler::WifiDirectBwuHandler(Mediums& mediums,
 ByteArray WifiDirectBwuHandler::HandleInitializeUpgradedMediumForEndpoint(
     ClientProxy* client, const std::string& upgrade_service_id,
     const std::string& endpoint_id) {
-  // Create WifiDirect GO
-  if (!wifi_direct_medium_.StartWifiDirect()) {
+  // Create WifiDirect GO, or reuse the one other endpoints upgraded to.
+  if (!wifi_direct_medium().StartWifiDirect()) {
     NEARBY_LOGS(INFO) << "Failed to start Wifi Direct!";
     return {};
   }
 
-  if (!wifi_direct_medium_.IsAcceptingConnections(upgrade_service_id)) {
-    if (!wifi_direct_medium_.StartAcceptingConnections(
+  if (!wifi_direct_medium().IsAcceptingConnections(upgrade_service_id)) {
+    if (!wifi_direct_medium().StartAcceptingConnections(
             upgrade_service_id,
             {
                 .accepted_cb = absl::bind_front(
@@ -66,7 +66,7 @@ ByteArray WifiDirectBwuHandler::HandleInitializeUpgradedMediumForEndpoint(
   // called and the server socket is created. Be careful moving this codeblock
   // around.
   WifiDirectCredentials* wifi_direct_crendential =
-      wifi_direct_medium_.GetCredentials(upgrade_service_id);
+      wifi_direct_medium().GetCredentials(upgrade_service_id);
   std::string ssid = wifi_direct_crendential->GetSSID();
   std::string password = wifi_direct_crendential->GetPassword();
   std::string gateway = wifi_direct_crendential->GetGateway();
@@ -86,9 +86,11 @@ ByteArray WifiDirectBwuHandler::HandleInitializeUpgradedMediumForEndpoint(
 
 void WifiDirectBwuHandler::HandleRevertInitiatorStateForService(
     const std::string& upgrade_service_id) {
-  wifi_direct_medium_.StopAcceptingConnections(upgrade_service_id);
-  wifi_direct_medium_.StopWifiDirect();
-  wifi_direct_medium_.DisconnectWifiDirect();
+  // The group stays up for the other services upgrading to it, and, in
+  // persistent group mode, for peers upgrading again.
+  wifi_direct_medium().StopAcceptingConnections(upgrade_service_id);
+  wifi_direct_medium().ReleaseWifiDirect();
+  wifi_direct_medium().ReleaseConnectionToGO();
 
   NEARBY_LOGS(INFO)
       << "WifiDirectBwuHandler successfully reverted all states for "
@@ -115,12 +117,12 @@ WifiDirectBwuHandler::CreateUpgradedEndpointChannel(
                     << ",  Password:" << password << ",  Port:" << port
                     << ",  Gateway:" << gateway;
 
-  if (!wifi_direct_medium_.ConnectWifiDirect(ssid, password)) {
+  if (!wifi_direct_medium().ConnectWifiDirect(ssid, password)) {
     NEARBY_LOGS(ERROR) << "Connect to WifiDiret GO failed";
     return nullptr;
   }
 
-  WifiDirectSocket socket = wifi_direct_medium_.Connect(
+  WifiDirectSocket socket = wifi_direct_medium().Connect(
       service_id, gateway, port, client->GetCancellationFlag(endpoint_id));
   if (!socket.IsValid()) {
     NEARBY_LOGS(ERROR)
@@ -68,6 +68,7 @@ class WifiDirectBwuHandler : public BaseBwuHandler {
       const std::string& endpoint_id) final;
 
   // Revert the upgrade when the procedure fails or disconnection is called.
+  // The group is released rather than stopped, see WifiDirect.
   void HandleRevertInitiatorStateForService(
       const std::string& upgrade_service_id) final;
 
@@ -76,9 +77,10 @@ class WifiDirectBwuHandler : public BaseBwuHandler {
                                    const std::string& upgrade_service_id,
                                    WifiDirectSocket socket);
 
+  Wifi& wifi_medium() { return mediums_.GetWifi(); }
+  WifiDirect& wifi_direct_medium() { return mediums_.GetWifiDirect(); }
+
   Mediums& mediums_;
-  Wifi& wifi_medium_ = mediums_.GetWifi();
-  WifiDirect& wifi_direct_medium_ = mediums_.GetWifiDirect();
 };
 
 }  // namespace connections
@@ -40,13 +40,13 @@ ByteArray WifiHotspotBwuHandler::HandleInitializeUpgradedMediumForEndpoint(
     ClientProxy* client, const std::string& upgrade_service_id,
     const std::string& endpoint_id) {
   // Create SoftAP
-  if (!wifi_hotspot_medium_.StartWifiHotspot()) {
+  if (!wifi_hotspot_medium().StartWifiHotspot()) {
     NEARBY_LOGS(INFO) << "Failed to start Wifi Hotspot!";
     return {};
   }
 
-  if (!wifi_hotspot_medium_.IsAcceptingConnections(upgrade_service_id)) {
-    if (!wifi_hotspot_medium_.StartAcceptingConnections(
+  if (!wifi_hotspot_medium().IsAcceptingConnections(upgrade_service_id)) {
+    if (!wifi_hotspot_medium().StartAcceptingConnections(
             upgrade_service_id,
             {
                 .accepted_cb = absl::bind_front(
@@ -70,7 +70,7 @@ ByteArray WifiHotspotBwuHandler::HandleInitializeUpgradedMediumForEndpoint(
   // called and the server socket is created. Be careful moving this codeblock
   // around.
   HotspotCredentials* hotspot_crendential =
-      wifi_hotspot_medium_.GetCredentials(upgrade_service_id);
+      wifi_hotspot_medium().GetCredentials(upgrade_service_id);
   std::string ssid = hotspot_crendential->GetSSID();
   std::string password = hotspot_crendential->GetPassword();
   std::string gateway = hotspot_crendential->GetGateway();
@@ -87,11 +87,27 @@ ByteArray WifiHotspotBwuHandler::HandleInitializeUpgradedMediumForEndpoint(
       /* supports_disabling_encryption */ disabling_encryption);
 }
 
+// Called by BWU initiator. Starts the SoftAP ahead of the upgrade, since that
+// can take seconds. HandleInitializeUpgradedMediumForEndpoint() then finds it
+// already started.
+void WifiHotspotBwuHandler::PrepareUpgradedMedium() {
+  if (!wifi_hotspot_medium().StartWifiHotspot()) {
+    NEARBY_LOGS(INFO) << "Failed to start Wifi Hotspot ahead of the upgrade!";
+  }
+}
+
+void WifiHotspotBwuHandler::RevertPreparedUpgradedMedium() {
+  if (HasActiveInitiatorEndpoints()) return;
+  wifi_hotspot_medium().StopWifiHotspot();
+  NEARBY_LOGS(INFO) << "WifiHotspotBwuHandler stopped the Wifi Hotspot started "
+                       "for an upgrade that didn't happen.";
+}
+
 void WifiHotspotBwuHandler::HandleRevertInitiatorStateForService(
     const std::string& upgrade_service_id) {
-  wifi_hotspot_medium_.StopAcceptingConnections(upgrade_service_id);
-  wifi_hotspot_medium_.StopWifiHotspot();
-  wifi_hotspot_medium_.DisconnectWifiHotspot();
+  wifi_hotspot_medium().StopAcceptingConnections(upgrade_service_id);
+  wifi_hotspot_medium().StopWifiHotspot();
+  wifi_hotspot_medium().DisconnectWifiHotspot();
 
   NEARBY_LOGS(INFO)
       << "WifiHotspotBwuHandler successfully reverted all states for "
@@ -120,12 +136,12 @@ WifiHotspotBwuHandler::CreateUpgradedEndpointChannel(
                     << ",  Password:" << password << ",  Port:" << port
                     << ",  Gateway:" << gateway;
 
-  if (!wifi_hotspot_medium_.ConnectWifiHotspot(ssid, password)) {
+  if (!wifi_hotspot_medium().ConnectWifiHotspot(ssid, password)) {
     NEARBY_LOGS(ERROR) << "Connect to Hotspot failed";
     return nullptr;
   }
 
-  WifiHotspotSocket socket = wifi_hotspot_medium_.Connect(
+  WifiHotspotSocket socket = wifi_hotspot_medium().Connect(
       service_id, gateway, port, client->GetCancellationFlag(endpoint_id));
   if (!socket.IsValid()) {
     NEARBY_LOGS(ERROR)
@@ -55,6 +55,8 @@ class WifiHotspotBwuHandler : public BaseBwuHandler {
   Medium GetUpgradeMedium() const final { return Medium::WIFI_HOTSPOT; }
   void OnEndpointDisconnect(ClientProxy* client,
                             const std::string& endpoint_id) final {}
+  void PrepareUpgradedMedium() final;
+  void RevertPreparedUpgradedMedium() final;
 
   // BaseBwuHandler implementation:
   ByteArray HandleInitializeUpgradedMediumForEndpoint(
@@ -67,8 +69,9 @@ class WifiHotspotBwuHandler : public BaseBwuHandler {
                                    const std::string& upgrade_service_id,
                                    WifiHotspotSocket socket);
 
+  WifiHotspot& wifi_hotspot_medium() { return mediums_.GetWifiHotspot(); }
+
   Mediums& mediums_;
-  WifiHotspot& wifi_hotspot_medium_{mediums_.GetWifiHotspot()};
 };
 
 }  // namespace connections
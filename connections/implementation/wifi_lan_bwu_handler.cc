@@ -55,7 +55,7 @@ WifiLanBwuHandler::CreateUpgradedEndpointChannel(
                        << "available WifiLan service (" << ip_address << ":"
                        << port << ") for endpoint " << endpoint_id;
 
-  WifiLanSocket socket = wifi_lan_medium_.Connect(
+  WifiLanSocket socket = wifi_lan_medium().Connect(
       service_id, ip_address, port, client->GetCancellationFlag(endpoint_id));
   if (!socket.IsValid()) {
     NEARBY_LOGS(ERROR)
@@ -89,8 +89,8 @@ WifiLanBwuHandler::CreateUpgradedEndpointChannel(
 ByteArray WifiLanBwuHandler::HandleInitializeUpgradedMediumForEndpoint(
     ClientProxy* client, const std::string& upgrade_service_id,
     const std::string& endpoint_id) {
-  if (!wifi_lan_medium_.IsAcceptingConnections(upgrade_service_id)) {
-    if (!wifi_lan_medium_.StartAcceptingConnections(
+  if (!wifi_lan_medium().IsAcceptingConnections(upgrade_service_id)) {
+    if (!wifi_lan_medium().StartAcceptingConnections(
             upgrade_service_id,
             {
                 .accepted_cb = absl::bind_front(
@@ -113,7 +113,7 @@ ByteArray WifiLanBwuHandler::HandleInitializeUpgradedMediumForEndpoint(
   // Note: Credentials are not populated until StartAcceptingConnections() is
   // called and the server socket is created. Be careful moving this codeblock
   // around.
-  auto credential = wifi_lan_medium_.GetCredentials(upgrade_service_id);
+  auto credential = wifi_lan_medium().GetCredentials(upgrade_service_id);
   auto ip_address = credential.first;
   auto port = credential.second;
   if (ip_address.empty()) {
@@ -134,7 +134,7 @@ ByteArray WifiLanBwuHandler::HandleInitializeUpgradedMediumForEndpoint(
 
 void WifiLanBwuHandler::HandleRevertInitiatorStateForService(
     const std::string& upgrade_service_id) {
-  wifi_lan_medium_.StopAcceptingConnections(upgrade_service_id);
+  wifi_lan_medium().StopAcceptingConnections(upgrade_service_id);
   NEARBY_LOGS(INFO) << "WifiLanBwuHandler successfully reverted all states for "
                     << "upgrade service ID " << upgrade_service_id;
 }
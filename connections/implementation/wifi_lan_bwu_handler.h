@@ -66,8 +66,9 @@ class WifiLanBwuHandler : public BaseBwuHandler {
                                    const std::string& upgrade_service_id,
                                    WifiLanSocket socket);
 
+  WifiLan& wifi_lan_medium() { return mediums_.GetWifiLan(); }
+
   Mediums& mediums_;
-  WifiLan& wifi_lan_medium_{mediums_.GetWifiLan()};
 };
 
 }  // namespace connections
@@ -15,6 +15,7 @@
 #ifndef CORE_LISTENERS_H_
 #define CORE_LISTENERS_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -162,6 +163,16 @@ struct DiscoveryListener {
       endpoint_distance_changed_cb = [](const std::string&, DistanceInfo) {};
 };
 
+// A buffer supplied by the client for an incoming BYTES payload.
+struct IncomingBytesBuffer {
+  // At least as large as the payload, or nullptr to have the payload held in
+  // a ByteArray instead.
+  char* data = nullptr;
+  // Called once the Payload the buffer was handed out with is destroyed, and
+  // not at all if |data| is nullptr.
+  Payload::ReleaseCallback release;
+};
+
 struct PayloadListener {
   // Called when a Payload is received from a remote endpoint. Depending
   // on the type of the Payload, all of the data may or may not have been
@@ -185,6 +196,19 @@ struct PayloadListener {
                           const PayloadProgressInfo& info)>
       payload_progress_cb =
           [](absl::string_view, const PayloadProgressInfo&) {};
+
+  // Optional. Called when a BYTES payload of |size| bytes arrives, before
+  // OnPayload(). The payload is copied into the returned buffer, and the
+  // Payload passed to OnPayload() refers to it instead of owning a copy; see
+  // Payload::AsBytesView().
+  //
+  // endpoint_id - The identifier for the remote endpoint that sent the
+  //               payload.
+  // payload_id  - The identifier of the payload.
+  // size        - The size of the payload in bytes.
+  absl::AnyInvocable<IncomingBytesBuffer(
+      absl::string_view endpoint_id, Payload::Id payload_id, size_t size)>
+      incoming_bytes_buffer_cb;
 };
 
 }  // namespace connections
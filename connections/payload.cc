@@ -16,6 +16,11 @@
 
 #include <algorithm>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/string_view.h"
 
 namespace nearby {
 namespace connections {
@@ -37,7 +42,7 @@ std::string getFileName(const std::string& s) {
 
 // Payload is default-constructible, and moveable, but not copyable container
 // that holds at most one instance of one of:
-// ByteArray, InputStream, or InputFile.
+// ByteArray, InputStream, InputFile, or a batch of files.
 Payload::Payload(Payload&& other) noexcept = default;
 Payload::~Payload() = default;
 Payload& Payload::operator=(Payload&& other) noexcept = default;
@@ -53,6 +58,12 @@ Payload::Payload(ByteArray&& bytes)
 Payload::Payload(const ByteArray& bytes)
     : type_(PayloadType::kBytes), content_(bytes) {}
 
+Payload::Payload(const char* data, size_t size, ReleaseCallback release)
+    : type_(PayloadType::kBytes),
+      content_(ByteArray()),
+      external_bytes_(absl::WrapUnique(new ExternalBytes{
+          absl::string_view(data, size), std::move(release)})) {}
+
 Payload::Payload(InputFile input_file)
     : id_(std::hash<std::string>()(input_file.GetFilePath())),
       file_name_(getFileName(input_file.GetFilePath())),
@@ -76,6 +87,11 @@ Payload::Payload(std::string parent_folder, std::string file_name,
 Payload::Payload(std::function<InputStream&()> stream)
     : type_(PayloadType::kStream), content_(std::move(stream)) {}
 
+Payload::Payload(std::string parent_folder, std::vector<BatchFile> files)
+    : parent_folder_(std::move(parent_folder)),
+      type_(PayloadType::kFileBatch),
+      content_(std::move(files)) {}
+
 // Constructors for incoming payloads.
 Payload::Payload(Id id, ByteArray&& bytes)
     : id_(id), type_(PayloadType::kBytes), content_(std::move(bytes)) {}
@@ -83,6 +99,13 @@ Payload::Payload(Id id, ByteArray&& bytes)
 Payload::Payload(Id id, const ByteArray& bytes)
     : id_(id), type_(PayloadType::kBytes), content_(bytes) {}
 
+Payload::Payload(Id id, const char* data, size_t size, ReleaseCallback release)
+    : id_(id),
+      type_(PayloadType::kBytes),
+      content_(ByteArray()),
+      external_bytes_(absl::WrapUnique(new ExternalBytes{
+          absl::string_view(data, size), std::move(release)})) {}
+
 Payload::Payload(Id id, std::string parent_folder, std::string file_name,
                  InputFile input_file)
     : id_(id),
@@ -94,12 +117,23 @@ Payload::Payload(Id id, std::string parent_folder, std::string file_name,
 Payload::Payload(Id id, std::function<InputStream&()> stream)
     : id_(id), type_(PayloadType::kStream), content_(std::move(stream)) {}
 
+Payload::Payload(Id id, std::string parent_folder,
+                 std::vector<BatchFile> files)
+    : id_(id),
+      parent_folder_(std::move(parent_folder)),
+      type_(PayloadType::kFileBatch),
+      content_(std::move(files)) {}
+
 // Returns ByteArray payload, if it has been defined, or empty ByteArray.
 const ByteArray& Payload::AsBytes() const& {
   static const ByteArray empty;  // NOLINT: function-level static is OK.
   auto* result = absl::get_if<ByteArray>(&content_);
   return result ? *result : empty;
 }
+absl::string_view Payload::AsBytesView() const {
+  if (external_bytes_) return external_bytes_->data;
+  return AsBytes().AsStringView();
+}
 // Returns InputStream* payload, if it has been defined, or nullptr.
 InputStream* Payload::AsStream() {
   auto* result = absl::get_if<std::function<InputStream&()>>(&content_);
@@ -107,6 +141,10 @@ InputStream* Payload::AsStream() {
 }
 // Returns InputFile* payload, if it has been defined, or nullptr.
 InputFile* Payload::AsFile() { return absl::get_if<InputFile>(&content_); }
+// Returns the files of a batch payload, if it has been defined, or nullptr.
+std::vector<Payload::BatchFile>* Payload::AsFileBatch() {
+  return absl::get_if<std::vector<BatchFile>>(&content_);
+}
 
 // Returns Payload unique ID.
 Payload::Id Payload::GetId() const { return id_; }
@@ -137,5 +175,9 @@ const std::string& Payload::GetParentFolder() const { return parent_folder_; }
 
 const std::string& Payload::GetFileName() const { return file_name_; }
 
+Payload::ExternalBytes::~ExternalBytes() {
+  if (release) std::move(release)();
+}
+
 }  // namespace connections
 }  // namespace nearby
@@ -18,8 +18,12 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/functional/any_invocable.h"
+#include "absl/strings/string_view.h"
 #include "absl/types/variant.h"
 #include "connections/payload_type.h"
 #include "internal/platform/byte_array.h"
@@ -34,14 +38,29 @@ namespace connections {
 
 // Payload is default-constructible, and moveable, but not copyable container
 // that holds at most one instance of one of:
-// ByteArray, InputStream, or InputFile.
+// ByteArray, InputStream, InputFile, or a batch of files.
 class Payload {
  public:
   using Id = PayloadId;
+
+  // One of the files of a kFileBatch payload. FileName and ParentFolder are
+  // what the remote device should save it as, ParentFolder being relative to
+  // the ParentFolder of the payload.
+  struct BatchFile {
+    std::string parent_folder;
+    std::string file_name;
+    InputFile file;
+  };
+
   // Order of types in variant, and values in Type enum is important.
   // Enum values must match respective variant types.
-  using Content = absl::variant<absl::monostate, ByteArray,
-                                std::function<InputStream&()>, InputFile>;
+  using Content =
+      absl::variant<absl::monostate, ByteArray, std::function<InputStream&()>,
+                    InputFile, std::vector<BatchFile>>;
+
+  // Called once a payload no longer needs the caller-owned buffer it was
+  // created from.
+  using ReleaseCallback = absl::AnyInvocable<void() &&>;
 
   Payload(Payload&& other) noexcept;
   ~Payload();
@@ -54,6 +73,11 @@ class Payload {
   explicit Payload(ByteArray&& bytes);
 
   explicit Payload(const ByteArray& bytes);
+  // Sends the |size| bytes at |data| as a BYTES payload, reading them from the
+  // caller's buffer when they're sent instead of copying them in first. The
+  // buffer must stay valid and unchanged until |release| is called, when the
+  // payload is destroyed.
+  Payload(const char* data, size_t size, ReleaseCallback release);
   explicit Payload(InputFile input_file);
 
   // InputFile is just "a pointer to a file on your disc", a wrapper around a
@@ -73,20 +97,38 @@ class Payload {
 
   explicit Payload(std::function<InputStream&()> stream);
 
+  // Sends |files| as a single payload, with one header, one set of progress
+  // updates and one last chunk for all of them. Small files are packed
+  // together into chunks. Only endpoints that support it can receive a batch,
+  // the others fail to.
+  explicit Payload(std::string parent_folder, std::vector<BatchFile> files);
+
   // Constructors for incoming payloads.
   Payload(Id id, ByteArray&& bytes);
   Payload(Id id, const ByteArray& bytes);
+  // Bytes received into a buffer supplied by the client; |release| is called
+  // when the payload is destroyed.
+  Payload(Id id, const char* data, size_t size, ReleaseCallback release);
   Payload(Id id, InputFile file);
   Payload(Id id, std::string parent_folder, std::string file_name,
           InputFile input_file);
   Payload(Id id, std::function<InputStream&()> stream);
+  // The files of an incoming batch are all listed from the start, each with
+  // the path it's being written to.
+  Payload(Id id, std::string parent_folder, std::vector<BatchFile> files);
 
   // Returns ByteArray payload, if it has been defined, or empty ByteArray.
+  // Empty for payloads created from a caller-owned buffer too.
   const ByteArray& AsBytes() const&;
+  // Returns the bytes of a BYTES payload, whether they're held in a ByteArray
+  // or a caller-owned buffer, or an empty view.
+  absl::string_view AsBytesView() const;
   // Returns InputStream* payload, if it has been defined, or nullptr.
   InputStream* AsStream();
   // Returns InputFile* payload, if it has been defined, or nullptr.
   InputFile* AsFile();
+  // Returns the files of a batch payload, if it has been defined, or nullptr.
+  std::vector<BatchFile>* AsFileBatch();
 
   // Returns Payload unique ID.
   Id GetId() const;
@@ -106,6 +148,14 @@ class Payload {
   const std::string& GetParentFolder() const;
 
  private:
+  // A caller-owned buffer, released along with the payload.
+  struct ExternalBytes {
+    ~ExternalBytes();
+
+    absl::string_view data;
+    ReleaseCallback release;
+  };
+
   PayloadType FindType() const;
 
   Id id_{GenerateId()};
@@ -116,6 +166,7 @@ class Payload {
 
   PayloadType type_{FindType()};
   Content content_;
+  std::unique_ptr<ExternalBytes> external_bytes_;
 };
 
 }  // namespace connections
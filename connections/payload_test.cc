@@ -16,6 +16,8 @@
 
 #include <memory>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "protobuf-matchers/protocol-buffer-matchers.h"
@@ -42,6 +44,22 @@ TEST(PayloadTest, SupportsByteArrayType) {
   EXPECT_EQ(payload.AsBytes(), bytes);
 }
 
+TEST(PayloadTest, SupportsCallerOwnedBytes) {
+  const std::string bytes = "bytes";
+  int released = 0;
+  {
+    Payload payload(bytes.data(), bytes.size(), [&released]() { ++released; });
+    EXPECT_EQ(payload.GetType(), PayloadType::kBytes);
+    EXPECT_EQ(payload.AsBytesView().data(), bytes.data());
+    EXPECT_EQ(payload.AsBytesView(), bytes);
+
+    Payload moved = std::move(payload);
+    EXPECT_EQ(released, 0);
+    EXPECT_EQ(moved.AsBytesView().data(), bytes.data());
+  }
+  EXPECT_EQ(released, 1);
+}
+
 TEST(PayloadTest, SupportsFileType) {
   constexpr size_t kOffset = 99;
   const auto payload_id = Payload::GenerateId();
@@ -93,6 +111,27 @@ TEST(PayloadTest,
   EXPECT_EQ(payload.GetFileName(), expected);
 }
 
+TEST(PayloadTest, SupportsFileBatchType) {
+  std::vector<Payload::BatchFile> files;
+  files.push_back({.parent_folder = "photos",
+                   .file_name = "a.png",
+                   .file = InputFile("/tmp/a.png", 10)});
+  files.push_back(
+      {.file_name = "b.txt", .file = InputFile("/tmp/b.txt", 20)});
+
+  Payload payload("trip", std::move(files));
+
+  EXPECT_EQ(payload.GetType(), PayloadType::kFileBatch);
+  EXPECT_EQ(payload.GetParentFolder(), "trip");
+  EXPECT_EQ(payload.AsFile(), nullptr);
+  EXPECT_EQ(payload.AsStream(), nullptr);
+  ASSERT_NE(payload.AsFileBatch(), nullptr);
+  ASSERT_EQ(payload.AsFileBatch()->size(), 2);
+  EXPECT_EQ(payload.AsFileBatch()->at(0).parent_folder, "photos");
+  EXPECT_EQ(payload.AsFileBatch()->at(0).file_name, "a.png");
+  EXPECT_EQ(payload.AsFileBatch()->at(1).file.GetFilePath(), "/tmp/b.txt");
+}
+
 TEST(PayloadTest, SupportsStreamType) {
   constexpr size_t kOffset = 1234456;
   auto pipe = std::make_shared<Pipe>();
@@ -18,7 +18,13 @@
 namespace nearby {
 namespace connections {
 
-enum class PayloadType { kUnknown = 0, kBytes = 1, kStream = 2, kFile = 3 };
+enum class PayloadType {
+  kUnknown = 0,
+  kBytes = 1,
+  kStream = 2,
+  kFile = 3,
+  kFileBatch = 4
+};
 enum PayloadDirection {
   UNKNOWN_DIRECTION_PAYLOAD = 0,
   INCOMING_PAYLOAD = 1,
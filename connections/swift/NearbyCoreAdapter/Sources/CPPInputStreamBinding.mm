@@ -18,7 +18,8 @@
 #import <objc/runtime.h>
 
 #include <memory>
-#include <vector>
+#include <string>
+#include <utility>
 
 // TODO(b/239758418): Change this to the non-internal version when available.
 #include "internal/platform/input_stream.h"
@@ -35,16 +36,18 @@ class CPPInputStream : public InputStream {
   ~CPPInputStream() override { Close(); }
 
   ExceptionOr<ByteArray> Read(std::int64_t size) override {
-    std::vector<uint8_t> buffer;
-    buffer.reserve(size);
-    NSInteger numberOfBytesRead = [iStream_ read:buffer.data() maxLength:size];
+    // Read straight into the string the ByteArray takes over, rather than into a buffer that is
+    // then copied.
+    std::string buffer(size, '\0');
+    NSInteger numberOfBytesRead = [iStream_ read:(uint8_t *)buffer.data() maxLength:size];
     if (numberOfBytesRead == 0) {
       return ExceptionOr<ByteArray>();
     }
     if (numberOfBytesRead < 0) {
       return ExceptionOr<ByteArray>(Exception::kIo);
     }
-    return ExceptionOr<ByteArray>(ByteArray((const char *)buffer.data(), numberOfBytesRead));
+    buffer.resize(numberOfBytesRead);
+    return ExceptionOr<ByteArray>(ByteArray(std::move(buffer)));
   }
 
   Exception Close() override {
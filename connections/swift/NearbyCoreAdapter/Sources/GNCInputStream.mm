@@ -61,7 +61,8 @@ using ::nearby::connections::NSErrorFromCppException;
     return -1;
   }
 
-  ByteArray byteArray = readResult.GetResult();
+  // Only the copy into the caller's buffer is needed.
+  const ByteArray &byteArray = readResult.result();
   if (byteArray.size() == 0) {
     _streamStatus = NSStreamStatusAtEnd;
     return 0;
@@ -17,14 +17,15 @@
 #import <Foundation/Foundation.h>
 
 #include <string>
+#include <utility>
 
+#include "absl/strings/string_view.h"
 #include "connections/payload.h"
 
 #import "connections/swift/NearbyCoreAdapter/Sources/CPPInputStreamBinding.h"
 #import "connections/swift/NearbyCoreAdapter/Sources/GNCInputStream.h"
 #import "connections/swift/NearbyCoreAdapter/Sources/GNCPayload+CppConversions.h"
 
-using ::nearby::ByteArray;
 using ::nearby::InputFile;
 using ::nearby::InputStream;
 using ::nearby::connections::Payload;
@@ -35,8 +36,15 @@ using ::nearby::connections::Payload;
   int64_t payloadId = payload.GetId();
   switch (payload.GetType()) {
     case nearby::connections::PayloadType::kBytes: {
-      ByteArray bytes = payload.AsBytes();
-      NSData *payloadData = [NSData dataWithBytes:bytes.data() length:bytes.size()];
+      // The NSData points into the payload's own buffer, and keeps the payload alive until it is
+      // deallocated.
+      Payload *heldPayload = new Payload(std::move(payload));
+      absl::string_view bytes = heldPayload->AsBytesView();
+      NSData *payloadData = [[NSData alloc] initWithBytesNoCopy:(void *)bytes.data()
+                                                         length:bytes.size()
+                                                    deallocator:^(void *buffer, NSUInteger length) {
+                                                      delete heldPayload;
+                                                    }];
       return [[GNCBytesPayload alloc] initWithData:payloadData identifier:payloadId];
     }
     case nearby::connections::PayloadType::kFile: {
@@ -54,6 +62,8 @@ using ::nearby::connections::Payload;
       GNCInputStream *stream = [[GNCInputStream alloc] initWithCppInputStream:payload.AsStream()];
       return [[GNCStreamPayload alloc] initWithStream:stream identifier:payloadId];
     }
+    // Batch payloads aren't exposed to Swift yet.
+    case nearby::connections::PayloadType::kFileBatch:
     case nearby::connections::PayloadType::kUnknown:
       return nil;
   }
@@ -68,7 +78,11 @@ using ::nearby::connections::Payload;
 @implementation GNCBytesPayload (CppConversions)
 
 - (Payload)toCpp {
-  return Payload(self.identifier, ByteArray((const char *)self.data.bytes, self.data.length));
+  // Copying an immutable NSData only retains it, so the payload reads the bytes from the app's
+  // buffer for as long as it holds on to them. A mutable one is copied, since the app may change it
+  // while it's being sent.
+  NSData *data = [self.data copy];
+  return Payload(self.identifier, (const char *)data.bytes, data.length, [data]() {});
 }
 
 @end
@@ -15,10 +15,18 @@
 #ifndef THIRD_PARTY_NEARBY_CONNECTIONS_V3_CONNECTIONS_DEVICE_PROVIDER_H_
 #define THIRD_PARTY_NEARBY_CONNECTIONS_V3_CONNECTIONS_DEVICE_PROVIDER_H_
 
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "connections/v3/connections_device.h"
 #include "internal/interop/device_provider.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/mutex_lock.h"
 
 namespace nearby {
 namespace connections {
@@ -37,8 +45,85 @@ class ConnectionsDeviceProvider : public NearbyDeviceProvider {
 
   const NearbyDevice* GetLocalDevice() override { return &device_; }
 
+  // Names an interned remote device. A handle is only given to another device
+  // after the one it named was released, and never resolves to that other
+  // device.
+  using DeviceHandle = std::int64_t;
+  static constexpr DeviceHandle kNoDevice = -1;
+
+  // Returns the handle of the remote device with `endpoint_id`, interning the
+  // device if it isn't yet. Interned devices are shared by all the v3
+  // callbacks about them, rather than built for every call.
+  DeviceHandle InternRemoteDevice(absl::string_view endpoint_id) {
+    MutexLock lock(&remote_devices_->mutex);
+    auto it = remote_devices_->handles.find(endpoint_id);
+    if (it != remote_devices_->handles.end()) {
+      return it->second;
+    }
+    std::uint32_t index;
+    if (remote_devices_->free_slots.empty()) {
+      index = remote_devices_->slots.size();
+      remote_devices_->slots.emplace_back();
+    } else {
+      index = remote_devices_->free_slots.back();
+      remote_devices_->free_slots.pop_back();
+    }
+    RemoteDevices::Slot& slot = remote_devices_->slots[index];
+    slot.device = std::make_shared<const ConnectionsDevice>(
+        endpoint_id, "", std::vector<ConnectionInfoVariant>{});
+    DeviceHandle handle =
+        (static_cast<DeviceHandle>(slot.generation) << 32) | index;
+    remote_devices_->handles.emplace(endpoint_id, handle);
+    return handle;
+  }
+
+  // Returns the remote device named by `handle` in constant time, or nullptr
+  // if it was released.
+  std::shared_ptr<const ConnectionsDevice> GetRemoteDevice(
+      DeviceHandle handle) const {
+    if (handle < 0) return nullptr;
+    std::uint32_t index = handle & 0xffffffff;
+    MutexLock lock(&remote_devices_->mutex);
+    if (index >= remote_devices_->slots.size()) return nullptr;
+    const RemoteDevices::Slot& slot = remote_devices_->slots[index];
+    if (slot.generation != (handle >> 32)) return nullptr;
+    return slot.device;
+  }
+
+  // Releases the remote device with `endpoint_id`, e.g. once it disconnected.
+  // Devices already handed out stay valid.
+  void ReleaseRemoteDevice(absl::string_view endpoint_id) {
+    MutexLock lock(&remote_devices_->mutex);
+    auto it = remote_devices_->handles.find(endpoint_id);
+    if (it == remote_devices_->handles.end()) {
+      return;
+    }
+    std::uint32_t index = it->second & 0xffffffff;
+    RemoteDevices::Slot& slot = remote_devices_->slots[index];
+    slot.device.reset();
+    ++slot.generation;
+    remote_devices_->free_slots.push_back(index);
+    remote_devices_->handles.erase(it);
+  }
+
  private:
+  struct RemoteDevices {
+    struct Slot {
+      std::shared_ptr<const ConnectionsDevice> device;
+      std::uint32_t generation = 0;
+    };
+
+    mutable Mutex mutex;
+    std::vector<Slot> slots ABSL_GUARDED_BY(mutex);
+    std::vector<std::uint32_t> free_slots ABSL_GUARDED_BY(mutex);
+    absl::flat_hash_map<std::string, DeviceHandle> handles
+        ABSL_GUARDED_BY(mutex);
+  };
+
   ConnectionsDevice device_;
+  // Heap allocated so that the provider stays movable.
+  std::unique_ptr<RemoteDevices> remote_devices_ =
+      std::make_unique<RemoteDevices>();
 };
 
 }  // namespace v3
@@ -14,6 +14,8 @@
 
 #include "connections/v3/connections_device_provider.h"
 
+#include <memory>
+
 #include "gmock/gmock.h"
 #include "protobuf-matchers/protocol-buffer-matchers.h"
 #include "gtest/gtest.h"
@@ -61,6 +63,41 @@ TEST(ConnectionsDeviceProviderTest, TestUnknownAuthStatus) {
             AuthenticationStatus::kUnknown);
 }
 
+TEST(ConnectionsDeviceProviderTest, InternsRemoteDevices) {
+  ConnectionsDeviceProvider provider(kEndpointId, kEndpointInfo, {});
+
+  ConnectionsDeviceProvider::DeviceHandle handle =
+      provider.InternRemoteDevice("WXYZ");
+  std::shared_ptr<const ConnectionsDevice> device =
+      provider.GetRemoteDevice(handle);
+
+  ASSERT_NE(device, nullptr);
+  EXPECT_EQ(device->GetEndpointId(), "WXYZ");
+  EXPECT_EQ(provider.InternRemoteDevice("WXYZ"), handle);
+  EXPECT_EQ(provider.GetRemoteDevice(handle), device);
+  EXPECT_NE(provider.InternRemoteDevice("ABCD"), handle);
+  EXPECT_EQ(provider.GetRemoteDevice(ConnectionsDeviceProvider::kNoDevice),
+            nullptr);
+}
+
+TEST(ConnectionsDeviceProviderTest, ReleasedHandleResolvesToNothing) {
+  ConnectionsDeviceProvider provider(kEndpointId, kEndpointInfo, {});
+  ConnectionsDeviceProvider::DeviceHandle handle =
+      provider.InternRemoteDevice("WXYZ");
+  std::shared_ptr<const ConnectionsDevice> device =
+      provider.GetRemoteDevice(handle);
+
+  provider.ReleaseRemoteDevice("WXYZ");
+  ConnectionsDeviceProvider::DeviceHandle other_handle =
+      provider.InternRemoteDevice("ABCD");
+
+  EXPECT_NE(other_handle, handle);
+  EXPECT_EQ(provider.GetRemoteDevice(handle), nullptr);
+  EXPECT_EQ(provider.GetRemoteDevice(other_handle)->GetEndpointId(), "ABCD");
+  // Devices handed out before stay valid.
+  EXPECT_EQ(device->GetEndpointId(), "WXYZ");
+}
+
 }  // namespace
 }  // namespace v3
 }  // namespace connections
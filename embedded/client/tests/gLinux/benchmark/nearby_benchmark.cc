@@ -0,0 +1,351 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the cost of the library API calls on the host, so that
+// optimizations can be compared before flashing a device. For every call it
+// reports the CPU cycles and instructions, where the kernel allows counting
+// them, the time, and the stack high-water mark.
+//
+// Build and run with
+//   ./build.sh gLinux benchmark OPTIMIZED_BUILD=1 NEARBY_SANITIZE_ADDRESS=0
+//       NEARBY_TRACE_LEVEL=OFF OUT_DIR_NAME=gLinux_benchmark
+// BENCHMARK_ITERATIONS sets the number of runs per call, 1000 by default.
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "fakes.h"
+#include "nearby.h"
+#include "nearby_fp_client.h"
+#include "nearby_fp_library.h"
+#include "nearby_message_stream.h"
+
+namespace {
+
+constexpr int kDefaultIterations = 1000;
+// Size and fill pattern of the stack the calls run on to measure their stack
+// use.
+constexpr size_t kStackSize = 64 * 1024;
+constexpr uint8_t kStackPattern = 0xA5;
+
+constexpr uint64_t kPeerAddress = 0xB0B1B2B3B4B5;
+
+// Same keys as in smoke_test.cc.
+constexpr uint8_t kBobPrivateKey[32] = {
+    0x02, 0xB4, 0x37, 0xB0, 0xED, 0xD6, 0xBB, 0xD4, 0x29, 0x06, 0x4A,
+    0x4E, 0x52, 0x9F, 0xCB, 0xF1, 0xC4, 0x8D, 0x0D, 0x62, 0x49, 0x24,
+    0xD5, 0x92, 0x27, 0x4B, 0x7E, 0xD8, 0x11, 0x93, 0xD7, 0x63};
+constexpr uint8_t kBobPublicKey[64] = {
+    0xF7, 0xD4, 0x96, 0xA6, 0x2E, 0xCA, 0x41, 0x63, 0x51, 0x54, 0x0A,
+    0xA3, 0x43, 0xBC, 0x69, 0x0A, 0x61, 0x09, 0xF5, 0x51, 0x50, 0x06,
+    0x66, 0xB8, 0x3B, 0x12, 0x51, 0xFB, 0x84, 0xFA, 0x28, 0x60, 0x79,
+    0x5E, 0xBD, 0x63, 0xD3, 0xB8, 0x83, 0x6F, 0x44, 0xA9, 0xA3, 0xE2,
+    0x8B, 0xB3, 0x40, 0x17, 0xE0, 0x15, 0xF5, 0x97, 0x93, 0x05, 0xD8,
+    0x49, 0xFD, 0xF8, 0xDE, 0x10, 0x12, 0x3B, 0x61, 0xD2};
+constexpr uint8_t kAlicePublicKey[64] = {
+    0x36, 0xAC, 0x68, 0x2C, 0x50, 0x82, 0x15, 0x66, 0x8F, 0xBE, 0xFE,
+    0x24, 0x7D, 0x01, 0xD5, 0xEB, 0x96, 0xE6, 0x31, 0x8E, 0x85, 0x5B,
+    0x2D, 0x64, 0xB5, 0x19, 0x5D, 0x38, 0xEE, 0x7E, 0x37, 0xBE, 0x18,
+    0x38, 0xC0, 0xB9, 0x48, 0xC3, 0xF7, 0x55, 0x20, 0xE0, 0x7E, 0x70,
+    0xF0, 0x72, 0x91, 0x41, 0x9A, 0xCE, 0x2D, 0x28, 0x14, 0x3C, 0x5A,
+    0xDB, 0x2D, 0xBD, 0x98, 0xEE, 0x3C, 0x8E, 0x4F, 0xBF};
+constexpr uint8_t kExpectedAesKey[16] = {0xB0, 0x7F, 0x1F, 0x17, 0xC2, 0x36,
+                                         0xCB, 0xD3, 0x35, 0x23, 0xC5, 0x15,
+                                         0xF3, 0x50, 0xAE, 0x57};
+
+struct Benchmark {
+  const char* name;
+  // Called before every run, not measured.
+  std::function<void()> setup;
+  std::function<void()> run;
+};
+
+struct Result {
+  uint64_t min_cycles = UINT64_MAX;
+  double cycles = 0;
+  double instructions = 0;
+  double nanoseconds = 0;
+  size_t stack_bytes = 0;
+};
+
+// Counts the CPU cycles and instructions spent in user space by this thread.
+// Not available if the kernel doesn't allow it, e.g. in some containers.
+class PerfCounters {
+ public:
+  PerfCounters() {
+    cycles_fd_ = Open(PERF_COUNT_HW_CPU_CYCLES, -1);
+    if (cycles_fd_ >= 0) {
+      instructions_fd_ = Open(PERF_COUNT_HW_INSTRUCTIONS, cycles_fd_);
+    }
+  }
+  ~PerfCounters() {
+    if (instructions_fd_ >= 0) close(instructions_fd_);
+    if (cycles_fd_ >= 0) close(cycles_fd_);
+  }
+
+  bool available() const { return instructions_fd_ >= 0; }
+
+  void Start() {
+    if (!available()) return;
+    ioctl(cycles_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(cycles_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+
+  // Returns false if the counters couldn't be read.
+  bool Stop(uint64_t* cycles, uint64_t* instructions) {
+    if (!available()) return false;
+    ioctl(cycles_fd_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    struct {
+      uint64_t count;
+      uint64_t values[2];
+    } group;
+    if (read(cycles_fd_, &group, sizeof(group)) != sizeof(group)) return false;
+    *cycles = group.values[0];
+    *instructions = group.values[1];
+    return true;
+  }
+
+ private:
+  static int Open(uint64_t config, int group_fd) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = group_fd < 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1,
+                   group_fd, /*flags=*/0);
+  }
+
+  int cycles_fd_ = -1;
+  int instructions_fd_ = -1;
+};
+
+uint64_t NowNs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+// The call that MeasureStack() runs on the painted stack.
+const std::function<void()>* stack_call;
+ucontext_t caller_context;
+ucontext_t call_context;
+
+void RunStackCall() { (*stack_call)(); }
+
+// Runs |call| on a stack filled with kStackPattern, and returns how much of
+// the stack it overwrote.
+size_t MeasureStack(const std::function<void()>& call) {
+  std::vector<uint8_t> stack(kStackSize, kStackPattern);
+  stack_call = &call;
+  getcontext(&call_context);
+  call_context.uc_stack.ss_sp = stack.data();
+  call_context.uc_stack.ss_size = stack.size();
+  call_context.uc_link = &caller_context;
+  makecontext(&call_context, RunStackCall, 0);
+  swapcontext(&caller_context, &call_context);
+  // The stack grows down, from the end of |stack|.
+  auto first_used = std::find_if(stack.begin(), stack.end(), [](uint8_t b) {
+    return b != kStackPattern;
+  });
+  return stack.end() - first_used;
+}
+
+Result Measure(const Benchmark& benchmark, PerfCounters& counters,
+               int iterations) {
+  Result result;
+  for (int i = 0; i < iterations; i++) {
+    if (benchmark.setup) benchmark.setup();
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t start_ns = NowNs();
+    counters.Start();
+    benchmark.run();
+    bool counted = counters.Stop(&cycles, &instructions);
+    result.nanoseconds += NowNs() - start_ns;
+    if (counted) {
+      result.min_cycles = std::min(result.min_cycles, cycles);
+      result.cycles += cycles;
+      result.instructions += instructions;
+    }
+  }
+  result.cycles /= iterations;
+  result.instructions /= iterations;
+  result.nanoseconds /= iterations;
+  if (benchmark.setup) benchmark.setup();
+  result.stack_bytes = MeasureStack(benchmark.run);
+  return result;
+}
+
+void SetAccountKeys(size_t count) {
+  std::vector<AccountKeyPair> account_keys;
+  for (size_t i = 0; i < count; i++) {
+    uint8_t account_key[ACCOUNT_KEY_SIZE_BYTES] = {0x04};
+    for (size_t j = 1; j < ACCOUNT_KEY_SIZE_BYTES; j++) {
+      account_key[j] = i * ACCOUNT_KEY_SIZE_BYTES + j;
+    }
+    account_keys.emplace_back(kPeerAddress + i, account_key);
+  }
+  nearby_test_fakes_SetAccountKeys(account_keys);
+  nearby_fp_LoadAccountKeys();
+}
+
+void OnMessageReceived(uint64_t peer_address,
+                       nearby_message_stream_Message* message) {}
+
+uint8_t advertisement[64];
+uint8_t response[AES_MESSAGE_SIZE_BYTES];
+uint8_t message_stream_buffer[128];
+const nearby_message_stream_State message_stream_state = {
+    .on_message_received = OnMessageReceived,
+    .peer_address = kPeerAddress,
+    .length = sizeof(message_stream_buffer),
+    .buffer = message_stream_buffer,
+};
+// A message with 16 bytes of payload.
+const uint8_t kMessage[] = {0x03, 0x0A, 0x00, 0x10, 1, 2,  3,  4,  5, 6,
+                            7,    8,    9,    10,   11, 12, 13, 14, 15, 16};
+
+std::vector<uint8_t> CreateKeyBasedPairingRequest() {
+  // Key-based pairing request with the provider's and the seeker's address.
+  uint8_t request[AES_MESSAGE_SIZE_BYTES] = {
+      0x00, 0x40, 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5,
+      0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xCD, 0xEF};
+  std::vector<uint8_t> encrypted(AES_MESSAGE_SIZE_BYTES +
+                                 sizeof(kAlicePublicKey));
+  nearby_test_fakes_Aes128Encrypt(request, encrypted.data(), kExpectedAesKey);
+  std::copy(kAlicePublicKey, kAlicePublicKey + sizeof(kAlicePublicKey),
+            encrypted.begin() + AES_MESSAGE_SIZE_BYTES);
+  return encrypted;
+}
+
+std::vector<Benchmark> GetBenchmarks() {
+  static const std::vector<uint8_t> key_based_pairing_request =
+      CreateKeyBasedPairingRequest();
+  auto with_account_keys = []() {
+    nearby_fp_client_Init(NULL);
+    SetAccountKeys(NEARBY_MAX_ACCOUNT_KEYS);
+  };
+  return {
+      {"empty", nullptr, []() {}},
+      {"nearby_fp_CreateNondiscoverableAdvertisement", with_account_keys,
+       []() {
+         nearby_fp_CreateNondiscoverableAdvertisement(
+             advertisement, sizeof(advertisement), false);
+       }},
+      {"nearby_fp_SetBloomFilter",
+       [with_account_keys]() {
+         with_account_keys();
+         nearby_fp_CreateNondiscoverableAdvertisement(
+             advertisement, sizeof(advertisement), false);
+       },
+       []() {
+         nearby_fp_SetBloomFilter(advertisement, /*use_sass_format=*/false,
+                                  /*in_use_key=*/NULL);
+       }},
+      {"nearby_fp_CreateRawKeybasedPairingResponse", nullptr,
+       []() {
+         nearby_fp_CreateRawKeybasedPairingResponse(
+             response, /*extended_response=*/false);
+       }},
+      {"key-based pairing request",
+       []() {
+         nearby_fp_client_Init(NULL);
+         nearby_test_fakes_SetAntiSpoofingKey(kBobPrivateKey, kBobPublicKey);
+         nearby_fp_client_SetAdvertisement(
+             NEARBY_FP_ADVERTISEMENT_DISCOVERABLE);
+       },
+       []() {
+         nearby_fp_fakes_ReceiveKeyBasedPairingRequest(
+             key_based_pairing_request.data(),
+             key_based_pairing_request.size());
+       }},
+#if NEARBY_FP_MESSAGE_STREAM
+      {"nearby_message_stream_Read",
+       []() { nearby_message_stream_Init(&message_stream_state); },
+       []() {
+         nearby_message_stream_Read(&message_stream_state, kMessage,
+                                    sizeof(kMessage));
+       }},
+      {"nearby_message_stream_Read (byte by byte)",
+       []() { nearby_message_stream_Init(&message_stream_state); },
+       []() {
+         for (size_t i = 0; i < sizeof(kMessage); i++) {
+           nearby_message_stream_Read(&message_stream_state, kMessage + i, 1);
+         }
+       }},
+#endif /* NEARBY_FP_MESSAGE_STREAM */
+  };
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int iterations = argc > 1 && argv[1][0] != '\0' ? atoi(argv[1])
+                                                   : kDefaultIterations;
+  if (iterations <= 0) {
+    fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+    return 1;
+  }
+#if defined(__SANITIZE_ADDRESS__)
+  fprintf(stderr,
+          "Built with AddressSanitizer, the results are inflated. Build with "
+          "NEARBY_SANITIZE_ADDRESS=0.\n");
+#endif
+  PerfCounters counters;
+  if (!counters.available()) {
+    fprintf(stderr,
+            "CPU counters are unavailable, only reporting time and stack.\n");
+  }
+
+  std::vector<Benchmark> benchmarks = GetBenchmarks();
+  // Cost of the measurement itself, subtracted from the other results.
+  Result empty = Measure(benchmarks[0], counters, iterations);
+  printf("%-45s %12s %12s %12s %10s %8s\n", "API call", "cycles",
+         "min cycles", "instructions", "ns", "stack");
+  for (size_t i = 1; i < benchmarks.size(); i++) {
+    Result result = Measure(benchmarks[i], counters, iterations);
+    if (counters.available()) {
+      printf("%-45s %12.0f %12llu %12.0f ", benchmarks[i].name,
+             std::max(result.cycles - empty.cycles, 0.0),
+             static_cast<unsigned long long>(
+                 result.min_cycles - std::min(empty.min_cycles,
+                                              result.min_cycles)),
+             std::max(result.instructions - empty.instructions, 0.0));
+    } else {
+      printf("%-45s %12s %12s %12s ", benchmarks[i].name, "-", "-", "-");
+    }
+    printf("%10.0f %8zu\n",
+           std::max(result.nanoseconds - empty.nanoseconds, 0.0),
+           result.stack_bytes - std::min(empty.stack_bytes,
+                                         result.stack_bytes));
+  }
+  return 0;
+}
@@ -18,12 +18,14 @@
 #include <openssl/sha.h>
 
 #include <cerrno>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <memory>
 #include <queue>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "fakes.h"
 #include "nearby_platform_se.h"
@@ -117,6 +119,35 @@ nearby_platform_status nearby_platform_Aes128Decrypt(const uint8_t input[16],
 }
 #endif /* NEARBY_PLATFORM_USE_MBEDTLS */
 
+#ifdef NEARBY_PLATFORM_HAS_AES_CTR
+// Encrypts all the counter blocks in one call, like an accelerator would.
+nearby_platform_status nearby_platform_Aes128Ctr(uint8_t *data, size_t length,
+                                                 const uint8_t iv[16],
+                                                 const uint8_t key[16]) {
+  size_t blocks = (length + 15) / 16;
+  std::vector<uint8_t> counters(blocks * 16);
+  std::vector<uint8_t> key_stream(blocks * 16 + 16);
+  for (size_t i = 0; i < blocks; i++) {
+    memcpy(counters.data() + 16 * i, iv, 16);
+    counters[16 * i] += i;
+  }
+  EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+  int output_length = key_stream.size();
+  EVP_EncryptInit(ctx, EVP_aes_128_ecb(), key, NULL);
+  EVP_CIPHER_CTX_set_padding(ctx, 0);
+  int result = EVP_EncryptUpdate(ctx, key_stream.data(), &output_length,
+                                 counters.data(), counters.size());
+  EVP_CIPHER_CTX_free(ctx);
+  if (result != 1) {
+    return kNearbyStatusError;
+  }
+  for (size_t i = 0; i < length; i++) {
+    data[i] ^= key_stream[i];
+  }
+  return kNearbyStatusOK;
+}
+#endif /* NEARBY_PLATFORM_HAS_AES_CTR */
+
 static EC_POINT *load_public_key(const uint8_t public_key[64]) {
   BN_CTX *bn_ctx;
   EC_KEY *key;
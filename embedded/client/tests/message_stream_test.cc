@@ -78,6 +78,11 @@ uint8_t buffer[kBufferSize];
 
 void OnMessageReceived(uint64_t peer_address,
                        nearby_message_stream_Message* message);
+bool OnHeaderReceived(uint64_t peer_address,
+                      const nearby_message_stream_Message* message);
+void OnPayloadReceived(uint64_t peer_address,
+                       const nearby_message_stream_Message* message,
+                       uint16_t offset, const uint8_t* data, size_t length);
 
 class MessageStreamTest : public ::testing::Test {
  public:
@@ -95,6 +100,13 @@ class MessageStreamTest : public ::testing::Test {
     nearby_message_stream_Send(kPeerAddress, message);
   }
 
+  // Streams the messages of |group|, and buffers the rest
+  void StreamGroup(uint8_t group) {
+    streamed_group_ = group;
+    stream_state_.on_header_received = OnHeaderReceived;
+    stream_state_.on_payload_received = OnPayloadReceived;
+  }
+
   void SendAck(const nearby_message_stream_Message* message) {
     nearby_message_stream_SendAck(kPeerAddress, message);
   }
@@ -108,6 +120,10 @@ class MessageStreamTest : public ::testing::Test {
   void SetUp() override;
 
   std::deque<StreamMessage> received_messages_;
+  std::deque<StreamMessage> received_headers_;
+  // Offset and length of every streamed payload fragment
+  std::vector<std::pair<uint16_t, size_t>> fragments_;
+  std::vector<uint8_t> streamed_payload_;
 
  private:
   void AddMessage(nearby_message_stream_Message* message) {
@@ -117,6 +133,16 @@ class MessageStreamTest : public ::testing::Test {
   friend void OnMessageReceived(uint64_t peer_address,
                                 nearby_message_stream_Message* message);
 
+  // To allow access to streamed messages
+  friend bool OnHeaderReceived(uint64_t peer_address,
+                               const nearby_message_stream_Message* message);
+  friend void OnPayloadReceived(uint64_t peer_address,
+                                const nearby_message_stream_Message* message,
+                                uint16_t offset, const uint8_t* data,
+                                size_t length);
+
+  uint8_t streamed_group_ = 0;
+
   nearby_message_stream_State stream_state_ = {
       .on_message_received = OnMessageReceived,
       .peer_address = kPeerAddress,
@@ -136,6 +162,25 @@ void OnMessageReceived(uint64_t peer_address,
   test_fixture->AddMessage(message);
 }
 
+bool OnHeaderReceived(uint64_t peer_address,
+                      const nearby_message_stream_Message* message) {
+  EXPECT_EQ(kPeerAddress, peer_address);
+  if (message->message_group != test_fixture->streamed_group_) return false;
+  test_fixture->received_headers_.emplace_back(message->message_group,
+                                               message->message_code);
+  return true;
+}
+
+void OnPayloadReceived(uint64_t peer_address,
+                       const nearby_message_stream_Message* message,
+                       uint16_t offset, const uint8_t* data, size_t length) {
+  EXPECT_EQ(kPeerAddress, peer_address);
+  EXPECT_EQ(test_fixture->streamed_payload_.size(), offset);
+  test_fixture->fragments_.emplace_back(offset, length);
+  test_fixture->streamed_payload_.insert(test_fixture->streamed_payload_.end(),
+                                         data, data + length);
+}
+
 TEST_F(MessageStreamTest, ReadWholeMessageWithNoData) {
   uint8_t group = 120;
   uint8_t code = 130;
@@ -289,6 +334,67 @@ TEST_F(MessageStreamTest, ReadTwoMessagesByteByByte) {
             received_messages_[1]);
 }
 
+TEST_F(MessageStreamTest, StreamMessageLongerThanBuffer) {
+  uint8_t group = 120;
+  uint8_t code = 130;
+  constexpr size_t kPayloadSize = 0x102;
+  uint8_t message[kHeaderSize + kPayloadSize];
+  message[0] = group;
+  message[1] = code;
+  message[2] = 0x01;
+  message[3] = 0x02;
+  for (unsigned i = 0; i < kPayloadSize; i++) {
+    message[kHeaderSize + i] = i;
+  }
+  StreamGroup(group);
+
+  Read(message, kHeaderSize + 10);
+  Read(message + kHeaderSize + 10, kPayloadSize - 10);
+
+  ASSERT_EQ(0, received_messages_.size());
+  ASSERT_EQ(1, received_headers_.size());
+  ASSERT_EQ(StreamMessage(group, code), received_headers_[0]);
+  ASSERT_THAT(fragments_,
+              ElementsAreArray({std::pair<uint16_t, size_t>(0, 10),
+                                std::pair<uint16_t, size_t>(10, 0xF8)}));
+  ASSERT_THAT(streamed_payload_,
+              ElementsAreArray(message + kHeaderSize,
+                               message + sizeof(message)));
+}
+
+TEST_F(MessageStreamTest, StreamMessageWithNoData) {
+  uint8_t group = 120;
+  uint8_t code = 130;
+  uint8_t message[] = {group, code, 0, 0};
+  StreamGroup(group);
+
+  ReadByteByByte(message, sizeof(message));
+
+  ASSERT_EQ(0, received_messages_.size());
+  ASSERT_EQ(1, received_headers_.size());
+  ASSERT_THAT(fragments_,
+              ElementsAreArray({std::pair<uint16_t, size_t>(0, 0)}));
+}
+
+TEST_F(MessageStreamTest, StreamOneOfTwoMessages) {
+  uint8_t group = 120;
+  uint8_t code = 130;
+  uint8_t group2 = 121;
+  uint8_t code2 = 131;
+  uint8_t message[] = {group, code, 0, 1, 30, group2, code2, 0, 2, 31, 32};
+  StreamGroup(group2);
+
+  Read(message, sizeof(message));
+
+  ASSERT_EQ(1, received_messages_.size());
+  ASSERT_EQ(StreamMessage(group, code,
+                          std::vector<uint8_t>(message + 4, message + 5)),
+            received_messages_[0]);
+  ASSERT_EQ(1, received_headers_.size());
+  ASSERT_EQ(StreamMessage(group2, code2), received_headers_[0]);
+  ASSERT_THAT(streamed_payload_, ElementsAreArray(message + 9, message + 11));
+}
+
 TEST_F(MessageStreamTest, SendMessageNoPayload) {
   nearby_message_stream_Message message{
       .message_group = 10,
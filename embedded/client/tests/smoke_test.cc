@@ -84,6 +84,7 @@ constexpr bool kRegularBloomFormat = false;
 constexpr bool kSassBloomFormat = true;
 constexpr uint8_t* kNoInUseKey = NULL;
 using ::testing::ElementsAreArray;
+using ::testing::Not;
 
 static std::string VecToString(std::vector<uint8_t> data) {
   std::stringstream output;
@@ -1832,6 +1833,27 @@ TEST(NearbyFpClient, AesCtr) {
   ASSERT_THAT(message, ElementsAreArray(kExpectedResult));
 }
 
+TEST(NearbyFpClient, AesCtrIsSymmetricOverManyBlocks) {
+  const uint8_t kKey[] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF,
+                          0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+  // Starts at an odd offset, so that the message isn't word aligned.
+  uint8_t buffer[1 + 8 + 16 * 4 + 5];
+  uint8_t* message = buffer + 1;
+  const size_t kMessageSize = sizeof(buffer) - 1;
+  for (size_t i = 0; i < kMessageSize; i++) {
+    message[i] = i;
+  }
+  std::vector<uint8_t> original(message, message + kMessageSize);
+
+  ASSERT_EQ(kNearbyStatusOK, nearby_fp_AesCtr(message, kMessageSize, kKey));
+  ASSERT_THAT(std::vector<uint8_t>(message, message + kMessageSize),
+              Not(ElementsAreArray(original)));
+  ASSERT_EQ(kNearbyStatusOK, nearby_fp_AesCtr(message, kMessageSize, kKey));
+
+  ASSERT_THAT(std::vector<uint8_t>(message, message + kMessageSize),
+              ElementsAreArray(original));
+}
+
 #if NEARBY_FP_ENABLE_ADDITIONAL_DATA
 TEST(NearbyFpClient, DecodeAdditionalData) {
   uint8_t message[] = {0x55, 0xEC, 0x5E, 0x60, 0x55, 0xAF, 0x6E, 0x92, 0x00,
@@ -2617,6 +2639,41 @@ TEST(NearbyFpClient, GenerateSassAdvertisement) {
   ASSERT_THAT(buffer, ElementsAreArray(kExpectedResult));
 }
 
+TEST(NearbyFpClient, UniqueAccountKeysFollowKeyListChanges) {
+  constexpr uint64_t kOtherAddress = 0x505050505050;
+  uint8_t account_key1[] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88,
+                            0x99, 0x00, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
+  uint8_t account_key2[] = {0x11, 0x11, 0x22, 0x22, 0x33, 0x33, 0x44, 0x44,
+                            0x55, 0x55, 0x66, 0x66, 0x77, 0x77, 0x88, 0x88};
+  std::vector<AccountKeyPair> account_keys{
+      AccountKeyPair(kRemoteDevice, account_key1),
+      AccountKeyPair(kRemoteDevice, account_key2),
+      AccountKeyPair(kOtherAddress, account_key1)};
+  nearby_fp_client_Init(NULL);
+  nearby_test_fakes_SetAccountKeys(account_keys);
+  nearby_fp_LoadAccountKeys();
+
+  ASSERT_EQ(2, nearby_fp_GetUniqueAccountKeyCount());
+  ASSERT_EQ(0, nearby_fp_GetNextUniqueAccountKeyIndex(0));
+  ASSERT_EQ(1, nearby_fp_GetNextUniqueAccountKeyIndex(1));
+  ASSERT_EQ(-1, nearby_fp_GetNextUniqueAccountKeyIndex(2));
+
+  // The duplicate moves to the top, so the original becomes the duplicate
+  nearby_fp_MarkAccountKeyAsActive(2);
+
+  ASSERT_EQ(2, nearby_fp_GetUniqueAccountKeyCount());
+  ASSERT_EQ(0, nearby_fp_GetNextUniqueAccountKeyIndex(0));
+  ASSERT_EQ(2, nearby_fp_GetNextUniqueAccountKeyIndex(1));
+
+  nearby_platform_AccountKeyInfo new_key = {.account_key = {0x04, 0x05}};
+  nearby_fp_AddAccountKey(&new_key);
+
+  ASSERT_EQ(3, nearby_fp_GetUniqueAccountKeyCount());
+  ASSERT_EQ(0, nearby_fp_GetNextUniqueAccountKeyIndex(0));
+  ASSERT_EQ(1, nearby_fp_GetNextUniqueAccountKeyIndex(1));
+  ASSERT_EQ(3, nearby_fp_GetNextUniqueAccountKeyIndex(2));
+}
+
 TEST(NearbyFpClient, GenerateAccountFilterNoSass) {
   std::vector<uint8_t> random_numbers = {0xC7, 0xC8};
   constexpr uint8_t kExpectedResult[] = {13,   0x16, 0x2C, 0xFE, 0x00,
@@ -2710,6 +2767,38 @@ TEST(NearbyFpClient, GenerateAccountFilterSassTwoKeys) {
   ASSERT_THAT(advertisement, ElementsAreArray(kExpectedResult));
 }
 
+TEST(NearbyFpClient, GenerateAccountFilterAgainAfterInUseKeyChanged) {
+  constexpr uint8_t kNotInUseResult[] = {17,   0x16, 0x2C, 0xFE, 0x10, 0x40,
+                                         0x42, 0x80, 0x81, 0x01, 0x21, 0xC7,
+                                         0xC8, 0x46, 0x6E, 0x39, 0xCB, 0x21};
+  constexpr uint8_t kInUseResult[] = {17,   0x16, 0x2C, 0xFE, 0x10, 0x40,
+                                      0x81, 0x28, 0xA8, 0x04, 0x21, 0xC7,
+                                      0xC8, 0x46, 0x6E, 0x39, 0xCB, 0x21};
+  uint8_t advertisement[] = {17,   0x16, 0x2C, 0xFE, 0x00, 0x40,
+                             0,    0,    0,    0,    0x21, 0xC7,
+                             0xC8, 0x46, 0x6E, 0x39, 0xCB, 0x21};
+  uint8_t account_key[] = {0x04, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88,
+                           0x99, 0x00, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
+  std::vector<AccountKeyPair> account_keys{
+      AccountKeyPair(kRemoteDevice, account_key)};
+  nearby_fp_client_Init(NULL);
+  nearby_test_fakes_SetAccountKeys(account_keys);
+  nearby_fp_LoadAccountKeys();
+
+  nearby_fp_SetBloomFilter(advertisement,
+                           /* use_sass_format= */ true, NULL);
+  ASSERT_THAT(advertisement, ElementsAreArray(kNotInUseResult));
+  nearby_fp_SetBloomFilter(advertisement,
+                           /* use_sass_format= */ true, NULL);
+  ASSERT_THAT(advertisement, ElementsAreArray(kNotInUseResult));
+  nearby_fp_SetBloomFilter(advertisement,
+                           /* use_sass_format= */ true, account_key);
+  ASSERT_THAT(advertisement, ElementsAreArray(kInUseResult));
+  nearby_fp_SetBloomFilter(advertisement,
+                           /* use_sass_format= */ true, NULL);
+  ASSERT_THAT(advertisement, ElementsAreArray(kNotInUseResult));
+}
+
 TEST(NearbyFpClient, EncryptRrf) {
   constexpr uint8_t kSassAdvertisement[] = {0x35, 0x00, 0x38, 0x09};
   constexpr uint8_t kExpectedResult[] = {0x46, 0x6E, 0x39, 0xCB, 0x21};
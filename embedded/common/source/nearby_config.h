@@ -39,12 +39,19 @@
 // Does the platform have a native BLE address rotation routine?
 // #define NEARBY_FP_HAVE_BLE_ADDRESS_ROTATION
 
+// Does the platform implement nearby_platform_Aes128Ctr()? Without it, AES-CTR
+// is done one nearby_platform_Aes128Encrypt() block at a time.
+// #define NEARBY_PLATFORM_HAS_AES_CTR
+
 // Support Smart Audio Source Switching
 // #define NEARBY_FP_ENABLE_SASS
 
 // The maximum size in bytes of additional data in a message in Message Stream.
-// Bigger payloads will be truncated.
+// Bigger payloads will be truncated. Every RFCOMM connection has a buffer of
+// this size.
+#ifndef MAX_MESSAGE_STREAM_PAYLOAD_SIZE
 #define MAX_MESSAGE_STREAM_PAYLOAD_SIZE 22
+#endif /* MAX_MESSAGE_STREAM_PAYLOAD_SIZE */
 
 // The maximum number of concurrent RFCOMM connections
 #define NEARBY_MAX_RFCOMM_CONNECTIONS 2
@@ -76,4 +83,11 @@
 
 // The maximum number of account keys that can be stored on the device.
 #define NEARBY_MAX_ACCOUNT_KEYS 5
+
+// Keep the last account key filter, so that refreshing the non-discoverable
+// advertisement with unchanged keys, salt and battery info doesn't hash every
+// account key again. Costs about 150 bytes of RAM.
+#ifndef NEARBY_FP_CACHE_ACCOUNT_KEY_FILTER
+#define NEARBY_FP_CACHE_ACCOUNT_KEY_FILTER 1
+#endif /* NEARBY_FP_CACHE_ACCOUNT_KEY_FILTER */
 #endif /* NEARBY_CONFIG_H */
@@ -94,6 +94,10 @@ static const uint8_t kSassRrdKey[] = {'S', 'A', 'S', 'S', '-', 'R',
                                       'R', 'D', '-', 'K', 'E', 'Y'};
 
 static AccountKeyList account_key_list;
+// is_unique_account_key[i] is true if key i of |account_key_list| isn't a
+// duplicate of any key before it. Derived from the list, so not persisted.
+static bool is_unique_account_key[NEARBY_MAX_ACCOUNT_KEYS];
+static size_t unique_account_key_count;
 
 static uint8_t sha_buffer[32];
 
@@ -137,27 +141,23 @@ static bool IsAccountKeyInRange(const uint8_t* account_key, size_t end_offset) {
 
 size_t nearby_fp_GetAccountKeyCount() { return account_key_list.num_keys; }
 
-size_t nearby_fp_GetUniqueAccountKeyCount() {
-  size_t count = 0;
-  int offset = 0;
-  while (true) {
-    offset = nearby_fp_GetNextUniqueAccountKeyIndex(offset);
-    if (offset == -1) break;
-    count++;
-    offset++;
+// Rebuilds the unique key index. Called whenever |account_key_list| changes, so
+// that iterating over the unique keys doesn't compare keys.
+static void UpdateUniqueAccountKeys() {
+  unique_account_key_count = 0;
+  for (size_t i = 0; i < account_key_list.num_keys; i++) {
+    is_unique_account_key[i] =
+        !IsAccountKeyInRange(account_key_list.key[i].account_key, i);
+    if (is_unique_account_key[i]) unique_account_key_count++;
   }
-  return count;
 }
 
+size_t nearby_fp_GetUniqueAccountKeyCount() { return unique_account_key_count; }
+
 int nearby_fp_GetNextUniqueAccountKeyIndex(int offset) {
   while (offset < nearby_fp_GetAccountKeyCount()) {
-    const nearby_platform_AccountKeyInfo* account_key_info =
-        nearby_fp_GetAccountKey(offset);
-    if (IsAccountKeyInRange(account_key_info->account_key, offset)) {
-      offset++;
-    } else {
-      return offset;
-    }
+    if (is_unique_account_key[offset]) return offset;
+    offset++;
   }
   return -1;
 }
@@ -177,6 +177,7 @@ void nearby_fp_MarkAccountKeyAsActive(unsigned key_number) {
     account_key_list.key[i] = account_key_list.key[i - 1];
   }
   account_key_list.key[0] = tmp;
+  UpdateUniqueAccountKeys();
 }
 
 void nearby_fp_CopyAccountKey(nearby_platform_AccountKeyInfo* dest,
@@ -223,6 +224,7 @@ void nearby_fp_AddAccountKey(const nearby_platform_AccountKeyInfo* key) {
   if (key_count < NEARBY_MAX_ACCOUNT_KEYS) {
     account_key_list.num_keys++;
   }
+  UpdateUniqueAccountKeys();
 }
 size_t nearby_fp_CreateDiscoverableAdvertisement(uint8_t* output,
                                                  size_t length) {
@@ -374,6 +376,50 @@ static const uint8_t* FindBatteryInfoLt(const uint8_t* advertisement) {
   return battery_info;
 }
 
+static uint8_t GetAccountKeyFilterFlags(const uint8_t* key, size_t k,
+                                        bool use_sass_format,
+                                        const uint8_t* in_use_key) {
+  uint8_t flags = key[0];
+  if (use_sass_format) {
+    if (in_use_key != NULL) {
+      if (!memcmp(key, in_use_key, ACCOUNT_KEY_SIZE_BYTES)) {
+        flags |= IN_USE_ACCOUNT_KEY_BIT;
+      }
+    } else if (k == 0) {
+      // The first key is the most recently used one
+      flags |= MOST_RECENTLY_USED_ACCOUNT_KEY_BIT;
+    }
+  }
+  return flags;
+}
+
+#if NEARBY_FP_CACHE_ACCOUNT_KEY_FILTER
+// An LT field has at most 15 bytes of value
+#define MAX_LT_FIELD_SIZE (LTV_HEADER_SIZE + 15)
+#define MAX_ACCOUNT_KEY_FILTER_SIZE ((6 * NEARBY_MAX_ACCOUNT_KEYS + 15) / 5)
+// The account keys with their filter flags, followed by the salt, battery info
+// and random resolvable fields with their LT headers
+#define MAX_ACCOUNT_KEY_FILTER_INPUT_SIZE \
+  (NEARBY_MAX_ACCOUNT_KEYS * ACCOUNT_KEY_SIZE_BYTES + 3 * MAX_LT_FIELD_SIZE)
+
+// The last account key filter and everything it was computed from. When an
+// advertisement is refreshed without any of them changing, the filter is
+// copied instead of hashing every account key again.
+static struct {
+  size_t input_length;
+  uint8_t input[MAX_ACCOUNT_KEY_FILTER_INPUT_SIZE];
+  size_t filter_length;
+  uint8_t filter[MAX_ACCOUNT_KEY_FILTER_SIZE];
+} account_key_filter_cache;
+
+static size_t AppendLtField(uint8_t* output, const uint8_t* field) {
+  if (field == NULL) return 0;
+  size_t length = GetLtLength(*field) + LTV_HEADER_SIZE;
+  memcpy(output, field, length);
+  return length;
+}
+#endif /* NEARBY_FP_CACHE_ACCOUNT_KEY_FILTER */
+
 size_t nearby_fp_SetBloomFilter(uint8_t* advertisement, bool use_sass_format,
                                 const uint8_t* in_use_key) {
   unsigned key_offset = 0;
@@ -405,22 +451,58 @@ size_t nearby_fp_SetBloomFilter(uint8_t* advertisement, bool use_sass_format,
   const size_t s = (6 * n + 15) / 5;
   NEARBY_ASSERT(s == GetLtLength(advertisement[ACCOUNT_KEY_DATA_OFFSET]));
   uint8_t* output = advertisement + ACCOUNT_KEY_DATA_OFFSET + LTV_HEADER_SIZE;
-  memset(output, 0, s);
+#if NEARBY_FP_CACHE_ACCOUNT_KEY_FILTER
+  NEARBY_ASSERT(n <= NEARBY_MAX_ACCOUNT_KEYS);
+  uint8_t input[MAX_ACCOUNT_KEY_FILTER_INPUT_SIZE];
+  size_t input_length = 0;
   for (size_t k = 0; k < n; k++) {
     key_offset = nearby_fp_GetNextUniqueAccountKeyIndex(key_offset);
     NEARBY_ASSERT(key_offset >= 0);
     const uint8_t* key = nearby_fp_GetAccountKey(key_offset)->account_key;
-    uint8_t flags = key[0];
-    if (use_sass_format) {
-      if (in_use_key != NULL) {
-        if (!memcmp(key, in_use_key, ACCOUNT_KEY_SIZE_BYTES)) {
-          flags |= IN_USE_ACCOUNT_KEY_BIT;
-        }
-      } else if (k == 0) {
-        // The first key is the most recently used one
-        flags |= MOST_RECENTLY_USED_ACCOUNT_KEY_BIT;
+    memcpy(input + input_length, key, ACCOUNT_KEY_SIZE_BYTES);
+    input[input_length] =
+        GetAccountKeyFilterFlags(key, k, use_sass_format, in_use_key);
+    input_length += ACCOUNT_KEY_SIZE_BYTES;
+    key_offset++;
+  }
+  input_length += AppendLtField(input + input_length, salt_field);
+  input_length += AppendLtField(input + input_length, battery_info_field);
+  input_length += AppendLtField(input + input_length, random_resolvable_field);
+  if (account_key_filter_cache.filter_length == s &&
+      account_key_filter_cache.input_length == input_length &&
+      !memcmp(account_key_filter_cache.input, input, input_length)) {
+    memcpy(output, account_key_filter_cache.filter, s);
+  } else {
+    memset(output, 0, s);
+    for (size_t k = 0; k < n; k++) {
+      nearby_platform_Sha256Start();
+      nearby_platform_Sha256Update(input + k * ACCOUNT_KEY_SIZE_BYTES,
+                                   ACCOUNT_KEY_SIZE_BYTES);
+      nearby_platform_Sha256Update(salt, salt_length);
+      nearby_platform_Sha256Update(battery_info_field,
+                                   battery_info_field_length);
+      nearby_platform_Sha256Update(random_resolvable_field,
+                                   random_resolvable_field_length);
+      nearby_platform_Sha256Finish(sha_buffer);
+      for (unsigned j = 0; j < 8; j++) {
+        uint32_t x = nearby_utils_GetBigEndian32(sha_buffer + 4 * j);
+        uint32_t m = x % (s * 8);
+        output[m / 8] |= (1 << (m % 8));
       }
     }
+    account_key_filter_cache.input_length = input_length;
+    memcpy(account_key_filter_cache.input, input, input_length);
+    account_key_filter_cache.filter_length = s;
+    memcpy(account_key_filter_cache.filter, output, s);
+  }
+#else
+  memset(output, 0, s);
+  for (size_t k = 0; k < n; k++) {
+    key_offset = nearby_fp_GetNextUniqueAccountKeyIndex(key_offset);
+    NEARBY_ASSERT(key_offset >= 0);
+    const uint8_t* key = nearby_fp_GetAccountKey(key_offset)->account_key;
+    uint8_t flags =
+        GetAccountKeyFilterFlags(key, k, use_sass_format, in_use_key);
     key_offset++;
     nearby_platform_Sha256Start();
     nearby_platform_Sha256Update(&flags, sizeof(flags));
@@ -437,6 +519,7 @@ size_t nearby_fp_SetBloomFilter(uint8_t* advertisement, bool use_sass_format,
       output[m / 8] |= (1 << (m % 8));
     }
   }
+#endif /* NEARBY_FP_CACHE_ACCOUNT_KEY_FILTER */
   if (use_sass_format) {
     advertisement[HEADER_OFFSET] = SASS_HEADER;
   }
@@ -461,8 +544,13 @@ size_t nearby_fp_AppendTxPower(uint8_t* advertisement, size_t length,
 nearby_platform_status nearby_fp_LoadAccountKeys() {
   size_t length = sizeof(account_key_list);
   memset(&account_key_list, 0, length);
-  return nearby_platform_LoadValue(kStoredKeyAccountKeyList,
-                                   (uint8_t*)&account_key_list, &length);
+  nearby_platform_status status = nearby_platform_LoadValue(
+      kStoredKeyAccountKeyList, (uint8_t*)&account_key_list, &length);
+  if (account_key_list.num_keys > NEARBY_MAX_ACCOUNT_KEYS) {
+    account_key_list.num_keys = NEARBY_MAX_ACCOUNT_KEYS;
+  }
+  UpdateUniqueAccountKeys();
+  return status;
 }
 
 nearby_platform_status nearby_fp_SaveAccountKeys() {
@@ -655,25 +743,50 @@ static nearby_platform_status GetRrdKey(
                                     sizeof(kSassRrdKey));
 }
 
+#ifndef NEARBY_PLATFORM_HAS_AES_CTR
+// XORs |data| with |key_stream| a word at a time, then byte by byte for the
+// tail.
+static void XorKeyStream(uint8_t* data, const uint8_t* key_stream,
+                         size_t length) {
+  size_t i = 0;
+  for (; i + sizeof(uint32_t) <= length; i += sizeof(uint32_t)) {
+    uint32_t x, y;
+    memcpy(&x, data + i, sizeof(x));
+    memcpy(&y, key_stream + i, sizeof(y));
+    x ^= y;
+    memcpy(data + i, &x, sizeof(x));
+  }
+  for (; i < length; i++) {
+    data[i] ^= key_stream[i];
+  }
+}
+#endif /* NEARBY_PLATFORM_HAS_AES_CTR */
+
 nearby_platform_status nearby_fp_AesCtr(
     uint8_t* message, size_t message_length,
     const uint8_t key[AES_MESSAGE_SIZE_BYTES]) {
-  uint8_t key_stream[AES_MESSAGE_SIZE_BYTES];
   uint8_t iv[AES_MESSAGE_SIZE_BYTES];
-  size_t offset = NONCE_SIZE;
+  if (message_length <= NONCE_SIZE) return kNearbyStatusOK;
   memset(iv, 0, AES_MESSAGE_SIZE_BYTES - NONCE_SIZE);
   memcpy(iv + AES_MESSAGE_SIZE_BYTES - NONCE_SIZE, message, NONCE_SIZE);
+#ifdef NEARBY_PLATFORM_HAS_AES_CTR
+  return nearby_platform_Aes128Ctr(message + NONCE_SIZE,
+                                   message_length - NONCE_SIZE, iv, key);
+#else
+  uint8_t key_stream[AES_MESSAGE_SIZE_BYTES];
+  size_t offset = NONCE_SIZE;
 
   while (offset < message_length) {
-    unsigned i;
-    unsigned bytes_left = message_length - offset;
+    size_t bytes_left = message_length - offset;
+    size_t block_length =
+        bytes_left < sizeof(key_stream) ? bytes_left : sizeof(key_stream);
     RETURN_IF_ERROR(nearby_platform_Aes128Encrypt(iv, key_stream, key));
-    for (i = 0; i < bytes_left && i < sizeof(key_stream); i++) {
-      message[offset++] ^= key_stream[i];
-    }
+    XorKeyStream(message + offset, key_stream, block_length);
+    offset += block_length;
     iv[0]++;
   }
   return kNearbyStatusOK;
+#endif /* NEARBY_PLATFORM_HAS_AES_CTR */
 }
 
 #if NEARBY_FP_ENABLE_ADDITIONAL_DATA
@@ -40,37 +40,62 @@ void nearby_message_stream_Read(const nearby_message_stream_State* state,
   uint16_t available_space =
       state->length - sizeof(nearby_message_stream_Metadata);
   while (length > 0) {
-    switch (metadata->bytes_read) {
-      case 0:
-        message->message_group = *data;
-        break;
-      case 1:
-        message->message_code = *data;
-        break;
-      case 2:
-        message->length = ((uint16_t)*data) << 8;
-        break;
-      case 3:
-        message->length += *data;
-        break;
-      default: {
-        uint16_t offset = metadata->bytes_read - HEADER_SIZE;
-        if (offset < message->length && offset < available_space) {
-          message->data[offset] = *data;
-        }
+    if (metadata->bytes_read < HEADER_SIZE) {
+      switch (metadata->bytes_read) {
+        case 0:
+          message->message_group = *data;
+          break;
+        case 1:
+          message->message_code = *data;
+          break;
+        case 2:
+          message->length = ((uint16_t)*data) << 8;
+          break;
+        case 3:
+          message->length += *data;
+          break;
+      }
+      data++;
+      length--;
+      metadata->bytes_read++;
+      if (metadata->bytes_read == HEADER_SIZE) {
+        metadata->streaming =
+            state->on_header_received != NULL &&
+            state->on_header_received(state->peer_address, message);
+      }
+    } else {
+      // Payload bytes are handled in as big chunks as the input allows
+      uint16_t offset = metadata->bytes_read - HEADER_SIZE;
+      size_t chunk = message->length - offset;
+      if (chunk > length) chunk = length;
+      if (metadata->streaming) {
+        state->on_payload_received(state->peer_address, message, offset, data,
+                                   chunk);
+      } else if (offset < available_space) {
+        size_t to_copy = available_space - offset;
+        memcpy(message->data + offset, data,
+               chunk < to_copy ? chunk : to_copy);
       }
+      data += chunk;
+      length -= chunk;
+      metadata->bytes_read += chunk;
     }
-    data++;
-    length--;
-    metadata->bytes_read++;
-    if (metadata->bytes_read - HEADER_SIZE == message->length) {
-      if (message->length > available_space) {
-        // Message truncated
-        message->length = available_space;
+    if (metadata->bytes_read >= HEADER_SIZE &&
+        metadata->bytes_read - HEADER_SIZE == message->length) {
+      if (metadata->streaming) {
+        if (message->length == 0) {
+          state->on_payload_received(state->peer_address, message, 0, data, 0);
+        }
+      } else {
+        if (message->length > available_space) {
+          // Message truncated
+          message->length = available_space;
+        }
+        state->on_message_received(state->peer_address, message);
       }
-      state->on_message_received(state->peer_address, message);
       message->length = 0;
       metadata->bytes_read = 0;
+      metadata->streaming = false;
     }
   }
 }
@@ -57,11 +57,29 @@ typedef struct {
   // to store nearby_message_stream_Metadata, so not all of the space is
   // available for message payload
   uint8_t* buffer;
+  // Optional. Callback triggered when the header of a message is read, before
+  // any of its payload. |message| has no data yet. Returning true streams the
+  // message: its payload is passed to |on_payload_received| as it arrives,
+  // without being copied to |buffer|, and |on_message_received| isn't called
+  // for it.
+  bool (*on_header_received)(uint64_t peer_address,
+                             const nearby_message_stream_Message* message);
+  // Callback triggered with every fragment of a streamed message payload.
+  // |data| points into the input passed to nearby_message_stream_Read().
+  // |offset| is the position of the fragment in the payload, the message is
+  // complete when |offset| + |length| equals |message->length|. A streamed
+  // message without payload gets a single empty fragment.
+  void (*on_payload_received)(uint64_t peer_address,
+                              const nearby_message_stream_Message* message,
+                              uint16_t offset, const uint8_t* data,
+                              size_t length);
 } nearby_message_stream_State;
 
 typedef struct {
   nearby_message_stream_Message message;
   uint16_t bytes_read;
+  // Is the payload of |message| streamed to |on_payload_received|?
+  bool streaming;
 } nearby_message_stream_Metadata;
 
 #if NEARBY_FP_MESSAGE_STREAM
@@ -71,7 +89,9 @@ void nearby_message_stream_Init(const nearby_message_stream_State* state);
 // Reads and deserializes data from an input stream. It is OK to pass in
 // incomplete packets. When the parses reads a complete message, it calls
 // |on_message_received|. If the message payload is too big to fit the buffer -
-// bigger than GetMaxPayloadSize(), then the payload is truncated.
+// bigger than GetMaxPayloadSize(), then the payload is truncated. Messages
+// streamed by |on_header_received| are never truncated, the buffer only needs
+// room for nearby_message_stream_Metadata.
 void nearby_message_stream_Read(const nearby_message_stream_State* state,
                                 const uint8_t* data, size_t length);
 
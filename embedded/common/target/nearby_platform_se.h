@@ -62,6 +62,22 @@ nearby_platform_status nearby_platform_Aes128Decrypt(
     uint8_t output[AES_MESSAGE_SIZE_BYTES],
     const uint8_t key[AES_MESSAGE_SIZE_BYTES]);
 
+#ifdef NEARBY_PLATFORM_HAS_AES_CTR
+// Encrypts or decrypts |data| in place with AES128 in CTR mode, as Fast Pair
+// uses it. The key stream of block i is AES128(key, counter_i), where
+// counter_i is |iv| with i added to its first byte. The last block may be
+// partial. Implementations on MCUs with a crypto accelerator should process
+// all the blocks in one operation.
+//
+// data   - Data to be encrypted or decrypted.
+// length - Length of data.
+// iv     - Counter of the first block.
+// key    - 128 bit key to use for encryption.
+nearby_platform_status nearby_platform_Aes128Ctr(
+    uint8_t* data, size_t length, const uint8_t iv[AES_MESSAGE_SIZE_BYTES],
+    const uint8_t key[AES_MESSAGE_SIZE_BYTES]);
+#endif /* NEARBY_PLATFORM_HAS_AES_CTR */
+
 // Generates a shared sec256p1 secret using remote party public key and this
 // device's private key.
 //
@@ -4,6 +4,15 @@ NEARBY_PLATFORM_USE_MBEDTLS ?= 0
 # Use the hardware SE to generate the secp256r1 secret. Alternatively, generate
 # the secret in software.
 NEARBY_PLATFORM_HAS_SE ?= 1
+# Benchmarks time the library itself, so by default they build without
+# AddressSanitizer, optimized and with tracing off.
+ifneq ($(filter benchmark,$(MAKECMDGOALS)),)
+NEARBY_SANITIZE_ADDRESS ?= 0
+OPTIMIZED_BUILD ?= 1
+NEARBY_TRACE_LEVEL ?= OFF
+endif
+# Build with AddressSanitizer.
+NEARBY_SANITIZE_ADDRESS ?= 1
 
 CFLAGS_EXTRA ?=
 CFLAGS += -g \
@@ -11,14 +20,29 @@ CFLAGS += -g \
           -Werror \
           -Wno-deprecated-declarations \
           -DARCH_GLINUX \
-          -fsanitize=address \
           -fno-omit-frame-pointer \
           -DARCH_GLINUX \
           -DNEARBY_ALL_MODULE_DEBUG \
           -DNEARBY_UNIT_TEST_ENABLED \
           $(CFLAGS_EXTRA)
 
-NEARBY_TRACE_LEVEL = VERBOSE
+NEARBY_TRACE_LEVEL ?= VERBOSE
+
+# The objects don't depend on the flags, so builds with other settings get
+# their own out/ directory rather than reusing objects built with these.
+ifneq ($(NEARBY_SANITIZE_ADDRESS),1)
+OUT_DIR_NAME := $(OUT_DIR_NAME)_noasan
+endif
+ifeq ($(OPTIMIZED_BUILD),1)
+OUT_DIR_NAME := $(OUT_DIR_NAME)_opt
+endif
+ifneq ($(NEARBY_TRACE_LEVEL),VERBOSE)
+OUT_DIR_NAME := $(OUT_DIR_NAME)_trace_$(NEARBY_TRACE_LEVEL)
+endif
+
+ifeq ($(NEARBY_SANITIZE_ADDRESS),1)
+CFLAGS += -fsanitize=address
+endif
 
 ifeq ($(OPTIMIZED_BUILD),1)
 CFLAGS += -O2
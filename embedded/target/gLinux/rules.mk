@@ -76,6 +76,15 @@ ifeq ($(NEARBY_PLATFORM_USE_MBEDTLS),1)
 ALL_TEST_OBJS += $(TARGET_MBEDTLS_OBJS)
 endif
 
+# Benchmarks of the library API calls, see
+# client/tests/gLinux/benchmark/nearby_benchmark.cc
+BENCHMARK_SRCS := $(wildcard client/tests/$(ARCH)/benchmark/*.cc)
+BENCHMARK_OBJS := $(patsubst %.cc,$(OUT_DIR)/%.o,$(BENCHMARK_SRCS))
+BENCHMARK_BINARY = $(OUT_DIR)/client/tests/$(ARCH)/benchmark/nearby_benchmark
+$(BENCHMARK_OBJS) : $(OUT_DIR)/%.o: %.cc
+	$(call compile_c,$(TEST_INCLUDES) -I. -std=c++14 $(CFLAGS))
+ALL_TEST_OBJS += $(BENCHMARK_OBJS)
+
 ALL_OBJS += $(ALL_TEST_OBJS)
 # Must include the .d files for test sources here since gLinux.rules is included
 # by makefile after after it includes $(DEPFILES).
@@ -114,9 +123,28 @@ $(TEST_BINARIES) : % : %.o
 		-std=c++14 \
 		$(LIBS)
 
+ifeq ($(NEARBY_PLATFORM_USE_MBEDTLS),1)
+$(BENCHMARK_BINARY) : $(MBEDTLS_LIBS)
+endif
+$(BENCHMARK_BINARY) : $(BENCHMARK_OBJS) $(NAME) $(TARGET_OBJS) $(TARGET_OS_OBJS)
+	mkdir -p $(dir $@)
+	$(CC) -o $@ $(BENCHMARK_OBJS) \
+		$(CFLAGS) \
+		$(TARGET_OBJS) \
+		$(TARGET_OS_OBJS) \
+		-L /usr/local/lib \
+		-std=c++14 \
+		$(LIBS)
+
+# Prints the static RAM (data and bss) and flash (text and data) use of the
+# library, then runs the benchmarks.
+benchmark: $(BENCHMARK_BINARY)
+	size -t $(NAME)
+	./$(BENCHMARK_BINARY) $(BENCHMARK_ITERATIONS)
+
 run_tests: $(TESTS_TO_RUN)
 
 tests: $(TEST_BINARIES)
 
 run_tests : tests
-.PHONY : tests run_tests
+.PHONY : tests run_tests benchmark
@@ -15,11 +15,13 @@
 #include "fastpair/analytics/analytics_recorder.h"
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "internal/analytics/event_logger.h"
+#include "internal/platform/mutex_lock.h"
 #include "internal/proto/analytics/fast_pair_log.proto.h"
 #include "proto/fast_pair_enums.proto.h"
-#include "third_party/protobuf/message_lite.h"
 
 namespace nearby {
 namespace fastpair {
@@ -28,101 +30,118 @@ namespace analytics {
 using ::nearby::fastpair::analytics::AnalyticsRecorder;
 using ::nearby::proto::fastpair::FastPairLog;
 
-void AnalyticsRecorder::NewGattEvent(int error_from_os) {
-  auto fast_pair_log = std::make_unique<FastPairLog>();
-
-  auto gatt_event = FastPairLog::GattEvent::default_instance().New();
-  gatt_event->set_error_from_os(error_from_os);
+AnalyticsRecorder::~AnalyticsRecorder() {
+  executor_.Shutdown();
+  std::vector<Event> events;
+  {
+    MutexLock lock(&mutex_);
+    events.swap(pending_events_);
+  }
+  LogEvents(std::move(events));
+}
 
-  fast_pair_log->set_allocated_gatt_event(gatt_event);
-  LogEvent(*fast_pair_log);
+void AnalyticsRecorder::NewGattEvent(int error_from_os) {
+  AddEvent([error_from_os](FastPairLog& fast_pair_log) {
+    fast_pair_log.mutable_gatt_event()->set_error_from_os(error_from_os);
+  });
 }
 
 void AnalyticsRecorder::NewBrEdrHandoverEvent(
     ::nearby::proto::fastpair::FastPairEvent::BrEdrHandoverErrorCode
         error_code) {
-  auto fast_pair_log = std::make_unique<FastPairLog>();
-
-  auto br_edr_event = FastPairLog::BrEdrHandoverEvent::default_instance().New();
-  br_edr_event->set_error_code(error_code);
-
-  fast_pair_log->set_allocated_br_edr_handover_event(br_edr_event);
-  LogEvent(*fast_pair_log);
+  AddEvent([error_code](FastPairLog& fast_pair_log) {
+    fast_pair_log.mutable_br_edr_handover_event()->set_error_code(error_code);
+  });
 }
 
 void AnalyticsRecorder::NewCreateBondEvent(
     ::nearby::proto::fastpair::FastPairEvent::CreateBondErrorCode error_code,
     int unbond_reason) {
-  auto fast_pair_log = std::make_unique<FastPairLog>();
-
-  auto create_bond_event =
-      FastPairLog::CreateBondEvent::default_instance().New();
-  create_bond_event->set_error_code(error_code);
-  create_bond_event->set_unbond_reason(unbond_reason);
-
-  fast_pair_log->set_allocated_bond_event(create_bond_event);
-  LogEvent(*fast_pair_log);
+  AddEvent([error_code, unbond_reason](FastPairLog& fast_pair_log) {
+    auto* create_bond_event = fast_pair_log.mutable_bond_event();
+    create_bond_event->set_error_code(error_code);
+    create_bond_event->set_unbond_reason(unbond_reason);
+  });
 }
 
 void AnalyticsRecorder::NewConnectEvent(
     ::nearby::proto::fastpair::FastPairEvent::ConnectErrorCode error_code,
     int profile_uuid) {
-  auto fast_pair_log = std::make_unique<FastPairLog>();
-
-  auto connect_event = FastPairLog::ConnectEvent::default_instance().New();
-  connect_event->set_error_code(error_code);
-  connect_event->set_profile_uuid(profile_uuid);
-
-  fast_pair_log->set_allocated_connect_event(connect_event);
-  LogEvent(*fast_pair_log);
+  AddEvent([error_code, profile_uuid](FastPairLog& fast_pair_log) {
+    auto* connect_event = fast_pair_log.mutable_connect_event();
+    connect_event->set_error_code(error_code);
+    connect_event->set_profile_uuid(profile_uuid);
+  });
 }
 
 void AnalyticsRecorder::NewProviderInfo(int number_account_keys_on_provider) {
-  auto fast_pair_log = std::make_unique<FastPairLog>();
-
-  auto provider_info = FastPairLog::ProviderInfo::default_instance().New();
-  provider_info->set_number_account_keys_on_provider(
-      number_account_keys_on_provider);
-
-  fast_pair_log->set_allocated_provider_info(provider_info);
-  LogEvent(*fast_pair_log);
+  AddEvent([number_account_keys_on_provider](FastPairLog& fast_pair_log) {
+    fast_pair_log.mutable_provider_info()->set_number_account_keys_on_provider(
+        number_account_keys_on_provider);
+  });
 }
 
 void AnalyticsRecorder::NewFootprintsInfo(int number_devices_on_footprints) {
-  auto fast_pair_log = std::make_unique<FastPairLog>();
-
-  auto footprints_info = FastPairLog::FootprintsInfo::default_instance().New();
-  footprints_info->set_number_devices_on_footprints(
-      number_devices_on_footprints);
-
-  fast_pair_log->set_allocated_footprints_info(footprints_info);
-  LogEvent(*fast_pair_log);
+  AddEvent([number_devices_on_footprints](FastPairLog& fast_pair_log) {
+    fast_pair_log.mutable_footprints_info()->set_number_devices_on_footprints(
+        number_devices_on_footprints);
+  });
 }
 
 void AnalyticsRecorder::NewKeyBasedPairingInfo(int request_flag,
                                                int response_type,
                                                int response_flag,
                                                int response_device_count) {
-  auto fast_pair_log = std::make_unique<FastPairLog>();
-
-  auto key_based_pairing_info =
-      FastPairLog::KeyBasedPairingInfo::default_instance().New();
-  key_based_pairing_info->set_request_flag(request_flag);
-  key_based_pairing_info->set_response_flag(response_flag);
-  key_based_pairing_info->set_response_device_count(response_device_count);
-  key_based_pairing_info->set_response_type(response_type);
+  AddEvent([request_flag, response_type, response_flag,
+            response_device_count](FastPairLog& fast_pair_log) {
+    auto* key_based_pairing_info =
+        fast_pair_log.mutable_key_based_pairing_info();
+    key_based_pairing_info->set_request_flag(request_flag);
+    key_based_pairing_info->set_response_flag(response_flag);
+    key_based_pairing_info->set_response_device_count(response_device_count);
+    key_based_pairing_info->set_response_type(response_type);
+  });
+}
 
-  fast_pair_log->set_allocated_key_based_pairing_info(key_based_pairing_info);
-  LogEvent(*fast_pair_log);
+void AnalyticsRecorder::Flush() {
+  executor_.Execute([this]() { LogPendingEvents(); });
 }
 
 // start private methods
 
-void AnalyticsRecorder::LogEvent(const ::google::protobuf::MessageLite& message) {
+void AnalyticsRecorder::AddEvent(Event event) {
   if (event_logger_ == nullptr) {
     return;
   }
-  event_logger_->Log(message);
+  MutexLock lock(&mutex_);
+  pending_events_.push_back(std::move(event));
+  if (pending_events_.size() >= kMaxBatchSize) {
+    executor_.Execute([this]() { LogPendingEvents(); });
+    return;
+  }
+  if (flush_scheduled_) {
+    return;
+  }
+  flush_scheduled_ = true;
+  executor_.Schedule([this]() { LogPendingEvents(); }, kFlushDelay);
+}
+
+void AnalyticsRecorder::LogPendingEvents() {
+  std::vector<Event> events;
+  {
+    MutexLock lock(&mutex_);
+    events.swap(pending_events_);
+    flush_scheduled_ = false;
+  }
+  LogEvents(std::move(events));
+}
+
+void AnalyticsRecorder::LogEvents(std::vector<Event> events) {
+  for (const Event& event : events) {
+    FastPairLog fast_pair_log;
+    event(fast_pair_log);
+    event_logger_->Log(fast_pair_log);
+  }
 }
 
 }  // namespace analytics
@@ -15,9 +15,15 @@
 #ifndef THIRD_PARTY_NEARBY_FASTPAIR_ANALYTICS_ANALYTICS_RECORDER_H_
 #define THIRD_PARTY_NEARBY_FASTPAIR_ANALYTICS_ANALYTICS_RECORDER_H_
 
+#include <functional>
 #include <memory>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/time/time.h"
 #include "internal/analytics/event_logger.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/scheduled_executor.h"
 #include "internal/proto/analytics/fast_pair_log.proto.h"
 #include "proto/fast_pair_enums.proto.h"
 #include "third_party/protobuf/message_lite.h"
@@ -26,11 +32,22 @@ namespace nearby {
 namespace fastpair {
 namespace analytics {
 
+// Records Fast Pair events. The events are buffered, and built into logs and
+// handed to the event logger in batches on a background thread, so that
+// recording doesn't hold up the caller during time-critical pairing steps.
+//
+// Thread-safe.
 class AnalyticsRecorder {
  public:
+  // A batch is logged right away once it holds this many events.
+  static constexpr int kMaxBatchSize = 32;
+  // Otherwise, events are logged this long after the first one of a batch.
+  static constexpr absl::Duration kFlushDelay = absl::Milliseconds(500);
+
   explicit AnalyticsRecorder(::nearby::analytics::EventLogger* event_logger)
       : event_logger_(event_logger) {}
-  ~AnalyticsRecorder() = default;
+  // Logs the pending events before returning.
+  ~AnalyticsRecorder();
 
   void NewGattEvent(int error_from_os);
 
@@ -55,11 +72,24 @@ class AnalyticsRecorder {
   void NewKeyBasedPairingInfo(int request_flag, int response_type,
                               int response_flag, int response_device_count);
 
- private:
-  std::unique_ptr<::nearby::proto::fastpair::FastPairLog> createFastPairLog();
-  void LogEvent(const ::google::protobuf::MessageLite& message);
+  // Logs the pending events on the background thread without waiting for the
+  // batch to fill up.
+  void Flush();
 
-  ::nearby::analytics::EventLogger* event_logger_ = nullptr;
+ private:
+  // Fills in the log of an event. Only captures the event's fields, so that
+  // building the log is left to the background thread.
+  using Event = std::function<void(::nearby::proto::fastpair::FastPairLog&)>;
+
+  void AddEvent(Event event);
+  void LogPendingEvents();
+  void LogEvents(std::vector<Event> events);
+
+  ::nearby::analytics::EventLogger* const event_logger_ = nullptr;
+  Mutex mutex_;
+  std::vector<Event> pending_events_ ABSL_GUARDED_BY(mutex_);
+  bool flush_scheduled_ ABSL_GUARDED_BY(mutex_) = false;
+  ScheduledExecutor executor_;
 };
 
 }  // namespace analytics
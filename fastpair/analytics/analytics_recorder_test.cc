@@ -15,11 +15,16 @@
 #include "fastpair/analytics/analytics_recorder.h"
 
 #include <memory>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "protobuf-matchers/protocol-buffer-matchers.h"
 #include "gtest/gtest.h"
+#include "absl/time/time.h"
 #include "internal/analytics/event_logger.h"
+#include "internal/platform/count_down_latch.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/mutex_lock.h"
 #include "internal/proto/analytics/fast_pair_log.proto.h"
 #include "proto/fast_pair_enums.proto.h"
 #include "third_party/protobuf/message_lite.h"
@@ -47,7 +52,7 @@ class AnalyticsRecorderTest : public ::testing::Test {
 
   const MockEventLogger& event_logger() { return event_logger_; }
 
-  AnalyticsRecorder analytics_recoder() { return analytics_recorder_; }
+  AnalyticsRecorder& analytics_recoder() { return analytics_recorder_; }
 
  private:
   MockEventLogger event_logger_;
@@ -134,6 +139,48 @@ TEST_F(AnalyticsRecorderTest, NewKeyBasedPairingInfo) {
   analytics_recoder().NewKeyBasedPairingInfo(16, 17, 18, 19);
 }
 
+TEST_F(AnalyticsRecorderTest, LogsFullBatchInOrder) {
+  CountDownLatch logged(AnalyticsRecorder::kMaxBatchSize);
+  Mutex mutex;
+  std::vector<int> account_keys;
+  EXPECT_CALL(event_logger(), Log)
+      .Times(AnalyticsRecorder::kMaxBatchSize)
+      .WillRepeatedly([&](const ::google::protobuf::MessageLite& message) {
+        auto log = dynamic_cast<const FastPairLog*>(&message);
+        ASSERT_NE(log, nullptr);
+        MutexLock lock(&mutex);
+        account_keys.push_back(
+            log->provider_info().number_account_keys_on_provider());
+        logged.CountDown();
+      });
+
+  std::vector<int> expected_account_keys;
+  for (int i = 0; i < AnalyticsRecorder::kMaxBatchSize; ++i) {
+    analytics_recoder().NewProviderInfo(i);
+    expected_account_keys.push_back(i);
+  }
+
+  EXPECT_TRUE(logged.Await(absl::Seconds(1)).result());
+  MutexLock lock(&mutex);
+  EXPECT_EQ(account_keys, expected_account_keys);
+}
+
+TEST_F(AnalyticsRecorderTest, FlushLogsPendingEvents) {
+  CountDownLatch logged(1);
+  EXPECT_CALL(event_logger(), Log)
+      .WillOnce([&](const ::google::protobuf::MessageLite& message) {
+        auto log = dynamic_cast<const FastPairLog*>(&message);
+        ASSERT_NE(log, nullptr);
+        EXPECT_EQ(log->footprints_info().number_devices_on_footprints(), 20);
+        logged.CountDown();
+      });
+
+  analytics_recoder().NewFootprintsInfo(20);
+  analytics_recoder().Flush();
+
+  EXPECT_TRUE(logged.Await(absl::Seconds(1)).result());
+}
+
 }  // namespace
 }  // namespace analytics
 }  // namespace fastpair
@@ -17,10 +17,13 @@
 #include <algorithm>
 #include <array>
 #include <cstdint>
+#include <optional>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/string_view.h"
 #include "fastpair/common/battery_notification.h"
+#include "fastpair/common/constant.h"
 #include "fastpair/common/non_discoverable_advertisement.h"
 #include "internal/crypto/sha2.h"
 #include "internal/platform/logging.h"
@@ -40,30 +43,9 @@ constexpr uint8_t kInUseByte = 0x06;
 constexpr uint8_t kShowUi = 0b00110011;
 constexpr uint8_t kHideUi = 0b00110100;
 
-// Helper to AccountKeyFilter::IsAccountKeyInFilter().
-// Performs the test to see if |data| is in |bit_sets|, a Bloom filter.
-bool AccountKeyFilterChecker(const std::vector<uint8_t>& data,
-                             const std::vector<uint8_t>& bit_sets) {
-  std::array<uint8_t, 32> hashed = crypto::SHA256Hash(data);
-
-  // Iterate over the hashed input in 4 byte increments, combine those 4
-  // bytes into an unsigned int and use it as the index into our
-  // |bit_sets|.
-  for (size_t i = 0; i < hashed.size(); i += 4) {
-    uint32_t hash = uint32_t{hashed[i]} << 24 | uint32_t{hashed[i + 1]} << 16 |
-                    uint32_t{hashed[i + 2]} << 8 | hashed[i + 3];
-
-    size_t num_bits = bit_sets.size() * kBitsInByte;
-    size_t n = hash % num_bits;
-    size_t byte_index = floor(n / kBitsInByte);
-    size_t bit_index = n % kBitsInByte;
-    bool is_set = (bit_sets[byte_index] >> bit_index) & 0x01;
-
-    if (!is_set) return false;
-  }
-  NEARBY_LOGS(INFO) << __func__ << " The accountkey is possibly in set.";
-  return true;
-}
+// Salt values only repeat while the peripheral doesn't rotate its salt, so a
+// few of them are enough.
+constexpr int kMaxCachedSaltValues = 8;
 
 }  // namespace
 
@@ -95,6 +77,23 @@ AccountKeyFilter::AccountKeyFilter(
     const std::vector<uint8_t>& salt_values)
     : bit_sets_(account_key_filter_bytes), salt_values_(salt_values) {}
 
+bool AccountKeyFilter::ContainsHash(const std::array<uint8_t, 32>& hash) const {
+  if (bit_sets_.empty()) return false;
+  const size_t num_bits = bit_sets_.size() * kBitsInByte;
+  // Iterate over the hashed input in 4 byte increments, combine those 4
+  // bytes into an unsigned int and use it as the index into our
+  // |bit_sets_|.
+  for (size_t i = 0; i < hash.size(); i += 4) {
+    uint32_t value = uint32_t{hash[i]} << 24 | uint32_t{hash[i + 1]} << 16 |
+                     uint32_t{hash[i + 2]} << 8 | hash[i + 3];
+    size_t n = value % num_bits;
+    if (!((bit_sets_[n / kBitsInByte] >> (n % kBitsInByte)) & 0x01)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool AccountKeyFilter::IsPossiblyInSet(const AccountKey& account_key) {
   if (!account_key.Ok()) {
     NEARBY_LOGS(INFO) << __func__ << " Invalid account key.";
@@ -110,15 +109,54 @@ bool AccountKeyFilter::IsPossiblyInSet(const AccountKey& account_key) {
   // We need to try account keys with different first bytes in case
   // the peripheral is SASS per
   // https://developers.google.com/nearby/fast-pair/early-access/specifications/extensions/sass#SassAdvertisingPayload
-  if (AccountKeyFilterChecker(data, bit_sets_)) {
-    return true;
+  for (uint8_t first_byte : {data[0], kRecentlyUsedByte, kInUseByte}) {
+    data[0] = first_byte;
+    if (ContainsHash(crypto::SHA256Hash(data))) {
+      NEARBY_LOGS(INFO) << __func__ << " The accountkey is possibly in set.";
+      return true;
+    }
+  }
+  return false;
+}
+
+AccountKeyMatcher::AccountKeyMatcher(std::vector<AccountKey> account_keys)
+    : account_keys_(std::move(account_keys)) {}
+
+std::optional<AccountKey> AccountKeyMatcher::FindPossibleMatch(
+    const AccountKeyFilter& filter) {
+  if (filter.empty()) return std::nullopt;
+  const std::vector<KeyHashes>& hashes = GetHashes(filter.salt_values());
+  for (size_t i = 0; i < account_keys_.size(); ++i) {
+    if (!account_keys_[i].Ok()) continue;
+    for (const Hash& hash : hashes[i]) {
+      if (filter.ContainsHash(hash)) return account_keys_[i];
+    }
   }
-  data[0] = kRecentlyUsedByte;
-  if (AccountKeyFilterChecker(data, bit_sets_)) {
-    return true;
+  return std::nullopt;
+}
+
+const std::vector<AccountKeyMatcher::KeyHashes>& AccountKeyMatcher::GetHashes(
+    const std::vector<uint8_t>& salt_values) {
+  auto it = hashes_.find(salt_values);
+  if (it != hashes_.end()) return it->second;
+  if (hashes_.size() >= kMaxCachedSaltValues) hashes_.clear();
+
+  std::vector<KeyHashes> hashes(account_keys_.size());
+  // One buffer for all the keys, only the key bytes change between them.
+  std::vector<uint8_t> data(kAccountKeySize);
+  data.insert(data.end(), salt_values.begin(), salt_values.end());
+  for (size_t i = 0; i < account_keys_.size(); ++i) {
+    const AccountKey& account_key = account_keys_[i];
+    if (!account_key.Ok()) continue;
+    std::copy(account_key.GetAsBytes().begin(), account_key.GetAsBytes().end(),
+              data.begin());
+    hashes[i][0] = crypto::SHA256Hash(data);
+    data[0] = kRecentlyUsedByte;
+    hashes[i][1] = crypto::SHA256Hash(data);
+    data[0] = kInUseByte;
+    hashes[i][2] = crypto::SHA256Hash(data);
   }
-  data[0] = kInUseByte;
-  return AccountKeyFilterChecker(data, bit_sets_);
+  return hashes_.emplace(salt_values, std::move(hashes)).first->second;
 }
 
 }  // namespace fastpair
@@ -15,9 +15,12 @@
 #ifndef THIRD_PARTY_NEARBY_FASTPAIR_COMMON_ACCOUNT_KEY_FILTER_H_
 #define THIRD_PARTY_NEARBY_FASTPAIR_COMMON_ACCOUNT_KEY_FILTER_H_
 
+#include <array>
 #include <cstdint>
+#include <optional>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "fastpair/common/account_key.h"
 #include "fastpair/common/non_discoverable_advertisement.h"
 
@@ -38,11 +41,47 @@ class AccountKeyFilter {
   // Return false if `account_key` is definitely not in set.
   bool IsPossiblyInSet(const AccountKey& account_key);
 
+  // Returns true if the SHA-256 `hash` of an account key and the salt values
+  // is possibly in the filter.
+  bool ContainsHash(const std::array<uint8_t, 32>& hash) const;
+
+  bool empty() const { return bit_sets_.empty(); }
+
+  // The salt, followed by the battery information when there is one, which
+  // are appended to the account keys to build the filter.
+  const std::vector<uint8_t>& salt_values() const { return salt_values_; }
+
  private:
   std::vector<uint8_t> bit_sets_;
   std::vector<uint8_t> salt_values_;
 };
 
+// Matches a fixed set of account keys, the saved ones, against the filters of
+// the advertisements received.
+//
+// The hashes of the account keys are computed once per salt values, for all
+// the keys at once, and reused for the next advertisements with the same salt
+// values. Not thread-safe.
+class AccountKeyMatcher {
+ public:
+  explicit AccountKeyMatcher(std::vector<AccountKey> account_keys);
+
+  // Returns the first account key possibly in `filter`, if any.
+  std::optional<AccountKey> FindPossibleMatch(const AccountKeyFilter& filter);
+
+ private:
+  using Hash = std::array<uint8_t, 32>;
+  // The hashes of an account key with each of the SASS first bytes.
+  using KeyHashes = std::array<Hash, 3>;
+
+  const std::vector<KeyHashes>& GetHashes(
+      const std::vector<uint8_t>& salt_values);
+
+  std::vector<AccountKey> account_keys_;
+  // Hashes of `account_keys_`, in order, by salt values.
+  absl::flat_hash_map<std::vector<uint8_t>, std::vector<KeyHashes>> hashes_;
+};
+
 }  // namespace fastpair
 }  // namespace nearby
 
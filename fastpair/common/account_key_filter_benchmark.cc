@@ -0,0 +1,114 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks for matching saved account keys against the account key filter
+// of a non-discoverable Fast Pair advertisement.
+//
+// Arguments are {filter_keys, saved_keys}: the filter is built from
+// filter_keys account keys, and every iteration checks saved_keys account
+// keys against it, only the last of which is in the filter. This is the work
+// a seeker does for each advertisement it receives.
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "fastpair/common/account_key.h"
+#include "fastpair/common/account_key_filter.h"
+#include "internal/crypto/sha2.h"
+
+namespace nearby {
+namespace fastpair {
+namespace {
+
+constexpr int kBitsInByte = 8;
+
+// Builds the Bloom filter of `account_keys` as described at
+// https://developers.google.com/nearby/fast-pair/specifications/service/provider#AccountKeyFilter
+std::vector<uint8_t> BuildFilter(const std::vector<AccountKey>& account_keys,
+                                 const std::vector<uint8_t>& salt) {
+  std::vector<uint8_t> filter(account_keys.size() * 6 / 5 + 3, 0);
+  const size_t num_bits = filter.size() * kBitsInByte;
+  for (const AccountKey& account_key : account_keys) {
+    std::vector<uint8_t> data(account_key.GetAsBytes().begin(),
+                              account_key.GetAsBytes().end());
+    data.insert(data.end(), salt.begin(), salt.end());
+    std::array<uint8_t, 32> hashed = crypto::SHA256Hash(data);
+    for (size_t i = 0; i < hashed.size(); i += 4) {
+      uint32_t hash = uint32_t{hashed[i]} << 24 |
+                      uint32_t{hashed[i + 1]} << 16 |
+                      uint32_t{hashed[i + 2]} << 8 | hashed[i + 3];
+      size_t n = hash % num_bits;
+      filter[n / kBitsInByte] |= 1 << (n % kBitsInByte);
+    }
+  }
+  return filter;
+}
+
+void BM_AccountKeyFilterIsPossiblyInSet(benchmark::State& state) {
+  const std::vector<uint8_t> salt = {0x11, 0x22};
+  std::vector<AccountKey> filter_keys;
+  for (int i = 0; i < state.range(0); ++i) {
+    filter_keys.push_back(AccountKey::CreateRandomKey());
+  }
+  std::vector<AccountKey> saved_keys;
+  for (int i = 1; i < state.range(1); ++i) {
+    saved_keys.push_back(AccountKey::CreateRandomKey());
+  }
+  saved_keys.push_back(filter_keys.back());
+
+  AccountKeyFilter filter(BuildFilter(filter_keys, salt), salt);
+  for (auto _ : state) {
+    for (const AccountKey& account_key : saved_keys) {
+      if (filter.IsPossiblyInSet(account_key)) break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * saved_keys.size());
+}
+
+BENCHMARK(BM_AccountKeyFilterIsPossiblyInSet)
+    ->ArgNames({"filter_keys", "saved_keys"})
+    ->ArgsProduct({{1, 5, 10}, {1, 16, 128}});
+
+// Same as above with an AccountKeyMatcher, for advertisements repeating their
+// salt, as they do between salt rotations.
+void BM_AccountKeyMatcherFindPossibleMatch(benchmark::State& state) {
+  const std::vector<uint8_t> salt = {0x11, 0x22};
+  std::vector<AccountKey> filter_keys;
+  for (int i = 0; i < state.range(0); ++i) {
+    filter_keys.push_back(AccountKey::CreateRandomKey());
+  }
+  std::vector<AccountKey> saved_keys;
+  for (int i = 1; i < state.range(1); ++i) {
+    saved_keys.push_back(AccountKey::CreateRandomKey());
+  }
+  saved_keys.push_back(filter_keys.back());
+
+  AccountKeyFilter filter(BuildFilter(filter_keys, salt), salt);
+  AccountKeyMatcher matcher(saved_keys);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(matcher.FindPossibleMatch(filter));
+  }
+  state.SetItemsProcessed(state.iterations() * saved_keys.size());
+}
+
+BENCHMARK(BM_AccountKeyMatcherFindPossibleMatch)
+    ->ArgNames({"filter_keys", "saved_keys"})
+    ->ArgsProduct({{1, 5, 10}, {1, 16, 128}});
+
+}  // namespace
+}  // namespace fastpair
+}  // namespace nearby
@@ -130,6 +130,46 @@ TEST_F(AccountKeyFilterTest, SassEnabledPeripheral) {
       AccountKeyFilter(filter4, salt_values).IsPossiblyInSet(account_key_3));
 }
 
+TEST_F(AccountKeyFilterTest, MatcherFindsAccountKey) {
+  AccountKeyMatcher matcher(
+      {AccountKey(""), AccountKey(account_key_2_), AccountKey(account_key_1_)});
+
+  EXPECT_EQ(matcher.FindPossibleMatch(AccountKeyFilter(filter_1_, salt_)),
+            AccountKey(account_key_1_));
+  EXPECT_EQ(matcher.FindPossibleMatch(AccountKeyFilter(filter_2_, salt_)),
+            AccountKey(account_key_2_));
+  EXPECT_FALSE(
+      matcher.FindPossibleMatch(AccountKeyFilter({}, salt_)).has_value());
+}
+
+TEST_F(AccountKeyFilterTest, MatcherWithDifferentSaltValues) {
+  AccountKeyMatcher matcher({AccountKey(account_key_1_)});
+  std::vector<uint8_t> salt_values = salt_;
+  for (auto& byte : battery_data_) salt_values.push_back(byte);
+
+  EXPECT_TRUE(matcher.FindPossibleMatch(AccountKeyFilter(filter_1_, salt_))
+                  .has_value());
+  EXPECT_TRUE(matcher
+                  .FindPossibleMatch(
+                      AccountKeyFilter(filter_1_with_battery_, salt_values))
+                  .has_value());
+  EXPECT_FALSE(matcher.FindPossibleMatch(AccountKeyFilter(filter_1_, {0x01}))
+                   .has_value());
+}
+
+TEST_F(AccountKeyFilterTest, MatcherWithSassEnabledPeripheral) {
+  const std::vector<uint8_t> bytes{0x06, 0x3F, 0xC1, 0x8C, 0x63, 0xDC,
+                                   0x75, 0x1A, 0xE8, 0x1A, 0xCF, 0x65,
+                                   0x10, 0x15, 0x1D, 0xB0};
+  const std::vector<uint8_t> filter{0x19, 0x23, 0x50, 0xE8, 0x37,
+                                    0x68, 0xF0, 0x65, 0x22};
+  const std::vector<uint8_t> salt_values{0xD7, 0xDE, 0x33, 0xE4, 0xE4, 0x64};
+  AccountKeyMatcher matcher({AccountKey(bytes)});
+
+  EXPECT_EQ(matcher.FindPossibleMatch(AccountKeyFilter(filter, salt_values)),
+            AccountKey(bytes));
+}
+
 }  // namespace
 }  // namespace fastpair
 }  // namespace nearby
@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
 #include "absl/strings/string_view.h"
 #include "fastpair/common/account_key.h"
 #include "fastpair/common/device_metadata.h"
@@ -53,6 +54,7 @@ class FastPairDevice {
 
   void SetPublicAddress(absl::string_view address) {
     public_address_ = std::string(address);
+    OnIdentifiersChanged();
   }
 
   std::optional<std::string> GetDisplayName() const { return display_name_; }
@@ -74,12 +76,14 @@ class FastPairDevice {
 
   void SetModelId(absl::string_view model_id) {
     model_id_ = std::string(model_id);
+    OnIdentifiersChanged();
   }
 
   absl::string_view GetModelId() const { return model_id_; }
 
   void SetBleAddress(absl::string_view address) {
     ble_address_ = std::string(address);
+    OnIdentifiersChanged();
   }
 
   absl::string_view GetBleAddress() const { return ble_address_; }
@@ -97,7 +101,17 @@ class FastPairDevice {
     return ble_address_;
   }
 
+  // Sets the callback run after the model ID, BLE or public address changes.
+  // Used by `FastPairDeviceRepository` to keep its indices up to date.
+  void SetIdentifiersChangedCallback(absl::AnyInvocable<void()> callback) {
+    identifiers_changed_callback_ = std::move(callback);
+  }
+
  private:
+  void OnIdentifiersChanged() {
+    if (identifiers_changed_callback_) identifiers_changed_callback_();
+  }
+
   std::string model_id_;
 
   // Bluetooth LE address of the device.
@@ -126,6 +140,8 @@ class FastPairDevice {
   AccountKey account_key_;
 
   std::optional<DeviceMetadata> metadata_;
+
+  absl::AnyInvocable<void()> identifiers_changed_callback_;
 };
 
 std::ostream& operator<<(std::ostream& stream, const FastPairDevice& device);
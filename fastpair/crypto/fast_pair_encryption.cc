@@ -31,6 +31,7 @@
 
 #include "fastpair/common/constant.h"
 #include "fastpair/crypto/fast_pair_key_pair.h"
+#include "fastpair/crypto/fast_pair_key_pool.h"
 #include "fastpair/crypto/fast_pair_message_type.h"
 #include "internal/platform/logging.h"
 #include <openssl/aes.h>
@@ -86,13 +87,12 @@ std::optional<KeyPair> FastPairEncryption::GenerateKeysWithEcdhKeyAgreement(
     return std::nullopt;
   }
 
-  // Generate the secp256r1 key-pair.
+  // Take a secp256r1 key-pair, generated ahead of time.
   bssl::UniquePtr<EC_GROUP> ec_group(
       EC_GROUP_new_by_curve_name(NID_X9_62_prime256v1));
-  bssl::UniquePtr<EC_KEY> ec_key(
-      EC_KEY_new_by_curve_name(NID_X9_62_prime256v1));
+  bssl::UniquePtr<EC_KEY> ec_key = FastPairKeyPool::GetInstance().Take();
 
-  if (!EC_KEY_generate_key(ec_key.get())) {
+  if (!ec_key) {
     NEARBY_LOGS(INFO) << __func__ << ": Failed to generate ec key";
     return std::nullopt;
   }
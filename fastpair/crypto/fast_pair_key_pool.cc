@@ -0,0 +1,86 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fastpair/crypto/fast_pair_key_pool.h"
+
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+#include "internal/platform/logging.h"
+#include <openssl/base.h>
+#include <openssl/ec_key.h>
+#include <openssl/nid.h>
+
+namespace nearby {
+namespace fastpair {
+
+// static
+FastPairKeyPool& FastPairKeyPool::GetInstance() {
+  static FastPairKeyPool* pool = new FastPairKeyPool();
+  return *pool;
+}
+
+FastPairKeyPool::FastPairKeyPool(int size) : size_(size) {
+  absl::MutexLock lock(&mutex_);
+  Refill();
+}
+
+bssl::UniquePtr<EC_KEY> FastPairKeyPool::Take() {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!keys_.empty()) {
+      bssl::UniquePtr<EC_KEY> key = std::move(keys_.front());
+      keys_.pop_front();
+      Refill();
+      return key;
+    }
+    Refill();
+  }
+  return Generate();
+}
+
+int FastPairKeyPool::size() const {
+  absl::MutexLock lock(&mutex_);
+  return keys_.size();
+}
+
+// static
+bssl::UniquePtr<EC_KEY> FastPairKeyPool::Generate() {
+  bssl::UniquePtr<EC_KEY> key(EC_KEY_new_by_curve_name(NID_X9_62_prime256v1));
+  if (!key || !EC_KEY_generate_key(key.get())) {
+    NEARBY_LOGS(INFO) << __func__ << ": Failed to generate ec key";
+    return nullptr;
+  }
+  return key;
+}
+
+void FastPairKeyPool::Refill() {
+  if (refilling_ || keys_.size() >= size_) return;
+  refilling_ = true;
+  executor_.Execute("fast-pair-key-pool-refill", [this]() {
+    absl::MutexLock lock(&mutex_);
+    while (keys_.size() < size_) {
+      // Generated without the lock, so that Take() doesn't wait for it.
+      mutex_.Unlock();
+      bssl::UniquePtr<EC_KEY> key = Generate();
+      mutex_.Lock();
+      if (!key) break;
+      keys_.push_back(std::move(key));
+    }
+    refilling_ = false;
+  });
+}
+
+}  // namespace fastpair
+}  // namespace nearby
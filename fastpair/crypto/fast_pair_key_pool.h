@@ -0,0 +1,65 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_NEARBY_FASTPAIR_CRYPTO_FAST_PAIR_KEY_POOL_H_
+#define THIRD_PARTY_NEARBY_FASTPAIR_CRYPTO_FAST_PAIR_KEY_POOL_H_
+
+#include <deque>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "internal/platform/single_thread_executor.h"
+#include <openssl/base.h>
+#include <openssl/ec_key.h>
+
+namespace nearby {
+namespace fastpair {
+
+// Generates the seeker's ephemeral secp256r1 key pairs ahead of the handshakes
+// that use them, on a background thread, since generating one takes a while on
+// slow devices. Each key pair is handed out once. Thread-safe.
+class FastPairKeyPool {
+ public:
+  static constexpr int kDefaultSize = 2;
+
+  // The pool used by the handshakes. Starts filling up on first use.
+  static FastPairKeyPool& GetInstance();
+
+  explicit FastPairKeyPool(int size = kDefaultSize);
+  FastPairKeyPool(const FastPairKeyPool&) = delete;
+  FastPairKeyPool& operator=(const FastPairKeyPool&) = delete;
+
+  // Returns a pre-generated key pair, or generates one if there is none left,
+  // and refills the pool in the background. Returns null if key generation
+  // fails.
+  bssl::UniquePtr<EC_KEY> Take() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  int size() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  static bssl::UniquePtr<EC_KEY> Generate();
+  void Refill() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const int size_;
+  mutable absl::Mutex mutex_;
+  std::deque<bssl::UniquePtr<EC_KEY>> keys_ ABSL_GUARDED_BY(mutex_);
+  bool refilling_ ABSL_GUARDED_BY(mutex_) = false;
+  // Destroyed first, so that a running refill finishes before the keys go.
+  SingleThreadExecutor executor_;
+};
+
+}  // namespace fastpair
+}  // namespace nearby
+
+#endif  // THIRD_PARTY_NEARBY_FASTPAIR_CRYPTO_FAST_PAIR_KEY_POOL_H_
@@ -0,0 +1,75 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fastpair/crypto/fast_pair_key_pool.h"
+
+#include "gtest/gtest.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include <openssl/base.h>
+#include <openssl/bn.h>
+#include <openssl/ec_key.h>
+
+namespace nearby {
+namespace fastpair {
+namespace {
+
+void WaitForSize(const FastPairKeyPool& pool, int size) {
+  absl::Time deadline = absl::Now() + absl::Seconds(10);
+  while (pool.size() < size && absl::Now() < deadline) {
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+}
+
+TEST(FastPairKeyPoolTest, FillsUpInBackground) {
+  FastPairKeyPool pool(3);
+
+  WaitForSize(pool, 3);
+
+  EXPECT_EQ(pool.size(), 3);
+}
+
+TEST(FastPairKeyPoolTest, HandsOutEachKeyOnce) {
+  FastPairKeyPool pool(2);
+  WaitForSize(pool, 2);
+
+  bssl::UniquePtr<EC_KEY> first = pool.Take();
+  bssl::UniquePtr<EC_KEY> second = pool.Take();
+  bssl::UniquePtr<EC_KEY> third = pool.Take();
+
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  ASSERT_NE(third, nullptr);
+  EXPECT_NE(BN_cmp(EC_KEY_get0_private_key(first.get()),
+                   EC_KEY_get0_private_key(second.get())),
+            0);
+  EXPECT_NE(BN_cmp(EC_KEY_get0_private_key(second.get()),
+                   EC_KEY_get0_private_key(third.get())),
+            0);
+}
+
+TEST(FastPairKeyPoolTest, RefillsAfterTake) {
+  FastPairKeyPool pool(2);
+  WaitForSize(pool, 2);
+
+  pool.Take();
+  pool.Take();
+  WaitForSize(pool, 2);
+
+  EXPECT_EQ(pool.size(), 2);
+}
+
+}  // namespace
+}  // namespace fastpair
+}  // namespace nearby
@@ -14,11 +14,14 @@
 
 #include "fastpair/dart/windows/fast_pair_service_adapter_dart.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/time/time.h"
 #include "third_party/dart_lang/v2/runtime/include/dart_api.h"
 #include "fastpair/dart/proto/callbacks.proto.h"
 #include "fastpair/dart/proto/enum.proto.h"
@@ -27,14 +30,23 @@
 #include "fastpair/proto/fastpair_rpcs.proto.h"
 #include "fastpair/ui/fast_pair/fast_pair_notification_controller.h"
 #include "internal/platform/logging.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/mutex_lock.h"
+#include "internal/platform/scheduled_executor.h"
+#include "internal/platform/system_clock.h"
 
 namespace nearby {
 namespace fastpair {
 namespace windows {
 namespace {
+// Device updates come in bursts while scanning, so they are coalesced into one
+// message, posted at most once every kUpdateInterval, instead of one message
+// each. Only the latest update of each device is kept.
 class NotificationControllerObserver
     : public FastPairNotificationController::Observer {
  public:
+  static constexpr absl::Duration kUpdateInterval = absl::Milliseconds(100);
+
   explicit NotificationControllerObserver(Dart_Port port)
       : callback_dart_(port) {}
 
@@ -42,8 +54,33 @@ class NotificationControllerObserver
     NEARBY_LOGS(INFO) << __func__
                       << ": The on update device is triggered for dart. "
                       << device.GetDetails().name();
-    const std::string device_proto =
-        SerializeDeviceChanged(device).SerializeAsString();
+    MutexLock lock(&mutex_);
+    auto *devices = pending_.mutable_devices();
+    auto it = std::find_if(devices->begin(), devices->end(),
+                           [&device](const auto &pending) {
+                             return pending.id() == device.GetDetails().id();
+                           });
+    if (it != devices->end()) {
+      *it = device.GetDetails();
+    } else {
+      *pending_.add_devices() = device.GetDetails();
+    }
+    if (flush_scheduled_) return;
+
+    flush_scheduled_ = true;
+    absl::Duration delay =
+        std::max(last_post_time_ + kUpdateInterval -
+                     SystemClock::ElapsedRealtime(),
+                 absl::ZeroDuration());
+    flush_executor_.Schedule([this]() { Flush(); }, delay);
+  }
+
+ private:
+  void Flush() {
+    MutexLock lock(&mutex_);
+    flush_scheduled_ = false;
+    if (pending_.devices().empty()) return;
+    const std::string device_proto = pending_.SerializeAsString();
     Dart_CObject object_device = {
         .type = Dart_CObject_Type::Dart_CObject_kTypedData,
         .value = {
@@ -52,19 +89,21 @@ class NotificationControllerObserver
                            .values = (uint8_t *)device_proto.data()}}};
     if (!Dart_PostCObject_DL(callback_dart_, &object_device)) {
       NEARBY_LOGS(ERROR)
-          << "Failed to post OnContactsDownloaded message to dart. id = "
-          << device.GetDetails().id();
+          << "Failed to post OnContactsDownloaded message to dart. devices = "
+          << pending_.devices_size();
     }
+    pending_.clear_devices();
+    last_post_time_ = SystemClock::ElapsedRealtime();
   }
 
- private:
-  ::nearby::fastpair::dart::proto::DeviceDownloadedCallbackData
-  SerializeDeviceChanged(const DeviceMetadata &device) {
-    ::nearby::fastpair::dart::proto::DeviceDownloadedCallbackData callback;
-    callback.add_devices()->MergeFrom(device.GetDetails());
-    return callback;
-  }
   Dart_Port callback_dart_;
+  Mutex mutex_;
+  ::nearby::fastpair::dart::proto::DeviceDownloadedCallbackData pending_
+      ABSL_GUARDED_BY(mutex_);
+  bool flush_scheduled_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Time last_post_time_ ABSL_GUARDED_BY(mutex_) = absl::InfinitePast();
+  // Declared last, so that no flush runs once the rest is destroyed.
+  ScheduledExecutor flush_executor_;
 };
 }  // namespace
 
@@ -0,0 +1,35 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "fastpair/dataparser/fast_pair_decoder.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  std::vector<uint8_t> service_data(data, data + size);
+  // Like FastPairDataParser, only decode service data that has a header, and
+  // only look for the model ID once HasModelId() accepted it.
+  if (service_data.empty()) return 0;
+
+  nearby::fastpair::FastPairDecoder::GetVersion(&service_data);
+  nearby::fastpair::FastPairDecoder::GetIdLength(&service_data);
+  if (nearby::fastpair::FastPairDecoder::HasModelId(&service_data)) {
+    nearby::fastpair::FastPairDecoder::GetHexModelIdFromServiceData(
+        &service_data);
+  }
+
+  return 0;
+}
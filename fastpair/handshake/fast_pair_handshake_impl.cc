@@ -25,6 +25,8 @@
 #include "fastpair/handshake/fast_pair_data_encryptor_impl.h"
 #include "fastpair/handshake/fast_pair_gatt_service_client_impl.h"
 #include "internal/base/bluetooth_address.h"
+#include "internal/flags/nearby_flags.h"
+#include "internal/platform/flags/nearby_platform_feature_flags.h"
 #include "internal/platform/logging.h"
 #include "internal/platform/single_thread_executor.h"
 
@@ -35,12 +37,65 @@ FastPairHandshakeImpl::FastPairHandshakeImpl(FastPairDevice& device,
                                              Mediums& mediums,
                                              OnCompleteCallback on_complete,
                                              SingleThreadExecutor* executor)
-    : FastPairHandshake(std::move(on_complete), nullptr, nullptr) {
+    : FastPairHandshake(std::move(on_complete), nullptr, nullptr),
+      device_(device),
+      pipelined_(NearbyFlags::GetInstance().GetBoolFlag(
+          platform::config_package_nearby::nearby_platform_feature::
+              kEnablePipelinedFastPairHandshake)),
+      executor_(executor) {
+  Connect(mediums, executor);
+}
+
+FastPairHandshakeImpl::FastPairHandshakeImpl(FastPairDevice& device,
+                                             Mediums& mediums,
+                                             SingleThreadExecutor* executor)
+    : FastPairHandshake(nullptr, nullptr, nullptr),
+      device_(device),
+      pipelined_(true),
+      executor_(executor),
+      started_(false) {
+  Connect(mediums, executor);
+}
+
+void FastPairHandshakeImpl::Start(OnCompleteCallback on_complete) {
+  executor_->Execute(
+      "start-handshake",
+      [this, on_complete = std::move(on_complete)]() mutable {
+        NEARBY_LOGS(INFO) << __func__ << ": Starting warmed-up handshake.";
+        on_complete_callback_ = std::move(on_complete);
+        started_ = true;
+        if (failure_.has_value()) {
+          Fail(device_, *failure_);
+        } else if (gatt_initialized_ && fast_pair_data_encryptor_) {
+          WriteKeyBasedPairingRequest(device_);
+        }
+      });
+}
+
+void FastPairHandshakeImpl::Connect(Mediums& mediums,
+                                    SingleThreadExecutor* executor) {
   fast_pair_gatt_service_client_ =
-      FastPairGattServiceClientImpl::Factory::Create(device, mediums, executor);
+      FastPairGattServiceClientImpl::Factory::Create(device_, mediums,
+                                                     executor);
   fast_pair_gatt_service_client_->InitializeGattConnection(
-      [&](std::optional<PairFailure> failure) {
-        OnGattClientInitializedCallback(device, failure);
+      [this](std::optional<PairFailure> failure) {
+        OnGattClientInitializedCallback(device_, failure);
+      });
+  if (pipelined_) {
+    // The GATT connection callbacks run on `executor_` too, so the ECDH key
+    // agreement overlaps with the connection and service discovery, and
+    // whichever finishes last writes the key-based pairing request.
+    executor_->Execute("create-data-encryptor", [this]() {
+      StartDataEncryptorCreation(device_);
+    });
+  }
+}
+
+void FastPairHandshakeImpl::StartDataEncryptorCreation(FastPairDevice& device) {
+  FastPairDataEncryptorImpl::Factory::CreateAsync(
+      device,
+      [&](std::unique_ptr<FastPairDataEncryptor> fast_pair_data_encryptor) {
+        OnDataEncryptorCreateAsync(device, std::move(fast_pair_data_encryptor));
       });
 }
 
@@ -50,18 +105,19 @@ void FastPairHandshakeImpl::OnGattClientInitializedCallback(
     NEARBY_LOGS(WARNING) << __func__
                          << ": Failed to init gatt client with failure = "
                          << failure.value();
-    std::move(on_complete_callback_)(device, failure.value());
+    Fail(device, failure.value());
     return;
   }
 
   NEARBY_LOGS(INFO)
       << __func__
       << ": Fast Pair GATT service client initialization successful.";
-  FastPairDataEncryptorImpl::Factory::CreateAsync(
-      device,
-      [&](std::unique_ptr<FastPairDataEncryptor> fast_pair_data_encryptor) {
-        OnDataEncryptorCreateAsync(device, std::move(fast_pair_data_encryptor));
-      });
+  gatt_initialized_ = true;
+  if (!pipelined_) {
+    StartDataEncryptorCreation(device);
+  } else if (fast_pair_data_encryptor_) {
+    WriteKeyBasedPairingRequest(device);
+  }
 }
 
 void FastPairHandshakeImpl::OnDataEncryptorCreateAsync(
@@ -70,12 +126,24 @@ void FastPairHandshakeImpl::OnDataEncryptorCreateAsync(
   if (!fast_pair_data_encryptor) {
     NEARBY_LOGS(WARNING) << __func__
                          << ": Failed to create Fast Pair Data Encryptor.";
-    std::move(on_complete_callback_)(device,
-                                     PairFailure::kDataEncryptorRetrieval);
+    Fail(device, PairFailure::kDataEncryptorRetrieval);
     return;
   }
 
   fast_pair_data_encryptor_ = std::move(fast_pair_data_encryptor);
+  if (gatt_initialized_) WriteKeyBasedPairingRequest(device);
+}
+
+void FastPairHandshakeImpl::Fail(FastPairDevice& device, PairFailure failure) {
+  failure_ = failure;
+  if (!started_ || !on_complete_callback_) return;
+  std::move(on_complete_callback_)(device, failure);
+}
+
+void FastPairHandshakeImpl::WriteKeyBasedPairingRequest(
+    FastPairDevice& device) {
+  // The handshake failed already, or waits for Start().
+  if (!started_ || !on_complete_callback_) return;
   NEARBY_LOGS(INFO) << __func__ << ": Beginning key-based pairing protocol";
   fast_pair_gatt_service_client_->WriteRequestAsync(
       /*message_type=*/kKeyBasedPairingType,
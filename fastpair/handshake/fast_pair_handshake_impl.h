@@ -23,6 +23,7 @@
 #include "fastpair/crypto/decrypted_response.h"
 #include "fastpair/handshake/fast_pair_handshake.h"
 #include "fastpair/internal/mediums/mediums.h"
+#include "internal/platform/single_thread_executor.h"
 
 namespace nearby {
 namespace fastpair {
@@ -32,19 +33,41 @@ class FastPairHandshakeImpl : public FastPairHandshake {
   explicit FastPairHandshakeImpl(FastPairDevice& device, Mediums& mediums,
                                  OnCompleteCallback on_complete,
                                  SingleThreadExecutor* executor);
+  // Warms up a handshake: connects to |device| and creates the data encryptor,
+  // but waits for Start() before writing the Key-Based Pairing Request.
+  FastPairHandshakeImpl(FastPairDevice& device, Mediums& mediums,
+                        SingleThreadExecutor* executor);
   FastPairHandshakeImpl(const FastPairHandshakeImpl&) = delete;
   FastPairHandshakeImpl& operator=(const FastPairHandshakeImpl&) = delete;
 
+ // Lets a warmed-up handshake proceed, calling |on_complete| once finished.
+  void Start(OnCompleteCallback on_complete);
+
  private:
+  void Connect(Mediums& mediums, SingleThreadExecutor* executor);
+  void StartDataEncryptorCreation(FastPairDevice& device);
   void OnGattClientInitializedCallback(FastPairDevice& device,
                                        std::optional<PairFailure> failure);
   void OnDataEncryptorCreateAsync(
       FastPairDevice& device,
       std::unique_ptr<FastPairDataEncryptor> fast_pair_data_encryptor);
+  void WriteKeyBasedPairingRequest(FastPairDevice& device);
+  // Completes the handshake with `failure`, unless it's already completed.
+  void Fail(FastPairDevice& device, PairFailure failure);
   void OnWriteResponse(FastPairDevice& device, absl::string_view response,
                        std::optional<PairFailure> failure);
   void OnParseDecryptedResponse(FastPairDevice& device,
                                 std::optional<DecryptedResponse>& response);
+
+  FastPairDevice& device_;
+  // Whether the data encryptor is created while the GATT connection is set up.
+  const bool pipelined_;
+  SingleThreadExecutor* executor_;
+  bool gatt_initialized_ = false;
+  // False while a warmed-up handshake waits for Start().
+  bool started_ = true;
+  // The failure of a warmed-up handshake, reported on Start().
+  std::optional<PairFailure> failure_;
 };
 
 }  // namespace fastpair
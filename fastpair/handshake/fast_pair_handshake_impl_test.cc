@@ -35,8 +35,10 @@
 #include "fastpair/handshake/fast_pair_gatt_service_client_impl.h"
 #include "fastpair/proto/fastpair_rpcs.proto.h"
 #include "fastpair/server_access/fake_fast_pair_repository.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/count_down_latch.h"
+#include "internal/platform/flags/nearby_platform_feature_flags.h"
 #include "internal/platform/medium_environment.h"
 #include "internal/platform/single_thread_executor.h"
 
@@ -229,6 +231,112 @@ TEST_F(FastPairHandshakeImplTest, Success) {
   EXPECT_TRUE(handshake_->completed_successfully());
 }
 
+TEST_F(FastPairHandshakeImplTest, PipelinedSuccess) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      platform::config_package_nearby::nearby_platform_feature::
+          kEnablePipelinedFastPairHandshake,
+      true);
+  bool notified = false;
+  StartGattServer([&]() {
+    notified = true;
+    EXPECT_OK(TriggerKeyBasedGattChanged());
+  });
+  InsertCorrectGattCharacteristics();
+  fast_pair_device_ = std::make_unique<FastPairDevice>(
+      kMetadataId, provider_address_, Protocol::kFastPairInitialPairing);
+  SetUpValidAntiSpoofingKey(fast_pair_device_.get());
+  CountDownLatch latch(1);
+  handshake_ = std::make_unique<FastPairHandshakeImpl>(
+      *fast_pair_device_, mediums_,
+      [&](FastPairDevice& callback_device, std::optional<PairFailure> failure) {
+        EXPECT_EQ(fast_pair_device_.get(), &callback_device);
+        EXPECT_EQ(fast_pair_device_->GetPublicAddress(), kPublicAddress);
+        EXPECT_FALSE(failure.has_value());
+        latch.CountDown();
+      },
+      &executor_);
+  latch.Await();
+  EXPECT_TRUE(notified);
+  EXPECT_TRUE(handshake_->completed_successfully());
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST_F(FastPairHandshakeImplTest, PipelinedDataEncryptorCreateError) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      platform::config_package_nearby::nearby_platform_feature::
+          kEnablePipelinedFastPairHandshake,
+      true);
+  bool notified = false;
+  StartGattServer([&]() {
+    notified = true;
+    EXPECT_OK(TriggerKeyBasedGattChanged());
+  });
+  InsertCorrectGattCharacteristics();
+  fast_pair_device_ = std::make_unique<FastPairDevice>(
+      kMetadataId, provider_address_, Protocol::kFastPairInitialPairing);
+  SetUpInvalidAntiSpoofingKey(fast_pair_device_.get());
+  CountDownLatch latch(1);
+  handshake_ = std::make_unique<FastPairHandshakeImpl>(
+      *fast_pair_device_, mediums_,
+      [&](FastPairDevice& callback_device, std::optional<PairFailure> failure) {
+        EXPECT_EQ(fast_pair_device_.get(), &callback_device);
+        EXPECT_EQ(failure.value(), PairFailure::kDataEncryptorRetrieval);
+        latch.CountDown();
+      },
+      &executor_);
+  latch.Await();
+  EXPECT_FALSE(notified);
+  EXPECT_FALSE(handshake_->completed_successfully());
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST_F(FastPairHandshakeImplTest, WarmedUpSuccess) {
+  bool notified = false;
+  StartGattServer([&]() {
+    notified = true;
+    EXPECT_OK(TriggerKeyBasedGattChanged());
+  });
+  InsertCorrectGattCharacteristics();
+  fast_pair_device_ = std::make_unique<FastPairDevice>(
+      kMetadataId, provider_address_, Protocol::kFastPairInitialPairing);
+  SetUpValidAntiSpoofingKey(fast_pair_device_.get());
+  CountDownLatch latch(1);
+  auto handshake = std::make_unique<FastPairHandshakeImpl>(
+      *fast_pair_device_, mediums_, &executor_);
+  FastPairHandshakeImpl* warm_up = handshake.get();
+  handshake_ = std::move(handshake);
+  EXPECT_FALSE(notified);
+  warm_up->Start(
+      [&](FastPairDevice& callback_device, std::optional<PairFailure> failure) {
+        EXPECT_EQ(fast_pair_device_.get(), &callback_device);
+        EXPECT_EQ(fast_pair_device_->GetPublicAddress(), kPublicAddress);
+        EXPECT_FALSE(failure.has_value());
+        latch.CountDown();
+      });
+  latch.Await();
+  EXPECT_TRUE(notified);
+  EXPECT_TRUE(handshake_->completed_successfully());
+}
+
+TEST_F(FastPairHandshakeImplTest, WarmedUpGattError) {
+  StartGattServer([]() {});
+  fast_pair_device_ = std::make_unique<FastPairDevice>(
+      kMetadataId, provider_address_, Protocol::kFastPairInitialPairing);
+  SetUpValidAntiSpoofingKey(fast_pair_device_.get());
+  CountDownLatch latch(1);
+  auto handshake = std::make_unique<FastPairHandshakeImpl>(
+      *fast_pair_device_, mediums_, &executor_);
+  FastPairHandshakeImpl* warm_up = handshake.get();
+  handshake_ = std::move(handshake);
+  warm_up->Start(
+      [&](FastPairDevice& callback_device, std::optional<PairFailure> failure) {
+        EXPECT_EQ(failure.value(), PairFailure::kCreateGattConnection);
+        latch.CountDown();
+      });
+  latch.Await();
+  EXPECT_FALSE(handshake_->completed_successfully());
+}
+
 TEST_F(FastPairHandshakeImplTest, GattError) {
   bool notified = false;
   StartGattServer([&]() {
@@ -20,7 +20,10 @@
 
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "fastpair/handshake/fast_pair_handshake_impl.h"
+#include "internal/platform/logging.h"
+#include "internal/platform/timer_impl.h"
 
 namespace nearby {
 namespace fastpair {
@@ -90,6 +93,15 @@ FastPairHandshake* FastPairHandshakeLookup::Create(
     FastPairDevice& device, Mediums& mediums, OnCompleteCallback on_complete,
     SingleThreadExecutor* executor) {
   absl::MutexLock lock(&mutex_);
+  if (warm_up_device_ == &device) {
+    warm_up_device_ = nullptr;
+    warm_up_timer_.reset();
+    FastPairHandshakeImpl* handshake = warm_up_.get();
+    auto it = fast_pair_handshakes_.emplace(&device, std::move(warm_up_));
+    DCHECK(it.second);
+    handshake->Start(std::move(on_complete));
+    return handshake;
+  }
   auto it = fast_pair_handshakes_.emplace(
       &device, g_test_create_function.has_value()
                    ? g_test_create_function.value()(device, mediums,
@@ -100,5 +112,38 @@ FastPairHandshake* FastPairHandshakeLookup::Create(
   return it.first->second.get();
 }
 
+void FastPairHandshakeLookup::WarmUp(FastPairDevice& device, Mediums& mediums,
+                                     SingleThreadExecutor* executor,
+                                     absl::Duration timeout) {
+  std::unique_ptr<FastPairHandshakeImpl> previous;
+  absl::MutexLock lock(&mutex_);
+  if (g_test_create_function.has_value() || warm_up_device_ == &device ||
+      fast_pair_handshakes_.contains(&device)) {
+    return;
+  }
+  NEARBY_LOGS(INFO) << __func__ << ": Warming up handshake for " << device;
+  previous = std::move(warm_up_);
+  warm_up_device_ = &device;
+  warm_up_ = std::make_unique<FastPairHandshakeImpl>(device, mediums, executor);
+  warm_up_timer_ = std::make_unique<TimerImpl>();
+  // The warm-up is dropped on the executor, which runs its callbacks.
+  warm_up_timer_->Start(
+      timeout / absl::Milliseconds(1), 0, [this, &device, executor]() {
+        executor->Execute("cancel-handshake-warm-up",
+                          [this, &device]() { CancelWarmUp(&device); });
+      });
+}
+
+void FastPairHandshakeLookup::CancelWarmUp(FastPairDevice* device) {
+  std::unique_ptr<FastPairHandshakeImpl> warm_up;
+  absl::MutexLock lock(&mutex_);
+  if (warm_up_device_ != device) return;
+  NEARBY_LOGS(INFO) << __func__ << ": Dropping handshake warm-up for "
+                    << *device;
+  warm_up_device_ = nullptr;
+  warm_up_timer_.reset();
+  warm_up = std::move(warm_up_);
+}
+
 }  // namespace fastpair
 }  // namespace nearby
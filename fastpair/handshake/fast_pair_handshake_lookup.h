@@ -22,10 +22,14 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/any_invocable.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "fastpair/common/fast_pair_device.h"
 #include "fastpair/common/pair_failure.h"
 #include "fastpair/handshake/fast_pair_handshake.h"
+#include "fastpair/handshake/fast_pair_handshake_impl.h"
 #include "fastpair/internal/mediums/mediums.h"
+#include "internal/platform/single_thread_executor.h"
+#include "internal/platform/timer_impl.h"
 
 namespace nearby {
 namespace fastpair {
@@ -68,12 +72,24 @@ class FastPairHandshakeLookup {
   void Clear();
 
   // Creates and returns a new instance for |FastPairdevice| if no instance
-  // already exists.
+  // already exists, starting the warmed-up one if |device| was warmed up.
   // Returns the existing instance if there is one.
   FastPairHandshake* Create(FastPairDevice& device, Mediums& mediums,
                             OnCompleteCallback on_complete,
                             SingleThreadExecutor* executor);
 
+  // Connects to |device| ahead of Create(), so that the handshake doesn't wait
+  // for the GATT connection. Only one device is warmed up at a time, replacing
+  // the previous one, and the warm-up is dropped after |timeout|.
+  void WarmUp(FastPairDevice& device, Mediums& mediums,
+              SingleThreadExecutor* executor,
+              absl::Duration timeout = kWarmUpTimeout);
+
+  // Drops the warm-up of |device|, if there is one.
+  void CancelWarmUp(FastPairDevice* device);
+
+  static constexpr absl::Duration kWarmUpTimeout = absl::Seconds(30);
+
  protected:
   // Constructor/destructor of singleton object should not be public
   // for which the destructor will never be called.
@@ -87,6 +103,9 @@ class FastPairHandshakeLookup {
 
   absl::flat_hash_map<FastPairDevice*, std::unique_ptr<FastPairHandshake>>
       fast_pair_handshakes_ ABSL_GUARDED_BY(mutex_);
+  FastPairDevice* warm_up_device_ ABSL_GUARDED_BY(mutex_) = nullptr;
+  std::unique_ptr<FastPairHandshakeImpl> warm_up_ ABSL_GUARDED_BY(mutex_);
+  std::unique_ptr<TimerImpl> warm_up_timer_ ABSL_GUARDED_BY(mutex_);
 };
 }  // namespace fastpair
 }  // namespace nearby
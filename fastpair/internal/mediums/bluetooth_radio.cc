@@ -19,67 +19,41 @@
 namespace nearby {
 namespace fastpair {
 
-BluetoothRadio::BluetoothRadio() {
+BluetoothRadio::BluetoothRadio()
+    : state_(BluetoothRadioState::ForAdapter(bluetooth_adapter_)),
+      user_id_(state_->AddUser()) {
   if (!IsAdapterValid()) {
     NEARBY_LOGS(ERROR) << "Bluetooth adapter is not valid: BT is not supported";
   }
 }
 
 BluetoothRadio::~BluetoothRadio() {
-  // We never enabled Bluetooth, nothing to do.
-  if (!ever_saved_state_.Get()) {
-    NEARBY_LOGS(INFO) << "BT adapter was not used. Not touching HW.";
+  if (state_ == nullptr) {
     return;
   }
-
-  NEARBY_LOG(INFO, "Bring BT adapter to original state");
-  if (!SetBluetoothState(originally_enabled_.Get())) {
-    NEARBY_LOGS(INFO) << "Failed to restore BT adapter original state.";
-  }
+  // Restores the original state if this was the last user to modify it.
+  state_->RemoveUser(user_id_, bluetooth_adapter_);
 }
 
 bool BluetoothRadio::Enable() {
   NEARBY_LOGS(INFO) << __func__;
-  if (!SaveOriginalState()) {
+  if (!IsAdapterValid()) {
     return false;
   }
 
-  return SetBluetoothState(true);
+  return state_->Enable(user_id_, bluetooth_adapter_);
 }
 
 bool BluetoothRadio::Disable() {
-  if (!SaveOriginalState()) {
+  if (!IsAdapterValid()) {
     return false;
   }
 
-  return SetBluetoothState(false);
+  return state_->Disable(user_id_, bluetooth_adapter_);
 }
 
 bool BluetoothRadio::IsEnabled() const {
-  return IsAdapterValid() && IsInDesiredState(true);
-}
-
-bool BluetoothRadio::SetBluetoothState(bool enable) {
-  return bluetooth_adapter_.SetStatus(
-      enable ? BluetoothAdapter::Status::kEnabled
-             : BluetoothAdapter::Status::kDisabled);
-}
-
-bool BluetoothRadio::IsInDesiredState(bool should_be_enabled) const {
-  return bluetooth_adapter_.IsEnabled() == should_be_enabled;
-}
-
-bool BluetoothRadio::SaveOriginalState() {
-  if (!IsAdapterValid()) {
-    return false;
-  }
-
-  // If we haven't saved the original state of the radio, save it.
-  if (!ever_saved_state_.Set(true)) {
-    originally_enabled_.Set(bluetooth_adapter_.IsEnabled());
-  }
-
-  return true;
+  return IsAdapterValid() && state_->IsEnabled(bluetooth_adapter_);
 }
 
 }  // namespace fastpair
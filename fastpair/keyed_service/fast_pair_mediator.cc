@@ -19,7 +19,10 @@
 #include <optional>
 #include <utility>
 
+#include "fastpair/common/fast_pair_version.h"
 #include "fastpair/common/protocol.h"
+#include "fastpair/crypto/fast_pair_key_pool.h"
+#include "fastpair/handshake/fast_pair_handshake_lookup.h"
 #include "fastpair/internal/mediums/mediums.h"
 #include "fastpair/pairing/pairer_broker_impl.h"
 #include "fastpair/repository/fast_pair_device_repository.h"
@@ -51,6 +54,8 @@ Mediator::Mediator(
       platform::config_package_nearby::nearby_platform_feature::
           kEnableBleV2Gatt,
       true);
+  // Generates the key pairs of the first handshakes before they're needed.
+  FastPairKeyPool::GetInstance();
   devices_ = std::make_unique<FastPairDeviceRepository>(executor_.get());
   scanner_broker_ = std::make_unique<ScannerBrokerImpl>(
       *mediums_, executor_.get(), devices_.get());
@@ -80,10 +85,21 @@ void Mediator::OnDeviceFound(FastPairDevice& device) {
   // Show discovery notification
   device_currently_showing_notification_ = &device;
   ui_broker_->ShowDiscovery(device, *notification_controller_);
+  // The user is likely to pair with the device of the notification, so
+  // connect to it while they decide. V1 devices pair without a handshake.
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          platform::config_package_nearby::nearby_platform_feature::
+              kEnableFastPairHandshakeWarmUp) &&
+      device.GetVersion().has_value() &&
+      device.GetVersion().value() != DeviceFastPairVersion::kV1) {
+    FastPairHandshakeLookup::GetInstance()->WarmUp(device, *mediums_,
+                                                   executor_.get());
+  }
 }
 
 void Mediator::OnDeviceLost(FastPairDevice& device) {
   NEARBY_LOGS(INFO) << __func__ << ": " << device;
+  FastPairHandshakeLookup::GetInstance()->CancelWarmUp(&device);
 }
 
 void Mediator::OnDiscoveryAction(FastPairDevice& device,
@@ -106,6 +122,7 @@ void Mediator::OnDiscoveryAction(FastPairDevice& device,
       [[fallthrough]];
     case DiscoveryAction::kDismissedByTimeout:
       NEARBY_LOGS(INFO) << __func__ << ": Action =  kDismissedByTimeout";
+      FastPairHandshakeLookup::GetInstance()->CancelWarmUp(&device);
       device_currently_showing_notification_ = nullptr;
       break;
     case DiscoveryAction::kLearnMore:
@@ -16,6 +16,7 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/log/check.h"
 #include "absl/status/status.h"
@@ -31,7 +32,25 @@ namespace fastpair {
 
 namespace {
 constexpr int kHeaderSize = 4;
+constexpr int kReadBufferSize = 1024;
+
+// Appends the complete messages at the start of `data` to `messages`, and
+// returns the rest of `data`.
+absl::string_view ParseMessages(absl::string_view data,
+                                std::vector<Message>& messages) {
+  while (data.size() >= kHeaderSize) {
+    int length = static_cast<uint8_t>(data[2]) * 256 +
+                 static_cast<uint8_t>(data[3]);
+    if (data.size() < kHeaderSize + length) break;
+    messages.push_back(
+        Message{.message_group = static_cast<MessageGroup>(data[0]),
+                .message_code = static_cast<MessageCode>(data[1]),
+                .payload = std::string(data.substr(kHeaderSize, length))});
+    data.remove_prefix(kHeaderSize + length);
+  }
+  return data;
 }
+}  // namespace
 
 absl::Status Medium::OpenRfcomm() {
   if (!bt_classic_medium_.has_value()) {
@@ -102,28 +121,24 @@ absl::Status Medium::Send(Message message, bool compute_and_append_mac) {
 void Medium::RunLoop(BluetoothSocket socket) {
   NEARBY_LOGS(INFO) << "Run loop";
   InputStream& input = socket.GetInputStream();
+  // Bytes received but not parsed yet. Reused by all the reads.
+  std::string buffer;
+  std::vector<Message> messages;
   while (!cancellation_flag_.Cancelled()) {
-    ExceptionOr<ByteArray> header = input.ReadExactly(kHeaderSize);
-    if (!header.ok() || header.result().size() != kHeaderSize) {
+    // Providers send several messages at once, e.g. on connection, and a
+    // single read returns all of them.
+    ExceptionOr<ByteArray> chunk = input.Read(kReadBufferSize);
+    if (!chunk.ok() || chunk.result().Empty()) {
       break;
     }
-    absl::string_view data = header.result().AsStringView();
-    MessageGroup group = static_cast<MessageGroup>(data[0]);
-    MessageCode code = static_cast<MessageCode>(data[1]);
-    int length = static_cast<unsigned int>(data[2]) * 256 +
-                 static_cast<unsigned int>(data[3]);
-    ExceptionOr<ByteArray> payload;
-    if (length > 0) {
-      payload = input.ReadExactly(length);
-    } else {
-      payload = ExceptionOr<ByteArray>(ByteArray(""));
-    }
-    if (!payload.ok() || payload.result().size() != length) {
-      break;
+    buffer.append(chunk.result().data(), chunk.result().size());
+    absl::string_view unparsed = ParseMessages(buffer, messages);
+    buffer.erase(0, buffer.size() - unparsed.size());
+    for (Message& message : messages) {
+      if (cancellation_flag_.Cancelled()) break;
+      observer_.OnReceived(std::move(message));
     }
-    observer_.OnReceived(Message{.message_group = group,
-                                 .message_code = code,
-                                 .payload = std::string(payload.result())});
+    messages.clear();
   }
   socket.Close();
   if (!cancellation_flag_.Cancelled()) {
@@ -187,6 +187,39 @@ TEST_F(MediumTest, ReceiveMessage) {
   EXPECT_EQ(messages[0], expected_message);
 }
 
+TEST_F(MediumTest, ReceiveMessagesInOneWrite) {
+  Message first_message = {
+      .message_group = MessageGroup::kDeviceInformationEvent,
+      .message_code = MessageCode::kSessionNonce,
+      .payload = absl::HexStringToBytes("ABCDEF")};
+  Message second_message = {
+      .message_group = MessageGroup::kDeviceInformationEvent,
+      .message_code = MessageCode::kBatteryUpdated,
+      .payload = absl::HexStringToBytes("575859")};
+  // The second message is cut in the middle of its payload.
+  std::string input = absl::HexStringToBytes("030A0003ABCDEF0303000357");
+  FastPairDevice fp_device("model id", "ble address",
+                           Protocol::kFastPairRetroactivePairing);
+  fp_device.SetPublicAddress(provider_.GetMacAddress());
+  provider_.DiscoverProvider(seeker_medium_);
+  provider_.EnableProviderRfcomm();
+  Medium medium =
+      Medium(fp_device, std::optional<BluetoothClassicMedium*>(&seeker_medium_),
+             observer_);
+  ASSERT_OK(medium.OpenRfcomm());
+  ASSERT_TRUE(observer_.connection_result_.Get().ok());
+
+  provider_.WriteProviderBytes(input);
+  ASSERT_OK(observer_.WaitForMessages(1, absl::Seconds(10)));
+  provider_.WriteProviderBytes(absl::HexStringToBytes("5859"));
+
+  ASSERT_OK(observer_.WaitForMessages(2, absl::Seconds(10)));
+  std::vector<Message> messages = observer_.GetMessages();
+  ASSERT_EQ(messages.size(), 2);
+  EXPECT_EQ(messages[0], first_message);
+  EXPECT_EQ(messages[1], second_message);
+}
+
 class MediumFuzzTest : public fuzztest::PerIterationFixtureAdapter<MediumTest> {
  public:
   void HandlesAnyInput(absl::string_view input) {
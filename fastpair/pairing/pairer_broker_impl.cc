@@ -14,6 +14,7 @@
 
 #include "fastpair/pairing/pairer_broker_impl.h"
 
+#include <algorithm>
 #include <memory>
 #include <optional>
 #include <string>
@@ -36,8 +37,11 @@ constexpr absl::Duration kRetryHandshakeDelay = absl::Seconds(1);
 }  // namespace
 
 PairerBrokerImpl::PairerBrokerImpl(Mediums& medium,
-                                   SingleThreadExecutor* executor)
-    : medium_(medium), executor_(executor) {}
+                                   SingleThreadExecutor* executor,
+                                   int max_concurrent_pairings)
+    : medium_(medium),
+      executor_(executor),
+      max_concurrent_pairings_(max_concurrent_pairings) {}
 
 void PairerBrokerImpl::AddObserver(Observer* observer) {
   observers_.AddObserver(observer);
@@ -48,9 +52,23 @@ void PairerBrokerImpl::RemoveObserver(Observer* observer) {
 }
 
 void PairerBrokerImpl::PairDevice(FastPairDevice& device) {
-  NEARBY_LOGS(INFO) << __func__ << ": Start to pair with device=" << device;
   {
     MutexLock lock(&mutex_);
+    std::string model_id(device.GetModelId());
+    if (!pairing_model_ids_.contains(model_id)) {
+      if (pairing_model_ids_.size() >=
+          static_cast<size_t>(max_concurrent_pairings_)) {
+        NEARBY_LOGS(INFO) << __func__ << ": Waiting to pair with device="
+                          << device << " until another pairing ends.";
+        if (std::find(waiting_devices_.begin(), waiting_devices_.end(),
+                      &device) == waiting_devices_.end()) {
+          waiting_devices_.push_back(&device);
+        }
+        return;
+      }
+      pairing_model_ids_.insert(model_id);
+    }
+    NEARBY_LOGS(INFO) << __func__ << ": Start to pair with device=" << device;
     model_id_to_current_ble_address_map_.insert_or_assign(
         std::string(device.GetModelId()), std::string(device.GetBleAddress()));
     did_handshake_previously_complete_successfully_map_.insert_or_assign(
@@ -164,8 +182,10 @@ void PairerBrokerImpl::OnHandshakeFailure(FastPairDevice& device,
     MutexLock lock(&mutex_);
     if (++num_handshake_attempts_[device.GetModelId()] <
         kMaxNumHandshakeAttempts) {
-      retry_handshake_timer_ = std::make_unique<TimerImpl>();
-      retry_handshake_timer_->Start(
+      auto& retry_handshake_timer =
+          retry_handshake_timers_[device.GetModelId()];
+      retry_handshake_timer = std::make_unique<TimerImpl>();
+      retry_handshake_timer->Start(
           kRetryHandshakeDelay / absl::Milliseconds(1), 0,
           [&]() { CreateHandshake(device); });
       return;
@@ -177,6 +197,7 @@ void PairerBrokerImpl::OnHandshakeFailure(FastPairDevice& device,
     observer->OnPairFailure(device, failure);
   }
   FastPairHandshakeLookup::GetInstance()->Erase(&device);
+  EndPairing(device);
 }
 
 void PairerBrokerImpl::StartPairingAttempt(FastPairDevice& device) {
@@ -261,8 +282,9 @@ void PairerBrokerImpl::OnFastPairPairingFailure(FastPairDevice& device,
     fast_pair_pairers_.erase(device.GetModelId());
     // Create a timer to wait |kCancelPairingRetryDelay| after cancelling
     // pairing to retry the pairing attempt.
-    cancel_pairing_timer_ = std::make_unique<TimerImpl>();
-    cancel_pairing_timer_->Start(
+    auto& cancel_pairing_timer = cancel_pairing_timers_[device.GetModelId()];
+    cancel_pairing_timer = std::make_unique<TimerImpl>();
+    cancel_pairing_timer->Start(
         kCancelPairingRetryDelay / absl::Milliseconds(1), 0,
         [&]() { PairFastPairDevice(device); });
     return;
@@ -307,28 +329,49 @@ void PairerBrokerImpl::OnFastPairProcedureComplete(FastPairDevice& device) {
 }
 
 void PairerBrokerImpl::EraseHandshakeAndPairers(FastPairDevice& device) {
-  MutexLock lock(&mutex_);
-  NEARBY_LOGS(WARNING) << __func__;
-  // |fast_pair_pairers_| and its children objects depend on the handshake
-  // instance. Shut them down before destroying the handshake.
-  pair_failure_counts_.erase(device.GetModelId());
-  fast_pair_pairers_.erase(device.GetModelId());
-  FastPairHandshakeLookup::GetInstance()->Erase(&device);
-  did_handshake_previously_complete_successfully_map_.insert_or_assign(
-      std::string(device.GetModelId()), false);
+  {
+    MutexLock lock(&mutex_);
+    NEARBY_LOGS(WARNING) << __func__;
+    // |fast_pair_pairers_| and its children objects depend on the handshake
+    // instance. Shut them down before destroying the handshake.
+    pair_failure_counts_.erase(device.GetModelId());
+    fast_pair_pairers_.erase(device.GetModelId());
+    FastPairHandshakeLookup::GetInstance()->Erase(&device);
+    did_handshake_previously_complete_successfully_map_.insert_or_assign(
+        std::string(device.GetModelId()), false);
+  }
+  EndPairing(device);
+}
+
+void PairerBrokerImpl::EndPairing(FastPairDevice& device) {
+  FastPairDevice* next_device;
+  {
+    MutexLock lock(&mutex_);
+    if (!pairing_model_ids_.erase(device.GetModelId()) ||
+        waiting_devices_.empty()) {
+      return;
+    }
+    next_device = waiting_devices_.front();
+    waiting_devices_.pop_front();
+  }
+  executor_->Execute("PairWaitingDevice",
+                     [this, next_device]() { PairDevice(*next_device); });
 }
 
 bool PairerBrokerImpl::IsPairing() {
   MutexLock lock(&mutex_);
   // We are guaranteed to not be pairing when the following two maps are
-  // empty.
-  return !fast_pair_pairers_.empty() || !pair_failure_counts_.empty();
+  // empty, and no device is waiting for its turn.
+  return !fast_pair_pairers_.empty() || !pair_failure_counts_.empty() ||
+         !waiting_devices_.empty();
 }
 
 void PairerBrokerImpl::StopPairing() {
   MutexLock lock(&mutex_);
   fast_pair_pairers_.clear();
   pair_failure_counts_.clear();
+  pairing_model_ids_.clear();
+  waiting_devices_.clear();
 }
 }  // namespace fastpair
 }  // namespace nearby
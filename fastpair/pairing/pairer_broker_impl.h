@@ -15,11 +15,13 @@
 #ifndef THIRD_PARTY_NEARBY_FASTPAIR_PAIRING_PAIRER_BROKER_IMPL_H_
 #define THIRD_PARTY_NEARBY_FASTPAIR_PAIRING_PAIRER_BROKER_IMPL_H_
 
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "fastpair/common/fast_pair_device.h"
 #include "fastpair/internal/mediums/mediums.h"
 #include "fastpair/pairing/fastpair/fast_pair_pairer.h"
@@ -31,9 +33,15 @@
 namespace nearby {
 namespace fastpair {
 
+// Pairs with several devices at once, up to |max_concurrent_pairings| of them,
+// each with its own GATT connection. Devices beyond those wait for a pairing
+// to end, in the order PairDevice() was called for them.
 class PairerBrokerImpl : public PairerBroker {
  public:
-  explicit PairerBrokerImpl(Mediums& medium, SingleThreadExecutor* executor);
+  static constexpr int kMaxConcurrentPairings = 3;
+
+  PairerBrokerImpl(Mediums& medium, SingleThreadExecutor* executor,
+                   int max_concurrent_pairings = kMaxConcurrentPairings);
   PairerBrokerImpl(const PairerBrokerImpl&) = delete;
   PairerBrokerImpl& operator=(const PairerBrokerImpl&) = delete;
 
@@ -72,8 +80,13 @@ class PairerBrokerImpl : public PairerBroker {
   void EraseHandshakeAndPairers(FastPairDevice& device)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_);
 
+  // Frees the pairing slot of |device|, and starts pairing with the next
+  // waiting device, if any.
+  void EndPairing(FastPairDevice& device);
+
   Mediums& medium_;
   SingleThreadExecutor* executor_;
+  const int max_concurrent_pairings_;
 
   // The key for all the following maps is a device model id.
   absl::flat_hash_map<std::string, std::unique_ptr<FastPairPairer>>
@@ -87,10 +100,16 @@ class PairerBrokerImpl : public PairerBroker {
       ABSL_GUARDED_BY(mutex_);
   absl::flat_hash_map<std::string, std::string>
       model_id_to_current_ble_address_map_ ABSL_GUARDED_BY(mutex_);
-
-  // Timer
-  std::unique_ptr<TimerImpl> cancel_pairing_timer_;
-  std::unique_ptr<TimerImpl> retry_handshake_timer_;
+  // Each device retries on its own timers, so that a retry doesn't cancel
+  // another device's.
+  absl::flat_hash_map<std::string, std::unique_ptr<TimerImpl>>
+      cancel_pairing_timers_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, std::unique_ptr<TimerImpl>>
+      retry_handshake_timers_ ABSL_GUARDED_BY(mutex_);
+
+  // The devices being paired with, and those waiting for their turn.
+  absl::flat_hash_set<std::string> pairing_model_ids_ ABSL_GUARDED_BY(mutex_);
+  std::deque<FastPairDevice*> waiting_devices_ ABSL_GUARDED_BY(mutex_);
 
   ObserverList<Observer> observers_;
 };
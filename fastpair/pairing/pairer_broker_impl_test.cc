@@ -27,6 +27,7 @@
 #include "gtest/gtest.h"
 #include "absl/functional/bind_front.h"
 #include "fastpair//handshake/fast_pair_handshake_lookup.h"
+#include "fastpair/common/device_metadata.h"
 #include "fastpair/common/pair_failure.h"
 #include "fastpair/handshake/fast_pair_data_encryptor_impl.h"
 #include "fastpair/handshake/fast_pair_handshake_impl.h"
@@ -38,6 +39,8 @@
 #include "internal/platform/ble_v2.h"
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/medium_environment.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/mutex_lock.h"
 #include <openssl/rand.h>
 
 namespace nearby {
@@ -698,5 +701,70 @@ TEST_F(PairerBrokerImplTest, FailToPairRetryThreeTimes) {
   EXPECT_EQ(pairer_broker_observer.pair_failure_,
             PairFailure::kPairingAndConnect);
 }
+
+TEST_F(PairerBrokerImplTest, PairsWithWaitingDeviceOnceAnotherPairingEnds) {
+  CountDownLatch device_paired_latch(1);
+  CountDownLatch account_key_writed_latch(1);
+  CountDownLatch pairing_completed_latch(1);
+  CountDownLatch pairing_failure_latch(1);
+  SetUpFastPairRepository(DeviceFastPairVersion::kHigherThanV1);
+  CreateMockDevice(DeviceFastPairVersion::kHigherThanV1,
+                   Protocol::kFastPairInitialPairing);
+  FastPairDevice other_device("0a0b0c", "11:22:33:44:55:66",
+                              Protocol::kFastPairInitialPairing);
+  proto::GetObservedDeviceResponse response;
+  response.mutable_device()->mutable_anti_spoofing_key_pair()->set_public_key(
+      std::string(kPublicAntiSpoof));
+  other_device.SetMetadata(DeviceMetadata(response));
+  // The handshakes never complete on their own, and the test fails those with
+  // `device_`, as many times as the broker retries them.
+  Mutex mutex;
+  std::vector<FastPairDevice*> handshake_devices;
+  std::vector<FastPairHandshake::OnCompleteCallback> handshake_callbacks;
+  std::vector<std::unique_ptr<CountDownLatch>> handshake_latches;
+  for (int i = 0; i < 4; ++i) {
+    handshake_latches.push_back(std::make_unique<CountDownLatch>(1));
+  }
+  FastPairHandshakeLookup::SetCreateFunctionForTesting(
+      [&](FastPairDevice& device, Mediums& mediums,
+          FastPairHandshake::OnCompleteCallback callback) {
+        MutexLock lock(&mutex);
+        handshake_devices.push_back(&device);
+        handshake_callbacks.push_back(std::move(callback));
+        handshake_latches[handshake_devices.size() - 1]->CountDown();
+        return std::make_unique<FastPairHandshake>(
+            [](FastPairDevice&, std::optional<PairFailure>) {}, nullptr,
+            nullptr);
+      });
+
+  pairer_broker_ = std::make_unique<PairerBrokerImpl>(
+      *mediums_, &executor_, /*max_concurrent_pairings=*/1);
+  PairerBrokerObserver pairer_broker_observer(
+      pairer_broker_.get(), &device_paired_latch, &account_key_writed_latch,
+      &pairing_completed_latch, &pairing_failure_latch);
+  pairer_broker_->PairDevice(*device_);
+  pairer_broker_->PairDevice(other_device);
+
+  EXPECT_TRUE(pairer_broker_->IsPairing());
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(handshake_latches[i]->Await(absl::Seconds(5)).result());
+    MutexLock lock(&mutex);
+    ASSERT_EQ(handshake_devices[i], device_.get());
+    handshake_callbacks[i](*device_, PairFailure::kCreateGattConnection);
+  }
+  pairing_failure_latch.Await();
+  ASSERT_TRUE(handshake_latches[3]->Await(absl::Seconds(5)).result());
+  {
+    MutexLock lock(&mutex);
+    EXPECT_EQ(handshake_devices[3], &other_device);
+  }
+
+  pairer_broker_->StopPairing();
+  executor_.Shutdown();
+  FastPairHandshakeLookup::GetInstance()->Clear();
+  FastPairHandshakeLookup::SetCreateFunctionForTesting(absl::bind_front(
+      &PairerBrokerImplTest::CreateConnectedHandshake, this));
+}
+
 }  // namespace fastpair
 }  // namespace nearby
@@ -14,30 +14,57 @@
 
 #include "fastpair/repository/fast_pair_device_repository.h"
 
-#include <algorithm>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "internal/base/bluetooth_address.h"
 #include "internal/platform/logging.h"
 #include "internal/platform/mutex_lock.h"
 
 namespace nearby {
 namespace fastpair {
+namespace {
+
+// Erases `key` from `index`, if it still maps to `device`.
+template <typename Key, typename LookupKey>
+void EraseFromIndex(absl::flat_hash_map<Key, FastPairDevice*>& index,
+                    const LookupKey& key, const FastPairDevice* device) {
+  auto it = index.find(key);
+  if (it != index.end() && it->second == device) index.erase(it);
+}
+
+}  // namespace
+
+FastPairDeviceRepository::~FastPairDeviceRepository() {
+  MutexLock lock(&mutex_);
+  for (auto& [ptr, entry] : devices_) {
+    entry.device->SetIdentifiersChangedCallback(nullptr);
+  }
+}
 
 FastPairDevice* FastPairDeviceRepository::AddDevice(
     std::unique_ptr<FastPairDevice> device) {
-  const auto& id = device->GetUniqueId();
   MutexLock lock(&mutex_);
-  for (auto& item : devices_) {
-    if (item->GetUniqueId() == id) {
-      // Overwrite the existing object.
-      *item = std::move(*device);
-      return item.get();
-    }
+  auto it = by_unique_id_.find(device->GetUniqueId());
+  if (it != by_unique_id_.end()) {
+    // Overwrite the existing object.
+    FastPairDevice* item = it->second;
+    Entry& entry = devices_.at(item);
+    Unindex(entry);
+    *item = std::move(*device);
+    Index(entry);
+    return item;
   }
   FastPairDevice* ptr = device.get();
-  devices_.push_back(std::move(device));
+  Entry& entry = devices_[ptr];
+  entry.device = std::move(device);
+  Index(entry);
   return ptr;
 }
 
@@ -54,31 +81,85 @@ void FastPairDeviceRepository::RemoveDevice(const FastPairDevice* device) {
 
 std::optional<FastPairDevice*> FastPairDeviceRepository::FindDevice(
     absl::string_view mac_address) {
+  absl::optional<device::BluetoothAddress> address =
+      device::BluetoothAddress::FromString(mac_address);
+  if (!address.has_value()) return std::nullopt;
   MutexLock lock(&mutex_);
-  auto it = std::find_if(devices_.begin(), devices_.end(),
-                         [&](const std::unique_ptr<FastPairDevice>& device) {
-                           return device->GetBleAddress() == mac_address ||
-                                  device->GetPublicAddress() == mac_address;
-                         });
-  if (it != devices_.end()) {
-    return it->get();
-  } else {
-    return std::nullopt;
-  }
+  auto it = by_ble_address_.find(*address);
+  if (it != by_ble_address_.end()) return it->second;
+  it = by_public_address_.find(*address);
+  if (it != by_public_address_.end()) return it->second;
+  return std::nullopt;
+}
+
+std::vector<FastPairDevice*> FastPairDeviceRepository::FindDevicesByModelId(
+    absl::string_view model_id) {
+  MutexLock lock(&mutex_);
+  auto it = by_model_id_.find(model_id);
+  if (it == by_model_id_.end()) return {};
+  return std::vector<FastPairDevice*>(it->second.begin(), it->second.end());
 }
 
 std::unique_ptr<FastPairDevice> FastPairDeviceRepository::ExtractDevice(
     const FastPairDevice* device) {
   MutexLock lock(&mutex_);
-  auto it = std::find_if(devices_.begin(), devices_.end(),
-                         [&](const std::unique_ptr<FastPairDevice>& item) {
-                           return item.get() == device;
-                         });
+  auto it = devices_.find(device);
   if (it == devices_.end()) return nullptr;
-  std::unique_ptr<FastPairDevice> fast_pair_device = std::move(*it);
+  Unindex(it->second);
+  std::unique_ptr<FastPairDevice> fast_pair_device =
+      std::move(it->second.device);
   devices_.erase(it);
+  fast_pair_device->SetIdentifiersChangedCallback(nullptr);
   return fast_pair_device;
 }
 
+void FastPairDeviceRepository::Index(Entry& entry) {
+  FastPairDevice* device = entry.device.get();
+  entry.unique_id = device->GetUniqueId();
+  entry.ble_address =
+      device::BluetoothAddress::FromString(device->GetBleAddress());
+  entry.public_address = absl::nullopt;
+  if (std::optional<std::string> public_address = device->GetPublicAddress();
+      public_address.has_value()) {
+    entry.public_address =
+        device::BluetoothAddress::FromString(*public_address);
+  }
+  entry.model_id = std::string(device->GetModelId());
+
+  by_unique_id_[entry.unique_id] = device;
+  if (entry.ble_address.has_value()) {
+    by_ble_address_[*entry.ble_address] = device;
+  }
+  if (entry.public_address.has_value()) {
+    by_public_address_[*entry.public_address] = device;
+  }
+  by_model_id_[entry.model_id].insert(device);
+  device->SetIdentifiersChangedCallback([this, device]() { Reindex(device); });
+}
+
+void FastPairDeviceRepository::Unindex(const Entry& entry) {
+  const FastPairDevice* device = entry.device.get();
+  EraseFromIndex(by_unique_id_, entry.unique_id, device);
+  if (entry.ble_address.has_value()) {
+    EraseFromIndex(by_ble_address_, *entry.ble_address, device);
+  }
+  if (entry.public_address.has_value()) {
+    EraseFromIndex(by_public_address_, *entry.public_address, device);
+  }
+  auto it = by_model_id_.find(entry.model_id);
+  if (it != by_model_id_.end()) {
+    it->second.erase(entry.device.get());
+    if (it->second.empty()) by_model_id_.erase(it);
+  }
+}
+
+void FastPairDeviceRepository::Reindex(const FastPairDevice* device) {
+  MutexLock lock(&mutex_);
+  auto it = devices_.find(device);
+  if (it == devices_.end()) return;
+  Unindex(it->second);
+  Index(it->second);
+}
+
 }  // namespace fastpair
 }  // namespace nearby
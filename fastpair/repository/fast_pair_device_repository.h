@@ -17,9 +17,15 @@
 
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "fastpair/common/fast_pair_device.h"
+#include "internal/base/bluetooth_address.h"
 #include "internal/platform/mutex.h"
 #include "internal/platform/single_thread_executor.h"
 
@@ -31,6 +37,7 @@ class FastPairDeviceRepository {
  public:
   explicit FastPairDeviceRepository(SingleThreadExecutor* executor)
       : executor_(executor) {}
+  ~FastPairDeviceRepository();
 
   // Adds device to the repository and takes over ownership.
   // If a device with the same MAC address is already in the repository, it is
@@ -46,12 +53,40 @@ class FastPairDeviceRepository {
   // or BLE.
   std::optional<FastPairDevice*> FindDevice(absl::string_view mac_address);
 
+  // Finds the devices of the `model_id` model.
+  std::vector<FastPairDevice*> FindDevicesByModelId(absl::string_view model_id);
+
  private:
+  // A device and the identifiers it is indexed by.
+  struct Entry {
+    std::unique_ptr<FastPairDevice> device;
+    std::string unique_id;
+    // Parsed once here so that lookups don't depend on how the address was
+    // formatted.
+    absl::optional<device::BluetoothAddress> ble_address;
+    absl::optional<device::BluetoothAddress> public_address;
+    std::string model_id;
+  };
+
   // Removes `device` from `devices_`.
   std::unique_ptr<FastPairDevice> ExtractDevice(const FastPairDevice* device);
+  // Indexes `entry` by the current identifiers of its device.
+  void Index(Entry& entry) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void Unindex(const Entry& entry) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void Reindex(const FastPairDevice* device);
+
   Mutex mutex_;
   SingleThreadExecutor* executor_;
-  std::vector<std::unique_ptr<FastPairDevice>> devices_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<const FastPairDevice*, Entry> devices_
+      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, FastPairDevice*> by_unique_id_
+      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<device::BluetoothAddress, FastPairDevice*>
+      by_ble_address_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<device::BluetoothAddress, FastPairDevice*>
+      by_public_address_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, absl::flat_hash_set<FastPairDevice*>>
+      by_model_id_ ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace fastpair
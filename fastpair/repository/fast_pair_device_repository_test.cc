@@ -57,6 +57,17 @@ TEST(FastPairDeviceRepositoryTest, FindDeviceByBleAddress) {
   EXPECT_EQ(device->GetModelId(), kModelId);
 }
 
+TEST(FastPairDeviceRepositoryTest, FindDeviceByAddressInAnyFormat) {
+  SingleThreadExecutor executor;
+  FastPairDeviceRepository repo(&executor);
+  FastPairDevice* device = repo.AddDevice(std::make_unique<FastPairDevice>(
+      kModelId, kBleAddress, Protocol::kFastPairInitialPairing));
+
+  EXPECT_EQ(repo.FindDevice("aa-bb-cc-dd-ee-ff"), device);
+  EXPECT_EQ(repo.FindDevice("AABBCCDDEEFF"), device);
+  EXPECT_FALSE(repo.FindDevice("not an address").has_value());
+}
+
 TEST(FastPairDeviceRepositoryTest, FindDeviceByBtAddress) {
   SingleThreadExecutor executor;
   FastPairDeviceRepository repo(&executor);
@@ -100,6 +111,59 @@ TEST(FastPairDeviceRepositoryTest, RemovingNonRegisteredDeviceIsSafe) {
   EXPECT_FALSE(repo.FindDevice(kBleAddress).has_value());
 }
 
+TEST(FastPairDeviceRepositoryTest, FindDeviceAfterAddressChanges) {
+  SingleThreadExecutor executor;
+  FastPairDeviceRepository repo(&executor);
+  FastPairDevice* device = repo.AddDevice(std::make_unique<FastPairDevice>(
+      kModelId, kBleAddress, Protocol::kFastPairInitialPairing));
+
+  device->SetPublicAddress(kBtAddress);
+
+  auto opt_device = repo.FindDevice(kBtAddress);
+  ASSERT_TRUE(opt_device.has_value());
+  EXPECT_EQ(opt_device.value(), device);
+
+  device->SetBleAddress("11:22:33:44:55:66");
+
+  EXPECT_FALSE(repo.FindDevice(kBleAddress).has_value());
+  opt_device = repo.FindDevice("11:22:33:44:55:66");
+  ASSERT_TRUE(opt_device.has_value());
+  EXPECT_EQ(opt_device.value(), device);
+}
+
+TEST(FastPairDeviceRepositoryTest, AddDeviceReplacesDeviceWithSameId) {
+  SingleThreadExecutor executor;
+  FastPairDeviceRepository repo(&executor);
+  FastPairDevice* device = repo.AddDevice(std::make_unique<FastPairDevice>(
+      kModelId, kBleAddress, Protocol::kFastPairInitialPairing));
+
+  FastPairDevice* replaced = repo.AddDevice(std::make_unique<FastPairDevice>(
+      "654321", kBleAddress, Protocol::kFastPairInitialPairing));
+
+  EXPECT_EQ(replaced, device);
+  EXPECT_EQ(device->GetModelId(), "654321");
+  EXPECT_TRUE(repo.FindDevicesByModelId(kModelId).empty());
+  EXPECT_THAT(repo.FindDevicesByModelId("654321"),
+              ::testing::ElementsAre(device));
+}
+
+TEST(FastPairDeviceRepositoryTest, FindDevicesByModelId) {
+  SingleThreadExecutor executor;
+  FastPairDeviceRepository repo(&executor);
+  FastPairDevice* device_1 = repo.AddDevice(std::make_unique<FastPairDevice>(
+      kModelId, kBleAddress, Protocol::kFastPairInitialPairing));
+  FastPairDevice* device_2 = repo.AddDevice(std::make_unique<FastPairDevice>(
+      kModelId, kBtAddress, Protocol::kFastPairInitialPairing));
+
+  EXPECT_THAT(repo.FindDevicesByModelId(kModelId),
+              ::testing::UnorderedElementsAre(device_1, device_2));
+
+  repo.RemoveDevice(device_1);
+
+  EXPECT_THAT(repo.FindDevicesByModelId(kModelId),
+              ::testing::ElementsAre(device_2));
+}
+
 }  // namespace
 
 }  // namespace fastpair
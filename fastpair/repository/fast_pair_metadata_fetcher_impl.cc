@@ -63,8 +63,7 @@ void FastPairMetadataFetcherImpl::StartGetUnauthRequest(
 
 void FastPairMetadataFetcherImpl::ProcessApiCallSuccess(
     const network::HttpResponse* response) {
-  network::HttpResponseBody response_body = response->GetBody();
-  result_callback_(response_body.GetRawData());
+  result_callback_(body_string_);
 }
 
 void FastPairMetadataFetcherImpl::ProcessApiCallFailure(absl::Status status) {
@@ -97,11 +96,18 @@ void FastPairMetadataFetcherImpl::Execute() {
   // Handle request body
   request.SetBody(std::string());
 
-  http_client_->StartRequest(
-      request, [&](const absl::StatusOr<network::HttpResponse>& response) {
+  // The body is gathered as it arrives, rather than buffered by the client
+  // and copied over once complete.
+  body_string_.clear();
+  http_client_->StartStreamingRequest(
+      request,
+      [this](absl::string_view chunk) {
+        body_string_.append(chunk.data(), chunk.size());
+        return true;
+      },
+      [&](const absl::StatusOr<network::HttpResponse>& response) {
         response_ = response;
         if (response_.ok()) {
-          body_string_ = std::string(response_->GetBody().GetRawData());
           ProcessApiCallSuccess(&response_.value());
         } else {
           ProcessApiCallFailure(response.status());
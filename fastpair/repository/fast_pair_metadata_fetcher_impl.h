@@ -70,8 +70,9 @@ class FastPairMetadataFetcherImpl : public FastPairMetadataFetcher {
   // Http client to execute request
   network::HttpClient* http_client_ = nullptr;
 
-  // Store a copy of HTTP response
+  // Store a copy of HTTP response, without its body.
   absl::StatusOr<network::HttpResponse> response_;
+  // The body of the response, as streamed by |http_client_|.
   std::string body_string_;
 
   // Used to indicate the OS type.
@@ -102,6 +102,13 @@ void Retroactive::SetPairingStep(PairingStep step) {
       break;
     }
     case PairingStep::kOpenMessageStream: {
+      // The message stream is only needed to learn the model ID and BLE
+      // address. Don't open it if the device already knows them.
+      const FastPairDevice& device = controller_->GetDevice();
+      if (!device.GetModelId().empty() && !device.GetBleAddress().empty()) {
+        SetPairingStep(PairingStep::kFetchAntiSpoofingKey);
+        return;
+      }
       absl::Status status = controller_->OpenMessageStream();
       if (!status.ok()) {
         SetPairingStep(PairingStep::kFailed);
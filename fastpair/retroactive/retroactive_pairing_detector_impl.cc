@@ -15,6 +15,7 @@
 #include "fastpair/retroactive/retroactive_pairing_detector_impl.h"
 
 #include <ios>
+#include <string>
 
 #include "fastpair/internal/mediums/mediums.h"
 #include "fastpair/pairing/pairer_broker.h"
@@ -54,6 +55,11 @@ void RetroactivePairingDetectorImpl::OnDevicePaired(FastPairDevice& device) {
     return;
   }
 
+  // A Fast Paired device has its account key already, so there is nothing
+  // left to evaluate until it is unpaired.
+  evaluated_devices_[device.GetPublicAddress().value()] =
+      std::string(device.GetModelId());
+
   // The Bluetooth Adapter system event `DevicePairedChanged` fires before
   // Fast Pair's `OnDevicePaired`, and a Fast Pair pairing is expected to have
   // both events. If a device is Fast Paired, it is already inserted in the
@@ -81,8 +87,20 @@ void RetroactivePairingDetectorImpl::DevicePairedChanged(
   // If the |new_paired_status| is false, it means a device was unpaired,
   // so we early return since it would not be a device to retroactively pair to.
   if (!new_paired_status) {
+    evaluated_devices_.erase(device.GetMacAddress());
+    potential_retroactive_addresses_.erase(device.GetMacAddress());
+    return;
+  }
+
+  // The event fires again when a paired device is re-reported, e.g. after the
+  // adapter is toggled. Its account key status can't have changed since it
+  // was evaluated, so skip the lookups and the message stream.
+  if (evaluated_devices_.contains(device.GetMacAddress())) {
+    NEARBY_LOGS(INFO) << __func__ << ": already evaluated device at address = "
+                      << device.GetMacAddress();
     return;
   }
+  evaluated_devices_.emplace(device.GetMacAddress(), "");
 
   // Both classic paired and Fast paired devices call this function, so we
   // have to add the device to |potential_retroactive_addresses_|. We expect
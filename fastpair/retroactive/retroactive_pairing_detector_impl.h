@@ -16,6 +16,7 @@
 #define THIRD_PARTY_NEARBY_FASTPAIR_RETROACTIVE_RETROACTIVE_PAIRING_DETECTOR_IMPL_H_
 #include <string>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "fastpair/internal/mediums/mediums.h"
 #include "fastpair/pairing/pairer_broker.h"
@@ -52,6 +53,10 @@ class RetroactivePairingDetectorImpl : public RetroactivePairingDetector,
   Mediums& mediums_;
   ObserverList<RetroactivePairingDetector::Observer> observers_;
   absl::flat_hash_set<std::string> potential_retroactive_addresses_;
+  // Classic addresses of the paired devices that were already evaluated, and
+  // their model IDs, if known, so that reconnecting or re-reported devices are
+  // not evaluated again. An address is forgotten when the device is unpaired.
+  absl::flat_hash_map<std::string, std::string> evaluated_devices_;
 };
 
 }  // namespace fastpair
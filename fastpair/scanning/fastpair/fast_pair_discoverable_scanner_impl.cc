@@ -114,20 +114,29 @@ void FastPairDiscoverableScannerImpl::OnDeviceFound(
       [this, fast_pair_service_data = std::move(fast_pair_service_data),
        address = peripheral.GetName()]()
           ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_) {
-            NEARBY_LOGS(INFO) << __func__ << ": Attempting to get model ID";
-            std::vector<uint8_t> service_data;
-            std::move(std::begin(fast_pair_service_data),
-                      std::end(fast_pair_service_data),
-                      std::back_inserter(service_data));
-
-            // TODO(jsobczak): GetHexModelIdFromServiceData() callback is
-            // synchronous. It would be simpler if
-            // GetHexModelIdFromServiceData() used return value rather than a
-            // callback.
-            FastPairDataParser::GetHexModelIdFromServiceData(
-                service_data, {[&](std::optional<absl::string_view> model_id) {
-                  OnModelIdRetrieved(address, model_id);
-                }});
+            ParsedServiceData& parsed = parsed_service_data_[address];
+            if (parsed.service_data != fast_pair_service_data) {
+              NEARBY_LOGS(INFO) << __func__ << ": Attempting to get model ID";
+              std::vector<uint8_t> service_data(
+                  fast_pair_service_data.begin(),
+                  fast_pair_service_data.end());
+              parsed.service_data = fast_pair_service_data;
+              parsed.model_id.reset();
+              // TODO(jsobczak): GetHexModelIdFromServiceData() callback is
+              // synchronous. It would be simpler if
+              // GetHexModelIdFromServiceData() used return value rather than a
+              // callback.
+              FastPairDataParser::GetHexModelIdFromServiceData(
+                  service_data,
+                  {[&](std::optional<absl::string_view> model_id) {
+                    if (model_id.has_value()) {
+                      parsed.model_id = std::string(*model_id);
+                    }
+                  }});
+            }
+            std::optional<absl::string_view> model_id;
+            if (parsed.model_id.has_value()) model_id = *parsed.model_id;
+            OnModelIdRetrieved(address, model_id);
           });
 }
 
@@ -207,6 +216,7 @@ void FastPairDiscoverableScannerImpl::OnDeviceLost(
   executor_->Execute("device-lost",
                      [this, address = peripheral.GetName()]()
                          ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_) {
+                           parsed_service_data_.erase(address);
                            auto opt_device =
                                device_repository_->FindDevice(address);
 
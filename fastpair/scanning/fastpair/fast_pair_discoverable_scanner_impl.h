@@ -20,6 +20,7 @@
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "fastpair/common/device_metadata.h"
 #include "fastpair/common/fast_pair_device.h"
 #include "fastpair/repository/fast_pair_device_repository.h"
@@ -71,6 +72,12 @@ class FastPairDiscoverableScannerImpl : public FastPairDiscoverableScanner,
   void OnDeviceLost(const BlePeripheral& peripheral) override;
 
  private:
+  // The service data last seen from a device, and the model ID parsed from it.
+  struct ParsedServiceData {
+    std::string service_data;
+    std::optional<std::string> model_id;
+  };
+
   void OnModelIdRetrieved(const std::string& address,
                           std::optional<absl::string_view> model_id);
   void OnDeviceMetadataRetrieved(std::string address, std::string model_id,
@@ -83,6 +90,10 @@ class FastPairDiscoverableScannerImpl : public FastPairDiscoverableScanner,
   DeviceCallback lost_callback_ ABSL_GUARDED_BY(*executor_);
   SingleThreadExecutor* executor_;
   FastPairDeviceRepository* device_repository_ ABSL_GUARDED_BY(*executor_);
+  // By BLE address. Devices tend to repeat their service data, which then
+  // needn't be parsed again.
+  absl::flat_hash_map<std::string, ParsedServiceData> parsed_service_data_
+      ABSL_GUARDED_BY(*executor_);
   ObserverList<FastPairScanner::Observer> observer_list_;
 };
 
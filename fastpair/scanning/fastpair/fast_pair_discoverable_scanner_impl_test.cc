@@ -353,6 +353,39 @@ TEST(FastPairDiscoverableScannerImplTest,
   EXPECT_FALSE(lost_notification.WaitForNotificationWithTimeout(kWaitTimeout));
 }
 
+TEST(FastPairDiscoverableScannerImplTest, RepeatedServiceData) {
+  auto scanner = std::make_unique<FakeFastPairScanner>();
+  auto repository = std::make_unique<FakeFastPairRepository>();
+  SingleThreadExecutor executor;
+  FastPairDeviceRepository devices(&executor);
+  proto::Device metadata;
+  metadata.set_device_type(proto::DeviceType::TRUE_WIRELESS_HEADPHONES);
+  repository->SetFakeMetadata(kValidModelId, metadata);
+  absl::Notification first_notification;
+  absl::Notification second_notification;
+  int found_count = 0;
+  std::unique_ptr<FastPairDiscoverableScanner>
+      discoverable_scanner_from_factory =
+          FastPairDiscoverableScannerImpl::Factory::Create(
+              *scanner,
+              [&](FastPairDevice& device) {
+                if (++found_count == 1) {
+                  first_notification.Notify();
+                } else {
+                  second_notification.Notify();
+                }
+              },
+              [&](FastPairDevice& device) {}, &executor, &devices);
+
+  auto ble_peripheral =
+      std::make_unique<FakeBlePeripheral>(kTestBleDeviceAddress, kValidModelId);
+  scanner->NotifyDeviceFound(BlePeripheral(ble_peripheral.get()));
+  first_notification.WaitForNotification();
+  // Same service data, which reuses the parsed model ID.
+  scanner->NotifyDeviceFound(BlePeripheral(ble_peripheral.get()));
+  EXPECT_TRUE(second_notification.WaitForNotificationWithTimeout(kWaitTimeout));
+}
+
 }  // namespace
 }  // namespace fastpair
 }  // namespace nearby
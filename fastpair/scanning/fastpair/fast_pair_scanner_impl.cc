@@ -18,10 +18,14 @@
 #include <string>
 #include <utility>
 
+#include "absl/hash/hash.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "fastpair/common/constant.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/logging.h"
+#include "internal/platform/mutex_lock.h"
 
 namespace nearby {
 namespace fastpair {
@@ -45,8 +49,11 @@ class ScanningSessionImpl : public FastPairScanner::ScanningSession {
 
 // FastPairScannerImpl
 FastPairScannerImpl::FastPairScannerImpl(Mediums& mediums,
-                                         SingleThreadExecutor* executor)
-    : mediums_(mediums), executor_(executor) {}
+                                         SingleThreadExecutor* executor,
+                                         absl::Duration suppression_window)
+    : mediums_(mediums),
+      executor_(executor),
+      suppression_window_(suppression_window) {}
 
 void FastPairScannerImpl::AddObserver(FastPairScanner::Observer* observer) {
   observer_.AddObserver(observer);
@@ -131,25 +138,43 @@ void FastPairScannerImpl::StartTimer(absl::Duration delay,
 }
 
 void FastPairScannerImpl::OnDeviceFound(const BlePeripheral& peripheral) {
-  NEARBY_LOGS(INFO) << __func__ << "Found device with ble Address = "
-                    << peripheral.GetName();
   std::string service_data =
       peripheral.GetAdvertisementBytes(kServiceId).string_data();
   if (service_data.empty()) {
     NEARBY_LOGS(WARNING) << "No Fast Pair service data found on device";
     return;
   }
+  if (!ShouldNotify(peripheral.GetName(), service_data)) return;
 
-  device_address_advertisement_data_map_[peripheral.GetName()].insert(
-      service_data);
-
+  NEARBY_LOGS(INFO) << __func__ << "Found device with ble Address = "
+                    << peripheral.GetName();
   NotifyDeviceFound(peripheral);
 }
 
+bool FastPairScannerImpl::ShouldNotify(const std::string& address,
+                                       absl::string_view service_data) {
+  const size_t service_data_hash = absl::HashOf(service_data);
+  const absl::Time now = absl::Now();
+  MutexLock lock(&mutex_);
+  auto [it, inserted] = sightings_.try_emplace(
+      address, Sighting{service_data_hash, now});
+  if (inserted) return true;
+  Sighting& sighting = it->second;
+  if (sighting.service_data_hash == service_data_hash &&
+      now - sighting.notify_time < suppression_window_) {
+    return false;
+  }
+  sighting = {service_data_hash, now};
+  return true;
+}
+
 void FastPairScannerImpl::OnDeviceLost(const BlePeripheral& peripheral) {
   NEARBY_LOGS(INFO) << __func__ << "Lost device with ble Address = "
                     << peripheral.GetName();
-  device_address_advertisement_data_map_.erase(peripheral.GetName());
+  {
+    MutexLock lock(&mutex_);
+    sightings_.erase(peripheral.GetName());
+  }
 
   for (auto& observer : observer_.GetObservers()) {
     observer->OnDeviceLost(peripheral);
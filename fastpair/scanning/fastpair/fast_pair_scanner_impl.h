@@ -15,14 +15,17 @@
 #ifndef THIRD_PARTY_NEARBY_FASTPAIR_SCANNING_FASTPAIR_FAST_PAIR_SCANNER_IMPL_H_
 #define THIRD_PARTY_NEARBY_FASTPAIR_SCANNING_FASTPAIR_FAST_PAIR_SCANNER_IMPL_H_
 
+#include <cstddef>
 #include <memory>
-#include <set>
 #include <string>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/time/time.h"
 #include "fastpair/internal/mediums/mediums.h"
 #include "fastpair/scanning/fastpair/fast_pair_scanner.h"
 #include "internal/base/observer_list.h"
 #include "internal/platform/bluetooth_adapter.h"
+#include "internal/platform/mutex.h"
 #include "internal/platform/single_thread_executor.h"
 #include "internal/platform/timer_impl.h"
 
@@ -31,8 +34,13 @@ namespace fastpair {
 
 class FastPairScannerImpl : public FastPairScanner {
  public:
-  explicit FastPairScannerImpl(Mediums& mediums,
-                               SingleThreadExecutor* executor);
+  static constexpr absl::Duration kDefaultSuppressionWindow = absl::Seconds(5);
+
+  // A device advertising the same service data again within
+  // `suppression_window` of the last notification is not notified again.
+  explicit FastPairScannerImpl(
+      Mediums& mediums, SingleThreadExecutor* executor,
+      absl::Duration suppression_window = kDefaultSuppressionWindow);
   FastPairScannerImpl(const FastPairScannerImpl&) = delete;
   FastPairScannerImpl& operator=(const FastPairScannerImpl&) = delete;
   ~FastPairScannerImpl() override = default;
@@ -59,14 +67,25 @@ class FastPairScannerImpl : public FastPairScanner {
   void StartTimer(absl::Duration delay, absl::AnyInvocable<void()> callback)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_);
 
+  // The last notified sighting of a device.
+  struct Sighting {
+    size_t service_data_hash;
+    absl::Time notify_time;
+  };
+
+  // Returns true if the sighting of `address` with `service_data` should be
+  // notified, and records it if so.
+  bool ShouldNotify(const std::string& address, absl::string_view service_data)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
   Mediums& mediums_;
   SingleThreadExecutor* executor_;
+  const absl::Duration suppression_window_;
   std::unique_ptr<TimerImpl> timer_ ABSL_GUARDED_BY(*executor_);
 
-  // Map of a Bluetooth device address to a set of advertisement data we have
-  // seen.
-  absl::flat_hash_map<std::string, std::set<std::string>>
-      device_address_advertisement_data_map_;
+  Mutex mutex_;
+  // Map of a Bluetooth device address to its last notified sighting.
+  absl::flat_hash_map<std::string, Sighting> sightings_ ABSL_GUARDED_BY(mutex_);
   ObserverList<FastPairScanner::Observer> observer_;
 };
 
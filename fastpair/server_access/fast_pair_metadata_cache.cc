@@ -0,0 +1,166 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fastpair/server_access/fast_pair_metadata_cache.h"
+
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <optional>
+#include <string>
+#include <system_error>  // NOLINT
+#include <utility>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "fastpair/common/device_metadata.h"
+#include "fastpair/proto/cache.proto.h"
+#include "internal/platform/logging.h"
+
+namespace nearby {
+namespace fastpair {
+namespace {
+
+constexpr absl::string_view kFileSuffix = ".metadata";
+
+}  // namespace
+
+FastPairMetadataCache::FastPairMetadataCache(
+    const Clock* clock, std::optional<std::filesystem::path> directory,
+    absl::Duration ttl, int capacity)
+    : clock_(clock),
+      directory_(std::move(directory)),
+      ttl_(ttl),
+      capacity_(capacity) {}
+
+std::optional<DeviceMetadata> FastPairMetadataCache::Get(
+    absl::string_view model_id) {
+  absl::MutexLock lock(&mutex_);
+  auto it = index_.find(model_id);
+  if (it != index_.end()) {
+    if (IsExpired(it->second->second)) {
+      entries_.erase(it->second);
+      index_.erase(it);
+      return std::nullopt;
+    }
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return DeviceMetadata(entries_.front().second.response());
+  }
+  std::optional<proto::CachedDeviceMetadata> cached = Load(model_id);
+  if (!cached.has_value() || IsExpired(*cached)) {
+    return std::nullopt;
+  }
+  DeviceMetadata metadata(cached->response());
+  Insert(model_id, *std::move(cached));
+  return metadata;
+}
+
+void FastPairMetadataCache::Put(absl::string_view model_id,
+                                const DeviceMetadata& metadata) {
+  proto::CachedDeviceMetadata cached;
+  *cached.mutable_response() = metadata.GetResponse();
+  cached.set_fetch_time_millis(absl::ToUnixMillis(clock_->Now()));
+  Store(model_id, cached);
+  absl::MutexLock lock(&mutex_);
+  auto it = index_.find(model_id);
+  if (it != index_.end()) {
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+  Insert(model_id, std::move(cached));
+}
+
+bool FastPairMetadataCache::IsExpired(
+    const proto::CachedDeviceMetadata& cached) const {
+  return absl::FromUnixMillis(cached.fetch_time_millis()) + ttl_ <
+         clock_->Now();
+}
+
+std::optional<std::filesystem::path> FastPairMetadataCache::GetPath(
+    absl::string_view model_id) const {
+  if (!directory_.has_value() || model_id.empty()) {
+    return std::nullopt;
+  }
+  // Model IDs are hex strings, anything else doesn't make a file name.
+  for (char c : model_id) {
+    if (!absl::ascii_isxdigit(c)) return std::nullopt;
+  }
+  return *directory_ / absl::StrCat(absl::AsciiStrToLower(model_id),
+                                    kFileSuffix);
+}
+
+std::optional<proto::CachedDeviceMetadata> FastPairMetadataCache::Load(
+    absl::string_view model_id) const {
+  std::optional<std::filesystem::path> path = GetPath(model_id);
+  if (!path.has_value()) {
+    return std::nullopt;
+  }
+  std::ifstream file(*path, std::ios::binary);
+  if (!file.is_open()) {
+    return std::nullopt;
+  }
+  proto::CachedDeviceMetadata cached;
+  if (!cached.ParseFromIstream(&file)) {
+    NEARBY_LOGS(WARNING) << __func__ << ": Dropping unreadable metadata of "
+                         << model_id;
+    std::error_code error;
+    std::filesystem::remove(*path, error);
+    return std::nullopt;
+  }
+  return cached;
+}
+
+void FastPairMetadataCache::Store(
+    absl::string_view model_id,
+    const proto::CachedDeviceMetadata& cached) const {
+  std::optional<std::filesystem::path> path = GetPath(model_id);
+  if (!path.has_value()) {
+    return;
+  }
+  std::error_code error;
+  std::filesystem::create_directories(*directory_, error);
+  // Written to a temporary file first, so that a crash doesn't leave a
+  // truncated file in place of the metadata.
+  std::filesystem::path temporary_path = *path;
+  temporary_path += ".tmp";
+  {
+    std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open() || !cached.SerializeToOstream(&file)) {
+      NEARBY_LOGS(WARNING) << __func__ << ": Failed to write metadata of "
+                           << model_id << " to " << temporary_path.string();
+      return;
+    }
+  }
+  std::filesystem::rename(temporary_path, *path, error);
+  if (error) {
+    NEARBY_LOGS(WARNING) << __func__ << ": Failed to write metadata of "
+                         << model_id << ": " << error.message();
+    std::filesystem::remove(temporary_path, error);
+  }
+}
+
+void FastPairMetadataCache::Insert(absl::string_view model_id,
+                                   proto::CachedDeviceMetadata cached) {
+  while (!entries_.empty() && entries_.size() >= capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  entries_.emplace_front(std::string(model_id), std::move(cached));
+  index_[model_id] = entries_.begin();
+}
+
+}  // namespace fastpair
+}  // namespace nearby
@@ -0,0 +1,89 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_NEARBY_FASTPAIR_SERVER_ACCESS_FAST_PAIR_METADATA_CACHE_H_
+#define THIRD_PARTY_NEARBY_FASTPAIR_SERVER_ACCESS_FAST_PAIR_METADATA_CACHE_H_
+
+#include <filesystem>  // NOLINT(build/c++17)
+#include <list>
+#include <optional>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "fastpair/common/device_metadata.h"
+#include "fastpair/proto/cache.proto.h"
+#include "internal/platform/clock.h"
+
+namespace nearby {
+namespace fastpair {
+
+// Caches the metadata of Fast Pair device models, by model ID, so that the
+// devices of a popular model don't each fetch it from the server.
+//
+// The most recently used models are kept in memory. When a directory is given,
+// every model is also written to a file of its own there, which outlives the
+// process. Metadata older than the TTL is never returned. Thread-safe.
+class FastPairMetadataCache {
+ public:
+  static constexpr absl::Duration kDefaultTtl = absl::Hours(24);
+  static constexpr int kDefaultCapacity = 32;
+
+  // `clock` must outlive the cache. Without `directory`, the metadata is only
+  // cached in memory.
+  FastPairMetadataCache(const Clock* clock,
+                        std::optional<std::filesystem::path> directory,
+                        absl::Duration ttl = kDefaultTtl,
+                        int capacity = kDefaultCapacity);
+
+  // Returns the metadata of `model_id`, if it's cached and not expired.
+  std::optional<DeviceMetadata> Get(absl::string_view model_id)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Caches `metadata` as the metadata of `model_id`, fetched now.
+  void Put(absl::string_view model_id, const DeviceMetadata& metadata)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  using Entries = std::list<std::pair<std::string, proto::CachedDeviceMetadata>>;
+
+  bool IsExpired(const proto::CachedDeviceMetadata& cached) const;
+  // Returns the file of `model_id`, or nullopt if it isn't cached on disk.
+  std::optional<std::filesystem::path> GetPath(absl::string_view model_id) const;
+  std::optional<proto::CachedDeviceMetadata> Load(
+      absl::string_view model_id) const;
+  void Store(absl::string_view model_id,
+             const proto::CachedDeviceMetadata& cached) const;
+  void Insert(absl::string_view model_id, proto::CachedDeviceMetadata cached)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const Clock* const clock_;
+  const std::optional<std::filesystem::path> directory_;
+  const absl::Duration ttl_;
+  const int capacity_;
+
+  absl::Mutex mutex_;
+  // Most recently used first.
+  Entries entries_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, Entries::iterator> index_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace fastpair
+}  // namespace nearby
+
+#endif  // THIRD_PARTY_NEARBY_FASTPAIR_SERVER_ACCESS_FAST_PAIR_METADATA_CACHE_H_
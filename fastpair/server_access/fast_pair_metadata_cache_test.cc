@@ -0,0 +1,113 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fastpair/server_access/fast_pair_metadata_cache.h"
+
+#include <filesystem>  // NOLINT(build/c++17)
+#include <optional>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "fastpair/common/device_metadata.h"
+#include "fastpair/proto/fastpair_rpcs.proto.h"
+#include "internal/test/fake_clock.h"
+
+namespace nearby {
+namespace fastpair {
+namespace {
+
+constexpr absl::string_view kModelId = "9adb11";
+constexpr absl::string_view kDeviceName = "Pixel Buds Pro";
+
+DeviceMetadata CreateMetadata(absl::string_view name) {
+  proto::GetObservedDeviceResponse response;
+  response.mutable_device()->set_name(std::string(name));
+  return DeviceMetadata(response);
+}
+
+class FastPairMetadataCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    directory_ = std::filesystem::temp_directory_path() /
+                 ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    std::filesystem::remove_all(directory_);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(directory_); }
+
+  FakeClock clock_;
+  std::filesystem::path directory_;
+};
+
+TEST_F(FastPairMetadataCacheTest, GetsPutMetadata) {
+  FastPairMetadataCache cache(&clock_, std::nullopt);
+
+  EXPECT_FALSE(cache.Get(kModelId).has_value());
+  cache.Put(kModelId, CreateMetadata(kDeviceName));
+
+  std::optional<DeviceMetadata> metadata = cache.Get(kModelId);
+  ASSERT_TRUE(metadata.has_value());
+  EXPECT_EQ(metadata->GetDetails().name(), kDeviceName);
+}
+
+TEST_F(FastPairMetadataCacheTest, ExpiresMetadata) {
+  FastPairMetadataCache cache(&clock_, directory_, absl::Hours(1));
+  cache.Put(kModelId, CreateMetadata(kDeviceName));
+
+  clock_.FastForward(absl::Minutes(59));
+  EXPECT_TRUE(cache.Get(kModelId).has_value());
+  clock_.FastForward(absl::Minutes(2));
+  EXPECT_FALSE(cache.Get(kModelId).has_value());
+}
+
+TEST_F(FastPairMetadataCacheTest, EvictsLeastRecentlyUsed) {
+  FastPairMetadataCache cache(&clock_, std::nullopt,
+                              FastPairMetadataCache::kDefaultTtl,
+                              /*capacity=*/2);
+  cache.Put("01", CreateMetadata("first"));
+  cache.Put("02", CreateMetadata("second"));
+  EXPECT_TRUE(cache.Get("01").has_value());
+
+  cache.Put("03", CreateMetadata("third"));
+
+  EXPECT_TRUE(cache.Get("01").has_value());
+  EXPECT_FALSE(cache.Get("02").has_value());
+  EXPECT_TRUE(cache.Get("03").has_value());
+}
+
+TEST_F(FastPairMetadataCacheTest, LoadsMetadataFromDisk) {
+  FastPairMetadataCache(&clock_, directory_)
+      .Put(kModelId, CreateMetadata(kDeviceName));
+
+  FastPairMetadataCache cache(&clock_, directory_);
+  std::optional<DeviceMetadata> metadata = cache.Get(kModelId);
+
+  ASSERT_TRUE(metadata.has_value());
+  EXPECT_EQ(metadata->GetDetails().name(), kDeviceName);
+}
+
+TEST_F(FastPairMetadataCacheTest, DoesNotStoreInvalidModelIdOnDisk) {
+  FastPairMetadataCache(&clock_, directory_)
+      .Put("../model", CreateMetadata(kDeviceName));
+
+  EXPECT_FALSE(
+      FastPairMetadataCache(&clock_, directory_).Get("../model").has_value());
+  EXPECT_FALSE(std::filesystem::exists(directory_));
+}
+
+}  // namespace
+}  // namespace fastpair
+}  // namespace nearby
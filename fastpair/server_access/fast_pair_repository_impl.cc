@@ -15,41 +15,108 @@
 #include "fastpair/server_access/fast_pair_repository_impl.h"
 
 #include <algorithm>
+#include <filesystem>  // NOLINT(build/c++17)
 #include <memory>
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "fastpair/repository/fast_pair_metadata_repository.h"
 #include "fastpair/repository/fast_pair_metadata_repository_impl.h"
 #include "fastpair/server_access/fast_pair_metadata_downloader_impl.h"
 #include "internal/network/http_client_factory.h"
 #include "internal/network/http_client_factory_impl.h"
+#include "internal/platform/device_info_impl.h"
 #include "internal/platform/logging.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 
 namespace nearby {
 namespace fastpair {
+namespace {
+
+constexpr char kMetadataCacheDirectory[] = "fast_pair_metadata";
+
+}  // namespace
 
 FastPairRepositoryImpl::FastPairRepositoryImpl()
     : http_factory_(std::make_unique<nearby::network::HttpClientFactoryImpl>()),
       repository_factory_(
           std::make_unique<FastPairMetadataRepositoryFactoryImpl>(
-              http_factory_.get())) {}
+              http_factory_.get())),
+      cache_(&clock_,
+             DeviceInfoImpl().GetAppDataPath() / kMetadataCacheDirectory) {}
 
 FastPairRepositoryImpl::FastPairRepositoryImpl(
-    std::unique_ptr<FastPairMetadataRepositoryFactory> repository)
-    : repository_factory_(std::move(repository)) {}
+    std::unique_ptr<FastPairMetadataRepositoryFactory> repository,
+    std::optional<std::filesystem::path> cache_directory)
+    : repository_factory_(std::move(repository)),
+      cache_(&clock_, std::move(cache_directory)) {}
 
 void FastPairRepositoryImpl::GetDeviceMetadata(
     absl::string_view hex_model_id,
     DeviceMetadataCallback callback) {
-  downloader_ = FastPairMetadataDownloaderImpl::Factory::Create(
-      hex_model_id, repository_factory_.get(), std::move(callback), []() {
-        NEARBY_LOGS(INFO) << __func__
-                          << ": Fast Pair Metadata download failed.";
-      });
-  downloader_->Run();
+  std::optional<DeviceMetadata> cached = cache_.Get(hex_model_id);
+  if (cached.has_value()) {
+    NEARBY_LOGS(VERBOSE) << __func__ << ": Found cached metadata of "
+                         << hex_model_id;
+    callback(*cached);
+    return;
+  }
+
+  FastPairMetadataDownloader* downloader;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (running_callbacks_ == 0) finished_.clear();
+    auto it = pending_.find(hex_model_id);
+    if (it != pending_.end()) {
+      NEARBY_LOGS(VERBOSE) << __func__ << ": Joining the download of "
+                           << hex_model_id;
+      it->second->callbacks.push_back(std::move(callback));
+      return;
+    }
+    auto pending = std::make_unique<PendingDownload>();
+    pending->model_id = std::string(hex_model_id);
+    pending->callbacks.push_back(std::move(callback));
+    absl::string_view model_id = pending->model_id;
+    pending->downloader = FastPairMetadataDownloaderImpl::Factory::Create(
+        model_id, repository_factory_.get(),
+        [this, model_id](DeviceMetadata& device_metadata) {
+          OnDownloadFinished(model_id, &device_metadata);
+        },
+        [this, model_id]() {
+          NEARBY_LOGS(INFO) << __func__
+                            << ": Fast Pair Metadata download failed.";
+          OnDownloadFinished(model_id, nullptr);
+        });
+    downloader = pending->downloader.get();
+    pending_.emplace(hex_model_id, std::move(pending));
+  }
+  downloader->Run();
+}
+
+void FastPairRepositoryImpl::OnDownloadFinished(
+    absl::string_view model_id, DeviceMetadata* device_metadata) {
+  std::vector<DeviceMetadataCallback> callbacks;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = pending_.find(model_id);
+    if (it == pending_.end()) return;
+    callbacks = std::move(it->second->callbacks);
+    finished_.push_back(std::move(it->second));
+    pending_.erase(it);
+    ++running_callbacks_;
+  }
+  // `model_id` is owned by the finished download, which outlives this call.
+  if (device_metadata != nullptr) {
+    cache_.Put(model_id, *device_metadata);
+    for (DeviceMetadataCallback& callback : callbacks) {
+      callback(*device_metadata);
+    }
+  }
+  absl::MutexLock lock(&mutex_);
+  --running_callbacks_;
 }
 }  // namespace fastpair
 }  // namespace nearby
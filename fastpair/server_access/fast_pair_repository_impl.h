@@ -15,35 +15,68 @@
 #ifndef THIRD_PARTY_NEARBY_FASTPAIR_SERVER_ACCESS_FAST_PAIR_REPOSITORY_IMPL_H_
 #define THIRD_PARTY_NEARBY_FASTPAIR_SERVER_ACCESS_FAST_PAIR_REPOSITORY_IMPL_H_
 
+#include <filesystem>  // NOLINT(build/c++17)
 #include <memory>
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "fastpair/repository/fast_pair_metadata_repository.h"
+#include "fastpair/server_access/fast_pair_metadata_cache.h"
 #include "fastpair/server_access/fast_pair_metadata_downloader.h"
 #include "fastpair/server_access/fast_pair_repository.h"
 #include "internal/network/http_client_factory.h"
-#include "absl/strings/string_view.h"
+#include "internal/platform/clock_impl.h"
 
 namespace nearby {
 namespace fastpair {
 class FastPairRepositoryImpl : public FastPairRepository {
  public:
   FastPairRepositoryImpl();
+  // Without `cache_directory`, the metadata is only cached in memory.
   explicit FastPairRepositoryImpl(
-      std::unique_ptr<FastPairMetadataRepositoryFactory> repository);
+      std::unique_ptr<FastPairMetadataRepositoryFactory> repository,
+      std::optional<std::filesystem::path> cache_directory = std::nullopt);
   FastPairRepositoryImpl(const FastPairRepositoryImpl&) = delete;
   FastPairRepositoryImpl& operator=(const FastPairRepositoryImpl&) = delete;
   ~FastPairRepositoryImpl() override = default;
 
+  // Calls back with the cached metadata when there is one. Otherwise the
+  // metadata is downloaded, once for all the concurrent requests of a model.
   void GetDeviceMetadata(absl::string_view hex_model_id,
                          DeviceMetadataCallback callback) override;
 
  private:
-  std::unique_ptr<FastPairMetadataDownloader> downloader_;
+  // A download, and the requests waiting on it.
+  struct PendingDownload {
+    // Owned here, the downloader only keeps a view of it.
+    std::string model_id;
+    std::unique_ptr<FastPairMetadataDownloader> downloader;
+    std::vector<DeviceMetadataCallback> callbacks;
+  };
+
+  void OnDownloadFinished(absl::string_view model_id,
+                          DeviceMetadata* device_metadata)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
   std::unique_ptr<network::HttpClientFactory> http_factory_;
   std::unique_ptr<FastPairMetadataRepositoryFactory> repository_factory_;
+  ClockImpl clock_;
+  FastPairMetadataCache cache_;
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::unique_ptr<PendingDownload>> pending_
+      ABSL_GUARDED_BY(mutex_);
+  // Finished downloads can't be destroyed from their own callbacks, they are
+  // kept here until no callback runs.
+  std::vector<std::unique_ptr<PendingDownload>> finished_
+      ABSL_GUARDED_BY(mutex_);
+  int running_callbacks_ ABSL_GUARDED_BY(mutex_) = 0;
 };
 }  // namespace fastpair
 }  // namespace nearby
@@ -23,6 +23,7 @@
 #include "gmock/gmock.h"
 #include "protobuf-matchers/protocol-buffer-matchers.h"
 #include "gtest/gtest.h"
+#include "absl/synchronization/notification.h"
 #include "fastpair/common/device_metadata.h"
 #include "fastpair/proto/fastpair_rpcs.proto.h"
 #include "fastpair/repository/fake_fast_pair_metadata_repository.h"
@@ -102,6 +103,42 @@ TEST_F(FastPairRepositoryImplTest, MetadataDownloadSuccess) {
   EXPECT_TRUE(notification.WaitForNotificationWithTimeout(kWaitTimeout));
 }
 
+TEST_F(FastPairRepositoryImplTest, ConcurrentRequestsShareOneDownload) {
+  auto fake_repository_factory =
+      std::make_unique<FakeFastPairMetadataRepositoryFactory>();
+  fake_repository_factory_ = fake_repository_factory.get();
+  repository_ = std::make_unique<FastPairRepositoryImpl>(
+      std::move(fake_repository_factory));
+  int first_calls = 0;
+  int second_calls = 0;
+
+  repository_->GetDeviceMetadata(
+      kModelId, [&](DeviceMetadata& device_metadata) { ++first_calls; });
+  FakeFastPairMetadataRepository* repository =
+      fake_repository_factory_->fake_repository();
+  ASSERT_TRUE(repository != nullptr);
+  repository_->GetDeviceMetadata(
+      kModelId, [&](DeviceMetadata& device_metadata) { ++second_calls; });
+
+  EXPECT_EQ(fake_repository_factory_->fake_repository(), repository);
+  proto::GetObservedDeviceResponse response;
+  response.mutable_device()->set_id(kDeviceId);
+  response.mutable_device()->set_name(kDeviceName);
+  GetObservedDataRequestSuccess(response);
+  EXPECT_EQ(first_calls, 1);
+  EXPECT_EQ(second_calls, 1);
+
+  // Served from the cache, without downloading it again.
+  repository_->GetDeviceMetadata(kModelId,
+                                 [&](DeviceMetadata& device_metadata) {
+                                   OnSuccess(device_metadata);
+                                 });
+  EXPECT_EQ(fake_repository_factory_->fake_repository(), repository);
+  ASSERT_TRUE(result_);
+  ASSERT_TRUE(result_->device);
+  EXPECT_EQ(result_->device->name(), kDeviceName);
+}
+
 }  // namespace
 }  // namespace fastpair
 }  // namespace nearby
@@ -93,11 +93,9 @@ bool ParseBluetoothAddress(absl::string_view input,
 }
 
 std::string ConvertBluetoothAddressUIntToString(uint64_t address) {
-  std::string mac_address = absl::StrFormat(
-      "%02llX:%02llX:%02llX:%02llX:%02llX:%02llX", address >> 40,
-      (address >> 32) & 0xff, (address >> 24) & 0xff, (address >> 16) & 0xff,
-      (address >> 8) & 0xff, address & 0xff);
-  return CanonicalizeBluetoothAddress(mac_address);
+  // Addresses wider than 48 bits are invalid.
+  if (BluetoothAddress(address).ToUInt() != address) return std::string();
+  return BluetoothAddress(address).ToString();
 }
 
 std::string CanonicalizeBluetoothAddress(absl::string_view address) {
@@ -120,5 +118,30 @@ std::string CanonicalizeBluetoothAddress(uint64_t address) {
   return ConvertBluetoothAddressUIntToString(address);
 }
 
+absl::optional<BluetoothAddress> BluetoothAddress::FromString(
+    absl::string_view address) {
+  std::array<uint8_t, 6> bytes;
+  if (!ParseBluetoothAddress(address, absl::MakeSpan(bytes))) {
+    return absl::nullopt;
+  }
+  uint64_t value = 0;
+  for (uint8_t byte : bytes) {
+    value = (value << 8) | byte;
+  }
+  return BluetoothAddress(value);
+}
+
+std::array<uint8_t, 6> BluetoothAddress::ToBytes() const {
+  std::array<uint8_t, 6> bytes;
+  for (int i = 0; i < 6; ++i) {
+    bytes[i] = static_cast<uint8_t>(address_ >> (8 * (5 - i)));
+  }
+  return bytes;
+}
+
+std::string BluetoothAddress::ToString() const {
+  return CanonicalizeBluetoothAddress(ToBytes());
+}
+
 }  // namespace device
 }  // namespace nearby
@@ -20,8 +20,10 @@
 
 #include <array>
 #include <string>
+#include <utility>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "absl/types/span.h"
 
 namespace nearby {
@@ -45,6 +47,44 @@ std::string CanonicalizeBluetoothAddress(
     const std::array<uint8_t, 6>& address_bytes);
 std::string CanonicalizeBluetoothAddress(uint64_t address);
 
+// A 48-bit Bluetooth address. Compares and hashes as a number, so that maps
+// keyed by addresses don't format or compare strings on every lookup, and
+// addresses formatted differently, e.g. in lower case, are the same key.
+class BluetoothAddress {
+ public:
+  constexpr BluetoothAddress() = default;
+  // Only the low 48 bits of |address| are used.
+  constexpr explicit BluetoothAddress(uint64_t address)
+      : address_(address & kMask) {}
+
+  // Parses |address| in any of the formats ParseBluetoothAddress() accepts.
+  static absl::optional<BluetoothAddress> FromString(absl::string_view address);
+
+  constexpr uint64_t ToUInt() const { return address_; }
+  std::array<uint8_t, 6> ToBytes() const;
+  // Returns the address in the canonical format: XX:XX:XX:XX:XX:XX.
+  std::string ToString() const;
+
+  constexpr bool operator==(const BluetoothAddress& other) const {
+    return address_ == other.address_;
+  }
+  constexpr bool operator!=(const BluetoothAddress& other) const {
+    return address_ != other.address_;
+  }
+  constexpr bool operator<(const BluetoothAddress& other) const {
+    return address_ < other.address_;
+  }
+  template <typename H>
+  friend H AbslHashValue(H h, const BluetoothAddress& address) {
+    return H::combine(std::move(h), address.address_);
+  }
+
+ private:
+  static constexpr uint64_t kMask = 0xFFFFFFFFFFFF;
+
+  uint64_t address_ = 0;
+};
+
 }  // namespace device
 }  // namespace nearby
 
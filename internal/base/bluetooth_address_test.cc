@@ -18,6 +18,8 @@
 #include <string>
 
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
 #include "absl/types/span.h"
 
 namespace nearby {
@@ -54,6 +56,29 @@ TEST(BluetoothUtil, CanonicalizeBluetoothAddress) {
   EXPECT_EQ(CanonicalizeBluetoothAddress(0x001A2B3C4D5E6F89), "");
 }
 
+TEST(BluetoothAddress, FromString) {
+  absl::optional<BluetoothAddress> address =
+      BluetoothAddress::FromString("1a-2b-3c-4d-5e-6f");
+  ASSERT_TRUE(address.has_value());
+  EXPECT_EQ(address->ToUInt(), 0x1A2B3C4D5E6F);
+  EXPECT_EQ(address->ToString(), "1A:2B:3C:4D:5E:6F");
+  EXPECT_EQ(address->ToBytes(),
+            (std::array<uint8_t, 6>{{26, 43, 60, 77, 94, 111}}));
+  EXPECT_EQ(BluetoothAddress::FromString("1A2B3C4D5E6F"), address);
+
+  EXPECT_FALSE(BluetoothAddress::FromString("nearby").has_value());
+  EXPECT_FALSE(BluetoothAddress::FromString("1A:2B:3C:4D:5E").has_value());
+}
+
+TEST(BluetoothAddress, KeysMapRegardlessOfFormat) {
+  absl::flat_hash_map<BluetoothAddress, int> map;
+  map[*BluetoothAddress::FromString("1A:2B:3C:4D:5E:6F")] = 1;
+
+  EXPECT_EQ(map[*BluetoothAddress::FromString("1a:2b:3c:4d:5e:6f")], 1);
+  EXPECT_EQ(map[BluetoothAddress(0x1A2B3C4D5E6F)], 1);
+  EXPECT_EQ(map.size(), 1);
+}
+
 }  // namespace
 }  // namespace device
 }  // namespace nearby
@@ -0,0 +1,231 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks for the crypto primitives.
+//
+// Message sizes span what the primitives see in practice: 16 - 32 bytes for
+// advertisement and handshake fields, 1 KB for control frames and 32 KB for
+// payload chunks.
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "absl/strings/string_view.h"
+#include "internal/crypto/aead.h"
+#include "internal/crypto/ec_private_key.h"
+#include "internal/crypto/ed25519.h"
+#include "internal/crypto/hkdf.h"
+#include "internal/crypto/hmac.h"
+#include "internal/crypto/random.h"
+#include "internal/crypto/sha2.h"
+
+namespace crypto {
+namespace {
+
+void MessageSizes(benchmark::internal::Benchmark* benchmark) {
+  for (int size : {16, 32, 1024, 32 * 1024}) benchmark->Arg(size);
+}
+
+std::string RandomString(size_t size) {
+  std::string bytes(size, 0);
+  RandBytes(bytes.data(), bytes.size());
+  return bytes;
+}
+
+const Aead::AeadAlgorithm kAeadAlgorithms[] = {
+    Aead::AES_128_CTR_HMAC_SHA256,
+    Aead::AES_256_GCM,
+    Aead::AES_256_GCM_SIV,
+    Aead::CHACHA20_POLY1305,
+};
+
+const char* const kAeadNames[] = {
+    "aes_128_ctr_hmac_sha256",
+    "aes_256_gcm",
+    "aes_256_gcm_siv",
+    "chacha20_poly1305",
+};
+
+// Arguments are {algorithm, size}, see kAeadAlgorithms.
+void AeadArgs(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"algorithm", "size"})
+      ->ArgsProduct({{0, 1, 2, 3}, {16, 32, 1024, 32 * 1024}});
+}
+
+void BM_AeadSeal(benchmark::State& state) {
+  Aead aead(kAeadAlgorithms[state.range(0)]);
+  const std::string key = RandomString(aead.KeyLength());
+  aead.Init(&key);
+  const std::string nonce = RandomString(aead.NonceLength());
+  const std::string plaintext = RandomString(state.range(1));
+  std::string ciphertext;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(aead.Seal(plaintext, nonce, "", &ciphertext));
+  }
+  state.SetLabel(kAeadNames[state.range(0)]);
+  state.SetBytesProcessed(state.iterations() * plaintext.size());
+}
+
+void BM_AeadOpen(benchmark::State& state) {
+  Aead aead(kAeadAlgorithms[state.range(0)]);
+  const std::string key = RandomString(aead.KeyLength());
+  aead.Init(&key);
+  const std::string nonce = RandomString(aead.NonceLength());
+  const std::string plaintext = RandomString(state.range(1));
+  std::string ciphertext;
+  if (!aead.Seal(plaintext, nonce, "", &ciphertext)) {
+    state.SkipWithError("Seal failed.");
+    return;
+  }
+  std::string opened;
+  for (auto _ : state) {
+    if (!aead.Open(ciphertext, nonce, "", &opened)) {
+      state.SkipWithError("Open failed.");
+      break;
+    }
+  }
+  state.SetLabel(kAeadNames[state.range(0)]);
+  state.SetBytesProcessed(state.iterations() * plaintext.size());
+}
+
+void BM_HkdfSha256(benchmark::State& state) {
+  const std::string secret = RandomString(32);
+  const std::string salt = RandomString(32);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        HkdfSha256(secret, salt, "benchmark", state.range(0)));
+  }
+}
+
+void BM_HmacSha256Sign(benchmark::State& state) {
+  HMAC hmac(HMAC::SHA256);
+  if (!hmac.Init(RandomString(32))) {
+    state.SkipWithError("Init failed.");
+    return;
+  }
+  const std::string data = RandomString(state.range(0));
+  std::array<unsigned char, kSHA256Length> digest;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hmac.Sign(data, digest.data(), digest.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+void BM_HmacSha256Verify(benchmark::State& state) {
+  HMAC hmac(HMAC::SHA256);
+  const std::string data = RandomString(state.range(0));
+  std::array<unsigned char, kSHA256Length> digest;
+  if (!hmac.Init(RandomString(32)) ||
+      !hmac.Sign(data, digest.data(), digest.size())) {
+    state.SkipWithError("Sign failed.");
+    return;
+  }
+  const absl::string_view expected(reinterpret_cast<const char*>(digest.data()),
+                                   digest.size());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hmac.Verify(data, expected));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+void BM_Sha256(benchmark::State& state) {
+  const std::string data = RandomString(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(SHA256HashString(data));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+void BM_EcPrivateKeyCreate(benchmark::State& state) {
+  for (auto _ : state) {
+    std::unique_ptr<ECPrivateKey> key = ECPrivateKey::Create();
+    benchmark::DoNotOptimize(key.get());
+  }
+}
+
+void BM_EcPrivateKeyExportRawPublicKey(benchmark::State& state) {
+  std::unique_ptr<ECPrivateKey> key = ECPrivateKey::Create();
+  std::string public_key;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(key->ExportRawPublicKey(&public_key));
+  }
+}
+
+void BM_Ed25519CreateKeyPair(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Ed25519Signer::CreateNewKeyPair().ok());
+  }
+}
+
+void BM_Ed25519Sign(benchmark::State& state) {
+  auto key_pair = Ed25519Signer::CreateNewKeyPair();
+  if (!key_pair.ok()) {
+    state.SkipWithError("Key generation failed.");
+    return;
+  }
+  auto signer = Ed25519Signer::Create(key_pair->private_key);
+  if (!signer.ok()) {
+    state.SkipWithError("Signer creation failed.");
+    return;
+  }
+  const std::string data = RandomString(state.range(0));
+  for (auto _ : state) {
+    std::optional<std::string> signature = signer->Sign(data);
+    benchmark::DoNotOptimize(signature.has_value());
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+void BM_Ed25519Verify(benchmark::State& state) {
+  auto key_pair = Ed25519Signer::CreateNewKeyPair();
+  if (!key_pair.ok()) {
+    state.SkipWithError("Key generation failed.");
+    return;
+  }
+  auto signer = Ed25519Signer::Create(key_pair->private_key);
+  auto verifier = Ed25519Verifier::Create(key_pair->public_key);
+  if (!signer.ok() || !verifier.ok()) {
+    state.SkipWithError("Signer or verifier creation failed.");
+    return;
+  }
+  const std::string data = RandomString(state.range(0));
+  std::optional<std::string> signature = signer->Sign(data);
+  if (!signature.has_value()) {
+    state.SkipWithError("Sign failed.");
+    return;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(verifier->Verify(data, *signature).ok());
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK(BM_AeadSeal)->Apply(AeadArgs);
+BENCHMARK(BM_AeadOpen)->Apply(AeadArgs);
+BENCHMARK(BM_HkdfSha256)->ArgName("derived_size")->Arg(16)->Arg(32)->Arg(64);
+BENCHMARK(BM_HmacSha256Sign)->ArgName("size")->Apply(MessageSizes);
+BENCHMARK(BM_HmacSha256Verify)->ArgName("size")->Apply(MessageSizes);
+BENCHMARK(BM_Sha256)->ArgName("size")->Apply(MessageSizes);
+BENCHMARK(BM_EcPrivateKeyCreate);
+BENCHMARK(BM_EcPrivateKeyExportRawPublicKey);
+BENCHMARK(BM_Ed25519CreateKeyPair);
+BENCHMARK(BM_Ed25519Sign)->ArgName("size")->Apply(MessageSizes);
+BENCHMARK(BM_Ed25519Verify)->ArgName("size")->Apply(MessageSizes);
+
+}  // namespace
+}  // namespace crypto
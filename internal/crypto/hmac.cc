@@ -17,6 +17,7 @@
 #include <stddef.h>
 
 #include <algorithm>
+#include <memory>
 #include <string>
 
 #ifdef NEARBY_CHROMIUM
@@ -35,16 +36,16 @@
 
 namespace crypto {
 
+struct HMAC::KeyedContext {
+  bssl::ScopedHMAC_CTX ctx;
+};
+
 HMAC::HMAC(HashAlgorithm hash_alg) : hash_alg_(hash_alg), initialized_(false) {
   // Only SHA-1 and SHA-256 hash algorithms are supported now.
   DCHECK(hash_alg_ == SHA1 || hash_alg_ == SHA256);
 }
 
-HMAC::~HMAC() {
-  // Zero out key copy.
-  key_.assign(key_.size(), 0);
-  nearbybase::STLClearObject(&key_);
-}
+HMAC::~HMAC() = default;
 
 size_t HMAC::DigestLength() const {
   switch (hash_alg_) {
@@ -62,7 +63,16 @@ bool HMAC::Init(const unsigned char* key, size_t key_length) {
   // Init must not be called more than once on the same HMAC object.
   DCHECK(!initialized_);
   initialized_ = true;
-  key_.assign(key, key + key_length);
+  EnsureOpenSSLInit();
+  auto keyed_context = std::make_unique<KeyedContext>();
+  // HMAC_Init_ex() takes a null key to mean "keep the current one".
+  static const unsigned char kEmptyKey = 0;
+  if (!HMAC_Init_ex(keyed_context->ctx.get(), key ? key : &kEmptyKey,
+                    key_length, hash_alg_ == SHA1 ? EVP_sha1() : EVP_sha256(),
+                    nullptr)) {
+    return false;
+  }
+  keyed_context_ = std::move(keyed_context);
   return true;
 }
 
@@ -78,13 +88,18 @@ bool HMAC::Sign(absl::Span<const uint8_t> data,
                 absl::Span<uint8_t> digest) const {
   DCHECK(initialized_);
 
-  if (digest.size() > DigestLength()) return false;
+  if (digest.size() > DigestLength() || keyed_context_ == nullptr) {
+    return false;
+  }
 
+  // Copying the keyed context skips hashing the padded key again, and leaves
+  // it untouched for concurrent and later calls.
+  bssl::ScopedHMAC_CTX ctx;
+  if (!HMAC_CTX_copy_ex(ctx.get(), keyed_context_->ctx.get())) return false;
   ScopedOpenSSLSafeSizeBuffer<EVP_MAX_MD_SIZE> result(digest.data(),
                                                       digest.size());
-  return !!::HMAC(hash_alg_ == SHA1 ? EVP_sha1() : EVP_sha256(), key_.data(),
-                  key_.size(), data.data(), data.size(), result.safe_buffer(),
-                  nullptr);
+  return HMAC_Update(ctx.get(), data.data(), data.size()) &&
+         HMAC_Final(ctx.get(), result.safe_buffer(), nullptr);
 }
 
 bool HMAC::Verify(absl::string_view data, absl::string_view digest) const {
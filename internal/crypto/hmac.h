@@ -16,6 +16,10 @@
 // support SHA-1 and SHA-256 for the hash algorithm, but this can be extended
 // easily. Prefer the absl::Span and std::vector overloads over the
 // absl::string_view and std::string overloads.
+//
+// The padded key is hashed once, by Init(), so keep an HMAC object around
+// rather than creating one per message when signing many messages with the
+// same key.
 
 #ifndef THIRD_PARTY_NEARBY_INTERNAL_CRYPTO_HMAC_H_
 #define THIRD_PARTY_NEARBY_INTERNAL_CRYPTO_HMAC_H_
@@ -88,7 +92,8 @@ class CRYPTO_EXPORT HMAC {
   // to the constructor and the key supplied to the Init method. The HMAC is
   // returned in |digest|, which has |digest_length| bytes of storage available.
   // If |digest_length| is smaller than DigestLength(), the output will be
-  // truncated. If it is larger, this method will fail.
+  // truncated. If it is larger, this method will fail. Safe to call from
+  // several threads at once.
   ABSL_MUST_USE_RESULT bool Sign(absl::string_view data, unsigned char* digest,
                                  size_t digest_length) const;
   ABSL_MUST_USE_RESULT bool Sign(absl::Span<const uint8_t> data,
@@ -115,9 +120,12 @@ class CRYPTO_EXPORT HMAC {
       absl::Span<const uint8_t> digest) const ABSL_MUST_USE_RESULT;
 
  private:
+  // The HMAC context right after keying, which Sign() copies from.
+  struct KeyedContext;
+
   HashAlgorithm hash_alg_;
   bool initialized_;
-  std::vector<unsigned char> key_;
+  std::unique_ptr<KeyedContext> keyed_context_;
 };
 
 }  // namespace crypto
@@ -20,6 +20,7 @@
 #include <array>
 #include <iterator>
 #include <string>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -376,3 +377,23 @@ TEST(HMACTest, Bytes) {
   EXPECT_FALSE(hmac.VerifyTruncated(
       data, absl::MakeSpan(calculated_hmac, kSHA256DigestSize / 2)));
 }
+
+TEST(HMACTest, SignConcurrently) {
+  crypto::HMAC hmac(crypto::HMAC::SHA1);
+  ASSERT_TRUE(hmac.Init(reinterpret_cast<const unsigned char *>(kSimpleKey),
+                        kSimpleKeyLength));
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < std::size(kSimpleHmacCases); ++i) {
+    threads.emplace_back([&hmac, i]() {
+      std::string data_string(kSimpleHmacCases[i].data,
+                              kSimpleHmacCases[i].data_len);
+      for (int j = 0; j < 100; ++j) {
+        unsigned char digest[kSHA1DigestSize];
+        EXPECT_TRUE(hmac.Sign(data_string, digest, kSHA1DigestSize));
+        EXPECT_EQ(0,
+                  memcmp(kSimpleHmacCases[i].digest, digest, kSHA1DigestSize));
+      }
+    });
+  }
+  for (std::thread &thread : threads) thread.join();
+}
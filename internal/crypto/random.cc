@@ -15,14 +15,73 @@
 #include "internal/crypto/random.h"
 
 #include <stddef.h>
+#include <string.h>
 
+#include <cstdint>
 #include <string>
 
+#include <openssl/mem.h>
 #include <openssl/rand.h>
 
+// BoringSSL's fork detection, which its own RNG relies on, isn't in its public
+// headers. The SwiftPM build links a BoringSSL whose symbols are prefixed, so
+// it can't be declared there, and that build goes without the buffer.
+#if defined(OPENSSL_IS_BORINGSSL) && !defined(NEARBY_SWIFTPM)
+#define NEARBY_RAND_FORK_GENERATION 1
+// Changes in a child created by fork() or clone() without CLONE_VM. Zero if
+// that can't be detected.
+extern "C" OPENSSL_EXPORT uint64_t CRYPTO_get_fork_generation(void);
+#endif
+
 namespace crypto {
 
+namespace {
+
+#if defined(NEARBY_RAND_FORK_GENERATION)
+// Requests of up to this many bytes, e.g. salts, nonces and IDs, are served
+// from a per-thread buffer, which is refilled kBufferSize bytes at a time.
+constexpr size_t kMaxBufferedLength = 32;
+constexpr size_t kBufferSize = 512;
+
+struct RandomBuffer {
+  ~RandomBuffer() { OPENSSL_cleanse(bytes, sizeof(bytes)); }
+
+  uint8_t bytes[kBufferSize];
+  // The unused bytes are the last |available| ones of |bytes|.
+  size_t available = 0;
+  uint64_t fork_generation = 0;
+};
+
+// Returns whether |length| bytes were served from the buffer.
+bool RandBytesFromBuffer(uint8_t *bytes, size_t length) {
+  if (length > kMaxBufferedLength) return false;
+  uint64_t generation = CRYPTO_get_fork_generation();
+  // Without fork detection, a child could hand out the same bytes as its
+  // parent.
+  if (generation == 0) return false;
+
+  thread_local RandomBuffer buffer;
+  if (buffer.fork_generation != generation || buffer.available < length) {
+    // Every refill is fresh output of RAND_bytes(), which reseeds on its own.
+    RAND_bytes(buffer.bytes, kBufferSize);
+    buffer.available = kBufferSize;
+    buffer.fork_generation = generation;
+  }
+  uint8_t *start = buffer.bytes + kBufferSize - buffer.available;
+  memcpy(bytes, start, length);
+  // Bytes are handed out once, and not kept around once handed out.
+  OPENSSL_cleanse(start, length);
+  buffer.available -= length;
+  return true;
+}
+#else
+bool RandBytesFromBuffer(uint8_t *, size_t) { return false; }
+#endif
+
+}  // namespace
+
 void RandBytes(void *bytes, size_t length) {
+  if (RandBytesFromBuffer(reinterpret_cast<uint8_t *>(bytes), length)) return;
   RAND_bytes(reinterpret_cast<uint8_t *>(bytes), length);
 }
 
@@ -16,6 +16,12 @@
 
 #include <stddef.h>
 
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <set>
 #include <string>
 
 #include "gtest/gtest.h"
@@ -54,6 +60,43 @@ TEST(RandBytes, RandomString) {
   EXPECT_TRUE(!IsTrivial(bytes));
 }
 
+TEST(RandBytes, SmallRequestsAreDistinct) {
+  // Enough requests to go through the per-thread buffer several times.
+  std::set<std::string> values;
+  for (int i = 0; i < 1000; ++i) {
+    std::string bytes(16, '\0');
+    RandBytes(nearbybase::WriteInto(&bytes, bytes.size()), bytes.size());
+    EXPECT_TRUE(values.insert(bytes).second);
+  }
+}
+
+#if !defined(_WIN32)
+TEST(RandBytes, ForkedChildGetsOtherBytes) {
+  // Leave buffered bytes behind for the child to inherit.
+  char bytes[16];
+  RandBytes(bytes, sizeof(bytes));
+
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    RandBytes(bytes, sizeof(bytes));
+    _exit(write(fds[1], bytes, sizeof(bytes)) == sizeof(bytes) ? 0 : 1);
+  }
+  RandBytes(bytes, sizeof(bytes));
+  char child_bytes[16];
+  EXPECT_EQ(read(fds[0], child_bytes, sizeof(child_bytes)),
+            sizeof(child_bytes));
+  waitpid(pid, nullptr, 0);
+  close(fds[0]);
+  close(fds[1]);
+
+  EXPECT_NE(std::string(bytes, sizeof(bytes)),
+            std::string(child_bytes, sizeof(child_bytes)));
+}
+#endif
+
 TEST(RandBytes, RandData) {
   uint64_t x = nearby::RandData<uint64_t>();
   uint64_t y = nearby::RandData<uint64_t>();
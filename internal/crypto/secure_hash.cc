@@ -57,6 +57,8 @@ class SecureHashSHA256 : public SecureHash {
 
   size_t GetHashLength() const override { return SHA256_DIGEST_LENGTH; }
 
+  void Reset() override { SHA256_Init(&ctx_); }
+
  private:
   SHA256_CTX ctx_;
 };
@@ -43,6 +43,10 @@ class CRYPTO_EXPORT SecureHash {
   virtual void Finish(void* output, size_t len) = 0;
   virtual size_t GetHashLength() const = 0;
 
+  // Starts over, as if newly created, so that one SecureHash can hash many
+  // inputs in turn without being recreated for each.
+  virtual void Reset() = 0;
+
   // Create a clone of this SecureHash. The returned clone and this both
   // represent the same hash state. But from this point on, calling
   // Update()/Finish() on either doesn't affect the state of the other.
@@ -115,3 +115,24 @@ TEST(SecureHashTest, Equality) {
   // The hash should be the same.
   EXPECT_EQ(0, memcmp(output1, output2, crypto::kSHA256Length));
 }
+
+TEST(SecureHashTest, Reset) {
+  std::string input1(10001, 'a');  // 'a' repeated 10001 times
+  std::string input2(10001, 'd');  // 'd' repeated 10001 times
+
+  uint8_t output1[crypto::kSHA256Length];
+  uint8_t output2[crypto::kSHA256Length];
+
+  std::unique_ptr<crypto::SecureHash> ctx(
+      crypto::SecureHash::Create(crypto::SecureHash::SHA256));
+  ctx->Update(input1.data(), input1.size());
+  ctx->Finish(output1, sizeof(output1));
+  // Resetting drops what was hashed before, even if it wasn't finished.
+  ctx->Reset();
+  ctx->Update(input2.data(), input2.size());
+  ctx->Reset();
+  ctx->Update(input1.data(), input1.size());
+  ctx->Finish(output2, sizeof(output2));
+
+  EXPECT_EQ(0, memcmp(output1, output2, crypto::kSHA256Length));
+}
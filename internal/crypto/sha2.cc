@@ -16,12 +16,15 @@
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <array>
-#include <memory>
+#include <cstring>
 #include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
-#include "internal/crypto/secure_hash.h"
+#include "internal/crypto/openssl_util.h"
+#include <openssl/mem.h>
 #include <openssl/sha.h>
 
 namespace crypto {
@@ -32,10 +35,27 @@ std::array<uint8_t, kSHA256Length> SHA256Hash(absl::Span<const uint8_t> input) {
   return digest;
 }
 
+std::vector<std::array<uint8_t, kSHA256Length>> SHA256HashBatch(
+    absl::Span<const absl::Span<const uint8_t>> inputs) {
+  EnsureOpenSSLInit();
+  std::vector<std::array<uint8_t, kSHA256Length>> digests(inputs.size());
+  // One context, reinitialized in place for every input.
+  SHA256_CTX ctx;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    SHA256_Init(&ctx);
+    SHA256_Update(&ctx, inputs[i].data(), inputs[i].size());
+    SHA256_Final(digests[i].data(), &ctx);
+  }
+  OPENSSL_cleanse(&ctx, sizeof(ctx));
+  return digests;
+}
+
 void SHA256HashString(absl::string_view str, void* output, size_t len) {
-  std::unique_ptr<SecureHash> ctx(SecureHash::Create(SecureHash::SHA256));
-  ctx->Update(str.data(), str.length());
-  ctx->Finish(output, len);
+  std::array<uint8_t, kSHA256Length> digest =
+      SHA256Hash(absl::MakeConstSpan(
+          reinterpret_cast<const uint8_t*>(str.data()), str.size()));
+  memcpy(output, digest.data(), std::min(len, digest.size()));
+  OPENSSL_cleanse(digest.data(), digest.size());
 }
 
 std::string SHA256HashString(absl::string_view str) {
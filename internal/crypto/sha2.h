@@ -20,6 +20,7 @@
 #include <cstdint>
 #include <array>
 #include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
@@ -37,6 +38,11 @@ static const size_t kSHA256Length = 32;  // Length in bytes of a SHA-256 hash.
 CRYPTO_EXPORT std::array<uint8_t, kSHA256Length> SHA256Hash(
     absl::Span<const uint8_t> input);
 
+// Computes the SHA-256 hashes of |inputs|, in order. Cheaper than calling
+// SHA256Hash() for each when there are many small inputs.
+CRYPTO_EXPORT std::vector<std::array<uint8_t, kSHA256Length>> SHA256HashBatch(
+    absl::Span<const absl::Span<const uint8_t>> inputs);
+
 // Convenience version of the above that returns the result in a 32-byte
 // string.
 CRYPTO_EXPORT std::string SHA256HashString(absl::string_view str);
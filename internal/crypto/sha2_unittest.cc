@@ -17,9 +17,12 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <array>
 #include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
+#include "absl/types/span.h"
 
 TEST(Sha256Test, Test1) {
   // Example B.1 from FIPS 180-2: one-block message.
@@ -96,3 +99,23 @@ TEST(Sha256Test, Test3) {
   for (size_t i = 0; i < sizeof(output_truncated3); i++)
     EXPECT_EQ(expected3[i], static_cast<int>(output_truncated3[i]));
 }
+
+TEST(Sha256Test, Batch) {
+  std::string input1 = "abc";
+  std::string input2(1000, 'a');
+  std::vector<absl::Span<const uint8_t>> inputs = {
+      absl::MakeConstSpan(reinterpret_cast<const uint8_t*>(input1.data()),
+                          input1.size()),
+      absl::MakeConstSpan(reinterpret_cast<const uint8_t*>(input2.data()),
+                          input2.size()),
+      {},
+  };
+
+  std::vector<std::array<uint8_t, crypto::kSHA256Length>> digests =
+      crypto::SHA256HashBatch(inputs);
+
+  ASSERT_EQ(digests.size(), inputs.size());
+  for (size_t i = 0; i < inputs.size(); i++)
+    EXPECT_EQ(digests[i], crypto::SHA256Hash(inputs[i]));
+  EXPECT_TRUE(crypto::SHA256HashBatch({}).empty());
+}
@@ -17,8 +17,10 @@
 
 #include <functional>
 #include <memory>
+#include <utility>
 
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
 #include "internal/network/http_request.h"
 #include "internal/network/http_response.h"
 #include "internal/platform/mutex_lock.h"
@@ -55,6 +57,10 @@ class HttpClient {
     HttpRequest http_request_ ABSL_GUARDED_BY(mutex_);
   };
 
+  // Receives the response body piece by piece as it arrives. Returning false
+  // stops the download, which then fails as cancelled.
+  using BodyChunkCallback = std::function<bool(absl::string_view chunk)>;
+
   virtual ~HttpClient() = default;
 
   // Starts HTTP request in asynchronization mode.
@@ -67,6 +73,34 @@ class HttpClient {
       std::unique_ptr<CancellableRequest> request,
       std::function<void(const absl::StatusOr<HttpResponse>&)> callback) = 0;
 
+  // Starts HTTP request in asynchronization mode, handing the body of a
+  // successful response to |on_body_chunk| as it arrives instead of
+  // buffering it, e.g. to parse it incrementally or to write it to a file.
+  // |callback| is called once the body is complete, with an empty body.
+  //
+  // Clients that can't stream hand the buffered body over in one chunk.
+  virtual void StartStreamingRequest(
+      const HttpRequest& request, BodyChunkCallback on_body_chunk,
+      std::function<void(const absl::StatusOr<HttpResponse>&)> callback) {
+    StartRequest(request, [on_body_chunk = std::move(on_body_chunk),
+                           callback = std::move(callback)](
+                              const absl::StatusOr<HttpResponse>& response) {
+      if (!response.ok()) {
+        callback(response);
+        return;
+      }
+      if (!on_body_chunk(response->GetBody().GetRawData())) {
+        callback(absl::CancelledError("Download stopped by the caller."));
+        return;
+      }
+      HttpResponse headers_only;
+      headers_only.SetStatusCode(response->GetStatusCode());
+      headers_only.SetReasonPhrase(response->GetReasonPhrase());
+      headers_only.SetHeaders(response->GetAllHeaders());
+      callback(headers_only);
+    });
+  }
+
   // Gets HTTP response in synchronization mode.
   virtual absl::StatusOr<HttpResponse> GetResponse(
       const HttpRequest& request) = 0;
@@ -17,18 +17,25 @@
 #include <chrono>  // NOLINT
 #include <functional>
 #include <future>  // NOLINT
+#include <map>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <sstream>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/functional/any_invocable.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "internal/flags/nearby_flags.h"
 #include "internal/network/debug.h"
 #include "internal/platform/flags/nearby_platform_feature_flags.h"
 #include "internal/platform/logging.h"
+#include "internal/platform/multi_thread_executor.h"
 #include "internal/platform/mutex_lock.h"
-#include "internal/platform/single_thread_executor.h"
 
 namespace nearby {
 namespace network {
@@ -37,29 +44,56 @@ void NearbyHttpClient::StartRequest(
     const HttpRequest& request,
     std::function<void(const absl::StatusOr<HttpResponse>&)> callback) {
   MutexLock lock(&mutex_);
+  std::optional<std::string> get_key;
+  if (request.GetMethod() == HttpRequestMethod::kGet) {
+    get_key = GetRequestKey(request);
+    PendingGet& pending_get = pending_gets_[*get_key];
+    pending_get.callbacks.push_back(std::move(callback));
+    if (pending_get.callbacks.size() > 1) {
+      NEARBY_LOGS(INFO) << __func__ << ": Joined the request in flight to url="
+                        << request.GetUrl().GetUrlPath();
+      // Moves the request up the queue if this one is more urgent.
+      if (pending_get.queue_key.has_value() &&
+          -pending_get.queue_key->first <
+              static_cast<int>(request.GetPriority())) {
+        auto node = queue_.extract(*pending_get.queue_key);
+        pending_get.queue_key = MakeQueueKey(request.GetPriority());
+        node.key() = *pending_get.queue_key;
+        queue_.insert(std::move(node));
+      }
+      return;
+    }
+    callback = [this, key = *get_key](
+                   const absl::StatusOr<HttpResponse>& response) {
+      OnGetResponse(key, response);
+    };
+  }
   if (NearbyFlags::GetInstance().GetBoolFlag(
           platform::config_package_nearby::nearby_platform_feature::
               kEnablePlatformThreadToNetwork)) {
-    executor_.Execute([request = std::move(request),
-                       callback = std::move(callback)]() {
-      NEARBY_LOGS(INFO) << __func__ << ": Start async request to url="
-                        << request.GetUrl().GetUrlPath();
-      absl::StatusOr<HttpResponse> response = InternalGetResponse(request);
-      if (response.ok()) {
-        NEARBY_LOGS(INFO) << __func__ << ": Got response from url="
-                          << request.GetUrl().GetUrlPath();
-      } else {
-        NEARBY_LOGS(ERROR) << __func__ << ": Failed to get response from url="
-                           << request.GetUrl().GetUrlPath() << ", status"
-                           << response.status();
-      }
+    Enqueue(
+        request.GetPriority(),
+        [request, callback = std::move(callback)]() {
+          NEARBY_LOGS(INFO) << __func__ << ": Start async request to url="
+                            << request.GetUrl().GetUrlPath();
+          absl::StatusOr<HttpResponse> response = InternalGetResponse(request);
+          if (response.ok()) {
+            NEARBY_LOGS(INFO) << __func__ << ": Got response from url="
+                              << request.GetUrl().GetUrlPath();
+          } else {
+            NEARBY_LOGS(ERROR)
+                << __func__ << ": Failed to get response from url="
+                << request.GetUrl().GetUrlPath() << ", status"
+                << response.status();
+          }
 
-      if (callback) {
-        callback(response);
-      }
-      NEARBY_LOGS(INFO) << __func__ << ": Completed request to url="
-                        << request.GetUrl().GetUrlPath();
-    });
+          if (callback) {
+            callback(response);
+          }
+          NEARBY_LOGS(INFO) << __func__ << ": Completed request to url="
+                            << request.GetUrl().GetUrlPath();
+        },
+        std::move(get_key));
   } else {
     CleanThreads();
 
@@ -96,8 +130,9 @@ void NearbyHttpClient::StartCancellableRequest(
     callback(absl::InvalidArgumentError("invalid cancellable request"));
     return;
   }
-  executor_
-      .Execute(
+  HttpRequestPriority priority =
+      cancellable_request->http_request().GetPriority();
+  Enqueue(priority,
           [cancellable_request = std::move(cancellable_request),
            callback = std::move(callback)]() {
             NEARBY_LOGS(INFO)
@@ -140,6 +175,31 @@ void NearbyHttpClient::StartCancellableRequest(
           });
 }
 
+void NearbyHttpClient::StartStreamingRequest(
+    const HttpRequest& request, BodyChunkCallback on_body_chunk,
+    std::function<void(const absl::StatusOr<HttpResponse>&)> callback) {
+  MutexLock lock(&mutex_);
+  Enqueue(request.GetPriority(), [request,
+                                  on_body_chunk = std::move(on_body_chunk),
+                                  callback = std::move(callback)]() mutable {
+    NEARBY_LOGS(INFO) << __func__ << ": Start streaming request to url="
+                      << request.GetUrl().GetUrlPath();
+    absl::StatusOr<HttpResponse> response =
+        InternalGetResponse(request, std::move(on_body_chunk));
+    if (!response.ok()) {
+      NEARBY_LOGS(ERROR) << __func__ << ": Failed to get response from url="
+                         << request.GetUrl().GetUrlPath() << ", status"
+                         << response.status();
+    }
+
+    if (callback) {
+      callback(response);
+    }
+    NEARBY_LOGS(INFO) << __func__ << ": Completed request to url="
+                      << request.GetUrl().GetUrlPath();
+  });
+}
+
 absl::StatusOr<HttpResponse> NearbyHttpClient::GetResponse(
     const HttpRequest& request) {
   NEARBY_LOGS(INFO) << __func__ << ": Start request to url="
@@ -158,6 +218,69 @@ absl::StatusOr<HttpResponse> NearbyHttpClient::GetResponse(
   return response;
 }
 
+void NearbyHttpClient::Enqueue(HttpRequestPriority priority,
+                               absl::AnyInvocable<void()> run,
+                               std::optional<std::string> get_key) {
+  QueueKey queue_key = MakeQueueKey(priority);
+  if (get_key.has_value()) {
+    pending_gets_[*get_key].queue_key = queue_key;
+  }
+  queue_.emplace(queue_key, QueuedRequest{.run = std::move(run),
+                                          .get_key = std::move(get_key)});
+  // Every task runs whichever request is first in the queue by then.
+  executor_.Execute([this]() { RunNext(); });
+}
+
+void NearbyHttpClient::RunNext() {
+  QueuedRequest request;
+  {
+    MutexLock lock(&mutex_);
+    if (queue_.empty()) return;
+    request = std::move(queue_.begin()->second);
+    queue_.erase(queue_.begin());
+    if (request.get_key.has_value()) {
+      auto it = pending_gets_.find(*request.get_key);
+      if (it != pending_gets_.end()) it->second.queue_key.reset();
+    }
+  }
+  request.run();
+}
+
+NearbyHttpClient::QueueKey NearbyHttpClient::MakeQueueKey(
+    HttpRequestPriority priority) {
+  return {-static_cast<int>(priority), next_sequence_number_++};
+}
+
+void NearbyHttpClient::OnGetResponse(
+    const std::string& key, const absl::StatusOr<HttpResponse>& response) {
+  std::vector<Callback> callbacks;
+  {
+    MutexLock lock(&mutex_);
+    auto it = pending_gets_.find(key);
+    if (it == pending_gets_.end()) return;
+    callbacks = std::move(it->second.callbacks);
+    pending_gets_.erase(it);
+  }
+  for (Callback& callback : callbacks) {
+    if (callback) {
+      callback(response);
+    }
+  }
+}
+
+std::string NearbyHttpClient::GetRequestKey(const HttpRequest& request) {
+  // Sorted, since the order of the headers doesn't matter.
+  std::map<std::string, std::vector<std::string>> headers(
+      request.GetAllHeaders().begin(), request.GetAllHeaders().end());
+  std::string key = absl::StrCat(request.GetUrl().GetUrlPath(), "\n");
+  for (const auto& header : headers) {
+    absl::StrAppend(&key, header.first, ": ", absl::StrJoin(header.second, ","),
+                    "\n");
+  }
+  absl::StrAppend(&key, "\n", request.GetBody().GetRawData());
+  return key;
+}
+
 void NearbyHttpClient::CleanThreads() {
   auto it = http_threads_.begin();
 
@@ -173,7 +296,7 @@ void NearbyHttpClient::CleanThreads() {
 }
 
 absl::StatusOr<HttpResponse> NearbyHttpClient::InternalGetResponse(
-    const HttpRequest& request) {
+    const HttpRequest& request, BodyChunkCallback on_body_chunk) {
   api::WebRequest web_request;
   web_request.url = request.GetUrl().GetUrlPath();
   web_request.method = absl::StrCat(request.GetMethodString());
@@ -183,6 +306,7 @@ absl::StatusOr<HttpResponse> NearbyHttpClient::InternalGetResponse(
     }
   }
   web_request.body = absl::StrCat(request.GetBody().GetRawData());
+  web_request.body_chunk_callback = on_body_chunk;
 
   if (debug::kRequestEnabled) {
     std::stringstream request_stream;
@@ -226,7 +350,13 @@ absl::StatusOr<HttpResponse> NearbyHttpClient::InternalGetResponse(
   for (const auto& header : web_response->headers) {
     response.AddHeader(header.first, header.second);
   }
-  response.SetBody(web_response->body);
+  if (on_body_chunk == nullptr) {
+    response.SetBody(web_response->body);
+  } else if (!web_response->body.empty() &&
+             !on_body_chunk(web_response->body)) {
+    // The platform couldn't stream, the body arrived in one piece.
+    return absl::CancelledError("Download stopped by the caller.");
+  }
 
   return response;
 }
@@ -15,23 +15,37 @@
 #ifndef THIRD_PARTY_NEARBY_INTERNAL_NETWORK_HTTP_CLIENT_IMPL_H_
 #define THIRD_PARTY_NEARBY_INTERNAL_NETWORK_HTTP_CLIENT_IMPL_H_
 
+#include <cstdint>
 #include <functional>
 #include <future>  // NOLINT
+#include <map>
 #include <memory>
+#include <optional>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
 #include "internal/network/http_client.h"
 #include "internal/network/http_request.h"
+#include "internal/platform/multi_thread_executor.h"
 #include "internal/platform/mutex.h"
-#include "internal/platform/single_thread_executor.h"
 
 namespace nearby {
 namespace network {
 
+// Runs up to |max_concurrent_requests| requests at a time, and queues the
+// others by priority (see HttpRequest::SetPriority()), oldest first. A GET
+// request that is identical to one in flight doesn't go out again, it gets the
+// response of the one in flight.
 class NearbyHttpClient : public HttpClient {
  public:
-  NearbyHttpClient() = default;
+  static constexpr int kMaxConcurrentRequests = 4;
+
+  explicit NearbyHttpClient(int max_concurrent_requests = kMaxConcurrentRequests)
+      : executor_(max_concurrent_requests) {}
   ~NearbyHttpClient() override = default;
 
   NearbyHttpClient(const NearbyHttpClient&) = default;
@@ -48,16 +62,59 @@ class NearbyHttpClient : public HttpClient {
       std::function<void(const absl::StatusOr<HttpResponse>&)> callback)
       override ABSL_LOCKS_EXCLUDED(mutex_);
 
+  // Streamed requests are never shared with identical GETs in flight, since
+  // each caller consumes its own body.
+  void StartStreamingRequest(
+      const HttpRequest& request, BodyChunkCallback on_body_chunk,
+      std::function<void(const absl::StatusOr<HttpResponse>&)> callback)
+      override ABSL_LOCKS_EXCLUDED(mutex_);
+
   // Gets HTTP response in synchronization mode.
   absl::StatusOr<HttpResponse> GetResponse(const HttpRequest& request) override;
 
  private:
+  using Callback = std::function<void(const absl::StatusOr<HttpResponse>&)>;
+  // Higher priority first, then older first.
+  using QueueKey = std::pair<int, int64_t>;
+
+  struct QueuedRequest {
+    absl::AnyInvocable<void()> run;
+    // The GetRequestKey() of a GET request.
+    std::optional<std::string> get_key;
+  };
+
+  struct PendingGet {
+    std::vector<Callback> callbacks;
+    // Set while the request waits in |queue_|.
+    std::optional<QueueKey> queue_key;
+  };
+
+  // Queues |run| with |priority|, and runs it when a thread frees up.
+  void Enqueue(HttpRequestPriority priority, absl::AnyInvocable<void()> run,
+               std::optional<std::string> get_key = std::nullopt)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Runs the first request of |queue_|.
+  void RunNext() ABSL_LOCKS_EXCLUDED(mutex_);
+  QueueKey MakeQueueKey(HttpRequestPriority priority)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   void CleanThreads() ABSL_SHARED_LOCKS_REQUIRED(mutex_);
+  // Calls the callbacks of the GET requests identical to |key|.
+  void OnGetResponse(const std::string& key,
+                     const absl::StatusOr<HttpResponse>& response)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  static std::string GetRequestKey(const HttpRequest& request);
+  // Streams the body to |on_body_chunk| if set.
   static absl::StatusOr<HttpResponse> InternalGetResponse(
-      const HttpRequest& request);
+      const HttpRequest& request, BodyChunkCallback on_body_chunk = nullptr);
 
   Mutex mutex_;
-  SingleThreadExecutor executor_;
+  // The callbacks of the GET requests in flight, by GetRequestKey().
+  absl::flat_hash_map<std::string, PendingGet> pending_gets_
+      ABSL_GUARDED_BY(mutex_);
+  std::map<QueueKey, QueuedRequest> queue_ ABSL_GUARDED_BY(mutex_);
+  int64_t next_sequence_number_ ABSL_GUARDED_BY(mutex_) = 0;
+  MultiThreadExecutor executor_;
   std::vector<std::future<void>> http_threads_ ABSL_GUARDED_BY(mutex_);
 };
 
@@ -14,10 +14,12 @@
 
 #include "internal/network/http_client_impl.h"
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "protobuf-matchers/protocol-buffer-matchers.h"
@@ -27,6 +29,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/synchronization/notification.h"
 #include "absl/time/time.h"
 #include "internal/network/http_client.h"
@@ -43,6 +46,9 @@ struct HttpTestContext {
   WebResponse web_response;
   absl::Status status;
   absl::Duration api_time;
+  std::atomic<int> request_count;
+  // Whether the body is handed to WebRequest::body_chunk_callback, if set.
+  bool can_stream;
 };
 
 HttpTestContext* GetContext() {
@@ -56,13 +62,24 @@ HttpTestContext* GetContext() {
 absl::StatusOr<WebResponse> ImplementationPlatform::SendRequest(
     const WebRequest& request) {
   GetContext()->web_request = request;
+  ++GetContext()->request_count;
   if (GetContext()->api_time != absl::ZeroDuration()) {
     absl::SleepFor(GetContext()->api_time);
   }
-  if (GetContext()->status.ok()) {
-    return GetContext()->web_response;
+  if (!GetContext()->status.ok()) {
+    return GetContext()->status;
   }
-  return GetContext()->status;
+  WebResponse response = GetContext()->web_response;
+  if (GetContext()->can_stream && request.body_chunk_callback) {
+    absl::string_view body = response.body;
+    for (size_t i = 0; i < body.size(); i += 4) {
+      if (!request.body_chunk_callback(body.substr(i, 4))) {
+        return absl::CancelledError("");
+      }
+    }
+    response.body.clear();
+  }
+  return response;
 }
 
 }  // namespace api
@@ -78,8 +95,12 @@ class NearbyHttpClientTest : public ::testing::Test {
     api::GetContext()->web_response = api::WebResponse();
     api::GetContext()->status = absl::Status();
     api::GetContext()->api_time = absl::ZeroDuration();
+    api::GetContext()->request_count = 0;
+    api::GetContext()->can_stream = false;
   }
 
+  void MockStreaming() { api::GetContext()->can_stream = true; }
+
   void MockFailedResponse(absl::Status status) {
     api::GetContext()->status = status;
   }
@@ -143,6 +164,33 @@ class NearbyHttpClientTest : public ::testing::Test {
     return result;
   }
 
+  // Streams the body into |chunks|, stopping after |max_chunks| of them.
+  absl::StatusOr<HttpResponse> GetStreamingResponseAsync(
+      absl::string_view url, std::vector<std::string>& chunks,
+      int max_chunks = 100) {
+    absl::StatusOr<HttpResponse> result;
+    absl::StatusOr<HttpRequest> request =
+        MakeHttpRequest(url, HttpRequestMethod::kGet, {}, "");
+    if (!request.ok()) {
+      return request.status();
+    }
+
+    absl::Notification notification;
+    client_.StartStreamingRequest(
+        *request,
+        [&chunks, max_chunks](absl::string_view chunk) {
+          chunks.push_back(std::string(chunk));
+          return chunks.size() < max_chunks;
+        },
+        [&result,
+         &notification](const absl::StatusOr<HttpResponse>& http_response) {
+          result = http_response;
+          notification.Notify();
+        });
+    notification.WaitForNotification();
+    return result;
+  }
+
   absl::StatusOr<HttpResponse> GetResponse(
       absl::string_view url, HttpRequestMethod method,
       const std::multimap<std::string, std::string>& headers,
@@ -230,6 +278,123 @@ TEST_F(NearbyHttpClientTest, TestGetWithErrorResult) {
   EXPECT_FALSE(result.ok());
 }
 
+TEST_F(NearbyHttpClientTest, TestStreamingGetAsync) {
+  MockStreaming();
+  MockResponse(HttpStatusCode::kHttpOk, "OK", {{"Content_Type", "image/png"}},
+               "web content");
+  std::vector<std::string> chunks;
+
+  auto result = GetStreamingResponseAsync("http://www.google.com", chunks);
+
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result->GetStatusCode(), HttpStatusCode::kHttpOk);
+  EXPECT_EQ(result->GetAllHeaders().at("Content_Type")[0], "image/png");
+  EXPECT_EQ(result->GetBody().GetRawData(), "");
+  EXPECT_THAT(chunks, ::testing::ElementsAre("web ", "cont", "ent"));
+}
+
+TEST_F(NearbyHttpClientTest, TestStreamingGetWithoutPlatformSupportAsync) {
+  MockResponse(HttpStatusCode::kHttpOk, "OK", {}, "web content");
+  std::vector<std::string> chunks;
+
+  auto result = GetStreamingResponseAsync("http://www.google.com", chunks);
+
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result->GetBody().GetRawData(), "");
+  EXPECT_THAT(chunks, ::testing::ElementsAre("web content"));
+}
+
+TEST_F(NearbyHttpClientTest, TestStopStreamingGetAsync) {
+  MockStreaming();
+  MockResponse(HttpStatusCode::kHttpOk, "OK", {}, "web content");
+  std::vector<std::string> chunks;
+
+  auto result = GetStreamingResponseAsync("http://www.google.com", chunks,
+                                          /*max_chunks=*/1);
+
+  EXPECT_TRUE(absl::IsCancelled(result.status()));
+  EXPECT_THAT(chunks, ::testing::ElementsAre("web "));
+}
+
+TEST_F(NearbyHttpClientTest, TestIdenticalGetsShareOneRequestAsync) {
+  MockResponse(HttpStatusCode::kHttpOk, "OK", {{"Content_Type", "text/html"}},
+               "web content");
+  api::GetContext()->api_time = absl::Milliseconds(300);
+  absl::StatusOr<HttpRequest> request =
+      MakeHttpRequest("http://www.google.com", HttpRequestMethod::kGet,
+                      {{"Content_Type", "text/html"}}, "");
+  ASSERT_TRUE(request.ok());
+  absl::Notification first_done;
+  absl::Notification second_done;
+  absl::StatusOr<HttpResponse> first;
+  absl::StatusOr<HttpResponse> second;
+
+  client().StartRequest(*request,
+                        [&](const absl::StatusOr<HttpResponse>& response) {
+                          first = response;
+                          first_done.Notify();
+                        });
+  client().StartRequest(*request,
+                        [&](const absl::StatusOr<HttpResponse>& response) {
+                          second = response;
+                          second_done.Notify();
+                        });
+
+  EXPECT_TRUE(first_done.WaitForNotificationWithTimeout(absl::Seconds(1)));
+  EXPECT_TRUE(second_done.WaitForNotificationWithTimeout(absl::Seconds(1)));
+  EXPECT_EQ(api::GetContext()->request_count, 1);
+  ASSERT_TRUE(first.ok());
+  ASSERT_TRUE(second.ok());
+  EXPECT_EQ(second->GetBody().GetRawData(), "web content");
+}
+
+TEST_F(NearbyHttpClientTest, TestRunsHigherPriorityFirstAsync) {
+  MockResponse(HttpStatusCode::kHttpOk, "OK", {}, "");
+  api::GetContext()->api_time = absl::Milliseconds(100);
+  NearbyHttpClient client(/*max_concurrent_requests=*/1);
+  absl::Mutex mutex;
+  std::vector<std::string> completed;
+  absl::Notification done;
+  auto start = [&](absl::string_view url, HttpRequestPriority priority) {
+    absl::StatusOr<HttpRequest> request =
+        MakeHttpRequest(url, HttpRequestMethod::kPost, {}, "");
+    ASSERT_TRUE(request.ok());
+    request->SetPriority(priority);
+    client.StartRequest(*request,
+                        [&, url = std::string(url)](
+                            const absl::StatusOr<HttpResponse>& response) {
+                          absl::MutexLock lock(&mutex);
+                          completed.push_back(url);
+                          if (completed.size() == 3) done.Notify();
+                        });
+  };
+
+  // The first request takes the only thread, the others wait in the queue.
+  start("http://www.google.com/first", HttpRequestPriority::kNormal);
+  absl::SleepFor(absl::Milliseconds(20));
+  start("http://www.google.com/low", HttpRequestPriority::kLow);
+  start("http://www.google.com/high", HttpRequestPriority::kHigh);
+
+  ASSERT_TRUE(done.WaitForNotificationWithTimeout(absl::Seconds(2)));
+  absl::MutexLock lock(&mutex);
+  EXPECT_EQ(completed,
+            (std::vector<std::string>{"http://www.google.com/first",
+                                      "http://www.google.com/high",
+                                      "http://www.google.com/low"}));
+}
+
+TEST_F(NearbyHttpClientTest, TestPostsAreNotSharedAsync) {
+  MockResponse(HttpStatusCode::kHttpNoContent, "OK", {}, "");
+  auto result = GetResponseAsync("http://www.google.com",
+                                 HttpRequestMethod::kPost, {}, "body");
+  ASSERT_TRUE(result.ok());
+  result = GetResponseAsync("http://www.google.com", HttpRequestMethod::kPost,
+                            {}, "body");
+  ASSERT_TRUE(result.ok());
+
+  EXPECT_EQ(api::GetContext()->request_count, 2);
+}
+
 TEST_F(NearbyHttpClientTest, TestPostAsync) {
   MockResponse(HttpStatusCode::kHttpNoContent, "OK",
                {{"Content_Type", "text/html"}}, "");
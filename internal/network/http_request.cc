@@ -37,6 +37,12 @@ void HttpRequest::SetMethod(const HttpRequestMethod& method) {
 
 const HttpRequestMethod& HttpRequest::GetMethod() const { return method_; }
 
+void HttpRequest::SetPriority(HttpRequestPriority priority) {
+  priority_ = priority;
+}
+
+HttpRequestPriority HttpRequest::GetPriority() const { return priority_; }
+
 absl::string_view HttpRequest::GetMethodString() const {
   switch (method_) {
     case HttpRequestMethod::kConnect:
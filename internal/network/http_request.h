@@ -39,6 +39,15 @@ enum class HttpRequestMethod {
   kPatch
 };
 
+// The order in which NearbyHttpClient sends the requests it has queued.
+enum class HttpRequestPriority {
+  // Background work, such as syncing data.
+  kLow,
+  kNormal,
+  // Requests the user is waiting for.
+  kHigh,
+};
+
 class HttpRequest {
  public:
   HttpRequest() = default;
@@ -57,6 +66,9 @@ class HttpRequest {
   const HttpRequestMethod& GetMethod() const;
   absl::string_view GetMethodString() const;
 
+  void SetPriority(HttpRequestPriority priority);
+  HttpRequestPriority GetPriority() const;
+
   void AddHeader(absl::string_view header, absl::string_view value);
   void RemoveHeader(absl::string_view header);
   const absl::flat_hash_map<std::string, std::vector<std::string>>&
@@ -77,6 +89,8 @@ class HttpRequest {
   // The request method: GET, POST, etc.
   HttpRequestMethod method_ = HttpRequestMethod::kGet;
 
+  HttpRequestPriority priority_ = HttpRequestPriority::kNormal;
+
   // The request headers, may include repeat keys
   absl::flat_hash_map<std::string, std::vector<std::string>> headers_;
 
@@ -46,6 +46,9 @@ TEST(HttpRequest, TestBuildRequest) {
   request.SetMethod(HttpRequestMethod::kPost);
   EXPECT_EQ(request.GetMethodString(), "POST");
   EXPECT_EQ(request.GetMethod(), HttpRequestMethod::kPost);
+  EXPECT_EQ(request.GetPriority(), HttpRequestPriority::kNormal);
+  request.SetPriority(HttpRequestPriority::kHigh);
+  EXPECT_EQ(request.GetPriority(), HttpRequestPriority::kHigh);
   request.RemoveQueryParameter("name");
   EXPECT_THAT(request.GetAllQueryParameters(), SizeIs(0));
   request.RemoveHeader("content-type");
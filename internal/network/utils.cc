@@ -15,11 +15,15 @@
 #include "internal/network/utils.h"
 
 #include <cctype>
+#include <fstream>
 #include <iomanip>
 #include <ios>
+#include <memory>
 #include <sstream>
 #include <string>
 
+#include "internal/network/http_client.h"
+
 namespace nearby {
 namespace network {
 
@@ -86,5 +90,19 @@ std::string UrlDecode(absl::string_view url_string) {
   return decoded_string_stream.str();
 }
 
+HttpClient::BodyChunkCallback WriteBodyToFile(absl::string_view path) {
+  auto file = std::make_shared<std::ofstream>(
+      std::string(path), std::ios::binary | std::ios::trunc);
+  if (!file->is_open()) {
+    return nullptr;
+  }
+  return [file](absl::string_view chunk) {
+    file->write(chunk.data(), chunk.size());
+    // Flushed right away, as the callback may outlive the download.
+    file->flush();
+    return file->good();
+  };
+}
+
 }  // namespace network
 }  // namespace nearby
@@ -18,6 +18,7 @@
 #include <string>
 
 #include "absl/strings/string_view.h"
+#include "internal/network/http_client.h"
 #include "internal/network/url.h"
 
 namespace nearby {
@@ -37,6 +38,13 @@ std::string UrlEncode(absl::string_view str);
 // @return     Decoded string.
 std::string UrlDecode(absl::string_view url_string);
 
+// Returns a body chunk callback writing the body of a streamed response to
+// the file at |path|, e.g. an image, without holding it in memory.
+//
+// @param path The file to create, or to truncate if it exists.
+// @return     The callback, or nullptr if the file can't be opened.
+HttpClient::BodyChunkCallback WriteBodyToFile(absl::string_view path);
+
 }  // namespace network
 }  // namespace nearby
 
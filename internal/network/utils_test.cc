@@ -14,9 +14,12 @@
 
 #include "internal/network/utils.h"
 
+#include <fstream>
+#include <sstream>
 #include <string>
 
 #include "gtest/gtest.h"
+#include "internal/network/http_client.h"
 
 namespace nearby {
 namespace network {
@@ -41,6 +44,25 @@ TEST(UrlDecode, TestDecodeMatch) {
             ")%5B%5D%5C%7C%C2%A9");
 }
 
+TEST(WriteBodyToFile, TestWritesChunks) {
+  std::string path = ::testing::TempDir() + "/body";
+  HttpClient::BodyChunkCallback callback = WriteBodyToFile(path);
+  ASSERT_NE(callback, nullptr);
+
+  EXPECT_TRUE(callback("web "));
+  EXPECT_TRUE(callback("content"));
+
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream content;
+  content << file.rdbuf();
+  EXPECT_EQ(content.str(), "web content");
+}
+
+TEST(WriteBodyToFile, TestFailsToOpenFile) {
+  EXPECT_EQ(WriteBodyToFile(::testing::TempDir() + "/missing/dir/body"),
+            nullptr);
+}
+
 }  // namespace
 }  // namespace network
 }  // namespace nearby
@@ -0,0 +1,50 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "internal/platform/async_stream.h"
+
+#include <cstdint>
+
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/future.h"
+
+namespace nearby {
+
+Future<ByteArray> BlockingInputStreamAdapter::ReadAsync(std::int64_t size) {
+  Future<ByteArray> future;
+  executor_->Execute([stream = stream_, size, future]() mutable {
+    SetFutureFrom(future, stream->Read(size));
+  });
+  return future;
+}
+
+Future<bool> BlockingOutputStreamAdapter::WriteAsync(const ByteArray& data) {
+  Future<bool> future;
+  executor_->Execute([stream = stream_, data, future]() mutable {
+    SetFutureFrom(future, stream->Write(data));
+  });
+  return future;
+}
+
+Future<bool> BlockingOutputStreamAdapter::FlushAsync() {
+  Future<bool> future;
+  executor_->Execute([stream = stream_, future]() mutable {
+    SetFutureFrom(future, stream->Flush());
+  });
+  return future;
+}
+
+}  // namespace nearby
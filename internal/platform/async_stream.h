@@ -0,0 +1,114 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef PLATFORM_PUBLIC_ASYNC_STREAM_H_
+#define PLATFORM_PUBLIC_ASYNC_STREAM_H_
+
+#include <cstdint>
+#include <utility>
+
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/future.h"
+#include "internal/platform/implementation/executor.h"
+#include "internal/platform/input_stream.h"
+#include "internal/platform/output_stream.h"
+
+namespace nearby {
+
+// Non-blocking counterpart of InputStream. Results come back through a
+// Future, whose listeners run on an executor of the caller's choice, so a
+// reader doesn't have to park a thread on every stream.
+class AsyncInputStream {
+ public:
+  virtual ~AsyncInputStream() = default;
+
+  // Reads at most `size` bytes. Resolves to an empty byte array on end of
+  // file, or fails with Exception::kIo on error.
+  virtual Future<ByteArray> ReadAsync(std::int64_t size) = 0;
+
+  // throws Exception::kIo
+  virtual Exception Close() = 0;
+};
+
+// Non-blocking counterpart of OutputStream.
+class AsyncOutputStream {
+ public:
+  virtual ~AsyncOutputStream() = default;
+
+  // Resolves to true once `data` is written, or fails with Exception::kIo.
+  virtual Future<bool> WriteAsync(const ByteArray& data) = 0;
+  // Resolves to true once the stream is flushed, or fails with Exception::kIo.
+  virtual Future<bool> FlushAsync() = 0;
+
+  // throws Exception::kIo
+  virtual Exception Close() = 0;
+};
+
+// Completes `future` with `result`, or with its exception.
+template <typename T>
+void SetFutureFrom(Future<T>& future, ExceptionOr<T> result) {
+  if (result.ok()) {
+    future.Set(std::move(result).result());
+  } else {
+    future.SetException(result.GetException());
+  }
+}
+
+// Completes `future` with true, or with `exception` if it was raised.
+inline void SetFutureFrom(Future<bool>& future, Exception exception) {
+  if (exception.Ok()) {
+    future.Set(true);
+  } else {
+    future.SetException(exception);
+  }
+}
+
+// Serves reads from a blocking InputStream by running them on `executor`.
+// Reads complete in order when the executor runs one task at a time. Both
+// the stream and the executor must outlive the pending reads.
+class BlockingInputStreamAdapter final : public AsyncInputStream {
+ public:
+  BlockingInputStreamAdapter(InputStream* stream, api::Executor* executor)
+      : stream_(stream), executor_(executor) {}
+
+  Future<ByteArray> ReadAsync(std::int64_t size) override;
+  Exception Close() override { return stream_->Close(); }
+
+ private:
+  InputStream* stream_;
+  api::Executor* executor_;
+};
+
+// Serves writes to a blocking OutputStream by running them on `executor`.
+// Writes complete in order when the executor runs one task at a time. Both
+// the stream and the executor must outlive the pending writes.
+class BlockingOutputStreamAdapter final : public AsyncOutputStream {
+ public:
+  BlockingOutputStreamAdapter(OutputStream* stream, api::Executor* executor)
+      : stream_(stream), executor_(executor) {}
+
+  Future<bool> WriteAsync(const ByteArray& data) override;
+  Future<bool> FlushAsync() override;
+  Exception Close() override { return stream_->Close(); }
+
+ private:
+  OutputStream* stream_;
+  api::Executor* executor_;
+};
+
+}  // namespace nearby
+
+#endif  // PLATFORM_PUBLIC_ASYNC_STREAM_H_
@@ -0,0 +1,114 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "internal/platform/async_stream.h"
+
+#include "gtest/gtest.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/future.h"
+#include "internal/platform/pipe.h"
+#include "internal/platform/single_thread_executor.h"
+
+namespace nearby {
+namespace {
+
+constexpr absl::Duration kTimeout = absl::Seconds(5);
+
+TEST(AsyncStreamTest, ReadAsyncDoesNotBlockTheCaller) {
+  Pipe pipe;
+  SingleThreadExecutor executor;
+  BlockingInputStreamAdapter input(&pipe.GetInputStream(), &executor);
+
+  Future<ByteArray> read = input.ReadAsync(16);
+  EXPECT_FALSE(read.IsSet());
+  EXPECT_TRUE(pipe.GetOutputStream().Write(ByteArray("data")).Ok());
+
+  ExceptionOr<ByteArray> result = read.Get(kTimeout);
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result.result(), ByteArray("data"));
+}
+
+TEST(AsyncStreamTest, ReadsCompleteInOrder) {
+  Pipe pipe;
+  SingleThreadExecutor executor;
+  BlockingInputStreamAdapter input(&pipe.GetInputStream(), &executor);
+
+  Future<ByteArray> first = input.ReadAsync(3);
+  Future<ByteArray> second = input.ReadAsync(3);
+  EXPECT_TRUE(pipe.GetOutputStream().Write(ByteArray("abcdef")).Ok());
+
+  EXPECT_EQ(first.Get(kTimeout).result(), ByteArray("abc"));
+  EXPECT_EQ(second.Get(kTimeout).result(), ByteArray("def"));
+}
+
+TEST(AsyncStreamTest, ReadAsyncNotifiesListener) {
+  Pipe pipe;
+  SingleThreadExecutor io_executor;
+  SingleThreadExecutor listener_executor;
+  BlockingInputStreamAdapter input(&pipe.GetInputStream(), &io_executor);
+  absl::Notification notification;
+  ByteArray received;
+
+  input.ReadAsync(16).AddListener(
+      [&](ExceptionOr<ByteArray> result) {
+        received = result.result();
+        notification.Notify();
+      },
+      &listener_executor);
+  EXPECT_TRUE(pipe.GetOutputStream().Write(ByteArray("data")).Ok());
+
+  ASSERT_TRUE(notification.WaitForNotificationWithTimeout(kTimeout));
+  EXPECT_EQ(received, ByteArray("data"));
+}
+
+TEST(AsyncStreamTest, ReadAsyncReportsEndOfStream) {
+  Pipe pipe;
+  SingleThreadExecutor executor;
+  BlockingInputStreamAdapter input(&pipe.GetInputStream(), &executor);
+
+  EXPECT_TRUE(pipe.GetOutputStream().Close().Ok());
+
+  ExceptionOr<ByteArray> result = input.ReadAsync(16).Get(kTimeout);
+  ASSERT_TRUE(result.ok());
+  EXPECT_TRUE(result.result().Empty());
+}
+
+TEST(AsyncStreamTest, WriteAsyncWritesToStream) {
+  Pipe pipe;
+  SingleThreadExecutor executor;
+  BlockingOutputStreamAdapter output(&pipe.GetOutputStream(), &executor);
+
+  EXPECT_TRUE(output.WriteAsync(ByteArray("data")).Get(kTimeout).ok());
+  EXPECT_TRUE(output.FlushAsync().Get(kTimeout).ok());
+
+  EXPECT_EQ(pipe.GetInputStream().Read(16).result(), ByteArray("data"));
+}
+
+TEST(AsyncStreamTest, WriteAsyncFailsOnClosedStream) {
+  Pipe pipe;
+  SingleThreadExecutor executor;
+  BlockingOutputStreamAdapter output(&pipe.GetOutputStream(), &executor);
+
+  EXPECT_TRUE(output.Close().Ok());
+
+  ExceptionOr<bool> result = output.WriteAsync(ByteArray("data")).Get(kTimeout);
+  EXPECT_TRUE(result.GetException().Raised(Exception::kIo));
+}
+
+}  // namespace
+}  // namespace nearby
@@ -15,6 +15,7 @@
 #ifndef PLATFORM_PUBLIC_ATOMIC_BOOLEAN_H_
 #define PLATFORM_PUBLIC_ATOMIC_BOOLEAN_H_
 
+#include <atomic>
 #include <memory>
 
 #include "internal/platform/implementation/atomic_boolean.h"
@@ -25,6 +26,29 @@ namespace nearby {
 // A boolean value that may be updated atomically.
 // See documentation in
 // cpp/platform/api/atomic_boolean.h
+//
+// Where std::atomic<bool> is lock-free, the value is kept inline, so that Get()
+// and Set() are inlined rather than virtual calls to a platform object.
+#if ATOMIC_BOOL_LOCK_FREE == 2
+class AtomicBoolean final : public api::AtomicBoolean {
+ public:
+  explicit AtomicBoolean(bool value = false) : value_(value) {}
+  ~AtomicBoolean() override = default;
+  AtomicBoolean(AtomicBoolean&& other) : value_(other.Get()) {}
+  AtomicBoolean& operator=(AtomicBoolean&& other) {
+    Set(other.Get());
+    return *this;
+  }
+
+  bool Get() const override { return value_.load(); }
+  bool Set(bool value) override { return value_.exchange(value); }
+
+  explicit operator bool() const { return Get(); }
+
+ private:
+  std::atomic<bool> value_;
+};
+#else
 class AtomicBoolean final : public api::AtomicBoolean {
  public:
   using Platform = api::ImplementationPlatform;
@@ -42,6 +66,7 @@ class AtomicBoolean final : public api::AtomicBoolean {
  private:
   std::unique_ptr<api::AtomicBoolean> impl_;
 };
+#endif  // ATOMIC_BOOL_LOCK_FREE == 2
 
 }  // namespace nearby
 
@@ -15,8 +15,11 @@
 #ifndef PLATFORM_PUBLIC_ATOMIC_REFERENCE_H_
 #define PLATFORM_PUBLIC_ATOMIC_REFERENCE_H_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <type_traits>
+#include <utility>
 
 #include "internal/platform/implementation/atomic_reference.h"
 #include "internal/platform/implementation/platform.h"
@@ -29,6 +32,29 @@ namespace nearby {
 template <typename, typename = void>
 class AtomicReference;
 
+#if ATOMIC_INT_LOCK_FREE == 2
+// Lock-free atomic type, for something convertible to std::uint32_t. Kept
+// inline, so that Get() and Set() compile down to plain atomic instructions.
+template <typename T>
+class AtomicReference<T, std::enable_if_t<sizeof(T) <= sizeof(std::uint32_t) &&
+                                          std::is_trivially_copyable<T>::value>>
+    final {
+ public:
+  explicit AtomicReference(T value) : value_(value) {}
+  ~AtomicReference() = default;
+  AtomicReference(AtomicReference&& other) : value_(other.Get()) {}
+  AtomicReference& operator=(AtomicReference&& other) {
+    Set(other.Get());
+    return *this;
+  }
+
+  T Get() const { return value_.load(); }
+  void Set(T value) { value_.store(value); }
+
+ private:
+  std::atomic<T> value_;
+};
+#else
 // Platform-based atomic type, for something convertible to std::uint32_t.
 template <typename T>
 class AtomicReference<T, std::enable_if_t<sizeof(T) <= sizeof(std::uint32_t) &&
@@ -49,6 +75,7 @@ class AtomicReference<T, std::enable_if_t<sizeof(T) <= sizeof(std::uint32_t) &&
  private:
   std::unique_ptr<api::AtomicUint32> impl_;
 };
+#endif  // ATOMIC_INT_LOCK_FREE == 2
 
 // Atomic type that is using Platform mutex to provide atomicity.
 // Supports any copyable type.
@@ -80,6 +107,28 @@ class AtomicReference<T,
   T value_;
 };
 
+// A value of any type that is read much more often than it is updated.
+// Set() publishes a new immutable copy, and Get() hands out the current copy
+// without locking or copying the value; readers keep the copy they got alive
+// and unchanged for as long as they hold it, however many Set()s follow.
+template <typename T>
+class AtomicSharedReference final {
+ public:
+  explicit AtomicSharedReference(T value)
+      : value_(std::make_shared<const T>(std::move(value))) {}
+  AtomicSharedReference(const AtomicSharedReference&) = delete;
+  AtomicSharedReference& operator=(const AtomicSharedReference&) = delete;
+  ~AtomicSharedReference() = default;
+
+  std::shared_ptr<const T> Get() const { return std::atomic_load(&value_); }
+  void Set(T value) {
+    std::atomic_store(&value_, std::make_shared<const T>(std::move(value)));
+  }
+
+ private:
+  std::shared_ptr<const T> value_;
+};
+
 }  // namespace nearby
 
 #endif  // PLATFORM_PUBLIC_ATOMIC_REFERENCE_H_
@@ -14,6 +14,10 @@
 
 #include "internal/platform/atomic_reference.h"
 
+#include <memory>
+#include <string>
+#include <utility>
+
 #include "gtest/gtest.h"
 
 namespace nearby {
@@ -84,4 +88,29 @@ TEST(AtomicReferenceTest, SupportObjects) {
   EXPECT_EQ(s, atomic_ref.Get());
 }
 
+TEST(AtomicReferenceTest, SupportsMove) {
+  AtomicReference<int> atomic_ref(5);
+  AtomicReference<int> moved_ref(std::move(atomic_ref));
+  EXPECT_EQ(moved_ref.Get(), 5);
+}
+
+TEST(AtomicSharedReferenceTest, GetReturnsWhatWasSet) {
+  AtomicSharedReference<std::string> atomic_ref("test");
+  EXPECT_EQ(*atomic_ref.Get(), "test");
+  atomic_ref.Set("other");
+  EXPECT_EQ(*atomic_ref.Get(), "other");
+}
+
+TEST(AtomicSharedReferenceTest, SetDoesNotChangeValueInUse) {
+  BigSizedStruct v1;
+  v1.data[0] = 5;
+  AtomicSharedReference<BigSizedStruct> atomic_ref(v1);
+  std::shared_ptr<const BigSizedStruct> in_use = atomic_ref.Get();
+  BigSizedStruct v2;
+  v2.data[0] = 6;
+  atomic_ref.Set(v2);
+  EXPECT_EQ(*in_use, v1);
+  EXPECT_EQ(*atomic_ref.Get(), v2);
+}
+
 }  // namespace nearby
@@ -14,26 +14,143 @@
 
 #include "internal/platform/base64_utils.h"
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <utility>
+
 #include "absl/strings/escaping.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "internal/platform/byte_array.h"
 
 namespace nearby {
 
-std::string Base64Utils::Encode(const ByteArray& bytes) {
-  std::string base64_string;
+namespace {
+
+constexpr char kAlphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+constexpr std::uint8_t kInvalid = 0xFF;
+
+constexpr std::array<std::uint8_t, 256> MakeDecodeTable() {
+  std::array<std::uint8_t, 256> table = {};
+  for (auto& value : table) value = kInvalid;
+  for (std::uint8_t i = 0; i < 64; ++i) {
+    table[static_cast<unsigned char>(kAlphabet[i])] = i;
+  }
+  return table;
+}
+
+constexpr std::array<std::uint8_t, 256> kDecodeTable = MakeDecodeTable();
 
-  absl::WebSafeBase64Escape(std::string(bytes), &base64_string);
+size_t GetEncodedSize(size_t size) {
+  return size / 3 * 4 + (size % 3 == 0 ? 0 : size % 3 + 1);
+}
+
+// Decodes a group of 4 characters at a time. Only takes the canonical
+// encoding of its output, so anything it rejects is left to absl, which
+// decides whether it's valid after all, e.g. with whitespace.
+bool DecodeCanonical(absl::string_view base64_string, char* output,
+                     size_t* decoded_size) {
+  if (!base64_string.empty() && base64_string.back() == '=') {
+    if (base64_string.size() % 4 != 0) return false;
+    base64_string.remove_suffix(1);
+    if (base64_string.back() == '=') base64_string.remove_suffix(1);
+  }
+  if (base64_string.size() % 4 == 1) return false;
+
+  const auto* in = reinterpret_cast<const unsigned char*>(base64_string.data());
+  size_t size = base64_string.size();
+  auto* out = reinterpret_cast<unsigned char*>(output);
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    std::uint8_t a = kDecodeTable[in[i]];
+    std::uint8_t b = kDecodeTable[in[i + 1]];
+    std::uint8_t c = kDecodeTable[in[i + 2]];
+    std::uint8_t d = kDecodeTable[in[i + 3]];
+    // kInvalid has the bits above the 6 of a valid character set.
+    if (((a | b | c | d) & 0xC0) != 0) return false;
+    std::uint32_t group = (a << 18) | (b << 12) | (c << 6) | d;
+    *out++ = group >> 16;
+    *out++ = group >> 8;
+    *out++ = group;
+  }
+  if (i < size) {
+    std::uint8_t a = kDecodeTable[in[i]];
+    std::uint8_t b = kDecodeTable[in[i + 1]];
+    std::uint8_t c = i + 2 < size ? kDecodeTable[in[i + 2]] : 0;
+    if (((a | b | c) & 0xC0) != 0) return false;
+    std::uint32_t group = (a << 18) | (b << 12) | (c << 6);
+    // Bits past the last byte must be zero in the canonical encoding.
+    if (i + 2 < size ? (group & 0xFF) != 0 : (group & 0xFFFF) != 0) {
+      return false;
+    }
+    *out++ = group >> 16;
+    if (i + 2 < size) *out++ = group >> 8;
+  }
+  *decoded_size = out - reinterpret_cast<unsigned char*>(output);
+  return true;
+}
 
+}  // namespace
+
+std::string Base64Utils::Encode(const ByteArray& bytes) {
+  return Encode(bytes.AsStringView());
+}
+
+std::string Base64Utils::Encode(absl::string_view bytes) {
+  std::string base64_string(GetEncodedSize(bytes.size()), '\0');
+  const auto* in = reinterpret_cast<const unsigned char*>(bytes.data());
+  size_t size = bytes.size();
+  char* out = base64_string.data();
+  size_t i = 0;
+  for (; i + 3 <= size; i += 3) {
+    std::uint32_t group = (in[i] << 16) | (in[i + 1] << 8) | in[i + 2];
+    *out++ = kAlphabet[group >> 18];
+    *out++ = kAlphabet[(group >> 12) & 0x3F];
+    *out++ = kAlphabet[(group >> 6) & 0x3F];
+    *out++ = kAlphabet[group & 0x3F];
+  }
+  if (i < size) {
+    std::uint32_t group = (in[i] << 16) | (i + 1 < size ? in[i + 1] << 8 : 0);
+    *out++ = kAlphabet[group >> 18];
+    *out++ = kAlphabet[(group >> 12) & 0x3F];
+    if (i + 1 < size) *out++ = kAlphabet[(group >> 6) & 0x3F];
+  }
   return base64_string;
 }
 
 ByteArray Base64Utils::Decode(absl::string_view base64_string) {
-  std::string decoded_string;
-  if (!absl::WebSafeBase64Unescape(base64_string, &decoded_string)) {
+  std::string decoded_string(GetMaxDecodedSize(base64_string.size()), '\0');
+  std::optional<size_t> size = DecodeInto(
+      base64_string, absl::MakeSpan(decoded_string.data(),
+                                    decoded_string.size()));
+  if (!size.has_value()) {
     return ByteArray();
   }
 
-  return ByteArray(decoded_string.data(), decoded_string.size());
+  decoded_string.resize(*size);
+  return ByteArray(std::move(decoded_string));
+}
+
+std::optional<size_t> Base64Utils::DecodeInto(absl::string_view base64_string,
+                                              absl::Span<char> output) {
+  size_t size;
+  if (output.size() >= GetMaxDecodedSize(base64_string.size()) &&
+      DecodeCanonical(base64_string, output.data(), &size)) {
+    return size;
+  }
+
+  std::string decoded_string;
+  if (!absl::WebSafeBase64Unescape(base64_string, &decoded_string) ||
+      decoded_string.size() > output.size()) {
+    return std::nullopt;
+  }
+  memcpy(output.data(), decoded_string.data(), decoded_string.size());
+  return decoded_string.size();
 }
 
 }  // namespace nearby
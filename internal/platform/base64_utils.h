@@ -15,15 +15,33 @@
 #ifndef PLATFORM_BASE_BASE64_UTILS_H_
 #define PLATFORM_BASE_BASE64_UTILS_H_
 
+#include <cstddef>
+#include <optional>
+#include <string>
+
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "internal/platform/byte_array.h"
 
 namespace nearby {
 
+// Encodes and decodes the URL and filename safe Base64 alphabet of RFC 4648,
+// without padding. Decoding also accepts padding.
 class Base64Utils {
  public:
   static std::string Encode(const ByteArray& bytes);
+  static std::string Encode(absl::string_view bytes);
   static ByteArray Decode(absl::string_view base64_string);
+
+  // Decodes |base64_string| into the start of |output|, without allocating if
+  // it's canonically encoded. Returns the decoded size, or nullopt if
+  // |base64_string| isn't valid Base64 or |output| is too small.
+  // GetMaxDecodedSize() is always large enough.
+  static std::optional<size_t> DecodeInto(absl::string_view base64_string,
+                                          absl::Span<char> output);
+  static size_t GetMaxDecodedSize(size_t base64_size) {
+    return (base64_size + 3) / 4 * 3;
+  }
 };
 
 }  // namespace nearby
@@ -0,0 +1,82 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/base64_utils.h"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/strings/escaping.h"
+#include "absl/types/span.h"
+#include "internal/platform/byte_array.h"
+
+namespace nearby {
+namespace {
+
+TEST(Base64UtilsTest, EncodesLikeAbsl) {
+  std::string bytes;
+  for (int size = 0; size < 64; ++size) {
+    std::string expected;
+    absl::WebSafeBase64Escape(bytes, &expected);
+
+    EXPECT_EQ(Base64Utils::Encode(ByteArray(bytes)), expected);
+    EXPECT_EQ(Base64Utils::Decode(expected), ByteArray(bytes));
+
+    bytes.push_back(static_cast<char>(size * 37 + 200));
+  }
+}
+
+TEST(Base64UtilsTest, DecodesPadding) {
+  EXPECT_EQ(Base64Utils::Decode("_w=="), ByteArray("\xFF"));
+  EXPECT_EQ(Base64Utils::Decode("_-8="), ByteArray("\xFF\xEF"));
+  EXPECT_EQ(Base64Utils::Decode("_w"), ByteArray("\xFF"));
+}
+
+TEST(Base64UtilsTest, RejectsInvalid) {
+  EXPECT_TRUE(Base64Utils::Decode("a").Empty());
+  EXPECT_TRUE(Base64Utils::Decode("ab$d").Empty());
+  // Not the URL safe alphabet.
+  EXPECT_TRUE(Base64Utils::Decode("+/==").Empty());
+}
+
+TEST(Base64UtilsTest, DecodesNonCanonicalLikeAbsl) {
+  for (absl::string_view base64_string : {"_x", "ab cd", "YQ=", "Y Q=="}) {
+    std::string expected;
+    if (absl::WebSafeBase64Unescape(base64_string, &expected)) {
+      EXPECT_EQ(Base64Utils::Decode(base64_string), ByteArray(expected))
+          << base64_string;
+    } else {
+      EXPECT_TRUE(Base64Utils::Decode(base64_string).Empty()) << base64_string;
+    }
+  }
+}
+
+TEST(Base64UtilsTest, DecodesIntoBuffer) {
+  char buffer[8];
+
+  std::optional<size_t> size =
+      Base64Utils::DecodeInto("aGVsbG8", absl::MakeSpan(buffer));
+
+  ASSERT_TRUE(size.has_value());
+  EXPECT_EQ(std::string(buffer, *size), "hello");
+  EXPECT_FALSE(
+      Base64Utils::DecodeInto("aGVsbG8", absl::MakeSpan(buffer, 4)).has_value());
+  EXPECT_FALSE(
+      Base64Utils::DecodeInto("a$", absl::MakeSpan(buffer)).has_value());
+}
+
+}  // namespace
+}  // namespace nearby
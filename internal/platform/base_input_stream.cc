@@ -49,7 +49,7 @@ std::uint16_t BaseInputStream::ReadUint16() {
   }
 
   // Convert from network order.
-  const char *data = read_bytes.data();
+  const auto *data = reinterpret_cast<const uint8_t *>(read_bytes.data());
   return static_cast<uint16_t>(data[0]) << 8 | static_cast<uint16_t>(data[1]);
 }
 
@@ -61,7 +61,7 @@ std::uint32_t BaseInputStream::ReadUint32() {
   }
 
   // Convert from network order.
-  const char *data = read_bytes.data();
+  const auto *data = reinterpret_cast<const uint8_t *>(read_bytes.data());
   return static_cast<uint32_t>(data[0]) << 24 |
          static_cast<uint32_t>(data[1]) << 16 |
          static_cast<uint32_t>(data[2]) << 8 | static_cast<uint32_t>(data[3]);
@@ -75,7 +75,7 @@ std::uint64_t BaseInputStream::ReadUint64() {
   }
 
   // Convert from network order.
-  const char *data = read_bytes.data();
+  const auto *data = reinterpret_cast<const uint8_t *>(read_bytes.data());
   return static_cast<uint64_t>(data[0]) << 56 |
          static_cast<uint64_t>(data[1]) << 48 |
          static_cast<uint64_t>(data[2]) << 40 |
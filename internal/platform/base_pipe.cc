@@ -14,13 +14,22 @@
 
 #include "internal/platform/base_pipe.h"
 
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
 #include "internal/platform/base_mutex_lock.h"
+#include "internal/platform/byte_slice.h"
 #include "internal/platform/input_stream.h"
 #include "internal/platform/output_stream.h"
 
 namespace nearby {
 
 ExceptionOr<ByteArray> BasePipe::Read(size_t size) {
+  if (!ring_.empty()) {
+    return RingRead(size);
+  }
+
   BaseMutexLock lock(mutex_.get());
 
   // We're done reading all the chunks that were written before the OutputStream
@@ -46,32 +55,43 @@ ExceptionOr<ByteArray> BasePipe::Read(size_t size) {
     return ExceptionOr<ByteArray>{ByteArray{}};
   }
 
-  ByteArray first_chunk{buffer_.front()};
-  buffer_.pop_front();
+  ByteSlice& first_chunk = buffer_.front();
 
   // If first_chunk is small enough to not overshoot the requested 'size', just
-  // return that.
+  // return that. This moves the bytes out of the pipe without a copy, unless a
+  // previous partial read left first_chunk sharing its storage.
   if (first_chunk.size() <= size) {
-    return ExceptionOr<ByteArray>{first_chunk};
+    ByteArray next_chunk = std::move(first_chunk).ToByteArray();
+    buffer_.pop_front();
+    return ExceptionOr<ByteArray>{std::move(next_chunk)};
   } else {
     // Break first_chunk into 2 parts -- the first one of which (next_chunk)
     // will be 'size' bytes long, and will be returned, and the second one of
-    // which (overflow_chunk) will be re-inserted into buffer_, at the head of
-    // the queue, to be served up in the next call to read().
-    ByteArray next_chunk(first_chunk.data(), size);
-    buffer_.push_front(
-        ByteArray(first_chunk.data() + size, first_chunk.size() - size));
-    return ExceptionOr<ByteArray>{next_chunk};
+    // which will stay at the head of buffer_, to be served up in the next call
+    // to read(). Only the returned part is copied; the remainder keeps
+    // referring to the original storage.
+    ByteArray next_chunk = first_chunk.Subslice(0, size).ToByteArray();
+    first_chunk = first_chunk.Subslice(size);
+    return ExceptionOr<ByteArray>{std::move(next_chunk)};
   }
 }
 
 Exception BasePipe::Write(const ByteArray& data) {
+  if (!ring_.empty()) {
+    return RingWrite(data);
+  }
+
   BaseMutexLock lock(mutex_.get());
 
   return WriteLocked(data);
 }
 
 void BasePipe::MarkInputStreamClosed() {
+  if (!ring_.empty()) {
+    RingMarkClosed(ring_input_closed_);
+    return;
+  }
+
   BaseMutexLock lock(mutex_.get());
 
   input_stream_closed_ = true;
@@ -81,6 +101,11 @@ void BasePipe::MarkInputStreamClosed() {
 }
 
 void BasePipe::MarkOutputStreamClosed() {
+  if (!ring_.empty()) {
+    RingMarkClosed(ring_output_closed_);
+    return;
+  }
+
   BaseMutexLock lock(mutex_.get());
 
   // Write a sentinel null chunk before marking output_stream_closed as true.
@@ -93,11 +118,107 @@ Exception BasePipe::WriteLocked(const ByteArray& data) {
     return {Exception::kIo};
   }
 
-  buffer_.push_back(data);
+  buffer_.push_back(ByteSlice(data));
   // Trigger cond_ to unblock a potentially-blocked call to read(), now that
   // there's more data for it to consume.
   cond_->Notify();
   return {Exception::kSuccess};
 }
 
+// The bounded pipe never takes mutex_ while chunks flow without waiting. A side
+// that has to wait sets its waiting flag and re-checks the ring under mutex_
+// before sleeping; the other side updates the ring and then checks that flag.
+// All the atomics involved are sequentially consistent, so either the waiter
+// sees the update or the updater sees the flag and notifies under mutex_.
+template <typename Ready>
+Exception BasePipe::WaitUntil(std::atomic<bool>& waiting, Ready ready) {
+  if (ready()) {
+    return {Exception::kSuccess};
+  }
+
+  BaseMutexLock lock(mutex_.get());
+  waiting = true;
+  while (!ready()) {
+    Exception wait_exception = cond_->Wait();
+
+    if (wait_exception.Raised()) {
+      waiting = false;
+      return wait_exception;
+    }
+  }
+  waiting = false;
+  return {Exception::kSuccess};
+}
+
+void BasePipe::WakeUp(const std::atomic<bool>& waiting) {
+  if (waiting) {
+    BaseMutexLock lock(mutex_.get());
+    cond_->Notify();
+  }
+}
+
+ExceptionOr<ByteArray> BasePipe::RingRead(size_t size) {
+  if (ring_read_all_chunks_) {
+    return ExceptionOr<ByteArray>{ByteArray{}};
+  }
+
+  const size_t head = ring_head_.load(std::memory_order_relaxed);
+  Exception wait_exception = WaitUntil(ring_reader_waiting_, [this, head]() {
+    return ring_tail_ != head || ring_input_closed_ || ring_output_closed_;
+  });
+  if (wait_exception.Raised()) {
+    return ExceptionOr<ByteArray>{wait_exception};
+  }
+
+  // The writer publishes its last chunk before marking the pipe closed, so an
+  // empty ring here means there is nothing left to read. An empty chunk
+  // written explicitly ends the stream as well, like in the unbounded pipe.
+  if (ring_tail_ == head || ring_[head % ring_.size()].Empty()) {
+    ring_read_all_chunks_ = true;
+    return ExceptionOr<ByteArray>{ByteArray{}};
+  }
+
+  ByteSlice& first_chunk = ring_[head % ring_.size()];
+
+  if (first_chunk.size() > size) {
+    ByteArray next_chunk = first_chunk.Subslice(0, size).ToByteArray();
+    first_chunk = first_chunk.Subslice(size);
+    return ExceptionOr<ByteArray>{std::move(next_chunk)};
+  }
+
+  ByteArray next_chunk = std::move(first_chunk).ToByteArray();
+  first_chunk = ByteSlice();
+  // Hand the slot back to the writer, which may be waiting for it.
+  ring_head_ = head + 1;
+  WakeUp(ring_writer_waiting_);
+  return ExceptionOr<ByteArray>{std::move(next_chunk)};
+}
+
+Exception BasePipe::RingWrite(const ByteArray& data) {
+  const size_t tail = ring_tail_.load(std::memory_order_relaxed);
+  Exception wait_exception = WaitUntil(ring_writer_waiting_, [this, tail]() {
+    return tail - ring_head_ < ring_.size() || ring_input_closed_ ||
+           ring_output_closed_;
+  });
+  if (wait_exception.Raised()) {
+    return wait_exception;
+  }
+  if (ring_input_closed_ || ring_output_closed_) {
+    return {Exception::kIo};
+  }
+
+  ring_[tail % ring_.size()] = ByteSlice(data);
+  ring_tail_ = tail + 1;
+  WakeUp(ring_reader_waiting_);
+  return {Exception::kSuccess};
+}
+
+void BasePipe::RingMarkClosed(std::atomic<bool>& closed) {
+  closed = true;
+  // Either side may be parked: the reader waiting for data, or the writer
+  // waiting for room, which it will never get once the reader is gone.
+  BaseMutexLock lock(mutex_.get());
+  cond_->Notify();
+}
+
 }  // namespace nearby
@@ -15,14 +15,18 @@
 #ifndef PLATFORM_BASE_BASE_PIPE_H_
 #define PLATFORM_BASE_BASE_PIPE_H_
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <deque>
 #include <memory>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "internal/platform/implementation/condition_variable.h"
 #include "internal/platform/implementation/mutex.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/byte_slice.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/input_stream.h"
 #include "internal/platform/output_stream.h"
@@ -45,6 +49,11 @@ namespace nearby {
 //   DerivedPipe(DerivedPipe&&) = default;
 //   DerivedPipe& operator=(DerivedPipe&&) = default;
 // };
+//
+// By default the pipe buffers an unbounded number of chunks. A derived class
+// may instead pass a ring capacity to Setup(), which bounds the pipe to that
+// many chunks and makes Write() block while the pipe is full. Such a pipe
+// must have at most one reader and one writer thread at a time.
 class BasePipe {
  public:
   static constexpr const size_t kChunkSize = 64 * 1024;
@@ -70,6 +79,16 @@ class BasePipe {
     cond_ = std::move(cond);
   }
 
+  // Sets up a bounded pipe holding up to `ring_capacity` chunks in a lock-free
+  // single-producer/single-consumer ring. `mutex` and `cond` are only used to
+  // park the reader while the ring is empty, or the writer while it is full.
+  void Setup(std::unique_ptr<api::Mutex> mutex,
+             std::unique_ptr<api::ConditionVariable> cond,
+             size_t ring_capacity) {
+    Setup(std::move(mutex), std::move(cond));
+    ring_.resize(ring_capacity > 0 ? ring_capacity : 1);
+  }
+
  private:
   class BasePipeInputStream : public InputStream {
    public:
@@ -116,6 +135,18 @@ class BasePipe {
   Exception WriteLocked(const ByteArray& data)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Bounded counterparts of the methods above, used when ring_ is not empty.
+  ExceptionOr<ByteArray> RingRead(size_t size) ABSL_LOCKS_EXCLUDED(mutex_);
+  Exception RingWrite(const ByteArray& data) ABSL_LOCKS_EXCLUDED(mutex_);
+  void RingMarkClosed(std::atomic<bool>& closed) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Blocks until `ready` returns true, with `waiting` set so that the other
+  // side knows to wake us up through WakeUp().
+  template <typename Ready>
+  Exception WaitUntil(std::atomic<bool>& waiting, Ready ready)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  void WakeUp(const std::atomic<bool>& waiting) ABSL_LOCKS_EXCLUDED(mutex_);
+
   // Order of declaration matters:
   // - mutex must be defined before condvar;
   // - input & output streams must be after both mutex and condvar.
@@ -123,7 +154,21 @@ class BasePipe {
   bool output_stream_closed_ ABSL_GUARDED_BY(mutex_) = false;
   bool read_all_chunks_ ABSL_GUARDED_BY(mutex_) = false;
 
-  std::deque<ByteArray> ABSL_GUARDED_BY(mutex_) buffer_;
+  std::deque<ByteSlice> ABSL_GUARDED_BY(mutex_) buffer_;
+
+  // Slots of the bounded pipe. ring_head_ and ring_tail_ count the chunks
+  // read and written so far; only the reader advances ring_head_ and only the
+  // writer advances ring_tail_, so neither needs mutex_.
+  std::vector<ByteSlice> ring_;
+  std::atomic<size_t> ring_head_{0};
+  std::atomic<size_t> ring_tail_{0};
+  std::atomic<bool> ring_input_closed_{false};
+  std::atomic<bool> ring_output_closed_{false};
+  std::atomic<bool> ring_reader_waiting_{false};
+  std::atomic<bool> ring_writer_waiting_{false};
+  // Only accessed by the reader.
+  bool ring_read_all_chunks_ = false;
+
   std::unique_ptr<api::Mutex> mutex_;
   std::unique_ptr<api::ConditionVariable> cond_;
 
@@ -0,0 +1,165 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "internal/platform/ble_scan_arbiter.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "internal/platform/implementation/ble_v2.h"
+#include "internal/platform/logging.h"
+#include "internal/platform/mutex_lock.h"
+#include "internal/platform/uuid.h"
+
+namespace nearby {
+
+using ::nearby::api::ble_v2::BleAdvertisementData;
+using ::nearby::api::ble_v2::TxPowerLevel;
+
+BleScanArbiter::~BleScanArbiter() {
+  MutexLock lock(&mutex_);
+  for (auto& item : service_scans_) {
+    if (item.second.platform_session) {
+      item.second.platform_session->stop_scanning();
+    }
+  }
+}
+
+std::unique_ptr<BleScanArbiter::ScanningSession> BleScanArbiter::StartScanning(
+    const Uuid& service_uuid, TxPowerLevel tx_power_level,
+    ScanningCallback callback) {
+  int client_id;
+  {
+    MutexLock lock(&mutex_);
+    client_id = next_client_id_++;
+    ServiceScan& service_scan = service_scans_[service_uuid];
+    service_scan.clients.insert(
+        {client_id,
+         Client{.tx_power_level = tx_power_level,
+                .advertisement_found_cb =
+                    std::make_shared<AdvertisementFoundCallback>(
+                        std::move(callback.advertisement_found_cb))}});
+    if (!UpdatePlatformScanLocked(service_uuid, service_scan,
+                                  &callback.start_scanning_result)
+             .ok()) {
+      service_scan.clients.erase(client_id);
+      if (service_scan.clients.empty()) {
+        service_scans_.erase(service_uuid);
+      }
+      return nullptr;
+    }
+  }
+
+  // The platform scan that was already running is shared with this client.
+  if (callback.start_scanning_result) {
+    callback.start_scanning_result(absl::OkStatus());
+  }
+  return std::make_unique<ScanningSession>(ScanningSession{
+      .stop_scanning = [this, service_uuid, client_id]() {
+        return StopScanning(service_uuid, client_id);
+      }});
+}
+
+int BleScanArbiter::GetPlatformScanCount() const {
+  MutexLock lock(&mutex_);
+  return std::count_if(
+      service_scans_.begin(), service_scans_.end(),
+      [](const auto& item) { return item.second.platform_session != nullptr; });
+}
+
+absl::Status BleScanArbiter::StopScanning(const Uuid& service_uuid,
+                                          int client_id) {
+  MutexLock lock(&mutex_);
+  auto it = service_scans_.find(service_uuid);
+  if (it == service_scans_.end() || !it->second.clients.erase(client_id)) {
+    return absl::NotFoundError("Scanning session was already stopped");
+  }
+
+  ServiceScan& service_scan = it->second;
+  if (service_scan.clients.empty()) {
+    absl::Status status = service_scan.platform_session->stop_scanning();
+    service_scans_.erase(it);
+    return status;
+  }
+  absl::AnyInvocable<void(absl::Status)> start_scanning_result =
+      [](absl::Status) {};
+  return UpdatePlatformScanLocked(service_uuid, service_scan,
+                                  &start_scanning_result);
+}
+
+absl::Status BleScanArbiter::UpdatePlatformScanLocked(
+    const Uuid& service_uuid, ServiceScan& service_scan,
+    absl::AnyInvocable<void(absl::Status)>* start_scanning_result) {
+  TxPowerLevel tx_power_level = TxPowerLevel::kUnknown;
+  for (const auto& item : service_scan.clients) {
+    tx_power_level = std::max(tx_power_level, item.second.tx_power_level);
+  }
+
+  if (service_scan.platform_session &&
+      service_scan.tx_power_level == tx_power_level) {
+    return absl::OkStatus();
+  }
+
+  if (service_scan.platform_session) {
+    NEARBY_LOGS(INFO) << "Restarting BLE scan for "
+                      << std::string(service_uuid) << " at power level "
+                      << static_cast<int>(tx_power_level);
+    service_scan.platform_session->stop_scanning();
+    service_scan.platform_session.reset();
+  }
+
+  service_scan.platform_session = medium_.StartScanning(
+      service_uuid, tx_power_level,
+      ScanningCallback{
+          .start_scanning_result = std::move(*start_scanning_result),
+          .advertisement_found_cb =
+              [this, service_uuid](
+                  api::ble_v2::BlePeripheral& peripheral,
+                  BleAdvertisementData advertisement_data) {
+                OnAdvertisementFound(service_uuid, peripheral,
+                                     std::move(advertisement_data));
+              },
+      });
+  *start_scanning_result = nullptr;
+  if (!service_scan.platform_session) {
+    return absl::InternalError("Failed to start BLE scan");
+  }
+  service_scan.tx_power_level = tx_power_level;
+  return absl::OkStatus();
+}
+
+void BleScanArbiter::OnAdvertisementFound(
+    const Uuid& service_uuid, api::ble_v2::BlePeripheral& peripheral,
+    BleAdvertisementData advertisement_data) {
+  std::vector<std::shared_ptr<AdvertisementFoundCallback>> callbacks;
+  {
+    MutexLock lock(&mutex_);
+    auto it = service_scans_.find(service_uuid);
+    if (it == service_scans_.end()) return;
+    for (const auto& item : it->second.clients) {
+      callbacks.push_back(item.second.advertisement_found_cb);
+    }
+  }
+  for (const auto& callback : callbacks) {
+    (*callback)(peripheral, advertisement_data);
+  }
+}
+
+}  // namespace nearby
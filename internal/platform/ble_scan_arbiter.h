@@ -0,0 +1,101 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef PLATFORM_PUBLIC_BLE_SCAN_ARBITER_H_
+#define PLATFORM_PUBLIC_BLE_SCAN_ARBITER_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "internal/platform/ble_v2.h"
+#include "internal/platform/implementation/ble_v2.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/uuid.h"
+
+namespace nearby {
+
+// Shares platform BLE scans between the clients of a BleV2Medium.
+//
+// Clients scanning for the same service UUID share one platform scan, and
+// every advertisement it finds is delivered to each of them. The platform
+// scan runs at the highest TxPowerLevel any of its clients asked for, which
+// platforms map to their scan duty cycle; it is only restarted when that level
+// changes, not whenever a client comes or goes.
+//
+// Sessions returned by StartScanning() must be stopped before the arbiter is
+// destroyed.
+class BleScanArbiter {
+ public:
+  using ScanningCallback = api::ble_v2::BleMedium::ScanningCallback;
+  using ScanningSession = api::ble_v2::BleMedium::ScanningSession;
+
+  explicit BleScanArbiter(BleV2Medium& medium) : medium_(medium) {}
+  ~BleScanArbiter();
+
+  // Same as BleV2Medium::StartScanning(), but joins the platform scan for
+  // `service_uuid` if there is one. Returns nullptr on error.
+  std::unique_ptr<ScanningSession> StartScanning(
+      const Uuid& service_uuid, api::ble_v2::TxPowerLevel tx_power_level,
+      ScanningCallback callback) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of platform scans running.
+  int GetPlatformScanCount() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  using AdvertisementFoundCallback =
+      decltype(ScanningCallback::advertisement_found_cb);
+
+  struct Client {
+    api::ble_v2::TxPowerLevel tx_power_level;
+    // Shared so that it can be invoked without holding `mutex_`.
+    std::shared_ptr<AdvertisementFoundCallback> advertisement_found_cb;
+  };
+
+  struct ServiceScan {
+    api::ble_v2::TxPowerLevel tx_power_level =
+        api::ble_v2::TxPowerLevel::kUnknown;
+    std::unique_ptr<ScanningSession> platform_session;
+    absl::flat_hash_map<int, Client> clients;
+  };
+
+  absl::Status StopScanning(const Uuid& service_uuid, int client_id)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Starts the platform scan for `service_uuid`, or restarts it if its clients
+  // now need a different power level. `start_scanning_result` is handed to the
+  // platform, and cleared, only if a platform scan is started.
+  absl::Status UpdatePlatformScanLocked(
+      const Uuid& service_uuid, ServiceScan& service_scan,
+      absl::AnyInvocable<void(absl::Status)>* start_scanning_result)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  void OnAdvertisementFound(
+      const Uuid& service_uuid, api::ble_v2::BlePeripheral& peripheral,
+      api::ble_v2::BleAdvertisementData advertisement_data)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  mutable Mutex mutex_;
+  BleV2Medium& medium_;
+  int next_client_id_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::flat_hash_map<Uuid, ServiceScan> service_scans_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace nearby
+
+#endif  // PLATFORM_PUBLIC_BLE_SCAN_ARBITER_H_
@@ -0,0 +1,165 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "internal/platform/ble_scan_arbiter.h"
+
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "protobuf-matchers/protocol-buffer-matchers.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "internal/platform/ble_v2.h"
+#include "internal/platform/bluetooth_adapter.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/count_down_latch.h"
+#include "internal/platform/implementation/ble_v2.h"
+#include "internal/platform/medium_environment.h"
+#include "internal/platform/uuid.h"
+
+namespace nearby {
+namespace {
+
+using ::nearby::api::ble_v2::BleAdvertisementData;
+using ::nearby::api::ble_v2::TxPowerLevel;
+using ::testing::status::StatusIs;
+using ScanningCallback = ::nearby::api::ble_v2::BleMedium::ScanningCallback;
+using ScanningSession = ::nearby::api::ble_v2::BleMedium::ScanningSession;
+
+constexpr absl::Duration kWaitDuration = absl::Milliseconds(1000);
+constexpr absl::string_view kAdvertisementString = "\x0a\x0b\x0c\x0d";
+
+ScanningCallback CountDownOnFound(CountDownLatch& latch) {
+  return ScanningCallback{
+      .advertisement_found_cb =
+          [&latch](api::ble_v2::BlePeripheral& peripheral,
+                   BleAdvertisementData advertisement_data) {
+            latch.CountDown();
+          },
+  };
+}
+
+class BleScanArbiterTest : public ::testing::Test {
+ protected:
+  void SetUp() override { env_.Start(); }
+  void TearDown() override { env_.Stop(); }
+
+  MediumEnvironment& env_{MediumEnvironment::Instance()};
+};
+
+TEST_F(BleScanArbiterTest, SharesPlatformScanForSameServiceUuid) {
+  BluetoothAdapter adapter_a;
+  BluetoothAdapter adapter_b;
+  BleV2Medium ble_a(adapter_a);
+  BleV2Medium ble_b(adapter_b);
+  BleScanArbiter arbiter(ble_a);
+  Uuid service_uuid(1234, 5678);
+  CountDownLatch found_latch_1(1);
+  CountDownLatch found_latch_2(1);
+
+  std::unique_ptr<ScanningSession> session_1 = arbiter.StartScanning(
+      service_uuid, TxPowerLevel::kHigh, CountDownOnFound(found_latch_1));
+  std::unique_ptr<ScanningSession> session_2 = arbiter.StartScanning(
+      service_uuid, TxPowerLevel::kHigh, CountDownOnFound(found_latch_2));
+  ASSERT_NE(session_1, nullptr);
+  ASSERT_NE(session_2, nullptr);
+  EXPECT_EQ(arbiter.GetPlatformScanCount(), 1);
+
+  BleAdvertisementData advertising_data;
+  advertising_data.service_data = {
+      {service_uuid, ByteArray(std::string(kAdvertisementString))}};
+  ASSERT_TRUE(ble_b.StartAdvertising(
+      advertising_data,
+      {.tx_power_level = TxPowerLevel::kHigh, .is_connectable = true}));
+
+  EXPECT_TRUE(found_latch_1.Await(kWaitDuration).result());
+  EXPECT_TRUE(found_latch_2.Await(kWaitDuration).result());
+
+  EXPECT_TRUE(ble_b.StopAdvertising());
+  EXPECT_OK(session_1->stop_scanning());
+  EXPECT_OK(session_2->stop_scanning());
+  env_.UnregisterBleV2Medium(*ble_a.GetImpl());
+  env_.UnregisterBleV2Medium(*ble_b.GetImpl());
+}
+
+TEST_F(BleScanArbiterTest, StartsPlatformScanPerServiceUuid) {
+  BluetoothAdapter adapter;
+  BleV2Medium ble(adapter);
+  BleScanArbiter arbiter(ble);
+  CountDownLatch found_latch(1);
+
+  std::unique_ptr<ScanningSession> session_1 = arbiter.StartScanning(
+      Uuid(1234, 5678), TxPowerLevel::kHigh, CountDownOnFound(found_latch));
+  std::unique_ptr<ScanningSession> session_2 = arbiter.StartScanning(
+      Uuid(8765, 4321), TxPowerLevel::kHigh, CountDownOnFound(found_latch));
+
+  EXPECT_EQ(arbiter.GetPlatformScanCount(), 2);
+  EXPECT_OK(session_1->stop_scanning());
+  EXPECT_OK(session_2->stop_scanning());
+  env_.UnregisterBleV2Medium(*ble.GetImpl());
+}
+
+TEST_F(BleScanArbiterTest, StopsPlatformScanWithLastSession) {
+  BluetoothAdapter adapter;
+  BleV2Medium ble(adapter);
+  BleScanArbiter arbiter(ble);
+  Uuid service_uuid(1234, 5678);
+  CountDownLatch found_latch(1);
+
+  std::unique_ptr<ScanningSession> session_1 = arbiter.StartScanning(
+      service_uuid, TxPowerLevel::kLow, CountDownOnFound(found_latch));
+  std::unique_ptr<ScanningSession> session_2 = arbiter.StartScanning(
+      service_uuid, TxPowerLevel::kHigh, CountDownOnFound(found_latch));
+
+  EXPECT_OK(session_2->stop_scanning());
+  EXPECT_EQ(arbiter.GetPlatformScanCount(), 1);
+  EXPECT_TRUE(env_.GetBleV2MediumStatus(*ble.GetImpl()).value().is_scanning);
+
+  EXPECT_OK(session_1->stop_scanning());
+  EXPECT_EQ(arbiter.GetPlatformScanCount(), 0);
+  EXPECT_FALSE(env_.GetBleV2MediumStatus(*ble.GetImpl()).value().is_scanning);
+
+  EXPECT_THAT(session_1->stop_scanning(),
+              StatusIs(absl::StatusCode::kNotFound));
+  env_.UnregisterBleV2Medium(*ble.GetImpl());
+}
+
+TEST_F(BleScanArbiterTest, ReportsStartToSessionJoiningPlatformScan) {
+  BluetoothAdapter adapter;
+  BleV2Medium ble(adapter);
+  BleScanArbiter arbiter(ble);
+  Uuid service_uuid(1234, 5678);
+  absl::Status start_status = absl::UnknownError("not started");
+
+  std::unique_ptr<ScanningSession> session_1 =
+      arbiter.StartScanning(service_uuid, TxPowerLevel::kHigh, {});
+  std::unique_ptr<ScanningSession> session_2 = arbiter.StartScanning(
+      service_uuid, TxPowerLevel::kHigh,
+      ScanningCallback{
+          .start_scanning_result =
+              [&start_status](absl::Status status) { start_status = status; },
+      });
+
+  EXPECT_OK(start_status);
+  EXPECT_OK(session_1->stop_scanning());
+  EXPECT_OK(session_2->stop_scanning());
+  env_.UnregisterBleV2Medium(*ble.GetImpl());
+}
+
+}  // namespace
+}  // namespace nearby
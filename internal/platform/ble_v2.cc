@@ -278,6 +278,27 @@ BleV2Socket BleV2Medium::Connect(const std::string& service_id,
   return socket;
 }
 
+BleV2ServerSocket BleV2Medium::OpenL2capServerSocket(
+    const std::string& service_id) {
+  return BleV2ServerSocket(*this, impl_->OpenL2capServerSocket(service_id));
+}
+
+BleV2Socket BleV2Medium::ConnectOverL2cap(int psm,
+                                          const std::string& service_id,
+                                          TxPowerLevel tx_power_level,
+                                          const BleV2Peripheral& peripheral,
+                                          CancellationFlag* cancellation_flag) {
+  BleV2Socket socket;
+  peripheral.GetImpl([&](api::ble_v2::BlePeripheral& device) {
+    socket = BleV2Socket(peripheral,
+                         impl_->ConnectOverL2cap(psm, service_id,
+                                                 tx_power_level, device,
+                                                 cancellation_flag),
+                         /*is_l2cap=*/true);
+  });
+  return socket;
+}
+
 bool BleV2Medium::IsExtendedAdvertisementsAvailable() {
   return impl_->IsExtendedAdvertisementsAvailable();
 }
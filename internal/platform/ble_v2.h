@@ -85,8 +85,9 @@ class BleV2Socket final {
  public:
   BleV2Socket() = default;
   BleV2Socket(BleV2Peripheral peripheral,
-              std::unique_ptr<api::ble_v2::BleSocket> socket)
-      : peripheral_(peripheral) {
+              std::unique_ptr<api::ble_v2::BleSocket> socket,
+              bool is_l2cap = false)
+      : peripheral_(peripheral), is_l2cap_(is_l2cap) {
     state_->socket = std::move(socket);
   }
   BleV2Socket(const BleV2Socket&) = default;
@@ -123,6 +124,10 @@ class BleV2Socket final {
   // Returns BlePeripheral object which wraps a valid BlePeripheral pointer.
   BleV2Peripheral& GetRemotePeripheral() { return peripheral_; }
 
+  // Returns true if the socket runs over an L2CAP connection-oriented channel
+  // rather than over GATT.
+  bool IsL2cap() const { return is_l2cap_; }
+
   // Returns true if a socket is usable. If this method returns false,
   // it is not safe to call any other method.
   // NOTE(socket validity):
@@ -148,6 +153,7 @@ class BleV2Socket final {
   };
   std::shared_ptr<SharedState> state_ = std::make_shared<SharedState>();
   BleV2Peripheral peripheral_;
+  bool is_l2cap_ = false;
 };
 
 // Container of operations that can be performed over the BLE GATT server
@@ -181,7 +187,8 @@ class BleV2ServerSocket final {
         peripheral = BleV2Peripheral(*medium_, *platform_peripheral);
       }
     }
-    return BleV2Socket(peripheral, std::move(socket));
+    return BleV2Socket(peripheral, std::move(socket),
+                       /*is_l2cap=*/GetPsm() != 0);
   }
 
   // Returns Exception::kIo on error, Exception::kSuccess otherwise.
@@ -190,6 +197,10 @@ class BleV2ServerSocket final {
     return impl_->Close();
   }
 
+  // Returns the PSM of the L2CAP channel this socket listens on, or 0 when it
+  // is a GATT server socket.
+  int GetPsm() const { return impl_->GetPsm(); }
+
   bool IsValid() const { return impl_ != nullptr; }
   api::ble_v2::BleServerSocket& GetImpl() { return *impl_; }
 
@@ -438,6 +449,17 @@ class BleV2Medium final {
                       const BleV2Peripheral& peripheral,
                       CancellationFlag* cancellation_flag);
 
+  // Returns a new BleServerSocket listening on an L2CAP channel.
+  // On Success, BleServerSocket::IsValid() returns true.
+  BleV2ServerSocket OpenL2capServerSocket(const std::string& service_id);
+
+  // Returns a new BleSocket connected to the L2CAP channel at `psm`.
+  // On Success, BleSocket::IsValid() returns true.
+  BleV2Socket ConnectOverL2cap(int psm, const std::string& service_id,
+                               api::ble_v2::TxPowerLevel tx_power_level,
+                               const BleV2Peripheral& peripheral,
+                               CancellationFlag* cancellation_flag);
+
   bool IsExtendedAdvertisementsAvailable();
 
   bool IsValid() const { return impl_ != nullptr; }
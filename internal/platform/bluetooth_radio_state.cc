@@ -0,0 +1,135 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/bluetooth_radio_state.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/time/time.h"
+#include "internal/platform/bluetooth_adapter.h"
+#include "internal/platform/logging.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/mutex_lock.h"
+#include "internal/platform/system_clock.h"
+
+namespace nearby {
+
+std::shared_ptr<BluetoothRadioState> BluetoothRadioState::ForAdapter(
+    const BluetoothAdapter& adapter) {
+  static Mutex* mutex = new Mutex();
+  static auto* states = new absl::flat_hash_map<
+      std::string, std::weak_ptr<BluetoothRadioState>>();
+
+  std::string mac_address =
+      adapter.IsValid() ? adapter.GetMacAddress() : std::string();
+  if (mac_address.empty()) {
+    return std::make_shared<BluetoothRadioState>();
+  }
+
+  MutexLock lock(mutex);
+  for (auto it = states->begin(); it != states->end();) {
+    if (it->second.expired()) {
+      states->erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  std::shared_ptr<BluetoothRadioState> state = (*states)[mac_address].lock();
+  if (state == nullptr) {
+    state = std::make_shared<BluetoothRadioState>();
+    (*states)[mac_address] = state;
+  }
+  return state;
+}
+
+int BluetoothRadioState::AddUser() {
+  MutexLock lock(&mutex_);
+  return next_user_id_++;
+}
+
+bool BluetoothRadioState::IsEnabled(const BluetoothAdapter& adapter) {
+  MutexLock lock(&mutex_);
+  return IsEnabledLocked(adapter);
+}
+
+bool BluetoothRadioState::Enable(int user_id, BluetoothAdapter& adapter) {
+  MutexLock lock(&mutex_);
+  SaveOriginalStateLocked(user_id, adapter);
+  enabling_users_.insert(user_id);
+  return SetEnabledLocked(true, adapter);
+}
+
+bool BluetoothRadioState::Disable(int user_id, BluetoothAdapter& adapter) {
+  MutexLock lock(&mutex_);
+  SaveOriginalStateLocked(user_id, adapter);
+  enabling_users_.erase(user_id);
+  if (!enabling_users_.empty()) {
+    NEARBY_LOGS(INFO) << "Not disabling BT adapter, " << enabling_users_.size()
+                      << " other users hold it enabled.";
+    return !IsEnabledLocked(adapter);
+  }
+  return SetEnabledLocked(false, adapter);
+}
+
+void BluetoothRadioState::RemoveUser(int user_id, BluetoothAdapter& adapter) {
+  MutexLock lock(&mutex_);
+  enabling_users_.erase(user_id);
+  if (modifying_users_.erase(user_id) == 0 || !modifying_users_.empty()) {
+    return;
+  }
+
+  NEARBY_LOGS(INFO) << "Bring BT adapter to original state";
+  if (!SetEnabledLocked(originally_enabled_, adapter)) {
+    NEARBY_LOGS(INFO) << "Failed to restore BT adapter original state.";
+  }
+}
+
+bool BluetoothRadioState::IsEnabledLocked(const BluetoothAdapter& adapter) {
+  absl::Time now = SystemClock::ElapsedRealtime();
+  if (now - enabled_read_time_ >= kStateTtl) {
+    enabled_ = adapter.IsEnabled();
+    enabled_read_time_ = now;
+  }
+  return enabled_;
+}
+
+void BluetoothRadioState::SaveOriginalStateLocked(
+    int user_id, const BluetoothAdapter& adapter) {
+  if (modifying_users_.empty()) {
+    // Don't trust the cache with what will be restored.
+    enabled_read_time_ = absl::InfinitePast();
+    originally_enabled_ = IsEnabledLocked(adapter);
+  }
+  modifying_users_.insert(user_id);
+}
+
+bool BluetoothRadioState::SetEnabledLocked(bool enabled,
+                                           BluetoothAdapter& adapter) {
+  if (IsEnabledLocked(adapter) == enabled) {
+    return true;
+  }
+  if (!adapter.SetStatus(enabled ? BluetoothAdapter::Status::kEnabled
+                                 : BluetoothAdapter::Status::kDisabled)) {
+    // The adapter may have gone part of the way; ask it next time.
+    enabled_read_time_ = absl::InfinitePast();
+    return false;
+  }
+  enabled_ = enabled;
+  enabled_read_time_ = SystemClock::ElapsedRealtime();
+  return true;
+}
+
+}  // namespace nearby
@@ -0,0 +1,102 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PLATFORM_PUBLIC_BLUETOOTH_RADIO_STATE_H_
+#define PLATFORM_PUBLIC_BLUETOOTH_RADIO_STATE_H_
+
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/time/time.h"
+#include "internal/platform/bluetooth_adapter.h"
+#include "internal/platform/mutex.h"
+
+namespace nearby {
+
+// Shares what is known about a Bluetooth radio between its users in the
+// process, e.g. the BluetoothRadio of Connections and the one of Fast Pair.
+//
+// Asking the adapter for its state, let alone toggling it, is slow on some
+// platforms, yet every medium start checks it. The state is therefore cached
+// for kStateTtl, and the adapter is only toggled when the radio isn't in the
+// requested state already. Users holding the radio enabled are counted, so
+// that one of them disabling it doesn't pull it from under the others, and so
+// that the state the radio was found in is only restored once the last user
+// is done with it.
+//
+// Thread-safe.
+class BluetoothRadioState {
+ public:
+  // How long the state read from the adapter is trusted. Changes made through
+  // this class are seen right away; changes made behind its back, e.g. by the
+  // user, after at most this long.
+  static constexpr absl::Duration kStateTtl = absl::Seconds(1);
+
+  // Returns the state shared by every user of the radio behind |adapter|.
+  // Radios are told apart by the MAC address of their adapter, so that
+  // simulated devices living in one process don't share one.
+  static std::shared_ptr<BluetoothRadioState> ForAdapter(
+      const BluetoothAdapter& adapter);
+
+  // Returns an id to identify a new user in the calls below.
+  int AddUser() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns whether the radio is enabled, only asking |adapter| if the state
+  // it last gave is older than kStateTtl.
+  bool IsEnabled(const BluetoothAdapter& adapter) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Holds the radio enabled for |user_id|, enabling it through |adapter|
+  // unless it already is. Returns whether the radio is enabled.
+  bool Enable(int user_id, BluetoothAdapter& adapter)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Drops the hold of |user_id| and disables the radio through |adapter|,
+  // unless it already is disabled, or another user holds it enabled. Returns
+  // whether the radio is disabled.
+  bool Disable(int user_id, BluetoothAdapter& adapter)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Forgets |user_id|. Once every user who enabled or disabled the radio is
+  // gone, restores it through |adapter| to the state it was in before the
+  // first of them did.
+  void RemoveUser(int user_id, BluetoothAdapter& adapter)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  bool IsEnabledLocked(const BluetoothAdapter& adapter)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Remembers the state the radio was found in, if no user changed it yet.
+  void SaveOriginalStateLocked(int user_id, const BluetoothAdapter& adapter)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  bool SetEnabledLocked(bool enabled, BluetoothAdapter& adapter)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Held while toggling the radio, so that users enabling it at the same time
+  // wait for the first one instead of toggling it again.
+  Mutex mutex_;
+  int next_user_id_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool enabled_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Time enabled_read_time_ ABSL_GUARDED_BY(mutex_) =
+      absl::InfinitePast();
+  // Users who enabled or disabled the radio, and those among them holding it
+  // enabled.
+  absl::flat_hash_set<int> modifying_users_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_set<int> enabling_users_ ABSL_GUARDED_BY(mutex_);
+  bool originally_enabled_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+}  // namespace nearby
+
+#endif  // PLATFORM_PUBLIC_BLUETOOTH_RADIO_STATE_H_
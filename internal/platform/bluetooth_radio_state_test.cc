@@ -0,0 +1,85 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/bluetooth_radio_state.h"
+
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "absl/time/clock.h"
+#include "internal/platform/bluetooth_adapter.h"
+
+namespace nearby {
+namespace {
+
+TEST(BluetoothRadioStateTest, SharesStateOfSameAdapter) {
+  BluetoothAdapter adapter;
+  BluetoothAdapter other_adapter;
+
+  std::shared_ptr<BluetoothRadioState> state =
+      BluetoothRadioState::ForAdapter(adapter);
+
+  EXPECT_EQ(BluetoothRadioState::ForAdapter(adapter), state);
+  EXPECT_NE(BluetoothRadioState::ForAdapter(other_adapter), state);
+}
+
+TEST(BluetoothRadioStateTest, KeepsRadioEnabledForOtherUsers) {
+  BluetoothAdapter adapter;
+  BluetoothRadioState state;
+  int user_a = state.AddUser();
+  int user_b = state.AddUser();
+
+  EXPECT_TRUE(state.Enable(user_a, adapter));
+  EXPECT_TRUE(state.Enable(user_b, adapter));
+
+  EXPECT_FALSE(state.Disable(user_a, adapter));
+  EXPECT_TRUE(adapter.IsEnabled());
+  EXPECT_TRUE(state.Disable(user_b, adapter));
+  EXPECT_FALSE(adapter.IsEnabled());
+  EXPECT_FALSE(state.IsEnabled(adapter));
+}
+
+TEST(BluetoothRadioStateTest, RestoresOriginalStateAfterLastUser) {
+  BluetoothAdapter adapter;
+  adapter.SetStatus(BluetoothAdapter::Status::kDisabled);
+  BluetoothRadioState state;
+  int user_a = state.AddUser();
+  int user_b = state.AddUser();
+  int idle_user = state.AddUser();
+
+  EXPECT_TRUE(state.Enable(user_a, adapter));
+  EXPECT_TRUE(state.Enable(user_b, adapter));
+  EXPECT_TRUE(adapter.IsEnabled());
+
+  state.RemoveUser(idle_user, adapter);
+  state.RemoveUser(user_a, adapter);
+  EXPECT_TRUE(adapter.IsEnabled());
+  state.RemoveUser(user_b, adapter);
+  EXPECT_FALSE(adapter.IsEnabled());
+}
+
+TEST(BluetoothRadioStateTest, CachesStateForTtl) {
+  BluetoothAdapter adapter;
+  BluetoothRadioState state;
+  EXPECT_TRUE(state.IsEnabled(adapter));
+
+  adapter.SetStatus(BluetoothAdapter::Status::kDisabled);
+
+  EXPECT_TRUE(state.IsEnabled(adapter));
+  absl::SleepFor(BluetoothRadioState::kStateTtl + absl::Milliseconds(100));
+  EXPECT_FALSE(state.IsEnabled(adapter));
+}
+
+}  // namespace
+}  // namespace nearby
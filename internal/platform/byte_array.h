@@ -94,6 +94,11 @@ class ByteArray {
   // operation.
   explicit operator std::string() && { return std::move(data_); }
 
+  // Returns a reference to the internal representation, without copying.
+  // The reference is only valid for as long as this ByteArray is alive and
+  // unmodified.
+  const std::string& AsStringRef() const { return data_; }
+
   // Returns the representation of the underlying data as a string view.
   absl::string_view AsStringView() const {
     return absl::string_view(data(), size());
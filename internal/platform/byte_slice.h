@@ -0,0 +1,122 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PLATFORM_BASE_BYTE_SLICE_H_
+#define PLATFORM_BASE_BYTE_SLICE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "internal/platform/byte_array.h"
+
+namespace nearby {
+
+// An immutable view into reference-counted byte storage.
+//
+// Copying a ByteSlice, or taking a Subslice() of it, shares the underlying
+// storage instead of copying the bytes, which makes it suitable for buffers
+// that are split up and handed around on hot paths. Storage is released once
+// the last slice referring to it goes away.
+//
+// Use ToByteArray() (deep copy) or std::move(slice).ToByteArray() (zero-copy
+// when the slice is the sole owner of all of its storage) to convert back
+// into a ByteArray at API boundaries.
+class ByteSlice {
+ public:
+  // Create an empty ByteSlice.
+  ByteSlice() = default;
+  ByteSlice(const ByteSlice&) = default;
+  ByteSlice& operator=(const ByteSlice&) = default;
+  ByteSlice(ByteSlice&&) = default;
+  ByteSlice& operator=(ByteSlice&&) = default;
+
+  // Takes over the storage of a temporary ByteArray without copying it.
+  explicit ByteSlice(ByteArray&& bytes)
+      : ByteSlice(std::string(std::move(bytes))) {}
+
+  // Creates a ByteSlice by copy of a ByteArray.
+  explicit ByteSlice(const ByteArray& bytes)
+      : ByteSlice(std::string(bytes.data(), bytes.size())) {}
+
+  // Takes over the storage of a temporary string without copying it.
+  explicit ByteSlice(std::string&& source)
+      : storage_(std::make_shared<std::string>(std::move(source))),
+        offset_(0),
+        size_(storage_->size()) {}
+
+  // Returns a slice of at most `size` bytes starting at `offset`, sharing
+  // storage with this slice. Out of range requests are clamped.
+  ByteSlice Subslice(size_t offset, size_t size) const {
+    ByteSlice slice;
+    if (offset >= size_) return slice;
+    slice.storage_ = storage_;
+    slice.offset_ = offset_ + offset;
+    slice.size_ = std::min(size, size_ - offset);
+    return slice;
+  }
+
+  // Returns a slice of everything from `offset` onwards.
+  ByteSlice Subslice(size_t offset) const {
+    return Subslice(offset, size_);
+  }
+
+  const char* data() const {
+    return storage_ ? storage_->data() + offset_ : nullptr;
+  }
+  size_t size() const { return size_; }
+  bool Empty() const { return size_ == 0; }
+
+  // Returns the representation of the underlying data as a string view.
+  absl::string_view AsStringView() const {
+    return absl::string_view(data(), size());
+  }
+
+  // Returns a copy of the viewed bytes as a ByteArray.
+  ByteArray ToByteArray() const& { return ByteArray(data(), size()); }
+
+  // Moves the bytes out of a temporary ByteSlice. This is zero-copy when the
+  // slice covers all of its storage and no other slice shares it; otherwise
+  // the viewed bytes are copied.
+  ByteArray ToByteArray() && {
+    if (storage_ && storage_.use_count() == 1 && offset_ == 0 &&
+        size_ == storage_->size()) {
+      ByteArray bytes(std::move(*storage_));
+      storage_.reset();
+      size_ = 0;
+      return bytes;
+    }
+    return ByteArray(data(), size());
+  }
+
+  friend bool operator==(const ByteSlice& lhs, const ByteSlice& rhs) {
+    return lhs.AsStringView() == rhs.AsStringView();
+  }
+  friend bool operator!=(const ByteSlice& lhs, const ByteSlice& rhs) {
+    return !(lhs == rhs);
+  }
+
+ private:
+  // Never modified through a slice, except when moved out of its sole owner.
+  std::shared_ptr<std::string> storage_;
+  size_t offset_ = 0;
+  size_t size_ = 0;
+};
+
+}  // namespace nearby
+
+#endif  // PLATFORM_BASE_BYTE_SLICE_H_
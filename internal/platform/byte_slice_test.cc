@@ -0,0 +1,91 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/byte_slice.h"
+
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "internal/platform/byte_array.h"
+
+namespace {
+
+using ::nearby::ByteArray;
+using ::nearby::ByteSlice;
+
+TEST(ByteSliceTest, DefaultIsEmpty) {
+  ByteSlice slice;
+  EXPECT_TRUE(slice.Empty());
+  EXPECT_EQ(slice.size(), 0);
+  EXPECT_TRUE(slice.ToByteArray().Empty());
+}
+
+TEST(ByteSliceTest, CreateFromByteArray) {
+  ByteArray bytes("ABCDEFGH");
+  ByteSlice slice(bytes);
+  EXPECT_EQ(slice.AsStringView(), "ABCDEFGH");
+  EXPECT_EQ(slice.ToByteArray(), bytes);
+}
+
+TEST(ByteSliceTest, CopiesShareStorage) {
+  ByteSlice slice(ByteArray("ABCDEFGH"));
+  ByteSlice copy = slice;
+  EXPECT_EQ(copy.data(), slice.data());
+  EXPECT_EQ(copy, slice);
+}
+
+TEST(ByteSliceTest, SubsliceSharesStorage) {
+  ByteSlice slice(ByteArray("ABCDEFGH"));
+  ByteSlice sub = slice.Subslice(2, 3);
+  EXPECT_EQ(sub.AsStringView(), "CDE");
+  EXPECT_EQ(sub.data(), slice.data() + 2);
+  EXPECT_EQ(slice.Subslice(5).AsStringView(), "FGH");
+}
+
+TEST(ByteSliceTest, SubsliceIsClamped) {
+  ByteSlice slice(ByteArray("ABCDEFGH"));
+  EXPECT_EQ(slice.Subslice(6, 10).AsStringView(), "GH");
+  EXPECT_TRUE(slice.Subslice(8, 1).Empty());
+  EXPECT_TRUE(slice.Subslice(100).Empty());
+}
+
+TEST(ByteSliceTest, SubsliceOutlivesParent) {
+  ByteSlice sub;
+  {
+    ByteSlice slice(ByteArray("ABCDEFGH"));
+    sub = slice.Subslice(4);
+  }
+  EXPECT_EQ(sub.ToByteArray(), ByteArray("EFGH"));
+}
+
+TEST(ByteSliceTest, MoveToByteArrayFromSoleOwner) {
+  std::string data(1024, 'x');
+  ByteSlice slice{std::string(data)};
+  const char* storage = slice.data();
+  ByteArray bytes = std::move(slice).ToByteArray();
+  EXPECT_EQ(bytes.data(), storage);
+  EXPECT_EQ(std::string(bytes), data);
+}
+
+TEST(ByteSliceTest, MoveToByteArrayFromSharedSliceCopies) {
+  ByteSlice slice(ByteArray("ABCDEFGH"));
+  ByteSlice copy = slice;
+  ByteArray bytes = std::move(copy).ToByteArray();
+  EXPECT_EQ(bytes, ByteArray("ABCDEFGH"));
+  // The original slice must still be intact.
+  EXPECT_EQ(slice.AsStringView(), "ABCDEFGH");
+}
+
+}  // namespace
@@ -30,15 +30,27 @@ class ConditionVariable final {
  public:
   using Platform = api::ImplementationPlatform;
   explicit ConditionVariable(Mutex* mutex)
-      : impl_(Platform::CreateConditionVariable(mutex->impl_.get())) {}
+      : mutex_(mutex),
+        impl_(Platform::CreateConditionVariable(mutex->impl_.get())) {}
   ConditionVariable(ConditionVariable&&) = default;
   ConditionVariable& operator=(ConditionVariable&&) = default;
 
   void Notify() { impl_->Notify(); }
-  Exception Wait() { return impl_->Wait(); }
-  Exception Wait(absl::Duration timeout) { return impl_->Wait(timeout); }
+  Exception Wait() {
+    bool profiled = mutex_->PauseProfiling();
+    Exception result = impl_->Wait();
+    mutex_->ResumeProfiling(profiled);
+    return result;
+  }
+  Exception Wait(absl::Duration timeout) {
+    bool profiled = mutex_->PauseProfiling();
+    Exception result = impl_->Wait(timeout);
+    mutex_->ResumeProfiling(profiled);
+    return result;
+  }
 
  private:
+  Mutex* mutex_;
   std::unique_ptr<api::ConditionVariable> impl_;
 };
 
@@ -18,66 +18,98 @@
 #include <optional>
 #include <string>
 #include <system_error>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "internal/platform/implementation/device_info.h"
+#include "internal/platform/mutex_lock.h"
 
 namespace nearby {
 
+namespace {
+
+// Refreshes the device info when the screen is unlocked.
+constexpr absl::string_view kScreenUnlockedListenerName =
+    "nearby_device_info_refresh";
+
+}  // namespace
+
+DeviceInfoImpl::~DeviceInfoImpl() {
+  bool has_listeners;
+  {
+    MutexLock lock(&listeners_mutex_);
+    has_listeners = !listeners_.empty();
+  }
+  if (has_listeners) {
+    device_info_impl_->UnregisterScreenLockedListener(
+        kScreenUnlockedListenerName);
+  }
+}
+
 std::u16string DeviceInfoImpl::GetOsDeviceName() const {
-  std::optional<std::u16string> device_name =
-      device_info_impl_->GetOsDeviceName();
-  if (device_name.has_value()) {
-    return *device_name;
+  MutexLock lock(&mutex_);
+  const Info& info = GetInfoLocked();
+  if (info.os_device_name.has_value()) {
+    return *info.os_device_name;
   }
 
   return u"unknown";
 }
 
 api::DeviceInfo::DeviceType DeviceInfoImpl::GetDeviceType() const {
-  return device_info_impl_->GetDeviceType();
+  MutexLock lock(&mutex_);
+  return GetInfoLocked().device_type;
 }
 
 api::DeviceInfo::OsType DeviceInfoImpl::GetOsType() const {
-  return device_info_impl_->GetOsType();
+  MutexLock lock(&mutex_);
+  return GetInfoLocked().os_type;
 }
 
 std::optional<std::u16string> DeviceInfoImpl::GetFullName() const {
-  return device_info_impl_->GetFullName();
+  MutexLock lock(&mutex_);
+  return GetInfoLocked().full_name;
 }
 
 std::optional<std::u16string> DeviceInfoImpl::GetGivenName() const {
-  return device_info_impl_->GetGivenName();
+  MutexLock lock(&mutex_);
+  return GetInfoLocked().given_name;
 }
 
 std::optional<std::u16string> DeviceInfoImpl::GetLastName() const {
-  return device_info_impl_->GetLastName();
+  MutexLock lock(&mutex_);
+  return GetInfoLocked().last_name;
 }
 
 std::optional<std::string> DeviceInfoImpl::GetProfileUserName() const {
-  return device_info_impl_->GetProfileUserName();
+  MutexLock lock(&mutex_);
+  return GetInfoLocked().profile_user_name;
 }
 
 std::filesystem::path DeviceInfoImpl::GetDownloadPath() const {
-  std::optional<std::filesystem::path> path =
-      device_info_impl_->GetDownloadPath();
-  if (path.has_value()) {
-    return *path;
+  MutexLock lock(&mutex_);
+  const Info& info = GetInfoLocked();
+  if (info.download_path.has_value()) {
+    return *info.download_path;
   }
   return std::filesystem::temp_directory_path();
 }
 
 std::filesystem::path DeviceInfoImpl::GetAppDataPath() const {
-  std::optional<std::filesystem::path> path =
-      device_info_impl_->GetLocalAppDataPath();
-  if (path.has_value()) {
-    return *path;
+  MutexLock lock(&mutex_);
+  const Info& info = GetInfoLocked();
+  if (info.local_app_data_path.has_value()) {
+    return *info.local_app_data_path;
   }
   return std::filesystem::temp_directory_path();
 }
 
 std::filesystem::path DeviceInfoImpl::GetTemporaryPath() const {
-  std::optional<std::filesystem::path> path =
-      device_info_impl_->GetTemporaryPath();
-  if (path.has_value()) {
-    return *path;
+  MutexLock lock(&mutex_);
+  const Info& info = GetInfoLocked();
+  if (info.temporary_path.has_value()) {
+    return *info.temporary_path;
   }
   return std::filesystem::temp_directory_path();
 }
@@ -108,4 +140,94 @@ void DeviceInfoImpl::UnregisterScreenLockedListener(
   device_info_impl_->UnregisterScreenLockedListener(listener_name);
 }
 
+void DeviceInfoImpl::Refresh() {
+  Info info = QueryInfo();
+  {
+    MutexLock lock(&mutex_);
+    bool changed = info_.has_value() && !(*info_ == info);
+    info_ = std::move(info);
+    if (!changed) {
+      return;
+    }
+  }
+
+  std::vector<std::function<void()>> callbacks;
+  {
+    MutexLock lock(&listeners_mutex_);
+    for (const auto& [name, callback] : listeners_) {
+      callbacks.push_back(callback);
+    }
+  }
+  for (const auto& callback : callbacks) {
+    callback();
+  }
+}
+
+// The screen locked listener is (un)registered outside of |listeners_mutex_|,
+// since the platform may be calling it, and it takes the mutex in Refresh().
+void DeviceInfoImpl::RegisterDeviceInfoChangedListener(
+    absl::string_view listener_name, std::function<void()> callback) {
+  bool first;
+  {
+    MutexLock lock(&listeners_mutex_);
+    first = listeners_.empty();
+    listeners_[listener_name] = std::move(callback);
+  }
+  if (first) {
+    device_info_impl_->RegisterScreenLockedListener(
+        kScreenUnlockedListenerName,
+        [this](api::DeviceInfo::ScreenStatus status) {
+          if (status == api::DeviceInfo::ScreenStatus::kUnlocked) {
+            Refresh();
+          }
+        });
+  }
+}
+
+void DeviceInfoImpl::UnregisterDeviceInfoChangedListener(
+    absl::string_view listener_name) {
+  bool last;
+  {
+    MutexLock lock(&listeners_mutex_);
+    last = listeners_.erase(listener_name) > 0 && listeners_.empty();
+  }
+  if (last) {
+    device_info_impl_->UnregisterScreenLockedListener(
+        kScreenUnlockedListenerName);
+  }
+}
+
+bool DeviceInfoImpl::Info::operator==(const Info& other) const {
+  return os_device_name == other.os_device_name &&
+         device_type == other.device_type && os_type == other.os_type &&
+         full_name == other.full_name && given_name == other.given_name &&
+         last_name == other.last_name &&
+         profile_user_name == other.profile_user_name &&
+         download_path == other.download_path &&
+         local_app_data_path == other.local_app_data_path &&
+         temporary_path == other.temporary_path;
+}
+
+DeviceInfoImpl::Info DeviceInfoImpl::QueryInfo() const {
+  return {
+      .os_device_name = device_info_impl_->GetOsDeviceName(),
+      .device_type = device_info_impl_->GetDeviceType(),
+      .os_type = device_info_impl_->GetOsType(),
+      .full_name = device_info_impl_->GetFullName(),
+      .given_name = device_info_impl_->GetGivenName(),
+      .last_name = device_info_impl_->GetLastName(),
+      .profile_user_name = device_info_impl_->GetProfileUserName(),
+      .download_path = device_info_impl_->GetDownloadPath(),
+      .local_app_data_path = device_info_impl_->GetLocalAppDataPath(),
+      .temporary_path = device_info_impl_->GetTemporaryPath(),
+  };
+}
+
+const DeviceInfoImpl::Info& DeviceInfoImpl::GetInfoLocked() const {
+  if (!info_.has_value()) {
+    info_ = QueryInfo();
+  }
+  return *info_;
+}
+
 }  // namespace nearby
@@ -20,16 +20,31 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "internal/platform/device_info.h"
+#include "internal/platform/implementation/device_info.h"
 #include "internal/platform/implementation/platform.h"
+#include "internal/platform/mutex.h"
 
 namespace nearby {
 
+// Device information from the platform. The device name and type, the user's
+// names and the known paths are queried once, on first use, and kept until
+// Refresh() finds them changed, so that callers on interactive paths don't
+// wait for the OS each time.
+//
+// Thread-safe.
 class DeviceInfoImpl : public DeviceInfo {
  public:
   DeviceInfoImpl()
-      : device_info_impl_(api::ImplementationPlatform::CreateDeviceInfo()) {}
+      : DeviceInfoImpl(api::ImplementationPlatform::CreateDeviceInfo()) {}
+  explicit DeviceInfoImpl(std::unique_ptr<api::DeviceInfo> device_info_impl)
+      : device_info_impl_(std::move(device_info_impl)) {}
+  ~DeviceInfoImpl() override;
 
   std::u16string GetOsDeviceName() const override;
   api::DeviceInfo::DeviceType GetDeviceType() const override;
@@ -53,8 +68,40 @@ class DeviceInfoImpl : public DeviceInfo {
       std::function<void(api::DeviceInfo::ScreenStatus)> callback) override;
   void UnregisterScreenLockedListener(absl::string_view listener_name) override;
 
+  // Queries the platform again, and calls the device info changed listeners if
+  // anything changed. Also done whenever the screen is unlocked while there
+  // are listeners.
+  void Refresh();
+  void RegisterDeviceInfoChangedListener(absl::string_view listener_name,
+                                         std::function<void()> callback);
+  void UnregisterDeviceInfoChangedListener(absl::string_view listener_name);
+
  private:
+  struct Info {
+    std::optional<std::u16string> os_device_name;
+    api::DeviceInfo::DeviceType device_type;
+    api::DeviceInfo::OsType os_type;
+    std::optional<std::u16string> full_name;
+    std::optional<std::u16string> given_name;
+    std::optional<std::u16string> last_name;
+    std::optional<std::string> profile_user_name;
+    std::optional<std::filesystem::path> download_path;
+    std::optional<std::filesystem::path> local_app_data_path;
+    std::optional<std::filesystem::path> temporary_path;
+
+    bool operator==(const Info& other) const;
+  };
+
+  Info QueryInfo() const;
+  // Returns the cached info, querying it first if needed.
+  const Info& GetInfoLocked() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   std::unique_ptr<api::DeviceInfo> device_info_impl_;
+  mutable Mutex mutex_;
+  mutable std::optional<Info> info_ ABSL_GUARDED_BY(mutex_);
+  Mutex listeners_mutex_;
+  absl::flat_hash_map<std::string, std::function<void()>> listeners_
+      ABSL_GUARDED_BY(listeners_mutex_);
 };
 }  // namespace nearby
 
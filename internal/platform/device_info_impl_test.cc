@@ -0,0 +1,154 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "internal/platform/device_info_impl.h"
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "absl/strings/string_view.h"
+#include "internal/platform/implementation/device_info.h"
+
+namespace nearby {
+namespace {
+
+// Counts how often the device name is queried.
+class CountingDeviceInfo : public api::DeviceInfo {
+ public:
+  explicit CountingDeviceInfo(int* os_device_name_queries)
+      : os_device_name_queries_(os_device_name_queries) {}
+
+  std::optional<std::u16string> GetOsDeviceName() const override {
+    ++*os_device_name_queries_;
+    return os_device_name_;
+  }
+  DeviceType GetDeviceType() const override { return DeviceType::kLaptop; }
+  OsType GetOsType() const override { return OsType::kWindows; }
+  std::optional<std::u16string> GetFullName() const override {
+    return std::nullopt;
+  }
+  std::optional<std::u16string> GetGivenName() const override {
+    return std::nullopt;
+  }
+  std::optional<std::u16string> GetLastName() const override {
+    return std::nullopt;
+  }
+  std::optional<std::string> GetProfileUserName() const override {
+    return std::nullopt;
+  }
+  std::optional<std::filesystem::path> GetDownloadPath() const override {
+    return std::filesystem::path("/downloads");
+  }
+  std::optional<std::filesystem::path> GetLocalAppDataPath() const override {
+    return std::nullopt;
+  }
+  std::optional<std::filesystem::path> GetCommonAppDataPath() const override {
+    return std::nullopt;
+  }
+  std::optional<std::filesystem::path> GetTemporaryPath() const override {
+    return std::nullopt;
+  }
+  std::optional<std::filesystem::path> GetLogPath() const override {
+    return std::nullopt;
+  }
+  std::optional<std::filesystem::path> GetCrashDumpPath() const override {
+    return std::nullopt;
+  }
+  bool IsScreenLocked() const override { return false; }
+  void RegisterScreenLockedListener(
+      absl::string_view listener_name,
+      std::function<void(ScreenStatus)> callback) override {
+    screen_locked_listener_ = std::move(callback);
+  }
+  void UnregisterScreenLockedListener(
+      absl::string_view listener_name) override {
+    screen_locked_listener_ = nullptr;
+  }
+
+  void SetOsDeviceName(std::u16string os_device_name) {
+    os_device_name_ = std::move(os_device_name);
+  }
+  void SetScreenStatus(ScreenStatus status) {
+    if (screen_locked_listener_) screen_locked_listener_(status);
+  }
+
+ private:
+  int* os_device_name_queries_;
+  std::u16string os_device_name_ = u"Laptop";
+  std::function<void(ScreenStatus)> screen_locked_listener_;
+};
+
+TEST(DeviceInfoImplTest, QueriesPlatformOnce) {
+  int queries = 0;
+  DeviceInfoImpl device_info(std::make_unique<CountingDeviceInfo>(&queries));
+
+  EXPECT_EQ(device_info.GetOsDeviceName(), u"Laptop");
+  EXPECT_EQ(device_info.GetOsDeviceName(), u"Laptop");
+  EXPECT_EQ(device_info.GetOsType(), api::DeviceInfo::OsType::kWindows);
+  EXPECT_EQ(device_info.GetDownloadPath(), std::filesystem::path("/downloads"));
+  EXPECT_EQ(queries, 1);
+}
+
+TEST(DeviceInfoImplTest, RefreshNotifiesChanges) {
+  int queries = 0;
+  auto platform_device_info = std::make_unique<CountingDeviceInfo>(&queries);
+  CountingDeviceInfo* platform = platform_device_info.get();
+  DeviceInfoImpl device_info(std::move(platform_device_info));
+  int changes = 0;
+  device_info.RegisterDeviceInfoChangedListener("test",
+                                                [&changes]() { ++changes; });
+  EXPECT_EQ(device_info.GetOsDeviceName(), u"Laptop");
+
+  device_info.Refresh();
+  EXPECT_EQ(changes, 0);
+
+  platform->SetOsDeviceName(u"Desktop");
+  EXPECT_EQ(device_info.GetOsDeviceName(), u"Laptop");
+  device_info.Refresh();
+  EXPECT_EQ(changes, 1);
+  EXPECT_EQ(device_info.GetOsDeviceName(), u"Desktop");
+
+  device_info.UnregisterDeviceInfoChangedListener("test");
+  platform->SetOsDeviceName(u"Tablet");
+  device_info.Refresh();
+  EXPECT_EQ(changes, 1);
+}
+
+TEST(DeviceInfoImplTest, RefreshesWhenScreenUnlocked) {
+  int queries = 0;
+  auto platform_device_info = std::make_unique<CountingDeviceInfo>(&queries);
+  CountingDeviceInfo* platform = platform_device_info.get();
+  DeviceInfoImpl device_info(std::move(platform_device_info));
+  int changes = 0;
+  device_info.RegisterDeviceInfoChangedListener("test",
+                                                [&changes]() { ++changes; });
+  EXPECT_EQ(device_info.GetOsDeviceName(), u"Laptop");
+
+  platform->SetOsDeviceName(u"Desktop");
+  platform->SetScreenStatus(api::DeviceInfo::ScreenStatus::kLocked);
+  EXPECT_EQ(device_info.GetOsDeviceName(), u"Laptop");
+  platform->SetScreenStatus(api::DeviceInfo::ScreenStatus::kUnlocked);
+
+  EXPECT_EQ(changes, 1);
+  EXPECT_EQ(device_info.GetOsDeviceName(), u"Desktop");
+}
+
+}  // namespace
+}  // namespace nearby
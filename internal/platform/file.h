@@ -85,6 +85,10 @@ class OutputFile final {
   // down to the applicable transport layer.
   Exception Flush();
 
+  // Reserves storage for a file that will grow to |size| bytes. This is only
+  // a hint; writes work the same whether or not it succeeds.
+  Exception Preallocate(std::int64_t size);
+
   // Disallows further writes to the file and frees system resources,
   // associated with it.
   Exception Close();
@@ -67,6 +67,60 @@ constexpr auto kWifiHotspotConnectionIntervalMillis =
 constexpr auto kWifiHotspotConnectionTimeoutMillis =
     flags::Flag<int64_t>(kConfigPackage, "45415888", 10000);
 
+// Read outgoing files through a memory mapping instead of a std::fstream.
+// Files that are truncated while being sent fault instead of failing a read.
+constexpr auto kEnableMemoryMappedInputFile =
+    flags::Flag<bool>(kConfigPackage, "45415889", false);
+
+// Run multi-thread executors on per-thread task queues with work stealing
+// instead of the platform thread pool.
+constexpr auto kEnableWorkStealingExecutor =
+    flags::Flag<bool>(kConfigPackage, "45415890", false);
+
+// Run single-thread executors as strands on one pool shared by the process
+// instead of giving each of them a thread.
+constexpr auto kEnableThreadBudget =
+    flags::Flag<bool>(kConfigPackage, "45415891", false);
+
+// The number of threads shared by the strands when the thread budget is on.
+constexpr auto kThreadBudgetPoolSize =
+    flags::Flag<int64_t>(kConfigPackage, "45415892", 16);
+
+// Run credential storage operations on a storage thread of their own, merging
+// back-to-back saves of the same credentials into one write.
+constexpr auto kEnableCredentialStorageWriteBehind =
+    flags::Flag<bool>(kConfigPackage, "45415893", false);
+
+// Create the Fast Pair data encryptor, and with it the ECDH shared secret,
+// while the GATT connection is being set up rather than after it.
+constexpr auto kEnablePipelinedFastPairHandshake =
+    flags::Flag<bool>(kConfigPackage, "45415894", false);
+
+// Connect to the Fast Pair device of the discovery notification before the
+// user taps it, so that pairing starts with the GATT connection in place.
+constexpr auto kEnableFastPairHandshakeWarmUp =
+    flags::Flag<bool>(kConfigPackage, "45415895", false);
+
+// Store preferences in a binary append log, read through a memory-mapped file,
+// instead of the JSON document. Existing JSON preferences are migrated.
+constexpr auto kEnableBinaryPreferences =
+    flags::Flag<bool>(kConfigPackage, "45415896", false);
+
+// Read outgoing files with unbuffered, overlapped reads that run ahead of the
+// sender, when they aren't memory-mapped.
+constexpr auto kEnableOverlappedInputFile =
+    flags::Flag<bool>(kConfigPackage, "45415897", false);
+
+// Filter BLE advertisements by the scanned service UUIDs in the controller,
+// where supported, instead of waking up for every advertisement around.
+constexpr auto kEnableBleScanFilters =
+    flags::Flag<bool>(kConfigPackage, "45415898", false);
+
+// Collects BLE scan results for this long and reports each peripheral once per
+// batch. 0 reports every advertisement as it's received.
+constexpr auto kBleScanBatchIntervalMillis =
+    flags::Flag<int64_t>(kConfigPackage, "45415899", 0);
+
 }  // namespace nearby_platform_feature
 }  // namespace config_package_nearby
 }  // namespace platform
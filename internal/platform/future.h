@@ -15,12 +15,31 @@
 #ifndef PLATFORM_PUBLIC_FUTURE_H_
 #define PLATFORM_PUBLIC_FUTURE_H_
 
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
+#include "internal/platform/exception.h"
+#include "internal/platform/implementation/executor.h"
 #include "internal/platform/settable_future.h"
 
 namespace nearby {
 
+namespace future_internal {
+
+template <typename R>
+struct ExceptionOrValue;
+template <typename U>
+struct ExceptionOrValue<ExceptionOr<U>> {
+  using type = U;
+};
+
+}  // namespace future_internal
+
 template <typename T>
 class Future final {
  public:
@@ -40,9 +59,45 @@ class Future final {
   virtual ExceptionOr<T> Get(absl::Duration timeout) {
     return impl_->Get(timeout);
   }
+  // Calls `callback` with the outcome on `executor` once the future is
+  // complete. A null `executor` calls it on the thread completing the future,
+  // or right away if it is already complete, so it must be quick.
   void AddListener(FutureCallback callback, api::Executor* executor) {
     impl_->AddListener(std::move(callback), executor);
   }
+  void OnComplete(FutureCallback callback, api::Executor* executor = nullptr) {
+    AddListener(std::move(callback), executor);
+  }
+
+  // Returns a future completed with what `continuation` returns once it is
+  // called, on `executor` as for AddListener(), with the outcome of this one.
+  // `continuation` takes an ExceptionOr<T> and returns an ExceptionOr<U>, so
+  // it may recover from an exception as well as raise one. For example:
+  //
+  // Future<int> length = ReadFile().Then(
+  //     [](ExceptionOr<ByteArray> file) -> ExceptionOr<int> {
+  //       if (!file.ok()) return file.GetException();
+  //       return ExceptionOr<int>(file.result().size());
+  //     },
+  //     &executor);
+  template <typename F,
+            typename U = typename future_internal::ExceptionOrValue<
+                std::invoke_result_t<F&, ExceptionOr<T>>>::type>
+  Future<U> Then(F continuation, api::Executor* executor = nullptr) {
+    Future<U> next;
+    AddListener(
+        [next, continuation = std::move(continuation)](
+            ExceptionOr<T> result) mutable {
+          ExceptionOr<U> next_result = continuation(std::move(result));
+          if (next_result.ok()) {
+            next.Set(std::move(next_result).result());
+          } else {
+            next.SetException(next_result.GetException());
+          }
+        },
+        executor);
+    return next;
+  }
   bool IsSet() const { return impl_->IsSet(); }
 
  private:
@@ -59,6 +114,65 @@ class Future final {
   std::shared_ptr<SettableFuture<T>> impl_;
 };
 
+// Returns a future set to the values of all `futures`, in order, once they are
+// all set, or failing with the first exception any of them fails with.
+template <typename T>
+Future<std::vector<T>> WhenAll(std::vector<Future<T>> futures) {
+  struct State {
+    explicit State(size_t count) : values(count), remaining(count) {}
+    // Each future only sets its own value, and the last one to complete reads
+    // them all. Kept apart in optionals, as std::vector<bool> would pack
+    // values set on different threads into the same word.
+    std::vector<std::optional<T>> values;
+    std::atomic<size_t> remaining;
+  };
+  Future<std::vector<T>> all;
+  if (futures.empty()) {
+    all.Set({});
+    return all;
+  }
+  auto state = std::make_shared<State>(futures.size());
+  for (size_t i = 0; i < futures.size(); ++i) {
+    futures[i].AddListener(
+        [all, state, i](ExceptionOr<T> result) mutable {
+          if (!result.ok()) {
+            all.SetException(result.GetException());
+            return;
+          }
+          state->values[i] = std::move(result).result();
+          if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::vector<T> values;
+            values.reserve(state->values.size());
+            for (std::optional<T>& value : state->values) {
+              values.push_back(*std::move(value));
+            }
+            all.Set(std::move(values));
+          }
+        },
+        nullptr);
+  }
+  return all;
+}
+
+// Returns a future completed like the first of `futures` to complete, whether
+// it is set or fails. Never completes if `futures` is empty.
+template <typename T>
+Future<T> WhenAny(std::vector<Future<T>> futures) {
+  Future<T> any;
+  for (Future<T>& future : futures) {
+    future.AddListener(
+        [any](ExceptionOr<T> result) mutable {
+          if (result.ok()) {
+            any.Set(std::move(result).result());
+          } else {
+            any.SetException(result.GetException());
+          }
+        },
+        nullptr);
+  }
+  return any;
+}
+
 }  // namespace nearby
 
 #endif  // PLATFORM_PUBLIC_FUTURE_H_
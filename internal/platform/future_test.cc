@@ -14,6 +14,10 @@
 
 #include "internal/platform/future.h"
 
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
@@ -266,4 +270,105 @@ TEST(FutureTest, SetExceptionBeforeTimeout) {
   EXPECT_EQ(future.Get().exception(), Exception::kExecution);
 }
 
+TEST(FutureTest, ListenerWithoutExecutorMayGetTheFuture) {
+  Future<int> future;
+  int value = 0;
+  future.OnComplete(
+      [&](ExceptionOr<int> result) { value = future.Get().result(); });
+
+  future.Set(5);
+
+  EXPECT_EQ(value, 5);
+}
+
+TEST(FutureTest, ThenChainsContinuations) {
+  Future<int> future;
+  SingleThreadExecutor executor;
+  Future<std::string> text =
+      future
+          .Then([](ExceptionOr<int> result) -> ExceptionOr<int> {
+            if (!result.ok()) return result.GetException();
+            return ExceptionOr<int>(result.result() * 2);
+          })
+          .Then(
+              [](ExceptionOr<int> result) -> ExceptionOr<std::string> {
+                if (!result.ok()) return result.GetException();
+                return ExceptionOr<std::string>(
+                    std::to_string(result.result()));
+              },
+              &executor);
+
+  future.Set(21);
+
+  EXPECT_EQ(text.Get(absl::Seconds(1)).result(), "42");
+}
+
+TEST(FutureTest, ThenPropagatesAndRecoversFromExceptions) {
+  Future<int> future;
+  Future<int> doubled =
+      future.Then([](ExceptionOr<int> result) -> ExceptionOr<int> {
+        if (!result.ok()) return result.GetException();
+        return ExceptionOr<int>(result.result() * 2);
+      });
+  Future<int> recovered = doubled.Then(
+      [](ExceptionOr<int> result) { return ExceptionOr<int>(-1); });
+
+  future.SetException({Exception::kIo});
+
+  EXPECT_EQ(doubled.Get().exception(), Exception::kIo);
+  EXPECT_EQ(recovered.Get().result(), -1);
+}
+
+TEST(FutureTest, WhenAllSetsValuesInOrder) {
+  std::vector<Future<int>> futures(3);
+  Future<std::vector<int>> all = WhenAll(futures);
+
+  futures[2].Set(3);
+  futures[0].Set(1);
+  EXPECT_FALSE(all.IsSet());
+  futures[1].Set(2);
+
+  EXPECT_THAT(all.Get().result(), ::testing::ElementsAre(1, 2, 3));
+  EXPECT_TRUE(WhenAll(std::vector<Future<int>>()).IsSet());
+}
+
+TEST(FutureTest, WhenAllSetsBoolsFromManyThreads) {
+  constexpr int kFutures = 64;
+  std::vector<Future<bool>> futures(kFutures);
+  Future<std::vector<bool>> all = WhenAll(futures);
+
+  {
+    std::vector<SingleThreadExecutor> executors(kFutures);
+    for (int i = 0; i < kFutures; ++i) {
+      executors[i].Execute(
+          [future = futures[i], i]() mutable { future.Set(i % 2 == 0); });
+    }
+  }
+
+  ExceptionOr<std::vector<bool>> values = all.Get(absl::Seconds(10));
+  ASSERT_TRUE(values.ok());
+  for (int i = 0; i < kFutures; ++i) {
+    EXPECT_EQ(values.result()[i], i % 2 == 0);
+  }
+}
+
+TEST(FutureTest, WhenAllFailsWithFirstException) {
+  std::vector<Future<int>> futures(2);
+  Future<std::vector<int>> all = WhenAll(futures);
+
+  futures[1].SetException({Exception::kTimeout});
+
+  EXPECT_EQ(all.Get().exception(), Exception::kTimeout);
+}
+
+TEST(FutureTest, WhenAnyCompletesWithFirstFuture) {
+  std::vector<Future<int>> futures(2);
+  Future<int> any = WhenAny(futures);
+
+  futures[1].Set(2);
+  futures[0].SetException({Exception::kIo});
+
+  EXPECT_EQ(any.Get().result(), 2);
+}
+
 }  // namespace nearby
@@ -44,6 +44,21 @@
  */
 - (nullable NSData *)readMaxLength:(NSUInteger)length error:(NSError **_Nullable)error;
 
+/**
+ * Reads the requested amount of bytes from the connection, as the regions they were received in.
+ *
+ * Blocks execution until the bytes have been read or an error occurs. The socket keeps several
+ * receives outstanding on the connection, so that data keeps arriving while the previous bytes are
+ * being processed. The returned data shares the received regions instead of copying them.
+ *
+ * @param length The number of bytes to read.
+ * @param[out] error Error that will be populated on failure. A read may return non-nil data along
+ *                   with an error. This normally happens if the data read is shorter than the
+ *                   requested length. Empty data is returned at the end of the stream.
+ */
+- (nullable dispatch_data_t)readDispatchDataMaxLength:(NSUInteger)length
+                                                error:(NSError **_Nullable)error;
+
 /**
  * Writes the given data to the connection.
  *
@@ -25,53 +25,120 @@
 
 @end
 
+// Size of each receive on the connection.
+static const size_t kReceiveChunkSize = 64 * 1024;
+
+// Receives kept outstanding on the connection, so that the next chunk is already on its way while
+// the previous one is being handed to the reader.
+static const int kMaxPendingReceives = 4;
+
+// Received bytes are buffered up to this size before new receives wait for the reader.
+static const size_t kMaxBufferedSize = 4 * kMaxPendingReceives * kReceiveChunkSize;
+
 @implementation GNCWiFiLANSocket {
+  NSCondition *_receiveCondition;
+  // Received data the reader hasn't taken yet. A chain of the received regions, never copied.
+  dispatch_data_t _receivedData;
+  NSError *_receiveError;
+  BOOL _receiveComplete;
+  int _pendingReceives;
 }
 
 - (instancetype)initWithConnection:(nw_connection_t)connection {
   self = [super init];
   if (self) {
     _connection = connection;
+    _receiveCondition = [[NSCondition alloc] init];
+    _receivedData = dispatch_data_empty;
   }
   return self;
 }
 
 - (NSData *)readMaxLength:(NSUInteger)length error:(NSError **)error {
-  __strong nw_connection_t connection = self.connection;
-  if (connection == nil) {
-    return nil;
-  }
-
-  NSCondition *condition = [[NSCondition alloc] init];
-  [condition lock];
-
-  __block NSData *blockResult = nil;
-  __block NSError *blockError = nil;
-
-  nw_connection_receive(
-      connection, length, length,
-      ^(dispatch_data_t content, nw_content_context_t context, bool is_complete, nw_error_t error) {
-        [condition lock];
-        if (error != nil) {
-          blockError = (__bridge_transfer NSError *)nw_error_copy_cf_error(error);
-        }
+  dispatch_data_t data = [self readDispatchDataMaxLength:length error:error];
 #if __LP64__
-        // This cast is only safe in a 64-bit runtime.
-        blockResult = [(NSData *)content copy];
+  // This cast is only safe in a 64-bit runtime.
+  return (NSData *)data;
 #else
-        blockResult = nil;
+  return nil;
 #endif
-        [condition signal];
-        [condition unlock];
-      });
+}
 
-  [condition wait];
-  [condition unlock];
+- (dispatch_data_t)readDispatchDataMaxLength:(NSUInteger)length error:(NSError **)error {
+  [_receiveCondition lock];
+  while (dispatch_data_get_size(_receivedData) < length && _receiveError == nil &&
+         !_receiveComplete) {
+    [self scheduleReceivesLockedForLength:length];
+    if (_pendingReceives == 0) {
+      // The connection is closed.
+      break;
+    }
+    [_receiveCondition wait];
+  }
+
+  size_t available = dispatch_data_get_size(_receivedData);
+  size_t resultLength = MIN(available, length);
+  dispatch_data_t result = nil;
+  if (resultLength > 0) {
+    result = dispatch_data_create_subrange(_receivedData, 0, resultLength);
+    _receivedData = dispatch_data_create_subrange(_receivedData, resultLength,
+                                                  available - resultLength);
+  }
+  NSError *blockError = resultLength < length ? _receiveError : nil;
+  BOOL isComplete = _receiveComplete;
+  // Room has been made for the next receives.
+  [self scheduleReceivesLockedForLength:0];
+  [_receiveCondition unlock];
 
   if (error != nil) {
     *error = blockError;
   }
-  return blockResult;
+  if (result == nil && !isComplete) {
+    return nil;
+  }
+  return result ?: dispatch_data_empty;
+}
+
+// Schedules receives until enough are outstanding to fill the buffer, or `length` bytes, whichever
+// is larger.
+- (void)scheduleReceivesLockedForLength:(NSUInteger)length {
+  __strong nw_connection_t connection = self.connection;
+  if (connection == nil) {
+    return;
+  }
+  size_t maxBufferedSize = MAX(kMaxBufferedSize, length);
+  while (_pendingReceives < kMaxPendingReceives && _receiveError == nil && !_receiveComplete &&
+         dispatch_data_get_size(_receivedData) + _pendingReceives * kReceiveChunkSize <
+             maxBufferedSize) {
+    _pendingReceives++;
+    __weak __typeof__(self) weakSelf = self;
+    // The receives complete in the order they are scheduled.
+    nw_connection_receive(
+        connection, 1, kReceiveChunkSize,
+        ^(dispatch_data_t content, nw_content_context_t context, bool is_complete,
+          nw_error_t error) {
+          [weakSelf didReceiveContent:content isComplete:is_complete error:error];
+        });
+  }
+}
+
+- (void)didReceiveContent:(dispatch_data_t)content
+               isComplete:(bool)isComplete
+                    error:(nw_error_t)error {
+  [_receiveCondition lock];
+  _pendingReceives--;
+  if (content != nil) {
+    _receivedData = dispatch_data_create_concat(_receivedData, content);
+  }
+  if (error != nil) {
+    if (_receiveError == nil) {
+      _receiveError = (__bridge_transfer NSError *)nw_error_copy_cf_error(error);
+    }
+  } else if (isComplete) {
+    _receiveComplete = YES;
+  }
+  [_receiveCondition broadcast];
+  [_receiveCondition unlock];
 }
 
 - (BOOL)write:(NSData *)data error:(NSError **)error {
@@ -123,7 +190,10 @@
     return;
   }
   nw_connection_cancel(connection);
+  [_receiveCondition lock];
   _connection = nil;
+  [_receiveCondition broadcast];
+  [_receiveCondition unlock];
 }
 
 @end
@@ -16,6 +16,7 @@
 #define PLATFORM_IMPL_APPLE_MULTI_THREAD_EXECUTOR_H_
 
 #import "internal/platform/implementation/apple/scheduled_executor.h"
+#include "internal/platform/implementation/executor.h"
 #include "internal/platform/implementation/submittable_executor.h"
 #import "internal/platform/runnable.h"
 
@@ -24,7 +25,8 @@ namespace apple {
 
 class MultiThreadExecutor : public api::SubmittableExecutor {
  public:
-  explicit MultiThreadExecutor(int max_concurrency);
+  explicit MultiThreadExecutor(int max_concurrency,
+                               api::ExecutorQos qos = api::ExecutorQos::kDefault);
   ~MultiThreadExecutor() override = default;
 
   MultiThreadExecutor(const MultiThreadExecutor&) = delete;
@@ -20,8 +20,8 @@
 namespace nearby {
 namespace apple {
 
-MultiThreadExecutor::MultiThreadExecutor(int max_concurrency) {
-  scheduled_executor_ = std::make_unique<ScheduledExecutor>(max_concurrency);
+MultiThreadExecutor::MultiThreadExecutor(int max_concurrency, api::ExecutorQos qos) {
+  scheduled_executor_ = std::make_unique<ScheduledExecutor>(max_concurrency, qos);
 }
 
 void MultiThreadExecutor::Shutdown() { scheduled_executor_->Shutdown(); }
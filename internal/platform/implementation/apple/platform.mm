@@ -20,6 +20,8 @@
 #include <memory>
 
 #include "absl/strings/string_view.h"
+#include "internal/flags/nearby_flags.h"
+#include "internal/platform/flags/nearby_platform_feature_flags.h"
 #include "internal/platform/implementation/apple/atomic_boolean.h"
 #include "internal/platform/implementation/apple/atomic_uint32.h"
 #include "internal/platform/implementation/apple/ble.h"
@@ -37,6 +39,7 @@
 #include "internal/platform/implementation/apple/wifi_lan.h"
 #include "internal/platform/implementation/mutex.h"
 #include "internal/platform/implementation/shared/file.h"
+#include "internal/platform/implementation/shared/mapped_file.h"
 #include "internal/platform/payload_id.h"
 
 namespace nearby {
@@ -115,6 +118,11 @@ std::unique_ptr<InputFile> ImplementationPlatform::CreateInputFile(PayloadId pay
 
 std::unique_ptr<InputFile> ImplementationPlatform::CreateInputFile(const std::string& file_path,
                                                                    size_t size) {
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          platform::config_package_nearby::nearby_platform_feature::kEnableMemoryMappedInputFile)) {
+    std::unique_ptr<InputFile> mapped_file = shared::MappedInputFile::Create(file_path);
+    if (mapped_file) return mapped_file;
+  }
   return shared::IOFile::CreateInputFile(file_path, size);
 }
 
@@ -133,17 +141,19 @@ std::unique_ptr<LogMessage> ImplementationPlatform::CreateLogMessage(
 }
 
 // Java-like Executors
-std::unique_ptr<SubmittableExecutor> ImplementationPlatform::CreateSingleThreadExecutor() {
-  return std::make_unique<apple::SingleThreadExecutor>();
+std::unique_ptr<SubmittableExecutor> ImplementationPlatform::CreateSingleThreadExecutor(
+    ExecutorQos qos) {
+  return std::make_unique<apple::SingleThreadExecutor>(qos);
 }
 
 std::unique_ptr<SubmittableExecutor> ImplementationPlatform::CreateMultiThreadExecutor(
-    int max_concurrency) {
-  return std::make_unique<apple::MultiThreadExecutor>(max_concurrency);
+    int max_concurrency, ExecutorQos qos) {
+  return std::make_unique<apple::MultiThreadExecutor>(max_concurrency, qos);
 }
 
-std::unique_ptr<ScheduledExecutor> ImplementationPlatform::CreateScheduledExecutor() {
-  return std::make_unique<apple::ScheduledExecutor>();
+std::unique_ptr<ScheduledExecutor> ImplementationPlatform::CreateScheduledExecutor(
+    ExecutorQos qos) {
+  return std::make_unique<apple::ScheduledExecutor>(1, qos);
 }
 
 // Mediums
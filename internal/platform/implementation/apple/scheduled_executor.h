@@ -19,6 +19,7 @@
 
 #include <memory>
 
+#include "internal/platform/implementation/executor.h"
 #include "internal/platform/implementation/scheduled_executor.h"
 #include "internal/platform/runnable.h"
 
@@ -29,6 +30,8 @@
  */
 @interface GNCOperationQueueImpl : NSObject
 @property(nonatomic) NSOperationQueue* queue;
+// The global queue delayed operations wait on, of the same quality of service as |queue|.
+@property(nonatomic) dispatch_queue_t timerQueue;
 @property(atomic) BOOL shuttingDown;
 @end
 
@@ -40,7 +43,8 @@ class ScheduledExecutor : public api::ScheduledExecutor {
  public:
   // The max_concurrency = 1 for default constructor.
   ScheduledExecutor();
-  explicit ScheduledExecutor(int max_concurrency);
+  explicit ScheduledExecutor(int max_concurrency,
+                             api::ExecutorQos qos = api::ExecutorQos::kDefault);
   ~ScheduledExecutor() override;
 
   ScheduledExecutor(const ScheduledExecutor&) = delete;
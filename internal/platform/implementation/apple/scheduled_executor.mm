@@ -45,10 +45,17 @@
 
 @implementation GNCOperationQueueImpl
 
-+ (instancetype)implWithMaxConcurrency:(int)maxConcurrency {
++ (instancetype)implWithMaxConcurrency:(int)maxConcurrency
+                     qualityOfService:(NSQualityOfService)qualityOfService {
   GNCOperationQueueImpl *impl = [[GNCOperationQueueImpl alloc] init];
   impl.queue = [[NSOperationQueue alloc] init];
   impl.queue.maxConcurrentOperationCount = maxConcurrency;
+  impl.queue.qualityOfService = qualityOfService;
+  // The other NSQualityOfService values are the same as their qos_class_t.
+  qos_class_t qosClass = qualityOfService == NSQualityOfServiceDefault
+                             ? QOS_CLASS_DEFAULT
+                             : (qos_class_t)qualityOfService;
+  impl.timerQueue = dispatch_get_global_queue(qosClass, 0);
   return impl;
 }
 
@@ -59,6 +66,21 @@ namespace apple {
 
 static const std::int64_t kExecutorShutdownDefaultTimeout = 500;  // 0.5 seconds
 
+// Payload transfers run user-initiated, so that the OS doesn't throttle them behind discovery and
+// analytics work, e.g. while the screen is off.
+static NSQualityOfService QualityOfServiceFromQos(api::ExecutorQos qos) {
+  switch (qos) {
+    case api::ExecutorQos::kUserInitiated:
+      return NSQualityOfServiceUserInitiated;
+    case api::ExecutorQos::kUtility:
+      return NSQualityOfServiceUtility;
+    case api::ExecutorQos::kBackground:
+      return NSQualityOfServiceBackground;
+    case api::ExecutorQos::kDefault:
+      return NSQualityOfServiceDefault;
+  }
+}
+
 // This Cancelable references a Runnable and a cancel method that sets its canceled boolean to true.
 class CancelableForRunnable : public api::Cancelable {
  public:
@@ -78,10 +100,11 @@ class CancelableForRunnable : public api::Cancelable {
   GNCRunnableWrapper *runnable_;
 };
 
-ScheduledExecutor::ScheduledExecutor() { impl_ = [GNCOperationQueueImpl implWithMaxConcurrency:1]; }
+ScheduledExecutor::ScheduledExecutor() : ScheduledExecutor(1) {}
 
-ScheduledExecutor::ScheduledExecutor(int max_concurrency) {
-  impl_ = [GNCOperationQueueImpl implWithMaxConcurrency:max_concurrency];
+ScheduledExecutor::ScheduledExecutor(int max_concurrency, api::ExecutorQos qos) {
+  impl_ = [GNCOperationQueueImpl implWithMaxConcurrency:max_concurrency
+                                       qualityOfService:QualityOfServiceFromQos(qos)];
 }
 
 ScheduledExecutor::~ScheduledExecutor() { impl_ = nil; }
@@ -98,7 +121,7 @@ std::shared_ptr<api::Cancelable> ScheduledExecutor::Schedule(Runnable &&runnable
   GNCOperationQueueImpl *impl = impl_;  // don't capture |this|
   dispatch_after(
       dispatch_time(DISPATCH_TIME_NOW, absl::ToInt64Milliseconds(duration) * NSEC_PER_MSEC),
-      dispatch_get_global_queue(DISPATCH_TARGET_QUEUE_DEFAULT, 0), ^{
+      impl.timerQueue, ^{
         [impl.queue addOperationWithBlock:^{
           // Execute the runnable only if the executor is not shutting down, and the runnable isn't
           // canceled.
@@ -22,7 +22,8 @@ namespace apple {
 
 class SingleThreadExecutor : public MultiThreadExecutor {
  public:
-  SingleThreadExecutor() : MultiThreadExecutor(1) {}
+  explicit SingleThreadExecutor(api::ExecutorQos qos = api::ExecutorQos::kDefault)
+      : MultiThreadExecutor(1, qos) {}
   ~SingleThreadExecutor() override = default;
 };
 
@@ -34,12 +34,22 @@ WifiLanInputStream::WifiLanInputStream(GNCWiFiLANSocket* socket) : socket_(socke
 
 ExceptionOr<ByteArray> WifiLanInputStream::Read(std::int64_t size) {
   NSError* error = nil;
-  NSData* data = [socket_ readMaxLength:size error:&error];
+  dispatch_data_t data = [socket_ readDispatchDataMaxLength:size error:&error];
   if (data == nil) {
     GTMLoggerError(@"Error reading socket: %@", error);
     return {Exception::kIo};
   }
-  return ExceptionOr<ByteArray>{ByteArray((const char*)data.bytes, data.length)};
+  // Copy the received regions straight into the buffer backing the ByteArray, the only copy on the
+  // way from the connection to the core.
+  std::string bytes;
+  bytes.reserve(dispatch_data_get_size(data));
+  std::string* output = &bytes;
+  dispatch_data_apply(data,
+                      ^bool(dispatch_data_t region, size_t offset, const void* buffer, size_t size) {
+                        output->append(static_cast<const char*>(buffer), size);
+                        return true;
+                      });
+  return ExceptionOr<ByteArray>{ByteArray(std::move(bytes))};
 }
 
 Exception WifiLanInputStream::Close() {
@@ -372,6 +372,10 @@ class BleServerSocket {
 
   // Returns Exception::kIo on error, Exception::kSuccess otherwise.
   virtual Exception Close() = 0;
+
+  // Returns the PSM of the L2CAP channel this socket listens on, or 0 when it
+  // is not an L2CAP server socket.
+  virtual int GetPsm() const { return 0; }
 };
 
 // The main BLE medium used inside of Nearby. This serves as the entry point
@@ -505,6 +509,31 @@ class BleMedium {
       const std::string& service_id, TxPowerLevel tx_power_level,
       BlePeripheral& peripheral, CancellationFlag* cancellation_flag) = 0;
 
+  // https://developer.android.com/reference/android/bluetooth/BluetoothAdapter#listenUsingInsecureL2capChannel()
+  //
+  // Opens a server socket on an L2CAP connection-oriented channel for the
+  // service ID, at a PSM picked by the platform and reported by GetPsm().
+  //
+  // On success, returns a new BleServerSocket.
+  // On error, or if the platform has no L2CAP channels, returns nullptr.
+  virtual std::unique_ptr<BleServerSocket> OpenL2capServerSocket(
+      const std::string& service_id) {
+    return nullptr;
+  }
+
+  // https://developer.android.com/reference/android/bluetooth/BluetoothDevice#createInsecureL2capChannel(int)
+  //
+  // Connects to the L2CAP connection-oriented channel a BLE peripheral
+  // listens on at `psm`.
+  //
+  // On success, returns a new BleSocket.
+  // On error, or if the platform has no L2CAP channels, returns nullptr.
+  virtual std::unique_ptr<BleSocket> ConnectOverL2cap(
+      int psm, const std::string& service_id, TxPowerLevel tx_power_level,
+      BlePeripheral& peripheral, CancellationFlag* cancellation_flag) {
+    return nullptr;
+  }
+
   // Requests if support extended advertisement.
   virtual bool IsExtendedAdvertisementsAvailable() = 0;
 
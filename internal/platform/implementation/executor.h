@@ -22,6 +22,18 @@ namespace api {
 
 int GetCurrentTid();
 
+// The kind of work an executor runs, for platforms that schedule threads by
+// quality of service. Platforms without such classes ignore it.
+enum class ExecutorQos {
+  kDefault,
+  // Work the user is waiting for, e.g. sending and receiving payloads.
+  kUserInitiated,
+  // Long running work the user isn't watching, e.g. discovery.
+  kUtility,
+  // Work the user doesn't see, e.g. analytics.
+  kBackground,
+};
+
 // This abstract class is the superclass of all classes representing an
 // Executor.
 class Executor {
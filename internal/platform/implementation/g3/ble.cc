@@ -37,6 +37,7 @@ void BleSocket::Connect(BleSocket& other) {
   absl::MutexLock lock(&mutex_);
   remote_socket_ = &other;
   input_ = other.output_;
+  link_.Connect(location::nearby::proto::connections::Medium::BLE);
 }
 
 InputStream& BleSocket::GetInputStream() {
@@ -76,6 +77,7 @@ BlePeripheral* BleSocket::GetRemotePeripheral() {
 void BleSocket::DoClose() {
   if (!closed_) {
     remote_socket_ = nullptr;
+    link_.Close();
     output_->GetOutputStream().Close();
     output_->GetInputStream().Close();
     if (IsConnectedLocked()) {
@@ -95,7 +97,7 @@ InputStream& BleSocket::GetLocalInputStream() {
 
 OutputStream& BleSocket::GetLocalOutputStream() {
   absl::MutexLock lock(&mutex_);
-  return output_->GetOutputStream();
+  return link_.GetOutputStream();
 }
 
 std::unique_ptr<api::BleSocket> BleServerSocket::Accept(
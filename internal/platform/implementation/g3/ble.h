@@ -28,6 +28,7 @@
 #include "internal/platform/implementation/g3/bluetooth_classic.h"
 #include "internal/platform/implementation/g3/multi_thread_executor.h"
 #include "internal/platform/implementation/g3/pipe.h"
+#include "internal/platform/implementation/g3/simulated_link.h"
 #include "internal/platform/input_stream.h"
 #include "internal/platform/output_stream.h"
 
@@ -90,6 +91,7 @@ class BleSocket : public api::BleSocket {
   // local socket comes from the peer socket, after connection.
   std::shared_ptr<Pipe> output_{new Pipe};
   std::shared_ptr<Pipe> input_;
+  SimulatedSocketLink link_ ABSL_GUARDED_BY(mutex_){output_};
   mutable absl::Mutex mutex_;
   BlePeripheral* peripheral_;
   BleSocket* remote_socket_ ABSL_GUARDED_BY(mutex_) = nullptr;
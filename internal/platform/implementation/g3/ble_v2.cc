@@ -78,6 +78,7 @@ void BleV2Socket::Connect(BleV2Socket& other) {
   absl::MutexLock lock(&mutex_);
   remote_socket_ = &other;
   input_ = other.output_;
+  link_.Connect(location::nearby::proto::connections::Medium::BLE);
 }
 
 InputStream& BleV2Socket::GetInputStream() {
@@ -127,6 +128,7 @@ BleV2Peripheral* BleV2Socket::GetRemotePeripheral() {
 void BleV2Socket::DoClose() {
   if (!closed_) {
     remote_socket_ = nullptr;
+    link_.Close();
     output_->GetOutputStream().Close();
     output_->GetInputStream().Close();
     input_->GetOutputStream().Close();
@@ -144,7 +146,7 @@ InputStream& BleV2Socket::GetLocalInputStream() {
 
 OutputStream& BleV2Socket::GetLocalOutputStream() {
   absl::MutexLock lock(&mutex_);
-  return output_->GetOutputStream();
+  return link_.GetOutputStream();
 }
 
 std::unique_ptr<api::ble_v2::BleSocket> BleV2ServerSocket::Accept() {
@@ -799,17 +801,13 @@ std::unique_ptr<api::ble_v2::BleSocket> BleV2Medium::Connect(
                     << ", peripheral=" << &GetPeripheral()
                     << ", service_id=" << service_id;
   // First, find an instance of remote medium, that exposed this peripheral.
-  auto& remote_adapter =
-      static_cast<BleV2Peripheral&>(remote_peripheral).GetAdapter();
-  auto* remote_medium =
-      static_cast<BleV2Medium*>(remote_adapter.GetBleV2Medium());
+  auto* remote_medium = GetRemoteMedium(remote_peripheral);
   if (!remote_medium) {
     return nullptr;
   }
 
   BleV2ServerSocket* remote_server_socket = nullptr;
   NEARBY_LOGS(INFO) << "G3 Ble Connect [peer]: medium=" << remote_medium
-                    << ", adapter=" << &remote_adapter
                     << ", peripheral=" << &remote_peripheral
                     << ", service_id=" << service_id;
   // Then, find our server socket context in this medium.
@@ -832,7 +830,71 @@ std::unique_ptr<api::ble_v2::BleSocket> BleV2Medium::Connect(
                        << service_id;
     return nullptr;
   }
+  return ConnectToServerSocket(remote_server_socket, cancellation_flag);
+}
+
+std::unique_ptr<api::ble_v2::BleServerSocket>
+BleV2Medium::OpenL2capServerSocket(const std::string& service_id) {
+  int psm;
+  {
+    absl::MutexLock lock(&mutex_);
+    psm = next_psm_++;
+  }
+  auto server_socket = std::make_unique<BleV2ServerSocket>(&GetAdapter(), psm);
+  server_socket->SetCloseNotifier([this, psm]() {
+    absl::MutexLock lock(&mutex_);
+    l2cap_server_sockets_.erase(psm);
+  });
+  NEARBY_LOGS(INFO) << "G3 Ble Adding L2CAP server socket: medium=" << this
+                    << ", service_id=" << service_id << ", psm=" << psm;
+  absl::MutexLock lock(&mutex_);
+  l2cap_server_sockets_.insert({psm, server_socket.get()});
+  return server_socket;
+}
+
+std::unique_ptr<api::ble_v2::BleSocket> BleV2Medium::ConnectOverL2cap(
+    int psm, const std::string& service_id, TxPowerLevel tx_power_level,
+    api::ble_v2::BlePeripheral& remote_peripheral,
+    CancellationFlag* cancellation_flag) {
+  NEARBY_LOGS(INFO) << "G3 Ble ConnectOverL2cap: medium=" << this
+                    << ", service_id=" << service_id << ", psm=" << psm;
+  auto* remote_medium = GetRemoteMedium(remote_peripheral);
+  if (!remote_medium) {
+    return nullptr;
+  }
+
+  BleV2ServerSocket* remote_server_socket = nullptr;
+  {
+    absl::MutexLock medium_lock(&remote_medium->mutex_);
+    auto item = remote_medium->l2cap_server_sockets_.find(psm);
+    remote_server_socket = item != remote_medium->l2cap_server_sockets_.end()
+                               ? item->second
+                               : nullptr;
+    if (remote_server_socket == nullptr) {
+      NEARBY_LOGS(ERROR)
+          << "G3 Ble Failed to find L2CAP server socket: psm=" << psm;
+      return nullptr;
+    }
+  }
+
+  if (cancellation_flag->Cancelled()) {
+    NEARBY_LOGS(ERROR) << "G3 BLE ConnectOverL2cap: Has been cancelled: psm="
+                       << psm;
+    return nullptr;
+  }
+  return ConnectToServerSocket(remote_server_socket, cancellation_flag);
+}
 
+BleV2Medium* BleV2Medium::GetRemoteMedium(
+    api::ble_v2::BlePeripheral& remote_peripheral) {
+  auto& remote_adapter =
+      static_cast<BleV2Peripheral&>(remote_peripheral).GetAdapter();
+  return static_cast<BleV2Medium*>(remote_adapter.GetBleV2Medium());
+}
+
+std::unique_ptr<api::ble_v2::BleSocket> BleV2Medium::ConnectToServerSocket(
+    BleV2ServerSocket* remote_server_socket,
+    CancellationFlag* cancellation_flag) {
   CancellationFlagListener listener(
       cancellation_flag, [&remote_server_socket]() {
         NEARBY_LOGS(INFO) << "G3 Ble Cancel Connect.";
@@ -845,8 +907,7 @@ std::unique_ptr<api::ble_v2::BleSocket> BleV2Medium::Connect(
   // Finally, Request to connect to this socket.
   if (!remote_server_socket->Connect(*socket)) {
     NEARBY_LOGS(ERROR) << "G3 Ble Failed to connect to existing Ble "
-                          "Server socket: service_id="
-                       << service_id;
+                          "Server socket";
     return nullptr;
   }
   NEARBY_LOGS(INFO) << "G3 Ble Connect to socket=" << socket.get();
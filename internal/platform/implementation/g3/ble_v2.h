@@ -30,6 +30,7 @@
 #include "internal/platform/implementation/ble_v2.h"
 #include "internal/platform/implementation/g3/bluetooth_adapter.h"
 #include "internal/platform/implementation/g3/pipe.h"
+#include "internal/platform/implementation/g3/simulated_link.h"
 #include "internal/platform/medium_environment.h"
 #include "internal/platform/prng.h"
 #include "internal/platform/uuid.h"
@@ -107,6 +108,7 @@ class BleV2Socket : public api::ble_v2::BleSocket {
   // local socket comes from the peer socket, after connection.
   std::shared_ptr<Pipe> output_{new Pipe};
   std::shared_ptr<Pipe> input_;
+  SimulatedSocketLink link_ ABSL_GUARDED_BY(mutex_){output_};
   mutable absl::Mutex mutex_;
   BluetoothAdapter* adapter_ = nullptr;  // Our Adapter. Read only.
   BleV2Socket* remote_socket_ ABSL_GUARDED_BY(mutex_) = nullptr;
@@ -115,7 +117,9 @@ class BleV2Socket : public api::ble_v2::BleSocket {
 
 class BleV2ServerSocket : public api::ble_v2::BleServerSocket {
  public:
-  explicit BleV2ServerSocket(BluetoothAdapter* adapter) : adapter_(adapter) {}
+  // A |psm| other than 0 makes this an L2CAP server socket.
+  explicit BleV2ServerSocket(BluetoothAdapter* adapter, int psm = 0)
+      : adapter_(adapter), psm_(psm) {}
   BleV2ServerSocket(const BleV2ServerSocket&) = default;
   BleV2ServerSocket& operator=(const BleV2ServerSocket&) = default;
   BleV2ServerSocket(BleV2ServerSocket&&) = default;
@@ -154,12 +158,15 @@ class BleV2ServerSocket : public api::ble_v2::BleServerSocket {
   // Calls close_notifier if it was previously set, and marks socket as closed.
   Exception Close() override ABSL_LOCKS_EXCLUDED(mutex_);
 
+  int GetPsm() const override { return psm_; }
+
  private:
   Exception DoClose() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   mutable absl::Mutex mutex_;
   absl::CondVar cond_;
   BluetoothAdapter* adapter_ = nullptr;  // Our Adapter. Read only.
+  int psm_ = 0;                          // Read only.
   absl::flat_hash_set<BleV2Socket*> pending_sockets_ ABSL_GUARDED_BY(mutex_);
   absl::AnyInvocable<void()> close_notifier_ ABSL_GUARDED_BY(mutex_);
   bool closed_ ABSL_GUARDED_BY(mutex_) = false;
@@ -216,6 +223,23 @@ class BleV2Medium : public api::ble_v2::BleMedium {
       api::ble_v2::BlePeripheral& remote_peripheral,
       CancellationFlag* cancellation_flag) override ABSL_LOCKS_EXCLUDED(mutex_);
 
+  // Opens an L2CAP server socket at the next free PSM.
+  //
+  // On success, returns a new BleServerSocket.
+  // On error, returns nullptr.
+  std::unique_ptr<api::ble_v2::BleServerSocket> OpenL2capServerSocket(
+      const std::string& service_id) override ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Connects to the L2CAP server socket of a remote Ble peripheral.
+  //
+  // On success, returns a new BleSocket.
+  // On error, returns nullptr.
+  std::unique_ptr<api::ble_v2::BleSocket> ConnectOverL2cap(
+      int psm, const std::string& service_id,
+      api::ble_v2::TxPowerLevel tx_power_level,
+      api::ble_v2::BlePeripheral& remote_peripheral,
+      CancellationFlag* cancellation_flag) override ABSL_LOCKS_EXCLUDED(mutex_);
+
   bool IsExtendedAdvertisementsAvailable() override;
 
   BluetoothAdapter& GetAdapter() { return *adapter_; }
@@ -346,7 +370,16 @@ class BleV2Medium : public api::ble_v2::BleMedium {
     api::ble_v2::ClientGattConnectionCallback callback_;
   };
 
+  // First PSM of the dynamic range for LE L2CAP channels.
+  static constexpr int kFirstDynamicPsm = 0x80;
+
   bool IsStopped(Borrowable<api::ble_v2::GattServer*>* server);
+  // Returns the medium that exposed |remote_peripheral|, or nullptr.
+  static BleV2Medium* GetRemoteMedium(
+      api::ble_v2::BlePeripheral& remote_peripheral);
+  std::unique_ptr<api::ble_v2::BleSocket> ConnectToServerSocket(
+      BleV2ServerSocket* remote_server_socket,
+      CancellationFlag* cancellation_flag) ABSL_LOCKS_EXCLUDED(mutex_);
   absl::Mutex mutex_;
   BluetoothAdapter* adapter_;  // Our device adapter; read-only.
   BleV2Peripheral peripheral_{adapter_};
@@ -355,6 +388,9 @@ class BleV2Medium : public api::ble_v2::BleMedium {
       remote_peripherals_ ABSL_GUARDED_BY(mutex_);
   absl::flat_hash_map<std::string, BleV2ServerSocket*> server_sockets_
       ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<int, BleV2ServerSocket*> l2cap_server_sockets_
+      ABSL_GUARDED_BY(mutex_);
+  int next_psm_ ABSL_GUARDED_BY(mutex_) = kFirstDynamicPsm;
   absl::flat_hash_set<std::pair<Uuid, std::uint32_t>>
       scanning_internal_session_ids_ ABSL_GUARDED_BY(mutex_);
   // TODO(edwinwu): Adds extended advertisement for testing.
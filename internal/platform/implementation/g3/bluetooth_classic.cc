@@ -38,6 +38,7 @@ void BluetoothSocket::Connect(BluetoothSocket& other) {
   absl::MutexLock lock(&mutex_);
   remote_socket_ = &other;
   input_ = other.output_;
+  link_.Connect(location::nearby::proto::connections::Medium::BLUETOOTH);
 }
 
 bool BluetoothSocket::IsConnected() const {
@@ -72,7 +73,7 @@ InputStream& BluetoothSocket::GetLocalInputStream() {
 
 OutputStream& BluetoothSocket::GetLocalOutputStream() {
   absl::MutexLock lock(&mutex_);
-  return output_->GetOutputStream();
+  return link_.GetOutputStream();
 }
 
 Exception BluetoothSocket::Close() {
@@ -84,6 +85,7 @@ Exception BluetoothSocket::Close() {
 void BluetoothSocket::DoClose() {
   if (!closed_) {
     remote_socket_ = nullptr;
+    link_.Close();
     output_->GetOutputStream().Close();
     output_->GetInputStream().Close();
     input_->GetOutputStream().Close();
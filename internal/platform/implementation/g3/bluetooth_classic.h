@@ -27,6 +27,7 @@
 #include "internal/platform/implementation/bluetooth_classic.h"
 #include "internal/platform/implementation/g3/bluetooth_adapter.h"
 #include "internal/platform/implementation/g3/pipe.h"
+#include "internal/platform/implementation/g3/simulated_link.h"
 #include "internal/platform/input_stream.h"
 #include "internal/platform/listeners.h"
 #include "internal/platform/output_stream.h"
@@ -111,6 +112,7 @@ class BluetoothSocket : public api::BluetoothSocket {
   // local socket comes from the peer socket, after connection.
   std::shared_ptr<Pipe> output_{new Pipe};
   std::shared_ptr<Pipe> input_;
+  SimulatedSocketLink link_ ABSL_GUARDED_BY(mutex_){output_};
   mutable absl::Mutex mutex_;
   BluetoothAdapter* adapter_ = nullptr;  // Our Adapter. Read only.
   BluetoothSocket* remote_socket_ ABSL_GUARDED_BY(mutex_) = nullptr;
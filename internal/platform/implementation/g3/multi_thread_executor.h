@@ -16,10 +16,14 @@
 #define PLATFORM_IMPL_G3_MULTI_THREAD_EXECUTOR_H_
 
 #include <atomic>
+#include <optional>
+#include <utility>
 
 #include "absl/time/clock.h"
 #include "internal/platform/implementation/submittable_executor.h"
 #include "internal/platform/implementation/shared/count_down_latch.h"
+#include "internal/platform/medium_environment.h"
+#include "internal/platform/runnable.h"
 #include "nisaba/port/thread_pool.h"
 
 namespace nearby {
@@ -35,12 +39,12 @@ class MultiThreadExecutor : public api::SubmittableExecutor {
   }
   void Execute(Runnable&& runnable) override {
     if (!shutdown_) {
-      thread_pool_.Schedule(std::move(runnable));
+      thread_pool_.Schedule(WrapTask(std::move(runnable)));
     }
   }
   bool DoSubmit(Runnable&& runnable) override {
     if (shutdown_) return false;
-    thread_pool_.Schedule(std::move(runnable));
+    thread_pool_.Schedule(WrapTask(std::move(runnable)));
     return true;
   }
   void Shutdown() override { DoShutdown(); }
@@ -48,12 +52,32 @@ class MultiThreadExecutor : public api::SubmittableExecutor {
 
   void ScheduleAfter(absl::Duration delay, Runnable&& runnable) {
     if (shutdown_) return;
-    thread_pool_.ScheduleAt(absl::Now() + delay, std::move(runnable));
+    thread_pool_.ScheduleAt(absl::Now() + delay,
+                            WrapTask(std::move(runnable)));
   }
   bool InShutdown() const { return shutdown_; }
 
  private:
+  // Runs |runnable| in the MediumEnvironment this executor was created in, if
+  // that was a scoped one. Reports posting and finishing it to the
+  // environment, if its simulated clock advances when executors are idle.
+  Runnable WrapTask(Runnable&& runnable) {
+    MediumEnvironment* env = scoped_env_ != nullptr
+                                 ? scoped_env_
+                                 : &MediumEnvironment::Instance();
+    bool track_activity = env->IsAutoAdvancingSimulatedClock();
+    if (scoped_env_ == nullptr && !track_activity) return std::move(runnable);
+    if (track_activity) env->NotifyExecutorActivity();
+    return [env, scoped = scoped_env_ != nullptr, track_activity,
+            runnable = std::move(runnable)]() mutable {
+      std::optional<MediumEnvironment::Scope> scope;
+      if (scoped) scope.emplace(env);
+      runnable();
+      if (track_activity) env->NotifyExecutorActivity();
+    };
+  }
   void DoShutdown() { shutdown_ = true; }
+  MediumEnvironment* const scoped_env_ = MediumEnvironment::GetScopedInstance();
   std::atomic_bool shutdown_ = false;
   ThreadPool thread_pool_;
 };
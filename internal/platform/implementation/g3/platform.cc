@@ -25,6 +25,8 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "internal/flags/nearby_flags.h"
+#include "internal/platform/flags/nearby_platform_feature_flags.h"
 #include "internal/platform/implementation/atomic_boolean.h"
 #include "internal/platform/implementation/atomic_reference.h"
 #include "internal/platform/implementation/bluetooth_adapter.h"
@@ -62,6 +64,10 @@
 #include "internal/platform/implementation/g3/wifi_hotspot.h"
 #include "internal/platform/implementation/g3/wifi_lan.h"
 #include "internal/platform/implementation/shared/file.h"
+#include "internal/platform/implementation/shared/mapped_file.h"
+#include "internal/platform/implementation/shared/strand.h"
+#include "internal/platform/implementation/shared/work_stealing_executor.h"
+#include "internal/platform/implementation/shared/write_behind_credential_storage.h"
 #include "internal/platform/implementation/wifi.h"
 #include "internal/platform/medium_environment.h"
 
@@ -88,17 +94,31 @@ int GetCurrentTid() {
 }
 
 std::unique_ptr<SubmittableExecutor>
-ImplementationPlatform::CreateSingleThreadExecutor() {
+ImplementationPlatform::CreateSingleThreadExecutor(ExecutorQos qos) {
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          platform::config_package_nearby::nearby_platform_feature::
+              kEnableThreadBudget)) {
+    return std::make_unique<shared::Strand>(shared::Strand::GetSharedPool(
+        NearbyFlags::GetInstance().GetInt64Flag(
+            platform::config_package_nearby::nearby_platform_feature::
+                kThreadBudgetPoolSize)));
+  }
   return std::make_unique<g3::SingleThreadExecutor>();
 }
 
 std::unique_ptr<SubmittableExecutor>
-ImplementationPlatform::CreateMultiThreadExecutor(int max_concurrency) {
+ImplementationPlatform::CreateMultiThreadExecutor(int max_concurrency,
+                                                  ExecutorQos qos) {
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          platform::config_package_nearby::nearby_platform_feature::
+              kEnableWorkStealingExecutor)) {
+    return std::make_unique<shared::WorkStealingExecutor>(max_concurrency);
+  }
   return std::make_unique<g3::MultiThreadExecutor>(max_concurrency);
 }
 
 std::unique_ptr<ScheduledExecutor>
-ImplementationPlatform::CreateScheduledExecutor() {
+ImplementationPlatform::CreateScheduledExecutor(ExecutorQos qos) {
   return std::make_unique<g3::ScheduledExecutor>();
 }
 
@@ -133,6 +153,13 @@ std::unique_ptr<InputFile> ImplementationPlatform::CreateInputFile(
 
 std::unique_ptr<InputFile> ImplementationPlatform::CreateInputFile(
     const std::string& file_path, size_t size) {
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          platform::config_package_nearby::nearby_platform_feature::
+              kEnableMemoryMappedInputFile)) {
+    std::unique_ptr<InputFile> mapped_file =
+        shared::MappedInputFile::Create(file_path);
+    if (mapped_file) return mapped_file;
+  }
   return shared::IOFile::CreateInputFile(file_path, size);
 }
 
@@ -174,6 +201,13 @@ ImplementationPlatform::CreateBleV2Medium(api::BluetoothAdapter& adapter) {
 
 std::unique_ptr<api::CredentialStorage>
 ImplementationPlatform::CreateCredentialStorage() {
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          platform::config_package_nearby::nearby_platform_feature::
+              kEnableCredentialStorageWriteBehind)) {
+    return std::make_unique<shared::WriteBehindCredentialStorage>(
+        std::make_unique<g3::CredentialStorageImpl>(),
+        CreateSingleThreadExecutor());
+  }
   return std::make_unique<g3::CredentialStorageImpl>();
 }
 
@@ -61,8 +61,7 @@ class ScheduledCancelable : public api::Cancelable {
 }  // namespace
 
 ScheduledExecutor::ScheduledExecutor() {
-  absl::optional<FakeClock*> fake_clock =
-      MediumEnvironment::Instance().GetSimulatedClock();
+  absl::optional<FakeClock*> fake_clock = env_.GetSimulatedClock();
   if (fake_clock.has_value()) {
     name_ = absl::StrFormat("G3 scheduled executor %p", this);
     (*fake_clock)->AddObserver(name_, [this]() { RunReadyTasks(); });
@@ -70,8 +69,7 @@ ScheduledExecutor::ScheduledExecutor() {
 }
 
 ScheduledExecutor::~ScheduledExecutor() {
-  absl::optional<FakeClock*> fake_clock =
-      MediumEnvironment::Instance().GetSimulatedClock();
+  absl::optional<FakeClock*> fake_clock = env_.GetSimulatedClock();
   if (fake_clock.has_value()) {
     (*fake_clock)->RemoveObserver(name_);
   }
@@ -90,13 +88,17 @@ std::shared_ptr<api::Cancelable> ScheduledExecutor::Schedule(
       runnable();
     }
   };
-  absl::optional<FakeClock*> fake_clock =
-      MediumEnvironment::Instance().GetSimulatedClock();
+  absl::optional<FakeClock*> fake_clock = env_.GetSimulatedClock();
   if (fake_clock.has_value()) {
     absl::Time trigger_time = (*fake_clock)->Now() + delay;
-    absl::MutexLock lock(&mutex_);
-    tasks_.insert(std::pair<absl::Time, std::unique_ptr<Runnable>>(
-        trigger_time, std::make_unique<Runnable>(std::move(task))));
+    {
+      absl::MutexLock lock(&mutex_);
+      tasks_.insert(std::pair<absl::Time, std::unique_ptr<Runnable>>(
+          trigger_time, std::make_unique<Runnable>(std::move(task))));
+    }
+    if (env_.IsAutoAdvancingSimulatedClock()) {
+      env_.AddSimulatedAlarm(trigger_time);
+    }
   } else {
     executor_.ScheduleAfter(delay, std::move(task));
   }
@@ -104,8 +106,7 @@ std::shared_ptr<api::Cancelable> ScheduledExecutor::Schedule(
 }
 
 void ScheduledExecutor::RunReadyTasks() {
-  absl::optional<FakeClock*> fake_clock =
-      MediumEnvironment::Instance().GetSimulatedClock();
+  absl::optional<FakeClock*> fake_clock = env_.GetSimulatedClock();
   if (executor_.InShutdown()) {
     return;
   }
@@ -25,6 +25,7 @@
 #include "internal/platform/implementation/cancelable.h"
 #include "internal/platform/implementation/g3/single_thread_executor.h"
 #include "internal/platform/implementation/scheduled_executor.h"
+#include "internal/platform/medium_environment.h"
 #include "internal/platform/runnable.h"
 
 namespace nearby {
@@ -46,6 +47,8 @@ class ScheduledExecutor final : public api::ScheduledExecutor {
 
  private:
   void RunReadyTasks();
+  // The clock may notify us on a thread outside of the environment's Scope.
+  MediumEnvironment& env_ = MediumEnvironment::Instance();
   SingleThreadExecutor executor_;
   std::string name_;
   absl::Mutex mutex_;
@@ -0,0 +1,134 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "internal/platform/implementation/g3/simulated_link.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/medium_environment.h"
+
+namespace nearby {
+namespace g3 {
+
+std::unique_ptr<SimulatedLink> SimulatedLink::Create(
+    location::nearby::proto::connections::Medium medium,
+    std::shared_ptr<Pipe> pipe) {
+  LinkModel model = MediumEnvironment::Instance().GetLinkModel(medium);
+  if (model.IsIdeal()) return nullptr;
+  return std::make_unique<SimulatedLink>(model, std::move(pipe));
+}
+
+SimulatedLink::SimulatedLink(const LinkModel& model,
+                             std::shared_ptr<Pipe> pipe)
+    : model_(model), pipe_(std::move(pipe)) {}
+
+SimulatedLink::~SimulatedLink() { Close(); }
+
+Exception SimulatedLink::Write(const ByteArray& data) {
+  absl::Time idle_at;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (closed_ || broken_) return {Exception::kIo};
+    if (Chance(model_.disconnect_probability)) {
+      broken_ = true;
+      pipe_->GetOutputStream().Close();
+      return {Exception::kIo};
+    }
+    absl::Time now = absl::Now();
+    idle_at_ = std::max(idle_at_, now);
+    if (model_.bandwidth_bytes_per_second > 0) {
+      idle_at_ += absl::Seconds(static_cast<double>(data.size()) /
+                                model_.bandwidth_bytes_per_second);
+    }
+    absl::Duration delay = model_.round_trip_time / 2;
+    if (model_.jitter > absl::ZeroDuration()) {
+      delay += model_.jitter *
+               std::uniform_real_distribution<double>(0, 1)(random_);
+    }
+    if (Chance(model_.loss_probability)) delay += model_.round_trip_time;
+    last_arrival_ = std::max(last_arrival_, idle_at_ + delay);
+    idle_at = idle_at_;
+    ++pending_;
+    delivery_.Execute([this, data, arrival = last_arrival_]() {
+      Deliver(data, arrival);
+    });
+  }
+  absl::SleepFor(idle_at - absl::Now());
+  return {Exception::kSuccess};
+}
+
+Exception SimulatedLink::Flush() {
+  absl::MutexLock lock(&mutex_);
+  WaitForDeliveries();
+  return {broken_ ? Exception::kIo : Exception::kSuccess};
+}
+
+Exception SimulatedLink::Close() {
+  absl::MutexLock lock(&mutex_);
+  if (closed_) return {Exception::kSuccess};
+  closed_ = true;
+  WaitForDeliveries();
+  pipe_->GetOutputStream().Close();
+  return {Exception::kSuccess};
+}
+
+void SimulatedLink::Deliver(const ByteArray& data, absl::Time arrival) {
+  bool lost;
+  {
+    absl::MutexLock lock(&mutex_);
+    mutex_.AwaitWithDeadline(absl::Condition(&broken_), arrival);
+    // A broken link loses whatever was still in flight.
+    lost = broken_;
+  }
+  if (!lost) pipe_->GetOutputStream().Write(data);
+  absl::MutexLock lock(&mutex_);
+  --pending_;
+}
+
+bool SimulatedLink::Chance(double probability) {
+  return probability > 0 &&
+         std::bernoulli_distribution(std::min(probability, 1.0))(random_);
+}
+
+bool SimulatedLink::IsDelivered() const { return pending_ == 0; }
+
+void SimulatedLink::WaitForDeliveries() {
+  mutex_.Await(absl::Condition(this, &SimulatedLink::IsDelivered));
+}
+
+void SimulatedSocketLink::Connect(
+    location::nearby::proto::connections::Medium medium) {
+  link_ = SimulatedLink::Create(medium, output_);
+}
+
+OutputStream& SimulatedSocketLink::GetOutputStream() {
+  if (link_ != nullptr) return *link_;
+  return output_->GetOutputStream();
+}
+
+void SimulatedSocketLink::Close() {
+  if (link_ != nullptr) link_->Close();
+}
+
+}  // namespace g3
+}  // namespace nearby
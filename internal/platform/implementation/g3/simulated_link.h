@@ -0,0 +1,111 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef PLATFORM_IMPL_G3_SIMULATED_LINK_H_
+#define PLATFORM_IMPL_G3_SIMULATED_LINK_H_
+
+#include <memory>
+#include <random>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/implementation/g3/pipe.h"
+#include "internal/platform/implementation/g3/single_thread_executor.h"
+#include "internal/platform/medium_environment.h"
+#include "internal/platform/output_stream.h"
+#include "proto/connections_enums.pb.h"
+
+namespace nearby {
+namespace g3 {
+
+// OutputStream that feeds a simulated socket's pipe as if the data travelled
+// over a link described by a LinkModel.
+//
+// Write() blocks for the transmission time of the data, which caps the
+// throughput at the model's bandwidth. The data is then handed to a delivery
+// thread, which puts it in the pipe once its propagation delay has passed.
+// Data is always delivered in order.
+class SimulatedLink : public OutputStream {
+ public:
+  // Returns a link for sockets of |medium| writing into |pipe|, or nullptr if
+  // MediumEnvironment has an ideal link model for that medium.
+  static std::unique_ptr<SimulatedLink> Create(
+      location::nearby::proto::connections::Medium medium,
+      std::shared_ptr<Pipe> pipe);
+
+  SimulatedLink(const LinkModel& model, std::shared_ptr<Pipe> pipe);
+  ~SimulatedLink() override;
+
+  Exception Write(const ByteArray& data) override ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Blocks until everything written so far has reached the pipe.
+  Exception Flush() override ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Delivers pending writes, then closes the pipe's output stream.
+  Exception Close() override ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  void Deliver(const ByteArray& data, absl::Time arrival)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  bool Chance(double probability) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  bool IsDelivered() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void WaitForDeliveries() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const LinkModel model_;
+  std::shared_ptr<Pipe> pipe_;
+  absl::Mutex mutex_;
+  std::mt19937_64 random_ ABSL_GUARDED_BY(mutex_){std::random_device()()};
+  // When the link finishes transmitting the data written so far.
+  absl::Time idle_at_ ABSL_GUARDED_BY(mutex_) = absl::InfinitePast();
+  // When the last write reaches the peer.
+  absl::Time last_arrival_ ABSL_GUARDED_BY(mutex_) = absl::InfinitePast();
+  int pending_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool broken_ ABSL_GUARDED_BY(mutex_) = false;
+  bool closed_ ABSL_GUARDED_BY(mutex_) = false;
+  // Declared last, so that it is destroyed before the state its tasks use.
+  SingleThreadExecutor delivery_;
+};
+
+// The SimulatedLink of a simulated socket, once it is connected and if its
+// medium has a link model. Writes into the socket's output pipe go through it.
+//
+// Not thread-safe, the socket guards it like its other state.
+class SimulatedSocketLink {
+ public:
+  explicit SimulatedSocketLink(std::shared_ptr<Pipe> output)
+      : output_(std::move(output)) {}
+
+  // Starts applying the link model of |medium|, if it has one.
+  void Connect(location::nearby::proto::connections::Medium medium);
+
+  // Returns the stream the socket's writes go to.
+  OutputStream& GetOutputStream();
+
+  // Delivers the writes still on their way.
+  void Close();
+
+ private:
+  std::shared_ptr<Pipe> output_;
+  std::unique_ptr<SimulatedLink> link_;
+};
+
+}  // namespace g3
+}  // namespace nearby
+
+#endif  // PLATFORM_IMPL_G3_SIMULATED_LINK_H_
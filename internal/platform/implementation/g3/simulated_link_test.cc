@@ -0,0 +1,118 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "internal/platform/implementation/g3/simulated_link.h"
+
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/implementation/g3/pipe.h"
+#include "internal/platform/medium_environment.h"
+
+namespace nearby {
+namespace g3 {
+namespace {
+
+using ::location::nearby::proto::connections::Medium;
+
+TEST(SimulatedLinkTest, IdealLinkIsNotCreated) {
+  MediumEnvironment& env = MediumEnvironment::Instance();
+  env.Start();
+  EXPECT_EQ(SimulatedLink::Create(Medium::WIFI_LAN, std::make_shared<Pipe>()),
+            nullptr);
+  env.Stop();
+}
+
+TEST(SimulatedLinkTest, CreatesLinkWithModelFromEnvironment) {
+  MediumEnvironment& env = MediumEnvironment::Instance();
+  env.Start({.link_models = {{Medium::BLUETOOTH,
+                              {.round_trip_time = absl::Milliseconds(10)}}}});
+  EXPECT_NE(SimulatedLink::Create(Medium::BLUETOOTH, std::make_shared<Pipe>()),
+            nullptr);
+  EXPECT_EQ(SimulatedLink::Create(Medium::WIFI_LAN, std::make_shared<Pipe>()),
+            nullptr);
+  env.SetLinkModel(Medium::WIFI_LAN, {.bandwidth_bytes_per_second = 1000});
+  EXPECT_NE(SimulatedLink::Create(Medium::WIFI_LAN, std::make_shared<Pipe>()),
+            nullptr);
+  env.Stop();
+}
+
+TEST(SimulatedLinkTest, DelaysDeliveryByHalfRoundTrip) {
+  auto pipe = std::make_shared<Pipe>();
+  SimulatedLink link({.round_trip_time = absl::Milliseconds(200)}, pipe);
+  ByteArray data(std::string("data"));
+  absl::Time start = absl::Now();
+
+  EXPECT_TRUE(link.Write(data).Ok());
+  // Latency doesn't hold up the writer.
+  EXPECT_LT(absl::Now() - start, absl::Milliseconds(100));
+  ExceptionOr<ByteArray> read = pipe->GetInputStream().Read(Pipe::kChunkSize);
+
+  ASSERT_TRUE(read.ok());
+  EXPECT_EQ(read.result(), data);
+  EXPECT_GE(absl::Now() - start, absl::Milliseconds(100));
+}
+
+TEST(SimulatedLinkTest, CapsThroughputAtBandwidth) {
+  auto pipe = std::make_shared<Pipe>();
+  SimulatedLink link({.bandwidth_bytes_per_second = 10000}, pipe);
+  ByteArray data(std::string(1000, 'x'));
+  absl::Time start = absl::Now();
+
+  for (int i = 0; i < 3; ++i) EXPECT_TRUE(link.Write(data).Ok());
+
+  EXPECT_GE(absl::Now() - start, absl::Milliseconds(300));
+}
+
+TEST(SimulatedLinkTest, KeepsOrderWithJitter) {
+  auto pipe = std::make_shared<Pipe>();
+  SimulatedLink link({.round_trip_time = absl::Milliseconds(2),
+                      .jitter = absl::Milliseconds(20)},
+                     pipe);
+
+  for (char c = 'a'; c <= 'j'; ++c) {
+    EXPECT_TRUE(link.Write(ByteArray(std::string(1, c))).Ok());
+  }
+  EXPECT_TRUE(link.Close().Ok());
+
+  std::string received;
+  while (true) {
+    ExceptionOr<ByteArray> read = pipe->GetInputStream().Read(1);
+    if (!read.ok() || read.result().Empty()) break;
+    received += std::string(read.result());
+  }
+  EXPECT_EQ(received, "abcdefghij");
+}
+
+TEST(SimulatedLinkTest, DisconnectBreaksLink) {
+  auto pipe = std::make_shared<Pipe>();
+  SimulatedLink link({.disconnect_probability = 1}, pipe);
+
+  EXPECT_EQ(link.Write(ByteArray(std::string("data"))),
+            Exception{Exception::kIo});
+  EXPECT_EQ(link.Write(ByteArray(std::string("more"))),
+            Exception{Exception::kIo});
+  ExceptionOr<ByteArray> read = pipe->GetInputStream().Read(Pipe::kChunkSize);
+  EXPECT_TRUE(!read.ok() || read.result().Empty());
+}
+
+}  // namespace
+}  // namespace g3
+}  // namespace nearby
@@ -39,6 +39,7 @@ void WifiDirectSocket::Connect(WifiDirectSocket& other) {
   absl::MutexLock lock(&mutex_);
   remote_socket_ = &other;
   input_ = other.output_;
+  link_.Connect(location::nearby::proto::connections::Medium::WIFI_DIRECT);
 }
 
 InputStream& WifiDirectSocket::GetInputStream() {
@@ -70,6 +71,7 @@ Exception WifiDirectSocket::Close() {
 void WifiDirectSocket::DoClose() {
   if (!closed_) {
     remote_socket_ = nullptr;
+    link_.Close();
     output_->GetOutputStream().Close();
     output_->GetInputStream().Close();
     input_->GetOutputStream().Close();
@@ -87,7 +89,7 @@ InputStream& WifiDirectSocket::GetLocalInputStream() {
 
 OutputStream& WifiDirectSocket::GetLocalOutputStream() {
   absl::MutexLock lock(&mutex_);
-  return output_->GetOutputStream();
+  return link_.GetOutputStream();
 }
 
 // Code for WifiDirectServerSocket
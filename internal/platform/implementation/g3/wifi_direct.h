@@ -23,6 +23,7 @@
 #include "absl/synchronization/mutex.h"
 #include "internal/platform/implementation/g3/multi_thread_executor.h"
 #include "internal/platform/implementation/g3/pipe.h"
+#include "internal/platform/implementation/g3/simulated_link.h"
 #include "internal/platform/implementation/wifi_direct.h"
 #include "internal/platform/input_stream.h"
 #include "internal/platform/output_stream.h"
@@ -89,6 +90,7 @@ class WifiDirectSocket : public api::WifiDirectSocket {
   // local socket comes from the peer socket, after connection.
   std::shared_ptr<Pipe> output_{new Pipe};
   std::shared_ptr<Pipe> input_;
+  SimulatedSocketLink link_ ABSL_GUARDED_BY(mutex_){output_};
   mutable absl::Mutex mutex_;
   WifiDirectSocket* remote_socket_ ABSL_GUARDED_BY(mutex_) = nullptr;
   bool closed_ ABSL_GUARDED_BY(mutex_) = false;
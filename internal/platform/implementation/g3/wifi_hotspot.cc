@@ -40,6 +40,7 @@ void WifiHotspotSocket::Connect(WifiHotspotSocket& other) {
   absl::MutexLock lock(&mutex_);
   remote_socket_ = &other;
   input_ = other.output_;
+  link_.Connect(location::nearby::proto::connections::Medium::WIFI_HOTSPOT);
 }
 
 InputStream& WifiHotspotSocket::GetInputStream() {
@@ -76,6 +77,7 @@ Exception WifiHotspotSocket::Close() {
 void WifiHotspotSocket::DoClose() {
   if (!closed_) {
     remote_socket_ = nullptr;
+    link_.Close();
     output_->GetOutputStream().Close();
     output_->GetInputStream().Close();
     input_->GetOutputStream().Close();
@@ -93,7 +95,7 @@ InputStream& WifiHotspotSocket::GetLocalInputStream() {
 
 OutputStream& WifiHotspotSocket::GetLocalOutputStream() {
   absl::MutexLock lock(&mutex_);
-  return output_->GetOutputStream();
+  return link_.GetOutputStream();
 }
 
 // Code for WifiHotspotServerSocket
@@ -40,6 +40,7 @@ void WifiLanSocket::Connect(WifiLanSocket& other) {
   absl::MutexLock lock(&mutex_);
   remote_socket_ = &other;
   input_ = other.output_;
+  link_.Connect(location::nearby::proto::connections::Medium::WIFI_LAN);
 }
 
 InputStream& WifiLanSocket::GetInputStream() {
@@ -76,6 +77,7 @@ Exception WifiLanSocket::Close() {
 void WifiLanSocket::DoClose() {
   if (!closed_) {
     remote_socket_ = nullptr;
+    link_.Close();
     output_->GetOutputStream().Close();
     output_->GetInputStream().Close();
     input_->GetOutputStream().Close();
@@ -93,7 +95,7 @@ InputStream& WifiLanSocket::GetLocalInputStream() {
 
 OutputStream& WifiLanSocket::GetLocalOutputStream() {
   absl::MutexLock lock(&mutex_);
-  return output_->GetOutputStream();
+  return link_.GetOutputStream();
 }
 
 std::string WifiLanServerSocket::GetName(const std::string& ip_address,
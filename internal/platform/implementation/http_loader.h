@@ -15,9 +15,12 @@
 #ifndef THIRD_PARTY_NEARBY_INTERNAL_PLATFORM_IMPLEMENTATION_HTTP_LOADER_H_
 #define THIRD_PARTY_NEARBY_INTERNAL_PLATFORM_IMPLEMENTATION_HTTP_LOADER_H_
 
+#include <functional>
 #include <map>
 #include <string>
 
+#include "absl/strings/string_view.h"
+
 namespace nearby {
 namespace api {
 
@@ -26,6 +29,10 @@ struct WebRequest {
   std::string method;
   std::multimap<std::string, std::string> headers;
   std::string body;
+  // If set, and the platform supports it, the body of a successful response
+  // is handed to it piece by piece as it arrives, and WebResponse::body stays
+  // empty. Returning false stops the download, which then fails as cancelled.
+  std::function<bool(absl::string_view chunk)> body_chunk_callback;
 };
 
 struct WebResponse {
@@ -15,6 +15,8 @@
 #ifndef PLATFORM_API_OUTPUT_FILE_H_
 #define PLATFORM_API_OUTPUT_FILE_H_
 
+#include <cstdint>
+
 #include "internal/platform/byte_array.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/output_stream.h"
@@ -26,6 +28,13 @@ namespace api {
 class OutputFile : public OutputStream {
  public:
   ~OutputFile() override = default;
+
+  // Reserves storage for a file that will grow to |size| bytes, without
+  // changing its visible size. Implementations that can't do this may keep
+  // the default, which does nothing.
+  virtual Exception Preallocate(std::int64_t size) {
+    return {Exception::kSuccess};
+  }
 };
 
 }  // namespace api
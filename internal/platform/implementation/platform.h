@@ -120,10 +120,12 @@ class ImplementationPlatform {
       const char* file, int line, LogMessage::Severity severity);
 
   // Java-like Executors
-  static std::unique_ptr<SubmittableExecutor> CreateSingleThreadExecutor();
+  static std::unique_ptr<SubmittableExecutor> CreateSingleThreadExecutor(
+      ExecutorQos qos = ExecutorQos::kDefault);
   static std::unique_ptr<SubmittableExecutor> CreateMultiThreadExecutor(
-      std::int32_t max_concurrency);
-  static std::unique_ptr<ScheduledExecutor> CreateScheduledExecutor();
+      std::int32_t max_concurrency, ExecutorQos qos = ExecutorQos::kDefault);
+  static std::unique_ptr<ScheduledExecutor> CreateScheduledExecutor(
+      ExecutorQos qos = ExecutorQos::kDefault);
 
   // Protocol implementations, domain-specific support
   static std::unique_ptr<BluetoothAdapter> CreateBluetoothAdapter();
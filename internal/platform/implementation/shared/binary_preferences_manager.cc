@@ -0,0 +1,423 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/implementation/shared/binary_preferences_manager.h"
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <memory>
+#include <string>
+#include <system_error>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "nlohmann/json.hpp"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/implementation/shared/mapped_file.h"
+#include "internal/platform/logging.h"
+
+namespace nearby {
+namespace shared {
+namespace {
+
+using json = ::nlohmann::json;
+
+// The log starts with the magic, followed by records of
+//   key size (4 bytes), key, value size (4 bytes), CBOR value
+// with sizes in little endian. A value size of kTombstone marks a removed key.
+constexpr absl::string_view kMagic = "NPL1";
+constexpr uint32_t kTombstone = 0xFFFFFFFF;
+constexpr size_t kSizeLength = 4;
+
+void AppendSize(std::string& output, uint32_t size) {
+  for (size_t i = 0; i < kSizeLength; ++i) {
+    output.push_back(static_cast<char>((size >> (8 * i)) & 0xFF));
+  }
+}
+
+bool ReadSize(absl::string_view& input, uint32_t& size) {
+  if (input.size() < kSizeLength) return false;
+  size = 0;
+  for (size_t i = 0; i < kSizeLength; ++i) {
+    size |= static_cast<uint32_t>(static_cast<uint8_t>(input[i])) << (8 * i);
+  }
+  input.remove_prefix(kSizeLength);
+  return true;
+}
+
+std::string EncodeRecord(absl::string_view key, const json* value) {
+  std::string record;
+  AppendSize(record, key.size());
+  record.append(key.data(), key.size());
+  if (value == nullptr) {
+    AppendSize(record, kTombstone);
+    return record;
+  }
+  std::vector<uint8_t> cbor = json::to_cbor(*value);
+  AppendSize(record, cbor.size());
+  record.append(cbor.begin(), cbor.end());
+  return record;
+}
+
+size_t GetRecordSize(absl::string_view key, const json& value) {
+  return 2 * kSizeLength + key.size() + json::to_cbor(value).size();
+}
+
+std::unique_ptr<api::InputFile> OpenMappedFile(absl::string_view path) {
+  return MappedInputFile::Create(path);
+}
+
+}  // namespace
+
+BinaryPreferencesManager::BinaryPreferencesManager(absl::string_view directory,
+                                                   OpenFile open_file)
+    : api::PreferencesManager(directory),
+      directory_(directory),
+      log_path_((std::filesystem::path(std::string(directory)) /
+                 std::string(kLogFileName))
+                    .string()),
+      open_file_(open_file != nullptr ? std::move(open_file)
+                                      : OpenFile(OpenMappedFile)) {
+  absl::MutexLock lock(&mutex_);
+  if (!Load()) {
+    MigrateFromJson();
+    Compact();
+  }
+}
+
+bool BinaryPreferencesManager::Load() {
+  std::unique_ptr<api::InputFile> file = open_file_(log_path_);
+  if (file == nullptr) {
+    return false;
+  }
+  ExceptionOr<ByteArray> bytes = file->Read(file->GetTotalSize());
+  file->Close();
+  if (!bytes.ok()) {
+    return false;
+  }
+  absl::string_view input = bytes.result().AsStringView();
+  if (!absl::ConsumePrefix(&input, kMagic)) {
+    NEARBY_LOGS(ERROR) << __func__ << ": Not a preferences log: " << log_path_;
+    return false;
+  }
+  log_size_ = kMagic.size() + input.size();
+  bool torn = false;
+  while (!input.empty()) {
+    uint32_t key_size;
+    uint32_t value_size;
+    if (!ReadSize(input, key_size) || input.size() < key_size) {
+      torn = true;
+      break;
+    }
+    std::string key(input.substr(0, key_size));
+    input.remove_prefix(key_size);
+    if (!ReadSize(input, value_size)) {
+      torn = true;
+      break;
+    }
+    if (value_size == kTombstone) {
+      values_.erase(key);
+      continue;
+    }
+    if (input.size() < value_size) {
+      torn = true;
+      break;
+    }
+    json value = json::from_cbor(input.substr(0, value_size),
+                                 /*strict=*/true, /*allow_exceptions=*/false);
+    input.remove_prefix(value_size);
+    if (value.is_discarded()) {
+      torn = true;
+      break;
+    }
+    values_[key] = std::move(value);
+  }
+  live_size_ = kMagic.size();
+  for (const auto& [key, value] : values_.items()) {
+    live_size_ += GetRecordSize(key, value);
+  }
+  if (torn) {
+    // Appending after a broken record would make the new records unreadable.
+    NEARBY_LOGS(WARNING) << __func__
+                         << ": Dropping the unreadable end of " << log_path_;
+    Compact();
+  }
+  return true;
+}
+
+void BinaryPreferencesManager::MigrateFromJson() {
+  std::filesystem::path json_path =
+      std::filesystem::path(directory_) / std::string(kJsonFileName);
+  std::ifstream json_file(json_path);
+  if (!json_file.good()) {
+    return;
+  }
+  json preferences = json::parse(json_file, nullptr, /*allow_exceptions=*/false);
+  if (preferences.is_discarded() || !preferences.is_object()) {
+    NEARBY_LOGS(WARNING) << __func__ << ": Can't migrate "
+                         << json_path.string();
+    return;
+  }
+  NEARBY_LOGS(INFO) << __func__ << ": Migrating " << json_path.string();
+  values_ = std::move(preferences);
+}
+
+bool BinaryPreferencesManager::Compact() {
+  std::string contents(kMagic);
+  for (const auto& [key, value] : values_.items()) {
+    contents += EncodeRecord(key, &value);
+  }
+  std::error_code error;
+  std::filesystem::create_directories(directory_, error);
+  std::string temporary_path = absl::StrCat(log_path_, ".tmp");
+  {
+    std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), contents.size());
+    file.close();
+    if (file.fail()) {
+      NEARBY_LOGS(ERROR) << __func__ << ": Failed to write " << temporary_path;
+      std::filesystem::remove(temporary_path, error);
+      return false;
+    }
+  }
+  std::filesystem::rename(temporary_path, log_path_, error);
+  if (error) {
+    NEARBY_LOGS(ERROR) << __func__ << ": Failed to replace " << log_path_
+                       << ": " << error.message();
+    std::filesystem::remove(temporary_path, error);
+    return false;
+  }
+  log_size_ = contents.size();
+  live_size_ = contents.size();
+  return true;
+}
+
+bool BinaryPreferencesManager::Append(absl::string_view key,
+                                      const json* value) {
+  std::string record = EncodeRecord(key, value);
+  {
+    std::ofstream file(log_path_, std::ios::binary | std::ios::app);
+    file.write(record.data(), record.size());
+    file.close();
+    if (file.fail()) {
+      NEARBY_LOGS(ERROR) << __func__ << ": Failed to append to " << log_path_;
+      // Rewriting the whole log also repairs a partly written record.
+      return Compact();
+    }
+  }
+  log_size_ += record.size();
+  if (log_size_ > kMinCompactionSize && log_size_ > 2 * live_size_) {
+    Compact();
+  }
+  return true;
+}
+
+bool BinaryPreferencesManager::SetValue(absl::string_view key,
+                                        const json& value) {
+  std::string key_string(key);
+  auto it = values_.find(key_string);
+  if (it != values_.end()) {
+    if (*it == value) {
+      return false;
+    }
+    live_size_ -= GetRecordSize(key, *it);
+  }
+  values_[key_string] = value;
+  live_size_ += GetRecordSize(key, value);
+  return Append(key, &value);
+}
+
+template <typename T>
+bool BinaryPreferencesManager::SetArrayValue(absl::string_view key,
+                                             absl::Span<const T> value) {
+  json array_value = json::array();
+  for (const T& item_value : value) {
+    array_value.push_back(item_value);
+  }
+  return SetValue(key, array_value);
+}
+
+template <typename T>
+T BinaryPreferencesManager::GetValue(absl::string_view key,
+                                     const T& default_value) const {
+  auto it = values_.find(std::string(key));
+  if (it == values_.end()) {
+    return default_value;
+  }
+  return it->template get<T>();
+}
+
+template <typename T>
+std::vector<T> BinaryPreferencesManager::GetArrayValue(
+    absl::string_view key, absl::Span<const T> default_value) const {
+  auto it = values_.find(std::string(key));
+  if (it == values_.end() || !it->is_array()) {
+    return std::vector<T>(default_value.begin(), default_value.end());
+  }
+  std::vector<T> result;
+  for (const json& item_value : *it) {
+    result.push_back(item_value.get<T>());
+  }
+  return result;
+}
+
+bool BinaryPreferencesManager::Set(absl::string_view key, const json& value) {
+  absl::MutexLock lock(&mutex_);
+  return SetValue(key, value);
+}
+
+bool BinaryPreferencesManager::SetBoolean(absl::string_view key, bool value) {
+  absl::MutexLock lock(&mutex_);
+  return SetValue(key, value);
+}
+
+bool BinaryPreferencesManager::SetInteger(absl::string_view key, int value) {
+  absl::MutexLock lock(&mutex_);
+  return SetValue(key, value);
+}
+
+bool BinaryPreferencesManager::SetInt64(absl::string_view key, int64_t value) {
+  absl::MutexLock lock(&mutex_);
+  return SetValue(key, value);
+}
+
+bool BinaryPreferencesManager::SetString(absl::string_view key,
+                                         absl::string_view value) {
+  absl::MutexLock lock(&mutex_);
+  return SetValue(key, std::string(value));
+}
+
+bool BinaryPreferencesManager::SetBooleanArray(absl::string_view key,
+                                               absl::Span<const bool> value) {
+  absl::MutexLock lock(&mutex_);
+  return SetArrayValue(key, value);
+}
+
+bool BinaryPreferencesManager::SetIntegerArray(absl::string_view key,
+                                               absl::Span<const int> value) {
+  absl::MutexLock lock(&mutex_);
+  return SetArrayValue(key, value);
+}
+
+bool BinaryPreferencesManager::SetInt64Array(absl::string_view key,
+                                             absl::Span<const int64_t> value) {
+  absl::MutexLock lock(&mutex_);
+  return SetArrayValue(key, value);
+}
+
+bool BinaryPreferencesManager::SetStringArray(
+    absl::string_view key, absl::Span<const std::string> value) {
+  absl::MutexLock lock(&mutex_);
+  return SetArrayValue(key, value);
+}
+
+bool BinaryPreferencesManager::SetTime(absl::string_view key,
+                                       absl::Time value) {
+  // Saved as nanos, like the JSON preferences.
+  absl::MutexLock lock(&mutex_);
+  return SetValue(key, absl::ToUnixNanos(value));
+}
+
+json BinaryPreferencesManager::Get(absl::string_view key,
+                                   const json& default_value) const {
+  absl::MutexLock lock(&mutex_);
+  return GetValue(key, default_value);
+}
+
+bool BinaryPreferencesManager::GetBoolean(absl::string_view key,
+                                          bool default_value) const {
+  absl::MutexLock lock(&mutex_);
+  return GetValue(key, default_value);
+}
+
+int BinaryPreferencesManager::GetInteger(absl::string_view key,
+                                         int default_value) const {
+  absl::MutexLock lock(&mutex_);
+  return GetValue(key, default_value);
+}
+
+int64_t BinaryPreferencesManager::GetInt64(absl::string_view key,
+                                           int64_t default_value) const {
+  absl::MutexLock lock(&mutex_);
+  return GetValue(key, default_value);
+}
+
+std::string BinaryPreferencesManager::GetString(
+    absl::string_view key, const std::string& default_value) const {
+  absl::MutexLock lock(&mutex_);
+  return GetValue(key, default_value);
+}
+
+std::vector<bool> BinaryPreferencesManager::GetBooleanArray(
+    absl::string_view key, absl::Span<const bool> default_value) const {
+  absl::MutexLock lock(&mutex_);
+  return GetArrayValue(key, default_value);
+}
+
+std::vector<int> BinaryPreferencesManager::GetIntegerArray(
+    absl::string_view key, absl::Span<const int> default_value) const {
+  absl::MutexLock lock(&mutex_);
+  return GetArrayValue(key, default_value);
+}
+
+std::vector<int64_t> BinaryPreferencesManager::GetInt64Array(
+    absl::string_view key, absl::Span<const int64_t> default_value) const {
+  absl::MutexLock lock(&mutex_);
+  return GetArrayValue(key, default_value);
+}
+
+std::vector<std::string> BinaryPreferencesManager::GetStringArray(
+    absl::string_view key, absl::Span<const std::string> default_value) const {
+  absl::MutexLock lock(&mutex_);
+  return GetArrayValue(key, default_value);
+}
+
+absl::Time BinaryPreferencesManager::GetTime(absl::string_view key,
+                                             absl::Time default_value) const {
+  absl::MutexLock lock(&mutex_);
+  auto it = values_.find(std::string(key));
+  if (it == values_.end()) {
+    return default_value;
+  }
+  return absl::FromUnixNanos(it->get<int64_t>());
+}
+
+void BinaryPreferencesManager::Remove(absl::string_view key) {
+  absl::MutexLock lock(&mutex_);
+  auto it = values_.find(std::string(key));
+  if (it == values_.end()) {
+    return;
+  }
+  live_size_ -= GetRecordSize(key, *it);
+  values_.erase(it);
+  Append(key, nullptr);
+}
+
+size_t BinaryPreferencesManager::GetLogSize() const {
+  absl::MutexLock lock(&mutex_);
+  return log_size_;
+}
+
+}  // namespace shared
+}  // namespace nearby
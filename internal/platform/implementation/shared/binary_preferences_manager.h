@@ -0,0 +1,172 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PLATFORM_IMPL_SHARED_BINARY_PREFERENCES_MANAGER_H_
+#define PLATFORM_IMPL_SHARED_BINARY_PREFERENCES_MANAGER_H_
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "nlohmann/json.hpp"
+#include "nlohmann/json_fwd.hpp"
+#include "internal/platform/implementation/input_file.h"
+#include "internal/platform/implementation/preferences_manager.h"
+
+namespace nearby {
+namespace shared {
+
+// Preferences stored in a binary append log instead of a JSON document.
+//
+// Every change appends one record to the log: the key and the value encoded as
+// CBOR, or a tombstone for a removed key. Loading reads the whole log through a
+// memory-mapped file and replays it, with no text to parse. When the log grows
+// to more than twice the size of the live records, it is compacted into a new
+// log holding only those. A record cut short by a crash is dropped on load.
+//
+// The first time a directory is opened, the preferences of the JSON
+// `preferences.json` in it are migrated to the log. The JSON file is left in
+// place. Thread-safe.
+class BinaryPreferencesManager : public api::PreferencesManager {
+ public:
+  // Opens a file for reading, e.g. by memory-mapping it. Returns nullptr if the
+  // file can't be opened.
+  using OpenFile = absl::AnyInvocable<std::unique_ptr<api::InputFile>(
+      absl::string_view path)>;
+
+  static constexpr absl::string_view kLogFileName = "preferences.log";
+  static constexpr absl::string_view kJsonFileName = "preferences.json";
+
+  // `directory` holds the log. Without `open_file`, the log is read through
+  // MappedInputFile.
+  explicit BinaryPreferencesManager(absl::string_view directory,
+                                    OpenFile open_file = nullptr);
+
+  bool Set(absl::string_view key, const nlohmann::json& value) override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  bool SetBoolean(absl::string_view key, bool value) override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  bool SetInteger(absl::string_view key, int value) override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  bool SetInt64(absl::string_view key, int64_t value) override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  bool SetString(absl::string_view key, absl::string_view value) override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  bool SetBooleanArray(absl::string_view key,
+                       absl::Span<const bool> value) override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  bool SetIntegerArray(absl::string_view key,
+                       absl::Span<const int> value) override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  bool SetInt64Array(absl::string_view key,
+                     absl::Span<const int64_t> value) override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  bool SetStringArray(absl::string_view key,
+                      absl::Span<const std::string> value) override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  bool SetTime(absl::string_view key, absl::Time value) override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  nlohmann::json Get(absl::string_view key,
+                     const nlohmann::json& default_value) const override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  bool GetBoolean(absl::string_view key, bool default_value) const override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  int GetInteger(absl::string_view key, int default_value) const override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  int64_t GetInt64(absl::string_view key, int64_t default_value) const override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  std::string GetString(absl::string_view key,
+                        const std::string& default_value) const override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  std::vector<bool> GetBooleanArray(absl::string_view key,
+                                    absl::Span<const bool> default_value)
+      const override ABSL_LOCKS_EXCLUDED(mutex_);
+  std::vector<int> GetIntegerArray(
+      absl::string_view key, absl::Span<const int> default_value) const override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  std::vector<int64_t> GetInt64Array(absl::string_view key,
+                                     absl::Span<const int64_t> default_value)
+      const override ABSL_LOCKS_EXCLUDED(mutex_);
+  std::vector<std::string> GetStringArray(
+      absl::string_view key,
+      absl::Span<const std::string> default_value) const override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  absl::Time GetTime(absl::string_view key,
+                     absl::Time default_value) const override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  void Remove(absl::string_view key) override ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Size of the log in bytes, for tests.
+  size_t GetLogSize() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  // Compaction is skipped for logs smaller than this.
+  static constexpr size_t kMinCompactionSize = 4096;
+
+  // Replays the log. Returns false if there is no readable log.
+  bool Load() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Loads `preferences.json`, if there is one.
+  void MigrateFromJson() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  bool SetValue(absl::string_view key, const nlohmann::json& value)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  template <typename T>
+  bool SetArrayValue(absl::string_view key, absl::Span<const T> value)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  template <typename T>
+  T GetValue(absl::string_view key, const T& default_value) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  template <typename T>
+  std::vector<T> GetArrayValue(absl::string_view key,
+                               absl::Span<const T> default_value) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Appends the record of `key` to the log, compacting it when it's due.
+  bool Append(absl::string_view key, const nlohmann::json* value)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Rewrites the log with the live records only.
+  bool Compact() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const std::string directory_;
+  const std::string log_path_;
+  OpenFile open_file_;
+
+  mutable absl::Mutex mutex_;
+  nlohmann::json values_ ABSL_GUARDED_BY(mutex_) = nlohmann::json::object();
+  size_t log_size_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Size the log would have after compaction.
+  size_t live_size_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace shared
+}  // namespace nearby
+
+#endif  // PLATFORM_IMPL_SHARED_BINARY_PREFERENCES_MANAGER_H_
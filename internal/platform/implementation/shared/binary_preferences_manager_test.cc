@@ -0,0 +1,163 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/implementation/shared/binary_preferences_manager.h"
+
+#include <cstddef>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "file/util/temp_path.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "nlohmann/json.hpp"
+
+namespace nearby {
+namespace shared {
+namespace {
+
+using ::testing::ElementsAre;
+
+class BinaryPreferencesManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    temp_path_ = std::make_unique<TempPath>(TempPath::Local);
+    directory_ = temp_path_->path() + "/preferences";
+  }
+
+  std::string GetLogPath() const {
+    return (std::filesystem::path(directory_) /
+            std::string(BinaryPreferencesManager::kLogFileName))
+        .string();
+  }
+
+  std::unique_ptr<TempPath> temp_path_;
+  std::string directory_;
+};
+
+TEST_F(BinaryPreferencesManagerTest, ValuesSurviveReopening) {
+  {
+    BinaryPreferencesManager preferences(directory_);
+    EXPECT_TRUE(preferences.SetBoolean("bool", true));
+    EXPECT_TRUE(preferences.SetInteger("int", 34));
+    EXPECT_TRUE(preferences.SetInt64("int64", 1LL << 40));
+    EXPECT_TRUE(preferences.SetString("string", "value"));
+    EXPECT_TRUE(preferences.SetIntegerArray("ints", std::vector<int>{1, 2, 3}));
+    EXPECT_TRUE(preferences.SetTime("time", absl::FromUnixSeconds(100)));
+    EXPECT_TRUE(
+        preferences.Set("json", nlohmann::json{{"a", 1}, {"b", "text"}}));
+  }
+
+  BinaryPreferencesManager preferences(directory_);
+  EXPECT_TRUE(preferences.GetBoolean("bool", false));
+  EXPECT_EQ(preferences.GetInteger("int", 0), 34);
+  EXPECT_EQ(preferences.GetInt64("int64", 0), 1LL << 40);
+  EXPECT_EQ(preferences.GetString("string", ""), "value");
+  EXPECT_THAT(preferences.GetIntegerArray("ints", std::vector<int>{}),
+              ElementsAre(1, 2, 3));
+  EXPECT_EQ(preferences.GetTime("time", absl::InfinitePast()),
+            absl::FromUnixSeconds(100));
+  EXPECT_EQ(preferences.Get("json", nlohmann::json()),
+            (nlohmann::json{{"a", 1}, {"b", "text"}}));
+  EXPECT_EQ(preferences.GetInteger("missing", 7), 7);
+}
+
+TEST_F(BinaryPreferencesManagerTest, SettingTheSameValueDoesNotAppend) {
+  BinaryPreferencesManager preferences(directory_);
+  EXPECT_TRUE(preferences.SetInteger("int", 34));
+  size_t log_size = preferences.GetLogSize();
+
+  EXPECT_FALSE(preferences.SetInteger("int", 34));
+
+  EXPECT_EQ(preferences.GetLogSize(), log_size);
+}
+
+TEST_F(BinaryPreferencesManagerTest, RemovedValueStaysRemoved) {
+  {
+    BinaryPreferencesManager preferences(directory_);
+    preferences.SetString("kept", "1");
+    preferences.SetString("removed", "2");
+    preferences.Remove("removed");
+  }
+
+  BinaryPreferencesManager preferences(directory_);
+  EXPECT_EQ(preferences.GetString("kept", ""), "1");
+  EXPECT_EQ(preferences.GetString("removed", "default"), "default");
+}
+
+TEST_F(BinaryPreferencesManagerTest, MigratesJsonPreferences) {
+  std::filesystem::create_directories(directory_);
+  {
+    std::ofstream json_file(
+        std::filesystem::path(directory_) /
+        std::string(BinaryPreferencesManager::kJsonFileName));
+    json_file << R"({"name": "device", "count": 3})";
+  }
+
+  {
+    BinaryPreferencesManager preferences(directory_);
+    EXPECT_EQ(preferences.GetString("name", ""), "device");
+    EXPECT_EQ(preferences.GetInteger("count", 0), 3);
+    preferences.SetInteger("count", 4);
+  }
+
+  // The log wins over the JSON file once it exists.
+  BinaryPreferencesManager preferences(directory_);
+  EXPECT_EQ(preferences.GetInteger("count", 0), 4);
+}
+
+TEST_F(BinaryPreferencesManagerTest, CompactsOverwrittenValues) {
+  BinaryPreferencesManager preferences(directory_);
+  std::string value(100, 'x');
+  for (int i = 0; i < 1000; ++i) {
+    preferences.SetString("key", absl::StrCat(value, i));
+  }
+
+  EXPECT_LT(preferences.GetLogSize(), 8192);
+  EXPECT_EQ(std::filesystem::file_size(GetLogPath()),
+            preferences.GetLogSize());
+  EXPECT_EQ(BinaryPreferencesManager(directory_).GetString("key", ""),
+            absl::StrCat(value, 999));
+}
+
+TEST_F(BinaryPreferencesManagerTest, DropsTruncatedRecord) {
+  size_t log_size;
+  {
+    BinaryPreferencesManager preferences(directory_);
+    preferences.SetString("first", "1");
+    log_size = preferences.GetLogSize();
+    preferences.SetString("second", "2");
+  }
+  std::filesystem::resize_file(GetLogPath(), log_size + 5);
+
+  {
+    BinaryPreferencesManager preferences(directory_);
+    EXPECT_EQ(preferences.GetString("first", ""), "1");
+    EXPECT_EQ(preferences.GetString("second", "default"), "default");
+    preferences.SetString("third", "3");
+  }
+
+  BinaryPreferencesManager preferences(directory_);
+  EXPECT_EQ(preferences.GetString("first", ""), "1");
+  EXPECT_EQ(preferences.GetString("third", ""), "3");
+}
+
+}  // namespace
+}  // namespace shared
+}  // namespace nearby
@@ -14,11 +14,15 @@
 
 #include "internal/platform/implementation/shared/file.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <algorithm>
 #include <cstddef>
 #include <ios>
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
@@ -63,15 +67,17 @@ ExceptionOr<ByteArray> IOFile::Read(std::int64_t size) {
     return ExceptionOr<ByteArray>{Exception::kIo};
   }
 
-  ByteArray bytes(size);
-  std::unique_ptr<char[]> read_bytes{new char[size]};
-  file_.read(read_bytes.get(), static_cast<ptrdiff_t>(size));
+  // Read straight into the buffer that will back the returned ByteArray, so
+  // the chunk is not copied again on its way to the payload frame.
+  std::string read_bytes(size, '\0');
+  file_.read(&read_bytes[0], static_cast<ptrdiff_t>(size));
   auto num_bytes_read = file_.gcount();
   if (num_bytes_read == 0) {
     return ExceptionOr<ByteArray>{Exception::kIo};
   }
 
-  return ExceptionOr<ByteArray>(ByteArray(read_bytes.get(), num_bytes_read));
+  read_bytes.resize(num_bytes_read);
+  return ExceptionOr<ByteArray>(ByteArray(std::move(read_bytes)));
 }
 
 Exception IOFile::Close() {
@@ -100,5 +106,31 @@ Exception IOFile::Flush() {
   return {file_.good() ? Exception::kSuccess : Exception::kIo};
 }
 
+Exception IOFile::Preallocate(std::int64_t size) {
+  // std::fstream doesn't expose its descriptor, so reserve the space through
+  // a second one. The reservation belongs to the file, not the descriptor.
+  int fd = open(path_.c_str(), O_WRONLY);
+  if (fd < 0) {
+    return {Exception::kIo};
+  }
+#if defined(__linux__)
+  // Keep the file size, so that readers only ever see bytes that were written.
+  bool preallocated = fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, size) == 0;
+#elif defined(__APPLE__)
+  fstore_t store = {F_ALLOCATECONTIG | F_ALLOCATEALL, F_PEOFPOSMODE, 0, size,
+                    0};
+  bool preallocated = fcntl(fd, F_PREALLOCATE, &store) != -1;
+  if (!preallocated) {
+    // Contiguous space isn't available; any space will do.
+    store.fst_flags = F_ALLOCATEALL;
+    preallocated = fcntl(fd, F_PREALLOCATE, &store) != -1;
+  }
+#else
+  bool preallocated = false;
+#endif
+  close(fd);
+  return {preallocated ? Exception::kSuccess : Exception::kIo};
+}
+
 }  // namespace shared
 }  // namespace nearby
@@ -43,6 +43,7 @@ class IOFile final : public api::InputFile, public api::OutputFile {
 
   Exception Write(const ByteArray& data) override;
   Exception Flush() override;
+  Exception Preallocate(std::int64_t size) override;
 
  private:
   explicit IOFile(const absl::string_view file_path, size_t size);
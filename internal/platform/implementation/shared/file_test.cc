@@ -138,6 +138,17 @@ TEST_F(FileTest, IOFile_Write) {
   AssertEquals(io_file_input->Read(kMaxSize), "abc");
 }
 
+TEST_F(FileTest, IOFile_PreallocateKeepsWrittenSize) {
+  auto io_file_output = shared::IOFile::CreateOutputFile(path_);
+  io_file_output->Preallocate(1024);
+  EXPECT_EQ(io_file_output->Write(ByteArray("abc")),
+            Exception{Exception::kSuccess});
+  EXPECT_EQ(io_file_output->Close(), Exception{Exception::kSuccess});
+  auto io_file_input = shared::IOFile::CreateInputFile(path_, GetSize());
+  EXPECT_EQ(io_file_input->GetTotalSize(), 3);
+  AssertEquals(io_file_input->Read(kMaxSize), "abc");
+}
+
 TEST_F(FileTest, IOFile_CloseOutput) {
   auto io_file = shared::IOFile::CreateOutputFile(path_);
   io_file->Close();
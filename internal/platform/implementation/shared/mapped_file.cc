@@ -0,0 +1,100 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/implementation/shared/mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/string_view.h"
+#include "internal/platform/exception.h"
+
+namespace nearby {
+namespace shared {
+
+std::unique_ptr<MappedInputFile> MappedInputFile::Create(
+    absl::string_view file_path) {
+  int fd = open(std::string(file_path).c_str(), O_RDONLY);
+  if (fd < 0) return nullptr;
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode) ||
+      file_stat.st_size <= 0) {
+    close(fd);
+    return nullptr;
+  }
+
+  void* data = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+  if (data == MAP_FAILED) return nullptr;
+  // Payloads are read front to back; let the kernel read ahead aggressively.
+  madvise(data, file_stat.st_size, MADV_SEQUENTIAL);
+
+  return absl::WrapUnique(new MappedInputFile(
+      file_path, static_cast<const char*>(data), file_stat.st_size));
+}
+
+MappedInputFile::MappedInputFile(absl::string_view file_path, const char* data,
+                                 std::int64_t total_size)
+    : path_(file_path), data_(data), total_size_(total_size) {}
+
+MappedInputFile::~MappedInputFile() { Close(); }
+
+ExceptionOr<ByteArray> MappedInputFile::Read(std::int64_t size) {
+  if (data_ == nullptr || size < 0) {
+    return ExceptionOr<ByteArray>{Exception::kIo};
+  }
+
+  std::int64_t bytes_to_read = std::min(size, total_size_ - position_);
+  if (bytes_to_read <= 0) {
+    return ExceptionOr<ByteArray>{ByteArray{}};
+  }
+
+  ByteArray bytes(data_ + position_, bytes_to_read);
+  position_ += bytes_to_read;
+  return ExceptionOr<ByteArray>(std::move(bytes));
+}
+
+ExceptionOr<size_t> MappedInputFile::Skip(size_t offset) {
+  if (data_ == nullptr) {
+    return ExceptionOr<size_t>{Exception::kIo};
+  }
+
+  std::int64_t skipped = std::min(static_cast<std::int64_t>(offset),
+                                  total_size_ - position_);
+  position_ += skipped;
+  return ExceptionOr<size_t>(skipped);
+}
+
+Exception MappedInputFile::Close() {
+  if (data_ != nullptr) {
+    munmap(const_cast<char*>(data_), total_size_);
+    data_ = nullptr;
+  }
+  return {Exception::kSuccess};
+}
+
+}  // namespace shared
+}  // namespace nearby
@@ -0,0 +1,110 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/implementation/shared/mapped_file.h"
+
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "file/util/temp_path.h"
+#include "gtest/gtest.h"
+#include "absl/strings/string_view.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+
+namespace nearby {
+namespace shared {
+
+class MappedFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    temp_path_ = std::make_unique<TempPath>(TempPath::Local);
+    path_ = temp_path_->path() + "/file.txt";
+  }
+
+  void WriteToFile(absl::string_view text) {
+    std::ofstream output_file(path_, std::ios::binary);
+    output_file << text;
+  }
+
+  void AssertEquals(const ExceptionOr<ByteArray>& bytes,
+                    const std::string& expected) {
+    EXPECT_TRUE(bytes.ok());
+    EXPECT_EQ(std::string(bytes.result()), expected);
+  }
+
+  void AssertEmpty(const ExceptionOr<ByteArray>& bytes) {
+    EXPECT_TRUE(bytes.ok());
+    EXPECT_TRUE(bytes.result().Empty());
+  }
+
+  static constexpr int64_t kMaxSize = 3;
+
+  std::unique_ptr<TempPath> temp_path_;
+  std::string path_;
+};
+
+TEST_F(MappedFileTest, NonExistentPathIsNotMapped) {
+  EXPECT_EQ(MappedInputFile::Create("/not/a/valid/path.txt"), nullptr);
+}
+
+TEST_F(MappedFileTest, EmptyFileIsNotMapped) {
+  WriteToFile("");
+  EXPECT_EQ(MappedInputFile::Create(path_), nullptr);
+}
+
+TEST_F(MappedFileTest, GetFilePathAndTotalSize) {
+  WriteToFile("abc");
+  auto file = MappedInputFile::Create(path_);
+  ASSERT_NE(file, nullptr);
+  EXPECT_EQ(file->GetFilePath(), path_);
+  EXPECT_EQ(file->GetTotalSize(), 3);
+}
+
+TEST_F(MappedFileTest, ReadWithSizeUntilEOF) {
+  WriteToFile("abc");
+  auto file = MappedInputFile::Create(path_);
+  ASSERT_NE(file, nullptr);
+  AssertEquals(file->Read(2), "ab");
+  AssertEquals(file->Read(kMaxSize), "c");
+  AssertEmpty(file->Read(kMaxSize));
+}
+
+TEST_F(MappedFileTest, SkipMovesReadPosition) {
+  WriteToFile("abcdef");
+  auto file = MappedInputFile::Create(path_);
+  ASSERT_NE(file, nullptr);
+  ExceptionOr<size_t> skipped = file->Skip(2);
+  ASSERT_TRUE(skipped.ok());
+  EXPECT_EQ(skipped.result(), 2);
+  AssertEquals(file->Read(kMaxSize), "cde");
+  skipped = file->Skip(10);
+  ASSERT_TRUE(skipped.ok());
+  EXPECT_EQ(skipped.result(), 1);
+  AssertEmpty(file->Read(kMaxSize));
+}
+
+TEST_F(MappedFileTest, ReadAfterCloseFails) {
+  WriteToFile("abc");
+  auto file = MappedInputFile::Create(path_);
+  ASSERT_NE(file, nullptr);
+  file->Close();
+  ExceptionOr<ByteArray> read_result = file->Read(kMaxSize);
+  EXPECT_FALSE(read_result.ok());
+  EXPECT_TRUE(read_result.GetException().Raised(Exception::kIo));
+}
+
+}  // namespace shared
+}  // namespace nearby
@@ -0,0 +1,93 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "internal/platform/implementation/shared/strand.h"
+
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+#include "internal/platform/implementation/executor.h"
+#include "internal/platform/implementation/shared/work_stealing_executor.h"
+#include "internal/platform/runnable.h"
+
+namespace nearby {
+namespace shared {
+namespace {
+
+// The strand whose tasks the current thread is running, if any.
+thread_local const Strand* current_strand = nullptr;
+
+}  // namespace
+
+Strand::Strand(api::Executor& pool) : pool_(pool) {}
+
+Strand::~Strand() { Shutdown(); }
+
+void Strand::Execute(Runnable&& runnable) { Submit(std::move(runnable)); }
+
+bool Strand::DoSubmit(Runnable&& runnable) {
+  return Submit(std::move(runnable));
+}
+
+void Strand::Shutdown() {
+  absl::MutexLock lock(&mutex_);
+  shutdown_ = true;
+  if (current_strand == this) return;
+  while (scheduled_) {
+    idle_cond_.Wait(&mutex_);
+  }
+}
+
+api::Executor& Strand::GetSharedPool(int pool_size) {
+  static api::Executor* pool = new WorkStealingExecutor(pool_size);
+  return *pool;
+}
+
+bool Strand::Submit(Runnable&& runnable) {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (shutdown_) return false;
+    tasks_.push_back(std::move(runnable));
+    if (scheduled_) return true;
+    scheduled_ = true;
+  }
+  pool_.Execute([this]() { RunTasks(); });
+  return true;
+}
+
+void Strand::RunTasks() {
+  for (int i = 0; i < kMaxTasksPerTurn; ++i) {
+    Runnable task;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (tasks_.empty()) {
+        // The strand may be destroyed as soon as the lock is released.
+        scheduled_ = false;
+        idle_cond_.SignalAll();
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    current_strand = this;
+    task();
+    current_strand = nullptr;
+  }
+  // Still scheduled; let the other strands on the pool have a turn.
+  pool_.Execute([this]() { RunTasks(); });
+}
+
+}  // namespace shared
+}  // namespace nearby
@@ -0,0 +1,76 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef PLATFORM_IMPL_SHARED_STRAND_H_
+#define PLATFORM_IMPL_SHARED_STRAND_H_
+
+#include <deque>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "internal/platform/implementation/executor.h"
+#include "internal/platform/implementation/submittable_executor.h"
+#include "internal/platform/runnable.h"
+
+namespace nearby {
+namespace shared {
+
+// A single-thread executor without a thread of its own.
+//
+// Tasks run one at a time, in the order they were submitted, on the threads
+// of a pool shared with other strands. A strand only occupies a pool thread
+// while it has tasks to run, and hands the thread back between batches so that
+// one busy strand doesn't starve the others. Tasks that block still hold their
+// pool thread, so the pool has to be big enough for the strands that wait on
+// each other.
+class Strand final : public api::SubmittableExecutor {
+ public:
+  // Runs the tasks on `pool`, which must outlive the strand.
+  explicit Strand(api::Executor& pool);
+  Strand(const Strand&) = delete;
+  Strand& operator=(const Strand&) = delete;
+  ~Strand() override;
+
+  void Execute(Runnable&& runnable) override ABSL_LOCKS_EXCLUDED(mutex_);
+  bool DoSubmit(Runnable&& runnable) override ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Stops accepting tasks and waits for the queued ones to run. Called from
+  // one of the strand's own tasks, it returns without waiting.
+  void Shutdown() override ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the pool shared by every strand of the process. `pool_size` only
+  // matters to the first call, which creates the pool.
+  static api::Executor& GetSharedPool(int pool_size);
+
+ private:
+  // The number of tasks a strand runs before handing its pool thread back.
+  static constexpr int kMaxTasksPerTurn = 16;
+
+  bool Submit(Runnable&& runnable) ABSL_LOCKS_EXCLUDED(mutex_);
+  void RunTasks() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  api::Executor& pool_;
+  absl::Mutex mutex_;
+  absl::CondVar idle_cond_;
+  std::deque<Runnable> tasks_ ABSL_GUARDED_BY(mutex_);
+  // Whether RunTasks() is queued on or running on the pool.
+  bool scheduled_ ABSL_GUARDED_BY(mutex_) = false;
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+}  // namespace shared
+}  // namespace nearby
+
+#endif  // PLATFORM_IMPL_SHARED_STRAND_H_
@@ -0,0 +1,166 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "internal/platform/implementation/shared/strand.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "internal/platform/implementation/shared/work_stealing_executor.h"
+
+namespace nearby {
+namespace shared {
+namespace {
+
+constexpr absl::Duration kTimeout = absl::Seconds(5);
+
+TEST(StrandTest, RunsTasksInSubmissionOrder) {
+  WorkStealingExecutor pool(4);
+  Strand strand(pool);
+  std::vector<int> order;
+
+  for (int i = 0; i < 100; ++i) {
+    strand.Execute([&order, i]() { order.push_back(i); });
+  }
+  strand.Shutdown();
+
+  ASSERT_EQ(order.size(), 100);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(order[i], i);
+  }
+}
+
+TEST(StrandTest, RunsOneTaskAtATime) {
+  WorkStealingExecutor pool(4);
+  std::vector<std::unique_ptr<Strand>> strands;
+  std::vector<std::unique_ptr<std::atomic<int>>> running;
+  std::atomic_bool overlapped = false;
+
+  for (int i = 0; i < 4; ++i) {
+    strands.push_back(std::make_unique<Strand>(pool));
+    running.push_back(std::make_unique<std::atomic<int>>(0));
+  }
+  for (int task = 0; task < 20; ++task) {
+    for (int i = 0; i < 4; ++i) {
+      std::atomic<int>& count = *running[i];
+      strands[i]->Execute([&count, &overlapped]() {
+        if (++count > 1) overlapped = true;
+        absl::SleepFor(absl::Milliseconds(1));
+        --count;
+      });
+    }
+  }
+  for (auto& strand : strands) {
+    strand->Shutdown();
+  }
+
+  EXPECT_FALSE(overlapped);
+}
+
+TEST(StrandTest, ManyStrandsShareThePoolThreads) {
+  WorkStealingExecutor pool(2);
+  std::vector<std::unique_ptr<Strand>> strands;
+  absl::Mutex mutex;
+  absl::flat_hash_set<std::thread::id> threads;
+  absl::BlockingCounter done(100);
+
+  for (int i = 0; i < 100; ++i) {
+    strands.push_back(std::make_unique<Strand>(pool));
+    strands.back()->Execute([&]() {
+      {
+        absl::MutexLock lock(&mutex);
+        threads.insert(std::this_thread::get_id());
+      }
+      done.DecrementCount();
+    });
+  }
+
+  done.Wait();
+  absl::MutexLock lock(&mutex);
+  EXPECT_LE(threads.size(), 2);
+}
+
+TEST(StrandTest, BusyStrandDoesNotStarveOthers) {
+  WorkStealingExecutor pool(1);
+  Strand busy(pool);
+  Strand other(pool);
+  std::atomic_bool stop = false;
+  absl::Notification other_ran;
+
+  // Keeps `busy` non-empty until `other` gets a turn.
+  for (int i = 0; i < 1000; ++i) {
+    busy.Execute([&stop]() {
+      if (!stop) absl::SleepFor(absl::Microseconds(100));
+    });
+  }
+  other.Execute([&]() {
+    stop = true;
+    other_ran.Notify();
+  });
+
+  EXPECT_TRUE(other_ran.WaitForNotificationWithTimeout(kTimeout));
+}
+
+TEST(StrandTest, ShutdownWaitsForQueuedTasks) {
+  WorkStealingExecutor pool(2);
+  Strand strand(pool);
+  std::atomic<int> count = 0;
+
+  for (int i = 0; i < 10; ++i) {
+    strand.Execute([&count]() {
+      absl::SleepFor(absl::Milliseconds(5));
+      ++count;
+    });
+  }
+  strand.Shutdown();
+
+  EXPECT_EQ(count, 10);
+}
+
+TEST(StrandTest, DoSubmitFailsAfterShutdown) {
+  WorkStealingExecutor pool(1);
+  Strand strand(pool);
+
+  strand.Shutdown();
+
+  EXPECT_FALSE(strand.DoSubmit([]() {}));
+}
+
+TEST(StrandTest, ShutdownFromOwnTaskDoesNotWait) {
+  WorkStealingExecutor pool(1);
+  Strand strand(pool);
+  absl::Notification done;
+
+  strand.Execute([&]() {
+    strand.Shutdown();
+    done.Notify();
+  });
+
+  EXPECT_TRUE(done.WaitForNotificationWithTimeout(kTimeout));
+  strand.Shutdown();
+}
+
+}  // namespace
+}  // namespace shared
+}  // namespace nearby
@@ -0,0 +1,263 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "internal/platform/implementation/shared/timer_wheel.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "internal/platform/implementation/cancelable.h"
+#include "internal/platform/runnable.h"
+
+namespace nearby {
+namespace shared {
+
+// A pending timer. Everything but `wheel` is guarded by the wheel's mutex.
+class TimerWheel::Timer : public api::Cancelable {
+ public:
+  Timer(TimerWheel* wheel, Runnable&& task)
+      : wheel(wheel), task(std::move(task)) {}
+
+  bool Cancel() override { return wheel->Cancel(this); }
+
+  TimerWheel* const wheel;
+  Runnable task;
+  uint64_t deadline = 0;
+  // The level the timer is linked into, or -1 once it fired or was cancelled.
+  int level = -1;
+  size_t slot = 0;
+  Timer* prev = nullptr;
+  Timer* next = nullptr;
+  // Keeps the timer alive while it is linked into the wheel.
+  std::shared_ptr<Timer> self;
+};
+
+TimerWheel::TimerWheel()
+    : start_(std::chrono::steady_clock::now()),
+      thread_([this]() { Run(); }) {}
+
+TimerWheel::~TimerWheel() {
+  {
+    absl::MutexLock lock(&mutex_);
+    shutdown_ = true;
+    cond_.Signal();
+  }
+  thread_.join();
+
+  std::vector<std::shared_ptr<Timer>> dropped;
+  {
+    absl::MutexLock lock(&mutex_);
+    for (auto& level : wheel_) {
+      for (Slot& slot : level) {
+        while (slot.head != nullptr) {
+          Timer* timer = slot.head;
+          Unlink(timer);
+          dropped.push_back(std::move(timer->self));
+        }
+      }
+    }
+  }
+}
+
+TimerWheel& TimerWheel::GetInstance() {
+  static TimerWheel* instance = new TimerWheel();
+  return *instance;
+}
+
+std::shared_ptr<api::Cancelable> TimerWheel::Schedule(Runnable&& runnable,
+                                                      absl::Duration delay) {
+  auto timer = std::make_shared<Timer>(this, std::move(runnable));
+  uint64_t delay_ticks = static_cast<uint64_t>(std::max<int64_t>(
+      absl::ToInt64Milliseconds(absl::Ceil(delay, absl::Milliseconds(1))), 0));
+
+  absl::MutexLock lock(&mutex_);
+  if (shutdown_) return timer;
+  // The current tick has partly passed already, so a task never runs early.
+  timer->deadline = std::max(NowTick() + delay_ticks + 1, current_tick_ + 1);
+  timer->self = timer;
+  Link(timer.get());
+  if (timer->deadline < wake_tick_) {
+    cond_.Signal();
+  }
+  return timer;
+}
+
+size_t TimerWheel::GetPendingCount() const {
+  absl::MutexLock lock(&mutex_);
+  size_t count = 0;
+  for (size_t level_count : level_counts_) count += level_count;
+  return count;
+}
+
+uint64_t TimerWheel::NowTick() const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now() - start_)
+      .count();
+}
+
+void TimerWheel::Link(Timer* timer) {
+  // Level n holds the timers due within 2^(8 * (n + 1)) ticks. Timers beyond
+  // the last level are parked at its far end and re-linked when it cascades.
+  uint64_t delta = timer->deadline - current_tick_;
+  int level = 0;
+  while (level < kLevels - 1 &&
+         delta >= (uint64_t{1} << (kSlotBits * (level + 1)))) {
+    ++level;
+  }
+  uint64_t tick = timer->deadline;
+  if (level == kLevels - 1) {
+    tick = std::min(
+        tick, current_tick_ + (uint64_t{1} << (kSlotBits * kLevels)) - 1);
+  }
+  timer->level = level;
+  timer->slot = (tick >> (kSlotBits * level)) & (kSlots - 1);
+
+  Slot& slot = wheel_[level][timer->slot];
+  timer->prev = nullptr;
+  timer->next = slot.head;
+  if (slot.head != nullptr) slot.head->prev = timer;
+  slot.head = timer;
+  ++level_counts_[level];
+}
+
+void TimerWheel::Unlink(Timer* timer) {
+  Slot& slot = wheel_[timer->level][timer->slot];
+  if (timer->prev != nullptr) {
+    timer->prev->next = timer->next;
+  } else {
+    slot.head = timer->next;
+  }
+  if (timer->next != nullptr) timer->next->prev = timer->prev;
+  --level_counts_[timer->level];
+  timer->prev = nullptr;
+  timer->next = nullptr;
+  timer->level = -1;
+}
+
+bool TimerWheel::Cancel(Timer* timer) {
+  Runnable task;
+  std::shared_ptr<Timer> self;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (timer->level < 0) return false;
+    Unlink(timer);
+    task = std::move(timer->task);
+    self = std::move(timer->self);
+  }
+  // The task and possibly the timer itself are released here, with the mutex
+  // unlocked.
+  return true;
+}
+
+void TimerWheel::Cascade(int level) {
+  Slot& slot =
+      wheel_[level][(current_tick_ >> (kSlotBits * level)) & (kSlots - 1)];
+  Timer* timer = slot.head;
+  slot.head = nullptr;
+  while (timer != nullptr) {
+    Timer* next = timer->next;
+    --level_counts_[level];
+    Link(timer);
+    timer = next;
+  }
+}
+
+uint64_t TimerWheel::NextEventTick() const {
+  uint64_t next = UINT64_MAX;
+  if (level_counts_[0] > 0) {
+    for (uint64_t tick = current_tick_ + 1; tick < current_tick_ + kSlots;
+         ++tick) {
+      if (wheel_[0][tick & (kSlots - 1)].head != nullptr) {
+        next = tick;
+        break;
+      }
+    }
+  }
+  // Higher levels only change when the lowest non-empty one cascades.
+  for (int level = 1; level < kLevels; ++level) {
+    if (level_counts_[level] > 0) {
+      int shift = kSlotBits * level;
+      next = std::min(next, ((current_tick_ >> shift) + 1) << shift);
+      break;
+    }
+  }
+  return next;
+}
+
+void TimerWheel::AdvanceTo(uint64_t tick, std::vector<Runnable>& due) {
+  while (current_tick_ < tick) {
+    uint64_t next = NextEventTick();
+    if (next > tick) {
+      current_tick_ = tick;
+      return;
+    }
+    current_tick_ = next;
+    if ((current_tick_ & (kSlots - 1)) == 0) {
+      int top = 1;
+      while (top < kLevels - 1 &&
+             ((current_tick_ >> (kSlotBits * top)) & (kSlots - 1)) == 0) {
+        ++top;
+      }
+      for (int level = top; level > 0; --level) {
+        Cascade(level);
+      }
+    }
+    Slot& slot = wheel_[0][current_tick_ & (kSlots - 1)];
+    while (slot.head != nullptr) {
+      Timer* timer = slot.head;
+      Unlink(timer);
+      due.push_back(std::move(timer->task));
+      timer->self.reset();
+    }
+  }
+}
+
+void TimerWheel::Run() {
+  while (true) {
+    std::vector<Runnable> due;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (shutdown_) return;
+      AdvanceTo(NowTick(), due);
+      if (due.empty()) {
+        wake_tick_ = NextEventTick();
+        if (wake_tick_ == UINT64_MAX) {
+          cond_.Wait(&mutex_);
+        } else {
+          cond_.WaitWithTimeout(
+              &mutex_, absl::FromChrono(start_ +
+                                        std::chrono::milliseconds(wake_tick_) -
+                                        std::chrono::steady_clock::now()));
+        }
+        wake_tick_ = UINT64_MAX;
+        continue;
+      }
+    }
+    for (Runnable& task : due) {
+      task();
+    }
+  }
+}
+
+}  // namespace shared
+}  // namespace nearby
@@ -0,0 +1,107 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef PLATFORM_IMPL_SHARED_TIMER_WHEEL_H_
+#define PLATFORM_IMPL_SHARED_TIMER_WHEEL_H_
+
+#include <array>
+#include <chrono>  // NOLINT
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "internal/platform/implementation/cancelable.h"
+#include "internal/platform/runnable.h"
+
+namespace nearby {
+namespace shared {
+
+// Runs delayed tasks off a single thread using a hierarchical timer wheel.
+//
+// Timers are bucketed by deadline into four levels of 256 slots each, with a
+// resolution of one millisecond. Scheduling and cancelling a timer take
+// constant time no matter how many timers are pending, and the thread only
+// wakes up when a slot is due. Tasks run on the wheel's thread and must be
+// short; callers normally hand the real work over to their own executor.
+class TimerWheel {
+ public:
+  TimerWheel();
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+  // Drops the pending timers without running them.
+  ~TimerWheel();
+
+  // The wheel shared by the platform executors. It is never destroyed.
+  static TimerWheel& GetInstance();
+
+  // Runs `runnable` once `delay` has passed, unless the returned Cancelable is
+  // cancelled first.
+  std::shared_ptr<api::Cancelable> Schedule(Runnable&& runnable,
+                                            absl::Duration delay)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of pending timers.
+  size_t GetPendingCount() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  static constexpr int kLevels = 4;
+  static constexpr int kSlotBits = 8;
+  static constexpr size_t kSlots = 1 << kSlotBits;
+
+  class Timer;
+
+  // An intrusive list of the timers in one slot.
+  struct Slot {
+    Timer* head = nullptr;
+  };
+
+  uint64_t NowTick() const;
+  void Link(Timer* timer) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void Unlink(Timer* timer) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  bool Cancel(Timer* timer) ABSL_LOCKS_EXCLUDED(mutex_);
+  // Moves the timers of a higher level slot down the wheel.
+  void Cascade(int level) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Returns the earliest tick at which something has to be done, or
+  // UINT64_MAX if no timer is pending.
+  uint64_t NextEventTick() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Advances the wheel to `tick` and moves the tasks due by then to `due`.
+  void AdvanceTo(uint64_t tick, std::vector<Runnable>& due)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void Run();
+
+  const std::chrono::steady_clock::time_point start_;
+
+  mutable absl::Mutex mutex_;
+  absl::CondVar cond_;
+  std::array<std::array<Slot, kSlots>, kLevels> wheel_ ABSL_GUARDED_BY(mutex_);
+  std::array<size_t, kLevels> level_counts_ ABSL_GUARDED_BY(mutex_) = {};
+  // Ticks are milliseconds since `start_`.
+  uint64_t current_tick_ ABSL_GUARDED_BY(mutex_) = 0;
+  // The tick the thread sleeps until, so that earlier timers wake it up.
+  uint64_t wake_tick_ ABSL_GUARDED_BY(mutex_) = UINT64_MAX;
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+
+  std::thread thread_;
+};
+
+}  // namespace shared
+}  // namespace nearby
+
+#endif  // PLATFORM_IMPL_SHARED_TIMER_WHEEL_H_
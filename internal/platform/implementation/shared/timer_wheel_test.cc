@@ -0,0 +1,143 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "internal/platform/implementation/shared/timer_wheel.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "internal/platform/implementation/cancelable.h"
+
+namespace nearby {
+namespace shared {
+namespace {
+
+constexpr absl::Duration kTimeout = absl::Seconds(5);
+
+TEST(TimerWheelTest, RunsTaskAfterDelay) {
+  TimerWheel wheel;
+  absl::Notification done;
+  absl::Time start = absl::Now();
+
+  wheel.Schedule([&done]() { done.Notify(); }, absl::Milliseconds(50));
+
+  ASSERT_TRUE(done.WaitForNotificationWithTimeout(kTimeout));
+  EXPECT_GE(absl::Now() - start, absl::Milliseconds(50));
+  EXPECT_EQ(wheel.GetPendingCount(), 0);
+}
+
+TEST(TimerWheelTest, RunsTasksInDeadlineOrder) {
+  TimerWheel wheel;
+  absl::Mutex mutex;
+  std::vector<int> order;
+  absl::Notification done;
+
+  // Spans a cascade from the second level of the wheel.
+  wheel.Schedule(
+      [&]() {
+        absl::MutexLock lock(&mutex);
+        order.push_back(3);
+        done.Notify();
+      },
+      absl::Milliseconds(300));
+  wheel.Schedule(
+      [&]() {
+        absl::MutexLock lock(&mutex);
+        order.push_back(1);
+      },
+      absl::Milliseconds(10));
+  wheel.Schedule(
+      [&]() {
+        absl::MutexLock lock(&mutex);
+        order.push_back(2);
+      },
+      absl::Milliseconds(100));
+
+  ASSERT_TRUE(done.WaitForNotificationWithTimeout(kTimeout));
+  absl::MutexLock lock(&mutex);
+  EXPECT_EQ(order, (std::vector<int>{1, 2, 3}));
+}
+
+TEST(TimerWheelTest, RunsZeroDelayTask) {
+  TimerWheel wheel;
+  absl::Notification done;
+
+  wheel.Schedule([&done]() { done.Notify(); }, absl::ZeroDuration());
+
+  EXPECT_TRUE(done.WaitForNotificationWithTimeout(kTimeout));
+}
+
+TEST(TimerWheelTest, CancelledTaskDoesNotRun) {
+  TimerWheel wheel;
+  std::atomic_bool ran = false;
+  absl::Notification later_done;
+
+  std::shared_ptr<api::Cancelable> timer =
+      wheel.Schedule([&ran]() { ran = true; }, absl::Milliseconds(20));
+  wheel.Schedule([&later_done]() { later_done.Notify(); },
+                 absl::Milliseconds(40));
+
+  EXPECT_TRUE(timer->Cancel());
+  EXPECT_EQ(wheel.GetPendingCount(), 1);
+  ASSERT_TRUE(later_done.WaitForNotificationWithTimeout(kTimeout));
+  EXPECT_FALSE(ran);
+}
+
+TEST(TimerWheelTest, CancelAfterRunFails) {
+  TimerWheel wheel;
+  absl::Notification done;
+
+  std::shared_ptr<api::Cancelable> timer =
+      wheel.Schedule([&done]() { done.Notify(); }, absl::Milliseconds(1));
+
+  ASSERT_TRUE(done.WaitForNotificationWithTimeout(kTimeout));
+  EXPECT_FALSE(timer->Cancel());
+}
+
+TEST(TimerWheelTest, CancelsManyTimers) {
+  TimerWheel wheel;
+  std::vector<std::shared_ptr<api::Cancelable>> timers;
+
+  for (int i = 0; i < 10000; ++i) {
+    timers.push_back(wheel.Schedule([]() {}, absl::Minutes(1 + i % 100)));
+  }
+  EXPECT_EQ(wheel.GetPendingCount(), 10000);
+  for (auto& timer : timers) {
+    EXPECT_TRUE(timer->Cancel());
+  }
+
+  EXPECT_EQ(wheel.GetPendingCount(), 0);
+}
+
+TEST(TimerWheelTest, DestructionDropsPendingTimers) {
+  std::atomic_bool ran = false;
+  std::shared_ptr<api::Cancelable> timer;
+  {
+    TimerWheel wheel;
+    timer = wheel.Schedule([&ran]() { ran = true; }, absl::Hours(1));
+  }
+
+  EXPECT_FALSE(ran);
+}
+
+}  // namespace
+}  // namespace shared
+}  // namespace nearby
@@ -0,0 +1,141 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "internal/platform/implementation/shared/work_stealing_executor.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+#include "internal/platform/runnable.h"
+
+namespace nearby {
+namespace shared {
+namespace {
+
+// The executor and queue owned by the current thread, if it is a worker.
+thread_local const WorkStealingExecutor* current_executor = nullptr;
+thread_local size_t current_worker = 0;
+
+}  // namespace
+
+WorkStealingExecutor::WorkStealingExecutor(int max_parallelism) {
+  size_t worker_count = std::max(max_parallelism, 1);
+  workers_.reserve(worker_count);
+  for (size_t i = 0; i < worker_count; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  // Threads start once every queue exists, since they steal from all of them.
+  for (size_t i = 0; i < worker_count; ++i) {
+    workers_[i]->thread = std::thread([this, i]() { RunWorker(i); });
+  }
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() { Shutdown(); }
+
+void WorkStealingExecutor::Execute(Runnable&& runnable) {
+  if (shutdown_) return;
+  Push(std::move(runnable));
+}
+
+bool WorkStealingExecutor::DoSubmit(Runnable&& runnable) {
+  if (shutdown_) return false;
+  Push(std::move(runnable));
+  return true;
+}
+
+void WorkStealingExecutor::Shutdown() {
+  shutdown_ = true;
+  {
+    absl::MutexLock lock(&idle_mutex_);
+    idle_cond_.SignalAll();
+  }
+  absl::MutexLock lock(&shutdown_mutex_);
+  for (auto& worker : workers_) {
+    if (!worker->thread.joinable()) continue;
+    if (worker->thread.get_id() == std::this_thread::get_id()) {
+      worker->thread.detach();
+    } else {
+      worker->thread.join();
+    }
+  }
+}
+
+void WorkStealingExecutor::Push(Runnable&& runnable) {
+  size_t worker = current_executor == this
+                      ? current_worker
+                      : next_worker_.fetch_add(1) % workers_.size();
+  {
+    absl::MutexLock lock(&workers_[worker]->mutex);
+    workers_[worker]->tasks.push_back(std::move(runnable));
+  }
+  // An idle thread registers itself before checking for pending tasks, so
+  // either it sees this task or we see it and wake it up.
+  ++pending_tasks_;
+  if (idle_workers_ > 0) {
+    absl::MutexLock lock(&idle_mutex_);
+    idle_cond_.Signal();
+  }
+}
+
+Runnable WorkStealingExecutor::Take(size_t worker) {
+  {
+    Worker& own = *workers_[worker];
+    absl::MutexLock lock(&own.mutex);
+    if (!own.tasks.empty()) {
+      Runnable task = std::move(own.tasks.front());
+      own.tasks.pop_front();
+      --pending_tasks_;
+      return task;
+    }
+  }
+  for (size_t i = 1; i < workers_.size(); ++i) {
+    Worker& victim = *workers_[(worker + i) % workers_.size()];
+    absl::MutexLock lock(&victim.mutex);
+    if (!victim.tasks.empty()) {
+      Runnable task = std::move(victim.tasks.back());
+      victim.tasks.pop_back();
+      --pending_tasks_;
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+void WorkStealingExecutor::RunWorker(size_t worker) {
+  current_executor = this;
+  current_worker = worker;
+  while (true) {
+    Runnable task = Take(worker);
+    if (task) {
+      task();
+      continue;
+    }
+    absl::MutexLock lock(&idle_mutex_);
+    ++idle_workers_;
+    while (pending_tasks_ == 0 && !shutdown_) {
+      idle_cond_.Wait(&idle_mutex_);
+    }
+    --idle_workers_;
+    // Queued tasks still run after shutdown; nothing new can be queued.
+    if (pending_tasks_ == 0 && shutdown_) return;
+  }
+}
+
+}  // namespace shared
+}  // namespace nearby
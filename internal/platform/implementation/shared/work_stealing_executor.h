@@ -0,0 +1,88 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef PLATFORM_IMPL_SHARED_WORK_STEALING_EXECUTOR_H_
+#define PLATFORM_IMPL_SHARED_WORK_STEALING_EXECUTOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "internal/platform/implementation/submittable_executor.h"
+#include "internal/platform/runnable.h"
+
+namespace nearby {
+namespace shared {
+
+// An Executor that runs tasks on a fixed number of threads, each with its own
+// task queue.
+//
+// Tasks submitted by one of the executor's threads go to that thread's queue;
+// other tasks are spread over the queues round-robin. A thread that runs out of
+// tasks steals from the other queues before going to sleep, so submitters and
+// workers rarely contend on the same lock. Like any multi-thread executor, it
+// gives no ordering guarantee between tasks.
+class WorkStealingExecutor final : public api::SubmittableExecutor {
+ public:
+  explicit WorkStealingExecutor(int max_parallelism);
+  WorkStealingExecutor(const WorkStealingExecutor&) = delete;
+  WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+  ~WorkStealingExecutor() override;
+
+  void Execute(Runnable&& runnable) override;
+  bool DoSubmit(Runnable&& runnable) override;
+
+  // Stops accepting tasks, runs the tasks already queued and joins the
+  // threads. Called from one of the executor's own tasks, it doesn't wait for
+  // that task's thread.
+  void Shutdown() override;
+
+ private:
+  struct Worker {
+    absl::Mutex mutex;
+    std::deque<Runnable> tasks ABSL_GUARDED_BY(mutex);
+    std::thread thread;
+  };
+
+  void Push(Runnable&& runnable);
+  // Takes a task from the front of `worker`'s own queue, or else from the back
+  // of another queue. Returns an empty Runnable if every queue is empty.
+  Runnable Take(size_t worker);
+  void RunWorker(size_t worker);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<size_t> next_worker_ = 0;
+  // Tasks pushed and not taken yet.
+  std::atomic<int> pending_tasks_ = 0;
+  std::atomic_bool shutdown_ = false;
+
+  // Only used to put idle threads to sleep and to wake them up.
+  absl::Mutex idle_mutex_;
+  absl::CondVar idle_cond_;
+  std::atomic<int> idle_workers_ = 0;
+
+  // Serializes joining the threads.
+  absl::Mutex shutdown_mutex_;
+};
+
+}  // namespace shared
+}  // namespace nearby
+
+#endif  // PLATFORM_IMPL_SHARED_WORK_STEALING_EXECUTOR_H_
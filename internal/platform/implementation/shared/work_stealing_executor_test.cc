@@ -0,0 +1,110 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "internal/platform/implementation/shared/work_stealing_executor.h"
+
+#include <atomic>
+
+#include "gtest/gtest.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+
+namespace nearby {
+namespace shared {
+namespace {
+
+constexpr absl::Duration kTimeout = absl::Seconds(5);
+
+TEST(WorkStealingExecutorTest, RunsEveryTaskBeforeShutdownReturns) {
+  WorkStealingExecutor executor(4);
+  std::atomic<int> count = 0;
+
+  for (int i = 0; i < 1000; ++i) {
+    executor.Execute([&count]() { ++count; });
+  }
+  executor.Shutdown();
+
+  EXPECT_EQ(count, 1000);
+}
+
+TEST(WorkStealingExecutorTest, RunsTasksInParallel) {
+  WorkStealingExecutor executor(2);
+  absl::Notification running[2];
+  absl::BlockingCounter done(2);
+
+  // Each task only finishes once the other one is running too.
+  for (int i = 0; i < 2; ++i) {
+    executor.Execute([&, i]() {
+      running[i].Notify();
+      EXPECT_TRUE(running[1 - i].WaitForNotificationWithTimeout(kTimeout));
+      done.DecrementCount();
+    });
+  }
+
+  done.Wait();
+}
+
+TEST(WorkStealingExecutorTest, IdleThreadStealsQueuedTask) {
+  WorkStealingExecutor executor(2);
+  absl::Notification stolen_task_ran;
+  absl::Notification done;
+
+  executor.Execute([&]() {
+    // Queued behind the running task on this thread, so only the other
+    // thread can run it.
+    executor.Execute([&]() { stolen_task_ran.Notify(); });
+    EXPECT_TRUE(stolen_task_ran.WaitForNotificationWithTimeout(kTimeout));
+    done.Notify();
+  });
+
+  EXPECT_TRUE(done.WaitForNotificationWithTimeout(kTimeout));
+}
+
+TEST(WorkStealingExecutorTest, RunsTasksSubmittedFromTasks) {
+  WorkStealingExecutor executor(3);
+  absl::BlockingCounter done(100);
+
+  executor.Execute([&]() {
+    for (int i = 0; i < 100; ++i) {
+      executor.Execute([&done]() { done.DecrementCount(); });
+    }
+  });
+
+  done.Wait();
+}
+
+TEST(WorkStealingExecutorTest, DoSubmitFailsAfterShutdown) {
+  WorkStealingExecutor executor(1);
+  bool ran = false;
+
+  executor.Shutdown();
+
+  EXPECT_FALSE(executor.DoSubmit([&ran]() { ran = true; }));
+  executor.Execute([&ran]() { ran = true; });
+  EXPECT_FALSE(ran);
+}
+
+TEST(WorkStealingExecutorTest, ShutdownTwiceIsSafe) {
+  WorkStealingExecutor executor(2);
+  EXPECT_TRUE(executor.DoSubmit([]() {}));
+
+  executor.Shutdown();
+  executor.Shutdown();
+}
+
+}  // namespace
+}  // namespace shared
+}  // namespace nearby
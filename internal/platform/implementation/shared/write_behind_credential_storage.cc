@@ -0,0 +1,149 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/implementation/shared/write_behind_credential_storage.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "internal/platform/implementation/credential_callbacks.h"
+#include "internal/platform/implementation/credential_storage.h"
+#include "internal/platform/implementation/submittable_executor.h"
+
+namespace nearby {
+namespace shared {
+
+WriteBehindCredentialStorage::WriteBehindCredentialStorage(
+    std::unique_ptr<api::CredentialStorage> storage,
+    std::unique_ptr<api::SubmittableExecutor> executor)
+    : storage_(std::move(storage)), executor_(std::move(executor)) {}
+
+WriteBehindCredentialStorage::~WriteBehindCredentialStorage() {
+  executor_->Shutdown();
+}
+
+void WriteBehindCredentialStorage::SaveCredentials(
+    absl::string_view manager_app_id, absl::string_view account_name,
+    const std::vector<LocalCredential>& private_credentials,
+    const std::vector<SharedCredential>& public_credentials,
+    PublicCredentialType public_credential_type,
+    SaveCredentialsResultCallback callback) {
+  // A save without credentials fails on its own, so it's never merged.
+  if (!private_credentials.empty() || !public_credentials.empty()) {
+    absl::MutexLock lock(&mutex_);
+    if (!pending_.empty() && pending_.back().save.has_value()) {
+      Save& save = *pending_.back().save;
+      if (save.manager_app_id == manager_app_id &&
+          save.account_name == account_name &&
+          save.public_credential_type == public_credential_type &&
+          (!save.private_credentials.empty() ||
+           !save.public_credentials.empty())) {
+        // Same as running the saves one after the other, each list replaces
+        // the stored one only if it isn't empty.
+        if (!private_credentials.empty()) {
+          save.private_credentials = private_credentials;
+        }
+        if (!public_credentials.empty()) {
+          save.public_credentials = public_credentials;
+        }
+        save.callbacks.push_back(std::move(callback));
+        return;
+      }
+    }
+  }
+  Save save{.manager_app_id = std::string(manager_app_id),
+            .account_name = std::string(account_name),
+            .private_credentials = private_credentials,
+            .public_credentials = public_credentials,
+            .public_credential_type = public_credential_type};
+  save.callbacks.push_back(std::move(callback));
+  Enqueue({.save = std::move(save)});
+}
+
+void WriteBehindCredentialStorage::UpdateLocalCredential(
+    absl::string_view manager_app_id, absl::string_view account_name,
+    LocalCredential credential, SaveCredentialsResultCallback callback) {
+  Enqueue({.run = [this, manager_app_id = std::string(manager_app_id),
+                   account_name = std::string(account_name),
+                   credential = std::move(credential),
+                   callback = std::move(callback)]() mutable {
+    storage_->UpdateLocalCredential(manager_app_id, account_name,
+                                    std::move(credential),
+                                    std::move(callback));
+  }});
+}
+
+void WriteBehindCredentialStorage::GetLocalCredentials(
+    const CredentialSelector& credential_selector,
+    GetLocalCredentialsResultCallback callback) {
+  Enqueue({.run = [this, credential_selector,
+                   callback = std::move(callback)]() mutable {
+    storage_->GetLocalCredentials(credential_selector, std::move(callback));
+  }});
+}
+
+void WriteBehindCredentialStorage::GetPublicCredentials(
+    const CredentialSelector& credential_selector,
+    PublicCredentialType public_credential_type,
+    GetPublicCredentialsResultCallback callback) {
+  Enqueue({.run = [this, credential_selector, public_credential_type,
+                   callback = std::move(callback)]() mutable {
+    storage_->GetPublicCredentials(credential_selector, public_credential_type,
+                                   std::move(callback));
+  }});
+}
+
+void WriteBehindCredentialStorage::Enqueue(Operation operation) {
+  {
+    absl::MutexLock lock(&mutex_);
+    pending_.push_back(std::move(operation));
+  }
+  executor_->Execute([this]() { RunNext(); });
+}
+
+void WriteBehindCredentialStorage::RunNext() {
+  Operation operation;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (pending_.empty()) return;
+    operation = std::move(pending_.front());
+    pending_.pop_front();
+  }
+  if (!operation.save.has_value()) {
+    operation.run();
+    return;
+  }
+  Save& save = *operation.save;
+  storage_->SaveCredentials(
+      save.manager_app_id, save.account_name, save.private_credentials,
+      save.public_credentials, save.public_credential_type,
+      SaveCredentialsResultCallback{
+          .credentials_saved_cb =
+              [callbacks = std::move(save.callbacks)](
+                  absl::Status status) mutable {
+                for (SaveCredentialsResultCallback& callback : callbacks) {
+                  if (callback.credentials_saved_cb) {
+                    callback.credentials_saved_cb(status);
+                  }
+                }
+              }});
+}
+
+}  // namespace shared
+}  // namespace nearby
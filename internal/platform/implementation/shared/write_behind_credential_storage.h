@@ -0,0 +1,108 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PLATFORM_IMPL_SHARED_WRITE_BEHIND_CREDENTIAL_STORAGE_H_
+#define PLATFORM_IMPL_SHARED_WRITE_BEHIND_CREDENTIAL_STORAGE_H_
+
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "internal/platform/implementation/credential_storage.h"
+#include "internal/platform/implementation/submittable_executor.h"
+#include "internal/platform/runnable.h"
+
+namespace nearby {
+namespace shared {
+
+// A credential storage that runs the operations of another one on an
+// executor, so that callers don't wait for the storage.
+//
+// Operations run one at a time, in the order they were called, so a fetch
+// sees every save made before it. A save for the same manager app, account
+// and public credential type as the last queued operation is merged into it
+// when that operation hasn't started yet, which turns a burst of credential
+// rotations into a single write. Callbacks are called on the executor.
+class WriteBehindCredentialStorage final : public api::CredentialStorage {
+ public:
+  // `executor` must run one task at a time, e.g. a single-thread executor.
+  WriteBehindCredentialStorage(
+      std::unique_ptr<api::CredentialStorage> storage,
+      std::unique_ptr<api::SubmittableExecutor> executor);
+  WriteBehindCredentialStorage(const WriteBehindCredentialStorage&) = delete;
+  WriteBehindCredentialStorage& operator=(const WriteBehindCredentialStorage&) =
+      delete;
+  // Waits for the queued operations to run.
+  ~WriteBehindCredentialStorage() override;
+
+  void SaveCredentials(absl::string_view manager_app_id,
+                       absl::string_view account_name,
+                       const std::vector<LocalCredential>& private_credentials,
+                       const std::vector<SharedCredential>& public_credentials,
+                       PublicCredentialType public_credential_type,
+                       SaveCredentialsResultCallback callback) override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  void UpdateLocalCredential(absl::string_view manager_app_id,
+                             absl::string_view account_name,
+                             LocalCredential credential,
+                             SaveCredentialsResultCallback callback) override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  void GetLocalCredentials(const CredentialSelector& credential_selector,
+                           GetLocalCredentialsResultCallback callback) override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  void GetPublicCredentials(
+      const CredentialSelector& credential_selector,
+      PublicCredentialType public_credential_type,
+      GetPublicCredentialsResultCallback callback) override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  struct Save {
+    std::string manager_app_id;
+    std::string account_name;
+    std::vector<LocalCredential> private_credentials;
+    std::vector<SharedCredential> public_credentials;
+    PublicCredentialType public_credential_type;
+    std::vector<SaveCredentialsResultCallback> callbacks;
+  };
+
+  // A queued operation, either a save or any other operation.
+  struct Operation {
+    std::optional<Save> save;
+    Runnable run;
+  };
+
+  void Enqueue(Operation operation) ABSL_LOCKS_EXCLUDED(mutex_);
+  void RunNext() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Only used on `executor_`.
+  std::unique_ptr<api::CredentialStorage> storage_;
+  absl::Mutex mutex_;
+  // The operations that haven't started, one task on `executor_` each.
+  std::deque<Operation> pending_ ABSL_GUARDED_BY(mutex_);
+  std::unique_ptr<api::SubmittableExecutor> executor_;
+};
+
+}  // namespace shared
+}  // namespace nearby
+
+#endif  // PLATFORM_IMPL_SHARED_WRITE_BEHIND_CREDENTIAL_STORAGE_H_
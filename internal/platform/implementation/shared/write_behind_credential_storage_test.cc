@@ -0,0 +1,223 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/implementation/shared/write_behind_credential_storage.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/notification.h"
+#include "internal/platform/implementation/credential_callbacks.h"
+#include "internal/platform/implementation/credential_storage.h"
+#include "internal/platform/implementation/shared/strand.h"
+#include "internal/platform/implementation/shared/work_stealing_executor.h"
+#include "internal/proto/credential.pb.h"
+#include "internal/proto/local_credential.pb.h"
+
+namespace nearby {
+namespace shared {
+namespace {
+
+using ::nearby::internal::LocalCredential;
+using ::nearby::internal::SharedCredential;
+using ::nearby::presence::CredentialSelector;
+using ::nearby::presence::GetLocalCredentialsResultCallback;
+using ::nearby::presence::GetPublicCredentialsResultCallback;
+using ::nearby::presence::PublicCredentialType;
+using ::nearby::presence::SaveCredentialsResultCallback;
+
+constexpr absl::string_view kManagerAppId = "manager app id";
+constexpr absl::string_view kAccountName = "test_account";
+
+struct SaveCall {
+  std::vector<std::string> private_secret_ids;
+  std::vector<std::string> public_secret_ids;
+};
+
+// Records the saves. Fetches wait for `unblock`, when set.
+class FakeCredentialStorage : public api::CredentialStorage {
+ public:
+  explicit FakeCredentialStorage(std::vector<SaveCall>& saves,
+                                 absl::Notification* unblock = nullptr)
+      : saves_(saves), unblock_(unblock) {}
+
+  void SaveCredentials(absl::string_view manager_app_id,
+                       absl::string_view account_name,
+                       const std::vector<LocalCredential>& private_credentials,
+                       const std::vector<SharedCredential>& public_credentials,
+                       PublicCredentialType public_credential_type,
+                       SaveCredentialsResultCallback callback) override {
+    SaveCall save;
+    for (const LocalCredential& credential : private_credentials) {
+      save.private_secret_ids.push_back(credential.secret_id());
+    }
+    for (const SharedCredential& credential : public_credentials) {
+      save.public_secret_ids.push_back(credential.secret_id());
+    }
+    saves_.push_back(std::move(save));
+    callback.credentials_saved_cb(absl::OkStatus());
+  }
+
+  void UpdateLocalCredential(absl::string_view manager_app_id,
+                             absl::string_view account_name,
+                             LocalCredential credential,
+                             SaveCredentialsResultCallback callback) override {
+    callback.credentials_saved_cb(absl::OkStatus());
+  }
+
+  void GetLocalCredentials(const CredentialSelector& credential_selector,
+                           GetLocalCredentialsResultCallback callback) override {
+    if (unblock_ != nullptr) unblock_->WaitForNotification();
+    callback.credentials_fetched_cb(std::vector<LocalCredential>());
+  }
+
+  void GetPublicCredentials(
+      const CredentialSelector& credential_selector,
+      PublicCredentialType public_credential_type,
+      GetPublicCredentialsResultCallback callback) override {
+    callback.credentials_fetched_cb(
+        std::vector<SharedCredential>(saves_.size()));
+  }
+
+ private:
+  std::vector<SaveCall>& saves_;
+  absl::Notification* unblock_;
+};
+
+std::vector<LocalCredential> PrivateCredentials(absl::string_view secret_id) {
+  LocalCredential credential;
+  credential.set_secret_id(std::string(secret_id));
+  return {credential};
+}
+
+std::vector<SharedCredential> PublicCredentials(absl::string_view secret_id) {
+  SharedCredential credential;
+  credential.set_secret_id(std::string(secret_id));
+  return {credential};
+}
+
+SaveCredentialsResultCallback CountSaved(int& saved) {
+  return {.credentials_saved_cb = [&saved](absl::Status status) {
+    if (status.ok()) ++saved;
+  }};
+}
+
+TEST(WriteBehindCredentialStorageTest, FetchSeesEarlierSaves) {
+  WorkStealingExecutor pool(2);
+  std::vector<SaveCall> saves;
+  int saved = 0;
+  size_t fetched = 0;
+  absl::Notification done;
+  {
+    WriteBehindCredentialStorage storage(
+        std::make_unique<FakeCredentialStorage>(saves),
+        std::make_unique<Strand>(pool));
+
+    storage.SaveCredentials(kManagerAppId, kAccountName, {},
+                            PublicCredentials("a"),
+                            PublicCredentialType::kRemotePublicCredential,
+                            CountSaved(saved));
+    storage.SaveCredentials("other app", kAccountName, {},
+                            PublicCredentials("b"),
+                            PublicCredentialType::kRemotePublicCredential,
+                            CountSaved(saved));
+    storage.GetPublicCredentials(
+        {}, PublicCredentialType::kRemotePublicCredential,
+        {.credentials_fetched_cb =
+             [&](absl::StatusOr<std::vector<SharedCredential>> credentials) {
+               fetched = credentials->size();
+               done.Notify();
+             }});
+    done.WaitForNotification();
+  }
+
+  EXPECT_EQ(saved, 2);
+  EXPECT_EQ(fetched, 2);
+}
+
+TEST(WriteBehindCredentialStorageTest, MergesQueuedSaves) {
+  WorkStealingExecutor pool(2);
+  std::vector<SaveCall> saves;
+  absl::Notification unblock;
+  int saved = 0;
+  {
+    WriteBehindCredentialStorage storage(
+        std::make_unique<FakeCredentialStorage>(saves, &unblock),
+        std::make_unique<Strand>(pool));
+    // Holds the executor so that the saves are queued behind it.
+    storage.GetLocalCredentials({}, {.credentials_fetched_cb = [](auto) {}});
+
+    storage.SaveCredentials(kManagerAppId, kAccountName,
+                            PrivateCredentials("private 1"),
+                            PublicCredentials("public 1"),
+                            PublicCredentialType::kLocalPublicCredential,
+                            CountSaved(saved));
+    storage.SaveCredentials(kManagerAppId, kAccountName, {},
+                            PublicCredentials("public 2"),
+                            PublicCredentialType::kLocalPublicCredential,
+                            CountSaved(saved));
+    storage.SaveCredentials(kManagerAppId, kAccountName, {},
+                            PublicCredentials("public 3"),
+                            PublicCredentialType::kLocalPublicCredential,
+                            CountSaved(saved));
+    unblock.Notify();
+  }
+
+  EXPECT_EQ(saved, 3);
+  ASSERT_EQ(saves.size(), 1);
+  EXPECT_EQ(saves[0].private_secret_ids,
+            std::vector<std::string>{"private 1"});
+  EXPECT_EQ(saves[0].public_secret_ids, std::vector<std::string>{"public 3"});
+}
+
+TEST(WriteBehindCredentialStorageTest, DoesNotMergeAcrossOtherOperations) {
+  WorkStealingExecutor pool(2);
+  std::vector<SaveCall> saves;
+  absl::Notification unblock;
+  int saved = 0;
+  {
+    WriteBehindCredentialStorage storage(
+        std::make_unique<FakeCredentialStorage>(saves, &unblock),
+        std::make_unique<Strand>(pool));
+    storage.GetLocalCredentials({}, {.credentials_fetched_cb = [](auto) {}});
+
+    storage.SaveCredentials(kManagerAppId, kAccountName, {},
+                            PublicCredentials("public 1"),
+                            PublicCredentialType::kLocalPublicCredential,
+                            CountSaved(saved));
+    storage.SaveCredentials(kManagerAppId, kAccountName, {},
+                            PublicCredentials("public 2"),
+                            PublicCredentialType::kRemotePublicCredential,
+                            CountSaved(saved));
+    storage.UpdateLocalCredential(kManagerAppId, kAccountName,
+                                  LocalCredential(), CountSaved(saved));
+    storage.SaveCredentials(kManagerAppId, kAccountName, {},
+                            PublicCredentials("public 3"),
+                            PublicCredentialType::kRemotePublicCredential,
+                            CountSaved(saved));
+    unblock.Notify();
+  }
+
+  EXPECT_EQ(saved, 4);
+  EXPECT_EQ(saves.size(), 3);
+}
+
+}  // namespace
+}  // namespace shared
+}  // namespace nearby
@@ -29,12 +29,14 @@
 #include "absl/status/status.h"
 #include "absl/strings/escaping.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/optional.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/implementation/ble_v2.h"
 #include "internal/platform/implementation/windows/utils.h"
 #include "internal/platform/logging.h"
 #include "winrt/Windows.Foundation.Collections.h"
+#include "winrt/Windows.Foundation.h"
 #include "winrt/Windows.Storage.Streams.h"
 #include "winrt/base.h"
 
@@ -75,9 +77,11 @@ using ::winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::
     GattSubscribedClient;
 using ::winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::
     GattWriteRequestedEventArgs;
+using ::winrt::Windows::Foundation::IAsyncOperation;
 using ::winrt::Windows::Foundation::Collections::IVectorView;
 using ::winrt::Windows::Storage::Streams::Buffer;
 using ::winrt::Windows::Storage::Streams::DataWriter;
+using ::winrt::Windows::Storage::Streams::IBuffer;
 using Permission = api::ble_v2::GattCharacteristic::Permission;
 using Property = api::ble_v2::GattCharacteristic::Property;
 
@@ -100,6 +104,13 @@ std::string ConvertGattStatusToString(
   }
 }
 
+IBuffer ToBuffer(const ByteArray& data) {
+  Buffer buffer = Buffer(data.size());
+  std::memcpy(buffer.data(), data.data(), data.size());
+  buffer.Length(data.size());
+  return buffer;
+}
+
 }  // namespace
 
 BleGattServer::BleGattServer(api::BluetoothAdapter* adapter,
@@ -155,6 +166,7 @@ bool BleGattServer::UpdateCharacteristic(
       NEARBY_LOGS(VERBOSE) << __func__
                            << ": Found the characteristic to update.";
       it.data = value;
+      it.buffer = ToBuffer(value);
 
       // If it is in running, notify the value changed.
       if (is_advertising_) {
@@ -184,10 +196,85 @@ bool BleGattServer::UpdateCharacteristic(
 absl::Status BleGattServer::NotifyCharacteristicChanged(
     const api::ble_v2::GattCharacteristic& characteristic, bool confirm,
     const ByteArray& new_value) {
-  // Currently, the method is not hooked up at platform layer.
   NEARBY_LOGS(VERBOSE) << __func__ << ": Notify characteristic="
                        << std::string(characteristic.uuid) << " changed.";
-  return absl::OkStatus();
+  {
+    absl::MutexLock lock(&notification_mutex_);
+    pending_notifications_.push_back({characteristic, ToBuffer(new_value)});
+    if (is_notifying_) {
+      // Goes out with the next batch of the caller already sending.
+      return absl::OkStatus();
+    }
+    is_notifying_ = true;
+  }
+  return SendPendingNotifications();
+}
+
+absl::Status BleGattServer::SendPendingNotifications() {
+  absl::Status status = absl::OkStatus();
+  while (true) {
+    std::vector<PendingNotification> batch;
+    {
+      absl::MutexLock lock(&notification_mutex_);
+      if (pending_notifications_.empty()) {
+        is_notifying_ = false;
+        return status;
+      }
+      batch.swap(pending_notifications_);
+    }
+
+    try {
+      // Start every notification of the batch before waiting for any. The
+      // stack sends them in order, back to back, instead of one per round
+      // trip to the remote device.
+      std::vector<IAsyncOperation<IVectorView<GattClientNotificationResult>>>
+          operations;
+      operations.reserve(batch.size());
+      for (const auto& notification : batch) {
+        GattCharacteristicData* characteristic_data =
+            FindGattCharacteristicData(notification.gatt_characteristic);
+        if (characteristic_data == nullptr ||
+            characteristic_data->local_characteristic == nullptr) {
+          NEARBY_LOGS(ERROR)
+              << __func__ << ": Failed to find characteristic="
+              << std::string(notification.gatt_characteristic.uuid);
+          if (status.ok()) {
+            status = absl::NotFoundError("Characteristic not found.");
+          }
+          continue;
+        }
+        operations.push_back(
+            characteristic_data->local_characteristic.NotifyValueAsync(
+                notification.buffer));
+      }
+
+      for (auto& operation : operations) {
+        for (const auto& result : operation.get()) {
+          if (result.Status() != GattCommunicationStatus::Success) {
+            NEARBY_LOGS(ERROR)
+                << __func__ << ": Failed to notify value change. remote "
+                << "device id="
+                << ::winrt::to_string(
+                       result.SubscribedClient().Session().DeviceId().Id());
+            if (status.ok()) {
+              status = absl::UnavailableError("Failed to notify value change.");
+            }
+          }
+        }
+      }
+      continue;
+    } catch (std::exception exception) {
+      NEARBY_LOGS(ERROR) << __func__ << ": Exception: " << exception.what();
+    } catch (const winrt::hresult_error& error) {
+      NEARBY_LOGS(ERROR) << __func__ << ": WinRT exception: " << error.code()
+                         << ": " << winrt::to_string(error.message());
+    } catch (...) {
+      NEARBY_LOGS(ERROR) << __func__ << ": Unknown exception.";
+    }
+    if (status.ok()) {
+      status = absl::InternalError("Failed to notify value change.");
+    }
+  }
 }
 
 void BleGattServer::Stop() {
@@ -477,12 +564,13 @@ bool BleGattServer::StopAdvertisement() {
       return {};
     }
 
-    const ByteArray& data = characteristic_data->data;
-
-    Buffer buffer = Buffer(data.size());
-    std::memcpy(buffer.data(), data.data(), data.size());
-    buffer.Length(data.size());
-    request.RespondWithValue(buffer);
+    // Characteristics are read far more often than they are updated, so
+    // answer with the buffer of the last update rather than copying |data|
+    // again for every read.
+    if (characteristic_data->buffer == nullptr) {
+      characteristic_data->buffer = ToBuffer(characteristic_data->data);
+    }
+    request.RespondWithValue(characteristic_data->buffer);
     deferral.Complete();
 
     NEARBY_LOGS(VERBOSE) << __func__ << ": Sent data to remote device.";
@@ -622,14 +710,13 @@ void BleGattServer::NotifyValueChanged(
       return;
     }
 
-    const ByteArray& data = characteristic_data->data;
-
-    Buffer buffer = Buffer(data.size());
-    std::memcpy(buffer.data(), data.data(), data.size());
-    buffer.Length(data.size());
+    if (characteristic_data->buffer == nullptr) {
+      characteristic_data->buffer = ToBuffer(characteristic_data->data);
+    }
 
     IVectorView<GattClientNotificationResult> results =
-        characteristic_data->local_characteristic.NotifyValueAsync(buffer)
+        characteristic_data->local_characteristic
+            .NotifyValueAsync(characteristic_data->buffer)
             .get();
 
     for (const auto& result : results) {
@@ -20,16 +20,20 @@
 #include <optional>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/implementation/ble_v2.h"
 #include "internal/platform/implementation/windows/ble_v2_peripheral.h"
 #include "internal/platform/implementation/windows/bluetooth_adapter.h"
+#include "absl/synchronization/mutex.h"
 #include "internal/platform/uuid.h"
 #include "winrt/Windows.Devices.Bluetooth.GenericAttributeProfile.h"
 #include "winrt/Windows.Devices.Bluetooth.h"
 #include "winrt/Windows.Foundation.Collections.h"
+#include "winrt/Windows.Storage.Streams.h"
 #include "winrt/base.h"
 
 namespace nearby {
@@ -67,6 +71,9 @@ class BleGattServer : public api::ble_v2::GattServer {
   struct GattCharacteristicData {
     api::ble_v2::GattCharacteristic gatt_characteristic;
     ByteArray data;
+    // |data| copied into a WinRT buffer once per update, and handed as is to
+    // every read and indication.
+    ::winrt::Windows::Storage::Streams::IBuffer buffer = nullptr;
     ::winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::
         GattLocalCharacteristic local_characteristic = nullptr;
     ::winrt::Windows::Foundation::Collections::IVectorView<
@@ -78,7 +85,16 @@ class BleGattServer : public api::ble_v2::GattServer {
     ::winrt::event_token subscribed_clients_changed_token{};
   };
 
+  // A value passed to NotifyCharacteristicChanged() that isn't sent yet.
+  struct PendingNotification {
+    api::ble_v2::GattCharacteristic gatt_characteristic;
+    ::winrt::Windows::Storage::Streams::IBuffer buffer = nullptr;
+  };
+
   bool InitializeGattServer();
+  // Sends the pending notifications in batches until none is left. Returns
+  // the first failure, if any.
+  absl::Status SendPendingNotifications();
   void NotifyValueChanged(
       const api::ble_v2::GattCharacteristic& gatt_characteristic);
 
@@ -121,6 +137,13 @@ class BleGattServer : public api::ble_v2::GattServer {
   api::ble_v2::ServerGattConnectionCallback gatt_connection_callback_{};
 
   ::winrt::event_token service_provider_advertisement_changed_token_{};
+
+  absl::Mutex notification_mutex_;
+  std::vector<PendingNotification> pending_notifications_
+      ABSL_GUARDED_BY(notification_mutex_);
+  // Whether a caller of NotifyCharacteristicChanged() is sending the pending
+  // notifications, and will pick up the ones queued meanwhile.
+  bool is_notifying_ ABSL_GUARDED_BY(notification_mutex_) = false;
   bool is_advertising_ = false;
   bool is_gatt_server_inited_ = false;
 };
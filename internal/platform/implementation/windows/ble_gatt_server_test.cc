@@ -80,6 +80,31 @@ TEST(BleV2GattServer, DISABLED_UpdateCharacteristic) {
       gatt_characteristic.value(), value));
 }
 
+TEST(BleV2GattServer, DISABLED_NotifyCharacteristicChanged) {
+  BluetoothAdapter bluetoothAdapter;
+  BleGattServer blev2_gatt_server(&bluetoothAdapter, {});
+
+  Uuid service_uuid;
+  Uuid characteristic_uuid;
+  const api::ble_v2::GattCharacteristic::Permission permissions =
+      api::ble_v2::GattCharacteristic::Permission::kRead;
+  const api::ble_v2::GattCharacteristic::Property properties =
+      api::ble_v2::GattCharacteristic::Property::kNotify;
+
+  auto gatt_characteristic = blev2_gatt_server.CreateCharacteristic(
+      service_uuid, characteristic_uuid, permissions, properties);
+  ByteArray service_data;
+  ASSERT_TRUE(blev2_gatt_server.StartAdvertisement(service_data, true));
+
+  EXPECT_TRUE(blev2_gatt_server
+                  .NotifyCharacteristicChanged(gatt_characteristic.value(),
+                                               /*confirm=*/false,
+                                               ByteArray("packet"))
+                  .ok());
+
+  EXPECT_TRUE(blev2_gatt_server.StopAdvertisement());
+}
+
 }  // namespace
 }  // namespace windows
 }  // namespace nearby
@@ -23,6 +23,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/escaping.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
@@ -64,6 +65,8 @@ using ::winrt::Windows::Devices::Bluetooth::BluetoothError;
 using ::winrt::Windows::Devices::Bluetooth::BluetoothLEDevice;
 using ::winrt::Windows::Devices::Bluetooth::Advertisement::
     BluetoothLEAdvertisement;
+using ::winrt::Windows::Devices::Bluetooth::Advertisement::
+    BluetoothLEAdvertisementBytePattern;
 using ::winrt::Windows::Devices::Bluetooth::Advertisement::
     BluetoothLEAdvertisementDataSection;
 using ::winrt::Windows::Devices::Bluetooth::Advertisement::
@@ -268,29 +271,29 @@ std::unique_ptr<BleV2Medium::ScanningSession> BleV2Medium::StartScanning(
                             "Bluetooth adapter is not enabled.";
     return nullptr;
   }
-  if (!is_watcher_started_) {
+  // The filter of a started watcher can't be changed, so a watcher that
+  // filters out `service_uuid` is replaced.
+  bool is_filtered_out = is_watcher_started_ &&
+                         !filtered_service_uuids_.empty() &&
+                         !filtered_service_uuids_.contains(service_uuid);
+  if (!is_watcher_started_ || is_filtered_out) {
     NEARBY_LOGS(WARNING) << __func__ << ": Starting BLE Scanning.";
     try {
-      watcher_ = BluetoothLEAdvertisementWatcher();
-      watcher_token_ = watcher_.Stopped({this, &BleV2Medium::WatcherHandler});
-      advertisement_received_token_ =
-          watcher_.Received({this, &BleV2Medium::AdvertisementFoundHandler});
-
-      if (adapter_->IsExtendedAdvertisingSupported()) {
-        watcher_.AllowExtendedAdvertisements(true);
-      } else {
-        watcher_.AllowExtendedAdvertisements(false);
+      if (is_filtered_out) {
+        watcher_.Stopped(watcher_token_);
+        watcher_.Received(advertisement_received_token_);
+        watcher_.Stop();
+        watcher_ = nullptr;
+        is_watcher_started_ = false;
       }
-
-      // Active mode indicates that scan request packets will be sent to query
-      // for Scan Response
-      watcher_.ScanningMode(BluetoothLEScanningMode::Active);
-      ::winrt::Windows::Devices::Bluetooth::BluetoothSignalStrengthFilter
-          filter;
-      filter.SamplingInterval(TimeSpan(std::chrono::seconds(2)));
-      watcher_.SignalStrengthFilter(filter);
-      watcher_.Start();
-      is_watcher_started_ = true;
+      absl::flat_hash_set<Uuid> service_uuids = {service_uuid};
+      {
+        absl::MutexLock lock(&map_mutex_);
+        for (const auto& element : service_uuid_to_session_map_) {
+          service_uuids.insert(element.first);
+        }
+      }
+      StartWatcher(service_uuids);
       NEARBY_LOGS(INFO) << __func__ << ": BLE scanning started.";
     } catch (std::exception exception) {
       NEARBY_LOGS(ERROR) << __func__ << ": Exception to start BLE scanning: "
@@ -1016,6 +1019,49 @@ void BleV2Medium::AdvertisementReceivedHandler(
   }
 }
 
+void BleV2Medium::StartWatcher(const absl::flat_hash_set<Uuid>& service_uuids) {
+  watcher_ = BluetoothLEAdvertisementWatcher();
+  watcher_token_ = watcher_.Stopped({this, &BleV2Medium::WatcherHandler});
+  advertisement_received_token_ =
+      watcher_.Received({this, &BleV2Medium::AdvertisementFoundHandler});
+
+  if (adapter_->IsExtendedAdvertisingSupported()) {
+    watcher_.AllowExtendedAdvertisements(true);
+  } else {
+    watcher_.AllowExtendedAdvertisements(false);
+  }
+
+  // Active mode indicates that scan request packets will be sent to query
+  // for Scan Response
+  watcher_.ScanningMode(BluetoothLEScanningMode::Active);
+  ::winrt::Windows::Devices::Bluetooth::BluetoothSignalStrengthFilter filter;
+  filter.SamplingInterval(TimeSpan(std::chrono::seconds(2)));
+  watcher_.SignalStrengthFilter(filter);
+
+  filtered_service_uuids_.clear();
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          platform::config_package_nearby::nearby_platform_feature::
+              kEnableBleScanFilters)) {
+    // Only service data is parsed below, and its section starts with the 16
+    // bit service UUID in little endian. The controller runs the byte
+    // patterns when it can, so that other advertisements don't wake us up.
+    for (const Uuid& service_uuid : service_uuids) {
+      std::array<char, 16> service_id_data = service_uuid.data();
+      DataWriter data_writer;
+      data_writer.WriteByte(static_cast<uint8_t>(service_id_data[3]));
+      data_writer.WriteByte(static_cast<uint8_t>(service_id_data[2]));
+      watcher_.AdvertisementFilter().BytePatterns().Append(
+          BluetoothLEAdvertisementBytePattern(
+              BluetoothLEAdvertisementDataTypes::ServiceData16BitUuids(), 0,
+              data_writer.DetachBuffer()));
+    }
+    filtered_service_uuids_ = service_uuids;
+  }
+
+  watcher_.Start();
+  is_watcher_started_ = true;
+}
+
 void BleV2Medium::AdvertisementFoundHandler(
     BluetoothLEAdvertisementWatcher watcher,
     BluetoothLEAdvertisementReceivedEventArgs args) {
@@ -1073,16 +1119,65 @@ void BleV2Medium::AdvertisementFoundHandler(
                           "corresponding data, skipping";
     return;
   }
-  // Save the BleV2Peripheral.
   std::string bluetooth_address =
       uint64_to_mac_address_string(args.BluetoothAddress());
-  BleV2Peripheral* peripheral_ptr = GetOrCreatePeripheral(bluetooth_address);
+  int64_t batch_interval_millis = NearbyFlags::GetInstance().GetInt64Flag(
+      platform::config_package_nearby::nearby_platform_feature::
+          kBleScanBatchIntervalMillis);
+  if (batch_interval_millis <= 0) {
+    NotifyAdvertisementFound(bluetooth_address, service_uuid_list,
+                             ble_advertisement_data);
+    return;
+  }
+
+  // Peripherals advertise many times a second; within a batch, only the
+  // latest advertisement of each is reported.
+  absl::MutexLock lock(&pending_advertisements_mutex_);
+  PendingAdvertisement& pending = pending_advertisements_[bluetooth_address];
+  for (const Uuid& service_uuid : service_uuid_list) {
+    if (std::find(pending.service_uuids.begin(), pending.service_uuids.end(),
+                  service_uuid) == pending.service_uuids.end()) {
+      pending.service_uuids.push_back(service_uuid);
+    }
+  }
+  for (auto& [service_uuid, data] : ble_advertisement_data.service_data) {
+    pending.advertisement_data.service_data[service_uuid] = std::move(data);
+  }
+  if (is_flush_scheduled_) {
+    return;
+  }
+  if (scan_batch_executor_ == nullptr) {
+    scan_batch_executor_ = std::make_unique<ScheduledExecutor>();
+  }
+  is_flush_scheduled_ = true;
+  scan_batch_executor_->Schedule([this]() { FlushPendingAdvertisements(); },
+                                 absl::Milliseconds(batch_interval_millis));
+}
+
+void BleV2Medium::FlushPendingAdvertisements() {
+  absl::flat_hash_map<std::string, PendingAdvertisement> pending_advertisements;
+  {
+    absl::MutexLock lock(&pending_advertisements_mutex_);
+    pending_advertisements = std::move(pending_advertisements_);
+    pending_advertisements_.clear();
+    is_flush_scheduled_ = false;
+  }
+  for (const auto& [address, pending] : pending_advertisements) {
+    NotifyAdvertisementFound(address, pending.service_uuids,
+                             pending.advertisement_data);
+  }
+}
+
+void BleV2Medium::NotifyAdvertisementFound(
+    absl::string_view address, const std::vector<Uuid>& service_uuid_list,
+    const BleAdvertisementData& ble_advertisement_data) {
+  // Save the BleV2Peripheral.
+  BleV2Peripheral* peripheral_ptr = GetOrCreatePeripheral(address);
   if (peripheral_ptr == nullptr) {
-    NEARBY_LOGS(ERROR) << "No BLE peripheral with address: "
-                       << bluetooth_address;
+    NEARBY_LOGS(ERROR) << "No BLE peripheral with address: " << address;
     return;
   }
-  NEARBY_LOGS(INFO) << "BLE peripheral with address: " << bluetooth_address;
+  NEARBY_LOGS(INFO) << "BLE peripheral with address: " << address;
 
   // Invokes callbacks that matches the UUID.
   for (auto service_uuid : service_uuid_list) {
@@ -17,7 +17,11 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/implementation/ble_v2.h"
@@ -25,6 +29,7 @@
 #include "internal/platform/implementation/windows/ble_v2_peripheral.h"
 #include "internal/platform/implementation/windows/bluetooth_adapter.h"
 #include "internal/platform/implementation/windows/bluetooth_classic.h"
+#include "internal/platform/implementation/windows/scheduled_executor.h"
 #include "internal/platform/input_stream.h"
 #include "internal/platform/output_stream.h"
 #include "internal/platform/uuid.h"
@@ -111,6 +116,23 @@ class BleV2Medium : public api::ble_v2::BleMedium {
                       winrt::Windows::Devices::Bluetooth::Advertisement::
                           BluetoothLEAdvertisementWatcherStoppedEventArgs args);
 
+  // A scan result waiting for its batch to be reported.
+  struct PendingAdvertisement {
+    std::vector<Uuid> service_uuids;
+    api::ble_v2::BleAdvertisementData advertisement_data;
+  };
+
+  // Creates and starts `watcher_`. With scan filters on, the watcher only
+  // reports the service data of `service_uuids`. Throws on failure.
+  void StartWatcher(const absl::flat_hash_set<Uuid>& service_uuids);
+
+  // Reports `advertisement_data` of the peripheral at `address` to the scanning
+  // sessions of `service_uuids`.
+  void NotifyAdvertisementFound(
+      absl::string_view address, const std::vector<Uuid>& service_uuids,
+      const api::ble_v2::BleAdvertisementData& advertisement_data);
+  void FlushPendingAdvertisements();
+
   uint64_t GenerateSessionId();
   // Returns nullptr if `address` is invalid.
   BleV2Peripheral* GetOrCreatePeripheral(absl::string_view address);
@@ -140,6 +162,10 @@ class BleV2Medium : public api::ble_v2::BleMedium {
   bool is_gatt_publisher_started_ = false;
   bool is_watcher_started_ = false;
 
+  // Service UUIDs the hardware filter of `watcher_` lets through. Empty if the
+  // watcher isn't filtered.
+  absl::flat_hash_set<Uuid> filtered_service_uuids_;
+
   ::winrt::event_token publisher_token_;
   ::winrt::event_token watcher_token_;
   ::winrt::event_token advertisement_received_token_;
@@ -155,6 +181,16 @@ class BleV2Medium : public api::ble_v2::BleMedium {
   absl::flat_hash_map<BleV2Peripheral::UniqueId, PeripheralInfo> peripheral_map_
       ABSL_GUARDED_BY(peripheral_map_mutex_);
   absl::Time cleanup_time_ ABSL_GUARDED_BY(peripheral_map_mutex_) = absl::Now();
+
+  absl::Mutex pending_advertisements_mutex_;
+  // By peripheral address, the scan results of the current batch.
+  absl::flat_hash_map<std::string, PendingAdvertisement> pending_advertisements_
+      ABSL_GUARDED_BY(pending_advertisements_mutex_);
+  bool is_flush_scheduled_ ABSL_GUARDED_BY(pending_advertisements_mutex_) =
+      false;
+  // Must be declared last, so that a pending flush is done before the state it
+  // uses is destroyed.
+  std::unique_ptr<ScheduledExecutor> scan_batch_executor_;
 };
 
 }  // namespace windows
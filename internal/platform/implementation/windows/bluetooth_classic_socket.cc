@@ -14,7 +14,6 @@
 
 #include "internal/platform/implementation/windows/bluetooth_classic_socket.h"
 
-#include <cstring>
 #include <exception>
 #include <memory>
 #include <utility>
@@ -55,8 +54,8 @@ BluetoothSocket::BluetoothSocket(StreamSocket streamSocket)
   bluetooth_device_ =
       std::make_unique<BluetoothDevice>(native_bluetooth_device_);
 
-  input_stream_ = BluetoothInputStream(windows_socket_.InputStream());
-  output_stream_ = BluetoothOutputStream(windows_socket_.OutputStream());
+  input_stream_ = WinRtSocketInputStream(windows_socket_.InputStream());
+  output_stream_ = WinRtSocketOutputStream(windows_socket_.OutputStream());
 }
 
 BluetoothSocket::BluetoothSocket() {}
@@ -148,148 +147,6 @@ bool BluetoothSocket::Connect(HostName connectionHostName,
   return false;
 }
 
-BluetoothSocket::BluetoothInputStream::BluetoothInputStream(
-    IInputStream stream) {
-  winrt_input_stream_ = stream;
-}
-
-ExceptionOr<ByteArray> BluetoothSocket::BluetoothInputStream::Read(
-    std::int64_t size) {
-  try {
-    if (size <= 0) {
-      NEARBY_LOGS(ERROR) << __func__
-                         << ": Invalid transmit packet size: " << size;
-      return {Exception::kIo};
-    }
-
-    if (size > read_buffer_.Capacity()) {
-      NEARBY_LOGS(WARNING) << __func__
-                         << ": resize receive buffer to packet size: " << size;
-      read_buffer_ = Buffer(size);
-    }
-
-    // Init the read buffer.
-    read_buffer_.Length(0);
-
-    auto ibuffer = winrt_input_stream_
-                       .ReadAsync(read_buffer_, size, InputStreamOptions::None)
-                       .get();
-
-    if (ibuffer.Length() != size) {
-      NEARBY_LOGS(WARNING) << __func__ << ": Got " << ibuffer.Length()
-                           << " bytes of total " << size << " bytes.";
-    }
-
-    ByteArray data((char*)ibuffer.data(), ibuffer.Length());
-    return ExceptionOr(data);
-  } catch (std::exception exception) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Exception: " << exception.what();
-    return {Exception::kIo};
-  } catch (const winrt::hresult_error& error) {
-    NEARBY_LOGS(ERROR) << __func__ << ": WinRT exception: " << error.code()
-                       << ": " << winrt::to_string(error.message());
-    return {Exception::kIo};
-  } catch (...) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Unknown exeption.";
-    return {Exception::kIo};
-  }
-}
-
-Exception BluetoothSocket::BluetoothInputStream::Close() {
-  NEARBY_LOGS(INFO) << __func__ << ": Close bluetooth input stream.";
-
-  try {
-    if (winrt_input_stream_ != nullptr) {
-      winrt_input_stream_.Close();
-    }
-    return {Exception::kSuccess};
-  } catch (std::exception exception) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Exception: " << exception.what();
-    return {Exception::kIo};
-  } catch (const winrt::hresult_error& error) {
-    NEARBY_LOGS(ERROR) << __func__ << ": WinRT exception: " << error.code()
-                       << ": " << winrt::to_string(error.message());
-    return {Exception::kIo};
-  } catch (...) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Unknown exeption.";
-    return {Exception::kIo};
-  }
-}
-
-BluetoothSocket::BluetoothOutputStream::BluetoothOutputStream(
-    IOutputStream stream) {
-  winrt_output_stream_ = stream;
-}
-
-Exception BluetoothSocket::BluetoothOutputStream::Write(const ByteArray& data) {
-  try {
-    if (data.size() > write_buffer_.Capacity()) {
-      NEARBY_LOGS(WARNING) << __func__
-                         << ": resize write buffer to packet size: "
-                         << data.size();
-      write_buffer_ = Buffer(data.size());
-    }
-
-    std::memcpy(write_buffer_.data(), data.data(), data.size());
-    write_buffer_.Length(data.size());
-
-    winrt::hresult hresult =
-        winrt_output_stream_.WriteAsync(write_buffer_).get();
-    return {Exception::kSuccess};
-  } catch (std::exception exception) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Exception: " << exception.what();
-    return {Exception::kIo};
-  } catch (const winrt::hresult_error& error) {
-    NEARBY_LOGS(ERROR) << __func__ << ": WinRT exception: " << error.code()
-                       << ": " << winrt::to_string(error.message());
-    return {Exception::kIo};
-  } catch (...) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Unknown exeption.";
-    return {Exception::kIo};
-  }
-}
-
-Exception BluetoothSocket::BluetoothOutputStream::Flush() {
-  try {
-    if (winrt_output_stream_ == nullptr) {
-      return {Exception::kSuccess};
-    }
-
-    winrt_output_stream_.FlushAsync().get();
-    return {Exception::kSuccess};
-  } catch (std::exception exception) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Exception: " << exception.what();
-    return {Exception::kIo};
-  } catch (const winrt::hresult_error& error) {
-    NEARBY_LOGS(ERROR) << __func__ << ": WinRT exception: " << error.code()
-                       << ": " << winrt::to_string(error.message());
-    return {Exception::kIo};
-  } catch (...) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Unknown exeption.";
-    return {Exception::kIo};
-  }
-}
-
-Exception BluetoothSocket::BluetoothOutputStream::Close() {
-  NEARBY_LOGS(INFO) << __func__ << ": Close bluetooth output stream.";
-  try {
-    if (winrt_output_stream_ != nullptr) {
-      winrt_output_stream_.Close();
-    }
-    return {Exception::kSuccess};
-  } catch (std::exception exception) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Exception: " << exception.what();
-    return {Exception::kIo};
-  } catch (const winrt::hresult_error& error) {
-    NEARBY_LOGS(ERROR) << __func__ << ": WinRT exception: " << error.code()
-                       << ": " << winrt::to_string(error.message());
-    return {Exception::kIo};
-  } catch (...) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Unknown exeption.";
-    return {Exception::kIo};
-  }
-}
-
 bool BluetoothSocket::InternalConnect(HostName connectionHostName,
                                       winrt::hstring connectionServiceName) {
   try {
@@ -334,8 +191,8 @@ bool BluetoothSocket::InternalConnect(HostName connectionHostName,
     bluetooth_device_ =
         std::make_unique<BluetoothDevice>(native_bluetooth_device_);
 
-    input_stream_ = BluetoothInputStream(windows_socket_.InputStream());
-    output_stream_ = BluetoothOutputStream(windows_socket_.OutputStream());
+    input_stream_ = WinRtSocketInputStream(windows_socket_.InputStream());
+    output_stream_ = WinRtSocketOutputStream(windows_socket_.OutputStream());
 
     NEARBY_LOGS(INFO) << __func__
                       << ": Bluetooth socket successfully connected to "
@@ -19,6 +19,7 @@
 
 #include "internal/platform/implementation/bluetooth_classic.h"
 #include "internal/platform/implementation/windows/bluetooth_classic_device.h"
+#include "internal/platform/implementation/windows/winrt_socket_streams.h"
 #include "winrt/Windows.Foundation.h"
 #include "winrt/Windows.Networking.Sockets.h"
 #include "winrt/Windows.Storage.Streams.h"
@@ -99,36 +100,6 @@ class BluetoothSocket : public api::BluetoothSocket {
                winrt::hstring connectionServiceName);
 
  private:
-  static constexpr int kInitialTransmitPacketSize = 4096;
-
-  class BluetoothInputStream : public InputStream {
-   public:
-    explicit BluetoothInputStream(IInputStream stream);
-    ~BluetoothInputStream() override = default;
-
-    ExceptionOr<ByteArray> Read(std::int64_t size) override;
-    Exception Close() override;
-
-   private:
-    IInputStream winrt_input_stream_{nullptr};
-    Buffer read_buffer_{kInitialTransmitPacketSize};
-  };
-
-  class BluetoothOutputStream : public OutputStream {
-   public:
-    explicit BluetoothOutputStream(IOutputStream stream);
-    ~BluetoothOutputStream() override = default;
-
-    Exception Write(const ByteArray& data) override;
-    Exception Flush() override;
-
-    Exception Close() override;
-
-   private:
-    IOutputStream winrt_output_stream_{nullptr};
-    Buffer write_buffer_{kInitialTransmitPacketSize};
-  };
-
   bool InternalConnect(HostName connectionHostName,
                        winrt::hstring connectionServiceName);
 
@@ -138,8 +109,10 @@ class BluetoothSocket : public api::BluetoothSocket {
 
   StreamSocket windows_socket_{nullptr};
   bool is_bluetooth_socket_closed_ = false;
-  BluetoothInputStream input_stream_{nullptr};
-  BluetoothOutputStream output_stream_{nullptr};
+  // Keep a read outstanding and reuse their buffers, so that RFCOMM reads
+  // don't wait for a round trip through WinRT or allocate per call.
+  WinRtSocketInputStream input_stream_{nullptr};
+  WinRtSocketOutputStream output_stream_{nullptr};
   std::unique_ptr<BluetoothDevice> bluetooth_device_ = nullptr;
   winrt::Windows::Devices::Bluetooth::BluetoothDevice native_bluetooth_device_{
       nullptr};
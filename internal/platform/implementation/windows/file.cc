@@ -14,11 +14,14 @@
 
 #include "internal/platform/implementation/windows/file.h"
 
+#include <windows.h>
+
 #include <algorithm>
 #include <cstddef>
 #include <ios>
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
@@ -70,14 +73,16 @@ ExceptionOr<ByteArray> IOFile::Read(std::int64_t size) {
       return ExceptionOr<ByteArray>{ByteArray{}};
     }
 
-    ByteArray bytes(size);
-    std::unique_ptr<char[]> read_bytes{new char[size]};
-    file_.read(read_bytes.get(), static_cast<ptrdiff_t>(size));
+    // Read straight into the buffer that will back the returned ByteArray, so
+    // the chunk is not copied again on its way to the payload frame.
+    std::string read_bytes(size, '\0');
+    file_.read(&read_bytes[0], static_cast<ptrdiff_t>(size));
     auto num_bytes_read = file_.gcount();
     if (num_bytes_read == 0) {
       return ExceptionOr<ByteArray>{Exception::kIo};
     }
-    return ExceptionOr<ByteArray>(ByteArray(read_bytes.get(), num_bytes_read));
+    read_bytes.resize(num_bytes_read);
+    return ExceptionOr<ByteArray>(ByteArray(std::move(read_bytes)));
   } catch (...) {
     NEARBY_LOGS(ERROR) << "Fail to read";
     return ExceptionOr<ByteArray>{Exception::kIo};
@@ -115,5 +120,29 @@ Exception IOFile::Flush() {
   return {file_.good() ? Exception::kSuccess : Exception::kIo};
 }
 
+Exception IOFile::Preallocate(std::int64_t size) {
+  // std::fstream doesn't expose its handle, so reserve the space through a
+  // second one. The allocation stays in place while |file_| is open.
+  std::wstring wide_path = string_to_wstring(path_);
+  HANDLE handle = CreateFileW(wide_path.c_str(), GENERIC_WRITE,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (handle == INVALID_HANDLE_VALUE) {
+    NEARBY_LOGS(WARNING) << "Failed to open file to preallocate, error: "
+                         << GetLastError();
+    return {Exception::kIo};
+  }
+
+  // Unlike SetFileValidData(), this doesn't need SE_MANAGE_VOLUME_NAME, and
+  // it leaves the end of file where it is.
+  FILE_ALLOCATION_INFO allocation_info;
+  allocation_info.AllocationSize.QuadPart = size;
+  bool preallocated =
+      SetFileInformationByHandle(handle, FileAllocationInfo, &allocation_info,
+                                 sizeof(allocation_info));
+  CloseHandle(handle);
+  return {preallocated ? Exception::kSuccess : Exception::kIo};
+}
+
 }  // namespace windows
 }  // namespace nearby
@@ -33,6 +33,19 @@ constexpr DWORD kHostNameMaximumLength = 256;
 
 using ::nearby::api::WebResponse;
 
+// Returns the WinInet session shared by all the loaders. WinInet keeps the
+// connections of a session alive, so requests to the same server reuse them.
+// The session lives as long as the process.
+HINTERNET GetInternetSession() {
+  static HINTERNET session =
+      InternetOpenA("Mozilla/5.0",                /*Agent*/
+                    INTERNET_OPEN_TYPE_PRECONFIG, /*Access Type*/
+                    nullptr,                      /*Proxy*/
+                    nullptr,                      /*Proxy bypass*/
+                    0);                           /*Flags*/
+  return session;
+}
+
 }  // namespace
 
 absl::StatusOr<WebResponse> HttpLoader::GetResponse() {
@@ -195,11 +208,7 @@ absl::Status HttpLoader::ParseUrl() {
 }
 
 absl::Status HttpLoader::ConnectWebServer() {
-  internet_handle_ = InternetOpenA("Mozilla/5.0",                /*Agent*/
-                                   INTERNET_OPEN_TYPE_PRECONFIG, /*Access Type*/
-                                   nullptr,                      /*Proxy*/
-                                   nullptr, /*Proxy bypass*/
-                                   0);      /*Flags*/
+  internet_handle_ = GetInternetSession();
 
   if (internet_handle_ == nullptr) {
     NEARBY_LOGS(ERROR) << "Failed to open internet with error "
@@ -219,7 +228,6 @@ absl::Status HttpLoader::ConnectWebServer() {
   if (connect_handle_ == nullptr) {
     NEARBY_LOGS(ERROR) << "Failed to connect remote web server with error "
                        << GetLastError() << ".";
-    InternetCloseHandle(internet_handle_);
     return absl::FailedPreconditionError(absl::StrCat(GetLastError()));
   }
 
@@ -227,7 +235,7 @@ absl::Status HttpLoader::ConnectWebServer() {
 }
 
 absl::Status HttpLoader::SendRequest() {
-  DWORD flags = INTERNET_FLAG_NO_AUTO_REDIRECT;
+  DWORD flags = INTERNET_FLAG_NO_AUTO_REDIRECT | INTERNET_FLAG_KEEP_CONNECTION;
   if (is_secure_) {
     flags |= INTERNET_FLAG_SECURE;
   }
@@ -245,7 +253,6 @@ absl::Status HttpLoader::SendRequest() {
     NEARBY_LOGS(ERROR)
         << "Failed to open request to remote web server with error "
         << GetLastError() << ".";
-    InternetCloseHandle(internet_handle_);
     InternetCloseHandle(connect_handle_);
 
     return absl::FailedPreconditionError(absl::StrCat(GetLastError()));
@@ -289,7 +296,6 @@ absl::Status HttpLoader::SendRequest() {
         << GetLastError() << ".";
     InternetCloseHandle(request_handle_);
     InternetCloseHandle(connect_handle_);
-    InternetCloseHandle(internet_handle_);
 
     return absl::FailedPreconditionError(absl::StrCat(GetLastError()));
   }
@@ -318,6 +324,12 @@ absl::StatusOr<WebResponse> HttpLoader::ProcessResponse() {
   }
   web_response.headers = *headers;
 
+  status = HTTPCodeToStatus(web_response.status_code, web_response.status_text);
+  if (!status.ok()) {
+    // The body of a failed response is dropped anyway.
+    return status;
+  }
+
   // Get response data
   char buffer[kReceiveBufferSize];
 
@@ -329,6 +341,12 @@ absl::StatusOr<WebResponse> HttpLoader::ProcessResponse() {
     if (read_result) {
       if (read_size == 0) {
         break;
+      } else if (request_.body_chunk_callback) {
+        if (!request_.body_chunk_callback(
+                absl::string_view(buffer, read_size))) {
+          NEARBY_LOGS(INFO) << "Response download stopped by the caller.";
+          return absl::CancelledError("Download stopped by the caller.");
+        }
       } else {
         // Append data to response
         web_response.body.append(buffer, read_size);
@@ -339,16 +357,10 @@ absl::StatusOr<WebResponse> HttpLoader::ProcessResponse() {
           << GetLastError() << ".";
       InternetCloseHandle(request_handle_);
       InternetCloseHandle(connect_handle_);
-      InternetCloseHandle(internet_handle_);
       return absl::FailedPreconditionError(absl::StrCat(GetLastError()));
     }
   }
 
-  status = HTTPCodeToStatus(web_response.status_code, web_response.status_text);
-  if (!status.ok()) {
-    return status;
-  }
-
   return web_response;
 }
 
@@ -363,10 +375,8 @@ void HttpLoader::DisconnectWebServer() {
     connect_handle_ = nullptr;
   }
 
-  if (internet_handle_ != nullptr) {
-    InternetCloseHandle(internet_handle_);
-    internet_handle_ = nullptr;
-  }
+  // The shared session stays open for the next requests.
+  internet_handle_ = nullptr;
 }
 
 absl::Status HttpLoader::HTTPCodeToStatus(int status_code,
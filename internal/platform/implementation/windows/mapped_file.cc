@@ -0,0 +1,117 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/implementation/windows/mapped_file.h"
+
+#include <windows.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/string_view.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/implementation/windows/utils.h"
+#include "internal/platform/logging.h"
+
+namespace nearby {
+namespace windows {
+
+std::unique_ptr<MappedInputFile> MappedInputFile::Create(
+    absl::string_view file_path) {
+  // Always open input file path as wide string on Windows platform.
+  std::wstring wide_path = string_to_wstring(std::string(file_path));
+  HANDLE file = CreateFileW(wide_path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0) {
+    CloseHandle(file);
+    return nullptr;
+  }
+
+  HANDLE mapping =
+      CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  // The mapping keeps the file open on its own.
+  CloseHandle(file);
+  if (mapping == nullptr) {
+    NEARBY_LOGS(WARNING) << "Failed to map file, error: " << GetLastError();
+    return nullptr;
+  }
+
+  void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (data == nullptr) {
+    NEARBY_LOGS(WARNING) << "Failed to map view of file, error: "
+                         << GetLastError();
+    CloseHandle(mapping);
+    return nullptr;
+  }
+
+  return absl::WrapUnique(new MappedInputFile(file_path, mapping,
+                                              static_cast<const char*>(data),
+                                              file_size.QuadPart));
+}
+
+MappedInputFile::MappedInputFile(absl::string_view file_path, HANDLE mapping,
+                                 const char* data, std::int64_t total_size)
+    : path_(file_path),
+      mapping_(mapping),
+      data_(data),
+      total_size_(total_size) {}
+
+MappedInputFile::~MappedInputFile() { Close(); }
+
+ExceptionOr<ByteArray> MappedInputFile::Read(std::int64_t size) {
+  if (data_ == nullptr || size < 0) {
+    return ExceptionOr<ByteArray>{Exception::kIo};
+  }
+
+  std::int64_t bytes_to_read = std::min(size, total_size_ - position_);
+  if (bytes_to_read <= 0) {
+    return ExceptionOr<ByteArray>{ByteArray{}};
+  }
+
+  ByteArray bytes(data_ + position_, bytes_to_read);
+  position_ += bytes_to_read;
+  return ExceptionOr<ByteArray>(std::move(bytes));
+}
+
+ExceptionOr<size_t> MappedInputFile::Skip(size_t offset) {
+  if (data_ == nullptr) {
+    return ExceptionOr<size_t>{Exception::kIo};
+  }
+
+  std::int64_t skipped = std::min(static_cast<std::int64_t>(offset),
+                                  total_size_ - position_);
+  position_ += skipped;
+  return ExceptionOr<size_t>(skipped);
+}
+
+Exception MappedInputFile::Close() {
+  if (data_ != nullptr) {
+    UnmapViewOfFile(data_);
+    CloseHandle(mapping_);
+    data_ = nullptr;
+  }
+  return {Exception::kSuccess};
+}
+
+}  // namespace windows
+}  // namespace nearby
@@ -0,0 +1,66 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PLATFORM_IMPL_WINDOWS_MAPPED_FILE_H_
+#define PLATFORM_IMPL_WINDOWS_MAPPED_FILE_H_
+
+#include <windows.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/implementation/input_file.h"
+
+namespace nearby {
+namespace windows {
+
+// An InputFile that maps a view of the whole file, so that reads are copies
+// out of the page cache instead of reads through a std::fstream, and skips
+// only move the read position.
+class MappedInputFile final : public api::InputFile {
+ public:
+  // Returns nullptr if the file can't be opened or mapped, e.g. because it is
+  // empty; callers should fall back to IOFile in that case.
+  static std::unique_ptr<MappedInputFile> Create(absl::string_view file_path);
+
+  ~MappedInputFile() override;
+
+  ExceptionOr<ByteArray> Read(std::int64_t size) override;
+  ExceptionOr<size_t> Skip(size_t offset) override;
+
+  std::string GetFilePath() const override { return path_; }
+
+  std::int64_t GetTotalSize() const override { return total_size_; }
+  Exception Close() override;
+
+ private:
+  MappedInputFile(absl::string_view file_path, HANDLE mapping,
+                  const char* data, std::int64_t total_size);
+
+  std::string path_;
+  HANDLE mapping_;
+  const char* data_;
+  std::int64_t total_size_;
+  std::int64_t position_ = 0;
+};
+
+}  // namespace windows
+}  // namespace nearby
+
+#endif  // PLATFORM_IMPL_WINDOWS_MAPPED_FILE_H_
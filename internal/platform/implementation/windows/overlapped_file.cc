@@ -0,0 +1,223 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/implementation/windows/overlapped_file.h"
+
+#include <windows.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/string_view.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/implementation/windows/utils.h"
+#include "internal/platform/logging.h"
+
+namespace nearby {
+namespace windows {
+
+std::unique_ptr<OverlappedInputFile> OverlappedInputFile::Create(
+    absl::string_view file_path) {
+  // Always open input file path as wide string on Windows platform.
+  std::wstring wide_path = string_to_wstring(std::string(file_path));
+  HANDLE file = CreateFileW(
+      wide_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+      FILE_FLAG_OVERLAPPED | FILE_FLAG_NO_BUFFERING | FILE_FLAG_SEQUENTIAL_SCAN,
+      nullptr);
+  if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0) {
+    CloseHandle(file);
+    return nullptr;
+  }
+
+  auto input_file = absl::WrapUnique(
+      new OverlappedInputFile(file_path, file, file_size.QuadPart));
+  for (Buffer& buffer : input_file->buffers_) {
+    // VirtualAlloc() returns page aligned memory, which satisfies the
+    // alignment unbuffered reads need.
+    buffer.data = static_cast<char*>(VirtualAlloc(
+        nullptr, kBufferSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+    buffer.overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (buffer.data == nullptr || buffer.overlapped.hEvent == nullptr) {
+      NEARBY_LOGS(WARNING) << "Failed to allocate read buffer, error: "
+                           << GetLastError();
+      return nullptr;
+    }
+  }
+  if (!input_file->Seek()) {
+    return nullptr;
+  }
+  return input_file;
+}
+
+OverlappedInputFile::OverlappedInputFile(absl::string_view file_path,
+                                         HANDLE file, std::int64_t total_size)
+    : path_(file_path), file_(file), total_size_(total_size) {}
+
+OverlappedInputFile::~OverlappedInputFile() { Close(); }
+
+bool OverlappedInputFile::StartRead(Buffer& buffer, std::int64_t offset) {
+  buffer.offset = offset;
+  buffer.length = 0;
+  buffer.pending = false;
+  if (offset >= total_size_) {
+    return true;
+  }
+
+  HANDLE event = buffer.overlapped.hEvent;
+  buffer.overlapped = {};
+  buffer.overlapped.hEvent = event;
+  buffer.overlapped.Offset = static_cast<DWORD>(offset);
+  buffer.overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+  // The result of reads that complete right away is also fetched through
+  // GetOverlappedResult().
+  if (!ReadFile(file_, buffer.data, kBufferSize, nullptr,
+                &buffer.overlapped)) {
+    DWORD error = GetLastError();
+    if (error == ERROR_HANDLE_EOF) {
+      return true;
+    }
+    if (error != ERROR_IO_PENDING) {
+      NEARBY_LOGS(ERROR) << "Failed to read file, error: " << error;
+      return false;
+    }
+  }
+  buffer.pending = true;
+  return true;
+}
+
+bool OverlappedInputFile::WaitForRead(Buffer& buffer) {
+  if (!buffer.pending) {
+    return true;
+  }
+  buffer.pending = false;
+  DWORD length = 0;
+  if (!GetOverlappedResult(file_, &buffer.overlapped, &length, TRUE)) {
+    DWORD error = GetLastError();
+    if (error != ERROR_HANDLE_EOF) {
+      NEARBY_LOGS(ERROR) << "Failed to read file, error: " << error;
+      return false;
+    }
+    length = 0;
+  }
+  buffer.length = length;
+  return true;
+}
+
+void OverlappedInputFile::CancelReads() {
+  for (Buffer& buffer : buffers_) {
+    if (!buffer.pending) continue;
+    CancelIoEx(file_, &buffer.overlapped);
+    // The buffer must not be reused or freed before the read is done with it.
+    DWORD length;
+    GetOverlappedResult(file_, &buffer.overlapped, &length, TRUE);
+    buffer.pending = false;
+    buffer.length = 0;
+  }
+}
+
+bool OverlappedInputFile::Seek() {
+  CancelReads();
+  std::int64_t offset = position_ - position_ % kBufferSize;
+  current_ = 0;
+  return StartRead(buffers_[0], offset) &&
+         StartRead(buffers_[1], offset + kBufferSize);
+}
+
+ExceptionOr<ByteArray> OverlappedInputFile::Read(std::int64_t size) {
+  if (file_ == INVALID_HANDLE_VALUE || size < 0) {
+    return ExceptionOr<ByteArray>{Exception::kIo};
+  }
+
+  std::int64_t bytes_to_read = std::min(size, total_size_ - position_);
+  if (bytes_to_read <= 0) {
+    return ExceptionOr<ByteArray>{ByteArray{}};
+  }
+
+  std::string bytes;
+  bytes.reserve(bytes_to_read);
+  while (static_cast<std::int64_t>(bytes.size()) < bytes_to_read) {
+    Buffer& buffer = buffers_[current_];
+    if (!WaitForRead(buffer)) {
+      return ExceptionOr<ByteArray>{Exception::kIo};
+    }
+
+    std::int64_t end = buffer.offset + buffer.length;
+    if (position_ >= buffer.offset && position_ < end) {
+      std::int64_t length =
+          std::min<std::int64_t>(bytes_to_read - bytes.size(), end - position_);
+      bytes.append(buffer.data + (position_ - buffer.offset), length);
+      position_ += length;
+    } else if (position_ >= end && buffer.length < kBufferSize &&
+               position_ >= buffer.offset) {
+      // The file got shorter since it was opened.
+      break;
+    } else if (position_ >= end && position_ < end + kBufferSize) {
+      // The other buffer holds the next chunk; read the one after it into this
+      // one.
+      if (!StartRead(buffer, buffer.offset + 2 * kBufferSize)) {
+        return ExceptionOr<ByteArray>{Exception::kIo};
+      }
+      current_ ^= 1;
+    } else if (!Seek()) {
+      return ExceptionOr<ByteArray>{Exception::kIo};
+    }
+  }
+
+  if (bytes.empty()) {
+    return ExceptionOr<ByteArray>{Exception::kIo};
+  }
+  return ExceptionOr<ByteArray>(ByteArray(std::move(bytes)));
+}
+
+ExceptionOr<size_t> OverlappedInputFile::Skip(size_t offset) {
+  if (file_ == INVALID_HANDLE_VALUE) {
+    return ExceptionOr<size_t>{Exception::kIo};
+  }
+
+  // The chunks are read from the new position on the next Read().
+  std::int64_t skipped = std::min(static_cast<std::int64_t>(offset),
+                                  total_size_ - position_);
+  position_ += skipped;
+  return ExceptionOr<size_t>(skipped);
+}
+
+Exception OverlappedInputFile::Close() {
+  if (file_ != INVALID_HANDLE_VALUE) {
+    CancelReads();
+    CloseHandle(file_);
+    file_ = INVALID_HANDLE_VALUE;
+  }
+  for (Buffer& buffer : buffers_) {
+    if (buffer.data != nullptr) {
+      VirtualFree(buffer.data, 0, MEM_RELEASE);
+      buffer.data = nullptr;
+    }
+    if (buffer.overlapped.hEvent != nullptr) {
+      CloseHandle(buffer.overlapped.hEvent);
+      buffer.overlapped.hEvent = nullptr;
+    }
+  }
+  return {Exception::kSuccess};
+}
+
+}  // namespace windows
+}  // namespace nearby
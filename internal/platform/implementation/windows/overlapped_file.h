@@ -0,0 +1,93 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PLATFORM_IMPL_WINDOWS_OVERLAPPED_FILE_H_
+#define PLATFORM_IMPL_WINDOWS_OVERLAPPED_FILE_H_
+
+#include <windows.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/implementation/input_file.h"
+
+namespace nearby {
+namespace windows {
+
+// An InputFile that reads with unbuffered, overlapped ReadFile calls instead of
+// a std::fstream. The file is read in aligned chunks into two buffers; while
+// one of them is being consumed, the next chunk is already being read into the
+// other, so the disk keeps working while the caller sends the previous chunk.
+class OverlappedInputFile final : public api::InputFile {
+ public:
+  // Size of each read ahead buffer. A multiple of any sector size, as
+  // unbuffered reads require.
+  static constexpr DWORD kBufferSize = 1 << 20;
+
+  // Returns nullptr if the file can't be opened for unbuffered reads, or is
+  // empty; callers should fall back to IOFile in that case.
+  static std::unique_ptr<OverlappedInputFile> Create(
+      absl::string_view file_path);
+
+  ~OverlappedInputFile() override;
+
+  ExceptionOr<ByteArray> Read(std::int64_t size) override;
+  ExceptionOr<size_t> Skip(size_t offset) override;
+
+  std::string GetFilePath() const override { return path_; }
+
+  std::int64_t GetTotalSize() const override { return total_size_; }
+  Exception Close() override;
+
+ private:
+  struct Buffer {
+    char* data = nullptr;
+    OVERLAPPED overlapped = {};
+    // Offset in the file of the chunk in `data`.
+    std::int64_t offset = 0;
+    // Bytes of the chunk read so far, valid once the read is no longer
+    // pending. Less than kBufferSize at the end of the file.
+    DWORD length = 0;
+    bool pending = false;
+  };
+
+  OverlappedInputFile(absl::string_view file_path, HANDLE file,
+                      std::int64_t total_size);
+
+  // Starts reading the chunk at `offset` into `buffer`.
+  bool StartRead(Buffer& buffer, std::int64_t offset);
+  // Waits for the read of `buffer`, if there is one.
+  bool WaitForRead(Buffer& buffer);
+  void CancelReads();
+  // Drops the chunks read ahead and reads ahead from `position_` instead.
+  bool Seek();
+
+  std::string path_;
+  HANDLE file_;
+  std::int64_t total_size_;
+  std::int64_t position_ = 0;
+  Buffer buffers_[2];
+  // Index of the buffer holding the chunk at `position_`.
+  int current_ = 0;
+};
+
+}  // namespace windows
+}  // namespace nearby
+
+#endif  // PLATFORM_IMPL_WINDOWS_OVERLAPPED_FILE_H_
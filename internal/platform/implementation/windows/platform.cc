@@ -27,6 +27,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <filesystem>  // NOLINT(build/c++17)
 #include <fstream>
 #include <memory>
 #include <optional>
@@ -35,8 +36,14 @@
 
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "internal/flags/nearby_flags.h"
+#include "internal/platform/flags/nearby_platform_feature_flags.h"
 #include "internal/platform/implementation/http_loader.h"
+#include "internal/platform/implementation/shared/binary_preferences_manager.h"
 #include "internal/platform/implementation/shared/count_down_latch.h"
+#include "internal/platform/implementation/shared/strand.h"
+#include "internal/platform/implementation/shared/work_stealing_executor.h"
 #include "internal/platform/implementation/windows/atomic_boolean.h"
 #include "internal/platform/implementation/windows/atomic_reference.h"
 #include "internal/platform/implementation/windows/ble.h"
@@ -52,7 +59,9 @@
 #include "internal/platform/implementation/windows/http_loader.h"
 #include "internal/platform/implementation/windows/listenable_future.h"
 #include "internal/platform/implementation/windows/log_message.h"
+#include "internal/platform/implementation/windows/mapped_file.h"
 #include "internal/platform/implementation/windows/mutex.h"
+#include "internal/platform/implementation/windows/overlapped_file.h"
 #include "internal/platform/implementation/windows/preferences_manager.h"
 #include "internal/platform/implementation/windows/scheduled_executor.h"
 #include "internal/platform/implementation/windows/server_sync.h"
@@ -72,6 +81,8 @@ namespace api {
 namespace {
 
 constexpr char kNCRelativePath[] = "Google\\Nearby\\Connections";
+// Bursts of preference changes are written to disk together.
+constexpr absl::Duration kPreferencesCommitDelay = absl::Milliseconds(500);
 
 std::string GetApplicationName(DWORD pid) {
   HANDLE handle =
@@ -201,6 +212,20 @@ std::unique_ptr<InputFile> ImplementationPlatform::CreateInputFile(
 
 std::unique_ptr<InputFile> ImplementationPlatform::CreateInputFile(
     const std::string& file_path, size_t size) {
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          platform::config_package_nearby::nearby_platform_feature::
+              kEnableMemoryMappedInputFile)) {
+    std::unique_ptr<InputFile> mapped_file =
+        windows::MappedInputFile::Create(file_path);
+    if (mapped_file) return mapped_file;
+  }
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          platform::config_package_nearby::nearby_platform_feature::
+              kEnableOverlappedInputFile)) {
+    std::unique_ptr<InputFile> overlapped_file =
+        windows::OverlappedInputFile::Create(file_path);
+    if (overlapped_file) return overlapped_file;
+  }
   return windows::IOFile::CreateInputFile(file_path, size);
 }
 
@@ -239,18 +264,31 @@ std::unique_ptr<LogMessage> ImplementationPlatform::CreateLogMessage(
 }
 
 std::unique_ptr<SubmittableExecutor>
-ImplementationPlatform::CreateSingleThreadExecutor() {
+ImplementationPlatform::CreateSingleThreadExecutor(ExecutorQos qos) {
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          platform::config_package_nearby::nearby_platform_feature::
+              kEnableThreadBudget)) {
+    return absl::make_unique<shared::Strand>(shared::Strand::GetSharedPool(
+        NearbyFlags::GetInstance().GetInt64Flag(
+            platform::config_package_nearby::nearby_platform_feature::
+                kThreadBudgetPoolSize)));
+  }
   return absl::make_unique<windows::SubmittableExecutor>();
 }
 
 std::unique_ptr<SubmittableExecutor>
 ImplementationPlatform::CreateMultiThreadExecutor(
-    std::int32_t max_concurrency) {
+    std::int32_t max_concurrency, ExecutorQos qos) {
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          platform::config_package_nearby::nearby_platform_feature::
+              kEnableWorkStealingExecutor)) {
+    return absl::make_unique<shared::WorkStealingExecutor>(max_concurrency);
+  }
   return absl::make_unique<windows::SubmittableExecutor>(max_concurrency);
 }
 
 std::unique_ptr<ScheduledExecutor>
-ImplementationPlatform::CreateScheduledExecutor() {
+ImplementationPlatform::CreateScheduledExecutor(ExecutorQos qos) {
   return absl::make_unique<windows::ScheduledExecutor>();
 }
 
@@ -322,7 +360,22 @@ std::unique_ptr<DeviceInfo> ImplementationPlatform::CreateDeviceInfo() {
 
 std::unique_ptr<nearby::api::PreferencesManager>
 ImplementationPlatform::CreatePreferencesManager(absl::string_view path) {
-  return std::make_unique<windows::PreferencesManager>(path);
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          platform::config_package_nearby::nearby_platform_feature::
+              kEnableBinaryPreferences)) {
+    std::optional<std::filesystem::path> directory =
+        CreateDeviceInfo()->GetLocalAppDataPath();
+    if (!directory.has_value()) {
+      directory = std::filesystem::temp_directory_path();
+    }
+    return std::make_unique<shared::BinaryPreferencesManager>(
+        (*directory / std::string(path)).string(),
+        [](absl::string_view file_path) -> std::unique_ptr<InputFile> {
+          return windows::MappedInputFile::Create(file_path);
+        });
+  }
+  return std::make_unique<windows::PreferencesManager>(path,
+                                                       kPreferencesCommitDelay);
 }
 
 }  // namespace api
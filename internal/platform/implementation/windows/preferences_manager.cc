@@ -33,8 +33,9 @@ namespace {
 using json = ::nlohmann::json;
 }  // namespace
 
-PreferencesManager::PreferencesManager(absl::string_view file_path)
-    : api::PreferencesManager(file_path) {
+PreferencesManager::PreferencesManager(absl::string_view file_path,
+                                       absl::Duration commit_delay)
+    : api::PreferencesManager(file_path), commit_delay_(commit_delay) {
   std::optional<std::filesystem::path> path =
       nearby::api::ImplementationPlatform::CreateDeviceInfo()
           ->GetLocalAppDataPath();
@@ -46,6 +47,25 @@ PreferencesManager::PreferencesManager(absl::string_view file_path)
   preferences_repository_ =
       std::make_unique<PreferencesRepository>(full_path.string());
   value_ = preferences_repository_->LoadPreferences();
+  if (commit_delay_ > absl::ZeroDuration()) {
+    commit_executor_ = std::make_unique<ScheduledExecutor>();
+  }
+}
+
+PreferencesManager::~PreferencesManager() {
+  if (commit_executor_ != nullptr) {
+    // Waits for a running commit, and cancels the scheduled one.
+    commit_executor_->Shutdown();
+  }
+  Commit();
+}
+
+bool PreferencesManager::Commit() {
+  absl::MutexLock lock(&mutex_);
+  if (!dirty_) {
+    return true;
+  }
+  return Save();
 }
 
 bool PreferencesManager::Set(absl::string_view key, const json& value) {
@@ -107,7 +127,7 @@ bool PreferencesManager::SetTime(absl::string_view key, absl::Time value) {
   }
 
   value_[absl::StrCat(key)] = tt;
-  return Commit();
+  return OnChanged();
 }
 
 // Get JSON value.
@@ -179,17 +199,44 @@ absl::Time PreferencesManager::GetTime(absl::string_view key,
 // Removes preferences
 void PreferencesManager::Remove(absl::string_view key) {
   absl::MutexLock lock(&mutex_);
-  value_.erase(absl::StrCat(key));
+  if (value_.erase(absl::StrCat(key)) > 0) {
+    OnChanged();
+  }
 }
 
 // Private methods
 
 // Writes data to storage.
-bool PreferencesManager::Commit() {
+bool PreferencesManager::Save() {
+  if (pending_commit_ != nullptr) {
+    pending_commit_->Cancel();
+    pending_commit_ = nullptr;
+  }
   if (!preferences_repository_->SavePreferences(value_)) {
     NEARBY_LOGS(ERROR) << "Failed to save preference." << std::endl;
     return false;
   }
+  dirty_ = false;
+  return true;
+}
+
+bool PreferencesManager::OnChanged() {
+  dirty_ = true;
+  if (commit_executor_ == nullptr) {
+    return Save();
+  }
+  // The first change of a burst schedules the write, later ones join it.
+  if (pending_commit_ == nullptr) {
+    pending_commit_ = commit_executor_->Schedule(
+        [this]() {
+          absl::MutexLock lock(&mutex_);
+          pending_commit_ = nullptr;
+          if (dirty_) {
+            Save();
+          }
+        },
+        commit_delay_);
+  }
   return true;
 }
 
@@ -205,7 +252,7 @@ bool PreferencesManager::SetValue(absl::string_view key, const json& value) {
   }
 
   value_[absl::StrCat(key)] = value;
-  return Commit();
+  return OnChanged();
 }
 
 template <typename T>
@@ -243,7 +290,7 @@ bool PreferencesManager::SetArrayValue(absl::string_view key,
   }
 
   value_[absl::StrCat(key)] = array_value;
-  return Commit();
+  return OnChanged();
 }
 
 template <typename T>
@@ -28,8 +28,10 @@
 #include "absl/types/span.h"
 #include "nlohmann/json.hpp"
 #include "nlohmann/json_fwd.hpp"
+#include "internal/platform/implementation/cancelable.h"
 #include "internal/platform/implementation/preferences_manager.h"
 #include "internal/platform/implementation/windows/preferences_repository.h"
+#include "internal/platform/implementation/windows/scheduled_executor.h"
 
 namespace nearby {
 namespace windows {
@@ -38,9 +40,19 @@ namespace windows {
 // Preferences are persistent storage for application settings, it is key/value
 // based settings. Application components can observe the interested preference
 // change by the observer.
+//
+// Values are read from memory. Every change is written to storage right away,
+// unless a `commit_delay` is given: then changes are written behind, in one
+// go, `commit_delay` after the first change of a burst. Pending changes are
+// written by Commit() and on destruction.
 class PreferencesManager : public api::PreferencesManager {
  public:
-  explicit PreferencesManager(absl::string_view path);
+  explicit PreferencesManager(absl::string_view path,
+                              absl::Duration commit_delay = absl::ZeroDuration());
+  ~PreferencesManager() override;
+
+  // Writes pending changes to storage now.
+  bool Commit() ABSL_LOCKS_EXCLUDED(mutex_);
 
   // Sets values
 
@@ -110,7 +122,10 @@ class PreferencesManager : public api::PreferencesManager {
 
  private:
   // Writes data to storage.
-  bool Commit() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  bool Save() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Writes data to storage, or schedules the write when it is written behind.
+  bool OnChanged() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   bool SetValue(absl::string_view key, const nlohmann::json& value)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
@@ -131,8 +146,14 @@ class PreferencesManager : public api::PreferencesManager {
   nlohmann::json value_ ABSL_GUARDED_BY(mutex_);
   std::unique_ptr<PreferencesRepository> preferences_repository_
       ABSL_GUARDED_BY(mutex_);
+  const absl::Duration commit_delay_;
+  // Are there changes that are not written to storage yet?
+  bool dirty_ ABSL_GUARDED_BY(mutex_) = false;
+  std::shared_ptr<api::Cancelable> pending_commit_ ABSL_GUARDED_BY(mutex_);
 
   mutable absl::Mutex mutex_;
+  // Only created when changes are written behind.
+  std::unique_ptr<ScheduledExecutor> commit_executor_;
 };
 
 }  // namespace windows
@@ -185,5 +185,35 @@ TEST(PreferencesManager, RemoveKey) {
   EXPECT_EQ(result, "default key");
 }
 
+TEST(PreferencesManager, WriteBehindCommitsOnDemand) {
+  std::string int_key = "write_behind_int_key";
+  PreferencesManager pm(kPreferencesFilePath, absl::Hours(1));
+  pm.SetInteger(int_key, 1);
+  pm.SetInteger(int_key, 2);
+  EXPECT_EQ(pm.GetInteger(int_key, 0), 2);
+  EXPECT_TRUE(pm.Commit());
+  EXPECT_EQ(PreferencesManager(kPreferencesFilePath).GetInteger(int_key, 0), 2);
+}
+
+TEST(PreferencesManager, WriteBehindCommitsAfterDelay) {
+  std::string int_key = "write_behind_delayed_int_key";
+  PreferencesManager pm(kPreferencesFilePath, kTimeOut / 2);
+  pm.SetInteger(int_key, 3);
+  pm.SetInteger(int_key, 4);
+  absl::SleepFor(kTimeOut);
+  EXPECT_EQ(PreferencesManager(kPreferencesFilePath).GetInteger(int_key, 0), 4);
+}
+
+TEST(PreferencesManager, WriteBehindCommitsOnDestruction) {
+  std::string string_key = "write_behind_string_key";
+  {
+    PreferencesManager pm(kPreferencesFilePath, absl::Hours(1));
+    pm.SetString(string_key, "written behind");
+  }
+  EXPECT_EQ(
+      PreferencesManager(kPreferencesFilePath).GetString(string_key, ""),
+      "written behind");
+}
+
 }  // namespace windows
 }  // namespace nearby
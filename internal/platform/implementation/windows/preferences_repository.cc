@@ -30,6 +30,7 @@ using json = ::nlohmann::json;
 
 constexpr char kPreferencesFileName[] = "preferences.json";
 constexpr char kPreferencesBackupFileName[] = "preferences_bak.json";
+constexpr char kPreferencesTemporaryFileName[] = "preferences_tmp.json";
 
 }  // namespace
 
@@ -76,27 +77,26 @@ bool PreferencesRepository::SavePreferences(json preferences) {
 
     std::filesystem::path full_name = path / kPreferencesFileName;
     std::filesystem::path full_name_backup = path / kPreferencesBackupFileName;
+    std::filesystem::path full_name_temporary =
+        path / kPreferencesTemporaryFileName;
 
-    // Create a backup without moving the bytes on disk
-    if (std::filesystem::exists(full_name)) {
-      NEARBY_LOGS(INFO) << "Making backup of preferences file.";
-      std::filesystem::rename(full_name, full_name_backup);
-    }
-
-    std::ofstream preferences_file(full_name.c_str());
+    // Write a complete new file before touching the current one, so that the
+    // file is never seen half written.
+    std::ofstream preferences_file(full_name_temporary.c_str(),
+                                   std::ios::trunc);
     preferences_file << preferences;
     preferences_file.close();
+    if (preferences_file.fail()) {
+      NEARBY_LOGS(ERROR) << "Failed to write preferences file.";
+      std::filesystem::remove(full_name_temporary);
+      return false;
+    }
 
-    // Make sure the file wasn't saved in a corrupted state
-    if (!AttemptLoad().has_value()) {
-      NEARBY_LOGS(ERROR) << "Preferences saved to disk in corrupted state. "
-                            "Restoring from backup.";
-
-      if (!RestoreFromBackup().has_value()) {
-        NEARBY_LOGS(ERROR) << "Failed to restore preferences file.";
-        return false;
-      }
+    // Keep the current file as the backup without moving the bytes on disk
+    if (std::filesystem::exists(full_name)) {
+      std::filesystem::rename(full_name, full_name_backup);
     }
+    std::filesystem::rename(full_name_temporary, full_name);
   } catch (const std::exception& e) {
     NEARBY_LOGS(ERROR) << "Failed to save preferences file: " << e.what();
     return false;
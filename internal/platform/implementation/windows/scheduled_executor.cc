@@ -19,16 +19,45 @@
 #include <algorithm>
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
+#include "internal/flags/nearby_flags.h"
+#include "internal/platform/flags/nearby_platform_feature_flags.h"
+#include "internal/platform/implementation/executor.h"
+#include "internal/platform/implementation/shared/strand.h"
+#include "internal/platform/implementation/shared/timer_wheel.h"
+#include "internal/platform/implementation/windows/executor.h"
 #include "internal/platform/logging.h"
 
 namespace nearby {
 namespace windows {
 
+namespace {
+
+std::unique_ptr<api::Executor> CreateExecutor() {
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          platform::config_package_nearby::nearby_platform_feature::
+              kEnableThreadBudget)) {
+    return std::make_unique<shared::Strand>(shared::Strand::GetSharedPool(
+        NearbyFlags::GetInstance().GetInt64Flag(
+            platform::config_package_nearby::nearby_platform_feature::
+                kThreadBudgetPoolSize)));
+  }
+  return std::make_unique<nearby::windows::Executor>();
+}
+
+}  // namespace
+
 ScheduledExecutor::ScheduledExecutor()
-    : executor_(std::make_unique<nearby::windows::Executor>()),
-      shut_down_(false) {}
+    : state_(std::make_shared<State>(CreateExecutor())) {}
+
+ScheduledExecutor::~ScheduledExecutor() {
+  if (!state_->shut_down) {
+    Shutdown();
+  }
+}
 
 // Cancelable is kept both in the executor context, and in the caller context.
 // We want Cancelable to live until both caller and executor are done with it.
@@ -36,45 +65,77 @@ ScheduledExecutor::ScheduledExecutor()
 // using std:shared_ptr<> instead of std::unique_ptr<>.
 std::shared_ptr<api::Cancelable> ScheduledExecutor::Schedule(
     Runnable&& runnable, absl::Duration duration) {
-  if (shut_down_) {
+  if (state_->shut_down) {
     NEARBY_LOGS(ERROR) << __func__
                        << ": Attempt to Schedule on a shut down executor.";
 
     return nullptr;
   }
 
-  // Cleans completed tasks
-  std::remove_if(
-      scheduled_tasks_.begin(), scheduled_tasks_.end(),
-      [](std::shared_ptr<ScheduledTask>& task) { return task->IsDone(); });
-
   std::shared_ptr<ScheduledTask> task =
-      std::make_shared<ScheduledTask>(std::move(runnable), duration);
+      std::make_shared<ScheduledTask>(std::move(runnable));
+  {
+    absl::MutexLock lock(&mutex_);
+    if (scheduled_tasks_.size() >= prune_size_) {
+      scheduled_tasks_.erase(
+          std::remove_if(scheduled_tasks_.begin(), scheduled_tasks_.end(),
+                         [](const std::weak_ptr<ScheduledTask>& task) {
+                           std::shared_ptr<ScheduledTask> locked = task.lock();
+                           return locked == nullptr || locked->IsDone();
+                         }),
+          scheduled_tasks_.end());
+      prune_size_ = std::max(kMinPruneSize, scheduled_tasks_.size() * 2);
+    }
+    scheduled_tasks_.push_back(task);
+  }
 
-  scheduled_tasks_.push_back(task);
-  executor_->Execute([task]() { task->Start(); });
+  // The shared timer wheel only hands the task over to our executor, so a
+  // pending task no longer holds an executor thread while it waits. The wheel
+  // runs due callbacks after releasing its lock, so one may still run after
+  // Shutdown() failed to cancel it, and after this executor is gone.
+  task->SetTimer(shared::TimerWheel::GetInstance().Schedule(
+      [weak_state = std::weak_ptr<State>(state_), task]() {
+        std::shared_ptr<State> state = weak_state.lock();
+        if (state == nullptr) return;
+        absl::ReaderMutexLock lock(&state->mutex);
+        if (state->shut_down) return;
+        state->executor->Execute([task]() { task->Run(); });
+      },
+      duration));
   return task;
 }
 
 void ScheduledExecutor::Execute(Runnable&& runnable) {
-  if (shut_down_) {
+  if (state_->shut_down) {
     NEARBY_LOGS(ERROR) << __func__
                        << ": Attempt to Execute on a shut down executor.";
     return;
   }
 
-  executor_->Execute(std::move(runnable));
+  state_->executor->Execute(std::move(runnable));
 }
 
 void ScheduledExecutor::Shutdown() {
-  if (!shut_down_) {
-    shut_down_ = true;
-    for (auto& task : scheduled_tasks_) {
-      task->Cancel();
+  bool was_shut_down;
+  {
+    absl::MutexLock lock(&state_->mutex);
+    was_shut_down = state_->shut_down.exchange(true);
+  }
+  if (!was_shut_down) {
+    std::vector<std::weak_ptr<ScheduledTask>> scheduled_tasks;
+    {
+      absl::MutexLock lock(&mutex_);
+      scheduled_tasks = std::move(scheduled_tasks_);
+      scheduled_tasks_.clear();
+    }
+    for (auto& task : scheduled_tasks) {
+      std::shared_ptr<ScheduledTask> locked = task.lock();
+      if (locked != nullptr) {
+        locked->Cancel();
+      }
     }
 
-    scheduled_tasks_.clear();
-    executor_->Shutdown();
+    state_->executor->Shutdown();
     return;
   }
   NEARBY_LOGS(ERROR) << __func__
@@ -17,15 +17,18 @@
 
 #include <windows.h>
 
+#include <atomic>
+#include <cstddef>
 #include <memory>
 #include <utility>
 #include <vector>
 
-#include "absl/synchronization/notification.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "internal/platform/implementation/cancelable.h"
+#include "internal/platform/implementation/executor.h"
 #include "internal/platform/implementation/scheduled_executor.h"
-#include "internal/platform/implementation/windows/executor.h"
 
 namespace nearby {
 namespace windows {
@@ -40,7 +43,7 @@ class ScheduledExecutor : public api::ScheduledExecutor {
  public:
   ScheduledExecutor();
 
-  ~ScheduledExecutor() override = default;
+  ~ScheduledExecutor() override;
 
   // Cancelable is kept both in the executor context, and in the caller context.
   // We want Cancelable to live until both caller and executor are done with it.
@@ -56,44 +59,65 @@ class ScheduledExecutor : public api::ScheduledExecutor {
   void Shutdown() override;
 
  private:
+  static constexpr size_t kMinPruneSize = 16;
+
   class ScheduledTask : public api::Cancelable {
    public:
-    explicit ScheduledTask(Runnable&& task, absl::Duration duration)
-        : task_(std::move(task)), duration_(duration) {}
+    explicit ScheduledTask(Runnable&& task) : task_(std::move(task)) {}
 
     bool Cancel() override {
-      if (is_executed_ || is_cancelled_) {
+      if (is_done_.exchange(true)) {
         return false;
       }
-
-      is_cancelled_ = true;
-      notification_.Notify();
+      absl::MutexLock lock(&mutex_);
+      if (timer_ != nullptr) {
+        timer_->Cancel();
+      }
       return true;
     };
 
-    void Start() {
-      if (is_executed_ ||
-          notification_.WaitForNotificationWithTimeout(duration_)) {
+    void Run() {
+      if (is_done_.exchange(true)) {
         return;
       }
-
-      is_executed_ = true;
       task_();
     }
 
-    bool IsDone() const { return is_cancelled_ || is_executed_; }
+    void SetTimer(std::shared_ptr<api::Cancelable> timer) {
+      absl::MutexLock lock(&mutex_);
+      timer_ = std::move(timer);
+    }
+
+    bool IsDone() const { return is_done_; }
 
    private:
     Runnable task_;
-    absl::Duration duration_;
-    absl::Notification notification_;
-    bool is_cancelled_ = false;
-    bool is_executed_ = false;
+    absl::Mutex mutex_;
+    std::shared_ptr<api::Cancelable> timer_ ABSL_GUARDED_BY(mutex_);
+    std::atomic_bool is_done_ = false;
+  };
+
+  // Shared with the timer wheel callbacks, which may still be running after
+  // this executor is destroyed.
+  struct State {
+    explicit State(std::unique_ptr<api::Executor> executor)
+        : executor(std::move(executor)) {}
+
+    // A strand on the shared pool when the thread budget is on.
+    const std::unique_ptr<api::Executor> executor;
+    // Held while handing a task over to |executor|, so that none is handed
+    // over once Shutdown() has set |shut_down|.
+    absl::Mutex mutex;
+    std::atomic_bool shut_down = false;
   };
 
-  std::unique_ptr<nearby::windows::Executor> executor_ = nullptr;
-  std::vector<std::shared_ptr<ScheduledTask>> scheduled_tasks_;
-  std::atomic_bool shut_down_ = false;
+  const std::shared_ptr<State> state_;
+  absl::Mutex mutex_;
+  // Tasks not known to be done, so that Shutdown() can cancel them. Done tasks
+  // are pruned whenever the list doubles in size.
+  std::vector<std::weak_ptr<ScheduledTask>> scheduled_tasks_
+      ABSL_GUARDED_BY(mutex_);
+  size_t prune_size_ ABSL_GUARDED_BY(mutex_) = kMinPruneSize;
 };
 
 }  // namespace windows
@@ -99,6 +99,26 @@ TEST(ScheduledExecutorTests, ScheduleSucceeds) {
   ASSERT_EQ(output, expected);
 }
 
+TEST(ScheduledExecutorTests, ShortDelayRunsBeforeLongDelay) {
+  absl::Notification short_notification;
+  absl::Notification long_notification;
+
+  auto submittableExecutor = std::make_unique<ScheduledExecutor>();
+
+  submittableExecutor->Schedule([&]() { long_notification.Notify(); },
+                                absl::Milliseconds(500));
+  submittableExecutor->Schedule([&]() { short_notification.Notify(); },
+                                absl::Milliseconds(50));
+
+  // A pending task doesn't hold up the ones due before it.
+  ASSERT_TRUE(short_notification.WaitForNotificationWithTimeout(
+      absl::Milliseconds(200)));
+  EXPECT_FALSE(long_notification.HasBeenNotified());
+  ASSERT_TRUE(long_notification.WaitForNotificationWithTimeout(
+      absl::Milliseconds(1000)));
+  submittableExecutor->Shutdown();
+}
+
 TEST(ScheduledExecutorTests, CancelSucceeds) {
   absl::Notification notification;
   // Arrange
@@ -15,13 +15,31 @@
 #include "internal/platform/implementation/windows/timer.h"
 
 #include <memory>
+#include <utility>
 
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "internal/flags/nearby_flags.h"
+#include "internal/platform/flags/nearby_platform_feature_flags.h"
+#include "internal/platform/implementation/executor.h"
+#include "internal/platform/implementation/shared/strand.h"
+#include "internal/platform/implementation/shared/timer_wheel.h"
 #include "internal/platform/logging.h"
 
 namespace nearby {
 namespace windows {
 
+namespace {
+
+api::Executor& GetCallbackExecutor() {
+  return shared::Strand::GetSharedPool(
+      NearbyFlags::GetInstance().GetInt64Flag(
+          platform::config_package_nearby::nearby_platform_feature::
+              kThreadBudgetPoolSize));
+}
+
+}  // namespace
+
 Timer::~Timer() { Stop(); }
 
 bool Timer::Create(int delay, int interval,
@@ -33,85 +51,93 @@ bool Timer::Create(int delay, int interval,
     return false;
   }
 
-  if (timer_queue_handle_ != nullptr) {
-    return false;
-  }
-
-  timer_queue_handle_ = CreateTimerQueue();
-  if (timer_queue_handle_ == nullptr) {
-    NEARBY_LOGS(ERROR) << "Failed to create timer queue.";
-    return false;
-  }
-
-  delay_ = delay;
-  interval_ = interval;
-  callback_ = std::move(callback);
-
-  if (!CreateTimerQueueTimer(&handle_, timer_queue_handle_,
-                             static_cast<WAITORTIMERCALLBACK>(TimerRoutine),
-                             &callback_, delay, interval, WT_EXECUTEDEFAULT)) {
-    if (!DeleteTimerQueueEx(timer_queue_handle_, nullptr)) {
-      NEARBY_LOGS(ERROR) << "Failed to create timer in timer queue.";
-    }
-    timer_queue_handle_ = nullptr;
+  if (state_ != nullptr) {
     return false;
   }
 
+  state_ = std::make_shared<State>(std::move(callback), interval);
+  absl::MutexLock state_lock(&state_->mutex);
+  ScheduleLocked(state_, delay);
   return true;
 }
 
 bool Timer::Stop() {
-  absl::MutexLock lock(&mutex_);
-
-  if (timer_queue_handle_ == nullptr) {
-    return true;
-  }
+  std::shared_ptr<api::Cancelable> pending;
+  {
+    absl::MutexLock lock(&mutex_);
 
-  if (!DeleteTimerQueueTimer(timer_queue_handle_, handle_, nullptr)) {
-    if (GetLastError() != ERROR_IO_PENDING) {
-      NEARBY_LOGS(ERROR) << "Failed to delete timer from timer queue.";
-      return false;
+    if (state_ == nullptr) {
+      return true;
     }
-  }
 
-  handle_ = nullptr;
-
-  if (!DeleteTimerQueueEx(timer_queue_handle_, nullptr)) {
-    NEARBY_LOGS(ERROR) << "Failed to delete timer queue.";
-    return false;
+    absl::MutexLock state_lock(&state_->mutex);
+    state_->running = false;
+    pending = std::move(state_->pending);
+    state_ = nullptr;
   }
 
-  timer_queue_handle_ = nullptr;
+  // Cancelled outside of the locks, as the wheel may be about to fire it and
+  // waiting for them.
+  if (pending != nullptr) {
+    pending->Cancel();
+  }
   return true;
 }
 
 bool Timer::FireNow() {
-  absl::MutexLock lock(&mutex_);
-
-  if (!timer_queue_handle_ || !callback_) {
-    return false;
+  std::shared_ptr<State> state;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (state_ == nullptr || !state_->callback) {
+      return false;
+    }
+    state = state_;
   }
 
-  if (task_executor_ == nullptr) {
-    task_executor_ = std::make_unique<SubmittableExecutor>();
-  }
+  GetCallbackExecutor().Execute([state]() { state->callback(); });
+  return true;
+}
 
-  if (task_executor_ == nullptr) {
-    NEARBY_LOGS(ERROR)
-        << "Failed to fire the task due to cannot create executor.";
-    return false;
-  }
+void Timer::ScheduleLocked(const std::shared_ptr<State>& state, int delay) {
+  // The wheel only holds on to the state weakly, so that a stopped timer
+  // doesn't linger in it.
+  std::weak_ptr<State> weak_state = state;
+  state->pending = shared::TimerWheel::GetInstance().Schedule(
+      [weak_state]() {
+        std::shared_ptr<State> state = weak_state.lock();
+        if (state != nullptr) {
+          OnFired(state);
+        }
+      },
+      absl::Milliseconds(delay));
+}
 
-  task_executor_->Execute([&]() { callback_(); });
+void Timer::OnFired(const std::shared_ptr<State>& state) {
+  {
+    absl::MutexLock lock(&state->mutex);
+    if (!state->running) {
+      return;
+    }
+    if (state->interval > 0) {
+      ScheduleLocked(state, state->interval);
+    } else {
+      state->pending = nullptr;
+    }
+  }
 
-  return true;
+  // Wheel tasks must be short, the callback runs on the pool.
+  GetCallbackExecutor().Execute([state]() { RunCallback(state); });
 }
 
-void CALLBACK Timer::TimerRoutine(PVOID lpParam, BOOLEAN TimerOrWaitFired) {
-  absl::AnyInvocable<void()>* callback =
-      reinterpret_cast<absl::AnyInvocable<void()>*>(lpParam);
-  if (*callback != nullptr) {
-    (*callback)();
+void Timer::RunCallback(const std::shared_ptr<State>& state) {
+  {
+    absl::MutexLock lock(&state->mutex);
+    if (!state->running) {
+      return;
+    }
+  }
+  if (state->callback) {
+    state->callback();
   }
 }
 
@@ -15,18 +15,20 @@
 #ifndef PLATFORM_IMPL_WINDOWS_TIMER_H_
 #define PLATFORM_IMPL_WINDOWS_TIMER_H_
 
-#include <windows.h>
-
 #include <memory>
+#include <utility>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
 #include "absl/synchronization/mutex.h"
+#include "internal/platform/implementation/cancelable.h"
 #include "internal/platform/implementation/timer.h"
-#include "internal/platform/implementation/windows/submittable_executor.h"
 
 namespace nearby {
 namespace windows {
 
+// Times on the process-wide shared::TimerWheel instead of creating an OS timer
+// queue per timer, and runs the callbacks on the shared thread pool.
 class Timer : public api::Timer {
  public:
   Timer() = default;
@@ -39,16 +41,27 @@ class Timer : public api::Timer {
   bool FireNow() override ABSL_LOCKS_EXCLUDED(mutex_);
 
  private:
-  static void CALLBACK TimerRoutine(PVOID lpParam, BOOLEAN TimerOrWaitFired);
+  // One per Create(). Shared with the pending wheel timer and the running
+  // callbacks, so that they never outlive the callback they call.
+  struct State {
+    absl::Mutex mutex;
+    // Only assigned here, so it is called without holding `mutex`.
+    absl::AnyInvocable<void()> callback;
+    const int interval;
+    bool running ABSL_GUARDED_BY(mutex) = true;
+    std::shared_ptr<api::Cancelable> pending ABSL_GUARDED_BY(mutex);
+
+    State(absl::AnyInvocable<void()> callback, int interval)
+        : callback(std::move(callback)), interval(interval) {}
+  };
+
+  static void ScheduleLocked(const std::shared_ptr<State>& state, int delay)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(state->mutex);
+  static void OnFired(const std::shared_ptr<State>& state);
+  static void RunCallback(const std::shared_ptr<State>& state);
 
   mutable absl::Mutex mutex_;
-  int delay_ ABSL_GUARDED_BY(mutex_);
-  int interval_ ABSL_GUARDED_BY(mutex_);
-  absl::AnyInvocable<void()> callback_;
-  HANDLE handle_ ABSL_GUARDED_BY(mutex_) = nullptr;
-  HANDLE timer_queue_handle_ ABSL_GUARDED_BY(mutex_) = nullptr;
-  std::unique_ptr<SubmittableExecutor> task_executor_ ABSL_GUARDED_BY(mutex_) =
-      nullptr;
+  std::shared_ptr<State> state_ ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace windows
@@ -63,6 +63,18 @@ TEST(Timer, DISABLED_TestFireNow) {
   EXPECT_EQ(count, 1);
 }
 
+TEST(Timer, DISABLED_TestStopCancelsTimer) {
+  int count = 0;
+
+  auto timer = nearby::api::ImplementationPlatform::CreateTimer();
+
+  EXPECT_TRUE(timer != nullptr);
+  EXPECT_TRUE(timer->Create(300, 0, [&]() { ++count; }));
+  EXPECT_TRUE(timer->Stop());
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  EXPECT_EQ(count, 0);
+}
+
 }  // namespace
 }  // namespace windows
 }  // namespace nearby
@@ -30,6 +30,7 @@
 #include "internal/platform/implementation/wifi_hotspot.h"
 #include "internal/platform/implementation/windows/scheduled_executor.h"
 #include "internal/platform/implementation/windows/submittable_executor.h"
+#include "internal/platform/implementation/windows/winrt_socket_streams.h"
 
 // WinRT headers
 #include "absl/types/optional.h"
@@ -136,7 +137,7 @@ class WifiHotspotSocket : public api::WifiHotspotSocket {
     Exception Close() override;
 
    private:
-    IInputStream input_stream_{nullptr};
+    WinRtSocketInputStream winrt_stream_{nullptr};
     SOCKET socket_ = INVALID_SOCKET;
     SocketType socket_type_ = SocketType::kWinRTSocket;
   };
@@ -153,7 +154,7 @@ class WifiHotspotSocket : public api::WifiHotspotSocket {
     Exception Close() override;
 
    private:
-    IOutputStream output_stream_{nullptr};
+    WinRtSocketOutputStream winrt_stream_{nullptr};
     SOCKET socket_ = INVALID_SOCKET;
     SocketType socket_type_ = SocketType::kWinRTSocket;
   };
@@ -81,8 +81,8 @@ Exception WifiHotspotSocket::Close() {
 }
 
 WifiHotspotSocket::SocketInputStream::SocketInputStream(
-    IInputStream input_stream) {
-  input_stream_ = input_stream;
+    IInputStream input_stream)
+    : winrt_stream_(input_stream) {
   socket_type_ = SocketType::kWinRTSocket;
 }
 
@@ -95,17 +95,7 @@ ExceptionOr<ByteArray> WifiHotspotSocket::SocketInputStream::Read(
     std::int64_t size) {
   try {
     if (socket_type_ == SocketType::kWinRTSocket) {
-      Buffer buffer = Buffer(size);
-
-      auto ibuffer =
-          input_stream_.ReadAsync(buffer, size, InputStreamOptions::None).get();
-
-      if (ibuffer.Length() != size) {
-        NEARBY_LOGS(WARNING) << "Only got part of data of needed.";
-      }
-
-      ByteArray data((char*)ibuffer.data(), ibuffer.Length());
-      return ExceptionOr<ByteArray>(data);
+      return winrt_stream_.Read(size);
     }
     // When socket_type_ == SocketType::kWin32Socket
     char recv_buf[kMaxByteRecieved];
@@ -154,12 +144,7 @@ ExceptionOr<ByteArray> WifiHotspotSocket::SocketInputStream::Read(
 ExceptionOr<size_t> WifiHotspotSocket::SocketInputStream::Skip(size_t offset) {
   try {
     if (socket_type_ == SocketType::kWinRTSocket) {
-      Buffer buffer = Buffer(offset);
-
-      auto ibuffer =
-          input_stream_.ReadAsync(buffer, offset, InputStreamOptions::None)
-              .get();
-      return ExceptionOr<size_t>((size_t)ibuffer.Length());
+      return winrt_stream_.Skip(offset);
     }
     // When socket_type_ == SocketType::kWin32Socket
     char recv_buf[kMaxByteRecieved];
@@ -206,7 +191,7 @@ ExceptionOr<size_t> WifiHotspotSocket::SocketInputStream::Skip(size_t offset) {
 Exception WifiHotspotSocket::SocketInputStream::Close() {
   try {
     if (socket_type_ == SocketType::kWinRTSocket) {
-      input_stream_.Close();
+      return winrt_stream_.Close();
     } else {
       // When socket_type_ == SocketType::kWin32Socket
       shutdown(socket_, SD_RECEIVE);
@@ -227,8 +212,8 @@ Exception WifiHotspotSocket::SocketInputStream::Close() {
 
 // SocketOutputStream
 WifiHotspotSocket::SocketOutputStream::SocketOutputStream(
-    IOutputStream output_stream) {
-  output_stream_ = output_stream;
+    IOutputStream output_stream)
+    : winrt_stream_(output_stream) {
   socket_type_ = SocketType::kWinRTSocket;
 }
 
@@ -240,12 +225,7 @@ WifiHotspotSocket::SocketOutputStream::SocketOutputStream(SOCKET socket) {
 Exception WifiHotspotSocket::SocketOutputStream::Write(const ByteArray& data) {
   try {
     if (socket_type_ == SocketType::kWinRTSocket) {
-      Buffer buffer = Buffer(data.size());
-      std::memcpy(buffer.data(), data.data(), data.size());
-      buffer.Length(data.size());
-
-      output_stream_.WriteAsync(buffer).get();
-      return {Exception::kSuccess};
+      return winrt_stream_.Write(data);
     }
     // When socket_type_ == SocketType::kWin32Socket
     char sendbuf[kMaxByteRecieved];
@@ -275,7 +255,7 @@ Exception WifiHotspotSocket::SocketOutputStream::Write(const ByteArray& data) {
 Exception WifiHotspotSocket::SocketOutputStream::Flush() {
   try {
     if (socket_type_ == SocketType::kWinRTSocket) {
-      output_stream_.FlushAsync().get();
+      return winrt_stream_.Flush();
     }
     return {Exception::kSuccess};
   } catch (std::exception exception) {
@@ -294,7 +274,7 @@ Exception WifiHotspotSocket::SocketOutputStream::Flush() {
 Exception WifiHotspotSocket::SocketOutputStream::Close() {
   try {
     if (socket_type_ == SocketType::kWinRTSocket) {
-      output_stream_.Close();
+      return winrt_stream_.Close();
     } else {
       // When socket_type_ == SocketType::kWin32Socket
       shutdown(socket_, SD_SEND);
@@ -38,6 +38,7 @@
 #include "internal/platform/exception.h"
 #include "internal/platform/implementation/wifi_lan.h"
 #include "internal/platform/implementation/windows/scheduled_executor.h"
+#include "internal/platform/implementation/windows/winrt_socket_streams.h"
 #include "internal/platform/input_stream.h"
 #include "internal/platform/mutex.h"
 #include "internal/platform/nsd_service_info.h"
@@ -116,38 +117,10 @@ class WifiLanSocket : public api::WifiLanSocket {
   Exception Close() override;
 
  private:
-  // A simple wrapper to handle input stream of socket
-  class SocketInputStream : public InputStream {
-   public:
-    SocketInputStream(IInputStream input_stream);
-    ~SocketInputStream() = default;
-
-    ExceptionOr<ByteArray> Read(std::int64_t size) override;
-    ExceptionOr<size_t> Skip(size_t offset) override;
-    Exception Close() override;
-
-   private:
-    IInputStream input_stream_{nullptr};
-  };
-
-  // A simple wrapper to handle output stream of socket
-  class SocketOutputStream : public OutputStream {
-   public:
-    SocketOutputStream(IOutputStream output_stream);
-    ~SocketOutputStream() = default;
-
-    Exception Write(const ByteArray& data) override;
-    Exception Flush() override;
-    Exception Close() override;
-
-   private:
-    IOutputStream output_stream_{nullptr};
-  };
-
   // Internal properties
   StreamSocket stream_soket_{nullptr};
-  SocketInputStream input_stream_{nullptr};
-  SocketOutputStream output_stream_{nullptr};
+  WinRtSocketInputStream input_stream_{nullptr};
+  WinRtSocketOutputStream output_stream_{nullptr};
 };
 
 // WifiLanServerSocket provides the support to server socket, this server socket
@@ -12,7 +12,6 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include <cstring>
 #include <exception>
 
 #include "internal/platform/implementation/windows/wifi_lan.h"
@@ -21,11 +20,10 @@
 namespace nearby {
 namespace windows {
 
-WifiLanSocket::WifiLanSocket(StreamSocket socket) {
-  stream_soket_ = socket;
-  input_stream_ = SocketInputStream(socket.InputStream());
-  output_stream_ = SocketOutputStream(socket.OutputStream());
-}
+WifiLanSocket::WifiLanSocket(StreamSocket socket)
+    : stream_soket_(socket),
+      input_stream_(socket.InputStream()),
+      output_stream_(socket.OutputStream()) {}
 
 WifiLanSocket::~WifiLanSocket() {
   try {
@@ -65,135 +63,5 @@ Exception WifiLanSocket::Close() {
   }
 }
 
-// SocketInputStream
-WifiLanSocket::SocketInputStream::SocketInputStream(IInputStream input_stream) {
-  input_stream_ = input_stream;
-}
-
-ExceptionOr<ByteArray> WifiLanSocket::SocketInputStream::Read(
-    std::int64_t size) {
-  try {
-    Buffer buffer = Buffer(size);
-
-    auto ibuffer =
-        input_stream_.ReadAsync(buffer, size, InputStreamOptions::None).get();
-
-    if (ibuffer.Length() != size) {
-      NEARBY_LOGS(WARNING) << "Only got part of data of needed.";
-    }
-
-    ByteArray data((char*)ibuffer.data(), ibuffer.Length());
-
-    return ExceptionOr(data);
-  } catch (std::exception exception) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Exception: " << exception.what();
-    return {Exception::kIo};
-  } catch (const winrt::hresult_error& error) {
-    NEARBY_LOGS(ERROR) << __func__ << ": WinRT exception: " << error.code()
-                       << ": " << winrt::to_string(error.message());
-    return {Exception::kIo};
-  } catch (...) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Unknown exeption.";
-    return {Exception::kIo};
-  }
-}
-
-ExceptionOr<size_t> WifiLanSocket::SocketInputStream::Skip(size_t offset) {
-  try {
-    Buffer buffer = Buffer(offset);
-
-    auto ibuffer =
-        input_stream_.ReadAsync(buffer, offset, InputStreamOptions::None).get();
-    return ExceptionOr((size_t)ibuffer.Length());
-  } catch (std::exception exception) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Exception: " << exception.what();
-    return {Exception::kIo};
-  } catch (const winrt::hresult_error& error) {
-    NEARBY_LOGS(ERROR) << __func__ << ": WinRT exception: " << error.code()
-                       << ": " << winrt::to_string(error.message());
-    return {Exception::kIo};
-  } catch (...) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Unknown exeption.";
-    return {Exception::kIo};
-  }
-}
-
-Exception WifiLanSocket::SocketInputStream::Close() {
-  try {
-    input_stream_.Close();
-    return {Exception::kSuccess};
-  } catch (std::exception exception) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Exception: " << exception.what();
-    return {Exception::kIo};
-  } catch (const winrt::hresult_error& error) {
-    NEARBY_LOGS(ERROR) << __func__ << ": WinRT exception: " << error.code()
-                       << ": " << winrt::to_string(error.message());
-    return {Exception::kIo};
-  } catch (...) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Unknown exeption.";
-    return {Exception::kIo};
-  }
-}
-
-// SocketOutputStream
-WifiLanSocket::SocketOutputStream::SocketOutputStream(
-    IOutputStream output_stream) {
-  output_stream_ = output_stream;
-}
-
-Exception WifiLanSocket::SocketOutputStream::Write(const ByteArray& data) {
-  try {
-    Buffer buffer = Buffer(data.size());
-    std::memcpy(buffer.data(), data.data(), data.size());
-    buffer.Length(data.size());
-    output_stream_.WriteAsync(buffer).get();
-    return {Exception::kSuccess};
-  } catch (std::exception exception) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Exception: " << exception.what();
-    return {Exception::kIo};
-  } catch (const winrt::hresult_error& error) {
-    NEARBY_LOGS(ERROR) << __func__ << ": WinRT exception: " << error.code()
-                       << ": " << winrt::to_string(error.message());
-    return {Exception::kIo};
-  } catch (...) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Unknown exeption.";
-    return {Exception::kIo};
-  }
-}
-
-Exception WifiLanSocket::SocketOutputStream::Flush() {
-  try {
-    output_stream_.FlushAsync().get();
-    return {Exception::kSuccess};
-  } catch (std::exception exception) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Exception: " << exception.what();
-    return {Exception::kIo};
-  } catch (const winrt::hresult_error& error) {
-    NEARBY_LOGS(ERROR) << __func__ << ": WinRT exception: " << error.code()
-                       << ": " << winrt::to_string(error.message());
-    return {Exception::kIo};
-  } catch (...) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Unknown exeption.";
-    return {Exception::kIo};
-  }
-}
-
-Exception WifiLanSocket::SocketOutputStream::Close() {
-  try {
-    output_stream_.Close();
-    return {Exception::kSuccess};
-  } catch (std::exception exception) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Exception: " << exception.what();
-    return {Exception::kIo};
-  } catch (const winrt::hresult_error& error) {
-    NEARBY_LOGS(ERROR) << __func__ << ": WinRT exception: " << error.code()
-                       << ": " << winrt::to_string(error.message());
-    return {Exception::kIo};
-  } catch (...) {
-    NEARBY_LOGS(ERROR) << __func__ << ": Unknown exeption.";
-    return {Exception::kIo};
-  }
-}
-
 }  // namespace windows
 }  // namespace nearby
@@ -0,0 +1,208 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/implementation/windows/winrt_socket_streams.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <utility>
+
+#include "internal/platform/logging.h"
+
+namespace nearby {
+namespace windows {
+
+using ::winrt::Windows::Storage::Streams::Buffer;
+using ::winrt::Windows::Storage::Streams::IInputStream;
+using ::winrt::Windows::Storage::Streams::InputStreamOptions;
+using ::winrt::Windows::Storage::Streams::IOutputStream;
+
+// WinRtSocketInputStream
+WinRtSocketInputStream::WinRtSocketInputStream(IInputStream input_stream)
+    : input_stream_(input_stream) {}
+
+ExceptionOr<ByteArray> WinRtSocketInputStream::Read(std::int64_t size) {
+  try {
+    if (size <= 0) {
+      NEARBY_LOGS(ERROR) << __func__ << ": Invalid read size: " << size;
+      return {Exception::kIo};
+    }
+    if (!FillCurrentBuffer()) {
+      return ExceptionOr<ByteArray>(ByteArray());
+    }
+    std::uint32_t length = static_cast<std::uint32_t>(std::min<std::int64_t>(
+        size, current_.Length() - current_offset_));
+    ByteArray data(reinterpret_cast<const char*>(current_.data()) +
+                       current_offset_,
+                   length);
+    current_offset_ += length;
+    return ExceptionOr<ByteArray>(std::move(data));
+  } catch (std::exception exception) {
+    NEARBY_LOGS(ERROR) << __func__ << ": Exception: " << exception.what();
+    return {Exception::kIo};
+  } catch (const winrt::hresult_error& error) {
+    NEARBY_LOGS(ERROR) << __func__ << ": WinRT exception: " << error.code()
+                       << ": " << winrt::to_string(error.message());
+    return {Exception::kIo};
+  } catch (...) {
+    NEARBY_LOGS(ERROR) << __func__ << ": Unknown exeption.";
+    return {Exception::kIo};
+  }
+}
+
+ExceptionOr<size_t> WinRtSocketInputStream::Skip(size_t offset) {
+  try {
+    size_t skipped = 0;
+    while (skipped < offset && FillCurrentBuffer()) {
+      std::uint32_t length = static_cast<std::uint32_t>(std::min<size_t>(
+          offset - skipped, current_.Length() - current_offset_));
+      current_offset_ += length;
+      skipped += length;
+    }
+    return ExceptionOr<size_t>(skipped);
+  } catch (std::exception exception) {
+    NEARBY_LOGS(ERROR) << __func__ << ": Exception: " << exception.what();
+    return {Exception::kIo};
+  } catch (const winrt::hresult_error& error) {
+    NEARBY_LOGS(ERROR) << __func__ << ": WinRT exception: " << error.code()
+                       << ": " << winrt::to_string(error.message());
+    return {Exception::kIo};
+  } catch (...) {
+    NEARBY_LOGS(ERROR) << __func__ << ": Unknown exeption.";
+    return {Exception::kIo};
+  }
+}
+
+Exception WinRtSocketInputStream::Close() {
+  try {
+    // Closing the stream also completes the outstanding read, so a reader
+    // blocked on it returns.
+    if (input_stream_ != nullptr) {
+      input_stream_.Close();
+    }
+    return {Exception::kSuccess};
+  } catch (std::exception exception) {
+    NEARBY_LOGS(ERROR) << __func__ << ": Exception: " << exception.what();
+    return {Exception::kIo};
+  } catch (const winrt::hresult_error& error) {
+    NEARBY_LOGS(ERROR) << __func__ << ": WinRT exception: " << error.code()
+                       << ": " << winrt::to_string(error.message());
+    return {Exception::kIo};
+  } catch (...) {
+    NEARBY_LOGS(ERROR) << __func__ << ": Unknown exeption.";
+    return {Exception::kIo};
+  }
+}
+
+bool WinRtSocketInputStream::FillCurrentBuffer() {
+  if (current_ != nullptr && current_offset_ < current_.Length()) {
+    return true;
+  }
+  if (pending_read_ == nullptr) {
+    StartNextRead();
+  }
+  // The completed read may hand back a different buffer than the one it was
+  // given, so always consume the returned one.
+  current_ = pending_read_.get();
+  current_offset_ = 0;
+  pending_read_ = nullptr;
+  next_buffer_ = 1 - next_buffer_;
+  if (current_.Length() == 0) {
+    // End of stream, don't read any further ahead.
+    return false;
+  }
+  // |current_| is done with the other buffer, so it can take the next read.
+  StartNextRead();
+  return true;
+}
+
+void WinRtSocketInputStream::StartNextRead() {
+  Buffer& buffer = buffers_[next_buffer_];
+  if (buffer == nullptr) {
+    buffer = Buffer(kReadBufferSize);
+  }
+  // Partial, so the read completes as soon as any bytes arrived instead of
+  // waiting for a full buffer.
+  pending_read_ = input_stream_.ReadAsync(buffer, buffer.Capacity(),
+                                          InputStreamOptions::Partial);
+}
+
+// WinRtSocketOutputStream
+WinRtSocketOutputStream::WinRtSocketOutputStream(IOutputStream output_stream)
+    : output_stream_(output_stream) {}
+
+Exception WinRtSocketOutputStream::Write(const ByteArray& data) {
+  try {
+    if (write_buffer_ == nullptr || write_buffer_.Capacity() < data.size()) {
+      write_buffer_ = Buffer(data.size());
+    }
+    std::memcpy(write_buffer_.data(), data.data(), data.size());
+    write_buffer_.Length(data.size());
+    output_stream_.WriteAsync(write_buffer_).get();
+    return {Exception::kSuccess};
+  } catch (std::exception exception) {
+    NEARBY_LOGS(ERROR) << __func__ << ": Exception: " << exception.what();
+    return {Exception::kIo};
+  } catch (const winrt::hresult_error& error) {
+    NEARBY_LOGS(ERROR) << __func__ << ": WinRT exception: " << error.code()
+                       << ": " << winrt::to_string(error.message());
+    return {Exception::kIo};
+  } catch (...) {
+    NEARBY_LOGS(ERROR) << __func__ << ": Unknown exeption.";
+    return {Exception::kIo};
+  }
+}
+
+Exception WinRtSocketOutputStream::Flush() {
+  try {
+    if (output_stream_ == nullptr) {
+      return {Exception::kSuccess};
+    }
+    output_stream_.FlushAsync().get();
+    return {Exception::kSuccess};
+  } catch (std::exception exception) {
+    NEARBY_LOGS(ERROR) << __func__ << ": Exception: " << exception.what();
+    return {Exception::kIo};
+  } catch (const winrt::hresult_error& error) {
+    NEARBY_LOGS(ERROR) << __func__ << ": WinRT exception: " << error.code()
+                       << ": " << winrt::to_string(error.message());
+    return {Exception::kIo};
+  } catch (...) {
+    NEARBY_LOGS(ERROR) << __func__ << ": Unknown exeption.";
+    return {Exception::kIo};
+  }
+}
+
+Exception WinRtSocketOutputStream::Close() {
+  try {
+    if (output_stream_ != nullptr) {
+      output_stream_.Close();
+    }
+    return {Exception::kSuccess};
+  } catch (std::exception exception) {
+    NEARBY_LOGS(ERROR) << __func__ << ": Exception: " << exception.what();
+    return {Exception::kIo};
+  } catch (const winrt::hresult_error& error) {
+    NEARBY_LOGS(ERROR) << __func__ << ": WinRT exception: " << error.code()
+                       << ": " << winrt::to_string(error.message());
+    return {Exception::kIo};
+  } catch (...) {
+    NEARBY_LOGS(ERROR) << __func__ << ": Unknown exeption.";
+    return {Exception::kIo};
+  }
+}
+
+}  // namespace windows
+}  // namespace nearby
@@ -0,0 +1,96 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PLATFORM_IMPL_WINDOWS_WINRT_SOCKET_STREAMS_H_
+#define PLATFORM_IMPL_WINDOWS_WINRT_SOCKET_STREAMS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/input_stream.h"
+#include "internal/platform/output_stream.h"
+
+// WinRT headers
+#include "internal/platform/implementation/windows/generated/winrt/Windows.Foundation.h"
+#include "internal/platform/implementation/windows/generated/winrt/Windows.Storage.Streams.h"
+#include "internal/platform/implementation/windows/generated/winrt/base.h"
+
+namespace nearby {
+namespace windows {
+
+// InputStream over the IInputStream of a WinRT StreamSocket.
+//
+// One read is always kept outstanding: while the caller consumes the bytes of
+// the last completed read, the next one is already filling a second buffer.
+// The two buffers are allocated once and reused for the lifetime of the
+// stream, and Skip() discards bytes without allocating.
+//
+// Like the other socket streams, it must not be read from several threads at
+// the same time. Close() may be called from any thread; it fails the read
+// in progress.
+class WinRtSocketInputStream : public InputStream {
+ public:
+  // Bytes requested from the socket by each read.
+  static constexpr std::uint32_t kReadBufferSize = 64 * 1024;
+
+  explicit WinRtSocketInputStream(
+      winrt::Windows::Storage::Streams::IInputStream input_stream);
+  ~WinRtSocketInputStream() override = default;
+
+  ExceptionOr<ByteArray> Read(std::int64_t size) override;
+  ExceptionOr<size_t> Skip(size_t offset) override;
+  Exception Close() override;
+
+ private:
+  // Makes sure |current_| has unread bytes. Returns false on end of stream.
+  // Throws on socket errors.
+  bool FillCurrentBuffer();
+  void StartNextRead();
+
+  winrt::Windows::Storage::Streams::IInputStream input_stream_{nullptr};
+  winrt::Windows::Storage::Streams::Buffer buffers_[2]{nullptr, nullptr};
+  // Index into |buffers_| of the buffer the outstanding read fills.
+  int next_buffer_ = 0;
+  winrt::Windows::Foundation::IAsyncOperationWithProgress<
+      winrt::Windows::Storage::Streams::IBuffer, std::uint32_t>
+      pending_read_{nullptr};
+  // Result of the last completed read, and how much of it was consumed.
+  winrt::Windows::Storage::Streams::IBuffer current_{nullptr};
+  std::uint32_t current_offset_ = 0;
+};
+
+// OutputStream over the IOutputStream of a WinRT StreamSocket. Copies each
+// write into a buffer that is kept and only grown, instead of allocating a
+// new one per write.
+class WinRtSocketOutputStream : public OutputStream {
+ public:
+  explicit WinRtSocketOutputStream(
+      winrt::Windows::Storage::Streams::IOutputStream output_stream);
+  ~WinRtSocketOutputStream() override = default;
+
+  Exception Write(const ByteArray& data) override;
+  Exception Flush() override;
+  Exception Close() override;
+
+ private:
+  winrt::Windows::Storage::Streams::IOutputStream output_stream_{nullptr};
+  winrt::Windows::Storage::Streams::Buffer write_buffer_{nullptr};
+};
+
+}  // namespace windows
+}  // namespace nearby
+
+#endif  // PLATFORM_IMPL_WINDOWS_WINRT_SOCKET_STREAMS_H_
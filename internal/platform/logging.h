@@ -39,6 +39,10 @@
 #else
 #include "glog/logging.h"
 #endif
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+
 #include "internal/platform/implementation/log_message.h"
 #include "internal/platform/implementation/platform.h"
 
@@ -55,6 +59,39 @@ class LogMessageVoidify {
   void operator&(std::ostream&) {}
 };
 
+// Per call site state of NEARBY_LOGS_EVERY_N.
+class LogEveryNState {
+ public:
+  // Returns true for the first call and for every |n|th call after it.
+  bool ShouldLog(int n) {
+    std::uint32_t count = counter_.fetch_add(1, std::memory_order_relaxed);
+    return n <= 1 || count % static_cast<std::uint32_t>(n) == 0;
+  }
+
+ private:
+  std::atomic<std::uint32_t> counter_{0};
+};
+
+// Per call site state of NEARBY_LOGS_EVERY_N_SEC.
+class LogEveryNSecState {
+ public:
+  // Returns true if no call returned true in the last |seconds| seconds.
+  bool ShouldLog(double seconds) {
+    std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now().time_since_epoch())
+                           .count();
+    std::int64_t next = next_log_nanos_.load(std::memory_order_relaxed);
+    if (now < next) return false;
+    // Only one of the threads racing past |next| gets to log.
+    return next_log_nanos_.compare_exchange_strong(
+        next, now + static_cast<std::int64_t>(seconds * 1e9),
+        std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<std::int64_t> next_log_nanos_{0};
+};
+
 }  // namespace nearby
 
 // Severity enum conversion
@@ -71,9 +108,24 @@ class LogMessageVoidify {
 #endif  // defined(_WIN32)
 #define NEARBY_SEVERITY(severity) NEARBY_SEVERITY_##severity
 
+// Compile-time minimum severity, as the integer value of
+// nearby::api::LogMessage::Severity. Log statements below it are compiled out
+// together with their operands; e.g. -DNEARBY_MIN_LOG_SEVERITY=0 strips all
+// VERBOSE logs. FATAL logs are always kept.
+#ifndef NEARBY_MIN_LOG_SEVERITY
+#define NEARBY_MIN_LOG_SEVERITY -1
+#endif
+
+#define NEARBY_LOG_IS_COMPILED(severity)                                   \
+  (static_cast<int>(NEARBY_SEVERITY(severity)) >= NEARBY_MIN_LOG_SEVERITY || \
+   NEARBY_SEVERITY(severity) == NEARBY_SEVERITY_FATAL)
+
 // Log enabling
-#define NEARBY_LOG_IS_ON(severity) \
-  nearby::api::LogMessage::ShouldCreateLogMessage(NEARBY_SEVERITY(severity))
+// The runtime check runs before any LogMessage is created, so a filtered log
+// statement costs one call and never evaluates its operands.
+#define NEARBY_LOG_IS_ON(severity)    \
+  (NEARBY_LOG_IS_COMPILED(severity) && \
+   nearby::api::LogMessage::ShouldCreateLogMessage(NEARBY_SEVERITY(severity)))
 
 #define NEARBY_LOG_SET_SEVERITY(severity) \
   nearby::api::LogMessage::SetMinLogSeverity(NEARBY_SEVERITY(severity))
@@ -94,6 +146,26 @@ class LogMessageVoidify {
   NEARBY_LOG_IS_ON(severity)      \
   ? NEARBY_LOG_MESSAGE(severity)->Print(__VA_ARGS__) : (void)0
 
+// Rate-limited variants for per-frame and per-chunk diagnostics. Each call
+// site keeps its own state. NEARBY_LOGS_EVERY_N logs the first and then every
+// |n|th enabled occurrence; NEARBY_LOGS_EVERY_N_SEC logs at most once per
+// |seconds|. Skipped occurrences don't evaluate their operands.
+#define NEARBY_LOGS_EVERY_N(severity, n)                       \
+  !(NEARBY_LOG_IS_ON(severity) && []() {                       \
+    static nearby::LogEveryNState state;                       \
+    return &state;                                             \
+  }()->ShouldLog(n))                                           \
+      ? (void)0                                                \
+      : nearby::LogMessageVoidify() & NEARBY_LOG_MESSAGE(severity)->Stream()
+
+#define NEARBY_LOGS_EVERY_N_SEC(severity, seconds)             \
+  !(NEARBY_LOG_IS_ON(severity) && []() {                       \
+    static nearby::LogEveryNSecState state;                    \
+    return &state;                                             \
+  }()->ShouldLog(seconds))                                     \
+      ? (void)0                                                \
+      : nearby::LogMessageVoidify() & NEARBY_LOG_MESSAGE(severity)->Stream()
+
 #ifdef NEARBY_SWIFTPM
 #define LOG(severity) NEARBY_LOGS(severity)
 #endif
@@ -50,4 +50,37 @@ TEST(LoggingTest, CanStream_LoggingDisabled) {
   EXPECT_EQ(num, 42);
 }
 
+TEST(LoggingTest, CanStreamEveryN) {
+  NEARBY_LOG_SET_SEVERITY(INFO);
+  int num = 0;
+  for (int i = 0; i < 10; ++i) {
+    NEARBY_LOGS_EVERY_N(INFO, 3) << "Every third: " << num++;
+  }
+  // Evaluated on the 1st, 4th, 7th and 10th calls.
+  EXPECT_EQ(num, 4);
+}
+
+TEST(LoggingTest, CanStreamEveryN_LoggingDisabled) {
+  NEARBY_LOG_SET_SEVERITY(ERROR);
+  int num = 0;
+  for (int i = 0; i < 10; ++i) {
+    NEARBY_LOGS_EVERY_N(INFO, 3) << "Every third: " << num++;
+  }
+  EXPECT_EQ(num, 0);
+}
+
+TEST(LoggingTest, CanStreamEveryNSec) {
+  NEARBY_LOG_SET_SEVERITY(INFO);
+  int num = 0;
+  for (int i = 0; i < 10; ++i) {
+    NEARBY_LOGS_EVERY_N_SEC(INFO, 3600) << "Once an hour: " << num++;
+  }
+  EXPECT_EQ(num, 1);
+}
+
+TEST(LoggingTest, VerboseIsCompiledByDefault) {
+  EXPECT_TRUE(NEARBY_LOG_IS_COMPILED(VERBOSE));
+  EXPECT_TRUE(NEARBY_LOG_IS_COMPILED(FATAL));
+}
+
 }  // namespace
@@ -21,13 +21,16 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <thread>  // NOLINT
 #include <type_traits>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/strings/escaping.h"
+#include "absl/synchronization/notification.h"
 #include "absl/types/optional.h"
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/feature_flags.h"
@@ -38,7 +41,17 @@
 
 namespace nearby {
 
+namespace {
+thread_local MediumEnvironment* scoped_instance = nullptr;
+}  // namespace
+
+MediumEnvironment::Scope::Scope(MediumEnvironment* env)
+    : previous_(std::exchange(scoped_instance, env)) {}
+
+MediumEnvironment::Scope::~Scope() { scoped_instance = previous_; }
+
 MediumEnvironment& MediumEnvironment::Instance() {
+  if (scoped_instance != nullptr) return *scoped_instance;
   static std::aligned_storage_t<sizeof(MediumEnvironment),
                                 alignof(MediumEnvironment)>
       storage;
@@ -46,6 +59,19 @@ MediumEnvironment& MediumEnvironment::Instance() {
   return *env;
 }
 
+MediumEnvironment* MediumEnvironment::GetScopedInstance() {
+  return scoped_instance;
+}
+
+std::unique_ptr<MediumEnvironment> MediumEnvironment::Create() {
+  return absl::WrapUnique(new MediumEnvironment());
+}
+
+MediumEnvironment::~MediumEnvironment() {
+  Scope scope(this);
+  Stop();
+}
+
 void MediumEnvironment::Start(EnvironmentConfig config) {
   if (!enabled_.exchange(true)) {
     NEARBY_LOGS(INFO) << "MediumEnvironment::Start()";
@@ -55,6 +81,13 @@ void MediumEnvironment::Start(EnvironmentConfig config) {
       simulated_clock_ = std::make_unique<FakeClock>();
     }
     Reset();
+    if (config_.use_simulated_clock && config_.auto_advance_simulated_clock) {
+      auto_advance_simulated_clock_ = true;
+      auto_advance_stopped_ = std::make_unique<absl::Notification>();
+      auto_advance_thread_ =
+          std::thread(&MediumEnvironment::RunAutoAdvance, this,
+                      auto_advance_stopped_.get());
+    }
   }
 }
 
@@ -62,11 +95,20 @@ void MediumEnvironment::Stop() {
   if (enabled_.exchange(false)) {
     NEARBY_LOGS(INFO) << "MediumEnvironment::Stop()";
     Sync(false);
+    if (auto_advance_thread_.joinable()) {
+      auto_advance_stopped_->Notify();
+      auto_advance_thread_.join();
+      auto_advance_stopped_.reset();
+      auto_advance_simulated_clock_ = false;
+    }
     if (config_.use_simulated_clock) {
       MutexLock lock(&mutex_);
       simulated_clock_.reset();
+      simulated_alarms_.clear();
     }
     config_ = {};
+    MutexLock lock(&mutex_);
+    link_models_.clear();
   }
 }
 
@@ -86,6 +128,7 @@ void MediumEnvironment::Reset() {
       MutexLock lock(&mutex_);
       wifi_direct_mediums_.clear();
       wifi_hotspot_mediums_.clear();
+      link_models_ = config_.link_models;
     }
     use_valid_peer_connection_ = true;
     peer_connection_latency_ = absl::ZeroDuration();
@@ -117,6 +160,20 @@ const EnvironmentConfig& MediumEnvironment::GetEnvironmentConfig() {
   return config_;
 }
 
+void MediumEnvironment::SetLinkModel(
+    location::nearby::proto::connections::Medium medium,
+    const LinkModel& model) {
+  MutexLock lock(&mutex_);
+  link_models_[medium] = model;
+}
+
+LinkModel MediumEnvironment::GetLinkModel(
+    location::nearby::proto::connections::Medium medium) {
+  MutexLock lock(&mutex_);
+  auto it = link_models_.find(medium);
+  return it != link_models_.end() ? it->second : LinkModel();
+}
+
 void MediumEnvironment::OnBluetoothAdapterChangedState(
     api::BluetoothAdapter& adapter, api::BluetoothDevice& adapter_device,
     std::string name, bool enabled, api::BluetoothAdapter::ScanMode mode) {
@@ -391,7 +448,11 @@ void MediumEnvironment::OnWifiLanServiceStateChanged(
 
 void MediumEnvironment::RunOnMediumEnvironmentThread(Runnable runnable) {
   job_count_++;
-  executor_.Execute(std::move(runnable));
+  executor_.Execute([this, runnable = std::move(runnable)]() mutable {
+    // |executor_| may have been created outside of any Scope.
+    Scope scope(this);
+    runnable();
+  });
 }
 
 void MediumEnvironment::RegisterBluetoothMedium(
@@ -1122,6 +1183,38 @@ absl::optional<FakeClock*> MediumEnvironment::GetSimulatedClock() {
   return absl::nullopt;
 }
 
+void MediumEnvironment::AddSimulatedAlarm(absl::Time trigger_time) {
+  MutexLock lock(&mutex_);
+  simulated_alarms_.insert(trigger_time);
+}
+
+void MediumEnvironment::RunAutoAdvance(absl::Notification* stopped) {
+  Scope scope(this);
+  std::int64_t last_activity = -1;
+  while (!stopped->WaitForNotificationWithTimeout(kAutoAdvanceIdleTime)) {
+    std::int64_t activity = executor_activity_.load(std::memory_order_relaxed);
+    if (activity != last_activity) {
+      last_activity = activity;
+      continue;
+    }
+
+    // Nothing ran for a whole period, so everyone is waiting on a timeout.
+    FakeClock* clock;
+    absl::Duration delay;
+    {
+      MutexLock lock(&mutex_);
+      if (!simulated_clock_) continue;
+      clock = simulated_clock_.get();
+      simulated_alarms_.erase(simulated_alarms_.begin(),
+                              simulated_alarms_.upper_bound(clock->Now()));
+      if (simulated_alarms_.empty()) continue;
+      delay = *simulated_alarms_.begin() - clock->Now();
+    }
+    // The clock outlives this thread, see Stop().
+    clock->FastForward(delay);
+  }
+}
+
 void MediumEnvironment::RegisterGattServer(
     api::ble_v2::BleMedium& medium, api::ble_v2::BlePeripheral* peripheral,
     Borrowable<api::ble_v2::GattServer*> gatt_server) {
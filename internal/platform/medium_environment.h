@@ -16,15 +16,20 @@
 #define PLATFORM_BASE_MEDIUM_ENVIRONMENT_H_
 
 #include <atomic>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
+#include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "internal/base/observer_list.h"
 #include "internal/platform/borrowable.h"
@@ -46,9 +51,41 @@
 #include "internal/platform/nsd_service_info.h"
 #include "internal/platform/single_thread_executor.h"
 #include "internal/platform/wifi_credential.h"
+#include "proto/connections_enums.pb.h"
 
 namespace nearby {
 
+// Characteristics of the link that simulated sockets emulate for the data
+// written to them. A default constructed LinkModel is an ideal link, which
+// transfers data at memory speed.
+struct LinkModel {
+  // Maximum throughput of the link; 0 means unlimited.
+  std::int64_t bandwidth_bytes_per_second = 0;
+
+  // Round trip time of the link. Every write reaches the peer after half of
+  // it, plus its transmission time.
+  absl::Duration round_trip_time = absl::ZeroDuration();
+
+  // Upper bound of a uniformly distributed extra delay added to every write.
+  // The link stays in order, so jitter never reorders data.
+  absl::Duration jitter = absl::ZeroDuration();
+
+  // Probability that a write is lost and retransmitted, which delays it by
+  // another round trip.
+  double loss_probability = 0;
+
+  // Probability that a write breaks the link. The write fails, and the peer
+  // reads end of stream.
+  double disconnect_probability = 0;
+
+  bool IsIdeal() const {
+    return bandwidth_bytes_per_second <= 0 &&
+           round_trip_time <= absl::ZeroDuration() &&
+           jitter <= absl::ZeroDuration() && loss_probability <= 0 &&
+           disconnect_probability <= 0;
+  }
+};
+
 // Environment config that can control availability of certain mediums for
 // testing.
 struct EnvironmentConfig {
@@ -61,6 +98,20 @@ struct EnvironmentConfig {
   // The simulated clock is automatically picked up by SystemClock, Timer and
   // ScheduledExecutor implementations.
   bool use_simulated_clock = false;
+
+  // With use_simulated_clock, jumps the simulated clock to the next alarm of a
+  // ScheduledExecutor once no executor has been handed or finished a task for
+  // kAutoAdvanceIdleTime of real time. Timeouts then pass as soon as the
+  // devices are waiting on them, so long scenarios run at CPU speed. Work that
+  // takes a while without touching executors, e.g. a slow simulated link, can
+  // see its timeouts fire early.
+  bool auto_advance_simulated_clock = false;
+
+  // Link models applied to simulated sockets of the given mediums. Mediums
+  // without an entry use an ideal link. Delays are in real time, even
+  // with the simulated clock installed.
+  absl::flat_hash_map<location::nearby::proto::connections::Medium, LinkModel>
+      link_models;
 };
 
 // MediumEnvironment is a simulated environment which allows multiple instances
@@ -94,9 +145,37 @@ class MediumEnvironment {
   MediumEnvironment(const MediumEnvironment&) = delete;
   MediumEnvironment& operator=(const MediumEnvironment&) = delete;
 
-  // Creates and returns a reference to the global test environment instance.
+  // Makes Instance() return |env| on the current thread while it lives. g3
+  // executors created meanwhile keep running their tasks in |env|, so that
+  // the devices of a scenario, their callbacks and their simulated clock stay
+  // in it. This lets independent scenarios run side by side in one process.
+  class Scope {
+   public:
+    explicit Scope(MediumEnvironment* env);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    MediumEnvironment* previous_;
+  };
+
+  // Returns the environment of the innermost Scope on the current thread, or
+  // else the global test environment instance, creating it if needed.
   static MediumEnvironment& Instance();
 
+  // Returns the environment of the innermost Scope on the current thread, or
+  // nullptr if there is none.
+  static MediumEnvironment* GetScopedInstance();
+
+  // Creates an environment isolated from the global one and from any other,
+  // to be used through a Scope. It must outlive the mediums and executors
+  // created in it.
+  static std::unique_ptr<MediumEnvironment> Create();
+
+  // Stops the environment. Never called for the global instance.
+  ~MediumEnvironment();
+
   // Global ON/OFF switch for medium environment.
   // Start & Stop work as On/Off switch for this object.
   // Default state (after creation) is ON, to make it compatible with early
@@ -160,6 +239,15 @@ class MediumEnvironment {
       absl::string_view mac_address);
 
   const EnvironmentConfig& GetEnvironmentConfig();
+
+  // Replaces the link model of |medium|, overriding the one from
+  // EnvironmentConfig until the next Reset(). Only applies to sockets that
+  // connect afterwards.
+  void SetLinkModel(location::nearby::proto::connections::Medium medium,
+                    const LinkModel& model);
+
+  // Returns the link model that new sockets of |medium| should apply.
+  LinkModel GetLinkModel(location::nearby::proto::connections::Medium medium);
 #ifndef NO_WEBRTC
   // Registers |message_callback| to receive messages sent to device with id
   // |self_id|, and |complete_callback| to notify when signaling is complete.
@@ -345,6 +433,24 @@ class MediumEnvironment {
 
   absl::optional<FakeClock*> GetSimulatedClock();
 
+  // Real time without executor activity after which the simulated clock is
+  // advanced, if EnvironmentConfig::auto_advance_simulated_clock is set.
+  static constexpr absl::Duration kAutoAdvanceIdleTime = absl::Milliseconds(20);
+
+  // Whether executors need to report their activity and alarms below.
+  bool IsAutoAdvancingSimulatedClock() const {
+    return auto_advance_simulated_clock_;
+  }
+
+  // Tells the environment that an executor was handed or finished a task.
+  void NotifyExecutorActivity() {
+    executor_activity_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Tells the environment that a ScheduledExecutor has a task due at
+  // |trigger_time| on the simulated clock.
+  void AddSimulatedAlarm(absl::Time trigger_time);
+
   api::ble_v2::BleMedium* FindBleV2Medium(absl::string_view address);
   api::ble_v2::BleMedium* FindBleV2Medium(uint64_t id);
 
@@ -448,12 +554,10 @@ class MediumEnvironment {
     std::optional<api::BluetoothPairingCallback::PairingError> pairing_error;
   };
 
-  // This is a singleton object, for which destructor will never be called.
-  // Constructor will be invoked once from Instance() static method.
-  // Object is create in-place (with a placement new) to guarantee that
-  // destructor is not scheduled for execution at exit.
+  // The global instance is created in-place (with a placement new) by
+  // Instance(), to guarantee that its destructor is not scheduled for
+  // execution at exit. Other instances come from Create().
   MediumEnvironment() = default;
-  ~MediumEnvironment() = default;
 
   void OnBluetoothDeviceStateChanged(BluetoothMediumContext& info,
                                      api::BluetoothDevice& device,
@@ -477,6 +581,10 @@ class MediumEnvironment {
 
   void RunOnMediumEnvironmentThread(Runnable runnable);
 
+  // Advances the simulated clock to the next alarm whenever executors are
+  // idle, until |stopped| is notified.
+  void RunAutoAdvance(absl::Notification* stopped);
+
   std::atomic_bool enabled_ = false;
   std::atomic_int job_count_ = 0;
   std::atomic_bool enable_notifications_ = false;
@@ -518,6 +626,16 @@ class MediumEnvironment {
   bool use_valid_peer_connection_ = true;
   absl::Duration peer_connection_latency_ = absl::ZeroDuration();
   std::unique_ptr<FakeClock> simulated_clock_ ABSL_GUARDED_BY(mutex_);
+  // Trigger times of tasks scheduled on the simulated clock, including ones
+  // canceled meanwhile.
+  absl::btree_multiset<absl::Time> simulated_alarms_ ABSL_GUARDED_BY(mutex_);
+  std::atomic_bool auto_advance_simulated_clock_ = false;
+  std::atomic<std::int64_t> executor_activity_ = 0;
+  // Set while |auto_advance_thread_| runs.
+  std::unique_ptr<absl::Notification> auto_advance_stopped_;
+  std::thread auto_advance_thread_;
+  absl::flat_hash_map<location::nearby::proto::connections::Medium, LinkModel>
+      link_models_ ABSL_GUARDED_BY(mutex_);
   ObserverList<api::BluetoothClassicMedium::Observer> observers_;
 };
 
@@ -27,30 +27,53 @@ absl::Duration kMinReportedTaskDuration = absl::Seconds(10);
 }  // namespace
 
 MonitoredRunnable::MonitoredRunnable(Runnable&& runnable)
-    : runnable_{std::move(runnable)} {}
+    : MonitoredRunnable("", std::move(runnable)) {}
 
-MonitoredRunnable::MonitoredRunnable(const std::string& name,
+MonitoredRunnable::MonitoredRunnable(absl::string_view name,
                                      Runnable&& runnable)
-    : name_{name}, runnable_{std::move(runnable)} {
-  PendingJobRegistry::GetInstance().AddPendingJob(name_, post_time_);
+    : MonitoredRunnable(name, /*lockable=*/nullptr, std::move(runnable)) {}
+
+MonitoredRunnable::MonitoredRunnable(absl::string_view name,
+                                     const Lockable* lockable,
+                                     Runnable&& runnable)
+    : name_{PendingJobRegistry::InternName(name)},
+      lockable_{lockable},
+      runnable_{std::move(runnable)} {
+  job_id_ = PendingJobRegistry::GetInstance().AddPendingJob(name_, post_time_);
+}
+
+MonitoredRunnable::MonitoredRunnable(MonitoredRunnable&& other)
+    : name_{other.name_},
+      lockable_{other.lockable_},
+      runnable_{std::move(other.runnable_)},
+      post_time_{other.post_time_},
+      job_id_{std::exchange(other.job_id_, PendingJobRegistry::kNoJob)} {}
+
+MonitoredRunnable::~MonitoredRunnable() {
+  PendingJobRegistry::GetInstance().RemoveJob(job_id_);
 }
 
 void MonitoredRunnable::operator()() {
   auto start_time = SystemClock::ElapsedRealtime();
   auto start_delay = start_time - post_time_;
   if (start_delay >= kMinReportedStartDelay) {
-    NEARBY_LOGS(INFO) << "Task: \"" << name_ << "\" started after "
+    NEARBY_LOGS(INFO) << "Task: \"" << *name_ << "\" started after "
                       << absl::ToInt64Seconds(start_delay) << " seconds";
   }
-  PendingJobRegistry::GetInstance().RemovePendingJob(name_, post_time_);
-  PendingJobRegistry::GetInstance().AddRunningJob(name_, post_time_);
-  runnable_();
+  PendingJobRegistry::GetInstance().StartJob(job_id_);
+  if (lockable_ != nullptr) {
+    ThreadLockHolder thread_lock(lockable_);
+    runnable_();
+  } else {
+    runnable_();
+  }
   auto task_duration = SystemClock::ElapsedRealtime() - start_time;
   if (task_duration >= kMinReportedTaskDuration) {
-    NEARBY_LOGS(INFO) << "Task: \"" << name_ << "\" finished after "
+    NEARBY_LOGS(INFO) << "Task: \"" << *name_ << "\" finished after "
                       << absl::ToInt64Seconds(task_duration) << " seconds";
   }
-  PendingJobRegistry::GetInstance().RemoveRunningJob(name_, post_time_);
+  PendingJobRegistry::GetInstance().RemoveJob(
+      std::exchange(job_id_, PendingJobRegistry::kNoJob));
   PendingJobRegistry::GetInstance().ListJobs();
 }
 
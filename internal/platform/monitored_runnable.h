@@ -17,7 +17,10 @@
 
 #include <string>
 
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "internal/platform/lockable.h"
+#include "internal/platform/pending_job_registry.h"
 #include "internal/platform/runnable.h"
 #include "internal/platform/system_clock.h"
 
@@ -30,14 +33,27 @@ namespace nearby {
 class MonitoredRunnable {
  public:
   explicit MonitoredRunnable(Runnable&& runnable);
-  MonitoredRunnable(const std::string& name, Runnable&& runnable);
+  MonitoredRunnable(absl::string_view name, Runnable&& runnable);
+  // Also holds |lockable| while running, like ThreadCheckRunnable does, so
+  // executors don't need to wrap |runnable| in one and allocate it separately.
+  MonitoredRunnable(absl::string_view name, const Lockable* lockable,
+                    Runnable&& runnable);
+  MonitoredRunnable(MonitoredRunnable&& other);
+  MonitoredRunnable& operator=(MonitoredRunnable&&) = delete;
+  // Unregisters the task if it never ran, e.g. because its executor was shut
+  // down.
+  ~MonitoredRunnable();
 
   void operator()();
 
  private:
-  const std::string name_;
+  // Interned by PendingJobRegistry.
+  const std::string* name_;
+  // May be null.
+  const Lockable* lockable_;
   Runnable runnable_;
   absl::Time post_time_ = SystemClock::ElapsedRealtime();
+  PendingJobRegistry::JobId job_id_ = PendingJobRegistry::kNoJob;
 };
 
 }  // namespace nearby
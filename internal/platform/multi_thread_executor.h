@@ -31,6 +31,9 @@ class ABSL_LOCKABLE MultiThreadExecutor final : public SubmittableExecutor {
   explicit MultiThreadExecutor(int max_parallelism)
       : SubmittableExecutor(
             Platform::CreateMultiThreadExecutor(max_parallelism)) {}
+  MultiThreadExecutor(int max_parallelism, api::ExecutorQos qos)
+      : SubmittableExecutor(
+            Platform::CreateMultiThreadExecutor(max_parallelism, qos)) {}
   MultiThreadExecutor(MultiThreadExecutor&&) = default;
   MultiThreadExecutor& operator=(MultiThreadExecutor&&) = default;
   ~MultiThreadExecutor() override = default;
@@ -15,11 +15,13 @@
 #ifndef PLATFORM_PUBLIC_MUTEX_H_
 #define PLATFORM_PUBLIC_MUTEX_H_
 
+#include <cstdint>
 #include <memory>
 
 #include "absl/base/thread_annotations.h"
 #include "internal/platform/implementation/mutex.h"
 #include "internal/platform/implementation/platform.h"
+#include "internal/platform/mutex_profiler.h"
 
 namespace nearby {
 
@@ -29,6 +31,9 @@ namespace nearby {
 // This is a classic mutex can be acquired at most once.
 // Atttempt to acuire mutex from the same thread that is holding it will likely
 // cause a deadlock.
+//
+// A mutex constructed with a name reports its wait and hold times to
+// MutexProfiler while profiling is enabled.
 class ABSL_LOCKABLE Mutex final {
  public:
   using Platform = api::ImplementationPlatform;
@@ -37,17 +42,50 @@ class ABSL_LOCKABLE Mutex final {
   explicit Mutex(bool check = true)
       : impl_(Platform::CreateMutex(check ? Mode::kRegular
                                           : Mode::kRegularNoCheck)) {}
+  explicit Mutex(const char* name, bool check = true) : Mutex(check) {
+    site_ = MutexProfiler::GetSite(name);
+  }
   Mutex(Mutex&&) = default;
   Mutex& operator=(Mutex&&) = default;
   ~Mutex() = default;
 
-  void Lock() ABSL_EXCLUSIVE_LOCK_FUNCTION() { impl_->Lock(); }
-  void Unlock() ABSL_UNLOCK_FUNCTION() { impl_->Unlock(); }
+  void Lock() ABSL_EXCLUSIVE_LOCK_FUNCTION() {
+    if (site_ == nullptr || !MutexProfiler::IsEnabled()) {
+      impl_->Lock();
+      return;
+    }
+    int64_t wait_start = MutexProfiler::Site::Now();
+    impl_->Lock();
+    acquired_at_ = site_->RecordAcquisition(wait_start);
+  }
+  void Unlock() ABSL_UNLOCK_FUNCTION() {
+    if (acquired_at_ != 0) {
+      site_->RecordRelease(acquired_at_);
+      acquired_at_ = 0;
+    }
+    impl_->Unlock();
+  }
 
  private:
   friend class ConditionVariable;
-  friend class MutexLock;
+
+  // Called by ConditionVariable around a wait, which releases the mutex.
+  // Returns whether the current hold was being profiled.
+  bool PauseProfiling() {
+    if (acquired_at_ == 0) return false;
+    site_->RecordRelease(acquired_at_);
+    acquired_at_ = 0;
+    return true;
+  }
+  void ResumeProfiling(bool profiled) {
+    if (profiled) acquired_at_ = MutexProfiler::Site::Now();
+  }
+
   std::unique_ptr<api::Mutex> impl_;
+  MutexProfiler::Site* site_ = nullptr;
+  // Time at which a profiled hold started; 0 if the hold is not profiled.
+  // Only accessed by the thread holding the mutex.
+  int64_t acquired_at_ = 0;
 };
 
 // This mutex is compatible with Java definition:
@@ -56,22 +94,48 @@ class ABSL_LOCKABLE Mutex final {
 // it without blocking.
 // It needs to be released equal number of times before any other thread could
 // successfully acquire it.
+//
+// Like Mutex, a named RecursiveMutex reports to MutexProfiler; only the
+// outermost acquisition and release of a thread are recorded.
 class ABSL_LOCKABLE RecursiveMutex final {
  public:
   using Platform = api::ImplementationPlatform;
   using Mode = api::Mutex::Mode;
 
   RecursiveMutex() : impl_(Platform::CreateMutex(Mode::kRecursive)) {}
+  explicit RecursiveMutex(const char* name) : RecursiveMutex() {
+    site_ = MutexProfiler::GetSite(name);
+  }
   RecursiveMutex(RecursiveMutex&&) = default;
   RecursiveMutex& operator=(RecursiveMutex&&) = default;
   ~RecursiveMutex() = default;
 
-  void Lock() ABSL_EXCLUSIVE_LOCK_FUNCTION() { impl_->Lock(); }
-  void Unlock() ABSL_UNLOCK_FUNCTION() { impl_->Unlock(); }
+  void Lock() ABSL_EXCLUSIVE_LOCK_FUNCTION() {
+    if (site_ == nullptr) {
+      impl_->Lock();
+      return;
+    }
+    int64_t wait_start =
+        MutexProfiler::IsEnabled() ? MutexProfiler::Site::Now() : 0;
+    impl_->Lock();
+    if (depth_++ == 0 && wait_start != 0) {
+      acquired_at_ = site_->RecordAcquisition(wait_start);
+    }
+  }
+  void Unlock() ABSL_UNLOCK_FUNCTION() {
+    if (site_ != nullptr && --depth_ == 0 && acquired_at_ != 0) {
+      site_->RecordRelease(acquired_at_);
+      acquired_at_ = 0;
+    }
+    impl_->Unlock();
+  }
 
  private:
-  friend class MutexLock;
   std::unique_ptr<api::Mutex> impl_;
+  MutexProfiler::Site* site_ = nullptr;
+  // Only accessed by the thread holding the mutex.
+  int depth_ = 0;
+  int64_t acquired_at_ = 0;
 };
 
 #pragma pop_macro("CreateMutex")
@@ -0,0 +1,154 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/mutex_profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace nearby {
+namespace {
+
+// The registry must not use nearby::Mutex, which reports back to it.
+struct Registry {
+  absl::Mutex mutex;
+  absl::flat_hash_map<std::string, std::unique_ptr<MutexProfiler::Site>> sites
+      ABSL_GUARDED_BY(mutex);
+};
+
+Registry& GetRegistry() {
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+void UpdateMax(std::atomic<int64_t>& max, int64_t value) {
+  int64_t current = max.load(std::memory_order_relaxed);
+  while (value > current &&
+         !max.compare_exchange_weak(current, value,
+                                    std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace
+
+int64_t MutexProfiler::Site::Now() {
+  int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch())
+                    .count();
+  return now == 0 ? 1 : now;
+}
+
+int64_t MutexProfiler::Site::RecordAcquisition(int64_t wait_start) {
+  int64_t now = Now();
+  int64_t wait = now - wait_start;
+  acquisitions_.fetch_add(1, std::memory_order_relaxed);
+  total_wait_nanos_.fetch_add(wait, std::memory_order_relaxed);
+  UpdateMax(max_wait_nanos_, wait);
+  return now;
+}
+
+void MutexProfiler::Site::RecordRelease(int64_t acquired_at) {
+  int64_t hold = Now() - acquired_at;
+  total_hold_nanos_.fetch_add(hold, std::memory_order_relaxed);
+  UpdateMax(max_hold_nanos_, hold);
+}
+
+MutexProfiler::Stats MutexProfiler::Site::GetStats() const {
+  Stats stats;
+  stats.acquisitions = acquisitions_.load(std::memory_order_relaxed);
+  stats.total_wait_time =
+      absl::Nanoseconds(total_wait_nanos_.load(std::memory_order_relaxed));
+  stats.max_wait_time =
+      absl::Nanoseconds(max_wait_nanos_.load(std::memory_order_relaxed));
+  stats.total_hold_time =
+      absl::Nanoseconds(total_hold_nanos_.load(std::memory_order_relaxed));
+  stats.max_hold_time =
+      absl::Nanoseconds(max_hold_nanos_.load(std::memory_order_relaxed));
+  return stats;
+}
+
+void MutexProfiler::Site::Reset() {
+  acquisitions_.store(0, std::memory_order_relaxed);
+  total_wait_nanos_.store(0, std::memory_order_relaxed);
+  max_wait_nanos_.store(0, std::memory_order_relaxed);
+  total_hold_nanos_.store(0, std::memory_order_relaxed);
+  max_hold_nanos_.store(0, std::memory_order_relaxed);
+}
+
+MutexProfiler::Site* MutexProfiler::GetSite(absl::string_view name) {
+  Registry& registry = GetRegistry();
+  absl::MutexLock lock(&registry.mutex);
+  auto& site = registry.sites[name];
+  if (site == nullptr) {
+    site = std::make_unique<Site>(name);
+  }
+  return site.get();
+}
+
+absl::flat_hash_map<std::string, MutexProfiler::Stats>
+MutexProfiler::GetStats() {
+  Registry& registry = GetRegistry();
+  absl::flat_hash_map<std::string, Stats> result;
+  absl::MutexLock lock(&registry.mutex);
+  for (const auto& [name, site] : registry.sites) {
+    result.emplace(name, site->GetStats());
+  }
+  return result;
+}
+
+std::string MutexProfiler::Dump() {
+  auto stats = GetStats();
+  std::vector<std::pair<std::string, Stats>> sorted(stats.begin(),
+                                                    stats.end());
+  std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+    if (a.second.total_wait_time != b.second.total_wait_time) {
+      return a.second.total_wait_time > b.second.total_wait_time;
+    }
+    return a.first < b.first;
+  });
+  std::string result;
+  for (const auto& [name, site_stats] : sorted) {
+    absl::StrAppend(&result, name, ": acquisitions=", site_stats.acquisitions,
+                    " wait_total=",
+                    absl::FormatDuration(site_stats.total_wait_time),
+                    " wait_max=", absl::FormatDuration(site_stats.max_wait_time),
+                    " hold_total=",
+                    absl::FormatDuration(site_stats.total_hold_time),
+                    " hold_max=", absl::FormatDuration(site_stats.max_hold_time),
+                    "\n");
+  }
+  return result;
+}
+
+void MutexProfiler::Reset() {
+  Registry& registry = GetRegistry();
+  absl::MutexLock lock(&registry.mutex);
+  for (auto& [name, site] : registry.sites) {
+    site->Reset();
+  }
+}
+
+}  // namespace nearby
@@ -0,0 +1,99 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PLATFORM_PUBLIC_MUTEX_PROFILER_H_
+#define PLATFORM_PUBLIC_MUTEX_PROFILER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+
+namespace nearby {
+
+// Opt-in contention profiling for named Mutex and RecursiveMutex instances.
+//
+// A mutex constructed with a name reports to the profiler site registered for
+// that name; all instances sharing a name are aggregated. While profiling is
+// disabled (the default) a named mutex only pays for one relaxed atomic load
+// per Lock(). Unnamed mutexes are never profiled.
+//
+// Hold time is measured from acquisition until release. Time spent blocked in
+// ConditionVariable::Wait() is not counted as holding the mutex.
+class MutexProfiler {
+ public:
+  struct Stats {
+    int64_t acquisitions = 0;
+    absl::Duration total_wait_time;
+    absl::Duration max_wait_time;
+    absl::Duration total_hold_time;
+    absl::Duration max_hold_time;
+  };
+
+  // Counters for all mutexes sharing one name. Sites are never destroyed.
+  class Site {
+   public:
+    explicit Site(absl::string_view name) : name_(name) {}
+    Site(const Site&) = delete;
+    Site& operator=(const Site&) = delete;
+
+    // Returns a monotonic timestamp, in nanoseconds. Never returns 0.
+    static int64_t Now();
+
+    // Records an acquisition that started waiting at `wait_start` and returns
+    // the time at which the mutex was acquired.
+    int64_t RecordAcquisition(int64_t wait_start);
+    // Records a release of a mutex acquired at `acquired_at`.
+    void RecordRelease(int64_t acquired_at);
+
+    const std::string& GetName() const { return name_; }
+    Stats GetStats() const;
+    void Reset();
+
+   private:
+    const std::string name_;
+    std::atomic<int64_t> acquisitions_{0};
+    std::atomic<int64_t> total_wait_nanos_{0};
+    std::atomic<int64_t> max_wait_nanos_{0};
+    std::atomic<int64_t> total_hold_nanos_{0};
+    std::atomic<int64_t> max_hold_nanos_{0};
+  };
+
+  static void SetEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+  static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  // Returns the site for `name`, creating it on first use.
+  static Site* GetSite(absl::string_view name);
+
+  // Returns a snapshot of the statistics of every site, keyed by name.
+  static absl::flat_hash_map<std::string, Stats> GetStats();
+
+  // Returns a human readable report, one line per site, most waited on first.
+  static std::string Dump();
+
+  // Clears the statistics of every site.
+  static void Reset();
+
+ private:
+  static inline std::atomic<bool> enabled_{false};
+};
+
+}  // namespace nearby
+
+#endif  // PLATFORM_PUBLIC_MUTEX_PROFILER_H_
@@ -0,0 +1,124 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "internal/platform/mutex_profiler.h"
+
+#include "gtest/gtest.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "internal/platform/condition_variable.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/mutex_lock.h"
+#include "internal/platform/single_thread_executor.h"
+
+namespace nearby {
+namespace {
+
+class MutexProfilerTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    MutexProfiler::Reset();
+    MutexProfiler::SetEnabled(true);
+  }
+  void TearDown() override { MutexProfiler::SetEnabled(false); }
+
+  static MutexProfiler::Stats GetStats(const char* name) {
+    return MutexProfiler::GetStats()[name];
+  }
+};
+
+TEST_F(MutexProfilerTest, DisabledProfilerRecordsNothing) {
+  MutexProfiler::SetEnabled(false);
+  Mutex mutex("MutexProfilerTest.Disabled");
+  { MutexLock lock(&mutex); }
+
+  EXPECT_EQ(GetStats("MutexProfilerTest.Disabled").acquisitions, 0);
+}
+
+TEST_F(MutexProfilerTest, CountsAcquisitionsAndHoldTime) {
+  Mutex mutex("MutexProfilerTest.Hold");
+  for (int i = 0; i < 3; ++i) {
+    MutexLock lock(&mutex);
+    absl::SleepFor(absl::Milliseconds(10));
+  }
+
+  MutexProfiler::Stats stats = GetStats("MutexProfilerTest.Hold");
+  EXPECT_EQ(stats.acquisitions, 3);
+  EXPECT_GE(stats.total_hold_time, absl::Milliseconds(30));
+  EXPECT_GE(stats.max_hold_time, absl::Milliseconds(10));
+  EXPECT_LE(stats.max_hold_time, stats.total_hold_time);
+}
+
+TEST_F(MutexProfilerTest, RecordsWaitTime) {
+  Mutex mutex("MutexProfilerTest.Wait");
+  SingleThreadExecutor executor;
+  absl::Notification locked;
+  mutex.Lock();
+  executor.Execute([&]() {
+    locked.Notify();
+    MutexLock lock(&mutex);
+  });
+  locked.WaitForNotification();
+  absl::SleepFor(absl::Milliseconds(50));
+  mutex.Unlock();
+  executor.Shutdown();
+
+  MutexProfiler::Stats stats = GetStats("MutexProfilerTest.Wait");
+  EXPECT_EQ(stats.acquisitions, 2);
+  EXPECT_GE(stats.max_wait_time, absl::Milliseconds(40));
+}
+
+TEST_F(MutexProfilerTest, InstancesWithTheSameNameAreAggregated) {
+  Mutex first("MutexProfilerTest.Shared");
+  Mutex second("MutexProfilerTest.Shared");
+  { MutexLock lock(&first); }
+  { MutexLock lock(&second); }
+
+  EXPECT_EQ(GetStats("MutexProfilerTest.Shared").acquisitions, 2);
+}
+
+TEST_F(MutexProfilerTest, RecursiveMutexRecordsOutermostAcquisition) {
+  RecursiveMutex mutex("MutexProfilerTest.Recursive");
+  {
+    MutexLock outer(&mutex);
+    MutexLock inner(&mutex);
+  }
+
+  EXPECT_EQ(GetStats("MutexProfilerTest.Recursive").acquisitions, 1);
+}
+
+TEST_F(MutexProfilerTest, ConditionVariableWaitIsNotHoldTime) {
+  Mutex mutex("MutexProfilerTest.CondVar");
+  ConditionVariable cond(&mutex);
+  {
+    MutexLock lock(&mutex);
+    cond.Wait(absl::Milliseconds(100));
+  }
+
+  EXPECT_LT(GetStats("MutexProfilerTest.CondVar").total_hold_time,
+            absl::Milliseconds(50));
+}
+
+TEST_F(MutexProfilerTest, DumpListsNamedMutexes) {
+  Mutex mutex("MutexProfilerTest.Dump");
+  { MutexLock lock(&mutex); }
+
+  EXPECT_NE(MutexProfiler::Dump().find("MutexProfilerTest.Dump: acquisitions=1"),
+            std::string::npos);
+}
+
+}  // namespace
+}  // namespace nearby
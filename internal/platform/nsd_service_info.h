@@ -93,7 +93,7 @@ class NsdServiceInfo {
   std::string service_name_;
   absl::flat_hash_map<std::string, std::string> txt_records_;
   std::string ip_address_;
-  int port_;
+  int port_ = 0;
   std::string service_type_;
 };
 
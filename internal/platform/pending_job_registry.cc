@@ -14,7 +14,17 @@
 
 #include "internal/platform/pending_job_registry.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "internal/platform/logging.h"
+#include "internal/platform/mutex.h"
 #include "internal/platform/mutex_lock.h"
 #include "internal/platform/system_clock.h"
 
@@ -24,6 +34,21 @@ namespace {
 absl::Duration kMinReportInterval = absl::Seconds(60);
 absl::Duration kReportPendingJobsOlderThan = absl::Seconds(40);
 absl::Duration kReportRunningJobsOlderThan = absl::Seconds(60);
+
+struct NameRegistry {
+  Mutex mutex;
+  absl::flat_hash_map<std::string, std::unique_ptr<const std::string>> names
+      ABSL_GUARDED_BY(mutex);
+};
+
+NameRegistry& GetNameRegistry() {
+  static NameRegistry* registry = new NameRegistry();
+  return *registry;
+}
+
+std::int64_t Now() {
+  return absl::ToUnixNanos(SystemClock::ElapsedRealtime());
+}
 }  // namespace
 
 PendingJobRegistry& PendingJobRegistry::GetInstance() {
@@ -35,55 +60,91 @@ PendingJobRegistry::PendingJobRegistry() = default;
 
 PendingJobRegistry::~PendingJobRegistry() = default;
 
-void PendingJobRegistry::AddPendingJob(const std::string& name,
-                                       absl::Time post_time) {
-  MutexLock lock(&mutex_);
-  pending_jobs_.emplace(CreateKey(name, post_time), post_time);
+const std::string* PendingJobRegistry::InternName(absl::string_view name) {
+  thread_local absl::flat_hash_map<std::string, const std::string*> cache;
+  auto it = cache.find(name);
+  if (it != cache.end()) return it->second;
+
+  NameRegistry& registry = GetNameRegistry();
+  const std::string* interned;
+  {
+    MutexLock lock(&registry.mutex);
+    auto entry = registry.names.find(name);
+    if (entry == registry.names.end()) {
+      absl::string_view key =
+          registry.names.size() < kMaxNames ? name : kOtherName;
+      entry = registry.names
+                  .emplace(key, std::make_unique<const std::string>(key))
+                  .first;
+    }
+    interned = entry->second.get();
+  }
+  cache.emplace(name, interned);
+  return interned;
 }
 
-void PendingJobRegistry::RemovePendingJob(const std::string& name,
-                                          absl::Time post_time) {
-  MutexLock lock(&mutex_);
-  pending_jobs_.erase(CreateKey(name, post_time));
+PendingJobRegistry::JobId PendingJobRegistry::AddPendingJob(
+    const std::string* name, absl::Time post_time) {
+  unsigned start = next_slot_.fetch_add(1, std::memory_order_relaxed);
+  for (int i = 0; i < kMaxJobs; ++i) {
+    JobId id = (start + i) % kMaxJobs;
+    Slot& slot = slots_[id];
+    if (slot.in_use.load(std::memory_order_relaxed) ||
+        slot.in_use.exchange(true, std::memory_order_acquire)) {
+      continue;
+    }
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start_time.store(0, std::memory_order_relaxed);
+    // Zero means the slot is empty.
+    slot.post_time.store(std::max<std::int64_t>(absl::ToUnixNanos(post_time),
+                                                1),
+                         std::memory_order_release);
+    return id;
+  }
+  return kNoJob;
 }
 
-void PendingJobRegistry::AddRunningJob(const std::string& name,
-                                       absl::Time post_time) {
-  MutexLock lock(&mutex_);
-  running_jobs_.emplace(CreateKey(name, post_time),
-                        SystemClock::ElapsedRealtime());
+void PendingJobRegistry::StartJob(JobId id) {
+  if (id == kNoJob) return;
+  slots_[id].start_time.store(Now(), std::memory_order_relaxed);
 }
 
-void PendingJobRegistry::RemoveRunningJob(const std::string& name,
-                                          absl::Time post_time) {
-  MutexLock lock(&mutex_);
-  running_jobs_.erase(CreateKey(name, post_time));
+void PendingJobRegistry::RemoveJob(JobId id) {
+  if (id == kNoJob) return;
+  Slot& slot = slots_[id];
+  slot.post_time.store(0, std::memory_order_relaxed);
+  slot.in_use.store(false, std::memory_order_release);
 }
 
 void PendingJobRegistry::ListJobs() {
-  auto current_time = SystemClock::ElapsedRealtime();
-  MutexLock lock(&mutex_);
-  if (current_time - list_jobs_time_ < kMinReportInterval) return;
-  for (auto& job : pending_jobs_) {
-    auto age = current_time - job.second;
-    if (age >= kReportPendingJobsOlderThan) {
-      NEARBY_LOGS(INFO) << "Task \"" << job.first << "\" is waiting for "
-                        << absl::ToInt64Seconds(age) << " s";
-    }
+  std::int64_t current_time = Now();
+  std::int64_t list_jobs_time = list_jobs_time_.load(std::memory_order_relaxed);
+  if (absl::Nanoseconds(current_time - list_jobs_time) < kMinReportInterval ||
+      !list_jobs_time_.compare_exchange_strong(list_jobs_time, current_time,
+                                               std::memory_order_relaxed)) {
+    return;
   }
-  for (auto& job : running_jobs_) {
-    auto age = current_time - job.second;
-    if (age >= kReportRunningJobsOlderThan) {
-      NEARBY_LOGS(INFO) << "Task \"" << job.first << "\" is running for "
-                        << absl::ToInt64Seconds(age) << " s";
+  // A slot may be reused while it is read, which at worst reports a job with
+  // the age of another one.
+  for (const Slot& slot : slots_) {
+    std::int64_t post_time = slot.post_time.load(std::memory_order_acquire);
+    if (post_time == 0) continue;
+    const std::string* name = slot.name.load(std::memory_order_relaxed);
+    std::int64_t start_time = slot.start_time.load(std::memory_order_relaxed);
+    if (start_time == 0) {
+      auto age = absl::Nanoseconds(current_time - post_time);
+      if (age >= kReportPendingJobsOlderThan) {
+        NEARBY_LOGS(INFO) << "Task \"" << *name << "\" is waiting for "
+                          << absl::ToInt64Seconds(age) << " s";
+      }
+    } else {
+      auto age = absl::Nanoseconds(current_time - start_time);
+      if (age >= kReportRunningJobsOlderThan) {
+        NEARBY_LOGS(INFO) << "Task \"" << *name << "\" is running for "
+                          << absl::ToInt64Seconds(age) << " s";
+      }
     }
   }
-  list_jobs_time_ = current_time;
-}
-
-std::string PendingJobRegistry::CreateKey(const std::string& name,
-                                          absl::Time post_time) {
-  return name + "." + std::to_string(absl::ToUnixNanos(post_time));
 }
 
 }  // namespace nearby
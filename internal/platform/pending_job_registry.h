@@ -15,37 +15,67 @@
 #ifndef PLATFORM_PUBLIC_PENDING_JOB_REGISTRY_H_
 #define PLATFORM_PUBLIC_PENDING_JOB_REGISTRY_H_
 
-#include "absl/base/thread_annotations.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
-#include "internal/platform/mutex.h"
 
 namespace nearby {
 
 // A global registry of running tasks. The goal is to help us monitor
 // tasks that are either waiting too long for their turn or they never finish
+//
+// Jobs live in a fixed table of slots updated with atomics, so registering a
+// job takes no lock and allocates nothing. Jobs registered while every slot is
+// taken aren't monitored.
 class PendingJobRegistry {
  public:
+  // Identifies a registered job.
+  using JobId = int;
+  static constexpr JobId kNoJob = -1;
+  static constexpr int kMaxJobs = 1024;
+  // Names beyond this many are all interned as kOtherName.
+  static constexpr int kMaxNames = 1024;
+  static constexpr char kOtherName[] = "(other)";
+
   static PendingJobRegistry& GetInstance();
 
   ~PendingJobRegistry();
 
-  void AddPendingJob(const std::string& name, absl::Time post_time);
-  void RemovePendingJob(const std::string& name, absl::Time post_time);
-  void AddRunningJob(const std::string& name, absl::Time post_time);
-  void RemoveRunningJob(const std::string& name, absl::Time post_time);
+  // Returns the copy of |name| shared by all the jobs with that name, which is
+  // never destroyed. Only takes a lock the first time a thread sees |name|.
+  static const std::string* InternName(absl::string_view name);
+
+  // Registers a job with an interned |name|, waiting since |post_time|.
+  // Returns kNoJob if every slot is taken.
+  JobId AddPendingJob(const std::string* name, absl::Time post_time);
+  // Marks the job as running since now.
+  void StartJob(JobId id);
+  // Unregisters the job, whether it ran or not.
+  void RemoveJob(JobId id);
+  // Logs the jobs waiting or running for too long, at most once a minute.
   void ListJobs();
 
  private:
-  PendingJobRegistry();
+  struct Slot {
+    std::atomic<bool> in_use{false};
+    std::atomic<const std::string*> name{nullptr};
+    // In Unix nanoseconds of SystemClock::ElapsedRealtime(). |post_time| is
+    // set last and cleared first, so a non-zero one tells the slot holds a
+    // job; |start_time| is zero while the job is pending.
+    std::atomic<std::int64_t> post_time{0};
+    std::atomic<std::int64_t> start_time{0};
+  };
 
-  std::string CreateKey(const std::string& name, absl::Time post_time);
+  PendingJobRegistry();
 
-  Mutex mutex_;
-  absl::flat_hash_map<const std::string, absl::Time> pending_jobs_
-      ABSL_GUARDED_BY(mutex_);
-  absl::flat_hash_map<const std::string, absl::Time> running_jobs_
-      ABSL_GUARDED_BY(mutex_);
-  absl::Time list_jobs_time_ ABSL_GUARDED_BY(mutex_) = absl::UnixEpoch();
+  std::array<Slot, kMaxJobs> slots_;
+  // Where the search for a free slot starts, to spread jobs over the table.
+  std::atomic<unsigned> next_slot_{0};
+  std::atomic<std::int64_t> list_jobs_time_{0};
 };
 
 }  // namespace nearby
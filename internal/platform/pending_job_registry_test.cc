@@ -0,0 +1,95 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/pending_job_registry.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
+#include "internal/platform/lockable.h"
+#include "internal/platform/monitored_runnable.h"
+#include "internal/platform/single_thread_executor.h"
+#include "internal/platform/system_clock.h"
+
+namespace nearby {
+namespace {
+
+TEST(PendingJobRegistryTest, InternsNames) {
+  const std::string* name = PendingJobRegistry::InternName("task");
+
+  EXPECT_EQ(*name, "task");
+  EXPECT_EQ(PendingJobRegistry::InternName(std::string("task")), name);
+  EXPECT_NE(PendingJobRegistry::InternName("other-task"), name);
+}
+
+TEST(PendingJobRegistryTest, ReusesSlotsOfRemovedJobs) {
+  PendingJobRegistry& registry = PendingJobRegistry::GetInstance();
+  const std::string* name = PendingJobRegistry::InternName("task");
+  std::vector<PendingJobRegistry::JobId> ids;
+  absl::flat_hash_set<PendingJobRegistry::JobId> distinct_ids;
+
+  for (int i = 0; i < PendingJobRegistry::kMaxJobs; ++i) {
+    PendingJobRegistry::JobId id =
+        registry.AddPendingJob(name, SystemClock::ElapsedRealtime());
+    if (id == PendingJobRegistry::kNoJob) break;
+    ids.push_back(id);
+    distinct_ids.insert(id);
+  }
+  EXPECT_EQ(distinct_ids.size(), ids.size());
+  EXPECT_EQ(registry.AddPendingJob(name, SystemClock::ElapsedRealtime()),
+            PendingJobRegistry::kNoJob);
+
+  registry.StartJob(ids.back());
+  registry.RemoveJob(ids.back());
+  EXPECT_EQ(registry.AddPendingJob(name, SystemClock::ElapsedRealtime()),
+            ids.back());
+  for (PendingJobRegistry::JobId id : ids) {
+    registry.RemoveJob(id);
+  }
+}
+
+TEST(PendingJobRegistryTest, UnregistersTasksThatNeverRan) {
+  PendingJobRegistry& registry = PendingJobRegistry::GetInstance();
+  for (int i = 0; i < 2 * PendingJobRegistry::kMaxJobs; ++i) {
+    MonitoredRunnable runnable("task", []() {});
+    MonitoredRunnable moved = std::move(runnable);
+  }
+  {
+    SingleThreadExecutor executor;
+    for (int i = 0; i < 2 * PendingJobRegistry::kMaxJobs; ++i) {
+      executor.Execute("task", []() {});
+    }
+  }
+
+  PendingJobRegistry::JobId id = registry.AddPendingJob(
+      PendingJobRegistry::InternName("task"), SystemClock::ElapsedRealtime());
+  EXPECT_NE(id, PendingJobRegistry::kNoJob);
+  registry.RemoveJob(id);
+}
+
+TEST(PendingJobRegistryTest, RunsTasksWithLockable) {
+  Lockable lockable;
+  bool ran = false;
+  MonitoredRunnable runnable("a-task-name-too-long-for-inline-storage",
+                             &lockable, [&ran]() { ran = true; });
+
+  runnable();
+
+  EXPECT_TRUE(ran);
+}
+
+}  // namespace
+}  // namespace nearby
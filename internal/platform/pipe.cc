@@ -14,6 +14,8 @@
 
 #include "internal/platform/pipe.h"
 
+#include <cstddef>
+
 #include "internal/platform/implementation/condition_variable.h"
 #include "internal/platform/implementation/mutex.h"
 #include "internal/platform/implementation/platform.h"
@@ -33,6 +35,12 @@ Pipe::Pipe() {
   Setup(std::move(mutex), std::move(cond));
 }
 
+Pipe::Pipe(size_t ring_capacity) {
+  auto mutex = Platform::CreateMutex(api::Mutex::Mode::kRegular);
+  auto cond = Platform::CreateConditionVariable(mutex.get());
+  Setup(std::move(mutex), std::move(cond), ring_capacity);
+}
+
 #pragma pop_macro("CreateMutex")
 
 }  // namespace nearby
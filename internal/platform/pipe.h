@@ -15,6 +15,8 @@
 #ifndef PLATFORM_PUBLIC_PIPE_H_
 #define PLATFORM_PUBLIC_PIPE_H_
 
+#include <cstddef>
+
 #include "internal/platform/base_pipe.h"
 
 namespace nearby {
@@ -24,6 +26,9 @@ namespace nearby {
 class Pipe final : public BasePipe {
  public:
   Pipe();
+  // Creates a bounded pipe that holds at most `ring_capacity` chunks; writes
+  // block while it is full. Only one thread may read, and one write, at a time.
+  explicit Pipe(size_t ring_capacity);
   ~Pipe() override = default;
   Pipe(Pipe&&) = delete;
   Pipe& operator=(Pipe&&) = delete;
@@ -340,4 +340,98 @@ TEST(PipeTest, ConcurrentWriteAndRead) {
   reader_thread.Join();
 }
 
+TEST(PipeTest, BoundedPipeSimpleWriteRead) {
+  Pipe pipe(/*ring_capacity=*/2);
+  InputStream& input_stream{pipe.GetInputStream()};
+  OutputStream& output_stream{pipe.GetOutputStream()};
+
+  std::string data("ABCDEFGH");
+  EXPECT_TRUE(output_stream.Write(ByteArray(data)).Ok());
+  EXPECT_TRUE(output_stream.Close().Ok());
+
+  ExceptionOr<ByteArray> read_data = input_stream.Read(4);
+  EXPECT_TRUE(read_data.ok());
+  EXPECT_EQ("ABCD", std::string(read_data.result()));
+  read_data = input_stream.Read(Pipe::kChunkSize);
+  EXPECT_TRUE(read_data.ok());
+  EXPECT_EQ("EFGH", std::string(read_data.result()));
+  read_data = input_stream.Read(Pipe::kChunkSize);
+  EXPECT_TRUE(read_data.ok());
+  EXPECT_TRUE(read_data.result().Empty());
+}
+
+TEST(PipeTest, BoundedPipeWriteBlockedUntilRead) {
+  Pipe pipe(/*ring_capacity=*/1);
+  InputStream& input_stream{pipe.GetInputStream()};
+  OutputStream& output_stream{pipe.GetOutputStream()};
+  std::atomic_bool second_write_done = false;
+
+  EXPECT_TRUE(output_stream.Write(ByteArray(std::string("ABCD"))).Ok());
+  Thread writer_thread;
+  writer_thread.Start([&output_stream, &second_write_done]() {
+    EXPECT_TRUE(output_stream.Write(ByteArray(std::string("EFGH"))).Ok());
+    second_write_done = true;
+  });
+
+  absl::SleepFor(absl::Milliseconds(100));
+  EXPECT_FALSE(second_write_done);
+
+  ExceptionOr<ByteArray> read_data = input_stream.Read(Pipe::kChunkSize);
+  EXPECT_TRUE(read_data.ok());
+  EXPECT_EQ("ABCD", std::string(read_data.result()));
+  writer_thread.Join();
+  EXPECT_TRUE(second_write_done);
+
+  read_data = input_stream.Read(Pipe::kChunkSize);
+  EXPECT_TRUE(read_data.ok());
+  EXPECT_EQ("EFGH", std::string(read_data.result()));
+}
+
+TEST(PipeTest, BoundedPipeBlockedWriteFailsWhenInputStreamClosed) {
+  Pipe pipe(/*ring_capacity=*/1);
+  InputStream& input_stream{pipe.GetInputStream()};
+  OutputStream& output_stream{pipe.GetOutputStream()};
+
+  EXPECT_TRUE(output_stream.Write(ByteArray(std::string("ABCD"))).Ok());
+  Thread writer_thread;
+  writer_thread.Start([&output_stream]() {
+    EXPECT_TRUE(output_stream.Write(ByteArray(std::string("EFGH")))
+                    .Raised(Exception::kIo));
+  });
+
+  absl::SleepFor(absl::Milliseconds(100));
+  EXPECT_TRUE(input_stream.Close().Ok());
+  writer_thread.Join();
+}
+
+TEST(PipeTest, BoundedPipeConcurrentWriteAndRead) {
+  constexpr int kChunkCount = 10000;
+  Pipe pipe(/*ring_capacity=*/4);
+  std::string expected_data;
+  for (int i = 0; i < kChunkCount; ++i) {
+    expected_data += std::to_string(i);
+  }
+
+  Thread writer_thread;
+  writer_thread.Start([&pipe]() {
+    for (int i = 0; i < kChunkCount; ++i) {
+      EXPECT_TRUE(
+          pipe.GetOutputStream().Write(ByteArray(std::to_string(i))).Ok());
+    }
+    EXPECT_TRUE(pipe.GetOutputStream().Close().Ok());
+  });
+
+  std::string actual_data;
+  while (true) {
+    ExceptionOr<ByteArray> read_data =
+        pipe.GetInputStream().Read(Pipe::kChunkSize);
+    ASSERT_TRUE(read_data.ok());
+    if (read_data.result().Empty()) break;
+    actual_data += std::string(read_data.result());
+  }
+  writer_thread.Join();
+
+  EXPECT_EQ(expected_data, actual_data);
+}
+
 }  // namespace nearby
@@ -19,6 +19,7 @@
 #include <memory>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "internal/platform/cancelable.h"
 #include "internal/platform/cancellable_task.h"
@@ -43,6 +44,8 @@ class ABSL_LOCKABLE ScheduledExecutor final : public Lockable {
   using Platform = api::ImplementationPlatform;
 
   ScheduledExecutor() : impl_(Platform::CreateScheduledExecutor()) {}
+  explicit ScheduledExecutor(api::ExecutorQos qos)
+      : impl_(Platform::CreateScheduledExecutor(qos)) {}
   ScheduledExecutor(ScheduledExecutor&& other) { *this = std::move(other); }
   ~ScheduledExecutor() { DoShutdown(); }
 
@@ -55,12 +58,11 @@ class ABSL_LOCKABLE ScheduledExecutor final : public Lockable {
     }
     return *this;
   }
-  void Execute(const std::string& name, Runnable&& runnable)
+  void Execute(absl::string_view name, Runnable&& runnable)
       ABSL_LOCKS_EXCLUDED(mutex_) {
     MutexLock lock(&mutex_);
     if (impl_)
-      impl_->Execute(MonitoredRunnable(
-          name, ThreadCheckRunnable(this, std::move(runnable))));
+      impl_->Execute(MonitoredRunnable(name, this, std::move(runnable)));
   }
 
   void Execute(Runnable&& runnable) ABSL_LOCKS_EXCLUDED(mutex_) {
@@ -15,6 +15,7 @@
 #include "internal/platform/scheduled_executor.h"
 
 #include <atomic>
+#include <memory>
 
 #include "gtest/gtest.h"
 #include "absl/synchronization/mutex.h"
@@ -263,6 +264,64 @@ TEST(ScheduledExecutorTest,
   MediumEnvironment::Instance().Stop();
 }
 
+TEST(ScheduledExecutorTest, AutoAdvancingSimulatedClockRunsTasksWhenIdle) {
+  MediumEnvironment::Instance().Start(
+      {.use_simulated_clock = true, .auto_advance_simulated_clock = true});
+  FakeClock* fake_clock =
+      MediumEnvironment::Instance().GetSimulatedClock().value();
+  absl::Time start_time = fake_clock->Now();
+  ScheduledExecutor executor;
+  CountDownLatch first_task_latch(1);
+  CountDownLatch second_task_latch(1);
+  executor.Schedule([&]() { second_task_latch.CountDown(); }, absl::Hours(2));
+  executor.Schedule([&]() { first_task_latch.CountDown(); }, absl::Hours(1));
+
+  // Nobody advances the clock, but the tasks still run in a moment of real
+  // time, in order.
+  EXPECT_TRUE(first_task_latch.Await(absl::Seconds(5)).result());
+  EXPECT_EQ(fake_clock->Now() - start_time, absl::Hours(1));
+  EXPECT_TRUE(second_task_latch.Await(absl::Seconds(5)).result());
+  EXPECT_EQ(fake_clock->Now() - start_time, absl::Hours(2));
+  executor.Shutdown();
+  MediumEnvironment::Instance().Stop();
+}
+
+TEST(ScheduledExecutorTest, ScopedEnvironmentsHaveTheirOwnClocks) {
+  std::unique_ptr<MediumEnvironment> first_env = MediumEnvironment::Create();
+  std::unique_ptr<MediumEnvironment> second_env = MediumEnvironment::Create();
+  CountDownLatch first_task_latch(1);
+  std::atomic_bool second_task_ran = false;
+  MediumEnvironment* first_task_env = nullptr;
+  {
+    MediumEnvironment::Scope scope(first_env.get());
+    first_env->Start({.use_simulated_clock = true});
+    ScheduledExecutor executor;
+    executor.Schedule(
+        [&]() {
+          first_task_env = &MediumEnvironment::Instance();
+          first_task_latch.CountDown();
+        },
+        kShortDelay);
+    {
+      MediumEnvironment::Scope inner_scope(second_env.get());
+      second_env->Start({.use_simulated_clock = true});
+      ScheduledExecutor second_executor;
+      second_executor.Schedule([&]() { second_task_ran = true; }, kShortDelay);
+
+      first_env->GetSimulatedClock().value()->FastForward(kShortDelay);
+      EXPECT_TRUE(first_task_latch.Await(absl::Seconds(5)).result());
+      EXPECT_FALSE(second_task_ran);
+      second_executor.Shutdown();
+      second_env->Stop();
+    }
+    EXPECT_EQ(&MediumEnvironment::Instance(), first_env.get());
+    executor.Shutdown();
+    first_env->Stop();
+  }
+  EXPECT_EQ(first_task_env, first_env.get());
+  EXPECT_NE(&MediumEnvironment::Instance(), first_env.get());
+}
+
 struct ThreadCheckTestClass {
   ScheduledExecutor executor;
   int value ABSL_GUARDED_BY(executor) = 0;
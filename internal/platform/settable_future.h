@@ -43,29 +43,40 @@ class SettableFuture : public api::SettableFuture<T> {
   ~SettableFuture() override = default;
 
   bool Set(T value) override {
-    MutexLock lock(&mutex_);
-    timer_.reset();
-    if (!done_) {
+    std::vector<Listener> listeners;
+    ExceptionOr<T> result;
+    {
+      MutexLock lock(&mutex_);
+      timer_.reset();
+      if (done_) return false;
       value_ = std::move(value);
       done_ = true;
       exception_ = {Exception::kSuccess};
       completed_.Notify();
-      InvokeAllLocked();
-      return true;
+      listeners = std::move(listeners_);
+      listeners_.clear();
+      if (!listeners.empty()) result = GetLocked();
     }
-    return false;
+    InvokeAll(std::move(listeners), std::move(result));
+    return true;
   }
 
+  // Calls `callback` with the outcome on `executor` once the future is
+  // complete. A null `executor` calls it on the thread completing the future,
+  // or right away if it is already complete, so it must be quick.
   void AddListener(FutureCallback callback, api::Executor* executor) override {
-    MutexLock lock(&mutex_);
-    if (done_) {
-      executor->Execute(
-          [value = GetLocked(), callback = std::move(callback)]() mutable {
-            callback(std::move(value));
-          });
-    } else {
-      listeners_.emplace_back(std::make_pair(executor, std::move(callback)));
+    std::vector<Listener> listeners;
+    ExceptionOr<T> result;
+    {
+      MutexLock lock(&mutex_);
+      if (!done_) {
+        listeners_.emplace_back(executor, std::move(callback));
+        return;
+      }
+      result = GetLocked();
     }
+    listeners.emplace_back(executor, std::move(callback));
+    InvokeAll(std::move(listeners), std::move(result));
   }
 
   bool IsSet() const {
@@ -74,15 +85,22 @@ class SettableFuture : public api::SettableFuture<T> {
   }
 
   bool SetException(Exception exception) override {
-    MutexLock lock(&mutex_);
-    if (timer_) {
-      timer_->Stop();
-      // We can't destroy the timer from the timer.
-      if (!exception.Raised(Exception::kTimeout)) {
-        timer_.reset();
+    std::vector<Listener> listeners;
+    ExceptionOr<T> result;
+    {
+      MutexLock lock(&mutex_);
+      if (timer_) {
+        timer_->Stop();
+        // We can't destroy the timer from the timer.
+        if (!exception.Raised(Exception::kTimeout)) {
+          timer_.reset();
+        }
       }
+      listeners = SetExceptionLocked(exception);
+      if (!listeners.empty()) result = GetLocked();
     }
-    return SetExceptionLocked(exception);
+    InvokeAll(std::move(listeners), std::move(result));
+    return true;
   }
 
   ExceptionOr<T> Get() override {
@@ -94,35 +112,47 @@ class SettableFuture : public api::SettableFuture<T> {
   }
 
   ExceptionOr<T> Get(absl::Duration timeout) override {
-    MutexLock lock(&mutex_);
-    while (!done_) {
-      absl::Time start_time = SystemClock::ElapsedRealtime();
-      if (completed_.Wait(timeout).Raised(Exception::kInterrupted)) {
-        SetExceptionLocked({Exception::kInterrupted});
-        break;
-      }
-      absl::Duration spent = SystemClock::ElapsedRealtime() - start_time;
-      if (spent < timeout) {
-        timeout -= spent;
-      } else if (!done_) {
-        SetExceptionLocked({Exception::kTimeout});
-        break;
+    std::vector<Listener> listeners;
+    ExceptionOr<T> result;
+    {
+      MutexLock lock(&mutex_);
+      while (!done_) {
+        absl::Time start_time = SystemClock::ElapsedRealtime();
+        if (completed_.Wait(timeout).Raised(Exception::kInterrupted)) {
+          listeners = SetExceptionLocked({Exception::kInterrupted});
+          break;
+        }
+        absl::Duration spent = SystemClock::ElapsedRealtime() - start_time;
+        if (spent < timeout) {
+          timeout -= spent;
+        } else if (!done_) {
+          listeners = SetExceptionLocked({Exception::kTimeout});
+          break;
+        }
       }
+      result = GetLocked();
     }
-    return GetLocked();
+    InvokeAll(std::move(listeners), result);
+    return result;
   }
 
  private:
-  bool SetExceptionLocked(Exception exception) {
+  using Listener = std::pair<api::Executor*, FutureCallback>;
+
+  // Returns the listeners to call once `mutex_` is released, if this completed
+  // the future.
+  std::vector<Listener> SetExceptionLocked(Exception exception) {
+    std::vector<Listener> listeners;
     if (!done_) {
       exception_ = exception.value != Exception::kSuccess
                        ? exception
                        : Exception{Exception::kFailed};
       done_ = true;
       completed_.Notify();
-      InvokeAllLocked();
+      listeners = std::move(listeners_);
+      listeners_.clear();
     }
-    return true;
+    return listeners;
   }
 
   ExceptionOr<T> GetLocked() {
@@ -131,19 +161,28 @@ class SettableFuture : public api::SettableFuture<T> {
                : ExceptionOr<T>{value_};
   }
 
-  void InvokeAllLocked() {
-    for (auto& item : listeners_) {
-      item.first->Execute(
-          [value = GetLocked(), callback = std::move(item.second)]() mutable {
+  // Called without holding `mutex_`, so that listeners called in place may
+  // use the future. The last listener gets `result` itself, the others a copy.
+  static void InvokeAll(std::vector<Listener> listeners,
+                        ExceptionOr<T> result) {
+    for (size_t i = 0; i < listeners.size(); ++i) {
+      auto& [executor, callback] = listeners[i];
+      ExceptionOr<T> value =
+          i + 1 < listeners.size() ? result : std::move(result);
+      if (executor == nullptr) {
+        callback(std::move(value));
+        continue;
+      }
+      executor->Execute(
+          [value = std::move(value), callback = std::move(callback)]() mutable {
             callback(std::move(value));
           });
     }
-    listeners_.clear();
   }
 
   mutable Mutex mutex_;
   ConditionVariable completed_{&mutex_};
-  std::vector<std::pair<api::Executor*, FutureCallback>> listeners_;
+  std::vector<Listener> listeners_;
   bool done_{false};
   T value_;
   Exception exception_{Exception::kFailed};
@@ -29,6 +29,8 @@ class ABSL_LOCKABLE SingleThreadExecutor : public SubmittableExecutor {
   using Platform = api::ImplementationPlatform;
   SingleThreadExecutor()
       : SubmittableExecutor(Platform::CreateSingleThreadExecutor()) {}
+  explicit SingleThreadExecutor(api::ExecutorQos qos)
+      : SubmittableExecutor(Platform::CreateSingleThreadExecutor(qos)) {}
   ~SingleThreadExecutor() override = default;
   SingleThreadExecutor(SingleThreadExecutor&&) = default;
   SingleThreadExecutor& operator=(SingleThreadExecutor&&) = default;
@@ -21,6 +21,7 @@
 #include <utility>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
 #include "internal/platform/callable.h"
 #include "internal/platform/future.h"
 #include "internal/platform/implementation/executor.h"
@@ -54,19 +55,17 @@ class ABSL_LOCKABLE SubmittableExecutor : public api::SubmittableExecutor,
     }
     return *this;
   }
-  virtual void Execute(const std::string& name, Runnable&& runnable)
+  virtual void Execute(absl::string_view name, Runnable&& runnable)
       ABSL_LOCKS_EXCLUDED(mutex_) {
     MutexLock lock(&mutex_);
     if (impl_)
-      impl_->Execute(MonitoredRunnable(
-          name, ThreadCheckRunnable(this, std::move(runnable))));
+      impl_->Execute(MonitoredRunnable(name, this, std::move(runnable)));
   }
 
   void Execute(Runnable&& runnable) ABSL_LOCKS_EXCLUDED(mutex_) override {
     MutexLock lock(&mutex_);
     if (impl_)
-      impl_->Execute(
-          MonitoredRunnable(ThreadCheckRunnable(this, std::move(runnable))));
+      impl_->Execute(MonitoredRunnable("", this, std::move(runnable)));
   }
 
   void Shutdown() ABSL_LOCKS_EXCLUDED(mutex_) override { DoShutdown(); }
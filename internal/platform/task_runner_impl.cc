@@ -18,9 +18,8 @@
 #include <utility>
 
 #include "absl/functional/any_invocable.h"
-#include "internal/platform/implementation/crypto.h"
+#include "absl/time/time.h"
 #include "internal/platform/single_thread_executor.h"
-#include "internal/platform/timer_impl.h"
 
 namespace nearby {
 
@@ -50,27 +49,12 @@ bool TaskRunnerImpl::PostDelayedTask(absl::Duration delay,
     return true;
   }
 
-  absl::MutexLock lock(&mutex_);
-  uint64_t id = GenerateId();
-
-  std::unique_ptr<Timer> timer = std::make_unique<TimerImpl>();
-  if (timer->Start(delay / absl::Milliseconds(1), 0,
-                   [this, id, task = std::move(task)]() mutable {
-                     if (task) {
-                       PostTask(std::move(task));
-                     }
-                     {
-                       absl::MutexLock lock(&mutex_);
-                       timers_map_.erase(id);
-                     }
-                   })) {
-    timers_map_.emplace(id, std::move(timer));
-    return true;
-  }
-
-  return false;
+  // Timing through the scheduled executor shares the platform's timer
+  // service instead of creating a platform timer per task.
+  scheduled_executor_.Schedule(
+      [this, task = std::move(task)]() mutable { PostTask(std::move(task)); },
+      delay);
+  return true;
 }
 
-uint64_t TaskRunnerImpl::GenerateId() { return nearby::RandData<uint64_t>(); }
-
 }  // namespace nearby
@@ -26,13 +26,11 @@
 #include <memory>
 #include <utility>
 
-#include "absl/base/thread_annotations.h"
-#include "absl/container/flat_hash_map.h"
 #include "absl/functional/any_invocable.h"
-#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "internal/platform/multi_thread_executor.h"
+#include "internal/platform/scheduled_executor.h"
 #include "internal/platform/task_runner.h"
-#include "internal/platform/timer.h"
 
 namespace nearby {
 
@@ -43,16 +41,13 @@ class TaskRunnerImpl : public TaskRunner {
 
   bool PostTask(absl::AnyInvocable<void()> task) override;
   bool PostDelayedTask(absl::Duration delay,
-                       absl::AnyInvocable<void()> task) override
-      ABSL_LOCKS_EXCLUDED(mutex_);
+                       absl::AnyInvocable<void()> task) override;
 
  private:
-  uint64_t GenerateId();
-
-  mutable absl::Mutex mutex_;
   std::unique_ptr<::nearby::SubmittableExecutor> executor_;
-  absl::flat_hash_map<uint64_t, std::unique_ptr<Timer>> timers_map_
-      ABSL_GUARDED_BY(mutex_);
+  // Only times the delayed tasks, which then run on `executor_`. Declared last
+  // so that pending timers are cancelled before `executor_` goes away.
+  ScheduledExecutor scheduled_executor_;
 };
 
 }  // namespace nearby
@@ -0,0 +1,200 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "internal/platform/tracing.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+
+namespace nearby {
+namespace {
+
+// Buffers of exited threads are kept for export, up to this many.
+constexpr int kMaxRetiredBuffers = 16;
+
+struct TraceEvent {
+  const char* category;
+  const char* name;
+  const char* arg_name;
+  int64_t arg_value;
+  int64_t start_micros;
+  // -1 for instant events.
+  int64_t duration_micros;
+};
+
+struct ThreadBuffer {
+  explicit ThreadBuffer(int tid) : tid(tid) {
+    events.resize(Tracer::kEventsPerThread);
+  }
+
+  const int tid;
+  // Only contended while the buffer is being exported or cleared.
+  absl::Mutex mutex;
+  std::vector<TraceEvent> events ABSL_GUARDED_BY(mutex);
+  // Total events recorded; the next one goes to events[count % size].
+  int64_t count ABSL_GUARDED_BY(mutex) = 0;
+};
+
+// Tracing must not use nearby::Mutex, which is itself instrumented.
+struct Registry {
+  absl::Mutex mutex;
+  int next_tid ABSL_GUARDED_BY(mutex) = 1;
+  std::vector<std::shared_ptr<ThreadBuffer>> live ABSL_GUARDED_BY(mutex);
+  std::deque<std::shared_ptr<ThreadBuffer>> retired ABSL_GUARDED_BY(mutex);
+};
+
+Registry& GetRegistry() {
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+// Registers the thread's buffer on first use and retires it on thread exit.
+class ThreadBufferHolder {
+ public:
+  ThreadBufferHolder() {
+    Registry& registry = GetRegistry();
+    absl::MutexLock lock(&registry.mutex);
+    buffer_ = std::make_shared<ThreadBuffer>(registry.next_tid++);
+    registry.live.push_back(buffer_);
+  }
+  ~ThreadBufferHolder() {
+    Registry& registry = GetRegistry();
+    absl::MutexLock lock(&registry.mutex);
+    registry.live.erase(
+        std::remove(registry.live.begin(), registry.live.end(), buffer_),
+        registry.live.end());
+    registry.retired.push_back(std::move(buffer_));
+    if (registry.retired.size() > kMaxRetiredBuffers) {
+      registry.retired.pop_front();
+    }
+  }
+
+  ThreadBuffer& buffer() { return *buffer_; }
+
+ private:
+  std::shared_ptr<ThreadBuffer> buffer_;
+};
+
+void Record(const TraceEvent& event) {
+  thread_local ThreadBufferHolder holder;
+  ThreadBuffer& buffer = holder.buffer();
+  absl::MutexLock lock(&buffer.mutex);
+  buffer.events[buffer.count % buffer.events.size()] = event;
+  ++buffer.count;
+}
+
+void AppendJsonString(std::string* out, const char* value) {
+  out->push_back('"');
+  for (const char* c = value; *c != '\0'; ++c) {
+    if (*c == '"' || *c == '\\') {
+      out->push_back('\\');
+      out->push_back(*c);
+    } else if (static_cast<unsigned char>(*c) < 0x20) {
+      out->push_back(' ');
+    } else {
+      out->push_back(*c);
+    }
+  }
+  out->push_back('"');
+}
+
+void AppendEvents(std::string* out, bool* first, ThreadBuffer& buffer) {
+  absl::MutexLock lock(&buffer.mutex);
+  int64_t size = buffer.events.size();
+  for (int64_t i = std::max<int64_t>(0, buffer.count - size);
+       i < buffer.count; ++i) {
+    const TraceEvent& event = buffer.events[i % size];
+    if (!*first) out->push_back(',');
+    *first = false;
+    absl::StrAppend(out, "{\"name\":");
+    AppendJsonString(out, event.name);
+    absl::StrAppend(out, ",\"cat\":");
+    AppendJsonString(out, event.category);
+    if (event.duration_micros < 0) {
+      absl::StrAppend(out, ",\"ph\":\"i\",\"s\":\"t\"");
+    } else {
+      absl::StrAppend(out, ",\"ph\":\"X\",\"dur\":", event.duration_micros);
+    }
+    absl::StrAppend(out, ",\"ts\":", event.start_micros,
+                    ",\"pid\":1,\"tid\":", buffer.tid);
+    if (event.arg_name != nullptr) {
+      absl::StrAppend(out, ",\"args\":{");
+      AppendJsonString(out, event.arg_name);
+      absl::StrAppend(out, ":", event.arg_value, "}");
+    }
+    out->push_back('}');
+  }
+}
+
+std::vector<std::shared_ptr<ThreadBuffer>> GetAllBuffers() {
+  Registry& registry = GetRegistry();
+  absl::MutexLock lock(&registry.mutex);
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers(registry.retired.begin(),
+                                                     registry.retired.end());
+  buffers.insert(buffers.end(), registry.live.begin(), registry.live.end());
+  return buffers;
+}
+
+}  // namespace
+
+int64_t Tracer::NowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void Tracer::RecordComplete(const char* category, const char* name,
+                            int64_t start_micros, int64_t duration_micros,
+                            const char* arg_name, int64_t arg_value) {
+  Record({category, name, arg_name, arg_value, start_micros,
+          std::max<int64_t>(0, duration_micros)});
+}
+
+void Tracer::RecordInstant(const char* category, const char* name,
+                           const char* arg_name, int64_t arg_value) {
+  if (!IsEnabled()) return;
+  Record({category, name, arg_name, arg_value, NowMicros(), -1});
+}
+
+std::string Tracer::ExportChromeTraceJson() {
+  std::string out = "{\"traceEvents\":[";
+  bool first = true;
+  for (const auto& buffer : GetAllBuffers()) {
+    AppendEvents(&out, &first, *buffer);
+  }
+  absl::StrAppend(&out, "],\"displayTimeUnit\":\"ms\"}");
+  return out;
+}
+
+void Tracer::Clear() {
+  for (const auto& buffer : GetAllBuffers()) {
+    absl::MutexLock lock(&buffer->mutex);
+    buffer->count = 0;
+  }
+  Registry& registry = GetRegistry();
+  absl::MutexLock lock(&registry.mutex);
+  registry.retired.clear();
+}
+
+}  // namespace nearby
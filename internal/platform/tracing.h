@@ -0,0 +1,103 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef PLATFORM_PUBLIC_TRACING_H_
+#define PLATFORM_PUBLIC_TRACING_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace nearby {
+
+// Low-overhead event tracing for the payload data path.
+//
+// Events are appended to a fixed-size ring buffer owned by the recording
+// thread, so recording never contends with other recording threads; the
+// oldest events of a thread are overwritten once its buffer is full.
+// ExportChromeTraceJson() renders all buffered events in the Chrome trace
+// event format, which can be loaded in Perfetto or chrome://tracing.
+//
+// Tracing is disabled by default, in which case a TraceScope costs one relaxed
+// atomic load. Category, name and argument name strings are stored by pointer
+// and must outlive the trace; use string literals.
+class Tracer {
+ public:
+  // Capacity of each thread's ring buffer, in events.
+  static constexpr int kEventsPerThread = 4096;
+
+  static void SetEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+  static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  // Returns the monotonic timestamp used for events, in microseconds.
+  static int64_t NowMicros();
+
+  // Records an event spanning [start_micros, start_micros + duration_micros).
+  // `arg_name` may be null if the event has no argument.
+  static void RecordComplete(const char* category, const char* name,
+                             int64_t start_micros, int64_t duration_micros,
+                             const char* arg_name, int64_t arg_value);
+
+  // Records a point-in-time event, if tracing is enabled.
+  static void RecordInstant(const char* category, const char* name,
+                            const char* arg_name = nullptr,
+                            int64_t arg_value = 0);
+
+  // Returns the buffered events of all threads as Chrome trace event JSON.
+  static std::string ExportChromeTraceJson();
+
+  // Drops all buffered events.
+  static void Clear();
+
+ private:
+  static inline std::atomic<bool> enabled_{false};
+};
+
+// Records the lifetime of a scope as a complete event on the current thread.
+class TraceScope {
+ public:
+  TraceScope(const char* category, const char* name)
+      : category_(category),
+        name_(name),
+        start_micros_(Tracer::IsEnabled() ? Tracer::NowMicros() : -1) {}
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+  ~TraceScope() {
+    if (start_micros_ >= 0) {
+      Tracer::RecordComplete(category_, name_, start_micros_,
+                             Tracer::NowMicros() - start_micros_, arg_name_,
+                             arg_value_);
+    }
+  }
+
+  // Attaches a single named integer argument to the event.
+  void SetArg(const char* arg_name, int64_t arg_value) {
+    arg_name_ = arg_name;
+    arg_value_ = arg_value;
+  }
+
+ private:
+  const char* const category_;
+  const char* const name_;
+  const int64_t start_micros_;
+  const char* arg_name_ = nullptr;
+  int64_t arg_value_ = 0;
+};
+
+}  // namespace nearby
+
+#endif  // PLATFORM_PUBLIC_TRACING_H_
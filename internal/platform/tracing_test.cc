@@ -0,0 +1,94 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "internal/platform/tracing.h"
+
+#include <string>
+#include <thread>  // NOLINT
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace nearby {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+class TracingTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    Tracer::Clear();
+    Tracer::SetEnabled(true);
+  }
+  void TearDown() override {
+    Tracer::SetEnabled(false);
+    Tracer::Clear();
+  }
+};
+
+TEST_F(TracingTest, DisabledTracerRecordsNothing) {
+  Tracer::SetEnabled(false);
+  { TraceScope trace("test", "Disabled"); }
+  Tracer::RecordInstant("test", "DisabledInstant");
+
+  EXPECT_EQ(Tracer::ExportChromeTraceJson(),
+            "{\"traceEvents\":[],\"displayTimeUnit\":\"ms\"}");
+}
+
+TEST_F(TracingTest, ScopeRecordsCompleteEvent) {
+  {
+    TraceScope trace("payload", "SendFrame");
+    trace.SetArg("bytes", 1024);
+  }
+
+  std::string json = Tracer::ExportChromeTraceJson();
+  EXPECT_THAT(json, HasSubstr("\"name\":\"SendFrame\",\"cat\":\"payload\","
+                              "\"ph\":\"X\",\"dur\":"));
+  EXPECT_THAT(json, HasSubstr("\"args\":{\"bytes\":1024}"));
+}
+
+TEST_F(TracingTest, RecordsInstantEvent) {
+  Tracer::RecordInstant("bwu", "Upgrade", "medium", 5);
+
+  EXPECT_THAT(Tracer::ExportChromeTraceJson(),
+              HasSubstr("\"name\":\"Upgrade\",\"cat\":\"bwu\",\"ph\":\"i\""));
+}
+
+TEST_F(TracingTest, KeepsEventsOfExitedThreads) {
+  std::thread thread([]() { TraceScope trace("test", "OtherThread"); });
+  thread.join();
+
+  EXPECT_THAT(Tracer::ExportChromeTraceJson(), HasSubstr("OtherThread"));
+}
+
+TEST_F(TracingTest, RingBufferDropsOldestEvents) {
+  Tracer::RecordInstant("test", "Oldest");
+  for (int i = 0; i < Tracer::kEventsPerThread; ++i) {
+    Tracer::RecordInstant("test", "Newer");
+  }
+
+  EXPECT_THAT(Tracer::ExportChromeTraceJson(), Not(HasSubstr("Oldest")));
+}
+
+TEST_F(TracingTest, ClearDropsEvents) {
+  Tracer::RecordInstant("test", "Cleared");
+  Tracer::Clear();
+
+  EXPECT_THAT(Tracer::ExportChromeTraceJson(), Not(HasSubstr("Cleared")));
+}
+
+}  // namespace
+}  // namespace nearby
@@ -17,6 +17,7 @@
 
 #include <array>
 #include <cstdint>
+#include <optional>
 #include <string>
 
 #include "absl/strings/string_view.h"
@@ -40,6 +41,26 @@ class Uuid final {
   constexpr Uuid(std::uint64_t most_sig_bits, std::uint64_t least_sig_bits)
       : most_sig_bits_(most_sig_bits), least_sig_bits_(least_sig_bits) {}
 
+  // Parses the canonical textual representation, e.g.
+  // "0000FEF3-0000-1000-8000-00805F9B34FB", in either case. Returns nullopt
+  // for anything else.
+  static constexpr std::optional<Uuid> FromString(absl::string_view str) {
+    if (str.size() != 36) return std::nullopt;
+    std::uint64_t bits[2] = {0, 0};
+    int nibbles = 0;
+    for (int i = 0; i < 36; ++i) {
+      if (i == 8 || i == 13 || i == 18 || i == 23) {
+        if (str[i] != '-') return std::nullopt;
+        continue;
+      }
+      int digit = HexDigit(str[i]);
+      if (digit < 0) return std::nullopt;
+      std::uint64_t& half = bits[nibbles++ / 16];
+      half = (half << 4) | static_cast<std::uint64_t>(digit);
+    }
+    return Uuid(bits[0], bits[1]);
+  }
+
   // Returns a 16-size char array representing this UUID.
   std::array<char, 16> data() const;
 
@@ -54,8 +75,8 @@ class Uuid final {
   // section in advertising data
   std::string Get16BitAsString() const;
 
-  std::uint64_t GetMostSigBits() const { return most_sig_bits_; }
-  std::uint64_t GetLeastSigBits() const { return least_sig_bits_; }
+  constexpr std::uint64_t GetMostSigBits() const { return most_sig_bits_; }
+  constexpr std::uint64_t GetLeastSigBits() const { return least_sig_bits_; }
 
   bool operator<(const Uuid &rhs) const;
   // Hashable
@@ -70,6 +91,14 @@ class Uuid final {
   bool IsEmpty() const { return most_sig_bits_ == 0 && least_sig_bits_ == 0; }
 
  private:
+  // Returns the value of hex digit |c|, or -1 if it isn't one.
+  static constexpr int HexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+  }
+
   std::string ToCanonicalString(const std::array<char, 16> &data) const;
 
   std::uint64_t most_sig_bits_{0};
@@ -14,6 +14,7 @@
 
 #include "internal/platform/uuid.h"
 
+#include <optional>
 #include <string>
 
 #include "gmock/gmock.h"
@@ -131,5 +132,28 @@ TEST(UuidTest, OperatorGreaterThan) {
   EXPECT_TRUE(a < b);
 }
 
+TEST(UuidTest, FromStringParsesCanonicalString) {
+  static_assert(Uuid::FromString("0000FEF3-0000-1000-8000-00805F9B34FB")
+                    ->GetLeastSigBits() == kCopresenceServiceUuidLsb);
+
+  std::optional<Uuid> uuid =
+      Uuid::FromString("0000fef3-0000-1000-8000-00805f9b34fb");
+
+  ASSERT_TRUE(uuid.has_value());
+  EXPECT_EQ(*uuid, Uuid(kCopresenceServiceUuidMsb, kCopresenceServiceUuidLsb));
+  EXPECT_EQ(Uuid::FromString(std::string(*uuid)), uuid);
+}
+
+TEST(UuidTest, FromStringRejectsOtherStrings) {
+  EXPECT_FALSE(Uuid::FromString("").has_value());
+  EXPECT_FALSE(Uuid::FromString("FEF3").has_value());
+  EXPECT_FALSE(
+      Uuid::FromString("0000FEF3000010008000-00805F9B34FB").has_value());
+  EXPECT_FALSE(
+      Uuid::FromString("0000FEF3-0000-1000-8000_00805F9B34FB").has_value());
+  EXPECT_FALSE(
+      Uuid::FromString("0000FEF3-0000-1000-8000-00805F9B34FG").has_value());
+}
+
 }  // namespace
 }  // namespace nearby
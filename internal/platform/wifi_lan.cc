@@ -20,6 +20,14 @@
 #include "internal/platform/mutex_lock.h"
 
 namespace nearby {
+namespace {
+
+bool IsSameResolution(const NsdServiceInfo& a, const NsdServiceInfo& b) {
+  return a.GetIPAddress() == b.GetIPAddress() && a.GetPort() == b.GetPort() &&
+         a.GetTxtRecords() == b.GetTxtRecords();
+}
+
+}  // namespace
 
 bool WifiLanMedium::StartAdvertising(const NsdServiceInfo& nsd_service_info) {
   return impl_->StartAdvertising(nsd_service_info);
@@ -65,12 +73,30 @@ bool WifiLanMedium::StartDiscovery(const std::string& service_id,
             }
 
             std::string service_name = service_info.GetServiceName();
-            auto pair = services_it->second.insert(service_name);
-            if (!pair.second) {
+            std::string service_id = it->second->service_id;
+            DiscoveredServiceCallback& medium_callback =
+                it->second->medium_callback;
+            auto [cached, inserted] =
+                services_it->second.insert({service_name, service_info});
+            if (!inserted) {
+              if (IsSameResolution(cached->second, service_info)) {
+                NEARBY_LOGS(INFO)
+                    << "Discovering (again) service_info=" << &service_info
+                    << ", service_type=" << service_type
+                    << ", service_name=" << service_info.GetServiceName();
+                return;
+              }
+              // The service changed its address or TXT records, so report
+              // the old resolution lost before reporting the new one.
               NEARBY_LOGS(INFO)
-                  << "Discovering (again) service_info=" << &service_info
+                  << "Updating service_info=" << &service_info
                   << ", service_type=" << service_type
                   << ", service_name=" << service_info.GetServiceName();
+              NsdServiceInfo old_service_info =
+                  std::exchange(cached->second, service_info);
+              medium_callback.service_lost_cb(std::move(old_service_info),
+                                              service_id);
+              medium_callback.service_discovered_cb(service_info, service_id);
               return;
             }
 
@@ -78,10 +104,6 @@ bool WifiLanMedium::StartDiscovery(const std::string& service_id,
                 << "Adding service_info=" << &service_info
                 << ", service_type=" << service_type
                 << ", service_name=" << service_info.GetServiceName();
-
-            std::string service_id = it->second->service_id;
-            DiscoveredServiceCallback& medium_callback =
-                it->second->medium_callback;
             medium_callback.service_discovered_cb(service_info, service_id);
           },
       .service_lost_cb =
@@ -102,13 +124,15 @@ bool WifiLanMedium::StartDiscovery(const std::string& service_id,
             NEARBY_LOGS(INFO) << "Removing service_info=" << &service_info
                               << ", service_type=" << service_type
                               << ", service_info_name=" << service_name;
-            // Callback service lost.
+            // Callback service lost with the cached resolution, since the
+            // platform may only report the name of a lost service.
             const auto& it = service_type_to_callback_map_.find(service_type);
             if (it != service_type_to_callback_map_.end()) {
               std::string service_id = it->second->service_id;
               DiscoveredServiceCallback& medium_callback =
                   it->second->medium_callback;
-              medium_callback.service_lost_cb(service_info, service_id);
+              medium_callback.service_lost_cb(std::move(item.mapped()),
+                                              service_id);
             }
           },
   };
@@ -124,7 +148,7 @@ bool WifiLanMedium::StartDiscovery(const std::string& service_id,
     // Insert an empty services set to track the services under the service
     // type.
     service_type_to_services_map_.insert(
-        {service_type, absl::flat_hash_set<std::string>()});
+        {service_type, absl::flat_hash_map<std::string, NsdServiceInfo>()});
   }
 
   bool success = impl_->StartDiscovery(service_type, std::move(api_callback));
@@ -214,8 +214,11 @@ class WifiLanMedium {
   absl::flat_hash_map<std::string, std::unique_ptr<DiscoveryCallbackInfo>>
       service_type_to_callback_map_ ABSL_GUARDED_BY(mutex_);
 
-  // Used to keep the map from service type to services with the type.
-  absl::flat_hash_map<std::string, absl::flat_hash_set<std::string>>
+  // Used to keep the map from service type to the latest resolution of each
+  // service with the type, by service name. Resolving a service again only
+  // reaches the callback if its address, port or TXT records changed.
+  absl::flat_hash_map<std::string,
+                      absl::flat_hash_map<std::string, NsdServiceInfo>>
       service_type_to_services_map_ ABSL_GUARDED_BY(mutex_);
 };
 
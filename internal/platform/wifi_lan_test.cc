@@ -15,6 +15,8 @@
 #include "internal/platform/wifi_lan.h"
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "protobuf-matchers/protocol-buffer-matchers.h"
@@ -23,6 +25,8 @@
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/logging.h"
 #include "internal/platform/medium_environment.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/mutex_lock.h"
 
 namespace nearby {
 namespace {
@@ -399,6 +403,66 @@ TEST_F(WifiLanMediumTest, CanDiscoverMultipleAdvertisementsOnSameService) {
   env_.Stop();
 }
 
+TEST_F(WifiLanMediumTest, ReportsChangedServiceAsLostAndFound) {
+  env_.Start();
+  WifiLanMedium wifi_lan_discovery;
+  WifiLanMedium wifi_lan_advertising_1;
+  WifiLanMedium wifi_lan_advertising_2;
+  std::string service_id(kServiceId);
+  std::string service_type(kServiceType);
+  std::string service_info_name(kServiceInfoName);
+  std::string endpoint_info_key(kEndpointInfoKey);
+  CountDownLatch discovered_latch(2);
+  CountDownLatch lost_latch(1);
+  Mutex mutex;
+  std::vector<std::string> discovered_endpoints;
+  std::string lost_endpoint;
+
+  wifi_lan_discovery.StartDiscovery(
+      service_id, service_type,
+      DiscoveredServiceCallback{
+          .service_discovered_cb =
+              [&](NsdServiceInfo service_info,
+                  const std::string& service_id) {
+                MutexLock lock(&mutex);
+                discovered_endpoints.push_back(
+                    service_info.GetTxtRecord(endpoint_info_key));
+                discovered_latch.CountDown();
+              },
+          .service_lost_cb =
+              [&](NsdServiceInfo service_info,
+                  const std::string& service_id) {
+                MutexLock lock(&mutex);
+                lost_endpoint = service_info.GetTxtRecord(endpoint_info_key);
+                lost_latch.CountDown();
+              },
+      });
+
+  // Both devices advertise the same service name, so the second one looks
+  // like the first one changing its TXT records.
+  NsdServiceInfo nsd_service_info_1;
+  nsd_service_info_1.SetServiceName(service_info_name);
+  nsd_service_info_1.SetTxtRecord(endpoint_info_key, "endpoint1");
+  nsd_service_info_1.SetServiceType(service_type);
+  NsdServiceInfo nsd_service_info_2 = nsd_service_info_1;
+  nsd_service_info_2.SetTxtRecord(endpoint_info_key, "endpoint2");
+
+  EXPECT_TRUE(wifi_lan_advertising_1.StartAdvertising(nsd_service_info_1));
+  EXPECT_TRUE(wifi_lan_advertising_2.StartAdvertising(nsd_service_info_2));
+  EXPECT_TRUE(discovered_latch.Await(kWaitDuration).result());
+  EXPECT_TRUE(lost_latch.Await(kWaitDuration).result());
+  {
+    MutexLock lock(&mutex);
+    EXPECT_THAT(discovered_endpoints,
+                ::testing::ElementsAre("endpoint1", "endpoint2"));
+    EXPECT_EQ(lost_endpoint, "endpoint1");
+  }
+  EXPECT_TRUE(wifi_lan_advertising_1.StopAdvertising(nsd_service_info_1));
+  EXPECT_TRUE(wifi_lan_advertising_2.StopAdvertising(nsd_service_info_2));
+  EXPECT_TRUE(wifi_lan_discovery.StopDiscovery(service_type));
+  env_.Stop();
+}
+
 TEST_F(WifiLanMediumTest, CanDiscoverThatOtherMediumAdvertise) {
   env_.Start();
   WifiLanMedium wifi_lan_a;
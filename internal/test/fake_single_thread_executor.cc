@@ -24,9 +24,9 @@ FakeSingleThreadExecutor::FakeSingleThreadExecutor() = default;
 
 FakeSingleThreadExecutor::~FakeSingleThreadExecutor() { DoShutdown(); }
 
-void FakeSingleThreadExecutor::Execute(const std::string& name,
+void FakeSingleThreadExecutor::Execute(absl::string_view name,
                                        Runnable&& runnable) {
-  runnables_.push_back(std::make_pair(name, std::move(runnable)));
+  runnables_.push_back(std::make_pair(std::string(name), std::move(runnable)));
 
   if (!run_executables_immediately_) return;
 
@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
 #include "internal/platform/single_thread_executor.h"
 
 namespace nearby {
@@ -32,7 +33,7 @@ class ABSL_LOCKABLE FakeSingleThreadExecutor final
   FakeSingleThreadExecutor(FakeSingleThreadExecutor&&) = default;
   FakeSingleThreadExecutor& operator=(FakeSingleThreadExecutor&&) = default;
 
-  void Execute(const std::string& name, Runnable&& runnable) override;
+  void Execute(absl::string_view name, Runnable&& runnable) override;
 
   void SetRunExecutablesImmediately(bool run_executables_immediately) {
     run_executables_immediately_ = run_executables_immediately;
@@ -14,6 +14,7 @@
 
 #include "internal/weave/base_socket.h"
 
+#include <algorithm>
 #include <deque>
 #include <string>
 #include <utility>
@@ -36,8 +37,11 @@
 namespace nearby {
 namespace weave {
 
-BaseSocket::BaseSocket(const Connection& connection, SocketCallback&& callback)
-    : socket_callback_(std::move(callback)),
+BaseSocket::BaseSocket(const Connection& connection, SocketCallback&& callback,
+                       int max_packets_in_flight)
+    : max_packets_in_flight_(
+          std::clamp(max_packets_in_flight, 1, Packet::kMaxPacketCounter)),
+      socket_callback_(std::move(callback)),
       connection_(const_cast<Connection&>(connection)) {
   connection_.Initialize(
       {.on_transmit_cb =
@@ -103,9 +107,9 @@ void BaseSocket::TryWriteNextControl() {
   // one of three packets. ConnectionRequest, ConnectionConfirm, or Error.
   // In any case, we should not have any messages in the queue from the previous
   // connection.
-  current_message_ = nullptr;
-  message_request_queue_.clear();
-  WritePacket(current_control_->NextPacket(max_packet_size_));
+  ClearMessagesLocked();
+  WritePacket(current_control_->NextPacket(max_packet_size_),
+              InFlightPacket::kControl);
 }
 
 void BaseSocket::TryWriteNextMessage() {
@@ -121,28 +125,55 @@ void BaseSocket::TryWriteNextMessage() {
   }
   bool connected = IsConnected();
   MutexLock lock(&mutex_);
-  if (current_message_ == nullptr) {
-    if (!message_request_queue_.empty()) {
-      current_message_ = &message_request_queue_.front();
-    }
-  }
-  if (current_message_ == nullptr || current_message_->IsFinished() ||
-      !connected) {
+  if (!connected) {
     return;
   }
-  WritePacket(current_message_->NextPacket(max_packet_size_));
+  while (packets_in_flight_.size() <
+         static_cast<size_t>(max_packets_in_flight_)) {
+    // Messages stay queued until their last packet is transmitted, so the
+    // message to write from is the first one with packets left.
+    if (current_message_ == nullptr || current_message_->IsFinished()) {
+      current_message_ = nullptr;
+      for (MessageWriteRequest& request : message_request_queue_) {
+        if (!request.IsFinished()) {
+          current_message_ = &request;
+          break;
+        }
+      }
+    }
+    if (current_message_ == nullptr) {
+      return;
+    }
+    absl::StatusOr<Packet> packet =
+        current_message_->NextPacket(max_packet_size_);
+    WritePacket(std::move(packet), current_message_->IsFinished()
+                                       ? InFlightPacket::kLastMessagePacket
+                                       : InFlightPacket::kMessagePacket);
+  }
 }
 
-void BaseSocket::WritePacket(absl::StatusOr<Packet> packet) {
+void BaseSocket::WritePacket(absl::StatusOr<Packet> packet,
+                             InFlightPacket in_flight) {
   if (!packet.ok()) {
     NEARBY_LOGS(WARNING) << "Packet status:" << packet.status();
     return;
   }
   CHECK(packet->SetPacketCounter(packet_counter_generator_.Next()).ok());
-  NEARBY_LOGS(INFO) << "transmitting packet";
+  NEARBY_LOGS(VERBOSE) << "transmitting packet";
+  packets_in_flight_.push_back(in_flight);
   connection_.Transmit(packet->GetBytes());
 }
 
+void BaseSocket::ClearMessagesLocked() {
+  current_message_ = nullptr;
+  message_request_queue_.clear();
+  for (InFlightPacket& in_flight : packets_in_flight_) {
+    if (in_flight == InFlightPacket::kLastMessagePacket) {
+      in_flight = InFlightPacket::kMessagePacket;
+    }
+  }
+}
+
 void BaseSocket::OnWriteRequestWriteComplete(absl::Status status) {
   RunOnSocketThread(
       "OnWriteRequestWriteComplete",
@@ -150,20 +181,33 @@ void BaseSocket::OnWriteRequestWriteComplete(absl::Status status) {
           ABSL_LOCKS_EXCLUDED(mutex_) mutable {
             {
               MutexLock lock(&mutex_);
-              if (current_control_ != nullptr) {
-                current_control_ = nullptr;
-                control_request_queue_.pop_front();
-              } else if (current_message_ != nullptr) {
-                NEARBY_LOGS(INFO) << "OnWriteResult current is not null";
-                if (current_message_->IsFinished()) {
-                  NEARBY_LOGS(INFO) << "OnWriteResult current finished";
-                  current_message_->SetWriteStatus(status);
-                  if (!message_request_queue_.empty() &&
-                      current_message_ == &message_request_queue_.front()) {
-                    NEARBY_LOGS(INFO) << "remove message";
-                    message_request_queue_.pop_front();
+              // Completions of packets written before the last reset have
+              // nothing left to finish.
+              if (packets_in_flight_.empty()) {
+                NEARBY_LOGS_EVERY_N_SEC(INFO, 1)
+                    << "OnWriteResult for a dropped packet";
+              } else {
+                InFlightPacket in_flight = packets_in_flight_.front();
+                packets_in_flight_.pop_front();
+                if (in_flight == InFlightPacket::kControl) {
+                  if (current_control_ != nullptr) {
+                    current_control_ = nullptr;
+                    control_request_queue_.pop_front();
+                  }
+                } else if ((in_flight == InFlightPacket::kLastMessagePacket ||
+                            !status.ok()) &&
+                           !message_request_queue_.empty()) {
+                  // Packets complete in order, so this one belongs to the
+                  // first queued message. A failed packet fails its message.
+                  MessageWriteRequest& message = message_request_queue_.front();
+                  message.SetWriteStatus(status);
+                  if (current_message_ == &message) {
                     current_message_ = nullptr;
                   }
+                  message_request_queue_.pop_front();
+                  if (!status.ok()) {
+                    ClearMessagesLocked();
+                  }
                 }
               }
             }
@@ -195,8 +239,7 @@ void BaseSocket::Disconnect() {
       WriteControlPacket(Packet::CreateErrorPacket());
       {
         MutexLock lock(&mutex_);
-        current_message_ = nullptr;
-        message_request_queue_.clear();
+        ClearMessagesLocked();
         state_ = SocketConnectionState::kDisconnecting;
       }
       DisconnectQuietly();
@@ -226,6 +269,7 @@ void BaseSocket::DisconnectQuietly() {
                             MutexLock lock(&mutex_);
                             message_request_queue_.clear();
                             control_request_queue_.clear();
+                            packets_in_flight_.clear();
                             current_control_ = nullptr;
                             current_message_ = nullptr;
                             state_ = SocketConnectionState::kDisconnected;
@@ -38,7 +38,11 @@ namespace weave {
 // messages.
 class BaseSocket {
  public:
-  BaseSocket(const Connection& connection, SocketCallback&& callback);
+  // Up to `max_packets_in_flight` message packets are handed to the
+  // connection before the first of them is reported transmitted. The 3-bit
+  // packet counter caps it at Packet::kMaxPacketCounter.
+  BaseSocket(const Connection& connection, SocketCallback&& callback,
+             int max_packets_in_flight = 1);
   virtual ~BaseSocket();
 
   bool IsConnected() ABSL_LOCKS_EXCLUDED(mutex_);
@@ -57,7 +61,7 @@ class BaseSocket {
   void WriteControlPacket(Packet packet);
   void OnReceiveDataPacket(Packet packet);
   void RunOnSocketThread(std::string name, Runnable&& runnable) {
-    NEARBY_LOGS(INFO) << "RunOnSocketThread: " << name;
+    NEARBY_LOGS_EVERY_N(VERBOSE, 100) << "RunOnSocketThread: " << name;
     executor_.Execute(name, std::move(runnable));
   }
   void ShutDown();
@@ -79,6 +83,13 @@ class BaseSocket {
     kConnected
   };
 
+  // What the completion of a packet handed to the connection finishes.
+  enum class InFlightPacket {
+    kControl,
+    kMessagePacket,
+    kLastMessagePacket,
+  };
+
   bool IsRemotePacketCounterExpected(int counter);
   void TryWriteNextControl() ABSL_EXCLUSIVE_LOCKS_REQUIRED(executor_)
       ABSL_LOCKS_EXCLUDED(mutex_);
@@ -86,7 +97,10 @@ class BaseSocket {
       ABSL_LOCKS_EXCLUDED(mutex_);
   void OnWriteRequestWriteComplete(absl::Status status)
       ABSL_LOCKS_EXCLUDED(executor_);
-  void WritePacket(absl::StatusOr<Packet> packet);
+  void WritePacket(absl::StatusOr<Packet> packet, InFlightPacket in_flight)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Drops queued messages. Their packets in flight won't complete any message.
+  void ClearMessagesLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   Mutex mutex_;
   // Messages and controls are in two separate queues to separate their control
@@ -97,6 +111,10 @@ class BaseSocket {
       ABSL_GUARDED_BY(mutex_);
   ControlPacketWriteRequest* current_control_ = nullptr;
   MessageWriteRequest* current_message_ = nullptr;
+  // Packets handed to the connection that weren't reported transmitted yet,
+  // oldest first. The connection reports them in order.
+  std::deque<InFlightPacket> packets_in_flight_ ABSL_GUARDED_BY(mutex_);
+  const int max_packets_in_flight_;
   SocketConnectionState state_ ABSL_GUARDED_BY(mutex_) =
       SocketConnectionState::kDisconnected;
   int max_packet_size_;
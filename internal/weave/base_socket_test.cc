@@ -84,8 +84,10 @@ class FakeConnection : public Connection {
 class FakeSocket : public BaseSocket {
  public:
   explicit FakeSocket(const Connection& connection,
-                      SocketCallback&& socketCallback)
-      : BaseSocket(connection, std::move(socketCallback)) {}
+                      SocketCallback&& socketCallback,
+                      int max_packets_in_flight = 1)
+      : BaseSocket(connection, std::move(socketCallback),
+                   max_packets_in_flight) {}
   MOCK_METHOD(void, Connect, (), (override));
   void OnReceiveControlPacket(Packet packet) override {
     control_packets_.push_back(std::move(packet));
@@ -278,6 +280,60 @@ TEST_F(BaseSocketTest, TestWritePacketCounterRollover) {
   EXPECT_EQ(connection_.PollWrittenPacket(), packet.GetBytes());
 }
 
+TEST_F(BaseSocketTest, TestWriteWaitsForTransmit) {
+  connection_.SetInstantTransmit(false);
+  socket_.OnConnectedProxy(kMaxPacketSize);
+  nearby::Future<absl::Status> status =
+      socket_.Write(ByteArray("\x01\x02\x03"));
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_EQ(connection_.PollWrittenPacket(),
+            CreateDataPacket(0, true, false, ByteArray("\x01\x02")).GetBytes());
+  EXPECT_TRUE(connection_.NoMorePackets());
+  connection_.OnTransmitProxy(absl::OkStatus());
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_EQ(connection_.PollWrittenPacket(),
+            CreateDataPacket(1, false, true, ByteArray("\x03")).GetBytes());
+  EXPECT_FALSE(status.IsSet());
+  connection_.OnTransmitProxy(absl::OkStatus());
+  EXPECT_OK(status.Get().GetResult());
+}
+
+TEST_F(BaseSocketTest, TestWritePipelinesPackets) {
+  FakeConnection connection(20);
+  connection.SetInstantTransmit(false);
+  FakeSocket socket(connection, SocketCallback{}, /*max_packets_in_flight=*/2);
+  socket.OnConnectedProxy(kMaxPacketSize);
+  nearby::Future<absl::Status> first =
+      socket.Write(ByteArray("\x01\x02\x03\x04\x05"));
+  nearby::Future<absl::Status> second = socket.Write(ByteArray("\x06"));
+  absl::SleepFor(absl::Milliseconds(10));
+  // Two packets go out before either is transmitted.
+  EXPECT_EQ(connection.PollWrittenPacket(),
+            CreateDataPacket(0, true, false, ByteArray("\x01\x02")).GetBytes());
+  EXPECT_EQ(connection.PollWrittenPacket(),
+            CreateDataPacket(1, false, false, ByteArray("\x03\x04")).GetBytes());
+  EXPECT_TRUE(connection.NoMorePackets());
+
+  connection.OnTransmitProxy(absl::OkStatus());
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_EQ(connection.PollWrittenPacket(),
+            CreateDataPacket(2, false, true, ByteArray("\x05")).GetBytes());
+  EXPECT_TRUE(connection.NoMorePackets());
+
+  // The next message fills the window once the first one is written out.
+  connection.OnTransmitProxy(absl::OkStatus());
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_EQ(connection.PollWrittenPacket(),
+            CreateDataPacket(3, true, true, ByteArray("\x06")).GetBytes());
+  EXPECT_FALSE(first.IsSet());
+
+  connection.OnTransmitProxy(absl::OkStatus());
+  EXPECT_OK(first.Get().GetResult());
+  EXPECT_FALSE(second.IsSet());
+  connection.OnTransmitProxy(absl::OkStatus());
+  EXPECT_OK(second.Get().GetResult());
+}
+
 TEST_F(BaseSocketTest, TestResetByDisconnect) {
   connection_.SetInstantTransmit(false);
   socket_.OnConnectedProxy(kMaxPacketSize);
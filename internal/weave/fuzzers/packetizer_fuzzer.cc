@@ -0,0 +1,44 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "fuzzer/FuzzedDataProvider.h"
+#include "internal/platform/byte_array.h"
+#include "internal/weave/packet.h"
+#include "internal/weave/packetizer.h"
+
+// Splits the input into packets, the way they'd arrive over a connection, and
+// reassembles the data packets into messages.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  FuzzedDataProvider provider(data, size);
+  nearby::weave::Packetizer packetizer;
+
+  while (provider.remaining_bytes() > 0) {
+    std::string packet_bytes = provider.ConsumeBytesAsString(
+        provider.ConsumeIntegralInRange<size_t>(1, 512));
+    auto packet =
+        nearby::weave::Packet::FromBytes(nearby::ByteArray(packet_bytes));
+    if (!packet.ok() || !packet->IsDataPacket()) continue;
+    if (packetizer.AddPacket(*std::move(packet)).ok()) {
+      packetizer.TakeMessage();
+    } else {
+      packetizer.Reset();
+    }
+  }
+
+  return 0;
+}
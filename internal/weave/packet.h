@@ -20,6 +20,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
 #include "internal/platform/byte_array.h"
 
 namespace nearby {
@@ -100,6 +101,10 @@ class Packet {
   }
   static Packet CreateDataPacket(bool is_first_packet, bool is_last_packet,
                                  ByteArray payload);
+  // Same as above, but copies `payload` straight into the packet, e.g. from a
+  // view into the message being sent.
+  static Packet CreateDataPacket(bool is_first_packet, bool is_last_packet,
+                                 absl::string_view payload);
   static absl::StatusOr<Packet> CreateConnectionRequestPacket(
       int16_t min_protocol_version, int16_t max_protocol_version,
       int16_t max_packet_size, absl::string_view extra_data);
@@ -127,6 +132,10 @@ class Packet {
   int GetPacketCounter() const;
   ControlPacketType GetControlCommandNumber() const;
   std::string GetPayload() const { return bytes_.substr(kPacketHeaderLength); }
+  // Returns a view of the payload, valid as long as the packet is.
+  absl::string_view GetPayloadView() const {
+    return absl::string_view(bytes_).substr(kPacketHeaderLength);
+  }
   std::string GetBytes() const { return bytes_; }
   absl::Status SetPacketCounter(int packetCounter);
   std::string ToString();
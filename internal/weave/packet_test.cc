@@ -21,6 +21,7 @@
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
 
 namespace nearby {
 namespace weave {
@@ -111,6 +112,14 @@ TEST(PacketTest, CreateDataPacketTest) {
   EXPECT_EQ(packet.GetPacketCounter(), 0);
 }
 
+TEST(PacketTest, CreateDataPacketFromViewTest) {
+  absl::string_view message = "a big payload";
+  Packet packet = Packet::CreateDataPacket(true, false, message.substr(2, 3));
+  Packet expected = Packet::CreateDataPacket(true, false, ByteArray("big"));
+  EXPECT_EQ(packet.GetBytes(), expected.GetBytes());
+  EXPECT_EQ(packet.GetPayloadView(), "big");
+}
+
 TEST(PacketTest, SetPacketCounterTest) {
   Packet packet = Packet::CreateDataPacket(false, false, ByteArray("sample"));
   EXPECT_OK(packet.SetPacketCounter(1));
@@ -17,6 +17,7 @@
 #include <utility>
 
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/mutex_lock.h"
 #include "internal/weave/packet.h"
@@ -40,7 +41,10 @@ absl::Status Packetizer::AddPacket(Packet packet) {
         "Packet marked as first packet cannot be added if there are existing "
         "packets.");
   }
-  absl::StrAppend(&pending_payloads_, packet.GetPayload());
+  if (packet.IsFirstPacket()) {
+    pending_payloads_.reserve(last_message_size_);
+  }
+  absl::StrAppend(&pending_payloads_, packet.GetPayloadView());
   if (packet.IsLastPacket()) {
     is_message_complete_ = true;
   }
@@ -53,6 +57,7 @@ absl::StatusOr<ByteArray> Packetizer::TakeMessage() {
     return absl::UnavailableError(
         "Full message is not available, no last packet added yet.");
   }
+  last_message_size_ = pending_payloads_.size();
   ByteArray message = ByteArray(std::move(pending_payloads_));
   pending_payloads_.clear();
   is_message_complete_ = false;
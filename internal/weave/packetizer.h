@@ -15,6 +15,7 @@
 #ifndef THIRD_PARTY_NEARBY_INTERNAL_WEAVE_PACKETIZER_H_
 #define THIRD_PARTY_NEARBY_INTERNAL_WEAVE_PACKETIZER_H_
 
+#include <cstddef>
 #include <string>
 
 #include "absl/status/statusor.h"
@@ -48,6 +49,9 @@ class Packetizer {
  private:
   Mutex mutex_;
   std::string pending_payloads_ ABSL_GUARDED_BY(mutex_);
+  // Messages on a connection tend to be of similar sizes, so the buffer of a
+  // new message starts with the capacity of the last one.
+  size_t last_message_size_ ABSL_GUARDED_BY(mutex_) = 0;
   bool is_message_complete_ ABSL_GUARDED_BY(mutex_) = false;
 };
 }  // namespace weave
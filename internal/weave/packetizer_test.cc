@@ -46,6 +46,22 @@ TEST(PacketizerTest, TestAddPacket) {
   EXPECT_EQ(message->string_data(), "helloworld");
 }
 
+TEST(PacketizerTest, TestTakeMessagesOfDifferentSizes) {
+  Packetizer packetizer;
+  EXPECT_OK(packetizer.AddPacket(Packet::CreateDataPacket(
+      /*is_first_packet=*/true, /*is_last_packet=*/true,
+      ByteArray("a long message"))));
+  auto message = packetizer.TakeMessage();
+  ASSERT_OK(message);
+  EXPECT_EQ(message->string_data(), "a long message");
+
+  EXPECT_OK(packetizer.AddPacket(Packet::CreateDataPacket(
+      /*is_first_packet=*/true, /*is_last_packet=*/true, ByteArray("short"))));
+  message = packetizer.TakeMessage();
+  ASSERT_OK(message);
+  EXPECT_EQ(message->string_data(), "short");
+}
+
 TEST(PacketizerTest, TestAddPacketTwice) {
   Packet packet1 = Packet::CreateDataPacket(
       /*is_first_packet=*/true, /*is_last_packet=*/false, ByteArray("hello"));
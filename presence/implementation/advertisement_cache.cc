@@ -0,0 +1,62 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "presence/implementation/advertisement_cache.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "presence/implementation/advertisement_decoder.h"
+
+namespace nearby {
+namespace presence {
+
+const std::optional<Advertisement>* AdvertisementCache::Find(
+    absl::string_view advertisement) {
+  auto it = index_.find(advertisement);
+  if (it == index_.end()) {
+    return nullptr;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return &it->second->second;
+}
+
+void AdvertisementCache::Insert(absl::string_view advertisement,
+                                std::optional<Advertisement> decoded) {
+  auto it = index_.find(advertisement);
+  if (it != index_.end()) {
+    it->second->second = std::move(decoded);
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return;
+  }
+  if (capacity_ <= 0) {
+    return;
+  }
+  if (entries_.size() >= static_cast<size_t>(capacity_)) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  entries_.emplace_front(std::string(advertisement), std::move(decoded));
+  index_.emplace(entries_.front().first, entries_.begin());
+}
+
+void AdvertisementCache::Clear() {
+  index_.clear();
+  entries_.clear();
+}
+
+}  // namespace presence
+}  // namespace nearby
@@ -0,0 +1,72 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_ADVERTISEMENT_CACHE_H_
+#define THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_ADVERTISEMENT_CACHE_H_
+
+#include <list>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "presence/implementation/advertisement_decoder.h"
+
+namespace nearby {
+namespace presence {
+
+// A bounded, least recently used cache of decoded advertisements, keyed by
+// the raw advertisement bytes.
+//
+// Scanners report an advertisement every advertising interval until the remote
+// device rotates its salt, and each report would otherwise be parsed,
+// decrypted and matched against the scan filters again. The outcome is only
+// valid for the credentials and filters it was decoded with, so the owner
+// must `Clear()` the cache when they change. This class is not thread-safe.
+class AdvertisementCache {
+ public:
+  explicit AdvertisementCache(int capacity) : capacity_(capacity) {}
+  AdvertisementCache(AdvertisementCache&&) = default;
+  AdvertisementCache& operator=(AdvertisementCache&&) = default;
+
+  // Returns the cached outcome of decoding `advertisement`, or nullptr if it
+  // isn't cached. A cached `std::nullopt` means that the advertisement isn't
+  // relevant to the scan. The pointer is valid until the next `Insert()` or
+  // `Clear()`.
+  const std::optional<Advertisement>* Find(absl::string_view advertisement);
+
+  // Caches the outcome of decoding `advertisement`, evicting the least
+  // recently used entry if the cache is full.
+  void Insert(absl::string_view advertisement,
+              std::optional<Advertisement> decoded);
+
+  void Clear();
+
+  int size() const { return entries_.size(); }
+
+ private:
+  using Entry = std::pair<std::string, std::optional<Advertisement>>;
+
+  int capacity_;
+  // Most recently used first.
+  std::list<Entry> entries_;
+  // Keys point into `entries_`, which doesn't move its elements.
+  absl::flat_hash_map<absl::string_view, std::list<Entry>::iterator> index_;
+};
+
+}  // namespace presence
+}  // namespace nearby
+
+#endif  // THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_ADVERTISEMENT_CACHE_H_
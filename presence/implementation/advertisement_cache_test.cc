@@ -0,0 +1,115 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "presence/implementation/advertisement_cache.h"
+
+#include <optional>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "presence/data_element.h"
+#include "presence/implementation/advertisement_decoder.h"
+
+namespace nearby {
+namespace presence {
+
+namespace {
+using ::testing::ElementsAre;
+
+Advertisement GetAdvertisement(absl::string_view tx_power) {
+  return Advertisement{.data_elements = {DataElement(
+                           DataElement::kTxPowerFieldType, tx_power)}};
+}
+
+TEST(AdvertisementCache, FindsInsertedAdvertisement) {
+  AdvertisementCache cache(2);
+
+  cache.Insert("advertisement", GetAdvertisement("5"));
+
+  const std::optional<Advertisement>* advertisement =
+      cache.Find("advertisement");
+  ASSERT_NE(advertisement, nullptr);
+  ASSERT_TRUE(advertisement->has_value());
+  EXPECT_THAT((*advertisement)->data_elements,
+              ElementsAre(DataElement(DataElement::kTxPowerFieldType, "5")));
+}
+
+TEST(AdvertisementCache, FindsIrrelevantAdvertisement) {
+  AdvertisementCache cache(2);
+
+  cache.Insert("advertisement", std::nullopt);
+
+  const std::optional<Advertisement>* advertisement =
+      cache.Find("advertisement");
+  ASSERT_NE(advertisement, nullptr);
+  EXPECT_FALSE(advertisement->has_value());
+}
+
+TEST(AdvertisementCache, MissingAdvertisement) {
+  AdvertisementCache cache(2);
+  cache.Insert("advertisement", GetAdvertisement("5"));
+
+  EXPECT_EQ(cache.Find("other advertisement"), nullptr);
+}
+
+TEST(AdvertisementCache, EvictsLeastRecentlyUsed) {
+  AdvertisementCache cache(2);
+  cache.Insert("first", GetAdvertisement("1"));
+  cache.Insert("second", GetAdvertisement("2"));
+  cache.Find("first");
+
+  cache.Insert("third", GetAdvertisement("3"));
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_NE(cache.Find("first"), nullptr);
+  EXPECT_EQ(cache.Find("second"), nullptr);
+  EXPECT_NE(cache.Find("third"), nullptr);
+}
+
+TEST(AdvertisementCache, InsertReplacesOutcome) {
+  AdvertisementCache cache(2);
+  cache.Insert("advertisement", std::nullopt);
+
+  cache.Insert("advertisement", GetAdvertisement("5"));
+
+  EXPECT_EQ(cache.size(), 1);
+  const std::optional<Advertisement>* advertisement =
+      cache.Find("advertisement");
+  ASSERT_NE(advertisement, nullptr);
+  EXPECT_TRUE(advertisement->has_value());
+}
+
+TEST(AdvertisementCache, Clear) {
+  AdvertisementCache cache(2);
+  cache.Insert("advertisement", GetAdvertisement("5"));
+
+  cache.Clear();
+
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_EQ(cache.Find("advertisement"), nullptr);
+}
+
+TEST(AdvertisementCache, SurvivesMove) {
+  AdvertisementCache cache(2);
+  cache.Insert("advertisement", GetAdvertisement("5"));
+
+  AdvertisementCache moved = std::move(cache);
+
+  EXPECT_NE(moved.Find("advertisement"), nullptr);
+}
+
+}  // namespace
+}  // namespace presence
+}  // namespace nearby
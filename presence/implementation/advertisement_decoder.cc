@@ -15,16 +15,23 @@
 #include "presence/implementation/advertisement_decoder.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/variant.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/future.h"
 #include "internal/platform/logging.h"
 #include "internal/proto/credential.pb.h"
 #include "presence/data_element.h"
@@ -46,6 +53,14 @@ constexpr int kEncryptedIdentityAdditionalLength =
     kSaltSize + kBaseMetadataSize;
 constexpr int kEddystoneAdditionalLength = 20;
 
+// Bounds the memory used for remembered decryptions. Nearby devices rotate
+// their salts, so the oldest entries are the least likely to be seen again.
+constexpr int kMaxDecryptions = 256;
+
+// Trying a credential takes a few microseconds, so it's only worth handing
+// credentials to other threads in chunks of at least this many.
+constexpr int kMinCredentialsPerDecryptTask = 16;
+
 uint8_t GetDataElementType(uint8_t header) { return header & kDataTypeMask; }
 
 size_t GetDataElementLength(uint8_t header) {
@@ -155,34 +170,8 @@ absl::StatusOr<DataElement> ParseDataElement(const absl::string_view input,
   return DataElement(data_type, input.substr(start, length));
 }
 
-bool Contains(const std::vector<DataElement>& data_elements,
-              const DataElement& data_element) {
-  return std::find(data_elements.begin(), data_elements.end(), data_element) !=
-         data_elements.end();
-}
-
-bool ContainsAll(const std::vector<DataElement>& data_elements,
-                 const std::vector<DataElement>& extended_properties) {
-  for (const auto& filter_element : extended_properties) {
-    if (!Contains(data_elements, filter_element)) {
-      return false;
-    }
-  }
-  return true;
-}
-
-bool ContainsAny(const std::vector<DataElement>& data_elements,
-                 const std::vector<int>& actions) {
-  if (actions.empty()) {
-    return true;
-  }
-  for (int action : actions) {
-    if (Contains(data_elements, DataElement(ActionBit(action)))) {
-      return true;
-    }
-  }
-  return false;
-}
+// The type and value of a data element, as compared by the scan filters.
+using DataElementKey = std::pair<uint16_t, absl::string_view>;
 
 }  // namespace
 
@@ -205,29 +194,87 @@ void AdvertisementDecoder::DecodeBaseAction(
   ActionFactory::DecodeAction(action, decoded_advertisement_.data_elements);
 }
 
+int AdvertisementDecoder::FindDecryptingCredential(
+    const std::vector<internal::SharedCredential>& credentials, int begin,
+    int end, absl::string_view salt, absl::string_view data_elements,
+    const std::atomic<bool>& found, std::string& decrypted) {
+  for (int i = begin; i < end && !found.load(std::memory_order_relaxed); ++i) {
+    const internal::SharedCredential& credential = credentials[i];
+    std::optional<LdtEncryptor> uncached_encryptor;
+    LdtEncryptor* encryptor = nullptr;
+    if (decryptors_ != nullptr) {
+      encryptor = decryptors_->Get(credential);
+    } else {
+      absl::StatusOr<LdtEncryptor> created = LdtEncryptor::Create(
+          credential.key_seed(),
+          credential.metadata_encryption_key_unsigned_adv_tag());
+      if (created.ok()) {
+        encryptor = &uncached_encryptor.emplace(*std::move(created));
+      }
+    }
+    if (encryptor == nullptr) {
+      continue;
+    }
+    absl::StatusOr<std::string> result =
+        encryptor->DecryptAndVerify(data_elements, salt);
+    if (result.ok() && result->size() > kBaseMetadataSize) {
+      decrypted = *std::move(result);
+      return i;
+    }
+  }
+  return -1;
+}
+
 absl::StatusOr<std::string> AdvertisementDecoder::DecryptLdt(
     const std::vector<internal::SharedCredential>& credentials,
     absl::string_view salt, absl::string_view data_elements) {
   if (credentials.empty()) {
     return absl::UnavailableError("No credentials");
   }
-  for (const auto& credential : credentials) {
-    absl::StatusOr<LdtEncryptor> encryptor = LdtEncryptor::Create(
-        credential.key_seed(),
-        credential.metadata_encryption_key_unsigned_adv_tag());
-    if (encryptor.ok()) {
-      absl::StatusOr<std::string> result =
-          encryptor->DecryptAndVerify(data_elements, salt);
-      if (result.ok() && result->size() > kBaseMetadataSize) {
-        decoded_advertisement_.public_credential = credential;
-        decoded_advertisement_.metadata_key =
-            result->substr(0, kBaseMetadataSize);
-        return result->substr(kBaseMetadataSize);
-      }
+  const int size = credentials.size();
+  const int chunks =
+      decrypt_executor_ == nullptr
+          ? 1
+          : std::clamp(size / kMinCredentialsPerDecryptTask, 1,
+                       kMaxParallelDecryptTasks);
+  // The first chunk of credentials is tried on the calling thread, the others
+  // on `decrypt_executor_`. A chunk stops as soon as any chunk has found the
+  // credential, since only one credential can verify the advertisement.
+  std::atomic<bool> found = false;
+  std::vector<std::string> decrypted(chunks);
+  std::vector<Future<int>> matches(chunks - 1);
+  for (int chunk = 1; chunk < chunks; ++chunk) {
+    decrypt_executor_->Submit<int>(
+        [this, &credentials, begin = chunk * size / chunks,
+         end = (chunk + 1) * size / chunks, salt, data_elements, &found,
+         &chunk_decrypted = decrypted[chunk]]() -> ExceptionOr<int> {
+          int match =
+              FindDecryptingCredential(credentials, begin, end, salt,
+                                       data_elements, found, chunk_decrypted);
+          if (match >= 0) found = true;
+          return ExceptionOr<int>(match);
+        },
+        &matches[chunk - 1]);
+  }
+  int match = FindDecryptingCredential(credentials, 0, size / chunks, salt,
+                                       data_elements, found, decrypted[0]);
+  std::string* result = &decrypted[0];
+  if (match >= 0) found = true;
+  // Wait for all chunks, since they reference the arguments.
+  for (int chunk = 1; chunk < chunks; ++chunk) {
+    ExceptionOr<int> chunk_match = matches[chunk - 1].Get();
+    if (match < 0 && chunk_match.ok() && chunk_match.result() >= 0) {
+      match = chunk_match.result();
+      result = &decrypted[chunk];
     }
   }
-  return absl::UnavailableError(
-      "Couldn't decrypt the message with any credentials");
+  if (match < 0) {
+    return absl::UnavailableError(
+        "Couldn't decrypt the message with any credentials");
+  }
+  decoded_advertisement_.public_credential = credentials[match];
+  decoded_advertisement_.metadata_key = result->substr(0, kBaseMetadataSize);
+  return result->substr(kBaseMetadataSize);
 }
 
 absl::Status AdvertisementDecoder::DecryptDataElements(
@@ -267,6 +314,29 @@ absl::Status AdvertisementDecoder::DecryptDataElements(
 
 absl::StatusOr<std::string> AdvertisementDecoder::Decrypt(
     absl::string_view salt, absl::string_view encrypted) {
+  DecryptionKey key = {decoded_advertisement_.identity_type,
+                       absl::StrCat(salt, encrypted)};
+  auto it = decryptions_.find(key);
+  if (it != decryptions_.end()) {
+    decoded_advertisement_.public_credential = it->second.public_credential;
+    decoded_advertisement_.metadata_key = it->second.metadata_key;
+    return it->second.data_elements;
+  }
+  absl::StatusOr<std::string> decrypted =
+      DecryptWithCredentials(salt, encrypted);
+  if (decryptions_.size() >= kMaxDecryptions) {
+    decryptions_.clear();
+  }
+  decryptions_.emplace(
+      std::move(key),
+      Decryption{.public_credential = decoded_advertisement_.public_credential,
+                 .metadata_key = decoded_advertisement_.metadata_key,
+                 .data_elements = decrypted});
+  return decrypted;
+}
+
+absl::StatusOr<std::string> AdvertisementDecoder::DecryptWithCredentials(
+    absl::string_view salt, absl::string_view encrypted) {
   for (const auto& scan_filter : scan_request_.scan_filters) {
     if (!absl::holds_alternative<LegacyPresenceScanFilter>(scan_filter)) {
       continue;
@@ -381,37 +451,53 @@ bool AdvertisementDecoder::MatchesScanFilter(
   if (scan_request_.scan_filters.empty()) {
     return true;
   }
-  for (const auto& filter : scan_request_.scan_filters) {
-    if (absl::holds_alternative<PresenceScanFilter>(filter)) {
-      if (MatchesScanFilter(data_elements,
-                            absl::get<PresenceScanFilter>(filter))) {
-        return true;
-      }
-    } else if (absl::holds_alternative<LegacyPresenceScanFilter>(filter)) {
-      if (MatchesScanFilter(data_elements,
-                            absl::get<LegacyPresenceScanFilter>(filter))) {
-        return true;
-      }
+  // Index the advertisement once, rather than searching it for every action
+  // and extended property of every filter.
+  Actions actions;
+  absl::flat_hash_set<DataElementKey> elements;
+  elements.reserve(data_elements.size());
+  for (const DataElement& element : data_elements) {
+    if (element.GetType() == DataElement::kActionFieldType &&
+        element.GetValue().size() == 1) {
+      actions.set(static_cast<uint8_t>(element.GetValue()[0]));
+    }
+    elements.insert({element.GetType(), element.GetValue()});
+  }
+  for (const CompiledScanFilter& filter : compiled_scan_filters_) {
+    // The advertisement must:
+    // * contain any Action from the filter, if it has some,
+    // * contain all Data Elements in the filter.
+    if (filter.actions.any() && (filter.actions & actions).none()) {
+      continue;
+    }
+    if (std::all_of(filter.extended_properties.begin(),
+                    filter.extended_properties.end(),
+                    [&elements](const DataElement& property) {
+                      return elements.contains(DataElementKey(
+                          property.GetType(), property.GetValue()));
+                    })) {
+      return true;
     }
   }
   return false;
 }
 
-bool AdvertisementDecoder::MatchesScanFilter(
-    const std::vector<DataElement>& data_elements,
-    const PresenceScanFilter& filter) {
-  // The advertisement must contain all Data Elements in scan request.
-  return ContainsAll(data_elements, filter.extended_properties);
-}
-
-bool AdvertisementDecoder::MatchesScanFilter(
-    const std::vector<DataElement>& data_elements,
-    const LegacyPresenceScanFilter& filter) {
-  // The advertisement must:
-  // * contain any Action from scan request,
-  // * contain all Data Elements in scan request.
-  return ContainsAny(data_elements, filter.actions) &&
-         ContainsAll(data_elements, filter.extended_properties);
+void AdvertisementDecoder::CompileScanFilters() {
+  for (const auto& filter : scan_request_.scan_filters) {
+    if (const auto* presence_filter =
+            absl::get_if<PresenceScanFilter>(&filter)) {
+      compiled_scan_filters_.push_back(
+          {.extended_properties = presence_filter->extended_properties});
+    } else if (const auto* legacy_filter =
+                   absl::get_if<LegacyPresenceScanFilter>(&filter)) {
+      CompiledScanFilter compiled = {
+          .extended_properties = legacy_filter->extended_properties};
+      for (int action : legacy_filter->actions) {
+        compiled.actions.set(static_cast<uint8_t>(action));
+      }
+      compiled_scan_filters_.push_back(std::move(compiled));
+    }
+  }
 }
 
 std::vector<CredentialSelector> AdvertisementDecoder::GetCredentialSelectors(
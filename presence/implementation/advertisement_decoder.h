@@ -15,7 +15,10 @@
 #ifndef THIRD_PARTY_NEARBY_PRESENCE_ADVERTISEMENT_DECODER_H_
 #define THIRD_PARTY_NEARBY_PRESENCE_ADVERTISEMENT_DECODER_H_
 
+#include <atomic>
+#include <bitset>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -23,8 +26,10 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "internal/platform/implementation/credential_callbacks.h"
+#include "internal/platform/submittable_executor.h"
 #include "internal/proto/credential.pb.h"
 #include "presence/data_element.h"
+#include "presence/implementation/ldt_decryptor_cache.h"
 #include "presence/scan_request.h"
 
 namespace nearby {
@@ -44,17 +49,33 @@ class AdvertisementDecoder {
  public:
   using IdentityType = ::nearby::internal::IdentityType;
 
+  // The maximum number of chunks the credentials are split into when they are
+  // tried in parallel.
+  static constexpr int kMaxParallelDecryptTasks = 4;
+
+  // `decryptors`, if not null, provides the LDT encryptors of the credentials
+  // and must outlive the decoder. Otherwise, the encryptors are built for
+  // every decoded advertisement.
+  // `decrypt_executor`, if not null, is used to try large sets of credentials
+  // in parallel and must outlive the decoder.
   AdvertisementDecoder(
       ScanRequest scan_request,
       absl::flat_hash_map<IdentityType,
-                          std::vector<internal::SharedCredential>>* credentials)
-      : scan_request_(scan_request), credentials_(credentials) {
+                          std::vector<internal::SharedCredential>>* credentials,
+      LdtDecryptorCache* decryptors = nullptr,
+      SubmittableExecutor* decrypt_executor = nullptr)
+      : scan_request_(scan_request),
+        credentials_(credentials),
+        decryptors_(decryptors),
+        decrypt_executor_(decrypt_executor) {
     AddBannedDataTypes();
+    CompileScanFilters();
   }
 
   explicit AdvertisementDecoder(ScanRequest scan_request)
       : scan_request_(scan_request) {
     AddBannedDataTypes();
+    CompileScanFilters();
   }
 
   static std::vector<CredentialSelector> GetCredentialSelectors(
@@ -74,23 +95,56 @@ class AdvertisementDecoder {
   // Decrypts data elements stored inside encrypted `elem` and appends them to
   // `decoded_advertisement_`.
   absl::Status DecryptDataElements(const DataElement& elem);
+  // Decrypts `encrypted` with the credentials of the scan. Decryptions are
+  // remembered, so an advertisement that is received again, as they are until
+  // the remote device rotates its salt, doesn't try the credentials again.
   absl::StatusOr<std::string> Decrypt(absl::string_view salt,
                                       absl::string_view encrypted);
+  absl::StatusOr<std::string> DecryptWithCredentials(
+      absl::string_view salt, absl::string_view encrypted);
   void DecodeBaseAction(absl::string_view serialized_action);
+  // Returns the index of the first credential in [`begin`, `end`) that
+  // decrypts `data_elements` into `decrypted`, or -1 if there is none or if
+  // `found` is set meanwhile. Safe to call concurrently.
+  int FindDecryptingCredential(
+      const std::vector<internal::SharedCredential>& credentials, int begin,
+      int end, absl::string_view salt, absl::string_view data_elements,
+      const std::atomic<bool>& found, std::string& decrypted);
   absl::StatusOr<std::string> DecryptLdt(
       const std::vector<internal::SharedCredential>& credentials,
       absl::string_view salt, absl::string_view data_elements);
   void AddBannedDataTypes();
-  bool MatchesScanFilter(const std::vector<DataElement>& data_elements,
-                         const PresenceScanFilter& filter);
-  bool MatchesScanFilter(const std::vector<DataElement>& data_elements,
-                         const LegacyPresenceScanFilter& filter);
+  void CompileScanFilters();
+
+  // Action bytes, as in the values of `kActionFieldType` data elements.
+  using Actions = std::bitset<256>;
+  // A scan filter in the form the advertisements are matched against.
+  struct CompiledScanFilter {
+    // Any of these actions, or any advertisement if empty.
+    Actions actions;
+    std::vector<DataElement> extended_properties;
+  };
+
+  // The outcome of decrypting an encrypted identity data element.
+  struct Decryption {
+    absl::StatusOr<internal::SharedCredential> public_credential;
+    std::string metadata_key;
+    absl::StatusOr<std::string> data_elements;
+  };
+  // Decryptions keyed by the identity type and the salt and encrypted bytes
+  // of the identity data element. They are valid for as long as the
+  // credentials don't change, i.e. for the lifetime of this decoder.
+  using DecryptionKey = std::pair<IdentityType, std::string>;
 
   ScanRequest scan_request_;
   absl::flat_hash_map<IdentityType, std::vector<internal::SharedCredential>>*
       credentials_ = nullptr;
+  LdtDecryptorCache* decryptors_ = nullptr;
+  SubmittableExecutor* decrypt_executor_ = nullptr;
   absl::flat_hash_set<int> banned_data_types_;
+  std::vector<CompiledScanFilter> compiled_scan_filters_;
   Advertisement decoded_advertisement_;
+  absl::flat_hash_map<DecryptionKey, Decryption> decryptions_;
 };
 
 }  // namespace presence
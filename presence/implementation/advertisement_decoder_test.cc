@@ -16,6 +16,7 @@
 
 #include <array>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -25,8 +26,10 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/multi_thread_executor.h"
 #include "internal/proto/credential.pb.h"
 #include "presence/data_element.h"
+#include "presence/implementation/ldt_decryptor_cache.h"
 #include "presence/scan_request.h"
 #include "presence/scan_request_builder.h"
 
@@ -37,6 +40,7 @@ namespace {
 using ::nearby::ByteArray;  // NOLINT
 using ::nearby::internal::IdentityType;
 using ::nearby::internal::SharedCredential;  // NOLINT
+using ::protobuf_matchers::EqualsProto;
 using ::testing::ElementsAre;
 using ::testing::Matcher;
 using ::testing::Pointwise;
@@ -184,6 +188,69 @@ TEST(AdvertisementDecoder, DecodeBaseNpProvisionedAdvertisement) {
                                        absl::HexStringToBytes("0A"))));
 }
 
+TEST(AdvertisementDecoder, DecodeRepeatedAdvertisementWithoutDecrypting) {
+  const std::string salt = "AB";
+  ByteArray metadata_key(
+      {205, 104, 63, 225, 161, 209, 248, 70, 84, 61, 10, 19, 212, 174});
+  absl::flat_hash_map<IdentityType, std::vector<internal::SharedCredential>>
+      credentials;
+  credentials[IdentityType::IDENTITY_TYPE_PRIVATE].push_back(
+      GetPublicCredential());
+  AdvertisementDecoder decoder(GetScanRequest(), &credentials);
+  const std::string advertisement =
+      absl::HexStringToBytes("00514142c2c30e79fee14599e36e34d5d42e49fc37b0df");
+  ASSERT_OK(decoder.DecodeAdvertisement(advertisement));
+  // Without credentials, only a remembered decryption can decode it.
+  credentials.clear();
+
+  absl::StatusOr<Advertisement> result =
+      decoder.DecodeAdvertisement(advertisement);
+
+  ASSERT_OK(result);
+  EXPECT_EQ(result->metadata_key, metadata_key.AsStringView());
+  ASSERT_OK(result->public_credential);
+  EXPECT_THAT(*result->public_credential, EqualsProto(GetPublicCredential()));
+  EXPECT_THAT(result->data_elements,
+              ElementsAre(DataElement(DataElement::kSaltFieldType, salt),
+                          DataElement(DataElement::kTxPowerFieldType,
+                                      absl::HexStringToBytes("05")),
+                          DataElement(DataElement::kActionFieldType,
+                                      absl::HexStringToBytes("08"))));
+}
+
+TEST(AdvertisementDecoder, DecodeWithCredentialsTriedInParallel) {
+  const std::string salt = "AB";
+  absl::flat_hash_map<IdentityType, std::vector<internal::SharedCredential>>
+      credentials;
+  std::vector<internal::SharedCredential>& private_credentials =
+      credentials[IdentityType::IDENTITY_TYPE_PRIVATE];
+  for (int i = 0; i < 100; ++i) {
+    SharedCredential credential;
+    credential.set_key_seed(absl::StrCat("seed ", i, std::string(32, '.')));
+    credential.set_metadata_encryption_key_unsigned_adv_tag(
+        std::string(32, '.'));
+    private_credentials.push_back(credential);
+  }
+  private_credentials.push_back(GetPublicCredential());
+  LdtDecryptorCache decryptors;
+  MultiThreadExecutor decrypt_executor(3);
+  AdvertisementDecoder decoder(GetScanRequest(), &credentials, &decryptors,
+                               &decrypt_executor);
+
+  absl::StatusOr<Advertisement> result = decoder.DecodeAdvertisement(
+      absl::HexStringToBytes("00514142c2c30e79fee14599e36e34d5d42e49fc37b0df"));
+
+  ASSERT_OK(result);
+  ASSERT_OK(result->public_credential);
+  EXPECT_THAT(*result->public_credential, EqualsProto(GetPublicCredential()));
+  EXPECT_THAT(result->data_elements,
+              ElementsAre(DataElement(DataElement::kSaltFieldType, salt),
+                          DataElement(DataElement::kTxPowerFieldType,
+                                      absl::HexStringToBytes("05")),
+                          DataElement(DataElement::kActionFieldType,
+                                      absl::HexStringToBytes("08"))));
+}
+
 TEST(AdvertisementDecoder, InvalidEncryptedContent) {
   std::string salt = "AB";
   ByteArray metadata_key(
@@ -201,6 +268,26 @@ TEST(AdvertisementDecoder, InvalidEncryptedContent) {
 
 #endif /*USE_RUST_LDT*/
 
+TEST(AdvertisementDecoder, NoCredentialDecryptsWhenTriedInParallel) {
+  absl::flat_hash_map<IdentityType, std::vector<internal::SharedCredential>>
+      credentials;
+  for (int i = 0; i < 100; ++i) {
+    SharedCredential credential;
+    credential.set_key_seed(absl::StrCat("seed ", i, std::string(32, '.')));
+    credential.set_metadata_encryption_key_unsigned_adv_tag(
+        std::string(32, '.'));
+    credentials[IdentityType::IDENTITY_TYPE_PRIVATE].push_back(credential);
+  }
+  LdtDecryptorCache decryptors;
+  MultiThreadExecutor decrypt_executor(3);
+  AdvertisementDecoder decoder(GetScanRequest(), &credentials, &decryptors,
+                               &decrypt_executor);
+
+  EXPECT_THAT(decoder.DecodeAdvertisement(absl::HexStringToBytes(
+                  "00514142c2c30e79fee14599e36e34d5d42e49fc37b0df")),
+              StatusIs(absl::StatusCode::kUnavailable));
+}
+
 TEST(AdvertisementDecoder, DecodeBaseNpPublicAdvertisement) {
   const std::string salt = "AB";
   AdvertisementDecoder decoder(GetScanRequest());
@@ -401,6 +488,23 @@ TEST(AdvertisementDecoder, MatchesLegacyPresenceScanFilterWithActions) {
   EXPECT_TRUE(decoder.MatchesScanFilter({salt, ttt_action, model_id}));
 }
 
+TEST(AdvertisementDecoder, MatchesLegacyPresenceScanFilterWithOtherAction) {
+  DataElement active_unlock_action =
+      DataElement(ActionBit::kActiveUnlockAction);
+  DataElement ttt_action = DataElement(ActionBit::kTapToTransferAction);
+  LegacyPresenceScanFilter filter = {
+      .actions = {static_cast<int>(ActionBit::kTapToTransferAction)}};
+
+  AdvertisementDecoder decoder(
+      ScanRequestBuilder().AddScanFilter(filter).Build());
+  // The session moves its decoder around.
+  AdvertisementDecoder moved_decoder = std::move(decoder);
+
+  EXPECT_FALSE(moved_decoder.MatchesScanFilter({active_unlock_action}));
+  EXPECT_TRUE(
+      moved_decoder.MatchesScanFilter({active_unlock_action, ttt_action}));
+}
+
 TEST(AdvertisementDecoder, MatchesMultipleFilters) {
   std::vector<DataElement> adv = {
       DataElement(DataElement::kPrivateIdentityFieldType, "payload")};
@@ -14,6 +14,8 @@
 
 #include "presence/implementation/advertisement_factory.h"
 
+#include <algorithm>
+#include <array>
 #include <string>
 #include <utility>
 #include <vector>
@@ -50,19 +52,47 @@ absl::StatusOr<uint8_t> CreateDataElementHeader(size_t length,
   return (length << DataElement::kDataElementLengthShift) | data_type;
 }
 
-absl::Status AppendDataElement(unsigned data_type,
-                               absl::string_view data_element,
-                               std::string& output) {
-  auto header = CreateDataElementHeader(data_element.size(), data_type);
-  if (!header.ok()) {
-    NEARBY_LOG(WARNING, "Can't add Data element type: %d, length: %d",
-               data_type, data_element.size());
-    return header.status();
-  }
-  output.push_back(*header);
-  output.insert(output.end(), data_element.begin(), data_element.end());
-  return absl::OkStatus();
-}
+// Serializes an advertisement into a buffer on the stack. Legacy BLE
+// advertisements are too small to be worth a heap allocation per field.
+class AdvertisementBuffer {
+ public:
+  absl::Status Append(absl::string_view bytes) {
+    if (bytes.size() > buffer_.size() - size_) {
+      return absl::OutOfRangeError(absl::StrFormat(
+          "Advertisement is longer than %d bytes", buffer_.size()));
+    }
+    std::copy(bytes.begin(), bytes.end(), buffer_.begin() + size_);
+    size_ += bytes.size();
+    return absl::OkStatus();
+  }
+
+  absl::Status AppendByte(uint8_t byte) {
+    return Append(absl::string_view(reinterpret_cast<const char*>(&byte), 1));
+  }
+
+  absl::Status AppendDataElement(unsigned data_type,
+                                 absl::string_view data_element) {
+    auto header = CreateDataElementHeader(data_element.size(), data_type);
+    if (!header.ok()) {
+      NEARBY_LOG(WARNING, "Can't add Data element type: %d, length: %d",
+                 data_type, data_element.size());
+      return header.status();
+    }
+    absl::Status result = AppendByte(*header);
+    if (!result.ok()) {
+      return result;
+    }
+    return Append(data_element);
+  }
+
+  absl::string_view data() const {
+    return absl::string_view(buffer_.data(), size_);
+  }
+
+ private:
+  std::array<char, kMaxBaseNpAdvSize> buffer_;
+  size_t size_ = 0;
+};
 
 uint8_t GetIdentityFieldType(IdentityType type) {
   switch (type) {
@@ -117,10 +147,11 @@ AdvertisementFactory::CreateBaseNpAdvertisement(
     absl::optional<LocalCredential> credential) const {
   const auto& presence =
       absl::get<BaseBroadcastRequest::BasePresence>(request.variant);
-  std::string payload;
-  payload.reserve(kMaxBaseNpAdvSize);
-  payload.push_back(kBaseVersion);
-  absl::Status result;
+  AdvertisementBuffer payload;
+  absl::Status result = payload.AppendByte(kBaseVersion);
+  if (!result.ok()) {
+    return result;
+  }
   std::string tx_power = {static_cast<char>(request.tx_power)};
   std::string action = SerializeAction(presence.action);
   uint8_t identity_type =
@@ -135,21 +166,20 @@ AdvertisementFactory::CreateBaseNpAdvertisement(
     if (!credential) {
       return absl::FailedPreconditionError("Missing credentials");
     }
-    std::string unencrypted;
-    result = AppendDataElement(DataElement::kTxPowerFieldType, tx_power,
-                               unencrypted);
+    AdvertisementBuffer unencrypted;
+    result =
+        unencrypted.AppendDataElement(DataElement::kTxPowerFieldType, tx_power);
     if (!result.ok()) {
       return result;
     }
-    result =
-        AppendDataElement(DataElement::kActionFieldType, action, unencrypted);
+    result = unencrypted.AppendDataElement(DataElement::kActionFieldType, action);
     if (!result.ok()) {
       return result;
     }
     NEARBY_LOGS(VERBOSE) << "Unencrypted advertisement payload "
-                         << absl::BytesToHexString(unencrypted);
+                         << absl::BytesToHexString(unencrypted.data());
     absl::StatusOr<std::string> encrypted =
-        EncryptDataElements(*credential, request.salt, unencrypted);
+        EncryptDataElements(*credential, request.salt, unencrypted.data());
     if (!encrypted.ok()) {
       return encrypted.status();
     }
@@ -166,34 +196,42 @@ AdvertisementFactory::CreateBaseNpAdvertisement(
     if (!identity_header.ok()) {
       return identity_header.status();
     }
-    payload.push_back(*identity_header);
+    result = payload.AppendByte(*identity_header);
+    if (!result.ok()) {
+      return result;
+    }
     // In the encrypted format, salt is not a DE (thus no header)
-    payload.append(request.salt);
-    payload.append(*encrypted);
+    result = payload.Append(request.salt);
+    if (!result.ok()) {
+      return result;
+    }
+    result = payload.Append(*encrypted);
+    if (!result.ok()) {
+      return result;
+    }
   } else {
-    result = AppendDataElement(identity_type, "", payload);
+    result = payload.AppendDataElement(identity_type, "");
     if (!result.ok()) {
       return result;
     }
     if (!request.salt.empty()) {
       result =
-          AppendDataElement(DataElement::kSaltFieldType, request.salt, payload);
+          payload.AppendDataElement(DataElement::kSaltFieldType, request.salt);
       if (!result.ok()) {
         return result;
       }
     }
-    result =
-        AppendDataElement(DataElement::kTxPowerFieldType, tx_power, payload);
+    result = payload.AppendDataElement(DataElement::kTxPowerFieldType, tx_power);
     if (!result.ok()) {
       return result;
     }
-    result = AppendDataElement(DataElement::kActionFieldType, action, payload);
+    result = payload.AppendDataElement(DataElement::kActionFieldType, action);
     if (!result.ok()) {
       return result;
     }
   }
   return AdvertisementData{.is_extended_advertisement = false,
-                           .content = payload};
+                           .content = std::string(payload.data())};
 }
 absl::StatusOr<std::string> AdvertisementFactory::EncryptDataElements(
     const LocalCredential& credential, absl::string_view salt,
@@ -204,15 +242,30 @@ absl::StatusOr<std::string> AdvertisementFactory::EncryptDataElements(
         credential.metadata_encryption_key_v0().size(), kBaseMetadataSize));
   }
 
-  // HMAC is not used during encryption, so we can pass an empty value.
-  absl::StatusOr<LdtEncryptor> encryptor =
-      LdtEncryptor::Create(credential.key_seed(), /*known_hmac=*/"");
-  if (!encryptor.ok()) {
-    return encryptor.status();
+  auto it = encryptors_.find(credential.key_seed());
+  if (it == encryptors_.end()) {
+    // HMAC is not used during encryption, so we can pass an empty value.
+    absl::StatusOr<LdtEncryptor> encryptor =
+        LdtEncryptor::Create(credential.key_seed(), /*known_hmac=*/"");
+    if (!encryptor.ok()) {
+      return encryptor.status();
+    }
+    if (encryptors_.size() >= kMaxCachedEncryptors) {
+      encryptors_.clear();
+    }
+    it = encryptors_.emplace(credential.key_seed(), *std::move(encryptor))
+             .first;
+  }
+  AdvertisementBuffer plaintext;
+  absl::Status result = plaintext.Append(credential.metadata_encryption_key_v0());
+  if (!result.ok()) {
+    return result;
+  }
+  result = plaintext.Append(data_elements);
+  if (!result.ok()) {
+    return result;
   }
-  std::string plaintext =
-      absl::StrCat(credential.metadata_encryption_key_v0(), data_elements);
-  return encryptor->Encrypt(plaintext, salt);
+  return it->second.Encrypt(plaintext.data(), salt);
 }
 
 absl::StatusOr<CredentialSelector> AdvertisementFactory::GetCredentialSelector(
@@ -18,15 +18,21 @@
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "internal/proto/credential.pb.h"
 #include "presence/implementation/base_broadcast_request.h"
+#include "presence/implementation/ldt.h"
 #include "presence/implementation/mediums/advertisement_data.h"
 
 namespace nearby {
 namespace presence {
 
 // Builds BLE advertisements from broadcast requests.
+//
+// Keeps the LDT encryptors of the credentials it encrypted advertisements
+// with, so that advertising again with the same credential, e.g. with another
+// salt, doesn't derive the LDT keys again. Not thread-safe.
 class AdvertisementFactory {
  public:
   using LocalCredential = internal::LocalCredential;
@@ -47,12 +53,18 @@ class AdvertisementFactory {
   }
 
  private:
+  // A device only broadcasts with its current credentials.
+  static constexpr int kMaxCachedEncryptors = 8;
+
   absl::StatusOr<AdvertisementData> CreateBaseNpAdvertisement(
       const BaseBroadcastRequest& request,
       absl::optional<LocalCredential> credential) const;
   absl::StatusOr<std::string> EncryptDataElements(
       const LocalCredential& credential, absl::string_view salt,
       absl::string_view data_elements) const;
+
+  // Encryptors by key seed.
+  mutable absl::flat_hash_map<std::string, LdtEncryptor> encryptors_;
 };
 
 }  // namespace presence
@@ -81,6 +81,32 @@ TEST(AdvertisementFactory, CreateAdvertisementFromPrivateIdentity) {
             "00514142c2c30e79fee14599e36e34d5d42e49fc37b0df");
 }
 
+TEST(AdvertisementFactory, CreateAdvertisementWithAnotherSalt) {
+  constexpr IdentityType kIdentity = IdentityType::IDENTITY_TYPE_PRIVATE;
+  std::vector<DataElement> data_elements;
+  data_elements.emplace_back(ActionBit::kActiveUnlockAction);
+  Action action = ActionFactory::CreateAction(data_elements);
+  BaseBroadcastRequest request =
+      BaseBroadcastRequest(BasePresenceRequestBuilder(kIdentity)
+                               .SetAccountName("Test account")
+                               .SetSalt("CD")
+                               .SetTxPower(5)
+                               .SetAction(action));
+  AdvertisementFactory factory;
+
+  absl::StatusOr<AdvertisementData> first =
+      factory.CreateAdvertisement(request, CreateLocalCredential(kIdentity));
+  request.salt = "AB";
+  absl::StatusOr<AdvertisementData> second =
+      factory.CreateAdvertisement(request, CreateLocalCredential(kIdentity));
+
+  ASSERT_OK(first);
+  ASSERT_OK(second);
+  EXPECT_NE(first->content, second->content);
+  EXPECT_EQ(absl::BytesToHexString(second->content),
+            "00514142c2c30e79fee14599e36e34d5d42e49fc37b0df");
+}
+
 TEST(AdvertisementFactory, CreateAdvertisementFromTrustedIdentity) {
   std::string account_name = "Test account";
   std::string salt = "AB";
@@ -177,10 +177,25 @@ absl::optional<LocalCredential> BroadcastManager::Advertise(
     NEARBY_LOGS(INFO) << "Broadcast session terminated, id: " << id;
     return absl::optional<LocalCredential>();
   }
+  absl::optional<MultiplexKey> multiplex_key =
+      GetMultiplexKey(broadcast_request, it->second.GetPowerMode());
+  if (multiplex_key) {
+    auto multiplex = multiplexes_.find(*multiplex_key);
+    if (multiplex != multiplexes_.end() &&
+        JoinMultiplex(id,
+                      absl::get<BaseBroadcastRequest::BasePresence>(
+                          broadcast_request.variant)
+                          .action,
+                      it->second.GetPowerMode(), multiplex->second)) {
+      multiplexed_sessions_.insert({id, *multiplex_key});
+      // The salt of the multiplex was consumed when it started.
+      return absl::optional<LocalCredential>();
+    }
+  }
   absl::optional<LocalCredential> credential =
       SelectCredential(broadcast_request, std::move(credentials));
   absl::StatusOr<AdvertisementData> advertisement =
-      AdvertisementFactory().CreateAdvertisement(broadcast_request, credential);
+      advertisement_factory_.CreateAdvertisement(broadcast_request, credential);
   if (!advertisement.ok()) {
     NEARBY_LOGS(WARNING) << "Can't create advertisement, reason: "
                          << advertisement.status();
@@ -199,10 +214,140 @@ absl::optional<LocalCredential> BroadcastManager::Advertise(
                               absl::InternalError("Can't start advertising"));
     return absl::optional<LocalCredential>();
   }
-  it->second.SetAdvertisingSession(std::move(session));
+  if (multiplex_key && !multiplexes_.contains(*multiplex_key)) {
+    Multiplex multiplex{.request = broadcast_request,
+                        .credential = credential,
+                        .advertisement = *std::move(advertisement),
+                        .advertising_session = std::move(session)};
+    multiplex.actions.insert(
+        {id, absl::get<BaseBroadcastRequest::BasePresence>(
+                 broadcast_request.variant)
+                 .action});
+    multiplexes_.insert({*multiplex_key, std::move(multiplex)});
+    multiplexed_sessions_.insert({id, *multiplex_key});
+  } else {
+    it->second.SetAdvertisingSession(std::move(session));
+  }
   return credential;
 }
 
+absl::optional<BroadcastManager::MultiplexKey>
+BroadcastManager::GetMultiplexKey(const BaseBroadcastRequest& broadcast_request,
+                                  PowerMode power_mode) {
+  if (!absl::holds_alternative<BaseBroadcastRequest::BasePresence>(
+          broadcast_request.variant)) {
+    return absl::optional<MultiplexKey>();
+  }
+  const CredentialSelector& selector =
+      absl::get<BaseBroadcastRequest::BasePresence>(broadcast_request.variant)
+          .credential_selector;
+  MultiplexKey key{.identity_type = selector.identity_type,
+                   .tx_power = broadcast_request.tx_power,
+                   .power_mode = power_mode};
+  if (AdvertisementFactory::GetCredentialSelector(broadcast_request).ok()) {
+    key.manager_app_id = selector.manager_app_id;
+    key.account_name = selector.account_name;
+  }
+  return key;
+}
+
+bool BroadcastManager::JoinMultiplex(BroadcastSessionId id, Action action,
+                                     PowerMode power_mode,
+                                     Multiplex& multiplex) {
+  BaseBroadcastRequest request = multiplex.request;
+  Action& merged =
+      absl::get<BaseBroadcastRequest::BasePresence>(request.variant).action;
+  merged.action = action.action;
+  for (const auto& [unused, member_action] : multiplex.actions) {
+    merged.action |= member_action.action;
+  }
+  absl::StatusOr<AdvertisementData> advertisement =
+      advertisement_factory_.CreateAdvertisement(request,
+                                                 multiplex.credential);
+  if (!advertisement.ok()) {
+    NEARBY_LOGS(INFO) << "Can't merge broadcast session " << id
+                      << ", reason: " << advertisement.status();
+    return false;
+  }
+  if (!Readvertise(multiplex, *std::move(advertisement), power_mode, id)) {
+    // Bring back the advertisement of the other sessions.
+    Readvertise(multiplex, multiplex.advertisement, power_mode,
+                absl::optional<BroadcastSessionId>());
+    return false;
+  }
+  multiplex.actions.insert({id, action});
+  return true;
+}
+
+bool BroadcastManager::LeaveMultiplex(BroadcastSessionId id) {
+  auto key = multiplexed_sessions_.find(id);
+  if (key == multiplexed_sessions_.end()) {
+    return false;
+  }
+  auto it = multiplexes_.find(key->second);
+  PowerMode power_mode = key->second.power_mode;
+  multiplexed_sessions_.erase(key);
+  if (it == multiplexes_.end()) {
+    return true;
+  }
+  Multiplex& multiplex = it->second;
+  multiplex.actions.erase(id);
+  if (multiplex.actions.empty()) {
+    if (multiplex.advertising_session) {
+      absl::Status status = multiplex.advertising_session->stop_advertising();
+      if (!status.ok()) {
+        NEARBY_LOGS(WARNING) << "StopAdvertising error: " << status;
+      }
+    }
+    multiplexes_.erase(it);
+    return true;
+  }
+  BaseBroadcastRequest request = multiplex.request;
+  Action& merged =
+      absl::get<BaseBroadcastRequest::BasePresence>(request.variant).action;
+  merged.action = 0;
+  for (const auto& [unused, member_action] : multiplex.actions) {
+    merged.action |= member_action.action;
+  }
+  absl::StatusOr<AdvertisementData> advertisement =
+      advertisement_factory_.CreateAdvertisement(request,
+                                                 multiplex.credential);
+  if (advertisement.ok()) {
+    Readvertise(multiplex, *std::move(advertisement), power_mode,
+                absl::optional<BroadcastSessionId>());
+  }
+  return true;
+}
+
+bool BroadcastManager::Readvertise(Multiplex& multiplex,
+                                   AdvertisementData advertisement,
+                                   PowerMode power_mode,
+                                   absl::optional<BroadcastSessionId> id) {
+  if (multiplex.advertising_session) {
+    absl::Status status = multiplex.advertising_session->stop_advertising();
+    if (!status.ok()) {
+      NEARBY_LOGS(WARNING) << "StopAdvertising error: " << status;
+    }
+    multiplex.advertising_session.reset();
+  }
+  multiplex.advertising_session = mediums_->GetBle().StartAdvertising(
+      advertisement, power_mode,
+      AdvertisingCallback{
+          .start_advertising_result = [this, id](absl::Status status) {
+            if (id) {
+              NotifyStartCallbackStatus(*id, status);
+            } else if (!status.ok()) {
+              NEARBY_LOGS(WARNING)
+                  << "Can't restart multiplexed advertisement: " << status;
+            }
+          }});
+  if (!multiplex.advertising_session) {
+    return false;
+  }
+  multiplex.advertisement = std::move(advertisement);
+  return true;
+}
+
 void BroadcastManager::NotifyStartCallbackStatus(BroadcastSessionId id,
                                                  absl::Status status) {
   RunOnServiceControllerThread("started-broadcast-cb",
@@ -215,6 +360,7 @@ void BroadcastManager::NotifyStartCallbackStatus(BroadcastSessionId id,
                                      it->second.CallStartedCallback(status);
                                      if (!status.ok()) {
                                        // Delete failed session.
+                                       LeaveMultiplex(id);
                                        sessions_.erase(it);
                                      }
                                    });
@@ -229,7 +375,9 @@ void BroadcastManager::StopBroadcast(BroadcastSessionId id) {
               << absl::StrFormat("BroadcastSession(0x%x) not found", id);
           return;
         }
-        it->second.StopAdvertising();
+        if (!LeaveMultiplex(id)) {
+          it->second.StopAdvertising();
+        }
         sessions_.erase(it);
       });
 }
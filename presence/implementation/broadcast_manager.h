@@ -21,15 +21,19 @@
 #include <vector>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 #include "internal/platform/single_thread_executor.h"
 #include "internal/proto/credential.pb.h"
 #include "presence/broadcast_request.h"
 #include "presence/data_types.h"
+#include "presence/implementation/advertisement_factory.h"
 #include "presence/implementation/base_broadcast_request.h"
 #include "presence/implementation/credential_manager.h"
+#include "presence/implementation/mediums/advertisement_data.h"
 #include "presence/implementation/mediums/mediums.h"
+#include "presence/power_mode.h"
 
 namespace nearby {
 namespace presence {
@@ -76,6 +80,55 @@ class BroadcastManager {
     PowerMode power_mode_;
     std::unique_ptr<AdvertisingSession> advertising_session_;
   };
+  // Identifies the Presence sessions whose advertisements can be merged into
+  // one: their advertisements only differ in their actions.
+  struct MultiplexKey {
+    internal::IdentityType identity_type;
+    // Only set for identities encrypted with a local credential.
+    std::string manager_app_id;
+    std::string account_name;
+    int8_t tx_power;
+    PowerMode power_mode;
+
+    template <typename H>
+    friend H AbslHashValue(H h, const MultiplexKey& key) {
+      return H::combine(std::move(h), key.identity_type, key.manager_app_id,
+                        key.account_name, key.tx_power, key.power_mode);
+    }
+    friend bool operator==(const MultiplexKey& a, const MultiplexKey& b) {
+      return a.identity_type == b.identity_type &&
+             a.manager_app_id == b.manager_app_id &&
+             a.account_name == b.account_name && a.tx_power == b.tx_power &&
+             a.power_mode == b.power_mode;
+    }
+  };
+  // One advertisement carrying the actions of several sessions, so that they
+  // take a single advertising set of the BLE controller.
+  struct Multiplex {
+    // The request of the session that started the advertisement.
+    BaseBroadcastRequest request;
+    absl::optional<LocalCredential> credential;
+    absl::flat_hash_map<BroadcastSessionId, Action> actions;
+    AdvertisementData advertisement;
+    std::unique_ptr<AdvertisingSession> advertising_session;
+  };
+  static absl::optional<MultiplexKey> GetMultiplexKey(
+      const BaseBroadcastRequest& broadcast_request, PowerMode power_mode);
+  // Adds session `id` to the advertisement of `multiplex`. Returns false if
+  // the session has to advertise on its own.
+  bool JoinMultiplex(BroadcastSessionId id, Action action,
+                     PowerMode power_mode, Multiplex& multiplex)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_);
+  // Removes session `id` from its multiplex, if any. Returns false if the
+  // session isn't multiplexed.
+  bool LeaveMultiplex(BroadcastSessionId id)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_);
+  // Replaces the advertisement of `multiplex`. `id` is the session told
+  // whether the advertisement started.
+  bool Readvertise(Multiplex& multiplex, AdvertisementData advertisement,
+                   PowerMode power_mode, absl::optional<BroadcastSessionId> id)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_);
+
   BroadcastSessionId GenerateBroadcastSessionId();
   void NotifyStartCallbackStatus(BroadcastSessionId id, absl::Status status);
   void RunOnServiceControllerThread(absl::string_view name, Runnable runnable) {
@@ -97,6 +150,11 @@ class BroadcastManager {
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_);
   absl::flat_hash_map<BroadcastSessionId, BroadcastSessionState> sessions_
       ABSL_GUARDED_BY(*executor_);
+  AdvertisementFactory advertisement_factory_ ABSL_GUARDED_BY(*executor_);
+  absl::flat_hash_map<MultiplexKey, Multiplex> multiplexes_
+      ABSL_GUARDED_BY(*executor_);
+  absl::flat_hash_map<BroadcastSessionId, MultiplexKey> multiplexed_sessions_
+      ABSL_GUARDED_BY(*executor_);
 };
 
 }  // namespace presence
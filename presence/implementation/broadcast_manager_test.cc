@@ -130,6 +130,31 @@ TEST_P(BroadcastManagerTest, StartAndStopBroadcast) {
   EXPECT_FALSE(IsAdvertising());
 }
 
+TEST_P(BroadcastManagerTest, BroadcastsShareAdvertisement) {
+  nearby::Future<absl::Status> second_status;
+  absl::StatusOr<BroadcastSessionId> first =
+      broadcast_manager_.StartBroadcast(
+          CreateBroadcastRequest(internal::IDENTITY_TYPE_PUBLIC),
+          CreateBroadcastCallback());
+  ASSERT_OK(first);
+  EXPECT_OK(start_broadcast_status_.Get().GetResult());
+  absl::StatusOr<BroadcastSessionId> second =
+      broadcast_manager_.StartBroadcast(
+          CreateBroadcastRequest(internal::IDENTITY_TYPE_PUBLIC),
+          {.start_broadcast_cb = [&](absl::Status status) {
+            second_status.Set(status);
+          }});
+  ASSERT_OK(second);
+  EXPECT_OK(second_status.Get().GetResult());
+  EXPECT_TRUE(IsAdvertising());
+
+  broadcast_manager_.StopBroadcast(*first);
+  EXPECT_TRUE(IsAdvertising());
+
+  broadcast_manager_.StopBroadcast(*second);
+  EXPECT_FALSE(IsAdvertising());
+}
+
 TEST_P(BroadcastManagerTest, StopBroadcastTwiceNoSideEffects) {
   absl::StatusOr<BroadcastSessionId> session =
       broadcast_manager_.StartBroadcast(
@@ -15,10 +15,12 @@
 #ifndef THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_CREDENTIAL_MANAGER_H_
 #define THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_CREDENTIAL_MANAGER_H_
 
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <vector>
 
+#include "absl/functional/any_invocable.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "internal/platform/implementation/credential_callbacks.h"
@@ -30,6 +32,25 @@ namespace presence {
 
 using SubscriberId = uint64_t;
 
+// What changed in the public credentials a subscriber is subscribed for, see
+// `CredentialManager::SubscribeForPublicCredentialUpdates()`. Credentials are
+// identified by their secret id.
+struct PublicCredentialsUpdate {
+  // Increases by one with every update delivered to the subscriber. The first
+  // update, with generation 1, carries all credentials in `added`.
+  uint64_t generation = 0;
+  // Credentials the subscriber hasn't been told about yet.
+  std::vector<nearby::internal::SharedCredential> added;
+  // New versions of credentials the subscriber has been told about.
+  std::vector<nearby::internal::SharedCredential> updated;
+  // Credentials that are gone, as the subscriber was last told about them.
+  std::vector<nearby::internal::SharedCredential> removed;
+};
+
+struct PublicCredentialsUpdateCallback {
+  absl::AnyInvocable<void(PublicCredentialsUpdate)> credentials_updated_cb;
+};
+
 /*
  * The instance of CredentialManager is owned by {@code ServiceControllerImpl}.
  * Helping service controller to manage local credentials and coordinate with
@@ -85,6 +106,14 @@ class CredentialManager {
       PublicCredentialType public_credential_type,
       GetPublicCredentialsResultCallback callback) = 0;
 
+  // Like `SubscribeForPublicCredentials()`, but the `callback` is only given
+  // what changed since it was last called, and isn't called when nothing did.
+  // Unsubscribe with `UnsubscribeFromPublicCredentials()`.
+  virtual SubscriberId SubscribeForPublicCredentialUpdates(
+      const CredentialSelector& credential_selector,
+      PublicCredentialType public_credential_type,
+      PublicCredentialsUpdateCallback callback) = 0;
+
   // Unsubscribes from public credentials updates. No new callbacks will be
   // triggered after this function returns. If there is a callback already
   // running, that callback may continue after
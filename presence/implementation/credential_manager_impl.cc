@@ -15,6 +15,7 @@
 #include "presence/implementation/credential_manager_impl.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <limits>
 #include <memory>
@@ -22,6 +23,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
@@ -82,6 +84,13 @@ void CredentialManagerImpl::GenerateCredentials(
     const std::vector<IdentityType>& identity_types,
     int credential_life_cycle_days, int contiguous_copy_of_credentials,
     GenerateCredentialsResultCallback credentials_generated_cb) {
+  if (generation_executor_ && !identity_types.empty() &&
+      contiguous_copy_of_credentials > 0) {
+    GenerateCredentialsInBackground(
+        metadata, manager_app_id, identity_types, credential_life_cycle_days,
+        contiguous_copy_of_credentials, std::move(credentials_generated_cb));
+    return;
+  }
   std::vector<SharedCredential> public_credentials;
   std::vector<LocalCredential> private_credentials;
 
@@ -100,16 +109,87 @@ void CredentialManagerImpl::GenerateCredentials(
     }
   }
 
+  SaveGeneratedCredentials(manager_app_id, metadata.account_name(),
+                           private_credentials, public_credentials,
+                           std::move(credentials_generated_cb));
+}
+
+void CredentialManagerImpl::GenerateCredentialsInBackground(
+    const Metadata& metadata, absl::string_view manager_app_id,
+    const std::vector<IdentityType>& identity_types,
+    int credential_life_cycle_days, int contiguous_copy_of_credentials,
+    GenerateCredentialsResultCallback credentials_generated_cb) {
+  struct Generation {
+    Metadata metadata;
+    std::string manager_app_id;
+    GenerateCredentialsResultCallback callback;
+    // In the order GenerateCredentials() returns them.
+    std::vector<std::pair<LocalCredential, SharedCredential>> credentials;
+    std::atomic<int> remaining;
+  };
+  const int count = identity_types.size() * contiguous_copy_of_credentials;
+  auto generation = std::make_shared<Generation>();
+  generation->metadata = metadata;
+  generation->manager_app_id = std::string(manager_app_id);
+  generation->callback = std::move(credentials_generated_cb);
+  generation->credentials.resize(count);
+  generation->remaining = count;
+
+  const absl::Time now = SystemClock::ElapsedRealtime();
+  const absl::Duration gap = credential_life_cycle_days * absl::Hours(24);
+  // One task per credential, so that the credentials in use right now are
+  // generated before the ones for the following days.
+  for (int index = 0; index < contiguous_copy_of_credentials; index++) {
+    for (int type = 0; type < identity_types.size(); type++) {
+      const int slot = type * contiguous_copy_of_credentials + index;
+      absl::Time start_time = now + index * gap;
+      generation_executor_->Execute(
+          [this, generation, slot, identity_type = identity_types[type],
+           start_time, end_time = start_time + gap]() {
+            generation->credentials[slot] = CreateLocalCredential(
+                generation->metadata, identity_type, start_time, end_time);
+            if (--generation->remaining > 0) return;
+            RunOnServiceControllerThread(
+                "save-generated-creds", [this, generation]() {
+                  std::vector<LocalCredential> private_credentials;
+                  std::vector<SharedCredential> public_credentials;
+                  for (auto& credentials : generation->credentials) {
+                    if (credentials.second.identity_type() ==
+                        IdentityType::IDENTITY_TYPE_UNSPECIFIED) {
+                      continue;
+                    }
+                    private_credentials.push_back(
+                        std::move(credentials.first));
+                    public_credentials.push_back(
+                        std::move(credentials.second));
+                  }
+                  SaveGeneratedCredentials(
+                      generation->manager_app_id,
+                      generation->metadata.account_name(),
+                      private_credentials, public_credentials,
+                      std::move(generation->callback));
+                });
+          });
+    }
+  }
+}
+
+void CredentialManagerImpl::SaveGeneratedCredentials(
+    absl::string_view manager_app_id, absl::string_view account_name,
+    const std::vector<LocalCredential>& private_credentials,
+    const std::vector<SharedCredential>& public_credentials,
+    GenerateCredentialsResultCallback credentials_generated_cb) {
   // Create credential_storage object and invoke SaveCredentials.
   credential_storage_ptr_->SaveCredentials(
-      manager_app_id, metadata.account_name(), private_credentials,
+      manager_app_id, account_name, private_credentials,
       public_credentials, PublicCredentialType::kLocalPublicCredential,
       SaveCredentialsResultCallback{
           .credentials_saved_cb =
               [this, manager_app_id = std::string(manager_app_id),
-               account_name = metadata.account_name(),
+               account_name = std::string(account_name),
                callback = std::move(credentials_generated_cb),
-               public_credentials](absl::Status status) mutable {
+               public_credentials](
+                  absl::Status status) mutable {
                 if (!status.ok()) {
                   NEARBY_LOGS(WARNING)
                       << "Save credentials failed with: " << status;
@@ -372,7 +452,25 @@ SubscriberId CredentialManagerImpl::SubscribeForPublicCredentials(
       [this, key = SubscriberKey{credential_selector, public_credential_type},
        id, callback = std::move(callback)]()
           ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_) mutable {
-            AddSubscriber(key, id, std::move(callback));
+            AddSubscriber(key, Subscriber(id, std::move(callback)));
+          });
+  GetPublicCredentials(credential_selector, public_credential_type,
+                       CreateNotifySubscribersCallback(
+                           {credential_selector, public_credential_type}));
+  return id;
+}
+
+SubscriberId CredentialManagerImpl::SubscribeForPublicCredentialUpdates(
+    const CredentialSelector& credential_selector,
+    PublicCredentialType public_credential_type,
+    PublicCredentialsUpdateCallback callback) {
+  SubscriberId id = nearby::RandData<SubscriberId>();
+  RunOnServiceControllerThread(
+      "add-update-subscriber",
+      [this, key = SubscriberKey{credential_selector, public_credential_type},
+       id, callback = std::move(callback)]()
+          ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_) mutable {
+            AddSubscriber(key, Subscriber(id, std::move(callback)));
           });
   GetPublicCredentials(credential_selector, public_credential_type,
                        CreateNotifySubscribersCallback(
@@ -386,10 +484,9 @@ void CredentialManagerImpl::UnsubscribeFromPublicCredentials(SubscriberId id) {
                                    *executor_) { RemoveSubscriber(id); });
 }
 
-void CredentialManagerImpl::AddSubscriber(
-    SubscriberKey key, SubscriberId id,
-    GetPublicCredentialsResultCallback callback) {
-  subscribers_[key].push_back(Subscriber(id, std::move(callback)));
+void CredentialManagerImpl::AddSubscriber(SubscriberKey key,
+                                          Subscriber subscriber) {
+  subscribers_[key].push_back(std::move(subscriber));
 }
 
 void CredentialManagerImpl::RemoveSubscriber(SubscriberId id) {
@@ -483,9 +580,48 @@ void CredentialManagerImpl::NotifySubscribers(
 
 void CredentialManagerImpl::Subscriber::NotifyCredentialsFetched(
     std::vector<SharedCredential>& credentials) {
+  if (update_callback_.credentials_updated_cb) {
+    NotifyCredentialsUpdated(credentials);
+    return;
+  }
   callback_.credentials_fetched_cb(credentials);
 }
 
+void CredentialManagerImpl::Subscriber::NotifyCredentialsUpdated(
+    const std::vector<SharedCredential>& credentials) {
+  PublicCredentialsUpdate update;
+  absl::flat_hash_map<std::string, SharedCredential> previous_credentials =
+      std::move(known_credentials_);
+  known_credentials_.clear();
+  for (const SharedCredential& credential : credentials) {
+    auto [it, inserted] =
+        known_credentials_.emplace(credential.secret_id(), credential);
+    if (!inserted) {
+      // Only the first of credentials sharing a secret id is kept.
+      continue;
+    }
+    auto previous = previous_credentials.find(credential.secret_id());
+    if (previous == previous_credentials.end()) {
+      update.added.push_back(credential);
+    } else {
+      if (previous->second.SerializeAsString() !=
+          credential.SerializeAsString()) {
+        update.updated.push_back(credential);
+      }
+      previous_credentials.erase(previous);
+    }
+  }
+  for (auto& [secret_id, credential] : previous_credentials) {
+    update.removed.push_back(std::move(credential));
+  }
+  if (generation_ > 0 && update.added.empty() && update.updated.empty() &&
+      update.removed.empty()) {
+    return;
+  }
+  update.generation = ++generation_;
+  update_callback_.credentials_updated_cb(std::move(update));
+}
+
 void CredentialManagerImpl::UpdateLocalCredential(
     const CredentialSelector& credential_selector,
     nearby::internal::LocalCredential credential,
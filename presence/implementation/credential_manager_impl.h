@@ -16,6 +16,7 @@
 #define THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_CREDENTIAL_MANAGER_IMPL_H_
 
 #include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
@@ -28,6 +29,7 @@
 #include "absl/time/time.h"
 #include "internal/platform/credential_storage_impl.h"
 #include "internal/platform/implementation/credential_callbacks.h"
+#include "internal/platform/multi_thread_executor.h"
 #include "internal/platform/runnable.h"
 #include "internal/platform/single_thread_executor.h"
 #include "internal/proto/credential.pb.h"
@@ -47,6 +49,15 @@ class CredentialManagerImpl : public CredentialManager {
     credential_storage_ptr_ = std::make_unique<nearby::CredentialStorageImpl>();
   }
 
+  // Generates credentials on `generation_threads` threads of its own rather
+  // than on the calling thread, so GenerateCredentials() returns before the
+  // credentials are generated.
+  CredentialManagerImpl(SingleThreadExecutor* executor, int generation_threads)
+      : CredentialManagerImpl(executor) {
+    generation_executor_ =
+        std::make_unique<MultiThreadExecutor>(generation_threads);
+  }
+
   // Test purpose only.
   CredentialManagerImpl(
       SingleThreadExecutor* executor,
@@ -106,6 +117,11 @@ class CredentialManagerImpl : public CredentialManager {
       PublicCredentialType public_credential_type,
       GetPublicCredentialsResultCallback callback) override;
 
+  SubscriberId SubscribeForPublicCredentialUpdates(
+      const CredentialSelector& credential_selector,
+      PublicCredentialType public_credential_type,
+      PublicCredentialsUpdateCallback callback) override;
+
   void UnsubscribeFromPublicCredentials(SubscriberId id) override;
 
   std::string DecryptMetadata(absl::string_view metadata_encryption_key,
@@ -165,6 +181,8 @@ class CredentialManagerImpl : public CredentialManager {
    public:
     Subscriber(SubscriberId id, GetPublicCredentialsResultCallback callback)
         : callback_(std::move(callback)), id_(id) {}
+    Subscriber(SubscriberId id, PublicCredentialsUpdateCallback callback)
+        : update_callback_(std::move(callback)), id_(id) {}
 
     SubscriberId GetId() const { return id_; }
 
@@ -173,10 +191,33 @@ class CredentialManagerImpl : public CredentialManager {
         std::vector<::nearby::internal::SharedCredential>& credentials);
 
    private:
+    // Tells an update subscriber what changed since its last update.
+    void NotifyCredentialsUpdated(
+        const std::vector<::nearby::internal::SharedCredential>& credentials);
+
     GetPublicCredentialsResultCallback callback_;
+    PublicCredentialsUpdateCallback update_callback_;
     SubscriberId id_;
+    // The credentials an update subscriber was last told about, by secret id.
+    uint64_t generation_ = 0;
+    absl::flat_hash_map<std::string, ::nearby::internal::SharedCredential>
+        known_credentials_;
   };
 
+  // Generates the credentials of GenerateCredentials() in parallel on
+  // `generation_executor_`, the current ones first.
+  void GenerateCredentialsInBackground(
+      const Metadata& metadata, absl::string_view manager_app_id,
+      const std::vector<IdentityType>& identity_types,
+      int credential_life_cycle_days, int contiguous_copy_of_credentials,
+      GenerateCredentialsResultCallback credentials_generated_cb);
+  void SaveGeneratedCredentials(
+      absl::string_view manager_app_id, absl::string_view account_name,
+      const std::vector<::nearby::internal::LocalCredential>&
+          private_credentials,
+      const std::vector<::nearby::internal::SharedCredential>&
+          public_credentials,
+      GenerateCredentialsResultCallback credentials_generated_cb);
   void RunOnServiceControllerThread(absl::string_view name,
                                     Runnable&& runnable) {
     executor_->Execute(std::string(name), std::move(runnable));
@@ -189,8 +230,7 @@ class CredentialManagerImpl : public CredentialManager {
       const SubscriberKey& key,
       std::vector<::nearby::internal::SharedCredential> credentials)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_);
-  void AddSubscriber(SubscriberKey key, SubscriberId id,
-                     GetPublicCredentialsResultCallback callback)
+  void AddSubscriber(SubscriberKey key, Subscriber subscriber)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_);
   void RemoveSubscriber(SubscriberId id)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_);
@@ -205,6 +245,8 @@ class CredentialManagerImpl : public CredentialManager {
       ABSL_GUARDED_BY(*executor_);
   SingleThreadExecutor* executor_;
   std::unique_ptr<nearby::CredentialStorageImpl> credential_storage_ptr_;
+  // Declared after the members its tasks use, so it's shut down first.
+  std::unique_ptr<MultiThreadExecutor> generation_executor_;
   Metadata metadata_;
 };
 
@@ -49,6 +49,7 @@ using ::nearby::internal::SharedCredential;
 using ::nearby::internal::IdentityType::IDENTITY_TYPE_PRIVATE;
 using ::nearby::internal::IdentityType::IDENTITY_TYPE_TRUSTED;
 using ::protobuf_matchers::EqualsProto;
+using ::testing::IsEmpty;
 using ::testing::UnorderedPointwise;
 using ::testing::status::StatusIs;
 
@@ -226,6 +227,38 @@ TEST_F(CredentialManagerImplTest, GenerateCredentialsSuccessfully) {
   }
 }
 
+TEST_F(CredentialManagerImplTest, GenerateCredentialsInBackground) {
+  constexpr int kNumCredentials = 5;
+  CredentialManagerImpl credential_manager(&executor_,
+                                           /*generation_threads=*/2);
+  CountDownLatch latch(1);
+  absl::StatusOr<std::vector<SharedCredential>> public_credentials;
+
+  credential_manager.GenerateCredentials(
+      CreateTestMetadata(), kManagerAppId,
+      {IDENTITY_TYPE_PRIVATE, IDENTITY_TYPE_TRUSTED}, /*credential_life_cycle_days=*/1,
+      kNumCredentials,
+      {.credentials_generated_cb =
+           [&](absl::StatusOr<std::vector<SharedCredential>> credentials) {
+             public_credentials = std::move(credentials);
+             latch.CountDown();
+           }});
+
+  EXPECT_TRUE(latch.Await(absl::Seconds(5)).result());
+  ASSERT_OK(public_credentials);
+  ASSERT_EQ(public_credentials->size(), 2 * kNumCredentials);
+  // Grouped by identity type, each group ordered by start time.
+  for (int i = 0; i < public_credentials->size(); i++) {
+    EXPECT_EQ(public_credentials->at(i).identity_type(),
+              i < kNumCredentials ? IDENTITY_TYPE_PRIVATE
+                                  : IDENTITY_TYPE_TRUSTED);
+    if (i % kNumCredentials > 0) {
+      EXPECT_GT(public_credentials->at(i).start_time_millis(),
+                public_credentials->at(i - 1).start_time_millis());
+    }
+  }
+}
+
 TEST_F(CredentialManagerImplTest,
        SubscribeCallsCallbackWithExistingCredentials) {
   absl::StatusOr<std::vector<SharedCredential>> public_credentials1;
@@ -288,6 +321,40 @@ TEST_F(CredentialManagerImplTest,
   Fence();
 }
 
+TEST_F(CredentialManagerImplTest, SubscribeForUpdatesReceivesChanges) {
+  std::vector<PublicCredentialsUpdate> updates;
+  AddLocalIdentity(kManagerAppId, kAccountName, IDENTITY_TYPE_PRIVATE);
+
+  SubscriberId id = credential_manager_.SubscribeForPublicCredentialUpdates(
+      CredentialSelector{.manager_app_id = std::string(kManagerAppId),
+                         .account_name = std::string(kAccountName),
+                         .identity_type = IDENTITY_TYPE_PRIVATE},
+      PublicCredentialType::kLocalPublicCredential,
+      {.credentials_updated_cb = [&](PublicCredentialsUpdate update) {
+        updates.push_back(std::move(update));
+      }});
+  Fence();
+  ASSERT_EQ(updates.size(), 1);
+  EXPECT_EQ(updates[0].generation, 1);
+  ASSERT_EQ(updates[0].added.size(), 1);
+  EXPECT_THAT(updates[0].updated, IsEmpty());
+  EXPECT_THAT(updates[0].removed, IsEmpty());
+
+  // Regenerating replaces the credential with one of a new secret id.
+  AddLocalIdentity(kManagerAppId, kAccountName, IDENTITY_TYPE_PRIVATE);
+  Fence();
+
+  ASSERT_EQ(updates.size(), 2);
+  EXPECT_EQ(updates[1].generation, 2);
+  EXPECT_EQ(updates[1].added.size(), 1);
+  EXPECT_THAT(updates[1].updated, IsEmpty());
+  ASSERT_EQ(updates[1].removed.size(), 1);
+  EXPECT_THAT(updates[1].removed[0], EqualsProto(updates[0].added[0]));
+  // Cleanup
+  credential_manager_.UnsubscribeFromPublicCredentials(id);
+  Fence();
+}
+
 TEST_F(CredentialManagerImplTest, NoCallbacksAfterUnsubscribe) {
   absl::StatusOr<std::vector<SharedCredential>> public_credentials;
   SubscriberId id = credential_manager_.SubscribeForPublicCredentials(
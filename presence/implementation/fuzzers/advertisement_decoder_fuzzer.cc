@@ -0,0 +1,32 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
+#include "presence/implementation/advertisement_decoder.h"
+#include "presence/scan_request.h"
+
+// Without credentials, encrypted sections fail to decrypt, but their headers
+// are still parsed.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  nearby::presence::AdvertisementDecoder decoder{
+      nearby::presence::ScanRequest()};
+
+  decoder.DecodeAdvertisement(
+      absl::string_view(reinterpret_cast<const char*>(data), size));
+
+  return 0;
+}
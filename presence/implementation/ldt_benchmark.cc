@@ -0,0 +1,133 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks for LDT encryption of Presence advertisements.
+//
+// BM_LdtScan models a scanner holding a number of credentials: every received
+// advertisement is tried against each credential's LdtEncryptor until one
+// verifies, with the matching credential last.
+
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "internal/crypto/random.h"
+#include "presence/implementation/ldt.h"
+
+namespace nearby {
+namespace presence {
+namespace {
+
+constexpr int kKeySeedSize = 32;
+constexpr int kHmacSize = 32;
+constexpr int kSaltSize = 2;
+
+std::string RandomString(size_t size) {
+  std::string bytes(size, 0);
+  crypto::RandBytes(bytes.data(), bytes.size());
+  return bytes;
+}
+
+// LDT encrypts 16 - 31 bytes.
+void DataSizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgName("size")->Arg(16)->Arg(24)->Arg(31);
+}
+
+void BM_LdtCreate(benchmark::State& state) {
+  const std::string key_seed = RandomString(kKeySeedSize);
+  const std::string known_hmac = RandomString(kHmacSize);
+  for (auto _ : state) {
+    absl::StatusOr<LdtEncryptor> encryptor =
+        LdtEncryptor::Create(key_seed, known_hmac);
+    if (!encryptor.ok()) {
+      state.SkipWithError(
+          absl::StrCat("LDT is unavailable: ", encryptor.status().ToString())
+              .c_str());
+      break;
+    }
+  }
+}
+
+void BM_LdtEncrypt(benchmark::State& state) {
+  absl::StatusOr<LdtEncryptor> encryptor = LdtEncryptor::Create(
+      RandomString(kKeySeedSize), RandomString(kHmacSize));
+  if (!encryptor.ok()) {
+    state.SkipWithError("LDT is unavailable.");
+    return;
+  }
+  const std::string data = RandomString(state.range(0));
+  const std::string salt = RandomString(kSaltSize);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(encryptor->Encrypt(data, salt).ok());
+  }
+}
+
+void BM_LdtDecryptAndVerify(benchmark::State& state) {
+  absl::StatusOr<LdtEncryptor> encryptor = LdtEncryptor::Create(
+      RandomString(kKeySeedSize), RandomString(kHmacSize));
+  if (!encryptor.ok()) {
+    state.SkipWithError("LDT is unavailable.");
+    return;
+  }
+  const std::string salt = RandomString(kSaltSize);
+  absl::StatusOr<std::string> encrypted =
+      encryptor->Encrypt(RandomString(state.range(0)), salt);
+  if (!encrypted.ok()) {
+    state.SkipWithError("Encrypt failed.");
+    return;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(encryptor->DecryptAndVerify(*encrypted, salt));
+  }
+}
+
+// Arguments are {credentials}.
+void BM_LdtScan(benchmark::State& state) {
+  const int credentials = static_cast<int>(state.range(0));
+  std::vector<LdtEncryptor> encryptors;
+  encryptors.reserve(credentials);
+  for (int i = 0; i < credentials; ++i) {
+    absl::StatusOr<LdtEncryptor> encryptor = LdtEncryptor::Create(
+        RandomString(kKeySeedSize), RandomString(kHmacSize));
+    if (!encryptor.ok()) {
+      state.SkipWithError("LDT is unavailable.");
+      return;
+    }
+    encryptors.push_back(*std::move(encryptor));
+  }
+  const std::string salt = RandomString(kSaltSize);
+  absl::StatusOr<std::string> advertisement =
+      encryptors.back().Encrypt(RandomString(24), salt);
+  if (!advertisement.ok()) {
+    state.SkipWithError("Encrypt failed.");
+    return;
+  }
+  for (auto _ : state) {
+    for (LdtEncryptor& encryptor : encryptors) {
+      if (encryptor.DecryptAndVerify(*advertisement, salt).ok()) break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * credentials);
+}
+
+BENCHMARK(BM_LdtCreate);
+BENCHMARK(BM_LdtEncrypt)->Apply(DataSizes);
+BENCHMARK(BM_LdtDecryptAndVerify)->Apply(DataSizes);
+BENCHMARK(BM_LdtScan)->ArgName("credentials")->RangeMultiplier(4)->Range(1, 256);
+
+}  // namespace
+}  // namespace presence
+}  // namespace nearby
@@ -0,0 +1,86 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "presence/implementation/ldt_decryptor_cache.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "internal/platform/logging.h"
+#include "internal/platform/mutex_lock.h"
+#include "internal/proto/credential.pb.h"
+#include "presence/implementation/ldt.h"
+
+namespace nearby {
+namespace presence {
+
+void LdtDecryptorCache::Update(
+    const std::vector<const internal::SharedCredential*>& credentials) {
+  MutexLock lock(&mutex_);
+  absl::flat_hash_map<Key, std::unique_ptr<LdtEncryptor>> encryptors;
+  encryptors.reserve(credentials.size());
+  for (const internal::SharedCredential* credential : credentials) {
+    Key key = GetKey(*credential);
+    if (encryptors.contains(key)) {
+      continue;
+    }
+    auto it = encryptors_.find(key);
+    std::unique_ptr<LdtEncryptor> encryptor =
+        it != encryptors_.end() ? std::move(it->second) : Create(*credential);
+    encryptors.emplace(std::move(key), std::move(encryptor));
+  }
+  encryptors_ = std::move(encryptors);
+}
+
+LdtEncryptor* LdtDecryptorCache::Get(
+    const internal::SharedCredential& credential) {
+  Key key = GetKey(credential);
+  MutexLock lock(&mutex_);
+  auto it = encryptors_.find(key);
+  if (it == encryptors_.end()) {
+    it = encryptors_.emplace(std::move(key), Create(credential)).first;
+  }
+  return it->second.get();
+}
+
+void LdtDecryptorCache::Remove(const internal::SharedCredential& credential) {
+  Key key = GetKey(credential);
+  MutexLock lock(&mutex_);
+  encryptors_.erase(key);
+}
+
+LdtDecryptorCache::Key LdtDecryptorCache::GetKey(
+    const internal::SharedCredential& credential) {
+  return {credential.key_seed(),
+          credential.metadata_encryption_key_unsigned_adv_tag()};
+}
+
+std::unique_ptr<LdtEncryptor> LdtDecryptorCache::Create(
+    const internal::SharedCredential& credential) {
+  absl::StatusOr<LdtEncryptor> encryptor = LdtEncryptor::Create(
+      credential.key_seed(),
+      credential.metadata_encryption_key_unsigned_adv_tag());
+  if (!encryptor.ok()) {
+    NEARBY_LOGS(WARNING) << "Failed to create LDT encryptor, status: "
+                         << encryptor.status();
+    return nullptr;
+  }
+  return std::make_unique<LdtEncryptor>(*std::move(encryptor));
+}
+
+}  // namespace presence
+}  // namespace nearby
@@ -0,0 +1,78 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_LDT_DECRYPTOR_CACHE_H_
+#define THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_LDT_DECRYPTOR_CACHE_H_
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/mutex_lock.h"
+#include "internal/proto/credential.pb.h"
+#include "presence/implementation/ldt.h"
+
+namespace nearby {
+namespace presence {
+
+// Keeps an `LdtEncryptor` for each credential a scan decrypts advertisements
+// with, so that the LDT keys are derived once per credential rather than once
+// per credential for every received advertisement.
+//
+// Encryptors are keyed by the credential's key seed and metadata encryption
+// key tag. Thread-safe.
+class LdtDecryptorCache {
+ public:
+  // Replaces the cached encryptors with those of `credentials`. Encryptors
+  // already built for any of `credentials` are reused, the rest are dropped.
+  void Update(const std::vector<const internal::SharedCredential*>& credentials)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the encryptor of `credential`, building it if it isn't cached yet.
+  // Returns nullptr if the encryptor can't be created. The encryptor stays
+  // valid until `Update()` drops its credential.
+  LdtEncryptor* Get(const internal::SharedCredential& credential)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Drops the encryptor of `credential`, if any.
+  void Remove(const internal::SharedCredential& credential)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of cached credentials.
+  int size() const ABSL_LOCKS_EXCLUDED(mutex_) {
+    MutexLock lock(&mutex_);
+    return encryptors_.size();
+  }
+
+ private:
+  using Key = std::pair<std::string, std::string>;
+
+  static Key GetKey(const internal::SharedCredential& credential);
+  static std::unique_ptr<LdtEncryptor> Create(
+      const internal::SharedCredential& credential);
+
+  // A null encryptor means that it couldn't be created for the credential.
+  mutable Mutex mutex_;
+  absl::flat_hash_map<Key, std::unique_ptr<LdtEncryptor>> encryptors_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace presence
+}  // namespace nearby
+
+#endif  // THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_LDT_DECRYPTOR_CACHE_H_
@@ -0,0 +1,119 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "presence/implementation/ldt_decryptor_cache.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "protobuf-matchers/protocol-buffer-matchers.h"
+#include "gtest/gtest.h"
+#include "absl/strings/string_view.h"
+#include "internal/proto/credential.pb.h"
+#include "presence/implementation/ldt.h"
+
+namespace nearby {
+namespace presence {
+
+namespace {
+using ::nearby::internal::SharedCredential;
+
+SharedCredential GetCredential(char seed) {
+  SharedCredential credential;
+  credential.set_key_seed(std::string(32, seed));
+  credential.set_metadata_encryption_key_unsigned_adv_tag(
+      std::string(32, seed + 1));
+  return credential;
+}
+
+TEST(LdtDecryptorCache, UpdateCachesEachCredentialOnce) {
+  SharedCredential first = GetCredential('a');
+  SharedCredential second = GetCredential('c');
+  LdtDecryptorCache cache;
+
+  cache.Update({&first, &second, &first});
+
+  EXPECT_EQ(cache.size(), 2);
+}
+
+TEST(LdtDecryptorCache, UpdateDropsRemovedCredentials) {
+  SharedCredential first = GetCredential('a');
+  SharedCredential second = GetCredential('c');
+  LdtDecryptorCache cache;
+  cache.Update({&first, &second});
+
+  cache.Update({&second});
+
+  EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(LdtDecryptorCache, GetCachesUnknownCredential) {
+  SharedCredential credential = GetCredential('a');
+  LdtDecryptorCache cache;
+
+  cache.Get(credential);
+
+  EXPECT_EQ(cache.size(), 1);
+}
+
+#ifdef USE_RUST_LDT
+
+TEST(LdtDecryptorCache, GetReturnsSameEncryptor) {
+  SharedCredential credential = GetCredential('a');
+  LdtDecryptorCache cache;
+  cache.Update({&credential});
+
+  LdtEncryptor* encryptor = cache.Get(credential);
+
+  ASSERT_NE(encryptor, nullptr);
+  EXPECT_EQ(cache.Get(credential), encryptor);
+}
+
+TEST(LdtDecryptorCache, UpdateReusesBuiltEncryptors) {
+  SharedCredential first = GetCredential('a');
+  SharedCredential second = GetCredential('c');
+  LdtDecryptorCache cache;
+  cache.Update({&first});
+  LdtEncryptor* encryptor = cache.Get(first);
+
+  cache.Update({&second, &first});
+
+  EXPECT_EQ(cache.Get(first), encryptor);
+}
+
+TEST(LdtDecryptorCache, CachedEncryptorDecrypts) {
+  SharedCredential credential = GetCredential('a');
+  constexpr absl::string_view kData = "0123456789abcdefghij";
+  constexpr absl::string_view kSalt = "sa";
+  absl::StatusOr<LdtEncryptor> encryptor = LdtEncryptor::Create(
+      credential.key_seed(),
+      credential.metadata_encryption_key_unsigned_adv_tag());
+  ASSERT_OK(encryptor);
+  absl::StatusOr<std::string> encrypted = encryptor->Encrypt(kData, kSalt);
+  ASSERT_OK(encrypted);
+  LdtDecryptorCache cache;
+  cache.Update({&credential});
+
+  absl::StatusOr<std::string> decrypted =
+      cache.Get(credential)->DecryptAndVerify(*encrypted, kSalt);
+
+  ASSERT_OK(decrypted);
+  EXPECT_EQ(*decrypted, kData);
+}
+
+#endif /* USE_RUST_LDT */
+
+}  // namespace
+}  // namespace presence
+}  // namespace nearby
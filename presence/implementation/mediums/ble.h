@@ -19,6 +19,7 @@
 #include <string>
 #include <utility>
 
+#include "internal/platform/ble_scan_arbiter.h"
 #include "internal/platform/ble_v2.h"
 #include "internal/platform/bluetooth_adapter.h"
 #include "internal/platform/uuid.h"
@@ -75,10 +76,11 @@ class Ble {
   }
 
   // Starts scanning for NP advertisements. The caller should use the returned
-  // `ScanningSession` to stop scanning.
+  // `ScanningSession` to stop scanning. Concurrent scans share one platform
+  // scan.
   std::unique_ptr<ScanningSession> StartScanning(ScanRequest scan_request,
                                                  ScanningCallback callback) {
-    return medium_.StartScanning(
+    return scan_arbiter_.StartScanning(
         kPresenceServiceUuid,
         ConvertPowerModeToPowerLevel(scan_request.power_mode),
         std::move(callback));
@@ -103,6 +105,7 @@ class Ble {
   }
 
   nearby::BleV2Medium medium_;
+  nearby::BleScanArbiter scan_arbiter_{medium_};
 };
 
 }  // namespace presence
@@ -16,6 +16,14 @@
 
 // Placeholder, empty implementations of LDT utilities. They will be replaced
 // with implementations in Rust.
+//
+// This file holds no cipher. It is only linked where the Rust LDT library is
+// unavailable (see `norust_or_windows_or_android` in BUILD), and every handle
+// it returns is invalid, so `LdtEncryptor::Create()` fails on those builds.
+// The LDT block cipher that scanning spends its time in is the one in
+// `ldt_np_adv_ffi`, and hardware acceleration of AES is up to the crypto
+// provider that library is built with. Cost per call is measured by
+// `ldt_benchmark`.
 
 NpLdtEncryptHandle NpLdtEncryptCreate(NpLdtKeySeed key_seed) {
   NpLdtEncryptHandle handle = {0};
@@ -17,19 +17,27 @@
 #include <algorithm>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/types/variant.h"
 #include "internal/platform/implementation/crypto.h"
 #include "internal/platform/future.h"
 #include "internal/platform/implementation/ble_v2.h"
 #include "internal/platform/implementation/credential_callbacks.h"
+#include "internal/platform/multi_thread_executor.h"
 #include "internal/platform/uuid.h"
 #include "presence/data_types.h"
+#include "presence/implementation/advertisement_cache.h"
 #include "presence/implementation/advertisement_decoder.h"
+#include "presence/implementation/credential_manager.h"
+#include "presence/implementation/ldt_decryptor_cache.h"
 #include "presence/implementation/mediums/ble.h"
 #include "presence/presence_device.h"
 #include "presence/scan_request.h"
@@ -42,6 +50,26 @@ using BleAdvertisementData = ::nearby::api::ble_v2::BleAdvertisementData;
 using BlePeripheral = ::nearby::api::ble_v2::BlePeripheral;
 using ScanningSession = ::nearby::api::ble_v2::BleMedium::ScanningSession;
 using ScanningCallback = ::nearby::api::ble_v2::BleMedium::ScanningCallback;
+using SharedCredential = ::nearby::internal::SharedCredential;
+using IdentityType = ::nearby::internal::IdentityType;
+
+// Whether `a` and `b` decrypt the same advertisements.
+bool HaveSameKeys(const SharedCredential& a, const SharedCredential& b) {
+  return a.key_seed() == b.key_seed() &&
+         a.metadata_encryption_key_unsigned_adv_tag() ==
+             b.metadata_encryption_key_unsigned_adv_tag();
+}
+
+// Adds `credential` to `credentials`, unless it has the keys of one of them.
+void AddCredential(const SharedCredential& credential,
+                   std::vector<SharedCredential>& credentials) {
+  if (std::none_of(credentials.begin(), credentials.end(),
+                   [&credential](const SharedCredential& other) {
+                     return HaveSameKeys(credential, other);
+                   })) {
+    credentials.push_back(credential);
+  }
+}
 }  // namespace
 
 ScanSessionId ScanManager::StartScan(ScanRequest scan_request,
@@ -69,14 +97,18 @@ ScanSessionId ScanManager::StartScan(ScanRequest scan_request,
                                 NotifyFoundBle(id, data, address);
                               });
                     }};
-            FetchCredentials(id, scan_request);
+            std::vector<SubscriberId> credential_subscriber_ids =
+                SubscribeForCredentials(id, scan_request);
             scan_sessions_.insert(
                 {id, ScanSessionState{
                          .request = scan_request,
                          .callback = std::move(scan_callback),
+                         .credential_subscriber_ids =
+                             std::move(credential_subscriber_ids),
                          .decoder = AdvertisementDecoder(scan_request),
                          .scanning_session = mediums_->GetBle().StartScanning(
                              scan_request, std::move(callback))}});
+            UpdateSharedDecoder();
           });
   return id;
 }
@@ -94,7 +126,12 @@ void ScanManager::StopScan(ScanSessionId id) {
             NEARBY_LOGS(WARNING) << "StopScan error: " << status;
           }
         }
+        for (SubscriberId subscriber_id :
+             it->second.credential_subscriber_ids) {
+          credential_manager_->UnsubscribeFromPublicCredentials(subscriber_id);
+        }
         scan_sessions_.erase(it);
+        UpdateSharedDecoder();
       });
 }
 
@@ -106,30 +143,43 @@ void ScanManager::NotifyFoundBle(ScanSessionId id, BleAdvertisementData data,
   if (it == scan_sessions_.end()) {
     return;
   }
-  auto advert = it->second.decoder.DecodeAdvertisement(advertisement_data);
-  if (!advert.ok()) {
-    // This advertisement is not relevant to the current element, skip.
+  ScanSessionState& session = it->second;
+  const std::optional<Advertisement>* advert =
+      session.decoded_advertisements.Find(advertisement_data);
+  if (advert == nullptr) {
+    std::optional<Advertisement> decoded =
+        GetSessionAdvertisement(session, DecodeShared(advertisement_data));
+    // Advertisements that fail to decode are not relevant to the current
+    // element, and are skipped like the ones not matching the scan filters.
+    if (decoded.has_value() &&
+        !session.decoder.MatchesScanFilter(decoded->data_elements)) {
+      decoded.reset();
+    }
+    session.decoded_advertisements.Insert(advertisement_data,
+                                          std::move(decoded));
+    advert = session.decoded_advertisements.Find(advertisement_data);
+  }
+  if (advert == nullptr || !advert->has_value()) {
     return;
   }
-  if (it->second.decoder.MatchesScanFilter(advert->data_elements)) {
-    // TODO(b/256913915): Provide more information in PresenceDevice once
-    // fully implemented
-    internal::Metadata metadata;
-    metadata.set_bluetooth_mac_address(std::string(remote_address));
-    PresenceDevice device{metadata};
-    device.AddExtendedProperties(advert->data_elements);
-    for (const auto& data_element : advert->data_elements) {
-      if (data_element.GetType() == DataElement::kActionFieldType) {
-        device.AddAction(PresenceAction(static_cast<int>(
-            static_cast<uint8_t>(data_element.GetValue()[0]))));
-      }
+  // TODO(b/256913915): Provide more information in PresenceDevice once
+  // fully implemented
+  internal::Metadata metadata;
+  metadata.set_bluetooth_mac_address(std::string(remote_address));
+  PresenceDevice device{metadata};
+  device.AddExtendedProperties((*advert)->data_elements);
+  for (const auto& data_element : (*advert)->data_elements) {
+    if (data_element.GetType() == DataElement::kActionFieldType) {
+      device.AddAction(PresenceAction(static_cast<int>(
+          static_cast<uint8_t>(data_element.GetValue()[0]))));
     }
-    it->second.callback.on_discovered_cb(std::move(device));
   }
+  session.callback.on_discovered_cb(std::move(device));
 }
 
-void ScanManager::FetchCredentials(ScanSessionId id,
-                                   const ScanRequest& scan_request) {
+std::vector<SubscriberId> ScanManager::SubscribeForCredentials(
+    ScanSessionId id, const ScanRequest& scan_request) {
+  std::vector<SubscriberId> subscriber_ids;
   std::vector<CredentialSelector> credential_selectors =
       AdvertisementDecoder::GetCredentialSelectors(scan_request);
   for (const CredentialSelector& selector : credential_selectors) {
@@ -141,40 +191,187 @@ void ScanManager::FetchCredentials(ScanSessionId id,
                         << selector.identity_type;
       continue;
     }
-    credential_manager_->GetPublicCredentials(
-        selector, PublicCredentialType::kRemotePublicCredential,
-        {.credentials_fetched_cb =
-             [this, id, identity_type = selector.identity_type](
-                 absl::StatusOr<
-                     std::vector<::nearby::internal::SharedCredential>>
-                     credentials) {
-               if (!credentials.ok()) {
-                 NEARBY_LOGS(WARNING)
-                     << "Failed to fetch credentials: " << credentials.status();
-                 return;
-               }
-               RunOnServiceControllerThread(
-                   "update-credentials",
-                   [this, id, identity_type,
-                    credentials = std::move(*credentials)]()
-                       ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_) {
-                         UpdateCredentials(id, identity_type,
-                                           std::move(credentials));
-                       });
-             }});
+    subscriber_ids.push_back(
+        credential_manager_->SubscribeForPublicCredentialUpdates(
+            selector, PublicCredentialType::kRemotePublicCredential,
+            {.credentials_updated_cb =
+                 [this, id, identity_type = selector.identity_type](
+                     PublicCredentialsUpdate update) {
+                   RunOnServiceControllerThread(
+                       "update-credentials",
+                       [this, id, identity_type, update = std::move(update)]()
+                           ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_) mutable {
+                             UpdateCredentials(id, identity_type,
+                                               std::move(update));
+                           });
+                 }}));
   }
+  return subscriber_ids;
 }
 
 void ScanManager::UpdateCredentials(ScanSessionId id,
                                     IdentityType identity_type,
-                                    std::vector<SharedCredential> credentials) {
+                                    PublicCredentialsUpdate update) {
   auto it = scan_sessions_.find(id);
   if (it == scan_sessions_.end()) {
     return;
   }
   ScanSessionState& session = it->second;
-  session.credentials[identity_type] = std::move(credentials);
-  session.decoder = AdvertisementDecoder(session.request, &session.credentials);
+  std::vector<SharedCredential>& credentials =
+      session.credentials[identity_type];
+  absl::flat_hash_set<std::string> replaced_secret_ids;
+  for (const SharedCredential& credential : update.updated) {
+    replaced_secret_ids.insert(credential.secret_id());
+  }
+  for (const SharedCredential& credential : update.removed) {
+    replaced_secret_ids.insert(credential.secret_id());
+  }
+  if (!replaced_secret_ids.empty()) {
+    credentials.erase(
+        std::remove_if(credentials.begin(), credentials.end(),
+                       [&](const SharedCredential& credential) {
+                         if (!replaced_secret_ids.contains(
+                                 credential.secret_id())) {
+                           return false;
+                         }
+                         return true;
+                       }),
+        credentials.end());
+  }
+  for (std::vector<SharedCredential>* changed :
+       {&update.updated, &update.added}) {
+    for (SharedCredential& credential : *changed) {
+      credentials.push_back(std::move(credential));
+    }
+  }
+  session.decoded_advertisements.Clear();
+  UpdateSharedDecoder();
+}
+
+void ScanManager::UpdateSharedDecoder() {
+  shared_decoded_advertisements_.Clear();
+  shared_credentials_.clear();
+  if (scan_sessions_.empty()) {
+    shared_decoder_.reset();
+    decryptors_.Update({});
+    return;
+  }
+  // The shared decoder accepts the identity types of all sessions and tries
+  // the credentials of all of them. A session gets a decoded advertisement
+  // only if it would have decoded it itself, see `GetSessionAdvertisement()`.
+  ScanRequest shared_request;
+  for (const auto& [id, session] : scan_sessions_) {
+    for (IdentityType identity_type : session.request.identity_types) {
+      if (std::find(shared_request.identity_types.begin(),
+                    shared_request.identity_types.end(),
+                    identity_type) == shared_request.identity_types.end()) {
+        shared_request.identity_types.push_back(identity_type);
+      }
+      // The credentials in the scan filters are tried for any identity type.
+      for (const auto& scan_filter : session.request.scan_filters) {
+        if (const auto* legacy_filter =
+                absl::get_if<LegacyPresenceScanFilter>(&scan_filter)) {
+          for (const SharedCredential& credential :
+               legacy_filter->remote_public_credentials) {
+            AddCredential(credential, shared_credentials_[identity_type]);
+          }
+        }
+      }
+    }
+    for (const auto& [identity_type, credentials] : session.credentials) {
+      for (const SharedCredential& credential : credentials) {
+        AddCredential(credential, shared_credentials_[identity_type]);
+      }
+    }
+  }
+  std::vector<const SharedCredential*> all_credentials;
+  for (const auto& [identity_type, credentials] : shared_credentials_) {
+    for (const SharedCredential& credential : credentials) {
+      all_credentials.push_back(&credential);
+    }
+  }
+  decryptors_.Update(all_credentials);
+  for (const SharedCredential* credential : all_credentials) {
+    // Builds the encryptor now rather than on the next advertisement.
+    decryptors_.Get(*credential);
+  }
+  shared_decoder_ = std::make_unique<AdvertisementDecoder>(
+      std::move(shared_request), &shared_credentials_, &decryptors_,
+      GetDecryptExecutor());
+}
+
+const std::optional<Advertisement>& ScanManager::DecodeShared(
+    absl::string_view advertisement_data) {
+  const std::optional<Advertisement>* advert =
+      shared_decoded_advertisements_.Find(advertisement_data);
+  if (advert == nullptr) {
+    std::optional<Advertisement> decoded;
+    absl::StatusOr<Advertisement> decoded_advert =
+        shared_decoder_->DecodeAdvertisement(advertisement_data);
+    if (decoded_advert.ok()) {
+      decoded = *std::move(decoded_advert);
+    }
+    shared_decoded_advertisements_.Insert(advertisement_data,
+                                          std::move(decoded));
+    advert = shared_decoded_advertisements_.Find(advertisement_data);
+  }
+  return *advert;
+}
+
+std::optional<Advertisement> ScanManager::GetSessionAdvertisement(
+    const ScanSessionState& session,
+    const std::optional<Advertisement>& advert) {
+  if (!advert.has_value()) {
+    // The shared decoder accepts every identity type and tries every
+    // credential that the session would, so the session can't do better.
+    return std::nullopt;
+  }
+  IdentityType identity_type = advert->identity_type;
+  if (identity_type != internal::IDENTITY_TYPE_UNSPECIFIED &&
+      std::find(session.request.identity_types.begin(),
+                session.request.identity_types.end(),
+                identity_type) == session.request.identity_types.end()) {
+    return std::nullopt;
+  }
+  if (!advert->public_credential.ok()) {
+    // Not encrypted.
+    return advert;
+  }
+  // Only one credential can decrypt an advertisement. The session must have
+  // it too.
+  std::vector<const SharedCredential*> candidates;
+  for (const auto& scan_filter : session.request.scan_filters) {
+    if (const auto* legacy_filter =
+            absl::get_if<LegacyPresenceScanFilter>(&scan_filter)) {
+      for (const SharedCredential& credential :
+           legacy_filter->remote_public_credentials) {
+        candidates.push_back(&credential);
+      }
+    }
+  }
+  auto it = session.credentials.find(identity_type);
+  if (it != session.credentials.end()) {
+    for (const SharedCredential& credential : it->second) {
+      candidates.push_back(&credential);
+    }
+  }
+  for (const SharedCredential* credential : candidates) {
+    if (HaveSameKeys(*credential, *advert->public_credential)) {
+      Advertisement session_advert = *advert;
+      session_advert.public_credential = *credential;
+      return session_advert;
+    }
+  }
+  return std::nullopt;
+}
+
+SubmittableExecutor* ScanManager::GetDecryptExecutor() {
+  if (!decrypt_executor_) {
+    // The decoder tries one of the chunks on the calling thread.
+    decrypt_executor_ = std::make_unique<MultiThreadExecutor>(
+        AdvertisementDecoder::kMaxParallelDecryptTasks - 1);
+  }
+  return decrypt_executor_.get();
 }
 
 int ScanManager::ScanningCallbacksLengthForTest() {
@@ -17,16 +17,21 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "internal/platform/multi_thread_executor.h"
 #include "internal/platform/single_thread_executor.h"
+#include "internal/platform/submittable_executor.h"
 #include "internal/proto/credential.pb.h"
 #include "presence/data_types.h"
+#include "presence/implementation/advertisement_cache.h"
 #include "presence/implementation/advertisement_decoder.h"
 #include "presence/implementation/credential_manager.h"
+#include "presence/implementation/ldt_decryptor_cache.h"
 #include "presence/implementation/mediums/mediums.h"
 #include "presence/scan_request.h"
 
@@ -38,6 +43,8 @@ namespace presence {
 class ScanManager {
  public:
   using SingleThreadExecutor = ::nearby::SingleThreadExecutor;
+  using MultiThreadExecutor = ::nearby::MultiThreadExecutor;
+  using SubmittableExecutor = ::nearby::SubmittableExecutor;
   using Mutex = ::nearby::Mutex;
   using MutexLock = ::nearby::MutexLock;
   using ScanningSession = ::nearby::api::ble_v2::BleMedium::ScanningSession;
@@ -51,7 +58,9 @@ class ScanManager {
     mediums_ = &mediums, credential_manager_ = &credential_manager;
     executor_ = &executor;
   }
-  ~ScanManager() = default;
+  ~ScanManager() {
+    if (decrypt_executor_) decrypt_executor_->Shutdown();
+  }
 
   ScanSessionId StartScan(ScanRequest scan_request, ScanCallback cb);
   void StopScan(ScanSessionId session_id);
@@ -60,29 +69,70 @@ class ScanManager {
   int ScanningCallbacksLengthForTest();
 
  private:
+  // Enough for the advertisements of a busy room, whose devices each rotate
+  // their salt every few minutes.
+  static constexpr int kMaxCachedAdvertisements = 128;
+
   struct ScanSessionState {
     ScanRequest request;
     ScanCallback callback;
+    std::vector<SubscriberId> credential_subscriber_ids;
     absl::flat_hash_map<IdentityType, std::vector<SharedCredential>>
         credentials;
+    // Only matches the decoded advertisements against the scan filters.
     AdvertisementDecoder decoder;
+    // The advertisements relevant to the session with its current
+    // credentials, or std::nullopt for the others.
+    AdvertisementCache decoded_advertisements{kMaxCachedAdvertisements};
     std::unique_ptr<ScanningSession> scanning_session;
   };
   void NotifyFoundBle(ScanSessionId id, BleAdvertisementData data,
                       absl::string_view remote_address)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_);
-  void FetchCredentials(ScanSessionId id, const ScanRequest& scan_request)
+  // Subscribes for the credentials the scan decrypts advertisements with.
+  // Returns the ids to unsubscribe with when the scan stops.
+  std::vector<SubscriberId> SubscribeForCredentials(
+      ScanSessionId id, const ScanRequest& scan_request)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_);
+  // Applies `update` to the credentials of `identity_type`.
   void UpdateCredentials(ScanSessionId id, IdentityType identity_type,
-                         std::vector<SharedCredential> credentials)
+                         PublicCredentialsUpdate update)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_);
+  // Rebuilds the decoder shared by the sessions, after a session started,
+  // stopped or got new credentials.
+  void UpdateSharedDecoder() ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_);
+  // Decodes `advertisement_data` once for all sessions. Returns std::nullopt
+  // if no session can decode it.
+  const std::optional<Advertisement>& DecodeShared(
+      absl::string_view advertisement_data)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_);
+  // Returns `advert`, as `session` would have decoded it itself, or
+  // std::nullopt if it couldn't have, e.g. for lack of the credential.
+  static std::optional<Advertisement> GetSessionAdvertisement(
+      const ScanSessionState& session,
+      const std::optional<Advertisement>& advert);
   void RunOnServiceControllerThread(absl::string_view name, Runnable runnable) {
     executor_->Execute(std::string(name), std::move(runnable));
   }
+  // Tries the credentials of a scan in parallel when there are many of them.
+  // Created with the first scan.
+  SubmittableExecutor* GetDecryptExecutor()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_);
   Mediums* mediums_;
   CredentialManager* credential_manager_;
+  std::unique_ptr<MultiThreadExecutor> decrypt_executor_
+      ABSL_GUARDED_BY(*executor_);
   absl::flat_hash_map<ScanSessionId, ScanSessionState> scan_sessions_
       ABSL_GUARDED_BY(*executor_);
+  // Every advertisement is decoded once, with the credentials of all sessions,
+  // and then handed to the sessions it is relevant to.
+  absl::flat_hash_map<IdentityType, std::vector<SharedCredential>>
+      shared_credentials_ ABSL_GUARDED_BY(*executor_);
+  LdtDecryptorCache decryptors_;
+  std::unique_ptr<AdvertisementDecoder> shared_decoder_
+      ABSL_GUARDED_BY(*executor_);
+  AdvertisementCache shared_decoded_advertisements_ ABSL_GUARDED_BY(
+      *executor_){kMaxCachedAdvertisements};
   SingleThreadExecutor* executor_;
 };
 
@@ -17,6 +17,7 @@
 #include <math.h>
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <string>
 #include <utility>
@@ -294,6 +295,38 @@ TEST_F(ScanManagerTest, StopOneSessionFromAnotherDeadlock) {
   EXPECT_EQ(manager.ScanningCallbacksLengthForTest(), 0);
 }
 
+TEST_F(ScanManagerTest, SharedDecodeOnlyReachesSessionsForIdentityType) {
+  Mediums mediums;
+  ScanManager manager(mediums, credential_manager_, executor_);
+  std::atomic<bool> private_session_found = false;
+
+  // Both sessions decode the same public advertisement, but only the one
+  // scanning for public identities gets it.
+  ScanRequest private_scan_request = MakeDefaultScanRequest();
+  private_scan_request.identity_types = {
+      nearby::internal::IdentityType::IDENTITY_TYPE_PRIVATE};
+  ScanSessionId private_scan_session = manager.StartScan(
+      private_scan_request,
+      {.start_scan_cb = [](absl::Status status) {},
+       .on_discovered_cb =
+           [&](PresenceDevice pd) { private_session_found = true; }});
+  ScanSessionId scan_session =
+      manager.StartScan(MakeDefaultScanRequest(), MakeDefaultScanCallback());
+  ASSERT_EQ(manager.ScanningCallbacksLengthForTest(), 2);
+
+  // Set up advertiser
+  nearby::BluetoothAdapter server_adapter;
+  Ble ble2(server_adapter);
+  std::unique_ptr<AdvertisingSession> advertising_session =
+      StartAdvertisingOn(ble2);
+
+  EXPECT_TRUE(found_latch_.Await().Ok());
+  manager.StopScan(scan_session);
+  manager.StopScan(private_scan_session);
+  EXPECT_EQ(manager.ScanningCallbacksLengthForTest(), 0);
+  EXPECT_FALSE(private_session_found);
+}
+
 // Receive a BLE advertisement after StopScan. `on_discovered_cb`
 // must not be called.
 TEST_F(ScanManagerTest, NoDeviceFoundAfterStopScan) {
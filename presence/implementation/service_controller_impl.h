@@ -72,6 +72,9 @@ class ServiceControllerImpl : public ServiceController {
   Mediums& GetMediums() { return mediums_; }
 
  private:
+  // Threads generating credentials off `executor_`.
+  static constexpr int kCredentialGenerationThreads = 2;
+
   SingleThreadExecutor executor_;
   void NotifyStartCallbackStatus(BroadcastSessionId id, absl::Status status);
   void RunOnServiceControllerThread(absl::string_view name, Runnable runnable) {
@@ -79,7 +82,7 @@ class ServiceControllerImpl : public ServiceController {
   }
   Mediums mediums_;  // NOLINT: further impl will use it.
   CredentialManagerImpl credential_manager_{
-      &executor_};  // NOLINT: further impl will use it.
+      &executor_, kCredentialGenerationThreads};
   ScanManager scan_manager_{mediums_, credential_manager_,
                             executor_};  // NOLINT: further impl will use it.
   BroadcastManager broadcast_manager_{mediums_, credential_manager_, executor_};
@@ -0,0 +1,119 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "presence/implementation/zone_estimator.h"
+
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "presence/presence_zone.h"
+
+namespace nearby {
+namespace presence {
+
+ZoneEstimator::DeviceHandle ZoneEstimator::GetHandle(
+    absl::string_view device_id) {
+  auto it = handles_.find(device_id);
+  if (it != handles_.end()) {
+    return it->second;
+  }
+  DeviceHandle handle;
+  if (free_handles_.empty()) {
+    handle = devices_.size();
+    devices_.emplace_back();
+  } else {
+    handle = free_handles_.back();
+    free_handles_.pop_back();
+    devices_[handle] = Device();
+  }
+  handles_.emplace(device_id, handle);
+  return handle;
+}
+
+void ZoneEstimator::Remove(absl::string_view device_id) {
+  auto it = handles_.find(device_id);
+  if (it == handles_.end()) {
+    return;
+  }
+  free_handles_.push_back(it->second);
+  handles_.erase(it);
+}
+
+std::optional<ZoneEstimator::RangeType> ZoneEstimator::Update(
+    DeviceHandle handle, std::optional<int8_t> tx_power, int rssi,
+    uint64_t elapsed_realtime_millis) {
+  Device& device = devices_[handle];
+  if (!device.has_rssi ||
+      elapsed_realtime_millis >
+          device.last_update_millis + kMaxSampleAgeMillis) {
+    device.rssi = rssi;
+    device.has_rssi = true;
+  } else {
+    device.rssi += kRssiWeight * (rssi - device.rssi);
+  }
+  device.last_update_millis = elapsed_realtime_millis;
+  if (tx_power.has_value()) {
+    device.tx_power = *tx_power;
+  }
+
+  RangeType zone = GetZoneAt(*GetDistanceMeters(handle), device.zone);
+  if (zone == device.zone) {
+    return std::nullopt;
+  }
+  device.zone = zone;
+  return zone;
+}
+
+ZoneEstimator::RangeType ZoneEstimator::GetZone(DeviceHandle handle) const {
+  return devices_[handle].zone;
+}
+
+std::optional<float> ZoneEstimator::GetDistanceMeters(
+    DeviceHandle handle) const {
+  const Device& device = devices_[handle];
+  if (!device.has_rssi) {
+    return std::nullopt;
+  }
+  return std::pow(10.0f, (device.tx_power - device.rssi) /
+                             (10.0f * kPathLossExponent));
+}
+
+ZoneEstimator::RangeType ZoneEstimator::GetZoneAt(float distance_meters,
+                                                  RangeType zone) {
+  // A boundary is pushed away from the zone the device is in, so the device
+  // stays in it until it is clearly past the boundary.
+  auto boundary = [zone](float meters, RangeType closer_zone) {
+    if (zone == RangeType::kRangeUnknown) {
+      return meters;
+    }
+    // Range types are ordered from the farthest to the closest.
+    return zone >= closer_zone ? meters * (1 + kHysteresisRatio)
+                               : meters * (1 - kHysteresisRatio);
+  };
+  if (distance_meters <= boundary(kWithinTapMeters, RangeType::kWithinTap)) {
+    return RangeType::kWithinTap;
+  }
+  if (distance_meters <=
+      boundary(kWithinReachMeters, RangeType::kWithinReach)) {
+    return RangeType::kWithinReach;
+  }
+  return RangeType::kFar;
+}
+
+}  // namespace presence
+}  // namespace nearby
@@ -0,0 +1,100 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_ZONE_ESTIMATOR_H_
+#define THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_ZONE_ESTIMATOR_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "presence/presence_zone.h"
+
+namespace nearby {
+namespace presence {
+
+// Estimates the distance zone of nearby devices from their BLE scan results,
+// for `SensorFusion` implementations to report zone transitions with.
+//
+// The RSSI of each device is smoothed with an exponentially weighted moving
+// average, updated in constant time per scan result, and converted to a
+// distance with the log-distance path loss model. A device only moves to
+// another zone once its distance is past the boundary by `kHysteresisRatio`,
+// so that a device hovering around a boundary doesn't flap between zones and
+// `Update()` only reports actual transitions.
+//
+// Devices are kept in an array indexed by handle. This class is not
+// thread-safe.
+class ZoneEstimator {
+ public:
+  using RangeType = PresenceZone::DistanceBoundary::RangeType;
+  using DeviceHandle = int;
+
+  static constexpr float kWithinTapMeters = 0.127;
+  static constexpr float kWithinReachMeters = 1.0;
+  // How far past a boundary, relative to it, a device has to be to move to
+  // the zone on the other side.
+  static constexpr float kHysteresisRatio = 0.2;
+  // Weight of the latest sample in the smoothed RSSI.
+  static constexpr float kRssiWeight = 0.25;
+  static constexpr float kPathLossExponent = 2.0;
+  // The RSSI at one meter, for scan results without a calibrated TX power.
+  static constexpr int8_t kDefaultTxPower = -59;
+  // The smoothed RSSI restarts from the next sample once it is this old.
+  static constexpr uint64_t kMaxSampleAgeMillis = 10'000;
+
+  // Returns the handle of `device_id`, assigning one if it has none.
+  DeviceHandle GetHandle(absl::string_view device_id);
+
+  // Forgets `device_id`. Its handle may be given to another device.
+  void Remove(absl::string_view device_id);
+
+  // Adds a scan result of the device with `handle`. Returns the device's new
+  // zone if it has changed, or std::nullopt.
+  std::optional<RangeType> Update(DeviceHandle handle,
+                                  std::optional<int8_t> tx_power, int rssi,
+                                  uint64_t elapsed_realtime_millis);
+
+  // Returns the current zone of the device with `handle`.
+  RangeType GetZone(DeviceHandle handle) const;
+
+  // Returns the estimated distance to the device with `handle`, or
+  // std::nullopt if it has no scan results yet.
+  std::optional<float> GetDistanceMeters(DeviceHandle handle) const;
+
+ private:
+  struct Device {
+    bool has_rssi = false;
+    float rssi = 0;
+    int8_t tx_power = kDefaultTxPower;
+    uint64_t last_update_millis = 0;
+    RangeType zone = RangeType::kRangeUnknown;
+  };
+
+  // Returns the zone at `distance_meters` for a device currently in `zone`.
+  static RangeType GetZoneAt(float distance_meters, RangeType zone);
+
+  std::vector<Device> devices_;
+  std::vector<DeviceHandle> free_handles_;
+  absl::flat_hash_map<std::string, DeviceHandle> handles_;
+};
+
+}  // namespace presence
+}  // namespace nearby
+
+#endif  // THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_ZONE_ESTIMATOR_H_
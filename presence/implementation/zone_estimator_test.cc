@@ -0,0 +1,121 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "presence/implementation/zone_estimator.h"
+
+#include <optional>
+
+#include "gtest/gtest.h"
+#include "presence/presence_zone.h"
+
+namespace nearby {
+namespace presence {
+namespace {
+
+using RangeType = ZoneEstimator::RangeType;
+
+// RSSIs at which a device with the default TX power is about 0.06, 0.6 and
+// 3.5 meters away.
+constexpr int kTapRssi = -35;
+constexpr int kReachRssi = -55;
+constexpr int kFarRssi = -70;
+
+TEST(ZoneEstimatorTest, ReportsFirstZone) {
+  ZoneEstimator estimator;
+  ZoneEstimator::DeviceHandle handle = estimator.GetHandle("device");
+
+  EXPECT_EQ(estimator.GetDistanceMeters(handle), std::nullopt);
+  EXPECT_EQ(estimator.Update(handle, std::nullopt, kReachRssi, 0),
+            RangeType::kWithinReach);
+  EXPECT_EQ(estimator.GetZone(handle), RangeType::kWithinReach);
+  EXPECT_NEAR(*estimator.GetDistanceMeters(handle), 0.63, 0.01);
+}
+
+TEST(ZoneEstimatorTest, OnlyReportsChanges) {
+  ZoneEstimator estimator;
+  ZoneEstimator::DeviceHandle handle = estimator.GetHandle("device");
+  estimator.Update(handle, std::nullopt, kFarRssi, 0);
+
+  EXPECT_EQ(estimator.Update(handle, std::nullopt, kFarRssi, 100),
+            std::nullopt);
+  EXPECT_EQ(estimator.Update(handle, std::nullopt, kFarRssi, 200),
+            std::nullopt);
+}
+
+TEST(ZoneEstimatorTest, SmoothsOutliers) {
+  ZoneEstimator estimator;
+  ZoneEstimator::DeviceHandle handle = estimator.GetHandle("device");
+  estimator.Update(handle, std::nullopt, kFarRssi, 0);
+
+  // A single strong sample doesn't bring the device within reach.
+  EXPECT_EQ(estimator.Update(handle, std::nullopt, kTapRssi, 100),
+            std::nullopt);
+  EXPECT_EQ(estimator.GetZone(handle), RangeType::kFar);
+}
+
+TEST(ZoneEstimatorTest, DoesNotFlapAroundBoundary) {
+  ZoneEstimator estimator;
+  ZoneEstimator::DeviceHandle handle = estimator.GetHandle("device");
+  // One meter away, just within reach.
+  ASSERT_EQ(estimator.Update(handle, ZoneEstimator::kDefaultTxPower,
+                             ZoneEstimator::kDefaultTxPower, 0),
+            RangeType::kWithinReach);
+
+  for (int i = 1; i < 20; ++i) {
+    int rssi = ZoneEstimator::kDefaultTxPower + (i % 2 ? -1 : 1);
+    EXPECT_EQ(estimator.Update(handle, std::nullopt, rssi, i * 100),
+              std::nullopt);
+  }
+}
+
+TEST(ZoneEstimatorTest, ReportsMoves) {
+  ZoneEstimator estimator;
+  ZoneEstimator::DeviceHandle handle = estimator.GetHandle("device");
+  estimator.Update(handle, std::nullopt, kFarRssi, 0);
+
+  std::optional<RangeType> zone;
+  for (int i = 1; i < 20 && !zone.has_value(); ++i) {
+    zone = estimator.Update(handle, std::nullopt, kTapRssi, i * 100);
+  }
+  EXPECT_EQ(zone, RangeType::kWithinReach);
+}
+
+TEST(ZoneEstimatorTest, RestartsFromStaleSamples) {
+  ZoneEstimator estimator;
+  ZoneEstimator::DeviceHandle handle = estimator.GetHandle("device");
+  estimator.Update(handle, std::nullopt, kFarRssi, 0);
+
+  EXPECT_EQ(estimator.Update(handle, std::nullopt, kTapRssi,
+                             ZoneEstimator::kMaxSampleAgeMillis + 1),
+            RangeType::kWithinTap);
+}
+
+TEST(ZoneEstimatorTest, ReusesHandlesOfRemovedDevices) {
+  ZoneEstimator estimator;
+  ZoneEstimator::DeviceHandle handle = estimator.GetHandle("device");
+  estimator.Update(handle, std::nullopt, kFarRssi, 0);
+  EXPECT_EQ(estimator.GetHandle("device"), handle);
+
+  estimator.Remove("device");
+  ZoneEstimator::DeviceHandle other_handle = estimator.GetHandle("other");
+
+  EXPECT_EQ(other_handle, handle);
+  EXPECT_EQ(estimator.GetZone(other_handle), RangeType::kRangeUnknown);
+  EXPECT_NE(estimator.GetHandle("device"), handle);
+}
+
+}  // namespace
+}  // namespace presence
+}  // namespace nearby